@@ -0,0 +1,22 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+cmake_minimum_required(VERSION 3.5)
+
+file(MAKE_DIRECTORY
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/src/libarchive"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/src/libarchive-build"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/tmp"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/src/libarchive-stamp"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/src"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/src/libarchive-stamp"
+)
+
+set(configSubDirs Debug;Release)
+foreach(subDir IN LISTS configSubDirs)
+    file(MAKE_DIRECTORY "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/src/libarchive-stamp/${subDir}")
+endforeach()
+if(cfgdir)
+  file(MAKE_DIRECTORY "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Debug/src/libarchive-stamp${cfgdir}") # cfgdir has leading slash
+endif()
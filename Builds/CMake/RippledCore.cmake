@@ -49,6 +49,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/basics/impl/FileUtilities.cpp
   src/ripple/basics/impl/IOUAmount.cpp
   src/ripple/basics/impl/Log.cpp
+  src/ripple/basics/impl/MemoryArena.cpp
   src/ripple/basics/impl/strHex.cpp
   src/ripple/basics/impl/StringUtilities.cpp
   #[===============================[
@@ -78,6 +79,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/protocol/impl/Issue.cpp
   src/ripple/protocol/impl/Keylet.cpp
   src/ripple/protocol/impl/LedgerFormats.cpp
+  src/ripple/protocol/impl/ParsedKeyCache.cpp
   src/ripple/protocol/impl/PublicKey.cpp
   src/ripple/protocol/impl/Quality.cpp
   src/ripple/protocol/impl/Rate2.cpp
@@ -351,8 +353,11 @@ target_sources (rippled PRIVATE
   src/ripple/app/ledger/impl/InboundLedger.cpp
   src/ripple/app/ledger/impl/InboundLedgers.cpp
   src/ripple/app/ledger/impl/InboundTransactions.cpp
+  src/ripple/app/ledger/impl/IssuerBalances.cpp
   src/ripple/app/ledger/impl/LedgerCleaner.cpp
   src/ripple/app/ledger/impl/LedgerDeltaAcquire.cpp
+  src/ripple/app/ledger/impl/LedgerHashIndex.cpp
+  src/ripple/app/ledger/impl/LedgerHeaderCache.cpp
   src/ripple/app/ledger/impl/LedgerMaster.cpp
   src/ripple/app/ledger/impl/LedgerReplay.cpp
   src/ripple/app/ledger/impl/LedgerReplayer.cpp
@@ -362,17 +367,23 @@ target_sources (rippled PRIVATE
   src/ripple/app/ledger/impl/LocalTxs.cpp
   src/ripple/app/ledger/impl/OpenLedger.cpp
   src/ripple/app/ledger/impl/SkipListAcquire.cpp
+  src/ripple/app/ledger/impl/StateExport.cpp
+  src/ripple/app/ledger/impl/StateTransfer.cpp
   src/ripple/app/ledger/impl/TimeoutCounter.cpp
   src/ripple/app/ledger/impl/TransactionAcquire.cpp
   src/ripple/app/ledger/impl/TransactionMaster.cpp
+  src/ripple/app/ledger/impl/TxIndex.cpp
+  src/ripple/app/ledger/impl/TxSetSketch.cpp
   src/ripple/app/main/Application.cpp
   src/ripple/app/main/BasicApp.cpp
   src/ripple/app/main/CollectorManager.cpp
   src/ripple/app/main/GRPCServer.cpp
   src/ripple/app/main/LoadManager.cpp
   src/ripple/app/main/Main.cpp
+  src/ripple/app/main/MemoryBudget.cpp
   src/ripple/app/main/NodeIdentity.cpp
   src/ripple/app/main/NodeStoreScheduler.cpp
+  src/ripple/app/main/StartupTasks.cpp
   src/ripple/app/reporting/DBHelpers.cpp
   src/ripple/app/reporting/ReportingETL.cpp
   src/ripple/app/reporting/ETLSource.cpp
@@ -388,7 +399,11 @@ target_sources (rippled PRIVATE
   src/ripple/app/misc/impl/AmendmentTable.cpp
   src/ripple/app/misc/impl/LoadFeeTrack.cpp
   src/ripple/app/misc/impl/Manifest.cpp
+  src/ripple/app/misc/impl/NodeStoreCompactor.cpp
+  src/ripple/app/misc/impl/SignatureCache.cpp
   src/ripple/app/misc/impl/Transaction.cpp
+  src/ripple/app/misc/impl/TransactionFilter.cpp
+  src/ripple/app/misc/impl/TxPartitions.cpp
   src/ripple/app/misc/impl/TxQ.cpp
   src/ripple/app/misc/impl/ValidatorKeys.cpp
   src/ripple/app/misc/impl/ValidatorList.cpp
@@ -405,6 +420,7 @@ target_sources (rippled PRIVATE
   src/ripple/app/paths/impl/BookStep.cpp
   src/ripple/app/paths/impl/DirectStep.cpp
   src/ripple/app/paths/impl/PaySteps.cpp
+  src/ripple/app/paths/impl/StrandWorkers.cpp
   src/ripple/app/paths/impl/XRPEndpointStep.cpp
   src/ripple/app/tx/impl/ApplyContext.cpp
   src/ripple/app/tx/impl/BookTip.cpp
@@ -437,8 +453,11 @@ target_sources (rippled PRIVATE
   #]===============================]
   src/ripple/basics/impl/Archive.cpp
   src/ripple/basics/impl/BasicConfig.cpp
+  src/ripple/basics/impl/Numa.cpp
   src/ripple/basics/impl/PerfLogImp.cpp
   src/ripple/basics/impl/ResolverAsio.cpp
+  src/ripple/basics/impl/StackSampler.cpp
+  src/ripple/basics/impl/Tracer.cpp
   src/ripple/basics/impl/UptimeClock.cpp
   src/ripple/basics/impl/make_SSLContext.cpp
   src/ripple/basics/impl/mulDiv.cpp
@@ -453,7 +472,9 @@ target_sources (rippled PRIVATE
      main sources:
        subdir: core
   #]===============================]
+  src/ripple/core/impl/AutoTune.cpp
   src/ripple/core/impl/Config.cpp
+  src/ripple/core/impl/CoroStackPool.cpp
   src/ripple/core/impl/DatabaseCon.cpp
   src/ripple/core/impl/Job.cpp
   src/ripple/core/impl/JobQueue.cpp
@@ -463,6 +484,7 @@ target_sources (rippled PRIVATE
   src/ripple/core/impl/SociDB.cpp
   src/ripple/core/impl/Stoppable.cpp
   src/ripple/core/impl/TimeKeeper.cpp
+  src/ripple/core/impl/WorkerPool.cpp
   src/ripple/core/impl/Workers.cpp
   src/ripple/core/Pg.cpp
   #[===============================[
@@ -493,6 +515,7 @@ target_sources (rippled PRIVATE
      main sources:
        subdir: net
   #]===============================]
+  src/ripple/net/impl/ArchiveDownloader.cpp
   src/ripple/net/impl/DatabaseDownloader.cpp
   src/ripple/net/impl/HTTPClient.cpp
   src/ripple/net/impl/HTTPDownloader.cpp
@@ -502,6 +525,7 @@ target_sources (rippled PRIVATE
   src/ripple/net/impl/RPCErr.cpp
   src/ripple/net/impl/RPCSub.cpp
   src/ripple/net/impl/RegisterSSLCerts.cpp
+  src/ripple/net/impl/SubscriberFanout.cpp
   #[===============================[
      main sources:
        subdir: nodestore
@@ -512,16 +536,22 @@ target_sources (rippled PRIVATE
   src/ripple/nodestore/backend/NullFactory.cpp
   src/ripple/nodestore/backend/RocksDBFactory.cpp
   src/ripple/nodestore/impl/BatchWriter.cpp
+  src/ripple/nodestore/impl/CodecDictionary.cpp
   src/ripple/nodestore/impl/Database.cpp
   src/ripple/nodestore/impl/DatabaseNodeImp.cpp
   src/ripple/nodestore/impl/DatabaseRotatingImp.cpp
   src/ripple/nodestore/impl/DatabaseShardImp.cpp
+  src/ripple/nodestore/impl/DatabaseTieredImp.cpp
   src/ripple/nodestore/impl/DecodedBlob.cpp
   src/ripple/nodestore/impl/DummyScheduler.cpp
   src/ripple/nodestore/impl/EncodedBlob.cpp
+  src/ripple/nodestore/impl/FilteredBackend.cpp
   src/ripple/nodestore/impl/ManagerImp.cpp
+  src/ripple/nodestore/impl/MappedFile.cpp
   src/ripple/nodestore/impl/NodeObject.cpp
+  src/ripple/nodestore/impl/PackedShard.cpp
   src/ripple/nodestore/impl/Shard.cpp
+  src/ripple/nodestore/impl/ShardFilter.cpp
   src/ripple/nodestore/impl/TaskQueue.cpp
   #[===============================[
      main sources:
@@ -536,6 +566,8 @@ target_sources (rippled PRIVATE
   src/ripple/overlay/impl/PeerReservationTable.cpp
   src/ripple/overlay/impl/PeerSet.cpp
   src/ripple/overlay/impl/ProtocolVersion.cpp
+  src/ripple/overlay/impl/RelayBatch.cpp
+  src/ripple/overlay/impl/StreamCompression.cpp
   src/ripple/overlay/impl/TrafficCount.cpp
   #[===============================[
      main sources:
@@ -580,6 +612,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/FetchInfo.cpp
   src/ripple/rpc/handlers/GatewayBalances.cpp
   src/ripple/rpc/handlers/GetCounts.cpp
+  src/ripple/rpc/handlers/GetTrace.cpp
   src/ripple/rpc/handlers/LedgerAccept.cpp
   src/ripple/rpc/handlers/LedgerCleanerHandler.cpp
   src/ripple/rpc/handlers/LedgerClosed.cpp
@@ -587,6 +620,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/LedgerData.cpp
   src/ripple/rpc/handlers/LedgerDiff.cpp
   src/ripple/rpc/handlers/LedgerEntry.cpp
+  src/ripple/rpc/handlers/LedgerExport.cpp
   src/ripple/rpc/handlers/LedgerHandler.cpp
   src/ripple/rpc/handlers/LedgerHeader.cpp
   src/ripple/rpc/handlers/LedgerRequest.cpp
@@ -627,10 +661,12 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/impl/LegacyPathFind.cpp
   src/ripple/rpc/impl/RPCHandler.cpp
   src/ripple/rpc/impl/RPCHelpers.cpp
+  src/ripple/rpc/impl/ResponseCache.cpp
   src/ripple/rpc/impl/Role.cpp
   src/ripple/rpc/impl/ServerHandlerImp.cpp
   src/ripple/rpc/impl/ShardArchiveHandler.cpp
   src/ripple/rpc/impl/ShardVerificationScheduler.cpp
+  src/ripple/rpc/impl/SigningQueue.cpp
   src/ripple/rpc/impl/Status.cpp
   src/ripple/rpc/impl/TransactionSign.cpp
 
@@ -650,7 +686,9 @@ target_sources (rippled PRIVATE
   src/ripple/shamap/impl/SHAMapInnerNode.cpp
   src/ripple/shamap/impl/SHAMapItem.cpp
   src/ripple/shamap/impl/SHAMapLeafNode.cpp
+  src/ripple/shamap/impl/SHAMapNodeArena.cpp
   src/ripple/shamap/impl/SHAMapNodeID.cpp
+  src/ripple/shamap/impl/SHAMapSnapshot.cpp
   src/ripple/shamap/impl/SHAMapSync.cpp
   src/ripple/shamap/impl/SHAMapTreeNode.cpp
   src/ripple/shamap/impl/ShardFamily.cpp
@@ -661,6 +699,9 @@ target_sources (rippled PRIVATE
   src/test/app/AccountDelete_test.cpp
   src/test/app/AccountTxPaging_test.cpp
   src/test/app/AmendmentTable_test.cpp
+  src/test/app/ApplyBench_test.cpp
+  src/test/app/BuildLedger_test.cpp
+  src/test/app/CanonicalTXSet_test.cpp
   src/test/app/Check_test.cpp
   src/test/app/CrossingLimits_test.cpp
   src/test/app/DeliverMin_test.cpp
@@ -670,14 +711,20 @@ target_sources (rippled PRIVATE
   src/test/app/Escrow_test.cpp
   src/test/app/FeeVote_test.cpp
   src/test/app/Flow_test.cpp
+  src/test/app/FlowBench_test.cpp
   src/test/app/Freeze_test.cpp
   src/test/app/HashRouter_test.cpp
+  src/test/app/LedgerDataPartitions_test.cpp
+  src/test/app/LedgerHashIndex_test.cpp
+  src/test/app/LedgerHeaderCache_test.cpp
   src/test/app/LedgerHistory_test.cpp
   src/test/app/LedgerLoad_test.cpp
   src/test/app/LedgerReplay_test.cpp
   src/test/app/LoadFeeTrack_test.cpp
   src/test/app/Manifest_test.cpp
+  src/test/app/MemoryBudget_test.cpp
   src/test/app/MultiSign_test.cpp
+  src/test/app/NodeStoreCompactor_test.cpp
   src/test/app/OfferStream_test.cpp
   src/test/app/Offer_test.cpp
   src/test/app/OversizeMeta_test.cpp
@@ -692,12 +739,19 @@ target_sources (rippled PRIVATE
   src/test/app/SetAuth_test.cpp
   src/test/app/SetRegularKey_test.cpp
   src/test/app/SetTrust_test.cpp
+  src/test/app/SignatureCache_test.cpp
+  src/test/app/StartupTasks_test.cpp
+  src/test/app/StateExport_test.cpp
+  src/test/app/StateTransfer_test.cpp
   src/test/app/Taker_test.cpp
   src/test/app/TheoreticalQuality_test.cpp
   src/test/app/Ticket_test.cpp
+  src/test/app/TransactionFilter_test.cpp
   src/test/app/Transaction_ordering_test.cpp
   src/test/app/TrustAndBalance_test.cpp
+  src/test/app/TxPartitions_test.cpp
   src/test/app/TxQ_test.cpp
+  src/test/app/TxSetSketch_test.cpp
   src/test/app/ValidatorKeys_test.cpp
   src/test/app/ValidatorList_test.cpp
   src/test/app/ValidatorSite_test.cpp
@@ -711,11 +765,20 @@ target_sources (rippled PRIVATE
   src/test/basics/FileUtilities_test.cpp
   src/test/basics/IOUAmount_test.cpp
   src/test/basics/KeyCache_test.cpp
+  src/test/basics/Log_test.cpp
+  src/test/basics/MemoryArena_test.cpp
+  src/test/basics/Numa_test.cpp
   src/test/basics/PerfLog_test.cpp
   src/test/basics/RangeSet_test.cpp
+  src/test/basics/ShardedTaggedCache_test.cpp
+  src/test/basics/SlabAllocator_test.cpp
+  src/test/basics/SSLSessionCache_test.cpp
   src/test/basics/Slice_test.cpp
+  src/test/basics/StackSampler_test.cpp
   src/test/basics/StringUtilities_test.cpp
   src/test/basics/TaggedCache_test.cpp
+  src/test/basics/Tracer_test.cpp
+  src/test/basics/UnorderedContainers_test.cpp
   src/test/basics/XRPAmount_test.cpp
   src/test/basics/base64_test.cpp
   src/test/basics/base_uint_test.cpp
@@ -732,8 +795,10 @@ target_sources (rippled PRIVATE
   src/test/beast/LexicalCast_test.cpp
   src/test/beast/SemanticVersion_test.cpp
   src/test/beast/aged_associative_container_test.cpp
+  src/test/beast/aged_flat_unordered_map_test.cpp
   src/test/beast/beast_CurrentThreadName_test.cpp
   src/test/beast/beast_Journal_test.cpp
+  src/test/beast/beast_LogHistogram_test.cpp
   src/test/beast/beast_PropertyStream_test.cpp
   src/test/beast/beast_Zero_test.cpp
   src/test/beast/beast_abstract_clock_test.cpp
@@ -750,10 +815,12 @@ target_sources (rippled PRIVATE
        subdir: consensus
   #]===============================]
   src/test/consensus/ByzantineFailureSim_test.cpp
+  src/test/consensus/ConsensusBench_test.cpp
   src/test/consensus/Consensus_test.cpp
   src/test/consensus/DistributedValidatorsSim_test.cpp
   src/test/consensus/LedgerTiming_test.cpp
   src/test/consensus/LedgerTrie_test.cpp
+  src/test/consensus/LedgerTrieBench_test.cpp
   src/test/consensus/NegativeUNL_test.cpp
   src/test/consensus/ScaleFreeSim_test.cpp
   src/test/consensus/Validations_test.cpp
@@ -763,11 +830,14 @@ target_sources (rippled PRIVATE
   #]===============================]
   src/test/core/ClosureCounter_test.cpp
   src/test/core/Config_test.cpp
+  src/test/core/CoroBench_test.cpp
+  src/test/core/CoroStackPool_test.cpp
   src/test/core/Coroutine_test.cpp
   src/test/core/CryptoPRNG_test.cpp
   src/test/core/JobQueue_test.cpp
   src/test/core/SociDB_test.cpp
   src/test/core/Stoppable_test.cpp
+  src/test/core/WorkerPool_test.cpp
   src/test/core/Workers_test.cpp
   #[===============================[
      test sources:
@@ -790,6 +860,7 @@ target_sources (rippled PRIVATE
   #]===============================]
   src/test/json/Object_test.cpp
   src/test/json/Output_test.cpp
+  src/test/json/ReaderBench_test.cpp
   src/test/json/Writer_test.cpp
   src/test/json/json_value_test.cpp
   #[===============================[
@@ -851,12 +922,15 @@ target_sources (rippled PRIVATE
        subdir: net
   #]===============================]
   src/test/net/DatabaseDownloader_test.cpp
+  src/test/net/SubscriberFanout_test.cpp
   #[===============================[
      test sources:
        subdir: nodestore
   #]===============================]
   src/test/nodestore/Backend_test.cpp
   src/test/nodestore/Basics_test.cpp
+  src/test/nodestore/Bench_test.cpp
+  src/test/nodestore/ConcurrencyWindow_test.cpp
   src/test/nodestore/DatabaseShard_test.cpp
   src/test/nodestore/Database_test.cpp
   src/test/nodestore/Timing_test.cpp
@@ -866,7 +940,11 @@ target_sources (rippled PRIVATE
      test sources:
        subdir: overlay
   #]===============================]
+  src/test/overlay/Message_test.cpp
   src/test/overlay/ProtocolVersion_test.cpp
+  src/test/overlay/RelayBatch_test.cpp
+  src/test/overlay/RelayBench_test.cpp
+  src/test/overlay/TrafficCount_test.cpp
   src/test/overlay/cluster_test.cpp
   src/test/overlay/short_read_test.cpp
   src/test/overlay/compression_test.cpp
@@ -886,6 +964,7 @@ target_sources (rippled PRIVATE
   src/test/protocol/InnerObjectFormats_test.cpp
   src/test/protocol/Issue_test.cpp
   src/test/protocol/KnownFormatToGRPC_test.cpp
+  src/test/protocol/ParsedKeyBench_test.cpp
   src/test/protocol/PublicKey_test.cpp
   src/test/protocol/Quality_test.cpp
   src/test/protocol/STAccount_test.cpp
@@ -896,7 +975,9 @@ target_sources (rippled PRIVATE
   src/test/protocol/SecretKey_test.cpp
   src/test/protocol/Seed_test.cpp
   src/test/protocol/SeqProxy_test.cpp
+  src/test/protocol/Serializer_test.cpp
   src/test/protocol/TER_test.cpp
+  src/test/protocol/digest_test.cpp
   src/test/protocol/types_test.cpp
   #[===============================[
      test sources:
@@ -936,10 +1017,13 @@ target_sources (rippled PRIVATE
   src/test/rpc/ReportingETL_test.cpp
   src/test/rpc/Roles_test.cpp
   src/test/rpc/RPCCall_test.cpp
+  src/test/rpc/RPCLoad_test.cpp
   src/test/rpc/RPCOverload_test.cpp
+  src/test/rpc/ResponseCache_test.cpp
   src/test/rpc/RobustTransaction_test.cpp
   src/test/rpc/ServerInfo_test.cpp
   src/test/rpc/ShardArchiveHandler_test.cpp
+  src/test/rpc/SigningQueue_test.cpp
   src/test/rpc/Status_test.cpp
   src/test/rpc/Submit_test.cpp
   src/test/rpc/Subscribe_test.cpp
@@ -954,6 +1038,7 @@ target_sources (rippled PRIVATE
      test sources:
        subdir: server
   #]===============================]
+  src/test/server/JSONRPCUtil_test.cpp
   src/test/server/ServerStatus_test.cpp
   src/test/server/Server_test.cpp
   #[===============================[
@@ -961,6 +1046,9 @@ target_sources (rippled PRIVATE
        subdir: shamap
   #]===============================]
   src/test/shamap/FetchPack_test.cpp
+  src/test/shamap/SHAMapBench_test.cpp
+  src/test/shamap/SHAMapNodeArena_test.cpp
+  src/test/shamap/SHAMapSnapshot_test.cpp
   src/test/shamap/SHAMapSync_test.cpp
   src/test/shamap/SHAMap_test.cpp
   #[===============================[
@@ -48,6 +48,20 @@ if (jemalloc)
   set (CMAKE_BUILD_RPATH ${CMAKE_BUILD_RPATH} ${JEMALLOC_LIB_PATH})
 endif ()
 
+if (mimalloc)
+  if (jemalloc)
+    message (FATAL_ERROR "jemalloc and mimalloc can't both be enabled")
+  endif ()
+  find_path (MIMALLOC_INCLUDE_DIR mimalloc.h PATH_SUFFIXES mimalloc)
+  find_library (MIMALLOC_LIBRARY NAMES mimalloc)
+  if (NOT MIMALLOC_INCLUDE_DIR OR NOT MIMALLOC_LIBRARY)
+    message (FATAL_ERROR "mimalloc requested but not found")
+  endif ()
+  target_compile_definitions (opts INTERFACE RIPPLE_MIMALLOC)
+  target_include_directories (opts SYSTEM INTERFACE ${MIMALLOC_INCLUDE_DIR})
+  target_link_libraries (opts INTERFACE ${MIMALLOC_LIBRARY})
+endif ()
+
 if (san)
   target_compile_options (opts
     INTERFACE
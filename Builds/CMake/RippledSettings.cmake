@@ -54,7 +54,13 @@ if (is_clang)
 else ()
   set (use_lld OFF CACHE BOOL "try lld linker, clang only" FORCE)
 endif ()
-option (jemalloc "Enables jemalloc for heap profiling" OFF)
+option (jemalloc "Enables jemalloc for heap profiling and memory arenas" OFF)
+option (mimalloc "Enables mimalloc as the heap allocator" OFF)
+if (is_linux)
+  option (io_uring "Use io_uring instead of epoll for socket I/O (Linux)" OFF)
+else ()
+  set (io_uring OFF CACHE BOOL "io_uring is only available on Linux" FORCE)
+endif ()
 option (werr "treat warnings as errors" OFF)
 option (local_protobuf
   "Force a local build of protobuf instead of looking for an installed version." OFF)
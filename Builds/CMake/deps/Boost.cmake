@@ -81,6 +81,26 @@ target_link_libraries (ripple_boost
 if (Boost_COMPILER)
   target_link_libraries (ripple_boost INTERFACE Boost::disable_autolinking)
 endif ()
+if (io_uring)
+  # Asio's io_uring backend replaces the epoll reactor for every socket,
+  # so peers, doors and RPC clients all use it. Submissions made while
+  # running handlers are batched into one io_uring_enter call.
+  if (Boost_VERSION_STRING VERSION_LESS 1.78)
+    message (FATAL_ERROR "io_uring requires Boost 1.78 or later")
+  endif ()
+  find_path (LIBURING_INCLUDE_DIR liburing.h)
+  find_library (LIBURING_LIBRARY NAMES uring)
+  if (NOT LIBURING_INCLUDE_DIR OR NOT LIBURING_LIBRARY)
+    message (FATAL_ERROR "io_uring requires liburing")
+  endif ()
+  target_include_directories (ripple_boost SYSTEM INTERFACE
+    ${LIBURING_INCLUDE_DIR})
+  target_compile_definitions (ripple_boost
+    INTERFACE
+      BOOST_ASIO_HAS_IO_URING
+      BOOST_ASIO_DISABLE_EPOLL)
+  target_link_libraries (ripple_boost INTERFACE ${LIBURING_LIBRARY})
+endif ()
 if (san AND is_clang)
   # TODO: gcc does not support -fsanitize-blacklist...can we do something else 
   # for gcc ?
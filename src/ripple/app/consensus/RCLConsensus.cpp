@@ -26,6 +26,7 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LocalTxs.h>
 #include <ripple/app/ledger/OpenLedger.h>
+#include <ripple/app/main/CollectorManager.h>
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
@@ -34,10 +35,12 @@
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
 #include <ripple/app/misc/ValidatorList.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/random.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/consensus/LedgerTiming.h>
 #include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/nodestore/Scheduler.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/BuildInfo.h>
@@ -93,6 +96,9 @@ RCLConsensus::Adaptor::Adaptor(
           1,
           std::numeric_limits<std::uint64_t>::max())}
     , nUnlVote_(nodeID_, j_)
+    , roundTimes_(app.getCollectorManager().collector()->make_histogram(
+          "Consensus",
+          "Round_Time"))
 {
     assert(valCookie_ != 0);
 
@@ -167,7 +173,7 @@ RCLConsensus::Adaptor::share(RCLCxTx const& tx)
     if (app_.getHashRouter().shouldRelay(tx.id()))
     {
         JLOG(j_.debug()) << "Relaying disputed tx " << tx.id();
-        auto const slice = tx.tx_.slice();
+        auto const slice = tx.tx_->slice();
         protocol::TMTransaction msg;
         msg.set_rawtransaction(slice.data(), slice.size());
         msg.set_status(protocol::tsNEW);
@@ -290,6 +296,11 @@ RCLConsensus::Adaptor::onClose(
     NetClock::time_point const& closeTime,
     ConsensusMode mode) -> Result
 {
+    establishStart_ = std::chrono::steady_clock::now();
+    if (openStart_ != std::chrono::steady_clock::time_point{})
+        app_.getTracer().record(
+            "open", "consensus", openStart_, establishStart_, ledger.seq() + 1);
+
     const bool wrongLCL = mode == ConsensusMode::wrongLedger;
     const bool proposing = mode == ConsensusMode::proposing;
 
@@ -303,8 +314,11 @@ RCLConsensus::Adaptor::onClose(
 
     auto initialLedger = app_.openLedger().current();
 
-    auto initialSet =
-        std::make_shared<SHAMap>(SHAMapType::TRANSACTION, app_.getNodeFamily());
+    // The set is discarded with the round, so its nodes are freed together
+    auto initialSet = std::make_shared<SHAMap>(
+        SHAMapType::TRANSACTION,
+        app_.getNodeFamily(),
+        std::make_shared<SHAMapNodeArena>());
     initialSet->setUnbacked();
 
     // Build SHAMap containing all transactions in our open ledger
@@ -316,7 +330,7 @@ RCLConsensus::Adaptor::onClose(
         tx.first->add(s);
         initialSet->addItem(
             SHAMapNodeType::tnTRANSACTION_NM,
-            SHAMapItem(tx.first->getTransactionID(), std::move(s)));
+            make_shamapitem(tx.first->getTransactionID(), s.slice()));
     }
 
     // Add pseudo-transactions to the set
@@ -360,7 +374,8 @@ RCLConsensus::Adaptor::onClose(
         RCLCensorshipDetector<TxID, LedgerIndex>::TxIDSeqVec proposed;
 
         initialSet->visitLeaves(
-            [&proposed, seq](std::shared_ptr<SHAMapItem const> const& item) {
+            [&proposed,
+             seq](boost::intrusive_ptr<SHAMapItem const> const& item) {
                 proposed.emplace_back(item->key(), seq);
             });
 
@@ -408,6 +423,13 @@ RCLConsensus::Adaptor::onAccept(
     ConsensusMode const& mode,
     Json::Value&& consensusJson)
 {
+    app_.getTracer().record(
+        "establish",
+        "consensus",
+        establishStart_,
+        std::chrono::steady_clock::now(),
+        prevLedger.seq() + 1);
+
     app_.getJobQueue().addJob(
         jtACCEPT,
         "acceptLedger",
@@ -417,6 +439,8 @@ RCLConsensus::Adaptor::onAccept(
             // is accepted, the consensus results and capture by reference state
             // will not change until startRound is called (which happens via
             // endConsensus).
+            NodeStore::ScopedFetchCaller const fetchCaller(
+                NodeStore::FetchCaller::consensus);
             this->doAccept(
                 result,
                 prevLedger,
@@ -437,8 +461,12 @@ RCLConsensus::Adaptor::doAccept(
     ConsensusMode const& mode,
     Json::Value&& consensusJson)
 {
+    perf::Tracer::Span span(
+        app_.getTracer(), "accept", "consensus", prevLedger.seq() + 1);
+
     prevProposers_ = result.proposers;
     prevRoundTime_ = result.roundTime.read();
+    roundTimes_.notify(result.roundTime.read());
 
     bool closeTimeCorrect;
 
@@ -519,7 +547,7 @@ RCLConsensus::Adaptor::doAccept(
         std::vector<TxID> accepted;
 
         result.txns.map_->visitLeaves(
-            [&accepted](std::shared_ptr<SHAMapItem const> const& item) {
+            [&accepted](boost::intrusive_ptr<SHAMapItem const> const& item) {
                 accepted.push_back(item->key());
             });
 
@@ -594,7 +622,7 @@ RCLConsensus::Adaptor::doAccept(
                         << "Test applying disputed transaction that did"
                         << " not get in " << dispute.tx().id();
 
-                    SerialIter sit(dispute.tx().tx_.slice());
+                    SerialIter sit(dispute.tx().tx_->slice());
                     auto txn = std::make_shared<STTx const>(sit);
 
                     // Disputed pseudo-transactions that were not accepted
@@ -653,6 +681,19 @@ RCLConsensus::Adaptor::doAccept(
         assert(app_.openLedger().current()->info().parentHash == built.id());
     }
 
+    //-------------------------------------------------------------------------
+    // With a pipelined close, the nodes of the new ledger are written while
+    // the next round gets under way. Saving the ledger waits for them.
+    if (app_.config().PIPELINED_CLOSE)
+    {
+        auto const& ledger = built.ledger_;
+        if (!app_.getJobQueue().addJob(
+                jtWRITE, "storeLedgerNodes", [ledger](Job&) {
+                    ledger->storeDeferredWrites();
+                }))
+            ledger->storeDeferredWrites();
+    }
+
     //-------------------------------------------------------------------------
     // we entered the round with the network,
     // see how close our close time is to other node's
@@ -747,7 +788,7 @@ RCLConsensus::Adaptor::buildLCL(
         if (auto const replayData = ledgerMaster_.releaseReplay())
         {
             assert(replayData->parent()->info().hash == previousLedger.id());
-            return buildLedger(*replayData, tapNONE, app_, j_);
+            return buildLedger(*replayData, tapREPLAY, app_, j_);
         }
         return buildLedger(
             previousLedger.ledger_,
@@ -891,6 +932,8 @@ RCLConsensus::getJson(bool full) const
 void
 RCLConsensus::timerEntry(NetClock::time_point const& now)
 {
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::consensus);
     try
     {
         std::lock_guard _{mutex_};
@@ -907,6 +950,8 @@ RCLConsensus::timerEntry(NetClock::time_point const& now)
 void
 RCLConsensus::gotTxSet(NetClock::time_point const& now, RCLTxSet const& txSet)
 {
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::consensus);
     try
     {
         std::lock_guard _{mutex_};
@@ -928,6 +973,8 @@ RCLConsensus::simulate(
     boost::optional<std::chrono::milliseconds> consensusDelay)
 {
     std::lock_guard _{mutex_};
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::consensus);
     consensus_.simulate(now, consensusDelay);
 }
 
@@ -937,6 +984,8 @@ RCLConsensus::peerProposal(
     RCLCxPeerPos const& newProposal)
 {
     std::lock_guard _{mutex_};
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::consensus);
     return consensus_.peerProposal(now, newProposal);
 }
 
@@ -945,6 +994,8 @@ RCLConsensus::Adaptor::preStartRound(
     RCLCxLedger const& prevLgr,
     hash_set<NodeID> const& nowTrusted)
 {
+    openStart_ = std::chrono::steady_clock::now();
+
     // We have a key, we do not want out of sync validations after a restart
     // and are not amendment blocked.
     validating_ = valPublic_.size() != 0 &&
@@ -1039,6 +1090,8 @@ RCLConsensus::startRound(
     hash_set<NodeID> const& nowTrusted)
 {
     std::lock_guard _{mutex_};
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::consensus);
     consensus_.startRound(
         now,
         prevLgrId,
@@ -28,6 +28,7 @@
 #include <ripple/app/misc/NegativeUNLVote.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/basics/Log.h>
+#include <ripple/beast/insight/Histogram.h>
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/consensus/Consensus.h>
 #include <ripple/core/JobQueue.h>
@@ -88,6 +89,14 @@ class RCLConsensus
         RCLCensorshipDetector<TxID, LedgerIndex> censorshipDetector_;
         NegativeUNLVote nUnlVote_;
 
+        // Distribution of consensus round durations
+        beast::insight::Histogram roundTimes_;
+
+        // When the open and establish phases of this round began, for the
+        // trace of the round. Set under the consensus lock.
+        std::chrono::steady_clock::time_point openStart_;
+        std::chrono::steady_clock::time_point establishStart_;
+
     public:
         using Ledger_t = RCLCxLedger;
         using NodeID_t = NodeID;
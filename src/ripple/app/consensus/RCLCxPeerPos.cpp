@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/app/consensus/RCLCxPeerPos.h>
+#include <ripple/app/misc/SignatureCache.h>
 #include <ripple/core/Config.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/Serializer.h>
@@ -57,6 +58,16 @@ RCLCxPeerPos::checkSign() const
     return verifyDigest(publicKey(), signingHash(), signature(), false);
 }
 
+bool
+RCLCxPeerPos::checkSign(SignatureCache& signatures) const
+{
+    auto const hash = signingHash();
+    return signatures.verify(
+        SignatureCache::key(hash, publicKey(), signature()), [&] {
+            return verifyDigest(publicKey(), hash, signature(), false);
+        });
+}
+
 Json::Value
 RCLCxPeerPos::getJson() const
 {
@@ -34,6 +34,8 @@
 
 namespace ripple {
 
+class SignatureCache;
+
 /** A peer's signed, proposed position for use in RCLConsensus.
 
     Carries a ConsensusProposal signed by a peer. Provides value semantics
@@ -69,6 +71,10 @@ public:
     bool
     checkSign() const;
 
+    //! Verify the signing hash of the proposal unless already known good
+    bool
+    checkSign(SignatureCache& signatures) const;
+
     //! Signature of the proposal (not necessarily verified)
     Slice
     signature() const
@@ -41,8 +41,12 @@ public:
     /** Constructor
 
         @param txn The transaction to wrap
+
+        @note The item is shared rather than copied: every SHAMapItem
+              comes from make_shamapitem and carries its own reference
+              count.
     */
-    RCLCxTx(SHAMapItem const& txn) : tx_{txn}
+    RCLCxTx(SHAMapItem const& txn) : tx_{&txn}
     {
     }
 
@@ -50,11 +54,11 @@ public:
     ID const&
     id() const
     {
-        return tx_.key();
+        return tx_->key();
     }
 
     //! The SHAMapItem that represents the transaction.
-    SHAMapItem const tx_;
+    boost::intrusive_ptr<SHAMapItem const> const tx_;
 };
 
 /** Represents a set of transactions in RCLConsensus.
@@ -90,9 +94,7 @@ public:
         bool
         insert(Tx const& t)
         {
-            return map_->addItem(
-                SHAMapNodeType::tnTRANSACTION_NM,
-                SHAMapItem{t.id(), t.tx_.peekData()});
+            return map_->addItem(SHAMapNodeType::tnTRANSACTION_NM, t.tx_);
         }
 
         /** Remove a transaction from the set.
@@ -138,15 +140,15 @@ public:
     /** Lookup a transaction.
 
         @param entry The ID of the transaction to find.
-        @return A shared pointer to the SHAMapItem.
+        @return A pointer to the SHAMapItem.
 
         @note Since find may not succeed, this returns a
-              `std::shared_ptr<const SHAMapItem>` rather than a Tx, which
-              cannot refer to a missing transaction.  The generic consensus
-              code uses the shared_ptr semantics to know whether the find
-              was successful and properly creates a Tx as needed.
+              `boost::intrusive_ptr<SHAMapItem const>` rather than a Tx,
+              which cannot refer to a missing transaction.  The generic
+              consensus code uses the pointer semantics to know whether the
+              find was successful and properly creates a Tx as needed.
     */
-    std::shared_ptr<const SHAMapItem> const&
+    boost::intrusive_ptr<SHAMapItem const> const&
     find(Tx::ID const& entry) const
     {
         return map_->peekItem(entry);
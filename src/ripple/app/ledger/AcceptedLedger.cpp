@@ -21,9 +21,46 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/chrono.h>
+#include <ripple/core/WorkerPool.h>
+#include <vector>
 
 namespace ripple {
 
+// Transactions are only built on several threads when each thread would
+// have at least this many to build.
+static constexpr std::size_t minTxnsPerThread = 64;
+
+/** Build the transactions of a closed ledger on several threads.
+
+    The transaction map is walked once to gather its items, which are then
+    deserialized in parallel on the threads of the worker pool.
+*/
+static std::vector<AcceptedLedgerTx::pointer>
+buildParallel(
+    std::shared_ptr<ReadView const> const& view,
+    Ledger const& ledger,
+    Application& app)
+{
+    std::vector<boost::intrusive_ptr<SHAMapItem const>> items;
+    ledger.txMap().visitLeaves(
+        [&items](boost::intrusive_ptr<SHAMapItem const> const& item) {
+            items.push_back(item);
+        });
+
+    std::vector<AcceptedLedgerTx::pointer> txns(items.size());
+
+    app.getWorkerPool().run(
+        items.size(),
+        [&](std::size_t i) {
+            auto const [txn, meta] = deserializeTxPlusMeta(*items[i]);
+            txns[i] = std::make_shared<AcceptedLedgerTx>(
+                view, txn, meta, app.accountIDCache(), app.logs());
+        },
+        minTxnsPerThread);
+
+    return txns;
+}
+
 AcceptedLedger::AcceptedLedger(
     std::shared_ptr<ReadView const> const& ledger,
     Application& app)
@@ -43,6 +80,11 @@ AcceptedLedger::AcceptedLedger(
 
     if (app.config().reporting())
         insertAll(flatFetchTransactions(*ledger, app));
+    else if (auto const closed = dynamic_cast<Ledger const*>(ledger.get()))
+    {
+        for (auto const& txn : buildParallel(ledger, *closed, app))
+            insert(txn);
+    }
     else
         insertAll(ledger->txs);
 }
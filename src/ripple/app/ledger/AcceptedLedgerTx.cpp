@@ -23,6 +23,7 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/protocol/UintTypes.h>
 #include <ripple/protocol/jss.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -34,23 +35,15 @@ AcceptedLedgerTx::AcceptedLedgerTx(
     Logs& logs)
     : mLedger(ledger)
     , mTxn(txn)
-    , mMeta(std::make_shared<TxMeta>(
-          txn->getTransactionID(),
-          ledger->seq(),
-          *met))
-    , mAffected(mMeta->getAffectedAccounts(logs.journal("View")))
+    , mRawMetaObj(met)
+    , mIndex(met->getFieldU32(sfTransactionIndex))
+    , mResult(TER::fromInt(met->getFieldU8(sfTransactionResult)))
     , accountCache_(accountCache)
     , logs_(logs)
 {
     assert(!ledger->open());
-
-    mResult = mMeta->getResultTER();
-
-    Serializer s;
-    met->add(s);
-    mRawMeta = std::move(s.modData());
-
-    buildJson();
+    if (mResult == tesSUCCESS)
+        buildBooks();
 }
 
 AcceptedLedgerTx::AcceptedLedgerTx(
@@ -62,39 +55,118 @@ AcceptedLedgerTx::AcceptedLedgerTx(
     : mLedger(ledger)
     , mTxn(txn)
     , mResult(result)
-    , mAffected(txn->getMentionedAccounts())
     , accountCache_(accountCache)
     , logs_(logs)
 {
     assert(ledger->open());
-    buildJson();
+    std::call_once(
+        metaOnce_, [&] { mAffected = txn->getMentionedAccounts(); });
+}
+
+std::shared_ptr<TxMeta> const&
+AcceptedLedgerTx::getMeta() const
+{
+    std::call_once(metaOnce_, [this] { buildMeta(); });
+    return mMeta;
+}
+
+boost::container::flat_set<AccountID> const&
+AcceptedLedgerTx::getAffected() const
+{
+    std::call_once(metaOnce_, [this] { buildMeta(); });
+    return mAffected;
 }
 
 std::string
 AcceptedLedgerTx::getEscMeta() const
 {
-    assert(!mRawMeta.empty());
-    return sqlBlobLiteral(mRawMeta);
+    assert(mRawMetaObj);
+    Serializer s;
+    mRawMetaObj->add(s);
+    return sqlBlobLiteral(s.peekData());
+}
+
+Json::Value
+AcceptedLedgerTx::getJson() const
+{
+    std::call_once(jsonOnce_, [this] { buildJson(); });
+    return mJson;
+}
+
+void
+AcceptedLedgerTx::buildBooks()
+{
+    for (auto const& node : mRawMetaObj->getFieldArray(sfAffectedNodes))
+    {
+        try
+        {
+            if (node.getFieldU16(sfLedgerEntryType) != ltOFFER)
+                continue;
+
+            // We need a field that contains the TakerGets and TakerPays
+            // parameters.
+            SField const* field = nullptr;
+            if (node.getFName() == sfModifiedNode)
+                field = &sfPreviousFields;
+            else if (node.getFName() == sfCreatedNode)
+                field = &sfNewFields;
+            else if (node.getFName() == sfDeletedNode)
+                field = &sfFinalFields;
+
+            if (!field)
+                continue;
+
+            auto const data =
+                dynamic_cast<STObject const*>(node.peekAtPField(*field));
+
+            if (data && data->isFieldPresent(sfTakerPays) &&
+                data->isFieldPresent(sfTakerGets))
+            {
+                Book const book{
+                    data->getFieldAmount(sfTakerGets).issue(),
+                    data->getFieldAmount(sfTakerPays).issue()};
+
+                if (std::find(mBooks.begin(), mBooks.end(), book) ==
+                    mBooks.end())
+                    mBooks.push_back(book);
+            }
+        }
+        catch (std::exception const&)
+        {
+            JLOG(logs_.journal("View").info())
+                << "Fields not found in AcceptedLedgerTx::buildBooks";
+        }
+    }
+}
+
+void
+AcceptedLedgerTx::buildMeta() const
+{
+    mMeta = std::make_shared<TxMeta>(
+        mTxn->getTransactionID(), mLedger->seq(), *mRawMetaObj);
+    mAffected = mMeta->getAffectedAccounts(logs_.journal("View"));
 }
 
 void
-AcceptedLedgerTx::buildJson()
+AcceptedLedgerTx::buildJson() const
 {
     mJson = Json::objectValue;
     mJson[jss::transaction] = mTxn->getJson(JsonOptions::none);
 
-    if (mMeta)
+    if (auto const& meta = getMeta())
     {
-        mJson[jss::meta] = mMeta->getJson(JsonOptions::none);
-        mJson[jss::raw_meta] = strHex(mRawMeta);
+        Serializer s;
+        mRawMetaObj->add(s);
+        mJson[jss::meta] = meta->getJson(JsonOptions::none);
+        mJson[jss::raw_meta] = strHex(s.peekData());
     }
 
     mJson[jss::result] = transHuman(mResult);
 
-    if (!mAffected.empty())
+    if (auto const& accounts = getAffected(); !accounts.empty())
     {
         Json::Value& affected = (mJson[jss::affected] = Json::arrayValue);
-        for (auto const& account : mAffected)
+        for (auto const& account : accounts)
             affected.append(accountCache_.toBase58(account));
     }
 
@@ -22,7 +22,9 @@
 
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/Book.h>
 #include <boost/container/flat_set.hpp>
+#include <mutex>
 
 namespace ripple {
 
@@ -40,6 +42,12 @@ class Logs;
           * This is used by InfoSub to report to clients
         - Cached stuff
 
+    The metadata, the affected accounts and the JSON are only built when
+    they are first asked for, since many consumers need none of them.
+    These lazy members may be initialized from several threads at once.
+    The order books a successful transaction touched are found when it is
+    constructed, so that they are gathered while the ledger is built.
+
     @code
     @endcode
 
@@ -73,15 +81,18 @@ public:
         return mTxn;
     }
     std::shared_ptr<TxMeta> const&
-    getMeta() const
-    {
-        return mMeta;
-    }
+    getMeta() const;
 
     boost::container::flat_set<AccountID> const&
-    getAffected() const
+    getAffected() const;
+
+    /** The order books whose offers a successful transaction created,
+        modified or deleted, each listed once.
+    */
+    std::vector<Book> const&
+    getBooks() const
     {
-        return mAffected;
+        return mBooks;
     }
 
     TxID
@@ -102,40 +113,50 @@ public:
     std::uint32_t
     getTxnSeq() const
     {
-        return mMeta->getIndex();
+        assert(isApplied());
+        return mIndex;
     }
 
     bool
     isApplied() const
     {
-        return bool(mMeta);
+        return bool(mRawMetaObj);
     }
     int
     getIndex() const
     {
-        return mMeta ? mMeta->getIndex() : 0;
+        return mIndex;
     }
     std::string
     getEscMeta() const;
     Json::Value
-    getJson() const
-    {
-        return mJson;
-    }
+    getJson() const;
 
 private:
     std::shared_ptr<ReadView const> mLedger;
     std::shared_ptr<STTx const> mTxn;
-    std::shared_ptr<TxMeta> mMeta;
+    std::shared_ptr<STObject const> mRawMetaObj;
+    std::uint32_t mIndex = 0;
     TER mResult;
-    boost::container::flat_set<AccountID> mAffected;
-    Blob mRawMeta;
-    Json::Value mJson;
     AccountIDCache const& accountCache_;
     Logs& logs_;
+    std::vector<Book> mBooks;
+
+    mutable std::once_flag metaOnce_;
+    mutable std::shared_ptr<TxMeta> mMeta;
+    mutable boost::container::flat_set<AccountID> mAffected;
+
+    mutable std::once_flag jsonOnce_;
+    mutable Json::Value mJson;
+
+    void
+    buildBooks();
+
+    void
+    buildMeta() const;
 
     void
-    buildJson();
+    buildJson() const;
 };
 
 }  // namespace ripple
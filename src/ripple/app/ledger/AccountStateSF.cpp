@@ -21,6 +21,18 @@
 
 namespace ripple {
 
+AccountStateSF::~AccountStateSF()
+{
+    try
+    {
+        flush();
+    }
+    catch (std::exception const&)
+    {
+        // A node that was not stored is fetched again when it is read
+    }
+}
+
 void
 AccountStateSF::gotNode(
     bool,
@@ -29,8 +41,25 @@ AccountStateSF::gotNode(
     Blob&& nodeData,
     SHAMapNodeType) const
 {
-    db_.store(
-        hotACCOUNT_NODE, std::move(nodeData), nodeHash.as_uint256(), ledgerSeq);
+    auto object = NodeObject::createObject(
+        hotACCOUNT_NODE, std::move(nodeData), nodeHash.as_uint256());
+
+    // Nodes can arrive from several threads traversing the same map
+    NodeStore::Batch batch;
+    std::uint32_t batchSeq = 0;
+    {
+        std::lock_guard lock(mutex_);
+        if (ledgerSeq != ledgerSeq_)
+        {
+            batch.swap(batch_);
+            batchSeq = ledgerSeq_;
+            ledgerSeq_ = ledgerSeq;
+        }
+        batch_.push_back(std::move(object));
+    }
+
+    if (!batch.empty())
+        db_.storeBatch(batch, batchSeq);
 }
 
 boost::optional<Blob>
@@ -39,4 +68,19 @@ AccountStateSF::getNode(SHAMapHash const& nodeHash) const
     return fp_.getFetchPack(nodeHash.as_uint256());
 }
 
+void
+AccountStateSF::flush() const
+{
+    NodeStore::Batch batch;
+    std::uint32_t batchSeq;
+    {
+        std::lock_guard lock(mutex_);
+        if (batch_.empty())
+            return;
+        batch.swap(batch_);
+        batchSeq = ledgerSeq_;
+    }
+    db_.storeBatch(batch, batchSeq);
+}
+
 }  // namespace ripple
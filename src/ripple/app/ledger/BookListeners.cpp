@@ -38,8 +38,8 @@ BookListeners::removeSubscriber(std::uint64_t seq)
 }
 
 void
-BookListeners::publish(
-    Json::Value const& jvObj,
+BookListeners::collect(
+    std::vector<InfoSub::pointer>& subscribers,
     hash_set<std::uint64_t>& havePublished)
 {
     std::lock_guard sl(mLock);
@@ -51,11 +51,9 @@ BookListeners::publish(
 
         if (p)
         {
-            // Only publish jvObj if this is the first occurence
+            // Only publish to p if this is the first occurence
             if (havePublished.emplace(p->getSeq()).second)
-            {
-                p->send(jvObj, true);
-            }
+                subscribers.push_back(p);
             ++it;
         }
         else
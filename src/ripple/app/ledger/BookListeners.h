@@ -23,6 +23,7 @@
 #include <ripple/net/InfoSub.h>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
@@ -46,19 +47,21 @@ public:
     void
     removeSubscriber(std::uint64_t sub);
 
-    /** Publish a transaction to subscribers
+    /** Gather the subscribers a transaction on this book goes to
 
-        Publish a transaction to clients subscribed to changes on this book.
+        Adds the clients subscribed to changes on this book to subscribers.
         Uses havePublished to prevent sending duplicate transactions to clients
         that have subscribed to multiple books.
 
-        @param jvObj JSON transaction data to publish
+        @param subscribers The subscribers to publish the transaction to
         @param havePublished InfoSub sequence numbers that have already
-                             published this transaction.
+                             been given this transaction.
 
     */
     void
-    publish(Json::Value const& jvObj, hash_set<std::uint64_t>& havePublished);
+    collect(
+        std::vector<InfoSub::pointer>& subscribers,
+        hash_set<std::uint64_t>& havePublished);
 
 private:
     std::recursive_mutex mLock;
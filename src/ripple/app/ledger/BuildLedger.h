@@ -24,6 +24,7 @@
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/ledger/ApplyView.h>
 #include <chrono>
+#include <functional>
 #include <memory>
 
 namespace ripple {
@@ -33,12 +34,16 @@ class CanonicalTXSet;
 class Ledger;
 class LedgerReplay;
 class SHAMap;
+class STTx;
 
 /** Build a new ledger by applying consensus transactions
 
     Build a new ledger by applying a set of transactions accepted as part of
     consensus.
 
+    If the server is configured for a pipelined close, the writes of the new
+    ledger's nodes are left to Ledger::storeDeferredWrites.
+
     @param parent The ledger to apply transactions to
     @param closeTime The time the ledger closed
     @param closeTimeCorrect Whether consensus agreed on close time
@@ -69,6 +74,8 @@ buildLedger(
     @param applyFlags Flags to use when applying transactions
     @param app Handle to application instance
     @param j Journal to use for logging
+    @param onApplied If set, called after each transaction is applied with
+                     the time its apply took
     @return The newly built ledger
  */
 std::shared_ptr<Ledger>
@@ -76,7 +83,9 @@ buildLedger(
     LedgerReplay const& replayData,
     ApplyFlags applyFlags,
     Application& app,
-    beast::Journal j);
+    beast::Journal j,
+    std::function<void(STTx const&, std::chrono::steady_clock::duration)> const&
+        onApplied = {});
 
 }  // namespace ripple
 #endif
@@ -21,13 +21,16 @@
 #define RIPPLE_APP_LEDGER_INBOUNDLEDGER_H_INCLUDED
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/StateTransfer.h>
 #include <ripple/app/ledger/impl/TimeoutCounter.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/overlay/PeerSet.h>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -100,6 +103,13 @@ public:
         std::weak_ptr<Peer>,
         std::shared_ptr<protocol::TMLedgerData> const&);
 
+    /** Take a peer's reply to a request for a range of the ledger's
+        state. */
+    void
+    gotStateRange(
+        std::shared_ptr<Peer> const& peer,
+        protocol::TMStateRange const& reply);
+
     using neededHash_t =
         std::pair<protocol::TMGetObjectByHash::ObjectType, uint256>;
 
@@ -133,9 +143,30 @@ private:
     void
     trigger(std::shared_ptr<Peer> const&, TriggerReason);
 
+    /** Send a request for nodes to the peer, or to the set's peers. Nodes
+        asked of the whole set are split among its fastest peers. */
+    void
+    sendNodeRequest(
+        protocol::TMGetLedger& tmGL,
+        std::shared_ptr<Peer> const& peer);
+
     std::vector<neededHash_t>
     getNeededHashes();
 
+    /** Fetch the state as batches of leaves, if it may be. Returns false
+        if its nodes are fetched instead. Call with a lock. */
+    bool
+    transferState(std::shared_ptr<Peer> const& peer);
+
+    /** Ask the peers that can answer for the ranges of the state no peer
+        is asked for, the given peer first. Returns false if no peer can
+        answer and none is being waited on. Call with a lock. */
+    bool
+    requestStateRanges(std::shared_ptr<Peer> const& peer);
+
+    std::vector<std::shared_ptr<Peer>>
+    statePeers() const;
+
     void
     addPeers();
 
@@ -160,8 +191,21 @@ private:
     bool
     takeHeader(std::string const& data);
 
+    // A node from a TMLedgerData reply, decoded without holding the lock
+    struct DecodedNode
+    {
+        std::optional<SHAMapNodeID> id;
+        std::shared_ptr<SHAMapTreeNode> node;
+    };
+
+    std::vector<DecodedNode>
+    decodeNodes(protocol::TMLedgerData const& packet) const;
+
     void
-    receiveNode(protocol::TMLedgerData& packet, SHAMapAddNode&);
+    receiveNode(
+        protocol::TMLedgerData& packet,
+        std::vector<DecodedNode> const& nodes,
+        SHAMapAddNode&);
 
     bool
     takeTxRootNode(Slice const& data, SHAMapAddNode&);
@@ -196,6 +240,13 @@ private:
     std::vector<PeerDataPairType> mReceivedData;
     bool mReceiveDispatched;
     std::unique_ptr<PeerSet> mPeerSet;
+
+    // Set while the state is fetched as batches of leaves
+    std::unique_ptr<StateTransfer> mStateTransfer;
+    // Set while the rebuilt state is checked and stored, without the lock
+    bool mStateFinishing = false;
+    // Set once the state's nodes are fetched instead of its leaves
+    bool mFetchStateNodes = false;
 };
 
 /** Deserialize a ledger header from a byte array. */
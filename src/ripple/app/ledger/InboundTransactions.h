@@ -68,6 +68,28 @@ public:
         std::shared_ptr<Peer> peer,
         std::shared_ptr<protocol::TMLedgerData> message) = 0;
 
+    /** Answer a peer's request to reconcile a transaction set with its own.
+     *
+     * @param request The ReconcileTxSet message, with the sketch of the
+     * peer's set.
+     * @return The transactions the wanted set adds to the peer's and the
+     * IDs of those it removes, or an error if the sets can't be reconciled.
+     */
+    virtual protocol::TMReconcileTxSetResponse
+    processReconcileRequest(protocol::TMReconcileTxSet const& request) = 0;
+
+    /** Rebuild a transaction set from a ReconcileTxSetResponse message.
+     *
+     * @param setHash The transaction set ID (digest of the SHAMap root node).
+     * @param peer The peer that sent the message.
+     * @param message The ReconcileTxSetResponse message.
+     */
+    virtual void
+    gotReconcile(
+        uint256 const& setHash,
+        std::shared_ptr<Peer> peer,
+        std::shared_ptr<protocol::TMReconcileTxSetResponse> message) = 0;
+
     /** Add a transaction set.
      *
      * @param setHash The transaction set ID (should match set.getHash()).
@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_ISSUERBALANCES_H_INCLUDED
+#define RIPPLE_APP_LEDGER_ISSUERBALANCES_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/core/Stoppable.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/STAmount.h>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+
+/** Keeps the totals gateway_balances reports for the issuers asked about.
+
+    An issuer's trust lines are scanned once, at the first validated ledger
+    after it is asked about. From then on its totals follow the trust lines
+    that each validated ledger changes, so gateway_balances for that ledger
+    is answered without visiting the issuer's owner directory.
+
+    The totals are scanned afresh when intervening ledgers are missing, and
+    every so often regardless, so that rounding in the running sums can't
+    build up. Issuers no longer asked about are dropped.
+*/
+class IssuerBalances : public Stoppable
+{
+public:
+    IssuerBalances(Application& app, Stoppable& parent);
+
+    /** Copy the totals of an issuer as of a ledger.
+
+        Every call marks the issuer as wanted, so its totals are kept from
+        the next validated ledger on.
+
+        @return false if the totals of this issuer aren't known for this
+                ledger, in which case the caller scans its trust lines.
+    */
+    bool
+    getTotals(
+        ReadView const& ledger,
+        AccountID const& issuer,
+        std::map<Currency, STAmount>& obligations,
+        std::map<AccountID, std::vector<STAmount>>& frozen,
+        std::map<AccountID, std::vector<STAmount>>& assets);
+
+    /** Bring the totals up to date with a validated ledger. */
+    void
+    setup(std::shared_ptr<ReadView const> const& ledger);
+
+private:
+    using PeerCurrency = std::pair<AccountID, Currency>;
+
+    struct Totals
+    {
+        // The sum owed in each currency, and the number of lines owed it
+        std::map<Currency, std::pair<STAmount, std::size_t>> obligations;
+        std::map<PeerCurrency, STAmount> frozen;
+        std::map<PeerCurrency, STAmount> assets;
+
+        // The ledger the trust lines were last scanned at
+        std::uint32_t scanned = 0;
+    };
+
+    using TotalsMap = hash_map<AccountID, Totals>;
+
+    // Add or remove what a trust line contributes to an issuer's totals
+    static void
+    apply(
+        Totals& totals,
+        AccountID const& issuer,
+        std::shared_ptr<SLE const> const& sle,
+        bool add);
+
+    Totals
+    scan(ReadView const& ledger, AccountID const& issuer);
+
+    // Bring the totals up to mTarget, then to any newer target
+    void
+    advance();
+
+    // Move the totals from one ledger to the next, returning false if any
+    // of the transactions in between lacks metadata
+    bool
+    applyDelta(ReadView const& before, ReadView const& after, TotalsMap& next);
+
+    Application& app_;
+
+    std::mutex mLock;
+
+    // The totals, exact for mLedger
+    TotalsMap mTotals;
+    std::shared_ptr<ReadView const> mLedger;
+
+    // The newest validated ledger, and whether advance is running
+    std::shared_ptr<ReadView const> mTarget;
+    bool mAdvancing = false;
+
+    // The ledger each issuer was last asked about at
+    hash_map<AccountID, std::uint32_t> mRequested;
+
+    beast::Journal const j_;
+};
+
+}  // namespace ripple
+
+#endif
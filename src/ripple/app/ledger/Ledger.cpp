@@ -25,13 +25,16 @@
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
 #include <ripple/app/ledger/TransactionMaster.h>
+#include <ripple/app/ledger/TxIndex.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/TxPartitions.h>
 #include <ripple/app/reporting/DBHelpers.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/contract.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/consensus/LedgerTiming.h>
@@ -50,8 +53,11 @@
 #include <ripple/protocol/UintTypes.h>
 #include <ripple/protocol/digest.h>
 #include <ripple/protocol/jss.h>
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/optional.hpp>
+#include <algorithm>
 #include <cassert>
+#include <map>
 #include <utility>
 #include <vector>
 
@@ -60,6 +66,7 @@
 namespace ripple {
 
 create_genesis_t const create_genesis{};
+open_lazily_t const open_lazily{};
 
 uint256
 calculateLedgerHash(LedgerInfo const& info)
@@ -119,7 +126,7 @@ public:
     sles_type::value_type
     dereference() const override
     {
-        auto const item = *iter_;
+        auto const& item = *iter_;
         SerialIter sit(item.slice());
         return std::make_shared<SLE const>(sit, item.key());
     }
@@ -168,7 +175,7 @@ public:
     txs_type::value_type
     dereference() const override
     {
-        auto const item = *iter_;
+        auto const& item = *iter_;
         if (metadata_)
             return deserializeTxPlusMeta(item);
         return {deserializeTx(item), nullptr};
@@ -270,15 +277,38 @@ Ledger::Ledger(
     }
 }
 
+Ledger::Ledger(
+    open_lazily_t,
+    LedgerInfo const& info,
+    bool acquire,
+    Config const& config,
+    Family& family)
+    : mImmutable(true)
+    , lazy_(std::make_unique<Lazy>(config, acquire))
+    , txMap_(std::make_shared<SHAMap>(
+          SHAMapType::TRANSACTION,
+          info.txHash,
+          family))
+    , stateMap_(
+          std::make_shared<SHAMap>(SHAMapType::STATE, info.accountHash, family))
+    , rules_(config.features)
+    , info_(info)
+{
+    info_.hash = calculateLedgerHash(info_);
+    txMap_->setImmutable();
+    stateMap_->setImmutable();
+}
+
 // Create a new ledger that follows this one
 Ledger::Ledger(Ledger const& prevLedger, NetClock::time_point closeTime)
     : mImmutable(false)
     , txMap_(std::make_shared<SHAMap>(
           SHAMapType::TRANSACTION,
-          prevLedger.stateMap_->family()))
-    , stateMap_(prevLedger.stateMap_->snapShot(true))
-    , fees_(prevLedger.fees_)
-    , rules_(prevLedger.rules_)
+          prevLedger.stateMap_->family(),
+          std::make_shared<SHAMapNodeArena>()))
+    , stateMap_(prevLedger.stateMap().snapShot(true))
+    , fees_(prevLedger.fees())
+    , rules_(prevLedger.rules())
 {
     info_.seq = prevLedger.info_.seq + 1;
     info_.parentCloseTime = prevLedger.info_.closeTime;
@@ -349,7 +379,10 @@ Ledger::setImmutable(Config const& config, bool rehash)
     mImmutable = true;
     txMap_->setImmutable();
     stateMap_->setImmutable();
-    setup(config);
+
+    // A ledger opened lazily reads its fees and rules on first use
+    if (!lazy_)
+        setup(config);
 }
 
 void
@@ -371,8 +404,9 @@ Ledger::setAccepted(
 bool
 Ledger::addSLE(SLE const& sle)
 {
-    SHAMapItem item(sle.key(), sle.getSerializer());
-    return stateMap_->addItem(SHAMapNodeType::tnACCOUNT_STATE, std::move(item));
+    auto const s = sle.getSerializer();
+    return stateMap_->addItem(
+        SHAMapNodeType::tnACCOUNT_STATE, make_shamapitem(sle.key(), s.slice()));
 }
 
 //------------------------------------------------------------------------------
@@ -406,6 +440,7 @@ deserializeTxPlusMeta(SHAMapItem const& item)
 bool
 Ledger::exists(Keylet const& k) const
 {
+    bindStateMap();
     // VFALCO NOTE Perhaps check the type for debug builds?
     return stateMap_->hasItem(k.key);
 }
@@ -413,12 +448,14 @@ Ledger::exists(Keylet const& k) const
 bool
 Ledger::exists(uint256 const& key) const
 {
+    bindStateMap();
     return stateMap_->hasItem(key);
 }
 
 boost::optional<uint256>
 Ledger::succ(uint256 const& key, boost::optional<uint256> const& last) const
 {
+    bindStateMap();
     auto item = stateMap_->upper_bound(key);
     if (item == stateMap_->end())
         return boost::none;
@@ -435,6 +472,7 @@ Ledger::read(Keylet const& k) const
         assert(false);
         return nullptr;
     }
+    bindStateMap();
     auto const& item = stateMap_->peekItem(k.key);
     if (!item)
         return nullptr;
@@ -450,12 +488,16 @@ Ledger::read(Keylet const& k) const
 auto
 Ledger::slesBegin() const -> std::unique_ptr<sles_type::iter_base>
 {
-    return std::make_unique<sles_iter_impl>(stateMap_->begin());
+    bindStateMap();
+    // Iterating state items is a range scan, so read ahead of it
+    return std::make_unique<sles_iter_impl>(
+        stateMap_->begin(stateMap_->family().db().scanReadAhead()));
 }
 
 auto
 Ledger::slesEnd() const -> std::unique_ptr<sles_type::iter_base>
 {
+    bindStateMap();
     return std::make_unique<sles_iter_impl>(stateMap_->end());
 }
 
@@ -463,24 +505,29 @@ auto
 Ledger::slesUpperBound(uint256 const& key) const
     -> std::unique_ptr<sles_type::iter_base>
 {
-    return std::make_unique<sles_iter_impl>(stateMap_->upper_bound(key));
+    bindStateMap();
+    return std::make_unique<sles_iter_impl>(stateMap_->upper_bound(
+        key, stateMap_->family().db().scanReadAhead()));
 }
 
 auto
 Ledger::txsBegin() const -> std::unique_ptr<txs_type::iter_base>
 {
+    bindTxMap();
     return std::make_unique<txs_iter_impl>(!open(), txMap_->begin());
 }
 
 auto
 Ledger::txsEnd() const -> std::unique_ptr<txs_type::iter_base>
 {
+    bindTxMap();
     return std::make_unique<txs_iter_impl>(!open(), txMap_->end());
 }
 
 bool
 Ledger::txExists(uint256 const& key) const
 {
+    bindTxMap();
     return txMap_->hasItem(key);
 }
 
@@ -488,6 +535,7 @@ auto
 Ledger::txRead(key_type const& key) const -> tx_type
 {
     assert(txMap_);
+    bindTxMap();
     auto const& item = txMap_->peekItem(key);
     if (!item)
         return {};
@@ -502,6 +550,7 @@ Ledger::txRead(key_type const& key) const -> tx_type
 auto
 Ledger::digest(key_type const& key) const -> boost::optional<digest_type>
 {
+    bindStateMap();
     SHAMapHash digest;
     // VFALCO Unfortunately this loads the item
     //        from the NodeStore needlessly.
@@ -533,7 +582,7 @@ Ledger::rawInsert(std::shared_ptr<SLE> const& sle)
     sle->add(ss);
     if (!stateMap_->addGiveItem(
             SHAMapNodeType::tnACCOUNT_STATE,
-            std::make_shared<SHAMapItem const>(sle->key(), std::move(ss))))
+            make_shamapitem(sle->key(), ss.slice())))
         LogicError("Ledger::rawInsert: key already exists");
 }
 
@@ -544,7 +593,7 @@ Ledger::rawReplace(std::shared_ptr<SLE> const& sle)
     sle->add(ss);
     if (!stateMap_->updateGiveItem(
             SHAMapNodeType::tnACCOUNT_STATE,
-            std::make_shared<SHAMapItem const>(sle->key(), std::move(ss))))
+            make_shamapitem(sle->key(), ss.slice())))
         LogicError("Ledger::rawReplace: key not found");
 }
 
@@ -562,7 +611,7 @@ Ledger::rawTxInsert(
     s.addVL(metaData->peekData());
     if (!txMap().addGiveItem(
             SHAMapNodeType::tnTRANSACTION_MD,
-            std::make_shared<SHAMapItem const>(key, std::move(s))))
+            make_shamapitem(key, s.slice())))
         LogicError("duplicate_tx: " + to_string(key));
 }
 
@@ -578,9 +627,8 @@ Ledger::rawTxInsertWithHash(
     Serializer s(txn->getDataLength() + metaData->getDataLength() + 16);
     s.addVL(txn->peekData());
     s.addVL(metaData->peekData());
-    auto item = std::make_shared<SHAMapItem const>(key, std::move(s));
-    auto hash = sha512Half(
-        HashPrefix::txNode, makeSlice(item->peekData()), item->key());
+    auto item = make_shamapitem(key, s.slice());
+    auto hash = sha512Half(HashPrefix::txNode, item->slice(), item->key());
     if (!txMap().addGiveItem(SHAMapNodeType::tnTRANSACTION_MD, std::move(item)))
         LogicError("duplicate_tx: " + to_string(key));
 
@@ -641,9 +689,66 @@ Ledger::setup(Config const& config)
     return ret;
 }
 
+bool
+Ledger::fetchLazily(
+    SHAMap& map,
+    uint256 const& root,
+    std::atomic<bool>& bound) const
+{
+    std::lock_guard lock(lazy_->mutex);
+    if (bound.load(std::memory_order_relaxed))
+        return true;
+
+    if (!map.fetchRoot(SHAMapHash{root}, nullptr))
+    {
+        if (lazy_->config.reporting())
+        {
+            // Reporting should never have incomplete data
+            Throw<std::runtime_error>("Missing map root for ledger");
+        }
+        if (lazy_->acquire)
+            map.family().missingNode(info_.hash, info_.seq);
+        return false;
+    }
+
+    bound.store(true, std::memory_order_release);
+    return true;
+}
+
+void
+Ledger::bindLazily(
+    SHAMap& map,
+    uint256 const& root,
+    std::atomic<bool>& bound) const
+{
+    if (!fetchLazily(map, root, bound))
+        Throw<SHAMapMissingNode>(
+            &map == txMap_.get() ? SHAMapType::TRANSACTION : SHAMapType::STATE,
+            SHAMapHash{root});
+}
+
+void
+Ledger::setUpNow() const
+{
+    bindStateMap();
+
+    std::lock_guard lock(lazy_->mutex);
+    if (lazy_->setUp.load(std::memory_order_relaxed))
+        return;
+
+    // Readers of the fees and rules wait here until they are set, so
+    // setting them is no different than doing so on construction.
+    if (!const_cast<Ledger*>(this)->setup(lazy_->config))
+        Throw<SHAMapMissingNode>(
+            SHAMapType::STATE, SHAMapHash{info_.accountHash});
+
+    lazy_->setUp.store(true, std::memory_order_release);
+}
+
 std::shared_ptr<SLE>
 Ledger::peek(Keylet const& k) const
 {
+    bindStateMap();
     auto const& value = stateMap_->peekItem(k.key);
     if (!value)
         return nullptr;
@@ -762,20 +867,21 @@ Ledger::updateNegativeUNL()
 
 //------------------------------------------------------------------------------
 bool
-Ledger::walkLedger(beast::Journal j) const
+Ledger::walkLedger(beast::Journal j, std::size_t nodesPerSecond) const
 {
     std::vector<SHAMapMissingNode> missingNodes1;
     std::vector<SHAMapMissingNode> missingNodes2;
 
-    if (stateMap_->getHash().isZero() && !info_.accountHash.isZero() &&
-        !stateMap_->fetchRoot(SHAMapHash{info_.accountHash}, nullptr))
+    if (lazy_ ? !fetchLazily(*stateMap_, info_.accountHash, lazy_->stateBound)
+              : stateMap_->getHash().isZero() && !info_.accountHash.isZero() &&
+                !stateMap_->fetchRoot(SHAMapHash{info_.accountHash}, nullptr))
     {
         missingNodes1.emplace_back(
             SHAMapType::STATE, SHAMapHash{info_.accountHash});
     }
     else
     {
-        stateMap_->walkMap(missingNodes1, 32);
+        stateMap_->walkMap(missingNodes1, 32, nodesPerSecond);
     }
 
     if (!missingNodes1.empty())
@@ -787,15 +893,16 @@ Ledger::walkLedger(beast::Journal j) const
         }
     }
 
-    if (txMap_->getHash().isZero() && info_.txHash.isNonZero() &&
-        !txMap_->fetchRoot(SHAMapHash{info_.txHash}, nullptr))
+    if (lazy_ ? !fetchLazily(*txMap_, info_.txHash, lazy_->txBound)
+              : txMap_->getHash().isZero() && info_.txHash.isNonZero() &&
+                !txMap_->fetchRoot(SHAMapHash{info_.txHash}, nullptr))
     {
         missingNodes2.emplace_back(
             SHAMapType::TRANSACTION, SHAMapHash{info_.txHash});
     }
     else
     {
-        txMap_->walkMap(missingNodes2, 32);
+        txMap_->walkMap(missingNodes2, 32, nodesPerSecond);
     }
 
     if (!missingNodes2.empty())
@@ -812,6 +919,9 @@ Ledger::walkLedger(beast::Journal j) const
 bool
 Ledger::assertSensible(beast::Journal ledgerJ) const
 {
+    bindStateMap();
+    bindTxMap();
+
     if (info_.hash.isNonZero() && info_.accountHash.isNonZero() && stateMap_ &&
         txMap_ && (info_.accountHash == stateMap_->getHash().as_uint256()) &&
         (info_.txHash == txMap_->getHash().as_uint256()))
@@ -914,11 +1024,86 @@ isFlagLedger(LedgerIndex seq)
     return seq % FLAG_LEDGER_INTERVAL == 0;
 }
 
+// A validated ledger whose transactions are ready to be written to SQL
+struct LedgerToSave
+{
+    std::shared_ptr<Ledger const> ledger;
+    AcceptedLedger::pointer aLedger;
+};
+
+// The most ledgers written to SQL by one batch
+static constexpr std::size_t saveBatchLimit = 16;
+
+// Statements built from many rows are flushed once they reach this many
+// rows or bytes. SQLite accepts at most 500 rows in one VALUES clause, and
+// statements of at most a million bytes by default.
+static constexpr std::size_t sqlRowLimit = 500;
+static constexpr std::size_t sqlByteLimit = 256 * 1024;
+
+/** Builds statements of the form `<head> <row>, <row>, ...;`
+
+    Rows are accumulated and the statement is run whenever it grows past
+    the row or byte limits, so the cost of each statement is spread over
+    many rows. Call flush() to run the rows that remain.
+*/
+class MultiRowStatement
+{
+    soci::session& session_;
+    std::string const& head_;
+    std::string const tail_;
+    std::string sql_;
+    std::size_t rows_ = 0;
+
+public:
+    MultiRowStatement(
+        soci::session& session,
+        std::string const& head,
+        std::string tail = ";")
+        : session_(session), head_(head), tail_(std::move(tail))
+    {
+    }
+
+    void
+    add(std::string const& row)
+    {
+        if (rows_ == 0)
+        {
+            sql_ = head_;
+            sql_.reserve(std::min(head_.size() + row.size(), sqlByteLimit));
+        }
+        else
+        {
+            sql_ += ", ";
+        }
+        sql_ += row;
+
+        if (++rows_ >= sqlRowLimit || sql_.size() >= sqlByteLimit)
+            flush();
+    }
+
+    void
+    flush()
+    {
+        if (rows_ == 0)
+            return;
+        sql_ += tail_;
+        session_ << sql_;
+        rows_ = 0;
+    }
+};
+
+/** Check a validated ledger and gather what is needed to save it.
+
+    This stores the ledger header in the node store and builds the
+    accepted ledger. Leaves `save` empty if another thread saved the
+    ledger, and returns `false` if it could not be gathered.
+*/
 static bool
-saveValidatedLedger(
+prepareSave(
     Application& app,
     std::shared_ptr<Ledger const> const& ledger,
-    bool current)
+    bool current,
+    LedgerToSave& save)
 {
     auto j = app.journal("Ledger");
     auto seq = ledger->info().seq;
@@ -929,6 +1114,9 @@ saveValidatedLedger(
         return true;
     }
 
+    // The ledger database must not refer to nodes that are not yet stored
+    ledger->storeDeferredWrites();
+
     // TODO(tom): Fix this hard-coded SQL!
     JLOG(j.trace()) << "saveValidatedLedger " << (current ? "" : "fromAcquire ")
                     << seq;
@@ -959,6 +1147,21 @@ saveValidatedLedger(
             hotLEDGER, std::move(s.modData()), ledger->info().hash, seq);
     }
 
+    if (app.config().txIndex())
+    {
+        try
+        {
+            for (auto& [key, data] : makeTxIndex(*ledger))
+                app.getNodeStore().store(
+                    hotTX_INDEX, std::move(data), key, seq);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j.warn()) << "Unable to index the transactions of ledger "
+                           << seq << ": " << e.what();
+        }
+    }
+
     AcceptedLedger::pointer aLedger;
     try
     {
@@ -980,147 +1183,272 @@ saveValidatedLedger(
         return false;
     }
 
-    if (!app.config().reporting())
-    {
-        static boost::format deleteLedger(
-            "DELETE FROM Ledgers WHERE LedgerSeq = %u;");
-        static boost::format deleteTrans1(
-            "DELETE FROM Transactions WHERE LedgerSeq = %u;");
-        static boost::format deleteTrans2(
-            "DELETE FROM AccountTransactions WHERE LedgerSeq = %u;");
-        static boost::format deleteAcctTrans(
-            "DELETE FROM AccountTransactions WHERE TransID = '%s';");
+    save.ledger = ledger;
+    save.aLedger = std::move(aLedger);
+    return true;
+}
 
-        {
-            auto db = app.getLedgerDB().checkoutDb();
-            *db << boost::str(deleteLedger % seq);
-        }
+/** Write prepared ledgers to the SQL databases.
 
-        if (app.config().useTxTables())
-        {
-            auto db = app.getTxnDB().checkoutDb();
+    All of the ledgers are written in one transaction on each database,
+    with rows of the same kind combined into as few statements as the
+    limits allow.
+*/
+static void
+writeSaves(Application& app, std::vector<LedgerToSave> const& saves)
+{
+    auto j = app.journal("Ledger");
 
-            soci::transaction tr(*db);
+    if (app.config().reporting())
+    {
+        assert(false);
+        return;
+    }
 
-            *db << boost::str(deleteTrans1 % seq);
-            *db << boost::str(deleteTrans2 % seq);
+    // A batch is traced as the save of its newest ledger
+    perf::Tracer::Span span(
+        app.getTracer(),
+        "saveValidated",
+        "ledger",
+        saves.back().ledger->info().seq);
 
-            std::string const ledgerSeq(std::to_string(seq));
+    std::string seqs;
+    for (auto const& save : saves)
+    {
+        if (!seqs.empty())
+            seqs += ",";
+        seqs += std::to_string(save.ledger->info().seq);
+    }
 
-            for (auto const& [_, acceptedLedgerTx] : aLedger->getMap())
-            {
-                (void)_;
-                uint256 transactionID = acceptedLedgerTx->getTransactionID();
+    {
+        auto db = app.getLedgerDB().checkoutDb();
+        *db << "DELETE FROM Ledgers WHERE LedgerSeq IN (" + seqs + ");";
+    }
 
-                std::string const txnId(to_string(transactionID));
-                std::string const txnSeq(
-                    std::to_string(acceptedLedgerTx->getTxnSeq()));
+    if (app.config().useTxTables())
+    {
+        auto db = app.getTxnDB().checkoutDb();
 
-                *db << boost::str(deleteAcctTrans % transactionID);
+        // Each ledger goes to the partition holding its range, which may
+        // have to be created first. That cannot be done in a transaction.
+        auto& partitions = app.getTxPartitions();
+        std::map<std::string, std::vector<LedgerToSave const*>> bySchema;
+        for (auto const& save : saves)
+            bySchema[partitions.schemaFor(save.ledger->info().seq)].push_back(
+                &save);
+
+        soci::transaction tr(*db);
+
+        // A ledger saved again, or a transaction seen in another ledger
+        // earlier, may have rows in any partition.
+        for (auto const& schema : partitions.schemas())
+        {
+            *db << "DELETE FROM " + schema +
+                    ".Transactions WHERE LedgerSeq IN (" + seqs + ");";
+            *db << "DELETE FROM " + schema +
+                    ".AccountTransactions WHERE LedgerSeq IN (" + seqs + ");";
+
+            // Rows from earlier saves of these transactions in other ledgers
+            // must be removed before any rows are added.
+            std::string const deleteAcctTrans(
+                "DELETE FROM " + schema +
+                ".AccountTransactions WHERE TransID IN (");
+            MultiRowStatement deletes(*db, deleteAcctTrans, ");");
+            for (auto const& save : saves)
+            {
+                for (auto const& [_, acceptedLedgerTx] : save.aLedger->getMap())
+                {
+                    (void)_;
+                    deletes.add(
+                        "'" + to_string(acceptedLedgerTx->getTransactionID()) +
+                        "'");
+                }
+            }
+            deletes.flush();
+        }
 
-                auto const& accts = acceptedLedgerTx->getAffected();
+        for (auto const& [schema, schemaSaves] : bySchema)
+        {
+            std::string const insertAcctTrans(
+                "INSERT INTO " + schema +
+                ".AccountTransactions "
+                "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
+            std::string const insertTrans(boost::replace_first_copy(
+                STTx::getMetaSQLInsertReplaceHeader(),
+                "INTO Transactions",
+                "INTO " + schema + ".Transactions"));
+            MultiRowStatement accounts(*db, insertAcctTrans);
+            MultiRowStatement transactions(*db, insertTrans);
+
+            for (auto const save : schemaSaves)
+            {
+                auto const seq = save->ledger->info().seq;
+                std::string const ledgerSeq(std::to_string(seq));
 
-                if (!accts.empty())
+                for (auto const& [_, acceptedLedgerTx] :
+                     save->aLedger->getMap())
                 {
-                    std::string sql(
-                        "INSERT INTO AccountTransactions "
-                        "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
+                    (void)_;
+                    std::string const txnId(
+                        to_string(acceptedLedgerTx->getTransactionID()));
+                    std::string const txnSeq(
+                        std::to_string(acceptedLedgerTx->getTxnSeq()));
 
-                    // Try to make an educated guess on how much space we'll
-                    // need for our arguments. In argument order we have: 64
-                    // + 34 + 10 + 10 = 118 + 10 extra = 128 bytes
-                    sql.reserve(sql.length() + (accts.size() * 128));
+                    auto const& accts = acceptedLedgerTx->getAffected();
+
+                    if (accts.empty())
+                    {
+                        JLOG(j.warn()) << "Transaction in ledger " << seq
+                                       << " affects no accounts";
+                        JLOG(j.warn()) << acceptedLedgerTx->getTxn()->getJson(
+                            JsonOptions::none);
+                    }
 
-                    bool first = true;
                     for (auto const& account : accts)
                     {
-                        if (!first)
-                            sql += ", ('";
-                        else
-                        {
-                            sql += "('";
-                            first = false;
-                        }
-
-                        sql += txnId;
-                        sql += "','";
-                        sql += app.accountIDCache().toBase58(account);
-                        sql += "',";
-                        sql += ledgerSeq;
-                        sql += ",";
-                        sql += txnSeq;
-                        sql += ")";
+                        accounts.add(
+                            "('" + txnId + "','" +
+                            app.accountIDCache().toBase58(account) + "'," +
+                            ledgerSeq + "," + txnSeq + ")");
                     }
-                    sql += ";";
-                    JLOG(j.trace()) << "ActTx: " << sql;
-                    *db << sql;
-                }
-                else
-                {
-                    JLOG(j.warn()) << "Transaction in ledger " << seq
-                                   << " affects no accounts";
-                    JLOG(j.warn()) << acceptedLedgerTx->getTxn()->getJson(
-                        JsonOptions::none);
+
+                    transactions.add(acceptedLedgerTx->getTxn()->getMetaSQL(
+                        seq, acceptedLedgerTx->getEscMeta()));
                 }
+            }
+            accounts.flush();
+            transactions.flush();
+        }
 
-                *db
-                    << (STTx::getMetaSQLInsertReplaceHeader() +
-                        acceptedLedgerTx->getTxn()->getMetaSQL(
-                            seq, acceptedLedgerTx->getEscMeta()) +
-                        ";");
+        tr.commit();
 
-                app.getMasterTransaction().inLedger(transactionID, seq);
+        for (auto const& save : saves)
+        {
+            auto const seq = save.ledger->info().seq;
+            for (auto const& [_, acceptedLedgerTx] : save.aLedger->getMap())
+            {
+                (void)_;
+                app.getMasterTransaction().inLedger(
+                    acceptedLedgerTx->getTransactionID(), seq);
             }
-
-            tr.commit();
         }
+    }
 
-        {
-            static std::string addLedger(
-                R"sql(INSERT OR REPLACE INTO Ledgers
+    {
+        static std::string addLedger(
+            R"sql(INSERT OR REPLACE INTO Ledgers
                 (LedgerHash,LedgerSeq,PrevHash,TotalCoins,ClosingTime,PrevClosingTime,
                 CloseTimeRes,CloseFlags,AccountSetHash,TransSetHash)
             VALUES
                 (:ledgerHash,:ledgerSeq,:prevHash,:totalCoins,:closingTime,:prevClosingTime,
                 :closeTimeRes,:closeFlags,:accountSetHash,:transSetHash);)sql");
 
-            auto db(app.getLedgerDB().checkoutDb());
-
-            soci::transaction tr(*db);
-
-            auto const hash = to_string(ledger->info().hash);
-            auto const parentHash = to_string(ledger->info().parentHash);
-            auto const drops = to_string(ledger->info().drops);
-            auto const closeTime =
-                ledger->info().closeTime.time_since_epoch().count();
-            auto const parentCloseTime =
-                ledger->info().parentCloseTime.time_since_epoch().count();
-            auto const closeTimeResolution =
-                ledger->info().closeTimeResolution.count();
-            auto const closeFlags = ledger->info().closeFlags;
-            auto const accountHash = to_string(ledger->info().accountHash);
-            auto const txHash = to_string(ledger->info().txHash);
-
-            *db << addLedger, soci::use(hash), soci::use(seq),
-                soci::use(parentHash), soci::use(drops), soci::use(closeTime),
-                soci::use(parentCloseTime), soci::use(closeTimeResolution),
-                soci::use(closeFlags), soci::use(accountHash),
-                soci::use(txHash);
-
-            tr.commit();
+        auto db(app.getLedgerDB().checkoutDb());
+
+        soci::transaction tr(*db);
+
+        std::string hash;
+        LedgerIndex seq;
+        std::string parentHash;
+        std::string drops;
+        NetClock::rep closeTime;
+        NetClock::rep parentCloseTime;
+        NetClock::rep closeTimeResolution;
+        int closeFlags;
+        std::string accountHash;
+        std::string txHash;
+
+        // Prepared once and run for each ledger
+        soci::statement st =
+            (db->prepare << addLedger,
+             soci::use(hash),
+             soci::use(seq),
+             soci::use(parentHash),
+             soci::use(drops),
+             soci::use(closeTime),
+             soci::use(parentCloseTime),
+             soci::use(closeTimeResolution),
+             soci::use(closeFlags),
+             soci::use(accountHash),
+             soci::use(txHash));
+
+        for (auto const& save : saves)
+        {
+            auto const& info = save.ledger->info();
+            hash = to_string(info.hash);
+            seq = info.seq;
+            parentHash = to_string(info.parentHash);
+            drops = to_string(info.drops);
+            closeTime = info.closeTime.time_since_epoch().count();
+            parentCloseTime = info.parentCloseTime.time_since_epoch().count();
+            closeTimeResolution = info.closeTimeResolution.count();
+            closeFlags = info.closeFlags;
+            accountHash = to_string(info.accountHash);
+            txHash = to_string(info.txHash);
+            st.execute(true);
         }
+
+        tr.commit();
     }
-    else
-    {
-        assert(false);
-    }
+}
+
+static bool
+saveValidatedLedger(
+    Application& app,
+    std::shared_ptr<Ledger const> const& ledger,
+    bool current)
+{
+    std::vector<LedgerToSave> saves(1);
+    if (!prepareSave(app, ledger, current, saves.front()))
+        return false;
+
+    if (!saves.front().ledger)
+        return true;
+
+    writeSaves(app, saves);
 
     // Clients can now trust the database for
     // information about this ledger sequence.
-    app.pendingSaves().finishWork(seq);
+    app.pendingSaves().finishWork(ledger->info().seq);
     return true;
 }
 
+/** Save the ledgers in the queue, a batch at a time, until it is empty. */
+static void
+drainSaveQueue(Application& app)
+{
+    auto j = app.journal("Ledger");
+
+    while (true)
+    {
+        auto const ledgers = app.pendingSaves().takeBatch(saveBatchLimit);
+        if (ledgers.empty())
+            return;
+
+        std::vector<LedgerToSave> saves;
+        saves.reserve(ledgers.size());
+        for (auto const& ledger : ledgers)
+        {
+            LedgerToSave save;
+            if (prepareSave(app, ledger, true, save) && save.ledger)
+                saves.push_back(std::move(save));
+        }
+
+        if (saves.empty())
+            continue;
+
+        JLOG(j.debug()) << "Saving " << saves.size() << " ledgers from "
+                        << saves.front().ledger->info().seq;
+
+        writeSaves(app, saves);
+
+        // Clients can now trust the database for
+        // information about these ledger sequences.
+        for (auto const& save : saves)
+            app.pendingSaves().finishWork(save.ledger->info().seq);
+    }
+}
+
 /** Save, or arrange to save, a fully-validated ledger
     Returns false on error
 */
@@ -1156,34 +1484,67 @@ pendSaveValidated(
         return true;
     }
 
-    JobType const jobType{isCurrent ? jtPUBLEDGER : jtPUBOLDLEDGER};
-    char const* const jobName{
-        isCurrent ? "Ledger::pendSave" : "Ledger::pendOldSave"};
-
-    // See if we can use the JobQueue.
-    if (!isSynchronous &&
-        app.getJobQueue().addJob(
-            jobType, jobName, [&app, ledger, isCurrent](Job&) {
-                saveValidatedLedger(app, ledger, isCurrent);
-            }))
+    if (!isSynchronous)
     {
-        return true;
+        // Asynchronous saves go through the queue, so that ledgers which
+        // arrive together are written together.
+        bool dispatch = false;
+        if (app.pendingSaves().enqueue(ledger, dispatch))
+        {
+            if (!dispatch)
+                return true;
+
+            JobType const jobType{isCurrent ? jtPUBLEDGER : jtPUBOLDLEDGER};
+            char const* const jobName{
+                isCurrent ? "Ledger::pendSave" : "Ledger::pendOldSave"};
+
+            if (app.getJobQueue().addJob(
+                    jobType, jobName, [&app](Job&) { drainSaveQueue(app); }))
+            {
+                return true;
+            }
+
+            // The JobQueue won't do the Job. Drain the queue here.
+            drainSaveQueue(app);
+            return true;
+        }
+
+        // The queue is full. Do the save synchronously, which slows the
+        // caller down until the queue has room.
+        JLOG(app.journal("Ledger").debug())
+            << "Save queue full for " << ledger->info().seq;
     }
 
-    // The JobQueue won't do the Job.  Do the save synchronously.
     return saveValidatedLedger(app, ledger, isCurrent);
 }
 
 void
 Ledger::unshare() const
 {
+    bindStateMap();
+    bindTxMap();
     stateMap_->unshare();
     txMap_->unshare();
 }
 
+void
+Ledger::setDeferredWrites(std::shared_ptr<SHAMapDeferredWrites> writes)
+{
+    deferredWrites_ = std::move(writes);
+}
+
+void
+Ledger::storeDeferredWrites() const
+{
+    if (deferredWrites_)
+        deferredWrites_->store(stateMap_->family().db());
+}
+
 void
 Ledger::invariants() const
 {
+    bindStateMap();
+    bindTxMap();
     stateMap_->invariants();
     txMap_->invariants();
 }
@@ -1203,7 +1564,7 @@ loadLedgerHelper(std::string const& sqlSuffix, Application& app, bool acquire)
     uint256 ledgerHash{};
     std::uint32_t ledgerSeq{0};
 
-    auto db = app.getLedgerDB().checkoutDb();
+    auto db = app.getLedgerDB().checkoutReadDb();
 
     boost::optional<std::string> sLedgerHash, sPrevHash, sAccountHash,
         sTransHash;
@@ -1617,7 +1978,7 @@ getHashByIndex(std::uint32_t ledgerIndex, Application& app)
 
     std::string hash;
     {
-        auto db = app.getLedgerDB().checkoutDb();
+        auto db = app.getLedgerDB().checkoutReadDb();
 
         boost::optional<std::string> lh;
         *db << sql, soci::into(lh);
@@ -1644,7 +2005,7 @@ getHashesByIndex(
     if (app.config().reporting())
         return getHashesByIndexPostgres(
             ledgerIndex, ledgerHash, parentHash, app);
-    auto db = app.getLedgerDB().checkoutDb();
+    auto db = app.getLedgerDB().checkoutReadDb();
 
     boost::optional<std::string> lhO, phO;
 
@@ -1676,7 +2037,7 @@ getHashesByIndex(std::uint32_t minSeq, std::uint32_t maxSeq, Application& app)
     sql.append(std::to_string(maxSeq));
     sql.append(";");
 
-    auto db = app.getLedgerDB().checkoutDb();
+    auto db = app.getLedgerDB().checkoutReadDb();
 
     std::uint64_t ls;
     std::string lh;
@@ -1704,6 +2065,69 @@ getHashesByIndex(std::uint32_t minSeq, std::uint32_t maxSeq, Application& app)
     return ret;
 }
 
+std::vector<LedgerInfo>
+loadLedgerInfos(std::uint32_t minSeq, std::uint32_t maxSeq, Application& app)
+{
+    if (app.config().reporting())
+        return loadLedgerInfosPostgres(std::make_pair(minSeq, maxSeq), app);
+
+    std::string sql =
+        "SELECT LedgerHash, PrevHash, AccountSetHash, TransSetHash, "
+        "TotalCoins, ClosingTime, PrevClosingTime, CloseTimeRes, CloseFlags, "
+        "LedgerSeq FROM Ledgers WHERE LedgerSeq >= ";
+    sql.append(std::to_string(minSeq));
+    sql.append(" AND LedgerSeq <= ");
+    sql.append(std::to_string(maxSeq));
+    sql.append(";");
+
+    auto db = app.getLedgerDB().checkoutReadDb();
+
+    boost::optional<std::string> sLedgerHash, sPrevHash, sAccountHash,
+        sTransHash;
+    boost::optional<std::uint64_t> totDrops, closingTime, prevClosingTime,
+        closeResolution, closeFlags, ledgerSeq64;
+    soci::statement st =
+        (db->prepare << sql,
+         soci::into(sLedgerHash),
+         soci::into(sPrevHash),
+         soci::into(sAccountHash),
+         soci::into(sTransHash),
+         soci::into(totDrops),
+         soci::into(closingTime),
+         soci::into(prevClosingTime),
+         soci::into(closeResolution),
+         soci::into(closeFlags),
+         soci::into(ledgerSeq64));
+
+    using time_point = NetClock::time_point;
+    using duration = NetClock::duration;
+
+    std::vector<LedgerInfo> infos;
+    st.execute();
+    while (st.fetch())
+    {
+        LedgerInfo info;
+        if (sLedgerHash)
+            (void)info.hash.parseHex(*sLedgerHash);
+        if (sPrevHash)
+            (void)info.parentHash.parseHex(*sPrevHash);
+        if (sAccountHash)
+            (void)info.accountHash.parseHex(*sAccountHash);
+        if (sTransHash)
+            (void)info.txHash.parseHex(*sTransHash);
+        info.drops = totDrops.value_or(0);
+        info.closeTime = time_point{duration{closingTime.value_or(0)}};
+        info.parentCloseTime =
+            time_point{duration{prevClosingTime.value_or(0)}};
+        info.closeFlags = closeFlags.value_or(0);
+        info.closeTimeResolution = duration{closeResolution.value_or(0)};
+        info.seq = rangeCheckedCast<std::uint32_t>(ledgerSeq64.value_or(0));
+        infos.push_back(info);
+    }
+
+    return infos;
+}
+
 std::vector<
     std::pair<std::shared_ptr<STTx const>, std::shared_ptr<STObject const>>>
 flatFetchTransactions(Application& app, std::vector<uint256>& nodestoreHashes)
@@ -1741,7 +2165,7 @@ flatFetchTransactions(Application& app, std::vector<uint256>& nodestoreHashes)
         if (obj)
         {
             auto node = SHAMapTreeNode::makeFromPrefix(
-                makeSlice(obj->getData()), SHAMapHash{nodestoreHash});
+                obj->getData(), SHAMapHash{nodestoreHash});
             if (!node)
             {
                 assert(false);
@@ -32,6 +32,8 @@
 #include <ripple/protocol/Serializer.h>
 #include <ripple/shamap/SHAMap.h>
 #include <boost/optional.hpp>
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 namespace ripple {
@@ -48,6 +50,12 @@ struct create_genesis_t
 };
 extern create_genesis_t const create_genesis;
 
+struct open_lazily_t
+{
+    explicit open_lazily_t() = default;
+};
+extern open_lazily_t const open_lazily;
+
 /** Holds a ledger.
 
     The ledger is composed of two SHAMaps. The state map holds all of the
@@ -118,6 +126,21 @@ public:
         Family& family,
         beast::Journal j);
 
+    /** Used for ledgers held in full, opened from their headers.
+
+        The maps are bound to their roots, and the fees and rules are read
+        from the state map, on first use, so that a ledger opened only for
+        its header is opened without reading the node store. Should a root
+        then be missing, the ledger is acquired if requested and
+        SHAMapMissingNode is thrown.
+    */
+    Ledger(
+        open_lazily_t,
+        LedgerInfo const& info,
+        bool acquire,
+        Config const& config,
+        Family& family);
+
     /** Create a new ledger following a previous ledger
 
         The ledger will have the sequence number that
@@ -160,12 +183,14 @@ public:
     Fees const&
     fees() const override
     {
+        setUpLazily();
         return fees_;
     }
 
     Rules const&
     rules() const override
     {
+        setUpLazily();
         return rules_;
     }
 
@@ -307,24 +332,28 @@ public:
     SHAMap const&
     stateMap() const
     {
+        bindStateMap();
         return *stateMap_;
     }
 
     SHAMap&
     stateMap()
     {
+        bindStateMap();
         return *stateMap_;
     }
 
     SHAMap const&
     txMap() const
     {
+        bindTxMap();
         return *txMap_;
     }
 
     SHAMap&
     txMap()
     {
+        bindTxMap();
         return *txMap_;
     }
 
@@ -337,8 +366,13 @@ public:
     void
     updateSkipList();
 
+    /** Walk both maps, logging any missing nodes.
+
+        @param nodesPerSecond Limit on the rate nodes are visited, or 0
+        @return true if no nodes were found missing
+    */
     bool
-    walkLedger(beast::Journal j) const;
+    walkLedger(beast::Journal j, std::size_t nodesPerSecond = 0) const;
 
     bool
     assertSensible(beast::Journal ledgerJ) const;
@@ -348,6 +382,21 @@ public:
     void
     unshare() const;
 
+    /** Attach the node writes that were put off when building this ledger.
+
+        Only the sole owner of a ledger that is being built may call this.
+    */
+    void
+    setDeferredWrites(std::shared_ptr<SHAMapDeferredWrites> writes);
+
+    /** Store the node writes that were put off when building this ledger.
+
+        Returns once they are all stored, waiting on a concurrent call if
+        need be. Does nothing if no writes were put off.
+    */
+    void
+    storeDeferredWrites() const;
+
     /**
      * get Negative UNL validators' master public keys
      *
@@ -398,11 +447,67 @@ private:
     bool
     setup(Config const& config);
 
+    // What a ledger opened lazily has yet to do
+    struct Lazy
+    {
+        Lazy(Config const& config_, bool acquire_)
+            : config(config_), acquire(acquire_)
+        {
+        }
+
+        Config const& config;
+        bool const acquire;
+        std::mutex mutex;
+        std::atomic<bool> txBound{false};
+        std::atomic<bool> stateBound{false};
+        std::atomic<bool> setUp{false};
+    };
+
+    void
+    bindTxMap() const
+    {
+        if (lazy_ && !lazy_->txBound.load(std::memory_order_acquire))
+            bindLazily(*txMap_, info_.txHash, lazy_->txBound);
+    }
+
+    void
+    bindStateMap() const
+    {
+        if (lazy_ && !lazy_->stateBound.load(std::memory_order_acquire))
+            bindLazily(*stateMap_, info_.accountHash, lazy_->stateBound);
+    }
+
+    // Bind a map to its root, reporting whether it could be found
+    bool
+    fetchLazily(SHAMap& map, uint256 const& root, std::atomic<bool>& bound)
+        const;
+
+    // Bind a map to its root, throwing if it could not be found
+    void
+    bindLazily(SHAMap& map, uint256 const& root, std::atomic<bool>& bound)
+        const;
+
+    void
+    setUpLazily() const
+    {
+        if (lazy_ && !lazy_->setUp.load(std::memory_order_acquire))
+            setUpNow();
+    }
+
+    void
+    setUpNow() const;
+
     bool mImmutable;
 
+    // Set while a ledger opened lazily has work left to do on first use
+    std::unique_ptr<Lazy> const lazy_;
+
     std::shared_ptr<SHAMap> txMap_;
     std::shared_ptr<SHAMap> stateMap_;
 
+    // Node writes put off when the ledger was built, if any
+    std::shared_ptr<SHAMapDeferredWrites> deferredWrites_;
+
     // Protects fee variables
     std::mutex mutable mutex_;
 
@@ -457,6 +562,15 @@ getHashesByIndex(
 extern std::map<std::uint32_t, std::pair<uint256, uint256>>
 getHashesByIndex(std::uint32_t minSeq, std::uint32_t maxSeq, Application& app);
 
+/** Load the headers of the ledgers in a range of sequences.
+
+    @param minSeq The first sequence of the range.
+    @param maxSeq The last sequence of the range.
+    @return The headers found, hashes included.
+*/
+extern std::vector<LedgerInfo>
+loadLedgerInfos(std::uint32_t minSeq, std::uint32_t maxSeq, Application& app);
+
 // Fetch the ledger with the highest sequence contained in the database
 extern std::tuple<std::shared_ptr<Ledger>, std::uint32_t, uint256>
 getLatestLedger(Application& app);
@@ -49,8 +49,9 @@ public:
             Safe to call from any thread at any time.
 
         @param parameters A Json object with configurable parameters.
+        @return The progress of the cleaner.
     */
-    virtual void
+    virtual Json::Value
     doClean(Json::Value const& parameters) = 0;
 };
 
@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_LEDGERHASHINDEX_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERHASHINDEX_H_INCLUDED
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/base_uint.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace boost {
+namespace interprocess {
+class file_mapping;
+class mapped_region;
+}  // namespace interprocess
+}  // namespace boost
+
+namespace ripple {
+
+/** The hashes of validated ledgers, indexed by sequence.
+
+    Sequences are grouped into chunks of consecutive ledgers, each an
+    array of 32 byte slots that is allocated when the first hash in it is
+    set. A slot of zeros is a ledger whose hash is not known.
+
+    Given a file, the chunks are appended to it as needed and memory
+    mapped, so looking up a hash costs no I/O once its page is resident,
+    and the hashes survive a restart. Without one the chunks are held in
+    memory. The file is only a cache: if it can not be used it is started
+    over, and if it can not be created the index is kept in memory.
+
+    Only hashes of validated ledgers belong here. They never change,
+    except to correct an entry found to disagree with the chain.
+*/
+class LedgerHashIndex
+{
+public:
+    /** The ledgers in each chunk. */
+    static constexpr std::uint32_t chunkLedgers = 65536;
+
+    /** Create an index.
+
+        @param path The file holding the index, or empty to keep the
+                    index in memory only.
+    */
+    LedgerHashIndex(boost::filesystem::path path, beast::Journal j);
+
+    ~LedgerHashIndex();
+
+    LedgerHashIndex(LedgerHashIndex const&) = delete;
+    LedgerHashIndex&
+    operator=(LedgerHashIndex const&) = delete;
+
+    /** Return the hash of a ledger, if it is known. */
+    boost::optional<uint256>
+    get(std::uint32_t seq) const;
+
+    /** Record the hash of a validated ledger. */
+    void
+    set(std::uint32_t seq, uint256 const& hash);
+
+    /** Return true if the index is kept in a file. */
+    bool
+    mapped() const
+    {
+        return file_ != nullptr;
+    }
+
+private:
+    void
+    open();
+
+    void
+    reset();
+
+    // The slots of the chunk holding a sequence, allocated if need be
+    unsigned char*
+    chunk(std::uint32_t seq);
+
+    boost::filesystem::path const path_;
+    beast::Journal const j_;
+
+    std::mutex mutable mutex_;
+
+    // The slots of each chunk, by number, or null if not allocated
+    std::vector<unsigned char*> chunks_;
+
+    // Chunks held in memory
+    std::vector<std::unique_ptr<unsigned char[]>> memory_;
+
+    // The file, its header and the chunks mapped from it
+    std::unique_ptr<boost::interprocess::file_mapping> file_;
+    std::unique_ptr<boost::interprocess::mapped_region> header_;
+    std::vector<std::unique_ptr<boost::interprocess::mapped_region>> regions_;
+    std::uint32_t fileChunks_ = 0;
+    bool failed_ = false;
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_LEDGERHEADERCACHE_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERHEADERCACHE_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/ledger/ReadView.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+
+/** The headers of validated ledgers, indexed by sequence.
+
+    Sequences are grouped into chunks of consecutive ledgers, each an
+    array of compact entries that is allocated when the first header in
+    it is inserted. An entry holds what a header is made of, while the
+    ledger hash, which depends on all of it, is computed on lookup.
+
+    The cache holds at most a given number of chunks; past that the one
+    least recently used is dropped, so a server keeping all of history
+    keeps the headers of the ranges it is asked about.
+*/
+class LedgerHeaderCache
+{
+public:
+    /** The ledgers in each chunk. */
+    static constexpr std::uint32_t chunkLedgers = 4096;
+
+    /** Create a cache.
+
+        @param maxLedgers The number of ledgers whose headers may be held.
+    */
+    explicit LedgerHeaderCache(std::uint32_t maxLedgers);
+
+    ~LedgerHeaderCache();
+
+    LedgerHeaderCache(LedgerHeaderCache const&) = delete;
+    LedgerHeaderCache&
+    operator=(LedgerHeaderCache const&) = delete;
+
+    /** Return the header of a ledger, if it is held. */
+    boost::optional<LedgerInfo>
+    get(std::uint32_t seq) const;
+
+    /** Hold the header of a validated ledger. */
+    void
+    insert(LedgerInfo const& info);
+
+    /** Drop the headers of ledgers before a sequence. */
+    void
+    erasePrior(std::uint32_t seq);
+
+    /** Return the number of headers held. */
+    std::size_t
+    size() const;
+
+private:
+    struct Entry;
+    struct Chunk;
+
+    std::size_t const maxChunks_;
+
+    std::mutex mutable mutex_;
+
+    // The chunks, by number
+    std::map<std::uint32_t, std::unique_ptr<Chunk>> chunks_;
+
+    // Counts lookups and insertions, to age the chunks by
+    std::uint64_t mutable ticks_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
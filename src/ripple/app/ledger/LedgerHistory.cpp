@@ -18,11 +18,14 @@
 //==============================================================================
 
 #include <ripple/app/ledger/LedgerHistory.h>
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/contract.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/json/to_string.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -36,6 +39,26 @@ std::chrono::seconds constexpr CachedLedgerAge = std::chrono::minutes{2};
 
 // FIXME: Need to clean up ledgers by index at some point
 
+// The headers of the ledgers a server retains are cached, up to about
+// 60 megabytes for one keeping all of history
+static std::uint32_t constexpr maxCachedHeaders = 1 << 19;
+
+// Headers missing from the cache are loaded this many ledgers at a time
+static std::uint32_t constexpr headerLoadLedgers = 256;
+
+static std::uint32_t
+cachedHeaders(Config const& config)
+{
+    std::uint32_t retained = config.LEDGER_HISTORY;
+    std::uint32_t onlineDelete = 0;
+    if (get_if_exists(
+            config.section(ConfigSection::nodeDatabase()),
+            "online_delete",
+            onlineDelete))
+        retained = std::max(retained, onlineDelete);
+    return std::min(retained, maxCachedHeaders);
+}
+
 LedgerHistory::LedgerHistory(
     beast::insight::Collector::ptr const& collector,
     Application& app)
@@ -54,6 +77,7 @@ LedgerHistory::LedgerHistory(
           std::chrono::minutes{5},
           stopwatch(),
           app_.journal("TaggedCache"))
+    , headers_(cachedHeaders(app_.config()))
     , j_(app.journal("LedgerHistory"))
 {
 }
@@ -71,7 +95,10 @@ LedgerHistory::insert(std::shared_ptr<Ledger const> ledger, bool validated)
     const bool alreadyHad = m_ledgers_by_hash.canonicalize_replace_cache(
         ledger->info().hash, ledger);
     if (validated)
+    {
         mLedgersByIndex[ledger->info().seq] = ledger->info().hash;
+        headers_.insert(ledger->info());
+    }
 
     return alreadyHad;
 }
@@ -103,6 +130,9 @@ LedgerHistory::getLedgerBySeq(LedgerIndex index)
         }
     }
 
+    if (auto ret = loadLazily(index, boost::none))
+        return ret;
+
     std::shared_ptr<Ledger const> ret = loadByIndex(index, app_);
 
     if (!ret)
@@ -146,6 +176,70 @@ LedgerHistory::getLedgerByHash(LedgerHash const& hash)
     return ret;
 }
 
+std::shared_ptr<Ledger const>
+LedgerHistory::getLedgerByHash(LedgerHash const& hash, LedgerIndex index)
+{
+    if (auto ret = m_ledgers_by_hash.fetch(hash))
+    {
+        assert(ret->isImmutable());
+        assert(ret->info().hash == hash);
+        return ret;
+    }
+
+    if (auto ret = loadLazily(index, hash))
+        return ret;
+
+    return getLedgerByHash(hash);
+}
+
+std::shared_ptr<Ledger const>
+LedgerHistory::loadLazily(
+    LedgerIndex index,
+    boost::optional<LedgerHash> const& hash)
+{
+    // Only a ledger held in full can be opened without checking its maps
+    if (!app_.getLedgerMaster().haveLedger(index))
+        return {};
+
+    auto info = headers_.get(index);
+    if (!info)
+    {
+        auto const first = index - index % headerLoadLedgers;
+        for (auto const& loaded :
+             loadLedgerInfos(first, first + headerLoadLedgers - 1, app_))
+        {
+            if (loaded.hash == calculateLedgerHash(loaded))
+                headers_.insert(loaded);
+            else
+                JLOG(j_.warn()) << "Header of ledger " << loaded.seq
+                                << " does not match its hash " << loaded.hash;
+        }
+
+        info = headers_.get(index);
+        if (!info)
+            return {};
+    }
+
+    if (hash && info->hash != *hash)
+    {
+        JLOG(j_.debug()) << "Cached header of ledger " << index << " is "
+                         << info->hash << ", not " << *hash;
+        return {};
+    }
+
+    auto ledger = std::make_shared<Ledger>(
+        open_lazily, *info, true, app_.config(), app_.getNodeFamily());
+    ledger->setFull();
+
+    JLOG(j_.trace()) << "Opened ledger " << index << " from its header";
+
+    std::shared_ptr<Ledger const> ret = std::move(ledger);
+    std::unique_lock sl(m_ledgers_by_hash.peekMutex());
+    m_ledgers_by_hash.canonicalize_replace_client(ret->info().hash, ret);
+    mLedgersByIndex[ret->info().seq] = ret->info().hash;
+    return ret;
+}
+
 static void
 log_one(
     ReadView const& ledger,
@@ -411,7 +505,7 @@ LedgerHistory::handleMismatch(
         }
         else
         {
-            if ((*b)->peekData() != (*v)->peekData())
+            if ((*b)->slice() != (*v)->slice())
             {
                 // Same transaction with different metadata
                 log_metadata_difference(
@@ -21,6 +21,7 @@
 #define RIPPLE_APP_LEDGER_LEDGERHISTORY_H_INCLUDED
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerHeaderCache.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/beast/insight/Collector.h>
 #include <ripple/beast/insight/Event.h>
@@ -61,6 +62,14 @@ public:
     std::shared_ptr<Ledger const>
     getLedgerByHash(LedgerHash const& ledgerHash);
 
+    /** Retrieve a validated ledger given its hash and sequence number
+
+        Knowing the sequence, a ledger held locally can be opened from
+        its cached header.
+    */
+    std::shared_ptr<Ledger const>
+    getLedgerByHash(LedgerHash const& ledgerHash, LedgerIndex ledgerIndex);
+
     /** Get a ledger's hash given its sequence number
         @param ledgerIndex The sequence number of the desired ledger
         @return The hash of the specified ledger
@@ -108,7 +117,25 @@ public:
     void
     clearLedgerCachePrior(LedgerIndex seq);
 
+    /** Forget the headers of ledgers before a sequence */
+    void
+    clearHeadersPrior(LedgerIndex seq)
+    {
+        headers_.erasePrior(seq);
+    }
+
 private:
+    /** Open a ledger held locally from its header, without reading its
+        maps until they are used.
+        @param ledgerIndex The sequence of the ledger
+        @param ledgerHash The hash the ledger must have, if known
+        @return The ledger, or null if its header is not found
+    */
+    std::shared_ptr<Ledger const>
+    loadLazily(
+        LedgerIndex ledgerIndex,
+        boost::optional<LedgerHash> const& ledgerHash);
+
     /** Log details in the case where we build one ledger but
         validate a different one.
         @param built The hash of the ledger we built
@@ -156,6 +183,9 @@ private:
     // Maps ledger indexes to the corresponding hash.
     std::map<LedgerIndex, LedgerHash> mLedgersByIndex;  // validated ledgers
 
+    // The headers of validated ledgers, to open them without a query
+    LedgerHeaderCache headers_;
+
     beast::Journal j_;
 };
 
@@ -24,6 +24,7 @@
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerCleaner.h>
+#include <ripple/app/ledger/LedgerHashIndex.h>
 #include <ripple/app/ledger/LedgerHistory.h>
 #include <ripple/app/ledger/LedgerHolder.h>
 #include <ripple/app/ledger/LedgerReplay.h>
@@ -35,10 +36,12 @@
 #include <ripple/beast/insight/Collector.h>
 #include <ripple/beast/utility/PropertyStream.h>
 #include <ripple/core/Stoppable.h>
+#include <ripple/overlay/Message.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/protocol/RippleLedgerHash.h>
 #include <ripple/protocol/STValidation.h>
 #include <ripple/protocol/messages.h>
+#include <ripple/shamap/SHAMapSnapshot.h>
 #include <boost/optional.hpp>
 
 #include <mutex>
@@ -180,6 +183,15 @@ public:
     uint256
     getHashBySeq(std::uint32_t index);
 
+    /** Get a validated ledger's hash from the index by sequence, which
+        does no I/O
+     */
+    boost::optional<LedgerHash>
+    getIndexedHash(std::uint32_t index) const
+    {
+        return hashIndex_.get(index);
+    }
+
     /** Walk to a ledger's hash using the skip list */
     boost::optional<LedgerHash>
     walkHashBySeq(std::uint32_t index, InboundLedger::Reason reason);
@@ -259,7 +271,7 @@ public:
 
     bool
     fixIndex(LedgerIndex ledgerIndex, LedgerHash const& ledgerHash);
-    void
+    Json::Value
     doLedgerCleaner(Json::Value const& parameters);
 
     beast::PropertyStream::Source&
@@ -281,7 +293,12 @@ public:
     void
     gotFetchPack(bool progress, std::uint32_t seq);
 
-    void
+    /** Keep an object from a fetch pack until a ledger acquisition asks
+        for it.
+        @return false if the fetch pack cache is full and the object was
+                dropped
+    */
+    bool
     addFetchPack(uint256 const& hash, std::shared_ptr<Blob> data);
 
     boost::optional<Blob>
@@ -308,6 +325,20 @@ public:
     boost::optional<LedgerIndex>
     minSqlSeq();
 
+    /** Add the hashes in the ledger database to the hash index, in the
+        background. */
+    void
+    fillHashIndex();
+
+    /** Warm the tree node cache from the state snapshot, if configured. */
+    void
+    loadSnapshot();
+
+    /** Write the validated ledger's state map to the snapshot, if
+        configured. */
+    void
+    writeSnapshot();
+
 private:
     void
     setValidLedger(std::shared_ptr<Ledger const> const& l);
@@ -333,6 +364,16 @@ private:
         bool& progress,
         InboundLedger::Reason reason,
         std::unique_lock<std::recursive_mutex>&);
+    // Start a replay task for the ledgers below a missing historical one.
+    // Returns true if a replay task should be rebuilding the ledger.
+    bool
+    replayHistory(std::uint32_t missing, uint256 const& hash);
+    // Keep the backfill window full below a missing historical ledger
+    void
+    backfillHistory(std::uint32_t missing);
+    // Count a backfilled ledger and report the backfill rate
+    void
+    noteBackfilled(std::uint32_t seq);
     // Try to publish ledgers, acquire missing ledgers.  Always called with
     // m_mutex locked.  The passed lock is a reminder to callers.
     void
@@ -377,6 +418,9 @@ private:
 
     LedgerHistory mLedgerHistory;
 
+    // Hashes of validated ledgers by sequence
+    LedgerHashIndex hashIndex_;
+
     CanonicalTXSet mHeldTransactions{uint256()};
 
     // A set of transactions to replay during the next close
@@ -419,8 +463,33 @@ private:
 
     TaggedCache<uint256, Blob> fetch_packs_;
 
+    // Fetch packs recently built for peers, which are often several peers
+    // syncing from the same ledger, as the chunks they were sent in
+    TaggedCache<uint256, std::vector<std::shared_ptr<Message>>>
+        fetchPackReplies_;
+
+    // A fetch pack chunk arrived while a gotFetchPack job was running
+    std::atomic<bool> fetchPackArrived_{false};
+
     std::uint32_t fetch_seq_{0};
 
+    // Historical ledgers acquired at the same time while backfilling
+    std::uint32_t const history_window_;
+
+    // History backfill state, used only by the advance thread: the lowest
+    // ledger whose acquisition was started below the current gap, and the
+    // ledgers a replay task is rebuilding until it should have finished
+    std::uint32_t backfillLow_{0};
+    std::uint32_t replayLow_{0};
+    std::uint32_t replayHigh_{0};
+    std::chrono::steady_clock::time_point replayDeadline_;
+
+    // Ledgers backfilled since the rate was last reported
+    std::uint32_t backfillCount_{0};
+    std::chrono::steady_clock::time_point backfillMark_;
+    std::chrono::steady_clock::time_point backfillLast_;
+    std::atomic<std::uint64_t> backfillRate_{0};
+
     // Try to keep a validator from switching from test to live network
     // without first wiping the database.
     LedgerIndex const max_ledger_difference_{1000000};
@@ -428,6 +497,14 @@ private:
     // Time that the previous upgrade warning was issued.
     TimeKeeper::time_point upgradeWarningPrevTime_{};
 
+    // Snapshot of the validated state map, used to warm the tree node
+    // cache at startup. Null unless [state_snapshot] gives a path.
+    std::unique_ptr<SHAMapSnapshot> snapshot_;
+    std::size_t snapshotMaxNodes_{1000000};
+    std::chrono::seconds snapshotInterval_{600};
+    std::chrono::steady_clock::time_point snapshotDue_;
+    std::atomic<bool> snapshotWriting_{false};
+
 private:
     struct Stats
     {
@@ -440,12 +517,16 @@ private:
                   collector->make_gauge("LedgerMaster", "Validated_Ledger_Age"))
             , publishedLedgerAge(
                   collector->make_gauge("LedgerMaster", "Published_Ledger_Age"))
+            , historyBackfillRate(collector->make_gauge(
+                  "LedgerMaster",
+                  "History_Backfill_Rate"))
         {
         }
 
         beast::insight::Hook hook;
         beast::insight::Gauge validatedLedgerAge;
         beast::insight::Gauge publishedLedgerAge;
+        beast::insight::Gauge historyBackfillRate;
     };
 
     Stats m_stats;
@@ -457,6 +538,7 @@ private:
         std::lock_guard lock(m_mutex);
         m_stats.validatedLedgerAge.set(getValidatedLedgerAge().count());
         m_stats.publishedLedgerAge.set(getPublishedLedgerAge().count());
+        m_stats.historyBackfillRate.set(backfillRate_);
     }
 };
 
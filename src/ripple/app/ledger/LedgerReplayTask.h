@@ -175,6 +175,15 @@ private:
     void
     tryAdvance(ScopedLockType& sl);
 
+    /**
+     * Start acquiring the deltas that have entered the window, i.e. are
+     * fewer than window_ ledgers past the next one to build
+     * @param sl  lock. this function must be called with the lock, and
+     *            releases it while starting the deltas
+     */
+    void
+    startDeltas(ScopedLockType& sl);
+
     InboundLedgers& inboundLedgers_;
     LedgerReplayer& replayer_;
     TaskParameter parameter_;
@@ -182,6 +191,8 @@ private:
     std::shared_ptr<SkipListAcquire> skipListAcquirer_;
     std::shared_ptr<Ledger const> parent_ = {};
     uint32_t deltaToBuild_ = 0;  // should not build until have parent
+    uint32_t deltaToStart_ = 0;
+    std::size_t const window_;  // deltas acquired at the same time
     std::vector<std::shared_ptr<LedgerDeltaAcquire>> deltas_;
 
     friend class test::LedgerReplayClient;
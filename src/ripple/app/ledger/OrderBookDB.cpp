@@ -20,13 +20,23 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/impl/Tuning.h>
+#include <algorithm>
 
 namespace ripple {
 
+// Catch up on at most this many ledgers before scanning in full instead
+static constexpr std::uint32_t maxDeltaLedgers = 256;
+
+// Snapshot at most this many books of each published ledger
+static constexpr std::size_t maxSnapshotBooks = 64;
+
 OrderBookDB::OrderBookDB(Application& app, Stoppable& parent)
     : Stoppable("OrderBookDB", parent)
     , app_(app)
@@ -45,37 +55,167 @@ OrderBookDB::invalidate()
 void
 OrderBookDB::setup(std::shared_ptr<ReadView const> const& ledger)
 {
+    if (app_.config().PATH_SEARCH_MAX == 0)
+    {
+        // nothing to do
+        return;
+    }
+
     {
         std::lock_guard sl(mLock);
-        auto seq = ledger->info().seq;
+        auto const seq = ledger->info().seq;
 
-        // Do a full update every 256 ledgers
-        if (mSeq != 0)
+        // Ignore ledgers a little older than the one we're advancing to
+        if (mTarget)
         {
-            if (seq == mSeq)
-                return;
-            if ((seq > mSeq) && ((seq - mSeq) < 256))
+            auto const target = mTarget->info().seq;
+            if (seq == target && mSeq != 0)
                 return;
-            if ((seq < mSeq) && ((mSeq - seq) < 16))
+            if ((seq < target) && ((target - seq) < 16))
                 return;
         }
 
         JLOG(j_.debug()) << "Advancing from " << mSeq << " to " << seq;
 
-        mSeq = seq;
+        mTarget = ledger;
+        if (mAdvancing)
+            return;
+        mAdvancing = true;
     }
 
-    if (app_.config().PATH_SEARCH_MAX == 0)
-    {
-        // nothing to do
-    }
-    else if (app_.config().standalone())
-        update(ledger);
+    if (app_.config().standalone())
+        advance();
     else
         app_.getJobQueue().addJob(
-            jtUPDATE_PF, "OrderBookDB::update", [this, ledger](Job&) {
-                update(ledger);
-            });
+            jtUPDATE_PF, "OrderBookDB::update", [this](Job&) { advance(); });
+}
+
+void
+OrderBookDB::advance()
+{
+    for (;;)
+    {
+        std::shared_ptr<ReadView const> target;
+        std::uint32_t seq;
+        {
+            std::lock_guard sl(mLock);
+            target = mTarget;
+            seq = mSeq;
+            if (isStopping() || (seq != 0 && seq == target->info().seq))
+            {
+                mAdvancing = false;
+                return;
+            }
+        }
+
+        auto const targetSeq = target->info().seq;
+        bool current = false;
+        try
+        {
+            if (seq != 0 && targetSeq > seq &&
+                targetSeq - seq <= maxDeltaLedgers)
+            {
+                current = true;
+                for (auto s = seq + 1; current && s <= targetSeq; ++s)
+                {
+                    std::shared_ptr<ReadView const> ledger = s == targetSeq
+                        ? target
+                        : app_.getLedgerMaster().getLedgerBySeq(s);
+                    current = ledger && !ledger->open() && applyDelta(*ledger);
+                }
+            }
+        }
+        catch (SHAMapMissingNode const& mn)
+        {
+            JLOG(j_.info()) << "OrderBookDB::advance: " << mn.what();
+            current = false;
+        }
+
+        if (!current)
+        {
+            update(target);
+
+            std::lock_guard sl(mLock);
+            if (mSeq == 0)
+            {
+                // The scan failed; the next ledger will try again
+                mTarget.reset();
+                mAdvancing = false;
+                return;
+            }
+        }
+    }
+}
+
+bool
+OrderBookDB::applyDelta(ReadView const& ledger)
+{
+    std::vector<Book> created;
+    std::vector<Book> deleted;
+
+    for (auto const& item : ledger.txs)
+    {
+        auto const& meta = item.second;
+        if (!meta)
+            return false;
+
+        for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+        {
+            if (node.getFieldU16(sfLedgerEntryType) != ltDIR_NODE)
+                continue;
+
+            SField const* field = nullptr;
+            std::vector<Book>* books = nullptr;
+            if (node.getFName() == sfCreatedNode)
+            {
+                field = &sfNewFields;
+                books = &created;
+            }
+            else if (node.getFName() == sfDeletedNode)
+            {
+                field = &sfFinalFields;
+                books = &deleted;
+            }
+            else
+                continue;
+
+            // Only the root page of a book's quality directory says which
+            // book it belongs to.
+            auto const data =
+                dynamic_cast<STObject const*>(node.peekAtPField(*field));
+            if (data && data->isFieldPresent(sfExchangeRate) &&
+                data->isFieldPresent(sfRootIndex) &&
+                data->getFieldH256(sfRootIndex) ==
+                    node.getFieldH256(sfLedgerIndex))
+            {
+                Book book;
+                book.in.currency = data->getFieldH160(sfTakerPaysCurrency);
+                book.in.account = data->getFieldH160(sfTakerPaysIssuer);
+                book.out.account = data->getFieldH160(sfTakerGetsIssuer);
+                book.out.currency = data->getFieldH160(sfTakerGetsCurrency);
+                books->push_back(book);
+            }
+        }
+    }
+
+    for (auto const& book : created)
+        addOrderBook(book);
+
+    // A book is gone only once no directory of any quality is left
+    for (auto const& book : deleted)
+    {
+        auto const base = getBookBase(book);
+        if (!ledger.succ(base, getQualityNext(base)))
+            removeOrderBook(book);
+    }
+
+    JLOG(j_.trace()) << "OrderBookDB::applyDelta " << ledger.info().seq
+                     << ": " << created.size() << " created, "
+                     << deleted.size() << " deleted";
+
+    std::lock_guard sl(mLock);
+    mSeq = ledger.info().seq;
+    return true;
 }
 
 void
@@ -148,6 +288,7 @@ OrderBookDB::update(std::shared_ptr<ReadView const> const& ledger)
         mXRPBooks.swap(XRPBooks);
         mSourceMap.swap(sourceMap);
         mDestMap.swap(destMap);
+        mSeq = ledger->info().seq;
     }
     app_.getLedgerMaster().newOrderBookDB();
 }
@@ -188,6 +329,37 @@ OrderBookDB::addOrderBook(Book const& book)
         mXRPBooks.insert(book.in);
 }
 
+void
+OrderBookDB::removeOrderBook(Book const& book)
+{
+    std::lock_guard sl(mLock);
+
+    auto const matches = [&book](std::shared_ptr<OrderBook> const& ob) {
+        return ob->book() == book;
+    };
+
+    if (auto it = mSourceMap.find(book.in); it != mSourceMap.end())
+    {
+        auto& books = it->second;
+        books.erase(
+            std::remove_if(books.begin(), books.end(), matches), books.end());
+        if (books.empty())
+            mSourceMap.erase(it);
+    }
+
+    if (auto it = mDestMap.find(book.out); it != mDestMap.end())
+    {
+        auto& books = it->second;
+        books.erase(
+            std::remove_if(books.begin(), books.end(), matches), books.end());
+        if (books.empty())
+            mDestMap.erase(it);
+    }
+
+    if (isXRP(book.out))
+        mXRPBooks.erase(book.in);
+}
+
 // return list of all orderbooks that want this issuerID and currencyID
 OrderBook::List
 OrderBookDB::getBooksByTakerPays(Issue const& issue)
@@ -242,73 +414,157 @@ OrderBookDB::getBookListeners(Book const& book)
     return ret;
 }
 
-// Based on the meta, send the meta to the streams that are listening.
-// We need to determine which streams a given meta effects.
+bool
+OrderBookDB::getSnapshotPage(
+    ReadView const& ledger,
+    Book const& book,
+    AccountID const& taker,
+    unsigned int limit,
+    Json::Value& jvResult)
+{
+    std::shared_ptr<Snapshot const> snapshot;
+    {
+        std::lock_guard sl(mLock);
+        ++mBookRequests[book];
+        snapshot = mSnapshot;
+    }
+
+    if (!snapshot || ledger.open() ||
+        snapshot->ledgerHash != ledger.info().hash)
+        return false;
+
+    // The snapshot charges transfer fees, which the issuer doesn't pay
+    if (taker == book.out.account && !isXRP(book.out))
+        return false;
+
+    auto const it = snapshot->books.find(book);
+    if (it == snapshot->books.end())
+        return false;
+
+    auto const& [offers, complete] = it->second;
+    if (!complete && limit >= offers.size())
+        return false;
+
+    Json::Value& jvOffers =
+        (jvResult[jss::offers] = Json::Value(Json::arrayValue));
+    auto const count = std::min<std::size_t>(limit, offers.size());
+    for (Json::UInt i = 0; i < count; ++i)
+        jvOffers.append(offers[i]);
+    return true;
+}
+
 void
-OrderBookDB::processTxn(
-    std::shared_ptr<ReadView const> const& ledger,
-    const AcceptedLedgerTx& alTx,
-    Json::Value const& jvObj)
+OrderBookDB::snapshot(std::shared_ptr<ReadView const> const& ledger)
 {
+    {
+        std::lock_guard sl(mLock);
+        if (mBookRequests.empty())
+        {
+            mSnapshot.reset();
+            return;
+        }
+    }
+
+    if (app_.config().standalone())
+        buildSnapshot(ledger);
+    else
+        app_.getJobQueue().addJob(
+            jtUPDATE_PF, "OrderBookDB::snapshot", [this, ledger](Job&) {
+                buildSnapshot(ledger);
+            });
+}
+
+void
+OrderBookDB::buildSnapshot(std::shared_ptr<ReadView const> const& ledger)
+{
+    std::vector<std::pair<std::uint32_t, Book>> popular;
+    {
+        std::lock_guard sl(mLock);
+        for (auto it = mBookRequests.begin(); it != mBookRequests.end();)
+        {
+            popular.emplace_back(it->second, it->first);
+            if ((it->second /= 2) == 0)
+                it = mBookRequests.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    auto const books = std::min(popular.size(), maxSnapshotBooks);
+    std::partial_sort(
+        popular.begin(),
+        popular.begin() + books,
+        popular.end(),
+        [](auto const& a, auto const& b) { return a.first > b.first; });
+    popular.resize(books);
+
+    auto next = std::make_shared<Snapshot>();
+    next->ledgerHash = ledger->info().hash;
+    next->ledgerSeq = ledger->info().seq;
+
+    // One offer more than a client may ask for tells whether there are more
+    auto const walkLimit = RPC::Tuning::bookOffers.rmax + 1;
+    auto view = ledger;
+    for (auto const& [_, book] : popular)
+    {
+        (void)_;
+        if (isStopping())
+            return;
+
+        Json::Value result(Json::objectValue);
+        try
+        {
+            app_.getOPs().getBookPage(
+                view,
+                book,
+                beast::zero,
+                false,
+                false,
+                walkLimit,
+                Json::Value(Json::nullValue),
+                result);
+        }
+        catch (SHAMapMissingNode const& mn)
+        {
+            JLOG(j_.info()) << "OrderBookDB::buildSnapshot: " << mn.what();
+            continue;
+        }
+
+        auto& offers = result[jss::offers];
+        bool const complete = offers.size() < walkLimit;
+        next->books.emplace(book, std::make_pair(std::move(offers), complete));
+    }
+
+    JLOG(j_.debug()) << "OrderBookDB::buildSnapshot " << next->ledgerSeq
+                     << ": " << next->books.size() << " books";
+
+    std::lock_guard sl(mLock);
+    if (!mSnapshot || mSnapshot->ledgerSeq < next->ledgerSeq)
+        mSnapshot = std::move(next);
+}
+
+OrderBookDB::BookToListenersMap
+OrderBookDB::getBookListeners(AcceptedLedger const& ledger)
+{
+    BookToListenersMap ret;
     std::lock_guard sl(mLock);
-    if (alTx.getResult() == tesSUCCESS)
+
+    if (mListeners.empty())
+        return ret;
+
+    for (auto const& [_, alTx] : ledger.getMap())
     {
-        // For this particular transaction, maintain the set of unique
-        // subscriptions that have already published it.  This prevents sending
-        // the transaction multiple times if it touches multiple ltOFFER
-        // entries for the same book, or if it touches multiple books and a
-        // single client has subscribed to those books.
-        hash_set<std::uint64_t> havePublished;
-
-        // Check if this is an offer or an offer cancel or a payment that
-        // consumes an offer.
-        // Check to see what the meta looks like.
-        for (auto& node : alTx.getMeta()->getNodes())
+        (void)_;
+        for (auto const& book : alTx->getBooks())
         {
-            try
-            {
-                if (node.getFieldU16(sfLedgerEntryType) == ltOFFER)
-                {
-                    SField const* field = nullptr;
-
-                    // We need a field that contains the TakerGets and TakerPays
-                    // parameters.
-                    if (node.getFName() == sfModifiedNode)
-                        field = &sfPreviousFields;
-                    else if (node.getFName() == sfCreatedNode)
-                        field = &sfNewFields;
-                    else if (node.getFName() == sfDeletedNode)
-                        field = &sfFinalFields;
-
-                    if (field)
-                    {
-                        auto data = dynamic_cast<const STObject*>(
-                            node.peekAtPField(*field));
-
-                        if (data && data->isFieldPresent(sfTakerPays) &&
-                            data->isFieldPresent(sfTakerGets))
-                        {
-                            // determine the OrderBook
-                            Book b{
-                                data->getFieldAmount(sfTakerGets).issue(),
-                                data->getFieldAmount(sfTakerPays).issue()};
-
-                            auto listeners = getBookListeners(b);
-                            if (listeners)
-                            {
-                                listeners->publish(jvObj, havePublished);
-                            }
-                        }
-                    }
-                }
-            }
-            catch (std::exception const&)
-            {
-                JLOG(j_.info())
-                    << "Fields not found in OrderBookDB::processTxn";
-            }
+            if (ret.count(book))
+                continue;
+            if (auto it = mListeners.find(book); it != mListeners.end())
+                ret.emplace(book, it->second);
         }
     }
+
+    return ret;
 }
 
 }  // namespace ripple
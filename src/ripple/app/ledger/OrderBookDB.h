@@ -20,7 +20,7 @@
 #ifndef RIPPLE_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 #define RIPPLE_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 
-#include <ripple/app/ledger/AcceptedLedgerTx.h>
+#include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/BookListeners.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/OrderBook.h>
@@ -33,8 +33,17 @@ class OrderBookDB : public Stoppable
 public:
     OrderBookDB(Application& app, Stoppable& parent);
 
+    /** Bring the order books up to date with a closed ledger.
+
+        The books are rebuilt from a full scan of the ledger the first time,
+        and when the ledgers in between are not available. Otherwise they
+        are kept exact by adding and removing the books whose directories
+        the transactions of each intervening ledger created and deleted.
+    */
     void
     setup(std::shared_ptr<ReadView const> const& ledger);
+
+    /** Rebuild the order books from a full scan of the ledger. */
     void
     update(std::shared_ptr<ReadView const> const& ledger);
     void
@@ -61,12 +70,38 @@ public:
     BookListeners::pointer
     makeBookListeners(Book const&);
 
-    // see if this txn effects any orderbook
+    /** Copy the first offers of a book from the snapshot of a ledger.
+
+        The snapshot holds the offers of the most requested books, with
+        their funded amounts, as book_offers returns them. It is taken once
+        for each published ledger. Every call counts towards the popularity
+        of the book, whether or not it is served.
+
+        @return false if the snapshot can't answer for this ledger, book,
+                taker or limit, and the book must be walked instead.
+    */
+    bool
+    getSnapshotPage(
+        ReadView const& ledger,
+        Book const& book,
+        AccountID const& taker,
+        unsigned int limit,
+        Json::Value& jvResult);
+
+    /** Snapshot the most requested books as of a published ledger. */
     void
-    processTxn(
-        std::shared_ptr<ReadView const> const& ledger,
-        const AcceptedLedgerTx& alTx,
-        Json::Value const& jvObj);
+    snapshot(std::shared_ptr<ReadView const> const& ledger);
+
+    using BookToListenersMap = hash_map<Book, BookListeners::pointer>;
+
+    /** Find the listeners of the books a ledger's transactions touched.
+
+        The books are looked up under a single lock for the whole ledger,
+        rather than once for each of its transactions. Books nobody
+        listens to are left out.
+    */
+    BookToListenersMap
+    getBookListeners(AcceptedLedger const& ledger);
 
     using IssueToOrderBook = hash_map<Issue, OrderBook::List>;
 
@@ -74,6 +109,31 @@ private:
     void
     rawAddBook(Book const&);
 
+    void
+    removeOrderBook(Book const&);
+
+    // Bring the books up to mTarget, then to any newer target
+    void
+    advance();
+
+    // Apply the books created and deleted by a ledger's transactions,
+    // returning false if any of them lacks metadata.
+    bool
+    applyDelta(ReadView const& ledger);
+
+    void
+    buildSnapshot(std::shared_ptr<ReadView const> const& ledger);
+
+    // The offers of the popular books as of one published ledger
+    struct Snapshot
+    {
+        uint256 ledgerHash;
+        std::uint32_t ledgerSeq;
+
+        // The offers of each book, and whether they are all of them
+        hash_map<Book, std::pair<Json::Value, bool>> books;
+    };
+
     Application& app_;
 
     // by ci/ii
@@ -87,12 +147,22 @@ private:
 
     std::recursive_mutex mLock;
 
-    using BookToListenersMap = hash_map<Book, BookListeners::pointer>;
-
     BookToListenersMap mListeners;
 
+    // The ledger the books are exact for, or 0 if none
     std::uint32_t mSeq;
 
+    // The newest ledger the books should be brought up to
+    std::shared_ptr<ReadView const> mTarget;
+
+    // Whether advance is running
+    bool mAdvancing = false;
+
+    std::shared_ptr<Snapshot const> mSnapshot;
+
+    // Requests for each book, halved at every snapshot
+    hash_map<Book, std::uint32_t> mBookRequests;
+
     beast::Journal const j_;
 };
 
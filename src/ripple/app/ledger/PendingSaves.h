@@ -22,11 +22,17 @@
 
 #include <ripple/protocol/Protocol.h>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
+class Ledger;
+
 /** Keeps track of which ledgers haven't been fully saved.
 
     During the ledger building process this collection will keep
@@ -40,7 +46,24 @@ private:
     std::map<LedgerIndex, bool> map_;
     std::condition_variable await_;
 
+    // Ledgers waiting to be written to SQL by a batch
+    std::deque<std::shared_ptr<Ledger const>> queue_;
+    bool draining_ = false;
+    std::uint64_t batches_ = 0;
+    std::uint64_t batchedLedgers_ = 0;
+
 public:
+    /** The most ledgers that may wait in the queue. */
+    static constexpr std::size_t queueLimit = 256;
+
+    /** Counts describing the batched saves. */
+    struct Stats
+    {
+        std::size_t queued;
+        std::uint64_t batches;
+        std::uint64_t ledgers;
+    };
+
     /** Start working on a ledger
 
         This is called prior to updating the SQLite indexes.
@@ -127,6 +150,63 @@ public:
         } while (true);
     }
 
+    /** Queue a ledger to be written by a batch
+
+        @param dispatch Set to `true` if the caller must arrange for the
+                        queue to be drained.
+
+        @return 'false' if the queue is full
+    */
+    bool
+    enqueue(std::shared_ptr<Ledger const> ledger, bool& dispatch)
+    {
+        std::lock_guard lock(mutex_);
+
+        if (queue_.size() >= queueLimit)
+            return false;
+
+        queue_.push_back(std::move(ledger));
+        dispatch = !draining_;
+        draining_ = true;
+        return true;
+    }
+
+    /** Take up to `limit` queued ledgers, oldest first
+
+        An empty result means the queue is drained and that the next
+        call to enqueue will ask for it to be drained again.
+    */
+    std::vector<std::shared_ptr<Ledger const>>
+    takeBatch(std::size_t limit)
+    {
+        std::lock_guard lock(mutex_);
+
+        std::vector<std::shared_ptr<Ledger const>> batch;
+        while (!queue_.empty() && batch.size() < limit)
+        {
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+
+        if (batch.empty())
+        {
+            draining_ = false;
+        }
+        else
+        {
+            ++batches_;
+            batchedLedgers_ += batch.size();
+        }
+        return batch;
+    }
+
+    Stats
+    getStats() const
+    {
+        std::lock_guard lock(mutex_);
+        return {queue_.size(), batches_, batchedLedgers_};
+    }
+
     /** Get a snapshot of the pending saves
 
         Each entry in the returned map corresponds to a ledger
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_STATEEXPORT_H_INCLUDED
+#define RIPPLE_APP_LEDGER_STATEEXPORT_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/shamap/SHAMap.h>
+#include <boost/filesystem/path.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace ripple {
+
+class WorkerPool;
+
+/** Writing and reading files that hold all of a ledger's state.
+
+    An export is a flat file of (key, entry type, serialized entry) records,
+    packed into LZ4 compressed blocks, with an index of the blocks at the
+    end. It lets analysis tools take in a whole ledger without paging
+    through ledger_data.
+
+    The state map is read on several threads, each taking the entries of
+    one range of keys at a time. Blocks are written as soon as they are
+    compressed, in whatever order they are finished, and the index lists
+    them in key order.
+*/
+namespace StateExport {
+
+/** Uncompressed size at which a block is closed. */
+std::size_t constexpr defaultBlockBytes = 1024 * 1024;
+
+struct Summary
+{
+    std::uint32_t ledgerSeq = 0;
+    uint256 ledgerHash;
+    uint256 accountHash;
+    std::uint64_t entries = 0;
+    std::uint32_t blocks = 0;
+    // The size of the file, and of the records before compression
+    std::uint64_t bytes = 0;
+    std::uint64_t rawBytes = 0;
+    std::chrono::microseconds elapsed{};
+};
+
+struct Entry
+{
+    uint256 key;
+    // The sfLedgerEntryType of the entry, or 0 if it has none
+    std::uint16_t type;
+    Slice data;
+};
+
+/** Write the state map of a ledger to a file, replacing any there.
+
+    The file is written beside the path and renamed over it once complete,
+    so a reader never sees part of one. Entries missing from the node store
+    make the export fail.
+
+    @param map The state map of the ledger
+    @param info The header of the ledger
+    @param path The file to write
+    @param threads The most threads reading the map
+    @param workers The pool the threads are taken from
+    @param blockBytes The uncompressed size at which a block is closed
+    @return What was written
+    @throws std::runtime_error or SHAMapMissingNode on failure
+*/
+Summary
+write(
+    SHAMap const& map,
+    LedgerInfo const& info,
+    boost::filesystem::path const& path,
+    std::size_t threads,
+    WorkerPool& workers,
+    beast::Journal j,
+    std::size_t blockBytes = defaultBlockBytes);
+
+/** Read an export, calling a function with each entry in key order.
+
+    @return What the file holds
+    @throws std::runtime_error if the file is not a complete export
+*/
+Summary
+read(
+    boost::filesystem::path const& path,
+    std::function<void(Entry const&)> const& f);
+
+}  // namespace StateExport
+
+}  // namespace ripple
+
+#endif
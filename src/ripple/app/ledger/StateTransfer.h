@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_STATETRANSFER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_STATETRANSFER_H_INCLUDED
+
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/protocol/messages.h>
+#include <ripple/shamap/SHAMap.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace ripple {
+
+/** Rebuilds a ledger's state map from its leaves, fetched in key order.
+
+    The key space is split into ranges that are fetched side by side, each
+    from one peer at a time. A reply carries the leaves of its range from
+    the marker asked for on, and the marker to continue from. Once every
+    range is in, the map is hashed and checked against the ledger header.
+
+    Not thread safe: the owner serializes calls.
+*/
+class StateTransfer
+{
+public:
+    enum class Result {
+        useful,   // leaves taken; the range may be asked for again
+        stale,    // not an answer to a request still outstanding
+        refused,  // the peer doesn't have the ledger
+        bad       // the reply is malformed
+    };
+
+    // Number of ranges fetched side by side
+    static constexpr std::size_t defaultRanges = 16;
+
+    // Most leaves, and bytes of leaves, in one reply
+    static constexpr std::size_t replyLeaves = 2048;
+    static constexpr std::size_t replyBytes = kilobytes(512);
+
+    /** Create a transfer of the state map with the given root hash.
+
+        @param ranges The number of ranges, a power of two up to 256.
+    */
+    StateTransfer(
+        uint256 const& ledgerHash,
+        SHAMapHash const& accountHash,
+        Family& family,
+        std::size_t ranges = defaultRanges);
+
+    /** Return a request for a range no peer is asked for, or an unseated
+        optional if there is none. The range is marked as asked of the
+        peer.
+    */
+    std::optional<protocol::TMGetStateRange>
+    nextRequest(std::uint32_t peer);
+
+    /** Take a peer's reply.
+
+        A peer whose reply is refused or bad is not asked again.
+    */
+    Result
+    take(std::uint32_t peer, protocol::TMStateRange const& reply);
+
+    /** Called on every acquisition timer. Ranges asked for a whole
+        interval ago or more without an answer may be asked again.
+    */
+    void
+    timeout();
+
+    /** Whether the peer may be asked for ranges. */
+    bool
+    usable(std::uint32_t peer) const
+    {
+        return refused_.count(peer) == 0;
+    }
+
+    /** Whether any range is waiting for an answer. */
+    bool
+    waiting() const;
+
+    /** Whether every range is in. */
+    bool
+    complete() const;
+
+    /** Return the rebuilt map if its hash is the one expected, or null.
+
+        @note Only call once complete.
+    */
+    std::shared_ptr<SHAMap>
+    finish();
+
+    std::size_t
+    leaves() const
+    {
+        return leaves_;
+    }
+
+    /** Answer a request for a range of a ledger's state.
+
+        @param stateMap The state map of the ledger asked for, or null if
+                        we don't have the ledger.
+        @throws SHAMapMissingNode if the map is not all present
+    */
+    static protocol::TMStateRange
+    makeReply(
+        SHAMap const* stateMap,
+        protocol::TMGetStateRange const& request);
+
+private:
+    struct Range
+    {
+        uint256 marker;
+        // The first key of the next range, if there is one
+        std::optional<uint256> end;
+        bool done = false;
+        // The peer asked for the range, and when
+        std::optional<std::uint32_t> peer;
+        std::uint64_t asked = 0;
+    };
+
+    uint256 const ledgerHash_;
+    SHAMapHash const accountHash_;
+    std::shared_ptr<SHAMap> map_;
+    std::vector<Range> ranges_;
+    std::set<std::uint32_t> refused_;
+    std::uint64_t ticks_ = 0;
+    std::size_t leaves_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
@@ -21,6 +21,18 @@
 
 namespace ripple {
 
+TransactionStateSF::~TransactionStateSF()
+{
+    try
+    {
+        flush();
+    }
+    catch (std::exception const&)
+    {
+        // A node that was not stored is fetched again when it is read
+    }
+}
+
 void
 TransactionStateSF::gotNode(
     bool,
@@ -31,11 +43,25 @@ TransactionStateSF::gotNode(
 
 {
     assert(type != SHAMapNodeType::tnTRANSACTION_NM);
-    db_.store(
-        hotTRANSACTION_NODE,
-        std::move(nodeData),
-        nodeHash.as_uint256(),
-        ledgerSeq);
+    auto object = NodeObject::createObject(
+        hotTRANSACTION_NODE, std::move(nodeData), nodeHash.as_uint256());
+
+    // Nodes can arrive from several threads traversing the same map
+    NodeStore::Batch batch;
+    std::uint32_t batchSeq = 0;
+    {
+        std::lock_guard lock(mutex_);
+        if (ledgerSeq != ledgerSeq_)
+        {
+            batch.swap(batch_);
+            batchSeq = ledgerSeq_;
+            ledgerSeq_ = ledgerSeq;
+        }
+        batch_.push_back(std::move(object));
+    }
+
+    if (!batch.empty())
+        db_.storeBatch(batch, batchSeq);
 }
 
 boost::optional<Blob>
@@ -44,4 +70,19 @@ TransactionStateSF::getNode(SHAMapHash const& nodeHash) const
     return fp_.getFetchPack(nodeHash.as_uint256());
 }
 
+void
+TransactionStateSF::flush() const
+{
+    NodeStore::Batch batch;
+    std::uint32_t batchSeq;
+    {
+        std::lock_guard lock(mutex_);
+        if (batch_.empty())
+            return;
+        batch.swap(batch_);
+        batchSeq = ledgerSeq_;
+    }
+    db_.storeBatch(batch, batchSeq);
+}
+
 }  // namespace ripple
@@ -23,6 +23,7 @@
 #include <ripple/app/ledger/AbstractFetchPackContainer.h>
 #include <ripple/nodestore/Database.h>
 #include <ripple/shamap/SHAMapSyncFilter.h>
+#include <mutex>
 
 namespace ripple {
 
@@ -36,6 +37,9 @@ public:
     {
     }
 
+    // Stores the nodes received since the last flush
+    ~TransactionStateSF() override;
+
     void
     gotNode(
         bool fromFilter,
@@ -47,9 +51,18 @@ public:
     boost::optional<Blob>
     getNode(SHAMapHash const& nodeHash) const override;
 
+    /** Store the nodes received so far in one batch. */
+    void
+    flush() const;
+
 private:
     NodeStore::Database& db_;
     AbstractFetchPackContainer& fp_;
+
+    // Nodes received, and the ledger they belong to, waiting to be stored
+    mutable std::mutex mutex_;
+    mutable NodeStore::Batch batch_;
+    mutable std::uint32_t ledgerSeq_ = 0;
 };
 
 }  // namespace ripple
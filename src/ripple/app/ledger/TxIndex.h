@@ -0,0 +1,82 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_TXINDEX_H_INCLUDED
+#define RIPPLE_APP_LEDGER_TXINDEX_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+class Ledger;
+
+/** Where a validated transaction is.
+
+    The index maps the hash of each transaction in a validated ledger to
+    its ledger, its position in the ledger and the transaction tree leaf
+    that holds it with its metadata. Entries are node objects of type
+    hotTX_INDEX, stored in the node store alongside the ledger, or in the
+    shard holding the ledger, so they are kept and deleted with it.
+
+    A transaction is then found with one key lookup and one fetch of its
+    leaf, without the Transactions table.
+*/
+struct TxLocation
+{
+    std::uint32_t ledgerSeq = 0;
+
+    // The transaction's position in its ledger, sfTransactionIndex
+    std::uint32_t txnSeq = 0;
+
+    // The hash of the transaction tree leaf holding the transaction
+    uint256 node;
+};
+
+/** The key of the index entry of a transaction.
+
+    It is derived from the transaction hash so it can not be the hash of a
+    tree node or ledger.
+*/
+uint256
+txIndexKey(uint256 const& txID);
+
+/** The keys and contents of the index entries of a ledger's transactions.
+
+    Throws if the ledger's transaction tree is missing nodes.
+*/
+std::vector<std::pair<uint256, Blob>>
+makeTxIndex(Ledger const& ledger);
+
+boost::optional<TxLocation>
+parseTxIndex(NodeObject const& object);
+
+/** Look a transaction up in the node store, then in the shards. */
+boost::optional<TxLocation>
+findTxIndex(Application& app, uint256 const& txID);
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_TXSETSKETCH_H_INCLUDED
+#define RIPPLE_APP_LEDGER_TXSETSKETCH_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/shamap/SHAMap.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+/** A compact summary of a set of transaction IDs.
+
+    The sketch is an invertible Bloom lookup table. Subtracting the sketch
+    of one set from the sketch of another, built with the same number of
+    cells, leaves a sketch of their symmetric difference, which can be
+    listed as long as it holds no more IDs than the sketch was sized for.
+    The size of a sketch depends only on the difference it can list, not
+    on the size of the sets, which lets two peers find the transactions
+    their sets disagree on in one exchange.
+*/
+class TxSetSketch
+{
+public:
+    /** The IDs a difference of sets consists of. */
+    struct Difference
+    {
+        // In the set the sketch was built from
+        std::vector<uint256> added;
+        // In the set that was subtracted
+        std::vector<uint256> removed;
+    };
+
+    /** Create an empty sketch.
+
+        @param cells The number of cells, which is rounded up to a multiple
+                     of the number of cells each ID is stored in.
+    */
+    explicit TxSetSketch(std::size_t cells);
+
+    // The largest sketch peers exchange
+    static constexpr std::size_t maxCells = 3 * 1024;
+
+    /** The number of cells needed to list a difference of this size. */
+    static std::size_t
+    cellsFor(std::size_t differences);
+
+    std::size_t
+    cells() const
+    {
+        return cells_.size();
+    }
+
+    void
+    insert(uint256 const& id);
+
+    /** Subtract the sketch of another set.
+
+        @return false if the sketches have different numbers of cells.
+    */
+    bool
+    subtract(TxSetSketch const& other);
+
+    /** List the IDs the sketch holds.
+
+        @return An unseated optional if the sketch holds more IDs than it
+                can list.
+    */
+    std::optional<Difference>
+    decode() const;
+
+    std::string
+    serialize() const;
+
+    /** Parse a serialized sketch, or return an unseated optional if it is
+        malformed or larger than maxCells.
+    */
+    static std::optional<TxSetSketch>
+    deserialize(Slice data);
+
+private:
+    struct Cell
+    {
+        std::int32_t count = 0;
+        uint256 idSum;
+        std::uint64_t checkSum = 0;
+    };
+
+    // Number of cells each ID is stored in, one in each part of the table
+    static constexpr std::size_t hashCount = 3;
+
+    void
+    toggle(uint256 const& id, std::int32_t count);
+
+    bool
+    pure(Cell const& cell) const;
+
+    std::vector<Cell> cells_;
+};
+
+/** Build the sketch of a transaction set. */
+TxSetSketch
+makeTxSetSketch(SHAMap const& set, std::size_t cells);
+
+}  // namespace ripple
+
+#endif
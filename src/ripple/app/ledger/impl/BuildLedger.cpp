@@ -24,7 +24,14 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/tx/apply.h>
+#include <ripple/basics/Tracer.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/ledger/OpenView.h>
 #include <ripple/protocol/Feature.h>
+#include <ripple/protocol/STTx.h>
+#include <functional>
+#include <set>
+#include <vector>
 
 namespace ripple {
 
@@ -33,6 +40,9 @@ namespace ripple {
    It is responsible for adding transactions to the open view to generate the
    new ledger. It is generic since the mechanics differ for consensus
    generated ledgers versus replayed ledgers.
+
+   If deferWrites is set, the new nodes are hashed but not written to the
+   node store; the ledger holds their writes until storeDeferredWrites.
 */
 template <class ApplyTxs>
 std::shared_ptr<Ledger>
@@ -43,8 +53,13 @@ buildLedgerImpl(
     NetClock::duration closeResolution,
     Application& app,
     beast::Journal j,
+    bool deferWrites,
     ApplyTxs&& applyTxs)
 {
+    auto& tracer = app.getTracer();
+    perf::Tracer::Span span(
+        tracer, "buildLedger", "ledger", parent->info().seq + 1);
+
     auto built = std::make_shared<Ledger>(*parent, closeTime);
 
     if (built->isFlagLedger() && built->rules().enabled(featureNegativeUNL))
@@ -56,6 +71,8 @@ buildLedgerImpl(
     //   perform updates, extract changes
 
     {
+        perf::Tracer::Span applySpan(
+            tracer, "applyTransactions", "ledger", built->info().seq);
         OpenView accum(&*built);
         assert(!accum.open());
         applyTxs(accum, built);
@@ -66,9 +83,22 @@ buildLedgerImpl(
     {
         // Write the final version of all modified SHAMap
         // nodes to the node store to preserve the new LCL
+        perf::Tracer::Span flushSpan(
+            tracer, "flushDirty", "ledger", built->info().seq);
 
-        int const asf = built->stateMap().flushDirty(hotACCOUNT_NODE);
-        int const tmf = built->txMap().flushDirty(hotTRANSACTION_NODE);
+        int asf, tmf;
+        if (deferWrites)
+        {
+            auto writes = std::make_shared<SHAMapDeferredWrites>();
+            asf = built->stateMap().flushDirty(hotACCOUNT_NODE, *writes);
+            tmf = built->txMap().flushDirty(hotTRANSACTION_NODE, *writes);
+            built->setDeferredWrites(std::move(writes));
+        }
+        else
+        {
+            asf = built->stateMap().flushDirty(hotACCOUNT_NODE);
+            tmf = built->txMap().flushDirty(hotTRANSACTION_NODE);
+        }
         JLOG(j.debug()) << "Flushed " << asf << " accounts and " << tmf
                         << " transaction nodes";
     }
@@ -81,71 +111,552 @@ buildLedgerImpl(
     return built;
 }
 
-/** Apply a set of consensus transactions to a ledger.
+namespace {
 
-  @param app Handle to application
-  @param txns the set of transactions to apply,
-  @param failed set of transactions that failed to apply
-  @param view ledger to apply to
-  @param j Journal for logging
-  @return number of transactions applied; transactions to retry left in txns
+/** The keys written by the transactions committed so far in a pass. */
+struct Changes
+{
+    std::set<uint256> state;
+    std::set<uint256> txs;
+};
+
+/** A view that records what is read through it.
+
+    A transaction applied speculatively reads the ledger through one of
+    these. When it comes to be committed, the record shows whether a
+    transaction committed before it changed anything it saw.
 */
+class RecordingView : public ReadView
+{
+private:
+    ReadView const& base_;
 
-std::size_t
-applyTransactions(
+    // State keys read
+    std::vector<uint256> mutable keys_;
+
+    // Ranges of state keys searched. Each covers the keys above `first`,
+    // up to and including `second` if it is set.
+    std::vector<std::pair<uint256, boost::optional<uint256>>> mutable ranges_;
+
+    // Transaction keys read
+    std::vector<uint256> mutable txs_;
+
+    // Whether the state or transactions were iterated
+    bool mutable all_ = false;
+
+public:
+    explicit RecordingView(ReadView const& base) : base_(base)
+    {
+    }
+
+    /** Returns `true` if `changes` could affect what was read. */
+    bool
+    changedBy(Changes const& changes) const
+    {
+        if (all_)
+            return !changes.state.empty() || !changes.txs.empty();
+
+        for (auto const& key : keys_)
+        {
+            if (changes.state.count(key) != 0)
+                return true;
+        }
+
+        for (auto const& [first, last] : ranges_)
+        {
+            auto const iter = changes.state.upper_bound(first);
+            if (iter != changes.state.end() && (!last || *iter <= *last))
+                return true;
+        }
+
+        for (auto const& key : txs_)
+        {
+            if (changes.txs.count(key) != 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool
+    open() const override
+    {
+        return base_.open();
+    }
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    bool
+    exists(Keylet const& k) const override
+    {
+        keys_.push_back(k.key);
+        return base_.exists(k);
+    }
+
+    boost::optional<key_type>
+    succ(
+        key_type const& key,
+        boost::optional<key_type> const& last = boost::none) const override
+    {
+        auto const next = base_.succ(key, last);
+        ranges_.emplace_back(key, next ? next : last);
+        return next;
+    }
+
+    std::shared_ptr<SLE const>
+    read(Keylet const& k) const override
+    {
+        keys_.push_back(k.key);
+        return base_.read(k);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        all_ = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        all_ = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound(key_type const& key) const override
+    {
+        all_ = true;
+        return base_.slesUpperBound(key);
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        all_ = true;
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        all_ = true;
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists(key_type const& key) const override
+    {
+        txs_.push_back(key);
+        return base_.txExists(key);
+    }
+
+    tx_type
+    txRead(key_type const& key) const override
+    {
+        txs_.push_back(key);
+        return base_.txRead(key);
+    }
+};
+
+/** The changes one transaction made, held until they are committed. */
+class StagedChanges : public TxsRawView
+{
+private:
+    enum class Action {
+        erase,
+        insert,
+        replace,
+    };
+
+    struct Tx
+    {
+        uint256 key;
+        std::shared_ptr<Serializer const> txn;
+        std::shared_ptr<Serializer const> meta;
+    };
+
+    std::vector<std::pair<Action, std::shared_ptr<SLE>>> items_;
+    std::vector<Tx> txs_;
+    XRPAmount dropsDestroyed_{0};
+
+public:
+    /** Number the transactions as if applied after `count` others.
+
+        Throws if the metadata can not be rewritten, before anything
+        is changed.
+    */
+    void
+    renumber(std::size_t count)
+    {
+        std::vector<std::shared_ptr<Serializer const>> metas;
+        metas.reserve(txs_.size());
+        for (auto const& tx : txs_)
+        {
+            auto const index = static_cast<std::uint32_t>(count++);
+            if (!tx.meta)
+            {
+                metas.push_back(nullptr);
+                continue;
+            }
+            STObject meta(SerialIter{tx.meta->slice()}, sfMetadata);
+            if (meta.getFieldU32(sfTransactionIndex) == index)
+            {
+                metas.push_back(tx.meta);
+                continue;
+            }
+            meta.setFieldU32(sfTransactionIndex, index);
+            auto s = std::make_shared<Serializer>();
+            meta.add(*s);
+            metas.push_back(std::move(s));
+        }
+        for (std::size_t i = 0; i < txs_.size(); ++i)
+            txs_[i].meta = std::move(metas[i]);
+    }
+
+    /** Apply the changes to `to`, noting the keys in `changes`. */
+    void
+    apply(OpenView& to, Changes& changes) const
+    {
+        for (auto const& [action, sle] : items_)
+        {
+            changes.state.insert(sle->key());
+            switch (action)
+            {
+                case Action::erase:
+                    to.rawErase(sle);
+                    break;
+                case Action::insert:
+                    to.rawInsert(sle);
+                    break;
+                case Action::replace:
+                    to.rawReplace(sle);
+                    break;
+            }
+        }
+        if (dropsDestroyed_ != beast::zero)
+            to.rawDestroyXRP(dropsDestroyed_);
+        for (auto const& tx : txs_)
+        {
+            changes.txs.insert(tx.key);
+            to.rawTxInsert(tx.key, tx.txn, tx.meta);
+        }
+    }
+
+    void
+    rawErase(std::shared_ptr<SLE> const& sle) override
+    {
+        items_.emplace_back(Action::erase, sle);
+    }
+
+    void
+    rawInsert(std::shared_ptr<SLE> const& sle) override
+    {
+        items_.emplace_back(Action::insert, sle);
+    }
+
+    void
+    rawReplace(std::shared_ptr<SLE> const& sle) override
+    {
+        items_.emplace_back(Action::replace, sle);
+    }
+
+    void
+    rawDestroyXRP(XRPAmount const& fee) override
+    {
+        dropsDestroyed_ += fee;
+    }
+
+    void
+    rawTxInsert(
+        ReadView::key_type const& key,
+        std::shared_ptr<Serializer const> const& txn,
+        std::shared_ptr<Serializer const> const& metaData) override
+    {
+        txs_.push_back({key, txn, metaData});
+    }
+};
+
+/** A transaction applied ahead of its turn. */
+struct Speculation
+{
+    std::unique_ptr<RecordingView> reads;
+    StagedChanges changes;
+    ApplyResult result = ApplyResult::Retry;
+    bool valid = false;
+};
+
+// The number of transactions applied ahead of their turn at once, for
+// each thread. Later transactions see the commits of earlier batches.
+std::size_t constexpr speculationBatch = 8;
+
+/** Make one pass over a transaction set on several threads.
+
+    Transactions are gathered into batches. Each batch is applied on the
+    pool, every transaction against the view as it stood before the
+    batch. The results are then committed in canonical order. One whose
+    reads were changed by an earlier commit in the pass, or that should
+    not be run twice, is applied again in order against the view as it
+    now stands. The outcome is the same as that of a serial pass.
+
+    @return The number of transactions that were applied.
+*/
+int
+applyPassOnPool(
+    std::size_t threads,
     Application& app,
     std::shared_ptr<Ledger const> const& built,
     CanonicalTXSet& txns,
     std::set<TxID>& failed,
     OpenView& view,
+    bool firstPass,
+    bool certainRetry,
     beast::Journal j)
 {
-    bool certainRetry = true;
-    std::size_t count = 0;
-
-    // Attempt to apply all of the retriable transactions
-    for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
+    int changes = 0;
+    std::size_t reapplied = 0;
+    Changes committed;
+    std::vector<CanonicalTXSet::const_iterator> batch;
+    std::vector<Speculation> speculations;
+
+    auto it = txns.begin();
+    while (it != txns.end())
     {
-        JLOG(j.debug()) << (certainRetry ? "Pass: " : "Final pass: ") << pass
-                        << " begins (" << txns.size() << " transactions)";
-        int changes = 0;
+        batch.clear();
+        while (it != txns.end() && batch.size() < threads * speculationBatch)
+        {
+            auto const current = it++;
+            try
+            {
+                if (firstPass && built->txExists(current->first.getTXID()))
+                {
+                    txns.erase(current);
+                    continue;
+                }
+            }
+            catch (std::exception const&)
+            {
+                JLOG(j.warn()) << "Transaction " << current->first.getTXID()
+                               << " throws";
+                failed.insert(current->first.getTXID());
+                txns.erase(current);
+                continue;
+            }
+            batch.push_back(current);
+        }
 
-        auto it = txns.begin();
+        speculations.clear();
+        speculations.resize(batch.size());
+        auto const baseTxCount = view.txCount();
+        std::function<void(std::size_t)> const speculate =
+            [&](std::size_t i) {
+                auto const& tx = *batch[i]->second;
+                // Pseudo-transactions act on the server itself
+                if (isPseudoTx(tx))
+                    return;
+                auto& s = speculations[i];
+                try
+                {
+                    s.reads = std::make_unique<RecordingView>(view);
+                    OpenView spec(batch_view, s.reads.get(), baseTxCount + i);
+                    s.result = applyTransaction(
+                        app, spec, tx, certainRetry, tapNONE, j);
+                    spec.apply(s.changes);
+                    s.valid = true;
+                }
+                catch (std::exception const&)
+                {
+                }
+            };
+        app.getWorkerPool().run(batch.size(), speculate, 1);
 
-        while (it != txns.end())
+        for (std::size_t i = 0; i < batch.size(); ++i)
         {
-            auto const txid = it->first.getTXID();
+            auto const current = batch[i];
+            auto const txid = current->first.getTXID();
+            auto& s = speculations[i];
 
             try
             {
-                if (pass == 0 && built->txExists(txid))
+                if (s.valid && s.reads->changedBy(committed))
+                    s.valid = false;
+
+                if (s.valid)
                 {
-                    it = txns.erase(it);
-                    continue;
+                    try
+                    {
+                        s.changes.renumber(view.txCount());
+                    }
+                    catch (std::exception const&)
+                    {
+                        s.valid = false;
+                    }
+                }
+
+                ApplyResult result;
+                if (s.valid)
+                {
+                    s.changes.apply(view, committed);
+                    result = s.result;
+                }
+                else
+                {
+                    OpenView spec(batch_view, &view, view.txCount());
+                    result = applyTransaction(
+                        app, spec, *current->second, certainRetry, tapNONE, j);
+                    StagedChanges staged;
+                    spec.apply(staged);
+                    staged.apply(view, committed);
+                    ++reapplied;
                 }
 
-                switch (applyTransaction(
-                    app, view, *it->second, certainRetry, tapNONE, j))
+                switch (result)
                 {
                     case ApplyResult::Success:
-                        it = txns.erase(it);
+                        txns.erase(current);
                         ++changes;
                         break;
 
                     case ApplyResult::Fail:
                         failed.insert(txid);
-                        it = txns.erase(it);
+                        txns.erase(current);
                         break;
 
                     case ApplyResult::Retry:
-                        ++it;
+                        break;
                 }
             }
             catch (std::exception const&)
             {
                 JLOG(j.warn()) << "Transaction " << txid << " throws";
                 failed.insert(txid);
-                it = txns.erase(it);
+                txns.erase(current);
+            }
+        }
+    }
+
+    JLOG(j.debug()) << reapplied << " transactions applied again in order";
+    return changes;
+}
+
+}  // namespace
+
+/** Apply a set of consensus transactions to a ledger.
+
+  @param app Handle to application
+  @param txns the set of transactions to apply,
+  @param failed set of transactions that failed to apply
+  @param view ledger to apply to
+  @param j Journal for logging
+  @return number of transactions applied; transactions to retry left in txns
+*/
+
+std::size_t
+applyTransactions(
+    Application& app,
+    std::shared_ptr<Ledger const> const& built,
+    CanonicalTXSet& txns,
+    std::set<TxID>& failed,
+    OpenView& view,
+    beast::Journal j)
+{
+    bool certainRetry = true;
+    std::size_t count = 0;
+
+    // Verify any signatures not already known on several threads, so the
+    // passes below find them in the cache.
+    {
+        std::vector<std::shared_ptr<STTx const>> all;
+        all.reserve(txns.size());
+        for (auto const& item : txns)
+            all.push_back(item.second);
+        checkSignatures(
+            app.getHashRouter(),
+            app.getSignatureCache(),
+            all,
+            view.rules(),
+            app.getWorkerPool());
+    }
+
+    auto const threads = app.config().LEDGER_APPLY_THREADS;
+    bool const parallel = threads > 1 && txns.size() > 1;
+
+    // Attempt to apply all of the retriable transactions
+    for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
+    {
+        JLOG(j.debug()) << (certainRetry ? "Pass: " : "Final pass: ") << pass
+                        << " begins (" << txns.size() << " transactions)";
+        int changes = 0;
+
+        if (parallel)
+        {
+            changes = applyPassOnPool(
+                threads,
+                app,
+                built,
+                txns,
+                failed,
+                view,
+                pass == 0,
+                certainRetry,
+                j);
+        }
+        else
+        {
+            auto it = txns.begin();
+
+            while (it != txns.end())
+            {
+                auto const txid = it->first.getTXID();
+
+                try
+                {
+                    if (pass == 0 && built->txExists(txid))
+                    {
+                        it = txns.erase(it);
+                        continue;
+                    }
+
+                    switch (applyTransaction(
+                        app, view, *it->second, certainRetry, tapNONE, j))
+                    {
+                        case ApplyResult::Success:
+                            it = txns.erase(it);
+                            ++changes;
+                            break;
+
+                        case ApplyResult::Fail:
+                            failed.insert(txid);
+                            it = txns.erase(it);
+                            break;
+
+                        case ApplyResult::Retry:
+                            ++it;
+                    }
+                }
+                catch (std::exception const&)
+                {
+                    JLOG(j.warn()) << "Transaction " << txid << " throws";
+                    failed.insert(txid);
+                    it = txns.erase(it);
+                }
             }
         }
 
@@ -193,6 +704,7 @@ buildLedger(
         closeResolution,
         app,
         j,
+        app.config().PIPELINED_CLOSE,
         [&](OpenView& accum, std::shared_ptr<Ledger> const& built) {
             JLOG(j.debug())
                 << "Attempting to apply " << txns.size() << " transactions";
@@ -215,7 +727,9 @@ buildLedger(
     LedgerReplay const& replayData,
     ApplyFlags applyFlags,
     Application& app,
-    beast::Journal j)
+    beast::Journal j,
+    std::function<void(STTx const&, std::chrono::steady_clock::duration)> const&
+        onApplied)
 {
     auto const& replayLedger = replayData.replay();
 
@@ -228,9 +742,35 @@ buildLedger(
         replayLedger->info().closeTimeResolution,
         app,
         j,
+        false,
         [&](OpenView& accum, std::shared_ptr<Ledger> const& built) {
+            // The transactions are applied in order on this thread, but
+            // their signatures can be verified on several first.
+            std::vector<std::shared_ptr<STTx const>> all;
+            all.reserve(replayData.orderedTxns().size());
+            for (auto const& tx : replayData.orderedTxns())
+                all.push_back(tx.second);
+            checkSignatures(
+                app.getHashRouter(),
+                app.getSignatureCache(),
+                all,
+                accum.rules(),
+                app.getWorkerPool());
+
             for (auto& tx : replayData.orderedTxns())
+            {
+                if (!onApplied)
+                {
+                    applyTransaction(
+                        app, accum, *tx.second, false, applyFlags, j);
+                    continue;
+                }
+
+                auto const start = std::chrono::steady_clock::now();
                 applyTransaction(app, accum, *tx.second, false, applyFlags, j);
+                onApplied(
+                    *tx.second, std::chrono::steady_clock::now() - start);
+            }
         });
 }
 
@@ -26,7 +26,9 @@
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobQueue.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/nodestore/Scheduler.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/jss.h>
@@ -66,11 +68,18 @@ enum {
     // Number of nodes to request blindly
     ,
     reqNodes = 8
+
+    // Number of fastest peers a request to the whole set is split among
+    ,
+    peerCountSplit = 3
 };
 
 // millisecond for each ledger timeout
 auto constexpr ledgerAcquireTimeout = 2500ms;
 
+// Fewest nodes of a reply worth handing to another decoding thread
+std::size_t constexpr minNodesPerThread = 64;
+
 InboundLedger::InboundLedger(
     Application& app,
     uint256 const& hash,
@@ -102,6 +111,8 @@ InboundLedger::InboundLedger(
 void
 InboundLedger::init(ScopedLockType& collectionLock)
 {
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::ledgerSync);
     ScopedLockType sl(mtx_);
     collectionLock.unlock();
 
@@ -189,6 +200,8 @@ InboundLedger::update(std::uint32_t seq)
 bool
 InboundLedger::checkLocal()
 {
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::ledgerSync);
     ScopedLockType sl(mtx_);
     if (!isDone())
     {
@@ -302,10 +315,10 @@ InboundLedger::tryDB(NodeStore::Database& srcDB)
 {
     if (!mHaveHeader)
     {
-        auto makeLedger = [&, this](Blob const& data) {
+        auto makeLedger = [&, this](Slice data) {
             JLOG(journal_.trace()) << "Ledger header found in fetch pack";
             mLedger = std::make_shared<Ledger>(
-                deserializePrefixedHeader(makeSlice(data)),
+                deserializePrefixedHeader(data),
                 app_.config(),
                 mReason == Reason::SHARD ? *app_.getShardFamily()
                                          : app_.getNodeFamily());
@@ -334,7 +347,8 @@ InboundLedger::tryDB(NodeStore::Database& srcDB)
             auto& dstDB{mLedger->stateMap().family().db()};
             if (std::addressof(dstDB) != std::addressof(srcDB))
             {
-                Blob blob{nodeObject->getData()};
+                auto const data = nodeObject->getData();
+                Blob blob{data.begin(), data.end()};
                 dstDB.store(
                     hotLEDGER, std::move(blob), hash_, mLedger->info().seq);
             }
@@ -348,7 +362,7 @@ InboundLedger::tryDB(NodeStore::Database& srcDB)
 
             JLOG(journal_.trace()) << "Ledger header found in fetch pack";
 
-            makeLedger(*data);
+            makeLedger(makeSlice(*data));
             if (failed_)
                 return;
 
@@ -422,6 +436,8 @@ InboundLedger::tryDB(NodeStore::Database& srcDB)
 void
 InboundLedger::onTimer(bool wasProgress, ScopedLockType&)
 {
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::ledgerSync);
     mRecentNodes.clear();
 
     if (isDone())
@@ -430,6 +446,19 @@ InboundLedger::onTimer(bool wasProgress, ScopedLockType&)
         return;
     }
 
+    if (auto const fastest =
+            getFastestPeers(app_.overlay(), *mPeerSet, peerCountSplit);
+        !fastest.empty())
+        adaptTimer(*fastest.back()->responseTime());
+
+    // Ranges of the state a peer hasn't answered for may go to another
+    if (mStateTransfer && !mStateFinishing)
+    {
+        mStateTransfer->timeout();
+        if (wasProgress && !transferState(nullptr))
+            trigger(nullptr, TriggerReason::timeout);
+    }
+
     if (timeouts_ > ledgerTimeoutRetriesMax)
     {
         if (mSeq != 0)
@@ -681,6 +710,10 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
         {
             failed_ = true;
         }
+        else if (transferState(peer))
+        {
+            // Fetch the transactions while the state's leaves come in
+        }
         else if (mLedger->stateMap().getHash().isZero())
         {
             // we need the root node
@@ -733,7 +766,7 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
                             << "Sending AS node request (" << nodes.size()
                             << ") to "
                             << (peer ? "selected peer" : "all peers");
-                        mPeerSet->sendRequest(tmGL, peer);
+                        sendNodeRequest(tmGL, peer);
                         return;
                     }
                     else
@@ -797,7 +830,7 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
                     JLOG(journal_.trace())
                         << "Sending TX node request (" << nodes.size()
                         << ") to " << (peer ? "selected peer" : "all peers");
-                    mPeerSet->sendRequest(tmGL, peer);
+                    sendNodeRequest(tmGL, peer);
                     return;
                 }
                 else
@@ -818,6 +851,37 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
     }
 }
 
+void
+InboundLedger::sendNodeRequest(
+    protocol::TMGetLedger& tmGL,
+    std::shared_ptr<Peer> const& peer)
+{
+    if (peer || tmGL.nodeids_size() < 2)
+        return mPeerSet->sendRequest(tmGL, peer);
+
+    auto const fastest =
+        getFastestPeers(app_.overlay(), *mPeerSet, peerCountSplit);
+
+    // Until enough peers have answered, ask all of them for everything
+    if (fastest.size() < 2)
+        return mPeerSet->sendRequest(tmGL, peer);
+
+    // Each of the fastest peers is asked for an interleaved share of the
+    // nodes, so no one slow peer holds up the whole request
+    google::protobuf::RepeatedPtrField<std::string> nodeIDs;
+    nodeIDs.Swap(tmGL.mutable_nodeids());
+
+    std::size_t const count = nodeIDs.size();
+    auto const shares = std::min(fastest.size(), count);
+    for (std::size_t i = 0; i < shares; ++i)
+    {
+        tmGL.clear_nodeids();
+        for (auto j = i; j < count; j += shares)
+            *tmGL.add_nodeids() = nodeIDs[j];
+        mPeerSet->sendRequest(tmGL, fastest[i]);
+    }
+}
+
 void
 InboundLedger::filterNodes(
     std::vector<std::pair<SHAMapNodeID, uint256>>& nodes,
@@ -909,11 +973,49 @@ InboundLedger::takeHeader(std::string const& data)
     return true;
 }
 
+/** Decode and hash the nodes of a reply
+    Call without the lock. Replies with many nodes are shared out among
+    the threads of the worker pool. A node that fails to decode is left
+    null.
+*/
+std::vector<InboundLedger::DecodedNode>
+InboundLedger::decodeNodes(protocol::TMLedgerData const& packet) const
+{
+    auto const& wire = packet.nodes();
+    std::vector<DecodedNode> nodes(wire.size());
+
+    app_.getWorkerPool().run(
+        wire.size(),
+        [&](std::size_t i) {
+            auto& decoded = nodes[i];
+            decoded.id = deserializeSHAMapNodeID(wire[i].nodeid());
+
+            // Building the node computes its hash, which is all that's
+            // left to compare once the node is attached to the map
+            try
+            {
+                decoded.node = SHAMapTreeNode::makeFromWire(
+                    makeSlice(wire[i].nodedata()));
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(journal_.debug())
+                    << "Received bad node data: " << e.what();
+            }
+        },
+        minNodesPerThread);
+
+    return nodes;
+}
+
 /** Process node data received from a peer
     Call with a lock
 */
 void
-InboundLedger::receiveNode(protocol::TMLedgerData& packet, SHAMapAddNode& san)
+InboundLedger::receiveNode(
+    protocol::TMLedgerData& packet,
+    std::vector<DecodedNode> const& nodes,
+    SHAMapAddNode& san)
 {
     if (!mHaveHeader)
     {
@@ -952,10 +1054,8 @@ InboundLedger::receiveNode(protocol::TMLedgerData& packet, SHAMapAddNode& san)
 
     try
     {
-        for (auto const& node : packet.nodes())
+        for (auto const& [nodeID, node] : nodes)
         {
-            auto const nodeID = deserializeSHAMapNodeID(node.nodeid());
-
             if (!nodeID)
             {
                 san.incInvalid();
@@ -963,11 +1063,9 @@ InboundLedger::receiveNode(protocol::TMLedgerData& packet, SHAMapAddNode& san)
             }
 
             if (nodeID->isRoot())
-                san += map.addRootNode(
-                    rootHash, makeSlice(node.nodedata()), filter.get());
+                san += map.addRootNode(rootHash, node, filter.get());
             else
-                san += map.addKnownNode(
-                    *nodeID, makeSlice(node.nodedata()), filter.get());
+                san += map.addKnownNode(*nodeID, node, filter.get());
 
             if (!san.isGood())
             {
@@ -1088,6 +1186,164 @@ InboundLedger::getNeededHashes()
 /** Stash a TMLedgerData received from a peer for later processing
     Returns 'true' if we need to dispatch
 */
+bool
+InboundLedger::transferState(std::shared_ptr<Peer> const& peer)
+{
+    if (mStateFinishing)
+        return true;
+
+    if (!mStateTransfer)
+    {
+        // A server that never validated a ledger has next to none of the
+        // state, so fetching all its leaves beats walking its tree. The
+        // choice is made once, before any of the state's nodes are asked
+        // for.
+        if (mFetchStateNodes || !app_.config().STATE_TRANSFER ||
+            mReason == Reason::HISTORY || mReason == Reason::SHARD ||
+            app_.getLedgerMaster().haveValidated() || statePeers().empty())
+        {
+            mFetchStateNodes = true;
+            return false;
+        }
+
+        JLOG(journal_.debug()) << "Transferring the state of " << hash_;
+        mStateTransfer = std::make_unique<StateTransfer>(
+            hash_,
+            SHAMapHash{mLedger->info().accountHash},
+            mLedger->stateMap().family());
+    }
+
+    if (!requestStateRanges(peer))
+    {
+        JLOG(journal_.info())
+            << "No peer to transfer the state of " << hash_ << " from";
+        mStateTransfer.reset();
+        mFetchStateNodes = true;
+        return false;
+    }
+    return true;
+}
+
+bool
+InboundLedger::requestStateRanges(std::shared_ptr<Peer> const& peer)
+{
+    auto peers = statePeers();
+    if (peers.empty())
+        return mStateTransfer->waiting();
+
+    if (peer)
+    {
+        if (auto const it = std::find(peers.begin(), peers.end(), peer);
+            it != peers.end())
+            std::iter_swap(peers.begin(), it);
+    }
+
+    // Spread the ranges among the peers
+    for (std::size_t i = 0;; ++i)
+    {
+        auto const& target = peers[i % peers.size()];
+        auto const request = mStateTransfer->nextRequest(target->id());
+        if (!request)
+            break;
+        target->send(
+            std::make_shared<Message>(*request, protocol::mtGET_STATE_RANGE));
+    }
+    return true;
+}
+
+std::vector<std::shared_ptr<Peer>>
+InboundLedger::statePeers() const
+{
+    std::vector<std::shared_ptr<Peer>> peers;
+    for (auto const id : mPeerSet->getPeerIds())
+    {
+        if (auto p = app_.overlay().findPeerByShortID(id); p &&
+            p->supportsFeature(ProtocolFeature::StateTransfer) &&
+            (!mStateTransfer || mStateTransfer->usable(id)))
+            peers.push_back(std::move(p));
+    }
+    return peers;
+}
+
+void
+InboundLedger::gotStateRange(
+    std::shared_ptr<Peer> const& peer,
+    protocol::TMStateRange const& reply)
+{
+    ScopedLockType sl(mtx_);
+
+    if (isDone() || !mStateTransfer || mStateFinishing)
+        return;
+
+    switch (mStateTransfer->take(peer->id(), reply))
+    {
+        case StateTransfer::Result::stale:
+            return;
+        case StateTransfer::Result::bad:
+            JLOG(journal_.warn()) << "Bad state range from " << peer->id();
+            peer->charge(Resource::feeBadData);
+            break;
+        case StateTransfer::Result::refused:
+            JLOG(journal_.debug()) << "No state range from " << peer->id();
+            break;
+        case StateTransfer::Result::useful:
+            progress_ = true;
+            break;
+    }
+
+    if (!mStateTransfer->complete())
+    {
+        if (!transferState(peer))
+        {
+            sl.unlock();
+            trigger(nullptr, TriggerReason::reply);
+        }
+        return;
+    }
+
+    // Hashing and storing the whole state takes a while, so do it
+    // without the lock
+    mStateFinishing = true;
+    sl.unlock();
+    auto const map = mStateTransfer->finish();
+    if (map)
+    {
+        map->setLedgerSeq(mLedger->info().seq);
+        map->flushDirty(hotACCOUNT_NODE);
+    }
+    sl.lock();
+
+    mStateFinishing = false;
+    auto const leaves = mStateTransfer->leaves();
+    mStateTransfer.reset();
+    mFetchStateNodes = true;
+    if (isDone())
+        return;
+
+    // The nodes just stored make up the state map of the ledger
+    if (map &&
+        mLedger->stateMap().fetchRoot(
+            SHAMapHash{mLedger->info().accountHash}, nullptr))
+    {
+        JLOG(journal_.info()) << "Transferred the state of " << hash_ << ", "
+                              << leaves << " entries";
+        mHaveState = true;
+        if (mHaveTransactions)
+            complete_ = true;
+    }
+    else
+    {
+        JLOG(journal_.warn())
+            << "Transferred state of " << hash_ << " doesn't match";
+    }
+
+    sl.unlock();
+    if (complete_)
+        done();
+    else
+        trigger(nullptr, TriggerReason::reply);
+}
+
 bool
 InboundLedger::gotData(
     std::weak_ptr<Peer> peer,
@@ -1120,10 +1376,10 @@ InboundLedger::processData(
     std::shared_ptr<Peer> peer,
     protocol::TMLedgerData& packet)
 {
-    ScopedLockType sl(mtx_);
-
     if (packet.type() == protocol::liBASE)
     {
+        ScopedLockType sl(mtx_);
+
         if (packet.nodes_size() < 1)
         {
             JLOG(journal_.warn()) << "Got empty header data";
@@ -1195,8 +1451,14 @@ InboundLedger::processData(
             }
         }
 
+        // Decoding and hashing a large reply takes a while, so do it
+        // before taking the lock
+        auto const nodes = decodeNodes(packet);
+
+        ScopedLockType sl(mtx_);
+
         SHAMapAddNode san;
-        receiveNode(packet, san);
+        receiveNode(packet, nodes, san);
 
         if (packet.type() == protocol::liTX_NODE)
         {
@@ -1223,6 +1485,8 @@ InboundLedger::processData(
 void
 InboundLedger::runData()
 {
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::ledgerSync);
     std::shared_ptr<Peer> chosenPeer;
     int chosenPeerCount = -1;
 
@@ -19,6 +19,7 @@
 
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/InboundTransactions.h>
+#include <ripple/app/ledger/TxSetSketch.h>
 #include <ripple/app/ledger/impl/TransactionAcquire.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
@@ -26,6 +27,7 @@
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/RippleLedgerHash.h>
 #include <ripple/resource/Fees.h>
+#include <algorithm>
 #include <memory>
 #include <mutex>
 
@@ -122,7 +124,10 @@ public:
                 return std::shared_ptr<SHAMap>();
 
             ta = std::make_shared<TransactionAcquire>(
-                app_, hash, m_peerSetBuilder->build());
+                app_,
+                hash,
+                m_peerSetBuilder->build(),
+                app_.config().TX_RECONCILE ? m_position : nullptr);
 
             auto& obj = m_map[hash];
             obj.mAcquire = ta;
@@ -185,6 +190,79 @@ public:
             peer->charge(Resource::feeUnwantedData);
     }
 
+    protocol::TMReconcileTxSetResponse
+    processReconcileRequest(protocol::TMReconcileTxSet const& request) override
+    {
+        protocol::TMReconcileTxSetResponse reply;
+        reply.set_txsethash(request.txsethash());
+        reply.set_basesethash(request.basesethash());
+
+        auto const sketch =
+            TxSetSketch::deserialize(makeSlice(request.sketch()));
+        if (!sketch || request.txsethash().size() != uint256::size())
+        {
+            reply.set_error(protocol::TMReplyError::reBAD_REQUEST);
+            return reply;
+        }
+
+        auto const set = getSet(uint256{request.txsethash()}, false);
+        if (!set)
+        {
+            reply.set_error(protocol::TMReplyError::reNO_LEDGER);
+            return reply;
+        }
+
+        auto ours = makeTxSetSketch(*set, sketch->cells());
+        ours.subtract(*sketch);
+        auto const diff = ours.decode();
+
+        // A difference that doesn't match the set means the sketch was
+        // too small, and only happened to decode
+        auto const matches = diff &&
+            std::all_of(diff->added.begin(),
+                        diff->added.end(),
+                        [&set](auto const& id) { return set->hasItem(id); }) &&
+            std::none_of(diff->removed.begin(),
+                         diff->removed.end(),
+                         [&set](auto const& id) { return set->hasItem(id); });
+        if (!matches)
+        {
+            reply.set_error(protocol::TMReplyError::reNO_RECONCILE);
+            return reply;
+        }
+
+        for (auto const& id : diff->added)
+        {
+            auto const item = set->peekItem(id);
+            reply.add_transaction(item->data(), item->size());
+        }
+        for (auto const& id : diff->removed)
+            reply.add_removed(id.data(), id.size());
+
+        JLOG(app_.journal("InboundTransactions").debug())
+            << "Reconciled TX set " << to_string(uint256{request.txsethash()})
+            << ": " << diff->added.size() << " added, "
+            << diff->removed.size() << " removed";
+        return reply;
+    }
+
+    void
+    gotReconcile(
+        uint256 const& hash,
+        std::shared_ptr<Peer> peer,
+        std::shared_ptr<protocol::TMReconcileTxSetResponse> packet) override
+    {
+        TransactionAcquire::pointer ta = getAcquire(hash);
+
+        if (ta == nullptr)
+        {
+            peer->charge(Resource::feeUnwantedData);
+            return;
+        }
+
+        ta->takeReconcile(*packet, peer);
+    }
+
     void
     giveSet(
         uint256 const& hash,
@@ -207,6 +285,9 @@ public:
                 inboundSet.mSet = set;
 
             inboundSet.mAcquire.reset();
+
+            if (!fromAcquire)
+                m_position = set;
         }
 
         if (isNew)
@@ -247,6 +328,7 @@ public:
         std::lock_guard lock(mLock);
 
         m_map.clear();
+        m_position.reset();
 
         stopped();
     }
@@ -262,6 +344,10 @@ private:
     // The empty transaction set whose hash is zero
     InboundTransactionSet& m_zeroSet;
 
+    // The transaction set we last proposed, which sets we acquire are
+    // reconciled against
+    std::shared_ptr<SHAMap> m_position;
+
     std::function<void(std::shared_ptr<SHAMap> const&, bool)> m_gotSet;
 
     std::unique_ptr<PeerSetBuilder> m_peerSetBuilder;
@@ -0,0 +1,310 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/IssuerBalances.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/paths/RippleState.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/Config.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/ledger/View.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
+
+namespace ripple {
+
+// Catch up on at most this many ledgers before scanning in full instead
+static constexpr std::uint32_t maxDeltaLedgers = 256;
+
+// Scan each issuer's trust lines again after this many ledgers
+static constexpr std::uint32_t rescanLedgers = 4096;
+
+// Drop an issuer not asked about for this many ledgers
+static constexpr std::uint32_t idleLedgers = 1024;
+
+// Keep the totals of at most this many issuers
+static constexpr std::size_t maxIssuers = 32;
+
+IssuerBalances::IssuerBalances(Application& app, Stoppable& parent)
+    : Stoppable("IssuerBalances", parent)
+    , app_(app)
+    , j_(app.journal("IssuerBalances"))
+{
+}
+
+bool
+IssuerBalances::getTotals(
+    ReadView const& ledger,
+    AccountID const& issuer,
+    std::map<Currency, STAmount>& obligations,
+    std::map<AccountID, std::vector<STAmount>>& frozen,
+    std::map<AccountID, std::vector<STAmount>>& assets)
+{
+    std::lock_guard sl(mLock);
+    mRequested[issuer] = ledger.info().seq;
+
+    if (!mLedger || ledger.open() ||
+        ledger.info().hash != mLedger->info().hash)
+        return false;
+
+    auto const it = mTotals.find(issuer);
+    if (it == mTotals.end())
+        return false;
+
+    auto const& totals = it->second;
+    for (auto const& [currency, owed] : totals.obligations)
+        obligations[currency] = owed.first;
+    for (auto const& [line, balance] : totals.frozen)
+        frozen[line.first].push_back(balance);
+    for (auto const& [line, balance] : totals.assets)
+        assets[line.first].push_back(balance);
+    return true;
+}
+
+void
+IssuerBalances::setup(std::shared_ptr<ReadView const> const& ledger)
+{
+    {
+        std::lock_guard sl(mLock);
+        if (mTarget && mTarget->info().seq >= ledger->info().seq)
+            return;
+
+        mTarget = ledger;
+        if (mAdvancing)
+            return;
+        mAdvancing = true;
+    }
+
+    if (app_.config().standalone())
+        advance();
+    else
+        app_.getJobQueue().addJob(
+            jtUPDATE_PF, "IssuerBalances::advance", [this](Job&) {
+                advance();
+            });
+}
+
+void
+IssuerBalances::apply(
+    Totals& totals,
+    AccountID const& issuer,
+    std::shared_ptr<SLE const> const& sle,
+    bool add)
+{
+    auto const rs = RippleState::makeItem(issuer, sle);
+    if (!rs)
+        return;
+
+    // As in gateway_balances, a negative balance is owed by the issuer
+    auto const& balance = rs->getBalance();
+    int const balSign = balance.signum();
+    if (balSign == 0)
+        return;
+
+    auto const line =
+        std::make_pair(rs->getAccountIDPeer(), balance.getCurrency());
+
+    if (balSign > 0 || rs->getFreeze())
+    {
+        auto& held = balSign > 0 ? totals.assets : totals.frozen;
+        if (add)
+            held[line] = balSign > 0 ? balance : -balance;
+        else
+            held.erase(line);
+        return;
+    }
+
+    if (add)
+    {
+        auto& [sum, lines] = totals.obligations[line.second];
+        if (lines++ == 0)
+            sum = -balance;
+        else
+            sum -= balance;
+        return;
+    }
+
+    auto const it = totals.obligations.find(line.second);
+    if (it == totals.obligations.end())
+        return;
+    auto& [sum, lines] = it->second;
+    if (--lines == 0)
+        totals.obligations.erase(it);
+    else
+        sum += balance;
+}
+
+IssuerBalances::Totals
+IssuerBalances::scan(ReadView const& ledger, AccountID const& issuer)
+{
+    Totals totals;
+    forEachItem(ledger, issuer, [&](std::shared_ptr<SLE const> const& sle) {
+        apply(totals, issuer, sle, true);
+    });
+    totals.scanned = ledger.info().seq;
+    return totals;
+}
+
+bool
+IssuerBalances::applyDelta(
+    ReadView const& before,
+    ReadView const& after,
+    TotalsMap& next)
+{
+    hash_set<uint256> lines;
+    for (auto const& item : after.txs)
+    {
+        auto const& meta = item.second;
+        if (!meta)
+            return false;
+
+        for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+        {
+            if (node.getFieldU16(sfLedgerEntryType) == ltRIPPLE_STATE)
+                lines.insert(node.getFieldH256(sfLedgerIndex));
+        }
+    }
+
+    for (auto const& key : lines)
+    {
+        Keylet const k(ltRIPPLE_STATE, key);
+        auto const old = before.read(k);
+        auto const now = after.read(k);
+        auto const& sle = now ? now : old;
+        if (!sle)
+            continue;
+
+        for (auto const field : {&sfLowLimit, &sfHighLimit})
+        {
+            auto const issuer = sle->getFieldAmount(*field).getIssuer();
+            auto const it = next.find(issuer);
+            if (it == next.end())
+                continue;
+            if (old)
+                apply(it->second, issuer, old, false);
+            if (now)
+                apply(it->second, issuer, now, true);
+        }
+    }
+    return true;
+}
+
+void
+IssuerBalances::advance()
+{
+    for (;;)
+    {
+        std::shared_ptr<ReadView const> target;
+        std::shared_ptr<ReadView const> ledger;
+        TotalsMap next;
+        std::vector<AccountID> wanted;
+        {
+            std::lock_guard sl(mLock);
+            target = mTarget;
+            ledger = mLedger;
+            if (isStopping() || ledger == target)
+            {
+                mAdvancing = false;
+                return;
+            }
+
+            auto const seq = target->info().seq;
+            for (auto it = mRequested.begin(); it != mRequested.end();)
+            {
+                if (it->second + idleLedgers < seq)
+                    it = mRequested.erase(it);
+                else
+                    ++it;
+            }
+
+            for (auto const& [issuer, totals] : mTotals)
+            {
+                if (mRequested.count(issuer))
+                    next.emplace(issuer, totals);
+            }
+
+            for (auto const& [issuer, _] : mRequested)
+            {
+                (void)_;
+                if (!next.count(issuer) &&
+                    next.size() + wanted.size() < maxIssuers)
+                    wanted.push_back(issuer);
+            }
+        }
+
+        auto const targetSeq = target->info().seq;
+        try
+        {
+            bool current = false;
+            if (ledger && !next.empty() && targetSeq > ledger->info().seq &&
+                targetSeq - ledger->info().seq <= maxDeltaLedgers)
+            {
+                current = true;
+                auto before = ledger;
+                for (auto s = ledger->info().seq + 1;
+                     current && s <= targetSeq;
+                     ++s)
+                {
+                    std::shared_ptr<ReadView const> after = s == targetSeq
+                        ? target
+                        : app_.getLedgerMaster().getLedgerBySeq(s);
+                    current = after && !after->open() &&
+                        applyDelta(*before, *after, next);
+                    before = after;
+                }
+            }
+
+            for (auto& [issuer, totals] : next)
+            {
+                if (isStopping())
+                    break;
+                if (!current || totals.scanned + rescanLedgers <= targetSeq)
+                    totals = scan(*target, issuer);
+            }
+
+            for (auto const& issuer : wanted)
+            {
+                if (isStopping())
+                    break;
+                next.emplace(issuer, scan(*target, issuer));
+            }
+        }
+        catch (SHAMapMissingNode const& mn)
+        {
+            // Drop the totals; the next ledger will scan again
+            JLOG(j_.info()) << "IssuerBalances::advance: " << mn.what();
+            next.clear();
+        }
+
+        JLOG(j_.debug()) << "IssuerBalances::advance " << targetSeq << ": "
+                         << next.size() << " issuers";
+
+        std::lock_guard sl(mLock);
+        if (isStopping())
+        {
+            // Some of the totals may not have been brought up to date
+            mAdvancing = false;
+            return;
+        }
+        mTotals.swap(next);
+        mLedger = target;
+    }
+}
+
+}  // namespace ripple
@@ -21,8 +21,21 @@
 #include <ripple/app/ledger/LedgerCleaner.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
+#include <ripple/basics/FileUtilities.h>
 #include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/nodestore/Database.h>
 #include <ripple/protocol/jss.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 namespace detail {
@@ -39,16 +52,28 @@ Cleans up the ledger. Specifically, resolves these issues:
 
 2. Upon request, checks for missing nodes in a ledger and triggers a fetch.
 
+Ledgers are checked from the top of the range down by several workers at
+once, which share the node store's walk rate. Progress is saved to a file
+every few seconds, so that a clean still running when the server stops is
+picked up again when it starts.
+
 */
 
 class LedgerCleanerImp : public LedgerCleaner
 {
+    // How often the progress of a running clean is saved
+    static constexpr std::chrono::seconds checkpointInterval{10};
+
     Application& app_;
     beast::Journal const j_;
     mutable std::mutex mutex_;
 
     mutable std::condition_variable wakeup_;
 
+    // Signalled when a ledger is finished, or there is nothing left to give
+    // out, for workers waiting for one
+    std::condition_variable workReady_;
+
     std::thread thread_;
 
     enum class State : char { readyToClean = 0, startCleaning, cleaning };
@@ -58,9 +83,20 @@ class LedgerCleanerImp : public LedgerCleaner
     // The lowest ledger in the range we're checking.
     LedgerIndex minRange_ = 0;
 
-    // The highest ledger in the range we're checking
+    // The highest ledger in the range we're checking. Every ledger above it
+    // has been cleaned.
     LedgerIndex maxRange_ = 0;
 
+    // The next ledger to give to a worker
+    LedgerIndex next_ = 0;
+
+    // Ledgers below maxRange_ already cleaned
+    std::set<LedgerIndex> cleaned_;
+
+    // Changes when the range is set again, so that workers drop the
+    // ledgers they were given from the previous one
+    std::uint64_t generation_ = 0;
+
     // Check all state/transaction nodes
     bool checkNodes_ = false;
 
@@ -70,13 +106,34 @@ class LedgerCleanerImp : public LedgerCleaner
     // Number of errors encountered since last success
     int failures_ = 0;
 
+    // Ledgers cleaned since the cleaner last started, and when
+    std::uint32_t checked_ = 0;
+    std::chrono::steady_clock::time_point started_;
+
+    // When the progress of the running clean is next saved
+    std::chrono::steady_clock::time_point nextCheckpoint_;
+
+    // Ledgers checked at the same time
+    int const workers_;
+
+    // Where progress is saved to resume after a restart, if anywhere
+    boost::filesystem::path const checkpoint_;
+
     //--------------------------------------------------------------------------
 public:
     LedgerCleanerImp(
         Application& app,
         Stoppable& stoppable,
         beast::Journal journal)
-        : LedgerCleaner(stoppable), app_(app), j_(journal)
+        : LedgerCleaner(stoppable)
+        , app_(app)
+        , j_(journal)
+        , workers_(std::clamp(
+              get<int>(
+                  app.config().section(SECTION_LEDGER_CLEANER), "workers", 1),
+              1,
+              16))
+        , checkpoint_(checkpointPath(app.config()))
     {
     }
 
@@ -106,6 +163,7 @@ public:
             std::lock_guard lock(mutex_);
             shouldExit_ = true;
             wakeup_.notify_one();
+            workReady_.notify_all();
         }
         thread_.join();
     }
@@ -141,9 +199,15 @@ public:
     //
     //--------------------------------------------------------------------------
 
-    void
+    Json::Value
     doClean(Json::Value const& params) override
     {
+        if (params.isMember(jss::progress) && params[jss::progress].asBool())
+        {
+            std::lock_guard lock(mutex_);
+            return getJson(lock);
+        }
+
         LedgerIndex minRange = 0;
         LedgerIndex maxRange = 0;
         app_.getLedgerMaster().getFullValidatedRange(minRange, maxRange);
@@ -185,6 +249,10 @@ public:
                 "stop"
                     A boolean, when true informs the cleaner to gracefully
                     stop its current activities if any cleaning is taking place.
+
+                "progress"
+                    A boolean, when true reports the progress of the cleaner
+                    without changing what it is doing.
             */
 
             // Quick way to fix a single ledger
@@ -214,11 +282,11 @@ public:
             if (params.isMember(jss::stop) && params[jss::stop].asBool())
                 minRange_ = maxRange_ = 0;
 
-            if (state_ == State::readyToClean)
-            {
-                state_ = State::startCleaning;
-                wakeup_.notify_one();
-            }
+            restart(lock);
+
+            auto ret = getJson(lock);
+            ret[jss::message] = "Cleaner configured";
+            return ret;
         }
     }
 
@@ -228,10 +296,142 @@ public:
     //
     //--------------------------------------------------------------------------
 private:
+    // The file progress is saved to, or none if the databases are temporary
+    static boost::filesystem::path
+    checkpointPath(Config const& config)
+    {
+        auto const& section = config.section(SECTION_LEDGER_CLEANER);
+        if (auto const path = get(section, "checkpoint", ""); !path.empty())
+            return path;
+
+        if (config.standalone() && config.START_UP != Config::LOAD &&
+            config.START_UP != Config::LOAD_FILE &&
+            config.START_UP != Config::REPLAY)
+            return {};
+
+        auto const dir = config.legacy("database_path");
+        if (dir.empty())
+            return {};
+        return boost::filesystem::path(dir) / "ledger_cleaner.json";
+    }
+
+    // Start cleaning the range just set, from the top
+    void
+    restart(std::lock_guard<std::mutex> const&)
+    {
+        next_ = maxRange_;
+        cleaned_.clear();
+        ++generation_;
+        checked_ = 0;
+        started_ = std::chrono::steady_clock::now();
+        workReady_.notify_all();
+
+        if (state_ == State::readyToClean)
+        {
+            state_ = State::startCleaning;
+            wakeup_.notify_one();
+        }
+    }
+
+    // Whether there is nothing left to clean in the range
+    template <class Lock>
+    bool
+    finished(Lock const&) const
+    {
+        return (minRange_ > maxRange_) || (maxRange_ == 0) || (minRange_ == 0);
+    }
+
+    Json::Value
+    getJson(std::lock_guard<std::mutex> const&) const
+    {
+        Json::Value ret(Json::objectValue);
+        ret[jss::workers] = workers_;
+        if (maxRange_ == 0)
+        {
+            ret[jss::state] = "idle";
+            return ret;
+        }
+
+        ret[jss::state] = "running";
+        ret[jss::min_ledger] = minRange_;
+        ret[jss::max_ledger] = maxRange_;
+        ret[jss::check_nodes] = checkNodes_;
+        ret[jss::fix_txns] = fixTxns_;
+        if (maxRange_ >= minRange_)
+            ret[jss::remaining] = static_cast<Json::UInt>(
+                maxRange_ - minRange_ + 1 - cleaned_.size());
+        ret[jss::ledgers_checked] = checked_;
+        auto const elapsed = std::chrono::duration_cast<
+            std::chrono::duration<double>>(
+            std::chrono::steady_clock::now() - started_);
+        if (elapsed.count() > 0)
+            ret[jss::ledgers_per_second] = checked_ / elapsed.count();
+        if (failures_ > 0)
+            ret[jss::fail_counts] = failures_;
+        return ret;
+    }
+
+    // Pick up a clean that was running when the server last stopped
     void
     init()
     {
         JLOG(j_.debug()) << "Initializing";
+
+        if (checkpoint_.empty() || !boost::filesystem::exists(checkpoint_))
+            return;
+
+        boost::system::error_code ec;
+        auto const contents = getFileContents(ec, checkpoint_);
+        Json::Value saved;
+        if (ec || !Json::Reader().parse(contents, saved) ||
+            !saved.isObject() || !saved[jss::min_ledger].isIntegral() ||
+            !saved[jss::max_ledger].isIntegral())
+        {
+            JLOG(j_.warn()) << "Ignoring unreadable checkpoint " << checkpoint_;
+            return;
+        }
+
+        std::lock_guard lock(mutex_);
+        minRange_ = saved[jss::min_ledger].asUInt();
+        maxRange_ = saved[jss::max_ledger].asUInt();
+        checkNodes_ = saved[jss::check_nodes].asBool();
+        fixTxns_ = saved[jss::fix_txns].asBool();
+        JLOG(j_.info()) << "Resuming from checkpoint, ledgers " << minRange_
+                        << " to " << maxRange_;
+        restart(lock);
+    }
+
+    // Save how far the clean has got, or remove the checkpoint if it is done
+    void
+    saveCheckpoint()
+    {
+        if (checkpoint_.empty())
+            return;
+
+        Json::Value saved(Json::objectValue);
+        {
+            std::lock_guard lock(mutex_);
+            if (maxRange_ != 0)
+            {
+                saved[jss::min_ledger] = minRange_;
+                saved[jss::max_ledger] = maxRange_;
+                saved[jss::check_nodes] = checkNodes_;
+                saved[jss::fix_txns] = fixTxns_;
+            }
+        }
+
+        boost::system::error_code ec;
+        if (saved.size() == 0)
+            boost::filesystem::remove(checkpoint_, ec);
+        else
+            writeFileContents(ec, checkpoint_, saved.toStyledString());
+
+        if (ec)
+        {
+            // Log and ignore any file I/O exceptions
+            JLOG(j_.warn()) << "Problem writing " << checkpoint_ << " "
+                            << ec.value() << ": " << ec.message();
+        }
     }
 
     void
@@ -323,7 +523,13 @@ private:
             doTxns = true;
         }
 
-        if (doNodes && !nodeLedger->walkLedger(app_.journal("Ledger")))
+        // Keep the cleaner from starving the node store of reads. The
+        // workers share the walk rate between them.
+        auto walkRate = app_.getNodeStore().walkRate();
+        if (walkRate != 0)
+            walkRate = std::max<std::size_t>(walkRate / workers_, 1);
+        if (doNodes &&
+            !nodeLedger->walkLedger(app_.journal("Ledger"), walkRate))
         {
             JLOG(j_.debug()) << "Ledger " << ledgerIndex << " is missing nodes";
             app_.getLedgerMaster().clearLedger(ledgerIndex);
@@ -351,6 +557,11 @@ private:
         LedgerIndex const& ledgerIndex,
         std::shared_ptr<ReadView const>& referenceLedger)
     {
+        // The index holds hashes from the validated chain
+        if (auto const hash =
+                app_.getLedgerMaster().getIndexedHash(ledgerIndex))
+            return *hash;
+
         LedgerHash ledgerHash;
 
         if (!referenceLedger || (referenceLedger->info().seq < ledgerIndex))
@@ -398,6 +609,41 @@ private:
     /** Run the ledger cleaner. */
     void
     doLedgerCleaner()
+    {
+        JLOG(j_.info()) << "Cleaning with " << workers_ << " workers";
+
+        {
+            std::lock_guard lock(mutex_);
+            nextCheckpoint_ =
+                std::chrono::steady_clock::now() + checkpointInterval;
+        }
+        app_.getWorkerPool().run(workers_, [this](std::size_t) { work(); });
+
+        bool exiting;
+        {
+            std::lock_guard lock(mutex_);
+            exiting = shouldExit_;
+            if (!exiting && finished(lock))
+            {
+                minRange_ = maxRange_ = 0;
+                state_ = State::readyToClean;
+            }
+            else if (!exiting)
+            {
+                // A new range was set as the workers returned
+                state_ = State::startCleaning;
+            }
+        }
+
+        // Stopping the server keeps the checkpoint, to resume from it
+        saveCheckpoint();
+        if (!exiting)
+            JLOG(j_.info()) << "Cleaning done";
+    }
+
+    /** Clean the ledgers given out, until there are none left. */
+    void
+    work()
     {
         auto shouldExit = [this]() {
             std::lock_guard lock(mutex_);
@@ -405,6 +651,8 @@ private:
         };
 
         std::shared_ptr<ReadView const> goodLedger;
+        boost::optional<LedgerIndex> retry;
+        std::uint64_t generation = 0;
 
         while (!shouldExit())
         {
@@ -413,27 +661,41 @@ private:
             bool doNodes;
             bool doTxns;
 
-            while (app_.getFeeTrack().isLoadedLocal())
+            while (app_.getFeeTrack().isLoadedLocal() && !shouldExit())
             {
                 JLOG(j_.debug()) << "Waiting for load to subside";
                 std::this_thread::sleep_for(std::chrono::seconds(5));
-                if (shouldExit())
-                    return;
             }
 
             {
-                std::lock_guard lock(mutex_);
-                if ((minRange_ > maxRange_) || (maxRange_ == 0) ||
-                    (minRange_ == 0))
+                std::unique_lock<std::mutex> lock(mutex_);
+
+                // Retry a failed ledger, unless the range was set again
+                if (retry && generation != generation_)
+                    retry.reset();
+
+                // Wait for a ledger to clean, or for the other workers to
+                // finish the ones they have
+                workReady_.wait(lock, [&]() {
+                    return shouldExit_ || retry || finished(lock) ||
+                        (next_ >= minRange_ && next_ != 0);
+                });
+                if (shouldExit_ || finished(lock))
+                    break;
+
+                if (retry)
+                {
+                    ledgerIndex = *retry;
+                }
+                else
                 {
-                    minRange_ = maxRange_ = 0;
-                    state_ = State::readyToClean;
-                    return;
+                    ledgerIndex = next_--;
+                    generation = generation_;
                 }
-                ledgerIndex = maxRange_;
                 doNodes = checkNodes_;
                 doTxns = fixTxns_;
             }
+            retry.reset();
 
             ledgerHash = getHash(ledgerIndex, goodLedger);
 
@@ -456,23 +718,45 @@ private:
                     std::lock_guard lock(mutex_);
                     ++failures_;
                 }
+                retry = ledgerIndex;
                 // Wait for acquiring to catch up to us
                 std::this_thread::sleep_for(std::chrono::seconds(2));
             }
             else
             {
+                bool save = false;
                 {
                     std::lock_guard lock(mutex_);
-                    if (ledgerIndex == minRange_)
-                        ++minRange_;
-                    if (ledgerIndex == maxRange_)
-                        --maxRange_;
+                    if (generation == generation_)
+                    {
+                        cleaned_.insert(ledgerIndex);
+                        while (!cleaned_.empty() &&
+                               *cleaned_.rbegin() == maxRange_)
+                        {
+                            cleaned_.erase(maxRange_);
+                            --maxRange_;
+                        }
+                        ++checked_;
+                    }
                     failures_ = 0;
+
+                    // Save progress every so often while the workers run
+                    auto const now = std::chrono::steady_clock::now();
+                    if (now >= nextCheckpoint_)
+                    {
+                        nextCheckpoint_ = now + checkpointInterval;
+                        save = true;
+                    }
                 }
+                workReady_.notify_all();
+                if (save)
+                    saveCheckpoint();
                 // Reduce I/O pressure and wait for acquiring to catch up to us
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
             }
         }
+
+        workReady_.notify_all();
     }
 };
 
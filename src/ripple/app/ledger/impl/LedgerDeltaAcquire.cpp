@@ -58,6 +58,10 @@ void
 LedgerDeltaAcquire::init(int numPeers)
 {
     ScopedLockType sl(mtx_);
+    // Tasks sharing the delta each start it when it enters their window
+    if (started_)
+        return;
+    started_ = true;
     if (!isDone())
     {
         trigger(numPeers, sl);
@@ -203,7 +207,7 @@ LedgerDeltaAcquire::tryBuild(std::shared_ptr<Ledger const> const& parent)
     assert(parent->info().hash == replayTemp_->info().parentHash);
     // build ledger
     LedgerReplay replayData(parent, replayTemp_, std::move(orderedTxns_));
-    fullLedger_ = buildLedger(replayData, tapNONE, app_, journal_);
+    fullLedger_ = buildLedger(replayData, tapREPLAY, app_, journal_);
     if (fullLedger_ && fullLedger_->info().hash == hash_)
     {
         JLOG(journal_.info()) << "Built " << hash_;
@@ -246,6 +250,7 @@ LedgerDeltaAcquire::onLedgerBuilt(
                 switch (reason)
                 {
                     case InboundLedger::Reason::GENERIC:
+                    case InboundLedger::Reason::HISTORY:
                         app.getLedgerMaster().storeLedger(ledger);
                         break;
                     default:
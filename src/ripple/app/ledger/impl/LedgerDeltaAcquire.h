@@ -73,7 +73,7 @@ public:
     ~LedgerDeltaAcquire() override;
 
     /**
-     * Start the LedgerDeltaAcquire task
+     * Start the LedgerDeltaAcquire task, if not started already
      * @param numPeers  number of peers to try initially
      */
     void
@@ -155,6 +155,7 @@ private:
     InboundLedgers& inboundLedgers_;
     std::uint32_t const ledgerSeq_;
     std::unique_ptr<PeerSet> peerSet_;
+    bool started_ = false;
     std::shared_ptr<Ledger const> replayTemp_ = {};
     std::shared_ptr<Ledger const> fullLedger_ = {};
     std::map<std::uint32_t, std::shared_ptr<STTx const>> orderedTxns_;
@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerHashIndex.h>
+#include <ripple/basics/contract.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace ripple {
+
+// The file starts with a header:
+//
+//  magic       4 bytes
+//  version     4 bytes
+//  directory   4 bytes for each possible chunk
+//
+// followed by the chunks, in the order they were allocated. The directory
+// holds, for each chunk, one more than its position in the file, or zero
+// if it is not allocated. Integers are big endian.
+static constexpr std::uint32_t indexMagic = 0x4C484958;  // "LHIX"
+static constexpr std::uint32_t indexVersion = 1;
+static constexpr std::size_t indexChunks =
+    (std::uint64_t{1} << 32) / LedgerHashIndex::chunkLedgers;
+static constexpr std::size_t indexHeaderSize = 8 + 4 * indexChunks;
+static constexpr std::size_t chunkBytes =
+    LedgerHashIndex::chunkLedgers * uint256::bytes;
+
+static std::uint32_t
+get32(unsigned char const* p)
+{
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) |
+        (std::uint32_t(p[2]) << 8) | std::uint32_t(p[3]);
+}
+
+static void
+put32(unsigned char* p, std::uint32_t v)
+{
+    p[0] = static_cast<unsigned char>(v >> 24);
+    p[1] = static_cast<unsigned char>(v >> 16);
+    p[2] = static_cast<unsigned char>(v >> 8);
+    p[3] = static_cast<unsigned char>(v);
+}
+
+LedgerHashIndex::LedgerHashIndex(boost::filesystem::path path, beast::Journal j)
+    : path_(std::move(path)), j_(j), chunks_(indexChunks, nullptr)
+{
+    if (path_.empty())
+        return;
+
+    try
+    {
+        open();
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.warn()) << "Unable to open ledger hash index "
+                        << path_.string() << ", keeping it in memory: "
+                        << e.what();
+        reset();
+    }
+}
+
+LedgerHashIndex::~LedgerHashIndex() = default;
+
+boost::optional<uint256>
+LedgerHashIndex::get(std::uint32_t seq) const
+{
+    std::lock_guard lock(mutex_);
+
+    auto const slots = chunks_[seq / chunkLedgers];
+    if (!slots)
+        return boost::none;
+
+    uint256 hash;
+    std::memcpy(
+        hash.data(),
+        slots + (seq % chunkLedgers) * uint256::bytes,
+        hash.size());
+    if (hash.isZero())
+        return boost::none;
+    return hash;
+}
+
+void
+LedgerHashIndex::set(std::uint32_t seq, uint256 const& hash)
+{
+    assert(hash.isNonZero());
+
+    std::lock_guard lock(mutex_);
+    std::memcpy(
+        chunk(seq) + (seq % chunkLedgers) * uint256::bytes,
+        hash.data(),
+        hash.size());
+}
+
+void
+LedgerHashIndex::open()
+{
+    namespace bip = boost::interprocess;
+    namespace fs = boost::filesystem;
+
+    boost::system::error_code ec;
+    auto const size = fs::exists(path_, ec) ? fs::file_size(path_) : 0;
+
+    auto map = [this]() {
+        file_ = std::make_unique<bip::file_mapping>(
+            path_.string().c_str(), bip::read_write);
+        header_ = std::make_unique<bip::mapped_region>(
+            *file_, bip::read_write, 0, indexHeaderSize);
+        return static_cast<unsigned char*>(header_->get_address());
+    };
+
+    unsigned char* header = nullptr;
+    if (size >= indexHeaderSize)
+    {
+        header = map();
+
+        // Each chunk in the directory must be in the file, and only once
+        auto const inFile = (size - indexHeaderSize) / chunkBytes;
+        std::vector<bool> seen(inFile, false);
+        bool valid =
+            get32(header) == indexMagic && get32(header + 4) == indexVersion;
+        for (std::size_t i = 0; valid && i < indexChunks; ++i)
+        {
+            auto const pos = get32(header + 8 + 4 * i);
+            if (pos == 0)
+                continue;
+            valid = pos <= inFile && !seen[pos - 1];
+            if (valid)
+                seen[pos - 1] = true;
+        }
+
+        if (!valid)
+        {
+            JLOG(j_.warn()) << "Ledger hash index " << path_.string()
+                            << " is damaged, starting over";
+            header_.reset();
+            file_.reset();
+            header = nullptr;
+        }
+    }
+
+    if (!header)
+    {
+        {
+            std::ofstream out(
+                path_.string(), std::ios::binary | std::ios::trunc);
+            if (!out)
+                Throw<std::runtime_error>("unable to create the file");
+        }
+        fs::resize_file(path_, indexHeaderSize);
+        header = map();
+        put32(header, indexMagic);
+        put32(header + 4, indexVersion);
+    }
+
+    for (std::size_t i = 0; i < indexChunks; ++i)
+    {
+        auto const pos = get32(header + 8 + 4 * i);
+        if (pos == 0)
+            continue;
+
+        auto region = std::make_unique<bip::mapped_region>(
+            *file_,
+            bip::read_write,
+            indexHeaderSize + std::uint64_t{pos - 1} * chunkBytes,
+            chunkBytes);
+        // Lookups are scattered, so reading ahead only evicts pages
+        region->advise(bip::mapped_region::advice_random);
+        chunks_[i] = static_cast<unsigned char*>(region->get_address());
+        regions_.push_back(std::move(region));
+        fileChunks_ = std::max(fileChunks_, pos);
+    }
+
+    JLOG(j_.info()) << "Ledger hash index " << path_.string() << " has "
+                    << regions_.size() << " chunks";
+}
+
+void
+LedgerHashIndex::reset()
+{
+    std::fill(chunks_.begin(), chunks_.end(), nullptr);
+    memory_.clear();
+    regions_.clear();
+    header_.reset();
+    file_.reset();
+    fileChunks_ = 0;
+}
+
+unsigned char*
+LedgerHashIndex::chunk(std::uint32_t seq)
+{
+    namespace bip = boost::interprocess;
+
+    auto& slots = chunks_[seq / chunkLedgers];
+    if (slots)
+        return slots;
+
+    if (file_ && !failed_)
+    {
+        try
+        {
+            auto const offset =
+                indexHeaderSize + std::uint64_t{fileChunks_} * chunkBytes;
+            boost::filesystem::resize_file(path_, offset + chunkBytes);
+            auto region = std::make_unique<bip::mapped_region>(
+                *file_, bip::read_write, offset, chunkBytes);
+            region->advise(bip::mapped_region::advice_random);
+
+            // The space may hold a chunk allocated before a crash but never
+            // added to the directory
+            slots = static_cast<unsigned char*>(region->get_address());
+            std::memset(slots, 0, chunkBytes);
+            regions_.push_back(std::move(region));
+
+            put32(
+                static_cast<unsigned char*>(header_->get_address()) + 8 +
+                    4 * (seq / chunkLedgers),
+                ++fileChunks_);
+            return slots;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.warn()) << "Unable to grow ledger hash index "
+                            << path_.string()
+                            << ", keeping new chunks in memory: " << e.what();
+            failed_ = true;
+        }
+    }
+
+    memory_.emplace_back(new unsigned char[chunkBytes]());
+    slots = memory_.back().get();
+    return slots;
+}
+
+}  // namespace ripple
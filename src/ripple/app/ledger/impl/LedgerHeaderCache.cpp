@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerHeaderCache.h>
+#include <algorithm>
+#include <cassert>
+
+namespace ripple {
+
+struct LedgerHeaderCache::Entry
+{
+    uint256 parentHash;
+    uint256 txHash;
+    uint256 accountHash;
+    std::int64_t drops = 0;
+    NetClock::rep closeTime = 0;
+    NetClock::rep parentCloseTime = 0;
+    std::uint8_t closeTimeResolution = 0;
+    std::uint8_t closeFlags = 0;
+    bool present = false;
+};
+
+struct LedgerHeaderCache::Chunk
+{
+    Chunk() : entries(new Entry[chunkLedgers])
+    {
+    }
+
+    std::unique_ptr<Entry[]> entries;
+    std::uint32_t count = 0;
+    std::uint64_t used = 0;
+};
+
+LedgerHeaderCache::LedgerHeaderCache(std::uint32_t maxLedgers)
+    : maxChunks_(std::max<std::size_t>(
+          1,
+          (std::size_t{maxLedgers} + chunkLedgers - 1) / chunkLedgers))
+{
+}
+
+LedgerHeaderCache::~LedgerHeaderCache() = default;
+
+boost::optional<LedgerInfo>
+LedgerHeaderCache::get(std::uint32_t seq) const
+{
+    std::lock_guard lock(mutex_);
+
+    auto const it = chunks_.find(seq / chunkLedgers);
+    if (it == chunks_.end())
+        return boost::none;
+
+    auto const& e = it->second->entries[seq % chunkLedgers];
+    if (!e.present)
+        return boost::none;
+    it->second->used = ++ticks_;
+
+    using time_point = NetClock::time_point;
+    using duration = NetClock::duration;
+
+    LedgerInfo info;
+    info.seq = seq;
+    info.parentHash = e.parentHash;
+    info.txHash = e.txHash;
+    info.accountHash = e.accountHash;
+    info.drops = XRPAmount{e.drops};
+    info.closeTime = time_point{duration{e.closeTime}};
+    info.parentCloseTime = time_point{duration{e.parentCloseTime}};
+    info.closeTimeResolution = duration{e.closeTimeResolution};
+    info.closeFlags = e.closeFlags;
+    info.hash = calculateLedgerHash(info);
+    return info;
+}
+
+void
+LedgerHeaderCache::insert(LedgerInfo const& info)
+{
+    // The resolution and flags of every ledger fit in a byte
+    assert(info.closeTimeResolution.count() <= 0xff);
+    assert(info.closeFlags >= 0 && info.closeFlags <= 0xff);
+
+    std::lock_guard lock(mutex_);
+
+    auto& chunk = chunks_[info.seq / chunkLedgers];
+    if (!chunk)
+    {
+        chunk = std::make_unique<Chunk>();
+        if (chunks_.size() > maxChunks_)
+        {
+            auto oldest = chunks_.end();
+            for (auto it = chunks_.begin(); it != chunks_.end(); ++it)
+            {
+                if (it->second != chunk &&
+                    (oldest == chunks_.end() ||
+                     it->second->used < oldest->second->used))
+                    oldest = it;
+            }
+            chunks_.erase(oldest);
+        }
+    }
+    chunk->used = ++ticks_;
+
+    auto& e = chunk->entries[info.seq % chunkLedgers];
+    if (!e.present)
+        ++chunk->count;
+    e.parentHash = info.parentHash;
+    e.txHash = info.txHash;
+    e.accountHash = info.accountHash;
+    e.drops = info.drops.drops();
+    e.closeTime = info.closeTime.time_since_epoch().count();
+    e.parentCloseTime = info.parentCloseTime.time_since_epoch().count();
+    e.closeTimeResolution =
+        static_cast<std::uint8_t>(info.closeTimeResolution.count());
+    e.closeFlags = static_cast<std::uint8_t>(info.closeFlags);
+    e.present = true;
+}
+
+void
+LedgerHeaderCache::erasePrior(std::uint32_t seq)
+{
+    std::lock_guard lock(mutex_);
+
+    auto const end = chunks_.lower_bound(seq / chunkLedgers);
+    chunks_.erase(chunks_.begin(), end);
+
+    if (end == chunks_.end() || end->first != seq / chunkLedgers)
+        return;
+    auto& chunk = *end->second;
+    for (auto i = 0u; i < seq % chunkLedgers; ++i)
+    {
+        if (chunk.entries[i].present)
+        {
+            chunk.entries[i].present = false;
+            --chunk.count;
+        }
+    }
+}
+
+std::size_t
+LedgerHeaderCache::size() const
+{
+    std::lock_guard lock(mutex_);
+
+    std::size_t n = 0;
+    for (auto const& chunk : chunks_)
+        n += chunk.second->count;
+    return n;
+}
+
+}  // namespace ripple
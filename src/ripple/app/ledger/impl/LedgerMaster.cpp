@@ -41,6 +41,7 @@
 #include <ripple/basics/UptimeClock.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/core/Pg.h>
 #include <ripple/core/TimeKeeper.h>
@@ -54,6 +55,7 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
 #include <limits>
 #include <memory>
@@ -150,6 +152,35 @@ static constexpr std::chrono::minutes MAX_LEDGER_AGE_ACQUIRE{1};
 // Don't acquire history if write load is too high
 static constexpr int MAX_WRITE_LOAD_ACQUIRE{8192};
 
+// Fetch packs are sent in chunks of about this many bytes, each of which the
+// recipient applies on arrival, and no pack is larger than the ceiling
+static constexpr std::size_t FETCH_PACK_CHUNK_BYTES{1024 * 1024};
+static constexpr std::size_t FETCH_PACK_MAX_BYTES{8 * 1024 * 1024};
+
+// Most fetch pack objects kept until ledger acquisitions use them
+static constexpr std::size_t FETCH_PACK_MAX_OBJECTS{65536};
+
+// Ledgers read from the ledger database at a time to fill the hash index
+static constexpr std::uint32_t HASH_INDEX_FILL_BATCH{16384};
+
+// How often the history backfill rate is reported
+static constexpr std::chrono::minutes BACKFILL_REPORT_INTERVAL{1};
+
+// The file holding the hash index, or none if the databases are temporary
+static boost::filesystem::path
+hashIndexPath(Config const& config)
+{
+    if (config.standalone() && config.START_UP != Config::LOAD &&
+        config.START_UP != Config::LOAD_FILE &&
+        config.START_UP != Config::REPLAY)
+        return {};
+
+    auto const dir = config.legacy("database_path");
+    if (dir.empty())
+        return {};
+    return boost::filesystem::path(dir) / "ledger_hashes.dat";
+}
+
 // Helper function for LedgerMaster::doAdvance()
 // Return true if candidateLedger should be fetched from the network.
 static bool
@@ -189,6 +220,7 @@ LedgerMaster::LedgerMaster(
     , app_(app)
     , m_journal(journal)
     , mLedgerHistory(collector, app)
+    , hashIndex_(hashIndexPath(app_.config()), app_.journal("LedgerHashIndex"))
     , mLedgerCleaner(
           detail::make_LedgerCleaner(app, *this, app_.journal("LedgerCleaner")))
     , standalone_(app_.config().standalone())
@@ -202,8 +234,47 @@ LedgerMaster::LedgerMaster(
           std::chrono::seconds{45},
           stopwatch,
           app_.journal("TaggedCache"))
+    , fetchPackReplies_(
+          "FetchPackReply",
+          16,
+          std::chrono::seconds{5},
+          stopwatch,
+          app_.journal("TaggedCache"))
+    , history_window_(
+          app_.config().HISTORY_BACKFILL_WINDOW
+              ? app_.config().HISTORY_BACKFILL_WINDOW
+              : ledger_fetch_size_)
     , m_stats(std::bind(&LedgerMaster::collect_metrics, this), collector)
 {
+    auto const& section = app_.config().section(SECTION_STATE_SNAPSHOT);
+    if (auto const path = get(section, "path", ""); !path.empty())
+    {
+        snapshot_ = std::make_unique<SHAMapSnapshot>(
+            path, app_.journal("SHAMapSnapshot"));
+        snapshotMaxNodes_ =
+            get<std::size_t>(section, "max_nodes", snapshotMaxNodes_);
+        snapshotInterval_ = std::chrono::seconds{get<std::uint32_t>(
+            section, "interval", snapshotInterval_.count())};
+        snapshotDue_ = std::chrono::steady_clock::now() + snapshotInterval_;
+    }
+}
+
+void
+LedgerMaster::loadSnapshot()
+{
+    if (snapshot_)
+        snapshot_->load(app_.getNodeFamily());
+}
+
+void
+LedgerMaster::writeSnapshot()
+{
+    if (!snapshot_)
+        return;
+
+    if (auto const ledger = getValidatedLedger())
+        snapshot_->write(
+            ledger->stateMap(), ledger->info().seq, snapshotMaxNodes_);
 }
 
 LedgerIndex
@@ -365,6 +436,26 @@ LedgerMaster::setValidLedger(std::shared_ptr<Ledger const> const& l)
     (void)max_ledger_difference_;
     mValidLedgerSeq = l->info().seq;
 
+    if (snapshot_)
+    {
+        // Whatever the snapshot was loaded for has been acquired by now
+        snapshot_->release();
+
+        auto const now = std::chrono::steady_clock::now();
+        if (snapshotInterval_.count() != 0 && now >= snapshotDue_ &&
+            !snapshotWriting_.exchange(true))
+        {
+            snapshotDue_ = now + snapshotInterval_;
+            if (!app_.getJobQueue().addJob(
+                    jtWRITE, "writeSnapshot", [this, l](Job&) {
+                        snapshot_->write(
+                            l->stateMap(), l->info().seq, snapshotMaxNodes_);
+                        snapshotWriting_ = false;
+                    }))
+                snapshotWriting_ = false;
+        }
+    }
+
     app_.getOPs().updateLocalTx(*l);
     app_.getSHAMapStore().onLedgerClosed(getValidatedLedger());
     mLedgerHistory.validatedLedger(l, consensusHash);
@@ -520,6 +611,7 @@ LedgerMaster::switchLCL(std::shared_ptr<Ledger const> const& lastClosed)
 bool
 LedgerMaster::fixIndex(LedgerIndex ledgerIndex, LedgerHash const& ledgerHash)
 {
+    hashIndex_.set(ledgerIndex, ledgerHash);
     return mLedgerHistory.fixIndex(ledgerIndex, ledgerHash);
 }
 
@@ -874,6 +966,8 @@ LedgerMaster::fixMismatch(ReadView const& ledger)
 
             if (hash)
             {
+                hashIndex_.set(lSeq, *hash);
+
                 // try to close the seam
                 auto otherLedger = getLedgerBySeq(lSeq);
 
@@ -918,6 +1012,11 @@ LedgerMaster::setFullLedger(
     ledger->setValidated();
     ledger->setFull();
 
+    // The parent of a validated ledger is validated too
+    hashIndex_.set(ledger->info().seq, ledger->info().hash);
+    if (ledger->info().seq > 1)
+        hashIndex_.set(ledger->info().seq - 1, ledger->info().parentHash);
+
     if (isCurrent)
         mLedgerHistory.insert(ledger, true);
 
@@ -1299,7 +1398,10 @@ LedgerMaster::getLedgerHashForHistory(
     InboundLedger::Reason reason)
 {
     // Try to get the hash of a ledger we need to fetch for history
-    boost::optional<LedgerHash> ret;
+    boost::optional<LedgerHash> ret = hashIndex_.get(index);
+    if (ret)
+        return ret;
+
     auto const& l{
         reason == InboundLedger::Reason::SHARD ? mShardLedger : mHistLedger};
 
@@ -1705,6 +1807,9 @@ LedgerMaster::getCloseTimeByHash(
 uint256
 LedgerMaster::getHashBySeq(std::uint32_t index)
 {
+    if (auto const indexed = hashIndex_.get(index))
+        return *indexed;
+
     uint256 hash = mLedgerHistory.getLedgerHash(index);
 
     if (hash.isNonZero())
@@ -1716,10 +1821,16 @@ LedgerMaster::getHashBySeq(std::uint32_t index)
 boost::optional<LedgerHash>
 LedgerMaster::walkHashBySeq(std::uint32_t index, InboundLedger::Reason reason)
 {
-    boost::optional<LedgerHash> ledgerHash;
+    boost::optional<LedgerHash> ledgerHash = hashIndex_.get(index);
+    if (ledgerHash)
+        return ledgerHash;
 
     if (auto referenceLedger = mValidLedger.get())
+    {
         ledgerHash = walkHashBySeq(index, referenceLedger, reason);
+        if (ledgerHash)
+            hashIndex_.set(index, *ledgerHash);
+    }
 
     return ledgerHash;
 }
@@ -1788,12 +1899,18 @@ LedgerMaster::getLedgerBySeq(std::uint32_t index)
             if (valid->info().seq == index)
                 return valid;
 
+            if (auto const hash = hashIndex_.get(index))
+            {
+                if (auto ledger = mLedgerHistory.getLedgerByHash(*hash, index))
+                    return ledger;
+            }
+
             try
             {
                 auto const hash = hashOfSeq(*valid, index, m_journal);
 
                 if (hash)
-                    return mLedgerHistory.getLedgerByHash(*hash);
+                    return mLedgerHistory.getLedgerByHash(*hash, index);
             }
             catch (std::exception const&)
             {
@@ -1826,10 +1943,10 @@ LedgerMaster::getLedgerByHash(uint256 const& hash)
     return {};
 }
 
-void
+Json::Value
 LedgerMaster::doLedgerCleaner(Json::Value const& parameters)
 {
-    mLedgerCleaner->doClean(parameters);
+    return mLedgerCleaner->doClean(parameters);
 }
 
 void
@@ -1850,6 +1967,7 @@ LedgerMaster::sweep()
 {
     mLedgerHistory.sweep();
     fetch_packs_.sweep();
+    fetchPackReplies_.sweep();
 }
 
 float
@@ -1867,9 +1985,12 @@ LedgerMaster::getPropertySource()
 void
 LedgerMaster::clearPriorLedgers(LedgerIndex seq)
 {
-    std::lock_guard sl(mCompleteLock);
-    if (seq > 0)
-        mCompleteLedgers.erase(range(0u, seq - 1));
+    {
+        std::lock_guard sl(mCompleteLock);
+        if (seq > 0)
+            mCompleteLedgers.erase(range(0u, seq - 1));
+    }
+    mLedgerHistory.clearHeadersPrior(seq);
 }
 
 void
@@ -1902,6 +2023,13 @@ LedgerMaster::fetchForHistory(
     {
         assert(hash->isNonZero());
         auto ledger = getLedgerByHash(*hash);
+        if (!ledger && reason == InboundLedger::Reason::HISTORY &&
+            replayHistory(missing, *hash))
+        {
+            JLOG(m_journal.trace())
+                << "fetchForHistory waiting for replay of " << missing;
+            return;
+        }
         if (!ledger)
         {
             if (!app_.getInboundLedgers().isFailure(*hash))
@@ -1961,21 +2089,22 @@ LedgerMaster::fetchForHistory(
                             tryFill(j, ledger);
                         });
                 }
+                noteBackfilled(seq);
+                if (seq > 1)
+                    backfillHistory(seq - 1);
             }
             progress = true;
         }
+        else if (reason == InboundLedger::Reason::HISTORY)
+        {
+            backfillHistory(missing);
+        }
         else
         {
-            std::uint32_t fetchSz;
-            if (reason == InboundLedger::Reason::SHARD)
-                // Do not fetch ledger sequences lower
-                // than the shard's first ledger sequence
-                fetchSz = app_.getShardStore()->firstLedgerSeq(
-                    app_.getShardStore()->seqToShardIndex(missing));
-            else
-                // Do not fetch ledger sequences lower
-                // than the earliest ledger sequence
-                fetchSz = app_.getNodeStore().earliestLedgerSeq();
+            // Do not fetch ledger sequences lower
+            // than the shard's first ledger sequence
+            std::uint32_t fetchSz = app_.getShardStore()->firstLedgerSeq(
+                app_.getShardStore()->seqToShardIndex(missing));
             fetchSz = missing >= fetchSz
                 ? std::min(ledger_fetch_size_, (missing - fetchSz) + 1)
                 : 0;
@@ -2013,6 +2142,116 @@ LedgerMaster::fetchForHistory(
     }
 }
 
+bool
+LedgerMaster::replayHistory(std::uint32_t missing, uint256 const& hash)
+{
+    if (!app_.config().LEDGER_REPLAY)
+        return false;
+
+    if (missing >= replayLow_ && missing <= replayHigh_)
+        return std::chrono::steady_clock::now() < replayDeadline_;
+
+    // The task acquires the lowest ledger in full, and rebuilds the ones
+    // above it from their transactions
+    auto const earliest = app_.getNodeStore().earliestLedgerSeq();
+    if (missing <= earliest)
+        return false;
+    auto const n = std::min<std::uint32_t>(
+        {history_window_,
+         LedgerReplayParameters::MAX_TASK_SIZE,
+         missing - earliest + 1});
+    if (n < 2)
+        return false;
+
+    JLOG(m_journal.debug()) << "Replaying " << n << " historical ledgers"
+                            << " ending at " << missing;
+    app_.getLedgerReplayer().replay(
+        InboundLedger::Reason::HISTORY, hash, n);
+    replayLow_ = missing - n + 1;
+    replayHigh_ = missing;
+    replayDeadline_ = std::chrono::steady_clock::now() +
+        LedgerReplayParameters::TASK_TIMEOUT *
+            std::max(
+                LedgerReplayParameters::TASK_MAX_TIMEOUTS_MINIMUM,
+                n * LedgerReplayParameters::TASK_MAX_TIMEOUTS_MULTIPLIER);
+    return true;
+}
+
+void
+LedgerMaster::backfillHistory(std::uint32_t missing)
+{
+    // Do not fetch ledger sequences lower than the earliest ledger sequence
+    auto const earliest = app_.getNodeStore().earliestLedgerSeq();
+    if (missing < earliest)
+        return;
+    auto const floor =
+        missing - std::min(history_window_, missing - earliest + 1) + 1;
+
+    // Carry on below the ledgers already asked for in this gap, unless
+    // the gap moved since
+    auto seq = missing;
+    if (backfillLow_ >= floor && backfillLow_ <= missing)
+        seq = backfillLow_ - 1;
+
+    auto const now = std::chrono::steady_clock::now();
+    std::size_t started = 0;
+    try
+    {
+        for (; seq >= floor; --seq)
+        {
+            if (seq >= replayLow_ && seq <= replayHigh_ &&
+                now < replayDeadline_)
+                continue;
+            if (haveLedger(seq))
+                continue;
+            auto const reason = InboundLedger::Reason::HISTORY;
+            if (auto h = getLedgerHashForHistory(seq, reason))
+            {
+                assert(h->isNonZero());
+                app_.getInboundLedgers().acquire(*h, seq, reason);
+                ++started;
+            }
+        }
+    }
+    catch (std::exception const&)
+    {
+        JLOG(m_journal.warn()) << "Threw while prefetching";
+    }
+    backfillLow_ = floor;
+
+    if (started != 0)
+        JLOG(m_journal.trace()) << "History backfill acquiring " << started
+                                << " ledgers down to " << floor;
+}
+
+void
+LedgerMaster::noteBackfilled(std::uint32_t seq)
+{
+    auto const now = std::chrono::steady_clock::now();
+    if (backfillCount_ == 0 || now - backfillLast_ > BACKFILL_REPORT_INTERVAL)
+    {
+        // Do not let an idle spell lower the rate
+        backfillCount_ = 0;
+        backfillMark_ = now;
+        backfillRate_ = 0;
+    }
+    backfillLast_ = now;
+    ++backfillCount_;
+
+    auto const elapsed = now - backfillMark_;
+    if (elapsed < BACKFILL_REPORT_INTERVAL)
+        return;
+
+    auto const rate = backfillCount_ /
+        std::chrono::duration_cast<std::chrono::duration<double>>(elapsed)
+            .count();
+    backfillRate_ = std::llround(rate);
+    JLOG(m_journal.info()) << "History backfill acquired " << backfillCount_
+                           << " ledgers at " << rate << " ledgers/sec, down to "
+                           << seq;
+    backfillCount_ = 0;
+}
+
 // Try to publish ledgers, acquire missing ledgers
 void
 LedgerMaster::doAdvance(std::unique_lock<std::recursive_mutex>& sl)
@@ -2083,6 +2322,7 @@ LedgerMaster::doAdvance(std::unique_lock<std::recursive_mutex>& sl)
             {
                 mHistLedger.reset();
                 mShardLedger.reset();
+                backfillLow_ = 0;
                 JLOG(m_journal.trace()) << "tryAdvance not fetching history";
             }
         }
@@ -2104,6 +2344,7 @@ LedgerMaster::doAdvance(std::unique_lock<std::recursive_mutex>& sl)
                 {
                     ScopedUnlock sul{sl};
                     app_.getOPs().pubLedger(ledger);
+                    app_.getOrderBookDB().setup(ledger);
                 }
             }
 
@@ -2115,10 +2356,13 @@ LedgerMaster::doAdvance(std::unique_lock<std::recursive_mutex>& sl)
     } while (mAdvanceWork);
 }
 
-void
+bool
 LedgerMaster::addFetchPack(uint256 const& hash, std::shared_ptr<Blob> data)
 {
+    if (fetch_packs_.getCacheSize() >= FETCH_PACK_MAX_OBJECTS)
+        return false;
     fetch_packs_.canonicalize_replace_client(hash, data);
+    return true;
 }
 
 boost::optional<Blob>
@@ -2137,15 +2381,120 @@ LedgerMaster::getFetchPack(uint256 const& hash)
 void
 LedgerMaster::gotFetchPack(bool progress, std::uint32_t seq)
 {
+    fetchPackArrived_ = true;
     if (!mGotFetchPackThread.test_and_set(std::memory_order_acquire))
     {
         app_.getJobQueue().addJob(jtLEDGER_DATA, "gotFetchPack", [&](Job&) {
-            app_.getInboundLedgers().gotFetchPack();
-            mGotFetchPackThread.clear(std::memory_order_release);
+            // Go again for chunks that arrived while the acquisitions were
+            // checked, so the last chunk of a pack isn't left unused
+            do
+            {
+                fetchPackArrived_ = false;
+                app_.getInboundLedgers().gotFetchPack();
+                mGotFetchPackThread.clear(std::memory_order_release);
+            } while (fetchPackArrived_ &&
+                     !mGotFetchPackThread.test_and_set(
+                         std::memory_order_acquire));
         });
     }
 }
 
+namespace {
+
+/** Collects the objects of a fetch pack into chunks and sends each chunk
+    to the peer as soon as it is full.
+*/
+class FetchPackWriter
+{
+    std::shared_ptr<Peer> const peer_;
+    protocol::TMGetObjectByHash chunk_;
+    std::vector<std::shared_ptr<Message>> sent_;
+    std::size_t chunkBytes_ = 0;
+    std::size_t totalBytes_ = 0;
+    std::size_t objects_ = 0;
+
+public:
+    FetchPackWriter(
+        std::shared_ptr<Peer> peer,
+        protocol::TMGetObjectByHash const& request)
+        : peer_(std::move(peer))
+    {
+        chunk_.set_query(false);
+        if (request.has_seq())
+            chunk_.set_seq(request.seq());
+        chunk_.set_ledgerhash(request.ledgerhash());
+        chunk_.set_type(protocol::TMGetObjectByHash::otFETCH_PACK);
+    }
+
+    /** Add an object.
+        @return false once the pack has reached its ceiling
+    */
+    bool
+    add(uint256 const& hash,
+        void const* data,
+        std::size_t size,
+        std::uint32_t seq)
+    {
+        if (full())
+            return false;
+
+        protocol::TMIndexedObject* obj = chunk_.add_objects();
+        obj->set_hash(hash.data(), hash.size());
+        obj->set_data(data, size);
+        obj->set_ledgerseq(seq);
+
+        // The hash, the sequence and the framing of the fields
+        auto const bytes = size + hash.size() + 16;
+        chunkBytes_ += bytes;
+        totalBytes_ += bytes;
+        ++objects_;
+
+        if (chunkBytes_ >= FETCH_PACK_CHUNK_BYTES)
+            flush();
+        return !full();
+    }
+
+    /** Send the objects added since the last chunk was sent. */
+    void
+    flush()
+    {
+        if (chunk_.objects_size() == 0)
+            return;
+        auto msg = std::make_shared<Message>(chunk_, protocol::mtGET_OBJECTS);
+        peer_->send(msg);
+        sent_.push_back(std::move(msg));
+        chunk_.clear_objects();
+        chunkBytes_ = 0;
+    }
+
+    bool
+    full() const
+    {
+        return totalBytes_ >= FETCH_PACK_MAX_BYTES;
+    }
+
+    std::size_t
+    objects() const
+    {
+        return objects_;
+    }
+
+    std::size_t
+    bytes() const
+    {
+        return totalBytes_;
+    }
+
+    /** The chunks sent so far. */
+    std::vector<std::shared_ptr<Message>>&
+    sent()
+    {
+        return sent_;
+    }
+};
+
+}  // namespace
+
 /** Populate a fetch pack with data from the map the recipient wants.
 
     A recipient may or may not have the map that they are asking for. If
@@ -2154,7 +2503,7 @@ LedgerMaster::gotFetchPack(bool progress, std::uint32_t seq)
 
     @param have The map that the recipient already has (if any).
     @param cnt The maximum number of nodes to return.
-    @param into The protocol object into which we add information.
+    @param into The writer to which we add information.
     @param seq The sequence number of the ledger the map is a part of.
     @param withLeaves True if leaf nodes should be included.
 
@@ -2176,7 +2525,7 @@ populateFetchPack(
     SHAMap const& want,
     SHAMap const* have,
     std::uint32_t cnt,
-    protocol::TMGetObjectByHash* into,
+    FetchPackWriter& into,
     std::uint32_t seq,
     bool withLeaves = true)
 {
@@ -2186,19 +2535,19 @@ populateFetchPack(
 
     want.visitDifferences(
         have,
-        [&s, withLeaves, &cnt, into, seq](SHAMapTreeNode const& n) -> bool {
+        [&s, withLeaves, &cnt, &into, seq](SHAMapTreeNode const& n) -> bool {
             if (!withLeaves && n.isLeaf())
                 return true;
 
             s.erase();
             n.serializeWithPrefix(s);
 
-            auto const& hash = n.getHash().as_uint256();
-
-            protocol::TMIndexedObject* obj = into->add_objects();
-            obj->set_ledgerseq(seq);
-            obj->set_hash(hash.data(), hash.size());
-            obj->set_data(s.getDataPtr(), s.getLength());
+            if (!into.add(
+                    n.getHash().as_uint256(),
+                    s.getDataPtr(),
+                    s.getLength(),
+                    seq))
+                return false;
 
             return --cnt != 0;
         });
@@ -2265,27 +2614,35 @@ LedgerMaster::makeFetchPack(
         return;
     }
 
+    auto const key = sha512Half(
+        haveLedgerHash,
+        static_cast<std::uint32_t>(request->has_seq()),
+        request->seq(),
+        request->ledgerhash());
+    if (auto const chunks = fetchPackReplies_.fetch(key))
+    {
+        JLOG(m_journal.debug()) << "Sending cached fetch pack";
+        for (auto const& msg : *chunks)
+            peer->send(msg);
+        return;
+    }
+
     try
     {
         Serializer hdr(128);
 
-        protocol::TMGetObjectByHash reply;
-        reply.set_query(false);
-
-        if (request->has_seq())
-            reply.set_seq(request->seq());
-
-        reply.set_ledgerhash(request->ledgerhash());
-        reply.set_type(protocol::TMGetObjectByHash::otFETCH_PACK);
+        FetchPackWriter reply(peer, *request);
 
         // Building a fetch pack:
         //  1. Add the header for the requested ledger.
         //  2. Add the nodes for the AccountStateMap of that ledger.
         //  3. If there are transactions, add the nodes for the
         //     transactions of the ledger.
-        //  4. If the FetchPack now contains at least 512 entries then stop.
+        //  4. If the FetchPack now contains at least 512 entries, or has
+        //     reached its size ceiling, then stop.
         //  5. If not very much time has elapsed, then loop back and repeat
         //     the same process adding the previous ledger to the FetchPack.
+        // The pack goes out in chunks as it is built.
         do
         {
             std::uint32_t lSeq = want->info().seq;
@@ -2298,35 +2655,35 @@ LedgerMaster::makeFetchPack(
                 addRaw(want->info(), hdr);
 
                 // Add the data
-                protocol::TMIndexedObject* obj = reply.add_objects();
-                obj->set_hash(
-                    want->info().hash.data(), want->info().hash.size());
-                obj->set_data(hdr.getDataPtr(), hdr.getLength());
-                obj->set_ledgerseq(lSeq);
+                reply.add(
+                    want->info().hash, hdr.getDataPtr(), hdr.getLength(), lSeq);
             }
 
             populateFetchPack(
-                want->stateMap(), &have->stateMap(), 16384, &reply, lSeq);
+                want->stateMap(), &have->stateMap(), 16384, reply, lSeq);
 
             // We use nullptr here because transaction maps are per ledger
             // and so the requestor is unlikely to already have it.
-            if (want->info().txHash.isNonZero())
-                populateFetchPack(want->txMap(), nullptr, 512, &reply, lSeq);
+            if (want->info().txHash.isNonZero() && !reply.full())
+                populateFetchPack(want->txMap(), nullptr, 512, reply, lSeq);
 
-            if (reply.objects().size() >= 512)
+            if (reply.objects() >= 512 || reply.full())
                 break;
 
             have = std::move(want);
             want = getLedgerByHash(have->info().parentHash);
         } while (want && UptimeClock::now() <= uptime + 1s);
 
-        auto msg = std::make_shared<Message>(reply, protocol::mtGET_OBJECTS);
+        reply.flush();
 
         JLOG(m_journal.info())
-            << "Built fetch pack with " << reply.objects().size() << " nodes ("
-            << msg->getBufferSize() << " bytes)";
+            << "Built fetch pack with " << reply.objects() << " nodes ("
+            << reply.bytes() << " bytes) in " << reply.sent().size()
+            << " chunks";
 
-        peer->send(msg);
+        auto chunks = std::make_shared<std::vector<std::shared_ptr<Message>>>(
+            std::move(reply.sent()));
+        fetchPackReplies_.canonicalize_replace_client(key, chunks);
     }
     catch (std::exception const&)
     {
@@ -2340,6 +2697,51 @@ LedgerMaster::getFetchPackCacheSize() const
     return fetch_packs_.getCacheSize();
 }
 
+void
+LedgerMaster::fillHashIndex()
+{
+    if (app_.config().reporting())
+        return;
+
+    app_.getJobQueue().addJob(jtADVANCE, "fillHashIndex", [this](Job&) {
+        boost::optional<LedgerIndex> minSeq;
+        boost::optional<LedgerIndex> maxSeq;
+        {
+            auto db = app_.getLedgerDB().checkoutReadDb();
+            *db << "SELECT MIN(LedgerSeq), MAX(LedgerSeq) FROM Ledgers;",
+                soci::into(minSeq), soci::into(maxSeq);
+        }
+        if (!minSeq || !maxSeq)
+            return;
+
+        // Newest first, as those are looked up most. Entries already
+        // present came from the validated chain, which the database may
+        // not agree with, so they are kept.
+        std::size_t added = 0;
+        for (std::uint32_t last = *maxSeq; last >= *minSeq && !isStopping();)
+        {
+            auto const first =
+                last - std::min(last - *minSeq, HASH_INDEX_FILL_BATCH - 1);
+            for (auto const& [seq, hashes] :
+                 getHashesByIndex(first, last, app_))
+            {
+                if (hashes.first.isNonZero() && !hashIndex_.get(seq))
+                {
+                    hashIndex_.set(seq, hashes.first);
+                    ++added;
+                }
+            }
+            if (first == *minSeq)
+                break;
+            last = first - 1;
+        }
+
+        JLOG(m_journal.info()) << "Added " << added
+                               << " ledger hashes to the index from "
+                               << *minSeq << " to " << *maxSeq;
+    });
+}
+
 // Returns the minimum ledger sequence in SQL database, if any.
 boost::optional<LedgerIndex>
 LedgerMaster::minSqlSeq()
@@ -2347,7 +2749,7 @@ LedgerMaster::minSqlSeq()
     if (!app_.config().reporting())
     {
         boost::optional<LedgerIndex> seq;
-        auto db = app_.getLedgerDB().checkoutDb();
+        auto db = app_.getLedgerDB().checkoutReadDb();
         *db << "SELECT MIN(LedgerSeq) FROM Ledgers", soci::into(seq);
         return seq;
     }
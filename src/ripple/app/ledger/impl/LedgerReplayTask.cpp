@@ -103,6 +103,7 @@ LedgerReplayTask::LedgerReplayTask(
           parameter.totalLedgers_ *
               LedgerReplayParameters::TASK_MAX_TIMEOUTS_MULTIPLIER))
     , skipListAcquirer_(skipListAcquirer)
+    , window_(app.config().LEDGER_REPLAY_WINDOW)
 {
     JLOG(journal_.trace()) << "Create " << hash_;
 }
@@ -190,11 +191,17 @@ LedgerReplayTask::tryAdvance(ScopedLockType& sl)
                            << ", totalDeltas=" << deltas_.size() << ", parent "
                            << (parent_ ? parent_->info().hash : uint256());
 
-    bool shouldTry = parent_ && parameter_.full_ &&
-        parameter_.totalLedgers_ - 1 == deltas_.size();
+    bool shouldTry =
+        parameter_.full_ && parameter_.totalLedgers_ - 1 == deltas_.size();
     if (!shouldTry)
         return;
 
+    // Deltas are fetched, and verified as they arrive, while the ones
+    // before them are still being applied
+    startDeltas(sl);
+    if (!parent_ || isDone())
+        return;
+
     try
     {
         for (; deltaToBuild_ < deltas_.size(); ++deltaToBuild_)
@@ -210,7 +217,11 @@ LedgerReplayTask::tryAdvance(ScopedLockType& sl)
                 parent_ = l;
             }
             else
+            {
+                // Slide the window past the ledgers just built
+                startDeltas(sl);
                 return;
+            }
         }
 
         complete_ = true;
@@ -222,6 +233,30 @@ LedgerReplayTask::tryAdvance(ScopedLockType& sl)
     }
 }
 
+void
+LedgerReplayTask::startDeltas(ScopedLockType& sl)
+{
+    std::vector<std::shared_ptr<LedgerDeltaAcquire>> toStart;
+    for (; deltaToStart_ < deltas_.size() &&
+         deltaToStart_ < deltaToBuild_ + window_;
+         ++deltaToStart_)
+    {
+        toStart.push_back(deltas_[deltaToStart_]);
+    }
+
+    if (toStart.empty())
+        return;
+
+    JLOG(journal_.trace()) << "Task " << hash_ << " starts " << toStart.size()
+                           << " deltas, up to deltaIndex=" << deltaToStart_;
+
+    // A delta that is already available calls back into the task
+    sl.unlock();
+    for (auto const& delta : toStart)
+        delta->init(1);
+    sl.lock();
+}
+
 void
 LedgerReplayTask::updateSkipList(
     uint256 const& hash,
@@ -142,7 +142,6 @@ LedgerReplayer::createDeltas(std::shared_ptr<LedgerReplayTask> task)
              ++seq, ++skipListItem)
         {
             std::shared_ptr<LedgerDeltaAcquire> delta;
-            bool newDelta = false;
             {
                 std::lock_guard<std::mutex> lock(mtx_);
                 if (isStopping())
@@ -160,13 +159,11 @@ LedgerReplayer::createDeltas(std::shared_ptr<LedgerReplayTask> task)
                         seq,
                         peerSetBuilder_->build());
                     deltas_[*skipListItem] = delta;
-                    newDelta = true;
                 }
             }
 
+            // The task starts the delta once it is within its window
             task->addDelta(delta);
-            if (newDelta)
-                delta->init(1);
         }
     }
 }
@@ -174,7 +171,7 @@ LedgerReplayer::createDeltas(std::shared_ptr<LedgerReplayTask> task)
 void
 LedgerReplayer::gotSkipList(
     LedgerInfo const& info,
-    std::shared_ptr<SHAMapItem const> const& item)
+    boost::intrusive_ptr<SHAMapItem const> const& item)
 {
     std::shared_ptr<SkipListAcquire> skipList = {};
     {
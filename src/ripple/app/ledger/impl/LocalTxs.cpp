@@ -135,6 +135,7 @@ public:
         {
             std::lock_guard lock(m_lock);
 
+            tset.reserve(m_txns.size());
             for (auto const& it : m_txns)
                 tset.insert(it.getTX());
         }
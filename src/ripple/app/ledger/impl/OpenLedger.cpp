@@ -25,7 +25,6 @@
 #include <ripple/ledger/CachedView.h>
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/Overlay.h>
-#include <ripple/overlay/predicates.h>
 #include <ripple/protocol/Feature.h>
 #include <boost/range/adaptor/transformed.hpp>
 
@@ -150,9 +149,8 @@ OpenLedger::accept(
             msg.set_status(protocol::tsNEW);
             msg.set_receivetimestamp(
                 app.timeKeeper().now().time_since_epoch().count());
-            app.overlay().foreach(send_if_not(
-                std::make_shared<Message>(msg, protocol::mtTRANSACTION),
-                peer_in_set(*toSkip)));
+            msg.set_verified(isSignatureGood(app.getHashRouter(), txId));
+            app.overlay().relay(msg, *toSkip, false);
         }
     }
 
@@ -0,0 +1,438 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/basics/CompressionAlgorithms.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/nodestore/Database.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/shamap/Family.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+namespace StateExport {
+
+// The file starts with a header:
+//
+//  magic        4 bytes
+//  version      4 bytes
+//  ledgerSeq    4 bytes
+//  ledgerHash  32 bytes
+//  accountHash 32 bytes
+//
+// followed by the blocks, each LZ4 compressed on its own. A block holds
+// records in key order:
+//
+//  key         32 bytes
+//  type         2 bytes
+//  size         4 bytes
+//  data      size bytes
+//
+// After the blocks is the index, one entry per block in key order:
+//
+//  firstKey    32 bytes
+//  offset       8 bytes
+//  compressed   4 bytes
+//  size         4 bytes
+//  entries      4 bytes
+//
+// and the file ends with a footer:
+//
+//  indexOffset  8 bytes
+//  blocks       4 bytes
+//  entries      8 bytes
+//  rawBytes     8 bytes
+//  magic        4 bytes
+//
+// Integers are big endian, as Serializer writes them.
+static constexpr std::uint32_t exportMagic = 0x4C455850;  // "LEXP"
+static constexpr std::uint32_t exportVersion = 1;
+static constexpr std::size_t headerSize = 76;
+static constexpr std::size_t indexEntrySize = 52;
+static constexpr std::size_t footerSize = 32;
+
+// The keys are split into ranges by their first byte
+static constexpr std::size_t ranges = 256;
+
+namespace {
+
+struct Block
+{
+    uint256 firstKey;
+    std::uint32_t size = 0;
+    std::uint32_t entries = 0;
+    std::vector<std::uint8_t> compressed;
+};
+
+struct IndexEntry
+{
+    uint256 firstKey;
+    std::uint64_t offset;
+    std::uint32_t compressed;
+    std::uint32_t size;
+    std::uint32_t entries;
+};
+
+// Appends compressed blocks to the file one at a time, in the order
+// they are finished, and lists them for the index
+class BlockWriter
+{
+    std::mutex mutex_;
+    std::ofstream& out_;
+    std::uint64_t offset_;
+    std::vector<IndexEntry> index_;
+    std::uint64_t entries_ = 0;
+    std::uint64_t rawBytes_ = 0;
+
+public:
+    BlockWriter(std::ofstream& out, std::uint64_t offset)
+        : out_(out), offset_(offset)
+    {
+    }
+
+    void
+    write(Block const& block)
+    {
+        std::lock_guard lock(mutex_);
+        if (!out_)
+            Throw<std::runtime_error>("unable to write block");
+
+        out_.write(
+            reinterpret_cast<char const*>(block.compressed.data()),
+            block.compressed.size());
+        index_.push_back(
+            {block.firstKey,
+             offset_,
+             static_cast<std::uint32_t>(block.compressed.size()),
+             block.size,
+             block.entries});
+        offset_ += block.compressed.size();
+        entries_ += block.entries;
+        rawBytes_ += block.size;
+    }
+
+    // Only called once every block is written
+    std::uint64_t
+    offset() const
+    {
+        return offset_;
+    }
+
+    std::vector<IndexEntry>&
+    index()
+    {
+        return index_;
+    }
+
+    std::uint64_t
+    entries() const
+    {
+        return entries_;
+    }
+
+    std::uint64_t
+    rawBytes() const
+    {
+        return rawBytes_;
+    }
+};
+
+std::uint16_t
+entryType(SHAMapItem const& item)
+{
+    // sfLedgerEntryType, a 16 bit field of code 1, always comes first
+    auto const data = static_cast<std::uint8_t const*>(item.data());
+    if (item.size() >= 3 && data[0] == 0x11)
+        return (std::uint16_t{data[1]} << 8) | data[2];
+    return 0;
+}
+
+Block
+compress(Serializer const& raw, uint256 const& firstKey, std::uint32_t entries)
+{
+    Block block;
+    block.firstKey = firstKey;
+    block.size = raw.size();
+    block.entries = entries;
+    auto const size = compression_algorithms::lz4Compress(
+        raw.data(), raw.size(), [&block](std::size_t capacity) {
+            block.compressed.resize(capacity);
+            return block.compressed.data();
+        });
+    block.compressed.resize(size);
+    return block;
+}
+
+// Export the items whose keys start with the given byte
+void
+exportRange(
+    SHAMap const& map,
+    std::uint8_t first,
+    BlockWriter& writer,
+    std::size_t blockBytes)
+{
+    auto const readAhead = map.family().db().scanReadAhead();
+
+    Serializer raw(blockBytes + 4096);
+    uint256 firstKey;
+    std::uint32_t entries = 0;
+
+    auto flush = [&]() {
+        writer.write(compress(raw, firstKey, entries));
+        raw.erase();
+        entries = 0;
+    };
+
+    auto it = map.begin(readAhead);
+    if (first != 0)
+    {
+        // The last key of the range before this one
+        uint256 before;
+        before.data()[0] = first - 1;
+        std::fill(before.begin() + 1, before.end(), 0xFF);
+        it = map.upper_bound(before, readAhead);
+    }
+
+    for (; it != map.end() && it->key().data()[0] == first; ++it)
+    {
+        if (entries == 0)
+            firstKey = it->key();
+
+        raw.addBitString(it->key());
+        raw.add16(entryType(*it));
+        raw.add32(it->size());
+        raw.addRaw(it->data(), it->size());
+        ++entries;
+
+        if (raw.size() >= blockBytes)
+            flush();
+    }
+
+    // Blocks never span ranges, so each stays in key order
+    if (entries != 0)
+        flush();
+}
+
+}  // namespace
+
+Summary
+write(
+    SHAMap const& map,
+    LedgerInfo const& info,
+    boost::filesystem::path const& path,
+    std::size_t threads,
+    WorkerPool& workers,
+    beast::Journal j,
+    std::size_t blockBytes)
+{
+    using namespace std::chrono;
+    auto const start = steady_clock::now();
+
+    threads = std::clamp<std::size_t>(threads, 1, ranges);
+    blockBytes = std::max<std::size_t>(blockBytes, 1);
+
+    Summary summary;
+    summary.ledgerSeq = info.seq;
+    summary.ledgerHash = info.hash;
+    summary.accountHash = info.accountHash;
+
+    auto const temp = path.string() + ".tmp";
+
+    try
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            Throw<std::runtime_error>("unable to create " + temp);
+
+        Serializer s;
+        s.add32(exportMagic);
+        s.add32(exportVersion);
+        s.add32(info.seq);
+        s.addBitString(info.hash);
+        s.addBitString(info.accountHash);
+        out.write(reinterpret_cast<char const*>(s.data()), s.size());
+
+        // The ranges are spread over at most `threads` threads, which stop
+        // taking new ones once one of them fails
+        BlockWriter writer(out, s.size());
+        std::atomic<bool> failed{false};
+        workers.run(
+            ranges,
+            [&](std::size_t r) {
+                if (failed)
+                    return;
+                try
+                {
+                    exportRange(
+                        map, static_cast<std::uint8_t>(r), writer, blockBytes);
+                }
+                catch (...)
+                {
+                    failed = true;
+                    throw;
+                }
+            },
+            (ranges + threads - 1) / threads);
+
+        auto& index = writer.index();
+        auto const offset = writer.offset();
+        summary.entries = writer.entries();
+        summary.rawBytes = writer.rawBytes();
+
+        std::sort(index.begin(), index.end(), [](auto const& a, auto const& b) {
+            return a.firstKey < b.firstKey;
+        });
+
+        s.erase();
+        for (auto const& e : index)
+        {
+            s.addBitString(e.firstKey);
+            s.add64(e.offset);
+            s.add32(e.compressed);
+            s.add32(e.size);
+            s.add32(e.entries);
+        }
+        s.add64(offset);
+        s.add32(index.size());
+        s.add64(summary.entries);
+        s.add64(summary.rawBytes);
+        s.add32(exportMagic);
+        out.write(reinterpret_cast<char const*>(s.data()), s.size());
+
+        out.close();
+        if (!out)
+            Throw<std::runtime_error>("unable to write " + temp);
+
+        boost::filesystem::rename(temp, path);
+
+        summary.blocks = index.size();
+        summary.bytes = offset + s.size();
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j.warn()) << "Unable to export ledger " << info.seq << " to "
+                       << path.string() << ": " << e.what();
+
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp, ec);
+        throw;
+    }
+
+    summary.elapsed =
+        duration_cast<microseconds>(steady_clock::now() - start);
+
+    JLOG(j.info()) << "Exported " << summary.entries << " entries of ledger "
+                   << info.seq << " to " << path.string() << " in "
+                   << summary.blocks << " blocks, " << summary.bytes
+                   << " bytes in " << summary.elapsed.count() << "us";
+    return summary;
+}
+
+Summary
+read(
+    boost::filesystem::path const& path,
+    std::function<void(Entry const&)> const& f)
+{
+    namespace bip = boost::interprocess;
+    using namespace std::chrono;
+    auto const start = steady_clock::now();
+
+    bip::file_mapping file(path.string().c_str(), bip::read_only);
+    bip::mapped_region region(file, bip::read_only);
+    region.advise(bip::mapped_region::advice_sequential);
+
+    auto const data = static_cast<std::uint8_t const*>(region.get_address());
+    auto const size = region.get_size();
+    if (size < headerSize + footerSize)
+        Throw<std::runtime_error>("too short");
+
+    Summary summary;
+    summary.bytes = size;
+
+    SerialIter header(data, headerSize);
+    if (header.get32() != exportMagic)
+        Throw<std::runtime_error>("not an export");
+    if (auto const version = header.get32(); version != exportVersion)
+        Throw<std::runtime_error>("unknown version " + std::to_string(version));
+    summary.ledgerSeq = header.get32();
+    summary.ledgerHash = header.get256();
+    summary.accountHash = header.get256();
+
+    SerialIter footer(data + size - footerSize, footerSize);
+    auto const indexOffset = footer.get64();
+    summary.blocks = footer.get32();
+    summary.entries = footer.get64();
+    summary.rawBytes = footer.get64();
+    if (footer.get32() != exportMagic)
+        Throw<std::runtime_error>("incomplete export");
+    if (indexOffset < headerSize ||
+        indexOffset + std::uint64_t{summary.blocks} * indexEntrySize !=
+            size - footerSize)
+        Throw<std::runtime_error>("bad index");
+
+    SerialIter index(data + indexOffset, summary.blocks * indexEntrySize);
+    std::vector<std::uint8_t> block;
+    std::uint64_t entries = 0;
+
+    for (std::uint32_t b = 0; b < summary.blocks; ++b)
+    {
+        index.skip(32);
+        auto const offset = index.get64();
+        auto const compressed = index.get32();
+        auto const blockSize = index.get32();
+        auto const blockEntries = index.get32();
+        if (offset < headerSize || offset + compressed > indexOffset)
+            Throw<std::runtime_error>("bad block offset");
+
+        block.resize(blockSize);
+        compression_algorithms::lz4Decompress(
+            data + offset, compressed, block.data(), blockSize);
+
+        SerialIter records(block.data(), block.size());
+        for (std::uint32_t i = 0; i < blockEntries; ++i)
+        {
+            Entry entry;
+            entry.key = records.get256();
+            entry.type = records.get16();
+            entry.data = records.getSlice(records.get32());
+            f(entry);
+        }
+        if (!records.empty())
+            Throw<std::runtime_error>("bad block");
+        entries += blockEntries;
+    }
+
+    if (entries != summary.entries)
+        Throw<std::runtime_error>("entry count mismatch");
+
+    summary.elapsed =
+        duration_cast<microseconds>(steady_clock::now() - start);
+    return summary;
+}
+
+}  // namespace StateExport
+}  // namespace ripple
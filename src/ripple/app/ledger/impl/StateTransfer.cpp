@@ -0,0 +1,239 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/StateTransfer.h>
+#include <ripple/nodestore/Database.h>
+#include <ripple/shamap/SHAMapItem.h>
+#include <algorithm>
+#include <cassert>
+
+namespace ripple {
+
+namespace {
+
+std::optional<uint256>
+parseKey(std::string const& s)
+{
+    if (s.size() != uint256::size())
+        return std::nullopt;
+    return uint256{s};
+}
+
+}  // namespace
+
+StateTransfer::StateTransfer(
+    uint256 const& ledgerHash,
+    SHAMapHash const& accountHash,
+    Family& family,
+    std::size_t ranges)
+    : ledgerHash_(ledgerHash)
+    , accountHash_(accountHash)
+    , map_(std::make_shared<SHAMap>(SHAMapType::STATE, family))
+    , ranges_(ranges)
+{
+    assert(ranges != 0 && ranges <= 256 && (ranges & (ranges - 1)) == 0);
+
+    // Split the key space on the first byte of the key
+    auto const width = 256 / ranges;
+    for (std::size_t i = 0; i < ranges; ++i)
+    {
+        ranges_[i].marker.data()[0] = static_cast<std::uint8_t>(i * width);
+        if (i + 1 != ranges)
+        {
+            uint256 end;
+            end.data()[0] = static_cast<std::uint8_t>((i + 1) * width);
+            ranges_[i].end = end;
+        }
+    }
+}
+
+std::optional<protocol::TMGetStateRange>
+StateTransfer::nextRequest(std::uint32_t peer)
+{
+    if (!usable(peer))
+        return std::nullopt;
+
+    auto const range =
+        std::find_if(ranges_.begin(), ranges_.end(), [](Range const& r) {
+            return !r.done && !r.peer;
+        });
+    if (range == ranges_.end())
+        return std::nullopt;
+
+    range->peer = peer;
+    range->asked = ticks_;
+
+    protocol::TMGetStateRange request;
+    request.set_ledgerhash(ledgerHash_.begin(), ledgerHash_.size());
+    request.set_marker(range->marker.begin(), range->marker.size());
+    if (range->end)
+        request.set_end(range->end->begin(), range->end->size());
+    return request;
+}
+
+StateTransfer::Result
+StateTransfer::take(std::uint32_t peer, protocol::TMStateRange const& reply)
+{
+    auto const marker = parseKey(reply.marker());
+    if (!marker)
+        return Result::stale;
+
+    auto const range =
+        std::find_if(ranges_.begin(), ranges_.end(), [&](Range const& r) {
+            return r.peer == peer && r.marker == *marker;
+        });
+    if (range == ranges_.end())
+        return Result::stale;
+
+    // Whatever the answer, the range may be asked for again
+    range->peer.reset();
+
+    auto reject = [this, peer](Result result) {
+        refused_.insert(peer);
+        return result;
+    };
+
+    if (reply.has_error())
+        return reject(Result::refused);
+
+    // Leaves must be in key order and in the range, so every one received
+    // is new. Check them all before taking any.
+    std::vector<boost::intrusive_ptr<SHAMapItem const>> items;
+    items.reserve(reply.leaves_size());
+    std::optional<uint256> last;
+    for (auto const& leaf : reply.leaves())
+    {
+        auto const key = parseKey(leaf.key());
+        if (!key || leaf.data().empty() || *key < *marker ||
+            (last && *key <= *last) || (range->end && *key >= *range->end))
+            return reject(Result::bad);
+
+        items.push_back(make_shamapitem(*key, makeSlice(leaf.data())));
+        last = key;
+    }
+
+    std::optional<uint256> next;
+    if (reply.has_next())
+    {
+        next = parseKey(reply.next());
+        if (!next || *next <= *marker || (last && *next <= *last) ||
+            (range->end && *next >= *range->end))
+            return reject(Result::bad);
+    }
+
+    for (auto& item : items)
+        map_->addGiveItem(SHAMapNodeType::tnACCOUNT_STATE, std::move(item));
+    leaves_ += items.size();
+
+    if (next)
+        range->marker = *next;
+    else
+        range->done = true;
+    return Result::useful;
+}
+
+void
+StateTransfer::timeout()
+{
+    ++ticks_;
+    for (auto& range : ranges_)
+    {
+        if (range.peer && ticks_ - range.asked > 1)
+            range.peer.reset();
+    }
+}
+
+bool
+StateTransfer::waiting() const
+{
+    return std::any_of(ranges_.begin(), ranges_.end(), [](Range const& r) {
+        return r.peer.has_value();
+    });
+}
+
+bool
+StateTransfer::complete() const
+{
+    return std::all_of(ranges_.begin(), ranges_.end(), [](Range const& r) {
+        return r.done;
+    });
+}
+
+std::shared_ptr<SHAMap>
+StateTransfer::finish()
+{
+    assert(complete());
+    if (map_->getHash() != accountHash_)
+        return nullptr;
+    return map_;
+}
+
+protocol::TMStateRange
+StateTransfer::makeReply(
+    SHAMap const* stateMap,
+    protocol::TMGetStateRange const& request)
+{
+    protocol::TMStateRange reply;
+    reply.set_ledgerhash(request.ledgerhash());
+    reply.set_marker(request.marker());
+
+    auto const marker = parseKey(request.marker());
+    std::optional<uint256> end;
+    if (request.has_end())
+        end = parseKey(request.end());
+    if (request.ledgerhash().size() != uint256::size() || !marker ||
+        (request.has_end() && (!end || *end <= *marker)))
+    {
+        reply.set_error(protocol::TMReplyError::reBAD_REQUEST);
+        return reply;
+    }
+
+    if (!stateMap)
+    {
+        reply.set_error(protocol::TMReplyError::reNO_LEDGER);
+        return reply;
+    }
+
+    auto const readAhead = stateMap->family().db().scanReadAhead();
+    auto it = stateMap->begin(readAhead);
+    if (*marker != beast::zero)
+    {
+        auto before = *marker;
+        --before;
+        it = stateMap->upper_bound(before, readAhead);
+    }
+
+    std::size_t bytes = 0;
+    for (; it != stateMap->end() && (!end || it->key() < *end); ++it)
+    {
+        if (reply.leaves_size() == replyLeaves || bytes >= replyBytes)
+        {
+            reply.set_next(it->key().begin(), it->key().size());
+            break;
+        }
+
+        auto leaf = reply.add_leaves();
+        leaf->set_key(it->key().begin(), it->key().size());
+        leaf->set_data(it->data(), it->size());
+        bytes += it->size();
+    }
+    return reply;
+}
+
+}  // namespace ripple
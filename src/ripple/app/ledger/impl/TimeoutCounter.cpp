@@ -21,6 +21,7 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/overlay/Overlay.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -40,6 +41,7 @@ TimeoutCounter::TimeoutCounter(
     , failed_(false)
     , progress_(false)
     , timerInterval_(interval)
+    , baseInterval_(interval)
     , queueJobParameter_(std::move(jobParameter))
     , timer_(app_.getIOService())
 {
@@ -89,6 +91,16 @@ TimeoutCounter::queueJob(ScopedLockType& sl)
         });
 }
 
+void
+TimeoutCounter::adaptTimer(std::chrono::milliseconds responseTime)
+{
+    // Allow for the reply to a deep query and for the job queue
+    auto constexpr responseTimeMultiple = 4;
+
+    timerInterval_ = std::clamp(
+        responseTime * responseTimeMultiple, baseInterval_ / 2, baseInterval_);
+}
+
 void
 TimeoutCounter::invokeOnTimer()
 {
@@ -104,6 +104,14 @@ protected:
     void
     queueJob(ScopedLockType&);
 
+    /** Fit the timer interval to how fast the peers serving us answer.
+
+        The interval is a few times the response time, but no shorter than
+        half and no longer than the interval the object was built with.
+    */
+    void
+    adaptTimer(std::chrono::milliseconds responseTime);
+
     /** Hook called from invokeOnTimer(). */
     virtual void
     onTimer(bool progress, ScopedLockType&) = 0;
@@ -134,6 +142,8 @@ protected:
     bool progress_;
     /** The minimum time to wait between calls to execute(). */
     std::chrono::milliseconds timerInterval_;
+    /** The interval the object was built with. */
+    std::chrono::milliseconds const baseInterval_;
 
     QueueJobParameter queueJobParameter_;
 
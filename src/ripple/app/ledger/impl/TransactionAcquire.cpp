@@ -20,12 +20,18 @@
 #include <ripple/app/ledger/ConsensusTransSetSF.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/InboundTransactions.h>
+#include <ripple/app/ledger/TxSetSketch.h>
 #include <ripple/app/ledger/impl/TransactionAcquire.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/overlay/Message.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/impl/ProtocolMessage.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/resource/Fees.h>
 
+#include <algorithm>
 #include <memory>
 
 namespace ripple {
@@ -38,12 +44,18 @@ auto constexpr TX_ACQUIRE_TIMEOUT = 250ms;
 enum {
     NORM_TIMEOUTS = 4,
     MAX_TIMEOUTS = 20,
+
+    // A reconciliation sketch is sized to list one difference for every
+    // this many transactions in our set, and at least MIN_RECONCILE
+    RECONCILE_SHARE = 4,
+    MIN_RECONCILE = 8,
 };
 
 TransactionAcquire::TransactionAcquire(
     Application& app,
     uint256 const& hash,
-    std::unique_ptr<PeerSet> peerSet)
+    std::unique_ptr<PeerSet> peerSet,
+    std::shared_ptr<SHAMap> base)
     : TimeoutCounter(
           app,
           hash,
@@ -52,6 +64,8 @@ TransactionAcquire::TransactionAcquire(
           app.journal("TransactionAcquire"))
     , mHaveRoot(false)
     , mPeerSet(std::move(peerSet))
+    , mBase(std::move(base))
+    , mReconcile(Reconcile::done)
 {
     mMap = std::make_shared<SHAMap>(
         SHAMapType::TRANSACTION, hash, app_.getNodeFamily());
@@ -97,10 +111,21 @@ TransactionAcquire::onTimer(bool progress, ScopedLockType& psl)
         return;
     }
 
-    if (timeouts_ >= NORM_TIMEOUTS)
+    if (mReconcile == Reconcile::pending)
+    {
+        // The peer didn't answer in time, fetch the whole set instead
+        JLOG(journal_.debug()) << "TX set reconciliation timed out " << hash_;
+        mReconcile = Reconcile::done;
+        trigger(nullptr);
+    }
+    else if (timeouts_ >= NORM_TIMEOUTS)
         trigger(nullptr);
 
     addPeers(1);
+
+    if (auto const fastest = getFastestPeers(app_.overlay(), *mPeerSet, 1);
+        !fastest.empty())
+        adaptTimer(*fastest.front()->responseTime());
 }
 
 std::weak_ptr<TimeoutCounter>
@@ -123,6 +148,28 @@ TransactionAcquire::trigger(std::shared_ptr<Peer> const& peer)
         return;
     }
 
+    if (!mHaveRoot && mReconcile == Reconcile::idle && peer &&
+        peer->supportsFeature(ProtocolFeature::TxReconcile))
+    {
+        JLOG(journal_.trace()) << "TransactionAcquire::trigger reconcile";
+        protocol::TMReconcileTxSet tmRTS;
+        tmRTS.set_txsethash(hash_.begin(), hash_.size());
+        auto const& baseHash = mBase->getHash().as_uint256();
+        tmRTS.set_basesethash(baseHash.begin(), baseHash.size());
+        tmRTS.set_sketch(mSketch);
+        peer->send(
+            std::make_shared<Message>(tmRTS, protocol::mtRECONCILE_TXSET_REQ));
+        mReconcile = Reconcile::pending;
+        return;
+    }
+
+    if (!mHaveRoot && mReconcile == Reconcile::pending)
+    {
+        // Wait for the answer before fetching the set
+        JLOG(journal_.trace()) << "TransactionAcquire::trigger reconciling";
+        return;
+    }
+
     if (!mHaveRoot)
     {
         JLOG(journal_.trace()) << "TransactionAcquire::trigger "
@@ -243,6 +290,86 @@ TransactionAcquire::takeNodes(
     }
 }
 
+void
+TransactionAcquire::takeReconcile(
+    protocol::TMReconcileTxSetResponse const& reply,
+    std::shared_ptr<Peer> const& peer)
+{
+    ScopedLockType sl(mtx_);
+
+    if (complete_ || failed_ || mReconcile != Reconcile::pending)
+    {
+        JLOG(journal_.trace()) << "TX set reconciliation not wanted";
+        return;
+    }
+
+    mReconcile = Reconcile::done;
+
+    if (reply.has_error())
+    {
+        JLOG(journal_.debug())
+            << "Peer could not reconcile TX set " << hash_ << ": "
+            << reply.error();
+    }
+    else if (auto map = reconciled(reply))
+    {
+        JLOG(journal_.debug())
+            << "Reconciled TX set " << hash_ << ": "
+            << reply.transaction_size() << " added, " << reply.removed_size()
+            << " removed";
+        mMap = std::move(map);
+        progress_ = true;
+        complete_ = true;
+        done();
+        return;
+    }
+    else
+    {
+        JLOG(journal_.warn()) << "Peer sends us a bad reconciliation of "
+                              << hash_;
+        peer->charge(Resource::feeBadData);
+    }
+
+    // Fetch the whole set from all the peers held back while we waited
+    trigger(nullptr);
+}
+
+std::shared_ptr<SHAMap>
+TransactionAcquire::reconciled(
+    protocol::TMReconcileTxSetResponse const& reply) const
+{
+    if (reply.basesethash().size() != uint256::size() ||
+        uint256{reply.basesethash()} != mBase->getHash().as_uint256())
+        return {};
+
+    try
+    {
+        auto map = mBase->snapShot(true);
+
+        for (auto const& id : reply.removed())
+        {
+            if (id.size() != uint256::size() || !map->delItem(uint256{id}))
+                return {};
+        }
+
+        for (auto const& tx : reply.transaction())
+        {
+            auto const data = makeSlice(tx);
+            auto const item = make_shamapitem(
+                sha512Half(HashPrefix::transactionID, data), data);
+            if (!map->addItem(SHAMapNodeType::tnTRANSACTION_NM, item))
+                return {};
+        }
+
+        if (map->getHash().as_uint256() == hash_)
+            return map;
+    }
+    catch (std::exception const&)
+    {
+    }
+    return {};
+}
+
 void
 TransactionAcquire::addPeers(std::size_t limit)
 {
@@ -257,6 +384,25 @@ TransactionAcquire::init(int numPeers)
 {
     ScopedLockType sl(mtx_);
 
+    if (mBase)
+    {
+        std::vector<uint256> ids;
+        for (auto const& item : *mBase)
+            ids.push_back(item.key());
+
+        if (!ids.empty())
+        {
+            auto const differences = std::max<std::size_t>(
+                MIN_RECONCILE, ids.size() / RECONCILE_SHARE);
+            TxSetSketch sketch(std::min(
+                TxSetSketch::maxCells, TxSetSketch::cellsFor(differences)));
+            for (auto const& id : ids)
+                sketch.insert(id);
+            mSketch = sketch.serialize();
+            mReconcile = Reconcile::idle;
+        }
+    }
+
     addPeers(numPeers);
 
     setTimer(sl);
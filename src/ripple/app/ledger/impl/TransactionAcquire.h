@@ -36,10 +36,16 @@ class TransactionAcquire final
 public:
     using pointer = std::shared_ptr<TransactionAcquire>;
 
+    /** Create an acquisition.
+
+        @param base A set of our own, to try reconciling the set against
+                    with a peer before fetching all of it.
+    */
     TransactionAcquire(
         Application& app,
         uint256 const& hash,
-        std::unique_ptr<PeerSet> peerSet);
+        std::unique_ptr<PeerSet> peerSet,
+        std::shared_ptr<SHAMap> base = {});
     ~TransactionAcquire() = default;
 
     SHAMapAddNode
@@ -48,6 +54,11 @@ public:
         const std::list<Blob>& data,
         std::shared_ptr<Peer> const&);
 
+    void
+    takeReconcile(
+        protocol::TMReconcileTxSetResponse const& reply,
+        std::shared_ptr<Peer> const&);
+
     void
     init(int startPeers);
 
@@ -59,6 +70,13 @@ private:
     bool mHaveRoot;
     std::unique_ptr<PeerSet> mPeerSet;
 
+    enum class Reconcile { idle, pending, done };
+
+    // The set to reconcile against, and the sketch of it sent to a peer
+    std::shared_ptr<SHAMap> mBase;
+    std::string mSketch;
+    Reconcile mReconcile;
+
     void
     onTimer(bool progress, ScopedLockType& peerSetLock) override;
 
@@ -70,6 +88,9 @@ private:
 
     void
     trigger(std::shared_ptr<Peer> const&);
+
+    std::shared_ptr<SHAMap>
+    reconciled(protocol::TMReconcileTxSetResponse const& reply) const;
     std::weak_ptr<TimeoutCounter>
     pmDowncast() override;
 };
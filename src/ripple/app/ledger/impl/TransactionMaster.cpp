@@ -107,7 +107,7 @@ TransactionMaster::fetch(
 
 std::shared_ptr<STTx const>
 TransactionMaster::fetch(
-    std::shared_ptr<SHAMapItem> const& item,
+    boost::intrusive_ptr<SHAMapItem> const& item,
     SHAMapNodeType type,
     std::uint32_t uCommitLedger)
 {
@@ -123,9 +123,9 @@ TransactionMaster::fetch(
         }
         else if (type == SHAMapNodeType::tnTRANSACTION_MD)
         {
-            auto blob = SerialIter{item->data(), item->size()}.getVL();
-            txn = std::make_shared<STTx const>(
-                SerialIter{blob.data(), blob.size()});
+            auto const slice =
+                SerialIter{item->data(), item->size()}.getVLSlice();
+            txn = std::make_shared<STTx const>(SerialIter{slice});
         }
     }
     else
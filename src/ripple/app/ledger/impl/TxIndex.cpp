@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/TxIndex.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/RangeSet.h>
+#include <ripple/nodestore/Database.h>
+#include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/protocol/STObject.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/shamap/SHAMapLeafNode.h>
+
+namespace ripple {
+
+// Tree nodes and ledgers are hashed with a HashPrefix in front, which
+// this differs from
+static constexpr std::uint32_t txIndexTag = 0x54584958;  // "TXIX"
+
+// ledger sequence, transaction index, leaf hash
+static constexpr std::size_t txIndexSize = 4 + 4 + uint256::bytes;
+
+uint256
+txIndexKey(uint256 const& txID)
+{
+    return sha512Half(txIndexTag, txID);
+}
+
+std::vector<std::pair<uint256, Blob>>
+makeTxIndex(Ledger const& ledger)
+{
+    std::vector<std::pair<uint256, Blob>> result;
+    auto const seq = ledger.info().seq;
+
+    ledger.txMap().visitNodes([&](SHAMapTreeNode& node) {
+        if (!node.isLeaf())
+            return true;
+
+        auto const& item = static_cast<SHAMapLeafNode&>(node).peekItem();
+        SerialIter sit(item->slice());
+        sit.skip(sit.getVLDataLength());
+        auto const rawMeta = sit.getVL();
+        SerialIter mit(makeSlice(rawMeta));
+        STObject const meta(mit, sfMetadata);
+
+        Serializer s(txIndexSize);
+        s.add32(seq);
+        s.add32(meta.getFieldU32(sfTransactionIndex));
+        s.addBitString(node.getHash().as_uint256());
+        result.emplace_back(txIndexKey(item->key()), std::move(s.modData()));
+        return true;
+    });
+
+    return result;
+}
+
+boost::optional<TxLocation>
+parseTxIndex(NodeObject const& object)
+{
+    if (object.getType() != hotTX_INDEX ||
+        object.getData().size() != txIndexSize)
+        return boost::none;
+
+    SerialIter sit(object.getData());
+    TxLocation location;
+    location.ledgerSeq = sit.get32();
+    location.txnSeq = sit.get32();
+    location.node = sit.get256();
+    return location;
+}
+
+boost::optional<TxLocation>
+findTxIndex(Application& app, uint256 const& txID)
+{
+    auto const key = txIndexKey(txID);
+    if (auto object = app.getNodeStore().fetchNodeObject(key))
+        return parseTxIndex(*object);
+
+    auto shardStore = app.getShardStore();
+    if (!shardStore)
+        return boost::none;
+
+    // Each shard holds the entries of its own ledgers, newest shards first
+    RangeSet<std::uint32_t> complete;
+    if (!from_string(complete, shardStore->getCompleteShards()))
+        return boost::none;
+
+    for (auto it = complete.rbegin(); it != complete.rend(); ++it)
+    {
+        for (auto index = it->upper() + 1; index-- > it->lower();)
+        {
+            if (auto object = shardStore->fetchNodeObject(
+                    key, shardStore->firstLedgerSeq(index)))
+                return parseTxIndex(*object);
+        }
+    }
+
+    return boost::none;
+}
+
+}  // namespace ripple
@@ -0,0 +1,184 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/TxSetSketch.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/digest.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace ripple {
+
+namespace {
+
+// Bytes in a serialized cell: the count, the ID sum and the check sum
+std::size_t constexpr cellBytes = 4 + 32 + 8;
+
+// The first words pick the cells an ID is stored in, the last one is
+// the check that tells a cell holding a single ID from a mixture
+std::array<std::uint64_t, 4>
+words(uint256 const& id)
+{
+    auto const digest = sha512Half(id);
+    std::array<std::uint64_t, 4> result;
+    static_assert(sizeof(result) == uint256::size());
+    std::memcpy(result.data(), digest.data(), digest.size());
+    return result;
+}
+
+}  // namespace
+
+TxSetSketch::TxSetSketch(std::size_t cells)
+    : cells_(std::max(
+          hashCount,
+          (cells + hashCount - 1) / hashCount * hashCount))
+{
+}
+
+std::size_t
+TxSetSketch::cellsFor(std::size_t differences)
+{
+    // Small tables need the most room, since a few IDs that happen to share
+    // all their cells can't be taken out. About one sketch in a hundred
+    // sized this way fails to decode.
+    return 3 * differences + 10 * hashCount;
+}
+
+void
+TxSetSketch::insert(uint256 const& id)
+{
+    toggle(id, 1);
+}
+
+bool
+TxSetSketch::subtract(TxSetSketch const& other)
+{
+    if (other.cells_.size() != cells_.size())
+        return false;
+
+    for (std::size_t i = 0; i < cells_.size(); ++i)
+    {
+        cells_[i].count -= other.cells_[i].count;
+        cells_[i].idSum ^= other.cells_[i].idSum;
+        cells_[i].checkSum ^= other.cells_[i].checkSum;
+    }
+    return true;
+}
+
+std::optional<TxSetSketch::Difference>
+TxSetSketch::decode() const
+{
+    TxSetSketch sketch(*this);
+    Difference diff;
+
+    // Take out IDs from cells that hold only one, which may leave other
+    // cells holding only one, until there are none left to take. A sketch
+    // can never list more IDs than it has cells.
+    for (bool progress = true; progress;)
+    {
+        progress = false;
+        for (auto const& cell : sketch.cells_)
+        {
+            if (!sketch.pure(cell))
+                continue;
+
+            if (diff.added.size() + diff.removed.size() == cells_.size())
+                return {};
+
+            auto const id = cell.idSum;
+            auto const count = cell.count;
+            (count > 0 ? diff.added : diff.removed).push_back(id);
+            sketch.toggle(id, -count);
+            progress = true;
+        }
+    }
+
+    for (auto const& cell : sketch.cells_)
+    {
+        if (cell.count != 0 || cell.idSum.isNonZero() || cell.checkSum != 0)
+            return {};
+    }
+
+    return diff;
+}
+
+std::string
+TxSetSketch::serialize() const
+{
+    Serializer s(cells_.size() * cellBytes);
+    for (auto const& cell : cells_)
+    {
+        s.add32(static_cast<std::uint32_t>(cell.count));
+        s.addBitString(cell.idSum);
+        s.add64(cell.checkSum);
+    }
+    return s.getString();
+}
+
+std::optional<TxSetSketch>
+TxSetSketch::deserialize(Slice data)
+{
+    auto const cells = data.size() / cellBytes;
+    if (cells == 0 || cells > maxCells || data.size() % cellBytes != 0 ||
+        cells % hashCount != 0)
+        return {};
+
+    TxSetSketch sketch(cells);
+    SerialIter sit(data);
+    for (auto& cell : sketch.cells_)
+    {
+        cell.count = static_cast<std::int32_t>(sit.get32());
+        cell.idSum = sit.get256();
+        cell.checkSum = sit.get64();
+    }
+    return sketch;
+}
+
+void
+TxSetSketch::toggle(uint256 const& id, std::int32_t count)
+{
+    auto const w = words(id);
+    auto const part = cells_.size() / hashCount;
+    for (std::size_t i = 0; i < hashCount; ++i)
+    {
+        auto& cell = cells_[i * part + w[i] % part];
+        cell.count += count;
+        cell.idSum ^= id;
+        cell.checkSum ^= w[hashCount];
+    }
+}
+
+bool
+TxSetSketch::pure(Cell const& cell) const
+{
+    return (cell.count == 1 || cell.count == -1) &&
+        words(cell.idSum)[hashCount] == cell.checkSum;
+}
+
+TxSetSketch
+makeTxSetSketch(SHAMap const& set, std::size_t cells)
+{
+    TxSetSketch sketch(cells);
+    for (auto const& item : set)
+        sketch.insert(item.key());
+    return sketch;
+}
+
+}  // namespace ripple
@@ -18,8 +18,10 @@
 //==============================================================================
 
 #include <ripple/app/consensus/RCLValidations.h>
+#include <ripple/app/ledger/BuildLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/InboundTransactions.h>
+#include <ripple/app/ledger/IssuerBalances.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LedgerReplayer.h>
 #include <ripple/app/ledger/LedgerToJson.h>
@@ -32,14 +34,19 @@
 #include <ripple/app/main/DBInit.h>
 #include <ripple/app/main/GRPCServer.h>
 #include <ripple/app/main/LoadManager.h>
+#include <ripple/app/main/MemoryBudget.h>
 #include <ripple/app/main/NodeIdentity.h>
 #include <ripple/app/main/NodeStoreScheduler.h>
+#include <ripple/app/main/StartupTasks.h>
 #include <ripple/app/main/Tuning.h>
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/NodeStoreCompactor.h>
 #include <ripple/app/misc/SHAMapStore.h>
+#include <ripple/app/misc/SignatureCache.h>
+#include <ripple/app/misc/TxPartitions.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
 #include <ripple/app/misc/ValidatorSite.h>
@@ -49,12 +56,15 @@
 #include <ripple/basics/ByteUtilities.h>
 #include <ripple/basics/PerfLog.h>
 #include <ripple/basics/ResolverAsio.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/beast/asio/io_latency_probe.h>
 #include <ripple/beast/core/LexicalCast.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/core/Pg.h>
 #include <ripple/core/Stoppable.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/nodestore/DummyScheduler.h>
@@ -66,8 +76,11 @@
 #include <ripple/protocol/Feature.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/protocol/STParsedJSON.h>
+#include <ripple/protocol/TxFormats.h>
 #include <ripple/resource/Fees.h>
+#include <ripple/rpc/ResponseCache.h>
 #include <ripple/rpc/ShardArchiveHandler.h>
+#include <ripple/rpc/SigningQueue.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 #include <ripple/shamap/NodeFamily.h>
 #include <ripple/shamap/ShardFamily.h>
@@ -161,6 +174,7 @@ public:
 
     beast::Journal m_journal;
     std::unique_ptr<perf::PerfLog> perfLog_;
+    std::unique_ptr<perf::Tracer> tracer_;
     Application::MutexType m_masterMutex;
 
     // Required by the SHAMapStore
@@ -186,6 +200,7 @@ public:
 
     // These are Stoppable-related
     std::unique_ptr<JobQueue> m_jobQueue;
+    WorkerPool workerPool_;
     std::unique_ptr<NodeStore::Database> m_nodeStore;
     NodeFamily nodeFamily_;
     std::unique_ptr<NodeStore::DatabaseShard> shardStore_;
@@ -193,7 +208,10 @@ public:
     std::unique_ptr<RPC::ShardArchiveHandler> shardArchiveHandler_;
     // VFALCO TODO Make OrderBookDB abstract
     OrderBookDB m_orderBookDB;
+    IssuerBalances m_issuerBalances;
     std::unique_ptr<PathRequests> m_pathRequests;
+    std::unique_ptr<RPC::ResponseCache> responseCache_;
+    std::unique_ptr<RPC::SigningQueue> signingQueue_;
     std::unique_ptr<LedgerMaster> m_ledgerMaster;
     std::unique_ptr<InboundLedgers> m_inboundLedgers;
     std::unique_ptr<InboundTransactions> m_inboundTransactions;
@@ -210,6 +228,7 @@ public:
     std::unique_ptr<AmendmentTable> m_amendmentTable;
     std::unique_ptr<LoadFeeTrack> mFeeTrack;
     std::unique_ptr<HashRouter> hashRouter_;
+    std::unique_ptr<SignatureCache> signatureCache_;
     RCLValidations mValidations;
     std::unique_ptr<LoadManager> m_loadManager;
     std::unique_ptr<TxQ> txQ_;
@@ -219,6 +238,7 @@ public:
     bool startTimers_;
 
     std::unique_ptr<DatabaseCon> mTxnDB;
+    std::unique_ptr<TxPartitions> txPartitions_;
     std::unique_ptr<DatabaseCon> mLedgerDB;
     std::unique_ptr<DatabaseCon> mWalletDB;
     std::unique_ptr<Overlay> overlay_;
@@ -236,6 +256,12 @@ public:
 
     io_latency_sampler m_io_latency_sampler;
 
+    // Time taken by each step of setup(), ending with the total
+    std::vector<std::pair<std::string, std::chrono::milliseconds>>
+        startupTimes_;
+
+    MemoryBudget memoryBudget_;
+
     std::unique_ptr<GRPCServer> grpcServer_;
     std::unique_ptr<ReportingETL> reportingETL_;
 
@@ -281,6 +307,9 @@ public:
               logs_->journal("PerfLog"),
               [this]() { signalStop(); }))
 
+        , tracer_(std::make_unique<perf::Tracer>(
+              perf::setup_Tracer(config_->section("trace"))))
+
         , m_txMaster(*this)
 #ifdef RIPPLED_REPORTING
         , pgPool_(
@@ -325,9 +354,14 @@ public:
               m_nodeStoreScheduler,
               logs_->journal("JobQueue"),
               *logs_,
-              *perfLog_))
+              *perfLog_,
+              *tracer_))
+
+        , workerPool_(config_->PARALLEL_THREADS.value_or(
+              std::max(1u, std::thread::hardware_concurrency()) - 1))
 
-        , m_nodeStore(m_shaMapStore->makeNodeStore("NodeStore.main", 4))
+        , m_nodeStore(m_shaMapStore->makeNodeStore(
+              "NodeStore.main", config_->NODESTORE_READ_THREADS))
 
         , nodeFamily_(*this, *m_collectorManager)
 
@@ -341,11 +375,21 @@ public:
 
         , m_orderBookDB(*this, *m_jobQueue)
 
+        , m_issuerBalances(*this, *m_jobQueue)
+
         , m_pathRequests(std::make_unique<PathRequests>(
               *this,
               logs_->journal("PathRequest"),
               m_collectorManager->collector()))
 
+        , responseCache_(std::make_unique<RPC::ResponseCache>(
+              RPC::setup_ResponseCache(*config_),
+              m_collectorManager->collector()))
+
+        , signingQueue_(std::make_unique<RPC::SigningQueue>(
+              RPC::setup_SigningQueue(*config_),
+              logs_->journal("SigningQueue")))
+
         , m_ledgerMaster(std::make_unique<LedgerMaster>(
               *this,
               stopwatch(),
@@ -435,6 +479,8 @@ public:
               HashRouter::getDefaultHoldTime(),
               HashRouter::getDefaultRecoverLimit()))
 
+        , signatureCache_(std::make_unique<SignatureCache>())
+
         , mValidations(
               ValidationParms(),
               stopwatch(),
@@ -465,6 +511,9 @@ public:
               logs_->journal("Application"),
               std::chrono::milliseconds(100),
               get_io_service())
+        , memoryBudget_(
+              setup_MemoryBudget(*config_),
+              logs_->journal("MemoryBudget"))
         , grpcServer_(std::make_unique<GRPCServer>(*this, *m_jobQueue))
         , reportingETL_(std::make_unique<ReportingETL>(*this, *m_ledgerMaster))
     {
@@ -487,6 +536,11 @@ public:
 
         // VFALCO HACK
         m_nodeStoreScheduler.setJobQueue(*m_jobQueue);
+        m_nodeStoreScheduler.setCollector(m_collectorManager->collector());
+#ifdef RIPPLED_REPORTING
+        if (pgPool_)
+            pgPool_->setCollector(m_collectorManager->collector());
+#endif
 
         add(m_ledgerMaster->getPropertySource());
     }
@@ -556,6 +610,12 @@ public:
         return *m_jobQueue;
     }
 
+    WorkerPool&
+    getWorkerPool() override
+    {
+        return workerPool_;
+    }
+
     std::pair<PublicKey, SecretKey> const&
     nodeIdentity() override
     {
@@ -586,6 +646,12 @@ public:
         return m_io_latency_sampler.get();
     }
 
+    std::vector<std::pair<std::string, std::chrono::milliseconds>> const&
+    getStartupTimes() const override
+    {
+        return startupTimes_;
+    }
+
     LedgerMaster&
     getLedgerMaster() override
     {
@@ -635,12 +701,24 @@ public:
         return *perfLog_;
     }
 
+    perf::Tracer&
+    getTracer() override
+    {
+        return *tracer_;
+    }
+
     NodeCache&
     getTempNodeCache() override
     {
         return m_tempNodeCache;
     }
 
+    MemoryBudget&
+    getMemoryBudget() override
+    {
+        return memoryBudget_;
+    }
+
     NodeStore::Database&
     getNodeStore() override
     {
@@ -737,12 +815,30 @@ public:
         return m_orderBookDB;
     }
 
+    IssuerBalances&
+    getIssuerBalances() override
+    {
+        return m_issuerBalances;
+    }
+
     PathRequests&
     getPathRequests() override
     {
         return *m_pathRequests;
     }
 
+    RPC::ResponseCache&
+    getResponseCache() override
+    {
+        return *responseCache_;
+    }
+
+    RPC::SigningQueue&
+    getSigningQueue() override
+    {
+        return *signingQueue_;
+    }
+
     CachedSLEs&
     cachedSLEs() override
     {
@@ -767,6 +863,12 @@ public:
         return *hashRouter_;
     }
 
+    SignatureCache&
+    getSignatureCache() override
+    {
+        return *signatureCache_;
+    }
+
     RCLValidations&
     getValidations() override
     {
@@ -863,6 +965,12 @@ public:
         assert(mTxnDB.get() != nullptr);
         return *mTxnDB;
     }
+    TxPartitions&
+    getTxPartitions() override
+    {
+        assert(txPartitions_);
+        return *txPartitions_;
+    }
     DatabaseCon&
     getLedgerDB() override
     {
@@ -913,6 +1021,9 @@ public:
             auto setup = setup_DatabaseCon(*config_, m_journal);
             if (!config_->reporting())
             {
+                // Only the history databases serve concurrent queries
+                setup.readConnections = readConnections_DatabaseCon(*config_);
+
                 if (config_->useTxTables())
                 {
                     // transaction database
@@ -921,14 +1032,15 @@ public:
                         TxDBName,
                         TxDBPragma,
                         TxDBInit,
-                        DatabaseCon::CheckpointerSetup{
-                            m_jobQueue.get(), &logs()});
+                        DatabaseCon::CheckpointerSetup{&logs()});
                     mTxnDB->getSession() << boost::str(
                         boost::format("PRAGMA cache_size=-%d;") %
                         kilobytes(config_->getValueFor(SizedItem::txnDBCache)));
-                    if (!setup.standAlone || setup.startUp == Config::LOAD ||
-                        setup.startUp == Config::LOAD_FILE ||
-                        setup.startUp == Config::REPLAY)
+                    bool const temporary = setup.standAlone &&
+                        setup.startUp != Config::LOAD &&
+                        setup.startUp != Config::LOAD_FILE &&
+                        setup.startUp != Config::REPLAY;
+                    if (!temporary)
                     {
                         // Check if AccountTransactions has primary key
                         std::string cid, name, type;
@@ -956,6 +1068,34 @@ public:
                             }
                         }
                     }
+
+                    // A temporary database has nothing to partition
+                    auto const& nodeDb =
+                        config_->section(ConfigSection::nodeDatabase());
+                    std::uint32_t partitionLedgers = 0;
+                    if (!temporary &&
+                        get<bool>(nodeDb, "partition_transactions", false))
+                    {
+                        // Online deletion then retires a partition about
+                        // every other rotation
+                        partitionLedgers =
+                            get<std::uint32_t>(nodeDb, "online_delete", 0) / 2;
+                        if (partitionLedgers == 0)
+                            JLOG(m_journal.warn())
+                                << "partition_transactions has no effect "
+                                   "without online_delete";
+                    }
+                    std::vector<std::string> pragmas;
+                    if (auto const common = setup.commonPragma())
+                        pragmas = *common;
+                    pragmas.insert(
+                        pragmas.end(), TxDBPragma.begin(), TxDBPragma.end());
+                    txPartitions_ = std::make_unique<TxPartitions>(
+                        *mTxnDB,
+                        temporary ? boost::filesystem::path() : setup.dataDir,
+                        std::move(pragmas),
+                        partitionLedgers,
+                        logs_->journal("TxPartitions"));
                 }
 
                 // ledger database
@@ -964,7 +1104,7 @@ public:
                     LgrDBName,
                     LgrDBPragma,
                     LgrDBInit,
-                    DatabaseCon::CheckpointerSetup{m_jobQueue.get(), &logs()});
+                    DatabaseCon::CheckpointerSetup{&logs()});
                 mLedgerDB->getSession() << boost::str(
                     boost::format("PRAGMA cache_size=-%d;") %
                     kilobytes(config_->getValueFor(SizedItem::lgrDBCache)));
@@ -978,6 +1118,7 @@ public:
 
             // wallet database
             setup.useGlobalPragma = false;
+            setup.readConnections = 0;
             mWalletDB = std::make_unique<DatabaseCon>(
                 setup,
                 WalletDBName,
@@ -1108,6 +1249,8 @@ public:
 
         mValidations.flush();
 
+        m_ledgerMaster->writeSnapshot();
+
         validatorSites_->stop();
 
         // TODO Store manifests in manifests.sqlite instead of wallet.db
@@ -1274,6 +1417,9 @@ public:
         // VFALCO TODO fix the dependency inversion using an observer,
         //         have listeners register for "onSweep ()" notification.
 
+        // Settle the caches' targets before they sweep to them
+        memoryBudget_.rebalance();
+
         nodeFamily_.sweep();
         if (shardFamily_)
             shardFamily_->sweep();
@@ -1324,6 +1470,12 @@ private:
     bool
     loadOldLedger(std::string const& ledgerID, bool replay, bool isFilename);
 
+    bool
+    replayLedgers(std::uint32_t count);
+
+    bool
+    compactNodeStore(std::uint32_t count);
+
     void
     setMaxDisallowedLedger();
 };
@@ -1381,38 +1533,72 @@ ApplicationImp::setup()
                                   "system configuration.";
     }
 
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+    JLOG(m_journal.info()) << "Network I/O uses io_uring";
+#endif
+
     // Optionally turn off logging to console.
     logs_->silent(config_->silent());
 
+    if (config_->NODE_SIZE_AUTO)
+    {
+        auto const& host = config_->HOST_RESOURCES;
+        char const* const sizes[] = {
+            "tiny", "small", "medium", "large", "huge"};
+
+        std::string disk = "not measured";
+        if (host.readLatency)
+            disk = std::to_string(host.readLatency->count()) + "us, " +
+                std::to_string(static_cast<int>(host.readIops)) + " IOPS";
+
+        JLOG(m_journal.info())
+            << "node_size auto: " << host.cores << " cores, "
+            << (host.memory >> 20) << "MB of memory, node store reads "
+            << disk << "; chose " << sizes[config_->NODE_SIZE] << ", "
+            << config_->WORKERS << " workers, "
+            << config_->NODESTORE_READ_THREADS << " read threads, path search "
+            << config_->PATH_SEARCH << " up to " << config_->PATH_SEARCH_MAX;
+    }
+
     m_jobQueue->setThreadCount(
         config_->WORKERS, config_->standalone() && !config_->reporting());
 
     if (!config_->standalone())
         timeKeeper_->run(config_->SNTP_SERVERS);
 
-    if (!initRDBMS() || !initNodeStore())
-        return false;
+    Pathfinder::initPathTable();
 
-    if (shardStore_)
-    {
-        shardFamily_ =
-            std::make_unique<ShardFamily>(*this, *m_collectorManager);
+    // The databases, the node store and the validator configuration are
+    // independent and mostly wait on disk, so they are brought up in
+    // parallel. Loading the ledger needs the databases and the node store.
+    StartupTasks startup(workerPool_, m_journal);
 
-        if (!shardStore_->init())
-            return false;
-    }
+    startup.add("databases", {}, [this]() { return initRDBMS(); });
+
+    startup.add("node_store", {}, [this]() { return initNodeStore(); });
 
-    if (!peerReservations_->load(getWalletDB()))
+    std::vector<std::string> ledgerAfter{"databases", "node_store"};
+    if (shardStore_)
     {
-        JLOG(m_journal.fatal()) << "Cannot find peer reservations!";
-        return false;
+        startup.add("shards", {"node_store"}, [this]() {
+            shardFamily_ =
+                std::make_unique<ShardFamily>(*this, *m_collectorManager);
+            return shardStore_->init();
+        });
+        ledgerAfter.push_back("shards");
     }
 
-    if (validatorKeys_.publicKey.size())
-        setMaxDisallowedLedger();
+    startup.add("peer_reservations", {"databases"}, [this]() {
+        if (!peerReservations_->load(getWalletDB()))
+        {
+            JLOG(m_journal.fatal()) << "Cannot find peer reservations!";
+            return false;
+        }
+        return true;
+    });
 
     // Configure the amendments the server supports
-    {
+    startup.add("amendments", {"databases"}, [this]() {
         auto const& sa = detail::supportedAmendments();
         std::vector<std::string> saHashes;
         saHashes.reserve(sa.size());
@@ -1435,13 +1621,23 @@ ApplicationImp::setup()
             enabledAmendments,
             config_->section(SECTION_VETO_AMENDMENTS),
             logs_->journal("Amendments"));
-    }
+        return true;
+    });
+    ledgerAfter.push_back("amendments");
 
-    Pathfinder::initPathTable();
+    startup.add("ledger", ledgerAfter, [this]() {
+        if (validatorKeys_.publicKey.size())
+            setMaxDisallowedLedger();
+
+        if (config_->reporting())
+            return true;
+
+        auto const startUp = config_->START_UP;
+
+        // Warm the tree node cache before the ledger is loaded or acquired
+        if (startUp != Config::FRESH)
+            m_ledgerMaster->loadSnapshot();
 
-    auto const startUp = config_->START_UP;
-    if (!config_->reporting())
-    {
         if (startUp == Config::FRESH)
         {
             JLOG(m_journal.info()) << "Starting new Ledger";
@@ -1477,50 +1673,49 @@ ApplicationImp::setup()
         {
             startGenesisLedger();
         }
-    }
 
-    if (!config().reporting())
         m_orderBookDB.setup(getLedgerMaster().getCurrentLedger());
+        m_ledgerMaster->fillHashIndex();
+        return true;
+    });
 
-    nodeIdentity_ = loadNodeIdentity(*this);
+    startup.add("validators", {"databases"}, [this]() {
+        nodeIdentity_ = loadNodeIdentity(*this);
 
-    if (!cluster_->load(config().section(SECTION_CLUSTER_NODES)))
-    {
-        JLOG(m_journal.fatal()) << "Invalid entry in cluster configuration.";
-        return false;
-    }
-
-    if (!config().reporting())
-    {
+        if (!cluster_->load(config().section(SECTION_CLUSTER_NODES)))
         {
-            if (validatorKeys_.configInvalid())
-                return false;
+            JLOG(m_journal.fatal())
+                << "Invalid entry in cluster configuration.";
+            return false;
+        }
 
-            if (!validatorManifests_->load(
-                    getWalletDB(),
-                    "ValidatorManifests",
-                    validatorKeys_.manifest,
-                    config()
-                        .section(SECTION_VALIDATOR_KEY_REVOCATION)
-                        .values()))
-            {
-                JLOG(m_journal.fatal())
-                    << "Invalid configured validator manifest.";
-                return false;
-            }
+        if (config().reporting())
+            return true;
 
-            publisherManifests_->load(getWalletDB(), "PublisherManifests");
+        if (validatorKeys_.configInvalid())
+            return false;
 
-            // Setup trusted validators
-            if (!validators_->load(
-                    validatorKeys_.publicKey,
-                    config().section(SECTION_VALIDATORS).values(),
-                    config().section(SECTION_VALIDATOR_LIST_KEYS).values()))
-            {
-                JLOG(m_journal.fatal())
-                    << "Invalid entry in validator configuration.";
-                return false;
-            }
+        if (!validatorManifests_->load(
+                getWalletDB(),
+                "ValidatorManifests",
+                validatorKeys_.manifest,
+                config().section(SECTION_VALIDATOR_KEY_REVOCATION).values()))
+        {
+            JLOG(m_journal.fatal()) << "Invalid configured validator manifest.";
+            return false;
+        }
+
+        publisherManifests_->load(getWalletDB(), "PublisherManifests");
+
+        // Setup trusted validators
+        if (!validators_->load(
+                validatorKeys_.publicKey,
+                config().section(SECTION_VALIDATORS).values(),
+                config().section(SECTION_VALIDATOR_LIST_KEYS).values()))
+        {
+            JLOG(m_journal.fatal())
+                << "Invalid entry in validator configuration.";
+            return false;
         }
 
         if (!validatorSites_->load(
@@ -1530,7 +1725,23 @@ ApplicationImp::setup()
                 << "Invalid entry in [" << SECTION_VALIDATOR_LIST_SITES << "]";
             return false;
         }
-    }
+        return true;
+    });
+
+    bool const started = startup.run();
+    startupTimes_ = startup.durations();
+    startupTimes_.emplace_back("total", startup.elapsed());
+    if (!started)
+        return false;
+
+    // Per item estimates, counting the hashes, keys and pointers held
+    memoryBudget_.add("tree_nodes", *nodeFamily_.getTreeNodeCache(0), 512);
+    memoryBudget_.add("transactions", m_txMaster.getCache(), 2048);
+    memoryBudget_.add("temp_nodes", m_tempNodeCache, 512);
+    memoryBudget_.add("accepted_ledgers", m_acceptedLedgerCache, 262144);
+    if (auto const budget = memoryBudget_.budget())
+        JLOG(m_journal.info()) << "Memory budget " << budget << " bytes";
+
     //----------------------------------------------------------------------
     //
     // Server
@@ -1564,6 +1775,22 @@ ApplicationImp::setup()
             return false;
     }
 
+    if (config_->replayRange != 0)
+    {
+        // Nothing is left to do once the replayed ledgers are checked
+        if (!replayLedgers(config_->replayRange))
+            return false;
+        signalStop();
+    }
+
+    if (config_->compactRange != 0)
+    {
+        // The compacted store is not used until the operator switches to it
+        if (!compactNodeStore(config_->compactRange))
+            return false;
+        signalStop();
+    }
+
     // start first consensus round
     if (!config_->reporting() &&
         !m_networkOPs->beginConsensus(
@@ -2190,6 +2417,113 @@ ApplicationImp::loadOldLedger(
     return true;
 }
 
+/** Replay consecutive ledgers from the node store and verify them.
+
+    Starts with the ledger loaded for replay at startup. Each ledger is
+    rebuilt from its stored parent by applying its transactions again, and
+    the result must hash the same as the stored ledger. Only local data is
+    used. Reports the rate ledgers and transactions were applied at and the
+    apply time of each transaction type, and fails if any ledger differs.
+*/
+bool
+ApplicationImp::replayLedgers(std::uint32_t count)
+{
+    using namespace std::chrono;
+    using clock = steady_clock;
+
+    auto replayData = m_ledgerMaster->releaseReplay();
+    if (!replayData)
+    {
+        JLOG(m_journal.fatal()) << "No ledger was loaded to replay";
+        return false;
+    }
+
+    struct Cost
+    {
+        std::size_t count = 0;
+        clock::duration elapsed{};
+    };
+    std::map<TxType, Cost> costs;
+    auto const onApplied = [&costs](STTx const& tx, clock::duration d) {
+        auto& cost = costs[tx.getTxnType()];
+        ++cost.count;
+        cost.elapsed += d;
+    };
+
+    std::uint32_t ledgers = 0;
+    std::uint32_t mismatched = 0;
+    std::size_t txs = 0;
+    clock::duration elapsed{};
+
+    try
+    {
+        while (true)
+        {
+            auto const& info = replayData->replay()->info();
+
+            auto const start = clock::now();
+            auto const built = buildLedger(
+                *replayData, tapREPLAY, *this, m_journal, onApplied);
+            elapsed += clock::now() - start;
+
+            ++ledgers;
+            txs += replayData->orderedTxns().size();
+            if (built->info().hash != info.hash)
+            {
+                ++mismatched;
+                JLOG(m_journal.error())
+                    << "Replayed ledger " << info.seq << " is "
+                    << built->info().hash << " but should be " << info.hash
+                    << " (state " << built->info().accountHash << " vs "
+                    << info.accountHash << ", transactions "
+                    << built->info().txHash << " vs " << info.txHash << ")";
+            }
+
+            if (ledgers == count || isShutdown())
+                break;
+
+            auto next = loadByIndex(info.seq + 1, *this, false);
+            if (!next || next->info().parentHash != info.hash)
+            {
+                JLOG(m_journal.warn()) << "Ledger " << info.seq + 1
+                                       << " is not in the local databases";
+                break;
+            }
+            replayData = std::make_unique<LedgerReplay>(
+                replayData->replay(), std::move(next));
+        }
+    }
+    catch (SHAMapMissingNode const& mn)
+    {
+        JLOG(m_journal.fatal()) << "While replaying ledgers: " << mn.what();
+        return false;
+    }
+
+    auto const seconds = duration_cast<duration<double>>(elapsed).count();
+    JLOG(m_journal.info())
+        << "Replayed " << ledgers << " ledgers and " << txs
+        << " transactions in " << seconds << "s: "
+        << (seconds > 0 ? ledgers / seconds : 0) << " ledgers/s, "
+        << (seconds > 0 ? txs / seconds : 0) << " tx/s";
+    for (auto const& [type, cost] : costs)
+    {
+        auto const format = TxFormats::getInstance().findByType(type);
+        JLOG(m_journal.info())
+            << "  " << (format ? format->getName() : std::to_string(type))
+            << ": " << cost.count << " applied, "
+            << duration_cast<microseconds>(cost.elapsed).count() / cost.count
+            << "us each";
+    }
+
+    if (mismatched != 0)
+    {
+        JLOG(m_journal.fatal())
+            << mismatched << " of " << ledgers << " replayed ledgers differ";
+        return false;
+    }
+    return true;
+}
+
 bool
 ApplicationImp::serverOkay(std::string& reason)
 {
@@ -2265,6 +2599,110 @@ ApplicationImp::nodeToShards()
     return true;
 }
 
+bool
+ApplicationImp::compactNodeStore(std::uint32_t count)
+{
+    using namespace std::chrono;
+    auto const start = steady_clock::now();
+
+    boost::optional<LedgerIndex> maxSeq;
+    {
+        auto db = getLedgerDB().checkoutDb();
+        *db << "SELECT MAX(LedgerSeq) FROM Ledgers;", soci::into(maxSeq);
+    }
+    if (!maxSeq)
+    {
+        JLOG(m_journal.fatal()) << "No ledgers to keep in the ledger database";
+        return false;
+    }
+    auto const minSeq = *maxSeq >= count ? *maxSeq - count + 1 : 1;
+
+    std::vector<uint256> ledgers;
+    for (auto const& [seq, hashes] : getHashesByIndex(minSeq, *maxSeq, *this))
+        ledgers.push_back(hashes.first);
+
+    JLOG(m_journal.warn()) << "Compacting node store '"
+                           << m_nodeStore->getName() << "', keeping "
+                           << ledgers.size() << " ledgers " << minSeq
+                           << " through " << *maxSeq;
+
+    NodeStoreCompactor compactor(*m_nodeStore, logs_->journal("NodeObject"));
+    try
+    {
+        if (compactor.mark(ledgers, workerPool_) == 0)
+        {
+            JLOG(m_journal.fatal()) << "None of the ledgers to keep are in "
+                                    << "the node store";
+            return false;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(m_journal.fatal()) << "While marking live nodes: " << e.what();
+        return false;
+    }
+
+    NodeStore::DummyScheduler scheduler;
+    std::unique_ptr<NodeStore::Backend> dest;
+    auto const& section =
+        config_->section(ConfigSection::compactNodeDatabase());
+    if (!section.empty())
+    {
+        dest = NodeStore::Manager::instance().make_Backend(
+            section,
+            megabytes(
+                config_->getValueFor(SizedItem::burstSize, boost::none)),
+            scheduler,
+            logs_->journal("NodeObject"));
+        dest->open();
+    }
+    else
+    {
+        JLOG(m_journal.warn())
+            << "No [" << ConfigSection::compactNodeDatabase()
+            << "] section, only counting live objects";
+    }
+
+    auto const sweep = compactor.sweep(dest.get());
+    auto const dead = sweep.total.objects - sweep.live.objects;
+    auto const percent = [](std::uint64_t part, std::uint64_t whole) {
+        return whole ? 100.0 * part / whole : 0.0;
+    };
+
+    JLOG(m_journal.warn())
+        << "Node store holds " << sweep.total.objects << " objects, "
+        << sweep.total.bytes << " bytes: " << sweep.live.objects << " live ("
+        << percent(sweep.live.objects, sweep.total.objects) << "%, "
+        << sweep.live.bytes << " bytes), " << dead << " dead ("
+        << percent(dead, sweep.total.objects) << "%, "
+        << (sweep.total.bytes - sweep.live.bytes) << " bytes)";
+    if (compactor.missing() != 0)
+        JLOG(m_journal.warn())
+            << compactor.missing() << " nodes of the kept ledgers were "
+            << "already missing";
+
+    if (dest)
+    {
+        dest->close();
+        if (sweep.failed != 0)
+        {
+            JLOG(m_journal.fatal())
+                << "Unable to write " << sweep.failed << " live objects to '"
+                << dest->getName() << "'";
+            return false;
+        }
+
+        auto const elapsed =
+            duration_cast<seconds>(steady_clock::now() - start);
+        JLOG(m_journal.warn())
+            << "Wrote " << sweep.live.objects << " live objects to '"
+            << dest->getName() << "' in " << elapsed.count()
+            << " seconds. Point [" << ConfigSection::nodeDatabase()
+            << "] at it to use it.";
+    }
+    return true;
+}
+
 void
 ApplicationImp::setMaxDisallowedLedger()
 {
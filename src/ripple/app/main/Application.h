@@ -30,6 +30,9 @@
 #include <boost/asio.hpp>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -45,10 +48,13 @@ class DatabaseShard;
 }  // namespace NodeStore
 namespace perf {
 class PerfLog;
+class Tracer;
 }
 namespace RPC {
+class ResponseCache;
 class ShardArchiveHandler;
-}
+class SigningQueue;
+}  // namespace RPC
 
 // VFALCO TODO Fix forward declares required for header dependency loops
 class AmendmentTable;
@@ -56,16 +62,19 @@ class CachedSLEs;
 class CollectorManager;
 class Family;
 class HashRouter;
+class SignatureCache;
 class Logs;
 class LoadFeeTrack;
 class JobQueue;
 class InboundLedgers;
 class InboundTransactions;
+class IssuerBalances;
 class AcceptedLedger;
 class Ledger;
 class LedgerMaster;
 class LedgerReplayer;
 class LoadManager;
+class MemoryBudget;
 class ManifestCache;
 class ValidatorKeys;
 class NetworkOPs;
@@ -81,10 +90,12 @@ class AccountIDCache;
 class STLedgerEntry;
 class TimeKeeper;
 class TransactionMaster;
+class TxPartitions;
 class TxQ;
 
 class ValidatorList;
 class ValidatorSite;
+class WorkerPool;
 class Cluster;
 
 class DatabaseCon;
@@ -159,14 +170,20 @@ public:
     timeKeeper() = 0;
     virtual JobQueue&
     getJobQueue() = 0;
+    virtual WorkerPool&
+    getWorkerPool() = 0;
     virtual NodeCache&
     getTempNodeCache() = 0;
+    virtual MemoryBudget&
+    getMemoryBudget() = 0;
     virtual CachedSLEs&
     cachedSLEs() = 0;
     virtual AmendmentTable&
     getAmendmentTable() = 0;
     virtual HashRouter&
     getHashRouter() = 0;
+    virtual SignatureCache&
+    getSignatureCache() = 0;
     virtual LoadFeeTrack&
     getFeeTrack() = 0;
     virtual LoadManager&
@@ -211,10 +228,14 @@ public:
     getOPs() = 0;
     virtual OrderBookDB&
     getOrderBookDB() = 0;
+    virtual IssuerBalances&
+    getIssuerBalances() = 0;
     virtual TransactionMaster&
     getMasterTransaction() = 0;
     virtual perf::PerfLog&
     getPerfLog() = 0;
+    virtual perf::Tracer&
+    getTracer() = 0;
 
     virtual std::pair<PublicKey, SecretKey> const&
     nodeIdentity() = 0;
@@ -226,6 +247,10 @@ public:
     getResourceManager() = 0;
     virtual PathRequests&
     getPathRequests() = 0;
+    virtual RPC::ResponseCache&
+    getResponseCache() = 0;
+    virtual RPC::SigningQueue&
+    getSigningQueue() = 0;
     virtual SHAMapStore&
     getSHAMapStore() = 0;
     virtual PendingSaves&
@@ -238,12 +263,19 @@ public:
     openLedger() const = 0;
     virtual DatabaseCon&
     getTxnDB() = 0;
+    virtual TxPartitions&
+    getTxPartitions() = 0;
     virtual DatabaseCon&
     getLedgerDB() = 0;
 
     virtual std::chrono::milliseconds
     getIOLatency() = 0;
 
+    /** The time taken by each step of startup, ending with the total */
+    virtual std::vector<
+        std::pair<std::string, std::chrono::milliseconds>> const&
+    getStartupTimes() const = 0;
+
     virtual ReportingETL&
     getReportingETL() = 0;
 
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/app/main/BasicApp.h>
+#include <ripple/basics/Numa.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 
 BasicApp::BasicApp(std::size_t numberOfThreads)
@@ -30,6 +31,7 @@ BasicApp::BasicApp(std::size_t numberOfThreads)
         threads_.emplace_back([this, numberOfThreads]() {
             beast::setCurrentThreadName(
                 "io svc #" + std::to_string(numberOfThreads));
+            ripple::numa::pinCurrentThread(numberOfThreads);
             this->io_service_.run();
         });
     }
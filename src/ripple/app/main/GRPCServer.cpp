@@ -17,9 +17,11 @@
 */
 //==============================================================================
 
+#include <ripple/app/main/CollectorManager.h>
 #include <ripple/app/main/GRPCServer.h>
 #include <ripple/app/reporting/P2pProxy.h>
 #include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/beast/core/LexicalCast.h>
 #include <ripple/resource/Fees.h>
 
 #include <beast/net/IPAddressConversion.h>
@@ -66,7 +68,8 @@ GRPCServerImpl::CallData<Request, Response>::CallData(
     Forward<Request, Response> forward,
     RPC::Condition requiredCondition,
     Resource::Charge loadType,
-    std::vector<boost::asio::ip::address> const& secureGatewayIPs)
+    std::vector<boost::asio::ip::address> const& secureGatewayIPs,
+    beast::insight::Event latency)
     : service_(service)
     , cq_(cq)
     , finished_(false)
@@ -78,6 +81,7 @@ GRPCServerImpl::CallData<Request, Response>::CallData(
     , requiredCondition_(std::move(requiredCondition))
     , loadType_(std::move(loadType))
     , secureGatewayIPs_(secureGatewayIPs)
+    , latency_(std::move(latency))
 {
     // Bind a listener. When a request is received, "this" will be returned
     // from CompletionQueue::Next
@@ -97,7 +101,8 @@ GRPCServerImpl::CallData<Request, Response>::clone()
         forward_,
         requiredCondition_,
         loadType_,
-        secureGatewayIPs_);
+        secureGatewayIPs_,
+        latency_);
 }
 
 template <class Request, class Response>
@@ -107,6 +112,8 @@ GRPCServerImpl::CallData<Request, Response>::process()
     // sanity check
     BOOST_ASSERT(!finished_);
 
+    start_ = std::chrono::steady_clock::now();
+
     std::shared_ptr<CallData<Request, Response>> thisShared =
         this->shared_from_this();
 
@@ -139,6 +146,16 @@ template <class Request, class Response>
 void
 GRPCServerImpl::CallData<Request, Response>::process(
     std::shared_ptr<JobQueue::Coro> coro)
+{
+    respond(coro);
+    latency_.notify(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_));
+}
+
+template <class Request, class Response>
+void
+GRPCServerImpl::CallData<Request, Response>::respond(
+    std::shared_ptr<JobQueue::Coro> coro)
 {
     try
     {
@@ -454,6 +471,23 @@ GRPCServerImpl::GRPCServerImpl(Application& app)
             Throw<std::exception>();
         }
 
+        if (auto const [n, found] = section.find("completion_queues"); found)
+        {
+            try
+            {
+                completionQueueCount_ =
+                    beast::lexicalCastThrow<std::size_t>(n);
+                if (completionQueueCount_ == 0)
+                    Throw<std::exception>();
+            }
+            catch (std::exception const&)
+            {
+                JLOG(journal_.error())
+                    << "Invalid completion_queues '" << n << "' for grpc";
+                Throw<std::exception>();
+            }
+        }
+
         std::pair<std::string, bool> secureGateway =
             section.find("secure_gateway");
         if (secureGateway.second)
@@ -498,25 +532,29 @@ GRPCServerImpl::shutdown()
     // requests being processed are completed. CallData objects in the midst of
     // processing requests need to actually send data back to the client, via
     // responder_.Finish(...) or responder_.FinishWithError(...), for this call
-    // to unblock. Each cancelled listener is returned via cq_.Next(...) with ok
+    // to unblock. Each cancelled listener is returned via cq.Next(...) with ok
     // set to false
     server_->Shutdown();
     JLOG(journal_.debug()) << "Server has been shutdown";
 
-    // Always shutdown the completion queue after the server. This call allows
-    // cq_.Next() to return false, once all events posted to the completion
-    // queue have been processed. See handleRpcs() for more details.
-    cq_->Shutdown();
-    JLOG(journal_.debug()) << "Completion Queue has been shutdown";
+    // Always shutdown the completion queues after the server. This call
+    // allows cq.Next() to return false, once all events posted to the
+    // completion queue have been processed. See handleRpcs() for more details.
+    for (auto& cq : cqs_)
+        cq->Shutdown();
+    JLOG(journal_.debug()) << "Completion Queues have been shutdown";
 }
 
 void
-GRPCServerImpl::handleRpcs()
+GRPCServerImpl::handleRpcs(std::size_t index)
 {
+    auto& cq = *cqs_[index];
+
     // This collection should really be an unordered_set. However, to delete
-    // from the unordered_set, we need a shared_ptr, but cq_.Next() (see below
+    // from the unordered_set, we need a shared_ptr, but cq.Next() (see below
     // while loop) sets the tag to a raw pointer.
-    std::vector<std::shared_ptr<Processor>> requests = setupListeners();
+    std::vector<std::shared_ptr<Processor>> requests =
+        std::move(listeners_[index]);
 
     auto erase = [&requests](Processor* ptr) {
         auto it = std::find_if(
@@ -536,17 +574,17 @@ GRPCServerImpl::handleRpcs()
     // event is uniquely identified by its tag, which in this case is the
     // memory address of a CallData instance.
     // The return value of Next should always be checked. This return value
-    // tells us whether there is any kind of event or cq_ is shutting down.
-    // When cq_.Next(...) returns false, all work has been completed and the
+    // tells us whether there is any kind of event or cq is shutting down.
+    // When cq.Next(...) returns false, all work has been completed and the
     // loop can exit. When the server is shutdown, each CallData object that is
     // listening for a request is forceably cancelled, and is returned by
-    // cq_->Next() with ok set to false. Then, each CallData object processing
+    // cq.Next() with ok set to false. Then, each CallData object processing
     // a request must complete (by sending data to the client), each of which
-    // will be returned from cq_->Next() with ok set to true. After all
+    // will be returned from cq.Next() with ok set to true. After all
     // cancelled listeners and all CallData objects processing requests are
-    // returned via cq_->Next(), cq_->Next() will return false, causing the
+    // returned via cq.Next(), cq.Next() will return false, causing the
     // loop to exit.
-    while (cq_->Next(&tag, &ok))
+    while (cq.Next(&tag, &ok))
     {
         auto ptr = static_cast<Processor*>(tag);
         JLOG(journal_.trace()) << "Processing CallData object."
@@ -581,8 +619,24 @@ GRPCServerImpl::handleRpcs()
 }
 
 // create a CallData instance for each RPC
+beast::insight::Event
+GRPCServerImpl::latencyEvent(std::string const& name)
+{
+    auto it = latency_.find(name);
+    if (it == latency_.end())
+    {
+        it = latency_
+                 .emplace(
+                     name,
+                     app_.getCollectorManager().group("grpc")->make_event(
+                         name))
+                 .first;
+    }
+    return it->second;
+}
+
 std::vector<std::shared_ptr<Processor>>
-GRPCServerImpl::setupListeners()
+GRPCServerImpl::setupListeners(grpc::ServerCompletionQueue& cq)
 {
     std::vector<std::shared_ptr<Processor>> requests;
 
@@ -597,7 +651,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetFee,
@@ -605,7 +659,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::GetFee,
             RPC::NEEDS_CURRENT_LEDGER,
             Resource::feeReferenceRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetFee")));
     }
     {
         using cd = CallData<
@@ -614,7 +669,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetAccountInfo,
@@ -622,7 +677,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::GetAccountInfo,
             RPC::NO_CONDITION,
             Resource::feeReferenceRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetAccountInfo")));
     }
     {
         using cd = CallData<
@@ -631,7 +687,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetTransaction,
@@ -639,7 +695,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::GetTransaction,
             RPC::NEEDS_NETWORK_CONNECTION,
             Resource::feeReferenceRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetTransaction")));
     }
     {
         using cd = CallData<
@@ -648,7 +705,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestSubmitTransaction,
@@ -656,7 +713,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::SubmitTransaction,
             RPC::NEEDS_CURRENT_LEDGER,
             Resource::feeMediumBurdenRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("SubmitTransaction")));
     }
 
     {
@@ -666,7 +724,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetAccountTransactionHistory,
@@ -675,7 +733,8 @@ GRPCServerImpl::setupListeners()
                 GetAccountTransactionHistory,
             RPC::NO_CONDITION,
             Resource::feeMediumBurdenRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetAccountTransactionHistory")));
     }
 
     {
@@ -685,7 +744,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetLedger,
@@ -693,7 +752,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::GetLedger,
             RPC::NO_CONDITION,
             Resource::feeMediumBurdenRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetLedger")));
     }
     {
         using cd = CallData<
@@ -702,7 +762,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetLedgerData,
@@ -710,7 +770,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::GetLedgerData,
             RPC::NO_CONDITION,
             Resource::feeMediumBurdenRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetLedgerData")));
     }
     {
         using cd = CallData<
@@ -719,7 +780,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetLedgerDiff,
@@ -727,7 +788,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::GetLedgerDiff,
             RPC::NO_CONDITION,
             Resource::feeMediumBurdenRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetLedgerDiff")));
     }
     {
         using cd = CallData<
@@ -736,7 +798,7 @@ GRPCServerImpl::setupListeners()
 
         addToRequests(std::make_shared<cd>(
             service_,
-            *cq_,
+            cq,
             app_,
             &org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService::
                 RequestGetLedgerEntry,
@@ -744,7 +806,8 @@ GRPCServerImpl::setupListeners()
             &org::xrpl::rpc::v1::XRPLedgerAPIService::Stub::GetLedgerEntry,
             RPC::NO_CONDITION,
             Resource::feeMediumBurdenRPC,
-            secureGatewayIPs_));
+            secureGatewayIPs_,
+            latencyEvent("GetLedgerEntry")));
     }
     return requests;
 };
@@ -764,12 +827,18 @@ GRPCServerImpl::start()
     // Register "service_" as the instance through which we'll communicate with
     // clients. In this case it corresponds to an *asynchronous* service.
     builder.RegisterService(&service_);
-    // Get hold of the completion queue used for the asynchronous communication
-    // with the gRPC runtime.
-    cq_ = builder.AddCompletionQueue();
+    // Get hold of the completion queues used for the asynchronous
+    // communication with the gRPC runtime.
+    for (std::size_t i = 0; i < completionQueueCount_; ++i)
+        cqs_.push_back(builder.AddCompletionQueue());
     // Finally assemble the server.
     server_ = builder.BuildAndStart();
 
+    // Every queue listens for every RPC, so any idle thread can take the
+    // next request
+    for (auto& cq : cqs_)
+        listeners_.push_back(setupListeners(*cq));
+
     return true;
 }
 
@@ -779,12 +848,15 @@ GRPCServer::onStart()
     // Start the server and setup listeners
     if (running_ = impl_.start(); running_)
     {
-        thread_ = std::thread([this]() {
-            beast::setCurrentThreadName("rippled : GRPCServer");
-            // Start the event loop and begin handling requests
-            beast::setCurrentThreadName("rippled: grpc");
-            this->impl_.handleRpcs();
-        });
+        for (std::size_t i = 0; i < impl_.completionQueueCount(); ++i)
+        {
+            threads_.emplace_back([this, i]() {
+                // Start the event loop and begin handling requests
+                beast::setCurrentThreadName(
+                    "rippled: grpc #" + std::to_string(i));
+                this->impl_.handleRpcs(i);
+            });
+        }
     }
 }
 
@@ -794,7 +866,9 @@ GRPCServer::onStop()
     if (running_)
     {
         impl_.shutdown();
-        thread_.join();
+        for (auto& t : threads_)
+            t.join();
+        threads_.clear();
         running_ = false;
     }
 
@@ -21,6 +21,7 @@
 #define RIPPLE_CORE_GRPCSERVER_H_INCLUDED
 
 #include <ripple/app/main/Application.h>
+#include <ripple/beast/insight/Event.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/net/InfoSub.h>
@@ -35,6 +36,10 @@
 
 #include "org/xrpl/rpc/v1/xrp_ledger.grpc.pb.h"
 #include <grpcpp/grpcpp.h>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 
@@ -72,10 +77,17 @@ class GRPCServerImpl final
 {
 private:
     // CompletionQueue returns events that have occurred, or events that have
-    // been cancelled
-    std::unique_ptr<grpc::ServerCompletionQueue> cq_;
+    // been cancelled. Each queue is polled by its own thread.
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs_;
 
-    std::vector<std::shared_ptr<Processor>> requests_;
+    // The listeners bound to each completion queue, until its thread starts
+    std::vector<std::vector<std::shared_ptr<Processor>>> listeners_;
+
+    // Number of completion queues, from [port_grpc] completion_queues
+    std::size_t completionQueueCount_ = 1;
+
+    // Time from receiving each kind of request to queueing the response
+    std::map<std::string, beast::insight::Event> latency_;
 
     // The gRPC service defined by the .proto files
     org::xrpl::rpc::v1::XRPLedgerAPIService::AsyncService service_;
@@ -134,15 +146,26 @@ public:
     bool
     start();
 
-    // the main event loop
+    std::size_t
+    completionQueueCount() const
+    {
+        return cqs_.size();
+    }
+
+    // the event loop for one completion queue
     void
-    handleRpcs();
+    handleRpcs(std::size_t index);
 
-    // Create a CallData object for each RPC. Return created objects in vector
+    // Create a CallData object for each RPC, listening on the given
+    // completion queue. Return created objects in vector
     std::vector<std::shared_ptr<Processor>>
-    setupListeners();
+    setupListeners(grpc::ServerCompletionQueue& cq);
 
 private:
+    // The latency event for an RPC, created the first time it's named
+    beast::insight::Event
+    latencyEvent(std::string const& name);
+
     // Class encompasing the state and logic needed to serve a request.
     template <class Request, class Response>
     class CallData
@@ -194,6 +217,12 @@ private:
 
         std::vector<boost::asio::ip::address> const& secureGatewayIPs_;
 
+        // Reports the latency of each request
+        beast::insight::Event latency_;
+
+        // When the request was received
+        std::chrono::steady_clock::time_point start_;
+
     public:
         virtual ~CallData() = default;
 
@@ -209,7 +238,8 @@ private:
             Forward<Request, Response> forward,
             RPC::Condition requiredCondition,
             Resource::Charge loadType,
-            std::vector<boost::asio::ip::address> const& secureGatewayIPs);
+            std::vector<boost::asio::ip::address> const& secureGatewayIPs,
+            beast::insight::Event latency);
 
         CallData(const CallData&) = delete;
 
@@ -226,10 +256,15 @@ private:
         clone() override;
 
     private:
-        // process the request. Called inside the coroutine passed to JobQueue
+        // process the request and record its latency. Called inside the
+        // coroutine passed to JobQueue
         void
         process(std::shared_ptr<JobQueue::Coro> coro);
 
+        // process the request and send the response
+        void
+        respond(std::shared_ptr<JobQueue::Coro> coro);
+
         // return load type of this RPC
         Resource::Charge
         getLoadType();
@@ -317,7 +352,7 @@ public:
 
 private:
     GRPCServerImpl impl_;
-    std::thread thread_;
+    std::vector<std::thread> threads_;
     bool running_ = false;
 };
 }  // namespace ripple
@@ -21,9 +21,13 @@
 #include <ripple/app/main/LoadManager.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/basics/StackSampler.h>
 #include <ripple/basics/UptimeClock.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/basics/contract.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/json/to_string.h>
+#include <fstream>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -37,6 +41,13 @@ LoadManager::LoadManager(
     : Stoppable("LoadManager", parent)
     , app_(app)
     , journal_(journal)
+    , stallProfile_(setup_StallProfile(
+          app.config().section("stall_profile"),
+          app.config().CONFIG_DIR))
+    , profiling_(false)
+    , minWorkers_(static_cast<int>(app.config().WORKERS))
+    , maxWorkers_(std::min(2 * minWorkers_, 32))
+    , workers_(minWorkers_)
     , deadLock_()
     , armed_(false)
     , stop_(false)
@@ -98,11 +109,65 @@ LoadManager::onStop()
         }
         thread_.join();
     }
+    if (profiler_.joinable())
+        profiler_.join();
     stopped();
 }
 
 //------------------------------------------------------------------------------
 
+void
+LoadManager::profileStall(std::string const& reason)
+{
+    using namespace std::chrono;
+
+    if (stallProfile_.directory.empty() || profiling_.load())
+        return;
+
+    auto const now = steady_clock::now();
+    if (lastProfile_ != steady_clock::time_point{} &&
+        now - lastProfile_ < stallProfile_.minInterval)
+        return;
+    lastProfile_ = now;
+
+    if (profiler_.joinable())
+        profiler_.join();
+    profiling_ = true;
+    profiler_ = std::thread([this, reason]() {
+        beast::setCurrentThreadName("StallProfiler");
+
+        auto const when = floor<seconds>(system_clock::now());
+        auto const path = stallProfile_.directory /
+            ("stall-" + date::format("%Y%m%d-%H%M%S", when) + ".txt");
+
+        try
+        {
+            boost::filesystem::create_directories(stallProfile_.directory);
+            std::ofstream out(path.string());
+            if (!out)
+                Throw<std::runtime_error>("unable to open " + path.string());
+
+            out << reason << " at " << to_string(when) << "\n\n";
+            out << perf::sampleStacks(
+                stallProfile_.samples, stallProfile_.interval);
+            // Written last, since it waits on the job queue's lock
+            out.flush();
+            out << "Job queue:\n"
+                << Json::pretty(app_.getJobQueue().getJson(0)) << "\n";
+
+            JLOG(journal_.warn()) << "Wrote stack samples to " << path;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(journal_.error())
+                << "Unable to write stack samples: " << e.what();
+        }
+        profiling_ = false;
+    });
+}
+
+//------------------------------------------------------------------------------
+
 void
 LoadManager::run()
 {
@@ -143,6 +208,10 @@ LoadManager::run()
                         JLOG(journal_.warn())
                             << "Server stalled for "
                             << timeSpentDeadlocked.count() << " seconds.";
+                        profileStall(
+                            "Server stalled for " +
+                            std::to_string(timeSpentDeadlocked.count()) +
+                            " seconds");
                     }
                     else
                     {
@@ -175,10 +244,15 @@ LoadManager::run()
             }
         }
 
+        bool const overloaded = app_.getJobQueue().isOverloaded();
+        if (app_.config().WORKERS_AUTO && !app_.config().standalone())
+            tuneWorkers(overloaded);
+
         bool change = false;
-        if (app_.getJobQueue().isOverloaded())
+        if (overloaded)
         {
             JLOG(journal_.info()) << app_.getJobQueue().getJson(0);
+            profileStall("Job queue overloaded");
             change = app_.getFeeTrack().raiseLocalFee();
         }
         else
@@ -210,8 +284,67 @@ LoadManager::run()
     stopped();
 }
 
+void
+LoadManager::tuneWorkers(bool overloaded)
+{
+    // Seconds of load looked at for each change
+    constexpr int window = 60;
+
+    if (overloaded)
+        ++overloadedSeconds_;
+    if (++tuneSeconds_ < window)
+        return;
+
+    auto const previous = workers_;
+    if (overloadedSeconds_ >= window / 2 && workers_ < maxWorkers_)
+        ++workers_;
+    else if (overloadedSeconds_ == 0 && workers_ > minWorkers_)
+        --workers_;
+    tuneSeconds_ = 0;
+    overloadedSeconds_ = 0;
+
+    if (workers_ != previous)
+    {
+        JLOG(journal_.info()) << "node_size auto: job queue "
+                              << (workers_ > previous ? "overloaded" : "idle")
+                              << ", now " << workers_ << " workers";
+        app_.getJobQueue().setThreadCount(workers_, false);
+    }
+}
+
 //------------------------------------------------------------------------------
 
+LoadManager::StallProfileSetup
+setup_StallProfile(
+    Section const& section,
+    boost::filesystem::path const& configDir)
+{
+    LoadManager::StallProfileSetup setup;
+    std::string directory;
+    set(directory, "directory", section);
+    if (!directory.empty())
+    {
+        setup.directory = boost::filesystem::path(directory);
+        if (setup.directory.is_relative())
+        {
+            setup.directory =
+                boost::filesystem::absolute(setup.directory, configDir);
+        }
+    }
+
+    set(setup.samples, "samples", section);
+    if (setup.samples < 1)
+        Throw<std::runtime_error>("stall_profile samples must be positive");
+
+    std::uint32_t ms;
+    if (get_if_exists(section, "interval", ms))
+        setup.interval = std::chrono::milliseconds(ms);
+    std::uint32_t seconds;
+    if (get_if_exists(section, "min_interval", seconds))
+        setup.minInterval = std::chrono::seconds(seconds);
+    return setup;
+}
+
 std::unique_ptr<LoadManager>
 make_LoadManager(Application& app, Stoppable& parent, beast::Journal journal)
 {
@@ -20,9 +20,14 @@
 #ifndef RIPPLE_APP_MAIN_LOADMANAGER_H_INCLUDED
 #define RIPPLE_APP_MAIN_LOADMANAGER_H_INCLUDED
 
+#include <ripple/basics/BasicConfig.h>
 #include <ripple/core/Stoppable.h>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 
 namespace ripple {
@@ -45,6 +50,23 @@ class LoadManager : public Stoppable
     LoadManager(Application& app, Stoppable& parent, beast::Journal journal);
 
 public:
+    /** Configuration from the [stall_profile] section of rippled.cfg.
+
+        When the server stalls or the job queue is overloaded, the stacks
+        of every thread are sampled and written, with the state of the job
+        queue, to a file in the directory. Nothing is written if the
+        directory is empty.
+    */
+    struct StallProfileSetup
+    {
+        boost::filesystem::path directory;
+        // Times every thread is sampled, and the time between samples
+        int samples = 5;
+        std::chrono::milliseconds interval{100};
+        // Least time between two profiles
+        std::chrono::seconds minInterval{600};
+    };
+
     LoadManager() = delete;
     LoadManager(LoadManager const&) = delete;
     LoadManager&
@@ -92,10 +114,34 @@ private:
     void
     run();
 
+    // Sample the stacks on another thread, unless a profile is being
+    // taken or was taken too recently
+    void
+    profileStall(std::string const& reason);
+
+    // Called every second with node_size=auto, to add JobQueue workers
+    // while the queue stays overloaded and remove them once it is not
+    void
+    tuneWorkers(bool overloaded);
+
 private:
     Application& app_;
     beast::Journal const journal_;
 
+    StallProfileSetup const stallProfile_;
+    std::thread profiler_;
+    std::atomic<bool> profiling_;
+    // Only used by the LoadManager thread
+    std::chrono::steady_clock::time_point lastProfile_;
+
+    // Workers chosen by node_size=auto, and the most tuning may add
+    int const minWorkers_;
+    int const maxWorkers_;
+    // Only used by the LoadManager thread
+    int workers_;
+    int tuneSeconds_ = 0;
+    int overloadedSeconds_ = 0;
+
     std::thread thread_;
     std::mutex mutex_;  // Guards deadLock_, armed_, and stop_.
 
@@ -111,6 +157,11 @@ private:
         beast::Journal journal);
 };
 
+LoadManager::StallProfileSetup
+setup_StallProfile(
+    Section const& section,
+    boost::filesystem::path const& configDir);
+
 std::unique_ptr<LoadManager>
 make_LoadManager(Application& app, Stoppable& parent, beast::Journal journal);
 
@@ -20,6 +20,8 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/DBInit.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/MemoryArena.h>
+#include <ripple/basics/Numa.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/contract.h>
 #include <ripple/beast/clock/basic_seconds_clock.h>
@@ -148,6 +150,7 @@ printHelp(const po::options_description& desc)
            "     gateway_balances [<ledger>] <issuer_account> [ <hotwallet> [ "
            "<hotwallet> ]]\n"
            "     get_counts\n"
+           "     get_trace [clear|start|stop]\n"
            "     json <method> <json>\n"
            "     ledger [<id>|current|closed|validated] [full]\n"
            "     ledger_accept\n"
@@ -356,6 +359,16 @@ run(int argc, char** argv)
         importText += "] configuration file section).";
     }
 
+    std::string compactText;
+    {
+        compactText += "Write the nodes of the given number of most recent ";
+        compactText += "ledgers into a new node database (specified in the [";
+        compactText += ConfigSection::compactNodeDatabase();
+        compactText += "] configuration file section), report how much of ";
+        compactText += "the current one is dead and exit. Requires ";
+        compactText += "--standalone.";
+    }
+
     // Set up option parsing.
     //
     po::options_description gen("General Options");
@@ -372,7 +385,10 @@ run(int argc, char** argv)
         "version", "Display the build version.");
 
     po::options_description data("Ledger/Data Options");
-    data.add_options()("import", importText.c_str())(
+    data.add_options()(
+        "compact",
+        po::value<std::uint32_t>(),
+        compactText.c_str())("import", importText.c_str())(
         "ledger",
         po::value<std::string>(),
         "Load the specified ledger and start from the value given.")(
@@ -383,6 +399,10 @@ run(int argc, char** argv)
         "net", "Get the initial ledger from the network.")(
         "nodetoshard", "Import node store into shards")(
         "replay", "Replay a ledger close.")(
+        "replayrange",
+        po::value<std::uint32_t>(),
+        "With --replay, replay this many ledgers from the local node store, "
+        "verify their hashes, report throughput and exit.")(
         "start", "Start from a fresh Ledger.")(
         "startReporting",
         po::value<std::string>(),
@@ -641,6 +661,42 @@ run(int argc, char** argv)
         config->START_UP = Config::LOAD;
     }
 
+    if (vm.count("replayrange"))
+    {
+        if (config->START_UP != Config::REPLAY || !config->standalone())
+        {
+            std::cerr << "The replayrange option requires --standalone, "
+                         "--ledger and --replay"
+                      << std::endl;
+            return -1;
+        }
+
+        config->replayRange = vm["replayrange"].as<std::uint32_t>();
+        if (config->replayRange == 0)
+        {
+            std::cerr << "Invalid value specified for --replayrange"
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    if (vm.count("compact"))
+    {
+        if (!config->standalone())
+        {
+            std::cerr << "The compact option requires --standalone"
+                      << std::endl;
+            return -1;
+        }
+
+        config->compactRange = vm["compact"].as<std::uint32_t>();
+        if (config->compactRange == 0)
+        {
+            std::cerr << "Invalid value specified for --compact" << std::endl;
+            return -1;
+        }
+    }
+
     if (vm.count("valid"))
     {
         config->START_VALID = true;
@@ -751,6 +807,44 @@ run(int argc, char** argv)
         if (vm.count("debug"))
             setDebugLogSink(logs->makeSink("Debug", beast::severities::kTrace));
 
+        if (config->exists(SECTION_LOG_QUEUE))
+        {
+            auto const& section = config->section(SECTION_LOG_QUEUE);
+            auto const overflow = get<std::string>(section, "overflow", "drop");
+            if (overflow != "drop" && overflow != "block")
+            {
+                std::cerr << "Invalid overflow in [" SECTION_LOG_QUEUE "]: "
+                          << overflow << "\n";
+                return -1;
+            }
+            logs->startAsync(
+                get<std::size_t>(section, "size", 8192),
+                overflow == "drop" ? Logs::Overflow::drop
+                                   : Logs::Overflow::block);
+        }
+
+        // Threads are pinned as they start, so this comes before any
+        {
+            bool enable = false;
+            set(enable, "enable", config->section("numa"));
+            numa::setEnabled(enable);
+            if (enable && !numa::enabled())
+            {
+                JLOG(logs->journal("Application").warn())
+                    << "[numa] is enabled, but this host has one NUMA node";
+            }
+        }
+
+        {
+            bool hugePages = false;
+            set(hugePages, "huge_pages", config->section("memory_arenas"));
+            if (hugePages && !enableArenaHugePages())
+            {
+                JLOG(logs->journal("Application").warn())
+                    << "[memory_arenas] huge_pages needs a jemalloc build";
+            }
+        }
+
         auto timeKeeper = make_TimeKeeper(logs->journal("TimeKeeper"));
 
         auto app = make_Application(
@@ -0,0 +1,215 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/MemoryBudget.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/basics/Log.h>
+#include <boost/predef.h>
+#include <algorithm>
+#include <fstream>
+
+#if BOOST_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace ripple {
+
+MemoryBudget::MemoryBudget(std::uint64_t budget, beast::Journal journal)
+    : budget_(budget), j_(journal)
+{
+}
+
+void
+MemoryBudget::add(
+    std::string name,
+    std::size_t itemBytes,
+    std::size_t ceiling,
+    std::function<std::size_t()> size,
+    std::function<float()> hitRate,
+    std::function<void(std::size_t)> setTargetSize)
+{
+    if (ceiling == 0 || itemBytes == 0)
+        return;
+
+    std::lock_guard lock(mutex_);
+    caches_.push_back(
+        {std::move(name),
+         itemBytes,
+         ceiling,
+         ceiling,
+         std::move(size),
+         std::move(hitRate),
+         std::move(setTargetSize)});
+}
+
+void
+MemoryBudget::rebalance()
+{
+    if (budget_ == 0)
+        return;
+
+    if (auto const resident = residentMemory())
+        rebalance(*resident);
+}
+
+void
+MemoryBudget::rebalance(std::uint64_t resident)
+{
+    if (budget_ == 0)
+        return;
+
+    std::lock_guard lock(mutex_);
+    resident_ = resident;
+    auto const lowWater = budget_ - budget_ / 5;
+
+    std::vector<std::pair<float, Cache*>> byValue;
+    byValue.reserve(caches_.size());
+    for (auto& cache : caches_)
+        byValue.emplace_back(cache.hitRate(), &cache);
+
+    if (resident > budget_)
+    {
+        // Cut the least useful caches first
+        std::stable_sort(
+            byValue.begin(), byValue.end(), [](auto const& a, auto const& b) {
+                return a.first < b.first;
+            });
+
+        std::uint64_t excess = resident - lowWater;
+        for (auto [rate, cache] : byValue)
+        {
+            if (excess == 0)
+                break;
+
+            // Cut from what the cache holds now, not from a target it may
+            // never have reached
+            auto const floor = std::max<std::size_t>(1, cache->ceiling / 8);
+            auto const held = std::max(floor, cache->size());
+            auto const from = std::min(cache->target, held);
+            if (from <= floor)
+                continue;
+
+            auto const items = std::min<std::uint64_t>(
+                from - floor,
+                (excess + cache->itemBytes - 1) / cache->itemBytes);
+            cache->target = from - items;
+            cache->setTargetSize(cache->target);
+            excess -= std::min(excess, items * cache->itemBytes);
+            ++cuts_;
+
+            JLOG(j_.warn()) << "Resident memory " << resident
+                            << " exceeds budget " << budget_ << ": cut "
+                            << cache->name << " (hit rate " << rate
+                            << "%) to " << cache->target;
+        }
+    }
+    else if (resident < lowWater)
+    {
+        // Restore the most useful caches first
+        std::stable_sort(
+            byValue.begin(), byValue.end(), [](auto const& a, auto const& b) {
+                return a.first > b.first;
+            });
+
+        std::uint64_t room = lowWater - resident;
+        for (auto [rate, cache] : byValue)
+        {
+            if (cache->target >= cache->ceiling)
+                continue;
+
+            auto const step = std::max<std::size_t>(1, cache->ceiling / 8);
+            auto const items = std::min<std::uint64_t>(
+                {cache->ceiling - cache->target,
+                 step,
+                 room / cache->itemBytes});
+            if (items == 0)
+                continue;
+
+            cache->target += items;
+            cache->setTargetSize(cache->target);
+            room -= items * cache->itemBytes;
+
+            JLOG(j_.debug()) << "Restored " << cache->name << " (hit rate "
+                             << rate << "%) to " << cache->target;
+        }
+    }
+}
+
+Json::Value
+MemoryBudget::getJson() const
+{
+    Json::Value ret(Json::objectValue);
+    std::lock_guard lock(mutex_);
+    ret["budget"] = std::to_string(budget_);
+    ret["resident"] = std::to_string(resident_);
+    ret["cuts"] = std::to_string(cuts_);
+
+    Json::Value& caches = (ret["caches"] = Json::objectValue);
+    for (auto const& cache : caches_)
+    {
+        auto const size = cache.size();
+        Json::Value& c = (caches[cache.name] = Json::objectValue);
+        c["target"] = static_cast<Json::UInt>(cache.target);
+        c["ceiling"] = static_cast<Json::UInt>(cache.ceiling);
+        c["size"] = static_cast<Json::UInt>(size);
+        c["estimated_bytes"] = std::to_string(size * cache.itemBytes);
+        c["hit_rate"] = cache.hitRate();
+    }
+    return ret;
+}
+
+boost::optional<std::uint64_t>
+MemoryBudget::residentMemory()
+{
+#if BOOST_OS_LINUX
+    // The second field is the resident set size, in pages
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t pages = 0;
+    std::uint64_t resident = 0;
+    if (statm >> pages >> resident)
+        return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+    return boost::none;
+}
+
+boost::optional<std::uint64_t>
+MemoryBudget::physicalMemory()
+{
+#if BOOST_OS_LINUX
+    auto const pages = sysconf(_SC_PHYS_PAGES);
+    auto const pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0)
+        return static_cast<std::uint64_t>(pages) *
+            static_cast<std::uint64_t>(pageSize);
+#endif
+    return boost::none;
+}
+
+std::uint64_t
+setup_MemoryBudget(Config const& config)
+{
+    if (config.MEMORY_BUDGET != 0)
+        return megabytes(static_cast<std::uint64_t>(config.MEMORY_BUDGET));
+
+    if (auto const physical = MemoryBudget::physicalMemory())
+        return *physical - *physical / 4;
+    return 0;
+}
+
+}  // namespace ripple
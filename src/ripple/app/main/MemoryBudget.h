@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MAIN_MEMORYBUDGET_H_INCLUDED
+#define RIPPLE_APP_MAIN_MEMORYBUDGET_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/core/Config.h>
+#include <ripple/json/json_value.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+/** Shares a budget for resident memory among the server's caches.
+
+    Each cache keeps the target size it was configured with as a ceiling.
+    Before the caches are swept, the server's resident memory is compared to
+    the budget. Above the budget, the targets of the caches with the lowest
+    hit rates are cut first until the estimated size of what they hold has
+    come down by enough to bring memory back to 80% of the budget. Below 80%
+    of the budget, targets grow back by an eighth of their ceiling per sweep,
+    the caches with the highest hit rates first. A cache is never cut below
+    an eighth of its ceiling.
+
+    Cutting a target evicts nothing by itself; the cache's next sweep
+    expires entries faster until it is back within its target.
+*/
+class MemoryBudget
+{
+public:
+    /** A cache managed by the budget. */
+    struct Cache
+    {
+        std::string name;
+        // Estimated bytes held by each item, including overhead
+        std::size_t itemBytes;
+        // Target size the cache was configured with
+        std::size_t ceiling;
+        std::size_t target;
+        std::function<std::size_t()> size;
+        // Percentage of lookups that hit
+        std::function<float()> hitRate;
+        std::function<void(std::size_t)> setTargetSize;
+    };
+
+    /** Create a budget.
+
+        @param budget bytes of resident memory allowed, or zero to leave
+                      the caches at their configured sizes
+    */
+    MemoryBudget(std::uint64_t budget, beast::Journal journal);
+
+    /** Manage a TaggedCache or ShardedTaggedCache.
+
+        The cache must outlive the budget. Caches without a target size
+        are left alone.
+    */
+    template <class TaggedCacheType>
+    void
+    add(std::string name, TaggedCacheType& cache, std::size_t itemBytes)
+    {
+        add(std::move(name),
+            itemBytes,
+            cache.getTargetSize(),
+            [&cache]() { return cache.getCacheSize(); },
+            [&cache]() { return cache.getHitRate(); },
+            [&cache](std::size_t n) {
+                cache.setTargetSize(static_cast<int>(n));
+            });
+    }
+
+    void
+    add(std::string name,
+        std::size_t itemBytes,
+        std::size_t ceiling,
+        std::function<std::size_t()> size,
+        std::function<float()> hitRate,
+        std::function<void(std::size_t)> setTargetSize);
+
+    /** Adjust the caches' targets to the process's resident memory. */
+    void
+    rebalance();
+
+    /** Adjust the caches' targets to the given resident memory. */
+    void
+    rebalance(std::uint64_t resident);
+
+    std::uint64_t
+    budget() const
+    {
+        return budget_;
+    }
+
+    /** The targets and estimated sizes of the managed caches. */
+    Json::Value
+    getJson() const;
+
+    /** @return bytes of memory resident for this process, if known */
+    static boost::optional<std::uint64_t>
+    residentMemory();
+
+    /** @return bytes of physical memory in the machine, if known */
+    static boost::optional<std::uint64_t>
+    physicalMemory();
+
+private:
+    std::uint64_t const budget_;
+    beast::Journal const j_;
+
+    mutable std::mutex mutex_;
+    std::vector<Cache> caches_;
+    std::uint64_t resident_ = 0;
+    std::uint64_t cuts_ = 0;
+};
+
+/** The budget for resident memory, in bytes.
+
+    This is the [memory_budget] in megabytes if configured, otherwise three
+    quarters of physical memory, or zero if that is not known.
+*/
+std::uint64_t
+setup_MemoryBudget(Config const& config);
+
+}  // namespace ripple
+
+#endif
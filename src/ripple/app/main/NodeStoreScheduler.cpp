@@ -19,6 +19,8 @@
 
 #include <ripple/app/main/NodeStoreScheduler.h>
 #include <cassert>
+#include <iterator>
+#include <string>
 
 namespace ripple {
 
@@ -33,6 +35,34 @@ NodeStoreScheduler::setJobQueue(JobQueue& jobQueue)
     m_jobQueue = &jobQueue;
 }
 
+void
+NodeStoreScheduler::setCollector(
+    beast::insight::Collector::ptr const& collector)
+{
+    m_writePendingBytes = collector->make_gauge("NodeStore", "Write_Pending");
+    m_writeCommitMs = collector->make_gauge("NodeStore", "Write_Commit_Ms");
+    m_writeStallMs = collector->make_gauge("NodeStore", "Write_Stall_Ms");
+    m_writeInFlight = collector->make_gauge("NodeStore", "Write_In_Flight");
+    m_writeRetries = collector->make_gauge("NodeStore", "Write_Retries");
+    m_fetchLatency = collector->make_histogram("NodeStore", "Fetch_Latency");
+
+    // Indexed by NodeStore::FetchType and NodeStore::FetchCaller
+    char const* const types[] = {"Synchronous", "Async"};
+    char const* const callers[] = {
+        "Other", "RPC", "Ledger_Sync", "Consensus", "Online_Delete"};
+    using ByType = decltype(m_fetchLatencyByType);
+    using ByCaller = decltype(m_fetchLatencyByCaller);
+    static_assert(std::size(types) == std::tuple_size_v<ByType>);
+    static_assert(std::size(callers) == std::tuple_size_v<ByCaller>);
+
+    for (std::size_t i = 0; i < m_fetchLatencyByType.size(); ++i)
+        m_fetchLatencyByType[i] = collector->make_histogram(
+            "NodeStore", std::string("Fetch_Latency_") + types[i]);
+    for (std::size_t i = 0; i < m_fetchLatencyByCaller.size(); ++i)
+        m_fetchLatencyByCaller[i] = collector->make_histogram(
+            "NodeStore", std::string("Fetch_Latency_") + callers[i]);
+}
+
 void
 NodeStoreScheduler::onStop()
 {
@@ -82,6 +112,11 @@ NodeStoreScheduler::onFetch(NodeStore::FetchReport const& report)
         report.fetchType == NodeStore::FetchType::async ? jtNS_ASYNC_READ
                                                         : jtNS_SYNC_READ,
         1,
+        std::chrono::duration_cast<std::chrono::milliseconds>(report.elapsed));
+    m_fetchLatency.notify(report.elapsed);
+    m_fetchLatencyByType[static_cast<std::size_t>(report.fetchType)].notify(
+        report.elapsed);
+    m_fetchLatencyByCaller[static_cast<std::size_t>(report.caller)].notify(
         report.elapsed);
 }
 
@@ -89,6 +124,12 @@ void
 NodeStoreScheduler::onBatchWrite(NodeStore::BatchWriteReport const& report)
 {
     m_jobQueue->addLoadEvents(jtNS_WRITE, report.writeCount, report.elapsed);
+
+    m_writePendingBytes = report.pendingBytes;
+    m_writeCommitMs = report.elapsed.count();
+    m_writeStallMs = report.stalled.count();
+    m_writeInFlight = report.inFlight;
+    m_writeRetries = report.retries;
 }
 
 }  // namespace ripple
@@ -20,9 +20,11 @@
 #ifndef RIPPLE_APP_MAIN_NODESTORESCHEDULER_H_INCLUDED
 #define RIPPLE_APP_MAIN_NODESTORESCHEDULER_H_INCLUDED
 
+#include <ripple/beast/insight/Collector.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/nodestore/Scheduler.h>
+#include <array>
 #include <atomic>
 
 namespace ripple {
@@ -40,6 +42,10 @@ public:
     void
     setJobQueue(JobQueue& jobQueue);
 
+    /** Publish batch write backpressure through the given collector. */
+    void
+    setCollector(beast::insight::Collector::ptr const& collector);
+
     void
     onStop() override;
     void
@@ -57,6 +63,16 @@ private:
 
     JobQueue* m_jobQueue{nullptr};
     std::atomic<int> m_taskCount{0};
+
+    beast::insight::Gauge m_writePendingBytes;
+    beast::insight::Gauge m_writeCommitMs;
+    beast::insight::Gauge m_writeStallMs;
+    beast::insight::Gauge m_writeInFlight;
+    beast::insight::Gauge m_writeRetries;
+    beast::insight::Histogram m_fetchLatency;
+    // Fetch latency by FetchType, and by FetchCaller
+    std::array<beast::insight::Histogram, 2> m_fetchLatencyByType;
+    std::array<beast::insight::Histogram, 5> m_fetchLatencyByCaller;
 };
 
 }  // namespace ripple
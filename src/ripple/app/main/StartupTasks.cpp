@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/StartupTasks.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/WorkerPool.h>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace ripple {
+
+StartupTasks::StartupTasks(WorkerPool& workers, beast::Journal journal)
+    : workers_(workers), j_(journal)
+{
+}
+
+void
+StartupTasks::add(
+    std::string name,
+    std::vector<std::string> const& after,
+    std::function<bool()> task)
+{
+    Task t;
+    t.name = std::move(name);
+    t.work = std::move(task);
+    for (auto const& dep : after)
+    {
+        auto const it = std::find_if(
+            tasks_.begin(), tasks_.end(), [&dep](Task const& other) {
+                return other.name == dep;
+            });
+        if (it == tasks_.end())
+            LogicError(
+                "StartupTasks: " + t.name + " depends on unknown task " + dep);
+        t.after.push_back(std::distance(tasks_.begin(), it));
+    }
+    tasks_.push_back(std::move(t));
+}
+
+bool
+StartupTasks::run()
+{
+    using namespace std::chrono;
+    auto const start = clock_type::now();
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::exception_ptr error;
+    std::size_t running = 0;
+    std::size_t started = 0;
+    bool failed = false;
+
+    // The first task whose dependencies have all succeeded, if any. Tasks
+    // only wait on tasks added before them, so one pass in order sees the
+    // latest state of every dependency.
+    auto ready = [&]() -> Task* {
+        for (auto& task : tasks_)
+        {
+            if (task.state != State::pending)
+                continue;
+
+            if (failed)
+            {
+                task.state = State::skipped;
+                continue;
+            }
+
+            if (std::all_of(
+                    task.after.begin(),
+                    task.after.end(),
+                    [this](std::size_t i) {
+                        return tasks_[i].state == State::succeeded;
+                    }))
+                return &task;
+        }
+        return nullptr;
+    };
+
+    // Each worker runs tasks as they become ready, until none are left
+    // and none are running
+    auto work = [&](std::size_t) {
+        std::unique_lock lock(mutex);
+        while (true)
+        {
+            auto const t = ready();
+            if (!t)
+            {
+                if (running == 0)
+                    return;
+                cond.wait(lock);
+                continue;
+            }
+
+            t->state = State::running;
+            ++running;
+            ++started;
+            lock.unlock();
+
+            auto const begin = clock_type::now();
+            bool ok = false;
+            std::exception_ptr ep;
+            try
+            {
+                ok = t->work();
+            }
+            catch (...)
+            {
+                ep = std::current_exception();
+            }
+            auto const took =
+                duration_cast<milliseconds>(clock_type::now() - begin);
+
+            if (ok)
+                JLOG(j_.info()) << "Startup: " << t->name << " took "
+                                << took.count() << "ms";
+            else
+                JLOG(j_.error()) << "Startup: " << t->name << " failed after "
+                                 << took.count() << "ms";
+
+            lock.lock();
+            t->duration = took;
+            t->state = ok ? State::succeeded : State::failed;
+            if (!ok)
+                failed = true;
+            if (ep && !error)
+                error = ep;
+            --running;
+            cond.notify_all();
+        }
+    };
+    workers_.run(tasks_.size(), work);
+
+    elapsed_ = duration_cast<milliseconds>(clock_type::now() - start);
+    JLOG(j_.info()) << "Startup: " << started << " of " << tasks_.size()
+                    << " tasks ran in " << elapsed_.count() << "ms";
+
+    if (error)
+        std::rethrow_exception(error);
+    return !failed;
+}
+
+std::vector<std::pair<std::string, std::chrono::milliseconds>>
+StartupTasks::durations() const
+{
+    std::vector<std::pair<std::string, std::chrono::milliseconds>> result;
+    for (auto const& task : tasks_)
+    {
+        if (task.state == State::succeeded || task.state == State::failed)
+            result.emplace_back(task.name, task.duration);
+    }
+    return result;
+}
+
+}  // namespace ripple
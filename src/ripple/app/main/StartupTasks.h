@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MAIN_STARTUPTASKS_H_INCLUDED
+#define RIPPLE_APP_MAIN_STARTUPTASKS_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+class WorkerPool;
+
+/** Runs the steps of server startup, in parallel where they allow it.
+
+    Each task names the tasks it must wait for, which must have been added
+    before it, and starts on a thread of the worker pool once all of them
+    have succeeded. Once a task returns false or throws no further tasks
+    are started, since startup is going to fail, but tasks already running
+    are left to finish.
+*/
+class StartupTasks
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    StartupTasks(WorkerPool& workers, beast::Journal journal);
+
+    /** Add a task.
+
+        @param name identifies the task in the log and in server_info
+        @param after names of the tasks that must succeed before this starts
+        @param task the work to do, returning false on failure
+    */
+    void
+    add(std::string name,
+        std::vector<std::string> const& after,
+        std::function<bool()> task);
+
+    /** Run every task and wait for all of them to finish.
+
+        If a task threw, the first exception is rethrown once all the
+        running tasks have finished.
+
+        @return true if every task succeeded
+    */
+    bool
+    run();
+
+    /** The time taken by each task that finished, in the order added. */
+    std::vector<std::pair<std::string, std::chrono::milliseconds>>
+    durations() const;
+
+    /** The time taken by run(), from start to finish. */
+    std::chrono::milliseconds
+    elapsed() const
+    {
+        return elapsed_;
+    }
+
+private:
+    enum class State { pending, running, succeeded, failed, skipped };
+
+    struct Task
+    {
+        std::string name;
+        std::vector<std::size_t> after;
+        std::function<bool()> work;
+        State state = State::pending;
+        std::chrono::milliseconds duration{0};
+    };
+
+    WorkerPool& workers_;
+    beast::Journal const j_;
+    std::vector<Task> tasks_;
+    std::chrono::milliseconds elapsed_{0};
+};
+
+}  // namespace ripple
+
+#endif
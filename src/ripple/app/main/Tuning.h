@@ -25,6 +25,24 @@ namespace ripple {
 constexpr std::size_t fullBelowTargetSize = 524288;
 constexpr std::chrono::seconds fullBelowExpiration = std::chrono::minutes{10};
 
+// Most missing nodes asked of one peer in one request
+constexpr std::size_t missingNodeBatch = 256;
+
+// Most missing nodes waiting for a reply, across all peers
+constexpr std::size_t missingNodeOutstanding = 2048;
+
+// Most missing nodes tracked at once
+constexpr std::size_t missingNodeLimit = 65536;
+
+// How long to wait for a missing node before asking for it again
+constexpr std::chrono::seconds missingNodeTimeout{5};
+
+// How long a missing node nobody reads again is remembered
+constexpr std::chrono::seconds missingNodeExpiration = std::chrono::minutes{1};
+
+// Requests for a missing node before acquiring its whole ledger instead
+constexpr int missingNodeTries = 3;
+
 }  // namespace ripple
 
 #endif
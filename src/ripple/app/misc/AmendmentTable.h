@@ -156,8 +156,7 @@ public:
 
             initialPosition->addGiveItem(
                 SHAMapNodeType::tnTRANSACTION_NM,
-                std::make_shared<SHAMapItem>(
-                    amendTx.getTransactionID(), s.peekData()));
+                make_shamapitem(amendTx.getTransactionID(), s.slice()));
         }
     }
 };
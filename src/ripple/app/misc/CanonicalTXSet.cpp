@@ -18,6 +18,8 @@
 //==============================================================================
 
 #include <ripple/app/misc/CanonicalTXSet.h>
+#include <algorithm>
+#include <cassert>
 
 namespace ripple {
 
@@ -51,11 +53,57 @@ CanonicalTXSet::accountKey(AccountID const& account)
 void
 CanonicalTXSet::insert(std::shared_ptr<STTx const> const& txn)
 {
-    map_.insert(std::make_pair(
+    txs_.emplace_back(
         Key(accountKey(txn->getAccountID(sfAccount)),
             txn->getSeqProxy(),
             txn->getTransactionID()),
-        txn));
+        txn);
+    sorted_ = false;
+}
+
+void
+CanonicalTXSet::sort() const
+{
+    if (sorted_)
+        return;
+
+    if (erased_ != 0)
+    {
+        txs_.erase(
+            std::remove_if(
+                txs_.begin(),
+                txs_.end(),
+                [](value_type const& v) { return !v.second; }),
+            txs_.end());
+        erased_ = 0;
+    }
+
+    auto const less = [](value_type const& lhs, value_type const& rhs) {
+        return lhs.first < rhs.first;
+    };
+
+    // A stable sort keeps the first insert of a transaction when it is
+    // inserted more than once, as inserting into a map would.
+    std::stable_sort(txs_.begin(), txs_.end(), less);
+    txs_.erase(
+        std::unique(
+            txs_.begin(),
+            txs_.end(),
+            [&less](value_type const& lhs, value_type const& rhs) {
+                return !less(lhs, rhs) && !less(rhs, lhs);
+            }),
+        txs_.end());
+    sorted_ = true;
+}
+
+CanonicalTXSet::const_iterator
+CanonicalTXSet::erase(const_iterator const& it)
+{
+    auto const pos = txs_.begin() + (it.pos_ - txs_.cbegin());
+    assert(pos->second);
+    pos->second.reset();
+    ++erased_;
+    return const_iterator(std::next(it.pos_), txs_.cend());
 }
 
 std::shared_ptr<STTx const>
@@ -74,13 +122,20 @@ CanonicalTXSet::popAcctTransaction(std::shared_ptr<STTx const> const& tx)
     std::shared_ptr<STTx const> result;
     uint256 const effectiveAccount{accountKey(tx->getAccountID(sfAccount))};
 
+    sort();
     Key const after(effectiveAccount, tx->getSeqProxy(), beast::zero);
-    auto const itrNext{map_.lower_bound(after)};
-    if (itrNext != map_.end() &&
+    auto itrNext = std::lower_bound(
+        txs_.begin(),
+        txs_.end(),
+        after,
+        [](value_type const& v, Key const& key) { return v.first < key; });
+    while (itrNext != txs_.end() && !itrNext->second)
+        ++itrNext;
+    if (itrNext != txs_.end() &&
         itrNext->first.getAccount() == effectiveAccount)
     {
         result = std::move(itrNext->second);
-        map_.erase(itrNext);
+        ++erased_;
     }
 
     return result;
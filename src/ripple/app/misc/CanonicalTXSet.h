@@ -23,6 +23,8 @@
 #include <ripple/protocol/RippleLedgerHash.h>
 #include <ripple/protocol/STTx.h>
 #include <ripple/protocol/SeqProxy.h>
+#include <iterator>
+#include <vector>
 
 namespace ripple {
 
@@ -32,6 +34,11 @@ namespace ripple {
 
     - Puts transactions from the same account in SeqProxy order
 
+    Transactions are held in a flat vector. Inserts are appended and the
+    vector is sorted the next time the set is read, so building a set is
+    a single sort instead of a tree insert per transaction. Erasing only
+    clears the slot, which leaves every other iterator valid; inserting
+    invalidates all iterators.
 */
 // VFALCO TODO rename to SortedTxSet
 class CanonicalTXSet
@@ -103,9 +110,83 @@ private:
     uint256
     accountKey(AccountID const& account);
 
+    using value_type = std::pair<Key, std::shared_ptr<STTx const>>;
+    using storage_type = std::vector<value_type>;
+
 public:
-    using const_iterator =
-        std::map<Key, std::shared_ptr<STTx const>>::const_iterator;
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = CanonicalTXSet::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type const*;
+        using reference = value_type const&;
+
+        const_iterator() = default;
+
+        reference
+        operator*() const
+        {
+            return *pos_;
+        }
+
+        pointer
+        operator->() const
+        {
+            return &*pos_;
+        }
+
+        const_iterator&
+        operator++()
+        {
+            ++pos_;
+            skip();
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            auto const ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        friend bool
+        operator==(const_iterator const& lhs, const_iterator const& rhs)
+        {
+            return lhs.pos_ == rhs.pos_;
+        }
+
+        friend bool
+        operator!=(const_iterator const& lhs, const_iterator const& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class CanonicalTXSet;
+
+        const_iterator(
+            storage_type::const_iterator pos,
+            storage_type::const_iterator end)
+            : pos_(pos), end_(end)
+        {
+            skip();
+        }
+
+        // Step over the slots of erased transactions
+        void
+        skip()
+        {
+            while (pos_ != end_ && !pos_->second)
+                ++pos_;
+        }
+
+        storage_type::const_iterator pos_;
+        storage_type::const_iterator end_;
+    };
 
 public:
     explicit CanonicalTXSet(LedgerHash const& saltHash) : salt_(saltHash)
@@ -115,6 +196,12 @@ public:
     void
     insert(std::shared_ptr<STTx const> const& txn);
 
+    void
+    reserve(std::size_t n)
+    {
+        txs_.reserve(n);
+    }
+
     // Pops the next transaction on account that follows seqProx in the
     // sort order.  Normally called when a transaction is successfully
     // applied to the open ledger so the next transaction can be resubmitted
@@ -129,36 +216,38 @@ public:
     reset(LedgerHash const& salt)
     {
         salt_ = salt;
-        map_.clear();
+        txs_.clear();
+        erased_ = 0;
+        sorted_ = true;
     }
 
     const_iterator
-    erase(const_iterator const& it)
-    {
-        return map_.erase(it);
-    }
+    erase(const_iterator const& it);
 
     const_iterator
     begin() const
     {
-        return map_.begin();
+        sort();
+        return const_iterator(txs_.cbegin(), txs_.cend());
     }
 
     const_iterator
     end() const
     {
-        return map_.end();
+        sort();
+        return const_iterator(txs_.cend(), txs_.cend());
     }
 
     size_t
     size() const
     {
-        return map_.size();
+        sort();
+        return txs_.size() - erased_;
     }
     bool
     empty() const
     {
-        return map_.empty();
+        return size() == 0;
     }
 
     uint256 const&
@@ -168,7 +257,15 @@ public:
     }
 
 private:
-    std::map<Key, std::shared_ptr<STTx const>> map_;
+    // Drop erased slots and duplicates and put the remaining transactions
+    // in canonical order, if anything was inserted since the last sort.
+    void
+    sort() const;
+
+    // Sorted lazily, so that reading a set is allowed to reorder it
+    mutable storage_type txs_;
+    mutable std::size_t erased_ = 0;
+    mutable bool sorted_ = true;
 
     // Used to salt the accounts so people can't mine for low account numbers
     uint256 salt_;
@@ -26,6 +26,9 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/container/aged_unordered_map.h>
 #include <boost/optional.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace ripple {
 
@@ -48,6 +51,10 @@ namespace ripple {
     This table keeps track of which hashes have been received by which peers.
     It is used to manage the routing and broadcasting of messages in the peer
     to peer overlay.
+
+    The table is split into shards by the first byte of the hash, each with
+    its own lock, so that peers handling unrelated messages rarely contend.
+    Inserting into a shard expires the old entries of that shard only.
 */
 class HashRouter
 {
@@ -167,10 +174,11 @@ public:
         Stopwatch& clock,
         std::chrono::seconds entryHoldTimeInSeconds,
         std::uint32_t recoverLimit)
-        : suppressionMap_(clock)
-        , holdTime_(entryHoldTimeInSeconds)
-        , recoverLimit_(recoverLimit + 1u)
+        : holdTime_(entryHoldTimeInSeconds), recoverLimit_(recoverLimit + 1u)
     {
+        shards_.reserve(shardCount);
+        for (std::size_t i = 0; i < shardCount; ++i)
+            shards_.emplace_back(std::make_unique<Shard>(clock));
     }
 
     HashRouter&
@@ -240,19 +248,39 @@ public:
     shouldRecover(uint256 const& key);
 
 private:
-    // pair.second indicates whether the entry was created
-    std::pair<Entry&, bool>
-    emplace(uint256 const&);
+    // Must be a power of two
+    static constexpr std::size_t shardCount = 16;
+
+    struct Shard
+    {
+        explicit Shard(Stopwatch& clock) : suppressionMap(clock)
+        {
+        }
+
+        std::mutex mutex;
 
-    std::mutex mutable mutex_;
+        // Stores the suppressed hashes of this shard and their
+        // expiration time
+        beast::aged_unordered_map<
+            uint256,
+            Entry,
+            Stopwatch::clock_type,
+            hardened_hash<strong_hash>>
+            suppressionMap;
+    };
+
+    Shard&
+    shard(uint256 const& key)
+    {
+        return *shards_[*key.data() & (shardCount - 1)];
+    }
+
+    // pair.second indicates whether the entry was created.
+    // The shard's mutex must be held.
+    std::pair<Entry&, bool>
+    emplace(Shard& shard, uint256 const&);
 
-    // Stores all suppressed hashes and their expiration time
-    beast::aged_unordered_map<
-        uint256,
-        Entry,
-        Stopwatch::clock_type,
-        hardened_hash<strong_hash>>
-        suppressionMap_;
+    std::vector<std::unique_ptr<Shard>> shards_;
 
     std::chrono::seconds const holdTime_;
 
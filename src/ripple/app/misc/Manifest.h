@@ -21,10 +21,12 @@
 #define RIPPLE_APP_MISC_MANIFEST_H_INCLUDED
 
 #include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/SecretKey.h>
 #include <boost/optional.hpp>
+#include <mutex>
 #include <string>
 
 namespace ripple {
@@ -205,6 +207,48 @@ to_string(ManifestDisposition m)
 
 class DatabaseCon;
 
+/** Remembers the outcome of recent signature checks.
+
+    Outcomes are keyed by a digest of what was signed, the signature and the
+    key it was checked against. Once the cache holds `size` outcomes it
+    forgets them all, so it stays small however many signatures it is shown.
+
+    @par Thread Safety
+
+    May be called concurrently
+*/
+class SignatureCheckCache
+{
+public:
+    explicit SignatureCheckCache(std::size_t size) : size_(size)
+    {
+    }
+
+    /** Returns the outcome of the check with this digest, if remembered. */
+    boost::optional<bool>
+    find(uint256 const& digest) const
+    {
+        std::lock_guard lock{mutex_};
+        if (auto const iter = checks_.find(digest); iter != checks_.end())
+            return iter->second;
+        return boost::none;
+    }
+
+    void
+    insert(uint256 const& digest, bool valid)
+    {
+        std::lock_guard lock{mutex_};
+        if (checks_.size() >= size_)
+            checks_.clear();
+        checks_.emplace(digest, valid);
+    }
+
+private:
+    std::size_t const size_;
+    std::mutex mutable mutex_;
+    hash_map<uint256, bool> checks_;
+};
+
 /** Remembers manifests with the highest sequence number. */
 class ManifestCache
 {
@@ -213,6 +257,9 @@ private:
     std::mutex apply_mutex_;
     std::mutex mutable read_mutex_;
 
+    /** Outcomes of recent manifest signature checks. */
+    SignatureCheckCache mutable checked_{1024};
+
     /** Active manifests stored by master public key. */
     hash_map<PublicKey, Manifest> map_;
 
@@ -296,6 +343,18 @@ public:
     bool
     revoked(PublicKey const& pk) const;
 
+    /** Returns whether the manifest's signatures are valid.
+
+        The outcome is remembered, so a manifest that is received again is
+        not verified again.
+
+        @par Thread Safety
+
+        May be called concurrently
+    */
+    bool
+    checkSignatures(Manifest const& m) const;
+
     /** Add manifest to cache.
 
         @param m Manifest to add
@@ -305,7 +364,8 @@ public:
 
         @par Thread Safety
 
-        May be called concurrently
+        May be called concurrently. The signatures are verified without
+        holding the lock that serializes the changes to the cache.
     */
     ManifestDisposition
     applyManifest(Manifest m);
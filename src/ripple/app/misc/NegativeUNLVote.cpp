@@ -120,7 +120,7 @@ NegativeUNLVote::addTx(
     negUnlTx.add(s);
     if (!initialSet->addGiveItem(
             SHAMapNodeType::tnTRANSACTION_NM,
-            std::make_shared<SHAMapItem>(txID, s.peekData())))
+            make_shamapitem(txID, s.slice())))
     {
         JLOG(j_.warn()) << "N-UNL: ledger seq=" << seq
                         << ", add ttUNL_MODIFY tx failed";
@@ -193,16 +193,15 @@ NegativeUNLVote::buildScoreTable(
         scoreTable[k] = 0;
     }
 
-    // Query the validation container for every ledger hash and fill
-    // the score table.
-    for (int i = 0; i < FLAG_LEDGER_INTERVAL; ++i)
+    // Fill the score table from the validation history the container keeps
+    // for every trusted validator as validations arrive.
+    std::vector<uint256> const chain(
+        ledgerAncestors.end() - FLAG_LEDGER_INTERVAL, ledgerAncestors.end());
+    for (auto const& [nodeId, count] :
+         validations.getTrustedValidatedCounts(seq - 2, chain))
     {
-        for (auto const& v : validations.getTrustedForLedger(
-                 ledgerAncestors[numAncestors - 1 - i]))
-        {
-            if (scoreTable.count(v->getNodeID()))
-                ++scoreTable[v->getNodeID()];
-        }
+        if (auto const it = scoreTable.find(nodeId); it != scoreTable.end())
+            it->second = count;
     }
 
     // Return false if the validation message history or local node's
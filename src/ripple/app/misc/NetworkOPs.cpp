@@ -21,6 +21,7 @@
 #include <ripple/app/consensus/RCLValidations.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
+#include <ripple/app/ledger/IssuerBalances.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/app/ledger/LocalTxs.h>
@@ -33,6 +34,7 @@
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/Transaction.h>
+#include <ripple/app/misc/TransactionFilter.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
 #include <ripple/app/misc/ValidatorList.h>
@@ -40,6 +42,7 @@
 #include <ripple/app/reporting/ReportingETL.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/basics/PerfLog.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/UptimeClock.h>
 #include <ripple/basics/base64.h>
 #include <ripple/basics/mulDiv.h>
@@ -50,9 +53,11 @@
 #include <ripple/consensus/Consensus.h>
 #include <ripple/consensus/ConsensusParms.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/crypto/RFC1751.h>
 #include <ripple/crypto/csprng.h>
 #include <ripple/json/to_string.h>
+#include <ripple/net/SubscriberFanout.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/overlay/Cluster.h>
 #include <ripple/overlay/Overlay.h>
@@ -66,6 +71,7 @@
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/steady_timer.hpp>
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <tuple>
@@ -73,6 +79,9 @@
 
 namespace ripple {
 
+// Preflight a batch on several threads only when each gets this many
+static constexpr std::size_t minPreflightsPerThread = 16;
+
 class NetworkOPsImp final : public NetworkOPs
 {
     /**
@@ -98,6 +107,19 @@ class NetworkOPsImp final : public NetworkOPs
         {
             assert(local || failType == FailHard::no);
         }
+
+        /// The flags to apply the transaction with
+        ApplyFlags
+        flags() const
+        {
+            ApplyFlags result = tapNONE;
+            if (admin)
+                result |= tapUNLIMITED;
+
+            if (failType == FailHard::yes)
+                result |= tapFAIL_HARD;
+            return result;
+        }
     };
 
     /**
@@ -249,6 +271,7 @@ public:
               app_.logs().journal("LedgerConsensus"))
         , m_ledgerMaster(ledgerMaster)
         , m_job_queue(job_queue)
+        , fanout_(job_queue, app_.journal("SubscriberFanout"))
         , m_standalone(standalone)
         , minPeerCount_(start_valid ? 0 : minPeerCount)
         , m_stats(std::bind(&NetworkOPsImp::collect_metrics, this), collector)
@@ -331,6 +354,16 @@ public:
     void
     apply(std::unique_lock<std::mutex>& batchLock);
 
+    /**
+     * Run preflight on each transaction of a batch, on several threads
+     * when there are enough of them.
+     *
+     * @param batch The transactions about to be applied
+     * @return The result for each transaction, in the same order
+     */
+    std::vector<boost::optional<PreflightResult>>
+    preflightBatch(std::vector<TransactionStatus> const& batch);
+
     //
     // Owner functions.
     //
@@ -350,6 +383,7 @@ public:
         Book const&,
         AccountID const& uTakerID,
         const bool bProof,
+        const bool bBinary,
         unsigned int iLimit,
         Json::Value const& jvMarker,
         Json::Value& jvResult) override;
@@ -580,6 +614,10 @@ public:
     bool
     subTransactions(InfoSub::ref ispListener) override;
     bool
+    subTransactions(
+        InfoSub::ref ispListener,
+        std::shared_ptr<TransactionFilter const> filter) override;
+    bool
     unsubTransactions(std::uint64_t uListener) override;
 
     bool
@@ -664,7 +702,8 @@ private:
     void
     pubValidatedTransaction(
         std::shared_ptr<ReadView const> const& alAccepted,
-        const AcceptedLedgerTx& alTransaction);
+        const AcceptedLedgerTx& alTransaction,
+        OrderBookDB::BookToListenersMap const& bookListeners);
     void
     pubAccountTransaction(
         std::shared_ptr<ReadView const> const& lpCurrent,
@@ -729,10 +768,19 @@ private:
     };
     std::array<SubMapType, SubTypes::sLastEntry + 1> mStreamMaps;
 
+    // The transactions stream subscribers that gave a filter, which are
+    // not in mStreamMaps
+    SubMapType mFilteredTransactions;
+    TransactionFilterIndex mTransactionFilters;
+
     ServerFeeSummary mLastFeeSummary;
 
     JobQueue& m_job_queue;
 
+    // Delivers ledger and transaction stream messages off the publishing
+    // thread and outside of mSubLock
+    SubscriberFanout fanout_;
+
     // Whether we are in standalone mode.
     bool const m_standalone;
 
@@ -1101,6 +1149,7 @@ NetworkOPsImp::submitTransaction(std::shared_ptr<STTx const> const& iTrans)
     {
         auto const [validity, reason] = checkValidity(
             app_.getHashRouter(),
+            app_.getSignatureCache(),
             *trans,
             m_ledgerMaster.getValidatedRules(),
             app_.config());
@@ -1153,6 +1202,7 @@ NetworkOPsImp::processTransaction(
     auto const view = m_ledgerMaster.getCurrentLedger();
     auto const [validity, reason] = checkValidity(
         app_.getHashRouter(),
+        app_.getSignatureCache(),
         *transaction->getSTransaction(),
         view->rules(),
         app_.config());
@@ -1258,6 +1308,29 @@ NetworkOPsImp::transactionBatch()
     }
 }
 
+std::vector<boost::optional<PreflightResult>>
+NetworkOPsImp::preflightBatch(std::vector<TransactionStatus> const& batch)
+{
+    // Preflight only depends on the rules, so the transactions can be
+    // checked against those of the current open ledger on several threads
+    // before the master lock is taken. TxQ runs it again for any whose
+    // rules change in the meantime.
+    auto const rules = app_.openLedger().current()->rules();
+    auto const j = app_.journal("OpenLedger");
+
+    std::vector<boost::optional<PreflightResult>> results(batch.size());
+    app_.getWorkerPool().run(
+        batch.size(),
+        [&](std::size_t i) {
+            auto const& e = batch[i];
+            results[i].emplace(preflight(
+                app_, rules, *e.transaction->getSTransaction(), e.flags(), j));
+        },
+        minPreflightsPerThread);
+
+    return results;
+}
+
 void
 NetworkOPsImp::apply(std::unique_lock<std::mutex>& batchLock)
 {
@@ -1271,6 +1344,8 @@ NetworkOPsImp::apply(std::unique_lock<std::mutex>& batchLock)
 
     batchLock.unlock();
 
+    auto const preflights = preflightBatch(transactions);
+
     {
         std::unique_lock masterLock{app_.getMasterMutex(), std::defer_lock};
         bool changed = false;
@@ -1280,18 +1355,15 @@ NetworkOPsImp::apply(std::unique_lock<std::mutex>& batchLock)
             std::lock(masterLock, ledgerLock);
 
             app_.openLedger().modify([&](OpenView& view, beast::Journal j) {
-                for (TransactionStatus& e : transactions)
+                for (std::size_t i = 0; i < transactions.size(); ++i)
                 {
-                    // we check before adding to the batch
-                    ApplyFlags flags = tapNONE;
-                    if (e.admin)
-                        flags |= tapUNLIMITED;
-
-                    if (e.failType == FailHard::yes)
-                        flags |= tapFAIL_HARD;
-
+                    auto& e = transactions[i];
                     auto const result = app_.getTxQ().apply(
-                        app_, view, e.transaction->getSTransaction(), flags, j);
+                        app_,
+                        view,
+                        e.transaction->getSTransaction(),
+                        *preflights[i],
+                        j);
                     e.result = result.first;
                     e.applied = result.second;
                     changed = changed || result.second;
@@ -1425,10 +1497,11 @@ NetworkOPsImp::apply(std::unique_lock<std::mutex>& batchLock)
                     tx.set_receivetimestamp(
                         app_.timeKeeper().now().time_since_epoch().count());
                     tx.set_deferred(e.result == terQUEUED);
+                    // Cluster members trust our signature check
+                    tx.set_verified(isSignatureGood(
+                        app_.getHashRouter(), e.transaction->getID()));
                     // FIXME: This should be when we received it
-                    app_.overlay().foreach(send_if_not(
-                        std::make_shared<Message>(tx, protocol::mtTRANSACTION),
-                        peer_in_set(*toSkip)));
+                    app_.overlay().relay(tx, *toSkip, e.local);
                     e.transaction->setBroadcast();
                 }
             }
@@ -1926,12 +1999,13 @@ NetworkOPsImp::pubManifest(Manifest const& mo)
             jvObj[jss::domain] = mo.domain;
         jvObj[jss::manifest] = strHex(mo.serialized);
 
+        PublishedJson const msg(jvObj);
         for (auto i = mStreamMaps[sManifests].begin();
              i != mStreamMaps[sManifests].end();)
         {
             if (auto p = i->second.lock())
             {
-                p->send(jvObj, true);
+                p->publish(msg, true);
                 ++i;
             }
             else
@@ -2029,6 +2103,7 @@ NetworkOPsImp::pubServer()
 
         mLastFeeSummary = f;
 
+        PublishedJson const msg(jvObj);
         for (auto i = mStreamMaps[sServer].begin();
              i != mStreamMaps[sServer].end();)
         {
@@ -2039,7 +2114,7 @@ NetworkOPsImp::pubServer()
             //             sending of JSON data.
             if (p)
             {
-                p->send(jvObj, true);
+                p->publish(msg, true);
                 ++i;
             }
             else
@@ -2062,11 +2137,12 @@ NetworkOPsImp::pubConsensus(ConsensusPhase phase)
         jvObj[jss::type] = "consensusPhase";
         jvObj[jss::consensus] = to_string(phase);
 
+        PublishedJson const msg(jvObj);
         for (auto i = streamMap.begin(); i != streamMap.end();)
         {
             if (auto p = i->second.lock())
             {
-                p->send(jvObj, true);
+                p->publish(msg, true);
                 ++i;
             }
             else
@@ -2129,12 +2205,13 @@ NetworkOPsImp::pubValidation(std::shared_ptr<STValidation> const& val)
         if (auto const reserveInc = (*val)[~sfReserveIncrement])
             jvObj[jss::reserve_inc] = *reserveInc;
 
+        PublishedJson const msg(jvObj);
         for (auto i = mStreamMaps[sValidations].begin();
              i != mStreamMaps[sValidations].end();)
         {
             if (auto p = i->second.lock())
             {
-                p->send(jvObj, true);
+                p->publish(msg, true);
                 ++i;
             }
             else
@@ -2156,6 +2233,7 @@ NetworkOPsImp::pubPeerStatus(std::function<Json::Value(void)> const& func)
 
         jvObj[jss::type] = "peerStatusChange";
 
+        PublishedJson const msg(jvObj);
         for (auto i = mStreamMaps[sPeerStatus].begin();
              i != mStreamMaps[sPeerStatus].end();)
         {
@@ -2163,7 +2241,7 @@ NetworkOPsImp::pubPeerStatus(std::function<Json::Value(void)> const& func)
 
             if (p)
             {
-                p->send(jvObj, true);
+                p->publish(msg, true);
                 ++i;
             }
             else
@@ -2266,11 +2344,12 @@ NetworkOPsImp::transactionsSQL(
             selection % app_.accountIDCache().toBase58(account) % maxClause %
             minClause % offset % numberOfResults);
     else
+        // The view joins the tables within each partition of the database,
+        // and SQLite merges the partitions in order only when every ORDER
+        // BY term is a result column, so the selection must include them.
         sql = boost::str(
             boost::format(
-                "SELECT %s FROM "
-                "AccountTransactions INNER JOIN Transactions "
-                "ON Transactions.TransID = AccountTransactions.TransID "
+                "SELECT %s FROM AccountTxJoined AS AccountTransactions "
                 "WHERE Account = '%s' %s %s "
                 "ORDER BY AccountTransactions.LedgerSeq %s, "
                 "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
@@ -2297,7 +2376,8 @@ NetworkOPsImp::getAccountTxs(
     AccountTxs ret;
 
     std::string sql = transactionsSQL(
-        "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta",
+        "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta,"
+        "AccountTransactions.TxnSeq,AccountTransactions.TransID",
         account,
         minLedger,
         maxLedger,
@@ -2309,12 +2389,15 @@ NetworkOPsImp::getAccountTxs(
         bUnlimited);
 
     {
-        auto db = app_.getTxnDB().checkoutDb();
+        auto db = app_.getTxnDB().checkoutReadDb();
 
         boost::optional<std::uint64_t> ledgerSeq;
         boost::optional<std::string> status;
         soci::blob sociTxnBlob(*db), sociTxnMetaBlob(*db);
         soci::indicator rti, tmi;
+        // Selected only to order the rows
+        boost::optional<std::uint64_t> txnSeq;
+        boost::optional<std::string> transID;
         Blob rawTxn, txnMeta;
 
         soci::statement st =
@@ -2322,7 +2405,9 @@ NetworkOPsImp::getAccountTxs(
              soci::into(ledgerSeq),
              soci::into(status),
              soci::into(sociTxnBlob, rti),
-             soci::into(sociTxnMetaBlob, tmi));
+             soci::into(sociTxnMetaBlob, tmi),
+             soci::into(txnSeq),
+             soci::into(transID));
 
         st.execute();
         while (st.fetch())
@@ -2377,7 +2462,8 @@ NetworkOPsImp::getAccountTxsB(
     std::vector<txnMetaLedgerType> ret;
 
     std::string sql = transactionsSQL(
-        "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta",
+        "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta,"
+        "AccountTransactions.TxnSeq,AccountTransactions.TransID",
         account,
         minLedger,
         maxLedger,
@@ -2389,19 +2475,24 @@ NetworkOPsImp::getAccountTxsB(
         bUnlimited);
 
     {
-        auto db = app_.getTxnDB().checkoutDb();
+        auto db = app_.getTxnDB().checkoutReadDb();
 
         boost::optional<std::uint64_t> ledgerSeq;
         boost::optional<std::string> status;
         soci::blob sociTxnBlob(*db), sociTxnMetaBlob(*db);
         soci::indicator rti, tmi;
+        // Selected only to order the rows
+        boost::optional<std::uint64_t> txnSeq;
+        boost::optional<std::string> transID;
 
         soci::statement st =
             (db->prepare << sql,
              soci::into(ledgerSeq),
              soci::into(status),
              soci::into(sociTxnBlob, rti),
-             soci::into(sociTxnMetaBlob, tmi));
+             soci::into(sociTxnMetaBlob, tmi),
+             soci::into(txnSeq),
+             soci::into(transID));
 
         st.execute();
         while (st.fetch())
@@ -2651,6 +2742,11 @@ NetworkOPsImp::getServerInfo(bool human, bool admin, bool counters)
         {
             info[jss::pubkey_validator] = "none";
         }
+
+        Json::Value startup(Json::objectValue);
+        for (auto const& [step, took] : app_.getStartupTimes())
+            startup[step] = static_cast<Json::UInt>(took.count());
+        info[jss::startup_ms] = std::move(startup);
     }
 
     if (counters)
@@ -2893,6 +2989,7 @@ NetworkOPsImp::pubProposedTransaction(
 {
     Json::Value jvObj = transJson(*stTxn, terResult, false, lpCurrent);
 
+    std::vector<InfoSub::pointer> subscribers;
     {
         std::lock_guard sl(mSubLock);
 
@@ -2903,7 +3000,7 @@ NetworkOPsImp::pubProposedTransaction(
 
             if (p)
             {
-                p->send(jvObj, true);
+                subscribers.push_back(std::move(p));
                 ++it;
             }
             else
@@ -2912,6 +3009,8 @@ NetworkOPsImp::pubProposedTransaction(
             }
         }
     }
+    fanout_.publish(std::move(jvObj), std::move(subscribers));
+
     AcceptedLedgerTx alt(
         lpCurrent, stTxn, terResult, app_.accountIDCache(), app_.logs());
     JLOG(m_journal.trace()) << "pubProposed: " << alt.getJson();
@@ -2929,6 +3028,7 @@ NetworkOPsImp::forwardProposedTransaction(Json::Value const& jvObj)
     {
         std::lock_guard sl(mSubLock);
 
+        PublishedJson const msg(jvObj);
         auto it = mStreamMaps[sRTTransactions].begin();
         while (it != mStreamMaps[sRTTransactions].end())
         {
@@ -2936,7 +3036,7 @@ NetworkOPsImp::forwardProposedTransaction(Json::Value const& jvObj)
 
             if (p)
             {
-                p->send(jvObj, true);
+                p->publish(msg, true);
                 ++it;
             }
             else
@@ -3030,8 +3130,9 @@ NetworkOPsImp::forwardProposedAccountTransaction(Json::Value const& jvObj)
 
     if (!notify.empty())
     {
+        PublishedJson const msg(jvObj);
         for (InfoSub::ref isrListener : notify)
-            isrListener->send(jvObj, true);
+            isrListener->publish(msg, true);
     }
 }
 
@@ -3041,10 +3142,16 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
     // Ledgers are published only when they acquire sufficient validations
     // Holes are filled across connection loss or other catastrophe
 
+    auto& tracer = app_.getTracer();
+    perf::Tracer::Span span(
+        tracer, "pubLedger", "ledger", lpAccepted->info().seq);
+
     std::shared_ptr<AcceptedLedger> alpAccepted =
         app_.getAcceptedLedgerCache().fetch(lpAccepted->info().hash);
     if (!alpAccepted)
     {
+        perf::Tracer::Span acceptedSpan(
+            tracer, "AcceptedLedger", "ledger", lpAccepted->info().seq);
         alpAccepted = std::make_shared<AcceptedLedger>(lpAccepted, app_);
         app_.getAcceptedLedgerCache().canonicalize_replace_client(
             lpAccepted->info().hash, alpAccepted);
@@ -3053,7 +3160,7 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
     {
         JLOG(m_journal.debug())
             << "Publishing ledger = " << lpAccepted->info().seq;
-        std::lock_guard sl(mSubLock);
+        std::unique_lock sl(mSubLock);
 
         if (!mStreamMaps[sLedger].empty())
         {
@@ -3080,6 +3187,7 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
                     app_.getLedgerMaster().getCompleteLedgers();
             }
 
+            std::vector<InfoSub::pointer> subscribers;
             auto it = mStreamMaps[sLedger].begin();
             while (it != mStreamMaps[sLedger].end())
             {
@@ -3090,21 +3198,30 @@ NetworkOPsImp::pubLedger(std::shared_ptr<ReadView const> const& lpAccepted)
                         << "Publishing ledger = " << lpAccepted->info().seq
                         << " : consumer = " << p->getConsumer()
                         << " : obj = " << jvObj;
-                    p->send(jvObj, true);
+                    subscribers.push_back(std::move(p));
                     ++it;
                 }
                 else
                     it = mStreamMaps[sLedger].erase(it);
             }
+            sl.unlock();
+            fanout_.publish(std::move(jvObj), std::move(subscribers));
         }
     }
 
+    app_.getOrderBookDB().snapshot(lpAccepted);
+    app_.getIssuerBalances().setup(lpAccepted);
+
+    // Find who listens to the ledger's books once, not per transaction
+    auto const bookListeners =
+        app_.getOrderBookDB().getBookListeners(*alpAccepted);
+
     // Don't lock since pubAcceptedTransaction is locking.
     for (auto const& [_, accTx] : alpAccepted->getMap())
     {
         (void)_;
         JLOG(m_journal.trace()) << "pubAccepted: " << accTx->getJson();
-        pubValidatedTransaction(lpAccepted, *accTx);
+        pubValidatedTransaction(lpAccepted, *accTx, bookListeners);
     }
 }
 
@@ -3211,16 +3328,22 @@ NetworkOPsImp::transJson(
 void
 NetworkOPsImp::pubValidatedTransaction(
     std::shared_ptr<ReadView const> const& alAccepted,
-    const AcceptedLedgerTx& alTx)
+    const AcceptedLedgerTx& alTx,
+    OrderBookDB::BookToListenersMap const& bookListeners)
 {
-    std::shared_ptr<STTx const> stTxn = alTx.getTxn();
-    Json::Value jvObj = transJson(*stTxn, alTx.getResult(), true, alAccepted);
+    std::vector<InfoSub::pointer> subscribers;
 
-    if (auto const txMeta = alTx.getMeta())
+    // The subscribers to the books the transaction touched get it once,
+    // whichever of its books they follow, along with the stream
+    // subscribers so that the JSON is only serialized once.
+    if (!bookListeners.empty())
     {
-        jvObj[jss::meta] = txMeta->getJson(JsonOptions::none);
-        RPC::insertDeliveredAmount(
-            jvObj[jss::meta], *alAccepted, stTxn, *txMeta);
+        hash_set<std::uint64_t> havePublished;
+        for (auto const& book : alTx.getBooks())
+        {
+            if (auto it = bookListeners.find(book); it != bookListeners.end())
+                it->second->collect(subscribers, havePublished);
+        }
     }
 
     {
@@ -3233,7 +3356,7 @@ NetworkOPsImp::pubValidatedTransaction(
 
             if (p)
             {
-                p->send(jvObj, true);
+                subscribers.push_back(std::move(p));
                 ++it;
             }
             else
@@ -3248,14 +3371,50 @@ NetworkOPsImp::pubValidatedTransaction(
 
             if (p)
             {
-                p->send(jvObj, true);
+                subscribers.push_back(std::move(p));
                 ++it;
             }
             else
                 it = mStreamMaps[sRTTransactions].erase(it);
         }
+
+        // The filters are evaluated against what the transaction has,
+        // gathered once, and only those that could match are looked at
+        if (!mTransactionFilters.empty())
+        {
+            auto const subject = TransactionFilter::subjectOf(alTx);
+            for (auto const seq : mTransactionFilters.matches(subject))
+            {
+                auto const sub = mFilteredTransactions.find(seq);
+                if (sub == mFilteredTransactions.end())
+                    continue;
+
+                if (auto p = sub->second.lock())
+                    subscribers.push_back(std::move(p));
+                else
+                {
+                    mFilteredTransactions.erase(sub);
+                    mTransactionFilters.erase(seq);
+                }
+            }
+        }
+    }
+
+    if (!subscribers.empty())
+    {
+        std::shared_ptr<STTx const> stTxn = alTx.getTxn();
+        Json::Value jvObj =
+            transJson(*stTxn, alTx.getResult(), true, alAccepted);
+
+        if (auto const txMeta = alTx.getMeta())
+        {
+            jvObj[jss::meta] = txMeta->getJson(JsonOptions::none);
+            RPC::insertDeliveredAmount(
+                jvObj[jss::meta], *alAccepted, stTxn, *txMeta);
+        }
+
+        fanout_.publish(std::move(jvObj), std::move(subscribers));
     }
-    app_.getOrderBookDB().processTxn(alAccepted, alTx, jvObj);
     pubAccountTransaction(alAccepted, alTx, true);
 }
 
@@ -3344,8 +3503,9 @@ NetworkOPsImp::pubAccountTransaction(
             }
         }
 
-        for (InfoSub::ref isrListener : notify)
-            isrListener->send(jvObj, true);
+        fanout_.publish(
+            std::move(jvObj),
+            std::vector<InfoSub::pointer>(notify.begin(), notify.end()));
     }
 }
 
@@ -3570,9 +3730,25 @@ bool
 NetworkOPsImp::subTransactions(InfoSub::ref isrListener)
 {
     std::lock_guard sl(mSubLock);
-    return mStreamMaps[sTransactions]
-        .emplace(isrListener->getSeq(), isrListener)
-        .second;
+    auto const seq = isrListener->getSeq();
+    bool const filtered = mFilteredTransactions.erase(seq);
+    mTransactionFilters.erase(seq);
+    return mStreamMaps[sTransactions].emplace(seq, isrListener).second ||
+        filtered;
+}
+
+// <-- bool: true=added or replaced, false=already there unfiltered
+bool
+NetworkOPsImp::subTransactions(
+    InfoSub::ref isrListener,
+    std::shared_ptr<TransactionFilter const> filter)
+{
+    std::lock_guard sl(mSubLock);
+    auto const seq = isrListener->getSeq();
+    mStreamMaps[sTransactions].erase(seq);
+    mFilteredTransactions[seq] = isrListener;
+    mTransactionFilters.insert(seq, std::move(filter));
+    return true;
 }
 
 // <-- bool: true=erased, false=was not there
@@ -3580,7 +3756,9 @@ bool
 NetworkOPsImp::unsubTransactions(std::uint64_t uSeq)
 {
     std::lock_guard sl(mSubLock);
-    return mStreamMaps[sTransactions].erase(uSeq);
+    bool const filtered = mFilteredTransactions.erase(uSeq);
+    mTransactionFilters.erase(uSeq);
+    return mStreamMaps[sTransactions].erase(uSeq) || filtered;
 }
 
 // <-- bool: true=added, false=already there
@@ -3709,6 +3887,7 @@ NetworkOPsImp::getBookPage(
     Book const& book,
     AccountID const& uTakerID,
     bool const bProof,
+    bool const bBinary,
     unsigned int iLimit,
     Json::Value const& jvMarker,
     Json::Value& jvResult)
@@ -3839,7 +4018,16 @@ NetworkOPsImp::getBookPage(
                     }
                 }
 
-                Json::Value jvOffer = sleOffer->getJson(JsonOptions::none);
+                Json::Value jvOffer(Json::objectValue);
+                if (bBinary)
+                {
+                    jvOffer[jss::data] = serializeHex(*sleOffer);
+                    jvOffer[jss::index] = to_string(offerIndex);
+                }
+                else
+                {
+                    jvOffer = sleOffer->getJson(JsonOptions::none);
+                }
 
                 STAmount saTakerGetsFunded;
                 STAmount saOwnerFundsLimit = saOwnerFunds;
@@ -3928,6 +4116,7 @@ NetworkOPsImp::getBookPage(
     Book const& book,
     AccountID const& uTakerID,
     bool const bProof,
+    bool const bBinary,
     unsigned int iLimit,
     Json::Value const& jvMarker,
     Json::Value& jvResult)
@@ -3995,7 +4184,14 @@ NetworkOPsImp::getBookPage(
                 }
             }
 
-            Json::Value jvOffer = sleOffer->getJson(JsonOptions::none);
+            Json::Value jvOffer = bBinary
+                ? Json::Value(Json::objectValue)
+                : sleOffer->getJson(JsonOptions::none);
+            if (bBinary)
+            {
+                jvOffer[jss::data] = serializeHex(*sleOffer);
+                jvOffer[jss::index] = to_string(sleOffer->key());
+            }
 
             STAmount saTakerGetsFunded;
             STAmount saOwnerFundsLimit = saOwnerFunds;
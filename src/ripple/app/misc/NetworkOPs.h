@@ -162,6 +162,7 @@ public:
         Book const& book,
         AccountID const& uTakerID,
         bool const bProof,
+        bool const bBinary,
         unsigned int iLimit,
         Json::Value const& jvMarker,
         Json::Value& jvResult) = 0;
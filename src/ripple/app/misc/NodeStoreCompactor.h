@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_NODESTORECOMPACTOR_H_INCLUDED
+#define RIPPLE_APP_MISC_NODESTORECOMPACTOR_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/nodestore/Backend.h>
+#include <ripple/nodestore/Database.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+class WorkerPool;
+
+/** Reclaims the space of a node store that keeps every node forever.
+
+    A node store without online_delete, or one configured with it only
+    later, still holds every node of every ledger it ever saw. Compaction
+    finds the nodes that matter by marking everything reachable from the
+    ledgers to keep, then sweeps the source store, copying the marked
+    objects into a new backend. The source is only read, so the old store
+    stays whole until the operator switches to the new one.
+
+    Ledgers are marked on several threads. A node that is already marked
+    is not descended into, the way FullBelowCache stops a walk, so the
+    nodes ledgers share are read once however many ledgers hold them.
+*/
+class NodeStoreCompactor
+{
+public:
+    struct Counts
+    {
+        std::uint64_t objects = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    struct Sweep
+    {
+        Counts total;
+        Counts live;
+        // Live objects found in the source but not written
+        std::uint64_t failed = 0;
+    };
+
+    NodeStoreCompactor(NodeStore::Database& source, beast::Journal j);
+
+    /** Mark every node reachable from the ledgers.
+
+        @param ledgers The hashes of the ledgers to keep
+        @param workers The threads reading the source
+        @return The number of ledgers whose header was found
+    */
+    std::size_t
+    mark(std::vector<uint256> const& ledgers, WorkerPool& workers);
+
+    /** The nodes marked so far. */
+    Counts
+    marked() const;
+
+    /** The number of reachable nodes the source does not have. */
+    std::uint64_t
+    missing() const
+    {
+        return missing_;
+    }
+
+    /** Visit every object in the source, copying the live ones.
+
+        Objects are live if they are marked, or if they index a transaction
+        in a marked tree. Without a destination this only counts them.
+
+        @param dest The backend to copy live objects into, or nullptr
+    */
+    Sweep
+    sweep(NodeStore::Backend* dest);
+
+private:
+    // The marked hashes, split so threads rarely contend for one lock
+    struct Shard
+    {
+        std::mutex mutex;
+        hash_set<uint256> hashes;
+    };
+
+    static constexpr std::size_t shardCount = 64;
+
+    Shard&
+    shardFor(uint256 const& hash) const;
+
+    // Returns false if the hash was already marked
+    bool
+    insert(uint256 const& hash);
+
+    bool
+    isMarked(uint256 const& hash) const;
+
+    void
+    markLedger(uint256 const& ledgerHash);
+
+    void
+    markTree(uint256 const& root, std::uint32_t ledgerSeq);
+
+    NodeStore::Database& source_;
+    beast::Journal const j_;
+
+    mutable std::array<Shard, shardCount> shards_;
+    std::atomic<std::uint64_t> markedObjects_{0};
+    std::atomic<std::uint64_t> markedBytes_{0};
+    std::atomic<std::uint64_t> missing_{0};
+    std::atomic<std::size_t> ledgersFound_{0};
+};
+
+}  // namespace ripple
+
+#endif
@@ -20,14 +20,37 @@
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/SHAMapStoreImp.h>
+#include <ripple/app/misc/TxPartitions.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/core/ConfigSections.h>
 #include <ripple/core/Pg.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/impl/DatabaseRotatingImp.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
+#include <exception>
+#include <vector>
 
 namespace ripple {
+
+// Let the backend size its own cache around the tree node cache, which
+// holds about this much
+static void
+setTreeCacheBudget(Section& section, Config const& config)
+{
+    if (!section.exists("tree_cache_mb"))
+        section.set(
+            "tree_cache_mb",
+            std::to_string(
+                config.getValueFor(SizedItem::treeCacheSize) * 512 /
+                megabytes(1)));
+}
+
 void
 SHAMapStoreImp::SavedStateDB::init(
     BasicConfig const& config,
@@ -202,6 +225,9 @@ SHAMapStoreImp::SHAMapStoreImp(
         {
             backOff_ = std::chrono::milliseconds{temp};
         }
+        if (get_if_exists(section, "copy_threads", temp))
+            copyThreads_ = std::clamp<int>(temp, 1, 32);
+        get_if_exists(section, "copy_rate", copyRate_);
         if (get_if_exists(section, "age_threshold_seconds", temp))
             ageThreshold_ = std::chrono::seconds{temp};
         if (get_if_exists(section, "recovery_wait_seconds", temp))
@@ -246,6 +272,13 @@ SHAMapStoreImp::makeNodeStore(std::string const& name, std::int32_t readThreads)
                 "Reporting does not support online_delete. Remove "
                 "online_delete info from config");
         }
+        if (app_.config().section(ConfigSection::nodeDatabase()).exists(
+                "cold_path"))
+        {
+            Throw<std::runtime_error>(
+                "online_delete does not support a tiered node store. Remove "
+                "cold_path or online_delete from config");
+        }
         SavedState state = state_db_.getState();
         auto writableBackend = makeBackendRotating(state.writableDb);
         auto archiveBackend = makeBackendRotating(state.archiveDb);
@@ -272,6 +305,17 @@ SHAMapStoreImp::makeNodeStore(std::string const& name, std::int32_t readThreads)
     }
     else
     {
+        auto section = app_.config().section(ConfigSection::nodeDatabase());
+        setTreeCacheBudget(section, app_.config());
+        if (app_.config().reporting())
+        {
+            // Reads of ledgers recently written by the ETL process are served
+            // from memory instead of the remote backend
+            if (!section.exists("cache_size") && !section.exists("cache_age"))
+                section.set("cache_size", std::to_string(reportingCacheSize_));
+            if (!section.exists("cache_writes"))
+                section.set("cache_writes", "1");
+        }
         db = NodeStore::Manager::instance().make_Database(
             name,
             megabytes(
@@ -279,7 +323,7 @@ SHAMapStoreImp::makeNodeStore(std::string const& name, std::int32_t readThreads)
             scheduler_,
             readThreads,
             app_.getJobQueue(),
-            app_.config().section(ConfigSection::nodeDatabase()),
+            section,
             app_.logs().journal(nodeStoreName_));
         fdRequired_ += db->fdRequired();
     }
@@ -313,18 +357,178 @@ SHAMapStoreImp::fdRequired() const
     return fdRequired_;
 }
 
-bool
-SHAMapStoreImp::copyNode(std::uint64_t& nodeCount, SHAMapTreeNode const& node)
+std::uint64_t
+SHAMapStoreImp::copyState(SHAMap const& map)
 {
-    // Copy a single record from node to dbRotating_
-    dbRotating_->fetchNodeObject(node.getHash().as_uint256());
-    if (!(++nodeCount % checkHealthInterval_))
+    using namespace std::chrono;
+
+    std::atomic<bool> stop{false};
+    std::atomic<bool> paused{false};
+    std::atomic<std::uint64_t> nodeCount{0};
+
+    // Holds the threads, together, to the configured rate
+    auto const start = steady_clock::now();
+    auto pace = [&](std::uint64_t count) {
+        auto const copied = nodeCount += count;
+        if (copyRate_ != 0)
+        {
+            auto const due = start +
+                duration_cast<steady_clock::duration>(duration<double>(
+                    static_cast<double>(copied) / copyRate_));
+            if (due > steady_clock::now())
+                std::this_thread::sleep_until(due);
+        }
+        return copied;
+    };
+
+    // Copy a node. Reading it through the rotating database stores it in
+    // the writable backend if it was only in the archive. Returns the
+    // node if it is an inner one, so its children can be copied too.
+    auto copy = [&](SHAMapHash const& hash) {
+        auto const obj = dbRotating_->fetchNodeObject(hash.as_uint256());
+        if (!obj)
+            Throw<SHAMapMissingNode>(SHAMapType::STATE, hash);
+
+        auto const& data = obj->getData();
+        std::shared_ptr<SHAMapInnerNode> inner;
+        if (data.size() >= 4 &&
+            ((std::uint32_t(data[0]) << 24) | (std::uint32_t(data[1]) << 16) |
+             (std::uint32_t(data[2]) << 8) | std::uint32_t(data[3])) ==
+                static_cast<std::uint32_t>(HashPrefix::innerNode))
+        {
+            inner = std::static_pointer_cast<SHAMapInnerNode>(
+                SHAMapTreeNode::makeFromPrefix(data, hash));
+        }
+        return inner;
+    };
+
+    // Copy the children of an inner node, keeping the inner ones unless
+    // they are already copied
+    auto children = [&](SHAMapInnerNode const& node,
+                        std::vector<std::shared_ptr<SHAMapInnerNode>>& inner) {
+        std::uint64_t count = 0;
+        for (int i = 0; i < SHAMap::branchFactor && !stop; ++i)
+        {
+            if (node.isEmptyBranch(i))
+                continue;
+            auto const& hash = node.getChildHash(i);
+            if (copied_.count(hash.as_uint256()))
+                continue;
+            if (auto child = copy(hash))
+                inner.push_back(std::move(child));
+            ++count;
+        }
+        return count;
+    };
+
+    if (map.getHash().isZero())
+        return 0;
+
+    auto root = copy(map.getHash());
+    pace(1);
+    if (!root)
+        return nodeCount;
+
+    // Share out subtrees from far enough down that every thread has
+    // plenty to do. Each is remembered once copied, so that a copy cut
+    // short by poor health does not start over at the next ledger.
+    std::vector<std::shared_ptr<SHAMapInnerNode>> work{std::move(root)};
+    while (!work.empty() &&
+           work.size() <
+               std::max<std::size_t>(
+                   copyThreads_ * SHAMap::branchFactor, copySubtrees_))
     {
+        std::vector<std::shared_ptr<SHAMapInnerNode>> below;
+        for (auto const& node : work)
+            pace(children(*node, below));
+        work = std::move(below);
+
+        if (health())
+            return nodeCount;
+    }
+
+    // Health is checked by one thread at a time, at most once every
+    // copyHealthInterval_, while the other threads wait it out
+    std::mutex healthMutex;
+    auto nextHealthCheck = steady_clock::now() + copyHealthInterval_;
+    auto checkHealth = [&]() {
+        std::unique_lock lock(healthMutex, std::try_to_lock);
+        if (!lock.owns_lock() || steady_clock::now() < nextHealthCheck)
+            return;
+        paused = true;
         if (health())
-            return false;
+            stop = true;
+        paused = false;
+        nextHealthCheck = steady_clock::now() + copyHealthInterval_;
+    };
+
+    std::mutex doneMutex;
+    std::vector<uint256> done;
+
+    auto walk = [&](std::size_t i) {
+        NodeStore::ScopedFetchCaller const fetchCaller(
+            NodeStore::FetchCaller::onlineDelete);
+        try
+        {
+            std::uint64_t sinceCheck = 0;
+            std::vector<std::shared_ptr<SHAMapInnerNode>> stack{work[i]};
+            while (!stack.empty() && !stop)
+            {
+                auto node = std::move(stack.back());
+                stack.pop_back();
+                auto const count = children(*node, stack);
+                sinceCheck += count;
+                pace(count);
+
+                if (sinceCheck < checkHealthInterval_)
+                    continue;
+                sinceCheck = 0;
+                checkHealth();
+
+                // Give the batch writer a chance to drain before copying
+                // more, and wait out health checks
+                if (auto const load = dbRotating_->getWriteLoad();
+                    load > writeLoadBackOff_)
+                {
+                    JLOG(journal_.debug())
+                        << "copyState backing off, write load " << load;
+                    std::this_thread::sleep_for(backOff_);
+                }
+                while (paused && !stop)
+                    std::this_thread::sleep_for(backOff_);
+            }
+        }
+        catch (...)
+        {
+            stop = true;
+            throw;
+        }
+
+        if (!stop)
+        {
+            std::lock_guard lock(doneMutex);
+            done.push_back(work[i]->getHash().as_uint256());
+        }
+    };
+
+    // The subtrees are spread over at most copyThreads_ threads
+    std::exception_ptr error;
+    try
+    {
+        app_.getWorkerPool().run(
+            work.size(), walk, (work.size() + copyThreads_ - 1) / copyThreads_);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
     }
 
-    return true;
+    // Only added now, as the threads look subtrees up without a lock
+    copied_.insert(done.begin(), done.end());
+
+    if (error)
+        std::rethrow_exception(error);
+    return nodeCount;
 }
 
 void
@@ -338,6 +542,8 @@ SHAMapStoreImp::run()
             "online_delete info from config");
     }
     beast::setCurrentThreadName("SHAMapStore");
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::onlineDelete);
     LedgerIndex lastRotated = state_db_.getState().lastRotated;
     netOPs_ = &app_.getOPs();
     ledgerMaster_ = &app_.getLedgerMaster();
@@ -373,6 +579,9 @@ SHAMapStoreImp::run()
         }
 
         LedgerIndex const validatedSeq = validatedLedger->info().seq;
+
+        // Copying the ledger's nodes reads them from the node store
+        validatedLedger->storeDeferredWrites();
         if (!lastRotated)
         {
             lastRotated = validatedSeq;
@@ -403,12 +612,7 @@ SHAMapStoreImp::run()
             }
 
             JLOG(journal_.debug()) << "copying ledger " << validatedSeq;
-            std::uint64_t nodeCount = 0;
-            validatedLedger->stateMap().snapShot(false)->visitNodes(std::bind(
-                &SHAMapStoreImp::copyNode,
-                this,
-                std::ref(nodeCount),
-                std::placeholders::_1));
+            auto const nodeCount = copyState(validatedLedger->stateMap());
             switch (health())
             {
                 case Health::stopping:
@@ -469,6 +673,7 @@ SHAMapStoreImp::run()
 
                     return std::move(newBackend);
                 });
+            copied_.clear();
 
             JLOG(journal_.warn()) << "finished rotation " << validatedSeq;
         }
@@ -581,6 +786,7 @@ SHAMapStoreImp::makeBackendRotating(std::string path)
         newPath = boost::filesystem::unique_path(p);
     }
     section.set("path", newPath.string());
+    setTreeCacheBudget(section, app_.config());
 
     auto backend{NodeStore::Manager::instance().make_Backend(
         section,
@@ -699,21 +905,29 @@ SHAMapStoreImp::clearPrior(LedgerIndex lastRotated)
     if (!app_.config().useTxTables())
         return;
 
-    clearSql(
-        *transactionDb_,
-        lastRotated,
-        "SELECT MIN(LedgerSeq) FROM Transactions;",
-        "DELETE FROM Transactions WHERE LedgerSeq < %u;");
+    // Whole partitions go at once, leaving few rows to delete one batch
+    // at a time
+    auto& partitions = app_.getTxPartitions();
+    if (auto const retired = partitions.retire(lastRotated))
+        JLOG(journal_.debug()) << "Retired " << retired
+                               << " transaction database partitions";
     if (health())
         return;
 
-    clearSql(
-        *transactionDb_,
-        lastRotated,
-        "SELECT MIN(LedgerSeq) FROM AccountTransactions;",
-        "DELETE FROM AccountTransactions WHERE LedgerSeq < %u;");
-    if (health())
-        return;
+    for (auto const& schema : partitions.schemas())
+    {
+        for (std::string const table : {"Transactions", "AccountTransactions"})
+        {
+            auto const qualified = schema + "." + table;
+            clearSql(
+                *transactionDb_,
+                lastRotated,
+                "SELECT MIN(LedgerSeq) FROM " + qualified + ";",
+                "DELETE FROM " + qualified + " WHERE LedgerSeq < %u;");
+            if (health())
+                return;
+        }
+    }
 }
 
 SHAMapStoreImp::Health
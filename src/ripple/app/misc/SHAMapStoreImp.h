@@ -22,6 +22,7 @@
 
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/misc/SHAMapStore.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/nodestore/DatabaseRotating.h>
@@ -83,10 +84,18 @@ private:
     std::string const dbPrefix_ = "rippledb";
     // check health/stop status as records are copied
     std::uint64_t const checkHealthInterval_ = 1000;
+    // pause copying while this many writes are queued in the backend
+    static int const writeLoadBackOff_ = 8192;
+    // subtrees of the state tree shared out among the copying threads
+    static std::size_t const copySubtrees_ = 4096;
+    // how often the copying threads are stopped to check health
+    static constexpr std::chrono::milliseconds copyHealthInterval_{100};
     // minimum # of ledgers to maintain for health of network
     static std::uint32_t const minimumDeletionInterval_ = 256;
     // minimum # of ledgers required for standalone mode.
     static std::uint32_t const minimumDeletionIntervalSA_ = 8;
+    // node store cache entries in reporting mode, unless configured
+    static int const reportingCacheSize_ = 262144;
     // minimum ledger to maintain online.
     std::atomic<LedgerIndex> minimumOnline_{};
 
@@ -110,6 +119,8 @@ private:
     std::uint32_t deleteBatch_ = 100;
     std::chrono::milliseconds backOff_{100};
     std::chrono::seconds ageThreshold_{60};
+    int copyThreads_ = 4;
+    std::size_t copyRate_ = 0;
     /// If set, and the node is out of sync during an
     /// online_delete health check, sleep the thread
     /// for this time and check again so the node can
@@ -126,6 +137,10 @@ private:
     DatabaseCon* transactionDb_ = nullptr;
     DatabaseCon* ledgerDb_ = nullptr;
 
+    // Subtrees of the state tree copied into the writable backend since
+    // the last rotation. Only used by run().
+    hash_set<uint256> copied_;
+
     static constexpr auto nodeStoreName_ = "NodeStore";
 
 public:
@@ -193,9 +208,10 @@ public:
     minimumOnline() const override;
 
 private:
-    // callback for visitNodes
-    bool
-    copyNode(std::uint64_t& nodeCount, SHAMapTreeNode const& node);
+    // Copy every node of a state tree into the writable backend,
+    // returning the number of nodes copied
+    std::uint64_t
+    copyState(SHAMap const& map);
     void
     run();
     void
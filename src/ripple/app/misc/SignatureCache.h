@@ -0,0 +1,136 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_SIGNATURECACHE_H_INCLUDED
+#define RIPPLE_APP_MISC_SIGNATURECACHE_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Remembers signatures that were verified and found good.
+
+    The same signature can reach the signature checks along several paths:
+    a transaction is checked when it is received, again when a ledger is
+    built from a consensus set and again when a ledger is replayed, once
+    the HashRouter has forgotten it. Proposals and validations are checked
+    each time they arrive. Each path consults this cache first, so the
+    cryptography is done once per signature.
+
+    Entries are keyed by the signed digest, the public key and the
+    signature, see key(). Only good signatures are remembered. The cache
+    holds a fixed number of entries and evicts the oldest first.
+*/
+class SignatureCache
+{
+public:
+    static constexpr std::size_t defaultCapacity = 65536;
+
+    explicit SignatureCache(std::size_t capacity = defaultCapacity);
+
+    SignatureCache(SignatureCache const&) = delete;
+    SignatureCache&
+    operator=(SignatureCache const&) = delete;
+
+    /** Returns the key for a signature by a public key over a digest.
+
+        @param extra Anything else the outcome of the check depends on,
+                     such as whether a fully canonical signature was
+                     required.
+    */
+    static uint256
+    key(uint256 const& digest,
+        Slice const& publicKey,
+        Slice const& signature,
+        std::uint8_t extra = 0);
+
+    /** Returns `true` if the signature with this key is known good.
+
+        Counts a hit or a miss.
+    */
+    bool
+    contains(uint256 const& key);
+
+    /** Remembers that the signature with this key is good. */
+    void
+    insert(uint256 const& key);
+
+    /** Returns `true` if the signature is known good or `check` says so.
+
+        `check` is only called on a miss, and a good outcome is
+        remembered.
+    */
+    template <class Check>
+    bool
+    verify(uint256 const& key, Check&& check)
+    {
+        if (contains(key))
+            return true;
+        if (!check())
+            return false;
+        insert(key);
+        return true;
+    }
+
+    std::size_t
+    size() const;
+
+    std::uint64_t
+    hits() const
+    {
+        return hits_;
+    }
+
+    std::uint64_t
+    misses() const
+    {
+        return misses_;
+    }
+
+    /** Returns the fraction of lookups that were hits. */
+    float
+    rate() const;
+
+    Json::Value
+    getJson() const;
+
+private:
+    std::size_t const capacity_;
+
+    std::mutex mutable mutex_;
+    hash_set<uint256> entries_;
+    // Keys in the order they were inserted, oldest at next_ once full
+    std::vector<uint256> order_;
+    std::size_t next_ = 0;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
+
+}  // namespace ripple
+
+#endif
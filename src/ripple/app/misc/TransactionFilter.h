@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_TRANSACTIONFILTER_H_INCLUDED
+#define RIPPLE_APP_MISC_TRANSACTIONFILTER_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/Book.h>
+#include <ripple/protocol/STAmount.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/TxFormats.h>
+#include <boost/container/flat_set.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+class AcceptedLedgerTx;
+
+/** Selects the validated transactions a subscriber is sent.
+
+    A filter holds up to five predicates: transaction types, accounts,
+    currencies, order books and a minimum amount. A transaction matches
+    when it satisfies every predicate that is set, and it satisfies a
+    set when it has any member of it:
+
+        - its type is one of the types
+        - it affected one of the accounts
+        - one of its amounts, other than the fee, is in one of the
+          currencies
+        - it created, modified or deleted an offer in one of the books
+        - its Amount field is in the issue of the minimum and at least
+          as large as it
+
+    A filter with no predicates matches every transaction.
+*/
+class TransactionFilter
+{
+public:
+    /** What a filter is evaluated against, gathered once per transaction.
+     */
+    struct Subject
+    {
+        TxType type = ttINVALID;
+        boost::container::flat_set<AccountID> accounts;
+        boost::container::flat_set<Book> books;
+        boost::container::flat_set<Currency> currencies;
+        boost::optional<STAmount> amount;
+    };
+
+    static Subject
+    subjectOf(AcceptedLedgerTx const& tx);
+
+    static Subject
+    subjectOf(
+        STTx const& tx,
+        boost::container::flat_set<AccountID> affected,
+        std::vector<Book> const& books);
+
+    void
+    addType(TxType type)
+    {
+        types_.insert(type);
+    }
+
+    void
+    addAccount(AccountID const& account)
+    {
+        accounts_.insert(account);
+    }
+
+    void
+    addCurrency(Currency const& currency)
+    {
+        currencies_.insert(currency);
+    }
+
+    void
+    addBook(Book const& book)
+    {
+        books_.insert(book);
+    }
+
+    void
+    setMinAmount(STAmount const& amount)
+    {
+        minAmount_ = amount;
+    }
+
+    bool
+    empty() const
+    {
+        return types_.empty() && accounts_.empty() && currencies_.empty() &&
+            books_.empty() && !minAmount_;
+    }
+
+    bool
+    matches(Subject const& subject) const;
+
+private:
+    friend class TransactionFilterIndex;
+
+    boost::container::flat_set<TxType> types_;
+    boost::container::flat_set<AccountID> accounts_;
+    boost::container::flat_set<Currency> currencies_;
+    boost::container::flat_set<Book> books_;
+    boost::optional<STAmount> minAmount_;
+};
+
+/** The filters of the subscribers to the transactions stream.
+
+    Each filter is listed under the members of its most selective
+    predicate: its accounts, else its books, its currencies or its
+    types. The filters a transaction could match are then found by
+    looking up what the transaction has, and only those are evaluated,
+    so the work per transaction follows the subscribers it may go to
+    rather than all of them.
+*/
+class TransactionFilterIndex
+{
+public:
+    /** Add or replace the filter of a subscriber. */
+    void
+    insert(
+        std::uint64_t seq,
+        std::shared_ptr<TransactionFilter const> filter);
+
+    /** Remove the filter of a subscriber.
+
+        @return whether the subscriber had one
+    */
+    bool
+    erase(std::uint64_t seq);
+
+    bool
+    empty() const
+    {
+        return filters_.empty();
+    }
+
+    std::size_t
+    size() const
+    {
+        return filters_.size();
+    }
+
+    /** The subscribers whose filters match, each listed once. */
+    std::vector<std::uint64_t>
+    matches(TransactionFilter::Subject const& subject) const;
+
+private:
+    // Call f with the lists a filter belongs in and each of its keys
+    // there, returning false if it belongs in none
+    template <class F>
+    bool
+    forEachList(TransactionFilter const& filter, F&& f);
+
+    hash_map<std::uint64_t, std::shared_ptr<TransactionFilter const>>
+        filters_;
+    hash_map<AccountID, hash_set<std::uint64_t>> byAccount_;
+    hash_map<Book, hash_set<std::uint64_t>> byBook_;
+    hash_map<Currency, hash_set<std::uint64_t>> byCurrency_;
+    hash_map<std::uint16_t, hash_set<std::uint64_t>> byType_;
+    // The filters with only a minimum amount, or no predicates
+    hash_set<std::uint64_t> rest_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_TXPARTITIONS_H_INCLUDED
+#define RIPPLE_APP_MISC_TXPARTITIONS_H_INCLUDED
+
+#include <ripple/basics/Log.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/protocol/Protocol.h>
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+/** Splits the transaction database into files by range of ledgers.
+
+    The rows of the Transactions and AccountTransactions tables for each
+    range are kept in a file of their own, attached to every connection
+    of the transaction database as "tx<first ledger>". Temporary views
+    named after the tables combine the partitions with the rows in the
+    main file, so queries read them as before. Writes must name the
+    schema that holds the ledger.
+
+    Online deletion then retires a range by detaching and removing its
+    file, instead of deleting its rows one batch at a time.
+
+    Every connection also gets the view AccountTxJoined, which joins the
+    two tables within each file. Account transaction queries read it,
+    because SQLite can only merge a union that is not part of a join.
+*/
+class TxPartitions
+{
+public:
+    /** The most partitions attached at once. SQLite allows ten. */
+    static constexpr std::size_t maxPartitions = 8;
+
+    /** Attach the partitions found next to the transaction database.
+
+        @param db the transaction database
+        @param dataDir the directory holding the database
+        @param pragmas the pragmas the database was opened with
+        @param ledgers the ledgers in each new partition, or zero to write
+                       every ledger to the main file
+    */
+    TxPartitions(
+        DatabaseCon& db,
+        boost::filesystem::path const& dataDir,
+        std::vector<std::string> pragmas,
+        std::uint32_t ledgers,
+        beast::Journal journal);
+
+    /** The schema that holds the rows of a ledger.
+
+        A partition is created for the ledger if it falls in no existing
+        one, unless it is older than all of them. Call with the writer's
+        session checked out, outside any transaction.
+    */
+    std::string
+    schemaFor(LedgerIndex seq);
+
+    /** The schemas that may hold rows, "main" first. */
+    std::vector<std::string>
+    schemas() const;
+
+    /** Remove the partitions holding only ledgers before a given one.
+
+        The newest partition is kept.
+
+        @return the number of partitions removed
+    */
+    std::size_t
+    retire(LedgerIndex before);
+
+private:
+    static std::string
+    schema(LedgerIndex first);
+
+    boost::filesystem::path
+    path(LedgerIndex first) const;
+
+    // Create a partition's file and attach it
+    void
+    create(LedgerIndex first);
+
+    void
+    attach(soci::session& session, LedgerIndex first) const;
+
+    // Replace the temporary views on a connection
+    void
+    createViews(soci::session& session) const;
+
+    DatabaseCon& db_;
+    boost::filesystem::path const dataDir_;
+    std::vector<std::string> const pragmas_;
+    std::uint32_t const ledgers_;
+    beast::Journal const j_;
+
+    // Taken after the writer's session, never before
+    std::mutex mutable mutex_;
+    // The first ledger of each partition
+    std::set<LedgerIndex> partitions_;
+    bool warned_ = false;
+};
+
+}  // namespace ripple
+
+#endif
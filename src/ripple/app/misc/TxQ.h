@@ -28,6 +28,7 @@
 #include <ripple/protocol/TER.h>
 #include <boost/circular_buffer.hpp>
 #include <boost/intrusive/set.hpp>
+#include <vector>
 
 namespace ripple {
 
@@ -273,6 +274,23 @@ public:
         ApplyFlags flags,
         beast::Journal j);
 
+    /**
+        As above, reusing the result of running `preflight` on the
+        transaction earlier, which does not need the open ledger and so
+        can be done outside of any lock. Preflight is run again if the
+        rules have changed since.
+
+        @param preflightResult The result of `preflight` for `tx`, with
+               the flags it is to be applied with.
+    */
+    std::pair<TER, bool>
+    apply(
+        Application& app,
+        OpenView& view,
+        std::shared_ptr<STTx const> const& tx,
+        PreflightResult const& preflightResult,
+        beast::Journal j);
+
     /**
         Fill the new open ledger with transactions from the queue.
 
@@ -512,6 +530,12 @@ private:
         /// to put each MaybeTx object into more than one
         /// set without copies, pointers, etc.
         boost::intrusive::set_member_hook<> byFeeListHook;
+        /// Used by the TxQ::ExpirationMultiSet below to index the
+        /// transactions which have a `lastValid`. Unlinks itself
+        /// when the MaybeTx is destroyed.
+        boost::intrusive::set_member_hook<
+            boost::intrusive::link_mode<boost::intrusive::auto_unlink>>
+            byExpirationHook;
 
         /// The complete transaction.
         std::shared_ptr<STTx const> txn;
@@ -627,6 +651,21 @@ private:
         }
     };
 
+    /// Used for sorting @ref MaybeTx by `lastValid`
+    class EarlierExpiration
+    {
+    public:
+        /// Default constructor
+        explicit EarlierExpiration() = default;
+
+        /// Does `lhs` expire before `rhs`? Both must have a `lastValid`.
+        bool
+        operator()(const MaybeTx& lhs, const MaybeTx& rhs) const
+        {
+            return *lhs.lastValid < *rhs.lastValid;
+        }
+    };
+
     /** Used to represent an account to the queue, and stores the
         transactions queued for that account by SeqProxy.
     */
@@ -706,7 +745,7 @@ private:
         Application& app,
         OpenView& view,
         std::shared_ptr<STTx const> const& tx,
-        ApplyFlags flags,
+        PreflightResult const& pfresult,
         beast::Journal j);
 
     // Helper function that removes a replaced entry in _byFee.
@@ -723,6 +762,18 @@ private:
     using FeeMultiSet = boost::intrusive::
         multiset<MaybeTx, FeeHook, boost::intrusive::compare<GreaterFee>>;
 
+    using ExpirationHook = boost::intrusive::member_hook<
+        MaybeTx,
+        boost::intrusive::set_member_hook<
+            boost::intrusive::link_mode<boost::intrusive::auto_unlink>>,
+        &MaybeTx::byExpirationHook>;
+
+    using ExpirationMultiSet = boost::intrusive::multiset<
+        MaybeTx,
+        ExpirationHook,
+        boost::intrusive::compare<EarlierExpiration>,
+        boost::intrusive::constant_time_size<false>>;
+
     using AccountMap = std::map<AccountID, TxQAccount>;
 
     /// Setup parameters used to control the behavior of the queue
@@ -741,6 +792,13 @@ private:
         locked mutex_
     */
     FeeMultiSet byFee_;
+    /** The queued transactions which have a `lastValid`, ordered by
+        it, so that expired ones are found without visiting the whole
+        queue. Must outlive byAccount_, which owns the entries.
+        @note This member must always and only be accessed under
+        locked mutex_
+    */
+    ExpirationMultiSet byExpiration_;
     /** All of the accounts which currently have any transactions
         in the queue. Entries are created and destroyed dynamically
         as transactions are added and removed.
@@ -748,6 +806,13 @@ private:
         locked mutex_
     */
     AccountMap byAccount_;
+    /** Accounts which may have been left without any transactions
+        since the last ledger closed. They are removed from byAccount_
+        then, rather than while callers may hold iterators into it.
+        @note This member must always and only be accessed under
+        locked mutex_
+    */
+    std::vector<AccountID> emptiedAccounts_;
     /** Maximum number of transactions allowed in the queue based
         on the current metrics. If uninitialized, there is no limit,
         but that condition cannot last for long in practice.
@@ -252,6 +252,9 @@ class ValidatorList
     // The master public keys of the current negative UNL
     hash_set<PublicKey> negativeUNL_;
 
+    // Outcomes of recent checks of published list signatures
+    SignatureCheckCache mutable checkedBlobs_{256};
+
     // Currently supported versions of publisher list format
     static constexpr std::uint32_t supportedListVersions[]{1, 2};
     // In the initial release, to prevent potential abuse and attacks, any VL
@@ -841,6 +844,32 @@ private:
     void
     cacheValidatorFile(lock_guard const& lock, PublicKey const& pubKey) const;
 
+    /** Check a published list's signature, remembering the outcome.
+
+        @par Thread Safety
+
+        May be called concurrently
+    */
+    bool
+    checkBlobSignature(
+        PublicKey const& signingKey,
+        Slice const& data,
+        Slice const& signature) const;
+
+    /** Verify the signatures of published lists before applying them.
+
+        The outcomes are remembered, so applying the lists under the
+        exclusive lock does not verify them again.
+
+        @par Thread Safety
+
+        May be called concurrently
+    */
+    void
+    checkSignatures(
+        std::string const& manifest,
+        std::vector<ValidatorBlobInfo> const& blobs) const;
+
     /** Check response for trusted valid published list
 
         @return `ListDisposition::accepted` if list can be applied
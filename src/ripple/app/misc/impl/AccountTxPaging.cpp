@@ -103,12 +103,14 @@ accountTxPage(
     // marker is also an output parameter, so need to reset
     marker.reset();
 
+    // The view joins the tables within each partition of the database.
+    // Every ORDER BY term below is a result column, so SQLite merges the
+    // partitions in order.
     static std::string const prefix(
         R"(SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,
           Status,RawTxn,TxnMeta
-          FROM AccountTransactions INNER JOIN Transactions
-          ON Transactions.TransID = AccountTransactions.TransID
-          AND AccountTransactions.Account = '%s' WHERE
+          FROM AccountTxJoined AS AccountTransactions
+          WHERE AccountTransactions.Account = '%s' AND
           )");
 
     std::string sql;
@@ -127,26 +129,19 @@ accountTxPage(
     }
     else if (forward && (findLedger != 0))
     {
-        auto b58acct = idCache.toBase58(account);
+        // Seek straight to the marker in AcctTxIndex; comparing the
+        // (LedgerSeq, TxnSeq) pair keeps the scan a single index range
+        // however deep the page is.
         sql = boost::str(
-            boost::format((
-                R"(SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,
-            Status,RawTxn,TxnMeta
-            FROM AccountTransactions, Transactions WHERE
-            (AccountTransactions.TransID = Transactions.TransID AND
-            AccountTransactions.Account = '%s' AND
-            AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u')
-            OR
-            (AccountTransactions.TransID = Transactions.TransID AND
-            AccountTransactions.Account = '%s' AND
-            AccountTransactions.LedgerSeq = '%u' AND
-            AccountTransactions.TxnSeq >= '%u')
-            ORDER BY AccountTransactions.LedgerSeq ASC,
-            AccountTransactions.TxnSeq ASC
-            LIMIT %u;
-            )")) %
-            b58acct % (findLedger + 1) % maxLedger % b58acct % findLedger %
-            findSeq % queryLimit);
+            boost::format(
+                prefix + (R"((AccountTransactions.LedgerSeq,
+             AccountTransactions.TxnSeq) >= (%u, %u) AND
+             AccountTransactions.LedgerSeq <= %u
+             ORDER BY AccountTransactions.LedgerSeq ASC,
+             AccountTransactions.TxnSeq ASC
+             LIMIT %u;)")) %
+            idCache.toBase58(account) % findLedger % findSeq % maxLedger %
+            queryLimit);
     }
     else if (!forward && (findLedger == 0))
     {
@@ -160,26 +155,16 @@ accountTxPage(
     }
     else if (!forward && (findLedger != 0))
     {
-        auto b58acct = idCache.toBase58(account);
         sql = boost::str(
-            boost::format((
-                R"(SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,
-            Status,RawTxn,TxnMeta
-            FROM AccountTransactions, Transactions WHERE
-            (AccountTransactions.TransID = Transactions.TransID AND
-            AccountTransactions.Account = '%s' AND
-            AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u')
-            OR
-            (AccountTransactions.TransID = Transactions.TransID AND
-            AccountTransactions.Account = '%s' AND
-            AccountTransactions.LedgerSeq = '%u' AND
-            AccountTransactions.TxnSeq <= '%u')
-            ORDER BY AccountTransactions.LedgerSeq DESC,
-            AccountTransactions.TxnSeq DESC
-            LIMIT %u;
-            )")) %
-            b58acct % minLedger % (findLedger - 1) % b58acct % findLedger %
-            findSeq % queryLimit);
+            boost::format(
+                prefix + (R"((AccountTransactions.LedgerSeq,
+             AccountTransactions.TxnSeq) <= (%u, %u) AND
+             AccountTransactions.LedgerSeq >= %u
+             ORDER BY AccountTransactions.LedgerSeq DESC,
+             AccountTransactions.TxnSeq DESC
+             LIMIT %u;)")) %
+            idCache.toBase58(account) % findLedger % findSeq % minLedger %
+            queryLimit);
     }
     else
     {
@@ -189,7 +174,7 @@ accountTxPage(
     }
 
     {
-        auto db(connection.checkoutDb());
+        auto db(connection.checkoutReadDb());
 
         Blob rawData;
         Blob rawMeta;
@@ -26,6 +26,7 @@
 #include <ripple/json/json_reader.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/Sign.h>
+#include <ripple/protocol/digest.h>
 #include <boost/algorithm/clamp.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/regex.hpp>
@@ -336,25 +337,28 @@ ManifestCache::revoked(PublicKey const& pk) const
     return false;
 }
 
+bool
+ManifestCache::checkSignatures(Manifest const& m) const
+{
+    auto const digest = sha512Half(makeSlice(m.serialized));
+    if (auto const valid = checked_.find(digest))
+        return *valid;
+
+    auto const valid = m.verify();
+    checked_.insert(digest, valid);
+    return valid;
+}
+
 ManifestDisposition
 ManifestCache::applyManifest(Manifest m)
 {
-    std::lock_guard applyLock{apply_mutex_};
-
-    /*
-        before we spend time checking the signature, make sure the
-        sequence number is newer than any we have.
-    */
-    auto const iter = map_.find(m.masterKey);
+    // A manifest was received for a validator we're tracking, but its
+    // sequence number is not higher than the one already stored. This
+    // will happen normally when a peer without the latest gossip connects.
+    auto const stale = [this, &m](auto const& iter) {
+        if (iter == map_.end() || m.sequence > iter->second.sequence)
+            return false;
 
-    if (iter != map_.end() && m.sequence <= iter->second.sequence)
-    {
-        /*
-            A manifest was received for a validator we're tracking, but
-            its sequence number is not higher than the one already stored.
-            This will happen normally when a peer without the latest gossip
-            connects.
-        */
         if (auto stream = j_.debug())
             logMftAct(
                 stream,
@@ -362,10 +366,22 @@ ManifestCache::applyManifest(Manifest m)
                 m.masterKey,
                 m.sequence,
                 iter->second.sequence);
-        return ManifestDisposition::stale;  // not a newer manifest, ignore
+        return true;
+    };
+
+    /*
+        before we spend time checking the signature, make sure the
+        sequence number is newer than any we have.
+    */
+    {
+        std::lock_guard applyLock{apply_mutex_};
+        if (stale(map_.find(m.masterKey)))
+            return ManifestDisposition::stale;  // not a newer manifest, ignore
     }
 
-    if (!m.verify())
+    // Verify without the lock, so that manifests for other validators
+    // can be applied meanwhile.
+    if (!checkSignatures(m))
     {
         /*
           A manifest's signature is invalid.
@@ -376,6 +392,13 @@ ManifestCache::applyManifest(Manifest m)
         return ManifestDisposition::invalid;
     }
 
+    std::lock_guard applyLock{apply_mutex_};
+
+    // A newer manifest may have been applied while this one was verified
+    auto const iter = map_.find(m.masterKey);
+    if (stale(iter))
+        return ManifestDisposition::stale;
+
     std::lock_guard readLock{read_mutex_};
 
     bool const revoked = m.revoked();
@@ -0,0 +1,221 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/InboundLedger.h>
+#include <ripple/app/ledger/TxIndex.h>
+#include <ripple/app/misc/NodeStoreCompactor.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
+
+namespace ripple {
+
+NodeStoreCompactor::NodeStoreCompactor(
+    NodeStore::Database& source,
+    beast::Journal j)
+    : source_(source), j_(j)
+{
+}
+
+NodeStoreCompactor::Shard&
+NodeStoreCompactor::shardFor(uint256 const& hash) const
+{
+    // Node hashes are uniformly distributed
+    return shards_[hash.data()[0] % shardCount];
+}
+
+bool
+NodeStoreCompactor::insert(uint256 const& hash)
+{
+    auto& shard = shardFor(hash);
+    std::lock_guard lock(shard.mutex);
+    return shard.hashes.insert(hash).second;
+}
+
+bool
+NodeStoreCompactor::isMarked(uint256 const& hash) const
+{
+    auto& shard = shardFor(hash);
+    std::lock_guard lock(shard.mutex);
+    return shard.hashes.count(hash) != 0;
+}
+
+void
+NodeStoreCompactor::markTree(uint256 const& root, std::uint32_t ledgerSeq)
+{
+    std::vector<uint256> stack{root};
+
+    while (!stack.empty())
+    {
+        auto const hash = stack.back();
+        stack.pop_back();
+
+        // Whoever marked a node first walks the nodes below it
+        if (!insert(hash))
+            continue;
+
+        bool const found = source_.fetchNodePayload(
+            hash, ledgerSeq, [&](Slice data) {
+                ++markedObjects_;
+                markedBytes_ += data.size();
+
+                auto const node =
+                    SHAMapTreeNode::makeFromPrefix(data, SHAMapHash{hash});
+                if (!node->isInner())
+                    return;
+
+                auto const inner =
+                    std::static_pointer_cast<SHAMapInnerNode>(node);
+                for (int branch = 0; branch < SHAMapInnerNode::branchFactor;
+                     ++branch)
+                {
+                    if (!inner->isEmptyBranch(branch))
+                        stack.push_back(
+                            inner->getChildHash(branch).as_uint256());
+                }
+            });
+
+        if (!found)
+        {
+            ++missing_;
+            JLOG(j_.debug()) << "Missing node " << hash << " of ledger "
+                             << ledgerSeq;
+        }
+    }
+}
+
+void
+NodeStoreCompactor::markLedger(uint256 const& ledgerHash)
+{
+    if (!insert(ledgerHash))
+        return;
+
+    LedgerInfo info;
+    bool const found =
+        source_.fetchNodePayload(ledgerHash, 0, [&](Slice data) {
+            ++markedObjects_;
+            markedBytes_ += data.size();
+            info = deserializePrefixedHeader(data);
+        });
+
+    if (!found)
+    {
+        JLOG(j_.warn()) << "Missing header of ledger " << ledgerHash;
+        return;
+    }
+    ++ledgersFound_;
+
+    if (info.accountHash.isNonZero())
+        markTree(info.accountHash, info.seq);
+    if (info.txHash.isNonZero())
+        markTree(info.txHash, info.seq);
+}
+
+std::size_t
+NodeStoreCompactor::mark(
+    std::vector<uint256> const& ledgers,
+    WorkerPool& workers)
+{
+    // There is no point marking more once a ledger has failed
+    std::atomic<bool> failed{false};
+    auto const before = ledgersFound_.load();
+    workers.run(ledgers.size(), [&](std::size_t n) {
+        if (failed)
+            return;
+        try
+        {
+            markLedger(ledgers[n]);
+        }
+        catch (...)
+        {
+            failed = true;
+            throw;
+        }
+    });
+
+    auto const found = ledgersFound_ - before;
+    JLOG(j_.info()) << "Marked " << markedObjects_ << " objects, "
+                    << markedBytes_ << " bytes, reachable from " << found
+                    << " of " << ledgers.size() << " ledgers";
+    if (missing_ != 0)
+        JLOG(j_.warn()) << missing_ << " reachable nodes are missing";
+    return found;
+}
+
+NodeStoreCompactor::Counts
+NodeStoreCompactor::marked() const
+{
+    return {markedObjects_, markedBytes_};
+}
+
+NodeStoreCompactor::Sweep
+NodeStoreCompactor::sweep(NodeStore::Backend* dest)
+{
+    Sweep result;
+    NodeStore::Batch batch;
+    batch.reserve(NodeStore::batchWritePreallocationSize);
+
+    auto storeBatch = [&]() {
+        try
+        {
+            dest->storeBatch(batch);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.error()) << "Unable to write compacted objects: "
+                             << e.what();
+            result.failed += batch.size();
+        }
+        batch.clear();
+    };
+
+    source_.forEach([&](std::shared_ptr<NodeObject> object) {
+        auto const size = object->getData().size();
+        ++result.total.objects;
+        result.total.bytes += size;
+
+        bool live = isMarked(object->getHash());
+        if (!live && object->getType() == hotTX_INDEX)
+        {
+            // An index entry is kept with the tree holding its transaction
+            auto const location = parseTxIndex(*object);
+            live = location && isMarked(location->node);
+        }
+        if (!live)
+            return;
+
+        ++result.live.objects;
+        result.live.bytes += size;
+
+        if (dest)
+        {
+            batch.emplace_back(std::move(object));
+            if (batch.size() >= NodeStore::batchWritePreallocationSize)
+                storeBatch();
+        }
+    });
+
+    if (dest && !batch.empty())
+        storeBatch();
+
+    return result;
+}
+
+}  // namespace ripple
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/SignatureCache.h>
+#include <ripple/protocol/digest.h>
+#include <cassert>
+
+namespace ripple {
+
+SignatureCache::SignatureCache(std::size_t capacity) : capacity_(capacity)
+{
+    assert(capacity_ != 0);
+    entries_.reserve(capacity_);
+    order_.reserve(capacity_);
+}
+
+uint256
+SignatureCache::key(
+    uint256 const& digest,
+    Slice const& publicKey,
+    Slice const& signature,
+    std::uint8_t extra)
+{
+    // The key size is included so the key and signature bytes cannot be
+    // split differently to give the same hash
+    return sha512Half(
+        digest,
+        static_cast<std::uint32_t>(publicKey.size()),
+        publicKey,
+        signature,
+        extra);
+}
+
+bool
+SignatureCache::contains(uint256 const& key)
+{
+    bool found;
+    {
+        std::lock_guard lock(mutex_);
+        found = entries_.count(key) != 0;
+    }
+    ++(found ? hits_ : misses_);
+    return found;
+}
+
+void
+SignatureCache::insert(uint256 const& key)
+{
+    std::lock_guard lock(mutex_);
+    if (!entries_.insert(key).second)
+        return;
+
+    if (order_.size() < capacity_)
+    {
+        order_.push_back(key);
+        return;
+    }
+
+    entries_.erase(order_[next_]);
+    order_[next_] = key;
+    next_ = (next_ + 1) % capacity_;
+    ++evictions_;
+}
+
+std::size_t
+SignatureCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+float
+SignatureCache::rate() const
+{
+    auto const h = hits();
+    auto const total = h + misses();
+    if (total == 0)
+        return 0;
+    return static_cast<float>(h) / total;
+}
+
+Json::Value
+SignatureCache::getJson() const
+{
+    Json::Value ret(Json::objectValue);
+    ret["size"] = static_cast<Json::UInt>(size());
+    ret["target_size"] = static_cast<Json::UInt>(capacity_);
+    ret["hits"] = std::to_string(hits());
+    ret["misses"] = std::to_string(misses());
+    ret["hit_rate"] = rate();
+    ret["evictions"] = std::to_string(evictions_.load());
+    return ret;
+}
+
+}  // namespace ripple
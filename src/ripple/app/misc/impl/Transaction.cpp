@@ -17,7 +17,9 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/TxIndex.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/Transaction.h>
@@ -27,9 +29,11 @@
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/core/Pg.h>
 #include <ripple/json/json_reader.h>
+#include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/Feature.h>
 #include <ripple/protocol/jss.h>
+#include <ripple/shamap/SHAMapLeafNode.h>
 #include <boost/optional.hpp>
 
 namespace ripple {
@@ -133,12 +137,9 @@ Transaction::Locator
 Transaction::locate(uint256 const& id, Application& app)
 {
 #ifdef RIPPLED_REPORTING
-    auto baseCmd = boost::format(R"(SELECT tx('%s');)");
-
     std::string txHash = "\\x" + strHex(id);
-    std::string sql = boost::str(baseCmd % txHash);
 
-    auto res = PgQuery(app.getPgPool())(sql.data());
+    auto res = PgQuery(app.getPgPool())({"SELECT tx($1::bytea)", {txHash}});
 
     if (!res)
     {
@@ -205,6 +206,50 @@ Transaction::locate(uint256 const& id, Application& app)
         "Transaction::Locate - Invalid Postgres response");
 }
 
+// Finds a validated transaction through the transaction index
+static boost::optional<
+    std::pair<std::shared_ptr<Transaction>, std::shared_ptr<TxMeta>>>
+loadIndexed(uint256 const& id, Application& app, error_code_i& ec)
+{
+    auto const location = findTxIndex(app, id);
+    if (!location)
+        return boost::none;
+
+    auto object = app.getNodeStore().fetchNodeObject(
+        location->node, location->ledgerSeq);
+    if (auto shardStore = app.getShardStore(); !object && shardStore)
+        object =
+            shardStore->fetchNodeObject(location->node, location->ledgerSeq);
+    if (!object)
+        return boost::none;
+
+    try
+    {
+        auto const node = SHAMapTreeNode::makeFromPrefix(
+            object->getData(), SHAMapHash{location->node});
+        auto const leaf = dynamic_cast<SHAMapLeafNode const*>(node.get());
+        if (!leaf || leaf->peekItem()->key() != id)
+            return boost::none;
+
+        auto [sttx, meta] = deserializeTxPlusMeta(*leaf->peekItem());
+        std::string reason;
+        auto txn = std::make_shared<Transaction>(sttx, reason, app);
+        txn->setStatus(COMMITTED, location->ledgerSeq);
+        auto txMeta = std::make_shared<TxMeta>(id, location->ledgerSeq, *meta);
+        return std::pair{std::move(txn), std::move(txMeta)};
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(app.journal("Ledger").warn())
+            << "Unable to deserialize indexed transaction " << id
+            << ". Error: " << e.what();
+
+        ec = rpcDB_DESERIALIZATION;
+    }
+
+    return boost::none;
+}
+
 std::variant<
     std::pair<std::shared_ptr<Transaction>, std::shared_ptr<TxMeta>>,
     TxSearched>
@@ -214,6 +259,19 @@ Transaction::load(
     boost::optional<ClosedInterval<uint32_t>> const& range,
     error_code_i& ec)
 {
+    if (app.config().txIndex())
+    {
+        if (auto indexed = loadIndexed(id, app, ec))
+            return std::move(*indexed);
+        if (ec != rpcSUCCESS)
+            return TxSearched::unknown;
+    }
+
+    // Without the Transactions table, which ledgers were searched is not
+    // known
+    if (!app.config().useTxTables())
+        return TxSearched::unknown;
+
     std::string sql =
         "SELECT LedgerSeq,Status,RawTxn,TxnMeta "
         "FROM Transactions WHERE TransID='";
@@ -225,7 +283,7 @@ Transaction::load(
     boost::optional<std::string> status;
     Blob rawTxn, rawMeta;
     {
-        auto db = app.getTxnDB().checkoutDb();
+        auto db = app.getTxnDB().checkoutReadDb();
         soci::blob sociRawTxnBlob(*db), sociRawMetaBlob(*db);
         soci::indicator txn, meta;
 
@@ -0,0 +1,202 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/AcceptedLedgerTx.h>
+#include <ripple/app/misc/TransactionFilter.h>
+#include <ripple/protocol/SField.h>
+#include <algorithm>
+
+namespace ripple {
+
+TransactionFilter::Subject
+TransactionFilter::subjectOf(AcceptedLedgerTx const& tx)
+{
+    return subjectOf(*tx.getTxn(), tx.getAffected(), tx.getBooks());
+}
+
+TransactionFilter::Subject
+TransactionFilter::subjectOf(
+    STTx const& tx,
+    boost::container::flat_set<AccountID> affected,
+    std::vector<Book> const& books)
+{
+    Subject subject;
+    subject.type = tx.getTxnType();
+    subject.accounts = std::move(affected);
+    subject.books.insert(books.begin(), books.end());
+
+    // Every transaction pays its fee in XRP, so the fee would match
+    // every filter on XRP
+    for (auto const& field : tx)
+    {
+        if (field.getSType() == STI_AMOUNT && field.getFName() != sfFee)
+            subject.currencies.insert(
+                static_cast<STAmount const&>(field).getCurrency());
+    }
+
+    if (tx.isFieldPresent(sfAmount))
+        subject.amount = tx.getFieldAmount(sfAmount);
+    return subject;
+}
+
+template <class Set>
+static bool
+intersects(Set const& a, Set const& b)
+{
+    auto const& small = a.size() < b.size() ? a : b;
+    auto const& large = a.size() < b.size() ? b : a;
+    return std::any_of(small.begin(), small.end(), [&large](auto const& v) {
+        return large.count(v) != 0;
+    });
+}
+
+bool
+TransactionFilter::matches(Subject const& subject) const
+{
+    if (!types_.empty() && types_.count(subject.type) == 0)
+        return false;
+
+    if (!accounts_.empty() && !intersects(accounts_, subject.accounts))
+        return false;
+
+    if (!currencies_.empty() && !intersects(currencies_, subject.currencies))
+        return false;
+
+    if (!books_.empty() && !intersects(books_, subject.books))
+        return false;
+
+    if (minAmount_)
+    {
+        if (!subject.amount || subject.amount->issue() != minAmount_->issue())
+            return false;
+        if (*subject.amount < *minAmount_)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <class F>
+bool
+TransactionFilterIndex::forEachList(TransactionFilter const& filter, F&& f)
+{
+    if (!filter.accounts_.empty())
+    {
+        for (auto const& account : filter.accounts_)
+            f(byAccount_, account);
+    }
+    else if (!filter.books_.empty())
+    {
+        for (auto const& book : filter.books_)
+            f(byBook_, book);
+    }
+    else if (!filter.currencies_.empty())
+    {
+        for (auto const& currency : filter.currencies_)
+            f(byCurrency_, currency);
+    }
+    else if (!filter.types_.empty())
+    {
+        for (auto const type : filter.types_)
+            f(byType_, static_cast<std::uint16_t>(type));
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void
+TransactionFilterIndex::insert(
+    std::uint64_t seq,
+    std::shared_ptr<TransactionFilter const> filter)
+{
+    erase(seq);
+
+    auto const listed =
+        forEachList(*filter, [seq](auto& lists, auto const& key) {
+            lists[key].insert(seq);
+        });
+    if (!listed)
+        rest_.insert(seq);
+    filters_.emplace(seq, std::move(filter));
+}
+
+bool
+TransactionFilterIndex::erase(std::uint64_t seq)
+{
+    auto const it = filters_.find(seq);
+    if (it == filters_.end())
+        return false;
+
+    auto const listed =
+        forEachList(*it->second, [seq](auto& lists, auto const& key) {
+            auto const list = lists.find(key);
+            if (list == lists.end())
+                return;
+            list->second.erase(seq);
+            if (list->second.empty())
+                lists.erase(list);
+        });
+    if (!listed)
+        rest_.erase(seq);
+    filters_.erase(it);
+    return true;
+}
+
+std::vector<std::uint64_t>
+TransactionFilterIndex::matches(TransactionFilter::Subject const& subject) const
+{
+    std::vector<std::uint64_t> result;
+    if (filters_.empty())
+        return result;
+
+    hash_set<std::uint64_t> checked;
+    auto check = [&](std::uint64_t seq) {
+        if (!checked.insert(seq).second)
+            return;
+        if (auto const it = filters_.find(seq);
+            it != filters_.end() && it->second->matches(subject))
+            result.push_back(seq);
+    };
+    auto lookup = [&check](auto const& lists, auto const& key) {
+        if (auto const list = lists.find(key); list != lists.end())
+        {
+            for (auto const seq : list->second)
+                check(seq);
+        }
+    };
+
+    for (auto const& account : subject.accounts)
+        lookup(byAccount_, account);
+    for (auto const& book : subject.books)
+        lookup(byBook_, book);
+    for (auto const& currency : subject.currencies)
+        lookup(byCurrency_, currency);
+    lookup(byType_, static_cast<std::uint16_t>(subject.type));
+    for (auto const seq : rest_)
+        check(seq);
+
+    return result;
+}
+
+}  // namespace ripple
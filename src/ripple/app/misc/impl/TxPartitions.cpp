@@ -0,0 +1,298 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/DBInit.h>
+#include <ripple/app/misc/TxPartitions.h>
+#include <ripple/basics/contract.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace ripple {
+
+// Partition files are named after the transaction database, with the
+// first ledger of the range before the extension
+static std::string const partitionPrefix = "transaction.";
+static std::string const partitionSuffix = ".db";
+
+TxPartitions::TxPartitions(
+    DatabaseCon& db,
+    boost::filesystem::path const& dataDir,
+    std::vector<std::string> pragmas,
+    std::uint32_t ledgers,
+    beast::Journal journal)
+    : db_(db)
+    , dataDir_(dataDir)
+    , pragmas_(std::move(pragmas))
+    , ledgers_(ledgers)
+    , j_(journal)
+{
+    namespace fs = boost::filesystem;
+
+    // Partitions left by an earlier run are attached even if no more are
+    // to be created, so their rows can still be read
+    boost::system::error_code ec;
+    if (!dataDir_.empty() && fs::is_directory(dataDir_, ec))
+    {
+        for (auto const& entry : fs::directory_iterator(dataDir_))
+        {
+            auto const name = entry.path().filename().string();
+            auto const affixes =
+                partitionPrefix.size() + partitionSuffix.size();
+            if (name.size() <= affixes ||
+                !boost::starts_with(name, partitionPrefix) ||
+                !boost::ends_with(name, partitionSuffix))
+                continue;
+
+            auto const first = name.substr(
+                partitionPrefix.size(),
+                name.size() - affixes);
+            if (first.size() > 10 ||
+                !std::all_of(first.begin(), first.end(), [](char c) {
+                    return std::isdigit(static_cast<unsigned char>(c));
+                }))
+                continue;
+
+            auto const seq = std::stoull(first);
+            if (seq <= std::numeric_limits<LedgerIndex>::max())
+                partitions_.insert(static_cast<LedgerIndex>(seq));
+        }
+    }
+
+    if (partitions_.size() > maxPartitions)
+        Throw<std::runtime_error>(
+            "Too many transaction database partitions in " +
+            dataDir_.string());
+
+    db_.forEachSession([this](soci::session& session) {
+        for (auto const first : partitions_)
+            attach(session, first);
+        createViews(session);
+    });
+
+    JLOG(j_.info()) << "Transaction database has " << partitions_.size()
+                    << " partitions"
+                    << (ledgers_ ? ", each of " + std::to_string(ledgers_) +
+                                " ledgers"
+                                 : "");
+}
+
+std::string
+TxPartitions::schemaFor(LedgerIndex seq)
+{
+    std::lock_guard lock(mutex_);
+
+    // The partition starting last at or before the ledger
+    if (auto const it = partitions_.upper_bound(seq);
+        it != partitions_.begin() && seq - *std::prev(it) < ledgers_)
+        return schema(*std::prev(it));
+
+    // Ledgers older than every partition are rare, as partitions are
+    // created as the ledger advances, and go to the main file
+    if (ledgers_ == 0 || (!partitions_.empty() && seq < *partitions_.begin()))
+        return "main";
+
+    if (partitions_.size() >= maxPartitions)
+    {
+        if (!std::exchange(warned_, true))
+            JLOG(j_.warn()) << "Transaction database has "
+                            << partitions_.size()
+                            << " partitions, writing to the main file";
+        return "main";
+    }
+
+    auto const first = seq - seq % ledgers_;
+    try
+    {
+        create(first);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.error()) << "Unable to create transaction database partition "
+                         << path(first).string() << ": " << e.what();
+        partitions_.erase(first);
+        db_.forEachSession([this](soci::session& session) {
+            createViews(session);
+        });
+        return "main";
+    }
+    return schema(first);
+}
+
+std::vector<std::string>
+TxPartitions::schemas() const
+{
+    std::lock_guard lock(mutex_);
+    std::vector<std::string> result{"main"};
+    for (auto const first : partitions_)
+        result.push_back(schema(first));
+    return result;
+}
+
+std::size_t
+TxPartitions::retire(LedgerIndex before)
+{
+    auto writer = db_.checkoutDb();
+    std::lock_guard lock(mutex_);
+
+    if (partitions_.size() < 2)
+        return 0;
+
+    std::vector<LedgerIndex> old;
+    for (auto it = partitions_.begin(); std::next(it) != partitions_.end();
+         ++it)
+    {
+        // Partitions made with another size may overlap their ranges, so
+        // what each holds is looked up rather than assumed
+        auto const newest = [&](char const* table) {
+            boost::optional<std::uint64_t> seq;
+            *writer << "SELECT MAX(LedgerSeq) FROM " + schema(*it) + "." +
+                    table + ";",
+                soci::into(seq);
+            return seq.value_or(*it);
+        };
+        if (newest("Transactions") < before &&
+            newest("AccountTransactions") < before)
+            old.push_back(*it);
+    }
+    if (old.empty())
+        return 0;
+
+    for (auto const first : old)
+        partitions_.erase(first);
+
+    db_.forEachSession([&](soci::session& session) {
+        createViews(session);
+        for (auto const first : old)
+            session << "DETACH DATABASE " + schema(first) + ";";
+    });
+
+    for (auto const first : old)
+    {
+        auto const file = path(first);
+        boost::system::error_code ec;
+        for (auto const suffix : {"", "-wal", "-shm"})
+            boost::filesystem::remove(file.string() + suffix, ec);
+        JLOG(j_.info()) << "Removed transaction database partition "
+                        << file.string();
+    }
+
+    return old.size();
+}
+
+std::string
+TxPartitions::schema(LedgerIndex first)
+{
+    return "tx" + std::to_string(first);
+}
+
+boost::filesystem::path
+TxPartitions::path(LedgerIndex first) const
+{
+    return dataDir_ /
+        (partitionPrefix + std::to_string(first) + partitionSuffix);
+}
+
+void
+TxPartitions::create(LedgerIndex first)
+{
+    // The file is given the schema of the transaction database by a
+    // connection of its own, as every statement in TxDBInit names its
+    // tables without a schema
+    {
+        soci::session session;
+        open(session, "sqlite", path(first).string());
+        for (auto const& p : pragmas_)
+            session << p;
+        for (auto const sql : TxDBInit)
+            session << sql;
+    }
+
+    partitions_.insert(first);
+    db_.forEachSession([this, first](soci::session& session) {
+        attach(session, first);
+        createViews(session);
+    });
+
+    JLOG(j_.info()) << "Created transaction database partition "
+                    << path(first).string();
+}
+
+void
+TxPartitions::attach(soci::session& session, LedgerIndex first) const
+{
+    std::string file = path(first).string();
+    for (std::size_t i = file.find('\''); i != std::string::npos;
+         i = file.find('\'', i + 2))
+        file.insert(i, 1, '\'');
+
+    auto const name = schema(first);
+    session << "ATTACH DATABASE '" + file + "' AS " + name + ";";
+
+    // Pragmas apply to one schema, the main one unless named
+    static std::string const pragma = "PRAGMA ";
+    for (auto const& p : pragmas_)
+    {
+        if (boost::istarts_with(p, pragma))
+            session << pragma + name + "." + p.substr(pragma.size());
+    }
+}
+
+void
+TxPartitions::createViews(soci::session& session) const
+{
+    for (auto const view :
+         {"AccountTxJoined", "Transactions", "AccountTransactions"})
+        session << std::string("DROP VIEW IF EXISTS temp.") + view + ";";
+
+    std::string transactions;
+    std::string accounts;
+    std::string joined;
+    auto const add = [&](std::string const& name) {
+        auto const sep = transactions.empty() ? "" : " UNION ALL ";
+        transactions += sep + ("SELECT * FROM " + name + ".Transactions");
+        accounts += sep + ("SELECT * FROM " + name + ".AccountTransactions");
+        joined += sep +
+            ("SELECT a.TransID, a.Account, a.LedgerSeq, a.TxnSeq, "
+             "t.Status, t.RawTxn, t.TxnMeta FROM " +
+             name + ".AccountTransactions AS a INNER JOIN " + name +
+             ".Transactions AS t ON t.TransID = a.TransID");
+    };
+
+    add("main");
+    for (auto const first : partitions_)
+        add(schema(first));
+
+    // Temporary objects are found before those in the main file, so these
+    // views hide the tables there
+    if (!partitions_.empty())
+    {
+        session << "CREATE TEMP VIEW Transactions AS " + transactions + ";";
+        session << "CREATE TEMP VIEW AccountTransactions AS " + accounts +
+                ";";
+    }
+    session << "CREATE TEMP VIEW AccountTxJoined AS " + joined + ";";
+}
+
+}  // namespace ripple
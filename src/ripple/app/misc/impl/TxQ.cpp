@@ -354,6 +354,7 @@ TxQ::TxQ(Setup const& setup, beast::Journal j)
 
 TxQ::~TxQ()
 {
+    byExpiration_.clear();
     byFee_.clear();
 }
 
@@ -445,6 +446,8 @@ TxQ::erase(TxQ::FeeMultiSet::const_iterator_type candidateIter)
     auto const found = txQAccount.remove(seqProx);
     (void)found;
     assert(found);
+    if (txQAccount.empty())
+        emptiedAccounts_.push_back(txQAccount.account);
 
     return newCandidateIter;
 }
@@ -494,6 +497,8 @@ TxQ::eraseAndAdvance(TxQ::FeeMultiSet::const_iterator_type candidateIter)
 
     auto const candidateNextIter = byFee_.erase(candidateIter);
     txQAccount.transactions.erase(accountIter);
+    if (txQAccount.empty())
+        emptiedAccounts_.push_back(txQAccount.account);
 
     return useAccountNext ? byFee_.iterator_to(accountNextIter->second)
                           : candidateNextIter;
@@ -509,7 +514,10 @@ TxQ::erase(
     {
         byFee_.erase(byFee_.iterator_to(it->second));
     }
-    return txQAccount.transactions.erase(begin, end);
+    auto const next = txQAccount.transactions.erase(begin, end);
+    if (txQAccount.empty())
+        emptiedAccounts_.push_back(txQAccount.account);
+    return next;
 }
 
 std::pair<TER, bool>
@@ -730,11 +738,32 @@ TxQ::apply(
     ApplyFlags flags,
     beast::Journal j)
 {
+    return apply(app, view, tx, preflight(app, view.rules(), *tx, flags, j), j);
+}
+
+std::pair<TER, bool>
+TxQ::apply(
+    Application& app,
+    OpenView& view,
+    std::shared_ptr<STTx const> const& tx,
+    PreflightResult const& preflightResult,
+    beast::Journal j)
+{
+    assert(&preflightResult.tx == tx.get());
+
+    // See if the transaction is valid, properly formed,
+    // etc. before doing potentially expensive queue
+    // replace and multi-transaction operations.
+    auto const pfresult = preflightResult.rules == view.rules()
+        ? preflightResult
+        : preflight(app, view.rules(), *tx, preflightResult.flags, j);
+    auto flags = pfresult.flags;
+
     STAmountSO stAmountSO{view.rules().enabled(fixSTAmountCanonicalize)};
 
     // See if the transaction paid a high enough fee that it can go straight
     // into the ledger.
-    if (auto directApplied = tryDirectApply(app, view, tx, flags, j))
+    if (auto directApplied = tryDirectApply(app, view, tx, pfresult, j))
         return *directApplied;
 
     // If we get past tryDirectApply() without returning then we expect
@@ -744,10 +773,6 @@ TxQ::apply(
     //  o The transaction paid a high enough fee that fee averaging will apply.
     //  o The transaction will be queued.
 
-    // See if the transaction is valid, properly formed,
-    // etc. before doing potentially expensive queue
-    // replace and multi-transaction operations.
-    auto const pfresult = preflight(app, view.rules(), *tx, flags, j);
     if (pfresult.ter != tesSUCCESS)
         return {pfresult.ter, false};
 
@@ -1316,6 +1341,8 @@ TxQ::apply(
 
     // Then index it into the byFee lookup.
     byFee_.insert(candidate);
+    if (candidate.lastValid)
+        byExpiration_.insert(candidate);
     JLOG(j_.debug()) << "Added transaction " << candidate.txID
                      << " with result " << transToken(pfresult.ter) << " from "
                      << (accountIsInQueue ? "existing" : "new") << " account "
@@ -1352,29 +1379,25 @@ TxQ::processClosedLedger(Application& app, ReadView const& view, bool timeLeap)
             snapshot.txnsExpected * setup_.ledgersInQueue, setup_.queueSizeMin);
 
     // Remove any queued candidates whose LastLedgerSequence has gone by.
-    for (auto candidateIter = byFee_.begin(); candidateIter != byFee_.end();)
+    // Erasing a candidate also unlinks it from byExpiration_.
+    while (!byExpiration_.empty() &&
+           *byExpiration_.begin()->lastValid <= ledgerSeq)
     {
-        if (candidateIter->lastValid && *candidateIter->lastValid <= ledgerSeq)
-        {
-            byAccount_.at(candidateIter->account).dropPenalty = true;
-            candidateIter = erase(candidateIter);
-        }
-        else
-        {
-            ++candidateIter;
-        }
+        auto const& candidate = *byExpiration_.begin();
+        byAccount_.at(candidate.account).dropPenalty = true;
+        erase(byFee_.iterator_to(candidate));
     }
 
     // Remove any TxQAccounts that don't have candidates
     // under them
-    for (auto txQAccountIter = byAccount_.begin();
-         txQAccountIter != byAccount_.end();)
+    for (auto const& account : emptiedAccounts_)
     {
-        if (txQAccountIter->second.empty())
-            txQAccountIter = byAccount_.erase(txQAccountIter);
-        else
-            ++txQAccountIter;
+        auto const txQAccountIter = byAccount_.find(account);
+        if (txQAccountIter != byAccount_.end() &&
+            txQAccountIter->second.empty())
+            byAccount_.erase(txQAccountIter);
     }
+    emptiedAccounts_.clear();
 }
 
 /*
@@ -1627,9 +1650,10 @@ TxQ::tryDirectApply(
     Application& app,
     OpenView& view,
     std::shared_ptr<STTx const> const& tx,
-    ApplyFlags flags,
+    PreflightResult const& pfresult,
     beast::Journal j)
 {
+    auto const flags = pfresult.flags;
     auto const account = (*tx)[sfAccount];
     auto const sleAccount = view.read(keylet::account(account));
 
@@ -1663,7 +1687,7 @@ TxQ::tryDirectApply(
                          << " to open ledger.";
 
         auto const [txnResult, didApply] =
-            ripple::apply(app, view, *tx, flags, j);
+            doApply(preclaim(pfresult, app, view), app, view);
 
         JLOG(j_.trace()) << "New transaction " << transactionID
                          << (didApply ? " applied successfully with "
@@ -934,6 +934,8 @@ ValidatorList::applyLists(
             version) != 1)
         return PublisherListStats{ListDisposition::unsupported_version};
 
+    checkSignatures(manifest, blobs);
+
     std::lock_guard lock{mutex_};
 
     PublisherListStats result;
@@ -1257,6 +1259,59 @@ ValidatorList::loadLists()
     return sites;
 }
 
+bool
+ValidatorList::checkBlobSignature(
+    PublicKey const& signingKey,
+    Slice const& data,
+    Slice const& signature) const
+{
+    auto const digest = sha512Half(signingKey, data, signature);
+    if (auto const valid = checkedBlobs_.find(digest))
+        return *valid;
+
+    auto const valid = ripple::verify(signingKey, data, signature);
+    checkedBlobs_.insert(digest, valid);
+    return valid;
+}
+
+void
+ValidatorList::checkSignatures(
+    std::string const& manifest,
+    std::vector<ValidatorBlobInfo> const& blobs) const
+{
+    for (auto const& blobInfo : blobs)
+    {
+        auto const m = deserializeManifest(
+            base64_decode(blobInfo.manifest ? *blobInfo.manifest : manifest));
+        if (!m)
+            continue;
+
+        // Only spend time on the lists of publishers we trust
+        {
+            shared_lock read_lock{mutex_};
+            if (!publisherLists_.count(m->masterKey))
+                continue;
+        }
+
+        // A manifest that is not newer than the one we have is not applied,
+        // and the list must be signed with the key we already know.
+        auto signingKey = publisherManifests_.getSigningKey(m->masterKey);
+        if (auto const seq = publisherManifests_.getSequence(m->masterKey);
+            !seq || m->sequence > *seq)
+        {
+            if (m->revoked() || !publisherManifests_.checkSignatures(*m))
+                continue;
+            signingKey = m->signingKey;
+        }
+
+        if (auto const sig = strUnHex(blobInfo.signature))
+            checkBlobSignature(
+                signingKey,
+                makeSlice(base64_decode(blobInfo.blob)),
+                makeSlice(*sig));
+    }
+}
+
 ListDisposition
 ValidatorList::verify(
     ValidatorList::lock_guard const& lock,
@@ -1289,7 +1344,7 @@ ValidatorList::verify(
     auto const sig = strUnHex(signature);
     auto const data = base64_decode(blob);
     if (!sig ||
-        !ripple::verify(
+        !checkBlobSignature(
             publisherManifests_.getSigningKey(pubKey),
             makeSlice(data),
             makeSlice(*sig)))
@@ -68,7 +68,8 @@ flow(
     boost::optional<Quality> const& limitQuality,
     boost::optional<STAmount> const& sendMax,
     beast::Journal j,
-    path::detail::FlowDebugInfo* flowDebugInfo)
+    path::detail::FlowDebugInfo* flowDebugInfo,
+    std::size_t strandThreads)
 {
     Issue const srcIssue = [&] {
         if (sendMax)
@@ -145,7 +146,8 @@ flow(
                 limitQuality,
                 sendMax,
                 j,
-                flowDebugInfo));
+                flowDebugInfo,
+                strandThreads));
     }
 
     if (srcIsXRP && !dstIsXRP)
@@ -163,7 +165,8 @@ flow(
                 limitQuality,
                 sendMax,
                 j,
-                flowDebugInfo));
+                flowDebugInfo,
+                strandThreads));
     }
 
     if (!srcIsXRP && dstIsXRP)
@@ -181,7 +184,8 @@ flow(
                 limitQuality,
                 sendMax,
                 j,
-                flowDebugInfo));
+                flowDebugInfo,
+                strandThreads));
     }
 
     assert(!srcIsXRP && !dstIsXRP);
@@ -198,7 +202,8 @@ flow(
             limitQuality,
             sendMax,
             j,
-            flowDebugInfo));
+            flowDebugInfo,
+            strandThreads));
 }
 
 }  // namespace ripple
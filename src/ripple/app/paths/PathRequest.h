@@ -103,6 +103,12 @@ public:
     bool
     hasCompletion();
 
+    int
+    getIdentifier() const
+    {
+        return iIdentifier;
+    }
+
 private:
     bool
     isValid(std::shared_ptr<RippleLineCache> const& crCache);
@@ -22,11 +22,13 @@
 #include <ripple/app/paths/PathRequests.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobQueue.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/resource/Fees.h>
 #include <algorithm>
+#include <exception>
 
 namespace ripple {
 
@@ -49,7 +51,13 @@ PathRequests::getLineCache(
          ((lgrSeq + 8) < lineSeq)) ||  // we jumped way back for some reason
         (lgrSeq > (lineSeq + 8)))      // we jumped way forward for some reason
     {
-        mLineCache = std::make_shared<RippleLineCache>(ledger);
+        // Path searches over the previous closed ledger are still good if
+        // nothing they depend on changed.
+        if (authoritative && lgrSeq == lineSeq + 1 && !ledger->open() &&
+            !mLineCache->getLedger()->open())
+            mLineCache = std::make_shared<RippleLineCache>(ledger, *mLineCache);
+        else
+            mLineCache = std::make_shared<RippleLineCache>(ledger);
     }
     return mLineCache;
 }
@@ -73,20 +81,26 @@ PathRequests::updateAll(
     }
 
     bool newRequests = app_.getLedgerMaster().isNewPathRequest();
-    bool mustBreak = false;
+    std::atomic<bool> mustBreak{false};
 
     JLOG(mJournal.trace()) << "updateAll seq=" << cache->getLedger()->seq()
                            << ", " << requests.size() << " requests";
 
-    int processed = 0, removed = 0;
+    int processed = 0, removed = 0, delayed = 0;
 
     do
     {
-        for (auto const& wr : requests)
-        {
-            if (shouldCancel())
-                break;
-
+        // The requests are updated on the shared worker pool. They only read
+        // the ledger and share the line cache, which locks itself.
+        auto const deadline = std::chrono::steady_clock::now() + updateDeadline;
+        mustBreak = false;
+        std::atomic<int> passProcessed{0}, passDelayed{0};
+        std::mutex removeLock;
+        std::vector<PathRequest::pointer> toRemove;
+        bool removeDangling = false;
+        std::exception_ptr error;
+
+        auto update = [&](PathRequest::wptr const& wr) {
             auto request = wr.lock();
             bool remove = true;
 
@@ -97,6 +111,7 @@ PathRequests::updateAll(
                     remove = false;
                 else
                 {
+                    auto const start = std::chrono::steady_clock::now();
                     if (auto ipSub = request->getSubscriber())
                     {
                         if (!ipSub->getConsumer().warn())
@@ -107,7 +122,7 @@ PathRequests::updateAll(
                             update[jss::type] = "path_find";
                             ipSub->send(update, false);
                             remove = false;
-                            ++processed;
+                            ++passProcessed;
                         }
                     }
                     else if (request->hasCompletion())
@@ -115,41 +130,99 @@ PathRequests::updateAll(
                         // One-shot request with completion function
                         request->doUpdate(cache, false);
                         request->updateComplete();
-                        ++processed;
+                        ++passProcessed;
                     }
+
+                    auto const elapsed = std::chrono::steady_clock::now() -
+                        start;
+                    if (elapsed > slowUpdate)
+                        JLOG(mJournal.info())
+                            << "Path request " << request->getIdentifier()
+                            << " took "
+                            << std::chrono::duration_cast<
+                                   std::chrono::milliseconds>(elapsed)
+                                   .count()
+                            << "ms to update";
                 }
             }
 
             if (remove)
             {
-                std::lock_guard sl(mLock);
-
-                // Remove any dangling weak pointers or weak
-                // pointers that refer to this path request.
-                auto ret = std::remove_if(
-                    requests_.begin(),
-                    requests_.end(),
-                    [&removed, &request](auto const& wl) {
-                        auto r = wl.lock();
-
-                        if (r && r != request)
-                            return false;
-                        ++removed;
-                        return true;
-                    });
-
-                requests_.erase(ret, requests_.end());
+                std::lock_guard sl(removeLock);
+                if (request)
+                    toRemove.push_back(std::move(request));
+                else
+                    removeDangling = true;
             }
 
-            mustBreak =
-                !newRequests && app_.getLedgerMaster().isNewPathRequest();
-
             // We weren't handling new requests and then
             // there was a new request
-            if (mustBreak)
-                break;
+            if (!newRequests && app_.getLedgerMaster().isNewPathRequest())
+                mustBreak = true;
+        };
+
+        app_.getWorkerPool().run(
+            requests.size(),
+            [&](std::size_t i) {
+                // A new request is served by the next pass
+                if (mustBreak)
+                    return;
+
+                if (shouldCancel() ||
+                    std::chrono::steady_clock::now() > deadline)
+                {
+                    // Left for a later pass, likely on a newer ledger
+                    ++passDelayed;
+                    return;
+                }
+
+                try
+                {
+                    update(requests[i]);
+                }
+                catch (...)
+                {
+                    std::lock_guard sl(removeLock);
+                    if (!error)
+                        error = std::current_exception();
+                    mustBreak = true;
+                }
+            },
+            minRequestsPerThread);
+
+        processed += passProcessed;
+        delayed += passDelayed;
+
+        if (removeDangling || !toRemove.empty())
+        {
+            std::lock_guard sl(mLock);
+
+            // Remove any dangling weak pointers or weak
+            // pointers that refer to a removed path request.
+            auto ret = std::remove_if(
+                requests_.begin(),
+                requests_.end(),
+                [&removed, &toRemove](auto const& wl) {
+                    auto r = wl.lock();
+
+                    if (r &&
+                        std::find(toRemove.begin(), toRemove.end(), r) ==
+                            toRemove.end())
+                        return false;
+                    ++removed;
+                    return true;
+                });
+
+            requests_.erase(ret, requests_.end());
         }
 
+        if (error)
+            std::rethrow_exception(error);
+
+        // Out of time: let a newer ledger serve the requests left over
+        if (passDelayed > 0)
+            break;
+
         if (mustBreak)
         {  // a new request came in while we were working
             newRequests = true;
@@ -177,7 +250,11 @@ PathRequests::updateAll(
     } while (!shouldCancel());
 
     JLOG(mJournal.debug()) << "updateAll complete: " << processed
-                           << " processed and " << removed << " removed";
+                           << " processed, " << removed << " removed and "
+                           << delayed << " delayed";
+    if (delayed > 0)
+        JLOG(mJournal.info()) << "updateAll delayed " << delayed
+                              << " path requests to a later pass";
 }
 
 void
@@ -260,7 +337,17 @@ PathRequests::doLegacyPathRequest(
     std::shared_ptr<ReadView const> const& inLedger,
     Json::Value const& request)
 {
-    auto cache = std::make_shared<RippleLineCache>(inLedger);
+    std::shared_ptr<RippleLineCache> cache;
+    {
+        // Share the cache of the path requests if it is for this ledger
+        std::lock_guard sl(mLock);
+        if (mLineCache && !inLedger->open() &&
+            mLineCache->getLedger()->seq() == inLedger->seq() &&
+            mLineCache->getLedger()->info().hash == inLedger->info().hash)
+            cache = mLineCache;
+    }
+    if (!cache)
+        cache = std::make_shared<RippleLineCache>(inLedger);
 
     auto req = std::make_shared<PathRequest>(
         app_, [] {}, consumer, ++mLastIdentifier, *this, mJournal);
@@ -25,6 +25,7 @@
 #include <ripple/app/paths/RippleLineCache.h>
 #include <ripple/core/Job.h>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
 
@@ -99,6 +100,15 @@ public:
     }
 
 private:
+    // Update requests on several threads only when each gets this many
+    static constexpr std::size_t minRequestsPerThread = 2;
+
+    // Requests not started this long after a pass began wait for the next
+    static constexpr std::chrono::seconds updateDeadline{10};
+
+    // Updates that take longer than this are reported
+    static constexpr std::chrono::seconds slowUpdate{2};
+
     void
     insertPathRequest(PathRequest::pointer const&);
 
@@ -310,6 +310,24 @@ Pathfinder::findPaths(int searchLevel)
         paymentType = pt_nonXRP_to_nonXRP;
     }
 
+    // The paths the search finds depend only on these and on the trust
+    // lines and offers of the ledger, so an earlier search is as good.
+    RippleLineCache::PathSearchKey const searchKey{
+        mSrcAccount,
+        mDstAccount,
+        mSrcCurrency,
+        mSrcIssuer,
+        mDstAmount.issue(),
+        searchLevel};
+    if (auto const search = mRLCache->getPathSearch(searchKey))
+    {
+        mCompletePaths = search->paths;
+        JLOG(j_.debug()) << mCompletePaths.size()
+                         << " complete paths reused from ledger "
+                         << search->ledgerSeq;
+        return true;
+    }
+
     // Now iterate over all paths for that paymentType.
     for (auto const& costedPath : mPathTable[paymentType])
     {
@@ -327,6 +345,26 @@ Pathfinder::findPaths(int searchLevel)
 
     JLOG(j_.debug()) << mCompletePaths.size() << " complete paths found";
 
+    auto search = std::make_shared<RippleLineCache::PathSearch>();
+    search->paths = mCompletePaths;
+    search->ledgerSeq = mLedger->seq();
+    search->accounts.insert(mSrcAccount);
+    search->accounts.insert(mDstAccount);
+    search->accounts.insert(mEffectiveDst);
+    if (mSrcIssuer)
+        search->accounts.insert(*mSrcIssuer);
+    for (auto const& path : mCompletePaths)
+    {
+        for (auto const& element : path)
+        {
+            if (element.isAccount())
+                search->accounts.insert(element.getAccountID());
+            if (element.hasIssuer())
+                search->accounts.insert(element.getIssuerID());
+        }
+    }
+    mRLCache->setPathSearch(searchKey, std::move(search));
+
     // Even if we find no paths, default paths may work, and we don't check them
     // currently.
     return true;
@@ -111,7 +111,8 @@ RippleCalc::rippleCalculate(
                 limitQuality,
                 sendMax,
                 j,
-                nullptr);
+                nullptr,
+                pInputs ? pInputs->strandThreads : 0);
         }
         catch (std::exception& e)
         {
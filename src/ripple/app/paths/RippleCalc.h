@@ -51,6 +51,8 @@ public:
         bool defaultPathsAllowed = true;
         bool limitQuality = false;
         bool isLedgerOpen = true;
+        // Threads to evaluate strands on, if more than one
+        std::size_t strandThreads = 0;
     };
     struct Output
     {
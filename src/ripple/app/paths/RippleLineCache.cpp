@@ -18,7 +18,10 @@
 //==============================================================================
 
 #include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/app/paths/Tuning.h>
 #include <ripple/ledger/OpenView.h>
+#include <ripple/ledger/TxMeta.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -30,6 +33,58 @@ RippleLineCache::RippleLineCache(std::shared_ptr<ReadView const> const& ledger)
     mLedger = std::make_shared<OpenView>(&*ledger, ledger);
 }
 
+RippleLineCache::RippleLineCache(
+    std::shared_ptr<ReadView const> const& ledger,
+    RippleLineCache& previous)
+    : RippleLineCache(ledger)
+{
+    assert(!ledger->open());
+    assert(!previous.mLedger->open());
+    assert(ledger->seq() == previous.mLedger->seq() + 1);
+
+    // Payments, offers and trust line changes are all found through the
+    // accounts their transactions touched: a changed, created or deleted
+    // trust line names both of its accounts in the metadata.
+    hash_set<AccountID> touched;
+    for (auto const& [tx, meta] : ledger->txs)
+    {
+        if (!meta)
+            continue;
+        TxMeta const txMeta(tx->getTransactionID(), ledger->seq(), *meta);
+        for (auto const& account : txMeta.getAffectedAccounts(beast::Journal{
+                 beast::Journal::getNullSink()}))
+            touched.insert(account);
+    }
+
+    std::lock_guard sl(previous.mLock);
+
+    // The trust lines of untouched accounts are the same in this ledger.
+    hasher_ = previous.hasher_;
+    for (auto const& [key, lines] : previous.lines_)
+    {
+        if (touched.count(key.account_) == 0)
+            lines_.emplace(key, lines);
+    }
+
+    searches_ = previous.searches_;
+    for (auto it = searches_.begin(); it != searches_.end();)
+    {
+        auto const& search = *it->second;
+        bool const stale = ledger->seq() - search.ledgerSeq >=
+                PATHFINDER_MAX_SEARCH_REUSE ||
+            std::any_of(
+                search.accounts.begin(),
+                search.accounts.end(),
+                [&touched](AccountID const& account) {
+                    return touched.count(account) != 0;
+                });
+        if (stale)
+            it = searches_.erase(it);
+        else
+            ++it;
+    }
+}
+
 std::vector<RippleState::pointer> const&
 RippleLineCache::getRippleLines(AccountID const& accountID)
 {
@@ -46,4 +101,26 @@ RippleLineCache::getRippleLines(AccountID const& accountID)
     return it->second;
 }
 
+auto
+RippleLineCache::getPathSearch(PathSearchKey const& key)
+    -> std::shared_ptr<PathSearch const>
+{
+    std::lock_guard sl(mLock);
+
+    auto const it = searches_.find(key);
+    if (it == searches_.end())
+        return {};
+    return it->second;
+}
+
+void
+RippleLineCache::setPathSearch(
+    PathSearchKey const& key,
+    std::shared_ptr<PathSearch const> search)
+{
+    std::lock_guard sl(mLock);
+
+    searches_[key] = std::move(search);
+}
+
 }  // namespace ripple
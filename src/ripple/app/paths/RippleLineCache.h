@@ -22,10 +22,15 @@
 
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/paths/RippleState.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/basics/hardened_hash.h>
+#include <ripple/protocol/STPathSet.h>
+#include <boost/optional.hpp>
 #include <cstddef>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <tuple>
 #include <vector>
 
 namespace ripple {
@@ -34,8 +39,58 @@ namespace ripple {
 class RippleLineCache
 {
 public:
+    /** What the paths found by a Pathfinder search depend on. */
+    struct PathSearchKey
+    {
+        AccountID source;
+        AccountID destination;
+        Currency sourceCurrency;
+        boost::optional<AccountID> sourceIssuer;
+        Issue destinationIssue;
+        int level;
+
+        bool
+        operator<(PathSearchKey const& other) const
+        {
+            return std::tie(
+                       source,
+                       destination,
+                       sourceCurrency,
+                       sourceIssuer,
+                       destinationIssue,
+                       level) <
+                std::tie(
+                       other.source,
+                       other.destination,
+                       other.sourceCurrency,
+                       other.sourceIssuer,
+                       other.destinationIssue,
+                       other.level);
+        }
+    };
+
+    /** The complete paths found by a Pathfinder search. */
+    struct PathSearch
+    {
+        STPathSet paths;
+        /** Every account the paths go through or are issued by. */
+        hash_set<AccountID> accounts;
+        /** The sequence of the ledger searched. */
+        LedgerIndex ledgerSeq;
+    };
+
     explicit RippleLineCache(std::shared_ptr<ReadView const> const& l);
 
+    /** Construct a cache for the ledger following that of `previous`.
+
+        The trust lines of accounts no transaction in the ledger touched
+        are kept, as are path searches that depend on no touched account
+        and are not too old. Everything else is looked up again.
+    */
+    RippleLineCache(
+        std::shared_ptr<ReadView const> const& l,
+        RippleLineCache& previous);
+
     std::shared_ptr<ReadView const> const&
     getLedger() const
     {
@@ -45,6 +100,16 @@ public:
     std::vector<RippleState::pointer> const&
     getRippleLines(AccountID const& accountID);
 
+    /** Return the paths an earlier search found, if any. */
+    std::shared_ptr<PathSearch const>
+    getPathSearch(PathSearchKey const& key);
+
+    /** Remember the paths a search found for later requests. */
+    void
+    setPathSearch(
+        PathSearchKey const& key,
+        std::shared_ptr<PathSearch const> search);
+
 private:
     std::mutex mLock;
 
@@ -92,6 +157,8 @@ private:
 
     hash_map<AccountKey, std::vector<RippleState::pointer>, AccountKey::Hash>
         lines_;
+
+    std::map<PathSearchKey, std::shared_ptr<PathSearch const>> searches_;
 };
 
 }  // namespace ripple
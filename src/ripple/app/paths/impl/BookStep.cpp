@@ -164,6 +164,12 @@ public:
         return inactive_;
     }
 
+    void
+    setInactive(bool inactive) override
+    {
+        inactive_ = inactive;
+    }
+
 protected:
     std::string
     logStringImpl(char const* name) const
@@ -227,6 +227,15 @@ public:
         return false;
     }
 
+    /**
+       Restore whether the step is inactive, undoing the effect of a call to
+       rev or fwd whose result was never used.
+     */
+    virtual void
+    setInactive(bool)
+    {
+    }
+
     /**
        Return true if Out of lhs == Out of rhs.
     */
@@ -26,6 +26,7 @@
 #include <ripple/app/paths/impl/FlatSets.h>
 #include <ripple/app/paths/impl/FlowDebugInfo.h>
 #include <ripple/app/paths/impl/Steps.h>
+#include <ripple/app/paths/impl/StrandWorkers.h>
 #include <ripple/basics/IOUAmount.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/XRPAmount.h>
@@ -490,6 +491,8 @@ public:
    @param sendMaxST If present, the maximum STAmount to send
    @param j Journal to write journal messages to
    @param flowDebugInfo If pointer is non-null, write flow debug info here
+   @param strandThreads If more than one, evaluate the strands of each pass
+                        on this many threads. The result is the same.
    @return Actual amount in and out from the strands, errors, and payment
    sandbox
 */
@@ -504,7 +507,8 @@ flow(
     boost::optional<Quality> const& limitQuality,
     boost::optional<STAmount> const& sendMaxST,
     beast::Journal j,
-    path::detail::FlowDebugInfo* flowDebugInfo = nullptr)
+    path::detail::FlowDebugInfo* flowDebugInfo = nullptr,
+    std::size_t strandThreads = 0)
 {
     // Used to track the strand that offers the best quality (output/input
     // ratio)
@@ -574,6 +578,15 @@ flow(
     // successful
     boost::container::flat_set<uint256> ofrsToRmOnFail;
 
+    boost::optional<StrandWorkers> workers;
+    if (strandThreads > 1 && strands.size() > 1)
+        workers.emplace(strandThreads);
+
+    // Strand results computed ahead of the pass below, with any exception
+    using StrandOutcome = std::pair<
+        boost::optional<StrandResult<TInAmt, TOutAmt>>,
+        std::exception_ptr>;
+
     while (remainingOut > beast::zero &&
            (!remainingIn || *remainingIn > beast::zero))
     {
@@ -594,10 +607,58 @@ flow(
         // offers Constructed as `false,0` to workaround a gcc warning about
         // uninitialized variables
         boost::optional<std::size_t> markInactiveOnUse{false, 0};
+
+        // Every strand of a pass is evaluated against the same view, so
+        // they can all be evaluated at once on several threads. The loop
+        // below then takes the results in order exactly as if it had
+        // computed them itself. A strand it never reaches has whether its
+        // steps are inactive restored, since that outlives the pass.
+        bool const parallel = workers && activeStrands.size() > 1;
+        std::vector<StrandOutcome> outcomes(
+            parallel ? activeStrands.size() : 0);
+        std::vector<std::vector<bool>> wasInactive;
+        if (parallel)
+        {
+            wasInactive.resize(activeStrands.size());
+            for (std::size_t i = 0; i != activeStrands.size(); ++i)
+            {
+                if (auto const strand = activeStrands.get(i))
+                {
+                    for (auto const& step : *strand)
+                        wasInactive[i].push_back(step->inactive());
+                }
+            }
+
+            bool const canonicalize = *stAmountCanonicalizeSwitchover;
+            workers->run(activeStrands.size(), [&](std::size_t i) {
+                STAmountSO stAmountSO(canonicalize);
+                Strand const* strand = activeStrands.get(i);
+                if (!strand)
+                    return;
+                if (offerCrossing && limitQuality)
+                {
+                    auto const strandQ = qualityUpperBound(sb, *strand);
+                    if (!strandQ || *strandQ < *limitQuality)
+                        return;
+                }
+                try
+                {
+                    outcomes[i].first.emplace(flow<TInAmt, TOutAmt>(
+                        sb, *strand, remainingIn, remainingOut, j));
+                }
+                catch (...)
+                {
+                    outcomes[i].second = std::current_exception();
+                }
+            });
+        }
+
+        std::size_t strandsReached = 0;
         for (size_t strandIndex = 0, sie = activeStrands.size();
              strandIndex != sie;
              ++strandIndex)
         {
+            strandsReached = strandIndex + 1;
             Strand const* strand = activeStrands.get(strandIndex);
             if (!strand)
             {
@@ -610,8 +671,16 @@ flow(
                 if (!strandQ || *strandQ < *limitQuality)
                     continue;
             }
-            auto f = flow<TInAmt, TOutAmt>(
-                sb, *strand, remainingIn, remainingOut, j);
+            auto f = [&] {
+                if (outcomes.empty())
+                    return flow<TInAmt, TOutAmt>(
+                        sb, *strand, remainingIn, remainingOut, j);
+                auto& outcome = outcomes[strandIndex];
+                if (outcome.second)
+                    std::rethrow_exception(outcome.second);
+                assert(outcome.first);
+                return std::move(*outcome.first);
+            }();
 
             // rm bad offers even if the strand fails
             SetUnion(ofrsToRm, f.ofrsToRm);
@@ -678,6 +747,16 @@ flow(
             }
         }
 
+        for (std::size_t i = strandsReached; i < outcomes.size(); ++i)
+        {
+            if (auto const strand = activeStrands.get(i))
+            {
+                for (std::size_t k = 0; k != strand->size(); ++k)
+                    (*strand)[k]->setInactive(wasInactive[i][k]);
+            }
+        }
+        outcomes.clear();
+
         bool const shouldBreak = [&] {
             if (baseView.rules().enabled(featureFlowSortStrands))
                 return !best || offersConsidered >= maxOffersToConsider;
@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/paths/impl/StrandWorkers.h>
+#include <utility>
+
+namespace ripple {
+
+StrandWorkers::StrandWorkers(std::size_t threads) : threads_(threads)
+{
+}
+
+StrandWorkers::~StrandWorkers()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+void
+StrandWorkers::run(std::size_t n, std::function<void(std::size_t)> const& f)
+{
+    if (workers_.empty())
+    {
+        for (std::size_t t = 1; t < threads_; ++t)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        task_ = &f;
+        size_ = n;
+        next_ = 0;
+        error_ = nullptr;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    runTask();
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0 && next_ >= size_; });
+    task_ = nullptr;
+    if (auto error = std::exchange(error_, nullptr))
+        std::rethrow_exception(error);
+}
+
+void
+StrandWorkers::work()
+{
+    std::uint64_t seen = 0;
+    std::unique_lock lock(mutex_);
+    for (;;)
+    {
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_)
+            return;
+        seen = generation_;
+
+        lock.unlock();
+        runTask();
+        lock.lock();
+    }
+}
+
+void
+StrandWorkers::runTask()
+{
+    std::unique_lock lock(mutex_);
+
+    // A worker may wake after the task it was woken for already finished
+    if (!task_ || next_ >= size_)
+        return;
+
+    auto const& task = *task_;
+    ++busy_;
+    while (next_ < size_)
+    {
+        auto const i = next_++;
+        lock.unlock();
+        try
+        {
+            task(i);
+        }
+        catch (...)
+        {
+            lock.lock();
+            if (!error_)
+                error_ = std::current_exception();
+            continue;
+        }
+        lock.lock();
+    }
+    if (--busy_ == 0)
+        done_.notify_all();
+}
+
+}  // namespace ripple
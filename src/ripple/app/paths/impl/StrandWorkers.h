@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_PATHS_IMPL_STRANDWORKERS_H_INCLUDED
+#define RIPPLE_APP_PATHS_IMPL_STRANDWORKERS_H_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** A few threads that evaluate the strands of one flow in parallel.
+
+    The threads start on first use and are reused for every liquidity pass
+    until the object is destroyed, so a payment pays for them once.
+*/
+class StrandWorkers
+{
+public:
+    /** @param threads The number of threads to use, including the caller. */
+    explicit StrandWorkers(std::size_t threads);
+
+    StrandWorkers(StrandWorkers const&) = delete;
+    StrandWorkers&
+    operator=(StrandWorkers const&) = delete;
+
+    ~StrandWorkers();
+
+    /** Call `f` for every index in [0, n) and wait for all of them.
+
+        The caller runs calls too. If any call throws, the first exception
+        is rethrown once every call has finished.
+    */
+    void
+    run(std::size_t n, std::function<void(std::size_t)> const& f);
+
+private:
+    void
+    work();
+
+    void
+    runTask();
+
+    std::size_t const threads_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    bool stop_ = false;
+    std::uint64_t generation_ = 0;
+    std::size_t busy_ = 0;
+
+    std::function<void(std::size_t)> const* task_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t next_ = 0;
+    std::exception_ptr error_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -19,42 +19,185 @@
 
 #ifdef RIPPLED_REPORTING
 #include <ripple/app/reporting/DBHelpers.h>
+#include <algorithm>
 #include <memory>
 
 namespace ripple {
 
+/// The insert of a ledger header into the ledgers table
+static pg_params
+ledgerInsert(LedgerInfo const& info)
+{
+    return {
+        "INSERT INTO ledgers VALUES ($1::bigint, $2::bytea, $3::bytea, "
+        "$4::bigint, $5::bigint, $6::bigint, $7::bigint, $8::bigint, "
+        "$9::bytea, $10::bytea)",
+        {std::to_string(info.seq),
+         "\\x" + strHex(info.hash),
+         "\\x" + strHex(info.parentHash),
+         std::to_string(info.drops.drops()),
+         std::to_string(info.closeTime.time_since_epoch().count()),
+         std::to_string(info.parentCloseTime.time_since_epoch().count()),
+         std::to_string(info.closeTimeResolution.count()),
+         std::to_string(info.closeFlags),
+         "\\x" + strHex(info.accountHash),
+         "\\x" + strHex(info.txHash)}};
+}
+
 static bool
 writeToLedgersDB(LedgerInfo const& info, PgQuery& pgQuery, beast::Journal& j)
 {
     JLOG(j.debug()) << __func__;
-    auto cmd = boost::format(
-        R"(INSERT INTO ledgers
-           VALUES (%u,'\x%s', '\x%s',%u,%u,%u,%u,%u,'\x%s','\x%s'))");
-
-    auto ledgerInsert = boost::str(
-        cmd % info.seq % strHex(info.hash) % strHex(info.parentHash) %
-        info.drops.drops() % info.closeTime.time_since_epoch().count() %
-        info.parentCloseTime.time_since_epoch().count() %
-        info.closeTimeResolution.count() % info.closeFlags %
-        strHex(info.accountHash) % strHex(info.txHash));
-    JLOG(j.trace()) << __func__ << " : "
-                    << " : "
-                    << "query string = " << ledgerInsert;
-
-    auto res = pgQuery(ledgerInsert.data());
+    auto res = pgQuery(ledgerInsert(info));
 
     return res;
 }
 
-bool
-writeToPostgres(
+PgLedgerWriter::PgLedgerWriter(
+    std::shared_ptr<PgPool> const& pgPool,
+    beast::Journal j)
+    : pg_(pgPool), j_(j)
+{
+    auto res = pg_("BEGIN");
+    if (!res || res.status() != PGRES_COMMAND_OK)
+    {
+        std::stringstream msg;
+        msg << "PgLedgerWriter : Postgres BEGIN error: " << res.msg();
+        Throw<std::runtime_error>(msg.str());
+    }
+
+    // The staging table lasts until the end of the transaction
+    res = pg_(
+        "CREATE TEMPORARY TABLE account_transactions_stage "
+        "(LIKE account_transactions) ON COMMIT DROP");
+    if (!res || res.status() != PGRES_COMMAND_OK)
+    {
+        std::stringstream msg;
+        msg << "PgLedgerWriter : Postgres error creating staging table: "
+            << res.msg();
+        Throw<std::runtime_error>(msg.str());
+    }
+
+    pg_.copyBegin("account_transactions_stage", true);
+    copying_ = true;
+}
+
+PgLedgerWriter::~PgLedgerWriter()
+{
+    if (done_)
+        return;
+    try
+    {
+        if (copying_)
+            pg_.copyAbort();
+        pg_("ROLLBACK");
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.error()) << "PgLedgerWriter : error rolling back: "
+                         << e.what();
+    }
+}
+
+void
+PgLedgerWriter::add(
     LedgerInfo const& info,
-    std::vector<AccountTransactionsData> const& accountTxData,
+    std::vector<AccountTransactionsData> const& accountTxData)
+{
+    assert(copying_);
+    ledgers_.push_back(info);
+
+    for (auto const& data : accountTxData)
+    {
+        transactions_.row(4);
+        transactions_.bigint(data.ledgerSequence);
+        transactions_.bigint(data.transactionIndex);
+        transactions_.bytea(data.txHash.data(), data.txHash.size());
+        transactions_.bytea(
+            data.nodestoreHash.data(), data.nodestoreHash.size());
+
+        for (auto const& a : data.accounts)
+        {
+            accountTransactions_.row(3);
+            accountTransactions_.bytea(a.data(), a.size());
+            accountTransactions_.bigint(data.ledgerSequence);
+            accountTransactions_.bigint(data.transactionIndex);
+        }
+    }
+
+    if (accountTransactions_.size() >= sendSize)
+        pg_.copyData(accountTransactions_.take());
+}
+
+bool
+PgLedgerWriter::commit()
+{
+    assert(copying_);
+    accountTransactions_.finish();
+    pg_.copyData(accountTransactions_.take());
+    pg_.copyEnd();
+    copying_ = false;
+
+    // Writing to the ledgers db fails if the ledger already exists in the db.
+    // In this situation, the ETL process has detected there is another
+    // writer, and falls back to only publishing
+    // The inserts are pipelined, so they cost one round trip in all
+    std::vector<pg_params> inserts;
+    inserts.reserve(ledgers_.size());
+    for (auto const& info : ledgers_)
+        inserts.push_back(ledgerInsert(info));
+    auto const results = pg_.pipeline(inserts);
+    if (results.size() != inserts.size() ||
+        !std::all_of(results.begin(), results.end(), [](auto const& r) {
+            return static_cast<bool>(r);
+        }))
+    {
+        JLOG(j_.warn()) << __func__ << " : "
+                        << "Failed to write to ledgers database.";
+        return false;
+    }
+
+    transactions_.finish();
+    pg_.copyBegin("transactions", true);
+    copying_ = true;
+    pg_.copyData(transactions_.take());
+    pg_.copyEnd();
+    copying_ = false;
+
+    auto res = pg_(
+        "INSERT INTO account_transactions "
+        "SELECT * FROM account_transactions_stage "
+        "ORDER BY account, ledger_seq, transaction_index");
+    if (!res || res.status() != PGRES_COMMAND_OK)
+    {
+        std::stringstream msg;
+        msg << "PgLedgerWriter : Postgres error moving staged rows: "
+            << res.msg();
+        Throw<std::runtime_error>(msg.str());
+    }
+
+    res = pg_("COMMIT");
+    if (!res || res.status() != PGRES_COMMAND_OK)
+    {
+        std::stringstream msg;
+        msg << "PgLedgerWriter : Postgres COMMIT error: " << res.msg();
+        Throw<std::runtime_error>(msg.str());
+    }
+    done_ = true;
+    return true;
+}
+
+/// Write ledgers in one transaction, building the records of each table in
+/// memory. This is quicker than PgLedgerWriter for a single ledger
+static bool
+writeBuffered(
+    std::vector<LedgerWriteData> const& ledgers,
     std::shared_ptr<PgPool> const& pgPool,
     beast::Journal& j)
 {
     JLOG(j.debug()) << __func__ << " : "
-                    << "Beginning write to Postgres";
+                    << "Beginning write to Postgres of " << ledgers.size()
+                    << " ledgers";
 
     try
     {
@@ -69,36 +212,40 @@ writeToPostgres(
             Throw<std::runtime_error>(msg.str());
         }
 
-        // Writing to the ledgers db fails if the ledger already exists in the
-        // db. In this situation, the ETL process has detected there is another
-        // writer, and falls back to only publishing
-        if (!writeToLedgersDB(info, pg, j))
-        {
-            JLOG(j.warn()) << __func__ << " : "
-                           << "Failed to write to ledgers database.";
-            return false;
-        }
-
         std::stringstream transactionsCopyBuffer;
         std::stringstream accountTransactionsCopyBuffer;
-        for (auto const& data : accountTxData)
+        for (auto const& [info, accountTxData] : ledgers)
         {
-            std::string txHash = strHex(data.txHash);
-            std::string nodestoreHash = strHex(data.nodestoreHash);
-            auto idx = data.transactionIndex;
-            auto ledgerSeq = data.ledgerSequence;
-
-            transactionsCopyBuffer << std::to_string(ledgerSeq) << '\t'
-                                   << std::to_string(idx) << '\t' << "\\\\x"
-                                   << txHash << '\t' << "\\\\x" << nodestoreHash
-                                   << '\n';
+            // Writing to the ledgers db fails if the ledger already exists in
+            // the db. In this situation, the ETL process has detected there is
+            // another writer, and falls back to only publishing
+            if (!writeToLedgersDB(info, pg, j))
+            {
+                JLOG(j.warn()) << __func__ << " : "
+                               << "Failed to write to ledgers database.";
+                return false;
+            }
 
-            for (auto const& a : data.accounts)
+            for (auto const& data : accountTxData)
             {
-                std::string acct = strHex(a);
-                accountTransactionsCopyBuffer
-                    << "\\\\x" << acct << '\t' << std::to_string(ledgerSeq)
-                    << '\t' << std::to_string(idx) << '\n';
+                std::string txHash = strHex(data.txHash);
+                std::string nodestoreHash = strHex(data.nodestoreHash);
+                auto idx = data.transactionIndex;
+                auto ledgerSeq = data.ledgerSequence;
+
+                transactionsCopyBuffer << std::to_string(ledgerSeq) << '\t'
+                                       << std::to_string(idx) << '\t'
+                                       << "\\\\x" << txHash << '\t'
+                                       << "\\\\x" << nodestoreHash << '\n';
+
+                for (auto const& a : data.accounts)
+                {
+                    std::string acct = strHex(a);
+                    accountTransactionsCopyBuffer
+                        << "\\\\x" << acct << '\t'
+                        << std::to_string(ledgerSeq) << '\t'
+                        << std::to_string(idx) << '\n';
+                }
             }
         }
 
@@ -128,5 +275,49 @@ writeToPostgres(
     }
 }
 
+bool
+writeToPostgres(
+    LedgerInfo const& info,
+    std::vector<AccountTransactionsData> const& accountTxData,
+    std::shared_ptr<PgPool> const& pgPool,
+    beast::Journal& j)
+{
+    return writeBuffered({{info, accountTxData}}, pgPool, j);
+}
+
+bool
+writeToPostgres(
+    std::vector<LedgerWriteData> const& ledgers,
+    std::shared_ptr<PgPool> const& pgPool,
+    beast::Journal& j)
+{
+    if (ledgers.size() < 2)
+        return writeBuffered(ledgers, pgPool, j);
+
+    JLOG(j.debug()) << __func__ << " : "
+                    << "Beginning streamed write to Postgres of "
+                    << ledgers.size() << " ledgers";
+    try
+    {
+        PgLedgerWriter writer(pgPool, j);
+        for (auto const& [info, accountTxData] : ledgers)
+            writer.add(info, accountTxData);
+        if (!writer.commit())
+            return false;
+
+        JLOG(j.info()) << __func__ << " : "
+                       << "Successfully wrote " << ledgers.size()
+                       << " ledgers to Postgres";
+        return true;
+    }
+    catch (std::exception& e)
+    {
+        JLOG(j.error()) << __func__ << "Caught exception writing to Postgres : "
+                        << e.what();
+        assert(false);
+        return false;
+    }
+}
+
 }  // namespace ripple
 #endif
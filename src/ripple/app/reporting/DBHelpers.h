@@ -50,6 +50,10 @@ struct AccountTransactionsData
     }
 };
 
+/// A ledger header and the transaction data of that ledger
+using LedgerWriteData =
+    std::pair<LedgerInfo, std::vector<AccountTransactionsData>>;
+
 #ifdef RIPPLED_REPORTING
 /// Write new ledger and transaction data to Postgres
 /// @param info Ledger Info to write
@@ -64,6 +68,70 @@ writeToPostgres(
     std::shared_ptr<PgPool> const& pgPool,
     beast::Journal& j);
 
+/// Writes many ledgers to Postgres in a single transaction, as during a
+/// backfill. The account_transactions rows are streamed, as each ledger is
+/// added, through one COPY in the binary format into a staging table that
+/// has no indexes or constraints. When the batch is committed, the rows are
+/// moved into account_transactions sorted in index order, so its indexes
+/// are updated once per batch and mostly at their ends, instead of once per
+/// ledger in random order.
+///
+/// Member functions throw upon error. A batch not committed is rolled back.
+class PgLedgerWriter
+{
+    PgQuery pg_;
+    beast::Journal j_;
+
+    std::vector<LedgerInfo> ledgers_;
+
+    // The transactions rows must follow the ledgers rows they refer to, which
+    // are inserted only when the batch is committed
+    PgCopyRecords transactions_;
+
+    // Records not yet sent to the COPY into the staging table
+    PgCopyRecords accountTransactions_;
+
+    bool copying_ = false;
+    bool done_ = false;
+
+public:
+    /// Records are sent to Postgres in pieces of about this many bytes
+    static constexpr std::size_t sendSize = 1 << 20;
+
+    PgLedgerWriter(std::shared_ptr<PgPool> const& pgPool, beast::Journal j);
+
+    PgLedgerWriter(PgLedgerWriter const&) = delete;
+    PgLedgerWriter&
+    operator=(PgLedgerWriter const&) = delete;
+
+    ~PgLedgerWriter();
+
+    /// Add a ledger to the batch
+    /// @param info Ledger Info to write
+    /// @param accountTxData transaction data to write
+    void
+    add(LedgerInfo const& info,
+        std::vector<AccountTransactionsData> const& accountTxData);
+
+    /// Write the batch
+    /// @return false if one of the ledgers is already in the database, in
+    /// which case none of the batch was written
+    bool
+    commit();
+};
+
+/// Write several ledgers to Postgres in a single transaction
+/// @param ledgers ledger info and transaction data of each ledger to write
+/// @param pgPool pool of Postgres connections
+/// @param j journal (for logging)
+/// @return whether the write succeeded. If not, none of the ledgers were
+/// written
+bool
+writeToPostgres(
+    std::vector<LedgerWriteData> const& ledgers,
+    std::shared_ptr<PgPool> const& pgPool,
+    beast::Journal& j);
+
 #endif
 }  // namespace ripple
 #endif
@@ -21,11 +21,15 @@
 #define RIPPLE_APP_REPORTING_ETLHELPERS_H_INCLUDED
 #include <ripple/app/main/Application.h>
 #include <ripple/ledger/ReadView.h>
+#include <chrono>
 #include <condition_variable>
+#include <iomanip>
+#include <limits>
 #include <mutex>
 #include <optional>
 #include <queue>
 #include <sstream>
+#include <vector>
 
 namespace ripple {
 
@@ -159,6 +163,21 @@ public:
             cv_.notify_all();
         return ret;
     }
+
+    /// @return element popped from queue, or an empty optional if the queue
+    /// is empty. Does not block
+    std::optional<T>
+    tryPop()
+    {
+        std::unique_lock lck(m_);
+        if (queue_.empty())
+            return {};
+        std::optional<T> ret{std::move(queue_.front())};
+        queue_.pop();
+        if (maxSize_)
+            cv_.notify_all();
+        return ret;
+    }
 };
 
 /// Parititions the uint256 keyspace into numMarkers partitions, each of equal
@@ -181,5 +200,301 @@ getMarkers(size_t numMarkers)
     return markers;
 }
 
+/// Divides the state map keyspace among the streams that download a ledger
+/// in full. The partitions start out evenly spaced, as from getMarkers().
+/// State is not spread evenly across the keyspace, so some partitions take
+/// much longer than others. When a stream asks for work and every partition
+/// is taken, the partition estimated to have the most objects left is split
+/// at the midpoint of what remains, and the stream takes the upper half.
+///
+/// Positions in the keyspace are compared on the first 64 bits of the key.
+/// All member functions are thread safe.
+class LedgerDataPartitions
+{
+public:
+    /// A partition handed to a stream
+    struct Assignment
+    {
+        std::size_t id;
+
+        /// Where to start downloading. Zero is the start of the keyspace
+        uint256 marker;
+    };
+
+    /// The state of a partition after a page of it was downloaded
+    struct Progress
+    {
+        /// Whether the stream should go on downloading the partition
+        bool more;
+
+        /// The position just past the partition, if it is bounded. Objects
+        /// at or past this position belong to another partition
+        std::optional<std::uint64_t> end;
+    };
+
+    /// Partitions estimated to hold fewer objects than this are not split
+    static constexpr double minSplitObjects = 4096;
+
+    /// Before any objects have arrived, partitions narrower than this are
+    /// not split
+    static constexpr std::uint64_t minSplitWidth = std::uint64_t{1} << 48;
+
+private:
+    struct Partition
+    {
+        std::uint64_t begin = 0;
+        std::optional<std::uint64_t> end;
+
+        /// Where to resume downloading, and its position
+        uint256 marker;
+        std::uint64_t position = 0;
+
+        std::size_t objects = 0;
+        bool active = false;
+        bool done = false;
+
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point finished;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Partition> partitions_;
+    std::chrono::steady_clock::time_point lastReport_;
+
+    static std::uint64_t
+    remaining(Partition const& p)
+    {
+        return p.end.value_or(std::numeric_limits<std::uint64_t>::max()) -
+            p.position;
+    }
+
+    static uint256
+    keyAt(std::uint64_t position)
+    {
+        uint256 key;
+        for (std::size_t i = 0; i < 8; ++i)
+            key.data()[i] =
+                static_cast<unsigned char>(position >> (56 - 8 * i));
+        return key;
+    }
+
+    static std::string
+    toHex(std::uint64_t position)
+    {
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << position;
+        return ss.str();
+    }
+
+public:
+    /// @param numPartitions number of evenly spaced partitions to start with
+    explicit LedgerDataPartitions(std::size_t numPartitions)
+    {
+        auto const markers = getMarkers(numPartitions);
+        partitions_.reserve(markers.size());
+        for (std::size_t i = 0; i < markers.size(); ++i)
+        {
+            Partition p;
+            p.begin = p.position = position(markers[i]);
+            p.marker = markers[i];
+            if (i + 1 < markers.size())
+                p.end = position(markers[i + 1]);
+            partitions_.push_back(p);
+        }
+    }
+
+    /// @return the position of a key in the keyspace
+    static std::uint64_t
+    position(uint256 const& key)
+    {
+        std::uint64_t ret = 0;
+        for (std::size_t i = 0; i < 8; ++i)
+            ret = (ret << 8) | key.data()[i];
+        return ret;
+    }
+
+    /// Take a partition to download: one that no stream is working on, or
+    /// else the upper half of the partition with the most work left
+    /// @return the partition, or an empty optional if there is no work
+    /// worth handing out
+    std::optional<Assignment>
+    acquire()
+    {
+        std::lock_guard lock(mutex_);
+        auto const now = std::chrono::steady_clock::now();
+
+        for (std::size_t id = 0; id < partitions_.size(); ++id)
+        {
+            auto& p = partitions_[id];
+            if (!p.active && !p.done)
+            {
+                p.active = true;
+                if (p.started == std::chrono::steady_clock::time_point{})
+                    p.started = now;
+                return Assignment{id, p.marker};
+            }
+        }
+
+        // The density of objects in the keyspace downloaded so far
+        double objects = 0;
+        double covered = 0;
+        for (auto const& p : partitions_)
+        {
+            objects += p.objects;
+            covered += p.position - p.begin;
+        }
+        double const density = covered > 0 ? objects / covered : 0;
+
+        std::optional<std::size_t> best;
+        double bestWork = 0;
+        for (std::size_t id = 0; id < partitions_.size(); ++id)
+        {
+            auto const& p = partitions_[id];
+            if (!p.active || p.done || remaining(p) < 2)
+                continue;
+
+            double work = remaining(p);
+            if (density > 0)
+            {
+                // Estimate from the partition's own density once it has one
+                auto const own = p.position - p.begin;
+                work *= (own > 0 && p.objects > 0)
+                    ? static_cast<double>(p.objects) / own
+                    : density;
+                if (work < minSplitObjects)
+                    continue;
+            }
+            else if (remaining(p) < minSplitWidth)
+            {
+                continue;
+            }
+
+            if (!best || work > bestWork)
+            {
+                best = id;
+                bestWork = work;
+            }
+        }
+        if (!best)
+            return {};
+
+        auto& p = partitions_[*best];
+        auto const mid = p.position + remaining(p) / 2;
+
+        Partition upper;
+        upper.begin = upper.position = mid;
+        upper.end = p.end;
+        upper.marker = keyAt(mid);
+        upper.active = true;
+        upper.started = now;
+        p.end = mid;
+
+        partitions_.push_back(upper);
+        return Assignment{partitions_.size() - 1, upper.marker};
+    }
+
+    /// Record a page of a partition
+    /// @param id the partition
+    /// @param nextMarker the marker returned with the page; empty at the end
+    /// of the state map
+    /// @param objects the number of objects in the page
+    /// @return whether to go on, and where the partition now ends
+    Progress
+    advance(std::size_t id, std::string const& nextMarker, std::size_t objects)
+    {
+        std::lock_guard lock(mutex_);
+        auto& p = partitions_[id];
+        p.objects += objects;
+
+        bool more = nextMarker.size() == uint256::bytes;
+        if (more)
+        {
+            p.marker = uint256::fromVoid(nextMarker.data());
+            p.position = position(p.marker);
+            more = !p.end || p.position < *p.end;
+        }
+        if (!more)
+        {
+            p.active = false;
+            p.done = true;
+            p.finished = std::chrono::steady_clock::now();
+        }
+        return {more, p.end};
+    }
+
+    /// Give a partition back after a failed download, so that another stream
+    /// resumes it from the last page received
+    void
+    release(std::size_t id)
+    {
+        std::lock_guard lock(mutex_);
+        partitions_[id].active = false;
+    }
+
+    /// @return whether every partition has been downloaded
+    bool
+    complete() const
+    {
+        std::lock_guard lock(mutex_);
+        for (auto const& p : partitions_)
+        {
+            if (!p.done)
+                return false;
+        }
+        return true;
+    }
+
+    /// @return the number of partitions, including those split off
+    std::size_t
+    size() const
+    {
+        std::lock_guard lock(mutex_);
+        return partitions_.size();
+    }
+
+    /// Log the progress of every partition, at most once per interval unless
+    /// forced
+    void
+    report(
+        beast::Journal const& j,
+        bool force = false,
+        std::chrono::seconds interval = std::chrono::seconds(10))
+    {
+        std::lock_guard lock(mutex_);
+        auto const now = std::chrono::steady_clock::now();
+        if (!force && now - lastReport_ < interval)
+            return;
+        lastReport_ = now;
+
+        std::size_t total = 0;
+        for (std::size_t id = 0; id < partitions_.size(); ++id)
+        {
+            auto const& p = partitions_[id];
+            total += p.objects;
+
+            auto const width = static_cast<double>(
+                p.end.value_or(std::numeric_limits<std::uint64_t>::max()) -
+                p.begin);
+            auto const percent =
+                p.done ? 100.0 : 100.0 * (p.position - p.begin) / width;
+            auto const elapsed =
+                std::chrono::duration_cast<std::chrono::seconds>(
+                    (p.done ? p.finished : now) - p.started)
+                    .count();
+
+            JLOG(j.info()) << "Partition " << id << " [" << toHex(p.begin)
+                           << ", "
+                           << (p.end ? toHex(*p.end) : std::string("end"))
+                           << ") : " << static_cast<int>(percent) << "% . "
+                           << p.objects << " objects . " << elapsed << "s"
+                           << (p.done         ? " . done"
+                                   : p.active ? " . active"
+                                              : " . waiting");
+        }
+        JLOG(j.info()) << "Downloaded " << total << " objects in "
+                       << partitions_.size() << " partitions";
+    }
+};
+
 }  // namespace ripple
 #endif
@@ -19,10 +19,15 @@
 
 #include <ripple/app/reporting/ETLSource.h>
 #include <ripple/app/reporting/ReportingETL.h>
+#include <ripple/basics/random.h>
 #include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/json_writer.h>
 
+#include <algorithm>
+#include <array>
+
 namespace ripple {
 
 // Create ETL source without grpc endpoint
@@ -65,12 +70,12 @@ ETLSource::ETLSource(
 {
     try
     {
-        stub_ = org::xrpl::rpc::v1::XRPLedgerAPIService::NewStub(
-            grpc::CreateChannel(
-                beast::IP::Endpoint(
-                    boost::asio::ip::make_address(ip_), std::stoi(grpcPort_))
-                    .to_string(),
-                grpc::InsecureChannelCredentials()));
+        channel_ = grpc::CreateChannel(
+            beast::IP::Endpoint(
+                boost::asio::ip::make_address(ip_), std::stoi(grpcPort_))
+                .to_string(),
+            grpc::InsecureChannelCredentials());
+        stub_ = org::xrpl::rpc::v1::XRPLedgerAPIService::NewStub(channel_);
         JLOG(journal_.info()) << "Made stub for remote = " << toString();
     }
     catch (std::exception const& e)
@@ -382,6 +387,9 @@ ETLSource::handleMessage()
     }
 }
 
+/// One stream of GetLedgerData calls. The stream downloads a partition of
+/// the keyspace page by page, and when the partition is done takes another
+/// from the pool shared by all ETL sources.
 class AsyncCallData
 {
     std::unique_ptr<org::xrpl::rpc::v1::GetLedgerDataResponse> cur_;
@@ -392,36 +400,22 @@ class AsyncCallData
 
     grpc::Status status_;
 
-    unsigned char nextPrefix_;
+    LedgerDataPartitions& partitions_;
+
+    // the partition being downloaded, if any
+    std::optional<std::size_t> partition_;
 
     beast::Journal journal_;
 
 public:
     AsyncCallData(
-        uint256& marker,
-        std::optional<uint256> nextMarker,
+        LedgerDataPartitions& partitions,
         uint32_t seq,
         beast::Journal& j)
-        : journal_(j)
+        : partitions_(partitions), journal_(j)
     {
         request_.mutable_ledger()->set_sequence(seq);
-        if (marker.isNonZero())
-        {
-            request_.set_marker(marker.data(), marker.size());
-        }
         request_.set_user("ETL");
-        nextPrefix_ = 0x00;
-        if (nextMarker)
-            nextPrefix_ = nextMarker->data()[0];
-
-        unsigned char prefix = marker.data()[0];
-
-        JLOG(journal_.debug())
-            << "Setting up AsyncCallData. marker = " << strHex(marker)
-            << " . prefix = " << strHex(std::string(1, prefix))
-            << " . nextPrefix_ = " << strHex(std::string(1, nextPrefix_));
-
-        assert(nextPrefix_ > prefix || nextPrefix_ == 0x00);
 
         cur_ = std::make_unique<org::xrpl::rpc::v1::GetLedgerDataResponse>();
 
@@ -430,6 +424,43 @@ public:
         context_ = std::make_unique<grpc::ClientContext>();
     }
 
+    AsyncCallData(AsyncCallData const&) = delete;
+    AsyncCallData&
+    operator=(AsyncCallData const&) = delete;
+
+    ~AsyncCallData()
+    {
+        // hand an unfinished partition to another stream
+        if (partition_)
+            partitions_.release(*partition_);
+    }
+
+    /// Take a partition and make the first call for it
+    /// @return false if there is no work left to take
+    bool
+    start(
+        std::unique_ptr<org::xrpl::rpc::v1::XRPLedgerAPIService::Stub>& stub,
+        grpc::CompletionQueue& cq)
+    {
+        auto const assignment = partitions_.acquire();
+        if (!assignment)
+            return false;
+
+        partition_ = assignment->id;
+        auto const& marker = assignment->marker;
+        if (marker.isNonZero())
+            request_.set_marker(marker.data(), marker.size());
+        else
+            request_.clear_marker();
+
+        JLOG(journal_.debug())
+            << "Setting up AsyncCallData. partition = " << *partition_
+            << " . marker = " << strHex(marker);
+
+        call(stub, cq);
+        return true;
+    }
+
     enum class CallStatus { MORE, DONE, ERRORED };
     CallStatus
     process(
@@ -442,6 +473,7 @@ public:
         if (abort)
         {
             JLOG(journal_.error()) << "AsyncCallData aborted";
+            release();
             return CallStatus::ERRORED;
         }
         if (!status_.ok())
@@ -449,6 +481,7 @@ public:
             JLOG(journal_.debug()) << "AsyncCallData status_ not ok: "
                                    << " code = " << status_.error_code()
                                    << " message = " << status_.error_message();
+            release();
             return CallStatus::ERRORED;
         }
         if (!next_->is_unlimited())
@@ -461,27 +494,34 @@ public:
 
         std::swap(cur_, next_);
 
-        bool more = true;
+        auto const& objects = cur_->ledger_objects().objects();
+        auto const progress =
+            partitions_.advance(*partition_, cur_->marker(), objects.size());
 
-        // if no marker returned, we are done
-        if (cur_->marker().size() == 0)
-            more = false;
-
-        // if returned marker is greater than our end, we are done
-        unsigned char prefix = cur_->marker()[0];
-        if (nextPrefix_ != 0x00 && prefix >= nextPrefix_)
-            more = false;
-
-        // if we are not done, make the next async call
+        // if we are not done, make the next async call. Otherwise, help
+        // with whatever is left
+        bool more = progress.more;
         if (more)
         {
             request_.set_marker(std::move(cur_->marker()));
             call(stub, cq);
         }
+        else
+        {
+            partition_.reset();
+            more = start(stub, cq);
+        }
 
-        for (auto& obj : cur_->ledger_objects().objects())
+        for (auto& obj : objects)
         {
             auto key = uint256::fromVoid(obj.key().data());
+
+            // the partition may have been split while the call was in
+            // flight. Objects past its new end belong to another stream
+            if (progress.end &&
+                LedgerDataPartitions::position(key) >= *progress.end)
+                continue;
+
             auto& data = obj.data();
 
             SerialIter it{data.data(), data.size()};
@@ -490,6 +530,8 @@ public:
             queue.push(sle);
         }
 
+        partitions_.report(journal_);
+
         return more ? CallStatus::MORE : CallStatus::DONE;
     }
 
@@ -509,6 +551,15 @@ public:
         rpc->Finish(next_.get(), &status_, this);
     }
 
+    /// Give up the partition being downloaded
+    void
+    release()
+    {
+        if (partition_)
+            partitions_.release(*partition_);
+        partition_.reset();
+    }
+
     std::string
     getMarkerPrefix()
     {
@@ -522,7 +573,8 @@ public:
 bool
 ETLSource::loadInitialLedger(
     uint32_t sequence,
-    ThreadSafeQueue<std::shared_ptr<SLE>>& writeQueue)
+    ThreadSafeQueue<std::shared_ptr<SLE>>& writeQueue,
+    LedgerDataPartitions& partitions)
 {
     if (!stub_)
         return false;
@@ -533,22 +585,20 @@ ETLSource::loadInitialLedger(
 
     bool ok = false;
 
-    std::vector<AsyncCallData> calls;
-    std::vector<uint256> markers{getMarkers(etl_.getNumMarkers())};
-
-    for (size_t i = 0; i < markers.size(); ++i)
-    {
-        std::optional<uint256> nextMarker;
-        if (i + 1 < markers.size())
-            nextMarker = markers[i + 1];
-        calls.emplace_back(markers[i], nextMarker, sequence, journal_);
-    }
-
     JLOG(journal_.debug()) << "Starting data download for ledger " << sequence
                            << ". Using source = " << toString();
 
-    for (auto& c : calls)
-        c.call(stub_, cq);
+    std::vector<std::unique_ptr<AsyncCallData>> calls;
+    for (size_t i = 0; i < etl_.getNumMarkers(); ++i)
+    {
+        calls.push_back(
+            std::make_unique<AsyncCallData>(partitions, sequence, journal_));
+        if (!calls.back()->start(stub_, cq))
+        {
+            calls.pop_back();
+            break;
+        }
+    }
 
     size_t numFinished = 0;
     bool abort = false;
@@ -562,6 +612,7 @@ ETLSource::loadInitialLedger(
         if (!ok)
         {
             JLOG(journal_.error()) << "loadInitialLedger - ok is false";
+            ptr->release();
             return false;
             // handle cancelled
         }
@@ -647,18 +698,62 @@ ETLLoadBalancer::loadInitialLedger(
     uint32_t sequence,
     ThreadSafeQueue<std::shared_ptr<SLE>>& writeQueue)
 {
-    execute(
-        [this, &sequence, &writeQueue](auto& source) {
-            bool res = source->loadInitialLedger(sequence, writeQueue);
-            if (!res)
+    // Every source that has the ledger downloads from the same pool of
+    // partitions, so a fast source takes work from a slow one, and a source
+    // that fails leaves its partitions to the others
+    LedgerDataPartitions partitions{etl_.getNumMarkers()};
+
+    while (!etl_.isStopping() && !partitions.complete())
+    {
+        std::vector<ETLSource*> ready;
+        for (auto& source : sources_)
+        {
+            if (!source->hasLedger(sequence))
             {
-                JLOG(journal_.error()) << "Failed to download initial ledger. "
-                                       << " Sequence = " << sequence
-                                       << " source = " << source->toString();
+                JLOG(journal_.warn())
+                    << __func__ << " : "
+                    << "Ledger not present at source = " << source->toString()
+                    << " - ledger sequence = " << sequence;
+                continue;
             }
-            return res;
-        },
-        sequence);
+            ready.push_back(source.get());
+        }
+
+        // The sources download at the same time
+        etl_.getApplication().getWorkerPool().run(
+            ready.size(), [&](std::size_t i) {
+                if (!ready[i]->loadInitialLedger(
+                        sequence, writeQueue, partitions))
+                {
+                    JLOG(journal_.error())
+                        << "Failed to download initial ledger. "
+                        << " Sequence = " << sequence
+                        << " source = " << ready[i]->toString();
+                }
+            });
+
+        if (etl_.isStopping() || partitions.complete())
+            break;
+
+        // If another process loaded the ledger into the database, we can
+        // abort trying to fetch the ledger from a transaction processing
+        // process
+        if (etl_.getApplication().getLedgerMaster().getLedgerBySeq(sequence))
+        {
+            JLOG(journal_.warn())
+                << __func__ << " : "
+                << "Tried all sources, but ledger was found in db."
+                << " Sequence = " << sequence;
+            break;
+        }
+        JLOG(journal_.error())
+            << __func__ << " : "
+            << "Failed to download initial ledger "
+            << " - ledger sequence = " << sequence
+            << " - Tried all sources. Sleeping and trying again";
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+    }
+    partitions.report(journal_, true);
 }
 
 std::optional<org::xrpl::rpc::v1::GetLedgerResponse>
@@ -695,45 +790,108 @@ ETLLoadBalancer::fetchLedger(uint32_t ledgerSequence, bool getObjects)
         return {};
 }
 
+std::vector<ETLSource*>
+ETLLoadBalancer::forwardingOrder() const
+{
+    std::vector<ETLSource*> order;
+    order.reserve(sources_.size());
+    for (auto const& source : sources_)
+        order.push_back(source.get());
+
+    // Shuffle first so that sources with equal latency, and in particular
+    // the sources not measured yet, share the load
+    std::shuffle(order.begin(), order.end(), default_prng());
+    std::stable_sort(
+        order.begin(), order.end(), [](ETLSource* a, ETLSource* b) {
+            return a->getForwardLatency() < b->getForwardLatency();
+        });
+    return order;
+}
+
 std::unique_ptr<org::xrpl::rpc::v1::XRPLedgerAPIService::Stub>
 ETLLoadBalancer::getP2pForwardingStub() const
 {
-    if (sources_.size() == 0)
-        return nullptr;
-    srand((unsigned)time(0));
-    auto sourceIdx = rand() % sources_.size();
-    auto numAttempts = 0;
-    while (numAttempts < sources_.size())
+    for (auto source : forwardingOrder())
     {
-        auto stub = sources_[sourceIdx]->getP2pForwardingStub();
-        if (!stub)
-        {
-            sourceIdx = (sourceIdx + 1) % sources_.size();
-            ++numAttempts;
-            continue;
-        }
-        return stub;
+        if (auto stub = source->getP2pForwardingStub())
+            return stub;
     }
     return nullptr;
 }
 
+std::string
+ETLLoadBalancer::forwardCacheKey(RPC::JsonContext const& context)
+{
+    // Methods whose response depends only on the current or closed ledger
+    // and on server state, never on who is asking
+    static std::array<char const*, 5> const cacheable{
+        {"fee", "ledger_closed", "ledger_current", "server_info",
+         "server_state"}};
+
+    Json::Value const& params = context.params;
+    std::string const method = params.isMember(jss::command)
+        ? params[jss::command].asString()
+        : params[jss::method].asString();
+    if (std::find(cacheable.begin(), cacheable.end(), method) ==
+        cacheable.end())
+        return {};
+
+    // Admin and identified clients can see more than guests
+    Json::Value request = params;
+    request.removeMember(jss::id);
+    return std::to_string(static_cast<int>(context.role)) + ":" +
+        Json::FastWriter().write(request);
+}
+
 Json::Value
 ETLLoadBalancer::forwardToP2p(RPC::JsonContext& context) const
 {
     Json::Value res;
     if (sources_.size() == 0)
         return res;
-    srand((unsigned)time(0));
-    auto sourceIdx = rand() % sources_.size();
-    auto numAttempts = 0;
-    while (numAttempts < sources_.size())
+
+    auto const key = forwardCacheKey(context);
+    if (!key.empty())
     {
-        res = sources_[sourceIdx]->forwardToP2p(context);
-        if (!res.isMember("forwarded") || res["forwarded"] != true)
+        std::lock_guard lock(forwardCacheMtx_);
+        auto const it = forwardCache_.find(key);
+        if (it != forwardCache_.end() &&
+            it->second.expires > std::chrono::steady_clock::now())
         {
-            sourceIdx = (sourceIdx + 1) % sources_.size();
-            ++numAttempts;
+            res = it->second.response;
+            // The cached response carries the id of the request it answered
+            if (context.params.isMember(jss::id))
+                res[jss::id] = context.params[jss::id];
+            else
+                res.removeMember(jss::id);
+            JLOG(journal_.trace()) << "Answered forwarded request from cache";
+            return res;
+        }
+    }
+
+    for (auto source : forwardingOrder())
+    {
+        res = source->forwardToP2p(context);
+        if (!res.isMember("forwarded") || res["forwarded"] != true)
             continue;
+
+        if (!key.empty() && !res.isMember(jss::error))
+        {
+            auto const now = std::chrono::steady_clock::now();
+            std::lock_guard lock(forwardCacheMtx_);
+            if (forwardCache_.size() >= maxForwardCacheSize)
+            {
+                for (auto it = forwardCache_.begin();
+                     it != forwardCache_.end();)
+                {
+                    if (it->second.expires <= now)
+                        it = forwardCache_.erase(it);
+                    else
+                        ++it;
+                }
+            }
+            if (forwardCache_.size() < maxForwardCacheSize)
+                forwardCache_[key] = {res, now + forwardCacheTTL};
         }
         return res;
     }
@@ -745,21 +903,116 @@ ETLLoadBalancer::forwardToP2p(RPC::JsonContext& context) const
 std::unique_ptr<org::xrpl::rpc::v1::XRPLedgerAPIService::Stub>
 ETLSource::getP2pForwardingStub() const
 {
-    if (!connected_)
+    if (!connected_ || !channel_)
         return nullptr;
-    try
+    return org::xrpl::rpc::v1::XRPLedgerAPIService::NewStub(channel_);
+}
+
+std::unique_ptr<ETLSource::ForwardStream>
+ETLSource::takeForwardConnection(std::string const& client) const
+{
+    auto const now = std::chrono::steady_clock::now();
+    std::unique_ptr<ForwardStream> ws;
+    std::vector<std::unique_ptr<ForwardStream>> stale;
     {
-        return org::xrpl::rpc::v1::XRPLedgerAPIService::NewStub(
-            grpc::CreateChannel(
-                beast::IP::Endpoint(
-                    boost::asio::ip::make_address(ip_), std::stoi(grpcPort_))
-                    .to_string(),
-                grpc::InsecureChannelCredentials()));
+        std::lock_guard lock(forwardMtx_);
+        for (auto it = forwardPool_.begin(); it != forwardPool_.end();)
+        {
+            if (now - it->lastUsed > forwardIdleTimeout)
+            {
+                stale.push_back(std::move(it->ws));
+                it = forwardPool_.erase(it);
+            }
+            else if (!ws && it->client == client)
+            {
+                ws = std::move(it->ws);
+                it = forwardPool_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
     }
-    catch (std::exception const&)
+
+    // Close outside the lock; the peer may have dropped these already
+    for (auto& s : stale)
     {
-        JLOG(journal_.error()) << "Failed to create grpc stub";
-        return nullptr;
+        boost::system::error_code ec;
+        s->next_layer().close(ec);
+    }
+    return ws;
+}
+
+std::unique_ptr<ETLSource::ForwardStream>
+ETLSource::connectForward(std::string const& client) const
+{
+    namespace beast = boost::beast;          // from <boost/beast.hpp>
+    namespace http = beast::http;            // from <boost/beast/http.hpp>
+    namespace websocket = beast::websocket;  // from <boost/beast/websocket.hpp>
+    namespace net = boost::asio;             // from <boost/asio.hpp>
+    using tcp = boost::asio::ip::tcp;        // from <boost/asio/ip/tcp.hpp>
+
+    // These objects perform our I/O
+    tcp::resolver resolver{forwardIoc_};
+
+    JLOG(journal_.debug()) << "Creating websocket";
+    auto ws = std::make_unique<ForwardStream>(forwardIoc_);
+
+    // Look up the domain name
+    auto const results = resolver.resolve(ip_, wsPort_);
+
+    JLOG(journal_.debug()) << "Connecting websocket";
+    // Make the connection on the IP address we get from a lookup
+    net::connect(ws->next_layer(), results.begin(), results.end());
+
+    // Set a decorator to change the User-Agent of the handshake
+    // and to tell rippled to charge the client IP for RPC
+    // resources. See "secure_gateway" in
+    // https://github.com/ripple/rippled/blob/develop/cfg/rippled-example.cfg
+    ws->set_option(websocket::stream_base::decorator(
+        [client](websocket::request_type& req) {
+            req.set(
+                http::field::user_agent,
+                std::string(BOOST_BEAST_VERSION_STRING) +
+                    " websocket-client-coro");
+            req.set(http::field::forwarded, "for=" + client);
+        }));
+    JLOG(journal_.debug()) << "client ip: " << client;
+
+    JLOG(journal_.debug()) << "Performing websocket handshake";
+    // Perform the websocket handshake
+    ws->handshake(ip_, "/");
+    return ws;
+}
+
+void
+ETLSource::releaseForwardConnection(
+    std::string const& client,
+    std::unique_ptr<ForwardStream> ws) const
+{
+    std::unique_ptr<ForwardStream> evicted;
+    {
+        std::lock_guard lock(forwardMtx_);
+        if (forwardPool_.size() >= maxIdleForwardConnections)
+        {
+            auto const oldest = std::min_element(
+                forwardPool_.begin(),
+                forwardPool_.end(),
+                [](auto const& a, auto const& b) {
+                    return a.lastUsed < b.lastUsed;
+                });
+            evicted = std::move(oldest->ws);
+            forwardPool_.erase(oldest);
+        }
+        forwardPool_.push_back(
+            {client, std::move(ws), std::chrono::steady_clock::now()});
+    }
+
+    if (evicted)
+    {
+        boost::system::error_code ec;
+        evicted->next_layer().close(ec);
     }
 }
 
@@ -776,75 +1029,67 @@ ETLSource::forwardToP2p(RPC::JsonContext& context) const
             << "Attempted to proxy but failed to connect to tx";
         return response;
     }
-    namespace beast = boost::beast;          // from <boost/beast.hpp>
-    namespace http = beast::http;            // from <boost/beast/http.hpp>
-    namespace websocket = beast::websocket;  // from <boost/beast/websocket.hpp>
-    namespace net = boost::asio;             // from <boost/asio.hpp>
-    using tcp = boost::asio::ip::tcp;        // from <boost/asio/ip/tcp.hpp>
-    Json::Value& request = context.params;
-    try
-    {
-        // The io_context is required for all I/O
-        net::io_context ioc;
-
-        // These objects perform our I/O
-        tcp::resolver resolver{ioc};
-
-        JLOG(journal_.debug()) << "Creating websocket";
-        auto ws = std::make_unique<websocket::stream<tcp::socket>>(ioc);
-
-        // Look up the domain name
-        auto const results = resolver.resolve(ip_, wsPort_);
-
-        JLOG(journal_.debug()) << "Connecting websocket";
-        // Make the connection on the IP address we get from a lookup
-        net::connect(ws->next_layer(), results.begin(), results.end());
-
-        // Set a decorator to change the User-Agent of the handshake
-        // and to tell rippled to charge the client IP for RPC
-        // resources. See "secure_gateway" in
-        // https://github.com/ripple/rippled/blob/develop/cfg/rippled-example.cfg
-        ws->set_option(websocket::stream_base::decorator(
-            [&context](websocket::request_type& req) {
-                req.set(
-                    http::field::user_agent,
-                    std::string(BOOST_BEAST_VERSION_STRING) +
-                        " websocket-client-coro");
-                req.set(
-                    http::field::forwarded,
-                    "for=" + context.consumer.to_string());
-            }));
-        JLOG(journal_.debug()) << "client ip: " << context.consumer.to_string();
 
-        JLOG(journal_.debug()) << "Performing websocket handshake";
-        // Perform the websocket handshake
-        ws->handshake(ip_, "/");
+    auto const client = context.consumer.to_string();
+    auto const request = Json::FastWriter().write(context.params);
 
-        Json::FastWriter fastWriter;
+    // A pooled connection may have been closed by the p2p node while it sat
+    // idle, so a failure on one is retried once on a fresh connection
+    auto ws = takeForwardConnection(client);
+    bool reused = ws != nullptr;
+    while (true)
+    {
+        try
+        {
+            auto const start = std::chrono::steady_clock::now();
+            if (!ws)
+                ws = connectForward(client);
 
-        JLOG(journal_.debug()) << "Sending request";
-        // Send the message
-        ws->write(net::buffer(fastWriter.write(request)));
+            JLOG(journal_.debug()) << "Sending request";
+            // Send the message
+            ws->write(boost::asio::buffer(request));
 
-        beast::flat_buffer buffer;
-        ws->read(buffer);
+            boost::beast::flat_buffer buffer;
+            ws->read(buffer);
 
-        Json::Reader reader;
-        if (!reader.parse(
-                static_cast<char const*>(buffer.data().data()), response))
+            Json::Reader reader;
+            if (!reader.parse(
+                    boost::beast::buffers_to_string(buffer.data()), response))
+            {
+                JLOG(journal_.error()) << "Error parsing response";
+                response[jss::error] = "Error parsing response from tx";
+            }
+            JLOG(journal_.debug()) << "Successfully forward request";
+
+            releaseForwardConnection(client, std::move(ws));
+
+            // Weight each new sample by 1/8
+            auto const elapsed =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+            auto latency = forwardLatency_.load();
+            while (!forwardLatency_.compare_exchange_weak(
+                latency, latency == 0 ? elapsed : (7 * latency + elapsed) / 8))
+                ;
+
+            response["forwarded"] = true;
+            return response;
+        }
+        catch (std::exception const& e)
         {
-            JLOG(journal_.error()) << "Error parsing response";
-            response[jss::error] = "Error parsing response from tx";
+            ws.reset();
+            response = Json::Value{};
+            if (reused)
+            {
+                JLOG(journal_.debug())
+                    << "Pooled connection failed, reconnecting : " << e.what();
+                reused = false;
+                continue;
+            }
+            JLOG(journal_.error()) << "Encountered exception : " << e.what();
+            return response;
         }
-        JLOG(journal_.debug()) << "Successfully forward request";
-
-        response["forwarded"] = true;
-        return response;
-    }
-    catch (std::exception const& e)
-    {
-        JLOG(journal_.error()) << "Encountered exception : " << e.what();
-        return response;
     }
 }
 
@@ -21,6 +21,7 @@
 #define RIPPLE_APP_REPORTING_ETLSOURCE_H_INCLUDED
 #include <ripple/app/main/Application.h>
 #include <ripple/app/reporting/ETLHelpers.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/protocol/STLedgerEntry.h>
 #include <ripple/rpc/Context.h>
 
@@ -56,6 +57,10 @@ class ETLSource
     // a reference to the applications io_service
     boost::asio::io_context& ioc_;
 
+    // gRPC channels multiplex requests over one HTTP/2 connection, so a
+    // single channel is shared by ETL and by forwarded gRPC requests
+    std::shared_ptr<grpc::Channel> channel_;
+
     std::unique_ptr<org::xrpl::rpc::v1::XRPLedgerAPIService::Stub> stub_;
 
     std::unique_ptr<boost::beast::websocket::stream<boost::beast::tcp_stream>>
@@ -95,6 +100,47 @@ class ETLSource
     // used for retrying connections
     boost::asio::steady_timer timer_;
 
+    using ForwardStream =
+        boost::beast::websocket::stream<boost::asio::ip::tcp::socket>;
+
+    // An idle websocket connection used to forward requests. The p2p node
+    // charges resources to the client named in the Forwarded header of the
+    // handshake, so a connection is only reused for the same client.
+    struct ForwardConnection
+    {
+        std::string client;
+        std::unique_ptr<ForwardStream> ws;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    // Connections idle for longer than this are closed rather than reused
+    static constexpr std::chrono::seconds forwardIdleTimeout{30};
+    static constexpr std::size_t maxIdleForwardConnections = 16;
+
+    // Forwarding uses blocking I/O on the calling thread, which needs no
+    // running io_context
+    mutable boost::asio::io_context forwardIoc_;
+    mutable std::vector<ForwardConnection> forwardPool_;
+    mutable std::mutex forwardMtx_;
+
+    // Moving average of the time taken to forward a request, in
+    // microseconds. 0 until the first request is forwarded
+    mutable std::atomic<std::int64_t> forwardLatency_ = 0;
+
+    /// Take an idle forwarding connection for the client, if there is one
+    std::unique_ptr<ForwardStream>
+    takeForwardConnection(std::string const& client) const;
+
+    /// Open a new forwarding connection on behalf of the client
+    std::unique_ptr<ForwardStream>
+    connectForward(std::string const& client) const;
+
+    /// Return a forwarding connection to the pool once its response is read
+    void
+    releaseForwardConnection(
+        std::string const& client,
+        std::unique_ptr<ForwardStream> ws) const;
+
 public:
     bool
     isConnected() const
@@ -102,6 +148,14 @@ public:
         return connected_;
     }
 
+    /// @return moving average of the time taken to forward a request, or
+    /// zero if no request has been forwarded yet
+    std::chrono::microseconds
+    getForwardLatency() const
+    {
+        return std::chrono::microseconds{forwardLatency_.load()};
+    }
+
     std::chrono::system_clock::time_point
     getLastMsgTime() const
     {
@@ -235,6 +289,9 @@ public:
         result["ip"] = ip_;
         result["websocket_port"] = wsPort_;
         result["grpc_port"] = grpcPort_;
+        if (auto const latency = getForwardLatency(); latency.count() != 0)
+            result["forward_latency_us"] =
+                static_cast<Json::UInt>(latency.count());
         auto last = getLastMsgTime();
         if (last.time_since_epoch().count() != 0)
             result["last_message_arrival_time"] =
@@ -242,14 +299,17 @@ public:
         return result;
     }
 
-    /// Download a ledger in full
+    /// Download a ledger in full, or help to. Partitions of the keyspace are
+    /// taken from the pool until none remain
     /// @param ledgerSequence sequence of the ledger to download
     /// @param writeQueue queue to push downloaded ledger objects
+    /// @param partitions pool of partitions shared with other sources
     /// @return true if the download was successful
     bool
     loadInitialLedger(
         uint32_t ledgerSequence,
-        ThreadSafeQueue<std::shared_ptr<SLE>>& writeQueue);
+        ThreadSafeQueue<std::shared_ptr<SLE>>& writeQueue,
+        LedgerDataPartitions& partitions);
 
     /// Begin sequence of operations to connect to the ETL source and subscribe
     /// to ledgers and transactions_proposed
@@ -299,7 +359,8 @@ public:
     std::unique_ptr<org::xrpl::rpc::v1::XRPLedgerAPIService::Stub>
     getP2pForwardingStub() const;
 
-    /// Forward a JSON RPC request to a p2p node
+    /// Forward a JSON RPC request to a p2p node. Connections are kept open
+    /// and reused for later requests from the same client
     /// @param context context of RPC request
     /// @return response received from ETL source
     Json::Value
@@ -321,6 +382,30 @@ private:
 
     std::vector<std::unique_ptr<ETLSource>> sources_;
 
+    // Recent responses to forwarded requests whose answer changes at most
+    // once per ledger, keyed on the request without its id
+    struct CachedResponse
+    {
+        Json::Value response;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    static constexpr std::chrono::milliseconds forwardCacheTTL{1000};
+    static constexpr std::size_t maxForwardCacheSize = 256;
+
+    mutable hash_map<std::string, CachedResponse> forwardCache_;
+    mutable std::mutex forwardCacheMtx_;
+
+    /// @return the key to cache the response to the request under, or an
+    /// empty string if the response should not be cached
+    static std::string
+    forwardCacheKey(RPC::JsonContext const& context);
+
+    /// @return sources in the order forwarded requests should try them:
+    /// fastest first, with sources not yet measured ahead of the rest
+    std::vector<ETLSource*>
+    forwardingOrder() const;
+
 public:
     ETLLoadBalancer(ReportingETL& etl);
 
@@ -339,7 +424,8 @@ public:
     void
     add(std::string& host, std::string& websocketPort);
 
-    /// Load the initial ledger, writing data to the queue
+    /// Load the initial ledger, writing data to the queue. Every source that
+    /// has the ledger downloads a share of it
     /// @param sequence sequence of ledger to download
     /// @param writeQueue queue to push downloaded data to
     void
@@ -404,12 +490,15 @@ public:
         return ret;
     }
 
-    /// Randomly select a p2p node to forward a gRPC request to
+    /// Select a p2p node to forward a gRPC request to, preferring the
+    /// fastest
     /// @return gRPC stub to forward requests to p2p node
     std::unique_ptr<org::xrpl::rpc::v1::XRPLedgerAPIService::Stub>
     getP2pForwardingStub() const;
 
-    /// Forward a JSON RPC request to a randomly selected p2p node
+    /// Forward a JSON RPC request to a p2p node, preferring the fastest.
+    /// Responses to fee, server_info and similar requests are cached briefly
+    /// so that bursts of them are not all forwarded
     /// @param context context of the request
     /// @return response received from p2p node
     Json::Value
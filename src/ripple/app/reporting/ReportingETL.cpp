@@ -21,6 +21,7 @@
 #include <ripple/app/reporting/ReportingETL.h>
 
 #include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/json_writer.h>
 #include <boost/asio/connect.hpp>
@@ -70,35 +71,98 @@ ReportingETL::consumeLedgerData(
     }
 }
 
-std::vector<AccountTransactionsData>
-ReportingETL::insertTransactions(
-    std::shared_ptr<Ledger>& ledger,
-    org::xrpl::rpc::v1::GetLedgerResponse& data)
+/// Ledger data extracted from an ETL source and deserialized, ready to be
+/// applied to the parent ledger
+struct DecodedLedger
 {
+    struct Transaction
+    {
+        uint256 id;
+        std::shared_ptr<Serializer const> txn;
+        std::shared_ptr<Serializer const> meta;
+    };
+
+    LedgerInfo info;
+    std::vector<Transaction> transactions;
+
+    /// One entry for each transaction. The nodestore hashes are filled in
+    /// when the transactions are inserted into the ledger
     std::vector<AccountTransactionsData> accountTxData;
-    for (auto& txn : data.transactions_list().transactions())
+
+    /// Objects created, modified or deleted. A deleted object has no SLE
+    std::vector<std::pair<uint256, std::shared_ptr<SLE>>> objects;
+
+    bool skiplistIncluded = false;
+};
+
+DecodedLedger
+ReportingETL::decodeLedger(org::xrpl::rpc::v1::GetLedgerResponse& rawData)
+{
+    DecodedLedger decoded;
+    decoded.info = deserializeHeader(makeSlice(rawData.ledger_header()), true);
+
+    JLOG(journal_.debug()) << __func__ << " : "
+                           << "Deserialized ledger header. "
+                           << detail::toString(decoded.info);
+
+    auto& txns = rawData.transactions_list().transactions();
+    decoded.transactions.reserve(txns.size());
+    decoded.accountTxData.reserve(txns.size());
+    for (auto& txn : txns)
     {
         auto& raw = txn.transaction_blob();
 
         SerialIter it{raw.data(), raw.size()};
         STTx sttx{it};
 
-        auto txSerializer = std::make_shared<Serializer>(sttx.getSerializer());
-
         TxMeta txMeta{
-            sttx.getTransactionID(), ledger->info().seq, txn.metadata_blob()};
+            sttx.getTransactionID(), decoded.info.seq, txn.metadata_blob()};
+
+        decoded.transactions.push_back(
+            {sttx.getTransactionID(),
+             std::make_shared<Serializer>(sttx.getSerializer()),
+             std::make_shared<Serializer>(
+                 txMeta.getAsObject().getSerializer())});
+        decoded.accountTxData.emplace_back(txMeta, uint256{}, journal_);
+    }
 
-        auto metaSerializer =
-            std::make_shared<Serializer>(txMeta.getAsObject().getSerializer());
+    auto& objects = rawData.ledger_objects().objects();
+    decoded.objects.reserve(objects.size());
+    for (auto& obj : objects)
+    {
+        auto key = uint256::fromVoid(obj.key().data());
+        auto& data = obj.data();
 
-        JLOG(journal_.trace())
-            << __func__ << " : "
-            << "Inserting transaction = " << sttx.getTransactionID();
-        uint256 nodestoreHash = ledger->rawTxInsertWithHash(
-            sttx.getTransactionID(), txSerializer, metaSerializer);
-        accountTxData.emplace_back(txMeta, std::move(nodestoreHash), journal_);
+        // an empty blob indicates the object was deleted
+        std::shared_ptr<SLE> sle;
+        if (data.size() != 0)
+        {
+            SerialIter it{data.data(), data.size()};
+            sle = std::make_shared<SLE>(it, key);
+        }
+        decoded.objects.emplace_back(key, std::move(sle));
+    }
+
+    decoded.skiplistIncluded = rawData.skiplist_included();
+    return decoded;
+}
+
+std::vector<AccountTransactionsData>
+ReportingETL::insertTransactions(
+    std::shared_ptr<Ledger>& ledger,
+    DecodedLedger& data)
+{
+    assert(data.transactions.size() == data.accountTxData.size());
+    for (std::size_t i = 0; i < data.transactions.size(); ++i)
+    {
+        auto const& txn = data.transactions[i];
+
+        JLOG(journal_.trace()) << __func__ << " : "
+                               << "Inserting transaction = " << txn.id;
+        data.accountTxData[i].nodestoreHash =
+            ledger->rawTxInsertWithHash(txn.id, txn.txn, txn.meta);
     }
-    return accountTxData;
+    return std::move(data.accountTxData);
 }
 
 std::shared_ptr<Ledger>
@@ -123,21 +187,16 @@ ReportingETL::loadInitialLedger(uint32_t startingSequence)
     if (!ledgerData)
         return {};
 
-    LedgerInfo lgrInfo =
-        deserializeHeader(makeSlice(ledgerData->ledger_header()), true);
+    DecodedLedger decoded = decodeLedger(*ledgerData);
 
-    JLOG(journal_.debug()) << __func__ << " : "
-                           << "Deserialized ledger header. "
-                           << detail::toString(lgrInfo);
-
-    ledger =
-        std::make_shared<Ledger>(lgrInfo, app_.config(), app_.getNodeFamily());
+    ledger = std::make_shared<Ledger>(
+        decoded.info, app_.config(), app_.getNodeFamily());
     ledger->stateMap().clearSynching();
     ledger->txMap().clearSynching();
 
 #ifdef RIPPLED_REPORTING
     std::vector<AccountTransactionsData> accountTxData =
-        insertTransactions(ledger, *ledgerData);
+        insertTransactions(ledger, decoded);
 #endif
 
     auto start = std::chrono::system_clock::now();
@@ -162,6 +221,7 @@ ReportingETL::loadInitialLedger(uint32_t startingSequence)
     if (!stopping_)
     {
         flushLedger(ledger);
+        app_.getNodeStore().sync();
         if (app_.config().reporting())
         {
 #ifdef RIPPLED_REPORTING
@@ -205,8 +265,6 @@ ReportingETL::flushLedger(std::shared_ptr<Ledger>& ledger)
             ledger->info().seq);
     }
 
-    app_.getNodeStore().sync();
-
     auto end = std::chrono::system_clock::now();
 
     JLOG(journal_.debug()) << __func__ << " : "
@@ -375,38 +433,28 @@ ReportingETL::fetchLedgerDataAndDiff(uint32_t idx)
 std::pair<std::shared_ptr<Ledger>, std::vector<AccountTransactionsData>>
 ReportingETL::buildNextLedger(
     std::shared_ptr<Ledger>& next,
-    org::xrpl::rpc::v1::GetLedgerResponse& rawData)
+    DecodedLedger& data)
 {
     JLOG(journal_.info()) << __func__ << " : "
                           << "Beginning ledger update";
 
-    LedgerInfo lgrInfo =
-        deserializeHeader(makeSlice(rawData.ledger_header()), true);
-
-    JLOG(journal_.debug()) << __func__ << " : "
-                           << "Deserialized ledger header. "
-                           << detail::toString(lgrInfo);
-
-    next->setLedgerInfo(lgrInfo);
+    next->setLedgerInfo(data.info);
 
     next->stateMap().clearSynching();
     next->txMap().clearSynching();
 
     std::vector<AccountTransactionsData> accountTxData{
-        insertTransactions(next, rawData)};
+        insertTransactions(next, data)};
 
     JLOG(journal_.debug())
         << __func__ << " : "
         << "Inserted all transactions. Number of transactions  = "
-        << rawData.transactions_list().transactions_size();
+        << data.transactions.size();
 
-    for (auto& obj : rawData.ledger_objects().objects())
+    for (auto& [key, sle] : data.objects)
     {
-        auto key = uint256::fromVoid(obj.key().data());
-        auto& data = obj.data();
-
         // indicates object was deleted
-        if (data.size() == 0)
+        if (!sle)
         {
             JLOG(journal_.trace()) << __func__ << " : "
                                    << "Erasing object = " << key;
@@ -415,9 +463,6 @@ ReportingETL::buildNextLedger(
         }
         else
         {
-            SerialIter it{data.data(), data.size()};
-            std::shared_ptr<SLE> sle = std::make_shared<SLE>(it, key);
-
             if (next->exists(key))
             {
                 JLOG(journal_.trace()) << __func__ << " : "
@@ -435,9 +480,9 @@ ReportingETL::buildNextLedger(
     JLOG(journal_.debug())
         << __func__ << " : "
         << "Inserted/modified/deleted all objects. Number of objects = "
-        << rawData.ledger_objects().objects_size();
+        << data.objects.size();
 
-    if (!rawData.skiplist_included())
+    if (!data.skiplistIncluded)
     {
         next->updateSkipList();
         JLOG(journal_.warn())
@@ -459,24 +504,38 @@ std::optional<uint32_t>
 ReportingETL::runETLPipeline(uint32_t startSequence)
 {
     /*
-     * Behold, mortals! This function spawns three separate threads, which talk
-     * to each other via 2 different thread safe queues and 1 atomic variable.
-     * All threads and queues are function local. This function returns when all
-     * of the threads exit. There are two termination conditions: the first is
-     * if the load thread encounters a write conflict. In this case, the load
-     * thread sets writeConflict, an atomic bool, to true, which signals the
-     * other threads to stop. The second termination condition is when the
-     * entire server is shutting down, which is detected in one of three ways:
+     * Behold, mortals! This function spawns an extract thread, a transform
+     * thread and a load thread. They talk to each other via 2 thread safe
+     * queues and 1 atomic variable. All threads and queues are function
+     * local. This function returns when all of the threads exit.
+     *
+     * The extract thread fetches ledgers from the ETL source in sequence and
+     * pushes them onto the transform queue. The transform thread takes
+     * whatever ledgers are waiting on the transform queue, up to
+     * transformThreads_, and deserializes them at once on the application's
+     * worker pool; this does not depend on the parent ledger. It then
+     * applies each to its parent, strictly in sequence, pushing the result
+     * onto the load queue.
+     * The load thread writes whatever ledgers are waiting on the load queue,
+     * up to loadBatchSize_, in one batch: it flushes them all to the
+     * key-value store with a single sync, writes them to Postgres in one
+     * transaction, and publishes them in order.
+     *
+     * There are two termination conditions: the first is if the load thread
+     * encounters a write conflict. In this case, the load thread sets
+     * writeConflict, an atomic bool, to true, which signals the other threads
+     * to stop. The second termination condition is when the entire server is
+     * shutting down, which is detected in one of three ways:
      * 1. isStopping() returns true if the server is shutting down
      * 2. networkValidatedLedgers_.waitUntilValidatedByNetwork returns
      * false, signaling the wait was aborted.
      * 3. fetchLedgerDataAndDiff returns an empty optional, signaling the fetch
      * was aborted.
-     * In all cases, the extract thread detects this condition,
-     * and pushes an empty optional onto the transform queue. The transform
-     * thread, upon popping an empty optional, pushes an empty optional onto the
-     * load queue, and then returns. The load thread, upon popping an empty
-     * optional, returns.
+     * In all cases, the extract thread detects this condition and pushes an
+     * empty optional onto the transform queue. The transform thread, upon
+     * popping an empty optional, pushes an empty optional onto the load
+     * queue and returns. The load thread, upon popping an empty optional,
+     * returns.
      */
 
     JLOG(journal_.debug()) << __func__ << " : "
@@ -494,8 +553,11 @@ ReportingETL::runETLPipeline(uint32_t startSequence)
     std::atomic_bool writeConflict = false;
     std::optional<uint32_t> lastPublishedSequence;
     constexpr uint32_t maxQueueSize = 1000;
+    auto const transformBatchSize =
+        std::max<std::size_t>(transformThreads_, 1);
 
-    ThreadSafeQueue<std::optional<org::xrpl::rpc::v1::GetLedgerResponse>>
+    ThreadSafeQueue<std::optional<
+        std::pair<uint32_t, org::xrpl::rpc::v1::GetLedgerResponse>>>
         transformQueue{maxQueueSize};
 
     std::thread extracter{[this,
@@ -520,12 +582,6 @@ ReportingETL::runETLPipeline(uint32_t startSequence)
                 fetchLedgerDataAndDiff(currentSequence)};
             auto end = std::chrono::system_clock::now();
 
-            auto time = ((end - start).count()) / 1000000000.0;
-            auto tps =
-                fetchResponse->transactions_list().transactions_size() / time;
-
-            JLOG(journal_.debug()) << "Extract phase time = " << time
-                                   << " . Extract phase tps = " << tps;
             // if the fetch is unsuccessful, stop. fetchLedger only returns
             // false if the server is shutting down, or if the ledger was
             // found in the database (which means another process already
@@ -538,7 +594,15 @@ ReportingETL::runETLPipeline(uint32_t startSequence)
                 break;
             }
 
-            transformQueue.push(std::move(fetchResponse));
+            auto time = ((end - start).count()) / 1000000000.0;
+            auto tps =
+                fetchResponse->transactions_list().transactions_size() / time;
+
+            JLOG(journal_.debug()) << "Extract phase time = " << time
+                                   << " . Extract phase tps = " << tps;
+
+            transformQueue.push(
+                std::make_pair(currentSequence, std::move(*fetchResponse)));
             ++currentSequence;
         }
         // empty optional tells the transformer to shut down
@@ -552,39 +616,75 @@ ReportingETL::runETLPipeline(uint32_t startSequence)
     std::thread transformer{[this,
                              &parent,
                              &writeConflict,
+                             &transformQueue,
                              &loadQueue,
-                             &transformQueue]() {
+                             &transformBatchSize]() {
         beast::setCurrentThreadName("rippled: ReportingETL transform");
 
         assert(parent);
         parent = std::make_shared<Ledger>(*parent, NetClock::time_point{});
-        while (!writeConflict)
+        std::vector<org::xrpl::rpc::v1::GetLedgerResponse> batch;
+        std::vector<DecodedLedger> decoded;
+        bool done = false;
+        while (!done && !writeConflict)
         {
-            std::optional<org::xrpl::rpc::v1::GetLedgerResponse> fetchResponse{
-                transformQueue.pop()};
-            // if fetchResponse is an empty optional, the extracter thread has
+            batch.clear();
+            auto fetched = transformQueue.pop();
+            // if fetched is an empty optional, the extracter thread has
             // stopped and the transformer should stop as well
-            if (!fetchResponse)
-            {
+            if (!fetched)
                 break;
-            }
-            if (isStopping())
-                continue;
+            batch.push_back(std::move(fetched->second));
 
-            auto start = std::chrono::system_clock::now();
-            auto [next, accountTxData] =
-                buildNextLedger(parent, *fetchResponse);
-            auto end = std::chrono::system_clock::now();
+            // Take whatever else is ready, so that a backlog is decoded in
+            // parallel. A single ledger is never delayed to fill a batch
+            while (batch.size() < transformBatchSize)
+            {
+                auto more = transformQueue.tryPop();
+                if (!more)
+                    break;
+                if (!*more)
+                {
+                    done = true;
+                    break;
+                }
+                batch.push_back(std::move((*more)->second));
+            }
+            if (writeConflict || isStopping())
+                break;
 
-            auto duration = ((end - start).count()) / 1000000000.0;
-            JLOG(journal_.debug()) << "transform time = " << duration;
-            // The below line needs to execute before pushing to the queue, in
-            // order to prevent this thread and the loader thread from accessing
-            // the same SHAMap concurrently
-            parent = std::make_shared<Ledger>(*next, NetClock::time_point{});
-            loadQueue.push(
-                std::make_pair(std::move(next), std::move(accountTxData)));
+            // Deserializing does not depend on the parent ledger
+            auto const decodeStart = std::chrono::system_clock::now();
+            decoded.clear();
+            decoded.resize(batch.size());
+            app_.getWorkerPool().run(batch.size(), [&](std::size_t i) {
+                decoded[i] = decodeLedger(batch[i]);
+            });
+            auto const decodeEnd = std::chrono::system_clock::now();
+
+            JLOG(journal_.debug())
+                << "decode time = "
+                << ((decodeEnd - decodeStart).count()) / 1000000000.0
+                << ". ledgers = " << batch.size();
+
+            for (auto& data : decoded)
+            {
+                auto start = std::chrono::system_clock::now();
+                auto [next, accountTxData] = buildNextLedger(parent, data);
+                auto end = std::chrono::system_clock::now();
+
+                auto duration = ((end - start).count()) / 1000000000.0;
+                JLOG(journal_.debug()) << "transform time = " << duration;
+                // The below line needs to execute before pushing to the
+                // queue, in order to prevent this thread and the loader
+                // thread from accessing the same SHAMap concurrently
+                parent =
+                    std::make_shared<Ledger>(*next, NetClock::time_point{});
+                loadQueue.push(
+                    std::make_pair(std::move(next), std::move(accountTxData)));
+            }
         }
+
         // empty optional tells the loader to shutdown
         loadQueue.push({});
     }};
@@ -596,59 +696,110 @@ ReportingETL::runETLPipeline(uint32_t startSequence)
         beast::setCurrentThreadName("rippled: ReportingETL load");
         size_t totalTransactions = 0;
         double totalTime = 0;
-        while (!writeConflict)
+        bool done = false;
+        std::vector<std::pair<
+            std::shared_ptr<Ledger>,
+            std::vector<AccountTransactionsData>>>
+            batch;
+        while (!done && !writeConflict)
         {
-            std::optional<std::pair<
-                std::shared_ptr<Ledger>,
-                std::vector<AccountTransactionsData>>>
-                result{loadQueue.pop()};
+            batch.clear();
+            auto result = loadQueue.pop();
             // if result is an empty optional, the transformer thread has
             // stopped and the loader should stop as well
             if (!result)
                 break;
+            batch.push_back(std::move(*result));
+
+            // Take whatever else is ready, so that a backlog is written in
+            // batches. A single ledger is never delayed to fill a batch
+            while (batch.size() < loadBatchSize_)
+            {
+                auto more = loadQueue.tryPop();
+                if (!more)
+                    break;
+                if (!*more)
+                {
+                    done = true;
+                    break;
+                }
+                batch.push_back(std::move(**more));
+            }
             if (isStopping())
                 continue;
 
-            auto& ledger = result->first;
-            auto& accountTxData = result->second;
+            std::vector<size_t> numTxns;
+            numTxns.reserve(batch.size());
+            for (auto const& [ledger, accountTxData] : batch)
+                numTxns.push_back(accountTxData.size());
 
             auto start = std::chrono::system_clock::now();
             // write to the key-value store
-            flushLedger(ledger);
+            for (auto& entry : batch)
+                flushLedger(entry.first);
+            app_.getNodeStore().sync();
 
             auto mid = std::chrono::system_clock::now();
             // write to RDBMS
             // if there is a write conflict, some other process has already
             // written this ledger and has taken over as the ETL writer
+            std::size_t written = batch.size();
 #ifdef RIPPLED_REPORTING
-            if (!writeToPostgres(
-                    ledger->info(), accountTxData, app_.getPgPool(), journal_))
-                writeConflict = true;
+            std::vector<LedgerWriteData> rows;
+            rows.reserve(batch.size());
+            for (auto& [ledger, accountTxData] : batch)
+                rows.emplace_back(ledger->info(), std::move(accountTxData));
+
+            if (!writeToPostgres(rows, app_.getPgPool(), journal_))
+            {
+                // Write the ledgers one at a time, to publish every ledger
+                // before the one that conflicts
+                written = 0;
+                while (written < rows.size() &&
+                       writeToPostgres(
+                           rows[written].first,
+                           rows[written].second,
+                           app_.getPgPool(),
+                           journal_))
+                    ++written;
+                if (written < rows.size())
+                    writeConflict = true;
+            }
 #endif
 
             auto end = std::chrono::system_clock::now();
 
-            if (!writeConflict)
+            for (std::size_t i = 0; i < written; ++i)
             {
-                publishLedger(ledger);
-                lastPublishedSequence = ledger->info().seq;
+                publishLedger(batch[i].first);
+                lastPublishedSequence = batch[i].first->info().seq;
             }
+
             // print some performance numbers
             auto kvTime = ((mid - start).count()) / 1000000000.0;
             auto relationalTime = ((end - mid).count()) / 1000000000.0;
 
-            size_t numTxns = accountTxData.size();
+            size_t batchTxns = 0;
+            for (auto const n : numTxns)
+                batchTxns += n;
             totalTime += kvTime;
-            totalTransactions += numTxns;
+            totalTransactions += batchTxns;
+            for (std::size_t i = 0; i < written; ++i)
+            {
+                JLOG(journal_.info())
+                    << "Load phase of etl : "
+                    << "Successfully published ledger! Ledger info: "
+                    << detail::toString(batch[i].first->info())
+                    << ". txn count = " << numTxns[i];
+            }
             JLOG(journal_.info())
                 << "Load phase of etl : "
-                << "Successfully published ledger! Ledger info: "
-                << detail::toString(ledger->info())
-                << ". txn count = " << numTxns
+                << "ledgers in batch = " << batch.size()
+                << ". txn count = " << batchTxns
                 << ". key-value write time = " << kvTime
                 << ". relational write time = " << relationalTime
-                << ". key-value tps = " << numTxns / kvTime
-                << ". relational tps = " << numTxns / relationalTime
+                << ". key-value tps = " << batchTxns / kvTime
+                << ". relational tps = " << batchTxns / relationalTime
                 << ". total key-value tps = " << totalTransactions / totalTime;
         }
     }};
@@ -918,6 +1069,16 @@ ReportingETL::ReportingETL(Application& app, Stoppable& parent)
         std::pair<std::string, bool> numMarkers = section.find("num_markers");
         if (numMarkers.second)
             numMarkers_ = std::stoi(numMarkers.first);
+
+        std::pair<std::string, bool> transformThreads =
+            section.find("transform_threads");
+        if (transformThreads.second)
+            transformThreads_ = std::stoi(transformThreads.first);
+
+        std::pair<std::string, bool> loadBatchSize =
+            section.find("load_batch_size");
+        if (loadBatchSize.second)
+            loadBatchSize_ = std::stoi(loadBatchSize.first);
     }
 }
 
@@ -51,6 +51,7 @@
 namespace ripple {
 
 struct AccountTransactionsData;
+struct DecodedLedger;
 
 /**
  * This class is responsible for continuously extracting data from a
@@ -125,6 +126,17 @@ private:
     /// more load on the ETL source.
     size_t numMarkers_ = 2;
 
+    /// The most extracted ledgers the ETL pipeline deserializes at once, on
+    /// the application's worker pool. The ledgers are then built one after
+    /// another, in order, from the deserialized data.
+    size_t transformThreads_ = 4;
+
+    /// The most ledgers the ETL pipeline writes to the databases at once.
+    /// When several ledgers are waiting to be written, as during a
+    /// backfill, they are flushed to the key-value store with a single sync
+    /// and written to Postgres in a single transaction.
+    size_t loadBatchSize_ = 16;
+
     /// Whether the process is in strict read-only mode. In strict read-only
     /// mode, the process will never attempt to become the ETL writer, and will
     /// only publish ledgers as they are written to the database.
@@ -212,31 +224,36 @@ private:
     std::optional<org::xrpl::rpc::v1::GetLedgerResponse>
     fetchLedgerDataAndDiff(uint32_t sequence);
 
+    /// Deserialize the ledger header, transactions, metadata and ledger
+    /// objects extracted from an ETL source. Does not depend on any other
+    /// ledger, so ledgers can be decoded concurrently
+    /// @param rawData data extracted from an ETL source
+    /// @return the deserialized data
+    DecodedLedger
+    decodeLedger(org::xrpl::rpc::v1::GetLedgerResponse& rawData);
+
     /// Insert all of the extracted transactions into the ledger
     /// @param ledger ledger to insert transactions into
-    /// @param data data extracted from an ETL source
+    /// @param data decoded data extracted from an ETL source
     /// @return struct that contains the neccessary info to write to the
     /// transctions and account_transactions tables in Postgres (mostly
     /// transaction hashes, corresponding nodestore hashes and affected
     /// accounts)
     std::vector<AccountTransactionsData>
-    insertTransactions(
-        std::shared_ptr<Ledger>& ledger,
-        org::xrpl::rpc::v1::GetLedgerResponse& data);
+    insertTransactions(std::shared_ptr<Ledger>& ledger, DecodedLedger& data);
 
     /// Build the next ledger using the previous ledger and the extracted data.
     /// This function calls insertTransactions()
-    /// @note rawData should be data that corresponds to the ledger immediately
+    /// @note data should be data that corresponds to the ledger immediately
     /// following parent
     /// @param parent the previous ledger
-    /// @param rawData data extracted from an ETL source
+    /// @param data decoded data extracted from an ETL source
     /// @return the newly built ledger and data to write to Postgres
     std::pair<std::shared_ptr<Ledger>, std::vector<AccountTransactionsData>>
-    buildNextLedger(
-        std::shared_ptr<Ledger>& parent,
-        org::xrpl::rpc::v1::GetLedgerResponse& rawData);
+    buildNextLedger(std::shared_ptr<Ledger>& parent, DecodedLedger& data);
 
-    /// Write all new data to the key-value store
+    /// Write all new data to the key-value store. The caller must sync the
+    /// node store afterwards
     /// @param ledger ledger with new data to write
     void
     flushLedger(std::shared_ptr<Ledger>& ledger);
@@ -27,11 +27,14 @@
 #include <ripple/protocol/TER.h>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
 class Application;
 class HashRouter;
+class SignatureCache;
+class WorkerPool;
 
 /** Describes the pre-processing validity of a transaction.
 
@@ -53,6 +56,9 @@ enum class Validity {
 
     @note Results are cached internally, so tests will not be
         repeated over repeated calls, unless cache expires.
+        Good signatures are also remembered in `signatures`,
+        so they are not verified again after the router
+        forgets the transaction.
 
     @return `std::pair`, where `.first` is the status, and
             `.second` is the reason if appropriate.
@@ -62,10 +68,33 @@ enum class Validity {
 std::pair<Validity, std::string>
 checkValidity(
     HashRouter& router,
+    SignatureCache& signatures,
     STTx const& tx,
     Rules const& rules,
     Config const& config);
 
+/** Checks the signatures of several transactions at once.
+
+    Signatures that are not already known good or bad are verified on
+    the threads of `workers`, and the outcomes are cached as checkValidity
+    would cache them. Later calls to checkValidity for these transactions
+    then only need to do the local checks.
+
+    Each signature is verified on its own, exactly as checkValidity does.
+    Batch verification of Ed25519 signatures can accept signatures that
+    individual verification rejects, which would let this server disagree
+    with others about which transactions are valid.
+
+    @see checkValidity
+*/
+void
+checkSignatures(
+    HashRouter& router,
+    SignatureCache& signatures,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+    Rules const& rules,
+    WorkerPool& workers);
+
 /** Sets the validity of a given transaction in the cache.
 
     @warning Use with extreme care.
@@ -78,6 +107,24 @@ checkValidity(
 void
 forceValidity(HashRouter& router, uint256 const& txid, Validity validity);
 
+/** Returns true if the signature of a transaction is known to be good.
+
+    The signature was checked here, or a cluster member vouched for it.
+*/
+bool
+isSignatureGood(HashRouter& router, uint256 const& txid);
+
+/** Accepts a cluster member's word that a transaction's signature is good.
+
+    Validators check every signature themselves and ignore the member's
+    word. Any other server marks the signature good, leaving only the
+    local checks to run.
+
+    @return `true` if the signature was marked good.
+*/
+bool
+acceptVouchedSignature(Application& app, uint256 const& txid);
+
 /** Apply a transaction to an `OpenView`.
 
     This function is the canonical way to apply a transaction
@@ -114,6 +114,9 @@ private:
     TER
     failInvariantCheck(TER const result);
 
+    bool
+    sampleInvariants() const;
+
     template <std::size_t... Is>
     TER
     checkInvariantsHelper(
@@ -47,7 +47,17 @@ BookTip::step(beast::Journal j)
         // See if there's an entry at or worse than current quality. Notice
         // that the quality is encoded only in the index of the first page
         // of a directory.
-        auto const first_page = view_.succ(m_book, m_end);
+        //
+        // Nothing can sort between the current directory and m_book, so
+        // while that directory is still there it is the answer. Checking
+        // for it directly is cheaper than a successor search through every
+        // layer of the view.
+        boost::optional<uint256> first_page;
+        if (m_current && view_.exists(keylet::page(*m_current)))
+            first_page = m_current;
+        else
+            first_page = view_.succ(m_book, m_end);
+        m_current = boost::none;
 
         if (!first_page)
             return false;
@@ -64,6 +74,7 @@ BookTip::step(beast::Journal j)
 
             // Next query should start before this directory
             m_book = *first_page;
+            m_current = first_page;
 
             // The quality immediately before the next quality
             --m_book;
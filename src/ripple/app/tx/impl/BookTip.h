@@ -23,6 +23,7 @@
 #include <ripple/ledger/View.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/Quality.h>
+#include <boost/optional.hpp>
 
 #include <functional>
 
@@ -46,6 +47,9 @@ private:
     std::shared_ptr<SLE> m_entry;
     Quality m_quality;
 
+    // The first page of the directory the current offer came from
+    boost::optional<uint256> m_current;
+
 public:
     /** Create the iterator. */
     BookTip(ApplyView& view, Book const& book);
@@ -395,6 +395,7 @@ Payment::doApply()
         rcInput.defaultPathsAllowed = defaultPathsAllowed;
         rcInput.limitQuality = limitQuality;
         rcInput.isLedgerOpen = view().open();
+        rcInput.strandThreads = ctx_.app.config().FLOW_THREADS;
 
         path::RippleCalc::Output rc;
         {
@@ -17,10 +17,13 @@
 */
 //==============================================================================
 
+#include <ripple/app/main/Application.h>
 #include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/misc/SignatureCache.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/app/tx/applySteps.h>
 #include <ripple/basics/Log.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/protocol/Feature.h>
 
 namespace ripple {
@@ -33,9 +36,50 @@ namespace ripple {
 
 //------------------------------------------------------------------------------
 
+static STTx::RequireFullyCanonicalSig
+requireCanonicalSig(Rules const& rules)
+{
+    return rules.enabled(featureRequireFullyCanonicalSig)
+        ? STTx::RequireFullyCanonicalSig::yes
+        : STTx::RequireFullyCanonicalSig::no;
+}
+
+// Signatures are only checked on several threads when each thread would
+// have at least this many to check.
+static constexpr std::size_t minSignaturesPerThread = 8;
+
+// The signature cache key for a transaction. The transaction ID covers
+// the signatures, so they need not be hashed again.
+static uint256
+signatureKey(STTx const& tx, STTx::RequireFullyCanonicalSig required)
+{
+    return SignatureCache::key(
+        tx.getTransactionID(),
+        makeSlice(tx.getSigningPubKey()),
+        Slice{},
+        required == STTx::RequireFullyCanonicalSig::yes);
+}
+
+// Checks the signature of a transaction the router knows nothing about,
+// consulting the signature cache first.
+static std::pair<bool, std::string>
+checkSign(
+    SignatureCache& signatures,
+    STTx const& tx,
+    STTx::RequireFullyCanonicalSig required)
+{
+    std::pair<bool, std::string> ret{true, ""};
+    signatures.verify(signatureKey(tx, required), [&] {
+        ret = tx.checkSign(required);
+        return ret.first;
+    });
+    return ret;
+}
+
 std::pair<Validity, std::string>
 checkValidity(
     HashRouter& router,
+    SignatureCache& signatures,
     STTx const& tx,
     Rules const& rules,
     Config const& config)
@@ -49,12 +93,8 @@ checkValidity(
     if (!(flags & SF_SIGGOOD))
     {
         // Don't know signature state. Check it.
-        auto const requireCanonicalSig =
-            rules.enabled(featureRequireFullyCanonicalSig)
-            ? STTx::RequireFullyCanonicalSig::yes
-            : STTx::RequireFullyCanonicalSig::no;
-
-        auto const sigVerify = tx.checkSign(requireCanonicalSig);
+        auto const sigVerify =
+            checkSign(signatures, tx, requireCanonicalSig(rules));
         if (!sigVerify.first)
         {
             router.setFlags(id, SF_SIGBAD);
@@ -85,6 +125,36 @@ checkValidity(
     return {Validity::Valid, ""};
 }
 
+void
+checkSignatures(
+    HashRouter& router,
+    SignatureCache& signatures,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+    Rules const& rules,
+    WorkerPool& workers)
+{
+    std::vector<STTx const*> unknown;
+    unknown.reserve(txs.size());
+    for (auto const& tx : txs)
+    {
+        if (!(router.getFlags(tx->getTransactionID()) &
+              (SF_SIGBAD | SF_SIGGOOD)))
+            unknown.push_back(tx.get());
+    }
+
+    auto const required = requireCanonicalSig(rules);
+    workers.run(
+        unknown.size(),
+        [&](std::size_t i) {
+            auto const& tx = *unknown[i];
+            router.setFlags(
+                tx.getTransactionID(),
+                checkSign(signatures, tx, required).first ? SF_SIGGOOD
+                                                          : SF_SIGBAD);
+        },
+        minSignaturesPerThread);
+}
+
 void
 forceValidity(HashRouter& router, uint256 const& txid, Validity validity)
 {
@@ -105,6 +175,21 @@ forceValidity(HashRouter& router, uint256 const& txid, Validity validity)
         router.setFlags(txid, flags);
 }
 
+bool
+isSignatureGood(HashRouter& router, uint256 const& txid)
+{
+    return (router.getFlags(txid) & (SF_SIGGOOD | SF_SIGBAD)) == SF_SIGGOOD;
+}
+
+bool
+acceptVouchedSignature(Application& app, uint256 const& txid)
+{
+    if (!app.getValidationPublicKey().empty())
+        return false;
+    forceValidity(app.getHashRouter(), txid, Validity::SigGoodOnly);
+    return true;
+}
+
 std::pair<TER, bool>
 apply(
     Application& app,
@@ -22,6 +22,14 @@
 
 #include <boost/filesystem.hpp>
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace ripple {
 
 /** Extract a tar archive compressed with lz4
@@ -36,6 +44,84 @@ extractTarLz4(
     boost::filesystem::path const& src,
     boost::filesystem::path const& dst);
 
+/** Extract a tar archive compressed with lz4 as its bytes arrive
+
+    Input passed to write() is decompressed and unpacked into the
+    destination directory on a dedicated thread. At most `maxBuffered`
+    bytes of input are held in memory; write() blocks while the buffer
+    is full, which applies backpressure to the producer.
+
+    Entries with absolute paths or paths that escape the destination
+    directory are rejected.
+*/
+class TarLz4Extractor
+{
+public:
+    /** Start extracting
+
+        @param dst the directory to extract to
+        @param maxBuffered the maximum number of input bytes to buffer
+    */
+    TarLz4Extractor(
+        boost::filesystem::path const& dst,
+        std::size_t maxBuffered);
+
+    TarLz4Extractor(TarLz4Extractor const&) = delete;
+    TarLz4Extractor&
+    operator=(TarLz4Extractor const&) = delete;
+
+    /** Cancels the extraction if it has not finished */
+    ~TarLz4Extractor();
+
+    /** Queue input for extraction
+
+        Bytes received after the end of the archive are discarded.
+
+        @throws runtime_error if the extraction failed
+    */
+    void
+    write(void const* data, std::size_t size);
+
+    /** Signal the end of input and wait for the extraction to finish
+
+        @throws runtime_error if the extraction failed
+    */
+    void
+    finish();
+
+    /** Stop the extraction and wait for the thread to exit
+
+        Files already extracted are left in place.
+    */
+    void
+    cancel();
+
+private:
+    void
+    run();
+
+    // Called by libarchive on the extraction thread to obtain input
+    std::ptrdiff_t
+    pull(void const** buffer);
+
+    boost::filesystem::path const dst_;
+    std::size_t const maxBuffered_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::vector<std::uint8_t>> queue_;
+    std::size_t buffered_{0};
+    bool done_{false};
+    bool stopped_{false};
+    bool finished_{false};
+    std::string error_;
+
+    // The block most recently handed to libarchive
+    std::vector<std::uint8_t> current_;
+
+    std::thread thread_;
+};
+
 }  // namespace ripple
 
 #endif
@@ -0,0 +1,234 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_CACHEMETRICS_H_INCLUDED
+#define RIPPLE_BASICS_CACHEMETRICS_H_INCLUDED
+
+#include <ripple/beast/clock/abstract_clock.h>
+#include <ripple/beast/insight/Insight.h>
+#include <ripple/json/json_value.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** Sweep and eviction statistics for a cache.
+
+    The cache reports its evictions and, after every sweep, its counters
+    and how long the sweep took and held locks. The counters are sampled
+    at each sweep so that rates over the last minute and the last ten
+    minutes can be reported alongside the totals.
+*/
+class CacheMetrics
+{
+public:
+    using clock_type = beast::abstract_clock<std::chrono::steady_clock>;
+
+    struct Counts
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+    };
+
+    CacheMetrics(
+        std::string const& prefix,
+        beast::insight::Collector::ptr const& collector)
+        : evictionCounter_(collector->make_counter(prefix, "evictions"))
+        , sweepTime_(collector->make_event(prefix, "sweep_time"))
+        , lockTime_(collector->make_event(prefix, "sweep_lock_time"))
+    {
+    }
+
+    /** Estimate the bytes held by a cache built on a hash map.
+
+        This counts the map's nodes and the fixed size of the objects the
+        cache keeps alive, but not memory those objects own.
+
+        @param tracked entries in the map
+        @param nodeBytes size of a map entry
+        @param cached objects the cache holds strongly
+        @param objectBytes size of a cached object
+    */
+    static std::uint64_t
+    estimateBytes(
+        std::size_t tracked,
+        std::size_t nodeBytes,
+        std::size_t cached = 0,
+        std::size_t objectBytes = 0)
+    {
+        // A map node also holds a next pointer and the hash, and a shared
+        // object a control block
+        return static_cast<std::uint64_t>(tracked) *
+            (nodeBytes + 2 * sizeof(void*)) +
+            static_cast<std::uint64_t>(cached) *
+            (objectBytes + 2 * sizeof(void*));
+    }
+
+    void
+    evicted(std::uint64_t n)
+    {
+        if (n == 0)
+            return;
+        evictions_.fetch_add(n, std::memory_order_relaxed);
+        evictionCounter_.increment(n);
+    }
+
+    std::uint64_t
+    evictions() const
+    {
+        return evictions_.load(std::memory_order_relaxed);
+    }
+
+    /** Record a completed sweep.
+
+        @param counts the cache's counters once the sweep finished
+        @param now the time by the cache's clock
+        @param sweepTime how long the sweep took
+        @param lockTime how long the sweep held the cache's locks
+        @param longestHold the longest the sweep held a lock at once
+    */
+    void
+    swept(
+        Counts const& counts,
+        clock_type::time_point now,
+        std::chrono::microseconds sweepTime,
+        std::chrono::microseconds lockTime,
+        std::chrono::microseconds longestHold)
+    {
+        sweepTime_.notify(sweepTime);
+        lockTime_.notify(lockTime);
+
+        std::lock_guard lock(mutex_);
+        lastSweep_ = sweepTime;
+        lastLock_ = lockTime;
+        lastHold_ = longestHold;
+        totalLock_ += lockTime;
+        ++sweeps_;
+
+        samples_.push_back({now, counts});
+        // Keep one sample older than the longest window, as its baseline
+        while (samples_.size() > 1 && samples_[1].when <= now - longWindow)
+            samples_.pop_front();
+    }
+
+    /** Add the statistics to a cache's report.
+
+        @param obj the report
+        @param counts the cache's counters now
+        @param now the time by the cache's clock
+    */
+    void
+    getJson(
+        Json::Value& obj,
+        Counts const& counts,
+        clock_type::time_point now) const
+    {
+        obj["hits"] = std::to_string(counts.hits);
+        obj["misses"] = std::to_string(counts.misses);
+        obj["evictions"] = std::to_string(counts.evictions);
+
+        std::lock_guard lock(mutex_);
+        obj["sweeps"] = static_cast<Json::UInt>(sweeps_);
+        obj["last_sweep_us"] = static_cast<Json::UInt>(lastSweep_.count());
+        obj["last_sweep_lock_us"] = static_cast<Json::UInt>(lastLock_.count());
+        obj["last_sweep_hold_us"] = static_cast<Json::UInt>(lastHold_.count());
+        obj["sweep_lock_us"] = std::to_string(totalLock_.count());
+
+        addRates(obj["1m"], counts, now, shortWindow);
+        addRates(obj["10m"], counts, now, longWindow);
+    }
+
+private:
+    struct Sample
+    {
+        clock_type::time_point when;
+        Counts counts;
+    };
+
+    static constexpr std::chrono::seconds shortWindow{60};
+    static constexpr std::chrono::seconds longWindow{600};
+
+    // Rates per second since the newest sample at least a window old, or
+    // since the oldest sample if none is that old
+    void
+    addRates(
+        Json::Value& obj,
+        Counts const& counts,
+        clock_type::time_point now,
+        std::chrono::seconds window) const
+    {
+        obj = Json::objectValue;
+        if (samples_.empty())
+            return;
+
+        auto base = samples_.begin();
+        for (auto it = samples_.begin(); it != samples_.end(); ++it)
+        {
+            if (it->when > now - window)
+                break;
+            base = it;
+        }
+
+        using seconds = std::chrono::duration<double>;
+        auto const elapsed =
+            std::chrono::duration_cast<seconds>(now - base->when).count();
+        if (elapsed <= 0)
+            return;
+
+        auto const rate = [elapsed](std::uint64_t now, std::uint64_t then) {
+            return now > then ? (now - then) / elapsed : 0.0;
+        };
+        auto const hits =
+            counts.hits - std::min(counts.hits, base->counts.hits);
+        auto const misses =
+            counts.misses - std::min(counts.misses, base->counts.misses);
+
+        obj["seconds"] = static_cast<Json::UInt>(elapsed);
+        obj["hits_per_sec"] = rate(counts.hits, base->counts.hits);
+        obj["misses_per_sec"] = rate(counts.misses, base->counts.misses);
+        obj["evictions_per_sec"] =
+            rate(counts.evictions, base->counts.evictions);
+        if (hits + misses != 0)
+            obj["hit_rate"] = 100.0 * hits / (hits + misses);
+    }
+
+    std::atomic<std::uint64_t> evictions_{0};
+
+    beast::insight::Counter evictionCounter_;
+    beast::insight::Event sweepTime_;
+    beast::insight::Event lockTime_;
+
+    std::mutex mutable mutex_;
+    std::deque<Sample> samples_;
+    std::uint64_t sweeps_ = 0;
+    std::chrono::microseconds lastSweep_{0};
+    std::chrono::microseconds lastLock_{0};
+    std::chrono::microseconds lastHold_{0};
+    std::chrono::microseconds totalLock_{0};
+};
+
+}  // namespace ripple
+
+#endif
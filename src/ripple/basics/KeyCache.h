@@ -20,6 +20,7 @@
 #ifndef RIPPLE_BASICS_KEYCACHE_H_INCLUDED
 #define RIPPLE_BASICS_KEYCACHE_H_INCLUDED
 
+#include <ripple/basics/CacheMetrics.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/basics/hardened_hash.h>
 #include <ripple/beast/clock/abstract_clock.h>
@@ -90,6 +91,7 @@ private:
     Mutex mutable m_mutex;
     map_type m_map;
     Stats mutable m_stats;
+    CacheMetrics m_metrics;
     clock_type& m_clock;
     std::string const m_name;
     size_type m_target_size;
@@ -108,6 +110,7 @@ public:
         size_type target_size = 0,
         std::chrono::seconds expiration = std::chrono::minutes{2})
         : m_stats(name, std::bind(&KeyCache::collect_metrics, this), collector)
+        , m_metrics(name, collector)
         , m_clock(clock)
         , m_name(name)
         , m_target_size(target_size)
@@ -125,6 +128,7 @@ public:
               name,
               std::bind(&KeyCache::collect_metrics, this),
               beast::insight::NullCollector::New())
+        , m_metrics(name, beast::insight::NullCollector::New())
         , m_clock(clock)
         , m_name(name)
         , m_target_size(target_size)
@@ -262,10 +266,43 @@ public:
         return false;
     }
 
-    /** Remove stale entries from the cache. */
-    void
+    /** Sizes and statistics, for get_counts. */
+    Json::Value
+    getJson() const
+    {
+        std::size_t tracked;
+        CacheMetrics::Counts counts;
+        {
+            std::lock_guard lock(m_mutex);
+            tracked = m_map.size();
+            counts = {m_stats.hits, m_stats.misses, m_metrics.evictions()};
+        }
+
+        Json::Value ret(Json::objectValue);
+        ret["size"] = static_cast<Json::UInt>(tracked);
+        ret["estimated_bytes"] = std::to_string(estimateBytes(tracked));
+        m_metrics.getJson(ret, counts, m_clock.now());
+        return ret;
+    }
+
+    /** Estimate the bytes held by a cache of the given size. */
+    static std::uint64_t
+    estimateBytes(size_type size)
+    {
+        return CacheMetrics::estimateBytes(
+            size, sizeof(typename map_type::value_type));
+    }
+
+    /** Remove stale entries from the cache.
+        @return the number of entries removed
+    */
+    std::size_t
     sweep()
     {
+        using namespace std::chrono;
+        auto const start = steady_clock::now();
+        std::size_t removed = 0;
+
         clock_type::time_point const now(m_clock.now());
         clock_type::time_point when_expire;
 
@@ -296,12 +333,25 @@ public:
             else if (it->second.last_access <= when_expire)
             {
                 it = m_map.erase(it);
+                ++removed;
             }
             else
             {
                 ++it;
             }
         }
+
+        // The lock is held throughout
+        auto const took =
+            duration_cast<microseconds>(steady_clock::now() - start);
+        m_metrics.evicted(removed);
+        m_metrics.swept(
+            {m_stats.hits, m_stats.misses, m_metrics.evictions()},
+            now,
+            took,
+            took,
+            took);
+        return removed;
     }
 
 private:
@@ -24,6 +24,8 @@
 #include <ripple/beast/utility/Journal.h>
 #include <boost/beast/core/string.hpp>
 #include <boost/filesystem.hpp>
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -47,7 +49,16 @@ enum LogSeverity {
 /** Manages partitions for logging. */
 class Logs
 {
+public:
+    /** What a thread does when its queue of unwritten messages is full. */
+    enum class Overflow {
+        drop,  // Discard the message and count it
+        block  // Wait for the writer thread to make room
+    };
+
 private:
+    class AsyncWriter;
+
     class Sink : public beast::Journal::Sink
     {
     private:
@@ -131,6 +142,10 @@ private:
         void
         writeln(char const* text);
 
+        /** Write out anything buffered by the stream. */
+        void
+        flush();
+
         /** Write to the log file using std::string. */
         /** @{ */
         void
@@ -160,6 +175,7 @@ private:
     beast::severities::Severity thresh_;
     File file_;
     bool silent_ = false;
+    std::unique_ptr<AsyncWriter> async_;
 
 public:
     Logs(beast::severities::Severity level);
@@ -168,11 +184,32 @@ public:
     Logs&
     operator=(Logs const&) = delete;
 
-    virtual ~Logs() = default;
+    virtual ~Logs();
 
     bool
     open(boost::filesystem::path const& pathToLogFile);
 
+    /** Format and write messages on a background thread.
+
+        Afterwards a thread that logs only copies the message into a queue
+        of its own, which the background thread drains. Fatal messages are
+        written before write returns. Must be called before messages are
+        logged from more than one thread, and at most once.
+
+        @param capacity The number of messages each thread may have queued.
+        @param overflow What a thread does when its queue is full.
+    */
+    void
+    startAsync(std::size_t capacity, Overflow overflow);
+
+    /** Wait until every message already logged has been written. */
+    void
+    flush();
+
+    /** The number of messages discarded because a queue was full. */
+    std::uint64_t
+    dropped() const;
+
     beast::Journal::Sink&
     get(std::string const& name);
 
@@ -242,7 +279,12 @@ private:
         std::string& output,
         std::string const& message,
         beast::severities::Severity severity,
-        std::string const& partition);
+        std::string const& partition,
+        std::chrono::system_clock::time_point when =
+            std::chrono::system_clock::now());
+
+    void
+    writeFormatted(std::string const& s);
 };
 
 // Wraps a Journal::Stream to skip evaluation of
@@ -0,0 +1,199 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_MEMORYARENA_H_INCLUDED
+#define RIPPLE_BASICS_MEMORYARENA_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace ripple {
+
+/** The subsystems whose heap memory is accounted for separately.
+
+    Memory allocated through an arena is counted against it, so the
+    resident memory of the server can be attributed to its main consumers.
+    In a jemalloc build each arena is also a separate jemalloc arena, which
+    keeps long lived cache memory apart from short lived allocations and
+    lets the allocator report what each arena holds resident.
+*/
+enum class MemoryArena : std::uint8_t {
+    shamap,
+    nodeObject,
+    json,
+    stobject,
+    overlay,
+};
+
+constexpr std::size_t memoryArenaCount = 5;
+
+char const*
+to_string(MemoryArena arena);
+
+/** Counters for one arena. */
+struct MemoryArenaStats
+{
+    // Bytes requested by live allocations
+    std::uint64_t bytes = 0;
+
+    // Number of live allocations
+    std::uint64_t allocations = 0;
+
+    // Total number of allocations made
+    std::uint64_t total = 0;
+
+    // Bytes of memory the allocator holds resident for the arena, if the
+    // allocator reports it
+    std::uint64_t resident = 0;
+};
+
+MemoryArenaStats
+getMemoryArenaStats(MemoryArena arena);
+
+/** The name of the allocator this server was built with. */
+char const*
+allocatorName();
+
+/** Back the shamap and nodeObject arenas with transparent huge pages.
+
+    Only supported in a jemalloc build, where memory the arenas obtain
+    from the system from then on is advised as huge page eligible.
+
+    @return whether huge pages could be enabled
+*/
+bool
+enableArenaHugePages();
+
+void*
+arenaAllocate(MemoryArena arena, std::size_t bytes);
+
+void
+arenaDeallocate(MemoryArena arena, void* p, std::size_t bytes) noexcept;
+
+/** A standard allocator drawing memory from an arena. */
+template <class T, MemoryArena Arena>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = ArenaAllocator<U, Arena>;
+    };
+
+    ArenaAllocator() = default;
+
+    template <class U>
+    ArenaAllocator(ArenaAllocator<U, Arena> const&) noexcept
+    {
+    }
+
+    T*
+    allocate(std::size_t n)
+    {
+        return static_cast<T*>(arenaAllocate(Arena, n * sizeof(T)));
+    }
+
+    void
+    deallocate(T* p, std::size_t n) noexcept
+    {
+        arenaDeallocate(Arena, p, n * sizeof(T));
+    }
+
+    template <class U>
+    bool
+    operator==(ArenaAllocator<U, Arena> const&) const noexcept
+    {
+        return true;
+    }
+
+    template <class U>
+    bool
+    operator!=(ArenaAllocator<U, Arena> const&) const noexcept
+    {
+        return false;
+    }
+};
+
+/** A boost.pool user allocator drawing blocks from an arena. */
+template <MemoryArena Arena>
+struct ArenaPoolAllocator
+{
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    static char*
+    malloc(size_type bytes)
+    {
+        // The pool frees a block without its size, so keep it in front
+        auto p = static_cast<char*>(
+            arenaAllocate(Arena, bytes + alignof(std::max_align_t)));
+        *reinterpret_cast<size_type*>(p) = bytes;
+        return p + alignof(std::max_align_t);
+    }
+
+    static void
+    free(char* block)
+    {
+        auto p = block - alignof(std::max_align_t);
+        arenaDeallocate(
+            Arena,
+            p,
+            *reinterpret_cast<size_type*>(p) + alignof(std::max_align_t));
+    }
+};
+
+/** Base class for types whose heap instances are placed in an arena.
+
+    Objects built in place, or by std::make_shared, are not affected.
+*/
+template <MemoryArena Arena>
+class ArenaAllocated
+{
+public:
+    static void*
+    operator new(std::size_t bytes)
+    {
+        return arenaAllocate(Arena, bytes);
+    }
+
+    static void
+    operator delete(void* p, std::size_t bytes) noexcept
+    {
+        arenaDeallocate(Arena, p, bytes);
+    }
+
+    // Declaring the above hides the placement forms
+    static void*
+    operator new(std::size_t, void* where) noexcept
+    {
+        return where;
+    }
+
+    static void
+    operator delete(void*, void*) noexcept
+    {
+    }
+};
+
+}  // namespace ripple
+
+#endif
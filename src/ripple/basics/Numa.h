@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_NUMA_H_INCLUDED
+#define RIPPLE_BASICS_NUMA_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace ripple {
+namespace numa {
+
+/** The CPUs of each NUMA node of the host, read once.
+
+    A host that is not NUMA, or whose topology can't be read, has a single
+    node holding no CPUs.
+*/
+std::vector<std::vector<int>> const&
+nodes();
+
+/** The number of NUMA nodes, at least one. */
+std::size_t
+nodeCount();
+
+/** Whether thread groups are pinned to nodes.
+
+    Only true once enabled on a host with more than one node. It is set at
+    start up from the [numa] section, before the application and its
+    threads are made.
+*/
+bool
+enabled();
+
+void
+setEnabled(bool enable);
+
+/** Pin the calling thread to the CPUs of a node.
+
+    Threads of a group pass their index in the group, so the group is
+    spread round robin across the nodes. Does nothing unless enabled.
+*/
+void
+pinCurrentThread(std::size_t index);
+
+/** The node the calling thread is running on, or -1 if unknown. */
+int
+currentNode();
+
+/** Run a function on a thread pinned to a node, and wait for it.
+
+    Memory is placed on the node of the thread that first touches it, so
+    this allocates memory on a chosen node. If not enabled, the function
+    runs on the calling thread.
+*/
+void
+runOnNode(std::size_t node, std::function<void()> const& f);
+
+/** Memory allocation counters of each node, for get_counts.
+
+    "remote_percent" is the share of pages this host allocated on a node
+    other than the one the allocating thread ran on, since boot.
+*/
+Json::Value
+getJson();
+
+}  // namespace numa
+}  // namespace ripple
+
+#endif
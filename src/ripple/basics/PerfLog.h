@@ -142,6 +142,14 @@ public:
     virtual Json::Value
     currentJson() const = 0;
 
+    /**
+     * Render performance counters in the Prometheus text format
+     *
+     * @return Counters and duration histograms, one sample per line
+     */
+    virtual std::string
+    prometheus() const = 0;
+
     /**
      * Ensure enough room to store each currently executing job
      *
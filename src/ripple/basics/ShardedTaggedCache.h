@@ -0,0 +1,925 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+#define RIPPLE_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+
+#include <ripple/basics/CacheMetrics.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/Numa.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/beast/clock/abstract_clock.h>
+#include <ripple/beast/insight/Insight.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Map/cache combination, split into independently locked shards.
+
+    Works like TaggedCache: the cache keeps recently used objects alive,
+    and the map lets code paths that reference the same key share one
+    object for as long as any of them holds it. Each key belongs to one
+    of several shards, and each shard has its own lock and map, so
+    threads working on different keys rarely contend.
+
+    Sweeping visits one shard at a time. Lookups in the other shards
+    proceed while a shard is swept, and the objects swept out of a shard
+    are released after its lock is dropped.
+
+    There is no single lock over the whole cache, so unlike TaggedCache
+    there is no peekMutex. Callers that need several operations to be
+    atomic must use TaggedCache instead.
+
+    @note Callers must not modify data objects that are stored in the cache
+          unless they hold their own lock over all cache operations.
+*/
+template <
+    class Key,
+    class T,
+    class Hash = hardened_hash<>,
+    class KeyEqual = std::equal_to<Key>>
+class ShardedTaggedCache
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using clock_type = beast::abstract_clock<std::chrono::steady_clock>;
+
+    /** How strongly cached objects leave the cache. */
+    enum class Eviction {
+        /** Objects not used within the target age expire, as in
+            TaggedCache. The target age shrinks while the cache is over
+            its target size.
+        */
+        age,
+
+        /** Objects get a second chance: a sweep marks each object used
+            since the last sweep as unused, and expires the objects
+            still marked unused. A cache with a target size only expires
+            objects while it is over the target size. Lookups don't read
+            the clock.
+        */
+        clock
+    };
+
+    /** The default number of shards. */
+    static constexpr std::size_t defaultShards = 16;
+
+public:
+    ShardedTaggedCache(
+        std::string const& name,
+        int size,
+        clock_type::duration expiration,
+        clock_type& clock,
+        beast::Journal journal,
+        beast::insight::Collector::ptr const& collector =
+            beast::insight::NullCollector::New(),
+        Eviction eviction = Eviction::age,
+        std::size_t shards = defaultShards)
+        : m_journal(journal)
+        , m_clock(clock)
+        , m_stats(
+              name,
+              std::bind(&ShardedTaggedCache::collect_metrics, this),
+              collector)
+        , m_metrics(name, collector)
+        , m_name(name)
+        , m_eviction(eviction)
+        , m_shard_count(roundShards(shards))
+        , m_numa(numa::enabled())
+        , m_shards(makeShards(m_shard_count))
+        , m_target_size(size)
+        , m_target_age(expiration)
+        , m_hits(0)
+        , m_misses(0)
+    {
+    }
+
+public:
+    /** Return the clock associated with the cache. */
+    clock_type&
+    clock()
+    {
+        return m_clock;
+    }
+
+    /** Return the number of shards the keys are spread across. */
+    std::size_t
+    shards() const
+    {
+        return m_shard_count;
+    }
+
+    Eviction
+    eviction() const
+    {
+        return m_eviction;
+    }
+
+    int
+    getTargetSize() const
+    {
+        return m_target_size;
+    }
+
+    void
+    setTargetSize(int s)
+    {
+        m_target_size = s;
+
+        if (s > 0)
+        {
+            auto const perShard = shardTarget(s);
+            for (std::size_t i = 0; i < m_shard_count; ++i)
+            {
+                auto& shard = *m_shards[i];
+                std::lock_guard lock(shard.mutex);
+                shard.cache.rehash(static_cast<std::size_t>(
+                    (perShard + (perShard >> 2)) /
+                        shard.cache.max_load_factor() +
+                    1));
+            }
+        }
+
+        JLOG(m_journal.debug()) << m_name << " target size set to " << s;
+    }
+
+    clock_type::duration
+    getTargetAge() const
+    {
+        return m_target_age;
+    }
+
+    void
+    setTargetAge(clock_type::duration s)
+    {
+        m_target_age = s;
+        JLOG(m_journal.debug())
+            << m_name << " target age set to " << s.count();
+    }
+
+    int
+    getCacheSize() const
+    {
+        int count = 0;
+        for (std::size_t i = 0; i < m_shard_count; ++i)
+        {
+            auto& shard = *m_shards[i];
+            std::lock_guard lock(shard.mutex);
+            count += shard.cache_count;
+        }
+        return count;
+    }
+
+    int
+    getTrackSize() const
+    {
+        int count = 0;
+        for (std::size_t i = 0; i < m_shard_count; ++i)
+        {
+            auto& shard = *m_shards[i];
+            std::lock_guard lock(shard.mutex);
+            count += shard.cache.size();
+        }
+        return count;
+    }
+
+    float
+    getHitRate()
+    {
+        auto const hits = m_hits.load(std::memory_order_relaxed);
+        auto const total =
+            static_cast<float>(hits + m_misses.load(std::memory_order_relaxed));
+        return hits * (100.0f / std::max(1.0f, total));
+    }
+
+    void
+    clear()
+    {
+        for (std::size_t i = 0; i < m_shard_count; ++i)
+        {
+            auto& shard = *m_shards[i];
+            std::lock_guard lock(shard.mutex);
+            shard.cache.clear();
+            shard.cache_count = 0;
+        }
+    }
+
+    void
+    reset()
+    {
+        clear();
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+    /** Sizes and statistics, for get_counts. */
+    Json::Value
+    getJson() const
+    {
+        std::size_t cached = 0;
+        std::size_t tracked = 0;
+        for (std::size_t i = 0; i < m_shard_count; ++i)
+        {
+            auto& shard = *m_shards[i];
+            std::lock_guard lock(shard.mutex);
+            cached += shard.cache_count;
+            tracked += shard.cache.size();
+        }
+
+        Json::Value ret(Json::objectValue);
+        ret["size"] = static_cast<Json::UInt>(cached);
+        ret["track_size"] = static_cast<Json::UInt>(tracked);
+        ret["target_size"] = m_target_size.load();
+        ret["estimated_bytes"] = std::to_string(CacheMetrics::estimateBytes(
+            tracked,
+            sizeof(typename cache_type::value_type),
+            cached,
+            sizeof(mapped_type)));
+        m_metrics.getJson(ret, counts(), m_clock.now());
+        if (m_numa)
+        {
+            auto const local = m_localAccesses.load();
+            auto const remote = m_remoteAccesses.load();
+            if (local + remote != 0)
+                ret["numa_remote_percent"] = 100.0 * remote / (local + remote);
+        }
+        return ret;
+    }
+
+    void
+    sweep()
+    {
+        using namespace std::chrono;
+        auto const start = steady_clock::now();
+        steady_clock::duration locked{};
+        steady_clock::duration longest{};
+
+        int cacheRemovals = 0;
+        int mapRemovals = 0;
+
+        auto const targetSize = m_target_size.load();
+        auto const perShard = shardTarget(targetSize);
+        auto const targetAge = m_target_age.load();
+
+        std::vector<std::shared_ptr<mapped_type>> stuffToSweep;
+
+        for (std::size_t i = 0; i < m_shard_count; ++i)
+        {
+            auto& shard = *m_shards[i];
+
+            {
+                std::lock_guard lock(shard.mutex);
+                auto const lockedAt = steady_clock::now();
+
+                stuffToSweep.reserve(shard.cache.size());
+
+                if (m_eviction == Eviction::age)
+                {
+                    sweepByAge(
+                        shard,
+                        expiryTime(shard, perShard, targetAge),
+                        stuffToSweep,
+                        cacheRemovals,
+                        mapRemovals);
+                }
+                else
+                {
+                    sweepByClock(
+                        shard,
+                        perShard,
+                        stuffToSweep,
+                        cacheRemovals,
+                        mapRemovals);
+                }
+                auto const held = steady_clock::now() - lockedAt;
+                locked += held;
+                longest = std::max(longest, held);
+            }
+
+            // Release what we swept from this shard outside its lock
+            stuffToSweep.clear();
+        }
+
+        if (mapRemovals || cacheRemovals)
+        {
+            JLOG(m_journal.trace())
+                << m_name << ": cache -= " << cacheRemovals
+                << ", map -= " << mapRemovals;
+        }
+
+        m_metrics.evicted(cacheRemovals);
+        m_metrics.swept(
+            counts(),
+            m_clock.now(),
+            duration_cast<microseconds>(steady_clock::now() - start),
+            duration_cast<microseconds>(locked),
+            duration_cast<microseconds>(longest));
+    }
+
+    bool
+    del(const key_type& key, bool valid)
+    {
+        // Remove from cache, if !valid, remove from map too. Returns true if
+        // removed from cache
+        auto& shard = shardFor(key);
+        std::lock_guard lock(shard.mutex);
+
+        auto cit = shard.cache.find(key);
+
+        if (cit == shard.cache.end())
+            return false;
+
+        Entry& entry = cit->second;
+
+        bool ret = false;
+
+        if (entry.isCached())
+        {
+            --shard.cache_count;
+            entry.ptr.reset();
+            ret = true;
+        }
+
+        if (!valid || entry.isExpired())
+            shard.cache.erase(cit);
+
+        return ret;
+    }
+
+private:
+    template <bool replace>
+    bool
+    canonicalize(
+        const key_type& key,
+        std::conditional_t<
+            replace,
+            std::shared_ptr<T> const,
+            std::shared_ptr<T>>& data)
+    {
+        // Return canonical value, store if needed, refresh in cache
+        // Return values: true=we had the data already
+        auto& shard = shardFor(key);
+        std::lock_guard lock(shard.mutex);
+
+        auto cit = shard.cache.find(key);
+
+        if (cit == shard.cache.end())
+        {
+            shard.cache.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(key),
+                std::forward_as_tuple(now(), data));
+            ++shard.cache_count;
+            return false;
+        }
+
+        Entry& entry = cit->second;
+        touch(entry);
+
+        if (entry.isCached())
+        {
+            if constexpr (replace)
+            {
+                entry.ptr = data;
+                entry.weak_ptr = data;
+            }
+            else
+            {
+                data = entry.ptr;
+            }
+
+            return true;
+        }
+
+        auto cachedData = entry.lock();
+
+        if (cachedData)
+        {
+            if constexpr (replace)
+            {
+                entry.ptr = data;
+                entry.weak_ptr = data;
+            }
+            else
+            {
+                entry.ptr = cachedData;
+                data = cachedData;
+            }
+
+            ++shard.cache_count;
+            return true;
+        }
+
+        entry.ptr = data;
+        entry.weak_ptr = data;
+        ++shard.cache_count;
+
+        return false;
+    }
+
+public:
+    /** Replace aliased objects with originals.
+
+        @see TaggedCache::canonicalize_replace_cache
+    */
+    bool
+    canonicalize_replace_cache(
+        const key_type& key,
+        std::shared_ptr<T> const& data)
+    {
+        return canonicalize<true>(key, data);
+    }
+
+    /** Replace the caller's object with the cached original, if any.
+
+        @see TaggedCache::canonicalize_replace_client
+    */
+    bool
+    canonicalize_replace_client(const key_type& key, std::shared_ptr<T>& data)
+    {
+        return canonicalize<false>(key, data);
+    }
+
+    std::shared_ptr<T>
+    fetch(const key_type& key)
+    {
+        // fetch us a shared pointer to the stored data object
+        auto& shard = shardFor(key);
+        std::lock_guard lock(shard.mutex);
+
+        auto cit = shard.cache.find(key);
+
+        if (cit == shard.cache.end())
+        {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+
+        Entry& entry = cit->second;
+        touch(entry);
+
+        if (entry.isCached())
+        {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return entry.ptr;
+        }
+
+        entry.ptr = entry.lock();
+
+        if (entry.isCached())
+        {
+            // independent of cache size, so not counted as a hit
+            ++shard.cache_count;
+            return entry.ptr;
+        }
+
+        shard.cache.erase(cit);
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+
+    /** Insert the element into the container.
+        If the key already exists, nothing happens.
+        @return `true` If the element was inserted
+    */
+    bool
+    insert(key_type const& key, T const& value)
+    {
+        auto p = std::make_shared<T>(std::cref(value));
+        return canonicalize_replace_client(key, p);
+    }
+
+    bool
+    retrieve(const key_type& key, T& data)
+    {
+        // retrieve the value of the stored data
+        auto entry = fetch(key);
+
+        if (!entry)
+            return false;
+
+        data = *entry;
+        return true;
+    }
+
+    /** Refresh the expiration time on a key.
+
+        @param key The key to refresh.
+        @return `true` if the key was found and the object is cached.
+    */
+    bool
+    refreshIfPresent(const key_type& key)
+    {
+        bool found = false;
+
+        // If present, make current in cache
+        auto& shard = shardFor(key);
+        std::lock_guard lock(shard.mutex);
+
+        if (auto cit = shard.cache.find(key); cit != shard.cache.end())
+        {
+            Entry& entry = cit->second;
+
+            if (!entry.isCached())
+            {
+                // Convert weak to strong.
+                entry.ptr = entry.lock();
+
+                if (entry.isCached())
+                {
+                    // We just put the object back in cache
+                    ++shard.cache_count;
+                    touch(entry);
+                    found = true;
+                }
+                else
+                {
+                    // Couldn't get strong pointer,
+                    // object fell out of the cache so remove the entry.
+                    shard.cache.erase(cit);
+                }
+            }
+            else
+            {
+                // It's cached so update the timer
+                touch(entry);
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+    std::vector<key_type>
+    getKeys() const
+    {
+        std::vector<key_type> v;
+
+        for (std::size_t i = 0; i < m_shard_count; ++i)
+        {
+            auto& shard = *m_shards[i];
+            std::lock_guard lock(shard.mutex);
+            v.reserve(v.size() + shard.cache.size());
+            for (auto const& _ : shard.cache)
+                v.push_back(_.first);
+        }
+
+        return v;
+    }
+
+private:
+    struct Stats
+    {
+        template <class Handler>
+        Stats(
+            std::string const& prefix,
+            Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook(collector->make_hook(handler))
+            , size(collector->make_gauge(prefix, "size"))
+            , hit_rate(collector->make_gauge(prefix, "hit_rate"))
+        {
+        }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+    };
+
+    class Entry
+    {
+    public:
+        std::shared_ptr<mapped_type> ptr;
+        std::weak_ptr<mapped_type> weak_ptr;
+        clock_type::time_point last_access;
+
+        // Used since the last sweep, for clock eviction
+        bool referenced = true;
+
+        Entry(
+            clock_type::time_point const& last_access_,
+            std::shared_ptr<mapped_type> const& ptr_)
+            : ptr(ptr_), weak_ptr(ptr_), last_access(last_access_)
+        {
+        }
+
+        bool
+        isWeak() const
+        {
+            return ptr == nullptr;
+        }
+        bool
+        isCached() const
+        {
+            return ptr != nullptr;
+        }
+        bool
+        isExpired() const
+        {
+            return weak_ptr.expired();
+        }
+        std::shared_ptr<mapped_type>
+        lock()
+        {
+            return weak_ptr.lock();
+        }
+    };
+
+    using cache_type = hardened_hash_map<key_type, Entry, Hash, KeyEqual>;
+
+    struct Shard
+    {
+        std::mutex mutable mutex;
+        cache_type cache;
+
+        // Number of items cached
+        int cache_count = 0;
+    };
+
+    static std::size_t
+    roundShards(std::size_t shards)
+    {
+        // A power of two, so that a mask picks the shard
+        std::size_t n = 1;
+        while (n < shards)
+            n <<= 1;
+        return n;
+    }
+
+    // With NUMA, shard i is placed on node i % numa::nodeCount()
+    static std::vector<std::unique_ptr<Shard>>
+    makeShards(std::size_t count)
+    {
+        std::vector<std::unique_ptr<Shard>> shards(count);
+        auto const nodes = numa::enabled() ? numa::nodeCount() : 1;
+        for (std::size_t node = 0; node < nodes; ++node)
+        {
+            numa::runOnNode(node, [&]() {
+                for (std::size_t i = node; i < count; i += nodes)
+                    shards[i] = std::make_unique<Shard>();
+            });
+        }
+        return shards;
+    }
+
+    Shard&
+    shardFor(key_type const& key) const
+    {
+        auto const index = m_shard_hash(key) & (m_shard_count - 1);
+        if (m_numa)
+        {
+            // Each key lives in one shard, so the shard can't follow the
+            // caller, but how often it is remote is worth knowing
+            auto const node = numa::currentNode();
+            if (node >= 0)
+            {
+                if (static_cast<std::size_t>(node) ==
+                    index % numa::nodeCount())
+                    ++m_localAccesses;
+                else
+                    ++m_remoteAccesses;
+            }
+        }
+        return *m_shards[index];
+    }
+
+    // The share of the target size that falls to each shard
+    int
+    shardTarget(int targetSize) const
+    {
+        if (targetSize <= 0)
+            return 0;
+        return std::max<int>(targetSize / m_shard_count, 1);
+    }
+
+    // The time of an access, which clock eviction doesn't need
+    clock_type::time_point
+    now() const
+    {
+        if (m_eviction == Eviction::age)
+            return m_clock.now();
+        return {};
+    }
+
+    void
+    touch(Entry& entry) const
+    {
+        if (m_eviction == Eviction::age)
+            entry.last_access = m_clock.now();
+        else
+            entry.referenced = true;
+    }
+
+    clock_type::time_point
+    expiryTime(
+        Shard const& shard,
+        int targetSize,
+        clock_type::duration targetAge) const
+    {
+        clock_type::time_point const now(m_clock.now());
+
+        if (targetSize == 0 ||
+            (static_cast<int>(shard.cache.size()) <= targetSize))
+            return now - targetAge;
+
+        auto when_expire = now - targetAge * targetSize / shard.cache.size();
+
+        clock_type::duration const minimumAge(std::chrono::seconds(1));
+        if (when_expire > (now - minimumAge))
+            when_expire = now - minimumAge;
+
+        JLOG(m_journal.trace())
+            << m_name << " shard is growing fast " << shard.cache.size()
+            << " of " << targetSize << " aging at "
+            << (now - when_expire).count() << " of " << targetAge.count();
+
+        return when_expire;
+    }
+
+    // Evict a strongly cached entry, erasing it if nothing else holds it,
+    // and advance past it
+    void
+    expire(
+        Shard& shard,
+        typename cache_type::iterator& cit,
+        std::vector<std::shared_ptr<mapped_type>>& stuffToSweep,
+        int& cacheRemovals,
+        int& mapRemovals)
+    {
+        --shard.cache_count;
+        ++cacheRemovals;
+        if (cit->second.ptr.unique())
+        {
+            stuffToSweep.push_back(std::move(cit->second.ptr));
+            ++mapRemovals;
+            cit = shard.cache.erase(cit);
+            return;
+        }
+
+        // remains weakly cached
+        cit->second.ptr.reset();
+        ++cit;
+    }
+
+    void
+    sweepByAge(
+        Shard& shard,
+        clock_type::time_point when_expire,
+        std::vector<std::shared_ptr<mapped_type>>& stuffToSweep,
+        int& cacheRemovals,
+        int& mapRemovals)
+    {
+        auto cit = shard.cache.begin();
+
+        while (cit != shard.cache.end())
+        {
+            if (cit->second.isWeak())
+            {
+                // weak
+                if (cit->second.isExpired())
+                {
+                    ++mapRemovals;
+                    cit = shard.cache.erase(cit);
+                }
+                else
+                {
+                    ++cit;
+                }
+            }
+            else if (cit->second.last_access <= when_expire)
+            {
+                // strong, expired
+                expire(shard, cit, stuffToSweep, cacheRemovals, mapRemovals);
+            }
+            else
+            {
+                // strong, not expired
+                ++cit;
+            }
+        }
+    }
+
+    void
+    sweepByClock(
+        Shard& shard,
+        int targetSize,
+        std::vector<std::shared_ptr<mapped_type>>& stuffToSweep,
+        int& cacheRemovals,
+        int& mapRemovals)
+    {
+        auto cit = shard.cache.begin();
+
+        while (cit != shard.cache.end())
+        {
+            if (cit->second.isWeak())
+            {
+                // weak
+                if (cit->second.isExpired())
+                {
+                    ++mapRemovals;
+                    cit = shard.cache.erase(cit);
+                }
+                else
+                {
+                    ++cit;
+                }
+            }
+            else if (cit->second.referenced)
+            {
+                // strong, used since the last sweep: second chance
+                cit->second.referenced = false;
+                ++cit;
+            }
+            else if (targetSize == 0 || shard.cache_count > targetSize)
+            {
+                // strong, unused and not needed to stay at size
+                expire(shard, cit, stuffToSweep, cacheRemovals, mapRemovals);
+            }
+            else
+            {
+                ++cit;
+            }
+        }
+    }
+
+    CacheMetrics::Counts
+    counts() const
+    {
+        return {
+            m_hits.load(std::memory_order_relaxed),
+            m_misses.load(std::memory_order_relaxed),
+            m_metrics.evictions()};
+    }
+
+    void
+    collect_metrics()
+    {
+        m_stats.size.set(getCacheSize());
+
+        {
+            beast::insight::Gauge::value_type hit_rate(0);
+            auto const hits = m_hits.load(std::memory_order_relaxed);
+            auto const total(hits + m_misses.load(std::memory_order_relaxed));
+            if (total != 0)
+                hit_rate = (hits * 100) / total;
+            m_stats.hit_rate.set(hit_rate);
+        }
+    }
+
+private:
+    beast::Journal m_journal;
+    clock_type& m_clock;
+    Stats m_stats;
+    CacheMetrics m_metrics;
+
+    // Used for logging
+    std::string m_name;
+
+    Eviction const m_eviction;
+
+    std::size_t const m_shard_count;
+    // Whether the shards are spread across NUMA nodes
+    bool const m_numa;
+    std::vector<std::unique_ptr<Shard>> const m_shards;
+    Hash const m_shard_hash;
+
+    // Desired number of cache entries (0 = ignore)
+    std::atomic<int> m_target_size;
+
+    // Desired maximum cache age
+    std::atomic<clock_type::duration> m_target_age;
+
+    std::atomic<std::uint64_t> m_hits;
+    std::atomic<std::uint64_t> m_misses;
+
+    // Shard accesses from the shard's NUMA node, and from other nodes
+    std::atomic<std::uint64_t> mutable m_localAccesses{0};
+    std::atomic<std::uint64_t> mutable m_remoteAccesses{0};
+};
+
+}  // namespace ripple
+
+#endif
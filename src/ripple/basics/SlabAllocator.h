@@ -0,0 +1,344 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_SLABALLOCATOR_H_INCLUDED
+#define RIPPLE_BASICS_SLABALLOCATOR_H_INCLUDED
+
+#include <ripple/basics/spinlock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Hands out fixed size blocks of memory carved from large slabs.
+
+    Each block holds an object of type `Type` followed by a fixed number
+    of extra bytes. Blocks are taken from the most recent slab first, and
+    freed blocks are kept on a per-slab free list for reuse. A slab is
+    only touched as its blocks are handed out, so the pages of a fresh
+    slab do not become resident until they are needed.
+
+    Slabs are never returned to the system while the allocator exists.
+
+    @note The allocator only manages memory: callers construct and
+          destroy the objects that they place in it.
+*/
+template <typename Type>
+class SlabAllocator
+{
+private:
+    struct SlabBlock
+    {
+        // The next, older, slab.
+        SlabBlock* const next_;
+
+        std::uint8_t* const p_;
+        std::uint8_t* const end_;
+
+        // The first block that was never handed out.
+        std::uint8_t* avail_;
+
+        // Freed blocks, each holding a pointer to the next one.
+        std::uint8_t* free_ = nullptr;
+
+        std::atomic<std::uint8_t> lock_ = 0;
+
+        SlabBlock(
+            SlabBlock* next,
+            std::uint8_t* data,
+            std::size_t size,
+            std::size_t item)
+            : next_(next)
+            , p_(data)
+            , end_(data + (size / item) * item)
+            , avail_(data)
+        {
+        }
+
+        SlabBlock(SlabBlock const&) = delete;
+        SlabBlock&
+        operator=(SlabBlock const&) = delete;
+
+        ~SlabBlock()
+        {
+            std::free(p_);
+        }
+
+        bool
+        own(std::uint8_t const* p) const noexcept
+        {
+            return (p >= p_) && (p < end_);
+        }
+
+        std::uint8_t*
+        allocate(std::size_t item) noexcept
+        {
+            spinlock sl(lock_);
+            std::lock_guard lock(sl);
+
+            if (auto ret = free_)
+            {
+                std::memcpy(&free_, ret, sizeof(free_));
+                return ret;
+            }
+
+            if (avail_ == end_)
+                return nullptr;
+
+            auto ret = avail_;
+            avail_ += item;
+            return ret;
+        }
+
+        void
+        deallocate(std::uint8_t* p) noexcept
+        {
+            assert(own(p));
+
+            spinlock sl(lock_);
+            std::lock_guard lock(sl);
+
+            std::memcpy(p, &free_, sizeof(free_));
+            free_ = p;
+        }
+    };
+
+    // The slabs, newest first. Slabs are only ever added.
+    std::atomic<SlabBlock*> slabs_ = nullptr;
+
+    // Serializes the creation of new slabs.
+    std::mutex growMutex_;
+
+    // The size of each block, and the size of each slab.
+    std::size_t const itemSize_;
+    std::size_t const slabSize_;
+
+public:
+    /** Constructs a slab allocator able to allocate objects of a fixed size
+
+        @param extra The number of bytes to reserve after each object.
+        @param alloc The size of each slab.
+        @param align The alignment of each block.
+     */
+    explicit SlabAllocator(
+        std::size_t extra,
+        std::size_t alloc,
+        std::size_t align = alignof(Type))
+        : itemSize_(
+              ((std::max(sizeof(Type) + extra, sizeof(std::uint8_t*)) +
+                align - 1) /
+               align) *
+              align)
+        , slabSize_(alloc)
+    {
+        // Slabs come from malloc, which suits any fundamental alignment.
+        assert(align != 0 && (align & (align - 1)) == 0);
+        assert(align <= alignof(std::max_align_t));
+        assert(slabSize_ >= itemSize_);
+    }
+
+    SlabAllocator(SlabAllocator const& other) = delete;
+    SlabAllocator&
+    operator=(SlabAllocator const& other) = delete;
+
+    ~SlabAllocator()
+    {
+        auto slab = slabs_.load();
+        while (slab != nullptr)
+        {
+            auto next = slab->next_;
+            delete slab;
+            slab = next;
+        }
+    }
+
+    /** Returns the size of the memory block this allocator returns. */
+    constexpr std::size_t
+    size() const noexcept
+    {
+        return itemSize_;
+    }
+
+    /** Returns a suitably aligned pointer, if one is available.
+
+        @return a pointer to a block of memory from the allocator, or
+                nullptr if the allocator can't satisfy this request.
+     */
+    std::uint8_t*
+    allocate() noexcept
+    {
+        auto const head = slabs_.load(std::memory_order_acquire);
+
+        for (auto slab = head; slab != nullptr; slab = slab->next_)
+        {
+            if (auto ret = slab->allocate(itemSize_))
+                return ret;
+        }
+
+        std::lock_guard lock(growMutex_);
+
+        // Another thread may have added slabs while we searched.
+        auto const newest = slabs_.load(std::memory_order_acquire);
+
+        for (auto slab = newest; slab != head; slab = slab->next_)
+        {
+            if (auto ret = slab->allocate(itemSize_))
+                return ret;
+        }
+
+        auto buf = static_cast<std::uint8_t*>(std::malloc(slabSize_));
+
+        if (buf == nullptr)
+            return nullptr;
+
+        SlabBlock* slab = nullptr;
+
+        try
+        {
+            slab = new SlabBlock(newest, buf, slabSize_, itemSize_);
+        }
+        catch (std::bad_alloc const&)
+        {
+            std::free(buf);
+            return nullptr;
+        }
+
+        auto ret = slab->allocate(itemSize_);
+        slabs_.store(slab, std::memory_order_release);
+        return ret;
+    }
+
+    /** Returns the memory block to the allocator.
+
+        @param ptr A pointer to a memory block.
+
+        @return true if this memory block belonged to the allocator and has
+                been released; false otherwise.
+     */
+    bool
+    deallocate(std::uint8_t* ptr) noexcept
+    {
+        assert(ptr != nullptr);
+
+        for (auto slab = slabs_.load(std::memory_order_acquire);
+             slab != nullptr;
+             slab = slab->next_)
+        {
+            if (slab->own(ptr))
+            {
+                slab->deallocate(ptr);
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+/** A collection of slab allocators of various sizes for a given type. */
+template <typename Type>
+class SlabAllocatorSet
+{
+public:
+    struct SlabConfig
+    {
+        // The number of extra bytes each block reserves after the object
+        std::size_t extra;
+
+        // The size of each slab
+        std::size_t alloc;
+
+        // The alignment of each block
+        std::size_t align = alignof(Type);
+    };
+
+private:
+    // The allocators, ordered by increasing block size.
+    std::vector<std::unique_ptr<SlabAllocator<Type>>> allocators_;
+
+public:
+    explicit SlabAllocatorSet(std::vector<SlabConfig> cfg)
+    {
+        std::sort(cfg.begin(), cfg.end(), [](auto const& a, auto const& b) {
+            return a.extra < b.extra;
+        });
+
+        allocators_.reserve(cfg.size());
+
+        for (auto const& c : cfg)
+            allocators_.push_back(std::make_unique<SlabAllocator<Type>>(
+                c.extra, c.alloc, c.align));
+    }
+
+    SlabAllocatorSet(SlabAllocatorSet const& other) = delete;
+    SlabAllocatorSet&
+    operator=(SlabAllocatorSet const& other) = delete;
+
+    /** Returns a suitably aligned pointer, if one is available.
+
+        @param extra The number of extra bytes, above and beyond the size of
+                     the object, that should be returned by the allocator.
+
+        @return a pointer to a block of memory, or nullptr if the allocator
+                can't satisfy this request.
+     */
+    std::uint8_t*
+    allocate(std::size_t extra) noexcept
+    {
+        for (auto& a : allocators_)
+        {
+            if (a->size() >= sizeof(Type) + extra)
+                return a->allocate();
+        }
+
+        return nullptr;
+    }
+
+    /** Returns the memory block to the allocator.
+
+        @param ptr A pointer to a memory block.
+
+        @return true if this memory block belonged to one of the allocators
+                in this set and has been released; false otherwise.
+     */
+    bool
+    deallocate(std::uint8_t* ptr) noexcept
+    {
+        for (auto& a : allocators_)
+        {
+            if (a->deallocate(ptr))
+                return true;
+        }
+
+        return false;
+    }
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_STACKSAMPLER_H_INCLUDED
+#define RIPPLE_BASICS_STACKSAMPLER_H_INCLUDED
+
+#include <chrono>
+#include <string>
+
+namespace ripple {
+namespace perf {
+
+/** Whether sampleStacks can capture stacks on this platform. */
+bool
+canSampleStacks();
+
+/** Capture the stacks of every thread in the process, several times.
+
+    Each thread other than the caller is interrupted with a signal, and
+    records its own stack in the handler. Stacks that stay the same across
+    samples are reported once, with the number of samples they were seen
+    in, which picks out threads that are blocked or spinning.
+
+    Frames are named from the dynamic symbol table, so the binary must be
+    linked with -rdynamic for function names to appear. Otherwise each
+    frame gives a module and offset for addr2line.
+
+    Only one call runs at a time; a call made while another is running
+    waits for it.
+
+    @param samples The number of times every thread is sampled
+    @param interval The time between samples
+    @return A text report, one section per thread
+*/
+std::string
+sampleStacks(int samples, std::chrono::milliseconds interval);
+
+}  // namespace perf
+}  // namespace ripple
+
+#endif
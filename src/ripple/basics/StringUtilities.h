@@ -86,15 +86,33 @@ strUnHex(std::size_t strSize, Iterator begin, Iterator end)
 }
 
 inline boost::optional<Blob>
-strUnHex(std::string const& strSrc)
+strViewUnHex(boost::string_view const& strSrc)
 {
-    return strUnHex(strSrc.size(), strSrc.cbegin(), strSrc.cend());
+    Blob out((strSrc.size() + 1) / 2);
+
+    auto in = strSrc.data();
+    auto dest = out.data();
+
+    if (strSrc.size() & 1)
+    {
+        int c = charUnHex(*in++);
+
+        if (c < 0)
+            return {};
+
+        *dest++ = static_cast<unsigned char>(c);
+    }
+
+    if (!hexDecode(in, strSrc.size() / 2, dest))
+        return {};
+
+    return {std::move(out)};
 }
 
 inline boost::optional<Blob>
-strViewUnHex(boost::string_view const& strSrc)
+strUnHex(std::string const& strSrc)
 {
-    return strUnHex(strSrc.size(), strSrc.cbegin(), strSrc.cend());
+    return strViewUnHex(strSrc);
 }
 
 struct parsedURL
@@ -20,13 +20,18 @@
 #ifndef RIPPLE_BASICS_TAGGEDCACHE_H_INCLUDED
 #define RIPPLE_BASICS_TAGGEDCACHE_H_INCLUDED
 
+#include <ripple/basics/CacheMetrics.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/basics/hardened_hash.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <iterator>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 namespace ripple {
@@ -72,6 +77,7 @@ public:
               name,
               std::bind(&TaggedCache::collect_metrics, this),
               collector)
+        , m_metrics(name, collector)
         , m_name(name)
         , m_target_size(size)
         , m_target_age(expiration)
@@ -165,100 +171,137 @@ public:
         m_misses = 0;
     }
 
+    /** Sizes and statistics, for get_counts. */
+    Json::Value
+    getJson() const
+    {
+        CacheMetrics::Counts counts;
+        std::size_t cached;
+        std::size_t tracked;
+        int target;
+        {
+            std::lock_guard lock(m_mutex);
+            counts = {m_hits, m_misses, m_metrics.evictions()};
+            cached = m_cache_count;
+            tracked = m_cache.size();
+            target = m_target_size;
+        }
+
+        Json::Value ret(Json::objectValue);
+        ret["size"] = static_cast<Json::UInt>(cached);
+        ret["track_size"] = static_cast<Json::UInt>(tracked);
+        ret["target_size"] = target;
+        ret["estimated_bytes"] = std::to_string(CacheMetrics::estimateBytes(
+            tracked,
+            sizeof(typename cache_type::value_type),
+            cached,
+            sizeof(mapped_type)));
+        m_metrics.getJson(ret, counts, m_clock.now());
+        return ret;
+    }
+
+    /** Return the longest a sweep holds the lock at a time. */
+    std::chrono::microseconds
+    getSweepBudget() const
+    {
+        return m_sweep_budget.load();
+    }
+
+    /** Set the longest a sweep holds the lock at a time.
+
+        A sweep visits the map a slice of buckets at a time and releases
+        the lock between slices, so lookups wait at most about this long.
+    */
+    void
+    setSweepBudget(std::chrono::microseconds budget)
+    {
+        m_sweep_budget = budget;
+    }
+
     void
     sweep()
     {
+        using namespace std::chrono;
+        auto const start = steady_clock::now();
+        auto const budget = m_sweep_budget.load();
+        steady_clock::duration locked{};
+        steady_clock::duration longest{};
+
         int cacheRemovals = 0;
         int mapRemovals = 0;
-        int cc = 0;
+        int slices = 0;
 
         // Keep references to all the stuff we sweep
         // so that we can destroy them outside the lock.
         //
         std::vector<std::shared_ptr<mapped_type>> stuffToSweep;
+        CacheMetrics::Counts counts;
 
-        {
-            clock_type::time_point const now(m_clock.now());
-            clock_type::time_point when_expire;
+        clock_type::time_point when_expire;
+        std::size_t bucket = 0;
+        bool done = false;
 
-            std::lock_guard lock(m_mutex);
+        while (!done)
+        {
+            if (slices != 0)
+                std::this_thread::yield();
 
-            if (m_target_size == 0 ||
-                (static_cast<int>(m_cache.size()) <= m_target_size))
             {
-                when_expire = now - m_target_age;
-            }
-            else
-            {
-                when_expire =
-                    now - m_target_age * m_target_size / m_cache.size();
-
-                clock_type::duration const minimumAge(std::chrono::seconds(1));
-                if (when_expire > (now - minimumAge))
-                    when_expire = now - minimumAge;
-
-                JLOG(m_journal.trace())
-                    << m_name << " is growing fast " << m_cache.size() << " of "
-                    << m_target_size << " aging at "
-                    << (now - when_expire).count() << " of "
-                    << m_target_age.count();
-            }
-
-            stuffToSweep.reserve(m_cache.size());
+                std::lock_guard lock(m_mutex);
+                auto const lockedAt = steady_clock::now();
 
-            auto cit = m_cache.begin();
+                if (slices++ == 0)
+                    when_expire = expiryTime();
 
-            while (cit != m_cache.end())
-            {
-                if (cit->second.isWeak())
-                {
-                    // weak
-                    if (cit->second.isExpired())
-                    {
-                        ++mapRemovals;
-                        cit = m_cache.erase(cit);
-                    }
-                    else
-                    {
-                        ++cit;
-                    }
-                }
-                else if (cit->second.last_access <= when_expire)
+                // The map may have been rehashed since the last slice, in
+                // which case some entries are visited twice or not at all
+                // until the next sweep. Neither is harmful.
+                auto const buckets = m_cache.bucket_count();
+                while (bucket < buckets)
                 {
-                    // strong, expired
-                    --m_cache_count;
-                    ++cacheRemovals;
-                    if (cit->second.ptr.unique())
-                    {
-                        stuffToSweep.push_back(cit->second.ptr);
-                        ++mapRemovals;
-                        cit = m_cache.erase(cit);
-                    }
-                    else
-                    {
-                        // remains weakly cached
-                        cit->second.ptr.reset();
-                        ++cit;
-                    }
+                    sweepBucket(
+                        bucket++,
+                        when_expire,
+                        stuffToSweep,
+                        cacheRemovals,
+                        mapRemovals);
+
+                    if (bucket % sweepCheckInterval == 0 &&
+                        steady_clock::now() - lockedAt >= budget)
+                        break;
                 }
-                else
+                done = bucket >= buckets;
+
+                if (done)
                 {
-                    // strong, not expired
-                    ++cc;
-                    ++cit;
+                    m_metrics.evicted(cacheRemovals);
+                    counts = {m_hits, m_misses, m_metrics.evictions()};
                 }
+
+                auto const held = steady_clock::now() - lockedAt;
+                locked += held;
+                longest = std::max(longest, held);
             }
+
+            // Decrement the reference count on each strong pointer outside
+            // the lock, counting the time as part of the sweep
+            stuffToSweep.clear();
         }
 
         if (mapRemovals || cacheRemovals)
         {
             JLOG(m_journal.trace())
                 << m_name << ": cache = " << m_cache.size() << "-"
-                << cacheRemovals << ", map-=" << mapRemovals;
+                << cacheRemovals << ", map-=" << mapRemovals << " in "
+                << slices << " slices";
         }
 
-        // At this point stuffToSweep will go out of scope outside the lock
-        // and decrement the reference count on each strong pointer.
+        m_metrics.swept(
+            counts,
+            m_clock.now(),
+            duration_cast<microseconds>(steady_clock::now() - start),
+            duration_cast<microseconds>(locked),
+            duration_cast<microseconds>(longest));
     }
 
     bool
@@ -602,9 +645,93 @@ private:
 
     using cache_type = hardened_hash_map<key_type, Entry, Hash, KeyEqual>;
 
+    // Buckets a sweep visits between checks of how long it held the lock
+    static constexpr std::size_t sweepCheckInterval = 16;
+
+    // Strong entries last accessed at or before this time expire. Called
+    // with the lock held.
+    clock_type::time_point
+    expiryTime() const
+    {
+        clock_type::time_point const now(m_clock.now());
+
+        if (m_target_size == 0 ||
+            (static_cast<int>(m_cache.size()) <= m_target_size))
+            return now - m_target_age;
+
+        auto when_expire = now - m_target_age * m_target_size / m_cache.size();
+
+        clock_type::duration const minimumAge(std::chrono::seconds(1));
+        if (when_expire > (now - minimumAge))
+            when_expire = now - minimumAge;
+
+        JLOG(m_journal.trace())
+            << m_name << " is growing fast " << m_cache.size() << " of "
+            << m_target_size << " aging at " << (now - when_expire).count()
+            << " of " << m_target_age.count();
+        return when_expire;
+    }
+
+    // Bucket iterators cannot be used to erase, so erase by a copy of the
+    // key, which may not refer into the entry being erased
+    void
+    eraseKey(key_type const& key)
+    {
+        key_type const copy(key);
+        m_cache.erase(copy);
+    }
+
+    // Sweep the entries in one bucket of the map. Called with the lock
+    // held.
+    void
+    sweepBucket(
+        std::size_t bucket,
+        clock_type::time_point when_expire,
+        std::vector<std::shared_ptr<mapped_type>>& stuffToSweep,
+        int& cacheRemovals,
+        int& mapRemovals)
+    {
+        auto cit = m_cache.begin(bucket);
+        while (cit != m_cache.end(bucket))
+        {
+            // Erasing an entry leaves the iterators to the others valid
+            auto next = std::next(cit);
+
+            if (cit->second.isWeak())
+            {
+                // weak
+                if (cit->second.isExpired())
+                {
+                    ++mapRemovals;
+                    eraseKey(cit->first);
+                }
+            }
+            else if (cit->second.last_access <= when_expire)
+            {
+                // strong, expired
+                --m_cache_count;
+                ++cacheRemovals;
+                if (cit->second.ptr.unique())
+                {
+                    stuffToSweep.push_back(cit->second.ptr);
+                    ++mapRemovals;
+                    eraseKey(cit->first);
+                }
+                else
+                {
+                    // remains weakly cached
+                    cit->second.ptr.reset();
+                }
+            }
+
+            cit = next;
+        }
+    }
+
     beast::Journal m_journal;
     clock_type& m_clock;
     Stats m_stats;
+    CacheMetrics m_metrics;
 
     mutex_type mutable m_mutex;
 
@@ -617,6 +744,10 @@ private:
     // Desired maximum cache age
     clock_type::duration m_target_age;
 
+    // Longest a sweep holds the lock at a time
+    std::atomic<std::chrono::microseconds> m_sweep_budget{
+        std::chrono::milliseconds(2)};
+
     // Number of items cached
     int m_cache_count;
     cache_type m_cache;  // Hold strong reference to recent objects
@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_TRACER_H_INCLUDED
+#define RIPPLE_BASICS_TRACER_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/json/json_value.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+namespace perf {
+
+/** Records timed spans of work for viewing as a timeline.
+
+    Spans are kept in a ring buffer holding the most recent ones, and are
+    exported in the Chrome trace event format, which chrome://tracing and
+    Perfetto load. Each span may carry the sequence of the ledger it was
+    working on, so the phases of closing one ledger can be picked out.
+
+    Recording takes a lock, so spans are meant for work that takes tens of
+    microseconds or more. While disabled, a span costs one atomic load.
+*/
+class Tracer
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    /** Configuration from the [trace] section of rippled.cfg. */
+    struct Setup
+    {
+        bool enabled = false;
+        // Spans kept before the oldest are overwritten
+        std::size_t capacity = 65536;
+        // Whether every job the JobQueue runs is recorded
+        bool jobs = false;
+    };
+
+    /** Times the scope it lives in as a span. */
+    class Span
+    {
+    public:
+        /** Start a span.
+
+            @param name Name of the span, with static storage duration
+            @param category Category of the span, with static storage
+                            duration
+            @param ledgerSeq Sequence of the ledger worked on, or zero
+        */
+        Span(
+            Tracer& tracer,
+            char const* name,
+            char const* category,
+            std::uint32_t ledgerSeq = 0)
+            : tracer_(tracer.enabled() ? &tracer : nullptr)
+            , name_(name)
+            , category_(category)
+            , ledgerSeq_(ledgerSeq)
+        {
+            if (tracer_)
+                start_ = clock_type::now();
+        }
+
+        Span(Span const&) = delete;
+        Span&
+        operator=(Span const&) = delete;
+
+        ~Span()
+        {
+            if (tracer_)
+                tracer_->record(
+                    name_, category_, start_, clock_type::now(), ledgerSeq_);
+        }
+
+        /** Set the ledger the span is for, once it is known. */
+        void
+        setLedgerSeq(std::uint32_t ledgerSeq)
+        {
+            ledgerSeq_ = ledgerSeq;
+        }
+
+    private:
+        Tracer* tracer_;
+        char const* name_;
+        char const* category_;
+        std::uint32_t ledgerSeq_;
+        clock_type::time_point start_;
+    };
+
+    explicit Tracer(Setup const& setup);
+
+    Tracer(Tracer const&) = delete;
+    Tracer&
+    operator=(Tracer const&) = delete;
+
+    bool
+    enabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void
+    setEnabled(bool enabled)
+    {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    /** Whether the JobQueue should record each job it runs. */
+    bool
+    tracingJobs() const
+    {
+        return jobs_ && enabled();
+    }
+
+    /** Record a span that was timed by the caller. */
+    void
+    record(
+        char const* name,
+        char const* category,
+        clock_type::time_point start,
+        clock_type::time_point end,
+        std::uint32_t ledgerSeq = 0);
+
+    /** Return the recorded spans as a Chrome trace, oldest first.
+
+        @param minLedgerSeq If not zero, only spans for this ledger or
+                            later, or for no ledger, are returned
+    */
+    Json::Value
+    getJson(std::uint32_t minLedgerSeq = 0) const;
+
+    /** Discard the recorded spans. */
+    void
+    clear();
+
+    /** The number of spans held. */
+    std::size_t
+    size() const;
+
+private:
+    struct Event
+    {
+        char const* name;
+        char const* category;
+        clock_type::time_point start;
+        clock_type::duration duration;
+        std::uint32_t thread;
+        std::uint32_t ledgerSeq;
+    };
+
+    std::atomic<bool> enabled_;
+    bool const jobs_;
+    // Spans are timed from here
+    clock_type::time_point const epoch_;
+
+    std::mutex mutable mutex_;
+    std::vector<Event> events_;
+    std::size_t const capacity_;
+    // Where the next span goes once the buffer is full
+    std::size_t next_ = 0;
+};
+
+Tracer::Setup
+setup_Tracer(Section const& section);
+
+}  // namespace perf
+}  // namespace ripple
+
+#endif
@@ -24,6 +24,8 @@
 #include <ripple/beast/hash/hash_append.h>
 #include <ripple/beast/hash/uhash.h>
 #include <ripple/beast/hash/xxhasher.h>
+#include <cstring>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -34,6 +36,9 @@
  * Use hardened_hash_* containers for keys that do need a secure hashing
  * algorithm.
  *
+ * Use uniform_hash_* containers for keys that are already uniformly
+ * distributed, such as SHA-512 digests, and that an attacker cannot choose.
+ *
  * The cryptographic security of containers where a hash function is used as a
  * template parameter depends entirely on that hash function and not at all on
  * what container it is.
@@ -110,6 +115,55 @@ template <
 using hardened_hash_multiset =
     std::unordered_multiset<Value, Hash, Pred, Allocator>;
 
+// uniform_hash containers
+
+/** Hashes a key that is already uniformly distributed.
+
+    Ledger object keys, transaction IDs and amendment IDs are digests, so
+    their first 64 bits make a good hash as they are. Key must provide
+    `data()` and a static `bytes`, as base_uint does.
+*/
+struct uniform_key_hash
+{
+    explicit uniform_key_hash() = default;
+
+    using result_type = std::size_t;
+
+    template <class Key>
+    result_type
+    operator()(Key const& key) const noexcept
+    {
+        static_assert(Key::bytes >= sizeof(result_type), "");
+        result_type result;
+        std::memcpy(&result, key.data(), sizeof(result));
+        return result;
+    }
+};
+
+// Define RIPPLE_UNIFORM_KEY_HASH to 0 to build the uniform_hash containers
+// with the general purpose hash instead.
+#ifndef RIPPLE_UNIFORM_KEY_HASH
+#define RIPPLE_UNIFORM_KEY_HASH 1
+#endif
+
+using uniform_hash = std::
+    conditional_t<RIPPLE_UNIFORM_KEY_HASH, uniform_key_hash, beast::uhash<>>;
+
+template <
+    class Key,
+    class Value,
+    class Hash = uniform_hash,
+    class Pred = std::equal_to<Key>,
+    class Allocator = std::allocator<std::pair<Key const, Value>>>
+using uniform_hash_map = std::unordered_map<Key, Value, Hash, Pred, Allocator>;
+
+template <
+    class Value,
+    class Hash = uniform_hash,
+    class Pred = std::equal_to<Value>,
+    class Allocator = std::allocator<Value>>
+using uniform_hash_set = std::unordered_set<Value, Hash, Pred, Allocator>;
+
 }  // namespace ripple
 
 #endif
@@ -23,18 +23,17 @@
 #include <archive.h>
 #include <archive_entry.h>
 
+#include <algorithm>
+
 namespace ripple {
 
-void
-extractTarLz4(
-    boost::filesystem::path const& src,
-    boost::filesystem::path const& dst)
-{
-    if (!is_regular_file(src))
-        Throw<std::runtime_error>("Invalid source file");
+namespace {
+
+using archive_ptr = std::unique_ptr<struct archive, void (*)(struct archive*)>;
 
-    using archive_ptr =
-        std::unique_ptr<struct archive, void (*)(struct archive*)>;
+archive_ptr
+makeReader()
+{
     archive_ptr ar{
         archive_read_new(), [](struct archive* a) { archive_read_free(a); }};
     if (!ar)
@@ -46,13 +45,28 @@ extractTarLz4(
     if (archive_read_support_filter_lz4(ar.get()) < ARCHIVE_OK)
         Throw<std::runtime_error>(archive_error_string(ar.get()));
 
-    // Examples suggest this block size
-    if (archive_read_open_filename(ar.get(), src.string().c_str(), 10240) <
-        ARCHIVE_OK)
+    return ar;
+}
+
+// Returns true if the entry path stays within the destination
+bool
+isSafePath(boost::filesystem::path const& p)
+{
+    if (p.empty() || p.has_root_path())
+        return false;
+
+    for (auto const& part : p)
     {
-        Throw<std::runtime_error>(archive_error_string(ar.get()));
+        if (part == "..")
+            return false;
     }
+    return true;
+}
 
+// Writes every entry of an opened archive into the destination
+void
+extract(struct archive* ar, boost::filesystem::path const& dst)
+{
     archive_ptr aw{archive_write_disk_new(), [](struct archive* a) {
                        archive_write_free(a);
                    }};
@@ -62,7 +76,8 @@ extractTarLz4(
     if (archive_write_disk_set_options(
             aw.get(),
             ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_PERM | ARCHIVE_EXTRACT_ACL |
-                ARCHIVE_EXTRACT_FFLAGS) < ARCHIVE_OK)
+                ARCHIVE_EXTRACT_FFLAGS | ARCHIVE_EXTRACT_SECURE_NODOTDOT |
+                ARCHIVE_EXTRACT_SECURE_SYMLINKS) < ARCHIVE_OK)
     {
         Throw<std::runtime_error>(archive_error_string(aw.get()));
     }
@@ -74,14 +89,20 @@ extractTarLz4(
     struct archive_entry* entry;
     while (true)
     {
-        result = archive_read_next_header(ar.get(), &entry);
+        result = archive_read_next_header(ar, &entry);
         if (result == ARCHIVE_EOF)
             break;
         if (result < ARCHIVE_OK)
-            Throw<std::runtime_error>(archive_error_string(ar.get()));
+            Throw<std::runtime_error>(archive_error_string(ar));
+
+        boost::filesystem::path const entryPath{archive_entry_pathname(entry)};
+        if (!isSafePath(entryPath))
+        {
+            Throw<std::runtime_error>(
+                "Invalid archive entry path: " + entryPath.string());
+        }
 
-        archive_entry_set_pathname(
-            entry, (dst / archive_entry_pathname(entry)).string().c_str());
+        archive_entry_set_pathname(entry, (dst / entryPath).string().c_str());
         if (archive_write_header(aw.get(), entry) < ARCHIVE_OK)
             Throw<std::runtime_error>(archive_error_string(aw.get()));
 
@@ -92,11 +113,11 @@ extractTarLz4(
             la_int64_t offset;
             while (true)
             {
-                result = archive_read_data_block(ar.get(), &buf, &sz, &offset);
+                result = archive_read_data_block(ar, &buf, &sz, &offset);
                 if (result == ARCHIVE_EOF)
                     break;
                 if (result < ARCHIVE_OK)
-                    Throw<std::runtime_error>(archive_error_string(ar.get()));
+                    Throw<std::runtime_error>(archive_error_string(ar));
 
                 if (archive_write_data_block(aw.get(), buf, sz, offset) <
                     ARCHIVE_OK)
@@ -111,4 +132,154 @@ extractTarLz4(
     }
 }
 
+}  // namespace
+
+void
+extractTarLz4(
+    boost::filesystem::path const& src,
+    boost::filesystem::path const& dst)
+{
+    if (!is_regular_file(src))
+        Throw<std::runtime_error>("Invalid source file");
+
+    auto ar{makeReader()};
+
+    // Examples suggest this block size
+    if (archive_read_open_filename(ar.get(), src.string().c_str(), 10240) <
+        ARCHIVE_OK)
+    {
+        Throw<std::runtime_error>(archive_error_string(ar.get()));
+    }
+
+    extract(ar.get(), dst);
+}
+
+TarLz4Extractor::TarLz4Extractor(
+    boost::filesystem::path const& dst,
+    std::size_t maxBuffered)
+    : dst_(dst), maxBuffered_(std::max<std::size_t>(maxBuffered, 1))
+{
+    thread_ = std::thread(&TarLz4Extractor::run, this);
+}
+
+TarLz4Extractor::~TarLz4Extractor()
+{
+    cancel();
+}
+
+void
+TarLz4Extractor::write(void const* data, std::size_t size)
+{
+    if (size == 0)
+        return;
+
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this] {
+        return buffered_ < maxBuffered_ || finished_ || stopped_;
+    });
+
+    if (!error_.empty())
+        Throw<std::runtime_error>(error_);
+    if (stopped_)
+        Throw<std::runtime_error>("Extraction canceled");
+
+    // The archive ended, anything that follows is padding
+    if (finished_)
+        return;
+
+    auto const p{static_cast<std::uint8_t const*>(data)};
+    queue_.emplace_back(p, p + size);
+    buffered_ += size;
+    cv_.notify_all();
+}
+
+void
+TarLz4Extractor::finish()
+{
+    {
+        std::lock_guard lock(mutex_);
+        done_ = true;
+        cv_.notify_all();
+    }
+
+    if (thread_.joinable())
+        thread_.join();
+
+    std::lock_guard lock(mutex_);
+    if (!error_.empty())
+        Throw<std::runtime_error>(error_);
+    if (stopped_)
+        Throw<std::runtime_error>("Extraction canceled");
+}
+
+void
+TarLz4Extractor::cancel()
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (!finished_)
+            stopped_ = true;
+        cv_.notify_all();
+    }
+
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void
+TarLz4Extractor::run()
+{
+    try
+    {
+        auto ar{makeReader()};
+
+        auto const read = [](struct archive*,
+                             void* client,
+                             const void** buffer) -> la_ssize_t {
+            return static_cast<TarLz4Extractor*>(client)->pull(buffer);
+        };
+
+        if (archive_read_open(ar.get(), this, nullptr, read, nullptr) <
+            ARCHIVE_OK)
+        {
+            Throw<std::runtime_error>(archive_error_string(ar.get()));
+        }
+
+        extract(ar.get(), dst_);
+    }
+    catch (std::exception const& e)
+    {
+        std::lock_guard lock(mutex_);
+        error_ = e.what();
+    }
+
+    std::lock_guard lock(mutex_);
+    finished_ = true;
+    queue_.clear();
+    buffered_ = 0;
+    cv_.notify_all();
+}
+
+std::ptrdiff_t
+TarLz4Extractor::pull(void const** buffer)
+{
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this] { return !queue_.empty() || done_ || stopped_; });
+
+    if (stopped_)
+        return ARCHIVE_FATAL;
+
+    // End of input
+    if (queue_.empty())
+        return 0;
+
+    current_ = std::move(queue_.front());
+    queue_.pop_front();
+    buffered_ -= current_.size();
+    cv_.notify_all();
+
+    *buffer = current_.data();
+    return static_cast<std::ptrdiff_t>(current_.size());
+}
+
 }  // namespace ripple
@@ -20,13 +20,19 @@
 #include <ripple/basics/Log.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/contract.h>
+#include <ripple/beast/core/CurrentThreadName.h>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 
@@ -113,6 +119,332 @@ Logs::File::writeln(char const* text)
     }
 }
 
+void
+Logs::File::flush()
+{
+    if (m_stream != nullptr)
+        m_stream->flush();
+}
+
+//------------------------------------------------------------------------------
+
+/** Formats and writes messages logged from many threads on one thread.
+
+    Each thread that logs gets a ring of messages that only it fills and
+    only the writer thread empties, so logging takes no lock and threads
+    do not contend with each other. The strings in a slot keep their
+    storage when the slot is reused, so a message that fits in a slot
+    used before is queued without allocating.
+*/
+class Logs::AsyncWriter
+{
+private:
+    struct Record
+    {
+        std::chrono::system_clock::time_point when;
+        beast::severities::Severity level;
+        std::string partition;
+        std::string text;
+    };
+
+    // A queue with a single producer and a single consumer
+    class Ring
+    {
+    private:
+        std::vector<Record> slots_;
+        std::uint64_t const mask_;
+
+        // Advanced by the thread that logs
+        alignas(64) std::atomic<std::uint64_t> head_{0};
+
+        // Advanced by the writer thread
+        alignas(64) std::atomic<std::uint64_t> tail_{0};
+
+    public:
+        // Messages this thread has discarded
+        std::atomic<std::uint64_t> dropped{0};
+
+        // Set when the writer stops; the ring will not be drained again
+        std::atomic<bool> closed{false};
+
+        explicit Ring(std::size_t capacity)
+            : slots_(capacity), mask_(capacity - 1)
+        {
+        }
+
+        bool
+        push(
+            std::chrono::system_clock::time_point when,
+            beast::severities::Severity level,
+            std::string const& partition,
+            std::string const& text)
+        {
+            auto const head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) == slots_.size())
+                return false;
+            auto& slot = slots_[head & mask_];
+            slot.when = when;
+            slot.level = level;
+            slot.partition.assign(partition);
+            slot.text.assign(text);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Called by the thread that logs
+        bool
+        halfFull() const
+        {
+            return 2 * (head_.load(std::memory_order_relaxed) -
+                        tail_.load(std::memory_order_relaxed)) >=
+                slots_.size();
+        }
+
+        // Called by the writer thread
+        bool
+        empty() const
+        {
+            return head_.load(std::memory_order_acquire) ==
+                tail_.load(std::memory_order_relaxed);
+        }
+
+        template <class Function>
+        void
+        drain(Function&& f)
+        {
+            auto tail = tail_.load(std::memory_order_relaxed);
+            auto const head = head_.load(std::memory_order_acquire);
+            while (tail != head)
+            {
+                f(slots_[tail & mask_]);
+                tail_.store(++tail, std::memory_order_release);
+            }
+        }
+    };
+
+    // Formatted output is written in pieces of about this size
+    static constexpr std::size_t batchBytes = 64 * 1024;
+
+    Logs& logs_;
+    std::size_t const capacity_;
+    Overflow const overflow_;
+
+    // Distinguishes this writer in the rings cached by each thread
+    std::uint64_t const id_;
+
+    std::mutex mutable mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    std::uint64_t retiredDrops_ = 0;
+    std::uint64_t flushRequested_ = 0;
+    std::uint64_t flushed_ = 0;
+    bool stop_ = false;
+
+    // Used only by the writer thread
+    std::uint64_t reportedDrops_ = 0;
+
+    std::thread thread_;
+
+    static std::uint64_t
+    nextId()
+    {
+        static std::atomic<std::uint64_t> id{0};
+        return ++id;
+    }
+
+    // The ring of the calling thread, created on first use
+    Ring&
+    ring()
+    {
+        struct Entry
+        {
+            std::uint64_t writer;
+            std::shared_ptr<Ring> ring;
+        };
+        thread_local std::vector<Entry> cache;
+
+        for (auto const& entry : cache)
+        {
+            if (entry.writer == id_)
+                return *entry.ring;
+        }
+
+        cache.erase(
+            std::remove_if(
+                cache.begin(),
+                cache.end(),
+                [](Entry const& entry) { return entry.ring->closed.load(); }),
+            cache.end());
+
+        auto ring = std::make_shared<Ring>(capacity_);
+        {
+            std::lock_guard lock(mutex_);
+            rings_.push_back(ring);
+        }
+        cache.push_back({id_, ring});
+        return *ring;
+    }
+
+    std::uint64_t
+    totalDrops() const
+    {
+        std::uint64_t total = retiredDrops_;
+        for (auto const& ring : rings_)
+            total += ring->dropped.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void
+    run()
+    {
+        beast::setCurrentThreadName("log writer");
+
+        std::vector<std::shared_ptr<Ring>> active;
+        std::string batch;
+        std::string line;
+
+        auto const emit = [&]() {
+            if (!batch.empty())
+            {
+                logs_.writeFormatted(batch);
+                batch.clear();
+            }
+        };
+
+        std::unique_lock lock(mutex_);
+        for (;;)
+        {
+            auto const request = flushRequested_;
+            auto const stopping = stop_;
+            active = rings_;
+            lock.unlock();
+
+            for (auto const& ring : active)
+            {
+                ring->drain([&](Record& r) {
+                    format(line, r.text, r.level, r.partition, r.when);
+                    batch += line;
+                    batch += '\n';
+                    if (batch.size() >= batchBytes)
+                        emit();
+                });
+            }
+            emit();
+            active.clear();
+
+            lock.lock();
+
+            // Forget the rings of threads that have exited
+            rings_.erase(
+                std::remove_if(
+                    rings_.begin(),
+                    rings_.end(),
+                    [this](std::shared_ptr<Ring> const& ring) {
+                        if (ring.use_count() != 1 || !ring->empty())
+                            return false;
+                        retiredDrops_ += ring->dropped.load();
+                        return true;
+                    }),
+                rings_.end());
+
+            if (auto const drops = totalDrops(); drops != reportedDrops_)
+            {
+                format(
+                    line,
+                    std::to_string(drops - reportedDrops_) +
+                        " messages were dropped because a log queue was full",
+                    beast::severities::kWarning,
+                    "Logs");
+                reportedDrops_ = drops;
+                lock.unlock();
+                logs_.writeFormatted(line + '\n');
+                lock.lock();
+            }
+
+            flushed_ = request;
+            done_.notify_all();
+
+            if (stopping)
+                break;
+            if (flushRequested_ == flushed_ && !stop_)
+                wake_.wait_for(lock, std::chrono::milliseconds(10));
+        }
+
+        for (auto const& ring : rings_)
+            ring->closed = true;
+    }
+
+public:
+    AsyncWriter(Logs& logs, std::size_t capacity, Overflow overflow)
+        : logs_(logs)
+        , capacity_(capacity)
+        , overflow_(overflow)
+        , id_(nextId())
+        , thread_(&AsyncWriter::run, this)
+    {
+    }
+
+    AsyncWriter(AsyncWriter const&) = delete;
+    AsyncWriter&
+    operator=(AsyncWriter const&) = delete;
+
+    ~AsyncWriter()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    void
+    write(
+        beast::severities::Severity level,
+        std::string const& partition,
+        std::string const& text)
+    {
+        using namespace beast::severities;
+
+        auto& r = ring();
+        auto const when = std::chrono::system_clock::now();
+        while (!r.push(when, level, partition, text))
+        {
+            // A fatal message is never discarded
+            if (overflow_ == Overflow::drop && level < kFatal)
+            {
+                r.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            wake_.notify_one();
+            std::this_thread::yield();
+        }
+
+        // The process may be about to end
+        if (level >= kFatal)
+            flush();
+        else if (r.halfFull())
+            wake_.notify_one();
+    }
+
+    void
+    flush()
+    {
+        std::unique_lock lock(mutex_);
+        auto const request = ++flushRequested_;
+        wake_.notify_one();
+        done_.wait(lock, [&] { return flushed_ >= request; });
+    }
+
+    std::uint64_t
+    dropped() const
+    {
+        std::lock_guard lock(mutex_);
+        return totalDrops();
+    }
+};
+
 //------------------------------------------------------------------------------
 
 Logs::Logs(beast::severities::Severity thresh)
@@ -120,12 +452,46 @@ Logs::Logs(beast::severities::Severity thresh)
 {
 }
 
+Logs::~Logs()
+{
+    // Write out everything still queued while the file is open
+    async_.reset();
+}
+
 bool
 Logs::open(boost::filesystem::path const& pathToLogFile)
 {
     return file_.open(pathToLogFile);
 }
 
+void
+Logs::startAsync(std::size_t capacity, Overflow overflow)
+{
+    if (async_)
+        LogicError("Logs::startAsync : already started");
+
+    // The ring index is masked, so the capacity must be a power of two
+    std::size_t size = 2;
+    while (size < capacity)
+        size *= 2;
+    async_ = std::make_unique<AsyncWriter>(*this, size, overflow);
+}
+
+void
+Logs::flush()
+{
+    if (async_)
+        async_->flush();
+}
+
+std::uint64_t
+Logs::dropped() const
+{
+    if (async_)
+        return async_->dropped();
+    return 0;
+}
+
 beast::Journal::Sink&
 Logs::get(std::string const& name)
 {
@@ -179,6 +545,9 @@ Logs::write(
     std::string const& text,
     bool console)
 {
+    if (async_)
+        return async_->write(level, partition, text);
+
     std::string s;
     format(s, text, level, partition);
     std::lock_guard lock(mutex_);
@@ -190,6 +559,16 @@ Logs::write(
     //    out_.write_console(s);
 }
 
+void
+Logs::writeFormatted(std::string const& s)
+{
+    std::lock_guard lock(mutex_);
+    file_.write(s);
+    file_.flush();
+    if (!silent_)
+        std::cerr << s;
+}
+
 std::string
 Logs::rotate()
 {
@@ -312,11 +691,12 @@ Logs::format(
     std::string& output,
     std::string const& message,
     beast::severities::Severity severity,
-    std::string const& partition)
+    std::string const& partition,
+    std::chrono::system_clock::time_point when)
 {
     output.reserve(message.size() + partition.size() + 100);
 
-    output = to_string(std::chrono::system_clock::now());
+    output = to_string(when);
 
     output += " ";
     if (!partition.empty())
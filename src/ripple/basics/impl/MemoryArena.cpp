@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/MemoryArena.h>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+#if PROFILE_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#include <sys/mman.h>
+#elif RIPPLE_MIMALLOC
+#include <mimalloc.h>
+#endif
+
+namespace ripple {
+
+namespace {
+
+struct alignas(64) Counters
+{
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> total{0};
+};
+
+std::array<Counters, memoryArenaCount> counters;
+
+Counters&
+countersFor(MemoryArena arena)
+{
+    return counters[static_cast<std::size_t>(arena)];
+}
+
+#if PROFILE_JEMALLOC
+
+// The jemalloc arena behind each of ours, made on first use. Never
+// destroyed, since memory may be released during program termination.
+struct JemallocArenas
+{
+    std::array<unsigned, memoryArenaCount> index;
+    bool valid = true;
+
+    JemallocArenas()
+    {
+        for (auto& i : index)
+        {
+            std::size_t size = sizeof(i);
+            if (mallctl("arenas.create", &i, &size, nullptr, 0) != 0)
+                valid = false;
+        }
+    }
+};
+
+JemallocArenas&
+jemallocArenas()
+{
+    static JemallocArenas* const arenas = new JemallocArenas;
+    return *arenas;
+}
+
+// A cache for regions of an explicit arena is only ever used with that
+// arena, so each thread keeps one per arena.
+constexpr int noCache = -1;
+constexpr int deadCache = -2;
+
+thread_local std::array<int, memoryArenaCount> threadCaches = [] {
+    std::array<int, memoryArenaCount> a;
+    a.fill(noCache);
+    return a;
+}();
+
+struct ThreadCacheReaper
+{
+    ~ThreadCacheReaper()
+    {
+        for (auto& id : threadCaches)
+        {
+            if (id >= 0)
+            {
+                unsigned u = id;
+                mallctl("tcache.destroy", nullptr, nullptr, &u, sizeof(u));
+            }
+            id = deadCache;
+        }
+    }
+};
+
+thread_local ThreadCacheReaper reaper;
+
+int
+flagsFor(MemoryArena arena)
+{
+    auto& id = threadCaches[static_cast<std::size_t>(arena)];
+    if (id == noCache)
+    {
+        (void)&reaper;
+        unsigned u;
+        std::size_t size = sizeof(u);
+        id = mallctl("tcache.create", &u, &size, nullptr, 0) == 0
+            ? static_cast<int>(u)
+            : deadCache;
+    }
+    return id >= 0 ? MALLOCX_TCACHE(id) : MALLOCX_TCACHE_NONE;
+}
+
+extent_hooks_t* defaultHooks = nullptr;
+extent_hooks_t hugePageHooks;
+
+void*
+hugePageAlloc(
+    extent_hooks_t*,
+    void* address,
+    std::size_t size,
+    std::size_t alignment,
+    bool* zero,
+    bool* commit,
+    unsigned index)
+{
+    auto p = defaultHooks->alloc(
+        defaultHooks, address, size, alignment, zero, commit, index);
+    if (p)
+        madvise(p, size, MADV_HUGEPAGE);
+    return p;
+}
+
+std::string
+arenaKey(unsigned index, char const* name)
+{
+    return "arena." + std::to_string(index) + "." + name;
+}
+
+#endif
+
+}  // namespace
+
+char const*
+to_string(MemoryArena arena)
+{
+    switch (arena)
+    {
+        case MemoryArena::shamap:
+            return "shamap";
+        case MemoryArena::nodeObject:
+            return "node_object";
+        case MemoryArena::json:
+            return "json";
+        case MemoryArena::stobject:
+            return "stobject";
+        case MemoryArena::overlay:
+            return "overlay";
+    }
+    return "unknown";
+}
+
+char const*
+allocatorName()
+{
+#if PROFILE_JEMALLOC
+    return "jemalloc";
+#elif RIPPLE_MIMALLOC
+    return "mimalloc";
+#else
+    return "system";
+#endif
+}
+
+void*
+arenaAllocate(MemoryArena arena, std::size_t bytes)
+{
+    void* p = nullptr;
+#if PROFILE_JEMALLOC
+    auto& arenas = jemallocArenas();
+    if (arenas.valid && bytes != 0)
+        p = mallocx(
+            bytes,
+            MALLOCX_ARENA(arenas.index[static_cast<std::size_t>(arena)]) |
+                flagsFor(arena));
+    else
+        p = std::malloc(bytes);
+#elif RIPPLE_MIMALLOC
+    p = mi_malloc(bytes);
+#else
+    p = std::malloc(bytes);
+#endif
+    if (!p)
+        throw std::bad_alloc();
+
+    auto& c = countersFor(arena);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.total.fetch_add(1, std::memory_order_relaxed);
+    return p;
+}
+
+void
+arenaDeallocate(MemoryArena arena, void* p, std::size_t bytes) noexcept
+{
+    if (!p)
+        return;
+
+    auto& c = countersFor(arena);
+    c.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    c.allocations.fetch_sub(1, std::memory_order_relaxed);
+
+#if PROFILE_JEMALLOC
+    if (jemallocArenas().valid && bytes != 0)
+        sdallocx(p, bytes, flagsFor(arena));
+    else
+        std::free(p);
+#elif RIPPLE_MIMALLOC
+    mi_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+MemoryArenaStats
+getMemoryArenaStats(MemoryArena arena)
+{
+    auto const& c = countersFor(arena);
+    MemoryArenaStats s;
+    s.bytes = c.bytes.load(std::memory_order_relaxed);
+    s.allocations = c.allocations.load(std::memory_order_relaxed);
+    s.total = c.total.load(std::memory_order_relaxed);
+
+#if PROFILE_JEMALLOC
+    auto& arenas = jemallocArenas();
+    if (arenas.valid)
+    {
+        // Statistics are only refreshed when the epoch advances
+        std::uint64_t epoch = 1;
+        std::size_t size = sizeof(epoch);
+        mallctl("epoch", &epoch, &size, &epoch, size);
+
+        auto const key = "stats.arenas." +
+            std::to_string(arenas.index[static_cast<std::size_t>(arena)]) +
+            ".resident";
+        std::size_t resident = 0;
+        size = sizeof(resident);
+        if (mallctl(key.c_str(), &resident, &size, nullptr, 0) == 0)
+            s.resident = resident;
+    }
+#endif
+    return s;
+}
+
+bool
+enableArenaHugePages()
+{
+#if PROFILE_JEMALLOC && defined(MADV_HUGEPAGE)
+    auto& arenas = jemallocArenas();
+    if (!arenas.valid)
+        return false;
+
+    for (auto const arena : {MemoryArena::shamap, MemoryArena::nodeObject})
+    {
+        auto const index = arenas.index[static_cast<std::size_t>(arena)];
+        auto const key = arenaKey(index, "extent_hooks");
+        if (!defaultHooks)
+        {
+            std::size_t size = sizeof(defaultHooks);
+            if (mallctl(key.c_str(), &defaultHooks, &size, nullptr, 0) != 0 ||
+                !defaultHooks)
+                return false;
+            hugePageHooks = *defaultHooks;
+            hugePageHooks.alloc = hugePageAlloc;
+        }
+
+        extent_hooks_t* hooks = &hugePageHooks;
+        if (mallctl(key.c_str(), nullptr, nullptr, &hooks, sizeof(hooks)) != 0)
+            return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace ripple
@@ -0,0 +1,224 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Numa.h>
+#include <boost/predef.h>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if BOOST_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ripple {
+namespace numa {
+
+namespace {
+
+std::atomic<bool> enabled_{false};
+
+// Parses a sysfs CPU list such as "0-7,16-23"
+std::vector<int>
+parseCpuList(std::string const& list)
+{
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ','))
+    {
+        auto const dash = range.find('-');
+        try
+        {
+            auto const first = std::stoi(range.substr(0, dash));
+            auto const last = dash == std::string::npos
+                ? first
+                : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        catch (std::exception const&)
+        {
+        }
+    }
+    return cpus;
+}
+
+std::string
+nodePath(std::size_t node, char const* file)
+{
+    return "/sys/devices/system/node/node" + std::to_string(node) + "/" +
+        file;
+}
+
+std::vector<std::vector<int>>
+readNodes()
+{
+    std::vector<std::vector<int>> result;
+#if BOOST_OS_LINUX
+    for (std::size_t node = 0;; ++node)
+    {
+        std::ifstream in(nodePath(node, "cpulist"));
+        std::string list;
+        if (!std::getline(in, list))
+            break;
+        result.push_back(parseCpuList(list));
+    }
+#endif
+    if (result.empty())
+        result.emplace_back();
+    return result;
+}
+
+// The node of each CPU
+std::vector<int> const&
+cpuNodes()
+{
+    static std::vector<int> const result = [] {
+        std::vector<int> r;
+        auto const& n = nodes();
+        for (std::size_t node = 0; node < n.size(); ++node)
+        {
+            for (auto const cpu : n[node])
+            {
+                if (cpu >= static_cast<int>(r.size()))
+                    r.resize(cpu + 1, -1);
+                r[cpu] = static_cast<int>(node);
+            }
+        }
+        return r;
+    }();
+    return result;
+}
+
+#if BOOST_OS_LINUX
+void
+pin(pthread_t thread, std::size_t index)
+{
+    if (!enabled())
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto const cpu : nodes()[index % nodeCount()])
+        CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+#endif
+
+}  // namespace
+
+std::vector<std::vector<int>> const&
+nodes()
+{
+    static std::vector<std::vector<int>> const result = readNodes();
+    return result;
+}
+
+std::size_t
+nodeCount()
+{
+    return nodes().size();
+}
+
+bool
+enabled()
+{
+    return enabled_.load(std::memory_order_relaxed);
+}
+
+void
+setEnabled(bool enable)
+{
+    enabled_ = enable && nodeCount() > 1;
+}
+
+void
+pinCurrentThread(std::size_t index)
+{
+#if BOOST_OS_LINUX
+    pin(pthread_self(), index);
+#endif
+}
+
+int
+currentNode()
+{
+#if BOOST_OS_LINUX
+    auto const cpu = sched_getcpu();
+    auto const& n = cpuNodes();
+    if (cpu >= 0 && cpu < static_cast<int>(n.size()))
+        return n[cpu];
+#endif
+    return -1;
+}
+
+void
+runOnNode(std::size_t node, std::function<void()> const& f)
+{
+    if (!enabled())
+    {
+        f();
+        return;
+    }
+
+    std::thread t([&] {
+        pinCurrentThread(node);
+        f();
+    });
+    t.join();
+}
+
+Json::Value
+getJson()
+{
+    Json::Value ret(Json::objectValue);
+    ret["enabled"] = enabled();
+
+    std::uint64_t local = 0;
+    std::uint64_t other = 0;
+    Json::Value& out = (ret["nodes"] = Json::arrayValue);
+    for (std::size_t node = 0; node < nodeCount(); ++node)
+    {
+        Json::Value& jv = out.append(Json::objectValue);
+        jv["cpus"] = static_cast<Json::UInt>(nodes()[node].size());
+
+        std::ifstream in(nodePath(node, "numastat"));
+        std::string name;
+        std::uint64_t value;
+        while (in >> name >> value)
+        {
+            jv[name] = std::to_string(value);
+            if (name == "local_node")
+                local += value;
+            else if (name == "other_node")
+                other += value;
+        }
+    }
+    if (local + other != 0)
+        ret["remote_percent"] = 100.0 * other / (local + other);
+    return ret;
+}
+
+}  // namespace numa
+}  // namespace ripple
@@ -25,6 +25,7 @@
 #include <ripple/json/json_writer.h>
 #include <ripple/json/to_string.h>
 #include <boost/optional.hpp>
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <cstdlib>
@@ -49,7 +50,8 @@ PerfLogImp::Counters::Counters(
         rpc_.reserve(labels.size());
         for (std::string const label : labels)
         {
-            auto const inserted = rpc_.emplace(label, Rpc()).second;
+            auto const inserted =
+                rpc_.emplace(label, std::make_unique<RpcShards>()).second;
             if (!inserted)
             {
                 // Ensure that no other function populates this entry.
@@ -62,7 +64,8 @@ PerfLogImp::Counters::Counters(
         jq_.reserve(jobTypes.size());
         for (auto const& [jobType, _] : jobTypes)
         {
-            auto const inserted = jq_.emplace(jobType, Jq()).second;
+            auto const inserted =
+                jq_.emplace(jobType, std::make_unique<JqShards>()).second;
             if (!inserted)
             {
                 // Ensure that no other function populates this entry.
@@ -72,6 +75,74 @@ PerfLogImp::Counters::Counters(
     }
 }
 
+std::size_t
+PerfLogImp::Counters::shard()
+{
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t const index =
+        next.fetch_add(1, std::memory_order_relaxed) % shards;
+    return index;
+}
+
+void
+PerfLogImp::Counters::record(AtomicBuckets& buckets, microseconds dur)
+{
+    auto const i = std::lower_bound(
+                       bounds.begin(),
+                       bounds.end(),
+                       static_cast<std::uint64_t>(
+                           std::max<microseconds::rep>(dur.count(), 0)))
+        - bounds.begin();
+    buckets[i].fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class Atomic>
+static std::uint64_t
+load(Atomic const& a)
+{
+    return a.load(std::memory_order_relaxed);
+}
+
+template <class Buckets, class AtomicBuckets>
+static void
+add(Buckets& to, AtomicBuckets const& from)
+{
+    for (std::size_t i = 0; i < to.size(); ++i)
+        to[i] += load(from[i]);
+}
+
+PerfLogImp::Counters::Rpc
+PerfLogImp::Counters::sum(RpcShards const& shards)
+{
+    Rpc value;
+    for (auto const& s : shards)
+    {
+        value.started += load(s.started);
+        value.finished += load(s.finished);
+        value.errored += load(s.errored);
+        value.duration += microseconds(load(s.duration));
+        add(value.durations, s.durations);
+    }
+    return value;
+}
+
+PerfLogImp::Counters::Jq
+PerfLogImp::Counters::sum(JqShards const& shards)
+{
+    Jq value;
+    for (auto const& s : shards)
+    {
+        value.queued += load(s.queued);
+        value.started += load(s.started);
+        value.finished += load(s.finished);
+        value.queuedDuration += microseconds(load(s.queuedDuration));
+        value.runningDuration += microseconds(load(s.runningDuration));
+        add(value.queuedDurations, s.queuedDurations);
+        add(value.runningDurations, s.runningDurations);
+    }
+    return value;
+}
+
 Json::Value
 PerfLogImp::Counters::countersJson() const
 {
@@ -80,16 +151,9 @@ PerfLogImp::Counters::countersJson() const
     Rpc totalRpc;
     for (auto const& proc : rpc_)
     {
-        Rpc value;
-        {
-            std::lock_guard lock(proc.second.mutex);
-            if (!proc.second.value.started && !proc.second.value.finished &&
-                !proc.second.value.errored)
-            {
-                continue;
-            }
-            value = proc.second.value;
-        }
+        Rpc const value = sum(*proc.second);
+        if (!value.started && !value.finished && !value.errored)
+            continue;
 
         Json::Value p(Json::objectValue);
         p[jss::started] = std::to_string(value.started);
@@ -119,16 +183,9 @@ PerfLogImp::Counters::countersJson() const
     Jq totalJq;
     for (auto const& proc : jq_)
     {
-        Jq value;
-        {
-            std::lock_guard lock(proc.second.mutex);
-            if (!proc.second.value.queued && !proc.second.value.started &&
-                !proc.second.value.finished)
-            {
-                continue;
-            }
-            value = proc.second.value;
-        }
+        Jq const value = sum(*proc.second);
+        if (!value.queued && !value.started && !value.finished)
+            continue;
 
         Json::Value j(Json::objectValue);
         j[jss::queued] = std::to_string(value.queued);
@@ -214,6 +271,152 @@ PerfLogImp::Counters::currentJson() const
     return current;
 }
 
+namespace {
+
+// Formats metric families in the Prometheus text exposition format.
+class PrometheusWriter
+{
+    std::ostringstream out_;
+
+    static std::string
+    seconds(std::uint64_t us)
+    {
+        std::ostringstream s;
+        s << static_cast<double>(us) / 1'000'000;
+        return s.str();
+    }
+
+public:
+    void
+    family(char const* name, char const* type, char const* help)
+    {
+        out_ << "# HELP " << name << ' ' << help << '\n'
+             << "# TYPE " << name << ' ' << type << '\n';
+    }
+
+    void
+    sample(
+        char const* name,
+        std::string const& labels,
+        std::uint64_t value)
+    {
+        out_ << name << '{' << labels << "} " << value << '\n';
+    }
+
+    template <class Bounds, class Buckets>
+    void
+    histogram(
+        char const* name,
+        std::string const& labels,
+        Bounds const& bounds,
+        Buckets const& buckets,
+        PerfLog::microseconds sum)
+    {
+        std::uint64_t count = 0;
+        for (std::size_t i = 0; i < buckets.size(); ++i)
+        {
+            count += buckets[i];
+            out_ << name << "_bucket{" << labels << ",le=\""
+                 << (i < bounds.size() ? seconds(bounds[i]) : "+Inf")
+                 << "\"} " << count << '\n';
+        }
+        out_ << name << "_sum{" << labels << "} " << seconds(sum.count())
+             << '\n'
+             << name << "_count{" << labels << "} " << count << '\n';
+    }
+
+    std::string
+    str() const
+    {
+        return out_.str();
+    }
+};
+
+}  // namespace
+
+std::string
+PerfLogImp::Counters::prometheus() const
+{
+    std::vector<std::pair<std::string, Rpc>> rpc;
+    for (auto const& proc : rpc_)
+    {
+        Rpc value = sum(*proc.second);
+        if (value.started || value.finished || value.errored)
+            rpc.emplace_back("method=\"" + proc.first + "\"", value);
+    }
+
+    std::vector<std::pair<std::string, Jq>> jq;
+    for (auto const& proc : jq_)
+    {
+        Jq value = sum(*proc.second);
+        if (value.queued || value.started || value.finished)
+            jq.emplace_back(
+                "job=\"" + JobTypes::name(proc.first) + "\"", value);
+    }
+
+    PrometheusWriter w;
+
+    w.family(
+        "rippled_rpc_started_total", "counter", "RPC method calls started.");
+    for (auto const& [labels, value] : rpc)
+        w.sample("rippled_rpc_started_total", labels, value.started);
+    w.family(
+        "rippled_rpc_finished_total",
+        "counter",
+        "RPC method calls finished successfully.");
+    for (auto const& [labels, value] : rpc)
+        w.sample("rippled_rpc_finished_total", labels, value.finished);
+    w.family(
+        "rippled_rpc_errored_total",
+        "counter",
+        "RPC method calls ended by an exception.");
+    for (auto const& [labels, value] : rpc)
+        w.sample("rippled_rpc_errored_total", labels, value.errored);
+    w.family(
+        "rippled_rpc_duration_seconds",
+        "histogram",
+        "Durations of finished and errored RPC method calls.");
+    for (auto const& [labels, value] : rpc)
+        w.histogram(
+            "rippled_rpc_duration_seconds",
+            labels,
+            bounds,
+            value.durations,
+            value.duration);
+
+    w.family("rippled_job_queued_total", "counter", "Jobs queued.");
+    for (auto const& [labels, value] : jq)
+        w.sample("rippled_job_queued_total", labels, value.queued);
+    w.family("rippled_job_started_total", "counter", "Jobs started.");
+    for (auto const& [labels, value] : jq)
+        w.sample("rippled_job_started_total", labels, value.started);
+    w.family("rippled_job_finished_total", "counter", "Jobs finished.");
+    for (auto const& [labels, value] : jq)
+        w.sample("rippled_job_finished_total", labels, value.finished);
+    w.family(
+        "rippled_job_queued_seconds",
+        "histogram",
+        "Time jobs waited in the queue before running.");
+    for (auto const& [labels, value] : jq)
+        w.histogram(
+            "rippled_job_queued_seconds",
+            labels,
+            bounds,
+            value.queuedDurations,
+            value.queuedDuration);
+    w.family(
+        "rippled_job_running_seconds", "histogram", "Time jobs spent running.");
+    for (auto const& [labels, value] : jq)
+        w.histogram(
+            "rippled_job_running_seconds",
+            labels,
+            bounds,
+            value.runningDurations,
+            value.runningDuration);
+
+    return w.str();
+}
+
 //-----------------------------------------------------------------------------
 
 void
@@ -329,10 +532,8 @@ PerfLogImp::rpcStart(std::string const& method, std::uint64_t const requestId)
         return;
     }
 
-    {
-        std::lock_guard lock(counter->second.mutex);
-        ++counter->second.value.started;
-    }
+    (*counter->second)[Counters::shard()].started.fetch_add(
+        1, std::memory_order_relaxed);
     std::lock_guard lock(counters_.methodsMutex_);
     counters_.methods_[requestId] = {
         counter->first.c_str(), steady_clock::now()};
@@ -364,13 +565,15 @@ PerfLogImp::rpcEnd(
             assert(false);
         }
     }
-    std::lock_guard lock(counter->second.mutex);
+    auto const dur = std::chrono::duration_cast<microseconds>(
+        steady_clock::now() - startTime);
+    auto& shard = (*counter->second)[Counters::shard()];
     if (finish)
-        ++counter->second.value.finished;
+        shard.finished.fetch_add(1, std::memory_order_relaxed);
     else
-        ++counter->second.value.errored;
-    counter->second.value.duration += std::chrono::duration_cast<microseconds>(
-        steady_clock::now() - startTime);
+        shard.errored.fetch_add(1, std::memory_order_relaxed);
+    shard.duration.fetch_add(dur.count(), std::memory_order_relaxed);
+    Counters::record(shard.durations, dur);
 }
 
 void
@@ -382,8 +585,8 @@ PerfLogImp::jobQueue(JobType const type)
         assert(false);
         return;
     }
-    std::lock_guard lock(counter->second.mutex);
-    ++counter->second.value.queued;
+    (*counter->second)[Counters::shard()].queued.fetch_add(
+        1, std::memory_order_relaxed);
 }
 
 void
@@ -400,9 +603,11 @@ PerfLogImp::jobStart(
         return;
     }
     {
-        std::lock_guard lock(counter->second.mutex);
-        ++counter->second.value.started;
-        counter->second.value.queuedDuration += dur;
+        auto& shard = (*counter->second)[Counters::shard()];
+        shard.started.fetch_add(1, std::memory_order_relaxed);
+        shard.queuedDuration.fetch_add(
+            dur.count(), std::memory_order_relaxed);
+        Counters::record(shard.queuedDurations, dur);
     }
     std::lock_guard lock(counters_.jobsMutex_);
     if (instance >= 0 && instance < counters_.jobs_.size())
@@ -419,9 +624,11 @@ PerfLogImp::jobFinish(JobType const type, microseconds dur, int instance)
         return;
     }
     {
-        std::lock_guard lock(counter->second.mutex);
-        ++counter->second.value.finished;
-        counter->second.value.runningDuration += dur;
+        auto& shard = (*counter->second)[Counters::shard()];
+        shard.finished.fetch_add(1, std::memory_order_relaxed);
+        shard.runningDuration.fetch_add(
+            dur.count(), std::memory_order_relaxed);
+        Counters::record(shard.runningDurations, dur);
     }
     std::lock_guard lock(counters_.jobsMutex_);
     if (instance >= 0 && instance < counters_.jobs_.size())
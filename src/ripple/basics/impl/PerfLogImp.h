@@ -27,6 +27,8 @@
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/impl/Handler.h>
 #include <boost/asio/ip/host_name.hpp>
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <fstream>
@@ -42,28 +44,6 @@
 namespace ripple {
 namespace perf {
 
-/** A box coupling data with a mutex for locking access to it. */
-template <typename T>
-struct Locked
-{
-    T value;
-    mutable std::mutex mutex;
-
-    Locked() = default;
-    Locked(T const& value) : value(value)
-    {
-    }
-    Locked(T&& value) : value(std::move(value))
-    {
-    }
-    Locked(Locked const& rhs) : value(rhs.value)
-    {
-    }
-    Locked(Locked&& rhs) : value(std::move(rhs.value))
-    {
-    }
-};
-
 /**
  * Implementation class for PerfLog.
  */
@@ -76,6 +56,31 @@ class PerfLogImp : public PerfLog, Stoppable
     {
     public:
         using MethodStart = std::pair<char const*, steady_time_point>;
+
+        // Each thread adds to one shard of a counter, so that threads
+        // writing the same counter rarely share a cache line.
+        static constexpr std::size_t shards = 8;
+
+        // Upper bounds of the duration histogram buckets in microseconds.
+        // A final bucket counts everything slower.
+        static constexpr std::array<std::uint64_t, 12> bounds{
+            100,
+            250,
+            1'000,
+            2'500,
+            10'000,
+            25'000,
+            100'000,
+            250'000,
+            1'000'000,
+            2'500'000,
+            10'000'000,
+            25'000'000};
+
+        using Buckets = std::array<std::uint64_t, bounds.size() + 1>;
+        using AtomicBuckets =
+            std::array<std::atomic<std::uint64_t>, bounds.size() + 1>;
+
         /**
          * RPC performance counters.
          */
@@ -88,6 +93,8 @@ class PerfLogImp : public PerfLog, Stoppable
             std::uint64_t errored{0};
             // Cumulative duration of all finished and errored method calls.
             microseconds duration{0};
+            // Durations of finished and errored method calls.
+            Buckets durations{};
         };
 
         /**
@@ -103,12 +110,39 @@ class PerfLogImp : public PerfLog, Stoppable
             // Cumulative duration of all jobs' queued and running times.
             microseconds queuedDuration{0};
             microseconds runningDuration{0};
+            // Queued and running times of each job.
+            Buckets queuedDurations{};
+            Buckets runningDurations{};
+        };
+
+        struct alignas(64) RpcShard
+        {
+            std::atomic<std::uint64_t> started{0};
+            std::atomic<std::uint64_t> finished{0};
+            std::atomic<std::uint64_t> errored{0};
+            std::atomic<std::uint64_t> duration{0};
+            AtomicBuckets durations{};
         };
 
+        struct alignas(64) JqShard
+        {
+            std::atomic<std::uint64_t> queued{0};
+            std::atomic<std::uint64_t> started{0};
+            std::atomic<std::uint64_t> finished{0};
+            std::atomic<std::uint64_t> queuedDuration{0};
+            std::atomic<std::uint64_t> runningDuration{0};
+            AtomicBuckets queuedDurations{};
+            AtomicBuckets runningDurations{};
+        };
+
+        using RpcShards = std::array<RpcShard, shards>;
+        using JqShards = std::array<JqShard, shards>;
+
         // rpc_ and jq_ do not need mutex protection because all
         // keys and values are created before more threads are started.
-        std::unordered_map<std::string, Locked<Rpc>> rpc_;
-        std::unordered_map<JobType, Locked<Jq>> jq_;
+        // The shards are only updated with relaxed atomic operations.
+        std::unordered_map<std::string, std::unique_ptr<RpcShards>> rpc_;
+        std::unordered_map<JobType, std::unique_ptr<JqShards>> jq_;
         std::vector<std::pair<JobType, steady_time_point>> jobs_;
         mutable std::mutex jobsMutex_;
         std::unordered_map<std::uint64_t, MethodStart> methods_;
@@ -117,10 +151,27 @@ class PerfLogImp : public PerfLog, Stoppable
         Counters(
             std::vector<char const*> const& labels,
             JobTypes const& jobTypes);
+
+        // The shard of every counter that the calling thread updates.
+        static std::size_t
+        shard();
+
+        // Adds a duration to its histogram bucket.
+        static void
+        record(AtomicBuckets& buckets, microseconds dur);
+
+        // Sum the shards of a counter.
+        static Rpc
+        sum(RpcShards const& shards);
+        static Jq
+        sum(JqShards const& shards);
+
         Json::Value
         countersJson() const;
         Json::Value
         currentJson() const;
+        std::string
+        prometheus() const;
     };
 
     Setup const setup_;
@@ -195,6 +246,12 @@ public:
         return counters_.currentJson();
     }
 
+    std::string
+    prometheus() const override
+    {
+        return counters_.prometheus();
+    }
+
     void
     resizeJobs(int const resize) override;
     void
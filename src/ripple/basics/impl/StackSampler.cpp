@@ -0,0 +1,293 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StackSampler.h>
+#include <boost/core/demangle.hpp>
+#include <boost/predef.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if BOOST_OS_LINUX
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <dirent.h>
+#include <execinfo.h>
+#include <fstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ripple {
+namespace perf {
+
+#if BOOST_OS_LINUX
+
+namespace {
+
+constexpr int maxFrames = 64;
+// The signal handler and the signal trampoline
+constexpr int skipFrames = 2;
+
+// The steps of sampling one thread. Only one thread is sampled at a time,
+// and the sampler and the handler move the slot between the steps with
+// atomics, so a handler that runs after the sampler gave up on it does
+// not write into the next request.
+enum Step : int { idle, requested, writing, written };
+
+struct Slot
+{
+    std::atomic<int> step{idle};
+    std::atomic<pid_t> thread{0};
+    void* frames[maxFrames];
+    int depth = 0;
+};
+
+Slot slot;
+
+pid_t
+currentThread()
+{
+    return static_cast<pid_t>(::syscall(SYS_gettid));
+}
+
+extern "C" void
+onSampleSignal(int)
+{
+    auto const savedErrno = errno;
+    int expected = requested;
+    if (slot.thread.load() == currentThread() &&
+        slot.step.compare_exchange_strong(expected, writing))
+    {
+        slot.depth = ::backtrace(slot.frames, maxFrames);
+        slot.step.store(written);
+    }
+    errno = savedErrno;
+}
+
+// Nothing else in rippled uses the realtime signals
+int
+sampleSignal()
+{
+    return SIGRTMIN;
+}
+
+void
+installHandler()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        // The first call of backtrace loads libgcc, which is not safe
+        // to do in a signal handler
+        void* frames[1];
+        ::backtrace(frames, 1);
+
+        struct sigaction sa = {};
+        sa.sa_handler = &onSampleSignal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        ::sigaction(sampleSignal(), &sa, nullptr);
+    });
+}
+
+std::vector<pid_t>
+listThreads()
+{
+    std::vector<pid_t> threads;
+    if (DIR* dir = ::opendir("/proc/self/task"))
+    {
+        while (auto const entry = ::readdir(dir))
+        {
+            if (auto const id = std::atoi(entry->d_name); id > 0)
+                threads.push_back(id);
+        }
+        ::closedir(dir);
+    }
+    return threads;
+}
+
+std::string
+threadName(pid_t thread)
+{
+    std::ifstream comm("/proc/self/task/" + std::to_string(thread) + "/comm");
+    std::string name;
+    std::getline(comm, name);
+    return name;
+}
+
+// Returns false if the thread exited or did not answer in time
+bool
+sampleThread(pid_t thread, std::vector<void*>& frames)
+{
+    using namespace std::chrono;
+
+    slot.thread.store(thread);
+    slot.step.store(requested);
+    if (::syscall(SYS_tgkill, ::getpid(), thread, sampleSignal()) != 0)
+    {
+        slot.step.store(idle);
+        return false;
+    }
+
+    auto const deadline = steady_clock::now() + 100ms;
+    for (;;)
+    {
+        auto const step = slot.step.load();
+        if (step == written)
+            break;
+        if (step == requested && steady_clock::now() > deadline)
+        {
+            int expected = requested;
+            if (slot.step.compare_exchange_strong(expected, idle))
+                return false;
+        }
+        std::this_thread::sleep_for(50us);
+    }
+
+    if (slot.depth > skipFrames)
+        frames.assign(slot.frames + skipFrames, slot.frames + slot.depth);
+    else
+        frames.clear();
+    slot.step.store(idle);
+    return true;
+}
+
+// Turns "module(mangled+0x1f) [0x...]" into "module(demangled+0x1f) ..."
+std::string
+describe(void* frame)
+{
+    char** symbols = ::backtrace_symbols(&frame, 1);
+    if (!symbols)
+        return {};
+    std::string s = symbols[0];
+    std::free(symbols);
+
+    auto const open = s.find('(');
+    auto const plus = s.find('+', open);
+    if (open != std::string::npos && plus != std::string::npos &&
+        plus > open + 1)
+    {
+        auto const mangled = s.substr(open + 1, plus - open - 1);
+        s.replace(
+            open + 1, mangled.size(), boost::core::demangle(mangled.c_str()));
+    }
+    return s;
+}
+
+}  // namespace
+
+bool
+canSampleStacks()
+{
+    return true;
+}
+
+std::string
+sampleStacks(int samples, std::chrono::milliseconds interval)
+{
+    static std::mutex mutex;
+    std::lock_guard lock(mutex);
+
+    installHandler();
+
+    struct Thread
+    {
+        std::string name;
+        int answered = 0;
+        // Distinct stacks, with the number of samples each was seen in
+        std::vector<std::pair<std::vector<void*>, int>> stacks;
+    };
+
+    auto const self = currentThread();
+    std::map<pid_t, Thread> threads;
+    std::vector<void*> frames;
+
+    for (int i = 0; i < samples; ++i)
+    {
+        if (i != 0)
+            std::this_thread::sleep_for(interval);
+
+        for (auto const id : listThreads())
+        {
+            if (id == self)
+                continue;
+
+            auto& t = threads[id];
+            if (t.name.empty())
+                t.name = threadName(id);
+            if (!sampleThread(id, frames))
+                continue;
+
+            ++t.answered;
+            auto const iter = std::find_if(
+                t.stacks.begin(), t.stacks.end(), [&](auto const& s) {
+                    return s.first == frames;
+                });
+            if (iter != t.stacks.end())
+                ++iter->second;
+            else
+                t.stacks.emplace_back(frames, 1);
+        }
+    }
+
+    std::map<void*, std::string> names;
+    std::ostringstream out;
+    for (auto const& [id, t] : threads)
+    {
+        out << "Thread " << id << " \"" << t.name << "\", answered "
+            << t.answered << " of " << samples << " samples\n";
+        for (auto const& [stack, count] : t.stacks)
+        {
+            out << "  seen in " << count << " samples:\n";
+            for (std::size_t n = 0; n < stack.size(); ++n)
+            {
+                auto& name = names[stack[n]];
+                if (name.empty())
+                    name = describe(stack[n]);
+                out << "    #" << n << " " << name << "\n";
+            }
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+#else
+
+bool
+canSampleStacks()
+{
+    return false;
+}
+
+std::string
+sampleStacks(int, std::chrono::milliseconds)
+{
+    return "Stack sampling is not supported on this platform.\n";
+}
+
+#endif
+
+}  // namespace perf
+}  // namespace ripple
@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Tracer.h>
+#include <algorithm>
+
+namespace ripple {
+namespace perf {
+
+namespace {
+
+// A small number for each thread, in the order threads first record
+std::uint32_t
+threadNumber()
+{
+    static std::atomic<std::uint32_t> count{0};
+    thread_local std::uint32_t const number = ++count;
+    return number;
+}
+
+}  // namespace
+
+Tracer::Tracer(Setup const& setup)
+    : enabled_(setup.enabled)
+    , jobs_(setup.jobs)
+    , epoch_(clock_type::now())
+    , capacity_(std::max<std::size_t>(setup.capacity, 1))
+{
+}
+
+void
+Tracer::record(
+    char const* name,
+    char const* category,
+    clock_type::time_point start,
+    clock_type::time_point end,
+    std::uint32_t ledgerSeq)
+{
+    Event const e{
+        name, category, start, end - start, threadNumber(), ledgerSeq};
+
+    std::lock_guard lock(mutex_);
+    if (events_.size() < capacity_)
+    {
+        events_.push_back(e);
+        return;
+    }
+    events_[next_] = e;
+    next_ = (next_ + 1) % capacity_;
+}
+
+Json::Value
+Tracer::getJson(std::uint32_t minLedgerSeq) const
+{
+    using namespace std::chrono;
+
+    std::vector<Event> events;
+    {
+        std::lock_guard lock(mutex_);
+        events.reserve(events_.size());
+        events.insert(events.end(), events_.begin() + next_, events_.end());
+        events.insert(events.end(), events_.begin(), events_.begin() + next_);
+    }
+
+    Json::Value ret(Json::objectValue);
+    Json::Value& out = (ret["traceEvents"] = Json::arrayValue);
+    for (auto const& e : events)
+    {
+        if (minLedgerSeq != 0 && e.ledgerSeq != 0 && e.ledgerSeq < minLedgerSeq)
+            continue;
+
+        Json::Value& jv = out.append(Json::objectValue);
+        jv["name"] = e.name;
+        jv["cat"] = e.category;
+        jv["ph"] = "X";
+        // A double, so the timestamp does not wrap after 71 minutes
+        jv["ts"] = static_cast<double>(
+            duration_cast<microseconds>(e.start - epoch_).count());
+        jv["dur"] = static_cast<Json::UInt>(
+            duration_cast<microseconds>(e.duration).count());
+        jv["pid"] = 1;
+        jv["tid"] = e.thread;
+        if (e.ledgerSeq != 0)
+            jv["args"]["ledger_seq"] = e.ledgerSeq;
+    }
+    ret["displayTimeUnit"] = "ms";
+    return ret;
+}
+
+void
+Tracer::clear()
+{
+    std::lock_guard lock(mutex_);
+    events_.clear();
+    next_ = 0;
+}
+
+std::size_t
+Tracer::size() const
+{
+    std::lock_guard lock(mutex_);
+    return events_.size();
+}
+
+Tracer::Setup
+setup_Tracer(Section const& section)
+{
+    Tracer::Setup setup;
+    set(setup.enabled, "enable", section);
+    set(setup.capacity, "events", section);
+    set(setup.jobs, "jobs", section);
+    return setup;
+}
+
+}  // namespace perf
+}  // namespace ripple
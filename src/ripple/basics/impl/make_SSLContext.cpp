@@ -194,6 +194,42 @@ ssl_ctx_use_privatekey(SSL_CTX* const ctx, evp_pkey_ptr key)
         LogicError("SSL_CTX_use_PrivateKey failed");
 }
 
+// What a client connection prepared by SSLSessionCache carries along
+struct SessionTarget
+{
+    std::weak_ptr<SSLSessionCache> cache;
+    std::string key;
+};
+
+static void
+freeSessionTarget(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*)
+{
+    delete static_cast<SessionTarget*>(ptr);
+}
+
+static int
+sessionTargetIndex()
+{
+    static int const index =
+        SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeSessionTarget);
+    return index;
+}
+
+// Returns 0 since the cache keeps a copy, not the reference
+static int
+onNewSession(SSL* ssl, SSL_SESSION* session)
+{
+    auto const target =
+        static_cast<SessionTarget*>(SSL_get_ex_data(ssl, sessionTargetIndex()));
+    if (!target)
+        return 0;
+    auto const cache = target->cache.lock();
+    if (!cache)
+        return 0;
+    cache->insert(target->key, session);
+    return 0;
+}
+
 #ifdef SSL_FLAGS_NO_RENEGOTIATE_CIPHERS
 static bool
 disallowRenegotiation(SSL const* ssl, bool isNew)
@@ -439,12 +475,81 @@ get_context(std::string const& cipherList)
     SSL_CTX_set_info_callback(c->native_handle(), info_handler);
 #endif
 
+    // Servers keep sessions internally and issue tickets, as OpenSSL does
+    // by default. Clients hand theirs to an SSLSessionCache, if any.
+    SSL_CTX_set_session_cache_mode(c->native_handle(), SSL_SESS_CACHE_BOTH);
+    SSL_CTX_sess_set_new_cb(c->native_handle(), onNewSession);
+
     return c;
 }
 
 }  // namespace detail
 }  // namespace openssl
 
+//------------------------------------------------------------------------------
+SSLSessionCache::SSLSessionCache(std::size_t capacity) : capacity_(capacity)
+{
+}
+
+void
+SSLSessionCache::prepare(SSL* ssl, std::string const& key)
+{
+    {
+        std::lock_guard lock(mutex_);
+        auto const iter = sessions_.find(key);
+        if (iter != sessions_.end())
+        {
+            unsigned char const* data = iter->second.data();
+            if (auto const session = d2i_SSL_SESSION(
+                    nullptr, &data, static_cast<long>(iter->second.size())))
+            {
+                SSL_set_session(ssl, session);
+                SSL_SESSION_free(session);
+            }
+        }
+    }
+
+    auto target = std::make_unique<openssl::detail::SessionTarget>();
+    target->cache = weak_from_this();
+    target->key = key;
+    auto const index = openssl::detail::sessionTargetIndex();
+    delete static_cast<openssl::detail::SessionTarget*>(
+        SSL_get_ex_data(ssl, index));
+    if (SSL_set_ex_data(ssl, index, target.get()) == 1)
+        target.release();
+}
+
+std::size_t
+SSLSessionCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return sessions_.size();
+}
+
+void
+SSLSessionCache::insert(std::string const& key, SSL_SESSION* session)
+{
+    auto const size = i2d_SSL_SESSION(session, nullptr);
+    if (size <= 0)
+        return;
+    Blob der(size);
+    auto data = der.data();
+    if (i2d_SSL_SESSION(session, &data) != size)
+        return;
+
+    std::lock_guard lock(mutex_);
+    auto const [iter, inserted] = sessions_.emplace(key, Blob{});
+    if (inserted)
+        order_.push_back(key);
+    iter->second = std::move(der);
+
+    while (sessions_.size() > capacity_ && !order_.empty())
+    {
+        sessions_.erase(order_.front());
+        order_.pop_front();
+    }
+}
+
 //------------------------------------------------------------------------------
 std::shared_ptr<boost::asio::ssl::context>
 make_SSLContext(std::string const& cipherList)
@@ -20,6 +20,20 @@
 #include <ripple/basics/strHex.h>
 #include <array>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RIPPLE_HEX_X86 1
+#include <immintrin.h>
+#else
+#define RIPPLE_HEX_X86 0
+#endif
+
+#if defined(__aarch64__)
+#define RIPPLE_HEX_NEON 1
+#include <arm_neon.h>
+#else
+#define RIPPLE_HEX_NEON 0
+#endif
+
 namespace ripple {
 
 int
@@ -46,4 +60,282 @@ charUnHex(unsigned char c)
     return xtab[c];
 }
 
+namespace {
+
+constexpr char const hexDigits[] = "0123456789ABCDEF";
+
+void
+hexEncodeScalar(std::uint8_t const* in, std::size_t size, char* out)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        *out++ = hexDigits[in[i] >> 4];
+        *out++ = hexDigits[in[i] & 0x0F];
+    }
+}
+
+bool
+hexDecodeScalar(char const* in, std::size_t size, std::uint8_t* out)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto const hi = charUnHex(*in++);
+        auto const lo = charUnHex(*in++);
+
+        if (hi < 0 || lo < 0)
+            return false;
+
+        out[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+#if RIPPLE_HEX_X86
+
+#define RIPPLE_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define RIPPLE_TARGET_AVX2 __attribute__((target("avx2")))
+
+// Each kernel handles whole blocks and returns the number of bytes it
+// handled, leaving the rest to the scalar code.
+
+RIPPLE_TARGET_SSSE3 std::size_t
+hexEncodeSSSE3(std::uint8_t const* in, std::size_t size, char* out)
+{
+    auto const digits =
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(hexDigits));
+    auto const mask = _mm_set1_epi8(0x0F);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto const x =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+        auto const hi =
+            _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+        auto const lo = _mm_shuffle_epi8(digits, _mm_and_si128(x, mask));
+        auto const dest = reinterpret_cast<__m128i*>(out + 2 * i);
+        _mm_storeu_si128(dest, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(dest + 1, _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+RIPPLE_TARGET_AVX2 std::size_t
+hexEncodeAVX2(std::uint8_t const* in, std::size_t size, char* out)
+{
+    auto const digits = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(hexDigits)));
+    auto const mask = _mm256_set1_epi8(0x0F);
+
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        auto const x =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i));
+        auto const hi = _mm256_shuffle_epi8(
+            digits, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask));
+        auto const lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(x, mask));
+        // The unpacks work within each 128 bit half
+        auto const first = _mm256_unpacklo_epi8(hi, lo);
+        auto const second = _mm256_unpackhi_epi8(hi, lo);
+        auto const dest = reinterpret_cast<__m256i*>(out + 2 * i);
+        _mm256_storeu_si256(
+            dest, _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(
+            dest + 1, _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i;
+}
+
+// Converts hex digits to their values, clearing valid for other characters
+RIPPLE_TARGET_SSSE3 inline __m128i
+unHexSSSE3(__m128i c, __m128i& valid)
+{
+    auto const digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    auto const alpha =
+        _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    auto const isDigit =
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    auto const isAlpha =
+        _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    valid = _mm_and_si128(valid, _mm_or_si128(isDigit, isAlpha));
+    return _mm_or_si128(
+        _mm_and_si128(isDigit, digit),
+        _mm_andnot_si128(isDigit, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+RIPPLE_TARGET_SSSE3 std::size_t
+hexDecodeSSSE3(char const* in, std::size_t size, std::uint8_t* out)
+{
+    // Multiplies the high digit of each pair by 16 and adds the low one
+    auto const weights = _mm_set1_epi16(0x0110);
+
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        auto valid = _mm_set1_epi8(-1);
+        auto const values = unHexSSSE3(
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 2 * i)),
+            valid);
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+            break;
+        auto const bytes = _mm_maddubs_epi16(values, weights);
+        _mm_storel_epi64(
+            reinterpret_cast<__m128i*>(out + i),
+            _mm_packus_epi16(bytes, bytes));
+    }
+    return i;
+}
+
+RIPPLE_TARGET_AVX2 std::size_t
+hexDecodeAVX2(char const* in, std::size_t size, std::uint8_t* out)
+{
+    auto const weights = _mm256_set1_epi16(0x0110);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto const c =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + 2 * i));
+        auto const digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        auto const alpha = _mm256_sub_epi8(
+            _mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        auto const isDigit = _mm256_cmpeq_epi8(
+            _mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        auto const isAlpha = _mm256_cmpeq_epi8(
+            _mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+        if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isAlpha)) != -1)
+            break;
+        auto const values = _mm256_blendv_epi8(
+            _mm256_add_epi8(alpha, _mm256_set1_epi8(10)), digit, isDigit);
+        auto const bytes = _mm256_maddubs_epi16(values, weights);
+        // The pack works within each 128 bit half
+        auto const packed = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(bytes, bytes), 0x08);
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + i),
+            _mm256_castsi256_si128(packed));
+    }
+    return i;
+}
+
+enum class HexKernel { scalar, ssse3, avx2 };
+
+HexKernel
+hexKernel()
+{
+    static HexKernel const kernel = []() {
+        if (__builtin_cpu_supports("avx2"))
+            return HexKernel::avx2;
+        if (__builtin_cpu_supports("ssse3"))
+            return HexKernel::ssse3;
+        return HexKernel::scalar;
+    }();
+    return kernel;
+}
+
+#endif
+
+#if RIPPLE_HEX_NEON
+
+std::size_t
+hexEncodeNEON(std::uint8_t const* in, std::size_t size, char* out)
+{
+    auto const digits =
+        vld1q_u8(reinterpret_cast<std::uint8_t const*>(hexDigits));
+    auto const mask = vdupq_n_u8(0x0F);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto const x = vld1q_u8(in + i);
+        uint8x16x2_t chars;
+        chars.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(x, 4));
+        chars.val[1] = vqtbl1q_u8(digits, vandq_u8(x, mask));
+        vst2q_u8(reinterpret_cast<std::uint8_t*>(out + 2 * i), chars);
+    }
+    return i;
+}
+
+// Converts hex digits to their values, clearing valid for other characters
+inline uint8x16_t
+unHexNEON(uint8x16_t c, uint8x16_t& valid)
+{
+    auto const digit = vsubq_u8(c, vdupq_n_u8('0'));
+    auto const alpha = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    auto const isDigit = vcleq_u8(digit, vdupq_n_u8(9));
+    auto const isAlpha = vcleq_u8(alpha, vdupq_n_u8(5));
+    valid = vandq_u8(valid, vorrq_u8(isDigit, isAlpha));
+    return vbslq_u8(isDigit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+}
+
+std::size_t
+hexDecodeNEON(char const* in, std::size_t size, std::uint8_t* out)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        // Separates the high and low digits of each pair
+        auto const c =
+            vld2q_u8(reinterpret_cast<std::uint8_t const*>(in + 2 * i));
+        auto valid = vdupq_n_u8(0xFF);
+        auto const hi = unHexNEON(c.val[0], valid);
+        auto const lo = unHexNEON(c.val[1], valid);
+        if (vminvq_u8(valid) != 0xFF)
+            break;
+        vst1q_u8(out + i, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    }
+    return i;
+}
+
+#endif
+
+}  // namespace
+
+void
+hexEncode(std::uint8_t const* in, std::size_t size, char* out)
+{
+    std::size_t done = 0;
+#if RIPPLE_HEX_X86
+    switch (hexKernel())
+    {
+        case HexKernel::avx2:
+            done = hexEncodeAVX2(in, size, out);
+            break;
+        case HexKernel::ssse3:
+            done = hexEncodeSSSE3(in, size, out);
+            break;
+        case HexKernel::scalar:
+            break;
+    }
+#elif RIPPLE_HEX_NEON
+    done = hexEncodeNEON(in, size, out);
+#endif
+    hexEncodeScalar(in + done, size - done, out + 2 * done);
+}
+
+bool
+hexDecode(char const* in, std::size_t size, std::uint8_t* out)
+{
+    // A kernel stops at the first block with a character that is not a hex
+    // digit, and the scalar code then finds it
+    std::size_t done = 0;
+#if RIPPLE_HEX_X86
+    switch (hexKernel())
+    {
+        case HexKernel::avx2:
+            done = hexDecodeAVX2(in, size, out);
+            break;
+        case HexKernel::ssse3:
+            done = hexDecodeSSSE3(in, size, out);
+            break;
+        case HexKernel::scalar:
+            break;
+    }
+#elif RIPPLE_HEX_NEON
+    done = hexDecodeNEON(in, size, out);
+#endif
+    return hexDecodeScalar(in + 2 * done, size - done, out + done);
+}
+
 }  // namespace ripple
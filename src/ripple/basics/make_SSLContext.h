@@ -20,11 +20,65 @@
 #ifndef RIPPLE_BASICS_MAKE_SSLCONTEXT_H_INCLUDED
 #define RIPPLE_BASICS_MAKE_SSLCONTEXT_H_INCLUDED
 
+#include <ripple/basics/Blob.h>
 #include <boost/asio/ssl/context.hpp>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 namespace ripple {
 
+/** Remembers TLS sessions with servers so later connections resume them.
+
+    A resumed handshake skips the key exchange and the certificate, which
+    are most of the cost of connecting, so reconnecting to many servers at
+    once after a network outage is much cheaper. Sessions are kept under a
+    key chosen by the caller, normally the server's address, and the
+    oldest are dropped once the cache is full.
+
+    Sessions are kept serialized. OpenSSL stops resuming a session whose
+    connection ended without a TLS shutdown, but it is exactly after
+    dropped connections that resuming matters most.
+
+    Only contexts made by make_SSLContext or make_SSLContextAuthed hand
+    new sessions to the cache.
+*/
+class SSLSessionCache : public std::enable_shared_from_this<SSLSessionCache>
+{
+public:
+    explicit SSLSessionCache(std::size_t capacity);
+
+    SSLSessionCache(SSLSessionCache const&) = delete;
+    SSLSessionCache&
+    operator=(SSLSessionCache const&) = delete;
+
+    /** Prepare a client connection before its handshake.
+
+        Offers the session remembered under `key` for resumption, and
+        remembers under `key` the sessions the server issues. If the
+        server does not resume, a full handshake is done as usual.
+    */
+    void
+    prepare(SSL* ssl, std::string const& key);
+
+    std::size_t
+    size() const;
+
+    // Called from the OpenSSL new session callback
+    void
+    insert(std::string const& key, SSL_SESSION* session);
+
+private:
+    std::size_t const capacity_;
+
+    std::mutex mutable mutex_;
+    std::map<std::string, Blob> sessions_;
+    // Keys in the order they were first inserted
+    std::deque<std::string> order_;
+};
+
 /** Create a self-signed SSL context that allows anonymous Diffie Hellman. */
 std::shared_ptr<boost::asio::ssl::context>
 make_SSLContext(std::string const& cipherList);
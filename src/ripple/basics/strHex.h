@@ -22,6 +22,9 @@
 
 #include <boost/algorithm/hex.hpp>
 #include <boost/endian/conversion.hpp>
+#include <cstdint>
+#include <string>
+#include <type_traits>
 
 namespace ripple {
 
@@ -40,6 +43,46 @@ charUnHex(char c)
 }
 /** @} */
 
+/** Encodes bytes as upper case hex, using SIMD instructions if available.
+    @param in the bytes to encode
+    @param size the number of bytes
+    @param out receives 2 * size hex digits
+*/
+void
+hexEncode(std::uint8_t const* in, std::size_t size, char* out);
+
+/** Decodes pairs of hex digits, of either case, into bytes, using SIMD
+    instructions if available.
+    @param in 2 * size hex digits
+    @param size the number of bytes to produce
+    @param out receives size bytes, which are unspecified on failure
+    @return false if any character is not a hex digit
+*/
+[[nodiscard]] bool
+hexDecode(char const* in, std::size_t size, std::uint8_t* out);
+
+namespace detail {
+
+// True for pointers to bytes
+template <class P, class Byte = std::remove_cv_t<std::remove_pointer_t<P>>>
+constexpr bool isBytePointer = std::is_pointer_v<P> &&
+    (std::is_same_v<Byte, char> || std::is_same_v<Byte, signed char> ||
+     std::is_same_v<Byte, unsigned char>);
+
+// True for containers whose data() is a contiguous run of size() bytes
+template <class T, class = void>
+constexpr bool isByteContainer = false;
+
+template <class T>
+constexpr bool isByteContainer<
+    T,
+    std::void_t<
+        decltype(std::declval<T const&>().data()),
+        decltype(std::declval<T const&>().size())>> =
+    isBytePointer<decltype(std::declval<T const&>().data())>;
+
+}  // namespace detail
+
 template <class FwdIt>
 std::string
 strHex(FwdIt begin, FwdIt end)
@@ -50,8 +93,19 @@ strHex(FwdIt begin, FwdIt end)
             std::forward_iterator_tag>::value,
         "FwdIt must be a forward iterator");
     std::string result;
-    result.reserve(2 * std::distance(begin, end));
-    boost::algorithm::hex(begin, end, std::back_inserter(result));
+    if constexpr (detail::isBytePointer<FwdIt>)
+    {
+        result.resize(2 * std::distance(begin, end));
+        hexEncode(
+            reinterpret_cast<std::uint8_t const*>(begin),
+            std::distance(begin, end),
+            result.data());
+    }
+    else
+    {
+        result.reserve(2 * std::distance(begin, end));
+        boost::algorithm::hex(begin, end, std::back_inserter(result));
+    }
     return result;
 }
 
@@ -59,7 +113,13 @@ template <class T, class = decltype(std::declval<T>().begin())>
 std::string
 strHex(T const& from)
 {
-    return strHex(from.begin(), from.end());
+    if constexpr (detail::isByteContainer<T>)
+    {
+        auto const data = from.data();
+        return strHex(data, data + from.size());
+    }
+    else
+        return strHex(from.begin(), from.end());
 }
 
 }  // namespace ripple
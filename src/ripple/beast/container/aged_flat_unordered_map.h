@@ -0,0 +1,558 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef BEAST_CONTAINER_AGED_FLAT_UNORDERED_MAP_H_INCLUDED
+#define BEAST_CONTAINER_AGED_FLAT_UNORDERED_MAP_H_INCLUDED
+
+#include <ripple/beast/clock/abstract_clock.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace beast {
+
+/** An unordered map whose elements expire with age, stored flat.
+
+    This offers the part of the aged_unordered_map interface that tables
+    with a hold time use: find, emplace, touch, erase and expire.
+
+    The index is an open-addressing table probed linearly, whose slots hold
+    only a hash and a pointer, four to a cache line, so a lookup usually
+    reads one line of the index and then the element. The elements are not
+    allocated one by one: they are stored together in time buckets of a
+    fixed width, in the order they were inserted, so elements inserted at
+    about the same time, which tend to be looked up together, share cache
+    lines, and expiry frees them a bucket at a time.
+
+    Touching an element only updates its time. Expiry drops whole buckets
+    whose newest time is older than the requested age. Of their elements,
+    those not touched since are erased and the rest are moved to the bucket
+    of the time they were last touched, so each element moves at most once
+    per age however often it is touched. An element never expires early,
+    but may outlive the age by up to one bucket width. When the clock
+    advances in steps no smaller than the width, expiry is exact.
+
+    Expiring moves the elements that survive it, so iterators and references
+    are only valid until the next call to expire. Inserting invalidates
+    iterators but not references, and erasing invalidates only those to the
+    erased element.
+*/
+template <
+    class Key,
+    class T,
+    class Clock = std::chrono::steady_clock,
+    class Hash = std::hash<Key>,
+    class KeyEqual = std::equal_to<Key>>
+class aged_flat_unordered_map
+{
+public:
+    using clock_type = abstract_clock<Clock>;
+    using time_point = typename clock_type::time_point;
+    using duration = typename clock_type::duration;
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key const, T>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+private:
+    struct Element
+    {
+        template <class... Args>
+        Element(std::size_t hash_, time_point when_, Args&&... args)
+            : hash(hash_)
+            , when(when_)
+            , value(std::in_place, std::forward<Args>(args)...)
+        {
+        }
+
+        std::size_t hash;
+        time_point when;
+        // Empty once the element is erased
+        std::optional<value_type> value;
+    };
+
+    struct Bucket
+    {
+        Bucket(time_point start_) : start(start_), newest(start_)
+        {
+        }
+
+        time_point start;
+        time_point newest;
+        // A deque, so that adding elements doesn't move the others
+        std::deque<Element> elements;
+    };
+
+    struct Slot
+    {
+        std::size_t hash = 0;
+        // Null in a slot never used, erased() in one whose element is gone
+        Element* element = nullptr;
+    };
+
+    template <bool IsConst>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = aged_flat_unordered_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference =
+            std::conditional_t<IsConst, value_type const&, value_type&>;
+        using pointer =
+            std::conditional_t<IsConst, value_type const*, value_type*>;
+
+        basic_iterator() = default;
+
+        template <
+            bool OtherConst,
+            class = std::enable_if_t<IsConst || !OtherConst>>
+        basic_iterator(basic_iterator<OtherConst> const& other)
+            : map_(other.map_), index_(other.index_)
+        {
+        }
+
+        reference
+        operator*() const
+        {
+            return *map_->slots_[index_].element->value;
+        }
+
+        pointer
+        operator->() const
+        {
+            return &**this;
+        }
+
+        basic_iterator&
+        operator++()
+        {
+            index_ = map_->next(index_ + 1);
+            return *this;
+        }
+
+        basic_iterator
+        operator++(int)
+        {
+            auto prev = *this;
+            ++*this;
+            return prev;
+        }
+
+        /** The time the element was inserted or last touched. */
+        time_point const&
+        when() const
+        {
+            return map_->slots_[index_].element->when;
+        }
+
+        template <bool OtherConst>
+        bool
+        operator==(basic_iterator<OtherConst> const& other) const
+        {
+            return index_ == other.index_;
+        }
+
+        template <bool OtherConst>
+        bool
+        operator!=(basic_iterator<OtherConst> const& other) const
+        {
+            return index_ != other.index_;
+        }
+
+    private:
+        friend class aged_flat_unordered_map;
+        template <bool>
+        friend class basic_iterator;
+
+        using map_pointer = std::conditional_t<
+            IsConst,
+            aged_flat_unordered_map const*,
+            aged_flat_unordered_map*>;
+
+        basic_iterator(map_pointer map, std::size_t index)
+            : map_(map), index_(index)
+        {
+        }
+
+        map_pointer map_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+public:
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    explicit aged_flat_unordered_map(
+        clock_type& clock,
+        duration bucketWidth = std::chrono::seconds(1),
+        Hash const& hash = Hash(),
+        KeyEqual const& equal = KeyEqual())
+        : clock_(clock), width_(bucketWidth), hash_(hash), equal_(equal)
+    {
+        assert(width_ > duration::zero());
+    }
+
+    aged_flat_unordered_map(aged_flat_unordered_map const&) = delete;
+    aged_flat_unordered_map&
+    operator=(aged_flat_unordered_map const&) = delete;
+
+    clock_type&
+    clock()
+    {
+        return clock_;
+    }
+
+    clock_type const&
+    clock() const
+    {
+        return clock_;
+    }
+
+    bool
+    empty() const
+    {
+        return size_ == 0;
+    }
+
+    size_type
+    size() const
+    {
+        return size_;
+    }
+
+    iterator
+    begin()
+    {
+        return iterator(this, next(0));
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_iterator(this, next(0));
+    }
+
+    iterator
+    end()
+    {
+        return iterator(this, slots_.size());
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_iterator(this, slots_.size());
+    }
+
+    iterator
+    find(Key const& key)
+    {
+        return iterator(this, lookup(key, hash_(key)));
+    }
+
+    const_iterator
+    find(Key const& key) const
+    {
+        return const_iterator(this, lookup(key, hash_(key)));
+    }
+
+    size_type
+    count(Key const& key) const
+    {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    /** Insert an element made from the arguments if the key is absent.
+
+        A new element is timestamped now; an existing one is not touched.
+    */
+    template <class... Args>
+    std::pair<iterator, bool>
+    emplace(Key const& key, Args&&... args)
+    {
+        auto const hash = hash_(key);
+        if (auto const i = lookup(key, hash); i != slots_.size())
+            return {iterator(this, i), false};
+
+        // Linear probing slows quickly past three quarters full. Erased
+        // slots count toward that until the index is rebuilt.
+        if ((size_ + erased_ + 1) * 4 > slots_.size() * 3)
+        {
+            auto const capacity = slots_.empty() ? 16 : slots_.size();
+            rehash((size_ + 1) * 2 > capacity ? capacity * 2 : capacity);
+        }
+
+        auto const now = clock_.now();
+        auto& element = bucketFor(now).elements.emplace_back(
+            hash,
+            now,
+            std::piecewise_construct,
+            std::forward_as_tuple(key),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+
+        auto const i = place(hash);
+        if (slots_[i].element == erased())
+            --erased_;
+        slots_[i] = {hash, &element};
+        ++size_;
+        return {iterator(this, i), true};
+    }
+
+    /** Refresh the element's timestamp to now. */
+    void
+    touch(const_iterator pos)
+    {
+        slots_[pos.index_].element->when = clock_.now();
+    }
+
+    /** Erase an element.
+
+        @return An iterator to the element after it.
+    */
+    iterator
+    erase(const_iterator pos)
+    {
+        auto const i = pos.index_;
+        remove(i);
+        return iterator(this, next(i + 1));
+    }
+
+    size_type
+    erase(Key const& key)
+    {
+        auto const i = lookup(key, hash_(key));
+        if (i == slots_.size())
+            return 0;
+        remove(i);
+        return 1;
+    }
+
+    void
+    clear()
+    {
+        std::fill(slots_.begin(), slots_.end(), Slot{});
+        buckets_.clear();
+        size_ = 0;
+        erased_ = 0;
+    }
+
+    /** Erase the elements not touched in the last `age`.
+
+        @return The number of elements erased.
+    */
+    size_type
+    expire(duration age)
+    {
+        auto const expired = clock_.now() - age;
+        size_type n = 0;
+        while (!buckets_.empty() && buckets_.front()->newest <= expired)
+        {
+            auto const bucket = std::move(buckets_.front());
+            buckets_.pop_front();
+            for (auto& element : bucket->elements)
+            {
+                if (!element.value)
+                    continue;
+
+                auto const i = slotOf(element);
+                if (element.when <= expired)
+                {
+                    remove(i);
+                    ++n;
+                }
+                else
+                {
+                    // Touched since: move it to the bucket of that time
+                    auto const when = element.when;
+                    slots_[i].element = &bucketFor(when).elements.emplace_back(
+                        element.hash, when, std::move(*element.value));
+                }
+            }
+        }
+        return n;
+    }
+
+private:
+    std::size_t
+    mask() const
+    {
+        return slots_.size() - 1;
+    }
+
+    // Marks the slot of an erased element, so that lookups probe past it
+    Element*
+    erased() const
+    {
+        return reinterpret_cast<Element*>(const_cast<Slot*>(&erasedMark_));
+    }
+
+    std::size_t
+    lookup(Key const& key, std::size_t hash) const
+    {
+        if (slots_.empty())
+            return 0;
+
+        for (auto i = hash & mask();; i = (i + 1) & mask())
+        {
+            auto const& slot = slots_[i];
+            if (!slot.element)
+                return slots_.size();
+            if (slot.hash == hash && slot.element != erased() &&
+                equal_(slot.element->value->first, key))
+                return i;
+        }
+    }
+
+    // The slot an element is indexed in
+    std::size_t
+    slotOf(Element const& element) const
+    {
+        auto i = element.hash & mask();
+        while (slots_[i].element != &element)
+            i = (i + 1) & mask();
+        return i;
+    }
+
+    // The first slot free for an element with the hash
+    std::size_t
+    place(std::size_t hash) const
+    {
+        auto i = hash & mask();
+        while (slots_[i].element && slots_[i].element != erased())
+            i = (i + 1) & mask();
+        return i;
+    }
+
+    // The first slot in use at or after i
+    std::size_t
+    next(std::size_t i) const
+    {
+        while (i < slots_.size() &&
+               (!slots_[i].element || slots_[i].element == erased()))
+            ++i;
+        return i < slots_.size() ? i : slots_.size();
+    }
+
+    // The bucket for a time, which is at most now
+    Bucket&
+    bucketFor(time_point when)
+    {
+        if (buckets_.empty() || when >= buckets_.back()->start + width_)
+        {
+            buckets_.push_back(std::make_unique<Bucket>(when));
+            return *buckets_.back();
+        }
+
+        // The last bucket starting no later than the time
+        auto it = std::prev(buckets_.end());
+        if (when < (*it)->start)
+        {
+            it = std::upper_bound(
+                buckets_.begin(),
+                buckets_.end(),
+                when,
+                [](time_point const& t, std::unique_ptr<Bucket> const& b) {
+                    return t < b->start;
+                });
+            if (it != buckets_.begin())
+                --it;
+        }
+
+        // No bucket covers a time when nothing was inserted
+        if (when < (*it)->start)
+            it = buckets_.insert(it, std::make_unique<Bucket>(when));
+        else if (when >= (*it)->start + width_)
+            it = buckets_.insert(std::next(it), std::make_unique<Bucket>(when));
+
+        if (when > (*it)->newest)
+            (*it)->newest = when;
+        return **it;
+    }
+
+    // The element stays in its bucket until the bucket expires
+    void
+    remove(std::size_t i)
+    {
+        slots_[i].element->value.reset();
+        slots_[i].element = erased();
+        --size_;
+        ++erased_;
+    }
+
+    void
+    rehash(std::size_t capacity)
+    {
+        std::vector<Slot> slots(capacity);
+        slots.swap(slots_);
+
+        for (auto const& slot : slots)
+        {
+            if (slot.element && slot.element != erased())
+                slots_[place(slot.hash)] = slot;
+        }
+        erased_ = 0;
+    }
+
+    clock_type& clock_;
+    duration const width_;
+    Hash hash_;
+    KeyEqual equal_;
+
+    std::vector<Slot> slots_;
+    std::size_t size_ = 0;
+    std::size_t erased_ = 0;
+    std::deque<std::unique_ptr<Bucket>> buckets_;
+    Slot erasedMark_;
+};
+
+/** Expire the elements of a flat aged map past the specified age. */
+template <
+    class Key,
+    class T,
+    class Clock,
+    class Hash,
+    class KeyEqual,
+    class Rep,
+    class Period>
+std::size_t
+expire(
+    aged_flat_unordered_map<Key, T, Clock, Hash, KeyEqual>& c,
+    std::chrono::duration<Rep, Period> const& age)
+{
+    return c.expire(
+        std::chrono::duration_cast<
+            typename aged_flat_unordered_map<Key, T, Clock, Hash, KeyEqual>::
+                duration>(age));
+}
+
+}  // namespace beast
+
+#endif
@@ -23,6 +23,7 @@
 #include <ripple/beast/insight/Counter.h>
 #include <ripple/beast/insight/Event.h>
 #include <ripple/beast/insight/Gauge.h>
+#include <ripple/beast/insight/Histogram.h>
 #include <ripple/beast/insight/Hook.h>
 #include <ripple/beast/insight/Meter.h>
 
@@ -35,10 +36,10 @@ namespace insight {
 
     To export metrics from a class, pass and save a shared_ptr to this
     interface in the class constructor. Create the metric objects
-    as desired (counters, events, gauges, meters, and an optional hook)
-    using the interface.
+    as desired (counters, events, gauges, histograms, meters, and an
+    optional hook) using the interface.
 
-    @see Counter, Event, Gauge, Hook, Meter
+    @see Counter, Event, Gauge, Histogram, Hook, Meter
     @see NullCollector, StatsDCollector
 */
 class Collector
@@ -120,6 +121,22 @@ public:
     }
     /** @} */
 
+    /** Create a histogram with the specified name.
+        @see Histogram
+    */
+    /** @{ */
+    virtual Histogram
+    make_histogram(std::string const& name) = 0;
+
+    Histogram
+    make_histogram(std::string const& prefix, std::string const& name)
+    {
+        if (prefix.empty())
+            return make_histogram(name);
+        return make_histogram(prefix + "." + name);
+    }
+    /** @} */
+
     /** Create a meter with the specified name.
         @see Meter
     */
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef BEAST_INSIGHT_HISTOGRAM_H_INCLUDED
+#define BEAST_INSIGHT_HISTOGRAM_H_INCLUDED
+
+#include <ripple/beast/insight/HistogramImpl.h>
+
+#include <date/date.h>
+
+#include <chrono>
+#include <memory>
+
+namespace beast {
+namespace insight {
+
+/** A metric for the distribution of event timings.
+
+    Every timing is kept in a fixed size LogHistogram in this process, so
+    percentiles can be read locally whatever the collector. The collector
+    decides how the distribution is also reported elsewhere.
+
+    This is a lightweight reference wrapper which is cheap to copy and assign.
+    When the last reference goes away, the metric is no longer collected.
+*/
+class Histogram final
+{
+public:
+    using value_type = HistogramImpl::value_type;
+
+    /** Create a null metric.
+        A null metric records and reports no information.
+    */
+    Histogram()
+    {
+    }
+
+    /** Create the metric reference the specified implementation.
+        Normally this won't be called directly. Instead, call the appropriate
+        factory function in the Collector interface.
+        @see Collector.
+    */
+    explicit Histogram(std::shared_ptr<HistogramImpl> const& impl)
+        : m_impl(impl)
+    {
+    }
+
+    /** Record a timing. */
+    template <class Rep, class Period>
+    void
+    notify(std::chrono::duration<Rep, Period> const& value) const
+    {
+        if (m_impl)
+            m_impl->notify(date::ceil<value_type>(value));
+    }
+
+    /** The bucket counts of every timing recorded so far. */
+    LogHistogram::Counts
+    counts() const
+    {
+        if (m_impl)
+            return m_impl->counts();
+        return {};
+    }
+
+    /** The number of timings recorded so far. */
+    std::uint64_t
+    count() const
+    {
+        return LogHistogram::count(counts());
+    }
+
+    /** A timing at the given percentile, from 0 to 100. */
+    value_type
+    percentile(double p) const
+    {
+        return value_type(LogHistogram::percentile(counts(), p));
+    }
+
+    std::shared_ptr<HistogramImpl> const&
+    impl() const
+    {
+        return m_impl;
+    }
+
+private:
+    std::shared_ptr<HistogramImpl> m_impl;
+};
+
+}  // namespace insight
+}  // namespace beast
+
+#endif
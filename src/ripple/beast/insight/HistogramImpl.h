@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef BEAST_INSIGHT_HISTOGRAMIMPL_H_INCLUDED
+#define BEAST_INSIGHT_HISTOGRAMIMPL_H_INCLUDED
+
+#include <ripple/beast/insight/LogHistogram.h>
+
+#include <chrono>
+#include <memory>
+
+namespace beast {
+namespace insight {
+
+class Histogram;
+
+class HistogramImpl : public std::enable_shared_from_this<HistogramImpl>
+{
+public:
+    using value_type = std::chrono::microseconds;
+
+    virtual ~HistogramImpl() = 0;
+    virtual void
+    notify(value_type const& value) = 0;
+    virtual LogHistogram::Counts
+    counts() const = 0;
+};
+
+}  // namespace insight
+}  // namespace beast
+
+#endif
@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef BEAST_INSIGHT_LOGHISTOGRAM_H_INCLUDED
+#define BEAST_INSIGHT_LOGHISTOGRAM_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace beast {
+namespace insight {
+
+/** A fixed size distribution of non-negative integers.
+
+    Values below 8 have a bucket each. Above that, every power of two is
+    split into eight equal buckets, so a percentile read back is within
+    1/16 of a value that was recorded. Values from 2^40 up share the last
+    bucket. Recording is a relaxed increment and never allocates.
+
+    Bucket counts from several histograms, or from one histogram at two
+    points in time, can be added or subtracted to merge distributions or
+    to find the distribution of an interval.
+*/
+class LogHistogram
+{
+public:
+    static constexpr std::size_t subBuckets = 8;
+    static constexpr std::size_t maxExponent = 40;
+    static constexpr std::size_t buckets =
+        subBuckets + (maxExponent - 3) * subBuckets;
+
+    using Counts = std::array<std::uint64_t, buckets>;
+
+    LogHistogram() = default;
+    LogHistogram(LogHistogram const&) = delete;
+    LogHistogram&
+    operator=(LogHistogram const&) = delete;
+
+    void
+    add(std::uint64_t value) noexcept
+    {
+        counts_[index(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** Add counts recorded elsewhere to this histogram. */
+    void
+    merge(Counts const& counts) noexcept
+    {
+        for (std::size_t i = 0; i != buckets; ++i)
+        {
+            if (counts[i] != 0)
+                counts_[i].fetch_add(counts[i], std::memory_order_relaxed);
+        }
+    }
+
+    /** The current bucket counts. */
+    Counts
+    counts() const noexcept
+    {
+        Counts ret;
+        for (std::size_t i = 0; i != buckets; ++i)
+            ret[i] = counts_[i].load(std::memory_order_relaxed);
+        return ret;
+    }
+
+    /** The bucket a value is counted in. */
+    static std::size_t
+    index(std::uint64_t value) noexcept
+    {
+        if (value < subBuckets)
+            return static_cast<std::size_t>(value);
+        std::size_t exponent = 3;
+        while (exponent + 1 < 64 && (value >> (exponent + 1)) != 0)
+            ++exponent;
+        if (exponent >= maxExponent)
+            return buckets - 1;
+        auto const mantissa = (value >> (exponent - 3)) & (subBuckets - 1);
+        return subBuckets + (exponent - 3) * subBuckets + mantissa;
+    }
+
+    /** The smallest value counted in a bucket. */
+    static std::uint64_t
+    lowerBound(std::size_t i) noexcept
+    {
+        if (i < subBuckets)
+            return i;
+        auto const exponent = (i - subBuckets) / subBuckets + 3;
+        auto const mantissa = (i - subBuckets) % subBuckets;
+        return (subBuckets + mantissa) << (exponent - 3);
+    }
+
+    /** The value a bucket is reported as: the middle of its range. */
+    static std::uint64_t
+    midpoint(std::size_t i) noexcept
+    {
+        if (i < subBuckets)
+            return i;
+        auto const exponent = (i - subBuckets) / subBuckets + 3;
+        return lowerBound(i) + (std::uint64_t{1} << (exponent - 3)) / 2;
+    }
+
+    static std::uint64_t
+    count(Counts const& counts) noexcept
+    {
+        std::uint64_t total = 0;
+        for (auto const c : counts)
+            total += c;
+        return total;
+    }
+
+    /** A value at the given percentile, zero if nothing was recorded.
+        @param counts bucket counts
+        @param p percentile, from 0 to 100
+    */
+    static std::uint64_t
+    percentile(Counts const& counts, double p) noexcept
+    {
+        auto const total = count(counts);
+        if (total == 0)
+            return 0;
+        auto const rank = std::min(
+            static_cast<std::uint64_t>(total * std::clamp(p, 0.0, 100.0) / 100),
+            total - 1);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i != buckets; ++i)
+        {
+            seen += counts[i];
+            if (seen > rank)
+                return midpoint(i);
+        }
+        return midpoint(buckets - 1);
+    }
+
+    std::uint64_t
+    percentile(double p) const noexcept
+    {
+        return percentile(counts(), p);
+    }
+
+    /** The counts recorded between two readings of one histogram. */
+    static Counts
+    difference(Counts const& later, Counts const& earlier) noexcept
+    {
+        Counts ret;
+        for (std::size_t i = 0; i != buckets; ++i)
+            ret[i] = later[i] - earlier[i];
+        return ret;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, buckets> counts_{};
+};
+
+}  // namespace insight
+}  // namespace beast
+
+#endif
@@ -77,6 +77,12 @@ public:
         return m_collector->make_gauge(make_name(name));
     }
 
+    Histogram
+    make_histogram(std::string const& name) override
+    {
+        return m_collector->make_histogram(make_name(name));
+    }
+
     Meter
     make_meter(std::string const& name) override
     {
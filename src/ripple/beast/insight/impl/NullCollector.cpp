@@ -89,6 +89,33 @@ private:
 
 //------------------------------------------------------------------------------
 
+// Histograms are still recorded so that they can be read locally
+class NullHistogramImpl : public HistogramImpl
+{
+public:
+    explicit NullHistogramImpl() = default;
+
+    void
+    notify(value_type const& value) override
+    {
+        histogram_.add(value.count() < 0 ? 0 : value.count());
+    }
+
+    LogHistogram::Counts
+    counts() const override
+    {
+        return histogram_.counts();
+    }
+
+private:
+    NullHistogramImpl&
+    operator=(NullHistogramImpl const&);
+
+    LogHistogram histogram_;
+};
+
+//------------------------------------------------------------------------------
+
 class NullMeterImpl : public MeterImpl
 {
 public:
@@ -137,6 +164,12 @@ public:
         return Gauge(std::make_shared<detail::NullGaugeImpl>());
     }
 
+    Histogram
+    make_histogram(std::string const&) override
+    {
+        return Histogram(std::make_shared<detail::NullHistogramImpl>());
+    }
+
     Meter
     make_meter(std::string const&) override
     {
@@ -21,6 +21,7 @@
 #include <ripple/beast/insight/CounterImpl.h>
 #include <ripple/beast/insight/EventImpl.h>
 #include <ripple/beast/insight/GaugeImpl.h>
+#include <ripple/beast/insight/HistogramImpl.h>
 #include <ripple/beast/insight/HookImpl.h>
 #include <ripple/beast/insight/MeterImpl.h>
 #include <ripple/beast/insight/StatsDCollector.h>
@@ -179,6 +180,39 @@ private:
 
 //------------------------------------------------------------------------------
 
+// Sends percentiles of the timings recorded in each interval as gauges,
+// rather than every timing, so nothing is lost to dropped packets.
+class StatsDHistogramImpl : public HistogramImpl, public StatsDMetricBase
+{
+public:
+    StatsDHistogramImpl(
+        std::string const& name,
+        std::shared_ptr<StatsDCollectorImp> const& impl);
+
+    ~StatsDHistogramImpl() override;
+
+    void
+    notify(HistogramImpl::value_type const& value) override;
+    LogHistogram::Counts
+    counts() const override;
+
+    void
+    flush();
+    void
+    do_process() override;
+
+private:
+    StatsDHistogramImpl&
+    operator=(StatsDHistogramImpl const&);
+
+    std::shared_ptr<StatsDCollectorImp> m_impl;
+    std::string m_name;
+    LogHistogram m_histogram;
+    LogHistogram::Counts m_reported{};
+};
+
+//------------------------------------------------------------------------------
+
 class StatsDMeterImpl : public MeterImpl, public StatsDMetricBase
 {
 public:
@@ -294,6 +328,13 @@ public:
             name, shared_from_this()));
     }
 
+    Histogram
+    make_histogram(std::string const& name) override
+    {
+        return Histogram(std::make_shared<detail::StatsDHistogramImpl>(
+            name, shared_from_this()));
+    }
+
     Meter
     make_meter(std::string const& name) override
     {
@@ -679,6 +720,62 @@ StatsDGaugeImpl::do_process()
 
 //------------------------------------------------------------------------------
 
+StatsDHistogramImpl::StatsDHistogramImpl(
+    std::string const& name,
+    std::shared_ptr<StatsDCollectorImp> const& impl)
+    : m_impl(impl), m_name(name)
+{
+    m_impl->add(*this);
+}
+
+StatsDHistogramImpl::~StatsDHistogramImpl()
+{
+    m_impl->remove(*this);
+}
+
+void
+StatsDHistogramImpl::notify(HistogramImpl::value_type const& value)
+{
+    m_histogram.add(value.count() < 0 ? 0 : value.count());
+}
+
+LogHistogram::Counts
+StatsDHistogramImpl::counts() const
+{
+    return m_histogram.counts();
+}
+
+void
+StatsDHistogramImpl::flush()
+{
+    auto const current = m_histogram.counts();
+    auto const interval = LogHistogram::difference(current, m_reported);
+    m_reported = current;
+
+    auto const count = LogHistogram::count(interval);
+    if (count == 0)
+        return;
+
+    std::stringstream ss;
+    for (auto const p : {50, 90, 99})
+    {
+        ss << m_impl->prefix() << "." << m_name << ".p" << p << ":"
+           << LogHistogram::percentile(interval, p) << "|g"
+           << "\n";
+    }
+    ss << m_impl->prefix() << "." << m_name << ".count:" << count << "|c"
+       << "\n";
+    m_impl->post_buffer(ss.str());
+}
+
+void
+StatsDHistogramImpl::do_process()
+{
+    flush();
+}
+
+//------------------------------------------------------------------------------
+
 StatsDMeterImpl::StatsDMeterImpl(
     std::string const& name,
     std::shared_ptr<StatsDCollectorImp> const& impl)
@@ -1651,6 +1651,7 @@ Consensus<Adaptor>::createDisputes(TxSet_t const& o)
             tx,
             result_->txns.exists(txID),
             std::max(prevProposers_, currPeerPositions_.size()),
+            result_->disputePeers,
             j_};
 
         // Update all of the available peer's votes on the disputed transaction
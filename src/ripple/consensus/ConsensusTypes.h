@@ -25,6 +25,7 @@
 #include <ripple/consensus/DisputedTx.h>
 #include <chrono>
 #include <map>
+#include <memory>
 
 namespace ripple {
 
@@ -226,6 +227,10 @@ struct ConsensusResult
     //! Transactions which are under dispute with our peers
     hash_map<typename Tx_t::ID, Dispute_t> disputes;
 
+    //! Indices of the peers voting on the disputes
+    std::shared_ptr<DisputePeers<NodeID_t>> disputePeers =
+        std::make_shared<DisputePeers<NodeID_t>>();
+
     // Set of TxSet ids we have already compared/created disputes
     hash_set<typename TxSet_t::ID> compares;
 
@@ -28,10 +28,61 @@
 #include <ripple/protocol/Serializer.h>
 #include <ripple/protocol/UintTypes.h>
 #include <boost/container/flat_map.hpp>
+#include <bitset>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace ripple {
 
+/** Dense indices for the peers voting on the disputes of one round.
+
+    Every @ref DisputedTx of a round shares one instance, so that a peer's
+    vote is a bit at the same position in all of them.
+
+    @tparam NodeID_t The type for a node identifier
+*/
+template <class NodeID_t>
+class DisputePeers
+{
+public:
+    /** Return the index of a peer, assigning the next free one if needed */
+    std::size_t
+    insert(NodeID_t const& peer)
+    {
+        auto const [it, inserted] = index_.emplace(peer, ids_.size());
+        if (inserted)
+            ids_.push_back(peer);
+        return it->second;
+    }
+
+    /** Return the index of a peer, or size() if it has none */
+    std::size_t
+    find(NodeID_t const& peer) const
+    {
+        auto const it = index_.find(peer);
+        return it == index_.end() ? ids_.size() : it->second;
+    }
+
+    //! The peer with the given index
+    NodeID_t const&
+    operator[](std::size_t i) const
+    {
+        return ids_[i];
+    }
+
+    //! The number of peers with an index
+    std::size_t
+    size() const
+    {
+        return ids_.size();
+    }
+
+private:
+    boost::container::flat_map<NodeID_t, std::size_t> index_;
+    std::vector<NodeID_t> ids_;
+};
+
 /** A transaction discovered to be in dispute during consensus.
 
     During consensus, a @ref DisputedTx is created when a transaction
@@ -40,6 +91,9 @@ namespace ripple {
 
     Undisputed transactions have no corresponding @ref DisputedTx object.
 
+    Peer votes are kept as bits indexed through a @ref DisputePeers shared
+    by all disputes of the round, and tallied by counting bits.
+
     Refer to @ref Consensus for details on the template type requirements.
 
     @tparam Tx_t The type for a transaction
@@ -50,7 +104,9 @@ template <class Tx_t, class NodeID_t>
 class DisputedTx
 {
     using TxID_t = typename Tx_t::ID;
-    using Map_t = boost::container::flat_map<NodeID_t, bool>;
+    using Peers_t = DisputePeers<NodeID_t>;
+    using Word = std::uint64_t;
+    static constexpr std::size_t wordBits = 64;
 
 public:
     /** Constructor
@@ -58,16 +114,21 @@ public:
         @param tx The transaction under dispute
         @param ourVote Our vote on whether tx should be included
         @param numPeers Anticipated number of peer votes
+        @param peers Indices of the peers voting on this round's disputes
         @param j Journal for debugging
     */
     DisputedTx(
         Tx_t const& tx,
         bool ourVote,
         std::size_t numPeers,
+        std::shared_ptr<Peers_t> peers,
         beast::Journal j)
-        : yays_(0), nays_(0), ourVote_(ourVote), tx_(tx), j_(j)
+        : ourVote_(ourVote), tx_(tx), peers_(std::move(peers)), j_(j)
     {
-        votes_.reserve(numPeers);
+        auto const words = (std::max(numPeers, peers_->size()) + wordBits - 1) /
+            wordBits;
+        voted_.reserve(words);
+        yes_.reserve(words);
     }
 
     //! The unique id/hash of the disputed transaction.
@@ -132,11 +193,19 @@ public:
     getJson() const;
 
 private:
-    int yays_;      //< Number of yes votes
-    int nays_;      //< Number of no votes
+    //! Number of yes votes
+    int
+    yays() const;
+
+    //! Number of no votes
+    int
+    nays() const;
+
     bool ourVote_;  //< Our vote (true is yes)
     Tx_t tx_;       //< Transaction under dispute
-    Map_t votes_;   //< Map from NodeID to vote
+    std::shared_ptr<Peers_t> peers_;  //< Indices of the voting peers
+    std::vector<Word> voted_;         //< Bit set for each peer that voted
+    std::vector<Word> yes_;           //< Bit set for each peer voting yes
     beast::Journal const j_;
 };
 
@@ -145,38 +214,42 @@ template <class Tx_t, class NodeID_t>
 void
 DisputedTx<Tx_t, NodeID_t>::setVote(NodeID_t const& peer, bool votesYes)
 {
-    auto const [it, inserted] = votes_.insert(std::make_pair(peer, votesYes));
+    auto const i = peers_->insert(peer);
+    auto const word = i / wordBits;
+    auto const bit = Word{1} << (i % wordBits);
+    if (word >= voted_.size())
+    {
+        voted_.resize(word + 1, 0);
+        yes_.resize(word + 1, 0);
+    }
+
+    bool const voted = voted_[word] & bit;
+    bool const wasYes = yes_[word] & bit;
 
     // new vote
-    if (inserted)
+    if (!voted)
     {
         if (votesYes)
-        {
             JLOG(j_.debug()) << "Peer " << peer << " votes YES on " << tx_.id();
-            ++yays_;
-        }
         else
-        {
             JLOG(j_.debug()) << "Peer " << peer << " votes NO on " << tx_.id();
-            ++nays_;
-        }
     }
     // changes vote to yes
-    else if (votesYes && !it->second)
+    else if (votesYes && !wasYes)
     {
         JLOG(j_.debug()) << "Peer " << peer << " now votes YES on " << tx_.id();
-        --nays_;
-        ++yays_;
-        it->second = true;
     }
     // changes vote to no
-    else if (!votesYes && it->second)
+    else if (!votesYes && wasYes)
     {
         JLOG(j_.debug()) << "Peer " << peer << " now votes NO on " << tx_.id();
-        ++nays_;
-        --yays_;
-        it->second = false;
     }
+
+    voted_[word] |= bit;
+    if (votesYes)
+        yes_[word] |= bit;
+    else
+        yes_[word] &= ~bit;
 }
 
 // Remove a peer's vote on this disputed transaction
@@ -184,19 +257,36 @@ template <class Tx_t, class NodeID_t>
 void
 DisputedTx<Tx_t, NodeID_t>::unVote(NodeID_t const& peer)
 {
-    auto it = votes_.find(peer);
-
-    if (it != votes_.end())
+    auto const i = peers_->find(peer);
+    auto const word = i / wordBits;
+    if (word < voted_.size())
     {
-        if (it->second)
-            --yays_;
-        else
-            --nays_;
-
-        votes_.erase(it);
+        auto const bit = Word{1} << (i % wordBits);
+        voted_[word] &= ~bit;
+        yes_[word] &= ~bit;
     }
 }
 
+template <class Tx_t, class NodeID_t>
+int
+DisputedTx<Tx_t, NodeID_t>::yays() const
+{
+    std::size_t count = 0;
+    for (auto const w : yes_)
+        count += std::bitset<wordBits>(w).count();
+    return static_cast<int>(count);
+}
+
+template <class Tx_t, class NodeID_t>
+int
+DisputedTx<Tx_t, NodeID_t>::nays() const
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < voted_.size(); ++i)
+        count += std::bitset<wordBits>(voted_[i] & ~yes_[i]).count();
+    return static_cast<int>(count);
+}
+
 template <class Tx_t, class NodeID_t>
 bool
 DisputedTx<Tx_t, NodeID_t>::updateVote(
@@ -204,10 +294,13 @@ DisputedTx<Tx_t, NodeID_t>::updateVote(
     bool proposing,
     ConsensusParms const& p)
 {
-    if (ourVote_ && (nays_ == 0))
+    int const yes = yays();
+    int const no = nays();
+
+    if (ourVote_ && (no == 0))
         return false;
 
-    if (!ourVote_ && (yays_ == 0))
+    if (!ourVote_ && (yes == 0))
         return false;
 
     bool newPosition;
@@ -216,7 +309,7 @@ DisputedTx<Tx_t, NodeID_t>::updateVote(
     if (proposing)  // give ourselves full weight
     {
         // This is basically the percentage of nodes voting 'yes' (including us)
-        weight = (yays_ * 100 + (ourVote_ ? 100 : 0)) / (nays_ + yays_ + 1);
+        weight = (yes * 100 + (ourVote_ ? 100 : 0)) / (no + yes + 1);
 
         // To prevent avalanche stalls, we increase the needed weight slightly
         // over time.
@@ -233,7 +326,7 @@ DisputedTx<Tx_t, NodeID_t>::updateVote(
     {
         // don't let us outweigh a proposing node, just recognize consensus
         weight = -1;
-        newPosition = yays_ > nays_;
+        newPosition = yes > no;
     }
 
     if (newPosition == ourVote_)
@@ -260,17 +353,20 @@ DisputedTx<Tx_t, NodeID_t>::getJson() const
 
     Json::Value ret(Json::objectValue);
 
-    ret["yays"] = yays_;
-    ret["nays"] = nays_;
+    ret["yays"] = yays();
+    ret["nays"] = nays();
     ret["our_vote"] = ourVote_;
 
-    if (!votes_.empty())
+    Json::Value votesj(Json::objectValue);
+    for (std::size_t i = 0; i < voted_.size() * wordBits; ++i)
     {
-        Json::Value votesj(Json::objectValue);
-        for (auto const& [nodeId, vote] : votes_)
-            votesj[to_string(nodeId)] = vote;
-        ret["votes"] = std::move(votesj);
+        auto const bit = Word{1} << (i % wordBits);
+        if (voted_[i / wordBits] & bit)
+            votesj[to_string((*peers_)[i])] =
+                (yes_[i / wordBits] & bit) != 0;
     }
+    if (votesj.size() != 0)
+        ret["votes"] = std::move(votesj);
 
     return ret;
 }
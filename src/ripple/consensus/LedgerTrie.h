@@ -359,6 +359,12 @@ class LedgerTrie
     // Count of the tip support for each sequence number
     std::map<Seq, std::uint32_t> seqSupport;
 
+    // The last preferred ledger found and the largest issued sequence it
+    // was found for. Reset whenever the support changes.
+    mutable boost::optional<
+        std::pair<Seq, boost::optional<SpanTip<Ledger>>>>
+        preferred_;
+
     /** Find the node in the trie that represents the longest common ancestry
         with the given ledger.
 
@@ -436,6 +442,103 @@ class LedgerTrie
         }
     }
 
+    // Walk the trie from the root to find the preferred ledger
+    boost::optional<SpanTip<Ledger>>
+    findPreferred(Seq const largestIssued) const
+    {
+        if (empty())
+            return boost::none;
+
+        Node* curr = root.get();
+
+        bool done = false;
+
+        std::uint32_t uncommitted = 0;
+        auto uncommittedIt = seqSupport.begin();
+
+        while (curr && !done)
+        {
+            // Within a single span, the preferred by branch strategy is simply
+            // to continue along the span as long as the branch support of
+            // the next ledger exceeds the uncommitted support for that ledger.
+            {
+                // Add any initial uncommitted support prior for ledgers
+                // earlier than nextSeq or earlier than largestIssued
+                Seq nextSeq = curr->span.start() + Seq{1};
+                while (uncommittedIt != seqSupport.end() &&
+                       uncommittedIt->first < std::max(nextSeq, largestIssued))
+                {
+                    uncommitted += uncommittedIt->second;
+                    uncommittedIt++;
+                }
+
+                // Advance nextSeq along the span
+                while (nextSeq < curr->span.end() &&
+                       curr->branchSupport > uncommitted)
+                {
+                    // Jump to the next seqSupport change
+                    if (uncommittedIt != seqSupport.end() &&
+                        uncommittedIt->first < curr->span.end())
+                    {
+                        nextSeq = uncommittedIt->first + Seq{1};
+                        uncommitted += uncommittedIt->second;
+                        uncommittedIt++;
+                    }
+                    else  // otherwise we jump to the end of the span
+                        nextSeq = curr->span.end();
+                }
+                // We did not consume the entire span, so we have found the
+                // preferred ledger
+                if (nextSeq < curr->span.end())
+                    return curr->span.before(nextSeq)->tip();
+            }
+
+            // We have reached the end of the current span, so we need to
+            // find the best child
+            Node* best = nullptr;
+            std::uint32_t margin = 0;
+            if (curr->children.size() == 1)
+            {
+                best = curr->children[0].get();
+                margin = best->branchSupport;
+            }
+            else if (!curr->children.empty())
+            {
+                // Sort placing children with largest branch support in the
+                // front, breaking ties with the span's starting ID
+                std::partial_sort(
+                    curr->children.begin(),
+                    curr->children.begin() + 2,
+                    curr->children.end(),
+                    [](std::unique_ptr<Node> const& a,
+                       std::unique_ptr<Node> const& b) {
+                        return std::make_tuple(
+                                   a->branchSupport, a->span.startID()) >
+                            std::make_tuple(
+                                   b->branchSupport, b->span.startID());
+                    });
+
+                best = curr->children[0].get();
+                margin = curr->children[0]->branchSupport -
+                    curr->children[1]->branchSupport;
+
+                // If best holds the tie-breaker, gets one larger margin
+                // since the second best needs additional branchSupport
+                // to overcome the tie
+                if (best->span.startID() > curr->children[1]->span.startID())
+                    margin++;
+            }
+
+            // If the best child has margin exceeding the uncommitted support,
+            // continue from that child, otherwise we are done
+            if (best && ((margin > uncommitted) || (uncommitted == 0)))
+                curr = best;
+            else  // current is the best
+                done = true;
+        }
+        return curr->span.tip();
+    }
+
 public:
     LedgerTrie() : root{std::make_unique<Node>()}
     {
@@ -454,6 +557,8 @@ public:
         // There is always a place to insert
         assert(loc);
 
+        preferred_.reset();
+
         // Node from which to start incrementing branchSupport
         Node* incNode = loc;
 
@@ -541,6 +646,7 @@ public:
             return false;
 
         // found our node, remove it
+        preferred_.reset();
         count = std::min(count, loc->tipSupport);
         loc->tipSupport -= count;
 
@@ -673,101 +779,16 @@ public:
                              issued by this node.
         @return Pair with the sequence number and ID of the preferred ledger or
                 boost::none if no preferred ledger exists
+
+        @note The preferred ledger is asked for far more often than the
+              support changes, so the answer is kept until it does.
     */
     boost::optional<SpanTip<Ledger>>
     getPreferred(Seq const largestIssued) const
     {
-        if (empty())
-            return boost::none;
-
-        Node* curr = root.get();
-
-        bool done = false;
-
-        std::uint32_t uncommitted = 0;
-        auto uncommittedIt = seqSupport.begin();
-
-        while (curr && !done)
-        {
-            // Within a single span, the preferred by branch strategy is simply
-            // to continue along the span as long as the branch support of
-            // the next ledger exceeds the uncommitted support for that ledger.
-            {
-                // Add any initial uncommitted support prior for ledgers
-                // earlier than nextSeq or earlier than largestIssued
-                Seq nextSeq = curr->span.start() + Seq{1};
-                while (uncommittedIt != seqSupport.end() &&
-                       uncommittedIt->first < std::max(nextSeq, largestIssued))
-                {
-                    uncommitted += uncommittedIt->second;
-                    uncommittedIt++;
-                }
-
-                // Advance nextSeq along the span
-                while (nextSeq < curr->span.end() &&
-                       curr->branchSupport > uncommitted)
-                {
-                    // Jump to the next seqSupport change
-                    if (uncommittedIt != seqSupport.end() &&
-                        uncommittedIt->first < curr->span.end())
-                    {
-                        nextSeq = uncommittedIt->first + Seq{1};
-                        uncommitted += uncommittedIt->second;
-                        uncommittedIt++;
-                    }
-                    else  // otherwise we jump to the end of the span
-                        nextSeq = curr->span.end();
-                }
-                // We did not consume the entire span, so we have found the
-                // preferred ledger
-                if (nextSeq < curr->span.end())
-                    return curr->span.before(nextSeq)->tip();
-            }
-
-            // We have reached the end of the current span, so we need to
-            // find the best child
-            Node* best = nullptr;
-            std::uint32_t margin = 0;
-            if (curr->children.size() == 1)
-            {
-                best = curr->children[0].get();
-                margin = best->branchSupport;
-            }
-            else if (!curr->children.empty())
-            {
-                // Sort placing children with largest branch support in the
-                // front, breaking ties with the span's starting ID
-                std::partial_sort(
-                    curr->children.begin(),
-                    curr->children.begin() + 2,
-                    curr->children.end(),
-                    [](std::unique_ptr<Node> const& a,
-                       std::unique_ptr<Node> const& b) {
-                        return std::make_tuple(
-                                   a->branchSupport, a->span.startID()) >
-                            std::make_tuple(
-                                   b->branchSupport, b->span.startID());
-                    });
-
-                best = curr->children[0].get();
-                margin = curr->children[0]->branchSupport -
-                    curr->children[1]->branchSupport;
-
-                // If best holds the tie-breaker, gets one larger margin
-                // since the second best needs additional branchSupport
-                // to overcome the tie
-                if (best->span.startID() > curr->children[1]->span.startID())
-                    margin++;
-            }
-
-            // If the best child has margin exceeding the uncommitted support,
-            // continue from that child, otherwise we are done
-            if (best && ((margin > uncommitted) || (uncommitted == 0)))
-                curr = best;
-            else  // current is the best
-                done = true;
-        }
-        return curr->span.tip();
+        if (!preferred_ || preferred_->first != largestIssued)
+            preferred_.emplace(largestIssued, findPreferred(largestIssued));
+        return preferred_->second;
     }
 
     /** Return whether the trie is tracking any ledgers
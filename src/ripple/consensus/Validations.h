@@ -28,6 +28,8 @@
 #include <ripple/consensus/LedgerTrie.h>
 #include <ripple/protocol/PublicKey.h>
 #include <boost/optional.hpp>
+#include <algorithm>
+#include <deque>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -84,6 +86,15 @@ struct ValidationParms
      *  laggards are not considered offline.
      */
     std::chrono::seconds validationFRESHNESS = std::chrono::seconds{20};
+
+    /** Number of recent ledger sequences remembered for each trusted node.
+
+        For each of the last validationHISTORY_SIZE ledger sequences, the
+        ledger a trusted node fully validated is remembered until a newer
+        validation takes its place, so that reliability can be measured
+        without searching the stored validation sets.
+    */
+    std::size_t validationHISTORY_SIZE = 256;
 };
 
 /** Enforce validation increasing sequence requirement.
@@ -214,6 +225,10 @@ to_string(ValStatus m)
              private members of Validations but does not manage any data in the
              Adaptor instance itself.
 
+    The members are split between three mutexes, so that ingesting a
+    validation does not hold off queries that only need part of the state.
+    No two of them are ever held at once.
+
     @code
 
     // Conforms to the Ledger type requirements of LedgerTrie
@@ -294,9 +309,16 @@ class Validations
     using WrappedValidationType = std::decay_t<
         std::result_of_t<decltype (&Validation::unwrap)(Validation)>>;
 
-    // Manages concurrent access to members
+    // Manages concurrent access to the current validations, the trie and
+    // the ledgers being acquired for it
     mutable Mutex mutex_;
 
+    // Manages concurrent access to seqEnforcers_, bySequence_ and history_
+    mutable Mutex seqMutex_;
+
+    // Manages concurrent access to byLedger_ and toKeep_
+    mutable Mutex ledgerMutex_;
+
     // Validations from currently listed and trusted nodes (partial and full)
     hash_map<NodeID, Validation> current_;
 
@@ -304,9 +326,16 @@ class Validations
     SeqEnforcer<Seq> localSeqEnforcer_;
 
     // Sequence of the largest validation received from each node
+    // Managed by seqMutex_
     hash_map<NodeID, SeqEnforcer<Seq>> seqEnforcers_;
 
+    // The ledgers most recently fully validated by each trusted node, in
+    // increasing sequence order
+    // Managed by seqMutex_
+    hash_map<NodeID, std::deque<std::pair<Seq, ID>>> history_;
+
     //! Validations from listed nodes, indexed by ledger id (partial and full)
+    //! Managed by ledgerMutex_
     beast::aged_unordered_map<
         ID,
         hash_map<NodeID, Validation>,
@@ -315,6 +344,7 @@ class Validations
         byLedger_;
 
     // Partial and full validations indexed by sequence
+    // Managed by seqMutex_
     beast::aged_unordered_map<
         Seq,
         hash_map<NodeID, Validation>,
@@ -323,6 +353,7 @@ class Validations
         bySequence_;
 
     // Sequence of the earliest validation to keep from expire
+    // Managed by ledgerMutex_
     boost::optional<Seq> toKeep_;
 
     // Represents the ancestry of validated ledgers
@@ -339,7 +370,7 @@ class Validations
     ValidationParms const parms_;
 
     // Adaptor instance
-    // Is NOT managed by the mutex_ above
+    // Is NOT managed by the mutexes above
     Adaptor adaptor_;
 
 private:
@@ -524,7 +555,7 @@ private:
 
     /** Iterate the set of validations associated with a given ledger id
 
-        @param lock Existing lock on mutex_
+        @param lock Existing lock on ledgerMutex_
         @param ledgerID The identifier of the ledger
         @param pre Invokable with signature(std::size_t)
         @param f Invokable with signature (NodeID const &, Validation const &)
@@ -532,7 +563,7 @@ private:
         @note The invokable `pre` is called prior to iterating validations. The
               argument is the number of times `f` will be called.
         @warning The invokable f is expected to be a simple transformation of
-       its arguments and will be called with mutex_ under lock.
+       its arguments and will be called with ledgerMutex_ under lock.
     */
     template <class Pre, class F>
     void
@@ -588,6 +619,22 @@ public:
         return parms_;
     }
 
+    // Remember the ledger a trusted node fully validated
+    void
+    updateHistory(
+        std::lock_guard<Mutex> const&,
+        NodeID const& nodeID,
+        Validation const& val)
+    {
+        auto& history = history_[nodeID];
+        // A node's sequence may restart lower once its validations expire
+        while (!history.empty() && !(history.back().first < val.seq()))
+            history.pop_back();
+        history.emplace_back(val.seq(), val.ledgerID());
+        if (history.size() > parms_.validationHISTORY_SIZE)
+            history.pop_front();
+    }
+
     /** Return whether the local node can issue a validation for the given
        sequence number
 
@@ -617,12 +664,12 @@ public:
             return ValStatus::stale;
 
         {
-            std::lock_guard lock{mutex_};
+            std::lock_guard lock{seqMutex_};
 
             // Check that validation sequence is greater than any non-expired
             // validations sequence from that validator; if it's not, perform
             // additional work to detect Byzantine validations
-            auto const now = byLedger_.clock().now();
+            auto const now = bySequence_.clock().now();
 
             auto const [seqit, seqinserted] =
                 bySequence_[val.seq()].emplace(nodeID, val);
@@ -663,7 +710,17 @@ public:
                 return ValStatus::badSeq;
             }
 
+            if (val.trusted() && val.full())
+                updateHistory(lock, nodeID, val);
+        }
+
+        {
+            std::lock_guard lock{ledgerMutex_};
             byLedger_[val.ledgerID()].insert_or_assign(nodeID, val);
+        }
+
+        {
+            std::lock_guard lock{mutex_};
 
             auto const [it, inserted] = current_.emplace(nodeID, val);
             if (!inserted)
@@ -696,7 +753,7 @@ public:
     void
     setSeqToKeep(Seq const& s)
     {
-        std::lock_guard lock{mutex_};
+        std::lock_guard lock{ledgerMutex_};
         toKeep_ = s;
     }
 
@@ -708,29 +765,38 @@ public:
     void
     expire()
     {
-        std::lock_guard lock{mutex_};
-        if (toKeep_)
+        boost::optional<Seq> toKeep;
         {
-            for (auto i = byLedger_.begin(); i != byLedger_.end(); ++i)
+            std::lock_guard lock{ledgerMutex_};
+            toKeep = toKeep_;
+            if (toKeep)
             {
-                auto const& validationMap = i->second;
-                if (!validationMap.empty() &&
-                    validationMap.begin()->second.seq() >= toKeep_)
+                for (auto i = byLedger_.begin(); i != byLedger_.end(); ++i)
                 {
-                    byLedger_.touch(i);
+                    auto const& validationMap = i->second;
+                    if (!validationMap.empty() &&
+                        validationMap.begin()->second.seq() >= toKeep)
+                    {
+                        byLedger_.touch(i);
+                    }
                 }
             }
 
+            beast::expire(byLedger_, parms_.validationSET_EXPIRES);
+        }
+
+        std::lock_guard lock{seqMutex_};
+        if (toKeep)
+        {
             for (auto i = bySequence_.begin(); i != bySequence_.end(); ++i)
             {
-                if (i->first >= toKeep_)
+                if (i->first >= toKeep)
                 {
                     bySequence_.touch(i);
                 }
             }
         }
 
-        beast::expire(byLedger_, parms_.validationSET_EXPIRES);
         beast::expire(bySequence_, parms_.validationSET_EXPIRES);
     }
 
@@ -746,22 +812,50 @@ public:
     void
     trustChanged(hash_set<NodeID> const& added, hash_set<NodeID> const& removed)
     {
-        std::lock_guard lock{mutex_};
-
-        for (auto& [nodeId, validation] : current_)
         {
-            if (added.find(nodeId) != added.end())
+            std::lock_guard lock{mutex_};
+
+            for (auto& [nodeId, validation] : current_)
             {
-                validation.setTrusted();
-                updateTrie(lock, nodeId, validation, boost::none);
+                if (added.find(nodeId) != added.end())
+                {
+                    validation.setTrusted();
+                    updateTrie(lock, nodeId, validation, boost::none);
+                }
+                else if (removed.find(nodeId) != removed.end())
+                {
+                    validation.setUntrusted();
+                    removeTrie(lock, nodeId, validation);
+                }
             }
-            else if (removed.find(nodeId) != removed.end())
+        }
+
+        {
+            std::lock_guard lock{seqMutex_};
+            for (auto const& nodeId : removed)
+                history_.erase(nodeId);
+
+            // Rebuild the history of newly trusted nodes from the
+            // validations already received, oldest first
+            std::vector<std::pair<NodeID, Validation>> known;
+            for (auto const& [_, validationMap] : bySequence_)
             {
-                validation.setUntrusted();
-                removeTrie(lock, nodeId, validation);
+                (void)_;
+                for (auto const& [nodeId, validation] : validationMap)
+                {
+                    if (added.find(nodeId) != added.end() && validation.full())
+                        known.emplace_back(nodeId, validation);
+                }
             }
+            std::sort(
+                known.begin(), known.end(), [](auto const& a, auto const& b) {
+                    return a.second.seq() < b.second.seq();
+                });
+            for (auto const& [nodeId, validation] : known)
+                updateHistory(lock, nodeId, validation);
         }
 
+        std::lock_guard lock{ledgerMutex_};
         for (auto& [_, validationMap] : byLedger_)
         {
             (void)_;
@@ -989,7 +1083,7 @@ public:
     numTrustedForLedger(ID const& ledgerID)
     {
         std::size_t count = 0;
-        std::lock_guard lock{mutex_};
+        std::lock_guard lock{ledgerMutex_};
         byLedger(
             lock,
             ledgerID,
@@ -1010,7 +1104,7 @@ public:
     getTrustedForLedger(ID const& ledgerID)
     {
         std::vector<WrappedValidationType> res;
-        std::lock_guard lock{mutex_};
+        std::lock_guard lock{ledgerMutex_};
         byLedger(
             lock,
             ledgerID,
@@ -1023,6 +1117,48 @@ public:
         return res;
     }
 
+    /** Count the ledgers of a chain that each trusted node fully validated
+
+        Served from the per-node history kept as validations arrive, so the
+        cost does not depend on how many validations are stored.
+
+        @param seq The sequence number of the last ledger of the chain
+        @param chain The IDs of consecutive ledgers ending with the one with
+                     sequence seq. At most the last validationHISTORY_SIZE
+                     are considered.
+        @return The number of ledgers of the chain validated by each trusted
+                node with a history
+    */
+    hash_map<NodeID, std::uint32_t>
+    getTrustedValidatedCounts(Seq const& seq, std::vector<ID> const& chain)
+    {
+        auto const n =
+            std::min(chain.size(), parms_.validationHISTORY_SIZE);
+
+        hash_map<NodeID, std::uint32_t> res;
+        std::lock_guard lock{seqMutex_};
+        res.reserve(history_.size());
+        for (auto const& [nodeId, history] : history_)
+        {
+            // Walk the chain and the history back from their ends together
+            std::uint32_t count = 0;
+            auto it = history.rbegin();
+            Seq s = seq;
+            for (std::size_t i = 0; i < n && s != Seq{0}; ++i, --s)
+            {
+                while (it != history.rend() && s < it->first)
+                    ++it;
+                if (it == history.rend())
+                    break;
+                if (it->first == s &&
+                    it->second == chain[chain.size() - 1 - i])
+                    ++count;
+            }
+            res.emplace(nodeId, count);
+        }
+        return res;
+    }
+
     /** Returns fees reported by trusted full validators in the given ledger
 
         @param ledgerID The identifier of ledger of interest
@@ -1033,7 +1169,7 @@ public:
     fees(ID const& ledgerID, std::uint32_t baseFee)
     {
         std::vector<std::uint32_t> res;
-        std::lock_guard lock{mutex_};
+        std::lock_guard lock{ledgerMutex_};
         byLedger(
             lock,
             ledgerID,
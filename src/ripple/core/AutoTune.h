@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_AUTOTUNE_H_INCLUDED
+#define RIPPLE_CORE_AUTOTUNE_H_INCLUDED
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <cstdint>
+
+namespace ripple {
+
+/** What start up measured about the host, for node_size=auto. */
+struct HostResources
+{
+    // Hardware threads, or zero if unknown
+    unsigned cores = 0;
+    // Physical memory in bytes, or zero if unknown
+    std::uint64_t memory = 0;
+    // Mean time of one random read of a node store file, and the reads a
+    // second that gives one at a time, if a file could be measured
+    boost::optional<std::chrono::microseconds> readLatency;
+    double readIops = 0;
+};
+
+/** Measure the cores and memory of the host, and the read latency of the
+    largest file in the node store directory.
+
+    Reads bypass the page cache where the file system allows it, so they
+    measure the device. A new node store has nothing to measure.
+*/
+HostResources
+probeHost(boost::filesystem::path const& nodeStorePath);
+
+/** The sizes node_size=auto picks. */
+struct AutoTuning
+{
+    // Index into the node_size tables, "tiny" to "huge"
+    std::size_t nodeSize = 0;
+    // JobQueue worker threads
+    int workers = 0;
+    // Node store read threads
+    int readThreads = 0;
+    // Default and greatest path search levels
+    int pathSearch = 0;
+    int pathSearchMax = 0;
+};
+
+/** Choose sizes for the host.
+
+    The node size follows physical memory, capped on hosts with few cores.
+    A slow disk makes jobs wait on reads, so it gets more workers and more
+    read threads, while a fast one needs few read threads. Small nodes
+    search shorter payment paths.
+*/
+AutoTuning
+autoTune(HostResources const& host);
+
+}  // namespace ripple
+
+#endif
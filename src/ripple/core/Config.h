@@ -25,6 +25,7 @@
 #include <ripple/basics/base_uint.h>
 #include <ripple/beast/net/IPEndpoint.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/core/AutoTune.h>
 #include <ripple/protocol/SystemParameters.h>  // VFALCO Breaks levelization
 #include <boost/beast/core/string.hpp>
 #include <boost/filesystem.hpp>  // VFALCO FIX: This include should not be here
@@ -119,8 +120,16 @@ private:
 public:
     bool doImport = false;
     bool nodeToShard = false;
+    // With a replay start up, the number of consecutive ledgers to replay
+    // from the node store and verify before exiting
+    std::uint32_t replayRange = 0;
+    // The number of most recent ledgers whose nodes compaction keeps
+    std::uint32_t compactRange = 0;
     bool ELB_SUPPORT = false;
 
+    // Whether validated transactions are indexed in the node store
+    bool TX_INDEX = false;
+
     std::vector<std::string> IPS;           // Peer IPs from rippled.cfg.
     std::vector<std::string> IPS_FIXED;     // Fixed Peer IPs from rippled.cfg.
     std::vector<std::string> SNTP_SERVERS;  // SNTP servers from rippled.cfg.
@@ -164,6 +173,21 @@ public:
     int PATH_SEARCH_FAST = 2;
     int PATH_SEARCH_MAX = 10;
 
+    // Threads evaluating the strands of a payment, if more than one
+    std::size_t FLOW_THREADS = 0;
+
+    // Threads shared by work split across cores, besides the callers. If
+    // not set, one fewer than the cores.
+    boost::optional<std::size_t> PARALLEL_THREADS;
+
+    // Check the invariants of one in this many transactions replayed from
+    // validated ledgers, if not a validator
+    std::size_t REPLAY_INVARIANT_SAMPLE = 1;
+
+    // Write the nodes of a ledger built by consensus while the next round
+    // starts, instead of before it
+    bool PIPELINED_CLOSE = false;
+
     // Validation
     boost::optional<std::size_t>
         VALIDATION_QUORUM;  // validations to consider ledger authoritative
@@ -177,6 +201,17 @@ public:
     std::uint32_t FETCH_DEPTH = 1000000000;
 
     std::size_t NODE_SIZE = 0;
+    // Whether node_size is "auto", sized from the host at start up, and
+    // what was measured of the host to size it
+    bool NODE_SIZE_AUTO = false;
+    HostResources HOST_RESOURCES;
+
+    // Threads reading the node store ahead of need
+    int NODESTORE_READ_THREADS = 4;
+
+    // Resident memory the caches are shrunk to stay within, in megabytes.
+    // Zero means three quarters of physical memory.
+    std::size_t MEMORY_BUDGET = 0;
 
     bool SSL_VERIFY = true;
     std::string SSL_VERIFY_FILE;
@@ -184,9 +219,26 @@ public:
 
     // Compression
     bool COMPRESSION = false;
+    // Compress peer links as a stream, requires COMPRESSION
+    bool STREAM_COMPRESSION = false;
 
     // Enable the experimental Ledger Replay functionality
     bool LEDGER_REPLAY = false;
+    // Ledger deltas a replay task acquires at the same time
+    std::size_t LEDGER_REPLAY_WINDOW = 32;
+    // Historical ledgers acquired at the same time, 0 to size by node_size
+    std::uint32_t HISTORY_BACKFILL_WINDOW = 0;
+
+    // Threads applying consensus transactions when building a ledger
+    std::size_t LEDGER_APPLY_THREADS = 1;
+    // Reconcile disputed transaction sets against our own with peers
+    bool TX_RECONCILE = false;
+    // Relay proposals, validations and transactions to peers in batches
+    // when they queue up behind a write, see TMRelayBatch and TMTransactions
+    bool RELAY_BATCH = false;
+    // Fetch the state of the first ledger acquired in leaf batches, see
+    // TMGetStateRange
+    bool STATE_TRANSFER = false;
 
     // Work queue limits
     int MAX_TRANSACTIONS = 250;
@@ -198,6 +250,8 @@ public:
 
     // Thread pool configuration
     std::size_t WORKERS = 0;
+    // Whether node_size=auto chose WORKERS, which then follows the load
+    bool WORKERS_AUTO = false;
 
     // Reduce-relay - these parameters are experimental.
     // Enable reduce-relay features
@@ -212,6 +266,12 @@ public:
     // Set log level to debug so that the feature function can be
     // analyzed.
     bool VP_REDUCE_RELAY_SQUELCH = false;
+    // Transaction reduce-relay feature: relay transactions received from
+    // peers to a random TX_RELAY_PERCENTAGE of the other peers, but to at
+    // least reduce_relay::MIN_TX_RELAY_PEERS of them. Transactions submitted
+    // to this server are always sent to every peer.
+    bool TX_REDUCE_RELAY_ENABLE = false;
+    std::size_t TX_RELAY_PERCENTAGE = 25;
 
     // These override the command line client settings
     boost::optional<beast::IP::Endpoint> rpc_ip;
@@ -278,6 +338,12 @@ public:
         return USE_TX_TABLES;
     }
 
+    bool
+    txIndex() const
+    {
+        return TX_INDEX && !RUN_REPORTING;
+    }
+
     bool
     reportingReadOnly() const
     {
@@ -44,6 +44,11 @@ struct ConfigSection
     {
         return "import_db";
     }
+    static std::string
+    compactNodeDatabase()
+    {
+        return "compact_db";
+    }
 };
 
 // VFALCO TODO Rename and replace these macros with variables.
@@ -57,16 +62,22 @@ struct ConfigSection
 #define SECTION_FEE_ACCOUNT_RESERVE "fee_account_reserve"
 #define SECTION_FEE_OWNER_RESERVE "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH "fetch_depth"
+#define SECTION_FLOW_THREADS "flow_threads"
 #define SECTION_HISTORICAL_SHARD_PATHS "historical_shard_paths"
 #define SECTION_INSIGHT "insight"
 #define SECTION_IPS "ips"
 #define SECTION_IPS_FIXED "ips_fixed"
+#define SECTION_LEDGER_APPLY_THREADS "ledger_apply_threads"
+#define SECTION_LEDGER_CLEANER "ledger_cleaner"
 #define SECTION_LEDGER_HISTORY "ledger_history"
+#define SECTION_LOG_QUEUE "log_queue"
 #define SECTION_MAX_TRANSACTIONS "max_transactions"
+#define SECTION_MEMORY_BUDGET "memory_budget"
 #define SECTION_NETWORK_QUORUM "network_quorum"
 #define SECTION_NODE_SEED "node_seed"
 #define SECTION_NODE_SIZE "node_size"
 #define SECTION_OVERLAY "overlay"
+#define SECTION_PARALLEL_THREADS "parallel_threads"
 #define SECTION_PATH_SEARCH_OLD "path_search_old"
 #define SECTION_PATH_SEARCH "path_search"
 #define SECTION_PATH_SEARCH_FAST "path_search_fast"
@@ -75,15 +86,19 @@ struct ConfigSection
 #define SECTION_PEERS_MAX "peers_max"
 #define SECTION_PEERS_IN_MAX "peers_in_max"
 #define SECTION_PEERS_OUT_MAX "peers_out_max"
+#define SECTION_PIPELINED_CLOSE "pipelined_close"
 #define SECTION_REDUCE_RELAY "reduce_relay"
 #define SECTION_RELAY_PROPOSALS "relay_proposals"
 #define SECTION_RELAY_VALIDATIONS "relay_validations"
+#define SECTION_REPLAY_INVARIANT_SAMPLE "replay_invariant_sample"
 #define SECTION_RPC_STARTUP "rpc_startup"
 #define SECTION_SIGNING_SUPPORT "signing_support"
 #define SECTION_SNTP "sntp_servers"
 #define SECTION_SSL_VERIFY "ssl_verify"
 #define SECTION_SSL_VERIFY_FILE "ssl_verify_file"
 #define SECTION_SSL_VERIFY_DIR "ssl_verify_dir"
+#define SECTION_STATE_SNAPSHOT "state_snapshot"
+#define SECTION_STREAM_COMPRESSION "stream_compression"
 #define SECTION_SERVER_DOMAIN "server_domain"
 #define SECTION_VALIDATORS_FILE "validators_file"
 #define SECTION_VALIDATION_SEED "validation_seed"
@@ -97,6 +112,11 @@ struct ConfigSection
 #define SECTION_VETO_AMENDMENTS "veto_amendments"
 #define SECTION_WORKERS "workers"
 #define SECTION_LEDGER_REPLAY "ledger_replay"
+#define SECTION_LEDGER_REPLAY_WINDOW "ledger_replay_window"
+#define SECTION_HISTORY_BACKFILL_WINDOW "history_backfill_window"
+#define SECTION_TX_RECONCILE "tx_reconcile"
+#define SECTION_RELAY_BATCH "relay_batch"
+#define SECTION_STATE_TRANSFER "state_transfer"
 
 }  // namespace ripple
 
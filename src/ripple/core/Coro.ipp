@@ -46,7 +46,8 @@ JobQueue::Coro::Coro(
               finished_ = true;
 #endif
           },
-          boost::coroutines::attributes(megabytes(1)))
+          boost::coroutines::attributes(jq.coroStacks_.stackSize()),
+          CoroStackPool::Allocator(jq.coroStacks_))
 {
 }
 
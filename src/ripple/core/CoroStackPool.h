@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_COROSTACKPOOL_H_INCLUDED
+#define RIPPLE_CORE_COROSTACKPOOL_H_INCLUDED
+
+#include <boost/coroutine/stack_context.hpp>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Coroutine stacks that are kept for reuse once their coroutine ends.
+
+    Allocating a stack for every coroutine maps fresh memory, and each page
+    the coroutine touches then faults in. A stack taken from the pool has
+    been used before, so neither happens again. Stacks of other sizes, and
+    stacks freed while `maxIdle` are already kept, go back to the system.
+*/
+class CoroStackPool
+{
+public:
+    CoroStackPool(std::size_t stackSize, std::size_t maxIdle);
+
+    CoroStackPool(CoroStackPool const&) = delete;
+    CoroStackPool&
+    operator=(CoroStackPool const&) = delete;
+
+    ~CoroStackPool();
+
+    /** The size of the stacks that are pooled. */
+    std::size_t
+    stackSize() const
+    {
+        return stackSize_;
+    }
+
+    /** The number of stacks waiting to be reused. */
+    std::size_t
+    idle() const;
+
+    /** A boost.coroutine StackAllocator drawing from a pool. */
+    class Allocator
+    {
+    public:
+        explicit Allocator(CoroStackPool& pool) : pool_(&pool)
+        {
+        }
+
+        void
+        allocate(boost::coroutines::stack_context& ctx, std::size_t size);
+
+        void
+        deallocate(boost::coroutines::stack_context& ctx);
+
+    private:
+        CoroStackPool* pool_;
+    };
+
+private:
+    std::size_t const stackSize_;
+    std::size_t const maxIdle_;
+
+    mutable std::mutex mutex_;
+
+    // The lowest address of each idle stack
+    std::vector<void*> idle_;
+};
+
+}  // namespace ripple
+
+#endif
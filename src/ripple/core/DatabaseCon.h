@@ -25,6 +25,9 @@
 #include <ripple/core/SociDB.h>
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -48,6 +51,12 @@ public:
         : session_(std::move(it)), lock_(m)
     {
     }
+    LockedSociSession(
+        std::shared_ptr<soci::session> it,
+        std::unique_lock<mutex>&& lock)
+        : session_(std::move(it)), lock_(std::move(lock))
+    {
+    }
     LockedSociSession(LockedSociSession&& rhs) noexcept
         : session_(std::move(rhs.session_)), lock_(std::move(rhs.lock_))
     {
@@ -92,6 +101,9 @@ public:
         // Indicates whether or not to return the `globalPragma`
         // from commonPragma()
         bool useGlobalPragma = false;
+        // The number of read only connections opened alongside the
+        // writer. Zero sends every query to the writer.
+        std::size_t readConnections = 0;
 
         std::vector<std::string> const*
         commonPragma() const
@@ -106,7 +118,6 @@ public:
 
     struct CheckpointerSetup
     {
-        JobQueue* jobQueue;
         Logs* logs;
     };
 
@@ -126,7 +137,14 @@ public:
                   : (setup.dataDir / dbName),
               setup.commonPragma(),
               pragma,
-              initSQL)
+              initSQL,
+              // Temporary databases are private to their connection
+              setup.standAlone && !setup.reporting &&
+                      setup.startUp != Config::LOAD &&
+                      setup.startUp != Config::LOAD_FILE &&
+                      setup.startUp != Config::REPLAY
+                  ? 0
+                  : setup.readConnections)
     {
     }
 
@@ -140,7 +158,7 @@ public:
         CheckpointerSetup const& checkpointerSetup)
         : DatabaseCon(setup, dbName, pragma, initSQL)
     {
-        setupCheckpointing(checkpointerSetup.jobQueue, *checkpointerSetup.logs);
+        setupCheckpointing(*checkpointerSetup.logs);
     }
 
     template <std::size_t N, std::size_t M>
@@ -149,7 +167,7 @@ public:
         std::string const& dbName,
         std::array<char const*, N> const& pragma,
         std::array<char const*, M> const& initSQL)
-        : DatabaseCon(dataDir / dbName, nullptr, pragma, initSQL)
+        : DatabaseCon(dataDir / dbName, nullptr, pragma, initSQL, 0)
     {
     }
 
@@ -163,7 +181,7 @@ public:
         CheckpointerSetup const& checkpointerSetup)
         : DatabaseCon(dataDir, dbName, pragma, initSQL)
     {
-        setupCheckpointing(checkpointerSetup.jobQueue, *checkpointerSetup.logs);
+        setupCheckpointing(*checkpointerSetup.logs);
     }
 
     ~DatabaseCon();
@@ -180,16 +198,41 @@ public:
         return LockedSociSession(session_, lock_);
     }
 
+    /** Check out a connection for queries that only read.
+
+        Readers run concurrently with each other and with the writer, so
+        history lookups from many clients don't queue behind one another.
+        Returns the writer's session if no read connections were opened.
+    */
+    LockedSociSession
+    checkoutReadDb();
+
+    /** Run a function on the writer's session and on every reader's.
+
+        Each session is checked out while the function runs on it, and
+        readers accept changes to temporary objects meanwhile, so the
+        function can attach databases or create temporary views on every
+        connection. The writer's session is checked out first and held
+        until the function has run on all of them.
+    */
+    void
+    forEachSession(std::function<void(soci::session&)> const& f);
+
+    /** What the write ahead log checkpointer has done, if there is one. */
+    boost::optional<Checkpointer::Stats>
+    checkpointStats() const;
+
 private:
     void
-    setupCheckpointing(JobQueue*, Logs&);
+    setupCheckpointing(Logs&);
 
     template <std::size_t N, std::size_t M>
     DatabaseCon(
         boost::filesystem::path const& pPath,
         std::vector<std::string> const* commonPragma,
         std::array<char const*, N> const& pragma,
-        std::array<char const*, M> const& initSQL)
+        std::array<char const*, M> const& initSQL,
+        std::size_t readConnections)
         : session_(std::make_shared<soci::session>())
     {
         open(*session_, "sqlite", pPath.string());
@@ -212,18 +255,50 @@ private:
             soci::statement st = session_->prepare << sql;
             st.execute(true);
         }
+
+        // The schema exists now, so readers only need the pragmas
+        for (std::size_t i = 0; i < readConnections; ++i)
+        {
+            auto reader = std::make_unique<Reader>();
+            open(*reader->session, "sqlite", pPath.string());
+            if (commonPragma)
+            {
+                for (auto const& p : *commonPragma)
+                {
+                    soci::statement st = reader->session->prepare << p;
+                    st.execute(true);
+                }
+            }
+            for (auto const& p : pragma)
+            {
+                soci::statement st = reader->session->prepare << p;
+                st.execute(true);
+            }
+            *reader->session << "PRAGMA query_only=1;";
+            readers_.push_back(std::move(reader));
+        }
     }
 
+    struct Reader
+    {
+        std::shared_ptr<soci::session> const session =
+            std::make_shared<soci::session>();
+        LockedSociSession::mutex lock;
+    };
+
     LockedSociSession::mutex lock_;
 
-    // checkpointer may outlive the DatabaseCon when the checkpointer jobQueue
-    // callback locks a weak pointer and the DatabaseCon is then destroyed. In
+    // checkpointer may outlive the DatabaseCon when the checkpoint thread
+    // locks a weak pointer and the DatabaseCon is then destroyed. In
     // this case, the checkpointer needs to make sure it doesn't use an already
     // destroyed session. Thus this class keeps a shared_ptr to the session (so
     // the checkpointer can keep a weak_ptr) and the checkpointer is a
     // shared_ptr in this class. session_ will never be null.
     std::shared_ptr<soci::session> const session_;
     std::shared_ptr<Checkpointer> checkpointer_;
+
+    std::vector<std::unique_ptr<Reader>> readers_;
+    std::atomic<std::size_t> nextReader_{0};
 };
 
 // Return the checkpointer from its id. If the checkpointer no longer exists, an
@@ -236,6 +311,12 @@ setup_DatabaseCon(
     Config const& c,
     boost::optional<beast::Journal> j = boost::none);
 
+/** Returns the number of read connections to open for the transaction
+    and ledger databases.
+*/
+std::size_t
+readConnections_DatabaseCon(Config const& c);
+
 }  // namespace ripple
 
 #endif
@@ -46,7 +46,9 @@ enum JobType {
     jtLEDGER_REQ,     // Peer request ledger/txnset data
     jtPROPOSAL_ut,    // A proposal from an untrusted source
     jtREPLAY_TASK,    // A Ledger replay task/subtask
+    jtPEER_DECODE,    // Parse a large message received from a peer
     jtLEDGER_DATA,    // Received data for a ledger we're acquiring
+    jtPUBLISH,        // Deliver stream messages to subscribers
     jtCLIENT,         // A websocket command from the client
     jtRPC,            // A websocket command from the client
     jtUPDATE_PF,      // Update pathfinding requests
@@ -55,7 +57,6 @@ enum JobType {
     jtADVANCE,        // Advance validated/acquired ledgers
     jtPUBLEDGER,      // Publish a fully-accepted ledger
     jtTXN_DATA,       // Fetch a proposed set
-    jtWAL,            // Write-ahead logging
     jtVALIDATION_t,   // A validation from a trusted source
     jtWRITE,          // Write out hashed objects
     jtACCEPT,         // Accept a consensus ledger
@@ -21,6 +21,7 @@
 #define RIPPLE_CORE_JOBQUEUE_H_INCLUDED
 
 #include <ripple/basics/LocalValue.h>
+#include <ripple/core/CoroStackPool.h>
 #include <ripple/core/JobTypeData.h>
 #include <ripple/core/JobTypes.h>
 #include <ripple/core/Stoppable.h>
@@ -29,11 +30,14 @@
 #include <boost/coroutine/all.hpp>
 #include <boost/range/begin.hpp>  // workaround for boost 1.72 bug
 #include <boost/range/end.hpp>    // workaround for boost 1.72 bug
+#include <atomic>
+#include <vector>
 
 namespace ripple {
 
 namespace perf {
 class PerfLog;
+class Tracer;
 }
 
 class Logs;
@@ -145,7 +149,8 @@ public:
         Stoppable& parent,
         beast::Journal journal,
         Logs& logs,
-        perf::PerfLog& perfLog);
+        perf::PerfLog& perfLog,
+        perf::Tracer& tracer);
     ~JobQueue();
 
     /** Adds a job to the JobQueue.
@@ -201,6 +206,15 @@ public:
     int
     getJobCountGE(JobType t) const;
 
+    /** Returns `true` if the oldest waiting job of this type has waited
+        past the type's average latency target.
+
+        Callers that add optional work of this type can use this to turn
+        it away while the queue is behind.
+    */
+    bool
+    isBacklogged(JobType t) const;
+
     /** Set the number of thread serving the job queue to precisely this number.
      */
     void
@@ -234,12 +248,21 @@ private:
     using JobDataMap = std::map<JobType, JobTypeData>;
 
     beast::Journal m_journal;
+
+    // Declared early so that it outlives every coroutine
+    CoroStackPool coroStacks_;
+
     mutable std::mutex m_mutex;
-    std::uint64_t m_lastJob;
-    std::set<Job> m_jobSet;
+    std::atomic<std::uint64_t> m_lastJob;
     JobDataMap m_jobData;
     JobTypeData m_invalidJobData;
 
+    // Every job type, in the order their waiting jobs are run
+    std::vector<JobTypeData*> m_priorities;
+
+    // The number of jobs waiting across all job types
+    std::size_t m_jobCount = 0;
+
     // The number of jobs currently in processTask()
     int m_processCount;
 
@@ -251,6 +274,7 @@ private:
 
     // Statistics tracking
     perf::PerfLog& perfLog_;
+    perf::Tracer& tracer_;
     beast::insight::Collector::ptr m_collector;
     beast::insight::Gauge job_count;
     beast::insight::Hook hook;
@@ -283,14 +307,14 @@ private:
         std::string const& name,
         JobFunction const& func);
 
-    // Signals an added Job for processing.
+    // Adds a Job to the queue for its type and signals it for processing.
     //
     // Pre-conditions:
     //  The JobType must be valid.
-    //  The Job must exist in mJobSet.
     //  The Job must not have previously been queued.
     //
     // Post-conditions:
+    //  The Job is at the back of the queue for its type.
     //  Count of waiting jobs of that type will be incremented.
     //  If JobQueue exists, and has at least one thread, Job will eventually
     //  run.
@@ -298,20 +322,23 @@ private:
     // Invariants:
     //  The calling thread owns the JobLock
     void
-    queueJob(Job const& job, std::lock_guard<std::mutex> const& lock);
+    queueJob(Job&& job, std::lock_guard<std::mutex> const& lock);
 
     // Returns the next Job we should run now.
     //
     // RunnableJob:
-    //  A Job in the JobSet whose slots count for its type is greater than zero.
+    //  The oldest waiting Job of a type running fewer jobs than its limit.
+    //  Types are tried from the highest priority down, except that a type
+    //  whose oldest Job has waited past its average latency target is
+    //  taken first.
     //
     // Pre-conditions:
-    //  mJobSet must not be empty.
-    //  mJobSet holds at least one RunnableJob
+    //  At least one Job is waiting.
+    //  At least one RunnableJob is waiting.
     //
     // Post-conditions:
     //  job is a valid Job object.
-    //  job is removed from mJobQueue.
+    //  job is removed from the queue for its type.
     //  Waiting job count of its type is decremented
     //  Running job count of its type is incremented
     //
@@ -323,7 +350,7 @@ private:
     // Indicates that a running Job has completed its task.
     //
     // Pre-conditions:
-    //  Job must not exist in mJobSet.
+    //  Job must no longer be waiting.
     //  The JobType must not be invalid.
     //
     // Post-conditions:
@@ -339,7 +366,7 @@ private:
     // Runs the next appropriate waiting Job.
     //
     // Pre-conditions:
-    //  A RunnableJob must exist in the JobSet
+    //  A RunnableJob must be waiting
     //
     // Post-conditions:
     //  The chosen RunnableJob will have Job::doJob() called.
@@ -349,12 +376,6 @@ private:
     void
     processTask(int instance) override;
 
-    // Returns the limit of running jobs for the given job type.
-    // For jobs with no limit, we return the largest int. Hopefully that
-    // will be enough.
-    int
-    getJobLimit(JobType type);
-
     void
     onChildrenStopped() override;
 };
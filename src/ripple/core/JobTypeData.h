@@ -22,7 +22,9 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/beast/insight/Collector.h>
+#include <ripple/core/Job.h>
 #include <ripple/core/JobTypeInfo.h>
+#include <deque>
 
 namespace ripple {
 
@@ -47,10 +49,17 @@ public:
     /* And the number we deferred executing because of job limits */
     int deferred;
 
+    /* The waiting jobs of this type, oldest first */
+    std::deque<Job> jobs;
+
     /* Notification callbacks */
     beast::insight::Event dequeue;
     beast::insight::Event execute;
 
+    /* How long jobs waited in the queue, and then ran */
+    beast::insight::Histogram waitTimes;
+    beast::insight::Histogram runTimes;
+
     JobTypeData(
         JobTypeInfo const& info_,
         beast::insight::Collector::ptr const& collector,
@@ -69,6 +78,8 @@ public:
         {
             dequeue = m_collector->make_event(info.name() + "_q");
             execute = m_collector->make_event(info.name());
+            waitTimes = m_collector->make_histogram(info.name() + "_wait");
+            runTimes = m_collector->make_histogram(info.name() + "_run");
         }
     }
 
@@ -61,7 +61,9 @@ private:
         add(jtLEDGER_REQ, "ledgerRequest", 2, false, 0ms, 0ms);
         add(jtPROPOSAL_ut, "untrustedProposal", maxLimit, false, 500ms, 1250ms);
         add(jtREPLAY_TASK, "ledgerReplayTask", maxLimit, false, 0ms, 0ms);
+        add(jtPEER_DECODE, "peerDecode", maxLimit, false, 0ms, 0ms);
         add(jtLEDGER_DATA, "ledgerData", 2, false, 0ms, 0ms);
+        add(jtPUBLISH, "publishStream", maxLimit, false, 0ms, 0ms);
         add(jtCLIENT, "clientCommand", maxLimit, false, 2000ms, 5000ms);
         add(jtRPC, "RPC", maxLimit, false, 0ms, 0ms);
         add(jtUPDATE_PF, "updatePaths", maxLimit, false, 0ms, 0ms);
@@ -70,7 +72,6 @@ private:
         add(jtADVANCE, "advanceLedger", maxLimit, false, 0ms, 0ms);
         add(jtPUBLEDGER, "publishNewLedger", maxLimit, false, 3000ms, 4500ms);
         add(jtTXN_DATA, "fetchTxnData", 1, false, 0ms, 0ms);
-        add(jtWAL, "writeAhead", maxLimit, false, 1000ms, 2500ms);
         add(jtVALIDATION_t,
             "trustedValidation",
             maxLimit,
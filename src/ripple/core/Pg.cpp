@@ -90,7 +90,8 @@ Pg::connect()
         // Nothing to do if we already have a good connection.
         if (PQstatus(conn_.get()) == CONNECTION_OK)
             return;
-        /* Try resetting connection. */
+        /* Try resetting connection. Statements prepared on it are lost. */
+        prepared_.clear();
         PQreset(conn_.get());
     }
     else  // Make new connection.
@@ -136,16 +137,33 @@ Pg::query(char const* command, std::size_t nParams, char const* const* values)
             connect();
             if (nParams)
             {
-                // PQexecParams can process only a single command.
-                ret.reset(PQexecParams(
-                    conn_.get(),
-                    command,
-                    nParams,
-                    nullptr,
-                    values,
-                    nullptr,
-                    nullptr,
-                    0));
+                // A command with parameters is run as a prepared statement,
+                // so the server parses and plans it once per connection.
+                // A failed preparation is reported as the query's result
+                if (auto const name = prepare(command, nParams, ret))
+                {
+                    ret.reset(PQexecPrepared(
+                        conn_.get(),
+                        name->c_str(),
+                        nParams,
+                        values,
+                        nullptr,
+                        nullptr,
+                        0));
+                }
+                else if (!ret)
+                {
+                    // PQexecParams can process only a single command.
+                    ret.reset(PQexecParams(
+                        conn_.get(),
+                        command,
+                        nParams,
+                        nullptr,
+                        values,
+                        nullptr,
+                        nullptr,
+                        0));
+                }
             }
             else
             {
@@ -192,6 +210,27 @@ Pg::query(char const* command, std::size_t nParams, char const* const* values)
     return PgResult(std::move(ret));
 }
 
+std::string const*
+Pg::prepare(char const* command, std::size_t nParams, pg_result_type& failed)
+{
+    if (auto const it = prepared_.find(command); it != prepared_.end())
+        return &it->second;
+    if (prepared_.size() >= maxPrepared)
+        return nullptr;
+
+    auto name = "rippled_" + std::to_string(prepared_.size());
+    failed.reset(
+        PQprepare(conn_.get(), name.c_str(), command, nParams, nullptr));
+    if (!failed)
+        Throw<std::runtime_error>("no result structure returned");
+    if (PQresultStatus(failed.get()) != PGRES_COMMAND_OK)
+        return nullptr;
+
+    failed.reset();
+    JLOG(j_.debug()) << "prepared statement " << name << ": " << command;
+    return &prepared_.emplace(command, std::move(name)).first->second;
+}
+
 static pg_formatted_params
 formatParams(pg_params const& dbParams, beast::Journal const& j)
 {
@@ -238,13 +277,140 @@ Pg::query(pg_params const& dbParams)
             : nullptr);
 }
 
+std::vector<PgResult>
+Pg::pipeline(std::vector<pg_params> const& queries)
+{
+    std::vector<PgResult> results;
+#ifdef LIBPQ_HAS_PIPELINING
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_)
+            return results;
+    }
+
+    std::vector<pg_formatted_params> params;
+    params.reserve(queries.size());
+    for (auto const& q : queries)
+        params.push_back(formatParams(q, j_));
+
+    try
+    {
+        connect();
+
+        // Prepare what isn't yet, before any query is sent
+        std::vector<std::string const*> names;
+        names.reserve(queries.size());
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            pg_result_type failed{
+                nullptr, [](PGresult* result) { PQclear(result); }};
+            names.push_back(
+                prepare(queries[i].first, params[i].size(), failed));
+            if (failed)
+                Throw<std::runtime_error>(PQerrorMessage(conn_.get()));
+        }
+
+        if (!PQenterPipelineMode(conn_.get()))
+            Throw<std::runtime_error>("could not enter pipeline mode");
+
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            auto const values = params[i].size()
+                ? reinterpret_cast<char const* const*>(&params[i][0])
+                : nullptr;
+            auto const sent = names[i]
+                ? PQsendQueryPrepared(
+                      conn_.get(),
+                      names[i]->c_str(),
+                      params[i].size(),
+                      values,
+                      nullptr,
+                      nullptr,
+                      0)
+                : PQsendQueryParams(
+                      conn_.get(),
+                      queries[i].first,
+                      params[i].size(),
+                      nullptr,
+                      values,
+                      nullptr,
+                      nullptr,
+                      0);
+            if (!sent)
+                Throw<std::runtime_error>(PQerrorMessage(conn_.get()));
+        }
+        if (!PQpipelineSync(conn_.get()))
+            Throw<std::runtime_error>(PQerrorMessage(conn_.get()));
+
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            pg_result_type res{
+                nullptr, [](PGresult* result) { PQclear(result); }};
+            res.reset(PQgetResult(conn_.get()));
+            if (!res)
+                Throw<std::runtime_error>("no result structure returned");
+
+            // Each query's results end with a null
+            pg_result_type end{
+                nullptr, [](PGresult* result) { PQclear(result); }};
+            end.reset(PQgetResult(conn_.get()));
+
+            auto const status = PQresultStatus(res.get());
+            if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK)
+            {
+                results.emplace_back(std::move(res));
+            }
+            else
+            {
+                // After a query fails, the rest of the pipeline is aborted
+                JLOG(j_.error())
+                    << "bad query result in pipeline: " << PQresStatus(status)
+                    << " error message: " << PQerrorMessage(conn_.get());
+                results.emplace_back(res.get(), conn_.get());
+            }
+        }
+
+        pg_result_type sync{nullptr, [](PGresult* result) { PQclear(result); }};
+        sync.reset(PQgetResult(conn_.get()));
+        if (PQresultStatus(sync.get()) != PGRES_PIPELINE_SYNC ||
+            !PQexitPipelineMode(conn_.get()))
+            Throw<std::runtime_error>("could not leave pipeline mode");
+        return results;
+    }
+    catch (std::exception const& e)
+    {
+        // Sever the connection and fall back to one query at a time, which
+        // retries until successful
+        disconnect();
+        JLOG(j_.error()) << "database error in pipeline, retrying: "
+                         << e.what();
+        results.clear();
+    }
+#endif
+
+    for (auto const& q : queries)
+        results.push_back(query(q));
+    return results;
+}
+
 void
 Pg::bulkInsert(char const* table, std::string const& records)
+{
+    copyBegin(table, false);
+    copyData(records);
+    copyEnd();
+}
+
+void
+Pg::copyBegin(char const* table, bool binary)
 {
     // https://www.postgresql.org/docs/12/libpq-copy.html#LIBPQ-COPY-SEND
     assert(conn_.get());
-    static auto copyCmd = boost::format(R"(COPY %s FROM stdin)");
-    auto res = query(boost::str(copyCmd % table).c_str());
+    copyTable_ = table;
+    static auto copyCmd = boost::format(R"(COPY %s FROM stdin%s)");
+    auto res = query(
+        boost::str(copyCmd % table % (binary ? " WITH (FORMAT binary)" : ""))
+            .c_str());
     if (!res || res.status() != PGRES_COPY_IN)
     {
         std::stringstream ss;
@@ -254,20 +420,28 @@ Pg::bulkInsert(char const* table, std::string const& records)
             ss << ". Query status not PGRES_COPY_IN: " << res.status();
         Throw<std::runtime_error>(ss.str());
     }
+}
 
+void
+Pg::copyData(std::string const& records)
+{
     if (PQputCopyData(conn_.get(), records.c_str(), records.size()) == -1)
     {
         std::stringstream ss;
-        ss << "bulkInsert to " << table
+        ss << "bulkInsert to " << copyTable_
            << ". PQputCopyData error: " << PQerrorMessage(conn_.get());
         disconnect();
         Throw<std::runtime_error>(ss.str());
     }
+}
 
+void
+Pg::copyEnd()
+{
     if (PQputCopyEnd(conn_.get(), nullptr) == -1)
     {
         std::stringstream ss;
-        ss << "bulkInsert to " << table
+        ss << "bulkInsert to " << copyTable_
            << ". PQputCopyEnd error: " << PQerrorMessage(conn_.get());
         disconnect();
         Throw<std::runtime_error>(ss.str());
@@ -281,13 +455,32 @@ Pg::bulkInsert(char const* table, std::string const& records)
     if (status != PGRES_COMMAND_OK)
     {
         std::stringstream ss;
-        ss << "bulkInsert to " << table
+        ss << "bulkInsert to " << copyTable_
            << ". PQputCopyEnd status not PGRES_COMMAND_OK: " << status;
         disconnect();
         Throw<std::runtime_error>(ss.str());
     }
 }
 
+void
+Pg::copyAbort()
+{
+    // A COPY ended with an error message fails, and the transaction it is
+    // part of is aborted. Consume the failure so the connection can be used
+    if (!conn_ || PQputCopyEnd(conn_.get(), "aborted") == -1)
+    {
+        disconnect();
+        return;
+    }
+    pg_result_type res{nullptr, [](PGresult* result) { PQclear(result); }};
+    while (conn_)
+    {
+        res.reset(PQgetResult(conn_.get()));
+        if (!res)
+            break;
+    }
+}
+
 bool
 Pg::clear()
 {
@@ -314,7 +507,7 @@ Pg::clear()
                 [[fallthrough]];  // avoids compiler warning
             case PGRES_COPY_OUT:
             case PGRES_COPY_BOTH:
-                conn_.reset();
+                disconnect();
             default:;
         }
     } while (res && conn_);
@@ -500,6 +693,14 @@ PgPool::setup()
     }
 }
 
+void
+PgPool::setCollector(beast::insight::Collector::ptr const& collector)
+{
+    checkoutWait_ = collector->make_histogram("PgPool", "Checkout_Wait");
+    checkedOut_ = collector->make_gauge("PgPool", "Checked_Out");
+    exhausted_ = collector->make_counter("PgPool", "Exhausted");
+}
+
 void
 PgPool::onStop()
 {
@@ -540,8 +741,10 @@ PgPool::idleSweeper()
 std::unique_ptr<Pg>
 PgPool::checkout()
 {
+    auto const start = clock_type::now();
     std::unique_ptr<Pg> ret;
     std::unique_lock<std::mutex> lock(mutex_);
+    bool waited = false;
     do
     {
         if (stop_)
@@ -564,11 +767,17 @@ PgPool::checkout()
         else
         {
             JLOG(j_.error()) << "No database connections available.";
+            waited = true;
             cond_.wait(lock);
         }
     } while (!ret && !stop_);
+    if (ret)
+        checkedOut_ = connections_ - idle_.size();
     lock.unlock();
 
+    if (waited)
+        ++exhausted_;
+    checkoutWait_.notify(clock_type::now() - start);
     return ret;
 }
 
@@ -587,6 +796,7 @@ PgPool::checkin(std::unique_ptr<Pg>& pg)
             --connections_;
             pg.reset();
         }
+        checkedOut_ = connections_ - idle_.size();
     }
 
     cond_.notify_all();
@@ -23,18 +23,21 @@
 
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/basics/Log.h>
+#include <ripple/beast/insight/Collector.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/protocol/Protocol.h>
 #include <boost/lexical_cast.hpp>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <libpq-fe.h>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -262,6 +265,29 @@ class Pg
     // The connection object must be freed using the libpq API PQfinish() call.
     pg_connection_type conn_{nullptr, [](PGconn* conn) { PQfinish(conn); }};
 
+    /** Names of the statements prepared on the connection, by command.
+     *
+     * Prepared statements last as long as the connection, so they are kept
+     * while the connection is idle in the pool, and forgotten when it is
+     * severed or reset.
+     */
+    std::unordered_map<std::string, std::string> prepared_;
+
+    /** The most statements prepared on one connection. Commands past this
+     * are sent with their parameters each time instead. */
+    static constexpr std::size_t maxPrepared = 64;
+
+    /** Get the statement prepared for a command, preparing it if needed.
+     *
+     * @param command Command with parameters.
+     * @param nParams Number of parameters.
+     * @param failed Set to the result of a failed preparation.
+     * @return Name of the prepared statement, or nullptr if the command
+     *         was not prepared.
+     */
+    std::string const*
+    prepare(char const* command, std::size_t nParams, pg_result_type& failed);
+
     /** Clear results from the connection.
      *
      * Results from previous commands must be cleared before new commands
@@ -288,6 +314,7 @@ class Pg
     disconnect()
     {
         conn_.reset();
+        prepared_.clear();
     }
 
     /** Execute postgres query.
@@ -324,6 +351,20 @@ class Pg
     PgResult
     query(pg_params const& dbParams);
 
+    /** Execute several postgres queries with parameters, sending them all
+     * before waiting for any result.
+     *
+     * Uses the libpq pipeline mode where available, so the queries cost one
+     * round trip to the server instead of one each. Each query is run as a
+     * prepared statement. Meant for a handful of small queries, as the
+     * connection blocks if its buffers fill before the results are read.
+     *
+     * @param queries Database commands and parameter values.
+     * @return Result of each query, in order. Empty if stopping.
+     */
+    std::vector<PgResult>
+    pipeline(std::vector<pg_params> const& queries);
+
     /** Insert multiple records into a table using Postgres' bulk COPY.
      *
      * Throws upon error.
@@ -334,6 +375,41 @@ class Pg
     void
     bulkInsert(char const* table, std::string const& records);
 
+    /** Start a bulk COPY into a table. Records are then sent in any number
+     * of pieces with copyData(), and the COPY finished with copyEnd(). No
+     * other command may be run on the connection in the meantime.
+     *
+     * Throws upon error.
+     *
+     * @param table Name of table for import.
+     * @param binary Whether the records are in the binary COPY format.
+     */
+    void
+    copyBegin(char const* table, bool binary);
+
+    /** Send records to the COPY in progress.
+     *
+     * Throws upon error.
+     *
+     * @param records Records in the format given to copyBegin().
+     */
+    void
+    copyData(std::string const& records);
+
+    /** Finish the COPY in progress, inserting the records sent.
+     *
+     * Throws upon error.
+     */
+    void
+    copyEnd();
+
+    /** Abandon the COPY in progress. None of its records are inserted. */
+    void
+    copyAbort();
+
+    // Table of the COPY in progress, for error messages
+    std::string copyTable_;
+
 public:
     /** Constructor for Pg class.
      *
@@ -383,6 +459,16 @@ class PgPool : public Stoppable
     std::multimap<std::chrono::time_point<clock_type>, std::unique_ptr<Pg>>
         idle_;
 
+    /** Time spent waiting for a connection. */
+    beast::insight::Histogram checkoutWait_;
+
+    /** Number of connections checked out. */
+    beast::insight::Gauge checkedOut_;
+
+    /** Number of checkouts that had to wait for a connection to be returned
+     * because all of them were in use. */
+    beast::insight::Counter exhausted_;
+
     /** Get a postgres connection object.
      *
      * Return the most recent idle connection in the pool, if available.
@@ -421,6 +507,13 @@ public:
     void
     setup();
 
+    /** Report the time spent waiting for connections to a collector.
+     *
+     * @param collector Collector for the pool's metrics.
+     */
+    void
+    setCollector(beast::insight::Collector::ptr const& collector);
+
     /** Prepare for process shutdown. (Stoppable) */
     void
     onStop() override;
@@ -481,6 +574,19 @@ public:
         return operator()(pg_params{command, {}});
     }
 
+    /** Execute several postgres queries with parameters in one round trip.
+     *
+     * @param queries Database commands with parameters.
+     * @return Result of each query, in order. Empty if stopping.
+     */
+    std::vector<PgResult>
+    pipeline(std::vector<pg_params> const& queries)
+    {
+        if (!pg_)  // It means we're stopping. Return empty result.
+            return {};
+        return pg_->pipeline(queries);
+    }
+
     /** Insert multiple records into a table using Postgres' bulk COPY.
      *
      * Throws upon error.
@@ -493,6 +599,133 @@ public:
     {
         pg_->bulkInsert(table, records);
     }
+
+    /** Start a bulk COPY into a table, to be sent in pieces.
+     *
+     * Throws upon error.
+     *
+     * @param table Name of table for import.
+     * @param binary Whether the records are in the binary COPY format.
+     */
+    void
+    copyBegin(char const* table, bool binary)
+    {
+        pg_->copyBegin(table, binary);
+    }
+
+    /** Send records to the COPY in progress.
+     *
+     * Throws upon error.
+     *
+     * @param records Records in the format given to copyBegin().
+     */
+    void
+    copyData(std::string const& records)
+    {
+        pg_->copyData(records);
+    }
+
+    /** Finish the COPY in progress.
+     *
+     * Throws upon error.
+     */
+    void
+    copyEnd()
+    {
+        pg_->copyEnd();
+    }
+
+    /** Abandon the COPY in progress. */
+    void
+    copyAbort()
+    {
+        pg_->copyAbort();
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/** Records in the binary COPY format.
+ *
+ * The binary format is sent as is, so it is smaller than the text format
+ * and Postgres does not have to parse it. Fields are written in network
+ * byte order. The records may be taken in pieces as they are built, to be
+ * sent while more are added.
+ *
+ * https://www.postgresql.org/docs/12/sql-copy.html#id-1.9.3.55.9.4
+ */
+class PgCopyRecords
+{
+    std::string data_;
+
+    template <class Integer>
+    void
+    put(Integer value)
+    {
+        for (int shift = 8 * (sizeof(Integer) - 1); shift >= 0; shift -= 8)
+            data_.push_back(static_cast<char>(value >> shift));
+    }
+
+public:
+    /** Start the records with the file header. */
+    PgCopyRecords()
+    {
+        // The signature includes its terminating null
+        static char const signature[] = "PGCOPY\n\377\r\n";
+        data_.assign(signature, sizeof(signature));
+        // flags, then the length of the header extension
+        put(std::int32_t{0});
+        put(std::int32_t{0});
+    }
+
+    /** Start a record.
+     *
+     * @param fields Number of fields in the record.
+     */
+    void
+    row(std::int16_t fields)
+    {
+        put(fields);
+    }
+
+    /** Add a bigint field. */
+    void
+    bigint(std::int64_t value)
+    {
+        put(std::int32_t{8});
+        put(value);
+    }
+
+    /** Add a bytea field. */
+    void
+    bytea(void const* data, std::size_t size)
+    {
+        put(static_cast<std::int32_t>(size));
+        data_.append(static_cast<char const*>(data), size);
+    }
+
+    /** End the records with the file trailer. */
+    void
+    finish()
+    {
+        put(std::int16_t{-1});
+    }
+
+    /** @return the size of the records not yet taken. */
+    std::size_t
+    size() const
+    {
+        return data_.size();
+    }
+
+    /** Take the records built so far. */
+    std::string
+    take()
+    {
+        std::string ret;
+        ret.swap(data_);
+        return ret;
+    }
 };
 
 //-----------------------------------------------------------------------------
@@ -36,6 +36,7 @@
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobQueue.h>
 #define SOCI_USE_BOOST
+#include <chrono>
 #include <cstdint>
 #include <soci/soci.h>
 #include <string>
@@ -134,6 +135,20 @@ convert(std::string const& from, soci::blob& to);
 class Checkpointer : public std::enable_shared_from_this<Checkpointer>
 {
 public:
+    /** What the checkpointer has done so far. */
+    struct Stats
+    {
+        // Size of the write ahead log, in pages, after the last commit
+        int walPages = 0;
+        std::uint64_t checkpoints = 0;
+        // Checkpoints that had to wait for readers and writers
+        std::uint64_t restarts = 0;
+        // Pages copied from the write ahead log into the database
+        std::uint64_t pagesWritten = 0;
+        std::chrono::microseconds lastDuration{0};
+        std::chrono::microseconds maxDuration{0};
+    };
+
     virtual std::uintptr_t
     id() const = 0;
     virtual ~Checkpointer() = default;
@@ -143,20 +158,24 @@ public:
 
     virtual void
     checkpoint() = 0;
+
+    virtual Stats
+    stats() const = 0;
 };
 
-/** Returns a new checkpointer which makes checkpoints of a
-    soci database every checkpointPageCount pages, using a job on the job queue.
+/** Returns a new checkpointer which makes checkpoints of a soci database.
+
+    Checkpoints run on a thread shared by every checkpointer, so they never
+    wait behind other jobs nor hold up the thread that writes. They are
+    passive, and run more often while they fail to keep up, until the write
+    ahead log grows so large that the checkpointer waits for readers and
+    writers to restart it from the beginning.
 
-    The checkpointer contains references to the session and job queue
-    and so must outlive them both.
+    The checkpointer contains a reference to the session and so must not
+    outlive it.
  */
 std::shared_ptr<Checkpointer>
-makeCheckpointer(
-    std::uintptr_t id,
-    std::weak_ptr<soci::session>,
-    JobQueue&,
-    Logs&);
+makeCheckpointer(std::uintptr_t id, std::weak_ptr<soci::session>, Logs&);
 
 }  // namespace ripple
 
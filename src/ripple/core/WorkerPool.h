@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_WORKERPOOL_H_INCLUDED
+#define RIPPLE_CORE_WORKERPOOL_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** A fixed set of threads shared by work that is split across cores.
+
+    Work is given as a loop over a range of indexes. The calling thread
+    runs iterations too, and only waits for the ones a pool thread has
+    already started, so a caller makes progress even while every pool
+    thread is busy, and a loop may be run from inside another. Loops run
+    from several threads at once share the pool threads between them, so
+    the number of threads never grows with the number of callers.
+*/
+class WorkerPool
+{
+public:
+    /** @param threads The number of pool threads, besides the callers. */
+    explicit WorkerPool(std::size_t threads);
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool&
+    operator=(WorkerPool const&) = delete;
+
+    ~WorkerPool();
+
+    /** The most threads a loop can run on, the caller included. */
+    std::size_t
+    concurrency() const
+    {
+        return threads_.size() + 1;
+    }
+
+    /** Call `f` for every index in [0, n) and wait for all of them.
+
+        Pool threads only join a loop while each thread working on it has
+        at least `grain` indexes to call, so that short loops run on the
+        caller alone. If any call throws, the first exception is rethrown
+        once every call has finished.
+    */
+    void
+    run(std::size_t n,
+        std::function<void(std::size_t)> const& f,
+        std::size_t grain = 1);
+
+private:
+    struct Loop
+    {
+        std::function<void(std::size_t)> const* f;
+        std::size_t n;
+        std::size_t helpers;
+        std::atomic<std::size_t> next{0};
+        std::size_t joined = 0;
+        std::size_t active = 0;
+        std::exception_ptr error;
+    };
+
+    void
+    work(Loop& loop);
+
+    void
+    helper();
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::deque<Loop*> loops_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/random.h>
+#include <ripple/core/AutoTune.h>
+#include <boost/predef.h>
+#include <algorithm>
+#include <array>
+#include <thread>
+
+#if BOOST_OS_LINUX
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ripple {
+
+HostResources
+probeHost(boost::filesystem::path const& nodeStorePath)
+{
+    using namespace std::chrono;
+
+    HostResources host;
+    host.cores = std::thread::hardware_concurrency();
+
+#if BOOST_OS_LINUX
+    auto const pages = sysconf(_SC_PHYS_PAGES);
+    auto const pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0)
+        host.memory = static_cast<std::uint64_t>(pages) *
+            static_cast<std::uint64_t>(pageSize);
+
+    // The largest file holds most of the nodes, and is read the most
+    boost::filesystem::path largest;
+    std::uintmax_t size = 0;
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator iter(nodeStorePath, ec), end;
+         !ec && iter != end;
+         iter.increment(ec))
+    {
+        boost::system::error_code sizeEc;
+        auto const s = boost::filesystem::file_size(iter->path(), sizeEc);
+        if (!sizeEc && s > size)
+        {
+            largest = iter->path();
+            size = s;
+        }
+    }
+
+    constexpr std::size_t block = 4096;
+    if (size < 256 * block)
+        return host;
+
+    int fd = ::open(largest.c_str(), O_RDONLY | O_DIRECT);
+    if (fd < 0)
+        fd = ::open(largest.c_str(), O_RDONLY);
+    if (fd < 0)
+        return host;
+
+    void* const buffer = std::aligned_alloc(block, block);
+    if (buffer)
+    {
+        auto const blocks = size / block;
+        int reads = 0;
+        auto const start = steady_clock::now();
+        auto const deadline = start + 250ms;
+        while (reads < 200 && steady_clock::now() < deadline)
+        {
+            auto const offset = rand_int(default_prng(), blocks - 1) * block;
+            if (::pread(fd, buffer, block, offset) != block)
+                break;
+            ++reads;
+        }
+        auto const elapsed = steady_clock::now() - start;
+
+        if (reads > 0)
+        {
+            host.readLatency = duration_cast<microseconds>(elapsed / reads);
+            host.readIops = reads / duration<double>(elapsed).count();
+        }
+        std::free(buffer);
+    }
+    ::close(fd);
+#endif
+
+    return host;
+}
+
+AutoTuning
+autoTune(HostResources const& host)
+{
+    using namespace std::chrono_literals;
+
+    AutoTuning tuning;
+
+    // Physical memory for "small", "medium", "large" and "huge"
+    constexpr std::uint64_t gigabyte = 1024 * 1024 * 1024;
+    std::array<std::uint64_t, 4> const memory{
+        {8 * gigabyte, 12 * gigabyte, 16 * gigabyte, 24 * gigabyte}};
+    tuning.nodeSize = std::count_if(
+        memory.begin(), memory.end(), [&](std::uint64_t m) {
+            return host.memory >= m;
+        });
+
+    // The larger sizes need the cores to keep their caches busy
+    if (host.cores == 1)
+        tuning.nodeSize = 0;
+    else if (host.cores != 0 && host.cores < 4)
+        tuning.nodeSize = std::min<std::size_t>(tuning.nodeSize, 1);
+
+    int const cores = std::max(host.cores, 1u);
+    bool const slowDisk = host.readLatency && *host.readLatency >= 1ms;
+    bool const fastDisk = host.readLatency && *host.readLatency < 100us;
+
+    // As JobQueue::setThreadCount does, since I/O bottlenecks beyond a few
+    // threads, unless jobs spend their time waiting on a slow disk
+    tuning.workers = 2 + std::min(cores, slowDisk ? 8 : 4);
+
+    if (slowDisk)
+        tuning.readThreads = std::clamp(2 * cores, 4, 16);
+    else if (fastDisk)
+        tuning.readThreads = 2;
+    else
+        tuning.readThreads = 4;
+
+    std::array<int, 5> const pathSearch{{4, 5, 7, 7, 7}};
+    std::array<int, 5> const pathSearchMax{{6, 8, 10, 10, 10}};
+    tuning.pathSearch = pathSearch[tuning.nodeSize];
+    tuning.pathSearchMax = pathSearchMax[tuning.nodeSize];
+
+    return tuning;
+}
+
+}  // namespace ripple
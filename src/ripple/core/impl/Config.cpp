@@ -318,6 +318,7 @@ Config::setup(
     std::string ledgerTxDbType;
     Section ledgerTxTablesSection = section("ledger_tx_tables");
     get_if_exists(ledgerTxTablesSection, "use_tx_tables", USE_TX_TABLES);
+    get_if_exists(ledgerTxTablesSection, "tx_index", TX_INDEX);
 }
 
 void
@@ -415,7 +416,9 @@ Config::loadFromString(std::string const& fileContents)
 
     if (getSingleSection(secConfig, SECTION_NODE_SIZE, strTemp, j_))
     {
-        if (boost::iequals(strTemp, "tiny"))
+        if (boost::iequals(strTemp, "auto"))
+            NODE_SIZE_AUTO = true;
+        else if (boost::iequals(strTemp, "tiny"))
             NODE_SIZE = 0;
         else if (boost::iequals(strTemp, "small"))
             NODE_SIZE = 1;
@@ -430,6 +433,9 @@ Config::loadFromString(std::string const& fileContents)
                 4, beast::lexicalCastThrow<std::size_t>(strTemp));
     }
 
+    if (getSingleSection(secConfig, SECTION_MEMORY_BUDGET, strTemp, j_))
+        MEMORY_BUDGET = beast::lexicalCastThrow<std::size_t>(strTemp);
+
     if (getSingleSection(secConfig, SECTION_SIGNING_SUPPORT, strTemp, j_))
         signingEnabled_ = beast::lexicalCastThrow<bool>(strTemp);
 
@@ -519,6 +525,16 @@ Config::loadFromString(std::string const& fileContents)
         PATH_SEARCH_FAST = beast::lexicalCastThrow<int>(strTemp);
     if (getSingleSection(secConfig, SECTION_PATH_SEARCH_MAX, strTemp, j_))
         PATH_SEARCH_MAX = beast::lexicalCastThrow<int>(strTemp);
+    if (getSingleSection(secConfig, SECTION_FLOW_THREADS, strTemp, j_))
+        FLOW_THREADS = beast::lexicalCastThrow<std::size_t>(strTemp);
+    if (getSingleSection(secConfig, SECTION_PARALLEL_THREADS, strTemp, j_))
+        PARALLEL_THREADS = beast::lexicalCastThrow<std::size_t>(strTemp);
+    if (getSingleSection(
+            secConfig, SECTION_REPLAY_INVARIANT_SAMPLE, strTemp, j_))
+        REPLAY_INVARIANT_SAMPLE =
+            beast::lexicalCastThrow<std::size_t>(strTemp);
+    if (getSingleSection(secConfig, SECTION_PIPELINED_CLOSE, strTemp, j_))
+        PIPELINED_CLOSE = beast::lexicalCastThrow<bool>(strTemp);
 
     if (getSingleSection(secConfig, SECTION_DEBUG_LOGFILE, strTemp, j_))
         DEBUG_LOGFILE = strTemp;
@@ -526,17 +542,86 @@ Config::loadFromString(std::string const& fileContents)
     if (getSingleSection(secConfig, SECTION_WORKERS, strTemp, j_))
         WORKERS = beast::lexicalCastThrow<std::size_t>(strTemp);
 
+    if (NODE_SIZE_AUTO)
+    {
+        HOST_RESOURCES = probeHost(get<std::string>(
+            section(ConfigSection::nodeDatabase()), "path"));
+        auto const tuning = autoTune(HOST_RESOURCES);
+
+        NODE_SIZE = tuning.nodeSize;
+        NODESTORE_READ_THREADS = tuning.readThreads;
+        if (WORKERS == 0)
+        {
+            WORKERS = tuning.workers;
+            WORKERS_AUTO = true;
+        }
+        // Explicit path search levels are kept
+        if (!getIniFileSection(secConfig, SECTION_PATH_SEARCH))
+            PATH_SEARCH = tuning.pathSearch;
+        if (!getIniFileSection(secConfig, SECTION_PATH_SEARCH_MAX))
+            PATH_SEARCH_MAX = tuning.pathSearchMax;
+        PATH_SEARCH_FAST = std::min(PATH_SEARCH_FAST, PATH_SEARCH);
+    }
+
     if (getSingleSection(secConfig, SECTION_COMPRESSION, strTemp, j_))
         COMPRESSION = beast::lexicalCastThrow<bool>(strTemp);
 
+    if (getSingleSection(secConfig, SECTION_STREAM_COMPRESSION, strTemp, j_))
+        STREAM_COMPRESSION = beast::lexicalCastThrow<bool>(strTemp);
+
     if (getSingleSection(secConfig, SECTION_LEDGER_REPLAY, strTemp, j_))
         LEDGER_REPLAY = beast::lexicalCastThrow<bool>(strTemp);
 
+    if (getSingleSection(secConfig, SECTION_LEDGER_REPLAY_WINDOW, strTemp, j_))
+    {
+        LEDGER_REPLAY_WINDOW = beast::lexicalCastThrow<std::size_t>(strTemp);
+        if (LEDGER_REPLAY_WINDOW == 0)
+            Throw<std::runtime_error>(
+                "Invalid value specified in [" SECTION_LEDGER_REPLAY_WINDOW
+                "] section; the value must be at least 1");
+    }
+
+    if (getSingleSection(
+            secConfig, SECTION_HISTORY_BACKFILL_WINDOW, strTemp, j_))
+    {
+        HISTORY_BACKFILL_WINDOW =
+            beast::lexicalCastThrow<std::uint32_t>(strTemp);
+        if (HISTORY_BACKFILL_WINDOW > 1024)
+            Throw<std::runtime_error>(
+                "Invalid value specified in [" SECTION_HISTORY_BACKFILL_WINDOW
+                "] section; the value must be at most 1024");
+    }
+
+    if (getSingleSection(secConfig, SECTION_LEDGER_APPLY_THREADS, strTemp, j_))
+    {
+        LEDGER_APPLY_THREADS = beast::lexicalCastThrow<std::size_t>(strTemp);
+        if (LEDGER_APPLY_THREADS == 0)
+            Throw<std::runtime_error>(
+                "Invalid value specified in [" SECTION_LEDGER_APPLY_THREADS
+                "] section; the value must be at least 1");
+    }
+
+    if (getSingleSection(secConfig, SECTION_TX_RECONCILE, strTemp, j_))
+        TX_RECONCILE = beast::lexicalCastThrow<bool>(strTemp);
+
+    if (getSingleSection(secConfig, SECTION_RELAY_BATCH, strTemp, j_))
+        RELAY_BATCH = beast::lexicalCastThrow<bool>(strTemp);
+
+    if (getSingleSection(secConfig, SECTION_STATE_TRANSFER, strTemp, j_))
+        STATE_TRANSFER = beast::lexicalCastThrow<bool>(strTemp);
+
     if (exists(SECTION_REDUCE_RELAY))
     {
         auto sec = section(SECTION_REDUCE_RELAY);
         VP_REDUCE_RELAY_ENABLE = sec.value_or("vp_enable", false);
         VP_REDUCE_RELAY_SQUELCH = sec.value_or("vp_squelch", false);
+        TX_REDUCE_RELAY_ENABLE = sec.value_or("tx_enable", false);
+        TX_RELAY_PERCENTAGE =
+            sec.value_or("tx_relay_percentage", TX_RELAY_PERCENTAGE);
+        if (TX_RELAY_PERCENTAGE < 10 || TX_RELAY_PERCENTAGE > 100)
+            Throw<std::runtime_error>(
+                "Invalid " SECTION_REDUCE_RELAY
+                ", tx_relay_percentage must be between 10 and 100");
     }
 
     if (getSingleSection(secConfig, SECTION_MAX_TRANSACTIONS, strTemp, j_))
@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/core/CoroStackPool.h>
+#include <cstdlib>
+#include <new>
+
+namespace ripple {
+
+CoroStackPool::CoroStackPool(std::size_t stackSize, std::size_t maxIdle)
+    : stackSize_(stackSize), maxIdle_(maxIdle)
+{
+    idle_.reserve(maxIdle_);
+}
+
+CoroStackPool::~CoroStackPool()
+{
+    for (auto const limit : idle_)
+        std::free(limit);
+}
+
+std::size_t
+CoroStackPool::idle() const
+{
+    std::lock_guard lock(mutex_);
+    return idle_.size();
+}
+
+void
+CoroStackPool::Allocator::allocate(
+    boost::coroutines::stack_context& ctx,
+    std::size_t size)
+{
+    void* limit = nullptr;
+    if (size == pool_->stackSize_)
+    {
+        std::lock_guard lock(pool_->mutex_);
+        if (!pool_->idle_.empty())
+        {
+            limit = pool_->idle_.back();
+            pool_->idle_.pop_back();
+        }
+    }
+
+    if (!limit)
+    {
+        limit = std::malloc(size);
+        if (!limit)
+            Throw<std::bad_alloc>();
+    }
+
+    // Stacks grow down, so the coroutine starts at the highest address
+    ctx.size = size;
+    ctx.sp = static_cast<char*>(limit) + size;
+}
+
+void
+CoroStackPool::Allocator::deallocate(boost::coroutines::stack_context& ctx)
+{
+    void* const limit = static_cast<char*>(ctx.sp) - ctx.size;
+    if (ctx.size == pool_->stackSize_)
+    {
+        std::lock_guard lock(pool_->mutex_);
+        if (pool_->idle_.size() < pool_->maxIdle_)
+        {
+            pool_->idle_.push_back(limit);
+            return;
+        }
+    }
+    std::free(limit);
+}
+
+}  // namespace ripple
@@ -60,14 +60,11 @@ public:
     }
 
     std::shared_ptr<Checkpointer>
-    create(
-        std::shared_ptr<soci::session> const& session,
-        JobQueue& jobQueue,
-        Logs& logs)
+    create(std::shared_ptr<soci::session> const& session, Logs& logs)
     {
         std::lock_guard lock{mutex_};
         auto const id = nextId_++;
-        auto const r = makeCheckpointer(id, session, jobQueue, logs);
+        auto const r = makeCheckpointer(id, session, logs);
         checkpointers_[id] = r;
         return r;
     }
@@ -241,15 +238,87 @@ setup_DatabaseCon(Config const& c, boost::optional<beast::Journal> j)
     return setup;
 }
 
+std::size_t
+readConnections_DatabaseCon(Config const& c)
+{
+    // Readers may see SQLITE_BUSY while a rollback journal is being
+    // written, so they are only used in WAL mode
+    auto const& sqlite = c.section("sqlite");
+    std::string journal_mode = "wal";
+    std::string safety_level;
+    set(journal_mode, "journal_mode", sqlite);
+    if (set(safety_level, "safety_level", sqlite) &&
+        boost::iequals(safety_level, "low"))
+        journal_mode = "memory";
+
+    if (!boost::iequals(journal_mode, "wal"))
+        return 0;
+
+    std::size_t readConnections = 4;
+    set(readConnections, "read_connections", sqlite);
+    return readConnections;
+}
+
 std::unique_ptr<std::vector<std::string> const>
     DatabaseCon::Setup::globalPragma;
 
+LockedSociSession
+DatabaseCon::checkoutReadDb()
+{
+    if (readers_.empty())
+        return checkoutDb();
+
+    // Take the first idle reader, starting from a different one each time,
+    // and wait for one in turn only if they are all busy
+    auto const start = nextReader_++;
+    for (std::size_t i = 0; i < readers_.size(); ++i)
+    {
+        auto& reader = *readers_[(start + i) % readers_.size()];
+        std::unique_lock<LockedSociSession::mutex> lock(
+            reader.lock, std::try_to_lock);
+        if (lock)
+            return LockedSociSession(reader.session, std::move(lock));
+    }
+
+    auto& reader = *readers_[start % readers_.size()];
+    return LockedSociSession(reader.session, reader.lock);
+}
+
+void
+DatabaseCon::forEachSession(std::function<void(soci::session&)> const& f)
+{
+    std::lock_guard writerLock(lock_);
+    f(*session_);
+
+    for (auto& reader : readers_)
+    {
+        std::lock_guard readerLock(reader->lock);
+        *reader->session << "PRAGMA query_only=0;";
+        try
+        {
+            f(*reader->session);
+        }
+        catch (...)
+        {
+            *reader->session << "PRAGMA query_only=1;";
+            throw;
+        }
+        *reader->session << "PRAGMA query_only=1;";
+    }
+}
+
 void
-DatabaseCon::setupCheckpointing(JobQueue* q, Logs& l)
+DatabaseCon::setupCheckpointing(Logs& l)
+{
+    checkpointer_ = checkpointers.create(session_, l);
+}
+
+boost::optional<Checkpointer::Stats>
+DatabaseCon::checkpointStats() const
 {
-    if (!q)
-        Throw<std::logic_error>("No JobQueue");
-    checkpointer_ = checkpointers.create(session_, *q, l);
+    if (!checkpointer_)
+        return boost::none;
+    return checkpointer_->stats();
 }
 
 }  // namespace ripple
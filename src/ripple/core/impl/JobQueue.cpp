@@ -17,26 +17,45 @@
 */
 //==============================================================================
 
+#include <ripple/basics/ByteUtilities.h>
 #include <ripple/basics/PerfLog.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/contract.h>
 #include <ripple/core/JobQueue.h>
 
 namespace ripple {
 
+// Coroutine stacks kept for reuse, enough for a burst of client requests
+static constexpr std::size_t maxIdleCoroStacks = 64;
+
+// Returns true if the oldest waiting job of this type has waited past the
+// type's average latency target.
+static bool
+overdue(JobTypeData const& data, Job::clock_type::time_point now)
+{
+    using namespace std::chrono_literals;
+    auto const target = data.info.getAverageLatency();
+    return target != 0ms && !data.jobs.empty() &&
+        now - data.jobs.front().queue_time() >= target;
+}
+
 JobQueue::JobQueue(
     beast::insight::Collector::ptr const& collector,
     Stoppable& parent,
     beast::Journal journal,
     Logs& logs,
-    perf::PerfLog& perfLog)
+    perf::PerfLog& perfLog,
+    perf::Tracer& tracer)
     : Stoppable("JobQueue", parent)
     , m_journal(journal)
+    , coroStacks_(megabytes(1), maxIdleCoroStacks)
     , m_lastJob(0)
     , m_invalidJobData(JobTypes::instance().getInvalid(), collector, logs)
     , m_processCount(0)
     , m_workers(*this, &perfLog, "JobQueue", 0)
     , m_cancelCallback(std::bind(&Stoppable::isStopping, this))
     , perfLog_(perfLog)
+    , tracer_(tracer)
     , m_collector(collector)
 {
     hook = m_collector->make_hook(std::bind(&JobQueue::collect, this));
@@ -57,6 +76,10 @@ JobQueue::JobQueue(
             assert(result.second == true);
             (void)result.second;
         }
+
+        // Higher job types run first
+        for (auto iter = m_jobData.rbegin(); iter != m_jobData.rend(); ++iter)
+            m_priorities.push_back(&iter->second);
     }
 }
 
@@ -70,7 +93,7 @@ void
 JobQueue::collect()
 {
     std::lock_guard lock(m_mutex);
-    job_count = m_jobSet.size();
+    job_count = m_jobCount;
 }
 
 bool
@@ -94,6 +117,8 @@ JobQueue::addRefCountedJob(
     // do not add jobs to a queue with no threads
     assert(type == jtCLIENT || m_workers.getNumberOfThreads() > 0);
 
+    Job job(type, name, ++m_lastJob, data.load(), func, m_cancelCallback);
+
     {
         std::lock_guard lock(m_mutex);
 
@@ -110,11 +135,9 @@ JobQueue::addRefCountedJob(
         //
         assert(
             !isStopped() &&
-            (m_processCount > 0 || !m_jobSet.empty() || !areChildrenStopped()));
+            (m_processCount > 0 || m_jobCount > 0 || !areChildrenStopped()));
 
-        std::pair<std::set<Job>::iterator, bool> result(m_jobSet.insert(
-            Job(type, name, ++m_lastJob, data.load(), func, m_cancelCallback)));
-        queueJob(*result.first, lock);
+        queueJob(std::move(job), lock);
     }
     return true;
 }
@@ -156,6 +179,17 @@ JobQueue::getJobCountGE(JobType t) const
     return ret;
 }
 
+bool
+JobQueue::isBacklogged(JobType t) const
+{
+    std::lock_guard lock(m_mutex);
+
+    JobDataMap::const_iterator c = m_jobData.find(t);
+
+    return c != m_jobData.end() &&
+        overdue(c->second, Job::clock_type::now());
+}
+
 void
 JobQueue::setThreadCount(int c, bool const standaloneMode)
 {
@@ -216,6 +250,18 @@ JobQueue::isOverloaded()
     return count > 0;
 }
 
+// The median and tail of a distribution of job timings, in microseconds
+static Json::Value
+percentiles(beast::insight::Histogram const& histogram)
+{
+    auto const counts = histogram.counts();
+    Json::Value ret(Json::objectValue);
+    for (auto const p : {50, 90, 99})
+        ret["p" + std::to_string(p)] = static_cast<Json::UInt>(
+            beast::insight::LogHistogram::percentile(counts, p));
+    return ret;
+}
+
 Json::Value
 JobQueue::getJson(int c)
 {
@@ -243,7 +289,8 @@ JobQueue::getJson(int c)
         int running(data.running);
 
         if ((stats.count != 0) || (waiting != 0) ||
-            (stats.latencyPeak != 0ms) || (running != 0))
+            (stats.latencyPeak != 0ms) || (running != 0) ||
+            data.runTimes.count() != 0)
         {
             Json::Value& pri = priorities.append(Json::objectValue);
 
@@ -266,6 +313,12 @@ JobQueue::getJson(int c)
 
             if (running != 0)
                 pri["in_progress"] = running;
+
+            if (data.runTimes.count() != 0)
+            {
+                pri["wait_us"] = percentiles(data.waitTimes);
+                pri["run_us"] = percentiles(data.runTimes);
+            }
         }
     }
 
@@ -278,7 +331,7 @@ void
 JobQueue::rendezvous()
 {
     std::unique_lock<std::mutex> lock(m_mutex);
-    cv_.wait(lock, [&] { return m_processCount == 0 && m_jobSet.empty(); });
+    cv_.wait(lock, [&] { return m_processCount == 0 && m_jobCount == 0; });
 }
 
 JobTypeData&
@@ -310,27 +363,26 @@ JobQueue::checkStopped(std::lock_guard<std::mutex> const& lock)
     //  1. A stop notification was received
     //  2. All Stoppable children have stopped
     //  3. There are no executing calls to processTask
-    //  4. There are no remaining Jobs in the job set
+    //  4. There are no remaining waiting Jobs
     //  5. There are no suspended coroutines
     //
     if (isStopping() && areChildrenStopped() && (m_processCount == 0) &&
-        m_jobSet.empty() && nSuspend_ == 0)
+        m_jobCount == 0 && nSuspend_ == 0)
     {
         stopped();
     }
 }
 
 void
-JobQueue::queueJob(Job const& job, std::lock_guard<std::mutex> const& lock)
+JobQueue::queueJob(Job&& job, std::lock_guard<std::mutex> const& lock)
 {
     JobType const type(job.getType());
     assert(type != jtINVALID);
-    assert(m_jobSet.find(job) != m_jobSet.end());
     perfLog_.jobQueue(type);
 
     JobTypeData& data(getJobTypeData(type));
 
-    if (data.waiting + data.running < getJobLimit(type))
+    if (data.waiting + data.running < data.info.limit())
     {
         m_workers.addTask();
     }
@@ -341,40 +393,53 @@ JobQueue::queueJob(Job const& job, std::lock_guard<std::mutex> const& lock)
         ++data.deferred;
     }
     ++data.waiting;
+    data.jobs.push_back(std::move(job));
+    ++m_jobCount;
 }
 
 void
 JobQueue::getNextJob(Job& job)
 {
-    assert(!m_jobSet.empty());
+    assert(m_jobCount > 0);
+
+    auto const now = Job::clock_type::now();
+    JobTypeData* next = nullptr;
 
-    std::set<Job>::const_iterator iter;
-    for (iter = m_jobSet.begin(); iter != m_jobSet.end(); ++iter)
+    for (auto const data : m_priorities)
     {
-        JobTypeData& data(getJobTypeData(iter->getType()));
+        if (data->jobs.empty())
+            continue;
+
+        assert(data->running <= data->info.limit());
 
-        assert(data.running <= getJobLimit(data.type()));
+        // Only run this job if we're running below the limit.
+        if (data->running >= data->info.limit())
+            continue;
+
+        if (next == nullptr)
+            next = data;
 
-        // Run this job if we're running below the limit.
-        if (data.running < getJobLimit(data.type()))
+        // Promote a type that is missing its latency target. Client
+        // commands are never promoted; RPC turns them away instead.
+        if (data->type() != jtCLIENT && overdue(*data, now))
         {
-            assert(data.waiting > 0);
+            next = data;
             break;
         }
     }
 
-    assert(iter != m_jobSet.end());
+    if (next == nullptr)
+        LogicError("JobQueue::getNextJob : no job can run");
 
-    JobType const type = iter->getType();
-    JobTypeData& data(getJobTypeData(type));
-
-    assert(type != jtINVALID);
+    assert(next->waiting > 0);
+    assert(next->type() != jtINVALID);
 
-    job = *iter;
-    m_jobSet.erase(iter);
+    job = std::move(next->jobs.front());
+    next->jobs.pop_front();
+    --m_jobCount;
 
-    --data.waiting;
-    ++data.running;
+    --next->waiting;
+    ++next->running;
 }
 
 void
@@ -387,7 +452,7 @@ JobQueue::finishJob(JobType type)
     // Queue a deferred task if possible
     if (data.deferred > 0)
     {
-        assert(data.running + data.waiting >= getJobLimit(type));
+        assert(data.running + data.waiting >= data.info.limit());
 
         --data.deferred;
         m_workers.addTask();
@@ -420,16 +485,31 @@ JobQueue::processTask(int instance)
                 date::ceil<microseconds>(start_time - job.queue_time());
             perfLog_.jobStart(type, q_time, start_time, instance);
 
-            job.doJob();
+            if (tracer_.tracingJobs())
+            {
+                job.doJob();
+                tracer_.record(
+                    data.name().c_str(),
+                    "job",
+                    start_time,
+                    Job::clock_type::now());
+            }
+            else
+            {
+                job.doJob();
+            }
 
             // The amount of time it took to execute the job
             auto const x_time =
                 date::ceil<microseconds>(Job::clock_type::now() - start_time);
 
+            data.waitTimes.notify(q_time);
+            data.runTimes.notify(x_time);
+
             if (x_time >= 10ms || q_time >= 10ms)
             {
-                getJobTypeData(type).dequeue.notify(q_time);
-                getJobTypeData(type).execute.notify(x_time);
+                data.dequeue.notify(q_time);
+                data.execute.notify(x_time);
             }
             perfLog_.jobFinish(type, x_time, instance);
         }
@@ -441,7 +521,7 @@ JobQueue::processTask(int instance)
         // otherwise destructors with side effects can access
         // parent objects that are already destroyed.
         finishJob(type);
-        if (--m_processCount == 0 && m_jobSet.empty())
+        if (--m_processCount == 0 && m_jobCount == 0)
             cv_.notify_all();
         checkStopped(lock);
     }
@@ -450,15 +530,6 @@ JobQueue::processTask(int instance)
     // to the associated LoadEvent object (in the Job) may be destroyed.
 }
 
-int
-JobQueue::getJobLimit(JobType type)
-{
-    JobTypeInfo const& j(JobTypes::instance().get(type));
-    assert(j.type() != jtINVALID);
-
-    return j.limit();
-}
-
 void
 JobQueue::onChildrenStopped()
 {
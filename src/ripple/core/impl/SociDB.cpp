@@ -24,18 +24,23 @@
 
 #include <ripple/basics/ByteUtilities.h>
 #include <ripple/basics/contract.h>
+#include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/ConfigSections.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/core/SociDB.h>
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <soci/sqlite3/soci-sqlite3.h>
 
 namespace ripple {
 
-static auto checkpointPageCount = 1000;
-
 namespace detail {
 
 std::pair<std::string, soci::backend_factory const&>
@@ -189,26 +194,136 @@ convert(std::string const& from, soci::blob& to)
 
 namespace {
 
-/** Run a thread to checkpoint the write ahead log (wal) for
-    the given soci::session every 1000 pages. This is only implemented
-    for sqlite databases.
+// Checkpoint once the write ahead log is this many pages long
+int const checkpointPageCount = 1000;
+
+// Checkpoint more often, down to this many pages, while checkpoints can't
+// copy the whole log
+int const minCheckpointPageCount = 100;
+
+// Wait for readers and writers to restart the log once it is this long
+int const restartPageCount = 20 * checkpointPageCount;
 
-    Note: According to: https://www.sqlite.org/wal.html#ckpt this
-    is the default behavior of sqlite. We may be able to remove this
-    class.
+// How long to wait before retrying a checkpoint that couldn't finish
+std::chrono::milliseconds const minRetryDelay{50};
+std::chrono::milliseconds const maxRetryDelay{2000};
+
+/** The thread that makes the checkpoints of every database.
+
+    Checkpoints are run in the order they were requested, each once its
+    delay passes. A checkpointer destroyed while waiting is skipped.
 */
+class CheckpointThread
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct Request
+    {
+        clock_type::time_point due;
+        std::weak_ptr<Checkpointer> checkpointer;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request> requests_;
+    bool stop_ = false;
+    std::thread thread_;
+
+public:
+    CheckpointThread() : thread_(&CheckpointThread::run, this)
+    {
+    }
+
+    ~CheckpointThread()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void
+    post(
+        std::weak_ptr<Checkpointer> checkpointer,
+        std::chrono::milliseconds delay)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            auto const due = clock_type::now() + delay;
+            // Keep the requests sorted by the time they are due
+            auto const it = std::find_if(
+                requests_.rbegin(), requests_.rend(), [&](Request const& r) {
+                    return r.due <= due;
+                });
+            requests_.insert(it.base(), {due, std::move(checkpointer)});
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void
+    run()
+    {
+        beast::setCurrentThreadName("WAL checkpoint");
+
+        std::unique_lock lock(mutex_);
+        while (!stop_)
+        {
+            if (requests_.empty())
+            {
+                cv_.wait(lock);
+                continue;
+            }
+
+            if (auto const due = requests_.front().due; due > clock_type::now())
+            {
+                cv_.wait_until(lock, due);
+                continue;
+            }
+
+            auto const wp = std::move(requests_.front().checkpointer);
+            requests_.pop_front();
+            lock.unlock();
+            if (auto self = wp.lock())
+                self->checkpoint();
+            lock.lock();
+        }
+    }
+};
+
+CheckpointThread&
+checkpointThread()
+{
+    static CheckpointThread thread;
+    return thread;
+}
+
+/** Checkpoint the write ahead log (wal) of the given soci::session as it
+    grows. This is only implemented for sqlite databases.
 
+    Each commit reports the size of the log. Once it passes a threshold, a
+    passive checkpoint copies as much of the log into the database as it
+    can without waiting on readers or the writer. If readers still use
+    part of the log, the checkpoint is retried after a delay that grows
+    while they do, and the threshold is lowered so that the next ones copy
+    less at a time. Once a checkpoint copies the whole log, both are reset.
+
+    Passive checkpoints never shrink the log, and the writer only starts
+    it over once a checkpoint has copied all of it. So when the log grows
+    past a limit no matter what, the checkpointer waits for readers and
+    writers to finish instead, and restarts it.
+*/
 class WALCheckpointer : public Checkpointer
 {
 public:
     WALCheckpointer(
         std::uintptr_t id,
         std::weak_ptr<soci::session> session,
-        JobQueue& q,
         Logs& logs)
         : id_(id)
         , session_(std::move(session))
-        , jobQueue_(q)
         , j_(logs.journal("WALCheckpointer"))
     {
         if (auto [conn, keepAlive] = getConnection(); conn)
@@ -240,30 +355,7 @@ public:
     void
     schedule() override
     {
-        {
-            std::lock_guard lock(mutex_);
-            if (running_)
-                return;
-            running_ = true;
-        }
-
-        // If the Job is not added to the JobQueue then we're not running_.
-        if (!jobQueue_.addJob(
-                jtWAL,
-                "WAL",
-                // If the owning DatabaseCon is destroyed, no need to checkpoint
-                // or keep the checkpointer alive so use a weak_ptr to this.
-                // There is a separate check in `checkpoint` for a valid
-                // connection in the rare case when the DatabaseCon is destroyed
-                // after locking this weak_ptr
-                [wp = std::weak_ptr<Checkpointer>{shared_from_this()}](Job&) {
-                    if (auto self = wp.lock())
-                        self->checkpoint();
-                }))
-        {
-            std::lock_guard lock(mutex_);
-            running_ = false;
-        }
+        post(std::chrono::milliseconds{0});
     }
 
     void
@@ -272,14 +364,27 @@ public:
         auto [conn, keepAlive] = getConnection();
         (void)keepAlive;
         if (!conn)
+        {
+            std::lock_guard lock(mutex_);
+            running_ = false;
             return;
+        }
 
+        auto const restart = walPages_ >= restartPageCount;
+        auto const start = std::chrono::steady_clock::now();
         int log = 0, ckpt = 0;
         int ret = sqlite3_wal_checkpoint_v2(
-            conn, nullptr, SQLITE_CHECKPOINT_PASSIVE, &log, &ckpt);
+            conn,
+            nullptr,
+            restart ? SQLITE_CHECKPOINT_RESTART : SQLITE_CHECKPOINT_PASSIVE,
+            &log,
+            &ckpt);
+        auto const elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
 
         auto fname = sqlite3_db_filename(conn, "main");
-        if (ret != SQLITE_OK)
+        if (ret != SQLITE_OK && ret != SQLITE_BUSY)
         {
             auto jm = (ret == SQLITE_LOCKED) ? j_.trace() : j_.warn();
             JLOG(jm) << "WAL(" << fname << "): error " << ret;
@@ -287,11 +392,50 @@ public:
         else
         {
             JLOG(j_.trace()) << "WAL(" << fname << "): frames=" << log
-                             << ", written=" << ckpt;
+                             << ", written=" << ckpt
+                             << (restart ? ", restarted" : "") << ", "
+                             << elapsed.count() << "us";
         }
 
         std::lock_guard lock(mutex_);
-        running_ = false;
+        ++stats_.checkpoints;
+        if (restart)
+            ++stats_.restarts;
+        stats_.lastDuration = elapsed;
+        stats_.maxDuration = std::max(stats_.maxDuration, elapsed);
+
+        // The frames copied are counted from the start of the log, which
+        // starts over once all of it was copied
+        if (ckpt > 0)
+        {
+            stats_.pagesWritten += ckpt >= copied_ ? ckpt - copied_ : ckpt;
+            copied_ = ckpt;
+        }
+
+        if (ret == SQLITE_OK && ckpt >= log)
+        {
+            running_ = false;
+            copied_ = 0;
+            threshold_ = checkpointPageCount;
+            retryDelay_ = minRetryDelay;
+            return;
+        }
+
+        // Readers or the writer held the checkpoint back. It stays running
+        // until the retry.
+        threshold_ = std::max(minCheckpointPageCount, threshold_ / 2);
+        auto const delay = retryDelay_;
+        retryDelay_ = std::min(retryDelay_ * 2, maxRetryDelay);
+        checkpointThread().post(shared_from_this(), delay);
+    }
+
+    Stats
+    stats() const override
+    {
+        std::lock_guard lock(mutex_);
+        auto stats = stats_;
+        stats.walPages = walPages_;
+        return stats;
     }
 
 protected:
@@ -300,12 +444,29 @@ protected:
     // It is possible (tho rare) for the DatabaseCon class to be destoryed
     // before the checkpointer.
     std::weak_ptr<soci::session> session_;
-    std::mutex mutex_;
-    JobQueue& jobQueue_;
+    mutable std::mutex mutex_;
 
     bool running_ = false;
+    std::atomic<int> walPages_{0};
+    std::atomic<int> threshold_{checkpointPageCount};
+    std::chrono::milliseconds retryDelay_{minRetryDelay};
+    // Frames of the current log copied by earlier checkpoints
+    int copied_ = 0;
+    Stats stats_;
     beast::Journal const j_;
 
+    void
+    post(std::chrono::milliseconds delay)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            if (running_)
+                return;
+            running_ = true;
+        }
+        checkpointThread().post(shared_from_this(), delay);
+    }
+
     static int
     sqliteWALHook(
         void* cpId,
@@ -313,18 +474,18 @@ protected:
         const char* dbName,
         int walSize)
     {
-        if (walSize >= checkpointPageCount)
+        auto checkpointer =
+            checkpointerFromId(reinterpret_cast<std::uintptr_t>(cpId));
+        if (!checkpointer)
         {
-            if (auto checkpointer =
-                    checkpointerFromId(reinterpret_cast<std::uintptr_t>(cpId)))
-            {
-                checkpointer->schedule();
-            }
-            else
-            {
-                sqlite_api::sqlite3_wal_hook(conn, nullptr, nullptr);
-            }
+            sqlite_api::sqlite3_wal_hook(conn, nullptr, nullptr);
+            return SQLITE_OK;
         }
+
+        auto& wal = static_cast<WALCheckpointer&>(*checkpointer);
+        wal.walPages_ = walSize;
+        if (walSize >= wal.threshold_)
+            wal.schedule();
         return SQLITE_OK;
     }
 };
@@ -335,11 +496,9 @@ std::shared_ptr<Checkpointer>
 makeCheckpointer(
     std::uintptr_t id,
     std::weak_ptr<soci::session> session,
-    JobQueue& queue,
     Logs& logs)
 {
-    return std::make_shared<WALCheckpointer>(
-        id, std::move(session), queue, logs);
+    return std::make_shared<WALCheckpointer>(id, std::move(session), logs);
 }
 
 }  // namespace ripple
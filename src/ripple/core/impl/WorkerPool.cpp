@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/core/WorkerPool.h>
+#include <algorithm>
+
+namespace ripple {
+
+WorkerPool::WorkerPool(std::size_t threads)
+{
+    threads_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        threads_.emplace_back([this] { helper(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_)
+        thread.join();
+}
+
+void
+WorkerPool::run(
+    std::size_t n,
+    std::function<void(std::size_t)> const& f,
+    std::size_t grain)
+{
+    if (n == 0)
+        return;
+
+    // The caller is one of the threads, and each has `grain` indexes
+    auto const threads =
+        std::max<std::size_t>(1, n / std::max<std::size_t>(grain, 1));
+    auto const helpers = std::min(threads_.size(), threads - 1);
+
+    Loop loop;
+    loop.f = &f;
+    loop.n = n;
+    loop.helpers = helpers;
+
+    if (helpers != 0)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            loops_.push_back(&loop);
+        }
+        if (helpers == threads_.size())
+            wake_.notify_all();
+        else
+            for (std::size_t i = 0; i < helpers; ++i)
+                wake_.notify_one();
+    }
+
+    work(loop);
+
+    if (helpers != 0)
+    {
+        std::unique_lock lock(mutex_);
+        auto const it = std::find(loops_.begin(), loops_.end(), &loop);
+        if (it != loops_.end())
+            loops_.erase(it);
+        done_.wait(lock, [&loop] { return loop.active == 0; });
+    }
+
+    if (loop.error)
+        std::rethrow_exception(loop.error);
+}
+
+void
+WorkerPool::work(Loop& loop)
+{
+    for (auto i = loop.next++; i < loop.n; i = loop.next++)
+    {
+        try
+        {
+            (*loop.f)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex_);
+            if (!loop.error)
+                loop.error = std::current_exception();
+        }
+    }
+}
+
+void
+WorkerPool::helper()
+{
+    beast::setCurrentThreadName("rippled: WorkerPool");
+
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [this] { return stop_ || !loops_.empty(); });
+        if (stop_)
+            return;
+
+        // Take the oldest loop, and leave it behind the others so that
+        // loops running at once share the threads
+        auto const loop = loops_.front();
+        loops_.pop_front();
+        if (loop->next.load() >= loop->n)
+            continue;
+        if (++loop->joined < loop->helpers)
+            loops_.push_back(loop);
+        ++loop->active;
+
+        lock.unlock();
+        work(*loop);
+        lock.lock();
+
+        if (--loop->active == 0)
+            done_.notify_all();
+    }
+}
+
+}  // namespace ripple
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/basics/Numa.h>
 #include <ripple/basics/PerfLog.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/core/impl/Workers.h>
@@ -191,6 +192,8 @@ Workers::Worker::notify()
 void
 Workers::Worker::run()
 {
+    numa::pinCurrentThread(instance_);
+
     bool shouldExit = true;
     do
     {
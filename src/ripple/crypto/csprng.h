@@ -20,6 +20,8 @@
 #ifndef RIPPLE_CRYPTO_RANDOM_H_INCLUDED
 #define RIPPLE_CRYPTO_RANDOM_H_INCLUDED
 
+#include <cstdint>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <type_traits>
@@ -28,9 +30,19 @@ namespace ripple {
 
 /** A cryptographically secure random number engine
 
-    The engine is thread-safe (it uses a lock to serialize
-    access) and will, automatically, mix in some randomness
-    from std::random_device.
+    The engine is thread-safe and will, automatically, mix in
+    some randomness from std::random_device.
+
+    Random data comes from OpenSSL. From OpenSSL 1.1.1 each
+    thread draws from its own generator, which OpenSSL reseeds
+    from a shared one, so callers on different threads do not
+    contend. Older versions are serialized with a lock.
+
+    Single integers are served from a small per-thread buffer,
+    filled by one call to OpenSSL and erased as it is used. A
+    child process discards the buffer it inherits from a fork.
+    Buffers of random data, which keys and seeds are made from,
+    always come straight from OpenSSL.
 
     Meets the requirements of UniformRandomNumberEngine
 */
@@ -42,6 +54,10 @@ private:
     void
     mix(void* buffer, std::size_t count, double bitsPerByte);
 
+    // Fill a buffer directly from OpenSSL
+    void
+    fill(void* ptr, std::size_t count);
+
 public:
     using result_type = std::uint64_t;
 
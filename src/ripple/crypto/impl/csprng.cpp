@@ -20,14 +20,58 @@
 #include <ripple/basics/ByteUtilities.h>
 #include <ripple/basics/contract.h>
 #include <ripple/crypto/csprng.h>
+#include <ripple/crypto/secure_erase.h>
+#include <boost/predef.h>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cstring>
 #include <openssl/rand.h>
 #include <random>
 #include <stdexcept>
 
+#if !BOOST_OS_WINDOWS
+#include <pthread.h>
+#endif
+
 namespace ripple {
 
+// OpenSSL serializes access to its generators itself from 1.1.0 on.
+static constexpr bool needsLock = OPENSSL_VERSION_NUMBER < 0x10100000L;
+
+namespace {
+
+// Incremented in the child after a fork, so that the child does not hand
+// out the bytes its parent drew ahead
+std::atomic<unsigned> forkCount{0};
+
+// Random bytes drawn ahead for one thread, so that generating an integer
+// does not take a call into OpenSSL each time. Bytes are erased as they
+// are handed out. Only integers are served from here: data that keys and
+// seeds are made from comes straight from OpenSSL.
+struct ThreadBuffer
+{
+    static constexpr std::size_t size = 256;
+
+    std::array<std::uint8_t, size> bytes;
+    std::size_t next = size;
+    unsigned forks = 0;
+
+    ThreadBuffer() = default;
+    ThreadBuffer(ThreadBuffer const&) = delete;
+    ThreadBuffer&
+    operator=(ThreadBuffer const&) = delete;
+
+    ~ThreadBuffer()
+    {
+        secure_erase(bytes.data(), bytes.size());
+    }
+};
+
+thread_local ThreadBuffer threadBuffer;
+
+}  // namespace
+
 void
 csprng_engine::mix(void* data, std::size_t size, double bitsPerByte)
 {
@@ -35,13 +79,18 @@ csprng_engine::mix(void* data, std::size_t size, double bitsPerByte)
     assert(size != 0);
     assert(bitsPerByte != 0);
 
-    std::lock_guard lock(mutex_);
+    std::unique_lock lock(mutex_, std::defer_lock);
+    if (needsLock)
+        lock.lock();
     RAND_add(data, size, (size * bitsPerByte) / 8.0);
 }
 
 csprng_engine::csprng_engine()
 {
     mix_entropy();
+#if !BOOST_OS_WINDOWS
+    pthread_atfork(nullptr, nullptr, [] { ++forkCount; });
+#endif
 }
 
 csprng_engine::~csprng_engine()
@@ -76,32 +125,45 @@ csprng_engine::mix_entropy(void* buffer, std::size_t count)
         mix(buffer, count, 0.5);
 }
 
-csprng_engine::result_type
-csprng_engine::operator()()
+void
+csprng_engine::fill(void* ptr, std::size_t count)
 {
-    result_type ret;
-
-    std::lock_guard lock(mutex_);
+    std::unique_lock lock(mutex_, std::defer_lock);
+    if (needsLock)
+        lock.lock();
 
     auto const result =
-        RAND_bytes(reinterpret_cast<unsigned char*>(&ret), sizeof(ret));
+        RAND_bytes(reinterpret_cast<unsigned char*>(ptr), count);
 
-    if (result == 0)
+    if (result != 1)
         Throw<std::runtime_error>("Insufficient entropy");
+}
 
+csprng_engine::result_type
+csprng_engine::operator()()
+{
+    auto& buffer = threadBuffer;
+    result_type ret;
+
+    auto const forks = forkCount.load();
+    if (buffer.forks != forks || buffer.size - buffer.next < sizeof(ret))
+    {
+        fill(buffer.bytes.data(), buffer.size);
+        buffer.next = 0;
+        buffer.forks = forks;
+    }
+
+    auto const data = buffer.bytes.data() + buffer.next;
+    std::memcpy(&ret, data, sizeof(ret));
+    secure_erase(data, sizeof(ret));
+    buffer.next += sizeof(ret);
     return ret;
 }
 
 void
 csprng_engine::operator()(void* ptr, std::size_t count)
 {
-    std::lock_guard lock(mutex_);
-
-    auto const result =
-        RAND_bytes(reinterpret_cast<unsigned char*>(ptr), count);
-
-    if (result != 1)
-        Throw<std::runtime_error>("Insufficient entropy");
+    fill(ptr, count);
 }
 
 csprng_engine&
@@ -21,6 +21,7 @@
 #include <ripple/json/json_reader.h>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <istream>
 #include <string>
 
@@ -30,6 +31,17 @@ namespace Json {
 
 constexpr unsigned Reader::nest_limit;
 
+// Returns the first occurrence of c in [begin, end), or end. The C library
+// scans many bytes per step, which matters for long strings like tx_blob.
+static char const*
+findChar(char const* begin, char const* end, char c)
+{
+    if (begin == end)
+        return end;
+    auto const p = static_cast<char const*>(std::memchr(begin, c, end - begin));
+    return p ? p : end;
+}
+
 static std::string
 codePointToUTF8(unsigned int cp)
 {
@@ -397,19 +409,32 @@ Reader::readNumber()
 bool
 Reader::readString()
 {
-    Char c = 0;
+    // Jump from escape to escape up to the closing quote. The quote is
+    // searched for again only if an escape consumed it.
+    Location quote = nullptr;
 
     while (current_ != end_)
     {
-        c = getNextChar();
+        if (quote == nullptr || quote < current_)
+            quote = findChar(current_, end_, '"');
 
-        if (c == '\\')
-            getNextChar();
-        else if (c == '"')
-            break;
+        Location const escape = findChar(current_, quote, '\\');
+        if (escape == quote)
+        {
+            current_ = quote;
+            if (current_ == end_)
+                return false;
+            ++current_;
+            return true;
+        }
+
+        // Skip the backslash and the character it escapes
+        current_ = escape + 1;
+        if (current_ != end_)
+            ++current_;
     }
 
-    return c == '"';
+    return false;
 }
 
 bool
@@ -448,11 +473,12 @@ Reader::readObject(Token& tokenStart, unsigned depth)
                 "Missing ':' after object member name", colon, tokenObjectEnd);
         }
 
-        // Reject duplicate names
-        if (currentValue().isMember(name))
+        // Reject duplicate names, looking the name up only once
+        auto const members = currentValue().size();
+        Value& value = currentValue()[name];
+        if (currentValue().size() == members)
             return addError("Key '" + name + "' appears twice.", tokenName);
 
-        Value& value = currentValue()[name];
         nodes_.push(&value);
         bool ok = readValue(depth + 1);
         nodes_.pop();
@@ -680,12 +706,15 @@ Reader::decodeString(Token& token, std::string& decoded)
 
     while (current != end)
     {
-        Char c = *current++;
+        // Copy everything up to the next escape at once
+        Location const next = findChar(current, end, '\\');
+        decoded.append(current, next);
+        current = next;
 
-        if (c == '"')
-            break;
-        else if (c == '\\')
+        if (current != end)
         {
+            ++current;
+
             if (current == end)
                 return addError(
                     "Empty escape sequence in string", token, current);
@@ -741,10 +770,6 @@ Reader::decodeString(Token& token, std::string& decoded)
                         "Bad escape sequence in string", token, current);
             }
         }
-        else
-        {
-            decoded += c;
-        }
     }
 
     return true;
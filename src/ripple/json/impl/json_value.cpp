@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/basics/MemoryArena.h>
 #include <ripple/basics/contract.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/json/impl/json_assert.h>
@@ -58,7 +59,13 @@ public:
         if (length == unknown)
             length = value ? (unsigned int)strlen(value) : 0;
 
-        char* newString = static_cast<char*>(malloc(length + 1));
+        // The length is kept in front of the string, since it may hold
+        // nulls and the arena needs the size back
+        auto const bytes = sizeof(std::size_t) + length + 1;
+        auto block = static_cast<char*>(
+            ripple::arenaAllocate(ripple::MemoryArena::json, bytes));
+        std::memcpy(block, &bytes, sizeof(bytes));
+        char* newString = block + sizeof(bytes);
         if (value)
             memcpy(newString, value, length);
         newString[length] = 0;
@@ -69,7 +76,12 @@ public:
     releaseStringValue(char* value) override
     {
         if (value)
-            free(value);
+        {
+            auto block = value - sizeof(std::size_t);
+            std::size_t bytes;
+            std::memcpy(&bytes, block, sizeof(bytes));
+            ripple::arenaDeallocate(ripple::MemoryArena::json, block, bytes);
+        }
     }
 };
 
@@ -177,7 +189,7 @@ Value::CZString::isStaticString() const
  * memset( this, 0, sizeof(Value) )
  * This optimization is used in ValueInternalMap fast allocator.
  */
-Value::Value(ValueType type) : type_(type), allocated_(0)
+Value::Value(ValueType type) : type_(type), allocated_(0), inlined_(0)
 {
     switch (type)
     {
@@ -226,18 +238,18 @@ Value::Value(double value) : type_(realValue)
     value_.real_ = value;
 }
 
-Value::Value(const char* value) : type_(stringValue), allocated_(true)
+Value::Value(const char* value) : type_(stringValue)
 {
-    value_.string_ = valueAllocator()->duplicateStringValue(value);
+    setString(value, value ? (unsigned int)strlen(value) : 0);
 }
 
-Value::Value(std::string const& value) : type_(stringValue), allocated_(true)
+Value::Value(std::string const& value) : type_(stringValue)
 {
-    value_.string_ = valueAllocator()->duplicateStringValue(
-        value.c_str(), (unsigned int)value.length());
+    setString(value.c_str(), (unsigned int)value.length());
 }
 
-Value::Value(const StaticString& value) : type_(stringValue), allocated_(false)
+Value::Value(const StaticString& value)
+    : type_(stringValue), allocated_(false), inlined_(0)
 {
     value_.string_ = const_cast<char*>(value.c_str());
 }
@@ -260,14 +272,16 @@ Value::Value(const Value& other) : type_(other.type_)
             break;
 
         case stringValue:
-            if (other.value_.string_)
+            if (auto const str = other.stringData())
             {
-                value_.string_ = valueAllocator()->duplicateStringValue(
-                    other.value_.string_);
-                allocated_ = true;
+                setString(str, (unsigned int)strlen(str));
             }
             else
+            {
                 value_.string_ = 0;
+                allocated_ = 0;
+                inlined_ = 0;
+            }
 
             break;
 
@@ -318,10 +332,14 @@ Value::operator=(Value const& other)
 }
 
 Value::Value(Value&& other) noexcept
-    : value_(other.value_), type_(other.type_), allocated_(other.allocated_)
+    : value_(other.value_)
+    , type_(other.type_)
+    , allocated_(other.allocated_)
+    , inlined_(other.inlined_)
 {
     other.type_ = nullValue;
     other.allocated_ = 0;
+    other.inlined_ = 0;
 }
 
 Value&
@@ -344,6 +362,30 @@ Value::swap(Value& other) noexcept
     int temp2 = allocated_;
     allocated_ = other.allocated_;
     other.allocated_ = temp2;
+
+    int temp3 = inlined_;
+    inlined_ = other.inlined_;
+    other.inlined_ = temp3;
+}
+
+void
+Value::setString(const char* value, unsigned int length)
+{
+    if (length < smallStringSize)
+    {
+        if (length != 0)
+            memcpy(value_.small_, value, length);
+        value_.small_[length] = 0;
+        allocated_ = 0;
+        inlined_ = 1;
+    }
+    else
+    {
+        value_.string_ =
+            valueAllocator()->duplicateStringValue(value, length);
+        allocated_ = 1;
+        inlined_ = 0;
+    }
 }
 
 ValueType
@@ -393,9 +435,9 @@ operator<(const Value& x, const Value& y)
             return x.value_.bool_ < y.value_.bool_;
 
         case stringValue:
-            return (x.value_.string_ == 0 && y.value_.string_) ||
-                (y.value_.string_ && x.value_.string_ &&
-                 strcmp(x.value_.string_, y.value_.string_) < 0);
+            return (x.stringData() == 0 && y.stringData()) ||
+                (y.stringData() && x.stringData() &&
+                 strcmp(x.stringData(), y.stringData()) < 0);
 
         case arrayValue:
         case objectValue: {
@@ -442,9 +484,9 @@ operator==(const Value& x, const Value& y)
             return x.value_.bool_ == y.value_.bool_;
 
         case stringValue:
-            return x.value_.string_ == y.value_.string_ ||
-                (y.value_.string_ && x.value_.string_ &&
-                 !strcmp(x.value_.string_, y.value_.string_));
+            return x.stringData() == y.stringData() ||
+                (y.stringData() && x.stringData() &&
+                 !strcmp(x.stringData(), y.stringData()));
 
         case arrayValue:
         case objectValue:
@@ -462,7 +504,7 @@ const char*
 Value::asCString() const
 {
     JSON_ASSERT(type_ == stringValue);
-    return value_.string_;
+    return stringData();
 }
 
 std::string
@@ -474,7 +516,7 @@ Value::asString() const
             return "";
 
         case stringValue:
-            return value_.string_ ? value_.string_ : "";
+            return stringData() ? stringData() : "";
 
         case booleanValue:
             return value_.bool_ ? "true" : "false";
@@ -526,7 +568,7 @@ Value::asInt() const
             return value_.bool_ ? 1 : 0;
 
         case stringValue: {
-            char const* const str{value_.string_ ? value_.string_ : ""};
+            char const* const str{stringData() ? stringData() : ""};
             return beast::lexicalCastThrow<int>(str);
         }
 
@@ -568,7 +610,7 @@ Value::asUInt() const
             return value_.bool_ ? 1 : 0;
 
         case stringValue: {
-            char const* const str{value_.string_ ? value_.string_ : ""};
+            char const* const str{stringData() ? stringData() : ""};
             return beast::lexicalCastThrow<unsigned int>(str);
         }
 
@@ -634,7 +676,7 @@ Value::asBool() const
             return value_.bool_;
 
         case stringValue:
-            return value_.string_ && value_.string_[0] != 0;
+            return stringData() && stringData()[0] != 0;
 
         case arrayValue:
         case objectValue:
@@ -684,7 +726,7 @@ Value::isConvertibleTo(ValueType other) const
         case stringValue:
             return other == stringValue ||
                 (other == nullValue &&
-                 (!value_.string_ || value_.string_[0] == 0));
+                 (!stringData() || stringData()[0] == 0));
 
         case arrayValue:
             return other == arrayValue ||
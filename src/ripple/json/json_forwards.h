@@ -31,6 +31,9 @@ class ValueIteratorBase;
 class ValueIterator;
 class ValueConstIterator;
 
+// Writer.h
+class Writer;
+
 }  // namespace Json
 
 #endif  // JSON_FORWARDS_H_INCLUDED
@@ -20,8 +20,10 @@
 #ifndef RIPPLE_JSON_JSON_VALUE_H_INCLUDED
 #define RIPPLE_JSON_JSON_VALUE_H_INCLUDED
 
+#include <ripple/basics/MemoryArena.h>
 #include <ripple/json/json_forwards.h>
 #include <cstring>
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -191,7 +193,13 @@ private:
     };
 
 public:
-    using ObjectValues = std::map<CZString, Value>;
+    using ObjectValues = std::map<
+        CZString,
+        Value,
+        std::less<CZString>,
+        ripple::ArenaAllocator<
+            std::pair<CZString const, Value>,
+            ripple::MemoryArena::json>>;
 
 public:
     /** \brief Create a default Value of the given type.
@@ -419,6 +427,19 @@ private:
     Value&
     resolveReference(const char* key, bool isStatic);
 
+    // Strings shorter than this, including the terminator, are stored in
+    // the Value itself rather than in a separate allocation.
+    static constexpr unsigned smallStringSize = 16;
+
+    void
+    setString(const char* value, unsigned int length);
+
+    const char*
+    stringData() const
+    {
+        return inlined_ ? value_.small_ : value_.string_;
+    }
+
 private:
     union ValueHolder
     {
@@ -428,9 +449,11 @@ private:
         bool bool_;
         char* string_;
         ObjectValues* map_{nullptr};
+        char small_[smallStringSize];
     } value_;
     ValueType type_ : 8;
     int allocated_ : 1;  // Notes: if declared as bool, bitfield is useless.
+    int inlined_ : 1;    // The string is held in value_.small_
 };
 
 bool
@@ -45,6 +45,10 @@ enum ApplyFlags : std::uint32_t {
 
     // Transaction came from a privileged source
     tapUNLIMITED = 0x400,
+
+    // Transaction is replayed to rebuild a ledger
+    // the network has already validated
+    tapREPLAY = 0x800,
 };
 
 constexpr ApplyFlags
@@ -23,12 +23,23 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/container/aged_unordered_map.h>
 #include <ripple/protocol/STLedgerEntry.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 
 namespace ripple {
 
-/** Caches SLEs by their digest. */
+/** Caches SLEs by their digest.
+
+    The digest of a state leaf covers both its key and its contents, so
+    an entry stays valid for every ledger that holds the same leaf, and
+    is simply never found again once the leaf changes.
+
+    Digests are spread over several independently locked partitions so
+    that readers on many threads rarely contend.
+*/
 class CachedSLEs
 {
 public:
@@ -44,8 +55,10 @@ public:
     CachedSLEs(
         std::chrono::duration<Rep, Period> const& timeToLive,
         Stopwatch& clock)
-        : timeToLive_(timeToLive), map_(clock)
+        : timeToLive_(timeToLive)
     {
+        for (auto& partition : partitions_)
+            partition = std::make_unique<Partition>(clock);
     }
 
     /** Discard expired entries.
@@ -66,24 +79,26 @@ public:
     value_type
     fetch(digest_type const& digest, Handler const& h)
     {
+        auto& partition = partitionFor(digest);
         {
-            std::lock_guard lock(mutex_);
-            auto iter = map_.find(digest);
-            if (iter != map_.end())
+            std::lock_guard lock(partition.mutex);
+            auto iter = partition.map.find(digest);
+            if (iter != partition.map.end())
             {
-                ++hit_;
-                map_.touch(iter);
+                hit_.fetch_add(1, std::memory_order_relaxed);
+                partition.map.touch(iter);
                 return iter->second;
             }
         }
         auto sle = h();
         if (!sle)
             return nullptr;
-        std::lock_guard lock(mutex_);
-        ++miss_;
-        auto const [it, inserted] = map_.emplace(digest, std::move(sle));
+        miss_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard lock(partition.mutex);
+        auto const [it, inserted] =
+            partition.map.emplace(digest, std::move(sle));
         if (!inserted)
-            map_.touch(it);
+            partition.map.touch(it);
         return it->second;
     }
 
@@ -91,17 +106,53 @@ public:
     double
     rate() const;
 
+    /** Returns the number of lookups that found their SLE. */
+    std::uint64_t
+    hits() const
+    {
+        return hit_.load(std::memory_order_relaxed);
+    }
+
+    /** Returns the number of lookups that had to deserialize. */
+    std::uint64_t
+    misses() const
+    {
+        return miss_.load(std::memory_order_relaxed);
+    }
+
+    /** Returns the number of SLEs held. */
+    std::size_t
+    size() const;
+
 private:
-    std::size_t hit_ = 0;
-    std::size_t miss_ = 0;
-    std::mutex mutable mutex_;
+    static constexpr std::size_t partitionCount = 16;
+
+    struct Partition
+    {
+        explicit Partition(Stopwatch& clock) : map(clock)
+        {
+        }
+
+        std::mutex mutable mutex;
+        beast::aged_unordered_map<
+            digest_type,
+            value_type,
+            Stopwatch::clock_type,
+            hardened_hash<strong_hash>>
+            map;
+    };
+
+    Partition&
+    partitionFor(digest_type const& digest)
+    {
+        // The digest is already uniformly distributed.
+        return *partitions_[*digest.begin() % partitionCount];
+    }
+
+    std::atomic<std::uint64_t> hit_{0};
+    std::atomic<std::uint64_t> miss_{0};
     Stopwatch::duration timeToLive_;
-    beast::aged_unordered_map<
-        digest_type,
-        value_type,
-        Stopwatch::clock_type,
-        hardened_hash<strong_hash>>
-        map_;
+    std::array<std::unique_ptr<Partition>, partitionCount> partitions_;
 };
 
 }  // namespace ripple
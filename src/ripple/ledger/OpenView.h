@@ -46,6 +46,19 @@ struct open_ledger_t
 
 extern open_ledger_t const open_ledger;
 
+/** Batch view construction tag.
+
+    Views constructed with this tag number their
+    transactions after those already applied to
+    the view they will later be applied to.
+*/
+struct batch_view_t
+{
+    explicit batch_view_t() = default;
+};
+
+extern batch_view_t const batch_view;
+
 //------------------------------------------------------------------------------
 
 /** Writable ledger view that accumulates state and tx changes.
@@ -96,6 +109,7 @@ private:
     ReadView const* base_;
     detail::RawStateTable items_;
     std::shared_ptr<void const> hold_;
+    std::size_t baseTxCount_ = 0;
     bool open_ = true;
 
 public:
@@ -170,6 +184,17 @@ public:
     */
     OpenView(ReadView const* base, std::shared_ptr<void const> hold = nullptr);
 
+    /** Construct a view holding part of a batch of changes.
+
+        Effects:
+
+            As for a new last closed ledger, except that
+            txCount() starts at `baseTxCount`, so that the
+            metadata of transactions applied to this view
+            numbers them after that many others.
+    */
+    OpenView(batch_view_t, ReadView const* base, std::size_t baseTxCount);
+
     /** Returns true if this reflects an open ledger. */
     bool
     open() const override
@@ -180,7 +205,8 @@ public:
     /** Return the number of tx inserted since creation.
 
         This is used to set the "apply ordinal"
-        when calculating transaction metadata.
+        when calculating transaction metadata. For
+        a batch view it includes the base count.
     */
     std::size_t
     txCount() const;
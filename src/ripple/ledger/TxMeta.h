@@ -91,6 +91,12 @@ public:
     {
         return getAsObject().getJson(p);
     }
+
+    void
+    writeJson(Json::Writer& w, JsonOptions p) const
+    {
+        getAsObject().writeJson(w, p);
+    }
     void
     addRaw(Serializer&, TER, std::uint32_t index);
 
@@ -103,6 +103,11 @@ forEachItem(
     std::function<void(std::shared_ptr<SLE const> const&)> f);
 
 /** Iterate all items after an item in an owner directory.
+
+    With a correct hint only the pages from the one holding `after` on are
+    read, so paging through a large directory costs the size of each page
+    rather than the position in the directory.
+
     @param after The key of the item to start after
     @param hint The directory page containing `after`
     @param limit The maximum number of items to return
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_LEDGER_APPLYSTATETABLE_H_INCLUDED
 #define RIPPLE_LEDGER_APPLYSTATETABLE_H_INCLUDED
 
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/basics/XRPAmount.h>
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/ledger/OpenView.h>
@@ -27,6 +28,10 @@
 #include <ripple/ledger/ReadView.h>
 #include <ripple/ledger/TxMeta.h>
 #include <ripple/protocol/TER.h>
+#include <boost/container/pmr/flat_map.hpp>
+#include <boost/container/pmr/monotonic_buffer_resource.hpp>
+#include <array>
+#include <cstddef>
 #include <memory>
 
 namespace ripple {
@@ -46,13 +51,50 @@ private:
         modify,
     };
 
-    using items_t = std::map<key_type, std::pair<Action, std::shared_ptr<SLE>>>;
+    // A table is built for every transaction in every sandbox, so its
+    // items live in an arena that starts with a block of its own, sized
+    // for the initial items. Most tables never need another allocation.
+    struct Arena
+    {
+        static constexpr std::size_t initialSize = 1024;
+
+        alignas(std::max_align_t) std::array<std::byte, initialSize> buffer;
+        boost::container::pmr::monotonic_buffer_resource resource{
+            buffer.data(),
+            buffer.size()};
+    };
 
+    // The items are kept sorted in one block. Tables are small enough
+    // that inserting in the middle costs less than a node per item.
+    static constexpr std::size_t initialItems = 16;
+
+    struct sleAction
+    {
+        Action action;
+        std::shared_ptr<SLE> sle;
+
+        // Constructor needed for emplacement in the flat_map
+        sleAction(Action action_, std::shared_ptr<SLE> sle_)
+            : action(action_), sle(std::move(sle_))
+        {
+        }
+    };
+
+    using items_t = boost::container::pmr::flat_map<key_type, sleAction>;
+
+    // arena_ must outlive `items_`. Make it a pointer so the table may be
+    // moved.
+    std::unique_ptr<Arena> arena_;
     items_t items_;
     XRPAmount dropsDestroyed_{0};
 
 public:
-    ApplyStateTable() = default;
+    // The arena is default initialized, so that its block is not zeroed
+    ApplyStateTable() : arena_(new Arena), items_(&arena_->resource)
+    {
+        items_.reserve(initialItems);
+    }
+
     ApplyStateTable(ApplyStateTable&&) = default;
 
     ApplyStateTable(ApplyStateTable const&) = delete;
@@ -125,7 +167,7 @@ public:
     }
 
 private:
-    using Mods = hash_map<key_type, std::shared_ptr<SLE>>;
+    using Mods = uniform_hash_map<key_type, std::shared_ptr<SLE>>;
 
     static void
     threadItem(TxMeta& meta, std::shared_ptr<SLE> const& to);
@@ -25,20 +25,28 @@ namespace ripple {
 void
 CachedSLEs::expire()
 {
-    std::vector<std::shared_ptr<void const>> trash;
+    for (auto& partition : partitions_)
     {
-        auto const expireTime = map_.clock().now() - timeToLive_;
-        std::lock_guard lock(mutex_);
-        for (auto iter = map_.chronological.begin();
-             iter != map_.chronological.end();
-             ++iter)
+        // Release the expired SLEs after the lock is dropped.
+        std::vector<std::shared_ptr<void const>> trash;
         {
-            if (iter.when() > expireTime)
-                break;
-            if (iter->second.unique())
+            auto const expireTime =
+                partition->map.clock().now() - timeToLive_;
+            std::lock_guard lock(partition->mutex);
+            for (auto iter = partition->map.chronological.begin();
+                 iter != partition->map.chronological.end();)
             {
-                trash.emplace_back(std::move(iter->second));
-                iter = map_.erase(iter);
+                if (iter.when() > expireTime)
+                    break;
+                if (iter->second.unique())
+                {
+                    trash.emplace_back(std::move(iter->second));
+                    iter = partition->map.erase(iter);
+                }
+                else
+                {
+                    ++iter;
+                }
             }
         }
     }
@@ -47,11 +55,23 @@ CachedSLEs::expire()
 double
 CachedSLEs::rate() const
 {
-    std::lock_guard lock(mutex_);
-    auto const tot = hit_ + miss_;
+    auto const hit = hits();
+    auto const tot = hit + misses();
     if (tot == 0)
         return 0;
-    return double(hit_) / tot;
+    return double(hit) / tot;
+}
+
+std::size_t
+CachedSLEs::size() const
+{
+    std::size_t total = 0;
+    for (auto const& partition : partitions_)
+    {
+        std::lock_guard lock(partition->mutex);
+        total += partition->map.size();
+    }
+    return total;
 }
 
 }  // namespace ripple
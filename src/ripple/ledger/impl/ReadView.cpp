@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/ledger/ReadView.h>
 #include <boost/optional.hpp>
 
@@ -25,7 +26,7 @@ namespace ripple {
 class Rules::Impl
 {
 private:
-    std::unordered_set<uint256, hardened_hash<>> set_;
+    uniform_hash_set<uint256> set_;
     boost::optional<uint256> digest_;
     std::unordered_set<uint256, beast::uhash<>> const& presets_;
 
@@ -29,6 +29,7 @@
 #include <ripple/protocol/Quality.h>
 #include <ripple/protocol/st.h>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <cassert>
 
 namespace ripple {
@@ -289,28 +290,35 @@ forEachItemAfter(
     if (after.isNonZero())
     {
         auto const hintIndex = keylet::page(rootIndex, hint);
-        auto hintDir = view.read(hintIndex);
-        if (hintDir)
+        auto ownerDir = view.read(hintIndex);
+        std::size_t next = 0;
+        if (ownerDir)
         {
-            for (auto const& key : hintDir->getFieldV256(sfIndexes))
+            // Resume right after the item, without searching the page again
+            auto const& keys = ownerDir->getFieldV256(sfIndexes);
+            next = std::distance(
+                keys.begin(), std::find(keys.begin(), keys.end(), after));
+            if (next == keys.size())
+                ownerDir.reset();
+            else
             {
-                if (key == after)
-                {
-                    // We found the hint, we can start here
-                    currentIndex = hintIndex;
-                    break;
-                }
+                currentIndex = hintIndex;
+                ++next;
             }
         }
 
-        bool found = false;
+        // Without a good hint, search the directory from its root
+        bool found = ownerDir != nullptr;
         for (;;)
         {
-            auto const ownerDir = view.read(currentIndex);
+            if (!ownerDir)
+                ownerDir = view.read(currentIndex);
             if (!ownerDir)
                 return found;
-            for (auto const& key : ownerDir->getFieldV256(sfIndexes))
+            auto const& keys = ownerDir->getFieldV256(sfIndexes);
+            for (auto i = next; i < keys.size(); ++i)
             {
+                auto const& key = keys[i];
                 if (!found)
                 {
                     if (key == after)
@@ -326,6 +334,8 @@ forEachItemAfter(
             if (uNodeNext == 0)
                 return found;
             currentIndex = keylet::page(rootIndex, uNodeNext);
+            ownerDir.reset();
+            next = 0;
         }
     }
     else
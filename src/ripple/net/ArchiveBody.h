@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NET_ARCHIVEBODY_H
+#define RIPPLE_NET_ARCHIVEBODY_H
+
+#include <ripple/basics/Archive.h>
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <memory>
+
+namespace ripple {
+
+/** An HTTP body that extracts a tar.lz4 archive as it is received.
+
+    Nothing but the extracted files is written to disk. Because no
+    partial archive is kept, an interrupted download cannot be resumed.
+
+    ArchiveBody needs to meet requirements from beast which is why some
+    conventions used elsewhere in this code base are not followed.
+*/
+struct ArchiveBody
+{
+    // Algorithm for storing buffers when parsing.
+    class reader;
+
+    // The type of the @ref message::body member.
+    class value_type;
+};
+
+class ArchiveBody::value_type
+{
+    friend class reader;
+
+    boost::filesystem::path dst_;
+    std::unique_ptr<TarLz4Extractor> extractor_;
+    bool complete_ = false;
+
+public:
+    /// Returns `true` if an extraction is in progress
+    bool
+    is_open() const
+    {
+        return static_cast<bool>(extractor_);
+    }
+
+    /// Returns `true` if the whole archive was extracted
+    bool
+    complete() const
+    {
+        return complete_;
+    }
+
+    /** Start extracting into the given directory
+
+        @param dst The directory to extract to
+
+        @param maxBuffered The maximum number of received bytes
+                           held in memory before the reader blocks
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    open(
+        boost::filesystem::path const& dst,
+        std::size_t maxBuffered,
+        boost::system::error_code& ec)
+    {
+        try
+        {
+            dst_ = dst;
+            extractor_ = std::make_unique<TarLz4Extractor>(dst, maxBuffered);
+        }
+        catch (std::exception const&)
+        {
+            ec = boost::system::errc::make_error_code(
+                boost::system::errc::io_error);
+        }
+    }
+
+    /** Wait for the extraction to finish
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    finish(boost::system::error_code& ec)
+    {
+        if (!extractor_)
+            return;
+
+        try
+        {
+            extractor_->finish();
+            complete_ = true;
+        }
+        catch (std::exception const&)
+        {
+            ec = boost::system::errc::make_error_code(
+                boost::system::errc::io_error);
+        }
+        extractor_.reset();
+    }
+
+    /** Stop the extraction if one is in progress
+
+        Unless the whole archive was extracted, the destination
+        directory is removed so a partial extraction is never used.
+    */
+    void
+    close()
+    {
+        if (extractor_)
+        {
+            extractor_->cancel();
+            extractor_.reset();
+        }
+
+        if (!complete_ && !dst_.empty())
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(dst_, ec);
+        }
+    }
+};
+
+/** Algorithm for storing buffers when parsing.
+
+    Objects of this type are created during parsing
+    to store incoming buffers representing the body.
+*/
+class ArchiveBody::reader
+{
+    value_type& body_;  // The body we are extracting
+
+public:
+    template <bool isRequest, class Fields>
+    explicit reader(
+        boost::beast::http::header<isRequest, Fields>&,
+        value_type& b)
+        : body_(b)
+    {
+    }
+
+    void
+    init(boost::optional<std::uint64_t> const&, boost::system::error_code& ec)
+    {
+        // The extraction must have been started with open()
+        if (!body_.is_open())
+        {
+            ec = boost::system::errc::make_error_code(
+                boost::system::errc::bad_file_descriptor);
+        }
+    }
+
+    // Hands the buffers to the extractor, blocking while
+    // it is behind by more than its buffer limit.
+    template <class ConstBufferSequence>
+    std::size_t
+    put(ConstBufferSequence const& buffers, boost::system::error_code& ec)
+    {
+        std::size_t bytes = 0;
+        try
+        {
+            for (auto it = boost::asio::buffer_sequence_begin(buffers);
+                 it != boost::asio::buffer_sequence_end(buffers);
+                 ++it)
+            {
+                boost::asio::const_buffer const buffer{*it};
+                body_.extractor_->write(buffer.data(), buffer.size());
+                bytes += buffer.size();
+            }
+        }
+        catch (std::exception const&)
+        {
+            ec = boost::system::errc::make_error_code(
+                boost::system::errc::io_error);
+        }
+        return bytes;
+    }
+
+    // Waits for the extractor to write out the rest of the archive.
+    void
+    finish(boost::system::error_code& ec)
+    {
+        body_.finish(ec);
+    }
+};
+
+}  // namespace ripple
+
+#endif  // RIPPLE_NET_ARCHIVEBODY_H
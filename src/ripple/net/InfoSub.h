@@ -26,7 +26,9 @@
 #include <ripple/json/json_value.h>
 #include <ripple/protocol/Book.h>
 #include <ripple/resource/Consumer.h>
+#include <memory>
 #include <mutex>
+#include <string>
 
 namespace ripple {
 
@@ -34,6 +36,40 @@ namespace ripple {
 // Master operational handler, server sequencer, network tracker
 
 class PathRequest;
+class TransactionFilter;
+
+/** A message published to many subscribers.
+
+    The text of the message is written the first time a subscriber asks
+    for it and then shared, so an event is serialized once however many
+    subscribers it goes to.
+*/
+class PublishedJson
+{
+public:
+    explicit PublishedJson(Json::Value const& jv) : jv_(jv)
+    {
+    }
+
+    PublishedJson(PublishedJson const&) = delete;
+    PublishedJson&
+    operator=(PublishedJson const&) = delete;
+
+    Json::Value const&
+    json() const
+    {
+        return jv_;
+    }
+
+    /** The serialized message. */
+    std::shared_ptr<std::string const> const&
+    text() const;
+
+private:
+    Json::Value const& jv_;
+    mutable std::once_flag once_;
+    mutable std::shared_ptr<std::string const> text_;
+};
 
 /** Manages a client's subscription to data feeds.
  */
@@ -109,6 +145,12 @@ public:
 
         virtual bool
         subTransactions(ref ispListener) = 0;
+        // Only the transactions the filter matches are sent. Subscribing
+        // again replaces the filter, or removes it.
+        virtual bool
+        subTransactions(
+            ref ispListener,
+            std::shared_ptr<TransactionFilter const> filter) = 0;
         virtual bool
         unsubTransactions(std::uint64_t uListener) = 0;
 
@@ -158,6 +200,17 @@ public:
     virtual void
     send(Json::Value const& jvObj, bool broadcast) = 0;
 
+    /** Send a message that is published to many subscribers.
+
+        Subscribers that can send the serialized text as is override this
+        to share it; the default sends the JSON.
+    */
+    virtual void
+    publish(PublishedJson const& msg, bool broadcast)
+    {
+        send(msg.json(), broadcast);
+    }
+
     std::uint64_t
     getSeq();
 
@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NET_SUBSCRIBERFANOUT_H_INCLUDED
+#define RIPPLE_NET_SUBSCRIBERFANOUT_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/json/json_value.h>
+#include <ripple/net/InfoSub.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Delivers stream messages to subscribers from the job queue.
+
+    Publishing hands a message and its subscribers over and returns
+    without waiting for delivery. Subscribers are split into shards by
+    sequence number. Each shard is drained by at most one job at a time, so
+    every subscriber receives messages in the order they were published,
+    while different shards deliver in parallel.
+
+    A shard that falls more than a backlog behind drops its oldest message
+    for each new one. Slow websocket clients are normally disconnected by
+    their session's send queue limit well before that happens.
+*/
+class SubscriberFanout
+{
+public:
+    static constexpr std::size_t defaultMaxBacklog = 4096;
+
+    SubscriberFanout(
+        JobQueue& jobQueue,
+        beast::Journal journal,
+        std::size_t maxBacklog = defaultMaxBacklog);
+
+    SubscriberFanout(SubscriberFanout const&) = delete;
+    SubscriberFanout&
+    operator=(SubscriberFanout const&) = delete;
+
+    /** Queue a message for delivery to subscribers. */
+    void
+    publish(Json::Value jv, std::vector<InfoSub::pointer> subscribers);
+
+    /** The number of messages dropped because a shard fell behind. */
+    std::uint64_t
+    dropped() const
+    {
+        return dropped_;
+    }
+
+private:
+    struct Event
+    {
+        explicit Event(Json::Value&& jv_) : jv(std::move(jv_)), msg(jv)
+        {
+        }
+
+        Json::Value const jv;
+        PublishedJson const msg;
+    };
+
+    struct Delivery
+    {
+        std::shared_ptr<Event const> event;
+        std::vector<InfoSub::pointer> subscribers;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::deque<Delivery> queue;
+        bool running = false;
+        bool dropping = false;
+    };
+
+    void
+    drain(Shard& shard);
+
+    static constexpr std::size_t shardCount = 8;
+
+    JobQueue& jobQueue_;
+    beast::Journal const j_;
+    std::size_t const maxBacklog_;
+    std::array<Shard, shardCount> shards_;
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace ripple
+
+#endif
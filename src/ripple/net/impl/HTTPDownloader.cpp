@@ -271,6 +271,11 @@ HTTPDownloader::do_session(
         }
 
         stream_->asyncReadSome(read_buf_, *p, yield, ec);
+
+        // A failed read, or a body that rejected its data,
+        // leaves the parser unable to make progress
+        if (ec)
+            return failAndExit("async_read_some", p);
     }
 
     JLOG(j_.trace()) << "download completed: " << dstPath.string();
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/json/json_writer.h>
 #include <ripple/net/InfoSub.h>
 #include <atomic>
 
@@ -35,6 +36,21 @@ namespace ripple {
 
 //------------------------------------------------------------------------------
 
+std::shared_ptr<std::string const> const&
+PublishedJson::text() const
+{
+    std::call_once(once_, [this]() {
+        auto s = std::make_shared<std::string>();
+        Json::stream(jv_, [&s](void const* data, std::size_t n) {
+            s->append(static_cast<char const*>(data), n);
+        });
+        text_ = std::move(s);
+    });
+    return text_;
+}
+
+//------------------------------------------------------------------------------
+
 InfoSub::Source::Source(char const* name, Stoppable& parent)
     : Stoppable(name, parent)
 {
@@ -557,6 +557,28 @@ private:
         return jvRequest;
     }
 
+    // get_trace [clear|start|stop]
+    Json::Value
+    parseGetTrace(Json::Value const& jvParams)
+    {
+        Json::Value jvRequest(Json::objectValue);
+
+        if (jvParams.size())
+        {
+            auto const what = jvParams[0u].asString();
+            if (what == "clear")
+                jvRequest[jss::clear] = true;
+            else if (what == "start")
+                jvRequest[jss::enable] = true;
+            else if (what == "stop")
+                jvRequest[jss::enable] = false;
+            else
+                return rpcError(rpcINVALID_PARAMS);
+        }
+
+        return jvRequest;
+    }
+
     // sign_for <account> <secret> <json> offline
     // sign_for <account> <secret> <json>
     Json::Value
@@ -1245,6 +1267,7 @@ public:
             {"fetch_info", &RPCParser::parseFetchInfo, 0, 1},
             {"gateway_balances", &RPCParser::parseGatewayBalances, 1, -1},
             {"get_counts", &RPCParser::parseGetCounts, 0, 1},
+            {"get_trace", &RPCParser::parseGetTrace, 0, 1},
             {"json", &RPCParser::parseJson, 2, 2},
             {"json2", &RPCParser::parseJson2, 1, 1},
             {"ledger", &RPCParser::parseLedger, 0, 2},
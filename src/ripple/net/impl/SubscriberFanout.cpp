@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/net/SubscriberFanout.h>
+
+namespace ripple {
+
+SubscriberFanout::SubscriberFanout(
+    JobQueue& jobQueue,
+    beast::Journal journal,
+    std::size_t maxBacklog)
+    : jobQueue_(jobQueue), j_(journal), maxBacklog_(maxBacklog)
+{
+}
+
+void
+SubscriberFanout::publish(
+    Json::Value jv,
+    std::vector<InfoSub::pointer> subscribers)
+{
+    if (subscribers.empty())
+        return;
+
+    auto const event = std::make_shared<Event const>(std::move(jv));
+
+    std::array<std::vector<InfoSub::pointer>, shardCount> split;
+    for (auto& s : subscribers)
+    {
+        auto const i = s->getSeq() % shardCount;
+        split[i].push_back(std::move(s));
+    }
+
+    for (std::size_t i = 0; i < shardCount; ++i)
+    {
+        if (split[i].empty())
+            continue;
+
+        auto& shard = shards_[i];
+        std::lock_guard lock(shard.mutex);
+        if (shard.queue.size() >= maxBacklog_)
+        {
+            shard.queue.pop_front();
+            ++dropped_;
+            if (!shard.dropping)
+            {
+                JLOG(j_.warn()) << "Subscriber shard " << i << " is "
+                                << maxBacklog_
+                                << " messages behind, dropping the oldest";
+                shard.dropping = true;
+            }
+        }
+        shard.queue.push_back({event, std::move(split[i])});
+
+        if (!shard.running)
+        {
+            shard.running = jobQueue_.addJob(
+                jtPUBLISH, "SubscriberFanout", [this, &shard](Job&) {
+                    drain(shard);
+                });
+            // The job queue is stopping
+            if (!shard.running)
+                shard.queue.clear();
+        }
+    }
+}
+
+void
+SubscriberFanout::drain(Shard& shard)
+{
+    for (;;)
+    {
+        Delivery d;
+        {
+            std::lock_guard lock(shard.mutex);
+            if (shard.queue.empty())
+            {
+                shard.running = false;
+                shard.dropping = false;
+                return;
+            }
+            d = std::move(shard.queue.front());
+            shard.queue.pop_front();
+        }
+
+        for (auto const& s : d.subscribers)
+            s->publish(d.event->msg, true);
+    }
+}
+
+}  // namespace ripple
@@ -20,9 +20,11 @@
 #ifndef RIPPLE_NODESTORE_BACKEND_H_INCLUDED
 #define RIPPLE_NODESTORE_BACKEND_H_INCLUDED
 
+#include <ripple/json/json_value.h>
 #include <ripple/nodestore/Types.h>
 #include <atomic>
 #include <cstdint>
+#include <functional>
 
 namespace ripple {
 namespace NodeStore {
@@ -105,6 +107,26 @@ public:
     virtual Status
     fetch(void const* key, std::shared_ptr<NodeObject>* pObject) = 0;
 
+    /** Fetch a single object and pass its payload to a visitor.
+        Backends which decode objects from their own buffers override
+        this so that callers which only parse the payload do not need a
+        NodeObject. The visitor is invoked only if the object is found,
+        and the payload is only valid for the duration of that call.
+        @note This will be called concurrently.
+        @param key A pointer to the key data.
+        @param visit The function to invoke with the payload.
+        @return The result of the operation.
+    */
+    virtual Status
+    fetchPayload(void const* key, std::function<void(Slice)> const& visit)
+    {
+        std::shared_ptr<NodeObject> object;
+        auto const status = fetch(key, &object);
+        if (status == ok && object)
+            visit(object->getData());
+        return status;
+    }
+
     /** Return `true` if batch fetches are optimized. */
     virtual bool
     canFetchBatch() = 0;
@@ -122,6 +144,18 @@ public:
     virtual void
     store(std::shared_ptr<NodeObject> const& object) = 0;
 
+    /** Store several objects, the way @ref store stores one.
+        Implementations that queue writes take the objects all at once.
+        @note This will be called concurrently.
+        @param batch The objects to store.
+    */
+    virtual void
+    storeMany(Batch const& batch)
+    {
+        for (auto const& object : batch)
+            store(object);
+    }
+
     /** Store a group of objects.
         @note This function will not be called concurrently with
               itself or @ref store.
@@ -168,6 +202,12 @@ public:
         return std::nullopt;
     }
 
+    /** Add statistics specific to the backend to a get_counts report. */
+    virtual void
+    getCountsJson(Json::Value& obj) const
+    {
+    }
+
     /** Returns true if the backend uses permanent storage. */
     bool
     backed() const
@@ -86,6 +86,18 @@ public:
     virtual void
     import(Database& source) = 0;
 
+    /** Visit every object in the database.
+
+        This reads the whole database, for offline tools.
+
+        @note This must not be called concurrently with other methods.
+    */
+    void
+    forEach(std::function<void(std::shared_ptr<NodeObject>)> f)
+    {
+        for_each(std::move(f));
+    }
+
     /** Retrieve the estimated number of pending write operations.
         This is used for diagnostics.
     */
@@ -111,6 +123,17 @@ public:
         uint256 const& hash,
         std::uint32_t ledgerSeq) = 0;
 
+    /** Store several objects of one ledger, as @ref store would.
+
+        Backends that queue their writes take the whole batch at once,
+        rather than once for each object.
+
+        @param batch The objects to store.
+        @param ledgerSeq The sequence of the ledger the objects belong to.
+    */
+    virtual void
+    storeBatch(Batch const& batch, std::uint32_t ledgerSeq);
+
     /* Check if two ledgers are in the same database
 
         If these two sequence numbers map to the same database,
@@ -146,6 +169,42 @@ public:
         std::uint32_t ledgerSeq = 0,
         FetchType fetchType = FetchType::synchronous);
 
+    /** Fetch an object and pass its payload to a visitor.
+        This behaves like fetchNodeObject, but allows the database to
+        decode the object directly from the backend's buffers instead of
+        constructing a NodeObject. The payload is only valid for the
+        duration of the call to the visitor.
+
+        @note This can be called concurrently.
+        @param hash The key of the object to retrieve.
+        @param ledgerSeq The sequence of the ledger where the object is stored.
+        @param visit The function to invoke with the payload.
+        @param fetchType the type of fetch, synchronous or asynchronous.
+        @return `true` if the object was found and the visitor invoked.
+    */
+    bool
+    fetchNodePayload(
+        uint256 const& hash,
+        std::uint32_t ledgerSeq,
+        std::function<void(Slice)> const& visit,
+        FetchType fetchType = FetchType::synchronous);
+
+    /** Fetch several objects for the calling thread.
+
+        The default implementation fetches each object in turn. Derived
+        classes whose backend can have the reads of a batch in flight
+        together override this.
+
+        @note This can be called concurrently.
+        @param hashes The keys of the objects to retrieve.
+        @param ledgerSeq The sequence of the ledger where the objects are
+                         stored.
+        @return The objects, in the same order as `hashes`. Objects that
+                could not be retrieved are `nullptr`.
+    */
+    virtual std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch(std::vector<uint256> const& hashes, std::uint32_t ledgerSeq);
+
     /** Fetch an object without waiting.
         If I/O is required to determine whether or not the object is present,
         `false` is returned. Otherwise, `true` is returned and `object` is set
@@ -210,7 +269,7 @@ public:
         return fetchSz_;
     }
 
-    void
+    virtual void
     getCountsJson(Json::Value& obj);
 
     /** Returns the number of file descriptors the database expects to need */
@@ -226,6 +285,60 @@ public:
     void
     onChildrenStopped() override;
 
+    /** Returns how many levels below an inner node read from disk
+        should be read ahead asynchronously. Zero disables read ahead.
+    */
+    int
+    prefetchDepth() const
+    {
+        return prefetchDepth_;
+    }
+
+    /** Returns how many subtrees, at each level of its path, a SHAMap
+        range scan should read ahead asynchronously. Zero disables it.
+    */
+    int
+    scanReadAhead() const
+    {
+        return scanReadAhead_;
+    }
+
+    /** Returns the number of threads a SHAMap may use to hash and write
+        its dirty nodes when flushed. One or less flushes serially.
+    */
+    int
+    flushThreads() const
+    {
+        return flushThreads_;
+    }
+
+    /** Returns the number of threads a SHAMap may use to look for the
+        nodes it is missing while syncing. One or less looks serially.
+    */
+    int
+    syncThreads() const
+    {
+        return syncThreads_;
+    }
+
+    /** Returns the number of threads a SHAMap may use to check that all
+        of its nodes are present. One or less checks serially.
+    */
+    int
+    walkThreads() const
+    {
+        return walkThreads_;
+    }
+
+    /** Returns the number of nodes per second that background checks for
+        missing ledger nodes may visit. Zero means no limit.
+    */
+    std::size_t
+    walkRate() const
+    {
+        return walkRate_;
+    }
+
     /** @return The earliest ledger sequence allowed
      */
     std::uint32_t
@@ -269,6 +382,35 @@ protected:
         fetchDurationUs_ += duration;
     }
 
+    /** Fetch several objects on behalf of the asynchronous read threads.
+
+        The default implementation fetches each object individually.
+        Derived classes whose backend services batch reads efficiently
+        may override this to issue a single backend request.
+
+        @param hashes The keys of the objects to retrieve.
+        @param ledgerSeq The sequence of the ledger where the objects are
+                         stored.
+        @return The objects, in the same order as `hashes`. Objects that
+                could not be retrieved are `nullptr`.
+    */
+    virtual std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchAsync(
+        std::vector<uint256> const& hashes,
+        std::uint32_t ledgerSeq);
+
+    /** Fetch an object's payload on behalf of fetchNodePayload.
+
+        The default implementation fetches a NodeObject. Databases that can
+        read the payload without one should override this.
+    */
+    virtual bool
+    fetchNodePayload(
+        uint256 const& hash,
+        std::uint32_t ledgerSeq,
+        std::function<void(Slice)> const& visit,
+        FetchReport& fetchReport);
+
 private:
     std::atomic<std::uint64_t> storeCount_{0};
     std::atomic<std::uint64_t> storeSz_{0};
@@ -276,27 +418,57 @@ private:
     std::atomic<std::uint64_t> fetchDurationUs_{0};
     std::atomic<std::uint64_t> storeDurationUs_{0};
 
-    std::mutex readLock_;
-    std::condition_variable readCondVar_;
+    using ReadCallbacks = std::vector<std::pair<
+        std::uint32_t,
+        std::function<void(std::shared_ptr<NodeObject> const&)>>>;
 
-    // reads to do
-    std::map<
-        uint256,
-        std::vector<std::pair<
-            std::uint32_t,
-            std::function<void(std::shared_ptr<NodeObject> const&)>>>>
-        read_;
+    // Pending asynchronous reads are spread across independently locked
+    // shards, selected by the leading byte of the hash. Each read thread
+    // owns one shard and drains it in batches.
+    struct ReadShard
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+
+        // reads to do
+        std::map<uint256, ReadCallbacks> pending;
 
-    // last read
-    uint256 readLastHash_;
+        // last read
+        uint256 lastHash;
+    };
 
+    std::vector<std::unique_ptr<ReadShard>> readShards_;
     std::vector<std::thread> readThreads_;
-    bool readShut_{false};
+    std::atomic<bool> readShut_{false};
+
+    // Number of distinct hashes waiting to be read
+    std::atomic<std::uint64_t> readQueueDepth_{0};
+    // Number of batches drained by the read threads, and their total size
+    std::atomic<std::uint64_t> readBatchCount_{0};
+    std::atomic<std::uint64_t> readBatchItems_{0};
 
     // The default is 32570 to match the XRP ledger network's earliest
     // allowed sequence. Alternate networks may set this value.
     std::uint32_t const earliestLedgerSeq_;
 
+    // Levels of a SHAMap to read ahead, which needs read threads
+    int prefetchDepth_{0};
+
+    // Subtrees per level a SHAMap scan reads ahead, which needs read threads
+    int scanReadAhead_{0};
+
+    // Threads flushing the branches below a SHAMap root
+    int flushThreads_{1};
+
+    // Threads looking for missing nodes below a SHAMap root
+    int syncThreads_{1};
+
+    // Threads checking that a SHAMap is complete
+    int walkThreads_{1};
+
+    // Nodes per second that background completeness checks may visit
+    std::size_t walkRate_{0};
+
     virtual std::shared_ptr<NodeObject>
     fetchNodeObject(
         uint256 const& hash,
@@ -325,7 +497,7 @@ private:
     }
 
     void
-    threadEntry();
+    threadEntry(ReadShard& shard, int index);
 };
 
 }  // namespace NodeStore
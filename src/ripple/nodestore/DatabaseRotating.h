@@ -46,6 +46,11 @@ public:
 
     /** Rotates the backends.
 
+        Fetches and stores that start while `f` runs wait until the new
+        backends are published, so `f` must not use this database. Those
+        already under way when `f` is called finish on the previous
+        backends.
+
         @param f A function executed before the rotation and under the same lock
     */
     virtual void
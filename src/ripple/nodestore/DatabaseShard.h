@@ -136,6 +136,13 @@ public:
     virtual std::string
     getCompleteShards() = 0;
 
+    /** Report the progress of shards being finalized
+
+        @return An array with an entry for each shard being finalized
+    */
+    virtual Json::Value
+    getFinalizingShards() = 0;
+
     /** @return The maximum number of ledgers stored in a shard
      */
     virtual std::uint32_t
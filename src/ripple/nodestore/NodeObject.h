@@ -22,6 +22,7 @@
 
 #include <ripple/basics/Blob.h>
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/Slice.h>
 #include <ripple/protocol/Protocol.h>
 
 // VFALCO NOTE Intentionally not in the NodeStore namespace
@@ -33,7 +34,9 @@ enum NodeObjectType : std::uint32_t {
     hotUNKNOWN = 0,
     hotLEDGER = 1,
     hotACCOUNT_NODE = 3,
-    hotTRANSACTION_NODE = 4
+    hotTRANSACTION_NODE = 4,
+    // Where a transaction is, see TxIndex.h
+    hotTX_INDEX = 5
 };
 
 /** A simple object that the Ledger uses to store entries.
@@ -42,6 +45,12 @@ enum NodeObjectType : std::uint32_t {
     the blob. The blob is a variable length block of serialized data. The
     type identifies what the blob contains.
 
+    The object shares an allocation with its shared_ptr control block,
+    and a payload that is copied in is held in a second one. Both are
+    drawn from a pool of size classes, so that memory released by one
+    object is recycled for the next. A payload moved in as a Blob is kept
+    where it is.
+
     @note No checking is performed to make sure the hash matches the data.
     @see SHAMap
 */
@@ -50,30 +59,61 @@ class NodeObject : public CountedObject<NodeObject>
 public:
     static constexpr std::size_t keyBytes = 32;
 
+    /** Statistics about the memory used by NodeObject allocations. */
+    struct PoolStats
+    {
+        // Bytes in allocations owned by live objects
+        std::uint64_t allocatedBytes = 0;
+
+        // Bytes in released allocations kept for reuse
+        std::uint64_t cachedBytes = 0;
+
+        // Estimated bytes live objects would use with a separately
+        // allocated payload, for comparison with allocatedBytes
+        std::uint64_t legacyBytes = 0;
+
+        // Number of allocations satisfied from released memory
+        std::uint64_t reused = 0;
+    };
+
 private:
     // This hack is used to make the constructor effectively private
-    // except for when we use it in the call to make_shared.
-    // There's no portable way to make make_shared<> a friend work.
+    // except for when we use it in the call to allocate_shared.
+    // There's no portable way to make allocate_shared<> a friend work.
     struct PrivateAccess
     {
         explicit PrivateAccess() = default;
     };
 
 public:
-    // This constructor is private, use createObject instead.
+    // These constructors are private, use createObject instead.
     NodeObject(
         NodeObjectType type,
         Blob&& data,
         uint256 const& hash,
         PrivateAccess);
 
+    // Takes ownership of `block`, a pool allocation of at least
+    // `data.size()` bytes, and copies the payload into it.
+    NodeObject(
+        NodeObjectType type,
+        Slice data,
+        std::uint8_t* block,
+        uint256 const& hash,
+        PrivateAccess);
+
+    ~NodeObject();
+
+    NodeObject(NodeObject const&) = delete;
+    NodeObject&
+    operator=(NodeObject const&) = delete;
+
     /** Create an object from fields.
 
         The caller's variable is modified during this call. The
         underlying storage for the Blob is taken over by the NodeObject.
 
         @param type The type of object.
-        @param ledgerIndex The ledger in which this object appears.
         @param data A buffer containing the payload. The caller's variable
                     is overwritten.
         @param hash The 256-bit hash of the payload data.
@@ -81,6 +121,15 @@ public:
     static std::shared_ptr<NodeObject>
     createObject(NodeObjectType type, Blob&& data, uint256 const& hash);
 
+    /** Create an object from fields.
+
+        @param type The type of object.
+        @param data The payload, which is copied into the object.
+        @param hash The 256-bit hash of the payload data.
+    */
+    static std::shared_ptr<NodeObject>
+    createObject(NodeObjectType type, Slice data, uint256 const& hash);
+
     /** Returns the type of this object. */
     NodeObjectType
     getType() const;
@@ -90,13 +139,19 @@ public:
     getHash() const;
 
     /** Returns the underlying data. */
-    Blob const&
+    Slice
     getData() const;
 
+    /** Returns statistics about the memory used by all NodeObjects. */
+    static PoolStats
+    getPoolStats();
+
 private:
     NodeObjectType const mType;
+    std::uint32_t const mSize;
     uint256 const mHash;
-    Blob const mData;
+    Blob const mBlob;
+    std::uint8_t const* const mData;
 };
 
 }  // namespace ripple
@@ -22,12 +22,51 @@
 
 #include <ripple/nodestore/Task.h>
 #include <chrono>
+#include <cstdint>
 
 namespace ripple {
 namespace NodeStore {
 
 enum class FetchType { synchronous, async };
 
+/** The subsystem a fetch is made for. */
+enum class FetchCaller { unknown, rpc, ledgerSync, consensus, onlineDelete };
+
+/** Tags the fetches made on this thread while the object lives.
+
+    Fetches are attributed to the innermost tag on the thread that makes
+    them. Asynchronous fetches are made by the read threads, which batch
+    requests from every caller, so they are left untagged.
+*/
+class ScopedFetchCaller
+{
+public:
+    explicit ScopedFetchCaller(FetchCaller caller) : previous_(current())
+    {
+        current() = caller;
+    }
+
+    ScopedFetchCaller(ScopedFetchCaller const&) = delete;
+    ScopedFetchCaller&
+    operator=(ScopedFetchCaller const&) = delete;
+
+    ~ScopedFetchCaller()
+    {
+        current() = previous_;
+    }
+
+    /** The tag for fetches made on this thread. */
+    static FetchCaller&
+    current()
+    {
+        thread_local FetchCaller caller = FetchCaller::unknown;
+        return caller;
+    }
+
+private:
+    FetchCaller const previous_;
+};
+
 /** Contains information about a fetch operation. */
 struct FetchReport
 {
@@ -35,8 +74,9 @@ struct FetchReport
     {
     }
 
-    std::chrono::milliseconds elapsed;
+    std::chrono::microseconds elapsed;
     FetchType const fetchType;
+    FetchCaller const caller = ScopedFetchCaller::current();
     bool wasFound = false;
 };
 
@@ -47,6 +87,19 @@ struct BatchWriteReport
 
     std::chrono::milliseconds elapsed;
     int writeCount;
+
+    // Payload bytes still waiting to be written when the batch completed
+    std::uint64_t pendingBytes = 0;
+
+    // Time callers spent blocked waiting for room in the write buffers
+    // since the previous report
+    std::chrono::milliseconds stalled{0};
+
+    // Write requests issued to a remote backend that have not completed
+    std::uint64_t inFlight = 0;
+
+    // Total write requests the backend has had to retry
+    std::uint64_t retries = 0;
 };
 
 /** Scheduling for asynchronous backend activity
@@ -37,7 +37,13 @@ enum {
     // in a batch. Actual usage can be twice this since
     // we have a new batch growing as we write the old.
     //
-    batchWriteLimitSize = 65536
+    batchWriteLimitSize = 65536,
+
+    // This sets a limit on the number of pending reads an
+    // asynchronous read thread drains from its queue and
+    // hands to the backend in a single batch.
+    //
+    readBatchLimitSize = 64
 };
 
 /** Return codes from Backend operations. */
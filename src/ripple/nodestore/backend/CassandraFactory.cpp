@@ -29,24 +29,30 @@
 #include <ripple/nodestore/Backend.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/Scheduler.h>
+#include <ripple/nodestore/impl/ConcurrencyWindow.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <ripple/protocol/digest.h>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <exception>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <nudb/nudb.hpp>
+#include <numeric>
 #include <queue>
 #include <sstream>
 #include <thread>
@@ -61,6 +67,94 @@ writeCallback(CassFuture* fut, void* cbData);
 void
 readCallback(CassFuture* fut, void* cbData);
 
+// The token Cassandra's default Murmur3Partitioner assigns to a partition
+// key: the first half of the x64 128-bit MurmurHash3 of the key, seed 0.
+// Tail bytes are sign extended, matching the partitioner's Java code.
+std::int64_t
+murmur3Token(void const* key, std::size_t size)
+{
+    auto const data = static_cast<std::uint8_t const*>(key);
+    auto const rotl = [](std::uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    };
+    auto const fmix = [](std::uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    };
+    auto const tailByte = [data](std::size_t i) {
+        return static_cast<std::uint64_t>(static_cast<std::int8_t>(data[i]));
+    };
+
+    std::uint64_t constexpr c1 = 0x87c37b91114253d5ULL;
+    std::uint64_t constexpr c2 = 0x4cf5ad432745937fULL;
+    std::uint64_t h1 = 0;
+    std::uint64_t h2 = 0;
+
+    std::size_t const blocks = size / 16;
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        std::uint64_t k1 = 0;
+        std::uint64_t k2 = 0;
+        for (int b = 7; b >= 0; --b)
+        {
+            k1 = (k1 << 8) | data[i * 16 + b];
+            k2 = (k2 << 8) | data[i * 16 + 8 + b];
+        }
+
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = rotl(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+        h2 = rotl(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    std::size_t const tail = blocks * 16;
+    std::size_t const rest = size & 15;
+    std::uint64_t k1 = 0;
+    std::uint64_t k2 = 0;
+    for (std::size_t i = rest; i > 8; --i)
+        k2 ^= tailByte(tail + i - 1) << ((i - 9) * 8);
+    if (rest > 8)
+    {
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+    }
+    for (std::size_t i = std::min<std::size_t>(rest, 8); i > 0; --i)
+        k1 ^= tailByte(tail + i - 1) << ((i - 1) * 8);
+    if (rest > 0)
+    {
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+    }
+
+    h1 ^= size;
+    h2 ^= size;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix(h1);
+    h2 = fmix(h2);
+    h1 += h2;
+    return static_cast<std::int64_t>(h1);
+}
+
 class CassandraBackend : public Backend
 {
 private:
@@ -85,6 +179,7 @@ private:
     beast::Journal const j_;
     // size of a key
     size_t const keyBytes_;
+    Scheduler& scheduler_;
 
     Section const config_;
 
@@ -128,14 +223,62 @@ private:
     std::mutex syncMutex_;
     std::condition_variable syncCv_;
 
+    // Every object is written with its own statement, so that token aware
+    // routing sends it straight to a replica of its partition.
+    struct WriteCallbackData
+    {
+        CassandraBackend* backend;
+        // The shared pointer to the node object must exist until it's
+        // confirmed persisted. Otherwise, it can become deleted
+        // prematurely if other copies are removed from caches.
+        std::shared_ptr<NodeObject> no;
+        NodeStore::EncodedBlob e;
+        std::pair<void const*, std::size_t> compressed;
+        std::chrono::steady_clock::time_point begin;
+        // The data is stored in this buffer. The void* in the above member
+        // is a pointer into the below buffer
+        nudb::detail::buffer bf;
+
+        uint32_t currentRetries = 0;
+
+        WriteCallbackData(
+            CassandraBackend* f,
+            std::shared_ptr<NodeObject> const& nobj)
+            : backend(f), no(nobj)
+        {
+            e.prepare(no);
+
+            compressed =
+                NodeStore::nodeobject_compress(e.getData(), e.getSize(), bf);
+        }
+    };
+
+    // The number of writes in flight is limited by an adaptive window
+    // that starts small and grows while writes complete quickly. Guarded
+    // by throttleMutex_.
+    ConcurrencyWindow writeWindow_{32, 4096, std::chrono::milliseconds{50}};
+    std::uint32_t writesInFlight_ = 0;
+
+    // The number of token ranges read latency is tracked for
+    std::size_t tokenBuckets_ = 256;
+
+    // The most reads of one fetchBatch in flight at once
+    std::uint32_t readConcurrency_ = 256;
+    // The average read latency of each token range, in microseconds
+    std::vector<std::atomic<std::uint32_t>> readLatency_;
+
     Counters<std::atomic<std::uint64_t>> counters_;
 
 public:
     CassandraBackend(
         size_t keyBytes,
         Section const& keyValues,
+        Scheduler& scheduler,
         beast::Journal journal)
-        : j_(journal), keyBytes_(keyBytes), config_(keyValues)
+        : j_(journal)
+        , keyBytes_(keyBytes)
+        , scheduler_(scheduler)
+        , config_(keyValues)
     {
     }
 
@@ -467,15 +610,27 @@ public:
             setupPreparedStatements = true;
         }
 
-        work_.emplace(ioContext_);
-        ioThread_ = std::thread{[this]() { ioContext_.run(); }};
-        open_ = true;
-
         if (config_.exists("max_requests_outstanding"))
         {
             maxRequestsOutstanding =
                 get<int>(config_, "max_requests_outstanding");
         }
+
+        tokenBuckets_ = std::max<std::size_t>(
+            1, get<std::size_t>(config_, "read_token_ranges", tokenBuckets_));
+        writeWindow_ = ConcurrencyWindow(
+            get<std::uint32_t>(config_, "write_concurrency_start", 32),
+            get<std::uint32_t>(config_, "write_pipeline_depth", 4096),
+            std::chrono::milliseconds{std::max<std::int64_t>(
+                1, get<std::int64_t>(config_, "write_target_latency_ms", 50))});
+        readConcurrency_ = std::max<std::uint32_t>(
+            1,
+            get<std::uint32_t>(config_, "read_concurrency", readConcurrency_));
+        readLatency_ = std::vector<std::atomic<std::uint32_t>>(tokenBuckets_);
+
+        work_.emplace(ioContext_);
+        ioThread_ = std::thread{[this]() { ioContext_.run(); }};
+        open_ = true;
     }
 
     // Close the connection to the database
@@ -484,6 +639,8 @@ public:
     {
         {
             std::lock_guard<std::mutex> lock(mutex_);
+            if (open_)
+                sync();
             if (insert_)
             {
                 cass_prepared_free(insert_);
@@ -521,8 +678,10 @@ public:
             return backendError;
         }
         CassFuture* fut;
+        std::chrono::steady_clock::time_point begin;
         do
         {
+            begin = std::chrono::steady_clock::now();
             fut = cass_session_execute(session_.get(), statement);
             rc = cass_future_error_code(fut);
             if (rc != CASS_OK)
@@ -535,6 +694,10 @@ public:
                 JLOG(j_.warn()) << ss.str();
             }
         } while (rc != CASS_OK);
+        recordReadLatency(
+            tokenBucket(key),
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - begin));
 
         CassResult const* res = cass_future_get_result(fut);
         cass_statement_free(statement);
@@ -584,33 +747,47 @@ public:
         return true;
     }
 
+    struct ReadBatch;
+
     struct ReadCallbackData
     {
         CassandraBackend& backend;
+        ReadBatch& batch;
         const void* const key;
         std::shared_ptr<NodeObject>& result;
-        std::condition_variable& cv;
-
-        std::atomic_uint32_t& numFinished;
-        size_t batchSize;
+        // The token range of the key
+        std::size_t const range;
+        // When the latest attempt was sent
+        std::chrono::steady_clock::time_point begin;
 
         ReadCallbackData(
             CassandraBackend& backend,
+            ReadBatch& batch,
             const void* const key,
             std::shared_ptr<NodeObject>& result,
-            std::condition_variable& cv,
-            std::atomic_uint32_t& numFinished,
-            size_t batchSize)
+            std::size_t range)
             : backend(backend)
+            , batch(batch)
             , key(key)
             , result(result)
-            , cv(cv)
-            , numFinished(numFinished)
-            , batchSize(batchSize)
+            , range(range)
         {
         }
+    };
+
+    // The reads of one fetchBatch. No more than readConcurrency_ of them
+    // are in flight at once: each one that completes sends the next.
+    struct ReadBatch
+    {
+        std::vector<std::shared_ptr<NodeObject>> results;
+        std::vector<ReadCallbackData> reads;
+        // The order reads are sent in
+        std::vector<std::size_t> order;
 
-        ReadCallbackData(ReadCallbackData const& other) = default;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t sent = 0;
+        std::size_t finished = 0;
     };
 
     std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
@@ -619,33 +796,60 @@ public:
         std::size_t const numHashes = hashes.size();
         JLOG(j_.trace()) << "Fetching " << numHashes
                          << " records from Cassandra";
-        std::atomic_uint32_t numFinished = 0;
-        std::condition_variable cv;
-        std::mutex mtx;
-        std::vector<std::shared_ptr<NodeObject>> results{numHashes};
-        std::vector<std::shared_ptr<ReadCallbackData>> cbs;
-        cbs.reserve(numHashes);
-        for (std::size_t i = 0; i < hashes.size(); ++i)
-        {
-            cbs.push_back(std::make_shared<ReadCallbackData>(
+        if (numHashes == 0)
+            return {{}, ok};
+
+        ReadBatch batch;
+        batch.results.resize(numHashes);
+        batch.reads.reserve(numHashes);
+        for (std::size_t i = 0; i < numHashes; ++i)
+            batch.reads.emplace_back(
                 *this,
-                static_cast<void const*>(hashes[i]),
-                results[i],
-                cv,
-                numFinished,
-                numHashes));
-            read(*cbs[i]);
-        }
-        assert(results.size() == cbs.size());
-
-        std::unique_lock<std::mutex> lck(mtx);
-        cv.wait(lck, [&numFinished, &numHashes]() {
-            return numFinished == numHashes;
-        });
+                batch,
+                static_cast<void const*>(hashes[i]->data()),
+                batch.results[i],
+                tokenBucket(hashes[i]->data()));
+
+        // Reads of one token range are sent together, so token aware
+        // routing keeps them on the replicas that own it. The ranges that
+        // have been slowest go first, since the batch waits on its last
+        // read.
+        batch.order.resize(numHashes);
+        std::iota(batch.order.begin(), batch.order.end(), std::size_t{0});
+        std::vector<std::uint32_t> latency(numHashes);
+        for (std::size_t i = 0; i < numHashes; ++i)
+            latency[i] = readLatency_[batch.reads[i].range].load(
+                std::memory_order_relaxed);
+        std::sort(
+            batch.order.begin(),
+            batch.order.end(),
+            [&batch, &latency](std::size_t a, std::size_t b) {
+                auto const ra = batch.reads[a].range;
+                auto const rb = batch.reads[b].range;
+                if (latency[a] != latency[b])
+                    return latency[a] > latency[b];
+                return ra != rb ? ra < rb : a < b;
+            });
+
+        std::size_t const first =
+            std::min<std::size_t>(numHashes, readConcurrency_);
+        {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            batch.sent = first;
+        }
+        for (std::size_t i = 0; i < first; ++i)
+            read(batch.reads[batch.order[i]]);
+
+        {
+            std::unique_lock<std::mutex> lock(batch.mutex);
+            batch.cv.wait(lock, [&batch, numHashes]() {
+                return batch.finished == numHashes;
+            });
+        }
 
         JLOG(j_.trace()) << "Fetched " << numHashes
                          << " records from Cassandra";
-        return {results, ok};
+        return {std::move(batch.results), ok};
     }
 
     void
@@ -657,15 +861,14 @@ public:
             statement, 0, static_cast<cass_byte_t const*>(data.key), keyBytes_);
         if (rc != CASS_OK)
         {
-            size_t batchSize = data.batchSize;
-            if (++(data.numFinished) == batchSize)
-                data.cv.notify_all();
             cass_statement_free(statement);
             JLOG(j_.error()) << "Binding Cassandra fetch query: " << rc << ", "
                              << cass_error_desc(rc);
+            finishRead(data, false);
             return;
         }
 
+        data.begin = std::chrono::steady_clock::now();
         CassFuture* fut = cass_session_execute(session_.get(), statement);
 
         cass_statement_free(statement);
@@ -674,60 +877,75 @@ public:
         cass_future_free(fut);
     }
 
-    struct WriteCallbackData
+    // Account for a completed read and send the next one of its batch
+    void
+    finishRead(ReadCallbackData& data, bool answered)
     {
-        CassandraBackend* backend;
-        // The shared pointer to the node object must exist until it's
-        // confirmed persisted. Otherwise, it can become deleted
-        // prematurely if other copies are removed from caches.
-        std::shared_ptr<NodeObject> no;
-        NodeStore::EncodedBlob e;
-        std::pair<void const*, std::size_t> compressed;
-        std::chrono::steady_clock::time_point begin;
-        // The data is stored in this buffer. The void* in the above member
-        // is a pointer into the below buffer
-        nudb::detail::buffer bf;
-        std::atomic<std::uint64_t>& totalWriteRetries;
-
-        uint32_t currentRetries = 0;
-
-        WriteCallbackData(
-            CassandraBackend* f,
-            std::shared_ptr<NodeObject> const& nobj,
-            std::atomic<std::uint64_t>& retries)
-            : backend(f), no(nobj), totalWriteRetries(retries)
+        if (answered)
+            recordReadLatency(
+                data.range,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - data.begin));
+
+        auto& batch = data.batch;
+        ReadCallbackData* next = nullptr;
         {
-            e.prepare(no);
-
-            compressed =
-                NodeStore::nodeobject_compress(e.getData(), e.getSize(), bf);
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (batch.sent < batch.order.size())
+                next = &batch.reads[batch.order[batch.sent++]];
+            // The batch may be gone as soon as the lock is released
+            if (++batch.finished == batch.order.size())
+                batch.cv.notify_all();
         }
-    };
+        if (next)
+            read(*next);
+    }
 
+    // Keep a moving average of the read latency of each token range. The
+    // replicas of a range serve all of its reads, so this follows the
+    // hosts a batch is waiting on.
     void
-    write(WriteCallbackData& data, bool isRetry)
+    recordReadLatency(std::size_t range, std::chrono::microseconds latency)
     {
-        {
-            // We limit the total number of concurrent inflight writes. This is
-            // a client side throttling to prevent overloading the database.
-            // This is mostly useful when the very first ledger is being written
-            // in full, which is several millions records. On sufficiently large
-            // Cassandra clusters, this throttling is not needed; the default
-            // value of maxRequestsOutstanding is 10 million, which is more
-            // records than are present in any single ledger
-            std::unique_lock<std::mutex> lck(throttleMutex_);
-            if (!isRetry && numRequestsOutstanding_ > maxRequestsOutstanding)
-            {
-                JLOG(j_.trace()) << __func__ << " : "
-                                 << "Max outstanding requests reached. "
-                                 << "Waiting for other requests to finish";
-                ++counters_.writesDelayed;
-                throttleCv_.wait(lck, [this]() {
-                    return numRequestsOutstanding_ < maxRequestsOutstanding;
-                });
-            }
-        }
+        auto& average = readLatency_[range];
+        auto const sample = static_cast<std::uint32_t>(std::min<std::int64_t>(
+            latency.count(), std::numeric_limits<std::uint32_t>::max()));
+        auto const old = average.load(std::memory_order_relaxed);
+        average.store(
+            old == 0 ? sample : old - old / 8 + sample / 8,
+            std::memory_order_relaxed);
+        if (old != 0 && sample / 4 > old)
+            JLOG(j_.debug()) << "Cassandra read of token range " << range
+                             << " took " << sample << "us, against "
+                             << old << "us on average";
+    }
+
+    std::size_t
+    tokenBucket(void const* key) const
+    {
+        // Shift the signed token range onto [0, 2^64) so that buckets are
+        // contiguous token ranges, then scale to the number of buckets
+        auto const token =
+            static_cast<std::uint64_t>(murmur3Token(key, keyBytes_)) ^
+            (std::uint64_t{1} << 63);
+        return static_cast<std::size_t>(((token >> 32) * tokenBuckets_) >> 32);
+    }
+
+    // Adjust the concurrency window after a write completes or fails.
+    // Must be called with throttleMutex_ held.
+    void
+    adjustConcurrency(bool succeeded, std::chrono::microseconds latency)
+    {
+        auto const before = writeWindow_.limit();
+        writeWindow_.onComplete(succeeded, latency);
+        if (writeWindow_.limit() < before)
+            JLOG(j_.debug()) << "Cassandra write concurrency reduced to "
+                             << writeWindow_.limit();
+    }
 
+    void
+    write(WriteCallbackData& data)
+    {
         CassStatement* statement = cass_prepared_bind(insert_);
         cass_statement_set_consistency(statement, CASS_CONSISTENCY_QUORUM);
         CassError rc = cass_statement_bind_bytes(
@@ -770,11 +988,33 @@ public:
     store(std::shared_ptr<NodeObject> const& no) override
     {
         JLOG(j_.trace()) << "Writing to cassandra";
-        WriteCallbackData* data =
-            new WriteCallbackData(this, no, counters_.writeRetries);
+        {
+            // We limit the total number of concurrent inflight writes. This is
+            // a client side throttling to prevent overloading the database.
+            // This is mostly useful when the very first ledger is being written
+            // in full, which is several millions records. On sufficiently large
+            // Cassandra clusters, this throttling is not needed; the default
+            // value of maxRequestsOutstanding is 10 million, which is more
+            // records than are present in any single ledger
+            std::unique_lock<std::mutex> lck(throttleMutex_);
+            if (numRequestsOutstanding_ > maxRequestsOutstanding ||
+                writesInFlight_ >= writeWindow_.limit())
+            {
+                JLOG(j_.trace()) << __func__ << " : "
+                                 << "Max outstanding requests reached. "
+                                 << "Waiting for other requests to finish";
+                ++counters_.writesDelayed;
+                throttleCv_.wait(lck, [this]() {
+                    return numRequestsOutstanding_ < maxRequestsOutstanding &&
+                        writesInFlight_ < writeWindow_.limit();
+                });
+            }
+            ++writesInFlight_;
+        }
 
+        auto data = new WriteCallbackData(this, no);
         ++numRequestsOutstanding_;
-        write(*data, false);
+        write(*data);
     }
 
     void
@@ -866,9 +1106,7 @@ readCallback(CassFuture* fut, void* cbData)
     else
     {
         auto finish = [&requestParams]() {
-            size_t batchSize = requestParams.batchSize;
-            if (++(requestParams.numFinished) == batchSize)
-                requestParams.cv.notify_all();
+            requestParams.backend.finishRead(requestParams, true);
         };
         CassResult const* res = cass_future_get_result(fut);
 
@@ -925,13 +1163,19 @@ writeCallback(CassFuture* fut, void* cbData)
     CassandraBackend::WriteCallbackData& requestParams =
         *static_cast<CassandraBackend::WriteCallbackData*>(cbData);
     CassandraBackend& backend = *requestParams.backend;
+    auto const latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - requestParams.begin);
     auto rc = cass_future_error_code(fut);
     if (rc != CASS_OK)
     {
         JLOG(backend.j_.error())
             << "ERROR!!! Cassandra insert error: " << rc << ", "
             << cass_error_desc(rc) << ", retrying ";
-        ++requestParams.totalWriteRetries;
+        ++backend.counters_.writeRetries;
+        {
+            std::lock_guard<std::mutex> lck(backend.throttleMutex_);
+            backend.adjustConcurrency(false, latency);
+        }
         // exponential backoff with a max wait of 2^10 ms (about 1 second)
         auto wait = std::chrono::milliseconds(
             lround(std::pow(2, std::min(10u, requestParams.currentRetries))));
@@ -941,20 +1185,34 @@ writeCallback(CassFuture* fut, void* cbData)
                 backend.ioContext_, std::chrono::steady_clock::now() + wait);
         timer->async_wait([timer, &requestParams, &backend](
                               const boost::system::error_code& error) {
-            backend.write(requestParams, true);
+            backend.write(requestParams);
         });
     }
     else
     {
-        backend.counters_.writeDurationUs +=
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now() - requestParams.begin)
-                .count();
-        --(backend.numRequestsOutstanding_);
+        backend.counters_.writeDurationUs += latency.count();
+        {
+            std::lock_guard<std::mutex> lck(backend.throttleMutex_);
+            backend.adjustConcurrency(true, latency);
+            --backend.writesInFlight_;
+            --backend.numRequestsOutstanding_;
+        }
 
         backend.throttleCv_.notify_all();
         if (backend.numRequestsOutstanding_ == 0)
+        {
+            std::lock_guard<std::mutex> lck(backend.syncMutex_);
             backend.syncCv_.notify_all();
+        }
+
+        BatchWriteReport report;
+        report.writeCount = 1;
+        report.elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(latency);
+        report.inFlight = backend.numRequestsOutstanding_;
+        report.retries = backend.counters_.writeRetries;
+        backend.scheduler_.onBatchWrite(report);
+
         delete &requestParams;
     }
 }
@@ -988,7 +1246,8 @@ public:
         Scheduler& scheduler,
         beast::Journal journal) override
     {
-        return std::make_unique<CassandraBackend>(keyBytes, keyValues, journal);
+        return std::make_unique<CassandraBackend>(
+            keyBytes, keyValues, scheduler, journal);
     }
 
     std::unique_ptr<Backend>
@@ -1000,7 +1259,8 @@ public:
         nudb::context& context,
         beast::Journal journal) override
     {
-        return std::make_unique<CassandraBackend>(keyBytes, keyValues, journal);
+        return std::make_unique<CassandraBackend>(
+            keyBytes, keyValues, scheduler, journal);
     }
 };
 
@@ -18,23 +18,40 @@
 //==============================================================================
 
 #include <ripple/basics/contract.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/MappedFile.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <cstdio>
-#include <exception>
+#include <cstring>
 #include <memory>
 #include <nudb/nudb.hpp>
+#include <numeric>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
 
+// Batch reads from all NuDB backends share one pool, so that opening
+// several databases does not multiply the threads reading them
+static WorkerPool&
+nudbFetchPool()
+{
+    static WorkerPool pool(
+        std::min(8u, std::max(1u, std::thread::hardware_concurrency())) - 1);
+    return pool;
+}
+
+// File is the type NuDB uses to access the database files
+template <class File>
 class NuDBBackend : public Backend
 {
 public:
@@ -44,10 +61,22 @@ public:
     size_t const keyBytes_;
     std::size_t const burstSize_;
     std::string const name_;
-    nudb::store db_;
+    nudb::basic_store<nudb::xxhasher, File> db_;
     std::atomic<bool> deletePath_;
     Scheduler& scheduler_;
 
+    // Compresses new objects when configured. Objects written with it
+    // cannot be read back without it.
+    std::shared_ptr<CodecDictionary const> const dict_;
+
+    // Batches at least this large are spread across the fetch pool
+    static constexpr std::size_t parallelBatchMin = 16;
+
+    // Threads shared by the batch reads of every NuDB backend, and the
+    // most of them, the caller included, that one batch may use
+    WorkerPool* fetchPool_{nullptr};
+    std::size_t fetchThreads_{0};
+
     NuDBBackend(
         size_t keyBytes,
         Section const& keyValues,
@@ -60,10 +89,12 @@ public:
         , name_(get<std::string>(keyValues, "path"))
         , deletePath_(false)
         , scheduler_(scheduler)
+        , dict_(loadDictionary(keyValues))
     {
         if (name_.empty())
             Throw<std::runtime_error>(
                 "nodestore: Missing path in NuDB backend");
+        setFetchThreads(keyValues, nudbFetchPool().concurrency());
     }
 
     NuDBBackend(
@@ -80,10 +111,14 @@ public:
         , db_(context)
         , deletePath_(false)
         , scheduler_(scheduler)
+        , dict_(loadDictionary(keyValues))
     {
         if (name_.empty())
             Throw<std::runtime_error>(
                 "nodestore: Missing path in NuDB backend");
+        // Shards share a context and may be numerous, so they read
+        // batches serially unless configured otherwise
+        setFetchThreads(keyValues, 0);
     }
 
     ~NuDBBackend() override
@@ -168,9 +203,10 @@ public:
         nudb::error_code ec;
         db_.fetch(
             key,
-            [key, pno, &status](void const* data, std::size_t size) {
+            [this, key, pno, &status](void const* data, std::size_t size) {
                 nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
+                auto const result =
+                    nodeobject_decompress(data, size, bf, dict_.get());
                 DecodedBlob decoded(key, result.first, result.second);
                 if (!decoded.wasOk())
                 {
@@ -188,6 +224,35 @@ public:
         return status;
     }
 
+    Status
+    fetchPayload(void const* key, std::function<void(Slice)> const& visit)
+        override
+    {
+        Status status;
+        nudb::error_code ec;
+        db_.fetch(
+            key,
+            [this, key, &visit, &status](void const* data, std::size_t size) {
+                nudb::detail::buffer bf;
+                auto const result =
+                    nodeobject_decompress(data, size, bf, dict_.get());
+                DecodedBlob decoded(key, result.first, result.second);
+                if (!decoded.wasOk())
+                {
+                    status = dataCorrupt;
+                    return;
+                }
+                visit(decoded.getData());
+                status = ok;
+            },
+            ec);
+        if (ec == nudb::error::key_not_found)
+            return notFound;
+        if (ec)
+            Throw<nudb::system_error>(ec);
+        return status;
+    }
+
     bool
     canFetchBatch() override
     {
@@ -197,18 +262,44 @@ public:
     std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
     fetchBatch(std::vector<uint256 const*> const& hashes) override
     {
-        std::vector<std::shared_ptr<NodeObject>> results;
-        results.reserve(hashes.size());
-        for (auto const& h : hashes)
+        std::vector<std::shared_ptr<NodeObject>> results(hashes.size());
+        if (fetchThreads_ < 2 || hashes.size() < parallelBatchMin)
         {
-            std::shared_ptr<NodeObject> nObj;
-            Status status = fetch(h->begin(), &nObj);
-            if (status != ok)
-                results.push_back({});
-            else
-                results.push_back(nObj);
+            for (std::size_t i = 0; i < hashes.size(); ++i)
+                fetchOne(*hashes[i], results[i]);
+            return {results, ok};
         }
 
+        // NuDB does not expose the bucket a key maps to, so visit the
+        // keys in sorted order and keep several reads outstanding at
+        // once to fill the device queue.
+        std::vector<std::size_t> order(hashes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(
+            order.begin(),
+            order.end(),
+            [&hashes](std::size_t lhs, std::size_t rhs) {
+                return *hashes[lhs] < *hashes[rhs];
+            });
+
+        std::atomic<bool> stop{false};
+        fetchPool_->run(
+            order.size(),
+            [&](std::size_t i) {
+                if (stop)
+                    return;
+                try
+                {
+                    auto const index = order[i];
+                    fetchOne(*hashes[index], results[index]);
+                }
+                catch (...)
+                {
+                    stop = true;
+                    throw;
+                }
+            },
+            (order.size() + fetchThreads_ - 1) / fetchThreads_);
         return {results, ok};
     }
 
@@ -219,7 +310,8 @@ public:
         e.prepare(no);
         nudb::error_code ec;
         nudb::detail::buffer bf;
-        auto const result = nodeobject_compress(e.getData(), e.getSize(), bf);
+        auto const result =
+            nodeobject_compress(e.getData(), e.getSize(), bf, dict_.get());
         db_.insert(e.getKey(), result.first, result.second, ec);
         if (ec && ec != nudb::error::key_exists)
             Throw<nudb::system_error>(ec);
@@ -274,7 +366,8 @@ public:
                 std::size_t size,
                 nudb::error_code&) {
                 nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
+                auto const result =
+                    nodeobject_decompress(data, size, bf, dict_.get());
                 DecodedBlob decoded(key, result.first, result.second);
                 if (!decoded.wasOk())
                 {
@@ -328,6 +421,35 @@ public:
     {
         return 3;
     }
+
+private:
+    void
+    fetchOne(uint256 const& hash, std::shared_ptr<NodeObject>& result)
+    {
+        if (fetch(hash.begin(), &result) != ok)
+            result.reset();
+    }
+
+    static std::shared_ptr<CodecDictionary const>
+    loadDictionary(Section const& keyValues)
+    {
+        std::string path;
+        if (!get_if_exists(keyValues, "compression_dictionary", path) ||
+            path.empty())
+            return {};
+        return CodecDictionary::load(path);
+    }
+
+    void
+    setFetchThreads(Section const& keyValues, std::size_t threads)
+    {
+        // Setting fetch_threads to 0 restores serial batch reads
+        get_if_exists(keyValues, "fetch_threads", threads);
+        if (threads == 0)
+            return;
+        fetchPool_ = &nudbFetchPool();
+        fetchThreads_ = std::min(threads, fetchPool_->concurrency());
+    }
 };
 
 //------------------------------------------------------------------------------
@@ -359,7 +481,10 @@ public:
         Scheduler& scheduler,
         beast::Journal journal) override
     {
-        return std::make_unique<NuDBBackend>(
+        if (mapReads(keyValues))
+            return std::make_unique<NuDBBackend<MappedFile>>(
+                keyBytes, keyValues, burstSize, scheduler, journal);
+        return std::make_unique<NuDBBackend<nudb::native_file>>(
             keyBytes, keyValues, burstSize, scheduler, journal);
     }
 
@@ -372,9 +497,21 @@ public:
         nudb::context& context,
         beast::Journal journal) override
     {
-        return std::make_unique<NuDBBackend>(
+        if (mapReads(keyValues))
+            return std::make_unique<NuDBBackend<MappedFile>>(
+                keyBytes, keyValues, burstSize, scheduler, context, journal);
+        return std::make_unique<NuDBBackend<nudb::native_file>>(
             keyBytes, keyValues, burstSize, scheduler, context, journal);
     }
+
+private:
+    // Databases that are no longer written to can serve reads from a
+    // memory mapping of their files
+    static bool
+    mapReads(Section const& keyValues)
+    {
+        return get<bool>(keyValues, "mmap_reads", false);
+    }
 };
 
 static NuDBFactory nuDBFactory;
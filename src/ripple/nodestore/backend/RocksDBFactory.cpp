@@ -30,8 +30,12 @@
 #include <ripple/nodestore/impl/BatchWriter.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
 #include <atomic>
 #include <memory>
+#include <mutex>
 
 namespace ripple {
 namespace NodeStore {
@@ -80,11 +84,62 @@ public:
 
 //------------------------------------------------------------------------------
 
+/** The block cache shared by the RocksDB backends using the nodestore
+    profile.
+
+    The backends of a rotating or tiered node store then compete for one
+    budget instead of each holding its own. The cache is sized by the
+    first backend to be created, and released with the last.
+*/
+class RocksDBBlockCache
+{
+public:
+    std::shared_ptr<rocksdb::Cache>
+    get(std::size_t capacity)
+    {
+        std::lock_guard lock(mutex_);
+        auto cache = cache_.lock();
+        if (!cache)
+        {
+            // Give index and filter blocks, which are pinned, their own
+            // share of the cache so data blocks cannot push them out
+            cache = rocksdb::NewLRUCache(capacity, -1, false, 0.2);
+            cache_ = cache;
+        }
+        return cache;
+    }
+
+private:
+    std::mutex mutex_;
+    std::weak_ptr<rocksdb::Cache> cache_;
+};
+
+//------------------------------------------------------------------------------
+
 class RocksDBBackend : public Backend, public BatchWriter::Callback
 {
 private:
     std::atomic<bool> m_deletePath;
 
+    // Tuned for node objects: inner nodes and leaves are kept in column
+    // families of their own, each with whole key bloom filters and
+    // partitioned index and filter blocks pinned in a shared block cache
+    bool profile_ = false;
+
+    // Column families holding objects, in the order fetches look in them,
+    // and every family open so that all can be released on close
+    std::vector<rocksdb::ColumnFamilyHandle*> families_;
+    std::vector<rocksdb::ColumnFamilyHandle*> readOrder_;
+    rocksdb::ColumnFamilyHandle* inner_ = nullptr;
+    rocksdb::ColumnFamilyHandle* leaf_ = nullptr;
+
+    rocksdb::ColumnFamilyOptions innerOptions_;
+    rocksdb::ColumnFamilyOptions leafOptions_;
+    std::shared_ptr<rocksdb::Cache> blockCache_;
+
+    static constexpr char const* innerFamily = "inner_nodes";
+    static constexpr char const* leafFamily = "leaf_nodes";
+
 public:
     beast::Journal m_journal;
     size_t const m_keyBytes;
@@ -100,7 +155,8 @@ public:
         Section const& keyValues,
         Scheduler& scheduler,
         beast::Journal journal,
-        RocksDBEnv* env)
+        RocksDBEnv* env,
+        RocksDBBlockCache& sharedCache)
         : m_deletePath(false)
         , m_journal(journal)
         , m_keyBytes(keyBytes)
@@ -110,10 +166,30 @@ public:
         if (!get_if_exists(keyValues, "path", m_name))
             Throw<std::runtime_error>("Missing path in RocksDBFactory backend");
 
+        if (keyValues.exists("profile"))
+        {
+            auto const profile = get<std::string>(keyValues, "profile");
+            if (!boost::iequals(profile, "nodestore"))
+                Throw<std::runtime_error>(
+                    "Unknown RocksDB profile: " + profile);
+            profile_ = true;
+        }
+
         rocksdb::BlockBasedTableOptions table_options;
         m_options.env = env;
 
-        if (keyValues.exists("cache_mb"))
+        if (profile_)
+        {
+            // The tree node cache holds the most used nodes already, so by
+            // default the block cache gets half its budget for what falls
+            // out of it
+            auto const cacheMB = keyValues.exists("cache_mb")
+                ? get<int>(keyValues, "cache_mb")
+                : std::max(64, get<int>(keyValues, "tree_cache_mb") / 2);
+            blockCache_ = sharedCache.get(cacheMB * megabytes(1));
+            table_options.block_cache = blockCache_;
+        }
+        else if (keyValues.exists("cache_mb"))
             table_options.block_cache = rocksdb::NewLRUCache(
                 get<int>(keyValues, "cache_mb") * megabytes(1));
 
@@ -162,6 +238,30 @@ public:
 
         get_if_exists(keyValues, "block_size", table_options.block_size);
 
+        if (profile_)
+        {
+            // Every fetch of a leaf first misses in the inner nodes, and
+            // every fetch of an object not stored misses in both, so a
+            // miss must cost no more than a probe of a cached filter
+            if (!table_options.filter_policy)
+                table_options.filter_policy.reset(
+                    rocksdb::NewBloomFilterPolicy(10, false));
+            table_options.whole_key_filtering = true;
+            table_options.index_type =
+                rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+            table_options.partition_filters = true;
+            table_options.metadata_block_size = 4096;
+            table_options.cache_index_and_filter_blocks = true;
+            table_options.cache_index_and_filter_blocks_with_high_priority =
+                true;
+            table_options.pin_top_level_index_and_filter = true;
+            table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+
+            m_options.statistics = rocksdb::CreateDBStatistics();
+            m_options.statistics->set_stats_level(
+                rocksdb::kExceptDetailedTimers);
+        }
+
         if (keyValues.exists("universal_compaction") &&
             (get<int>(keyValues, "universal_compaction") != 0))
         {
@@ -195,6 +295,14 @@ public:
                     s.ToString());
         }
 
+        innerOptions_ = m_options;
+        leafOptions_ = m_options;
+        if (profile_)
+        {
+            // Inner nodes are mostly hashes, which do not compress
+            innerOptions_.compression = rocksdb::kNoCompression;
+        }
+
         std::string s1, s2;
         rocksdb::GetStringFromDBOptions(&s1, m_options, "; ");
         rocksdb::GetStringFromColumnFamilyOptions(&s2, m_options, "; ");
@@ -216,14 +324,78 @@ public:
             JLOG(m_journal.error()) << "database is already open";
             return;
         }
-        rocksdb::DB* db = nullptr;
         m_options.create_if_missing = createIfMissing;
-        rocksdb::Status status = rocksdb::DB::Open(m_options, m_name, &db);
+        m_options.create_missing_column_families = true;
+
+        // Every column family in the database must be opened. A database
+        // that does not exist yet has only the default one.
+        std::vector<std::string> names;
+        if (!rocksdb::DB::ListColumnFamilies(m_options, m_name, &names).ok())
+            names = {rocksdb::kDefaultColumnFamilyName};
+        auto const has = [&names](std::string const& name) {
+            return std::find(names.begin(), names.end(), name) != names.end();
+        };
+        if (profile_)
+        {
+            for (auto const name : {innerFamily, leafFamily})
+            {
+                if (!has(name))
+                    names.emplace_back(name);
+            }
+        }
+
+        std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+        for (auto const& name : names)
+        {
+            if (name == innerFamily)
+                descriptors.emplace_back(name, innerOptions_);
+            else if (name == leafFamily)
+                descriptors.emplace_back(name, leafOptions_);
+            else
+                descriptors.emplace_back(
+                    name, rocksdb::ColumnFamilyOptions(m_options));
+        }
+
+        rocksdb::DB* db = nullptr;
+        rocksdb::Status status = rocksdb::DB::Open(
+            rocksdb::DBOptions(m_options),
+            m_name,
+            descriptors,
+            &families_,
+            &db);
         if (!status.ok() || !db)
             Throw<std::runtime_error>(
                 std::string("Unable to open/create RocksDB: ") +
                 status.ToString());
         m_db.reset(db);
+
+        rocksdb::ColumnFamilyHandle* defaultFamily = nullptr;
+        for (auto const family : families_)
+        {
+            if (family->GetName() == innerFamily)
+                inner_ = family;
+            else if (family->GetName() == leafFamily)
+                leaf_ = family;
+            else if (family->GetName() == rocksdb::kDefaultColumnFamilyName)
+                defaultFamily = family;
+        }
+
+        // Objects written before the profile was used stay where they are,
+        // and are still found after the profile's families
+        if (inner_)
+            readOrder_.push_back(inner_);
+        if (leaf_)
+            readOrder_.push_back(leaf_);
+        std::uint64_t legacy = 0;
+        if (!profile_ ||
+            (m_db->GetIntProperty(
+                 defaultFamily, "rocksdb.estimate-num-keys", &legacy) &&
+             legacy != 0))
+            readOrder_.push_back(defaultFamily);
+
+        JLOG(m_journal.debug())
+            << "RocksDB " << m_name << " reads " << readOrder_.size()
+            << " column families";
     }
 
     bool
@@ -237,6 +409,11 @@ public:
     {
         if (m_db)
         {
+            readOrder_.clear();
+            inner_ = leaf_ = nullptr;
+            for (auto const family : families_)
+                m_db->DestroyColumnFamilyHandle(family);
+            families_.clear();
             m_db.reset();
             if (m_deletePath)
             {
@@ -254,28 +431,37 @@ public:
 
     //--------------------------------------------------------------------------
 
+    // Look up a key and hand the decoded value to `f`. The value is pinned
+    // in the block cache where possible rather than copied out.
+    template <class Function>
     Status
-    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override
+    fetchDecoded(void const* key, Function&& f)
     {
         assert(m_db);
-        pObject->reset();
 
         Status status(ok);
 
         rocksdb::ReadOptions const options;
         rocksdb::Slice const slice(static_cast<char const*>(key), m_keyBytes);
 
-        std::string string;
+        rocksdb::PinnableSlice value;
 
-        rocksdb::Status getStatus = m_db->Get(options, slice, &string);
+        rocksdb::Status getStatus = rocksdb::Status::NotFound();
+        for (auto const family : readOrder_)
+        {
+            getStatus = m_db->Get(options, family, slice, &value);
+            if (!getStatus.IsNotFound())
+                break;
+            value.Reset();
+        }
 
         if (getStatus.ok())
         {
-            DecodedBlob decoded(key, string.data(), string.size());
+            DecodedBlob decoded(key, value.data(), value.size());
 
             if (decoded.wasOk())
             {
-                *pObject = decoded.createObject();
+                f(decoded);
             }
             else
             {
@@ -305,6 +491,24 @@ public:
         return status;
     }
 
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override
+    {
+        pObject->reset();
+        return fetchDecoded(key, [pObject](DecodedBlob& decoded) {
+            *pObject = decoded.createObject();
+        });
+    }
+
+    Status
+    fetchPayload(void const* key, std::function<void(Slice)> const& visit)
+        override
+    {
+        return fetchDecoded(key, [&visit](DecodedBlob& decoded) {
+            visit(decoded.getData());
+        });
+    }
+
     bool
     canFetchBatch() override
     {
@@ -335,6 +539,12 @@ public:
         m_batch.store(object);
     }
 
+    void
+    storeMany(Batch const& batch) override
+    {
+        m_batch.store(batch);
+    }
+
     void
     storeBatch(Batch const& batch) override
     {
@@ -348,6 +558,7 @@ public:
             encoded.prepare(e);
 
             wb.Put(
+                familyFor(*e),
                 rocksdb::Slice(
                     reinterpret_cast<char const*>(encoded.getKey()),
                     m_keyBytes),
@@ -375,7 +586,18 @@ public:
         assert(m_db);
         rocksdb::ReadOptions const options;
 
-        std::unique_ptr<rocksdb::Iterator> it(m_db->NewIterator(options));
+        for (auto const family : readOrder_)
+            forEachIn(options, family, f);
+    }
+
+    void
+    forEachIn(
+        rocksdb::ReadOptions const& options,
+        rocksdb::ColumnFamilyHandle* family,
+        std::function<void(std::shared_ptr<NodeObject>)> const& f)
+    {
+        std::unique_ptr<rocksdb::Iterator> it(
+            m_db->NewIterator(options, family));
 
         for (it->SeekToFirst(); it->Valid(); it->Next())
         {
@@ -436,6 +658,83 @@ public:
     {
         return fdRequired_;
     }
+
+    void
+    getCountsJson(Json::Value& obj) const override
+    {
+        if (!m_db)
+            return;
+
+        auto const property = [this](
+                                  rocksdb::ColumnFamilyHandle* family,
+                                  std::string const& name) {
+            std::uint64_t value = 0;
+            m_db->GetIntProperty(family, name, &value);
+            return value;
+        };
+
+        // Compaction debt and running compactions are per column family
+        std::uint64_t pendingBytes = 0;
+        std::uint64_t compactions = 0;
+        for (auto const family : families_)
+        {
+            pendingBytes +=
+                property(family, "rocksdb.estimate-pending-compaction-bytes");
+            compactions += property(family, "rocksdb.num-running-compactions");
+        }
+
+        auto& stats = (obj["rocksdb"] = Json::objectValue);
+        stats["pending_compaction_bytes"] = std::to_string(pendingBytes);
+        stats["running_compactions"] = static_cast<Json::UInt>(compactions);
+        stats["write_stopped"] =
+            property(m_db->DefaultColumnFamily(), "rocksdb.is-write-stopped") !=
+            0;
+        stats["delayed_write_rate"] = std::to_string(property(
+            m_db->DefaultColumnFamily(), "rocksdb.actual-delayed-write-rate"));
+
+        if (blockCache_)
+        {
+            stats["block_cache_bytes"] =
+                std::to_string(blockCache_->GetUsage());
+            stats["block_cache_pinned_bytes"] =
+                std::to_string(blockCache_->GetPinnedUsage());
+            stats["block_cache_capacity"] =
+                std::to_string(blockCache_->GetCapacity());
+        }
+
+        if (auto const& s = m_options.statistics)
+        {
+            auto const ticker = [&s](rocksdb::Tickers t) {
+                return std::to_string(s->getTickerCount(t));
+            };
+            stats["stall_us"] = ticker(rocksdb::STALL_MICROS);
+            stats["block_cache_hits"] = ticker(rocksdb::BLOCK_CACHE_HIT);
+            stats["block_cache_misses"] = ticker(rocksdb::BLOCK_CACHE_MISS);
+            stats["bloom_filter_useful"] = ticker(rocksdb::BLOOM_FILTER_USEFUL);
+            stats["bytes_read"] = ticker(rocksdb::BYTES_READ);
+        }
+    }
+
+private:
+    // The family an object is written to. Inner nodes are told apart by
+    // the prefix their serialization starts with.
+    rocksdb::ColumnFamilyHandle*
+    familyFor(NodeObject const& object) const
+    {
+        if (!profile_)
+            return m_db->DefaultColumnFamily();
+
+        auto const& data = object.getData();
+        if (data.size() >= 4)
+        {
+            auto const prefix = (std::uint32_t(data[0]) << 24) |
+                (std::uint32_t(data[1]) << 16) | (std::uint32_t(data[2]) << 8) |
+                std::uint32_t(data[3]);
+            if (prefix == static_cast<std::uint32_t>(HashPrefix::innerNode))
+                return inner_;
+        }
+        return leaf_;
+    }
 };
 
 //------------------------------------------------------------------------------
@@ -444,6 +743,7 @@ class RocksDBFactory : public Factory
 {
 public:
     RocksDBEnv m_env;
+    RocksDBBlockCache m_blockCache;
 
     RocksDBFactory()
     {
@@ -470,7 +770,7 @@ public:
         beast::Journal journal) override
     {
         return std::make_unique<RocksDBBackend>(
-            keyBytes, keyValues, scheduler, journal, &m_env);
+            keyBytes, keyValues, scheduler, journal, &m_env, m_blockCache);
     }
 };
 
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/nodestore/impl/BatchWriter.h>
+#include <algorithm>
 
 namespace ripple {
 namespace NodeStore {
@@ -27,6 +28,9 @@ BatchWriter::BatchWriter(Callback& callback, Scheduler& scheduler)
     , m_scheduler(scheduler)
     , mWriteLoad(0)
     , mWritePending(false)
+    , mCommitSize(batchWritePreallocationSize)
+    , mPendingBytes(0)
+    , mStalled(0)
 {
     mWriteSet.reserve(batchWritePreallocationSize);
 }
@@ -39,20 +43,72 @@ BatchWriter::~BatchWriter()
 void
 BatchWriter::store(std::shared_ptr<NodeObject> const& object)
 {
-    std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
+    bool schedule = false;
+    {
+        std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
+        add(sl, object, schedule);
+    }
+    if (schedule)
+        m_scheduler.scheduleTask(*this);
+}
 
-    // If the batch has reached its limit, we wait
-    // until the batch writer is finished
-    while (mWriteSet.size() >= batchWriteLimitSize)
-        mWriteCondition.wait(sl);
+void
+BatchWriter::store(Batch const& batch)
+{
+    bool schedule = false;
+    {
+        std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
+        for (auto const& object : batch)
+            add(sl, object, schedule);
+    }
+    if (schedule)
+        m_scheduler.scheduleTask(*this);
+}
+
+void
+BatchWriter::add(
+    std::unique_lock<std::mutex>& sl,
+    std::shared_ptr<NodeObject> const& object,
+    bool& schedule)
+{
+    // If every buffer is full, we wait until the
+    // batch writer has finished a commit
+    if (mWriteSet.size() >= mCommitSize && mSealed.size() >= maxQueuedBatches)
+    {
+        // The writer must be running to make room. A scheduler may run it
+        // on this thread, so the lock is released to start it.
+        if (schedule)
+        {
+            schedule = false;
+            sl.unlock();
+            m_scheduler.scheduleTask(*this);
+            sl.lock();
+        }
+
+        auto const before = std::chrono::steady_clock::now();
+        mWriteCondition.wait(sl, [this] {
+            return mWriteSet.size() < mCommitSize ||
+                mSealed.size() < maxQueuedBatches;
+        });
+        mStalled += std::chrono::steady_clock::now() - before;
+    }
+
+    if (mWriteSet.size() >= mCommitSize)
+    {
+        mSealed.push_back(std::move(mWriteSet));
+        mWriteSet = Batch();
+        mWriteSet.reserve(mCommitSize);
+    }
 
     mWriteSet.push_back(object);
+    mPendingBytes += object->getData().size();
 
+    // The task is scheduled once the lock is released, since a scheduler
+    // may run it on this thread
     if (!mWritePending)
     {
         mWritePending = true;
-
-        m_scheduler.scheduleTask(*this);
+        schedule = true;
     }
 }
 
@@ -61,7 +117,10 @@ BatchWriter::getWriteLoad()
 {
     std::lock_guard sl(mWriteMutex);
 
-    return std::max(mWriteLoad, static_cast<int>(mWriteSet.size()));
+    std::size_t queued = mWriteSet.size();
+    for (auto const& batch : mSealed)
+        queued += batch.size();
+    return std::max(mWriteLoad, static_cast<int>(queued));
 }
 
 void
@@ -75,15 +134,22 @@ BatchWriter::writeBatch()
 {
     for (;;)
     {
-        std::vector<std::shared_ptr<NodeObject>> set;
-
-        set.reserve(batchWritePreallocationSize);
+        Batch set;
+        BatchWriteReport report;
 
         {
             std::lock_guard sl(mWriteMutex);
 
-            mWriteSet.swap(set);
-            assert(mWriteSet.empty());
+            if (!mSealed.empty())
+            {
+                set = std::move(mSealed.front());
+                mSealed.pop_front();
+            }
+            else
+            {
+                set.reserve(mCommitSize);
+                mWriteSet.swap(set);
+            }
             mWriteLoad = set.size();
 
             if (set.empty())
@@ -94,21 +160,64 @@ BatchWriter::writeBatch()
                 // VFALCO NOTE Fix this function to not return from the middle
                 return;
             }
+
+            // Room was made for callers waiting on a full set of buffers
+            mWriteCondition.notify_all();
+
+            report.stalled =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    mStalled);
+            mStalled = {};
         }
 
-        BatchWriteReport report;
         report.writeCount = set.size();
         auto const before = std::chrono::steady_clock::now();
 
         m_callback.writeBatch(set);
 
-        report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - before);
+        auto const elapsed = std::chrono::steady_clock::now() - before;
+        report.elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+
+        std::uint64_t bytes = 0;
+        for (auto const& object : set)
+            bytes += object->getData().size();
+
+        {
+            std::lock_guard sl(mWriteMutex);
+            mPendingBytes -= bytes;
+            report.pendingBytes = mPendingBytes;
+            adjustCommitSize(
+                set.size(),
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    elapsed));
+        }
 
         m_scheduler.onBatchWrite(report);
     }
 }
 
+void
+BatchWriter::adjustCommitSize(
+    std::size_t count,
+    std::chrono::microseconds elapsed)
+{
+    using namespace std::chrono;
+
+    // Estimate how many objects fit in the target latency, and move a
+    // quarter of the way there to smooth out noisy measurements
+    auto const perObject = std::max<std::int64_t>(elapsed.count(), 1) /
+        static_cast<double>(count);
+    auto const ideal =
+        duration_cast<microseconds>(targetCommitLatency).count() / perObject;
+    auto const next = (3.0 * mCommitSize + ideal) / 4.0;
+
+    mCommitSize = std::clamp<std::size_t>(
+        static_cast<std::size_t>(next),
+        batchWritePreallocationSize,
+        batchWriteLimitSize);
+}
+
 void
 BatchWriter::waitForWriting()
 {
@@ -23,7 +23,9 @@
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/Task.h>
 #include <ripple/nodestore/Types.h>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 
 namespace ripple {
@@ -35,6 +37,12 @@ namespace NodeStore {
     class it not required. A backend can implement its own write batching,
     or skip write batching if doing so yields a performance benefit.
 
+    Incoming objects accumulate in a filling buffer. Once the buffer holds
+    a full commit it is sealed and queued for the writer, and a fresh
+    buffer starts filling, so callers keep storing while earlier commits
+    are written. The commit size adapts to the measured latency of the
+    backend, and callers only block when every buffer is full.
+
     @see Scheduler
 */
 class BatchWriter : private Task
@@ -70,6 +78,10 @@ public:
     void
     store(std::shared_ptr<NodeObject> const& object);
 
+    /** Store several objects, taking the lock once for all of them. */
+    void
+    store(Batch const& batch);
+
     /** Get an estimate of the amount of writing I/O pending. */
     int
     getWriteLoad();
@@ -81,18 +93,34 @@ private:
     writeBatch();
     void
     waitForWriting();
+    void
+    adjustCommitSize(std::size_t count, std::chrono::microseconds elapsed);
+    // Add an object to the write set, with the write mutex held. Sets
+    // schedule if the writer task must be scheduled once it is released.
+    void
+    add(std::unique_lock<std::mutex>& sl,
+        std::shared_ptr<NodeObject> const& object,
+        bool& schedule);
 
 private:
-    using LockType = std::recursive_mutex;
-    using CondvarType = std::condition_variable_any;
+    // The number of sealed commits that may wait behind the one being
+    // written before callers are blocked
+    static constexpr std::size_t maxQueuedBatches = 2;
+
+    // The commit size is tuned so that one commit takes about this long
+    static constexpr std::chrono::milliseconds targetCommitLatency{100};
 
     Callback& m_callback;
     Scheduler& m_scheduler;
-    LockType mWriteMutex;
-    CondvarType mWriteCondition;
+    std::mutex mWriteMutex;
+    std::condition_variable mWriteCondition;
     int mWriteLoad;
     bool mWritePending;
     Batch mWriteSet;
+    std::deque<Batch> mSealed;
+    std::size_t mCommitSize;
+    std::uint64_t mPendingBytes;
+    std::chrono::steady_clock::duration mStalled;
 };
 
 }  // namespace NodeStore
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_BLOOMBLOCK_H_INCLUDED
+#define RIPPLE_NODESTORE_BLOOMBLOCK_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ripple {
+namespace NodeStore {
+namespace detail {
+
+/*  The layout shared by shard and key filters, which are blocked Bloom
+    filters of node object keys. The bits of a key all fall in one block
+    of 64 bytes, so testing a key reads a single cache line. Keys are
+    hashes already: the first eight bytes choose the block and the next
+    sixteen the bits.
+*/
+
+std::size_t constexpr bloomBlockBytes{64};
+std::size_t constexpr bloomBlockBits{bloomBlockBytes * 8};
+
+// Bits per key; with eight bits set in each key's block, about one key in
+// a thousand that was not added tests positive
+std::uint64_t constexpr bloomBitsPerKey{16};
+std::size_t constexpr bloomBitsPerBlockKey{8};
+
+/** The number of blocks of a filter sized for a number of keys. */
+inline std::uint64_t
+bloomBlocksFor(std::uint64_t keys)
+{
+    auto const blocks{
+        (keys * bloomBitsPerKey + bloomBlockBits - 1) / bloomBlockBits};
+    return blocks ? blocks : 1;
+}
+
+inline std::uint64_t
+bloomBlockOf(uint256 const& key, std::uint64_t blocks)
+{
+    std::uint64_t v{0};
+    for (std::size_t i = 0; i < 8; ++i)
+        v = (v << 8) | key.data()[i];
+    return v % blocks;
+}
+
+/** The i'th bit of the key in its block. */
+inline std::size_t
+bloomBitOf(uint256 const& key, std::size_t i)
+{
+    auto const p = key.data() + 8 + 2 * i;
+    return ((std::size_t{p[0]} << 8) | p[1]) % bloomBlockBits;
+}
+
+inline void
+putBE(std::uint8_t* p, std::uint64_t v, std::size_t bytes)
+{
+    for (std::size_t i = bytes; i > 0; --i)
+    {
+        p[i - 1] = static_cast<std::uint8_t>(v);
+        v >>= 8;
+    }
+}
+
+inline std::uint64_t
+getBE(std::uint8_t const* p, std::size_t bytes)
+{
+    std::uint64_t v{0};
+    for (std::size_t i = 0; i < bytes; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+}  // namespace detail
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
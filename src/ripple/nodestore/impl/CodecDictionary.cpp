@@ -0,0 +1,249 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+// Disable lz4 deprecation warning due to incompatibility with clang attributes
+#define LZ4_DISABLE_DEPRECATE_WARNINGS
+
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/CodecDictionary.h>
+#include <ripple/protocol/digest.h>
+#include <algorithm>
+#include <cstring>
+#include <lz4.h>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+// Length of the substrings counted while training
+constexpr std::size_t gramSize = 8;
+
+// Length of the segments copied into the dictionary
+constexpr std::size_t segmentSize = 64;
+
+std::uint32_t
+dictionaryId(Blob const& content)
+{
+    auto const digest = sha512Half(makeSlice(content));
+    std::uint32_t id;
+    std::memcpy(&id, digest.data(), sizeof(id));
+    return id;
+}
+
+std::uint64_t
+gramAt(std::uint8_t const* p)
+{
+    std::uint64_t gram;
+    std::memcpy(&gram, p, sizeof(gram));
+    return gram;
+}
+
+}  // namespace
+
+struct CodecDictionary::Stream
+{
+    LZ4_stream_t state;
+};
+
+CodecDictionary::CodecDictionary(Blob content)
+    : content_(std::move(content))
+    , id_(dictionaryId(content_))
+    , stream_(std::make_unique<Stream>())
+{
+    if (content_.empty() || content_.size() > maxSize)
+        Throw<std::runtime_error>(
+            "nodestore: bad dictionary size " +
+            std::to_string(content_.size()));
+
+    LZ4_initStream(&stream_->state, sizeof(stream_->state));
+    LZ4_loadDict(
+        &stream_->state,
+        reinterpret_cast<char const*>(content_.data()),
+        content_.size());
+}
+
+CodecDictionary::~CodecDictionary() = default;
+
+std::shared_ptr<CodecDictionary const>
+CodecDictionary::load(std::string const& path)
+{
+    boost::system::error_code ec;
+    auto const content = getFileContents(ec, path, maxSize);
+    if (ec)
+        Throw<std::runtime_error>(
+            "nodestore: unable to read dictionary " + path + ": " +
+            ec.message());
+    return std::make_shared<CodecDictionary const>(
+        Blob(content.begin(), content.end()));
+}
+
+std::size_t
+CodecDictionary::compress(
+    void const* in,
+    std::size_t in_size,
+    void* out,
+    std::size_t out_max) const
+{
+    // Copying the prepared state is much cheaper than loading the
+    // dictionary again for every object.
+    LZ4_stream_t state;
+    std::memcpy(&state, &stream_->state, sizeof(state));
+    auto const n = LZ4_compress_fast_continue(
+        &state,
+        reinterpret_cast<char const*>(in),
+        reinterpret_cast<char*>(out),
+        in_size,
+        out_max,
+        1);
+    return n > 0 ? n : 0;
+}
+
+bool
+CodecDictionary::decompress(
+    void const* in,
+    std::size_t in_size,
+    void* out,
+    std::size_t out_size) const
+{
+    auto const n = LZ4_decompress_safe_usingDict(
+        reinterpret_cast<char const*>(in),
+        reinterpret_cast<char*>(out),
+        in_size,
+        out_size,
+        reinterpret_cast<char const*>(content_.data()),
+        content_.size());
+    return n >= 0 && static_cast<std::size_t>(n) == out_size;
+}
+
+Blob
+CodecDictionary::train(std::vector<Blob> const& samples, std::size_t size)
+{
+    size = std::min(size, maxSize);
+
+    // Count how many samples each gram appears in
+    std::unordered_map<std::uint64_t, std::uint32_t> counts;
+    {
+        std::vector<std::uint64_t> grams;
+        for (auto const& sample : samples)
+        {
+            if (sample.size() < gramSize)
+                continue;
+            grams.clear();
+            for (std::size_t i = 0; i + gramSize <= sample.size(); ++i)
+                grams.push_back(gramAt(&sample[i]));
+            std::sort(grams.begin(), grams.end());
+            grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+            for (auto const gram : grams)
+                ++counts[gram];
+        }
+    }
+
+    struct Segment
+    {
+        std::uint64_t score;
+        std::uint32_t sample;
+        std::uint32_t offset;
+        std::uint32_t length;
+
+        bool
+        operator<(Segment const& other) const
+        {
+            return score < other.score;
+        }
+    };
+
+    // A segment is worth the number of samples sharing each of its grams.
+    // Grams unique to one sample, or already in the dictionary, add nothing.
+    std::vector<std::uint64_t> grams;
+    auto score = [&](Segment const& seg) {
+        auto const p = samples[seg.sample].data() + seg.offset;
+        grams.clear();
+        for (std::size_t i = 0; i + gramSize <= seg.length; ++i)
+            grams.push_back(gramAt(p + i));
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        std::uint64_t total = 0;
+        for (auto const gram : grams)
+        {
+            if (auto const n = counts[gram]; n > 1)
+                total += n;
+        }
+        return total;
+    };
+
+    std::priority_queue<Segment> candidates;
+    for (std::uint32_t i = 0; i < samples.size(); ++i)
+    {
+        auto const& sample = samples[i];
+        for (std::size_t offset = 0; offset + gramSize <= sample.size();
+             offset += segmentSize / 2)
+        {
+            Segment seg{0, i, static_cast<std::uint32_t>(offset), 0};
+            seg.length = std::min(segmentSize, sample.size() - offset);
+            seg.score = score(seg);
+            if (seg.score > 0)
+                candidates.push(seg);
+        }
+    }
+
+    // Greedily take the best segment, rescoring lazily since a segment
+    // loses value once its grams have been taken by another.
+    std::vector<Segment> chosen;
+    std::size_t total = 0;
+    while (!candidates.empty() && total < size)
+    {
+        auto seg = candidates.top();
+        candidates.pop();
+        auto const current = score(seg);
+        if (current == 0)
+            continue;
+        if (current < seg.score)
+        {
+            seg.score = current;
+            candidates.push(seg);
+            continue;
+        }
+
+        seg.length = std::min<std::size_t>(seg.length, size - total);
+        auto const p = samples[seg.sample].data() + seg.offset;
+        for (std::size_t i = 0; i + gramSize <= seg.length; ++i)
+            counts[gramAt(p + i)] = 0;
+        chosen.push_back(seg);
+        total += seg.length;
+    }
+
+    // The end of the dictionary stays within the LZ4 match window the
+    // longest as an object is compressed, so the best segments go last.
+    Blob result;
+    result.reserve(total);
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it)
+    {
+        auto const p = samples[it->sample].data() + it->offset;
+        result.insert(result.end(), p, p + it->length);
+    }
+    return result;
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
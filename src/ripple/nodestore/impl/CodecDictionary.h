@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_CODECDICTIONARY_H_INCLUDED
+#define RIPPLE_NODESTORE_CODECDICTIONARY_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/Slice.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A shared dictionary used to compress node objects.
+
+    Most leaf nodes are small and have much in common with each other,
+    which a stand-alone LZ4 block cannot take advantage of. Priming the
+    compressor with content typical of the node store lets each object
+    refer back to it instead.
+
+    Objects compressed with a dictionary record its id, and can only be
+    decompressed with the same dictionary.
+*/
+class CodecDictionary
+{
+public:
+    /** The largest dictionary LZ4 is able to reference. */
+    static constexpr std::size_t maxSize = 64 * 1024;
+
+    explicit CodecDictionary(Blob content);
+
+    ~CodecDictionary();
+
+    CodecDictionary(CodecDictionary const&) = delete;
+    CodecDictionary&
+    operator=(CodecDictionary const&) = delete;
+
+    /** Load a dictionary from a file. Throws on error. */
+    static std::shared_ptr<CodecDictionary const>
+    load(std::string const& path);
+
+    /** Build a dictionary from sample objects.
+
+        Segments which occur across the most samples are kept, with the
+        most valuable placed last.
+
+        @param samples Uncompressed node objects.
+        @param size The largest dictionary to produce.
+    */
+    static Blob
+    train(std::vector<Blob> const& samples, std::size_t size = maxSize);
+
+    /** Identifies the dictionary in compressed objects. */
+    std::uint32_t
+    id() const noexcept
+    {
+        return id_;
+    }
+
+    Slice
+    content() const noexcept
+    {
+        return makeSlice(content_);
+    }
+
+    /** Compress into a buffer of at least compressBound(in_size) bytes.
+
+        @return The number of bytes written, or zero on failure.
+    */
+    std::size_t
+    compress(
+        void const* in,
+        std::size_t in_size,
+        void* out,
+        std::size_t out_max) const;
+
+    /** Decompress exactly out_size bytes.
+
+        @return `true` if the input decoded to exactly out_size bytes.
+    */
+    bool
+    decompress(
+        void const* in,
+        std::size_t in_size,
+        void* out,
+        std::size_t out_size) const;
+
+private:
+    struct Stream;
+
+    Blob const content_;
+    std::uint32_t const id_;
+
+    // Compressor state with the dictionary already loaded
+    std::unique_ptr<Stream> stream_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
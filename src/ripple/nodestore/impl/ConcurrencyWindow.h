@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_CONCURRENCYWINDOW_H_INCLUDED
+#define RIPPLE_NODESTORE_CONCURRENCYWINDOW_H_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace ripple {
+namespace NodeStore {
+
+/** An adaptive limit on the number of requests in flight.
+
+    The limit grows by one each time a full window of requests completes
+    within the target latency, up to a ceiling, and halves when a request
+    is slow or fails. It halves at most once per target latency interval,
+    so that the requests caught in one overload count only once.
+
+    This class is not thread safe; callers serialize access.
+*/
+class ConcurrencyWindow
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    ConcurrencyWindow(
+        std::uint32_t initial,
+        std::uint32_t ceiling,
+        std::chrono::microseconds targetLatency)
+        : ceiling_(std::max<std::uint32_t>(1, ceiling))
+        , targetLatency_(targetLatency)
+        , limit_(std::clamp<std::uint32_t>(initial, 1, ceiling_))
+    {
+    }
+
+    /** The number of requests allowed in flight. */
+    std::uint32_t
+    limit() const
+    {
+        return limit_;
+    }
+
+    /** Adjusts the limit after a request completes or fails.
+
+        @param succeeded Whether the request succeeded.
+        @param latency How long the request took.
+        @param now The current time.
+    */
+    void
+    onComplete(
+        bool succeeded,
+        std::chrono::microseconds latency,
+        clock_type::time_point now = clock_type::now())
+    {
+        if (succeeded && latency <= targetLatency_)
+        {
+            if (++completed_ >= limit_)
+            {
+                completed_ = 0;
+                limit_ = std::min(limit_ + 1, ceiling_);
+            }
+        }
+        else if (!decreased_ || now - lastDecrease_ >= targetLatency_)
+        {
+            decreased_ = true;
+            lastDecrease_ = now;
+            completed_ = 0;
+            limit_ = std::max<std::uint32_t>(1, limit_ / 2);
+        }
+    }
+
+private:
+    std::uint32_t ceiling_;
+    std::chrono::microseconds targetLatency_;
+    std::uint32_t limit_;
+    std::uint32_t completed_ = 0;
+    bool decreased_ = false;
+    clock_type::time_point lastDecrease_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -18,12 +18,14 @@
 //==============================================================================
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/basics/Numa.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/json/json_value.h>
 #include <ripple/nodestore/Database.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/jss.h>
+#include <algorithm>
 #include <chrono>
 
 namespace ripple {
@@ -45,8 +47,33 @@ Database::Database(
     if (earliestLedgerSeq_ < 1)
         Throw<std::runtime_error>("Invalid earliest_seq");
 
-    while (readThreads-- > 0)
-        readThreads_.emplace_back(&Database::threadEntry, this);
+    // Each level may issue up to 16 times as many reads as the last
+    if (readThreads > 0)
+    {
+        prefetchDepth_ =
+            std::clamp(get<int>(config, "prefetch_depth", 0), 0, 3);
+        scanReadAhead_ =
+            std::clamp(get<int>(config, "scan_read_ahead", 0), 0, 15);
+    }
+
+    // There are at most 16 branches below a root to work on at once
+    flushThreads_ = std::clamp(get<int>(config, "flush_threads", 1), 1, 16);
+    syncThreads_ = std::clamp(get<int>(config, "sync_threads", 1), 1, 16);
+
+    // A walk shares out subtrees from further down, so it can use more
+    walkThreads_ = std::clamp(get<int>(config, "walk_threads", 1), 1, 32);
+    walkRate_ = std::max(get<int>(config, "walk_rate", 0), 0);
+
+    // Always create at least one shard so that requests posted to a
+    // database without read threads still have somewhere to go.
+    auto const shards = std::max(readThreads, 1);
+    readShards_.reserve(shards);
+    for (int i = 0; i < shards; ++i)
+        readShards_.emplace_back(std::make_unique<ReadShard>());
+
+    for (int i = 0; i < readThreads; ++i)
+        readThreads_.emplace_back(
+            &Database::threadEntry, this, std::ref(*readShards_[i]), i);
 }
 
 Database::~Database()
@@ -77,13 +104,13 @@ Database::onChildrenStopped()
 void
 Database::stopReadThreads()
 {
-    {
-        std::lock_guard lock(readLock_);
-        if (readShut_)  // Only stop threads once.
-            return;
+    if (readShut_.exchange(true))  // Only stop threads once.
+        return;
 
-        readShut_ = true;
-        readCondVar_.notify_all();
+    for (auto& shard : readShards_)
+    {
+        std::lock_guard lock(shard->mutex);
+        shard->cond.notify_all();
     }
 
     for (auto& e : readThreads_)
@@ -96,10 +123,42 @@ Database::asyncFetch(
     std::uint32_t ledgerSeq,
     std::function<void(std::shared_ptr<NodeObject> const&)>&& cb)
 {
-    // Post a read
-    std::lock_guard lock(readLock_);
-    read_[hash].emplace_back(ledgerSeq, std::move(cb));
-    readCondVar_.notify_one();
+    // Post a read to the shard responsible for this hash. With NUMA, its
+    // read thread is on the caller's node, so the object is read into
+    // memory near the caller.
+    auto index = *hash.begin() % readShards_.size();
+    if (auto const nodes = numa::nodeCount();
+        numa::enabled() && readThreads_.size() >= nodes)
+    {
+        if (auto const current = numa::currentNode(); current >= 0)
+        {
+            // Read thread i is pinned to node i % nodes
+            auto const node = static_cast<std::size_t>(current);
+            auto const onNode = (readShards_.size() - node + nodes - 1) / nodes;
+            index = node + nodes * (*hash.begin() % onNode);
+        }
+    }
+    auto& shard = *readShards_[index];
+    std::lock_guard lock(shard.mutex);
+    auto& callbacks = shard.pending[hash];
+    if (callbacks.empty())
+        ++readQueueDepth_;
+    callbacks.emplace_back(ledgerSeq, std::move(cb));
+    shard.cond.notify_one();
+}
+
+void
+Database::storeBatch(Batch const& batch, std::uint32_t ledgerSeq)
+{
+    for (auto const& object : batch)
+    {
+        auto const data = object->getData();
+        store(
+            object->getType(),
+            Blob(data.begin(), data.end()),
+            object->getHash(),
+            ledgerSeq);
+    }
 }
 
 void
@@ -161,11 +220,60 @@ Database::fetchNodeObject(
     ++fetchTotalCount_;
 
     fetchReport.elapsed =
-        duration_cast<milliseconds>(steady_clock::now() - begin);
+        duration_cast<microseconds>(steady_clock::now() - begin);
     scheduler_.onFetch(fetchReport);
     return nodeObject;
 }
 
+bool
+Database::fetchNodePayload(
+    uint256 const& hash,
+    std::uint32_t ledgerSeq,
+    std::function<void(Slice)> const& visit,
+    FetchType fetchType)
+{
+    FetchReport fetchReport(fetchType);
+
+    using namespace std::chrono;
+    auto const begin{steady_clock::now()};
+
+    std::size_t size{0};
+    bool const found{fetchNodePayload(
+        hash,
+        ledgerSeq,
+        [&size, &visit](Slice data) {
+            size = data.size();
+            visit(data);
+        },
+        fetchReport)};
+    if (found)
+    {
+        ++fetchHitCount_;
+        fetchSz_ += size;
+    }
+    ++fetchTotalCount_;
+
+    fetchReport.elapsed =
+        duration_cast<microseconds>(steady_clock::now() - begin);
+    scheduler_.onFetch(fetchReport);
+    return found;
+}
+
+bool
+Database::fetchNodePayload(
+    uint256 const& hash,
+    std::uint32_t ledgerSeq,
+    std::function<void(Slice)> const& visit,
+    FetchReport& fetchReport)
+{
+    auto const nodeObject{fetchNodeObject(hash, ledgerSeq, fetchReport)};
+    if (!nodeObject)
+        return false;
+
+    visit(nodeObject->getData());
+    return true;
+}
+
 bool
 Database::storeLedger(
     Ledger const& srcLedger,
@@ -265,52 +373,116 @@ Database::storeLedger(
     return true;
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+Database::fetchBatch(
+    std::vector<uint256> const& hashes,
+    std::uint32_t ledgerSeq)
+{
+    std::vector<std::shared_ptr<NodeObject>> results;
+    results.reserve(hashes.size());
+    for (auto const& hash : hashes)
+        results.push_back(
+            fetchNodeObject(hash, ledgerSeq, FetchType::synchronous));
+    return results;
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+Database::fetchBatchAsync(
+    std::vector<uint256> const& hashes,
+    std::uint32_t ledgerSeq)
+{
+    std::vector<std::shared_ptr<NodeObject>> results;
+    results.reserve(hashes.size());
+    for (auto const& hash : hashes)
+        results.push_back(fetchNodeObject(hash, ledgerSeq, FetchType::async));
+    return results;
+}
+
 // Entry point for async read threads
 void
-Database::threadEntry()
+Database::threadEntry(ReadShard& shard, int index)
 {
     beast::setCurrentThreadName("prefetch");
+    numa::pinCurrentThread(index);
     while (true)
     {
-        uint256 lastHash;
-        std::vector<std::pair<
-            std::uint32_t,
-            std::function<void(std::shared_ptr<NodeObject> const&)>>>
-            entry;
+        std::vector<std::pair<uint256, ReadCallbacks>> batch;
 
         {
-            std::unique_lock<std::mutex> lock(readLock_);
-            while (!readShut_ && read_.empty())
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            while (!readShut_ && shard.pending.empty())
             {
                 // All work is done
-                readCondVar_.wait(lock);
+                shard.cond.wait(lock);
             }
             if (readShut_)
                 break;
 
-            // Read in key order to make the back end more efficient
-            auto it = read_.lower_bound(readLastHash_);
-            if (it == read_.end())
+            // Drain a batch in key order, resuming after the last read,
+            // to make the back end more efficient
+            batch.reserve(std::min<std::size_t>(
+                shard.pending.size(), readBatchLimitSize));
+            auto it = shard.pending.lower_bound(shard.lastHash);
+            while (batch.size() < readBatchLimitSize && !shard.pending.empty())
             {
-                // start over from the beginning
-                it = read_.begin();
+                if (it == shard.pending.end())
+                {
+                    // start over from the beginning
+                    it = shard.pending.begin();
+                }
+                batch.emplace_back(it->first, std::move(it->second));
+                it = shard.pending.erase(it);
             }
-            lastHash = it->first;
-            entry = std::move(it->second);
-            read_.erase(it);
-            readLastHash_ = lastHash;
+            shard.lastHash = batch.back().first;
+        }
+
+        readQueueDepth_ -= batch.size();
+        ++readBatchCount_;
+        readBatchItems_ += batch.size();
+
+        // Every hash whose first request maps to the same database as the
+        // first entry can share one backend request
+        auto const seq = batch.front().second.front().first;
+        std::vector<uint256> hashes;
+        hashes.reserve(batch.size());
+        for (auto const& [hash, callbacks] : batch)
+        {
+            auto const s = callbacks.front().first;
+            if (s == seq || isSameDB(s, seq))
+                hashes.push_back(hash);
         }
 
-        auto seq = entry[0].first;
-        auto obj = fetchNodeObject(lastHash, seq, FetchType::async);
+        auto objs = hashes.size() > 1
+            ? fetchBatchAsync(hashes, seq)
+            : std::vector<std::shared_ptr<NodeObject>>{
+                  fetchNodeObject(hashes.front(), seq, FetchType::async)};
+        assert(objs.size() == hashes.size());
 
-        for (auto const& req : entry)
+        auto next = hashes.cbegin();
+        for (auto const& [hash, callbacks] : batch)
         {
-            if ((seq == req.first) || isSameDB(req.first, seq))
-                req.second(obj);
+            std::shared_ptr<NodeObject> obj;
+            std::uint32_t objSeq;
+            if (next != hashes.cend() && *next == hash)
+            {
+                obj = std::move(objs[next - hashes.cbegin()]);
+                objSeq = seq;
+                ++next;
+            }
             else
-                req.second(
-                    fetchNodeObject(lastHash, req.first, FetchType::async));
+            {
+                objSeq = callbacks.front().first;
+                obj = fetchNodeObject(hash, objSeq, FetchType::async);
+            }
+
+            for (auto const& req : callbacks)
+            {
+                if ((objSeq == req.first) || isSameDB(req.first, objSeq))
+                    req.second(obj);
+                else
+                    req.second(
+                        fetchNodeObject(hash, req.first, FetchType::async));
+            }
         }
     }
 }
@@ -325,6 +497,9 @@ Database::getCountsJson(Json::Value& obj)
     obj[jss::node_written_bytes] = std::to_string(storeSz_);
     obj[jss::node_read_bytes] = std::to_string(fetchSz_);
     obj[jss::node_reads_duration_us] = std::to_string(fetchDurationUs_);
+    obj[jss::node_read_queue] = std::to_string(readQueueDepth_);
+    obj[jss::node_read_batches] = std::to_string(readBatchCount_);
+    obj[jss::node_read_batch_items] = std::to_string(readBatchItems_);
 
     if (auto c = getCounters())
     {
@@ -20,6 +20,7 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/nodestore/impl/DatabaseNodeImp.h>
 #include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/jss.h>
 
 namespace ripple {
 namespace NodeStore {
@@ -34,6 +35,36 @@ DatabaseNodeImp::store(
     auto nObj = NodeObject::createObject(type, std::move(data), hash);
     backend_->store(nObj);
     storeStats(1, nObj->getData().size());
+    if (cacheWrites_)
+        cache_->canonicalize_replace_cache(hash, nObj);
+}
+
+void
+DatabaseNodeImp::storeBatch(Batch const& batch, std::uint32_t)
+{
+    backend_->storeMany(batch);
+
+    std::uint64_t bytes = 0;
+    for (auto const& object : batch)
+    {
+        bytes += object->getData().size();
+        if (cacheWrites_)
+            cache_->canonicalize_replace_cache(object->getHash(), object);
+    }
+    storeStats(batch.size(), bytes);
+}
+
+void
+DatabaseNodeImp::getCountsJson(Json::Value& obj)
+{
+    Database::getCountsJson(obj);
+    if (cache_)
+    {
+        obj[jss::node_cache_hit_rate] = cache_->getHitRate();
+        obj[jss::node_cache_size] =
+            static_cast<Json::UInt>(cache_->getCacheSize());
+    }
+    backend_->getCountsJson(obj);
 }
 
 void
@@ -100,8 +131,62 @@ DatabaseNodeImp::fetchNodeObject(
     return nodeObject;
 }
 
+bool
+DatabaseNodeImp::fetchNodePayload(
+    uint256 const& hash,
+    std::uint32_t ledgerSeq,
+    std::function<void(Slice)> const& visit,
+    FetchReport& fetchReport)
+{
+    // Objects must be materialized in order to be cached
+    if (cache_)
+        return Database::fetchNodePayload(hash, ledgerSeq, visit, fetchReport);
+
+    bool found{false};
+    Status status;
+    try
+    {
+        status = backend_->fetchPayload(
+            hash.data(), [&found, &visit](Slice data) {
+                found = true;
+                visit(data);
+            });
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.fatal()) << "Exception, " << e.what();
+        Rethrow();
+    }
+
+    switch (status)
+    {
+        case ok:
+        case notFound:
+            break;
+        case dataCorrupt:
+            JLOG(j_.fatal()) << "Corrupt NodeObject #" << hash;
+            break;
+        default:
+            JLOG(j_.warn()) << "Unknown status=" << status;
+            break;
+    }
+
+    if (found)
+        fetchReport.wasFound = true;
+
+    return found;
+}
+
 std::vector<std::shared_ptr<NodeObject>>
 DatabaseNodeImp::fetchBatch(std::vector<uint256> const& hashes)
+{
+    return fetchBatch(hashes, j_.error());
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseNodeImp::fetchBatch(
+    std::vector<uint256> const& hashes,
+    beast::Journal::Stream missing)
 {
     std::vector<std::shared_ptr<NodeObject>> results{hashes.size()};
     using namespace std::chrono;
@@ -150,7 +235,7 @@ DatabaseNodeImp::fetchBatch(std::vector<uint256> const& hashes)
         }
         else
         {
-            JLOG(j_.error())
+            JLOG(missing)
                 << "DatabaseNodeImp::fetchBatch - "
                 << "record not found in db or cache. hash = " << strHex(hash);
         }
@@ -164,5 +249,57 @@ DatabaseNodeImp::fetchBatch(std::vector<uint256> const& hashes)
     return results;
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseNodeImp::fetchBatch(
+    std::vector<uint256> const& hashes,
+    std::uint32_t ledgerSeq)
+{
+    if (!backend_->canFetchBatch())
+        return Database::fetchBatch(hashes, ledgerSeq);
+    return fetchBatchReported(hashes, FetchType::synchronous);
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseNodeImp::fetchBatchAsync(
+    std::vector<uint256> const& hashes,
+    std::uint32_t ledgerSeq)
+{
+    if (!backend_->canFetchBatch())
+        return Database::fetchBatchAsync(hashes, ledgerSeq);
+    return fetchBatchReported(hashes, FetchType::async);
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseNodeImp::fetchBatchReported(
+    std::vector<uint256> const& hashes,
+    FetchType fetchType)
+{
+    using namespace std::chrono;
+    auto const before = steady_clock::now();
+    // Misses are expected here, as for single fetches
+    auto results = fetchBatch(hashes, j_.trace());
+    if (results.empty())
+        return results;
+
+    // Each object is reported with its share of the batch's time
+    auto const elapsed =
+        duration_cast<microseconds>(steady_clock::now() - before) /
+        results.size();
+
+    for (auto const& nodeObject : results)
+    {
+        FetchReport fetchReport(fetchType);
+        fetchReport.elapsed = elapsed;
+        if (nodeObject)
+        {
+            fetchReport.wasFound = true;
+            fetchSz_ += nodeObject->getData().size();
+        }
+        scheduler_.onFetch(fetchReport);
+    }
+
+    return results;
+}
+
 }  // namespace NodeStore
 }  // namespace ripple
@@ -20,7 +20,7 @@
 #ifndef RIPPLE_NODESTORE_DATABASENODEIMP_H_INCLUDED
 #define RIPPLE_NODESTORE_DATABASENODEIMP_H_INCLUDED
 
-#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/ShardedTaggedCache.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/nodestore/Database.h>
 
@@ -72,12 +72,18 @@ public:
                 cacheSize = 16384;
             if (!cacheAge || *cacheAge == 0)
                 cacheAge = 5;
-            cache_ = std::make_shared<TaggedCache<uint256, NodeObject>>(
-                name,
-                cacheSize.value(),
-                std::chrono::minutes{cacheAge.value()},
-                stopwatch(),
-                j);
+            cache_ =
+                std::make_shared<ShardedTaggedCache<uint256, NodeObject>>(
+                    name,
+                    cacheSize.value(),
+                    std::chrono::minutes{cacheAge.value()},
+                    stopwatch(),
+                    j);
+
+            // Objects written are cached too, so that readers of recently
+            // written ledgers need not go to the backend. This pays when
+            // the backend is remote, as in reporting mode
+            cacheWrites_ = get<bool>(config, "cache_writes", false);
         }
         assert(backend_);
         setParent(parent);
@@ -111,6 +117,9 @@ public:
     store(NodeObjectType type, Blob&& data, uint256 const& hash, std::uint32_t)
         override;
 
+    void
+    storeBatch(Batch const& batch, std::uint32_t) override;
+
     bool isSameDB(std::uint32_t, std::uint32_t) override
     {
         // only one database
@@ -125,6 +134,10 @@ public:
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch(std::vector<uint256> const& hashes);
 
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch(std::vector<uint256> const& hashes, std::uint32_t ledgerSeq)
+        override;
+
     bool
     storeLedger(std::shared_ptr<Ledger const> const& srcLedger) override
     {
@@ -134,10 +147,15 @@ public:
     void
     sweep() override;
 
+    void
+    getCountsJson(Json::Value& obj) override;
+
 private:
     // Cache for database objects. This cache is not always initialized. Check
     // for null before using.
-    std::shared_ptr<TaggedCache<uint256, NodeObject>> cache_;
+    std::shared_ptr<ShardedTaggedCache<uint256, NodeObject>> cache_;
+    // Whether objects are added to the cache as they are stored
+    bool cacheWrites_ = false;
     // Persistent key/value storage
     std::shared_ptr<Backend> backend_;
 
@@ -147,6 +165,32 @@ private:
         std::uint32_t,
         FetchReport& fetchReport) override;
 
+    bool
+    fetchNodePayload(
+        uint256 const& hash,
+        std::uint32_t ledgerSeq,
+        std::function<void(Slice)> const& visit,
+        FetchReport& fetchReport) override;
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchAsync(
+        std::vector<uint256> const& hashes,
+        std::uint32_t ledgerSeq) override;
+
+    // Fetch a batch, logging each object found in neither the cache nor
+    // the backend to the given stream
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch(
+        std::vector<uint256> const& hashes,
+        beast::Journal::Stream missing);
+
+    // Fetch a batch from the backend, reporting each object to the
+    // scheduler
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchReported(
+        std::vector<uint256> const& hashes,
+        FetchType fetchType);
+
     void
     for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
     {
@@ -34,13 +34,13 @@ DatabaseRotatingImp::DatabaseRotatingImp(
     Section const& config,
     beast::Journal j)
     : DatabaseRotating(name, parent, scheduler, readThreads, config, j)
-    , writableBackend_(std::move(writableBackend))
-    , archiveBackend_(std::move(archiveBackend))
+    , backends_(std::make_shared<Backends const>(
+          Backends{std::move(writableBackend), std::move(archiveBackend)}))
 {
-    if (writableBackend_)
-        fdRequired_ += writableBackend_->fdRequired();
-    if (archiveBackend_)
-        fdRequired_ += archiveBackend_->fdRequired();
+    if (backends_->writableBackend)
+        fdRequired_ += backends_->writableBackend->fdRequired();
+    if (backends_->archiveBackend)
+        fdRequired_ += backends_->archiveBackend->fdRequired();
     setParent(parent);
 }
 
@@ -51,53 +51,56 @@ DatabaseRotatingImp::rotateWithLock(
 {
     std::lock_guard lock(mutex_);
 
-    auto newBackend = f(writableBackend_->getName());
-    archiveBackend_->setDeletePath();
-    archiveBackend_ = std::move(writableBackend_);
-    writableBackend_ = std::move(newBackend);
+    // Fetches and stores that start while `f` runs wait for the new pair.
+    // Those already under way finish with the current one.
+    rotating_ = true;
+    auto const current = std::atomic_load(&backends_);
+    std::unique_ptr<Backend> newBackend;
+    try
+    {
+        newBackend = f(current->writableBackend->getName());
+    }
+    catch (...)
+    {
+        rotating_ = false;
+        throw;
+    }
+    current->archiveBackend->setDeletePath();
+    std::atomic_store(
+        &backends_,
+        std::make_shared<Backends const>(
+            Backends{std::move(newBackend), current->writableBackend}));
+    rotating_ = false;
 }
 
 std::string
 DatabaseRotatingImp::getName() const
 {
-    std::lock_guard lock(mutex_);
-    return writableBackend_->getName();
+    return backends()->writableBackend->getName();
 }
 
 std::int32_t
 DatabaseRotatingImp::getWriteLoad() const
 {
-    std::lock_guard lock(mutex_);
-    return writableBackend_->getWriteLoad();
+    return backends()->writableBackend->getWriteLoad();
 }
 
 void
 DatabaseRotatingImp::import(Database& source)
 {
-    auto const backend = [&] {
-        std::lock_guard lock(mutex_);
-        return writableBackend_;
-    }();
-
-    importInternal(*backend, source);
+    importInternal(*backends()->writableBackend, source);
 }
 
 bool
 DatabaseRotatingImp::storeLedger(std::shared_ptr<Ledger const> const& srcLedger)
 {
-    auto const backend = [&] {
-        std::lock_guard lock(mutex_);
-        return writableBackend_;
-    }();
-
-    return Database::storeLedger(*srcLedger, backend);
+    return Database::storeLedger(*srcLedger, backends()->writableBackend);
 }
 
 void
 DatabaseRotatingImp::sync()
 {
-    std::lock_guard lock(mutex_);
-    writableBackend_->sync();
+    backends()->writableBackend->sync();
 }
 
 void
@@ -109,21 +112,34 @@ DatabaseRotatingImp::store(
 {
     auto nObj = NodeObject::createObject(type, std::move(data), hash);
 
-    auto const backend = [&] {
-        std::lock_guard lock(mutex_);
-        return writableBackend_;
-    }();
-
-    backend->store(nObj);
+    backends()->writableBackend->store(nObj);
     storeStats(1, nObj->getData().size());
 }
 
+void
+DatabaseRotatingImp::storeBatch(Batch const& batch, std::uint32_t)
+{
+    backends()->writableBackend->storeMany(batch);
+
+    std::uint64_t bytes = 0;
+    for (auto const& object : batch)
+        bytes += object->getData().size();
+    storeStats(batch.size(), bytes);
+}
+
 void
 DatabaseRotatingImp::sweep()
 {
     // nothing to do
 }
 
+void
+DatabaseRotatingImp::getCountsJson(Json::Value& obj)
+{
+    Database::getCountsJson(obj);
+    backends()->writableBackend->getCountsJson(obj);
+}
+
 std::shared_ptr<NodeObject>
 DatabaseRotatingImp::fetchNodeObject(
     uint256 const& hash,
@@ -166,27 +182,19 @@ DatabaseRotatingImp::fetchNodeObject(
     // See if the node object exists in the cache
     std::shared_ptr<NodeObject> nodeObject;
 
-    auto [writable, archive] = [&] {
-        std::lock_guard lock(mutex_);
-        return std::make_pair(writableBackend_, archiveBackend_);
-    }();
+    auto const backends = this->backends();
 
     // Try to fetch from the writable backend
-    nodeObject = fetch(writable);
+    nodeObject = fetch(backends->writableBackend);
     if (!nodeObject)
     {
         // Otherwise try to fetch from the archive backend
-        nodeObject = fetch(archive);
+        nodeObject = fetch(backends->archiveBackend);
         if (nodeObject)
         {
-            {
-                // Refresh the writable backend pointer
-                std::lock_guard lock(mutex_);
-                writable = writableBackend_;
-            }
-
-            // Update writable backend with data from the archive backend
-            writable->store(nodeObject);
+            // Update writable backend with data from the archive backend,
+            // using the latest pair in case a rotation happened meanwhile
+            this->backends()->writableBackend->store(nodeObject);
         }
     }
 
@@ -200,16 +208,13 @@ void
 DatabaseRotatingImp::for_each(
     std::function<void(std::shared_ptr<NodeObject>)> f)
 {
-    auto [writable, archive] = [&] {
-        std::lock_guard lock(mutex_);
-        return std::make_pair(writableBackend_, archiveBackend_);
-    }();
+    auto const backends = this->backends();
 
     // Iterate the writable backend
-    writable->for_each(f);
+    backends->writableBackend->for_each(f);
 
     // Iterate the archive backend
-    archive->for_each(f);
+    backends->archiveBackend->for_each(f);
 }
 
 }  // namespace NodeStore
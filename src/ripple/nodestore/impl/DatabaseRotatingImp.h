@@ -21,6 +21,9 @@
 #define RIPPLE_NODESTORE_DATABASEROTATINGIMP_H_INCLUDED
 
 #include <ripple/nodestore/DatabaseRotating.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace ripple {
 namespace NodeStore {
@@ -73,6 +76,9 @@ public:
     store(NodeObjectType type, Blob&& data, uint256 const& hash, std::uint32_t)
         override;
 
+    void
+    storeBatch(Batch const& batch, std::uint32_t) override;
+
     void
     sync() override;
 
@@ -82,17 +88,34 @@ public:
     void
     sweep() override;
 
-private:
-    std::shared_ptr<Backend> writableBackend_;
-    std::shared_ptr<Backend> archiveBackend_;
-    mutable std::mutex mutex_;
+    void
+    getCountsJson(Json::Value& obj) override;
 
+private:
     struct Backends
     {
-        std::shared_ptr<Backend> const& writableBackend;
-        std::shared_ptr<Backend> const& archiveBackend;
+        std::shared_ptr<Backend> writableBackend;
+        std::shared_ptr<Backend> archiveBackend;
     };
 
+    // The current pair is replaced as a whole on rotation, so readers
+    // take a snapshot without locking. The mutex is held for a rotation,
+    // and readers only wait on it while a rotation function runs.
+    std::shared_ptr<Backends const> backends_;
+    mutable std::mutex mutex_;
+    std::atomic<bool> rotating_{false};
+
+    std::shared_ptr<Backends const>
+    backends() const
+    {
+        if (rotating_)
+        {
+            std::lock_guard lock(mutex_);
+            return backends_;
+        }
+        return std::atomic_load(&backends_);
+    }
+
     std::shared_ptr<NodeObject>
     fetchNodeObject(
         uint256 const& hash,
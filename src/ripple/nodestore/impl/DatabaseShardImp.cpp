@@ -24,11 +24,13 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/random.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/impl/DatabaseShardImp.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/jss.h>
 
 #include <boost/algorithm/string/predicate.hpp>
 
@@ -155,13 +157,25 @@ DatabaseShardImp::init()
                         continue;
                     }
 
-                    // Check if a previous import failed
+                    // Check if a previous import was interrupted. It is
+                    // resumed if the node store is being imported again.
                     if (is_regular_file(shardDir / importMarker_))
                     {
-                        JLOG(j_.warn())
-                            << "shard " << shardIndex
-                            << " previously failed import, removing";
-                        remove_all(shardDir);
+                        if (app_.config().nodeToShard)
+                        {
+                            JLOG(j_.warn()) << "shard " << shardIndex
+                                            << " previously interrupted "
+                                               "import, resuming";
+                            importIndexes_.emplace(
+                                shardIndex, shardDir.parent_path());
+                        }
+                        else
+                        {
+                            JLOG(j_.warn())
+                                << "shard " << shardIndex
+                                << " previously failed import, removing";
+                            remove_all(shardDir);
+                        }
                         continue;
                     }
 
@@ -362,8 +376,11 @@ DatabaseShardImp::prepareShards(std::vector<std::uint32_t> const& shardIndexes)
         if (shards_.find(shardIndex) != shards_.end())
             return fail("is already stored", shardIndex);
 
-        if (preparedIndexes_.find(shardIndex) != preparedIndexes_.end())
+        if (preparedIndexes_.find(shardIndex) != preparedIndexes_.end() ||
+            importIndexes_.find(shardIndex) != importIndexes_.end())
+        {
             return fail("is already queued for import", shardIndex);
+        }
 
         // Any shard earlier than the two most recent shards
         // is a historical shard
@@ -580,7 +597,7 @@ DatabaseShardImp::fetchLedger(uint256 const& hash, std::uint32_t ledgerSeq)
     };
 
     auto ledger{std::make_shared<Ledger>(
-        deserializePrefixedHeader(makeSlice(nodeObject->getData())),
+        deserializePrefixedHeader(nodeObject->getData()),
         app_.config(),
         *app_.getShardFamily())};
 
@@ -689,6 +706,36 @@ DatabaseShardImp::getCompleteShards()
     return status_;
 }
 
+Json::Value
+DatabaseShardImp::getFinalizingShards()
+{
+    std::vector<std::shared_ptr<Shard>> shards;
+    {
+        std::lock_guard lock(mutex_);
+        assert(init_);
+
+        for (auto const& e : shards_)
+            if (e.second->getState() == Shard::finalizing)
+                shards.push_back(e.second);
+    }
+
+    Json::Value ret(Json::arrayValue);
+    for (auto const& shard : shards)
+    {
+        auto const progress{shard->getFinalizeProgress()};
+        Json::Value& jv{ret.append(Json::objectValue)};
+        jv[jss::index] = shard->index();
+        jv[jss::ledgers_verified] = progress.verified;
+        jv[jss::ledgers_total] = progress.total;
+        if (progress.elapsed.count() > 0)
+        {
+            jv[jss::ledgers_per_second] =
+                1000.0 * progress.verified / progress.elapsed.count();
+        }
+    }
+    return ret;
+}
+
 void
 DatabaseShardImp::onStop()
 {
@@ -734,6 +781,9 @@ DatabaseShardImp::onChildrenStopped()
 void
 DatabaseShardImp::import(Database& source)
 {
+    std::uint32_t earliestIndex;
+    std::uint32_t latestIndex;
+    std::uint32_t numHistShards;
     {
         std::lock_guard lock(mutex_);
         assert(init_);
@@ -746,8 +796,6 @@ DatabaseShardImp::import(Database& source)
             return;
         }
 
-        std::uint32_t earliestIndex;
-        std::uint32_t latestIndex;
         {
             auto loadLedger = [&](bool ascendSort =
                                       true) -> boost::optional<std::uint32_t> {
@@ -797,174 +845,261 @@ DatabaseShardImp::import(Database& source)
             }
         }
 
-        auto numHistShards = this->numHistoricalShards(lock);
+        numHistShards = numHistoricalShards(lock);
+    }
 
-        // Import the shards
-        for (std::uint32_t shardIndex = earliestIndex;
-             shardIndex <= latestIndex;
-             ++shardIndex)
+    // Import several shards at once. Each thread holds only the ledger
+    // it is copying and the one before it, so memory use grows with the
+    // number of threads rather than the number of shards.
+    std::atomic<bool> canImport{true};
+    auto importShard = [&](std::size_t i) {
+        if (!canImport)
+            return;
+
+        try
         {
-            auto const pathDesignation =
-                prepareForNewShard(shardIndex, numHistShards, lock);
+            auto const shardIndex{
+                earliestIndex + static_cast<std::uint32_t>(i)};
+            if (!importFromNodeStore(source, shardIndex, numHistShards))
+                canImport = false;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.fatal()) << "Exception caught in function " << __func__
+                             << ". Error: " << e.what();
+            canImport = false;
+        }
+    };
 
-            if (!pathDesignation)
-                break;
+    // The shards are spread over at most importThreads_ threads
+    {
+        auto const count{latestIndex - earliestIndex + 1};
+        auto const threads{std::min(importThreads_, count)};
+        app_.getWorkerPool().run(
+            count, importShard, (count + threads - 1) / threads);
+    }
 
-            auto const needsHistoricalPath =
-                *pathDesignation == PathDesignation::historical;
+    {
+        std::lock_guard lock(mutex_);
+        updateStatus(lock);
+    }
 
-            // Skip if being acquired
-            if (shardIndex == acquireIndex_)
-            {
-                JLOG(j_.debug())
-                    << "shard " << shardIndex << " already being acquired";
-                continue;
-            }
+    setFileStats();
+}
+
+bool
+DatabaseShardImp::importFromNodeStore(
+    Database& source,
+    std::uint32_t shardIndex,
+    std::uint32_t& numHistShards)
+{
+    using namespace boost::filesystem;
+    std::unique_ptr<Shard> shard;
+    path markerFile;
+    auto const isHistorical{shardIndex < shardBoundaryIndex()};
+    {
+        std::lock_guard lock(mutex_);
+
+        auto const pathDesignation =
+            prepareForNewShard(shardIndex, numHistShards, lock);
+
+        if (!pathDesignation)
+            return false;
+
+        auto const needsHistoricalPath =
+            *pathDesignation == PathDesignation::historical;
+
+        // Skip if being acquired
+        if (shardIndex == acquireIndex_)
+        {
+            JLOG(j_.debug())
+                << "shard " << shardIndex << " already being acquired";
+            return true;
+        }
+
+        // Skip if being imported
+        if (preparedIndexes_.find(shardIndex) != preparedIndexes_.end())
+        {
+            JLOG(j_.debug())
+                << "shard " << shardIndex << " already being imported";
+            return true;
+        }
 
-            // Skip if being imported
-            if (preparedIndexes_.find(shardIndex) != preparedIndexes_.end())
+        // Skip if stored
+        if (shards_.find(shardIndex) != shards_.end())
+        {
+            JLOG(j_.debug()) << "shard " << shardIndex << " already stored";
+            return true;
+        }
+
+        // Verify SQLite ledgers are in the node store
+        {
+            auto const firstSeq{firstLedgerSeq(shardIndex)};
+            auto const lastSeq{std::max(firstSeq, lastLedgerSeq(shardIndex))};
+            auto const numLedgers{
+                shardIndex == earliestShardIndex() ? lastSeq - firstSeq + 1
+                                                   : ledgersPerShard_};
+            auto ledgerHashes{getHashesByIndex(firstSeq, lastSeq, app_)};
+            if (ledgerHashes.size() != numLedgers)
+                return true;
+
+            for (std::uint32_t n = firstSeq; n <= lastSeq; n += 256)
             {
-                JLOG(j_.debug())
-                    << "shard " << shardIndex << " already being imported";
-                continue;
+                if (!source.fetchNodeObject(ledgerHashes[n].first, n))
+                {
+                    JLOG(j_.warn()) << "SQLite ledger sequence " << n
+                                    << " mismatches node store";
+                    return true;
+                }
             }
+        }
 
-            // Skip if stored
-            if (shards_.find(shardIndex) != shards_.end())
+        // Resume an import interrupted by a restart
+        if (auto const it{importIndexes_.find(shardIndex)};
+            it != importIndexes_.end())
+        {
+            shard = std::make_unique<Shard>(
+                app_, *this, shardIndex, it->second, j_);
+            if (shard->init(scheduler_, *ctx_))
             {
-                JLOG(j_.debug()) << "shard " << shardIndex << " already stored";
-                continue;
+                JLOG(j_.info()) << "shard " << shardIndex << " resuming import";
+                markerFile = shard->getDir() / importMarker_;
             }
-
-            // Verify SQLite ledgers are in the node store
+            else
             {
-                auto const firstSeq{firstLedgerSeq(shardIndex)};
-                auto const lastSeq{
-                    std::max(firstSeq, lastLedgerSeq(shardIndex))};
-                auto const numLedgers{
-                    shardIndex == earliestShardIndex() ? lastSeq - firstSeq + 1
-                                                       : ledgersPerShard_};
-                auto ledgerHashes{getHashesByIndex(firstSeq, lastSeq, app_)};
-                if (ledgerHashes.size() != numLedgers)
-                    continue;
-
-                bool valid{true};
-                for (std::uint32_t n = firstSeq; n <= lastSeq; n += 256)
-                {
-                    if (!source.fetchNodeObject(ledgerHashes[n].first, n))
-                    {
-                        JLOG(j_.warn()) << "SQLite ledger sequence " << n
-                                        << " mismatches node store";
-                        valid = false;
-                        break;
-                    }
-                }
-                if (!valid)
-                    continue;
+                // Removes the directory so the import can start over
+                shard->removeOnDestroy();
+                shard.reset();
             }
+        }
 
+        if (!shard)
+        {
             auto const path =
                 needsHistoricalPath ? chooseHistoricalPath(lock) : dir_;
 
             // Create the new shard
-            auto shard{
-                std::make_unique<Shard>(app_, *this, shardIndex, path, j_)};
+            shard = std::make_unique<Shard>(app_, *this, shardIndex, path, j_);
             if (!shard->init(scheduler_, *ctx_))
-                continue;
+            {
+                importIndexes_.erase(shardIndex);
+                return true;
+            }
 
             // Create a marker file to signify an import in progress
-            auto const shardDir{path / std::to_string(shardIndex)};
-            auto const markerFile{shardDir / importMarker_};
+            markerFile = shard->getDir() / importMarker_;
+            std::ofstream ofs{markerFile.string()};
+            if (!ofs.is_open())
             {
-                std::ofstream ofs{markerFile.string()};
-                if (!ofs.is_open())
-                {
-                    JLOG(j_.error()) << "shard " << shardIndex
-                                     << " failed to create temp marker file";
-                    shard->removeOnDestroy();
-                    continue;
-                }
-                ofs.close();
+                JLOG(j_.error()) << "shard " << shardIndex
+                                 << " failed to create temp marker file";
+                importIndexes_.erase(shardIndex);
+                shard->removeOnDestroy();
+                return true;
             }
+            ofs.close();
+        }
 
-            // Copy the ledgers from node store
-            std::shared_ptr<Ledger> recentStored;
-            boost::optional<uint256> lastLedgerHash;
+        // Keep other imports, downloads and acquisitions away from the
+        // shard, and count it against the limit while it is copied
+        importIndexes_[shardIndex] = shard->getDir().parent_path();
+        if (isHistorical)
+            ++numHistShards;
+    }
 
-            while (auto const ledgerSeq = shard->prepare())
-            {
-                auto ledger{loadByIndex(*ledgerSeq, app_, false)};
-                if (!ledger || ledger->info().seq != ledgerSeq)
-                    break;
+    // Copy the ledgers from node store
+    std::shared_ptr<Ledger> recentStored;
+    boost::optional<uint256> lastLedgerHash;
+    std::uint32_t copied{0};
 
-                auto const result{shard->storeLedger(ledger, recentStored)};
-                storeStats(result.count, result.size);
-                if (result.error)
-                    break;
+    while (auto const ledgerSeq = shard->prepare())
+    {
+        auto ledger{loadByIndex(*ledgerSeq, app_, false)};
+        if (!ledger || ledger->info().seq != ledgerSeq)
+            break;
 
-                if (!shard->setLedgerStored(ledger))
-                    break;
+        auto const result{shard->storeLedger(ledger, recentStored)};
+        storeStats(result.count, result.size);
+        if (result.error)
+            break;
 
-                if (!lastLedgerHash && ledgerSeq == lastLedgerSeq(shardIndex))
-                    lastLedgerHash = ledger->info().hash;
+        if (!shard->setLedgerStored(ledger))
+            break;
 
-                recentStored = std::move(ledger);
-            }
+        if (!lastLedgerHash && ledgerSeq == lastLedgerSeq(shardIndex))
+            lastLedgerHash = ledger->info().hash;
 
-            using namespace boost::filesystem;
-            bool success{false};
-            if (lastLedgerHash && shard->getState() == Shard::complete)
+        recentStored = std::move(ledger);
+
+        if (++copied % 1024 == 0)
+        {
+            JLOG(j_.info()) << "shard " << shardIndex << " imported "
+                            << copied << " ledgers";
+        }
+    }
+
+    // A resumed import may have stored the last ledger before the restart
+    if (!lastLedgerHash && shard->getState() == Shard::complete)
+    {
+        if (auto const hash{getHashByIndex(lastLedgerSeq(shardIndex), app_)};
+            hash.isNonZero())
+        {
+            lastLedgerHash = hash;
+        }
+    }
+
+    bool success{false};
+    if (lastLedgerHash && shard->getState() == Shard::complete)
+    {
+        // Store shard final key
+        Serializer s;
+        s.add32(Shard::version);
+        s.add32(firstLedgerSeq(shardIndex));
+        s.add32(lastLedgerSeq(shardIndex));
+        s.addBitString(*lastLedgerHash);
+        auto const nodeObject{NodeObject::createObject(
+            hotUNKNOWN, std::move(s.modData()), Shard::finalKey)};
+
+        if (shard->storeNodeObject(nodeObject))
+        {
+            std::lock_guard lock(mutex_);
+            try
             {
-                // Store shard final key
-                Serializer s;
-                s.add32(Shard::version);
-                s.add32(firstLedgerSeq(shardIndex));
-                s.add32(lastLedgerSeq(shardIndex));
-                s.addBitString(*lastLedgerHash);
-                auto const nodeObject{NodeObject::createObject(
-                    hotUNKNOWN, std::move(s.modData()), Shard::finalKey)};
-
-                if (shard->storeNodeObject(nodeObject))
-                {
-                    try
-                    {
-                        // The import process is complete and the
-                        // marker file is no longer required
-                        remove_all(markerFile);
-
-                        JLOG(j_.debug()) << "shard " << shardIndex
-                                         << " was successfully imported";
-                        finalizeShard(
-                            shards_.emplace(shardIndex, std::move(shard))
-                                .first->second,
-                            true,
-                            boost::none);
-                        success = true;
-
-                        if (shardIndex < shardBoundaryIndex())
-                            ++numHistShards;
-                    }
-                    catch (std::exception const& e)
-                    {
-                        JLOG(j_.fatal()) << "shard index " << shardIndex
-                                         << ". Exception caught in function "
-                                         << __func__ << ". Error: " << e.what();
-                    }
-                }
-            }
+                // The import process is complete and the
+                // marker file is no longer required
+                remove_all(markerFile);
 
-            if (!success)
+                JLOG(j_.debug())
+                    << "shard " << shardIndex << " was successfully imported";
+                importIndexes_.erase(shardIndex);
+                finalizeShard(
+                    shards_.emplace(shardIndex, std::move(shard)).first->second,
+                    true,
+                    boost::none);
+                success = true;
+            }
+            catch (std::exception const& e)
             {
-                JLOG(j_.error())
-                    << "shard " << shardIndex << " failed to import";
-                shard->removeOnDestroy();
+                JLOG(j_.fatal()) << "shard index " << shardIndex
+                                 << ". Exception caught in function "
+                                 << __func__ << ". Error: " << e.what();
             }
         }
+    }
 
-        updateStatus(lock);
+    if (!success)
+    {
+        JLOG(j_.error()) << "shard " << shardIndex << " failed to import";
+
+        std::lock_guard lock(mutex_);
+        importIndexes_.erase(shardIndex);
+        if (isHistorical)
+            --numHistShards;
+        if (shard)
+            shard->removeOnDestroy();
     }
 
-    setFileStats();
+    return true;
 }
 
 std::int32_t
@@ -1150,6 +1285,8 @@ DatabaseShardImp::initConfig(std::lock_guard<std::mutex> const&)
 
     {
         get_if_exists(section, "max_historical_shards", maxHistoricalShards_);
+        get_if_exists(section, "import_threads", importThreads_);
+        importThreads_ = std::max(importThreads_, 1u);
 
         Section const& historicalShardPaths =
             config.section(SECTION_HISTORICAL_SHARD_PATHS);
@@ -1201,6 +1338,28 @@ DatabaseShardImp::fetchNodeObject(
     std::uint32_t ledgerSeq,
     FetchReport& fetchReport)
 {
+    // Without a ledger sequence, only search the shards whose filters
+    // may contain the hash
+    if (ledgerSeq < earliestLedgerSeq())
+    {
+        std::vector<std::shared_ptr<Shard>> candidates;
+        {
+            std::lock_guard lock(mutex_);
+            candidates.reserve(shards_.size());
+            for (auto const& e : shards_)
+                candidates.push_back(e.second);
+        }
+
+        for (auto const& shard : candidates)
+        {
+            if (!shard->mayContain(hash))
+                continue;
+            if (auto nodeObject{shard->fetchNodeObject(hash, fetchReport)})
+                return nodeObject;
+        }
+        return nullptr;
+    }
+
     auto const shardIndex{seqToShardIndex(ledgerSeq)};
     std::shared_ptr<Shard> shard;
     {
@@ -1247,7 +1406,8 @@ DatabaseShardImp::findAcquireIndex(
              ++shardIndex)
         {
             if (shards_.find(shardIndex) == shards_.end() &&
-                preparedIndexes_.find(shardIndex) == preparedIndexes_.end())
+                preparedIndexes_.find(shardIndex) == preparedIndexes_.end() &&
+                importIndexes_.find(shardIndex) == importIndexes_.end())
             {
                 available.push_back(shardIndex);
             }
@@ -1270,7 +1430,8 @@ DatabaseShardImp::findAcquireIndex(
     {
         auto const shardIndex{rand_int(earliestShardIndex(), maxShardIndex)};
         if (shards_.find(shardIndex) == shards_.end() &&
-            preparedIndexes_.find(shardIndex) == preparedIndexes_.end())
+            preparedIndexes_.find(shardIndex) == preparedIndexes_.end() &&
+            importIndexes_.find(shardIndex) == importIndexes_.end())
         {
             return shardIndex;
         }
@@ -26,6 +26,8 @@
 
 #include <boost/asio/basic_waitable_timer.hpp>
 
+#include <map>
+
 namespace ripple {
 namespace NodeStore {
 
@@ -76,6 +78,9 @@ public:
     std::string
     getCompleteShards() override;
 
+    Json::Value
+    getFinalizingShards() override;
+
     std::uint32_t
     ledgersPerShard() const override
     {
@@ -184,6 +189,13 @@ private:
     // Shard indexes being imported
     std::set<std::uint32_t> preparedIndexes_;
 
+    // Shards being copied from the node store, or whose copy was
+    // interrupted and will be resumed, with the directory holding them
+    std::map<std::uint32_t, boost::filesystem::path> importIndexes_;
+
+    // Maximum number of shards copied from the node store at once
+    std::uint32_t importThreads_{2};
+
     // Shard index being acquired from the peer network
     std::uint32_t acquireIndex_{0};
 
@@ -252,6 +264,14 @@ private:
         Throw<std::runtime_error>("Shard store import not supported");
     }
 
+    // Copy a shard from the node store, resuming an interrupted copy
+    // if there is one. Returns false if no more shards can be added.
+    bool
+    importFromNodeStore(
+        Database& source,
+        std::uint32_t shardIndex,
+        std::uint32_t& numHistShards);
+
     // Randomly select a shard index not stored
     // Lock must be held
     boost::optional<std::uint32_t>
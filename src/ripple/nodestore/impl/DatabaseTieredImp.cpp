@@ -0,0 +1,366 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/beast/core/LexicalCast.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DatabaseTieredImp.h>
+#include <ripple/protocol/jss.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+
+namespace ripple {
+namespace NodeStore {
+
+DatabaseTieredImp::DatabaseTieredImp(
+    std::string const& name,
+    std::size_t burstSize,
+    Scheduler& scheduler,
+    int readThreads,
+    Stoppable& parent,
+    Section const& config,
+    beast::Journal j)
+    : Database(name, parent, scheduler, readThreads, config, j)
+    , burstSize_(burstSize)
+    , hotConfig_(config)
+    , hotPath_(get<std::string>(config, "path"))
+    , cold_([&]() -> std::shared_ptr<Backend> {
+        Section section(config);
+        std::string type;
+        if (get_if_exists(config, "cold_type", type))
+            section.set("type", type);
+        section.set("path", get<std::string>(config, "cold_path"));
+        auto backend = Manager::instance().make_Backend(
+            section, burstSize, scheduler, j);
+        backend->open();
+        return backend;
+    }())
+{
+    if (hotPath_.empty())
+        Throw<std::runtime_error>(
+            "nodestore: Missing path in tiered database");
+    if (config.exists("hot_age"))
+    {
+        auto const age = get<int>(config, "hot_age");
+        if (age <= 0)
+            Throw<std::runtime_error>(
+                "Specified non-positive value for hot_age");
+        hotAge_ = std::chrono::minutes{age};
+    }
+
+    recover();
+
+    // Up to three hot generations are open while one is being started
+    fdRequired_ += cold_->fdRequired() + 3 * tiers_->hot->fdRequired();
+    demoteThread_ = std::thread(&DatabaseTieredImp::demote, this);
+    setParent(parent);
+}
+
+DatabaseTieredImp::~DatabaseTieredImp()
+{
+    // Stop read threads in base before data members are destroyed
+    stopReadThreads();
+
+    {
+        std::lock_guard lock(demoteMutex_);
+        demoteStop_ = true;
+    }
+    demoteCond_.notify_all();
+    if (demoteThread_.joinable())
+        demoteThread_.join();
+}
+
+std::string
+DatabaseTieredImp::getName() const
+{
+    return tiers()->hot->getName();
+}
+
+std::int32_t
+DatabaseTieredImp::getWriteLoad() const
+{
+    std::size_t queued;
+    {
+        std::lock_guard lock(demoteMutex_);
+        queued = demoteQueue_.size();
+    }
+    return tiers()->hot->getWriteLoad() + static_cast<std::int32_t>(queued);
+}
+
+void
+DatabaseTieredImp::import(Database& source)
+{
+    // Imported objects are history, so they go straight to the cold tier
+    importInternal(*cold_, source);
+}
+
+void
+DatabaseTieredImp::store(
+    NodeObjectType type,
+    Blob&& data,
+    uint256 const& hash,
+    std::uint32_t)
+{
+    auto nObj = NodeObject::createObject(type, std::move(data), hash);
+    tiers()->hot->store(nObj);
+    storeStats(1, nObj->getData().size());
+
+    bool queued = false;
+    {
+        std::lock_guard lock(demoteMutex_);
+        if (!demoteStop_ && demoteQueue_.size() < maxDemoteQueue)
+        {
+            demoteQueue_.push_back(nObj);
+            queued = true;
+        }
+    }
+
+    if (queued)
+        demoteCond_.notify_one();
+    else
+    {
+        // The demotion thread is behind, so write the object ourselves
+        cold_->store(nObj);
+        ++demoted_;
+    }
+}
+
+void
+DatabaseTieredImp::sync()
+{
+    tiers()->hot->sync();
+    {
+        std::unique_lock lock(demoteMutex_);
+        demoteDoneCond_.wait(lock, [this] {
+            return demoteQueue_.empty() && demoteActive_ == 0;
+        });
+    }
+    cold_->sync();
+}
+
+bool
+DatabaseTieredImp::storeLedger(std::shared_ptr<Ledger const> const& srcLedger)
+{
+    // Copied ledgers are history, so they go straight to the cold tier
+    return Database::storeLedger(*srcLedger, cold_);
+}
+
+void
+DatabaseTieredImp::getCountsJson(Json::Value& obj)
+{
+    Database::getCountsJson(obj);
+    obj[jss::node_hot_reads] = std::to_string(hotReads_);
+    obj[jss::node_hot_hits] = std::to_string(hotHits_);
+    obj[jss::node_cold_reads] = std::to_string(coldReads_);
+    obj[jss::node_cold_hits] = std::to_string(coldHits_);
+    obj[jss::node_demoted] = std::to_string(demoted_);
+}
+
+std::shared_ptr<Backend>
+DatabaseTieredImp::makeGeneration(std::uint64_t generation)
+{
+    Section section(hotConfig_);
+    section.set(
+        "path",
+        (boost::filesystem::path(hotPath_) / std::to_string(generation))
+            .string());
+    std::shared_ptr<Backend> backend = Manager::instance().make_Backend(
+        section, burstSize_, scheduler_, j_);
+    backend->open();
+    return backend;
+}
+
+void
+DatabaseTieredImp::recover()
+{
+    namespace fs = boost::filesystem;
+
+    std::vector<std::uint64_t> existing;
+    if (fs::is_directory(hotPath_))
+    {
+        for (auto const& entry : fs::directory_iterator(hotPath_))
+        {
+            std::uint64_t generation;
+            if (fs::is_directory(entry.path()) &&
+                beast::lexicalCastChecked(
+                    generation, entry.path().filename().string()))
+                existing.push_back(generation);
+        }
+    }
+    std::sort(existing.begin(), existing.end());
+
+    // Objects still queued for the cold tier when the server stopped
+    // are lost, so copy every generation left behind across in full.
+    // The newest is kept for reads until the next generation starts.
+    std::shared_ptr<Backend> previous;
+    for (auto const generation : existing)
+    {
+        auto backend = makeGeneration(generation);
+        JLOG(j_.info()) << "Copying hot generation " << backend->getName()
+                        << " to the cold tier";
+        backend->for_each([this](std::shared_ptr<NodeObject> nodeObject) {
+            cold_->store(nodeObject);
+        });
+        if (previous)
+            previous->setDeletePath();
+        previous = std::move(backend);
+    }
+    cold_->sync();
+
+    generation_ = existing.empty() ? 0 : existing.back() + 1;
+    tiers_ = std::make_shared<Tiers const>(
+        Tiers{makeGeneration(generation_), std::move(previous)});
+}
+
+void
+DatabaseTieredImp::demote()
+{
+    using namespace std::chrono;
+
+    std::unique_lock lock(demoteMutex_);
+    auto rotateAt = steady_clock::now() + hotAge_;
+    while (!demoteStop_)
+    {
+        demoteCond_.wait_until(lock, rotateAt, [this] {
+            return demoteStop_ || !demoteQueue_.empty();
+        });
+        flushDemoteQueue(lock);
+
+        if (!demoteStop_ && steady_clock::now() >= rotateAt)
+        {
+            lock.unlock();
+            rotate();
+            lock.lock();
+            rotateAt = steady_clock::now() + hotAge_;
+        }
+    }
+    flushDemoteQueue(lock);
+}
+
+void
+DatabaseTieredImp::flushDemoteQueue(std::unique_lock<std::mutex>& lock)
+{
+    while (!demoteQueue_.empty())
+    {
+        std::vector<std::shared_ptr<NodeObject>> batch;
+        batch.swap(demoteQueue_);
+        ++demoteActive_;
+        lock.unlock();
+
+        for (auto const& nodeObject : batch)
+            cold_->store(nodeObject);
+        demoted_ += batch.size();
+
+        lock.lock();
+        --demoteActive_;
+    }
+    demoteDoneCond_.notify_all();
+}
+
+void
+DatabaseTieredImp::rotate()
+{
+    // Everything stored before the previous generation was retired
+    // has been flushed to the cold tier, so it can be dropped now.
+    auto const current = tiers();
+    auto hot = makeGeneration(++generation_);
+    JLOG(j_.debug()) << "Started hot generation " << hot->getName();
+
+    cold_->sync();
+    if (current->previous)
+        current->previous->setDeletePath();
+    std::atomic_store(
+        &tiers_,
+        std::make_shared<Tiers const>(Tiers{std::move(hot), current->hot}));
+}
+
+std::shared_ptr<NodeObject>
+DatabaseTieredImp::fetchFrom(Backend& backend, uint256 const& hash)
+{
+    Status status;
+    std::shared_ptr<NodeObject> nodeObject;
+    try
+    {
+        status = backend.fetch(hash.data(), &nodeObject);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.fatal()) << "Exception, " << e.what();
+        Rethrow();
+    }
+
+    switch (status)
+    {
+        case ok:
+            ++fetchHitCount_;
+            if (nodeObject)
+                fetchSz_ += nodeObject->getData().size();
+            break;
+        case notFound:
+            break;
+        case dataCorrupt:
+            JLOG(j_.fatal()) << "Corrupt NodeObject #" << hash;
+            break;
+        default:
+            JLOG(j_.warn()) << "Unknown status=" << status;
+            break;
+    }
+
+    return nodeObject;
+}
+
+std::shared_ptr<NodeObject>
+DatabaseTieredImp::fetchNodeObject(
+    uint256 const& hash,
+    std::uint32_t,
+    FetchReport& fetchReport)
+{
+    auto const tiers = this->tiers();
+
+    ++hotReads_;
+    auto nodeObject = fetchFrom(*tiers->hot, hash);
+    if (!nodeObject && tiers->previous)
+        nodeObject = fetchFrom(*tiers->previous, hash);
+
+    if (nodeObject)
+        ++hotHits_;
+    else
+    {
+        ++coldReads_;
+        nodeObject = fetchFrom(*cold_, hash);
+        if (nodeObject)
+            ++coldHits_;
+    }
+
+    if (nodeObject)
+        fetchReport.wasFound = true;
+
+    return nodeObject;
+}
+
+void
+DatabaseTieredImp::for_each(std::function<void(std::shared_ptr<NodeObject>)> f)
+{
+    // Once the queue is flushed the cold tier holds every object
+    sync();
+    cold_->for_each(f);
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
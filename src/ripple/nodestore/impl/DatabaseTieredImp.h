@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_DATABASETIEREDIMP_H_INCLUDED
+#define RIPPLE_NODESTORE_DATABASETIEREDIMP_H_INCLUDED
+
+#include <ripple/nodestore/Database.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A database split between a fast hot tier and a large cold tier.
+
+    New objects are written to the hot tier and queued for the cold tier,
+    which a background thread writes them to. The hot tier is a sequence
+    of generations kept in numbered directories below the configured path.
+    Every hot_age minutes a new generation is started, and the one before
+    the current generation is dropped, since all of its objects have by
+    then reached the cold tier. Reads check the hot generations first.
+*/
+class DatabaseTieredImp : public Database
+{
+public:
+    DatabaseTieredImp() = delete;
+    DatabaseTieredImp(DatabaseTieredImp const&) = delete;
+    DatabaseTieredImp&
+    operator=(DatabaseTieredImp const&) = delete;
+
+    DatabaseTieredImp(
+        std::string const& name,
+        std::size_t burstSize,
+        Scheduler& scheduler,
+        int readThreads,
+        Stoppable& parent,
+        Section const& config,
+        beast::Journal j);
+
+    ~DatabaseTieredImp() override;
+
+    std::string
+    getName() const override;
+
+    std::int32_t
+    getWriteLoad() const override;
+
+    void
+    import(Database& source) override;
+
+    void
+    store(NodeObjectType type, Blob&& data, uint256 const& hash, std::uint32_t)
+        override;
+
+    bool isSameDB(std::uint32_t, std::uint32_t) override
+    {
+        // both tiers act as one logical database
+        return true;
+    }
+
+    void
+    sync() override;
+
+    bool
+    storeLedger(std::shared_ptr<Ledger const> const& srcLedger) override;
+
+    void
+    sweep() override
+    {
+        // nothing to do
+    }
+
+    void
+    getCountsJson(Json::Value& obj) override;
+
+private:
+    struct Tiers
+    {
+        // Receives new objects
+        std::shared_ptr<Backend> hot;
+        // The previous generation, whose objects may still be queued
+        std::shared_ptr<Backend> previous;
+    };
+
+    // Objects waiting in the queue past this point are written to the
+    // cold tier by the storing thread instead
+    static constexpr std::size_t maxDemoteQueue = 65536;
+
+    std::size_t const burstSize_;
+    Section hotConfig_;
+    std::string const hotPath_;
+    std::chrono::minutes hotAge_{60};
+    std::uint64_t generation_{0};
+
+    // Replaced as a whole when a generation is started. Readers take a
+    // snapshot without locking.
+    std::shared_ptr<Tiers const> tiers_;
+    std::shared_ptr<Backend> const cold_;
+
+    mutable std::mutex demoteMutex_;
+    std::condition_variable demoteCond_;
+    std::condition_variable demoteDoneCond_;
+    std::vector<std::shared_ptr<NodeObject>> demoteQueue_;
+    std::size_t demoteActive_{0};
+    bool demoteStop_{false};
+    std::thread demoteThread_;
+
+    std::atomic<std::uint64_t> hotReads_{0};
+    std::atomic<std::uint64_t> hotHits_{0};
+    std::atomic<std::uint64_t> coldReads_{0};
+    std::atomic<std::uint64_t> coldHits_{0};
+    std::atomic<std::uint64_t> demoted_{0};
+
+    std::shared_ptr<Tiers const>
+    tiers() const
+    {
+        return std::atomic_load(&tiers_);
+    }
+
+    std::shared_ptr<Backend>
+    makeGeneration(std::uint64_t generation);
+
+    void
+    recover();
+
+    void
+    demote();
+
+    void
+    flushDemoteQueue(std::unique_lock<std::mutex>& lock);
+
+    void
+    rotate();
+
+    std::shared_ptr<NodeObject>
+    fetchFrom(Backend& backend, uint256 const& hash);
+
+    std::shared_ptr<NodeObject>
+    fetchNodeObject(
+        uint256 const& hash,
+        std::uint32_t,
+        FetchReport& fetchReport) override;
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override;
+
+    std::optional<Backend::Counters<std::uint64_t>>
+    getCounters() const override
+    {
+        return cold_->counters();
+    }
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
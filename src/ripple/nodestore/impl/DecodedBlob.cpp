@@ -64,6 +64,7 @@ DecodedBlob::DecodedBlob(void const* key, void const* value, int valueBytes)
             case hotLEDGER:
             case hotACCOUNT_NODE:
             case hotTRANSACTION_NODE:
+            case hotTX_INDEX:
                 m_success = true;
                 break;
         }
@@ -79,10 +80,10 @@ DecodedBlob::createObject()
 
     if (m_success)
     {
-        Blob data(m_objectData, m_objectData + m_dataBytes);
-
         object = NodeObject::createObject(
-            m_objectType, std::move(data), uint256::fromVoid(m_key));
+            m_objectType,
+            Slice(m_objectData, m_dataBytes),
+            uint256::fromVoid(m_key));
     }
 
     return object;
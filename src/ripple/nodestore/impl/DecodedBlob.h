@@ -52,6 +52,13 @@ public:
     std::shared_ptr<NodeObject>
     createObject();
 
+    /** Returns the payload, which refers to the raw data. */
+    Slice
+    getData() const noexcept
+    {
+        return {m_objectData, static_cast<std::size_t>(m_dataBytes)};
+    }
+
 private:
     bool m_success;
 
@@ -0,0 +1,495 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/BloomBlock.h>
+#include <ripple/nodestore/impl/FilteredBackend.h>
+
+#include <nudb/nudb.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+std::array<std::uint8_t, 8> constexpr keyFilterMagic{
+    {'R', 'K', 'F', 'I', 'L', 'T', 'E', 'R'}};
+std::uint32_t constexpr keyFilterVersion{1};
+std::size_t constexpr keyFilterHeaderBytes{8 + 4 + 8 + 8 + 8};
+
+std::size_t constexpr blockWords{detail::bloomBlockBytes / 8};
+
+// Words read or written to the filter file at once
+std::size_t constexpr chunkWords{8192};
+
+// Keys a filter is sized for when no size is configured
+std::uint64_t constexpr defaultKeyFilterCapacity{16 * 1024 * 1024};
+
+std::size_t constexpr negativeTargetSize{16384};
+std::chrono::seconds constexpr negativeTargetAge{60};
+
+}  // namespace
+
+KeyFilter::KeyFilter(std::uint64_t capacity)
+    : KeyFilter(capacity, detail::bloomBlocksFor(capacity))
+{
+}
+
+KeyFilter::KeyFilter(std::uint64_t capacity, std::uint64_t blocks)
+    : capacity_(capacity)
+    , blocks_(blocks)
+    , words_(new std::atomic<std::uint64_t>[blocks * blockWords])
+{
+    for (std::uint64_t i = 0; i < blocks_ * blockWords; ++i)
+        words_[i].store(0, std::memory_order_relaxed);
+}
+
+void
+KeyFilter::add(uint256 const& key)
+{
+    auto const block = &words_[detail::bloomBlockOf(key, blocks_) * blockWords];
+    for (std::size_t i = 0; i < detail::bloomBitsPerBlockKey; ++i)
+    {
+        auto const bit = detail::bloomBitOf(key, i);
+        auto const mask = std::uint64_t(1) << (bit % 64);
+
+        // Keys stored again leave the block's cache line shared
+        auto& word = block[bit / 64];
+        if (!(word.load(std::memory_order_relaxed) & mask))
+            word.fetch_or(mask, std::memory_order_relaxed);
+    }
+    keys_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool
+KeyFilter::mayContain(uint256 const& key) const
+{
+    auto const block = &words_[detail::bloomBlockOf(key, blocks_) * blockWords];
+    for (std::size_t i = 0; i < detail::bloomBitsPerBlockKey; ++i)
+    {
+        auto const bit = detail::bloomBitOf(key, i);
+        auto const mask = std::uint64_t(1) << (bit % 64);
+        if (!(block[bit / 64].load(std::memory_order_relaxed) & mask))
+            return false;
+    }
+    return true;
+}
+
+std::uint64_t
+KeyFilter::bytes() const
+{
+    return blocks_ * blockWords * 8;
+}
+
+void
+KeyFilter::save(boost::filesystem::path const& path) const
+{
+    std::array<std::uint8_t, keyFilterHeaderBytes> header;
+    std::copy(keyFilterMagic.begin(), keyFilterMagic.end(), header.begin());
+    detail::putBE(header.data() + 8, keyFilterVersion, 4);
+    detail::putBE(header.data() + 12, blocks_, 8);
+    detail::putBE(header.data() + 20, capacity_, 8);
+    detail::putBE(header.data() + 28, keys(), 8);
+
+    auto const tmpPath{path.string() + ".tmp"};
+    nudb::error_code ec;
+    nudb::native_file::erase(tmpPath, ec);
+    {
+        nudb::native_file file;
+        file.create(nudb::file_mode::append, tmpPath, ec);
+        if (!ec)
+            file.write(0, header.data(), header.size(), ec);
+
+        auto const words{blocks_ * blockWords};
+        std::vector<std::uint8_t> chunk(chunkWords * 8);
+        for (std::uint64_t i = 0; !ec && i < words; i += chunkWords)
+        {
+            auto const n{std::min<std::uint64_t>(chunkWords, words - i)};
+            for (std::uint64_t w = 0; w < n; ++w)
+            {
+                detail::putBE(
+                    chunk.data() + 8 * w,
+                    words_[i + w].load(std::memory_order_relaxed),
+                    8);
+            }
+            file.write(keyFilterHeaderBytes + 8 * i, chunk.data(), 8 * n, ec);
+        }
+
+        if (!ec)
+            file.sync(ec);
+        if (ec)
+        {
+            file.close();
+            nudb::error_code ignored;
+            nudb::native_file::erase(tmpPath, ignored);
+            Throw<nudb::system_error>(ec);
+        }
+    }
+    boost::filesystem::rename(tmpPath, path);
+}
+
+std::unique_ptr<KeyFilter>
+KeyFilter::load(boost::filesystem::path const& path, beast::Journal j)
+{
+    if (!boost::filesystem::exists(path))
+        return nullptr;
+
+    nudb::native_file file;
+    nudb::error_code ec;
+    file.open(nudb::file_mode::read, path.string(), ec);
+    std::array<std::uint8_t, keyFilterHeaderBytes> header;
+    if (!ec)
+        file.read(0, header.data(), header.size(), ec);
+    auto const size{ec ? 0 : file.size(ec)};
+    if (ec)
+    {
+        JLOG(j.warn()) << "unable to read " << path.string() << ": "
+                       << ec.message();
+        return nullptr;
+    }
+
+    auto const blocks{detail::getBE(header.data() + 12, 8)};
+    auto const capacity{detail::getBE(header.data() + 20, 8)};
+    if (!std::equal(
+            keyFilterMagic.begin(), keyFilterMagic.end(), header.begin()) ||
+        detail::getBE(header.data() + 8, 4) != keyFilterVersion ||
+        blocks != detail::bloomBlocksFor(capacity) ||
+        size != keyFilterHeaderBytes + blocks * blockWords * 8)
+    {
+        JLOG(j.warn()) << "invalid key filter " << path.string();
+        return nullptr;
+    }
+
+    std::unique_ptr<KeyFilter> filter(new KeyFilter(capacity, blocks));
+    auto const words{blocks * blockWords};
+    std::vector<std::uint8_t> chunk(chunkWords * 8);
+    for (std::uint64_t i = 0; i < words; i += chunkWords)
+    {
+        auto const n{std::min<std::uint64_t>(chunkWords, words - i)};
+        file.read(keyFilterHeaderBytes + 8 * i, chunk.data(), 8 * n, ec);
+        if (ec)
+        {
+            JLOG(j.warn()) << "unable to read " << path.string() << ": "
+                           << ec.message();
+            return nullptr;
+        }
+        for (std::uint64_t w = 0; w < n; ++w)
+        {
+            filter->words_[i + w].store(
+                detail::getBE(chunk.data() + 8 * w, 8),
+                std::memory_order_relaxed);
+        }
+    }
+    filter->keys_.store(detail::getBE(header.data() + 28, 8));
+    return filter;
+}
+
+//------------------------------------------------------------------------------
+
+FilteredBackend::FilteredBackend(
+    std::unique_ptr<Backend> backend,
+    Section const& parameters,
+    beast::Journal j)
+    : backend_(std::move(backend))
+    , j_(j)
+    , capacity_(get<std::uint64_t>(parameters, "key_filter_size", 0))
+    , negative_(
+          "negative keys",
+          stopwatch(),
+          negativeTargetSize,
+          negativeTargetAge)
+{
+    assert(backend_);
+
+    // A backend without files has nothing to find on a restart
+    if (backend_->backed())
+    {
+        auto const path{get<std::string>(parameters, "path")};
+        if (!path.empty())
+            filterPath_ = boost::filesystem::path(path) / KeyFilterFileName;
+    }
+}
+
+FilteredBackend::~FilteredBackend()
+{
+    if (filter_)
+        close();
+}
+
+void
+FilteredBackend::open(bool createIfMissing)
+{
+    backend_->open(createIfMissing);
+
+    if (!filterPath_.empty())
+    {
+        filter_ = KeyFilter::load(filterPath_, j_);
+
+        // Keys stored before an unclean shutdown would be missing from it
+        boost::system::error_code ec;
+        boost::filesystem::remove(filterPath_, ec);
+    }
+
+    if (!filter_)
+        rebuild(capacity_ ? capacity_ : defaultKeyFilterCapacity);
+    else if (filter_->keys() > filter_->capacity())
+        rebuild(std::max(capacity_, 2 * filter_->keys()));
+}
+
+void
+FilteredBackend::close()
+{
+    if (filter_ && !filterPath_.empty() && !deletePath_)
+    {
+        try
+        {
+            filter_->save(filterPath_);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.warn()) << "unable to save " << filterPath_.string()
+                            << ": " << e.what();
+        }
+    }
+    filter_.reset();
+    backend_->close();
+}
+
+Status
+FilteredBackend::fetch(void const* key, std::shared_ptr<NodeObject>* pObject)
+{
+    auto const hash{uint256::fromVoid(key)};
+    if (absent(hash))
+    {
+        pObject->reset();
+        return notFound;
+    }
+
+    auto const before{snapshot(hash)};
+    auto const status{backend_->fetch(key, pObject)};
+    if (status == notFound)
+        remember(hash, before);
+    return status;
+}
+
+Status
+FilteredBackend::fetchPayload(
+    void const* key,
+    std::function<void(Slice)> const& visit)
+{
+    auto const hash{uint256::fromVoid(key)};
+    if (absent(hash))
+        return notFound;
+
+    auto const before{snapshot(hash)};
+    auto const status{backend_->fetchPayload(key, visit)};
+    if (status == notFound)
+        remember(hash, before);
+    return status;
+}
+
+std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+FilteredBackend::fetchBatch(std::vector<uint256 const*> const& hashes)
+{
+    std::vector<std::shared_ptr<NodeObject>> results(hashes.size());
+
+    // The keys which may be stored, and where their objects go
+    std::vector<uint256 const*> reads;
+    std::vector<std::size_t> indexes;
+    std::vector<Snapshot> befores;
+    reads.reserve(hashes.size());
+    indexes.reserve(hashes.size());
+    befores.reserve(hashes.size());
+    for (std::size_t i = 0; i < hashes.size(); ++i)
+    {
+        if (absent(*hashes[i]))
+            continue;
+        reads.push_back(hashes[i]);
+        indexes.push_back(i);
+        befores.push_back(snapshot(*hashes[i]));
+    }
+    if (reads.empty())
+        return {std::move(results), ok};
+
+    auto [objects, status] = backend_->fetchBatch(reads);
+    for (std::size_t i = 0; i < reads.size() && i < objects.size(); ++i)
+    {
+        if (objects[i])
+            results[indexes[i]] = std::move(objects[i]);
+        else if (status == ok)
+            remember(*reads[i], befores[i]);
+    }
+    return {std::move(results), status};
+}
+
+void
+FilteredBackend::store(std::shared_ptr<NodeObject> const& object)
+{
+    // The filter must hold a key before the backend does
+    filter_->add(object->getHash());
+    backend_->store(object);
+    stored(object->getHash());
+}
+
+void
+FilteredBackend::storeMany(Batch const& batch)
+{
+    for (auto const& object : batch)
+        filter_->add(object->getHash());
+    backend_->storeMany(batch);
+    for (auto const& object : batch)
+        stored(object->getHash());
+}
+
+void
+FilteredBackend::storeBatch(Batch const& batch)
+{
+    for (auto const& object : batch)
+        filter_->add(object->getHash());
+    backend_->storeBatch(batch);
+    for (auto const& object : batch)
+        stored(object->getHash());
+}
+
+void
+FilteredBackend::setDeletePath()
+{
+    deletePath_ = true;
+    backend_->setDeletePath();
+}
+
+void
+FilteredBackend::getCountsJson(Json::Value& obj) const
+{
+    backend_->getCountsJson(obj);
+
+    auto& stats = (obj["key_filter"] = Json::objectValue);
+    if (filter_)
+    {
+        stats["keys"] = std::to_string(filter_->keys());
+        stats["capacity"] = std::to_string(filter_->capacity());
+        stats["bytes"] = std::to_string(filter_->bytes());
+    }
+    stats["filtered"] = std::to_string(filtered_.load());
+    stats["negative_hits"] = std::to_string(negativeHits_.load());
+    stats["false_positives"] = std::to_string(falsePositives_.load());
+    stats["negative_cache_size"] = static_cast<Json::UInt>(negative_.size());
+}
+
+bool
+FilteredBackend::absent(uint256 const& key)
+{
+    if (!filter_->mayContain(key))
+    {
+        filtered_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (negative_.touch_if_exists(key))
+    {
+        negativeHits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+FilteredBackend::Snapshot
+FilteredBackend::snapshot(uint256 const& key)
+{
+    Snapshot before;
+    before.generation = stripeOf(key).generation.load();
+
+    // A backend which queues writes may not yet hold a key it was given,
+    // and holds every key it was given once nothing is queued
+    before.settled = backend_->getWriteLoad() == 0;
+    return before;
+}
+
+void
+FilteredBackend::remember(uint256 const& key, Snapshot const& before)
+{
+    falsePositives_.fetch_add(1, std::memory_order_relaxed);
+    if (!before.settled)
+        return;
+
+    {
+        auto& stripe = stripeOf(key);
+        std::lock_guard lock(stripe.mutex);
+
+        // The key may have been stored while it was being read
+        if (stripe.generation.load() != before.generation)
+            return;
+        negative_.insert(key);
+    }
+
+    if (sinceSweep_.fetch_add(1, std::memory_order_relaxed) + 1 >=
+        negativeTargetSize)
+    {
+        sinceSweep_.store(0, std::memory_order_relaxed);
+        negative_.sweep();
+    }
+}
+
+void
+FilteredBackend::stored(uint256 const& key)
+{
+    auto& stripe = stripeOf(key);
+    std::lock_guard lock(stripe.mutex);
+    ++stripe.generation;
+    negative_.erase(key);
+}
+
+void
+FilteredBackend::rebuild(std::uint64_t capacity)
+{
+    JLOG(j_.info()) << "Building the key filter of " << getName();
+    auto const start{std::chrono::steady_clock::now()};
+
+    auto filter{std::make_unique<KeyFilter>(capacity)};
+    backend_->for_each([&filter](std::shared_ptr<NodeObject> object) {
+        filter->add(object->getHash());
+    });
+
+    JLOG(j_.info()) << "Built the key filter of " << getName() << " with "
+                    << filter->keys() << " keys in "
+                    << std::chrono::duration_cast<std::chrono::seconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count()
+                    << "s";
+
+    // Sized too small, the filter would pass many more missing keys
+    if (filter->keys() > capacity)
+    {
+        JLOG(j_.warn()) << "The key filter of " << getName() << " holds "
+                        << filter->keys() << " keys, more than the "
+                        << capacity << " it was sized for. Consider raising "
+                        << "key_filter_size";
+        return rebuild(2 * filter->keys());
+    }
+    filter_ = std::move(filter);
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
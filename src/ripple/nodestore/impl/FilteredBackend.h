@@ -0,0 +1,279 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+#define RIPPLE_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/KeyCache.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/nodestore/Backend.h>
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+namespace NodeStore {
+
+/*  A key filter tells which keys a backend may hold, so that lookups of
+    keys it doesn't hold, such as peers asking for objects we never had,
+    are answered without reading the backend. It is a blocked Bloom filter
+    laid out like a shard filter: the bits of a key all fall in one block
+    of 64 bytes, set from the bytes of the key itself. Unlike a shard
+    filter it is held in memory and grows as keys are stored.
+
+    The file a filter is saved to consists of a header (magic, version,
+    block count, capacity and key count) followed by the blocks. Integers
+    are big endian.
+*/
+
+// Name of the file a backend's key filter is saved to, in its directory
+inline constexpr auto KeyFilterFileName{"keys.filter"};
+
+/** An approximate set of keys that keys may be added to concurrently. */
+class KeyFilter
+{
+public:
+    /** Size a filter.
+
+        @param capacity The number of keys the filter holds before tests
+                        of keys not added return true more often than
+                        about one in a thousand.
+    */
+    explicit KeyFilter(std::uint64_t capacity);
+
+    void
+    add(uint256 const& key);
+
+    /** Returns false if the key was not added. */
+    bool
+    mayContain(uint256 const& key) const;
+
+    std::uint64_t
+    capacity() const
+    {
+        return capacity_;
+    }
+
+    /** The number of keys added, counting each time a key was. */
+    std::uint64_t
+    keys() const
+    {
+        return keys_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    bytes() const;
+
+    /** Write the filter under a temporary name and move it into place.
+
+        @throws std::exception on failure.
+    */
+    void
+    save(boost::filesystem::path const& path) const;
+
+    /** Read a filter saved by @ref save.
+
+        @return The filter, or null if the file is missing or invalid.
+    */
+    static std::unique_ptr<KeyFilter>
+    load(boost::filesystem::path const& path, beast::Journal j);
+
+private:
+    KeyFilter(std::uint64_t capacity, std::uint64_t blocks);
+
+    std::uint64_t const capacity_;
+    std::uint64_t const blocks_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+    std::atomic<std::uint64_t> keys_{0};
+};
+
+/** A backend which answers lookups of keys it doesn't hold without
+    reading the backend it wraps.
+
+    A key filter of the stored keys is checked first. Keys which pass the
+    filter but are not found are remembered for a while in a negative
+    cache, which is cleared of a key whenever the key is stored.
+
+    The filter is saved when the backend is closed and loaded, then
+    removed, when it is opened. When there is no saved filter, as after
+    the first start or an unclean shutdown, it is rebuilt by visiting
+    every stored object.
+*/
+class FilteredBackend : public Backend
+{
+public:
+    FilteredBackend(
+        std::unique_ptr<Backend> backend,
+        Section const& parameters,
+        beast::Journal j);
+
+    ~FilteredBackend() override;
+
+    std::string
+    getName() override
+    {
+        return backend_->getName();
+    }
+
+    void
+    open(bool createIfMissing) override;
+
+    bool
+    isOpen() override
+    {
+        return backend_->isOpen();
+    }
+
+    void
+    close() override;
+
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override;
+
+    Status
+    fetchPayload(void const* key, std::function<void(Slice)> const& visit)
+        override;
+
+    bool
+    canFetchBatch() override
+    {
+        return backend_->canFetchBatch();
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+    fetchBatch(std::vector<uint256 const*> const& hashes) override;
+
+    void
+    store(std::shared_ptr<NodeObject> const& object) override;
+
+    void
+    storeMany(Batch const& batch) override;
+
+    void
+    storeBatch(Batch const& batch) override;
+
+    void
+    sync() override
+    {
+        backend_->sync();
+    }
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
+    {
+        backend_->for_each(f);
+    }
+
+    int
+    getWriteLoad() override
+    {
+        return backend_->getWriteLoad();
+    }
+
+    void
+    setDeletePath() override;
+
+    void
+    verify() override
+    {
+        backend_->verify();
+    }
+
+    int
+    fdRequired() const override
+    {
+        return backend_->fdRequired();
+    }
+
+    std::optional<Counters<std::uint64_t>>
+    counters() const override
+    {
+        return backend_->counters();
+    }
+
+    void
+    getCountsJson(Json::Value& obj) const override;
+
+private:
+    // Stores of keys in a stripe advance its generation, so that a miss
+    // which raced a store of the key is not remembered
+    struct Stripe
+    {
+        std::mutex mutex;
+        std::atomic<std::uint64_t> generation{0};
+    };
+
+    struct Snapshot
+    {
+        std::uint64_t generation;
+        bool settled;
+    };
+
+    std::unique_ptr<Backend> backend_;
+    beast::Journal const j_;
+    std::uint64_t const capacity_;
+    // Where the filter is saved, empty if it is not
+    boost::filesystem::path filterPath_;
+    bool deletePath_ = false;
+
+    std::unique_ptr<KeyFilter> filter_;
+    KeyCache<uint256> negative_;
+    std::array<Stripe, 64> stripes_;
+    std::atomic<std::uint64_t> filtered_{0};
+    std::atomic<std::uint64_t> negativeHits_{0};
+    std::atomic<std::uint64_t> falsePositives_{0};
+    std::atomic<std::uint64_t> sinceSweep_{0};
+
+    Stripe&
+    stripeOf(uint256 const& key)
+    {
+        return stripes_[key.data()[uint256::bytes - 1] % stripes_.size()];
+    }
+
+    // Returns true if the key is known not to be stored
+    bool
+    absent(uint256 const& key);
+
+    // Taken before reading the backend for a key
+    Snapshot
+    snapshot(uint256 const& key);
+
+    // Remember that a key read after the snapshot was not found
+    void
+    remember(uint256 const& key, Snapshot const& before);
+
+    // Called after a key is written
+    void
+    stored(uint256 const& key);
+
+    void
+    rebuild(std::uint64_t capacity);
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
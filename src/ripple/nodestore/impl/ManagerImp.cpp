@@ -18,6 +18,8 @@
 //==============================================================================
 
 #include <ripple/nodestore/impl/DatabaseNodeImp.h>
+#include <ripple/nodestore/impl/DatabaseTieredImp.h>
+#include <ripple/nodestore/impl/FilteredBackend.h>
 #include <ripple/nodestore/impl/ManagerImp.h>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -64,8 +66,17 @@ ManagerImp::make_Backend(
         missing_backend();
     }
 
-    return factory->createInstance(
-        NodeObject::keyBytes, parameters, burstSize, scheduler, journal);
+    auto backend{factory->createInstance(
+        NodeObject::keyBytes, parameters, burstSize, scheduler, journal)};
+    if (!get<bool>(parameters, "key_filter", false))
+        return backend;
+
+    // The filter only knows of keys this server stores
+    if (boost::iequals(type, "cassandra"))
+        Throw<std::runtime_error>(
+            "key_filter can not be used with a Cassandra node store");
+    return std::make_unique<FilteredBackend>(
+        std::move(backend), parameters, journal);
 }
 
 std::unique_ptr<Database>
@@ -78,6 +89,12 @@ ManagerImp::make_Database(
     Section const& config,
     beast::Journal journal)
 {
+    if (config.exists("cold_path"))
+    {
+        return std::make_unique<DatabaseTieredImp>(
+            name, burstSize, scheduler, readThreads, parent, config, journal);
+    }
+
     auto backend{make_Backend(config, burstSize, scheduler, journal)};
     backend->open();
     return std::make_unique<DatabaseNodeImp>(
@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/nodestore/impl/MappedFile.h>
+
+#if !BOOST_OS_WINDOWS
+
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ripple {
+namespace NodeStore {
+
+MappedFile::MappedFile(MappedFile&& other)
+    : file_(std::move(other.file_))
+    , data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+{
+}
+
+MappedFile&
+MappedFile::operator=(MappedFile&& other)
+{
+    if (this != &other)
+    {
+        unmap();
+        file_ = std::move(other.file_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+void
+MappedFile::close()
+{
+    unmap();
+    file_.close();
+}
+
+void
+MappedFile::create(
+    nudb::file_mode mode,
+    nudb::path_type const& path,
+    nudb::error_code& ec)
+{
+    // A new file is empty, so there is nothing to map
+    file_.create(mode, path, ec);
+}
+
+void
+MappedFile::open(
+    nudb::file_mode mode,
+    nudb::path_type const& path,
+    nudb::error_code& ec)
+{
+    file_.open(mode, path, ec);
+    if (!ec)
+        map(path);
+}
+
+void
+MappedFile::read(
+    std::uint64_t offset,
+    void* buffer,
+    std::size_t bytes,
+    nudb::error_code& ec)
+{
+    if (data_ && offset <= size_ && bytes <= size_ - offset)
+    {
+        std::memcpy(buffer, static_cast<char const*>(data_) + offset, bytes);
+        ec = {};
+        return;
+    }
+    file_.read(offset, buffer, bytes, ec);
+}
+
+void
+MappedFile::trunc(std::uint64_t length, nudb::error_code& ec)
+{
+    // Touching mapped pages past the end of a file raises SIGBUS
+    if (length < size_)
+        unmap();
+    file_.trunc(length, ec);
+}
+
+void
+MappedFile::map(nudb::path_type const& path)
+{
+    unmap();
+
+    // Failing to map is not an error, reads use the native file instead
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+
+    nudb::error_code ec;
+    auto const size = file_.size(ec);
+    if (!ec && size > 0)
+    {
+        void* const data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            // Lookups are scattered, so reading ahead only evicts pages
+            ::madvise(data, size, MADV_RANDOM);
+            data_ = data;
+            size_ = size;
+        }
+    }
+    ::close(fd);
+}
+
+void
+MappedFile::unmap()
+{
+    if (data_)
+    {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_MAPPEDFILE_H_INCLUDED
+#define RIPPLE_NODESTORE_MAPPEDFILE_H_INCLUDED
+
+#include <boost/predef/os.h>
+#include <nudb/nudb.hpp>
+#include <cstdint>
+
+namespace ripple {
+namespace NodeStore {
+
+#if BOOST_OS_WINDOWS
+
+using MappedFile = nudb::native_file;
+
+#else
+
+/** A NuDB file whose reads are served from a memory mapping.
+
+    Satisfies NuDB's File requirements. An existing file is mapped read
+    only when opened, and reads that fall inside the mapping are copied
+    out of the page cache without a system call. Writes, and reads past
+    the end of the mapping, go through the native file, which shares the
+    page cache with the mapping.
+
+    Intended for databases that are no longer written to. The operating
+    system decides which pages stay resident.
+*/
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile&
+    operator=(MappedFile const&) = delete;
+    MappedFile(MappedFile&& other);
+    MappedFile&
+    operator=(MappedFile&& other);
+    ~MappedFile();
+
+    bool
+    is_open() const
+    {
+        return file_.is_open();
+    }
+
+    void
+    close();
+
+    void
+    create(
+        nudb::file_mode mode,
+        nudb::path_type const& path,
+        nudb::error_code& ec);
+
+    void
+    open(
+        nudb::file_mode mode,
+        nudb::path_type const& path,
+        nudb::error_code& ec);
+
+    static void
+    erase(nudb::path_type const& path, nudb::error_code& ec)
+    {
+        nudb::native_file::erase(path, ec);
+    }
+
+    std::uint64_t
+    size(nudb::error_code& ec) const
+    {
+        return file_.size(ec);
+    }
+
+    void
+    read(
+        std::uint64_t offset,
+        void* buffer,
+        std::size_t bytes,
+        nudb::error_code& ec);
+
+    void
+    write(
+        std::uint64_t offset,
+        void const* buffer,
+        std::size_t bytes,
+        nudb::error_code& ec)
+    {
+        file_.write(offset, buffer, bytes, ec);
+    }
+
+    void
+    sync(nudb::error_code& ec)
+    {
+        file_.sync(ec);
+    }
+
+    void
+    trunc(std::uint64_t length, nudb::error_code& ec);
+
+private:
+    void
+    map(nudb::path_type const& path);
+
+    void
+    unmap();
+
+    nudb::native_file file_;
+    void* data_ = nullptr;
+    std::uint64_t size_ = 0;
+};
+
+#endif
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -17,11 +17,313 @@
 */
 //==============================================================================
 
+#include <ripple/basics/MemoryArena.h>
 #include <ripple/nodestore/NodeObject.h>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
 
 namespace ripple {
 
+namespace {
+
+// Allocations are rounded up to a multiple of the granularity, and blocks
+// of every size class up to the limit are recycled through free lists.
+// Larger allocations, which are rare, go straight to the heap.
+//
+// Each thread keeps its own free lists, which it uses without locking,
+// and moves blocks to and from the shared lists a batch at a time. What a
+// thread still holds when it exits is handed back to the shared lists.
+class NodeObjectPool
+{
+    static constexpr std::size_t granularity = 32;
+    static constexpr std::size_t classes = 64;
+
+    // Blocks moved between a thread's list and the shared list at once
+    static constexpr std::size_t batch = 32;
+
+    // Upper bound on the memory held in all free lists
+    static constexpr std::uint64_t maxCachedBytes = 64 * 1024 * 1024;
+
+    struct SizeClass
+    {
+        std::mutex mutex;
+        std::vector<void*> free;
+    };
+
+    struct LocalCache
+    {
+        std::array<std::vector<void*>, classes> free;
+
+        LocalCache() = default;
+        LocalCache(LocalCache const&) = delete;
+        LocalCache&
+        operator=(LocalCache const&) = delete;
+
+        ~LocalCache();
+    };
+
+    std::array<SizeClass, classes> classes_;
+    std::atomic<std::uint64_t> allocated_{0};
+    std::atomic<std::uint64_t> cached_{0};
+    std::atomic<std::uint64_t> reused_{0};
+
+public:
+    std::atomic<std::uint64_t> legacy{0};
+
+    NodeObjectPool() = default;
+    NodeObjectPool(NodeObjectPool const&) = delete;
+    NodeObjectPool&
+    operator=(NodeObjectPool const&) = delete;
+
+    static std::size_t
+    roundUp(std::size_t bytes)
+    {
+        return (bytes + granularity - 1) / granularity * granularity;
+    }
+
+    void*
+    allocate(std::size_t bytes)
+    {
+        bytes = roundUp(bytes);
+        allocated_ += bytes;
+
+        auto const index = bytes / granularity - 1;
+        if (index < classes)
+        {
+            if (auto const cache = localCache())
+            {
+                auto& free = cache->free[index];
+                if (free.empty())
+                    refill(index, free);
+                if (!free.empty())
+                {
+                    auto p = free.back();
+                    free.pop_back();
+                    cached_ -= bytes;
+                    ++reused_;
+                    return p;
+                }
+            }
+            else
+            {
+                auto& c = classes_[index];
+                std::lock_guard lock(c.mutex);
+                if (!c.free.empty())
+                {
+                    auto p = c.free.back();
+                    c.free.pop_back();
+                    cached_ -= bytes;
+                    ++reused_;
+                    return p;
+                }
+            }
+        }
+
+        return arenaAllocate(MemoryArena::nodeObject, bytes);
+    }
+
+    void
+    deallocate(void* p, std::size_t bytes) noexcept
+    {
+        bytes = roundUp(bytes);
+        allocated_ -= bytes;
+
+        auto const index = bytes / granularity - 1;
+        if (index < classes && cached_ + bytes <= maxCachedBytes)
+        {
+            if (auto const cache = localCache())
+            {
+                auto& free = cache->free[index];
+                if (free.capacity() == 0)
+                    reserve(free);
+                if (free.size() == 2 * batch)
+                    release(index, free, batch);
+                if (free.size() < free.capacity())
+                {
+                    free.push_back(p);
+                    cached_ += bytes;
+                    return;
+                }
+            }
+            else
+            {
+                auto& c = classes_[index];
+                std::lock_guard lock(c.mutex);
+                try
+                {
+                    c.free.push_back(p);
+                    cached_ += bytes;
+                    return;
+                }
+                catch (std::bad_alloc const&)
+                {
+                }
+            }
+        }
+
+        arenaDeallocate(MemoryArena::nodeObject, p, bytes);
+    }
+
+    NodeObject::PoolStats
+    stats() const
+    {
+        NodeObject::PoolStats s;
+        s.allocatedBytes = allocated_;
+        s.cachedBytes = cached_;
+        s.legacyBytes = legacy;
+        s.reused = reused_;
+        return s;
+    }
+
+private:
+    // Set on each thread once its cache has been destroyed, so that
+    // objects released later on that thread use the shared lists
+    static inline thread_local bool cacheDestroyed_ = false;
+
+    static LocalCache*
+    localCache()
+    {
+        if (cacheDestroyed_)
+            return nullptr;
+        thread_local LocalCache cache;
+        return &cache;
+    }
+
+    static void
+    reserve(std::vector<void*>& free) noexcept
+    {
+        try
+        {
+            free.reserve(2 * batch);
+        }
+        catch (std::bad_alloc const&)
+        {
+        }
+    }
+
+    // Moves up to a batch of blocks from the shared list into `free`
+    void
+    refill(std::size_t index, std::vector<void*>& free)
+    {
+        if (free.capacity() == 0)
+            reserve(free);
+        if (free.capacity() == 0)
+            return;
+
+        auto& c = classes_[index];
+        std::lock_guard lock(c.mutex);
+        auto const n = std::min(batch, c.free.size());
+        free.insert(free.end(), c.free.end() - n, c.free.end());
+        c.free.resize(c.free.size() - n);
+    }
+
+    // Moves the last `n` blocks of `free` to the shared list, or back to
+    // the heap if the shared list cannot grow
+    void
+    release(std::size_t index, std::vector<void*>& free, std::size_t n) noexcept
+    {
+        auto& c = classes_[index];
+        {
+            std::lock_guard lock(c.mutex);
+            try
+            {
+                c.free.insert(c.free.end(), free.end() - n, free.end());
+                free.resize(free.size() - n);
+                return;
+            }
+            catch (std::bad_alloc const&)
+            {
+            }
+        }
+
+        auto const bytes = (index + 1) * granularity;
+        for (; n != 0; --n)
+        {
+            arenaDeallocate(MemoryArena::nodeObject, free.back(), bytes);
+            free.pop_back();
+            cached_ -= bytes;
+        }
+    }
+};
+
+// The pool is never destroyed, since objects held in static caches may
+// be released during program termination.
+NodeObjectPool&
+pool()
+{
+    static NodeObjectPool* const p = new NodeObjectPool;
+    return *p;
+}
+
+NodeObjectPool::LocalCache::~LocalCache()
+{
+    cacheDestroyed_ = true;
+    for (std::size_t i = 0; i < classes; ++i)
+    {
+        if (!free[i].empty())
+            pool().release(i, free[i], free[i].size());
+    }
+}
+
+// Draws the block holding the shared_ptr control block and the object
+// from the pool
+template <class T>
+struct NodeObjectAllocator
+{
+    using value_type = T;
+
+    NodeObjectAllocator() = default;
+
+    template <class U>
+    NodeObjectAllocator(NodeObjectAllocator<U> const&)
+    {
+    }
+
+    T*
+    allocate(std::size_t n)
+    {
+        return static_cast<T*>(pool().allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T* p, std::size_t n) noexcept
+    {
+        pool().deallocate(p, n * sizeof(T));
+    }
+
+    template <class U>
+    bool
+    operator==(NodeObjectAllocator<U> const&) const
+    {
+        return true;
+    }
+
+    template <class U>
+    bool
+    operator!=(NodeObjectAllocator<U> const&) const
+    {
+        return false;
+    }
+};
+
+// Estimated heap usage of an object with the previous layout: one block
+// for the control block, type, hash and vector, a separate block for the
+// payload, and the header of that second heap allocation.
+constexpr std::size_t
+legacySize(std::size_t payload)
+{
+    constexpr auto roundUp = [](std::size_t n) { return (n + 15) / 16 * 16; };
+    return roundUp(2 * sizeof(void*) + 8 + sizeof(uint256) + sizeof(Blob)) +
+        roundUp(payload) + 16;
+}
+
+}  // namespace
+
 //------------------------------------------------------------------------------
 
 NodeObject::NodeObject(
@@ -29,15 +331,72 @@ NodeObject::NodeObject(
     Blob&& data,
     uint256 const& hash,
     PrivateAccess)
-    : mType(type), mHash(hash), mData(std::move(data))
+    : mType(type)
+    , mSize(static_cast<std::uint32_t>(data.size()))
+    , mHash(hash)
+    , mBlob(std::move(data))
+    , mData(mBlob.data())
 {
+    pool().legacy += legacySize(mSize);
+}
+
+NodeObject::NodeObject(
+    NodeObjectType type,
+    Slice data,
+    std::uint8_t* block,
+    uint256 const& hash,
+    PrivateAccess)
+    : mType(type)
+    , mSize(static_cast<std::uint32_t>(data.size()))
+    , mHash(hash)
+    , mData(block)
+{
+    if (!data.empty())
+        std::memcpy(block, data.data(), data.size());
+    pool().legacy += legacySize(mSize);
+}
+
+NodeObject::~NodeObject()
+{
+    // A payload that was copied in lives in a block from the pool
+    if (mBlob.empty() && mSize != 0)
+        pool().deallocate(const_cast<std::uint8_t*>(mData), mSize);
+    pool().legacy -= legacySize(mSize);
 }
 
 std::shared_ptr<NodeObject>
 NodeObject::createObject(NodeObjectType type, Blob&& data, uint256 const& hash)
 {
-    return std::make_shared<NodeObject>(
-        type, std::move(data), hash, PrivateAccess());
+    return std::allocate_shared<NodeObject>(
+        NodeObjectAllocator<NodeObject>(),
+        type,
+        std::move(data),
+        hash,
+        PrivateAccess());
+}
+
+std::shared_ptr<NodeObject>
+NodeObject::createObject(NodeObjectType type, Slice data, uint256 const& hash)
+{
+    std::uint8_t* const block = data.empty()
+        ? nullptr
+        : static_cast<std::uint8_t*>(pool().allocate(data.size()));
+    try
+    {
+        return std::allocate_shared<NodeObject>(
+            NodeObjectAllocator<NodeObject>(),
+            type,
+            data,
+            block,
+            hash,
+            PrivateAccess());
+    }
+    catch (...)
+    {
+        if (block)
+            pool().deallocate(block, data.size());
+        throw;
+    }
 }
 
 NodeObjectType
@@ -52,10 +411,16 @@ NodeObject::getHash() const
     return mHash;
 }
 
-Blob const&
+Slice
 NodeObject::getData() const
 {
-    return mData;
+    return {mData, mSize};
+}
+
+NodeObject::PoolStats
+NodeObject::getPoolStats()
+{
+    return pool().stats();
 }
 
 }  // namespace ripple
@@ -0,0 +1,485 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/InboundLedger.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/PackedShard.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <ripple/protocol/Serializer.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+constexpr char magic[8]{'S', 'H', 'R', 'D', 'P', 'A', 'C', 'K'};
+constexpr std::uint32_t packVersion{1};
+
+// Index entries per fence
+constexpr std::uint32_t fenceInterval{128};
+
+// magic, version, firstSeq, lastSeq, fenceInterval,
+// objectCount, ledgersOffset, indexOffset, fencesOffset
+constexpr std::size_t headerSize{8 + 4 * 4 + 8 * 4};
+
+// key, offset, size
+constexpr std::size_t entrySize{32 + 8 + 4};
+
+// Buffered data before it is written to the file
+constexpr std::size_t writeBufferSize{1024 * 1024};
+
+void
+put32(std::uint8_t* p, std::uint32_t v)
+{
+    for (int i = 3; i >= 0; --i, v >>= 8)
+        p[i] = static_cast<std::uint8_t>(v);
+}
+
+void
+put64(std::uint8_t* p, std::uint64_t v)
+{
+    for (int i = 7; i >= 0; --i, v >>= 8)
+        p[i] = static_cast<std::uint8_t>(v);
+}
+
+std::uint32_t
+get32(std::uint8_t const* p)
+{
+    std::uint32_t v{0};
+    for (int i = 0; i < 4; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t
+get64(std::uint8_t const* p)
+{
+    std::uint64_t v{0};
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+}  // namespace
+
+PackedShardWriter::PackedShardWriter(
+    boost::filesystem::path const& path,
+    std::uint32_t firstSeq,
+    std::uint32_t lastSeq)
+    : path_(path)
+    , tmpPath_(path.string() + ".tmp")
+    , firstSeq_(firstSeq)
+    , lastSeq_(lastSeq)
+{
+    // Discard what an interrupted write left behind
+    boost::filesystem::remove(tmpPath_);
+
+    nudb::error_code ec;
+    file_.create(nudb::file_mode::append, tmpPath_.string(), ec);
+    if (ec)
+        Throw<nudb::system_error>(ec);
+
+    buffer_.reserve(writeBufferSize);
+
+    // The header is written last, once the offsets are known
+    std::uint8_t const header[headerSize]{};
+    append(header, headerSize);
+}
+
+PackedShardWriter::~PackedShardWriter()
+{
+    if (committed_)
+        return;
+
+    file_.close();
+    boost::system::error_code ec;
+    boost::filesystem::remove(tmpPath_, ec);
+}
+
+void
+PackedShardWriter::add(std::shared_ptr<NodeObject> const& nodeObject)
+{
+    EncodedBlob e;
+    e.prepare(nodeObject);
+    nudb::detail::buffer bf;
+    auto const result{nodeobject_compress(e.getData(), e.getSize(), bf)};
+
+    entries_.push_back(
+        {nodeObject->getHash(),
+         offset_,
+         static_cast<std::uint32_t>(result.second)});
+    append(result.first, result.second);
+}
+
+void
+PackedShardWriter::addLedger(LedgerInfo const& info)
+{
+    Serializer s(sizeof(LedgerInfo));
+    addRaw(info, s, true);
+
+    std::uint8_t size[4];
+    put32(size, s.getDataLength());
+    ledgers_.insert(ledgers_.end(), size, size + 4);
+    ledgers_.insert(ledgers_.end(), s.begin(), s.end());
+    ++ledgerCount_;
+}
+
+std::uint64_t
+PackedShardWriter::commit()
+{
+    std::uint8_t buf[entrySize];
+
+    // Ledger headers
+    auto const ledgersOffset{offset_};
+    put32(buf, ledgerCount_);
+    append(buf, 4);
+    append(ledgers_.data(), ledgers_.size());
+    ledgers_ = {};
+
+    // Index, keeping the first copy of an object added more than once
+    std::stable_sort(
+        entries_.begin(), entries_.end(), [](auto const& lhs, auto const& rhs) {
+            return lhs.key < rhs.key;
+        });
+    entries_.erase(
+        std::unique(
+            entries_.begin(),
+            entries_.end(),
+            [](auto const& lhs, auto const& rhs) {
+                return lhs.key == rhs.key;
+            }),
+        entries_.end());
+
+    auto const indexOffset{offset_};
+    for (auto const& entry : entries_)
+    {
+        std::memcpy(buf, entry.key.data(), 32);
+        put64(buf + 32, entry.offset);
+        put32(buf + 40, entry.size);
+        append(buf, entrySize);
+    }
+
+    // Fences
+    auto const fencesOffset{offset_};
+    for (std::size_t i = 0; i < entries_.size(); i += fenceInterval)
+        append(entries_[i].key.data(), 32);
+
+    flush();
+
+    std::uint8_t header[headerSize];
+    std::memcpy(header, magic, sizeof(magic));
+    put32(header + 8, packVersion);
+    put32(header + 12, firstSeq_);
+    put32(header + 16, lastSeq_);
+    put32(header + 20, fenceInterval);
+    put64(header + 24, entries_.size());
+    put64(header + 32, ledgersOffset);
+    put64(header + 40, indexOffset);
+    put64(header + 48, fencesOffset);
+
+    nudb::error_code ec;
+    file_.write(0, header, headerSize, ec);
+    if (!ec)
+        file_.sync(ec);
+    if (ec)
+        Throw<nudb::system_error>(ec);
+    file_.close();
+
+    boost::filesystem::rename(tmpPath_, path_);
+    committed_ = true;
+    return offset_;
+}
+
+void
+PackedShardWriter::append(void const* data, std::size_t size)
+{
+    auto const p{static_cast<std::uint8_t const*>(data)};
+    buffer_.insert(buffer_.end(), p, p + size);
+    offset_ += size;
+    if (buffer_.size() >= writeBufferSize)
+        flush();
+}
+
+void
+PackedShardWriter::flush()
+{
+    if (buffer_.empty())
+        return;
+
+    nudb::error_code ec;
+    file_.write(offset_ - buffer_.size(), buffer_.data(), buffer_.size(), ec);
+    if (ec)
+        Throw<nudb::system_error>(ec);
+    buffer_.clear();
+}
+
+//------------------------------------------------------------------------------
+
+PackedBackend::PackedBackend(
+    boost::filesystem::path const& path,
+    beast::Journal j)
+    : path_(path), j_(j)
+{
+}
+
+PackedBackend::~PackedBackend()
+{
+    try
+    {
+        close();
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.error()) << "exception: " << e.what()
+                         << " in function: " << __func__;
+    }
+}
+
+void
+PackedBackend::open(bool)
+{
+    if (file_.is_open())
+    {
+        assert(false);
+        JLOG(j_.error()) << "database is already open";
+        return;
+    }
+
+    nudb::error_code ec;
+    file_.open(nudb::file_mode::read, path_.string(), ec);
+    if (ec)
+        Throw<nudb::system_error>(ec);
+
+    try
+    {
+        std::uint8_t header[headerSize];
+        read(0, header, headerSize);
+        if (std::memcmp(header, magic, sizeof(magic)) != 0 ||
+            get32(header + 8) != packVersion ||
+            get32(header + 20) != fenceInterval)
+        {
+            Throw<std::runtime_error>("invalid packed shard header");
+        }
+
+        objectCount_ = get64(header + 24);
+        ledgersOffset_ = get64(header + 32);
+        indexOffset_ = get64(header + 40);
+        auto const fencesOffset{get64(header + 48)};
+        auto const fenceCount{
+            (objectCount_ + fenceInterval - 1) / fenceInterval};
+
+        if (ledgersOffset_ < headerSize || indexOffset_ < ledgersOffset_ ||
+            fencesOffset != indexOffset_ + objectCount_ * entrySize ||
+            fencesOffset + fenceCount * 32 != file_.size(ec) || ec)
+        {
+            Throw<std::runtime_error>("invalid packed shard layout");
+        }
+
+        std::vector<std::uint8_t> fences(fenceCount * 32);
+        read(fencesOffset, fences.data(), fences.size());
+        fences_.resize(fenceCount);
+        for (std::size_t i = 0; i < fenceCount; ++i)
+            std::memcpy(fences_[i].data(), fences.data() + i * 32, 32);
+    }
+    catch (std::exception const&)
+    {
+        file_.close();
+        fences_.clear();
+        throw;
+    }
+}
+
+void
+PackedBackend::close()
+{
+    if (!file_.is_open())
+        return;
+
+    file_.close();
+    fences_.clear();
+    if (deletePath_)
+        boost::filesystem::remove(path_);
+}
+
+Status
+PackedBackend::fetch(void const* key, std::shared_ptr<NodeObject>* pObject)
+{
+    pObject->reset();
+
+    auto const hash{uint256::fromVoid(key)};
+    auto const it{std::upper_bound(fences_.begin(), fences_.end(), hash)};
+    if (it == fences_.begin())
+        return notFound;
+
+    // Read the block of index entries covered by the fence
+    std::uint64_t const block{
+        static_cast<std::uint64_t>(std::distance(fences_.begin(), it) - 1)};
+    std::uint64_t const first{block * fenceInterval};
+    auto const count{std::min<std::uint64_t>(
+        fenceInterval, objectCount_ - first)};
+    std::vector<std::uint8_t> entries(count * entrySize);
+    read(indexOffset_ + first * entrySize, entries.data(), entries.size());
+
+    std::size_t lo{0};
+    std::size_t hi{count};
+    while (lo < hi)
+    {
+        auto const mid{lo + (hi - lo) / 2};
+        auto const entry{entries.data() + mid * entrySize};
+        auto const cmp{std::memcmp(entry, hash.data(), 32)};
+        if (cmp == 0)
+        {
+            return fetchEntry(
+                key, get64(entry + 32), get32(entry + 40), pObject);
+        }
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return notFound;
+}
+
+std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+PackedBackend::fetchBatch(std::vector<uint256 const*> const& hashes)
+{
+    std::vector<std::shared_ptr<NodeObject>> results;
+    results.reserve(hashes.size());
+    for (auto const& h : hashes)
+    {
+        std::shared_ptr<NodeObject> nObj;
+        Status status = fetch(h->begin(), &nObj);
+        if (status != ok)
+            results.push_back({});
+        else
+            results.push_back(nObj);
+    }
+
+    return {results, ok};
+}
+
+void
+PackedBackend::store(std::shared_ptr<NodeObject> const& nodeObject)
+{
+    // Storing is idempotent, so an object the file holds is accepted
+    std::shared_ptr<NodeObject> stored;
+    if (fetch(nodeObject->getHash().cbegin(), &stored) != ok)
+        Throw<std::logic_error>("packed shard is read only");
+}
+
+void
+PackedBackend::storeBatch(Batch const& batch)
+{
+    for (auto const& nodeObject : batch)
+        store(nodeObject);
+}
+
+void
+PackedBackend::for_each(std::function<void(std::shared_ptr<NodeObject>)> f)
+{
+    std::vector<std::uint8_t> block(fenceInterval * entrySize);
+    for (std::uint64_t first = 0; first < objectCount_; first += fenceInterval)
+    {
+        auto const count{std::min<std::uint64_t>(
+            fenceInterval, objectCount_ - first)};
+        read(indexOffset_ + first * entrySize, block.data(), count * entrySize);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const entry{block.data() + i * entrySize};
+            std::shared_ptr<NodeObject> nodeObject;
+            if (fetchEntry(
+                    entry, get64(entry + 32), get32(entry + 40), &nodeObject) !=
+                ok)
+            {
+                Throw<std::runtime_error>("packed shard corrupt object");
+            }
+            f(std::move(nodeObject));
+        }
+    }
+}
+
+std::vector<LedgerInfo>
+PackedBackend::ledgers()
+{
+    std::vector<std::uint8_t> section(indexOffset_ - ledgersOffset_);
+    read(ledgersOffset_, section.data(), section.size());
+
+    auto const end{section.data() + section.size()};
+    auto p{section.data()};
+    auto const remaining = [&]() { return static_cast<std::size_t>(end - p); };
+    if (remaining() < 4)
+        Throw<std::runtime_error>("packed shard invalid ledgers");
+
+    std::vector<LedgerInfo> infos(get32(p));
+    p += 4;
+    for (auto& info : infos)
+    {
+        if (remaining() < 4)
+            Throw<std::runtime_error>("packed shard invalid ledgers");
+        auto const size{get32(p)};
+        p += 4;
+        if (remaining() < size)
+            Throw<std::runtime_error>("packed shard invalid ledgers");
+        info = deserializeHeader(Slice(p, size), true);
+        p += size;
+    }
+    return infos;
+}
+
+void
+PackedBackend::read(std::uint64_t offset, void* buffer, std::size_t size)
+{
+    nudb::error_code ec;
+    file_.read(offset, buffer, size, ec);
+    if (ec)
+        Throw<nudb::system_error>(ec);
+}
+
+Status
+PackedBackend::fetchEntry(
+    void const* key,
+    std::uint64_t offset,
+    std::uint32_t size,
+    std::shared_ptr<NodeObject>* pObject)
+{
+    if (offset < headerSize || offset + size > ledgersOffset_)
+        return dataCorrupt;
+
+    nudb::detail::buffer data(size);
+    read(offset, data.get(), size);
+
+    nudb::detail::buffer bf;
+    auto const result{nodeobject_decompress(data.get(), size, bf)};
+    DecodedBlob decoded(key, result.first, result.second);
+    if (!decoded.wasOk())
+        return dataCorrupt;
+
+    *pObject = decoded.createObject();
+    return ok;
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
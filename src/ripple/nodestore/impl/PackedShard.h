@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_PACKEDSHARD_H_INCLUDED
+#define RIPPLE_NODESTORE_PACKEDSHARD_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/nodestore/Backend.h>
+
+#include <boost/filesystem.hpp>
+#include <nudb/nudb.hpp>
+
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/*  A packed shard stores the node objects of a final shard in one
+    immutable file. The file consists of, in order:
+
+        header      Magic, version, ledger range, object count and
+                    the offsets of the sections that follow.
+        data        Compressed node objects in the order they were
+                    added, which is ledger traversal order.
+        ledgers     The header of every ledger, oldest first.
+        index       One entry per object, sorted by key, holding the
+                    key and the location of the object in the data.
+        fences      The key of every `fenceInterval`th index entry.
+
+    Lookups binary search the fences, which are held in memory, then
+    the single block of index entries they select, so a fetch costs
+    two reads. All integers are big endian.
+*/
+
+// Name of the packed file in a shard directory
+inline constexpr auto PackedShardFileName{"shard.pack"};
+
+/** Writes a packed shard.
+
+    The file is written under a temporary name and only moved into
+    place by commit(), so a packed shard file is always complete.
+*/
+class PackedShardWriter
+{
+public:
+    /** Start writing a packed shard.
+
+        @param path The final path of the file.
+        @param firstSeq The first ledger sequence in the shard.
+        @param lastSeq The last ledger sequence in the shard.
+        @throws std::exception on failure.
+    */
+    PackedShardWriter(
+        boost::filesystem::path const& path,
+        std::uint32_t firstSeq,
+        std::uint32_t lastSeq);
+
+    PackedShardWriter(PackedShardWriter const&) = delete;
+    PackedShardWriter&
+    operator=(PackedShardWriter const&) = delete;
+
+    /** Removes the temporary file unless committed. */
+    ~PackedShardWriter();
+
+    /** Append a node object.
+
+        Objects whose key was already added are stored once.
+    */
+    void
+    add(std::shared_ptr<NodeObject> const& nodeObject);
+
+    /** Append a ledger header. Headers must be added oldest first. */
+    void
+    addLedger(LedgerInfo const& info);
+
+    /** Write the ledgers, index and fences and move the file into place.
+
+        @return The size of the file.
+    */
+    std::uint64_t
+    commit();
+
+private:
+    struct Entry
+    {
+        uint256 key;
+        std::uint64_t offset;
+        std::uint32_t size;
+    };
+
+    void
+    append(void const* data, std::size_t size);
+
+    void
+    flush();
+
+    boost::filesystem::path const path_;
+    boost::filesystem::path const tmpPath_;
+    std::uint32_t const firstSeq_;
+    std::uint32_t const lastSeq_;
+    nudb::native_file file_;
+    std::vector<std::uint8_t> buffer_;
+    std::uint64_t offset_{0};
+    std::vector<Entry> entries_;
+    std::vector<std::uint8_t> ledgers_;
+    std::uint32_t ledgerCount_{0};
+    bool committed_{false};
+};
+
+/** A read only backend serving a packed shard. */
+class PackedBackend : public Backend
+{
+public:
+    PackedBackend(boost::filesystem::path const& path, beast::Journal j);
+
+    ~PackedBackend() override;
+
+    std::string
+    getName() override
+    {
+        return path_.string();
+    }
+
+    void
+    open(bool createIfMissing) override;
+
+    bool
+    isOpen() override
+    {
+        return file_.is_open();
+    }
+
+    void
+    close() override;
+
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override;
+
+    bool
+    canFetchBatch() override
+    {
+        return false;
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+    fetchBatch(std::vector<uint256 const*> const& hashes) override;
+
+    /** Objects already in the file are accepted, others throw. */
+    void
+    store(std::shared_ptr<NodeObject> const& nodeObject) override;
+
+    void
+    storeBatch(Batch const& batch) override;
+
+    void
+    sync() override
+    {
+    }
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override;
+
+    int
+    getWriteLoad() override
+    {
+        return 0;
+    }
+
+    void
+    setDeletePath() override
+    {
+        deletePath_ = true;
+    }
+
+    void
+    verify() override
+    {
+    }
+
+    int
+    fdRequired() const override
+    {
+        return 1;
+    }
+
+    /** Returns the ledger headers embedded in the file, oldest first.
+
+        @throws std::exception on failure.
+    */
+    std::vector<LedgerInfo>
+    ledgers();
+
+private:
+    // Read `size` bytes at `offset` into `buffer`
+    void
+    read(std::uint64_t offset, void* buffer, std::size_t size);
+
+    // Read and decode the object stored at an index entry
+    Status
+    fetchEntry(
+        void const* key,
+        std::uint64_t offset,
+        std::uint32_t size,
+        std::shared_ptr<NodeObject>* pObject);
+
+    boost::filesystem::path const path_;
+    beast::Journal const j_;
+    nudb::native_file file_;
+    std::uint64_t objectCount_{0};
+    std::uint64_t ledgersOffset_{0};
+    std::uint64_t indexOffset_{0};
+    std::vector<uint256> fences_;
+    bool deletePath_{false};
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -18,21 +18,38 @@
 //==============================================================================
 
 #include <ripple/app/ledger/InboundLedger.h>
+#include <ripple/app/ledger/TxIndex.h>
 #include <ripple/app/main/DBInit.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/PackedShard.h>
 #include <ripple/nodestore/impl/Shard.h>
 #include <ripple/protocol/digest.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
+#include <thread>
+
 namespace ripple {
 namespace NodeStore {
 
 uint256 const Shard::finalKey{0};
 
+namespace {
+
+// Remove the NuDB files superseded by a packed shard file
+void
+removeNuDBFiles(boost::filesystem::path const& dir)
+{
+    for (auto const name : {"nudb.dat", "nudb.key", "nudb.log"})
+        boost::filesystem::remove(dir / name);
+}
+
+}  // namespace
+
 Shard::Shard(
     Application& app,
     DatabaseShard const& db,
@@ -108,12 +125,56 @@ Shard::init(Scheduler& scheduler, nudb::context& context)
     }
     section.set("path", dir_.string());
 
+    finalizeThreads_ = std::max<std::uint32_t>(
+        1,
+        get<std::uint32_t>(
+            section,
+            "finalize_threads",
+            std::min(4u, std::max(1u, std::thread::hardware_concurrency()))));
+
+    packFinal_ = get<bool>(section, "pack_final", false);
+
+    // A final shard is never written to again, so serve its reads from a
+    // memory mapping of the backend files unless configured otherwise
+    {
+        using namespace boost::filesystem;
+        if (get<bool>(section, "mmap_final", true) && exists(dir_) &&
+            !exists(dir_ / AcquireShardDBName) && exists(dir_ / LgrDBName) &&
+            exists(dir_ / TxDBName))
+        {
+            section.set("mmap_reads", "1");
+        }
+    }
+
     std::lock_guard lock{mutex_};
     if (backend_)
     {
         JLOG(j_.error()) << "shard " << index_ << " already initialized";
         return false;
     }
+
+    // A packed shard file holds every node object of the shard
+    if (auto const packed{dir_ / PackedShardFileName};
+        boost::filesystem::exists(packed) &&
+        !boost::filesystem::exists(dir_ / AcquireShardDBName))
+    {
+        try
+        {
+            // The NuDB files remain if they were in use when packed
+            removeNuDBFiles(dir_);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.error()) << "shard " << index_
+                             << ". Exception caught in function " << __func__
+                             << ". Error: " << e.what();
+            return false;
+        }
+
+        backend_ = std::make_unique<PackedBackend>(packed, j_);
+        return open(lock);
+    }
+
     backend_ = factory->createInstance(
         NodeObject::keyBytes,
         section,
@@ -286,6 +347,28 @@ Shard::fetchNodeObject(uint256 const& hash, FetchReport& fetchReport)
     return nodeObject;
 }
 
+bool
+Shard::mayContain(uint256 const& hash) const
+{
+    std::shared_ptr<ShardFilter const> filter;
+    {
+        std::lock_guard lock(mutex_);
+        filter = filter_;
+    }
+    return filter && filter->mayContain(hash);
+}
+
+Shard::FinalizeProgress
+Shard::getFinalizeProgress() const
+{
+    FinalizeProgress progress;
+    progress.verified = finalizeVerified_;
+    progress.total = maxLedgers_;
+    progress.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - finalizeStart_.load());
+    return progress;
+}
+
 Shard::StoreLedgerResult
 Shard::storeLedger(
     std::shared_ptr<Ledger const> const& srcLedger,
@@ -454,6 +537,25 @@ Shard::setLedgerStored(std::shared_ptr<Ledger const> const& ledger)
         }
     }
 
+    if (app_.config().txIndex())
+    {
+        try
+        {
+            Batch batch;
+            for (auto const& [key, data] : makeTxIndex(*ledger))
+                batch.emplace_back(NodeObject::createObject(
+                    hotTX_INDEX, makeSlice(data), key));
+            if (!batch.empty())
+                backend_->storeBatch(batch);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.warn()) << "shard " << index_
+                            << " unable to index the transactions of ledger "
+                            << ledgerSeq << ": " << e.what();
+        }
+    }
+
     if (!storeSQLite(ledger))
         return false;
 
@@ -667,8 +769,6 @@ Shard::finalize(
 
     // Validate every ledger stored in the backend
     Config const& config{app_.config()};
-    std::shared_ptr<Ledger> ledger;
-    std::shared_ptr<Ledger const> next;
     auto const lastLedgerHash{hash};
     auto& shardFamily{*app_.getShardFamily()};
     auto const fullBelowCache{shardFamily.getFullBelowCache(lastSeq_)};
@@ -678,8 +778,12 @@ Shard::finalize(
     fullBelowCache->reset();
     treeNodeCache->reset();
 
-    // Start with the last ledger in the shard and walk backwards from
-    // child to parent until we reach the first ledger
+    finalizeVerified_ = 0;
+    finalizeStart_ = std::chrono::steady_clock::now();
+
+    // Start with the last ledger in the shard and walk the headers
+    // backwards from child to parent until we reach the first ledger
+    std::vector<LedgerInfo> infos(maxLedgers_);
     ledgerSeq = lastSeq_;
     while (ledgerSeq >= firstSeq_)
     {
@@ -690,46 +794,201 @@ Shard::finalize(
         if (!nodeObject)
             return fail("invalid ledger");
 
-        ledger = std::make_shared<Ledger>(
-            deserializePrefixedHeader(makeSlice(nodeObject->getData())),
-            config,
-            shardFamily);
-        if (ledger->info().seq != ledgerSeq)
+        auto info{deserializePrefixedHeader(nodeObject->getData())};
+        if (info.seq != ledgerSeq)
             return fail("invalid ledger sequence");
-        if (ledger->info().hash != hash)
+        if (calculateLedgerHash(info) != hash)
             return fail("invalid ledger hash");
 
-        ledger->stateMap().setLedgerSeq(ledgerSeq);
-        ledger->txMap().setLedgerSeq(ledgerSeq);
+        info.hash = hash;
+        hash = info.parentHash;
+        infos[ledgerSeq - firstSeq_] = std::move(info);
+        --ledgerSeq;
+    }
+
+    auto loadLedger = [&](std::uint32_t seq, std::string& error) {
+        auto ledger{std::make_shared<Ledger>(
+            infos[seq - firstSeq_], config, shardFamily)};
+        ledger->stateMap().setLedgerSeq(seq);
+        ledger->txMap().setLedgerSeq(seq);
         ledger->setImmutable(config);
         if (!ledger->stateMap().fetchRoot(
                 SHAMapHash{ledger->info().accountHash}, nullptr))
         {
-            return fail("missing root STATE node");
+            error = "missing root STATE node";
+            ledger.reset();
         }
-        if (ledger->info().txHash.isNonZero() &&
+        else if (
+            ledger->info().txHash.isNonZero() &&
             !ledger->txMap().fetchRoot(
                 SHAMapHash{ledger->info().txHash}, nullptr))
         {
-            return fail("missing root TXN node");
+            error = "missing root TXN node";
+            ledger.reset();
+        }
+        return ledger;
+    };
+
+    // Each ledger's maps are verified against those of its child, so the
+    // nodes they share are only visited once. Runs of adjacent ledgers
+    // are verified in parallel, and the top ledger of each run is
+    // compared against its child at the bottom of the run above. The
+    // SQLite databases are written one ledger at a time, from the last
+    // ledger down as before, each ledger once it has been verified.
+    std::uint32_t constexpr finalizeRun{256};
+    std::uint32_t const runs{(maxLedgers_ + finalizeRun - 1) / finalizeRun};
+    std::uint32_t const threads{std::min(finalizeThreads_, runs)};
+    std::atomic<bool> failed{false};
+    std::mutex failMutex;
+    std::string failMsg;
+    std::uint32_t failSeq{0};
+    std::mutex verifiedMutex;
+    std::vector<bool> verified(writeSQLite ? maxLedgers_ : 0);
+    std::mutex storeMutex;
+    std::uint32_t storeSeq{lastSeq_};
+
+    auto setFailed = [&](std::uint32_t seq, std::string const& msg) {
+        std::lock_guard lock(failMutex);
+        if (!failed.exchange(true))
+        {
+            failSeq = seq;
+            failMsg = msg;
         }
+    };
 
-        if (!verifyLedger(ledger, next))
-            return fail("failed to validate ledger");
+    // Store the ledgers verified below the last one stored. A verifying
+    // thread leaves this to whichever thread is already storing, and the
+    // ledgers left over are stored once verification is done.
+    auto storeLedgers = [&](bool wait) {
+        std::unique_lock lock(storeMutex, std::defer_lock);
+        if (wait)
+            lock.lock();
+        else if (!lock.try_lock())
+            return;
 
-        if (writeSQLite && !storeSQLite(ledger))
-            return fail("failed storing to SQLite databases");
+        try
+        {
+            for (; storeSeq >= firstSeq_ && !failed; --storeSeq)
+            {
+                {
+                    std::lock_guard verifiedLock(verifiedMutex);
+                    if (!verified[storeSeq - firstSeq_])
+                        return;
+                }
 
-        hash = ledger->info().parentHash;
-        next = std::move(ledger);
-        --ledgerSeq;
+                std::string error;
+                auto ledger{loadLedger(storeSeq, error)};
+                if (!ledger)
+                    return setFailed(storeSeq, error);
+
+                if (!storeSQLite(ledger))
+                {
+                    return setFailed(
+                        storeSeq, "failed storing to SQLite databases");
+                }
+            }
+        }
+        catch (std::exception const& e)
+        {
+            setFailed(
+                storeSeq,
+                std::string("exception caught storing ledgers. Error: ") +
+                    e.what());
+        }
+    };
+
+    auto verifyRun = [&](std::size_t run) {
+        std::uint32_t seq{0};
+        try
+        {
+            auto const top{
+                lastSeq_ - static_cast<std::uint32_t>(run) * finalizeRun};
+            auto const bottom{
+                top - std::min(finalizeRun, top - firstSeq_ + 1) + 1};
+            std::string error;
+
+            std::shared_ptr<Ledger const> next;
+            if (top < lastSeq_ && !(next = loadLedger(top + 1, error)))
+                return setFailed(top + 1, error);
+
+            for (seq = top; seq >= bottom; --seq)
+            {
+                if (stop_ || failed)
+                    return;
+
+                auto ledger{loadLedger(seq, error)};
+                if (!ledger)
+                    return setFailed(seq, error);
+
+                if (!verifyLedger(ledger, next))
+                    return setFailed(seq, "failed to validate ledger");
+
+                if (writeSQLite)
+                {
+                    {
+                        std::lock_guard lock(verifiedMutex);
+                        verified[seq - firstSeq_] = true;
+                    }
+                    storeLedgers(false);
+                }
+
+                next = std::move(ledger);
+
+                // Keep the caches to about one ledger per thread
+                if (++finalizeVerified_ % threads == 0)
+                {
+                    fullBelowCache->reset();
+                    treeNodeCache->reset();
+                }
+            }
+        }
+        catch (std::exception const& e)
+        {
+            setFailed(
+                seq,
+                std::string("exception caught verifying ledgers. Error: ") +
+                    e.what());
+        }
+    };
+
+    // The runs are spread over at most `threads` threads
+    app_.getWorkerPool().run(runs, verifyRun, (runs + threads - 1) / threads);
+    if (writeSQLite)
+        storeLedgers(true);
+
+    fullBelowCache->reset();
+    treeNodeCache->reset();
+
+    if (stop_)
+        return false;
+
+    if (failed)
+    {
+        ledgerSeq = failSeq;
+        hash = ledgerSeq >= firstSeq_ && ledgerSeq <= lastSeq_
+            ? infos[ledgerSeq - firstSeq_].hash
+            : uint256{};
+        return fail(failMsg);
+    }
 
-        fullBelowCache->reset();
-        treeNodeCache->reset();
+    {
+        auto const elapsed{std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - finalizeStart_.load())};
+        JLOG(j_.debug()) << "shard " << index_ << " verified " << maxLedgers_
+                         << " ledgers in " << elapsed.count() << "s using "
+                         << threads << " threads";
     }
 
     JLOG(j_.debug()) << "shard " << index_ << " is valid";
 
+    // The shard is usable without a filter, only lookups by hash alone
+    // skip it
+    if (!writeFilter())
+    {
+        JLOG(j_.warn()) << "shard " << index_
+                        << " has no filter for lookups by hash";
+    }
+
     /*
     TODO MP
     SQLite VACUUM blocks all database access while processing.
@@ -800,9 +1059,217 @@ Shard::finalize(
             ". Error: " + e.what());
     }
 
+    // Failing to pack leaves the shard final in its NuDB backend
+    if (packFinal_ && !exists(dir_ / PackedShardFileName) &&
+        writePacked(infos))
+    {
+        std::lock_guard lock(mutex_);
+        usePacked(lock);
+    }
+
+    return true;
+}
+
+bool
+Shard::writeFilter()
+{
+    auto const datPath{dir_ / "nudb.dat"};
+    if (!boost::filesystem::exists(datPath))
+        return false;
+
+    try
+    {
+        // The backend is complete, so its data file is only read. Only
+        // the keys are needed, so the objects are neither decompressed
+        // nor fetched through the backend.
+        std::uint64_t keys{0};
+        nudb::error_code ec;
+        nudb::visit(
+            datPath.string(),
+            [&](void const*,
+                std::size_t,
+                void const*,
+                std::size_t,
+                nudb::error_code&) { ++keys; },
+            nudb::no_progress{},
+            ec);
+        if (ec)
+            Throw<nudb::system_error>(ec);
+
+        ShardFilterWriter writer(keys);
+        nudb::visit(
+            datPath.string(),
+            [&](void const* key,
+                std::size_t keyBytes,
+                void const*,
+                std::size_t,
+                nudb::error_code&) {
+                if (keyBytes == uint256::size())
+                    writer.add(uint256::fromVoid(key));
+            },
+            nudb::no_progress{},
+            ec);
+        if (ec)
+            Throw<nudb::system_error>(ec);
+
+        auto const path{dir_ / ShardFilterFileName};
+        writer.commit(path);
+
+        std::shared_ptr<ShardFilter const> filter{
+            ShardFilter::open(path, j_)};
+        if (!filter)
+            return false;
+
+        JLOG(j_.debug()) << "shard " << index_ << " filter holds " << keys
+                         << " keys";
+
+        std::lock_guard lock(mutex_);
+        filter_ = std::move(filter);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.error()) << "shard " << index_
+                         << ". Exception caught in function " << __func__
+                         << ". Error: " << e.what();
+        return false;
+    }
+    return true;
+}
+
+bool
+Shard::writePacked(std::vector<LedgerInfo> const& infos)
+{
+    auto fail = [&](std::string const& msg) {
+        JLOG(j_.error()) << "shard " << index_ << ". " << msg;
+        return false;
+    };
+
+    Config const& config{app_.config()};
+    auto& shardFamily{*app_.getShardFamily()};
+    auto const fullBelowCache{shardFamily.getFullBelowCache(lastSeq_)};
+    auto const treeNodeCache{shardFamily.getTreeNodeCache(lastSeq_)};
+
+    try
+    {
+        PackedShardWriter writer(
+            dir_ / PackedShardFileName, firstSeq_, lastSeq_);
+
+        auto add = [&](uint256 const& hash) {
+            auto nodeObject{verifyFetch(hash)};
+            if (!nodeObject)
+                return false;
+            writer.add(nodeObject);
+            return true;
+        };
+
+        if (!add(finalKey))
+            return fail("missing final key");
+
+        bool error{false};
+        auto visit = [&](SHAMapTreeNode const& node) {
+            if (stop_ || !add(node.getHash().as_uint256()))
+            {
+                error = true;
+                return false;
+            }
+            return true;
+        };
+
+        // Walk the ledgers oldest first, adding the header of each
+        // followed by the nodes its predecessor does not have, so the
+        // data is laid out in the order a ledger replay reads it
+        std::shared_ptr<Ledger const> prev;
+        for (auto const& info : infos)
+        {
+            if (stop_)
+                return false;
+
+            writer.addLedger(info);
+            if (!add(info.hash))
+                return fail("missing ledger " + std::to_string(info.seq));
+
+            auto ledger{std::make_shared<Ledger>(info, config, shardFamily)};
+            ledger->stateMap().setLedgerSeq(info.seq);
+            ledger->txMap().setLedgerSeq(info.seq);
+            ledger->setImmutable(config);
+
+            if (!ledger->stateMap().fetchRoot(
+                    SHAMapHash{info.accountHash}, nullptr))
+            {
+                return fail("missing root STATE node");
+            }
+            if (prev)
+                ledger->stateMap().visitDifferences(&prev->stateMap(), visit);
+            else
+                ledger->stateMap().visitNodes(visit);
+
+            if (info.txHash.isNonZero())
+            {
+                if (!ledger->txMap().fetchRoot(
+                        SHAMapHash{info.txHash}, nullptr))
+                {
+                    return fail("missing root TXN node");
+                }
+                ledger->txMap().visitNodes(visit);
+            }
+
+            if (error)
+            {
+                return stop_ ? false
+                             : fail(
+                                   "missing node in ledger " +
+                                   std::to_string(info.seq));
+            }
+
+            prev = std::move(ledger);
+            fullBelowCache->reset();
+            treeNodeCache->reset();
+        }
+
+        auto const size{writer.commit()};
+        JLOG(j_.debug()) << "shard " << index_ << " packed into " << size
+                         << " bytes";
+    }
+    catch (std::exception const& e)
+    {
+        return fail(
+            std::string("exception caught in function ") + __func__ +
+            ". Error: " + e.what());
+    }
+
+    fullBelowCache->reset();
+    treeNodeCache->reset();
     return true;
 }
 
+void
+Shard::usePacked(std::lock_guard<std::mutex> const& lock)
+{
+    // The finalizing caller holds a backend count. Other users keep the
+    // NuDB backend, which is replaced when the shard is next initialized.
+    if (backendCount_ > 1)
+        return;
+
+    try
+    {
+        auto packed{std::make_unique<PackedBackend>(
+            dir_ / PackedShardFileName, j_)};
+        packed->open(false);
+
+        backend_->close();
+        backend_ = std::move(packed);
+        removeNuDBFiles(dir_);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.error()) << "shard " << index_
+                         << ". Exception caught in function " << __func__
+                         << ". Error: " << e.what();
+    }
+
+    setFileStats(lock);
+}
+
 bool
 Shard::open(std::lock_guard<std::mutex> const& lock)
 {
@@ -840,7 +1307,7 @@ Shard::open(std::lock_guard<std::mutex> const& lock)
             AcquireShardDBName,
             AcquireShardDBPragma,
             AcquireShardDBInit,
-            DatabaseCon::CheckpointerSetup{&app_.getJobQueue(), &app_.logs()});
+            DatabaseCon::CheckpointerSetup{&app_.logs()});
         state_ = acquire;
     };
 
@@ -923,6 +1390,9 @@ Shard::open(std::lock_guard<std::mutex> const& lock)
             {
                 lastAccess_ = std::chrono::steady_clock::now();
                 state_ = final;
+
+                // Shards finalized before filters were written have none
+                filter_ = ShardFilter::open(dir_ / ShardFilterFileName, j_);
             }
             else
                 state_ = complete;
@@ -987,8 +1457,7 @@ Shard::initSQLite(std::lock_guard<std::mutex> const&)
                 LgrDBName,
                 LgrDBPragma,
                 LgrDBInit,
-                DatabaseCon::CheckpointerSetup{
-                    &app_.getJobQueue(), &app_.logs()});
+                DatabaseCon::CheckpointerSetup{&app_.logs()});
             lgrSQLiteDB_->getSession() << boost::str(
                 boost::format("PRAGMA cache_size=-%d;") %
                 kilobytes(config.getValueFor(SizedItem::lgrDBCache)));
@@ -998,8 +1467,7 @@ Shard::initSQLite(std::lock_guard<std::mutex> const&)
                 TxDBName,
                 TxDBPragma,
                 TxDBInit,
-                DatabaseCon::CheckpointerSetup{
-                    &app_.getJobQueue(), &app_.logs()});
+                DatabaseCon::CheckpointerSetup{&app_.logs()});
             txSQLiteDB_->getSession() << boost::str(
                 boost::format("PRAGMA cache_size=-%d;") %
                 kilobytes(config.getValueFor(SizedItem::txnDBCache)));
@@ -1281,7 +1749,7 @@ Shard::verifyFetch(uint256 const& hash) const
             case ok:
                 // Verify that the hash of node object matches the payload
                 if (nodeObject->getHash() !=
-                    sha512Half(makeSlice(nodeObject->getData())))
+                    sha512Half(nodeObject->getData()))
                     return fail("Node object hash does not match payload");
                 return nodeObject;
             case notFound:
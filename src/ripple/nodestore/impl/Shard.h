@@ -26,6 +26,7 @@
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/nodestore/NodeObject.h>
 #include <ripple/nodestore/Scheduler.h>
+#include <ripple/nodestore/impl/ShardFilter.h>
 
 #include <boost/filesystem.hpp>
 #include <nudb/nudb.hpp>
@@ -114,6 +115,13 @@ public:
     [[nodiscard]] std::shared_ptr<NodeObject>
     fetchNodeObject(uint256 const& hash, FetchReport& fetchReport);
 
+    /** Returns true if the shard has a filter that may contain a node object.
+
+        Only final shards have filters. A shard without one returns false.
+    */
+    [[nodiscard]] bool
+    mayContain(uint256 const& hash) const;
+
     /** Store a ledger.
 
         @param srcLedger The ledger to store.
@@ -188,6 +196,18 @@ public:
         bool const writeSQLite,
         boost::optional<uint256> const& referenceHash);
 
+    struct FinalizeProgress
+    {
+        std::uint32_t verified{0};             // Ledgers verified so far
+        std::uint32_t total{0};                // Ledgers in the shard
+        std::chrono::milliseconds elapsed{0};  // Time spent verifying
+    };
+
+    /** Returns the progress of ledger verification while finalizing.
+     */
+    [[nodiscard]] FinalizeProgress
+    getFinalizeProgress() const;
+
     /** Enables removal of the shard directory on destruction.
      */
     void
@@ -287,6 +307,9 @@ private:
     // Transaction SQLite database used for indexes
     std::unique_ptr<DatabaseCon> txSQLiteDB_;
 
+    // Filter of the node objects of a final shard, for lookups by hash alone
+    std::shared_ptr<ShardFilter const> filter_;
+
     // Tracking information used only when acquiring a shard from the network.
     // If the shard is final, this member will be null.
     std::unique_ptr<AcquireInfo> acquireInfo_;
@@ -306,6 +329,16 @@ private:
     // The time of the last access of a shard that has a final state
     std::chrono::steady_clock::time_point lastAccess_;
 
+    // Number of threads verifying ledgers when finalizing
+    std::uint32_t finalizeThreads_{1};
+
+    // Write a packed file for the shard when it becomes final
+    bool packFinal_{false};
+
+    // Ledgers verified by the current finalization and when it started
+    std::atomic<std::uint32_t> finalizeVerified_{0};
+    std::atomic<std::chrono::steady_clock::time_point> finalizeStart_;
+
     // Open shard databases
     [[nodiscard]] bool
     open(std::lock_guard<std::mutex> const& lock);
@@ -330,6 +363,19 @@ private:
         std::shared_ptr<Ledger const> const& ledger,
         std::shared_ptr<Ledger const> const& next) const;
 
+    // Write the filter of the keys in the backend and start using it
+    [[nodiscard]] bool
+    writeFilter();
+
+    // Write the verified ledgers and their nodes to a packed shard file
+    [[nodiscard]] bool
+    writePacked(std::vector<LedgerInfo> const& infos);
+
+    // Replace the backend with the packed shard file if it is not in use
+    // Lock over mutex_ required
+    void
+    usePacked(std::lock_guard<std::mutex> const&);
+
     // Fetches from backend and log errors based on status codes
     [[nodiscard]] std::shared_ptr<NodeObject>
     verifyFetch(uint256 const& hash) const;
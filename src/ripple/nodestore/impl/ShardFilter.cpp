@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/BloomBlock.h>
+#include <ripple/nodestore/impl/ShardFilter.h>
+
+#include <algorithm>
+#include <array>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+std::array<std::uint8_t, 8> constexpr filterMagic{
+    {'R', 'S', 'F', 'I', 'L', 'T', 'E', 'R'}};
+std::uint32_t constexpr filterVersion{1};
+std::size_t constexpr headerBytes{8 + 4 + 8 + 8};
+
+}  // namespace
+
+ShardFilterWriter::ShardFilterWriter(std::uint64_t keys)
+    : keys_(keys)
+    , blocks_(detail::bloomBlocksFor(keys))
+    , bits_(blocks_ * detail::bloomBlockBytes, 0)
+{
+}
+
+void
+ShardFilterWriter::add(uint256 const& key)
+{
+    auto const block = bits_.data() +
+        detail::bloomBlockOf(key, blocks_) * detail::bloomBlockBytes;
+    for (std::size_t i = 0; i < detail::bloomBitsPerBlockKey; ++i)
+    {
+        auto const bit = detail::bloomBitOf(key, i);
+        block[bit / 8] |= std::uint8_t(1) << (bit % 8);
+    }
+}
+
+void
+ShardFilterWriter::commit(boost::filesystem::path const& path) const
+{
+    std::array<std::uint8_t, headerBytes> header;
+    std::copy(filterMagic.begin(), filterMagic.end(), header.begin());
+    detail::putBE(header.data() + 8, filterVersion, 4);
+    detail::putBE(header.data() + 12, blocks_, 8);
+    detail::putBE(header.data() + 20, keys_, 8);
+
+    auto const tmpPath{path.string() + ".tmp"};
+    nudb::error_code ec;
+    nudb::native_file::erase(tmpPath, ec);
+    {
+        nudb::native_file file;
+        file.create(nudb::file_mode::append, tmpPath, ec);
+        if (!ec)
+            file.write(0, header.data(), header.size(), ec);
+        if (!ec)
+            file.write(header.size(), bits_.data(), bits_.size(), ec);
+        if (!ec)
+            file.sync(ec);
+        if (ec)
+        {
+            file.close();
+            nudb::error_code ignored;
+            nudb::native_file::erase(tmpPath, ignored);
+            Throw<nudb::system_error>(ec);
+        }
+    }
+    boost::filesystem::rename(tmpPath, path);
+}
+
+ShardFilter::ShardFilter(MappedFile file, std::uint64_t blocks)
+    : file_(std::move(file)), blocks_(blocks)
+{
+}
+
+std::unique_ptr<ShardFilter>
+ShardFilter::open(boost::filesystem::path const& path, beast::Journal j)
+{
+    if (!boost::filesystem::exists(path))
+        return nullptr;
+
+    MappedFile file;
+    nudb::error_code ec;
+    file.open(nudb::file_mode::read, path.string(), ec);
+    std::array<std::uint8_t, headerBytes> header;
+    if (!ec)
+        file.read(0, header.data(), header.size(), ec);
+    auto const size{ec ? 0 : file.size(ec)};
+    if (ec)
+    {
+        JLOG(j.warn()) << "unable to read " << path.string() << ": "
+                       << ec.message();
+        return nullptr;
+    }
+
+    auto const blocks{detail::getBE(header.data() + 12, 8)};
+    if (!std::equal(filterMagic.begin(), filterMagic.end(), header.begin()) ||
+        detail::getBE(header.data() + 8, 4) != filterVersion || blocks == 0 ||
+        size != headerBytes + blocks * detail::bloomBlockBytes)
+    {
+        JLOG(j.warn()) << "invalid shard filter " << path.string();
+        return nullptr;
+    }
+
+    return std::unique_ptr<ShardFilter>(
+        new ShardFilter(std::move(file), blocks));
+}
+
+bool
+ShardFilter::mayContain(uint256 const& key) const
+{
+    std::array<std::uint8_t, detail::bloomBlockBytes> block;
+    nudb::error_code ec;
+    file_.read(
+        headerBytes +
+            detail::bloomBlockOf(key, blocks_) * detail::bloomBlockBytes,
+        block.data(),
+        block.size(),
+        ec);
+
+    // Without the filter, the shard has to be searched
+    if (ec)
+        return true;
+
+    for (std::size_t i = 0; i < detail::bloomBitsPerBlockKey; ++i)
+    {
+        auto const bit = detail::bloomBitOf(key, i);
+        if (!(block[bit / 8] & (std::uint8_t(1) << (bit % 8))))
+            return false;
+    }
+    return true;
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
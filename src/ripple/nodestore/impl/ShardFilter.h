@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_SHARDFILTER_H_INCLUDED
+#define RIPPLE_NODESTORE_SHARDFILTER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/nodestore/impl/MappedFile.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/*  A shard filter tells which final shards may hold a node object, so that
+    a lookup by hash alone only searches those. It is a blocked Bloom
+    filter: the bits of a key all fall in one block of 64 bytes, so testing
+    a key reads a single cache line. Node object keys are hashes already,
+    so their bytes choose the block and bits directly.
+
+    The file consists of a header (magic, version, block count and key
+    count) followed by the blocks. Integers are big endian.
+*/
+
+// Name of the filter file in a shard directory
+inline constexpr auto ShardFilterFileName{"shard.filter"};
+
+/** Builds a shard filter and writes it to a file. */
+class ShardFilterWriter
+{
+public:
+    /** Size a filter.
+
+        @param keys The number of keys that will be added.
+    */
+    explicit ShardFilterWriter(std::uint64_t keys);
+
+    void
+    add(uint256 const& key);
+
+    /** Write the filter under a temporary name and move it into place.
+
+        @throws std::exception on failure.
+    */
+    void
+    commit(boost::filesystem::path const& path) const;
+
+private:
+    std::uint64_t const keys_;
+    std::uint64_t const blocks_;
+    std::vector<std::uint8_t> bits_;
+};
+
+/** A shard filter read from its file. */
+class ShardFilter
+{
+public:
+    /** Open a filter file.
+
+        @return The filter, or null if the file is missing or invalid.
+    */
+    static std::unique_ptr<ShardFilter>
+    open(boost::filesystem::path const& path, beast::Journal j);
+
+    /** Returns false if the shard does not hold the key.
+
+        Returns true for every key the shard holds, and for about one in
+        a thousand of those it doesn't.
+    */
+    bool
+    mayContain(uint256 const& key) const;
+
+private:
+    ShardFilter(MappedFile file, std::uint64_t blocks);
+
+    mutable MappedFile file_;
+    std::uint64_t const blocks_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -26,6 +26,7 @@
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/CodecDictionary.h>
 #include <ripple/nodestore/impl/varint.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <cstddef>
@@ -84,6 +85,58 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     return result;
 }
 
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+lz4dict_decompress(
+    void const* in,
+    std::size_t in_size,
+    CodecDictionary const* dict,
+    BufferFactory&& bf)
+{
+    using namespace nudb::detail;
+    std::pair<void const*, std::size_t> result;
+    std::uint8_t const* p = reinterpret_cast<std::uint8_t const*>(in);
+    std::size_t id;
+    auto const n0 = read_varint(p, in_size, id);
+    if (n0 == 0)
+        Throw<std::runtime_error>("lz4dict decompress: n == 0");
+    if (!dict || id != dict->id())
+        Throw<std::runtime_error>(
+            "lz4dict decompress: missing dictionary " + std::to_string(id));
+    auto const n1 = read_varint(p + n0, in_size - n0, result.second);
+    if (n1 == 0)
+        Throw<std::runtime_error>("lz4dict decompress: n == 0");
+    void* const out = bf(result.second);
+    result.first = out;
+    if (!dict->decompress(p + n0 + n1, in_size - n0 - n1, out, result.second))
+        Throw<std::runtime_error>("lz4dict decompress: bad data");
+    return result;
+}
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+lz4dict_compress(
+    void const* in,
+    std::size_t in_size,
+    CodecDictionary const& dict,
+    BufferFactory&& bf)
+{
+    using namespace nudb::detail;
+    std::pair<void const*, std::size_t> result;
+    std::array<std::uint8_t, 2 * varint_traits<std::size_t>::max> vi;
+    auto const n0 = write_varint(vi.data(), dict.id());
+    auto const n = n0 + write_varint(vi.data() + n0, in_size);
+    auto const out_max = LZ4_compressBound(in_size);
+    std::uint8_t* out = reinterpret_cast<std::uint8_t*>(bf(n + out_max));
+    result.first = out;
+    std::memcpy(out, vi.data(), n);
+    auto const out_size = dict.compress(in, in_size, out + n, out_max);
+    if (out_size == 0)
+        Throw<std::runtime_error>("lz4dict compress");
+    result.second = n + out_size;
+    return result;
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -93,11 +146,16 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     1 = lz4 compressed
     2 = inner node compressed
     3 = full inner node
+    4 = lz4 compressed against a shared dictionary
 */
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_decompress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    CodecDictionary const* dict = nullptr)
 {
     using namespace nudb::detail;
 
@@ -191,6 +249,11 @@ nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
             write(os, is(512), 512);
             break;
         }
+        case 4:  // lz4 with dictionary
+        {
+            result = lz4dict_decompress(p, in_size, dict, bf);
+            break;
+        }
         default:
             Throw<std::runtime_error>(
                 "nodeobject codec: bad type=" + std::to_string(type));
@@ -208,7 +271,11 @@ zero32()
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_compress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    CodecDictionary const* dict = nullptr)
 {
     using std::runtime_error;
     using namespace nudb::detail;
@@ -272,7 +339,7 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
 
     std::array<std::uint8_t, varint_traits<std::size_t>::max> vi;
 
-    constexpr std::size_t codecType = 1;
+    std::size_t const codecType = dict ? 4 : 1;
     auto const vn = write_varint(vi.data(), codecType);
     std::pair<void const*, std::size_t> result;
     switch (codecType)
@@ -291,6 +358,19 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
             result.second = vn + lzr.second;
             break;
         }
+        case 4:  // lz4 with dictionary
+        {
+            std::uint8_t* p;
+            auto const lzr = NodeStore::lz4dict_compress(
+                in, in_size, *dict, [&p, &vn, &bf](std::size_t n) {
+                    p = reinterpret_cast<std::uint8_t*>(bf(vn + n));
+                    return p + vn;
+                });
+            std::memcpy(p, vi.data(), vn);
+            result.first = p;
+            result.second = vn + lzr.second;
+            break;
+        }
         default:
             Throw<std::logic_error>(
                 "nodeobject codec: unknown=" + std::to_string(codecType));
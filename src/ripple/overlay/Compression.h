@@ -32,8 +32,13 @@ std::size_t constexpr headerBytes = 6;
 std::size_t constexpr headerBytesCompressed = 10;
 
 // All values other than 'none' must have the high bit. The low order four bits
-// must be 0.
-enum class Algorithm : std::uint8_t { None = 0x00, LZ4 = 0x90 };
+// must be 0. LZ4Stream payloads are compressed against the previous messages
+// on the link, see StreamCompressor.
+enum class Algorithm : std::uint8_t {
+    None = 0x00,
+    LZ4 = 0x90,
+    LZ4Stream = 0xA0
+};
 
 enum class Compressed : std::uint8_t { On, Off };
 
@@ -32,11 +32,89 @@
 #include <iterator>
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace ripple {
 
 constexpr std::size_t maximiumMessageSize = megabytes(64);
 
+namespace detail {
+
+// Message buffers are taken from pools of a few size classes, and the
+// larger ones from the overlay memory arena
+void*
+allocateMessageBuffer(std::size_t bytes);
+
+void
+deallocateMessageBuffer(void* p, std::size_t bytes) noexcept;
+
+/** A standard allocator for message buffers.
+
+    Elements are default initialized, so resizing a buffer that is about
+    to be written does not first fill it with zeros.
+*/
+template <class T>
+struct MessageBufferAllocator
+{
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = MessageBufferAllocator<U>;
+    };
+
+    MessageBufferAllocator() = default;
+
+    template <class U>
+    MessageBufferAllocator(MessageBufferAllocator<U> const&) noexcept
+    {
+    }
+
+    T*
+    allocate(std::size_t n)
+    {
+        return static_cast<T*>(allocateMessageBuffer(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T* p, std::size_t n) noexcept
+    {
+        deallocateMessageBuffer(p, n * sizeof(T));
+    }
+
+    template <class U>
+    void
+    construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>)
+    {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <class U, class... Args>
+    void
+    construct(U* p, Args&&... args)
+    {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <class U>
+    bool
+    operator==(MessageBufferAllocator<U> const&) const noexcept
+    {
+        return true;
+    }
+
+    template <class U>
+    bool
+    operator!=(MessageBufferAllocator<U> const&) const noexcept
+    {
+        return false;
+    }
+};
+
+}  // namespace detail
+
 // VFALCO NOTE If we forward declare Message and write out shared_ptr
 //             instead of using the in-class type alias, we can remove the
 //             entire ripple.pb.h from the main headers.
@@ -56,6 +134,12 @@ class Message : public std::enable_shared_from_this<Message>
     using Algorithm = compression::Algorithm;
 
 public:
+    /** Serialized messages, held in pooled storage that is reused once
+        the last peer sending a message lets go of it.
+    */
+    using Buffer =
+        std::vector<uint8_t, detail::MessageBufferAllocator<uint8_t>>;
+
     /** Constructor
      * @param message Protocol message to serialize
      * @param type Protocol message type
@@ -83,9 +167,16 @@ public:
      *     uncompressed (Compress::Off) payload buffer
      * @return Payload buffer
      */
-    std::vector<uint8_t> const&
+    Buffer const&
     getBuffer(Compressed tryCompressed);
 
+    /** Get the protocol message type */
+    int
+    getType() const
+    {
+        return getType(buffer_.data());
+    }
+
     /** Get the traffic category */
     std::size_t
     getCategory() const
@@ -101,8 +192,8 @@ public:
     }
 
 private:
-    std::vector<uint8_t> buffer_;
-    std::vector<uint8_t> bufferCompressed_;
+    Buffer buffer_;
+    Buffer bufferCompressed_;
     std::size_t category_;
     std::once_flag once_flag_;
     boost::optional<PublicKey> validatorKey_;
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_OVERLAY_OVERLAY_H_INCLUDED
 #define RIPPLE_OVERLAY_OVERLAY_H_INCLUDED
 
+#include <ripple/basics/make_SSLContext.h>
 #include <ripple/beast/utility/PropertyStream.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/json/json_value.h>
@@ -72,11 +73,15 @@ public:
         explicit Setup() = default;
 
         std::shared_ptr<boost::asio::ssl::context> context;
+        // Sessions with the peers we connected to, to resume next time
+        std::shared_ptr<SSLSessionCache> sessions;
         beast::IP::Address public_ip;
         int ipLimit = 0;
         std::uint32_t crawlOptions = 0;
         std::optional<std::uint32_t> networkID;
         bool vlEnabled = true;
+        // Messages at least this large are parsed on the job queue, 0 = never
+        std::size_t decodeOffloadBytes = 0;
     };
 
     using PeerSequence = std::vector<std::shared_ptr<Peer>>;
@@ -166,6 +171,18 @@ public:
         uint256 const& uid,
         PublicKey const& validator) = 0;
 
+    /** Relay a transaction.
+     * @param m the serialized transaction
+     * @param toSkip the peers which have already sent us this transaction
+     * @param local whether the transaction was submitted to this server,
+     *        in which case it is sent to every peer
+     */
+    virtual void
+    relay(
+        protocol::TMTransaction& m,
+        std::set<Peer::id_t> const& toSkip,
+        bool local) = 0;
+
     /** Visit every active peer.
      *
      * The visitor must be invocable as:
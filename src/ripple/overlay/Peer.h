@@ -25,6 +25,8 @@
 #include <ripple/json/json_value.h>
 #include <ripple/overlay/Message.h>
 #include <ripple/protocol/PublicKey.h>
+#include <chrono>
+#include <optional>
 
 namespace ripple {
 
@@ -39,6 +41,8 @@ enum class ProtocolFeature {
     ValidatorListPropagation,
     ValidatorList2Propagation,
     LedgerReplay,
+    TxReconcile,
+    StateTransfer,
 };
 
 /** Represents a peer connection in the overlay. */
@@ -87,6 +91,12 @@ public:
     virtual int
     getScore(bool) const = 0;
 
+    /** How long the peer takes to answer our ledger data requests.
+        Unset until it has answered one.
+    */
+    virtual std::optional<std::chrono::milliseconds>
+    responseTime() const = 0;
+
     virtual PublicKey const&
     getNodePublic() const = 0;
 
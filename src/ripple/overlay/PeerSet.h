@@ -28,6 +28,7 @@
 #include <boost/asio/basic_waitable_timer.hpp>
 #include <mutex>
 #include <set>
+#include <vector>
 
 namespace ripple {
 
@@ -77,6 +78,14 @@ public:
     getPeerIds() const = 0;
 };
 
+/** The peers of a set that have answered ledger data requests, fastest
+    first by their response time.
+
+    @param limit the most peers returned
+*/
+std::vector<std::shared_ptr<Peer>>
+getFastestPeers(Overlay& overlay, PeerSet const& set, std::size_t limit);
+
 class PeerSetBuilder
 {
 public:
@@ -20,7 +20,10 @@
 #ifndef RIPPLE_OVERLAY_REDUCERELAYCOMMON_H_INCLUDED
 #define RIPPLE_OVERLAY_REDUCERELAYCOMMON_H_INCLUDED
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <vector>
 
 namespace ripple {
 
@@ -48,6 +51,33 @@ static constexpr uint16_t MAX_SELECTED_PEERS = 5;
 // Wait before reduce-relay feature is enabled on boot up to let
 // the server establish peer connections
 static constexpr auto WAIT_ON_BOOTUP = std::chrono::minutes{10};
+// Transactions are relayed to at least this many peers, and flooded to
+// every peer when there are no more than this many
+static constexpr std::size_t MIN_TX_RELAY_PEERS = 10;
+
+/** Choose the peers to relay a transaction to.
+
+    Keeps a random percentage of the candidate peers, but never fewer than
+    MIN_TX_RELAY_PEERS of them.
+
+    @param peers The candidate peers, reduced in place to the chosen ones
+    @param percentage The share of the peers to keep, from 1 to 100
+    @param g A uniform random bit generator
+*/
+template <class Peer, class Generator>
+void
+selectTxRelayPeers(
+    std::vector<Peer>& peers,
+    std::size_t percentage,
+    Generator&& g)
+{
+    auto const keep = std::max(
+        MIN_TX_RELAY_PEERS, (peers.size() * percentage + 99) / 100);
+    if (peers.size() <= keep)
+        return;
+    std::shuffle(peers.begin(), peers.end(), g);
+    peers.resize(keep);
+}
 
 }  // namespace reduce_relay
 
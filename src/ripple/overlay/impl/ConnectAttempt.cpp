@@ -170,6 +170,11 @@ ConnectAttempt::onConnect(error_code ec)
 
     setTimer();
     stream_.set_verify_mode(boost::asio::ssl::verify_none);
+    if (auto const& sessions = overlay_.setup().sessions)
+        sessions->prepare(
+            stream_.native_handle(),
+            beast::IPAddressConversion::from_asio(remote_endpoint_)
+                .to_string());
     stream_.async_handshake(
         boost::asio::ssl::stream_base::client,
         strand_.wrap(std::bind(
@@ -205,7 +210,11 @@ ConnectAttempt::onHandshake(error_code ec)
         !overlay_.peerFinder().config().peerPrivate,
         app_.config().COMPRESSION,
         app_.config().VP_REDUCE_RELAY_ENABLE,
-        app_.config().LEDGER_REPLAY);
+        app_.config().LEDGER_REPLAY,
+        app_.config().STREAM_COMPRESSION,
+        app_.config().TX_RECONCILE,
+        app_.config().RELAY_BATCH,
+        app_.config().STATE_TRANSFER);
 
     buildHandshake(
         req_,
@@ -74,15 +74,30 @@ std::string
 makeFeaturesRequestHeader(
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled)
+    bool ledgerReplayEnabled,
+    bool streamComprEnabled,
+    bool txReconcileEnabled,
+    bool relayBatchEnabled,
+    bool stateTransferEnabled)
 {
     std::stringstream str;
     if (comprEnabled)
-        str << FEATURE_COMPR << "=lz4" << DELIM_FEATURE;
+    {
+        str << FEATURE_COMPR << "=lz4";
+        if (streamComprEnabled)
+            str << DELIM_VALUE << "lz4s";
+        str << DELIM_FEATURE;
+    }
     if (vpReduceRelayEnabled)
-        str << FEATURE_VPRR << "=1";
+        str << FEATURE_VPRR << "=1" << DELIM_FEATURE;
     if (ledgerReplayEnabled)
-        str << FEATURE_LEDGER_REPLAY << "=1";
+        str << FEATURE_LEDGER_REPLAY << "=1" << DELIM_FEATURE;
+    if (txReconcileEnabled)
+        str << FEATURE_TX_RECONCILE << "=1" << DELIM_FEATURE;
+    if (relayBatchEnabled)
+        str << FEATURE_RELAY_BATCH << "=1" << DELIM_FEATURE;
+    if (stateTransferEnabled)
+        str << FEATURE_STATE_TRANSFER << "=1";
     return str.str();
 }
 
@@ -91,15 +106,32 @@ makeFeaturesResponseHeader(
     http_request_type const& headers,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled)
+    bool ledgerReplayEnabled,
+    bool streamComprEnabled,
+    bool txReconcileEnabled,
+    bool relayBatchEnabled,
+    bool stateTransferEnabled)
 {
     std::stringstream str;
     if (comprEnabled && isFeatureValue(headers, FEATURE_COMPR, "lz4"))
-        str << FEATURE_COMPR << "=lz4" << DELIM_FEATURE;
+    {
+        str << FEATURE_COMPR << "=lz4";
+        if (streamComprEnabled &&
+            isFeatureValue(headers, FEATURE_COMPR, "lz4s"))
+            str << DELIM_VALUE << "lz4s";
+        str << DELIM_FEATURE;
+    }
     if (vpReduceRelayEnabled && featureEnabled(headers, FEATURE_VPRR))
-        str << FEATURE_VPRR << "=1";
+        str << FEATURE_VPRR << "=1" << DELIM_FEATURE;
     if (ledgerReplayEnabled && featureEnabled(headers, FEATURE_LEDGER_REPLAY))
-        str << FEATURE_LEDGER_REPLAY << "=1";
+        str << FEATURE_LEDGER_REPLAY << "=1" << DELIM_FEATURE;
+    if (txReconcileEnabled && featureEnabled(headers, FEATURE_TX_RECONCILE))
+        str << FEATURE_TX_RECONCILE << "=1" << DELIM_FEATURE;
+    if (relayBatchEnabled && featureEnabled(headers, FEATURE_RELAY_BATCH))
+        str << FEATURE_RELAY_BATCH << "=1" << DELIM_FEATURE;
+    if (stateTransferEnabled &&
+        featureEnabled(headers, FEATURE_STATE_TRANSFER))
+        str << FEATURE_STATE_TRANSFER << "=1";
     return str.str();
 }
 
@@ -365,7 +397,11 @@ makeRequest(
     bool crawlPublic,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled) -> request_type
+    bool ledgerReplayEnabled,
+    bool streamComprEnabled,
+    bool txReconcileEnabled,
+    bool relayBatchEnabled,
+    bool stateTransferEnabled) -> request_type
 {
     request_type m;
     m.method(boost::beast::http::verb::get);
@@ -379,7 +415,13 @@ makeRequest(
     m.insert(
         "X-Protocol-Ctl",
         makeFeaturesRequestHeader(
-            comprEnabled, vpReduceRelayEnabled, ledgerReplayEnabled));
+            comprEnabled,
+            vpReduceRelayEnabled,
+            ledgerReplayEnabled,
+            streamComprEnabled,
+            txReconcileEnabled,
+            relayBatchEnabled,
+            stateTransferEnabled));
     return m;
 }
 
@@ -408,7 +450,11 @@ makeResponse(
             req,
             app.config().COMPRESSION,
             app.config().VP_REDUCE_RELAY_ENABLE,
-            app.config().LEDGER_REPLAY));
+            app.config().LEDGER_REPLAY,
+            app.config().STREAM_COMPRESSION,
+            app.config().TX_RECONCILE,
+            app.config().RELAY_BATCH,
+            app.config().STATE_TRANSFER));
 
     buildHandshake(resp, sharedValue, networkID, public_ip, remote_ip, app);
 
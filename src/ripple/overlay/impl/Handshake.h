@@ -97,6 +97,11 @@ verifyHandshake(
    @param comprEnabled if true then compression feature is enabled
    @param vpReduceRelayEnabled if true then reduce-relay feature is enabled
    @param ledgerReplayEnabled if true then ledger-replay feature is enabled
+   @param streamComprEnabled if true then the link may be compressed as a
+      stream, requires comprEnabled
+   @param txReconcileEnabled if true then tx set reconciliation is enabled
+   @param relayBatchEnabled if true then batched consensus relay is enabled
+   @param stateTransferEnabled if true then bulk state transfer is enabled
    @return http request with empty body
  */
 request_type
@@ -104,7 +109,11 @@ makeRequest(
     bool crawlPublic,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled);
+    bool ledgerReplayEnabled,
+    bool streamComprEnabled = false,
+    bool txReconcileEnabled = false,
+    bool relayBatchEnabled = false,
+    bool stateTransferEnabled = false);
 
 /** Make http response
 
@@ -133,11 +142,18 @@ makeResponse(
 // The format is:
 // X-Protocol-Ctl: feature1=value1[,value2]*[\s*;\s*feature2=value1[,value2]*]*
 // value: \S+
-static constexpr char FEATURE_COMPR[] = "compr";  // compression
+// compression, "lz4" per message and "lz4s" for stream compression
+static constexpr char FEATURE_COMPR[] = "compr";
 static constexpr char FEATURE_VPRR[] =
     "vprr";  // validation/proposal reduce-relay
 static constexpr char FEATURE_LEDGER_REPLAY[] =
     "ledgerreplay";  // ledger replay
+static constexpr char FEATURE_TX_RECONCILE[] =
+    "txreconcile";  // transaction set reconciliation
+static constexpr char FEATURE_RELAY_BATCH[] =
+    "relaybatch";  // consensus messages and transactions relayed in batches
+static constexpr char FEATURE_STATE_TRANSFER[] =
+    "statetransfer";  // ledger state fetched in leaf batches
 static constexpr char DELIM_FEATURE[] = ";";
 static constexpr char DELIM_VALUE[] = ",";
 
@@ -212,13 +228,21 @@ peerFeatureEnabled(
    @param comprEnabled if true then compression feature is enabled
    @param vpReduceRelayEnabled if true then reduce-relay feature is enabled
    @param ledgerReplayEnabled if true then ledger-replay feature is enabled
+   @param streamComprEnabled if true then stream compression is offered
+   @param txReconcileEnabled if true then tx set reconciliation is enabled
+   @param relayBatchEnabled if true then batched consensus relay is enabled
+   @param stateTransferEnabled if true then bulk state transfer is enabled
    @return X-Protocol-Ctl header value
  */
 std::string
 makeFeaturesRequestHeader(
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled);
+    bool ledgerReplayEnabled,
+    bool streamComprEnabled = false,
+    bool txReconcileEnabled = false,
+    bool relayBatchEnabled = false,
+    bool stateTransferEnabled = false);
 
 /** Make response header X-Protocol-Ctl value with supported features.
     If the request has a feature that we support enabled
@@ -228,6 +252,10 @@ makeFeaturesRequestHeader(
    @param comprEnabled if true then compression feature is enabled
    @param vpReduceRelayEnabled if true then reduce-relay feature is enabled
    @param ledgerReplayEnabled if true then ledger-replay feature is enabled
+   @param streamComprEnabled if true then stream compression is accepted
+   @param txReconcileEnabled if true then tx set reconciliation is enabled
+   @param relayBatchEnabled if true then batched consensus relay is enabled
+   @param stateTransferEnabled if true then bulk state transfer is enabled
    @return X-Protocol-Ctl header value
  */
 std::string
@@ -235,7 +263,11 @@ makeFeaturesResponseHeader(
     http_request_type const& headers,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled);
+    bool ledgerReplayEnabled,
+    bool streamComprEnabled = false,
+    bool txReconcileEnabled = false,
+    bool relayBatchEnabled = false,
+    bool stateTransferEnabled = false);
 
 }  // namespace ripple
 
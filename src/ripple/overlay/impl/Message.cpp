@@ -17,12 +17,70 @@
 */
 //==============================================================================
 
+#include <ripple/basics/MemoryArena.h>
+#include <ripple/basics/SlabAllocator.h>
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/impl/TrafficCount.h>
 #include <cstdint>
 
 namespace ripple {
 
+namespace detail {
+
+namespace {
+
+// The size classes of the pools, by the bytes each block holds. They
+// cover validations, proposals, transactions and most ledger and object
+// replies; anything larger is allocated individually. The pages of a
+// slab only become resident as its blocks are first handed out.
+//
+// The set is never destroyed, so that messages released while static
+// objects are being destroyed can still be returned to it.
+SlabAllocatorSet<std::uint8_t>&
+messagePools()
+{
+    static constexpr std::size_t align = alignof(std::max_align_t);
+    static auto* const pools = new SlabAllocatorSet<std::uint8_t>({
+        {128 - 1, megabytes(std::size_t(2)), align},
+        {256 - 1, megabytes(std::size_t(4)), align},
+        {512 - 1, megabytes(std::size_t(4)), align},
+        {1024 - 1, megabytes(std::size_t(4)), align},
+        {2048 - 1, megabytes(std::size_t(4)), align},
+        {4096 - 1, megabytes(std::size_t(8)), align},
+        {16384 - 1, megabytes(std::size_t(16)), align},
+    });
+
+    return *pools;
+}
+
+}  // namespace
+
+void*
+allocateMessageBuffer(std::size_t bytes)
+{
+    // The set counts the one byte of its element type
+    if (bytes != 0)
+    {
+        if (auto p = messagePools().allocate(bytes - 1))
+            return p;
+    }
+
+    return arenaAllocate(MemoryArena::overlay, bytes);
+}
+
+void
+deallocateMessageBuffer(void* p, std::size_t bytes) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    // If the pools don't claim this pointer, it came from the arena
+    if (!messagePools().deallocate(static_cast<std::uint8_t*>(p)))
+        arenaDeallocate(MemoryArena::overlay, p, bytes);
+}
+
+}  // namespace detail
+
 Message::Message(
     ::google::protobuf::Message const& message,
     int type,
@@ -40,8 +98,11 @@ Message::Message(
 
     setHeader(buffer_.data(), messageBytes, type, Algorithm::None, 0);
 
+    // Computing the size cached the sizes of the nested messages, so the
+    // message can be written straight into the buffer without computing
+    // it again
     if (messageBytes != 0)
-        message.SerializeToArray(buffer_.data() + headerBytes, messageBytes);
+        message.SerializeWithCachedSizesToArray(buffer_.data() + headerBytes);
 
     assert(getBufferSize() == totalSize(message));
 }
@@ -86,6 +147,10 @@ Message::compress()
             case protocol::mtVALIDATORLIST:
             case protocol::mtVALIDATORLISTCOLLECTION:
             case protocol::mtREPLAY_DELTA_RESPONSE:
+            case protocol::mtRECONCILE_TXSET_RESPONSE:
+            case protocol::mtRELAY_BATCH:
+            case protocol::mtTRANSACTIONS:
+            case protocol::mtSTATE_RANGE:
                 return true;
             case protocol::mtPING:
             case protocol::mtCLUSTER:
@@ -100,6 +165,8 @@ Message::compress()
             case protocol::mtPROOF_PATH_REQ:
             case protocol::mtPROOF_PATH_RESPONSE:
             case protocol::mtREPLAY_DELTA_REQ:
+            case protocol::mtRECONCILE_TXSET_REQ:
+            case protocol::mtGET_STATE_RANGE:
                 break;
         }
         return false;
@@ -204,7 +271,7 @@ Message::getBufferSize()
     return buffer_.size();
 }
 
-std::vector<uint8_t> const&
+Message::Buffer const&
 Message::getBuffer(Compressed tryCompressed)
 {
     if (tryCompressed == Compressed::Off)
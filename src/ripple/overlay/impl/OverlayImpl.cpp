@@ -22,8 +22,10 @@
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/ValidatorList.h>
 #include <ripple/app/misc/ValidatorSite.h>
+#include <ripple/basics/UptimeClock.h>
 #include <ripple/basics/base64.h>
 #include <ripple/basics/make_SSLContext.h>
+#include <ripple/basics/random.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/nodestore/DatabaseShard.h>
@@ -103,6 +105,8 @@ OverlayImpl::Timer::on_timer(error_code ec)
     if ((++overlay_.timer_count_ % Tuning::checkIdlePeers) == 0)
         overlay_.deleteIdlePeers();
 
+    overlay_.ledgerDataCache_.sweep();
+
     timer_.expires_from_now(std::chrono::seconds(1));
     timer_.async_wait(overlay_.strand_.wrap(std::bind(
         &Timer::on_timer, shared_from_this(), std::placeholders::_1)));
@@ -137,6 +141,12 @@ OverlayImpl::OverlayImpl(
           config,
           collector))
     , m_resolver(resolver)
+    , ledgerDataCache_(
+          "LedgerDataCache",
+          Tuning::ledgerDataCacheSize,
+          Tuning::ledgerDataCacheAge,
+          stopwatch(),
+          app_.journal("TaggedCache"))
     , next_id_(1)
     , timer_count_(0)
     , slots_(app, *this)
@@ -454,6 +464,7 @@ OverlayImpl::add_active(std::shared_ptr<PeerImp> const& peer)
             std::make_tuple(peer));
         assert(result.second);
         (void)result.second;
+        updatePeerSnapshot();
     }
 
     list_.emplace(peer.get(), peer);
@@ -601,9 +612,11 @@ void
 OverlayImpl::onWrite(beast::PropertyStream::Map& stream)
 {
     beast::PropertyStream::Set set("traffic", stream);
-    auto const stats = m_traffic.getCounts();
-    for (auto const& i : stats)
+    auto const& stats = m_traffic.getCounts();
+    auto const& histograms = m_traffic.getHistograms();
+    for (std::size_t c = 0; c < stats.size(); ++c)
     {
+        auto const& i = stats[c];
         if (i)
         {
             beast::PropertyStream::Map item(set);
@@ -612,8 +625,28 @@ OverlayImpl::onWrite(beast::PropertyStream::Map& stream)
             item["messages_in"] = std::to_string(i.messagesIn.load());
             item["bytes_out"] = std::to_string(i.bytesOut.load());
             item["messages_out"] = std::to_string(i.messagesOut.load());
+
+            // Percentiles are the upper bounds of power of two buckets
+            auto add = [&item](
+                           std::string const& name,
+                           TrafficCount::Histogram const& h) {
+                using Histogram = TrafficCount::Histogram;
+                auto const counts = h.counts();
+                item[name + "_p50"] =
+                    std::to_string(Histogram::percentile(counts, 50));
+                item[name + "_p99"] =
+                    std::to_string(Histogram::percentile(counts, 99));
+            };
+            add("size", histograms[c].size);
+            add("queued_us", histograms[c].queued);
+            add("handler_us", histograms[c].handler);
         }
     }
+
+    beast::PropertyStream::Map txRelay("tx_reduce_relay", stream);
+    txRelay["relayed"] = std::to_string(txRelayed_.load());
+    txRelay["skipped"] = std::to_string(txRelaySkipped_.load());
+    txRelay["bytes_saved"] = std::to_string(txRelayBytesSaved_.load());
 }
 
 //------------------------------------------------------------------------------
@@ -634,6 +667,7 @@ OverlayImpl::activate(std::shared_ptr<PeerImp> const& peer)
             std::make_tuple(peer)));
         assert(result.second);
         (void)result.second;
+        updatePeerSnapshot();
     }
 
     JLOG(journal_.debug()) << "activated " << peer->getRemoteAddress() << " ("
@@ -650,7 +684,19 @@ void
 OverlayImpl::onPeerDeactivate(Peer::id_t id)
 {
     std::lock_guard lock(mutex_);
-    ids_.erase(id);
+    if (ids_.erase(id) != 0)
+        updatePeerSnapshot();
+}
+
+void
+OverlayImpl::updatePeerSnapshot()
+{
+    auto peers = std::make_shared<PeerSnapshot>();
+    peers->reserve(ids_.size());
+    for (auto const& x : ids_)
+        peers->push_back(x.second);
+    std::atomic_store(
+        &peers_, std::shared_ptr<PeerSnapshot const>(std::move(peers)));
 }
 
 void
@@ -723,6 +769,22 @@ OverlayImpl::reportTraffic(
     m_traffic.addCount(cat, isInbound, number);
 }
 
+void
+OverlayImpl::reportQueueTime(
+    TrafficCount::category cat,
+    std::chrono::microseconds elapsed)
+{
+    m_traffic.addQueueTime(cat, elapsed);
+}
+
+void
+OverlayImpl::reportHandlerTime(
+    TrafficCount::category cat,
+    std::chrono::microseconds elapsed)
+{
+    m_traffic.addHandlerTime(cat, elapsed);
+}
+
 Json::Value
 OverlayImpl::crawlShards(bool pubKey, std::uint32_t hops)
 {
@@ -1268,6 +1330,41 @@ OverlayImpl::relay(
     return {};
 }
 
+void
+OverlayImpl::relay(
+    protocol::TMTransaction& m,
+    std::set<Peer::id_t> const& toSkip,
+    bool local)
+{
+    auto const sm = std::make_shared<Message>(m, protocol::mtTRANSACTION);
+
+    std::vector<std::shared_ptr<PeerImp>> peers;
+    for_each([&](std::shared_ptr<PeerImp>&& p) {
+        if (toSkip.find(p->id()) == toSkip.end())
+            peers.emplace_back(std::move(p));
+    });
+
+    // The peers we leave out get the transaction from the others; only flood
+    // what we are the source of, and nothing until the overlay settles
+    auto const candidates = peers.size();
+    if (app_.config().TX_REDUCE_RELAY_ENABLE && !local &&
+        reduce_relay::epoch<std::chrono::minutes>(UptimeClock::now()) >
+            reduce_relay::WAIT_ON_BOOTUP)
+    {
+        reduce_relay::selectTxRelayPeers(
+            peers, app_.config().TX_RELAY_PERCENTAGE, default_prng());
+    }
+
+    for (auto const& p : peers)
+        p->send(sm);
+
+    auto const skipped = candidates - peers.size();
+    txRelayed_ += peers.size();
+    txRelaySkipped_ += skipped;
+    txRelayBytesSaved_ +=
+        skipped * sm->getBuffer(compression::Compressed::Off).size();
+}
+
 std::shared_ptr<Message>
 OverlayImpl::getManifestsMessage()
 {
@@ -1467,11 +1564,14 @@ setup_Overlay(BasicConfig const& config)
     {
         auto const& section = config.section("overlay");
         setup.context = make_SSLContext("");
+        setup.sessions = std::make_shared<SSLSessionCache>(Tuning::sslSessions);
 
         set(setup.ipLimit, "ip_limit", section);
         if (setup.ipLimit < 0)
             Throw<std::runtime_error>("Configured IP limit is invalid");
 
+        set(setup.decodeOffloadBytes, "decode_offload_bytes", section);
+
         std::string ip;
         set(ip, "public_ip", section);
         if (!ip.empty())
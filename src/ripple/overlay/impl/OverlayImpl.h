@@ -22,6 +22,7 @@
 
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/Resolver.h>
+#include <ripple/basics/TaggedCache.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/core/Job.h>
@@ -48,6 +49,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace ripple {
 
@@ -110,13 +112,28 @@ private:
     TrafficCount m_traffic;
     hash_map<std::shared_ptr<PeerFinder::Slot>, std::weak_ptr<PeerImp>> m_peers;
     hash_map<Peer::id_t, std::weak_ptr<PeerImp>> ids_;
+
+    // Immutable copy of the active peers in ids_, replaced under mutex_
+    // whenever ids_ changes and read without taking the lock.
+    using PeerSnapshot = std::vector<std::weak_ptr<PeerImp>>;
+    std::shared_ptr<PeerSnapshot const> peers_ =
+        std::make_shared<PeerSnapshot const>();
+
     Resolver& m_resolver;
+    // Serialized TMLedgerData replies, see ledgerDataCache()
+    TaggedCache<uint256, Message> ledgerDataCache_;
     std::atomic<Peer::id_t> next_id_;
     int timer_count_;
     std::atomic<uint64_t> jqTransOverflow_{0};
     std::atomic<uint64_t> peerDisconnects_{0};
     std::atomic<uint64_t> peerDisconnectsCharges_{0};
 
+    // Transaction reduce-relay: messages sent, messages not sent to peers
+    // left out of the selection, and the bytes that saved
+    std::atomic<uint64_t> txRelayed_{0};
+    std::atomic<uint64_t> txRelaySkipped_{0};
+    std::atomic<uint64_t> txRelayBytesSaved_{0};
+
     // Last time we crawled peers for shard info. 'cs' = crawl shards
     std::atomic<std::chrono::seconds> csLast_{std::chrono::seconds{0}};
     std::mutex csMutex_;
@@ -226,6 +243,12 @@ public:
         uint256 const& uid,
         PublicKey const& validator) override;
 
+    void
+    relay(
+        protocol::TMTransaction& m,
+        std::set<Peer::id_t> const& toSkip,
+        bool local) override;
+
     std::shared_ptr<Message>
     getManifestsMessage();
 
@@ -252,6 +275,10 @@ public:
     void
     onPeerDeactivate(Peer::id_t id);
 
+    // Publishes a new snapshot of ids_. Must be called with mutex_ held.
+    void
+    updatePeerSnapshot();
+
     // UnaryFunc will be called as
     //  void(std::shared_ptr<PeerImp>&&)
     //
@@ -259,19 +286,11 @@ public:
     void
     for_each(UnaryFunc&& f) const
     {
-        std::vector<std::weak_ptr<PeerImp>> wp;
-        {
-            std::lock_guard lock(mutex_);
-
-            // Iterate over a copy of the peer list because peer
-            // destruction can invalidate iterators.
-            wp.reserve(ids_.size());
+        // The snapshot is never modified once published, so peers
+        // connecting or disconnecting during the walk cannot invalidate it.
+        auto const wp = std::atomic_load(&peers_);
 
-            for (auto& x : ids_)
-                wp.push_back(x.second);
-        }
-
-        for (auto& w : wp)
+        for (auto const& w : *wp)
         {
             if (auto p = w.lock())
                 f(std::move(p));
@@ -329,6 +348,28 @@ public:
     void
     reportTraffic(TrafficCount::category cat, bool isInbound, int bytes);
 
+    /** Report how long a message waited in a peer's send queue */
+    void
+    reportQueueTime(
+        TrafficCount::category cat,
+        std::chrono::microseconds elapsed);
+
+    /** Report how long a received message took to handle */
+    void
+    reportHandlerTime(
+        TrafficCount::category cat,
+        std::chrono::microseconds elapsed);
+
+    /** Recently sent TMLedgerData replies, keyed by a digest of the request.
+        Peers catching up tend to ask for the same ledger data at the same
+        time, and each of them can be sent the same serialized reply.
+    */
+    TaggedCache<uint256, Message>&
+    ledgerDataCache()
+    {
+        return ledgerDataCache_;
+    }
+
     void
     incJqTransOverflow() override
     {
@@ -555,12 +596,24 @@ private:
             , bytesOut(collector->make_gauge(name, "Bytes_Out"))
             , messagesIn(collector->make_gauge(name, "Messages_In"))
             , messagesOut(collector->make_gauge(name, "Messages_Out"))
+            , sizeP50(collector->make_gauge(name, "Size_P50"))
+            , sizeP99(collector->make_gauge(name, "Size_P99"))
+            , queuedP50(collector->make_gauge(name, "Queued_us_P50"))
+            , queuedP99(collector->make_gauge(name, "Queued_us_P99"))
+            , handlerP50(collector->make_gauge(name, "Handler_us_P50"))
+            , handlerP99(collector->make_gauge(name, "Handler_us_P99"))
         {
         }
         beast::insight::Gauge bytesIn;
         beast::insight::Gauge bytesOut;
         beast::insight::Gauge messagesIn;
         beast::insight::Gauge messagesOut;
+        beast::insight::Gauge sizeP50;
+        beast::insight::Gauge sizeP99;
+        beast::insight::Gauge queuedP50;
+        beast::insight::Gauge queuedP99;
+        beast::insight::Gauge handlerP50;
+        beast::insight::Gauge handlerP99;
     };
 
     struct Stats
@@ -590,15 +643,28 @@ private:
     collect_metrics()
     {
         auto counts = m_traffic.getCounts();
+        auto const& histograms = m_traffic.getHistograms();
         std::lock_guard lock(m_statsMutex);
         assert(counts.size() == m_stats.trafficGauges.size());
 
+        using Histogram = TrafficCount::Histogram;
         for (std::size_t i = 0; i < counts.size(); ++i)
         {
-            m_stats.trafficGauges[i].bytesIn = counts[i].bytesIn;
-            m_stats.trafficGauges[i].bytesOut = counts[i].bytesOut;
-            m_stats.trafficGauges[i].messagesIn = counts[i].messagesIn;
-            m_stats.trafficGauges[i].messagesOut = counts[i].messagesOut;
+            auto& gauges = m_stats.trafficGauges[i];
+            gauges.bytesIn = counts[i].bytesIn;
+            gauges.bytesOut = counts[i].bytesOut;
+            gauges.messagesIn = counts[i].messagesIn;
+            gauges.messagesOut = counts[i].messagesOut;
+
+            auto const size = histograms[i].size.counts();
+            gauges.sizeP50 = Histogram::percentile(size, 50);
+            gauges.sizeP99 = Histogram::percentile(size, 99);
+            auto const queued = histograms[i].queued.counts();
+            gauges.queuedP50 = Histogram::percentile(queued, 50);
+            gauges.queuedP99 = Histogram::percentile(queued, 99);
+            auto const handler = histograms[i].handler.counts();
+            gauges.handlerP50 = Histogram::percentile(handler, 50);
+            gauges.handlerP99 = Histogram::percentile(handler, 99);
         }
         m_stats.peerDisconnects = getPeerDisconnect();
     }
@@ -21,9 +21,11 @@
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/InboundTransactions.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/StateTransfer.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SignatureCache.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/ValidatorList.h>
 #include <ripple/app/tx/apply.h>
@@ -36,9 +38,11 @@
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/overlay/Cluster.h>
 #include <ripple/overlay/impl/PeerImp.h>
+#include <ripple/overlay/impl/RelayBatch.h>
 #include <ripple/overlay/impl/Tuning.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/digest.h>
+#include <ripple/shamap/Family.h>
 
 #include <boost/algorithm/clamp.hpp>
 #include <boost/algorithm/string.hpp>
@@ -61,6 +65,58 @@ std::chrono::milliseconds constexpr peerHighLatency{300};
 
 /** How often we PING the peer to check for latency and sendq probe */
 std::chrono::seconds constexpr peerTimerInterval{60};
+
+/** Digest of everything a TMLedgerData reply to the request depends on, used
+    to find an identical reply in the ledger data cache */
+uint256
+ledgerDataKey(
+    protocol::TMGetLedger const& packet,
+    protocol::TMLedgerData const& reply,
+    SHAMapHash const& mapHash,
+    int depth)
+{
+    using beast::hash_append;
+    sha512_half_hasher h;
+    hash_append(
+        h,
+        reply.ledgerhash(),
+        reply.ledgerseq(),
+        static_cast<std::int32_t>(packet.itype()),
+        mapHash.as_uint256(),
+        depth);
+    if (packet.has_requestcookie())
+        hash_append(h, packet.requestcookie());
+    for (auto const& id : packet.nodeids())
+        hash_append(h, id);
+    return static_cast<sha512_half_hasher::result_type>(h);
+}
+
+/** Messages of these categories are sent ahead of ledger data, and ledger
+    data ahead of relayed transactions */
+bool
+isConsensusTraffic(TrafficCount::category cat)
+{
+    switch (cat)
+    {
+        case TrafficCount::category::base:
+        case TrafficCount::category::cluster:
+        case TrafficCount::category::overlay:
+        case TrafficCount::category::manifests:
+        case TrafficCount::category::proposal:
+        case TrafficCount::category::validation:
+        case TrafficCount::category::relay_batch:
+        case TrafficCount::category::validatorlist:
+        case TrafficCount::category::get_set:
+        case TrafficCount::category::share_set:
+        case TrafficCount::category::ld_tsc_get:
+        case TrafficCount::category::ld_tsc_share:
+        case TrafficCount::category::gl_tsc_share:
+        case TrafficCount::category::gl_tsc_get:
+            return true;
+        default:
+            return false;
+    }
+}
 }  // namespace
 
 PeerImp::PeerImp(
@@ -116,10 +172,31 @@ PeerImp::PeerImp(
           headers_,
           FEATURE_LEDGER_REPLAY,
           app_.config().LEDGER_REPLAY))
+    , txReconcileEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_TX_RECONCILE,
+          app_.config().TX_RECONCILE))
+    , relayBatchEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_RELAY_BATCH,
+          app_.config().RELAY_BATCH))
+    , stateTransferEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_STATE_TRANSFER,
+          app_.config().STATE_TRANSFER))
     , ledgerReplayMsgHandler_(app, app.getLedgerReplayer())
 {
+    if (compressionEnabled_ == Compressed::On &&
+        peerFeatureEnabled(
+            headers_, FEATURE_COMPR, "lz4s", app_.config().STREAM_COMPRESSION))
+    {
+        streamCompressor_ = std::make_unique<compression::StreamCompressor>();
+        streamDecompressor_ =
+            std::make_unique<compression::StreamDecompressor>();
+    }
     JLOG(journal_.debug()) << " compression enabled "
                            << (compressionEnabled_ == Compressed::On)
+                           << " stream " << (streamCompressor_ != nullptr)
                            << " vp reduce-relay enabled "
                            << vpReduceRelayEnabled_ << " on " << remote_address_
                            << " " << id_;
@@ -245,12 +322,33 @@ PeerImp::send(std::shared_ptr<Message> const& m)
     if (validator && !squelch_.expireSquelch(*validator))
         return;
 
+    auto const category = safe_cast<TrafficCount::category>(m->getCategory());
+    auto const lane = isConsensusTraffic(category)
+        ? laneConsensus
+        : (category == TrafficCount::category::transaction ? laneTransaction
+                                                           : laneLedger);
+
+    // Relayed transactions are the first to go when a peer falls behind
+    if (lane == laneTransaction &&
+        send_queue_[lane].size() >= Tuning::dropTransactionLane)
+        return;
+
+    // A stream compressed link compresses each message when it is written
     overlay_.reportTraffic(
-        safe_cast<TrafficCount::category>(m->getCategory()),
+        category,
         false,
-        static_cast<int>(m->getBuffer(compressionEnabled_).size()));
+        static_cast<int>(
+            m->getBuffer(streamCompressor_ ? Compressed::Off
+                                           : compressionEnabled_)
+                .size()));
+
+    if (category == TrafficCount::category::gl_get ||
+        category == TrafficCount::category::gl_tsc_get ||
+        category == TrafficCount::category::gl_txn_get ||
+        category == TrafficCount::category::gl_asn_get)
+        onLedgerRequest();
 
-    auto sendq_size = send_queue_.size();
+    auto sendq_size = sendQueueSize();
 
     if (sendq_size < Tuning::targetSendQueue)
     {
@@ -267,22 +365,12 @@ PeerImp::send(std::shared_ptr<Message> const& m)
              << " sendq: " << sendq_size;
     }
 
-    send_queue_.push(m);
+    send_queue_[lane].push_back({m, clock_type::now()});
 
     if (sendq_size != 0)
         return;
 
-    boost::asio::async_write(
-        stream_,
-        boost::asio::buffer(
-            send_queue_.front()->getBuffer(compressionEnabled_)),
-        bind_executor(
-            strand_,
-            std::bind(
-                &PeerImp::onWriteMessage,
-                shared_from_this(),
-                std::placeholders::_1,
-                std::placeholders::_2)));
+    writeQueued();
 }
 
 void
@@ -361,6 +449,9 @@ PeerImp::json()
             ret[jss::latency] = static_cast<Json::UInt>(latency_->count());
     }
 
+    if (auto const rt = responseTime())
+        ret[jss::response_time] = static_cast<Json::UInt>(rt->count());
+
     ret[jss::uptime] = static_cast<Json::UInt>(
         std::chrono::duration_cast<std::chrono::seconds>(uptime()).count());
 
@@ -436,6 +527,25 @@ PeerImp::json()
         std::to_string(metrics_.recv.average_bytes());
     ret[jss::metrics][jss::avg_bps_sent] =
         std::to_string(metrics_.sent.average_bytes());
+    if (auto const writes = writes_.load(); writes != 0)
+        ret[jss::metrics][jss::avg_msgs_per_write] =
+            static_cast<double>(messagesWritten_.load()) / writes;
+    if (streamCompressor_)
+    {
+        auto ratio = [](std::uint64_t in, std::uint64_t out) {
+            return out == 0 ? 0.0 : static_cast<double>(in) / out;
+        };
+        auto& sc = ret[jss::metrics][jss::stream_compression] =
+            Json::objectValue;
+        sc[jss::compress_ratio_sent] = ratio(
+            streamCompressor_->bytesIn(), streamCompressor_->bytesOut());
+        sc[jss::compress_ratio_recv] = ratio(
+            streamDecompressor_->bytesOut(), streamDecompressor_->bytesIn());
+        sc[jss::compress_us] =
+            std::to_string(streamCompressor_->elapsed().count());
+        sc[jss::decompress_us] =
+            std::to_string(streamDecompressor_->elapsed().count());
+    }
 
     return ret;
 }
@@ -451,6 +561,10 @@ PeerImp::supportsFeature(ProtocolFeature f) const
             return protocol_ >= make_protocol(2, 2);
         case ProtocolFeature::LedgerReplay:
             return ledgerReplayEnabled_;
+        case ProtocolFeature::TxReconcile:
+            return txReconcileEnabled_;
+        case ProtocolFeature::StateTransfer:
+            return stateTransferEnabled_;
     }
     return false;
 }
@@ -606,7 +720,7 @@ PeerImp::gracefulClose()
     while(send_queue_.size() > 1)
         send_queue_.pop_back();
 #endif
-    if (send_queue_.size() > 0)
+    if (sendQueueSize() > 0)
         return;
     setTimer();
     stream_.async_shutdown(bind_executor(
@@ -909,6 +1023,126 @@ PeerImp::onReadMessage(error_code ec, std::size_t bytes_transferred)
                 std::placeholders::_2)));
 }
 
+std::size_t
+PeerImp::sendQueueSize() const
+{
+    std::size_t size = writing_.size();
+    for (auto const& lane : send_queue_)
+        size += lane.size();
+    return size;
+}
+
+PeerImp::SendLane
+PeerImp::nextLane()
+{
+    // Weighted round robin: each lane gets its weight in messages per
+    // round, higher priority lanes first
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int i = 0; i < numLanes; ++i)
+        {
+            if (!send_queue_[i].empty() && laneCredits_[i] != 0)
+                return static_cast<SendLane>(i);
+        }
+
+        laneCredits_ = {
+            Tuning::consensusLaneWeight,
+            Tuning::ledgerLaneWeight,
+            Tuning::transactionLaneWeight};
+    }
+    return numLanes;
+}
+
+void
+PeerImp::writeQueued()
+{
+    assert(writing_.empty());
+
+    // Gather queued messages, always at least one, so that a burst of
+    // small messages goes out in a single write
+    writeBuffers_.clear();
+    std::size_t bytes = 0;
+    auto const now = clock_type::now();
+    for (auto lane = nextLane(); lane != numLanes; lane = nextLane())
+    {
+        if (lane != laneLedger && relayBatchEnabled_)
+            batchLane(lane);
+        auto const& [m, queued] = send_queue_[lane].front();
+        auto const& buffer = m->getBuffer(
+            streamCompressor_ ? Compressed::Off : compressionEnabled_);
+        if (!writing_.empty() &&
+            (writing_.size() == Tuning::writeCoalesceMessages ||
+             bytes + buffer.size() > Tuning::writeCoalesceBytes))
+            break;
+        if (streamCompressor_)
+        {
+            // Messages must be compressed in the order they are written
+            if (streamBuffers_.size() == writing_.size())
+                streamBuffers_.emplace_back();
+            auto& out = streamBuffers_[writing_.size()];
+            streamCompressor_->compress(makeSlice(buffer), out);
+            writeBuffers_.emplace_back(boost::asio::buffer(out));
+        }
+        else
+            writeBuffers_.emplace_back(boost::asio::buffer(buffer));
+        bytes += buffer.size();
+        overlay_.reportQueueTime(
+            safe_cast<TrafficCount::category>(m->getCategory()),
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                now - queued));
+        writing_.push_back(m);
+        send_queue_[lane].pop_front();
+        --laneCredits_[lane];
+    }
+    assert(!writing_.empty());
+
+    ++writes_;
+    messagesWritten_ += writing_.size();
+
+    boost::asio::async_write(
+        stream_,
+        writeBuffers_,
+        bind_executor(
+            strand_,
+            std::bind(
+                &PeerImp::onWriteMessage,
+                shared_from_this(),
+                std::placeholders::_1,
+                std::placeholders::_2)));
+}
+
+void
+PeerImp::batchLane(SendLane lane)
+{
+    assert(lane == laneConsensus || lane == laneTransaction);
+    auto const consensus = lane == laneConsensus;
+    auto const limit = consensus ? Tuning::relayBatchMessages
+                                 : Tuning::transactionBatchMessages;
+    auto const batchable =
+        consensus ? isRelayBatchable : isTransactionBatchable;
+
+    // Only messages that queued up while an earlier write was in progress
+    // are here, so batching them never holds one back
+    auto& queue = send_queue_[lane];
+    std::size_t n = 0;
+    while (n < queue.size() && n < limit && batchable(*queue[n].message))
+        ++n;
+    if (n < 2)
+        return;
+
+    auto const queued = queue.front().time;
+    std::vector<std::shared_ptr<Message>> messages;
+    messages.reserve(n);
+    for (; n != 0; --n)
+    {
+        messages.push_back(std::move(queue.front().message));
+        queue.pop_front();
+    }
+    queue.push_front(
+        {consensus ? makeRelayBatch(messages) : makeTransactionBatch(messages),
+         queued});
+}
+
 void
 PeerImp::onWriteMessage(error_code ec, std::size_t bytes_transferred)
 {
@@ -928,22 +1162,12 @@ PeerImp::onWriteMessage(error_code ec, std::size_t bytes_transferred)
 
     metrics_.sent.add_message(bytes_transferred);
 
-    assert(!send_queue_.empty());
-    send_queue_.pop();
-    if (!send_queue_.empty())
+    assert(!writing_.empty());
+    writing_.clear();
+    if (sendQueueSize() != 0)
     {
         // Timeout on writes only
-        return boost::asio::async_write(
-            stream_,
-            boost::asio::buffer(
-                send_queue_.front()->getBuffer(compressionEnabled_)),
-            bind_executor(
-                strand_,
-                std::bind(
-                    &PeerImp::onWriteMessage,
-                    shared_from_this(),
-                    std::placeholders::_1,
-                    std::placeholders::_2)));
+        return writeQueued();
     }
 
     if (gracefulClose_)
@@ -963,6 +1187,66 @@ PeerImp::onWriteMessage(error_code ec, std::size_t bytes_transferred)
 //
 //------------------------------------------------------------------------------
 
+bool
+PeerImp::deferDecode(std::uint16_t type, std::size_t size) const
+{
+    auto const threshold = overlay_.setup().decodeOffloadBytes;
+    if (threshold == 0 || size < threshold)
+        return false;
+    return type == protocol::mtLEDGER_DATA || type == protocol::mtGET_OBJECTS;
+}
+
+void
+PeerImp::onDeferredMessage(
+    detail::MessageHeader const& header,
+    std::vector<std::uint8_t>&& payload)
+{
+    auto h = header;
+    // The payload was copied out of the stream window
+    h.stream_payload = nullptr;
+
+    std::weak_ptr<PeerImp> weak = shared_from_this();
+    app_.getJobQueue().addJob(
+        jtPEER_DECODE,
+        "decodePeerMessage",
+        [weak, h, payload = std::move(payload)](Job&) {
+            auto peer = weak.lock();
+            if (!peer)
+                return;
+            if (h.message_type == protocol::mtLEDGER_DATA)
+                peer->decodeDeferred<protocol::TMLedgerData>(h, payload);
+            else
+                peer->decodeDeferred<protocol::TMGetObjectByHash>(h, payload);
+        });
+}
+
+template <class T>
+void
+PeerImp::decodeDeferred(
+    detail::MessageHeader const& header,
+    std::vector<std::uint8_t> const& payload)
+{
+    auto const m = detail::parsePayload<T>(header, payload);
+
+    post(strand_, [self = shared_from_this(), header, m]() {
+        if (!self->socket_.is_open() || self->gracefulClose_)
+            return;
+        if (!m)
+            return self->fail(
+                "onDeferredMessage",
+                make_error_code(boost::system::errc::bad_message));
+
+        self->onMessageBegin(
+            header.message_type,
+            m,
+            header.payload_wire_size,
+            header.uncompressed_size,
+            header.algorithm != compression::Algorithm::None);
+        self->onMessage(m);
+        self->onMessageEnd(header.message_type, m);
+    });
+}
+
 void
 PeerImp::onMessageUnknown(std::uint16_t type)
 {
@@ -980,8 +1264,9 @@ PeerImp::onMessageBegin(
     load_event_ =
         app_.getJobQueue().makeLoadEvent(jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
-    overlay_.reportTraffic(
-        TrafficCount::categorize(*m, type, true), true, static_cast<int>(size));
+    handlerCategory_ = TrafficCount::categorize(*m, type, true);
+    handlerStart_ = clock_type::now();
+    overlay_.reportTraffic(handlerCategory_, true, static_cast<int>(size));
     JLOG(journal_.trace()) << "onMessageBegin: " << type << " " << size << " "
                            << uncompressed_size << " " << isCompressed;
 }
@@ -991,6 +1276,11 @@ PeerImp::onMessageEnd(
     std::uint16_t,
     std::shared_ptr<::google::protobuf::Message> const&)
 {
+    // Work the handler hands off to the job queue isn't included
+    overlay_.reportHandlerTime(
+        handlerCategory_,
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            clock_type::now() - handlerStart_));
     load_event_.reset();
     charge(fee_);
 }
@@ -1430,7 +1720,13 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMTransaction> const& m)
                 flags |= SF_TRUSTED;
             }
 
-            if (app_.getValidationPublicKey().empty())
+            if (m->has_verified() && m->verified())
+            {
+                // The member checked the signature, so only the local
+                // checks remain. Validators still check it themselves.
+                acceptVouchedSignature(app_, txID);
+            }
+            else if (app_.getValidationPublicKey().empty())
             {
                 // For now, be paranoid and have each validator
                 // check each transaction, regardless of source
@@ -1451,7 +1747,7 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMTransaction> const& m)
         }
         else
         {
-            app_.getJobQueue().addJob(
+            addBatchedJob(
                 jtTRANSACTION,
                 "recvTransaction->checkTransaction",
                 [weak = std::weak_ptr<PeerImp>(shared_from_this()),
@@ -1579,11 +1875,139 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMReplayDeltaResponse> const& m)
     }
 }
 
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMReconcileTxSet> const& m)
+{
+    JLOG(p_journal_.trace()) << "onMessage, TMReconcileTxSet";
+    if (!txReconcileEnabled_)
+    {
+        charge(Resource::feeInvalidRequest);
+        return;
+    }
+
+    fee_ = Resource::feeMediumBurdenPeer;
+    std::weak_ptr<PeerImp> weak = shared_from_this();
+    app_.getJobQueue().addJob(
+        jtTXN_DATA, "recvReconcileTxSet", [weak, m](Job&) {
+            if (auto peer = weak.lock())
+            {
+                auto& inbound = peer->app_.getInboundTransactions();
+                auto reply = inbound.processReconcileRequest(*m);
+                if (reply.has_error() &&
+                    reply.error() == protocol::TMReplyError::reBAD_REQUEST)
+                    peer->charge(Resource::feeInvalidRequest);
+
+                // Answer even when the sets can't be reconciled, so the peer
+                // can fetch the set instead without waiting
+                peer->send(std::make_shared<Message>(
+                    reply, protocol::mtRECONCILE_TXSET_RESPONSE));
+            }
+        });
+}
+
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMReconcileTxSetResponse> const& m)
+{
+    if (!txReconcileEnabled_)
+    {
+        charge(Resource::feeInvalidRequest);
+        return;
+    }
+
+    if (!stringIsUint256Sized(m->txsethash()))
+    {
+        charge(Resource::feeInvalidRequest);
+        return;
+    }
+
+    uint256 const hash{m->txsethash()};
+    std::weak_ptr<PeerImp> weak = shared_from_this();
+    app_.getJobQueue().addJob(
+        jtTXN_DATA, "recvReconcileTxSetResponse", [weak, hash, m](Job&) {
+            if (auto peer = weak.lock())
+                peer->app_.getInboundTransactions().gotReconcile(
+                    hash, peer, m);
+        });
+}
+
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMGetStateRange> const& m)
+{
+    JLOG(p_journal_.trace()) << "onMessage, TMGetStateRange";
+    if (!stateTransferEnabled_)
+    {
+        charge(Resource::feeInvalidRequest);
+        return;
+    }
+
+    fee_ = Resource::feeMediumBurdenPeer;
+    std::weak_ptr<PeerImp> weak = shared_from_this();
+    app_.getJobQueue().addJob(
+        jtLEDGER_REQ, "recvGetStateRange", [weak, m](Job&) {
+            auto peer = weak.lock();
+            if (!peer)
+                return;
+
+            std::shared_ptr<Ledger const> ledger;
+            if (stringIsUint256Sized(m->ledgerhash()))
+                ledger = peer->app_.getLedgerMaster().getLedgerByHash(
+                    uint256{m->ledgerhash()});
+
+            protocol::TMStateRange reply;
+            try
+            {
+                reply = StateTransfer::makeReply(
+                    ledger ? &ledger->stateMap() : nullptr, *m);
+            }
+            catch (SHAMapMissingNode const& e)
+            {
+                JLOG(peer->p_journal_.debug())
+                    << "GetStateRange: " << e.what();
+                reply.Clear();
+                reply.set_ledgerhash(m->ledgerhash());
+                reply.set_marker(m->marker());
+                reply.set_error(protocol::TMReplyError::reNO_NODE);
+            }
+
+            if (reply.has_error() &&
+                reply.error() == protocol::TMReplyError::reBAD_REQUEST)
+                peer->charge(Resource::feeInvalidRequest);
+
+            // Answer even without the ledger, so the peer asks another
+            peer->send(
+                std::make_shared<Message>(reply, protocol::mtSTATE_RANGE));
+        });
+}
+
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMStateRange> const& m)
+{
+    if (!stateTransferEnabled_ || !stringIsUint256Sized(m->ledgerhash()))
+    {
+        charge(Resource::feeInvalidRequest);
+        return;
+    }
+
+    uint256 const hash{m->ledgerhash()};
+    std::weak_ptr<PeerImp> weak = shared_from_this();
+    app_.getJobQueue().addJob(
+        jtLEDGER_DATA, "recvStateRange", [weak, hash, m](Job&) {
+            if (auto peer = weak.lock())
+            {
+                if (auto inbound = peer->app_.getInboundLedgers().find(hash))
+                    inbound->gotStateRange(peer, *m);
+            }
+        });
+}
+
 void
 PeerImp::onMessage(std::shared_ptr<protocol::TMLedgerData> const& m)
 {
     protocol::TMLedgerData& packet = *m;
 
+    if (!m->has_requestcookie())
+        onLedgerResponse();
+
     if (m->nodes().size() <= 0)
     {
         JLOG(p_journal_.warn()) << "Ledger/TXset data with no nodes";
@@ -1723,7 +2147,7 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMProposeSet> const& m)
             calcNodeID(app_.validatorManifests().getMasterKey(publicKey))});
 
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob(
+    addBatchedJob(
         isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut,
         "recvPropose->checkPropose",
         [weak, m, proposal](Job& job) {
@@ -2009,6 +2433,26 @@ PeerImp::onValidatorListMessage(
         return;
     }
 
+    // Verifying the lists takes a while, so it is not done on the strand
+    std::weak_ptr<PeerImp> weak = shared_from_this();
+    app_.getJobQueue().addJob(
+        jtVALIDATION_ut,
+        "receiveValidatorList",
+        [weak, messageType, manifest, version, blobs, hash](Job&) {
+            if (auto peer = weak.lock())
+                peer->applyValidatorList(
+                    messageType, manifest, version, blobs, hash);
+        });
+}
+
+void
+PeerImp::applyValidatorList(
+    std::string const& messageType,
+    std::string const& manifest,
+    std::uint32_t version,
+    std::vector<ValidatorBlobInfo> const& blobs,
+    uint256 const& hash)
+{
     auto const applyResult = app_.validators().applyListsAndBroadcast(
         manifest,
         version,
@@ -2084,27 +2528,27 @@ PeerImp::onValidatorListMessage(
             // Charging this fee here won't hurt the peer in the normal
             // course of operation (ie. refresh every 5 minutes), but
             // will add up if the peer is misbehaving.
-            fee_ = Resource::feeUnwantedData;
+            charge(Resource::feeUnwantedData);
             break;
         case ListDisposition::stale:
             // There are very few good reasons for a peer to send an
             // old list, particularly more than once.
-            fee_ = Resource::feeBadData;
+            charge(Resource::feeBadData);
             break;
         case ListDisposition::untrusted:
             // Charging this fee here won't hurt the peer in the normal
             // course of operation (ie. refresh every 5 minutes), but
             // will add up if the peer is misbehaving.
-            fee_ = Resource::feeUnwantedData;
+            charge(Resource::feeUnwantedData);
             break;
         case ListDisposition::invalid:
             // This shouldn't ever happen with a well-behaved peer
-            fee_ = Resource::feeInvalidSignature;
+            charge(Resource::feeInvalidSignature);
             break;
         case ListDisposition::unsupported_version:
             // During a version transition, this may be legitimate.
             // If it happens frequently, that's probably bad.
-            fee_ = Resource::feeBadData;
+            charge(Resource::feeBadData);
             break;
         default:
             assert(false);
@@ -2303,7 +2747,7 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMValidation> const& m)
         if (isTrusted || cluster() || !app_.getFeeTrack().isLoadedLocal())
         {
             std::weak_ptr<PeerImp> weak = shared_from_this();
-            app_.getJobQueue().addJob(
+            addBatchedJob(
                 isTrusted ? jtVALIDATION_t : jtVALIDATION_ut,
                 "recvValidation->checkValidation",
                 [weak, val, m](Job&) {
@@ -2324,6 +2768,117 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMValidation> const& m)
     }
 }
 
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMRelayBatch> const& m)
+{
+    if (!relayBatchEnabled_ ||
+        m->proposals_size() + m->validations_size() >
+            static_cast<int>(Tuning::relayBatchMessages))
+    {
+        JLOG(p_journal_.warn()) << "RelayBatch: unexpected";
+        fee_ = Resource::feeInvalidRequest;
+        return;
+    }
+
+    auto parse = [this](auto packet, std::string const& data) {
+        return [this, packet, &data]() {
+            if (packet->ParseFromString(data))
+                onMessage(packet);
+            else
+                fee_ = Resource::feeInvalidRequest;
+        };
+    };
+
+    std::vector<std::function<void()>> entries;
+    entries.reserve(m->proposals_size() + m->validations_size());
+    for (auto const& data : m->proposals())
+        entries.push_back(
+            parse(std::make_shared<protocol::TMProposeSet>(), data));
+    for (auto const& data : m->validations())
+        entries.push_back(
+            parse(std::make_shared<protocol::TMValidation>(), data));
+    onBatch(entries, "recvRelayBatch");
+}
+
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMTransactions> const& m)
+{
+    if (!relayBatchEnabled_ ||
+        m->transactions_size() >
+            static_cast<int>(Tuning::transactionBatchMessages))
+    {
+        JLOG(p_journal_.warn()) << "Transactions: unexpected";
+        fee_ = Resource::feeInvalidRequest;
+        return;
+    }
+
+    std::vector<std::function<void()>> entries;
+    entries.reserve(m->transactions_size());
+    for (auto& tx : *m->mutable_transactions())
+    {
+        entries.push_back([this, &tx]() {
+            onMessage(std::make_shared<protocol::TMTransaction>(std::move(tx)));
+        });
+    }
+    onBatch(entries, "recvTransactions");
+}
+
+void
+PeerImp::onBatch(
+    std::vector<std::function<void()>> const& entries,
+    std::string const& name)
+{
+    // Each entry is handled as if it had arrived on its own, and the batch
+    // is charged the sum of the fees they incurred, labelled with the most
+    // expensive one
+    BatchedWork work;
+    batchedWork_ = &work;
+    auto fee = fee_;
+    Resource::Charge::value_type cost = 0;
+    for (auto const& entry : entries)
+    {
+        fee_ = Resource::feeLightPeer;
+        try
+        {
+            entry();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(p_journal_.warn())
+                << "Exception processing " << name << ": " << e.what();
+            fee_ = Resource::feeInvalidRequest;
+        }
+        cost += fee_.cost();
+        if (fee_.cost() > fee.cost())
+            fee = fee_;
+    }
+    batchedWork_ = nullptr;
+    fee_ = entries.empty() ? fee : Resource::Charge(cost, fee.label());
+
+    // The checks the entries hand off run as one job per job type
+    std::stable_sort(
+        work.begin(), work.end(), [](auto const& a, auto const& b) {
+            return a.first < b.first;
+        });
+    for (auto first = work.begin(); first != work.end();)
+    {
+        auto const type = first->first;
+        auto const last =
+            std::find_if(first, work.end(), [type](auto const& w) {
+                return w.first != type;
+            });
+        std::vector<std::function<void(Job&)>> handlers;
+        handlers.reserve(std::distance(first, last));
+        for (; first != last; ++first)
+            handlers.push_back(std::move(first->second));
+        app_.getJobQueue().addJob(
+            type, name, [handlers = std::move(handlers)](Job& job) {
+                for (auto const& handler : handlers)
+                    handler(job);
+            });
+    }
+}
+
 void
 PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
 {
@@ -2332,7 +2887,7 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
     if (packet.query())
     {
         // this is a query
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        if (send_queue_[laneLedger].size() >= Tuning::dropSendQueue)
         {
             JLOG(p_journal_.debug()) << "GetObject: Large send queue";
             return;
@@ -2379,18 +2934,17 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
                 auto nodeObject{app_.getNodeStore().fetchNodeObject(hash, seq)};
                 if (!nodeObject)
                 {
+                    // Without a ledger sequence, the shard store searches
+                    // the shards that may hold the object
                     if (auto shardStore = app_.getShardStore())
-                    {
-                        if (seq >= shardStore->earliestLedgerSeq())
-                            nodeObject = shardStore->fetchNodeObject(hash, seq);
-                    }
+                        nodeObject = shardStore->fetchNodeObject(hash, seq);
                 }
                 if (nodeObject)
                 {
                     protocol::TMIndexedObject& newObj = *reply.add_objects();
                     newObj.set_hash(hash.begin(), hash.size());
                     newObj.set_data(
-                        &nodeObject->getData().front(),
+                        nodeObject->getData().data(),
                         nodeObject->getData().size());
 
                     if (obj.has_nodeid())
@@ -2414,12 +2968,22 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
         bool pLDo = true;
         bool progress = false;
 
+        // Nodes missing from ledgers we have are fetched by hash
+        bool const nodes =
+            packet.type() == protocol::TMGetObjectByHash::otSTATE_NODE ||
+            packet.type() == protocol::TMGetObjectByHash::otTRANSACTION_NODE;
+
         for (int i = 0; i < packet.objects_size(); ++i)
         {
             const protocol::TMIndexedObject& obj = packet.objects(i);
 
             if (obj.has_hash() && stringIsUint256Sized(obj.hash()))
             {
+                if (nodes &&
+                    app_.getNodeFamily().foundNode(
+                        uint256{obj.hash()}, makeSlice(obj.data())))
+                    continue;
+
                 if (obj.has_ledgerseq())
                 {
                     if (obj.ledgerseq() != pLSeq)
@@ -2446,10 +3010,16 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
                 {
                     uint256 const hash{obj.hash()};
 
-                    app_.getLedgerMaster().addFetchPack(
-                        hash,
-                        std::make_shared<Blob>(
-                            obj.data().begin(), obj.data().end()));
+                    if (!app_.getLedgerMaster().addFetchPack(
+                            hash,
+                            std::make_shared<Blob>(
+                                obj.data().begin(), obj.data().end())))
+                    {
+                        // Use what we have before taking more
+                        JLOG(p_journal_.debug())
+                            << "GetObj: Fetch pack cache full";
+                        break;
+                    }
                 }
             }
         }
@@ -2584,6 +3154,7 @@ PeerImp::checkTransaction(
             // Check the signature before handing off to the job queue.
             if (auto [valid, validReason] = checkValidity(
                     app_.getHashRouter(),
+                    app_.getSignatureCache(),
                     *stx,
                     app_.getLedgerMaster().getValidatedRules(),
                     app_.config());
@@ -2634,6 +3205,18 @@ PeerImp::checkTransaction(
 }
 
 // Called from our JobQueue
+void
+PeerImp::addBatchedJob(
+    JobType type,
+    std::string const& name,
+    std::function<void(Job&)> handler)
+{
+    if (batchedWork_)
+        batchedWork_->emplace_back(type, std::move(handler));
+    else
+        app_.getJobQueue().addJob(type, name, std::move(handler));
+}
+
 void
 PeerImp::checkPropose(
     Job& job,
@@ -2647,7 +3230,7 @@ PeerImp::checkPropose(
 
     assert(packet);
 
-    if (!cluster() && !peerPos.checkSign())
+    if (!cluster() && !peerPos.checkSign(app_.getSignatureCache()))
     {
         JLOG(p_journal_.warn()) << "Proposal fails sig check";
         charge(Resource::feeInvalidSignature);
@@ -2686,7 +3269,16 @@ PeerImp::checkValidation(
     try
     {
         // VFALCO Which functions throw?
-        if (!cluster() && !val->isValid())
+        auto const valid = [&] {
+            auto const signature = val->getSignature();
+            return app_.getSignatureCache().verify(
+                SignatureCache::key(
+                    val->getSigningHash(),
+                    val->getSignerPublic(),
+                    makeSlice(signature)),
+                [&] { return val->isValid(); });
+        };
+        if (!cluster() && !valid())
         {
             JLOG(p_journal_.warn()) << "Validation is invalid";
             charge(Resource::feeInvalidRequest);
@@ -2789,6 +3381,30 @@ PeerImp::getLedger(std::shared_ptr<protocol::TMGetLedger> const& m)
 
     std::string logMe;
 
+    // Peers catching up often ask for the same data at the same time, so
+    // replies are serialized once and shared
+    auto& cache = overlay_.ledgerDataCache();
+    auto sendCached = [&](uint256 const& key) {
+        auto const m = cache.fetch(key);
+        if (!m)
+            return false;
+        overlay_.reportTraffic(
+            TrafficCount::category::ld_cache_hit,
+            false,
+            static_cast<int>(m->getBufferSize()));
+        send(m);
+        return true;
+    };
+    auto sendAndCache = [&](uint256 const& key) {
+        auto m = std::make_shared<Message>(reply, protocol::mtLEDGER_DATA);
+        overlay_.reportTraffic(
+            TrafficCount::category::ld_cache_miss,
+            false,
+            static_cast<int>(m->getBufferSize()));
+        cache.canonicalize_replace_client(key, m);
+        send(m);
+    };
+
     if (packet.itype() == protocol::liTS_CANDIDATE)
     {
         // Request is for a transaction candidate set
@@ -2837,7 +3453,7 @@ PeerImp::getLedger(std::shared_ptr<protocol::TMGetLedger> const& m)
     }
     else
     {
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        if (send_queue_[laneLedger].size() >= Tuning::dropSendQueue)
         {
             JLOG(p_journal_.debug()) << "GetLedger: Large send queue";
             return;
@@ -2968,6 +3584,10 @@ PeerImp::getLedger(std::shared_ptr<protocol::TMGetLedger> const& m)
         {
             // they want the ledger base data
             JLOG(p_journal_.trace()) << "GetLedger: Base data";
+            auto const key = ledgerDataKey(packet, reply, SHAMapHash{}, 0);
+            if (sendCached(key))
+                return;
+
             Serializer nData(128);
             addRaw(ledger->info(), nData);
             reply.add_nodes()->set_nodedata(
@@ -2997,9 +3617,7 @@ PeerImp::getLedger(std::shared_ptr<protocol::TMGetLedger> const& m)
                 }
             }
 
-            auto oPacket =
-                std::make_shared<Message>(reply, protocol::mtLEDGER_DATA);
-            send(oPacket);
+            sendAndCache(key);
             return;
         }
 
@@ -3030,6 +3648,13 @@ PeerImp::getLedger(std::shared_ptr<protocol::TMGetLedger> const& m)
         ? (std::min(packet.querydepth(), 3u))
         : (isHighLatency() ? 2 : 1);
 
+    auto const key = ledgerDataKey(packet, reply, map->getHash(), depth);
+    if (sendCached(key))
+    {
+        JLOG(p_journal_.trace()) << "GetLedger: Cached reply " << logMe;
+        return;
+    }
+
     for (int i = 0;
          (i < packet.nodeids().size() &&
           (reply.nodes().size() < Tuning::maxReplyNodes));
@@ -3099,8 +3724,7 @@ PeerImp::getLedger(std::shared_ptr<protocol::TMGetLedger> const& m)
         << "Got request for " << packet.nodeids().size() << " nodes at depth "
         << depth << ", return " << reply.nodes().size() << " nodes";
 
-    auto oPacket = std::make_shared<Message>(reply, protocol::mtLEDGER_DATA);
-    send(oPacket);
+    sendAndCache(key);
 }
 
 int
@@ -3127,10 +3751,14 @@ PeerImp::getScore(bool haveItem) const
     if (haveItem)
         score += spHaveItem;
 
-    boost::optional<std::chrono::milliseconds> latency;
+    // How long the peer takes to answer a ledger data request, once it has
+    // answered some, says more than the ping time
+    auto latency = responseTime();
+    if (!latency)
     {
         std::lock_guard sl(recentLock_);
-        latency = latency_;
+        if (latency_)
+            latency = *latency_;
     }
 
     if (latency)
@@ -3141,6 +3769,58 @@ PeerImp::getScore(bool haveItem) const
     return score;
 }
 
+std::optional<std::chrono::milliseconds>
+PeerImp::responseTime() const
+{
+    std::lock_guard sl(recentLock_);
+
+    if (!responseTime_)
+        return std::nullopt;
+
+    // A request still unanswered counts once it is overdue
+    if (!ledgerRequests_.empty())
+    {
+        auto const waiting = std::min(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                clock_type::now() - ledgerRequests_.front()),
+            Tuning::maxLedgerResponseTime);
+        if (waiting > *responseTime_)
+            return waiting;
+    }
+
+    return *responseTime_;
+}
+
+void
+PeerImp::onLedgerRequest()
+{
+    std::lock_guard sl(recentLock_);
+    if (ledgerRequests_.size() >= Tuning::maxTrackedLedgerRequests)
+        ledgerRequests_.pop_front();
+    ledgerRequests_.push_back(clock_type::now());
+}
+
+void
+PeerImp::onLedgerResponse()
+{
+    std::lock_guard sl(recentLock_);
+
+    // Peers answer in order, so a reply is to the oldest request
+    if (ledgerRequests_.empty())
+        return;
+
+    auto const elapsed = std::min(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            clock_type::now() - ledgerRequests_.front()),
+        Tuning::maxLedgerResponseTime);
+    ledgerRequests_.pop_front();
+
+    if (responseTime_)
+        responseTime_ = (*responseTime_ * 7 + elapsed) / 8;
+    else
+        responseTime_ = elapsed;
+}
+
 bool
 PeerImp::isHighLatency() const
 {
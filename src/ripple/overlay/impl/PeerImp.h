@@ -39,8 +39,12 @@
 #include <boost/endian/conversion.hpp>
 #include <boost/optional.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <array>
+#include <atomic>
 #include <cstdint>
-#include <queue>
+#include <deque>
+#include <functional>
+#include <vector>
 
 namespace ripple {
 
@@ -117,6 +121,11 @@ private:
     boost::optional<std::chrono::milliseconds> latency_;
     boost::optional<std::uint32_t> lastPingSeq_;
     clock_type::time_point lastPingTime_;
+
+    // When we sent the ledger data requests the peer hasn't answered yet,
+    // oldest first, and the smoothed time until its answers arrived in full
+    std::deque<clock_type::time_point> ledgerRequests_;
+    boost::optional<std::chrono::milliseconds> responseTime_;
     clock_type::time_point const creationTime_;
 
     reduce_relay::Squelch<UptimeClock> squelch_;
@@ -141,6 +150,8 @@ private:
     // o recentTxSets_
     // o trackingTime_
     // o latency_
+    // o ledgerRequests_
+    // o responseTime_
     //
     // The following variables are being protected preemptively:
     //
@@ -158,10 +169,28 @@ private:
     http_request_type request_;
     http_response_type response_;
     boost::beast::http::fields const& headers_;
-    std::queue<std::shared_ptr<Message>> send_queue_;
+    // Outbound messages waiting to be written, one queue per priority,
+    // and the messages of the write in progress
+    enum SendLane { laneConsensus, laneLedger, laneTransaction, numLanes };
+    struct Queued
+    {
+        std::shared_ptr<Message> message;
+        clock_type::time_point time;
+    };
+    std::array<std::deque<Queued>, numLanes> send_queue_;
+    std::array<std::size_t, numLanes> laneCredits_{};
+    std::vector<std::shared_ptr<Message>> writing_;
+    std::vector<boost::asio::const_buffer> writeBuffers_;
+    // The stream compressed copies of the messages in writing_
+    std::vector<std::vector<std::uint8_t>> streamBuffers_;
+    std::atomic<std::uint64_t> writes_{0};
+    std::atomic<std::uint64_t> messagesWritten_{0};
     bool gracefulClose_ = false;
     int large_sendq_ = 0;
     std::unique_ptr<LoadEvent> load_event_;
+    // The message being handled and when its handler started
+    TrafficCount::category handlerCategory_ = TrafficCount::category::unknown;
+    clock_type::time_point handlerStart_;
     // The highest sequence of each PublisherList that has
     // been sent to or received from this peer.
     hash_map<PublicKey, std::size_t> publisherListSequences_;
@@ -170,10 +199,21 @@ private:
     hash_map<PublicKey, ShardInfo> shardInfo_;
 
     Compressed compressionEnabled_ = Compressed::Off;
+    // Set if the link is compressed as a stream, see StreamCompressor
+    std::unique_ptr<compression::StreamCompressor> streamCompressor_;
+    std::unique_ptr<compression::StreamDecompressor> streamDecompressor_;
     // true if validation/proposal reduce-relay feature is enabled
     // on the peer.
     bool vpReduceRelayEnabled_ = false;
     bool ledgerReplayEnabled_ = false;
+    bool txReconcileEnabled_ = false;
+    bool relayBatchEnabled_ = false;
+    bool stateTransferEnabled_ = false;
+    // While the entries of a batch are handled, the jobs their handlers
+    // add, posted once the whole batch has been checked
+    using BatchedWork =
+        std::vector<std::pair<JobType, std::function<void(Job&)>>>;
+    BatchedWork* batchedWork_ = nullptr;
     LedgerReplayMsgHandler ledgerReplayMsgHandler_;
 
     friend class OverlayImpl;
@@ -391,6 +431,9 @@ public:
     int
     getScore(bool haveItem) const override;
 
+    std::optional<std::chrono::milliseconds>
+    responseTime() const override;
+
     bool
     isHighLatency() const override;
 
@@ -411,6 +454,28 @@ public:
         return compressionEnabled_ == Compressed::On;
     }
 
+    /** The decompressor for the link, nullptr if it isn't stream compressed.
+     */
+    compression::StreamDecompressor*
+    streamDecompressor()
+    {
+        return streamDecompressor_.get();
+    }
+
+    /** Whether a message is parsed on the job queue instead of the strand.
+
+        See decode_offload_bytes in the [overlay] section.
+    */
+    bool
+    deferDecode(std::uint16_t type, std::size_t size) const;
+
+    /** Parse a message deferred by deferDecode, then handle it on the strand.
+     */
+    void
+    onDeferredMessage(
+        detail::MessageHeader const& header,
+        std::vector<std::uint8_t>&& payload);
+
 private:
     void
     close();
@@ -462,6 +527,25 @@ private:
     void
     onReadMessage(error_code ec, std::size_t bytes_transferred);
 
+    // The number of outbound messages queued or being written
+    std::size_t
+    sendQueueSize() const;
+
+    // Pick the lane to take the next outbound message from, or numLanes
+    // if all are empty
+    SendLane
+    nextLane();
+
+    // Write as many queued messages as fit in one scatter/gather write
+    void
+    writeQueued();
+
+    // Replace a run of proposals and validations at the front of the
+    // consensus lane with a single TMRelayBatch, or a run of transactions
+    // at the front of the transaction lane with a single TMTransactions
+    void
+    batchLane(SendLane lane);
+
     // Called when protocol messages bytes are sent
     void
     onWriteMessage(error_code ec, std::size_t bytes_transferred);
@@ -478,6 +562,20 @@ public:
     //
     //--------------------------------------------------------------------------
 
+    /** Record that we asked the peer for ledger data, or that it replied.
+     */
+    void
+    onLedgerRequest();
+
+    void
+    onLedgerResponse();
+
+    template <class T>
+    void
+    decodeDeferred(
+        detail::MessageHeader const& header,
+        std::vector<std::uint8_t> const& payload);
+
     void
     onMessageUnknown(std::uint16_t type);
 
@@ -540,6 +638,18 @@ public:
     onMessage(std::shared_ptr<protocol::TMReplayDeltaRequest> const& m);
     void
     onMessage(std::shared_ptr<protocol::TMReplayDeltaResponse> const& m);
+    void
+    onMessage(std::shared_ptr<protocol::TMReconcileTxSet> const& m);
+    void
+    onMessage(std::shared_ptr<protocol::TMReconcileTxSetResponse> const& m);
+    void
+    onMessage(std::shared_ptr<protocol::TMGetStateRange> const& m);
+    void
+    onMessage(std::shared_ptr<protocol::TMStateRange> const& m);
+    void
+    onMessage(std::shared_ptr<protocol::TMRelayBatch> const& m);
+    void
+    onMessage(std::shared_ptr<protocol::TMTransactions> const& m);
 
 private:
     //--------------------------------------------------------------------------
@@ -560,12 +670,33 @@ private:
         std::uint32_t version,
         std::vector<ValidatorBlobInfo> const& blobs);
 
+    void
+    applyValidatorList(
+        std::string const& messageType,
+        std::string const& manifest,
+        std::uint32_t version,
+        std::vector<ValidatorBlobInfo> const& blobs,
+        uint256 const& hash);
+
     void
     checkTransaction(
         int flags,
         bool checkSignature,
         std::shared_ptr<STTx const> const& stx);
 
+    // Handle the entries of a batch, posting the jobs they add together
+    void
+    onBatch(
+        std::vector<std::function<void()>> const& entries,
+        std::string const& name);
+
+    // Add the job, or defer it while a batch is being handled
+    void
+    addBatchedJob(
+        JobType type,
+        std::string const& name,
+        std::function<void(Job&)> handler);
+
     void
     checkPropose(
         Job& job,
@@ -638,12 +769,33 @@ PeerImp::PeerImp(
           headers_,
           FEATURE_LEDGER_REPLAY,
           app_.config().LEDGER_REPLAY))
+    , txReconcileEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_TX_RECONCILE,
+          app_.config().TX_RECONCILE))
+    , relayBatchEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_RELAY_BATCH,
+          app_.config().RELAY_BATCH))
+    , stateTransferEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_STATE_TRANSFER,
+          app_.config().STATE_TRANSFER))
     , ledgerReplayMsgHandler_(app, app.getLedgerReplayer())
 {
     read_buffer_.commit(boost::asio::buffer_copy(
         read_buffer_.prepare(boost::asio::buffer_size(buffers)), buffers));
+    if (compressionEnabled_ == Compressed::On &&
+        peerFeatureEnabled(
+            headers_, FEATURE_COMPR, "lz4s", app_.config().STREAM_COMPRESSION))
+    {
+        streamCompressor_ = std::make_unique<compression::StreamCompressor>();
+        streamDecompressor_ =
+            std::make_unique<compression::StreamDecompressor>();
+    }
     JLOG(journal_.debug()) << "compression enabled "
                            << (compressionEnabled_ == Compressed::On)
+                           << " stream " << (streamCompressor_ != nullptr)
                            << " vp reduce-relay enabled "
                            << vpReduceRelayEnabled_ << " on " << remote_address_
                            << " " << id_;
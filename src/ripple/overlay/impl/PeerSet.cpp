@@ -21,6 +21,7 @@
 #include <ripple/core/JobQueue.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/PeerSet.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -183,6 +184,40 @@ private:
     beast::Journal j_;
 };
 
+std::vector<std::shared_ptr<Peer>>
+getFastestPeers(Overlay& overlay, PeerSet const& set, std::size_t limit)
+{
+    using TimedPeer =
+        std::pair<std::chrono::milliseconds, std::shared_ptr<Peer>>;
+
+    std::vector<TimedPeer> timed;
+    for (auto const id : set.getPeerIds())
+    {
+        if (auto peer = overlay.findPeerByShortID(id))
+        {
+            if (auto const rt = peer->responseTime())
+                timed.emplace_back(*rt, std::move(peer));
+        }
+    }
+
+    std::sort(
+        timed.begin(),
+        timed.end(),
+        [](TimedPeer const& lhs, TimedPeer const& rhs) {
+            return lhs.first < rhs.first;
+        });
+
+    std::vector<std::shared_ptr<Peer>> ret;
+    ret.reserve(std::min(limit, timed.size()));
+    for (auto& tp : timed)
+    {
+        if (ret.size() >= limit)
+            break;
+        ret.push_back(std::move(tp.second));
+    }
+    return ret;
+}
+
 std::unique_ptr<PeerSet>
 make_DummyPeerSet(Application& app)
 {
@@ -23,13 +23,16 @@
 #include <ripple/basics/ByteUtilities.h>
 #include <ripple/overlay/Compression.h>
 #include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/StreamCompression.h>
 #include <ripple/overlay/impl/ZeroCopyStream.h>
 #include <ripple/protocol/messages.h>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/buffers_iterator.hpp>
 #include <boost/system/error_code.hpp>
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <exception>
 #include <memory>
 #include <optional>
 #include <ripple.pb.h>
@@ -56,6 +59,30 @@ protocolMessageType(protocol::TMProofPathRequest const&)
     return protocol::mtPROOF_PATH_REQ;
 }
 
+inline protocol::MessageType
+protocolMessageType(protocol::TMReconcileTxSet const&)
+{
+    return protocol::mtRECONCILE_TXSET_REQ;
+}
+
+inline protocol::MessageType
+protocolMessageType(protocol::TMGetStateRange const&)
+{
+    return protocol::mtGET_STATE_RANGE;
+}
+
+inline protocol::MessageType
+protocolMessageType(protocol::TMRelayBatch const&)
+{
+    return protocol::mtRELAY_BATCH;
+}
+
+inline protocol::MessageType
+protocolMessageType(protocol::TMTransactions const&)
+{
+    return protocol::mtTRANSACTIONS;
+}
+
 /** Returns the name of a protocol message given its type. */
 template <class = void>
 std::string
@@ -109,6 +136,18 @@ protocolMessageName(int type)
             return "replay_delta_request";
         case protocol::mtREPLAY_DELTA_RESPONSE:
             return "replay_delta_response";
+        case protocol::mtRECONCILE_TXSET_REQ:
+            return "reconcile_txset_request";
+        case protocol::mtRECONCILE_TXSET_RESPONSE:
+            return "reconcile_txset_response";
+        case protocol::mtRELAY_BATCH:
+            return "relay_batch";
+        case protocol::mtTRANSACTIONS:
+            return "transactions";
+        case protocol::mtGET_STATE_RANGE:
+            return "get_state_range";
+        case protocol::mtSTATE_RANGE:
+            return "state_range";
         default:
             break;
     }
@@ -142,6 +181,12 @@ struct MessageHeader
      * compressed.
      */
     compression::Algorithm algorithm = compression::Algorithm::None;
+
+    /** The decompressed payload of a stream compressed message. Stream
+     * compressed payloads are decompressed as soon as they are received,
+     * whatever their type, to keep the link's history in step.
+     */
+    std::uint8_t const* stream_payload = nullptr;
 };
 
 template <typename BufferSequence>
@@ -206,7 +251,8 @@ parseMessageHeader(
 
         hdr.algorithm = static_cast<compression::Algorithm>(*iter & 0xF0);
 
-        if (hdr.algorithm != compression::Algorithm::LZ4)
+        if (hdr.algorithm != compression::Algorithm::LZ4 &&
+            hdr.algorithm != compression::Algorithm::LZ4Stream)
         {
             ec = make_error_code(boost::system::errc::protocol_error);
             return std::nullopt;
@@ -270,6 +316,14 @@ parseMessageContent(MessageHeader const& header, Buffers const& buffers)
 {
     auto const m = std::make_shared<T>();
 
+    if (header.algorithm == compression::Algorithm::LZ4Stream)
+    {
+        if (!header.stream_payload ||
+            !m->ParseFromArray(header.stream_payload, header.uncompressed_size))
+            return {};
+        return m;
+    }
+
     ZeroCopyInputStream<Buffers> stream(buffers);
     stream.Skip(header.header_size);
 
@@ -294,6 +348,63 @@ parseMessageContent(MessageHeader const& header, Buffers const& buffers)
     return m;
 }
 
+/** Copy the payload of a message out of the receive buffers so that it can
+ * be parsed later, by parsePayload. Stream compressed payloads are copied
+ * decompressed, other payloads as they are on the wire.
+ */
+template <class Buffers>
+std::vector<std::uint8_t>
+copyPayload(MessageHeader const& header, Buffers const& buffers)
+{
+    if (header.algorithm == compression::Algorithm::LZ4Stream)
+        return {
+            header.stream_payload,
+            header.stream_payload + header.uncompressed_size};
+
+    std::vector<std::uint8_t> payload(header.payload_wire_size);
+    auto const begin = buffersBegin(buffers) + header.header_size;
+    std::copy(begin, begin + payload.size(), payload.begin());
+    return payload;
+}
+
+/** Parse a payload copied by copyPayload.
+ * @return the message, or nullptr if the payload is invalid
+ */
+template <
+    class T,
+    class = std::enable_if_t<
+        std::is_base_of<::google::protobuf::Message, T>::value>>
+std::shared_ptr<T>
+parsePayload(
+    MessageHeader const& header,
+    std::vector<std::uint8_t> const& payload)
+{
+    auto const m = std::make_shared<T>();
+
+    if (header.algorithm == compression::Algorithm::LZ4)
+    {
+        std::vector<std::uint8_t> decompressed(header.uncompressed_size);
+        try
+        {
+            compression_algorithms::lz4Decompress(
+                payload.data(),
+                payload.size(),
+                decompressed.data(),
+                decompressed.size());
+        }
+        catch (std::exception const&)
+        {
+            return {};
+        }
+        if (!m->ParseFromArray(decompressed.data(), decompressed.size()))
+            return {};
+    }
+    else if (!m->ParseFromArray(payload.data(), payload.size()))
+        return {};
+
+    return m;
+}
+
 template <
     class T,
     class Buffers,
@@ -385,6 +496,41 @@ invokeProtocolMessage(
         return result;
     }
 
+    // Stream compressed messages are only sent once both sides agreed to it.
+    // A message that fails to decompress leaves the stream unusable.
+    if (header->algorithm == compression::Algorithm::LZ4Stream)
+    {
+        auto const decompressor = handler.streamDecompressor();
+        if (!decompressor)
+        {
+            result.second =
+                make_error_code(boost::system::errc::protocol_error);
+            return result;
+        }
+
+        std::vector<std::uint8_t> compressed(header->payload_wire_size);
+        auto const begin = detail::buffersBegin(buffers) + header->header_size;
+        std::copy(begin, begin + compressed.size(), compressed.begin());
+
+        header->stream_payload = decompressor->decompress(
+            compressed.data(), compressed.size(), header->uncompressed_size);
+        if (!header->stream_payload)
+        {
+            result.second = make_error_code(boost::system::errc::bad_message);
+            return result;
+        }
+    }
+
+    // The handler may take large messages to parse them off the I/O strand.
+    // Only the framing is checked here.
+    if (handler.deferDecode(header->message_type, header->uncompressed_size))
+    {
+        handler.onDeferredMessage(
+            *header, detail::copyPayload(*header, buffers));
+        result.first = header->total_wire_size;
+        return result;
+    }
+
     bool success;
 
     switch (header->message_type)
@@ -481,6 +627,30 @@ invokeProtocolMessage(
             success = detail::invoke<protocol::TMReplayDeltaResponse>(
                 *header, buffers, handler);
             break;
+        case protocol::mtRECONCILE_TXSET_REQ:
+            success = detail::invoke<protocol::TMReconcileTxSet>(
+                *header, buffers, handler);
+            break;
+        case protocol::mtRECONCILE_TXSET_RESPONSE:
+            success = detail::invoke<protocol::TMReconcileTxSetResponse>(
+                *header, buffers, handler);
+            break;
+        case protocol::mtRELAY_BATCH:
+            success = detail::invoke<protocol::TMRelayBatch>(
+                *header, buffers, handler);
+            break;
+        case protocol::mtTRANSACTIONS:
+            success = detail::invoke<protocol::TMTransactions>(
+                *header, buffers, handler);
+            break;
+        case protocol::mtGET_STATE_RANGE:
+            success = detail::invoke<protocol::TMGetStateRange>(
+                *header, buffers, handler);
+            break;
+        case protocol::mtSTATE_RANGE:
+            success = detail::invoke<protocol::TMStateRange>(
+                *header, buffers, handler);
+            break;
         default:
             handler.onMessageUnknown(header->message_type);
             success = true;
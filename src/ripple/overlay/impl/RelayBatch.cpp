@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/overlay/impl/RelayBatch.h>
+#include <cassert>
+
+namespace ripple {
+
+bool
+isRelayBatchable(Message const& m)
+{
+    auto const type = m.getType();
+    return type == protocol::mtPROPOSE_LEDGER ||
+        type == protocol::mtVALIDATION;
+}
+
+std::shared_ptr<Message>
+makeRelayBatch(std::vector<std::shared_ptr<Message>> const& messages)
+{
+    protocol::TMRelayBatch batch;
+    for (auto const& m : messages)
+    {
+        assert(isRelayBatchable(*m));
+        auto const& buffer = m->getBuffer(compression::Compressed::Off);
+        auto const payload = reinterpret_cast<char const*>(buffer.data()) +
+            compression::headerBytes;
+        auto const size = buffer.size() - compression::headerBytes;
+        if (m->getType() == protocol::mtVALIDATION)
+            batch.add_validations(payload, size);
+        else
+            batch.add_proposals(payload, size);
+    }
+    return std::make_shared<Message>(batch, protocol::mtRELAY_BATCH);
+}
+
+bool
+isTransactionBatchable(Message const& m)
+{
+    return m.getType() == protocol::mtTRANSACTION;
+}
+
+std::shared_ptr<Message>
+makeTransactionBatch(std::vector<std::shared_ptr<Message>> const& messages)
+{
+    protocol::TMTransactions batch;
+    for (auto const& m : messages)
+    {
+        assert(isTransactionBatchable(*m));
+        auto const& buffer = m->getBuffer(compression::Compressed::Off);
+        if (!batch.add_transactions()->ParseFromArray(
+                buffer.data() + compression::headerBytes,
+                buffer.size() - compression::headerBytes))
+            LogicError("makeTransactionBatch: unparsable transaction");
+    }
+    return std::make_shared<Message>(batch, protocol::mtTRANSACTIONS);
+}
+
+}  // namespace ripple
@@ -0,0 +1,64 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_RELAYBATCH_H_INCLUDED
+#define RIPPLE_OVERLAY_RELAYBATCH_H_INCLUDED
+
+#include <ripple/overlay/Message.h>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+/** Returns true if the message may be carried in a TMRelayBatch.
+
+    Only proposals and validations are batched, they are many, small and
+    relayed to every peer.
+*/
+bool
+isRelayBatchable(Message const& m);
+
+/** Packs proposals and validations into a single TMRelayBatch.
+
+    The serialized payload of each message is copied as is, so the
+    receiver handles every entry exactly as if it had arrived on its own.
+
+    @param messages the messages to pack, each of which must satisfy
+                    isRelayBatchable
+    @return the batch, ready to send
+*/
+std::shared_ptr<Message>
+makeRelayBatch(std::vector<std::shared_ptr<Message>> const& messages);
+
+/** Returns true if the message may be carried in a TMTransactions. */
+bool
+isTransactionBatchable(Message const& m);
+
+/** Packs relayed transactions into a single TMTransactions.
+
+    @param messages the messages to pack, each of which must satisfy
+                    isTransactionBatchable
+    @return the batch, ready to send
+*/
+std::shared_ptr<Message>
+makeTransactionBatch(std::vector<std::shared_ptr<Message>> const& messages);
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/overlay/Compression.h>
+#include <ripple/overlay/impl/StreamCompression.h>
+#include <lz4.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ripple {
+
+namespace compression {
+
+namespace {
+
+// LZ4 refers back at most this far
+std::size_t constexpr dictBytes = 64 * 1024;
+
+// The window is reset, keeping the last dictBytes, once it is full. Making
+// it several times larger than the history keeps the copying rare.
+std::size_t constexpr windowBytes = 4 * dictBytes;
+
+std::uint64_t
+since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+}  // namespace
+
+StreamCompressor::StreamCompressor() : stream_(LZ4_createStream())
+{
+    if (!stream_)
+        Throw<std::bad_alloc>();
+}
+
+StreamCompressor::~StreamCompressor()
+{
+    LZ4_freeStream(stream_);
+}
+
+void
+StreamCompressor::compress(Slice message, std::vector<std::uint8_t>& out)
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    if (message.size() < headerBytes)
+        Throw<std::runtime_error>("stream compress: invalid message");
+
+    auto const inSize = message.size() - headerBytes;
+    if (inSize > LZ4_MAX_INPUT_SIZE)
+        Throw<std::runtime_error>("stream compress: invalid size");
+
+    // Move the history to a new window if the message doesn't fit
+    if (pos_ + inSize > window_.size())
+    {
+        std::vector<char> next(std::max(windowBytes, dictBytes + inSize));
+        pos_ = LZ4_saveDict(stream_, next.data(), dictBytes);
+        window_.swap(next);
+    }
+    std::memcpy(
+        window_.data() + pos_, message.data() + headerBytes, inSize);
+
+    auto const outCapacity = LZ4_compressBound(inSize);
+    out.resize(headerBytesCompressed + outCapacity);
+    auto const outSize = LZ4_compress_fast_continue(
+        stream_,
+        window_.data() + pos_,
+        reinterpret_cast<char*>(out.data()) + headerBytesCompressed,
+        inSize,
+        outCapacity,
+        1);
+    if (outSize <= 0)
+        Throw<std::runtime_error>("stream compress: failed");
+    pos_ += inSize;
+    out.resize(headerBytesCompressed + outSize);
+
+    // Compressed header, see Message::setHeader
+    auto pack = [](std::uint8_t* p, std::uint32_t size) {
+        p[0] = static_cast<std::uint8_t>((size >> 24) & 0x0F);
+        p[1] = static_cast<std::uint8_t>((size >> 16) & 0xFF);
+        p[2] = static_cast<std::uint8_t>((size >> 8) & 0xFF);
+        p[3] = static_cast<std::uint8_t>(size & 0xFF);
+    };
+    pack(out.data(), outSize);
+    out[0] |= static_cast<std::uint8_t>(Algorithm::LZ4Stream);
+    out[4] = message[4];
+    out[5] = message[5];
+    pack(out.data() + 6, inSize);
+
+    bytesIn_ += inSize;
+    bytesOut_ += outSize;
+    elapsed_ += since(start);
+}
+
+StreamDecompressor::StreamDecompressor() : stream_(LZ4_createStreamDecode())
+{
+    if (!stream_)
+        Throw<std::bad_alloc>();
+}
+
+StreamDecompressor::~StreamDecompressor()
+{
+    LZ4_freeStreamDecode(stream_);
+}
+
+std::uint8_t const*
+StreamDecompressor::decompress(
+    std::uint8_t const* in,
+    std::size_t inSize,
+    std::size_t outSize)
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    if (inSize > LZ4_MAX_INPUT_SIZE || outSize > LZ4_MAX_INPUT_SIZE)
+        return nullptr;
+
+    // Mirror the compressor: the history it refers to is the last
+    // dictBytes of the payloads decompressed so far
+    if (pos_ + outSize > window_.size())
+    {
+        std::vector<char> next(std::max(windowBytes, dictBytes + outSize));
+        auto const keep = std::min(pos_, dictBytes);
+        if (keep != 0)
+            std::memcpy(next.data(), window_.data() + pos_ - keep, keep);
+        window_.swap(next);
+        pos_ = keep;
+        LZ4_setStreamDecode(stream_, window_.data(), keep);
+    }
+
+    auto const out = window_.data() + pos_;
+    auto const ret = LZ4_decompress_safe_continue(
+        stream_, reinterpret_cast<char const*>(in), out, inSize, outSize);
+    if (ret < 0 || static_cast<std::size_t>(ret) != outSize)
+        return nullptr;
+    pos_ += outSize;
+
+    bytesIn_ += inSize;
+    bytesOut_ += outSize;
+    elapsed_ += since(start);
+    return reinterpret_cast<std::uint8_t const*>(out);
+}
+
+}  // namespace compression
+
+}  // namespace ripple
@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_STREAMCOMPRESSION_H_INCLUDED
+#define RIPPLE_OVERLAY_STREAMCOMPRESSION_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+union LZ4_stream_u;
+union LZ4_streamDecode_u;
+
+namespace ripple {
+
+namespace compression {
+
+/** Compresses the messages sent on one peer link as a single stream.
+
+    Every message is LZ4 compressed against the last 64KB of the messages
+    sent before it, so small messages that repeat the content of earlier
+    ones, like transactions, proposals and validations, compress well even
+    though each of them is too small to compress on its own.
+
+    The peer must decompress the messages with a StreamDecompressor, one
+    per link, in the order they were compressed.
+
+    Not thread safe, except for the statistics.
+*/
+class StreamCompressor
+{
+public:
+    StreamCompressor();
+    StreamCompressor(StreamCompressor const&) = delete;
+    StreamCompressor&
+    operator=(StreamCompressor const&) = delete;
+    ~StreamCompressor();
+
+    /** Compress a serialized message.
+        @param message The message with its uncompressed header, as returned
+            by Message::getBuffer(Compressed::Off)
+        @param out Receives the message with a compressed header and the
+            compressed payload
+    */
+    void
+    compress(Slice message, std::vector<std::uint8_t>& out);
+
+    /** Payload bytes passed to compress(). */
+    std::uint64_t
+    bytesIn() const
+    {
+        return bytesIn_;
+    }
+
+    /** Payload bytes produced by compress(). */
+    std::uint64_t
+    bytesOut() const
+    {
+        return bytesOut_;
+    }
+
+    /** Time spent compressing. */
+    std::chrono::microseconds
+    elapsed() const
+    {
+        return std::chrono::microseconds(elapsed_);
+    }
+
+private:
+    LZ4_stream_u* stream_;
+    // The history the compressor refers to, followed by the message being
+    // compressed. Messages are appended so that the history stays contiguous.
+    std::vector<char> window_;
+    std::size_t pos_ = 0;
+
+    std::atomic<std::uint64_t> bytesIn_{0};
+    std::atomic<std::uint64_t> bytesOut_{0};
+    std::atomic<std::uint64_t> elapsed_{0};
+};
+
+/** Decompresses the messages produced by a peer's StreamCompressor.
+
+    Not thread safe, except for the statistics.
+*/
+class StreamDecompressor
+{
+public:
+    StreamDecompressor();
+    StreamDecompressor(StreamDecompressor const&) = delete;
+    StreamDecompressor&
+    operator=(StreamDecompressor const&) = delete;
+    ~StreamDecompressor();
+
+    /** Decompress the payload of the next message on the link.
+        @param in The compressed payload
+        @param inSize Size of the compressed payload
+        @param outSize Size of the payload once decompressed
+        @return The decompressed payload, valid until the next call, or
+            nullptr if the payload is corrupt. The stream can't be used
+            after a failure.
+    */
+    std::uint8_t const*
+    decompress(
+        std::uint8_t const* in,
+        std::size_t inSize,
+        std::size_t outSize);
+
+    /** Payload bytes passed to decompress(). */
+    std::uint64_t
+    bytesIn() const
+    {
+        return bytesIn_;
+    }
+
+    /** Payload bytes produced by decompress(). */
+    std::uint64_t
+    bytesOut() const
+    {
+        return bytesOut_;
+    }
+
+    /** Time spent decompressing. */
+    std::chrono::microseconds
+    elapsed() const
+    {
+        return std::chrono::microseconds(elapsed_);
+    }
+
+private:
+    LZ4_streamDecode_u* stream_;
+    std::vector<char> window_;
+    std::size_t pos_ = 0;
+
+    std::atomic<std::uint64_t> bytesIn_{0};
+    std::atomic<std::uint64_t> bytesOut_{0};
+    std::atomic<std::uint64_t> elapsed_{0};
+};
+
+}  // namespace compression
+
+}  // namespace ripple
+
+#endif
@@ -45,7 +45,7 @@ TrafficCount::categorize(
         (type == protocol::mtPEER_SHARD_INFO))
         return TrafficCount::category::shards;
 
-    if (type == protocol::mtTRANSACTION)
+    if (type == protocol::mtTRANSACTION || type == protocol::mtTRANSACTIONS)
         return TrafficCount::category::transaction;
 
     if (type == protocol::mtVALIDATORLIST ||
@@ -58,6 +58,9 @@ TrafficCount::categorize(
     if (type == protocol::mtPROPOSE_LEDGER)
         return TrafficCount::category::proposal;
 
+    if (type == protocol::mtRELAY_BATCH)
+        return TrafficCount::category::relay_batch;
+
     if (type == protocol::mtHAVE_SET)
         return inbound ? TrafficCount::category::get_set
                        : TrafficCount::category::share_set;
@@ -154,6 +157,18 @@ TrafficCount::categorize(
     if (type == protocol::mtREPLAY_DELTA_RESPONSE)
         return TrafficCount::category::replay_delta_response;
 
+    if (type == protocol::mtRECONCILE_TXSET_REQ)
+        return TrafficCount::category::reconcile_txset_request;
+
+    if (type == protocol::mtRECONCILE_TXSET_RESPONSE)
+        return TrafficCount::category::reconcile_txset_response;
+
+    if (type == protocol::mtGET_STATE_RANGE)
+        return TrafficCount::category::state_range_request;
+
+    if (type == protocol::mtSTATE_RANGE)
+        return TrafficCount::category::state_range_response;
+
     return TrafficCount::category::unknown;
 }
 
@@ -23,8 +23,10 @@
 #include <ripple/basics/safe_cast.h>
 #include <ripple/protocol/messages.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 
 namespace ripple {
@@ -61,6 +63,96 @@ public:
         }
     };
 
+    /** A distribution of values in power of two buckets.
+
+        Bucket 0 counts zeros and bucket i counts values in [2^(i-1), 2^i),
+        the last bucket also counts everything larger. Recording is a
+        relaxed increment on a shard picked by the calling thread, so that
+        threads don't contend on the same cache line; reads merge the shards.
+    */
+    class Histogram
+    {
+    public:
+        static constexpr std::size_t buckets = 32;
+        using Counts = std::array<std::uint64_t, buckets>;
+
+        void
+        add(std::uint64_t value)
+        {
+            std::size_t i = 0;
+            while (value != 0 && i != buckets - 1)
+            {
+                value >>= 1;
+                ++i;
+            }
+            shards_[shard()].counts[i].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /** The merged bucket counts */
+        Counts
+        counts() const
+        {
+            Counts ret{};
+            for (auto const& s : shards_)
+                for (std::size_t i = 0; i != buckets; ++i)
+                    ret[i] += s.counts[i].load(std::memory_order_relaxed);
+            return ret;
+        }
+
+        /** Upper bound of the bucket holding the given percentile, zero if
+            nothing was recorded.
+            @param counts merged bucket counts
+            @param p percentile, from 0 to 100
+        */
+        static std::uint64_t
+        percentile(Counts const& counts, double p)
+        {
+            std::uint64_t total = 0;
+            for (auto const c : counts)
+                total += c;
+            if (total == 0)
+                return 0;
+            auto const rank = std::min(
+                static_cast<std::uint64_t>(total * p / 100), total - 1);
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i != buckets; ++i)
+            {
+                seen += counts[i];
+                if (seen > rank)
+                    return i == 0 ? 0 : (std::uint64_t{1} << i) - 1;
+            }
+            return (std::uint64_t{1} << (buckets - 1)) - 1;
+        }
+
+    private:
+        static constexpr std::size_t numShards = 4;
+
+        static std::size_t
+        shard()
+        {
+            static std::atomic<std::size_t> next{0};
+            thread_local std::size_t const s = next++ % numShards;
+            return s;
+        }
+
+        struct alignas(64) Shard
+        {
+            std::array<std::atomic<std::uint64_t>, buckets> counts{};
+        };
+
+        std::array<Shard, numShards> shards_{};
+    };
+
+    /** Per category distributions: message sizes in bytes, time spent in
+        a peer's send queue and time spent in the message handler, both in
+        microseconds. */
+    struct Histograms
+    {
+        Histogram size;
+        Histogram queued;
+        Histogram handler;
+    };
+
     // If you add entries to this enum, you need to update the initialization
     // of the arrays at the bottom of this file which map array numbers to
     // human-readable, monitoring-tool friendly names.
@@ -73,6 +165,7 @@ public:
         transaction,
         proposal,
         validation,
+        relay_batch,  // proposals and validations in one TMRelayBatch
         validatorlist,
         shards,  // shard-related traffic
 
@@ -148,6 +241,18 @@ public:
         replay_delta_request,
         replay_delta_response,
 
+        // TMReconcileTxSet and TMReconcileTxSetResponse
+        reconcile_txset_request,
+        reconcile_txset_response,
+
+        // TMGetStateRange and TMStateRange
+        state_range_request,
+        state_range_response,
+
+        // TMLedgerData replies served from, or added to, the reply cache
+        ld_cache_hit,
+        ld_cache_miss,
+
         unknown  // must be last
     };
 
@@ -175,6 +280,24 @@ public:
             counts_[cat].bytesOut += bytes;
             ++counts_[cat].messagesOut;
         }
+        histograms_[cat].size.add(bytes);
+    }
+
+    /** Account for the time a message of the category spent queued */
+    void
+    addQueueTime(category cat, std::chrono::microseconds t)
+    {
+        assert(cat <= category::unknown);
+        histograms_[cat].queued.add(t.count());
+    }
+
+    /** Account for the time a message of the category spent in its handler
+     */
+    void
+    addHandlerTime(category cat, std::chrono::microseconds t)
+    {
+        assert(cat <= category::unknown);
+        histograms_[cat].handler.add(t.count());
     }
 
     TrafficCount() = default;
@@ -189,7 +312,16 @@ public:
         return counts_;
     }
 
+    /** The distributions, indexed like getCounts() */
+    auto const&
+    getHistograms() const
+    {
+        return histograms_;
+    }
+
 protected:
+    std::array<Histograms, category::unknown + 1> histograms_;
+
     std::array<TrafficStats, category::unknown + 1> counts_{{
         {"overhead"},           // category::base
         {"overhead_cluster"},   // category::cluster
@@ -198,6 +330,7 @@ protected:
         {"transactions"},       // category::transaction
         {"proposals"},          // category::proposal
         {"validations"},        // category::validation
+        {"relay_batches"},      // category::relay_batch
         {"validator_lists"},    // category::validatorlist
         {"shards"},             // category::shards
         {"set_get"},            // category::get_set
@@ -236,7 +369,13 @@ protected:
         {"proof_path_response"},    // category::proof_path_response
         {"replay_delta_request"},   // category::replay_delta_request
         {"replay_delta_response"},  // category::replay_delta_response
-        {"unknown"}                 // category::unknown
+        {"reconcile_txset_request"},   // category::reconcile_txset_request
+        {"reconcile_txset_response"},  // category::reconcile_txset_response
+        {"state_range_request"},       // category::state_range_request
+        {"state_range_response"},      // category::state_range_response
+        {"ledger_data_cache_hit"},  // category::ld_cache_hit
+        {"ledger_data_cache_miss"},  // category::ld_cache_miss
+        {"unknown"}                  // category::unknown
     }};
 };
 
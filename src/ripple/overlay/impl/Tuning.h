@@ -59,6 +59,45 @@ enum {
 /** Size of buffer used to read from the socket. */
 std::size_t constexpr readBufferBytes = 16384;
 
+/** Most bytes of queued messages gathered into a single write. A message
+    larger than this is still written, on its own. */
+std::size_t constexpr writeCoalesceBytes = 65536;
+
+/** Most queued messages gathered into a single write. */
+std::size_t constexpr writeCoalesceMessages = 64;
+
+/** Most proposals and validations packed into a single TMRelayBatch. */
+std::size_t constexpr relayBatchMessages = 32;
+
+/** Most relayed transactions packed into a single TMTransactions. A batch
+    takes one turn of the transaction lane, so this is kept small. */
+std::size_t constexpr transactionBatchMessages = 16;
+
+/** Messages taken from each send queue lane per round while the
+    higher priority lanes are busy: consensus, ledger data, transactions. */
+std::size_t constexpr consensusLaneWeight = 8;
+std::size_t constexpr ledgerLaneWeight = 2;
+std::size_t constexpr transactionLaneWeight = 1;
+
+/** How many relayed transactions may wait on a send queue before further
+    ones to that peer are dropped. */
+std::size_t constexpr dropTransactionLane = 128;
+
+/** How many serialized TMLedgerData replies are kept for peers asking for
+    the same data, and for how long. */
+int constexpr ledgerDataCacheSize = 128;
+std::chrono::seconds constexpr ledgerDataCacheAge{5};
+
+/** Most of our ledger data requests to a peer tracked while awaiting a
+    reply, and the longest a reply is counted as taking. A peer that
+    doesn't answer looks this slow. */
+std::size_t constexpr maxTrackedLedgerRequests = 64;
+std::chrono::milliseconds constexpr maxLedgerResponseTime{10000};
+
+/** Most TLS sessions with peers we connected to that are kept for
+    resuming later connections. */
+std::size_t constexpr sslSessions = 1024;
+
 }  // namespace Tuning
 
 }  // namespace ripple
@@ -20,12 +20,17 @@
 #ifndef RIPPLE_PEERFINDER_HANDOUTS_H_INCLUDED
 #define RIPPLE_PEERFINDER_HANDOUTS_H_INCLUDED
 
+#include <ripple/basics/random.h>
 #include <ripple/beast/container/aged_set.h>
 #include <ripple/peerfinder/impl/SlotImp.h>
 #include <ripple/peerfinder/impl/Tuning.h>
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <iterator>
+#include <list>
 #include <type_traits>
+#include <vector>
 
 namespace ripple {
 namespace PeerFinder {
@@ -75,7 +80,7 @@ handout(
         std::size_t n(0);
         for (auto si = seq_first; si != seq_last; ++si)
         {
-            auto c = *si;
+            auto&& c = *si;
             bool all_full(true);
             for (auto ti = first; ti != last; ++ti)
             {
@@ -96,6 +101,123 @@ handout(
 
 //------------------------------------------------------------------------------
 
+/** A shuffled copy of the Livecache, grouped by hops.
+    Handouts draw from the sample instead of shuffling the whole cache on
+    every call. The sample is refreshed periodically; in between, items
+    handed out move to the end of their hop so that successive handouts
+    rotate through it.
+*/
+class EndpointSample
+{
+public:
+    /** The endpoints in the sample at the same hops. */
+    class Hop
+    {
+    public:
+        using iterator = std::list<Endpoint>::const_iterator;
+
+        iterator
+        begin() const
+        {
+            return list_.cbegin();
+        }
+
+        iterator
+        end() const
+        {
+            return list_.cend();
+        }
+
+        std::size_t
+        size() const
+        {
+            return list_.size();
+        }
+
+        // move the element to the end of the container
+        void
+        move_back(iterator pos)
+        {
+            list_.splice(list_.end(), list_, pos);
+        }
+
+    private:
+        friend class EndpointSample;
+
+        std::list<Endpoint> list_;
+    };
+
+    using hops_type = std::array<Hop, 1 + Tuning::maxHops + 1>;
+    using iterator = hops_type::iterator;
+    using reverse_iterator = hops_type::reverse_iterator;
+
+    /** Replace the sample with a shuffled copy of a sequence of hops. */
+    template <class HopRange>
+    void
+    refresh(HopRange const& hops);
+
+    bool
+    empty() const
+    {
+        return size() == 0;
+    }
+
+    std::size_t
+    size() const
+    {
+        std::size_t n = 0;
+        for (auto const& hop : hops_)
+            n += hop.size();
+        return n;
+    }
+
+    iterator
+    begin()
+    {
+        return hops_.begin();
+    }
+
+    iterator
+    end()
+    {
+        return hops_.end();
+    }
+
+    reverse_iterator
+    rbegin()
+    {
+        return hops_.rbegin();
+    }
+
+    reverse_iterator
+    rend()
+    {
+        return hops_.rend();
+    }
+
+private:
+    hops_type hops_;
+};
+
+template <class HopRange>
+void
+EndpointSample::refresh(HopRange const& hops)
+{
+    std::vector<Endpoint> v;
+    auto to = hops_.begin();
+    for (auto from = hops.begin(); from != hops.end() && to != hops_.end();
+         ++from, ++to)
+    {
+        v.assign((*from).begin(), (*from).end());
+        std::shuffle(v.begin(), v.end(), default_prng());
+        to->list_.assign(v.begin(), v.end());
+    }
+    for (; to != hops_.end(); ++to)
+        to->list_.clear();
+}
+
+//------------------------------------------------------------------------------
+
 /** Receives handouts for redirecting a connection.
     An incoming connection request is redirected when we are full on slots.
 */
@@ -41,6 +41,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 
 namespace ripple {
@@ -85,6 +86,13 @@ public:
     // Live livecache from mtENDPOINTS messages
     Livecache<> livecache_;
 
+    // Shuffled copy of the livecache that handouts are drawn from,
+    // refreshed once per second. Guarded by sampleLock_ rather than lock_
+    // so that redirects don't wait on slot bookkeeping. When both are
+    // held, lock_ is acquired first.
+    std::mutex sampleLock_;
+    EndpointSample sample_;
+
     // LiveCache of addresses suitable for gaining initial connections
     Bootcache bootcache_;
 
@@ -450,10 +458,9 @@ public:
     std::vector<Endpoint>
     redirect(SlotImp::ptr const& slot)
     {
-        std::lock_guard _(lock_);
         RedirectHandouts h(slot);
-        livecache_.hops.shuffle();
-        handout(&h, (&h) + 1, livecache_.hops.begin(), livecache_.hops.end());
+        std::lock_guard sl(sampleLock_);
+        handout(&h, (&h) + 1, sample_.begin(), sample_.end());
         return std::move(h.list());
     }
 
@@ -523,9 +530,10 @@ public:
         //    Any outbound attempts are in progress
         //
         {
-            livecache_.hops.shuffle();
-            handout(
-                &h, (&h) + 1, livecache_.hops.rbegin(), livecache_.hops.rend());
+            {
+                std::lock_guard sl(sampleLock_);
+                handout(&h, (&h) + 1, sample_.rbegin(), sample_.rend());
+            }
             if (!h.list().empty())
             {
                 JLOG(m_journal.debug())
@@ -643,12 +651,14 @@ public:
             }
 
             // build sequence of endpoints by hops
-            livecache_.hops.shuffle();
-            handout(
-                targets.begin(),
-                targets.end(),
-                livecache_.hops.begin(),
-                livecache_.hops.end());
+            {
+                std::lock_guard sl(sampleLock_);
+                handout(
+                    targets.begin(),
+                    targets.end(),
+                    sample_.begin(),
+                    sample_.end());
+            }
 
             // broadcast
             for (auto const& t : targets)
@@ -675,6 +685,7 @@ public:
 
         // Expire the Livecache
         livecache_.expire();
+        refreshSample();
 
         // Expire the recent cache in each slot
         for (auto const& entry : slots_)
@@ -686,6 +697,16 @@ public:
         bootcache_.periodicActivity();
     }
 
+    // Replace the handout sample with a fresh copy of the livecache
+    void
+    refreshSample()
+    {
+        EndpointSample sample;
+        sample.refresh(livecache_.hops);
+        std::lock_guard sl(sampleLock_);
+        sample_ = std::move(sample);
+    }
+
     //--------------------------------------------------------------------------
 
     // Validate and clean up the list that we received from the slot.
@@ -142,6 +142,15 @@ public:
     toBase58(AccountID const&) const;
 };
 
+/** Return ripple::toBase58 for the AccountID, from a shared cache
+
+    For code that has no Application at hand, such as the
+    conversion of ledger objects and transactions to JSON,
+    which spells the same accounts over and over.
+*/
+std::string
+toBase58Cached(AccountID const& v);
+
 }  // namespace ripple
 
 //------------------------------------------------------------------------------
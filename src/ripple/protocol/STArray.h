@@ -162,6 +162,8 @@ public:
 
     virtual Json::Value
     getJson(JsonOptions index) const override;
+    void
+    writeJson(Json::Writer& w, JsonOptions options) const override;
     virtual void
     add(Serializer& s) const override;
 
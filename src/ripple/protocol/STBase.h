@@ -20,7 +20,9 @@
 #ifndef RIPPLE_PROTOCOL_STBASE_H_INCLUDED
 #define RIPPLE_PROTOCOL_STBASE_H_INCLUDED
 
+#include <ripple/basics/MemoryArena.h>
 #include <ripple/basics/contract.h>
+#include <ripple/json/json_forwards.h>
 #include <ripple/protocol/SField.h>
 #include <ripple/protocol/Serializer.h>
 #include <memory>
@@ -59,7 +61,7 @@ enum class JsonOptions { none = 0, include_date = 1 };
 
     @note "ST" stands for "Serialized Type."
 */
-class STBase
+class STBase : public ArenaAllocated<MemoryArena::stobject>
 {
 public:
     STBase();
@@ -120,6 +122,16 @@ public:
 
     virtual Json::Value getJson(JsonOptions /*options*/) const;
 
+    /** Write the JSON for this value straight to a writer.
+
+        The text is the same as writing the result of getJson(options), but
+        types that hold other values write them as they go instead of
+        building a Json::Value tree first. The writer must be positioned for
+        a value, as for Json::Writer::output.
+    */
+    virtual void
+    writeJson(Json::Writer& w, JsonOptions options) const;
+
     virtual void
     add(Serializer& s) const;
 
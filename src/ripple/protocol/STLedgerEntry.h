@@ -78,6 +78,9 @@ public:
     Json::Value
     getJson(JsonOptions options) const override;
 
+    void
+    writeJson(Json::Writer& w, JsonOptions options) const override;
+
     /** Returns the 'key' (or 'index') of this item.
         The key identifies this entry's position in
         the SHAMap associative container.
@@ -31,9 +31,11 @@
 #include <ripple/protocol/STPathSet.h>
 #include <ripple/protocol/STVector256.h>
 #include <ripple/protocol/impl/STVar.h>
+#include <boost/container/small_vector.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/optional.hpp>
 #include <cassert>
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -246,11 +248,42 @@ private:
         }
     };
 
-    using list_type = std::vector<detail::STVar>;
+    // Objects without a template, such as the nodes in metadata, seldom
+    // have more than a few fields. Keeping those inline puts the fields
+    // in the same allocation as the list.
+    static constexpr std::size_t inlineFields = 4;
 
-    list_type v_;
+    using list_type =
+        boost::container::small_vector<detail::STVar, inlineFields>;
+
+    // The fields are shared with copies of this object until either side
+    // changes them. Once a non-const pointer or reference into the fields
+    // has been handed out, `leaked_` is set and copies get fields of their
+    // own, since a write through it would otherwise show up in both.
+    std::shared_ptr<list_type> v_;
+    bool leaked_ = false;
     SOTemplate const* mType;
 
+    static list_type const&
+    emptyFields();
+
+    list_type const&
+    fields() const
+    {
+        return v_ ? *v_ : emptyFields();
+    }
+
+    // Return fields owned by this object alone, copying them if shared.
+    list_type&
+    mutableFields();
+
+    // Like getPField and makeFieldPresent, for callers that are done with
+    // the pointer before they return.
+    STBase*
+    writablePField(SField const& field, bool createOkay);
+    STBase*
+    writableFieldPresent(SField const& field);
+
 public:
     using iterator = boost::
         transform_iterator<Transform, STObject::list_type::const_iterator>;
@@ -261,7 +294,7 @@ public:
     };
 
     STObject(STObject&&);
-    STObject(STObject const&) = default;
+    STObject(STObject const&);
     STObject(const SOTemplate& type, SField const& name);
     STObject(
         const SOTemplate& type,
@@ -274,7 +307,7 @@ public:
     {
     }
     STObject&
-    operator=(STObject const&) = default;
+    operator=(STObject const&);
     STObject&
     operator=(STObject&& other);
 
@@ -297,25 +330,25 @@ public:
     iterator
     begin() const
     {
-        return iterator(v_.begin());
+        return iterator(fields().begin());
     }
 
     iterator
     end() const
     {
-        return iterator(v_.end());
+        return iterator(fields().end());
     }
 
     bool
     empty() const
     {
-        return v_.empty();
+        return fields().empty();
     }
 
     void
     reserve(std::size_t n)
     {
-        v_.reserve(n);
+        mutableFields().reserve(n);
     }
 
     void
@@ -345,7 +378,7 @@ public:
     virtual bool
     isDefault() const override
     {
-        return v_.empty();
+        return fields().empty();
     }
 
     virtual void
@@ -380,18 +413,22 @@ public:
     virtual Json::Value
     getJson(JsonOptions options) const override;
 
+    void
+    writeJson(Json::Writer& w, JsonOptions options) const override;
+
     template <class... Args>
     std::size_t
     emplace_back(Args&&... args)
     {
-        v_.emplace_back(std::forward<Args>(args)...);
-        return v_.size() - 1;
+        auto& v = mutableFields();
+        v.emplace_back(std::forward<Args>(args)...);
+        return v.size() - 1;
     }
 
     int
     getCount() const
     {
-        return v_.size();
+        return fields().size();
     }
 
     bool setFlag(std::uint32_t);
@@ -408,22 +445,24 @@ public:
     const STBase&
     peekAtIndex(int offset) const
     {
-        return v_[offset].get();
+        return fields()[offset].get();
     }
     STBase&
     getIndex(int offset)
     {
-        return v_[offset].get();
+        leaked_ = true;
+        return mutableFields()[offset].get();
     }
     const STBase*
     peekAtPIndex(int offset) const
     {
-        return &v_[offset].get();
+        return &fields()[offset].get();
     }
     STBase*
     getPIndex(int offset)
     {
-        return &v_[offset].get();
+        leaked_ = true;
+        return &mutableFields()[offset].get();
     }
 
     int
@@ -607,13 +646,13 @@ public:
     void
     setFieldH160(SField const& field, base_uint<160, Tag> const& v)
     {
-        STBase* rf = getPField(field, true);
+        STBase* rf = writablePField(field, true);
 
         if (!rf)
             throwFieldNotFound(field);
 
         if (rf->getSType() == STI_NOTPRESENT)
-            rf = makeFieldPresent(field);
+            rf = writableFieldPresent(field);
 
         using Bits = STBitString<160>;
         if (auto cf = dynamic_cast<Bits*>(rf))
@@ -649,6 +688,18 @@ public:
         return !(*this == o);
     }
 
+protected:
+    /** Write the present fields, and one more string member if extraKey is
+        not null, in the order Json::Value holds members: sorted by name.
+        The extra member replaces a field of the same name.
+    */
+    void
+    writeFieldsJson(
+        Json::Writer& w,
+        JsonOptions options,
+        char const* extraKey,
+        std::string const& extraValue) const;
+
 private:
     enum WhichFields : bool {
         // These values are carefully chosen to do the right thing if passed
@@ -730,13 +781,13 @@ private:
     {
         static_assert(!std::is_lvalue_reference<V>::value, "");
 
-        STBase* rf = getPField(field, true);
+        STBase* rf = writablePField(field, true);
 
         if (!rf)
             throwFieldNotFound(field);
 
         if (rf->getSType() == STI_NOTPRESENT)
-            rf = makeFieldPresent(field);
+            rf = writableFieldPresent(field);
 
         T* cf = dynamic_cast<T*>(rf);
 
@@ -751,13 +802,13 @@ private:
     void
     setFieldUsingAssignment(SField const& field, T const& value)
     {
-        STBase* rf = getPField(field, true);
+        STBase* rf = writablePField(field, true);
 
         if (!rf)
             throwFieldNotFound(field);
 
         if (rf->getSType() == STI_NOTPRESENT)
-            rf = makeFieldPresent(field);
+            rf = writableFieldPresent(field);
 
         T* cf = dynamic_cast<T*>(rf);
 
@@ -840,9 +891,9 @@ STObject::Proxy<T>::assign(U&& u)
     }
     T* t;
     if (style_ == soeINVALID)
-        t = dynamic_cast<T*>(st_->getPField(*f_, true));
+        t = dynamic_cast<T*>(st_->writablePField(*f_, true));
     else
-        t = dynamic_cast<T*>(st_->makeFieldPresent(*f_));
+        t = dynamic_cast<T*>(st_->writableFieldPresent(*f_));
     assert(t);
     *t = std::forward<U>(u);
 }
@@ -123,6 +123,8 @@ public:
     getJson(JsonOptions options) const override;
     Json::Value
     getJson(JsonOptions options, bool binary) const;
+    void
+    writeJson(Json::Writer& w, JsonOptions options) const override;
 
     void
     sign(PublicKey const& publicKey, SecretKey const& secretKey);
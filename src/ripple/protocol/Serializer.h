@@ -36,6 +36,23 @@
 
 namespace ripple {
 
+/** Serializers take their buffers from a small per-thread pool.
+
+    Most serializations are short lived, so on a busy thread the buffer a
+    Serializer needs has usually just been given back by the last one.
+    A buffer moved out with modData() or getData() leaves the pool for
+    good.
+*/
+namespace detail {
+
+Blob
+borrowSerializerBuffer(std::size_t n);
+
+void
+returnSerializerBuffer(Blob& buffer) noexcept;
+
+}  // namespace detail
+
 class Serializer
 {
 private:
@@ -44,11 +61,24 @@ private:
 
 public:
     explicit Serializer(int n = 256)
+        : mData(detail::borrowSerializerBuffer(n))
     {
-        mData.reserve(n);
+    }
+
+    Serializer(Serializer const&) = default;
+    Serializer(Serializer&&) = default;
+    Serializer&
+    operator=(Serializer const&) = default;
+    Serializer&
+    operator=(Serializer&&) = default;
+
+    ~Serializer()
+    {
+        detail::returnSerializerBuffer(mData);
     }
 
     Serializer(void const* data, std::size_t size)
+        : mData(detail::borrowSerializerBuffer(size))
     {
         mData.resize(size);
 
@@ -102,6 +132,8 @@ public:
     int
     addRaw(Blob const& vector);
     int
+    addRaw(Slice slice);
+    int
     addRaw(const void* ptr, int len);
     int
     addRaw(const Serializer& s);
@@ -388,6 +420,17 @@ public:
     Slice
     getSlice(std::size_t bytes);
 
+    /** Return the next VL field's data without copying it.
+
+        The slice points into the data being read, so it is only valid
+        for as long as that is.
+    */
+    Slice
+    getVLSlice()
+    {
+        return getSlice(getVLDataLength());
+    }
+
     // VFALCO DEPRECATED Returns a copy
     Blob
     getRaw(int size);
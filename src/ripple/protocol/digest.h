@@ -20,11 +20,14 @@
 #ifndef RIPPLE_PROTOCOL_DIGEST_H_INCLUDED
 #define RIPPLE_PROTOCOL_DIGEST_H_INCLUDED
 
+#include <ripple/basics/Slice.h>
 #include <ripple/basics/base_uint.h>
 #include <ripple/crypto/secure_erase.h>
 #include <boost/endian/conversion.hpp>
 #include <algorithm>
 #include <array>
+#include <cstring>
+#include <optional>
 
 namespace ripple {
 
@@ -157,16 +160,36 @@ public:
 
 namespace detail {
 
+/** Returns the SHA512-Half of a message that fits in one block.
+
+    @param block A 128 byte buffer holding the message in its first
+                 `size` bytes. The rest is overwritten with the padding.
+    @param size The size of the message, at most 111 bytes.
+    @param secure Whether the hash state is erased afterwards.
+*/
+uint256
+sha512HalfBlock(std::uint8_t* block, std::size_t size, bool secure) noexcept;
+
 /** Returns the SHA512-Half digest of a message.
 
     The SHA512-Half is the first 256 bits of the
     SHA-512 digest of the message.
+
+    Messages short enough to be padded into a single block, such as
+    keys, identifiers and ledger keylets, are collected locally and
+    hashed with one call to the compression function. Longer ones are
+    handed to the general purpose SHA-512 hasher.
 */
 template <bool Secure>
 struct basic_sha512_half_hasher
 {
 private:
-    sha512_hasher h_;
+    static constexpr std::size_t blockSize = 128;
+    static constexpr std::size_t smallLimit = blockSize - 17;
+
+    std::uint8_t small_[blockSize];
+    std::size_t size_ = 0;
+    std::optional<sha512_hasher> h_;
 
 public:
     static constexpr auto const endian = boost::endian::order::big;
@@ -181,12 +204,27 @@ public:
     void
     operator()(void const* data, std::size_t size) noexcept
     {
-        h_(data, size);
+        if (!h_ && size <= smallLimit - size_)
+        {
+            if (size != 0)
+                std::memcpy(small_ + size_, data, size);
+            size_ += size;
+            return;
+        }
+
+        if (!h_)
+        {
+            h_.emplace();
+            (*h_)(small_, size_);
+        }
+        (*h_)(data, size);
     }
 
     explicit operator result_type() noexcept
     {
-        auto const digest = sha512_hasher::result_type(h_);
+        if (!h_)
+            return sha512HalfBlock(small_, size_, Secure);
+        auto const digest = sha512_hasher::result_type(*h_);
         return result_type::fromVoid(digest.data());
     }
 
@@ -197,7 +235,9 @@ private:
 
     inline void erase(std::true_type)
     {
-        secure_erase(&h_, sizeof(h_));
+        secure_erase(small_, sizeof(small_));
+        if (h_)
+            secure_erase(&*h_, sizeof(*h_));
     }
 };
 
@@ -237,6 +277,20 @@ sha512Half_s(Args const&... args)
     return static_cast<typename sha512_half_hasher_s::result_type>(h);
 }
 
+/** Computes the SHA512-Half of several independent messages.
+
+    The result for each message is the same as sha512Half(message). When
+    the processor supports it, messages which pad to the same number of
+    blocks are hashed together using SIMD instructions; otherwise, and
+    for any that are left over, the messages are hashed one at a time.
+
+    @param messages The messages to hash.
+    @param digests Receives the digest of each message.
+    @param count The number of messages and digests.
+*/
+void
+sha512HalfBatch(Slice const* messages, uint256* digests, std::size_t count);
+
 }  // namespace ripple
 
 #endif
@@ -160,4 +160,11 @@ AccountIDCache::toBase58(AccountID const& id) const
     return result;
 }
 
+std::string
+toBase58Cached(AccountID const& v)
+{
+    static AccountIDCache const cache(65536);
+    return cache.toBase58(v);
+}
+
 }  // namespace ripple
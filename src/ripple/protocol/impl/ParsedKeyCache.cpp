@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/protocol/impl/ParsedKeyCache.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ripple {
+
+ParsedKeyCache&
+ParsedKeyCache::instance()
+{
+    static ParsedKeyCache cache;
+    return cache;
+}
+
+bool
+ParsedKeyCache::parse(Slice const& key, secp256k1_pubkey& out)
+{
+    if (key.size() != keySize)
+        return secp256k1_ec_pubkey_parse(
+                   secp256k1Context(), &out, key.data(), key.size()) == 1;
+
+    // The X coordinate of a real key is uniformly distributed, so its
+    // leading bytes pick the slot. A key made to collide with another
+    // only makes both miss.
+    std::uint64_t x;
+    std::memcpy(&x, key.data() + 1, sizeof(x));
+    auto const index = x % slots;
+    auto& slot = slots_[index];
+
+    {
+        std::lock_guard lock(locks_[index % locks]);
+        if (slot.used &&
+            std::equal(slot.key.begin(), slot.key.end(), key.data()))
+        {
+            out = slot.parsed;
+            ++hits_;
+            return true;
+        }
+    }
+
+    ++misses_;
+    if (secp256k1_ec_pubkey_parse(
+            secp256k1Context(), &out, key.data(), key.size()) != 1)
+        return false;
+
+    std::lock_guard lock(locks_[index % locks]);
+    std::copy(key.data(), key.data() + keySize, slot.key.begin());
+    slot.parsed = out;
+    slot.used = true;
+    return true;
+}
+
+}  // namespace ripple
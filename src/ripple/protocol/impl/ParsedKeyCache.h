@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_PARSEDKEYCACHE_H_INCLUDED
+#define RIPPLE_PROTOCOL_PARSEDKEYCACHE_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/protocol/impl/secp256k1.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace ripple {
+
+/** A bounded cache of parsed secp256k1 public keys.
+
+    Parsing a compressed public key decompresses the point, which costs
+    about as much as a field square root. The same validator and account
+    keys are verified against over and over, so the parsed form is kept
+    here, keyed by the compressed bytes.
+
+    The cache is direct mapped: each key can only go in the slot picked by
+    its X coordinate, and replaces whatever was there. Keys that fail to
+    parse are not cached. Slots are guarded by a fixed set of locks.
+*/
+class ParsedKeyCache
+{
+public:
+    static constexpr std::size_t slots = 2048;
+
+    ParsedKeyCache() = default;
+    ParsedKeyCache(ParsedKeyCache const&) = delete;
+    ParsedKeyCache&
+    operator=(ParsedKeyCache const&) = delete;
+
+    /** The cache used by verifyDigest. */
+    static ParsedKeyCache&
+    instance();
+
+    /** Parse a compressed public key, using the cached form if present.
+
+        @return `false` if the key is not a valid compressed key.
+    */
+    bool
+    parse(Slice const& key, secp256k1_pubkey& out);
+
+    std::uint64_t
+    hits() const
+    {
+        return hits_;
+    }
+
+    std::uint64_t
+    misses() const
+    {
+        return misses_;
+    }
+
+private:
+    static constexpr std::size_t keySize = 33;
+    static constexpr std::size_t locks = 64;
+
+    struct Slot
+    {
+        std::array<std::uint8_t, keySize> key{};
+        secp256k1_pubkey parsed;
+        bool used = false;
+    };
+
+    std::array<Slot, slots> slots_;
+    std::array<std::mutex, locks> mutable locks_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
+
+}  // namespace ripple
+
+#endif
@@ -21,6 +21,7 @@
 #include <ripple/basics/strHex.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/digest.h>
+#include <ripple/protocol/impl/ParsedKeyCache.h>
 #include <ripple/protocol/impl/secp256k1.h>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <ed25519-donna/ed25519.h>
@@ -231,11 +232,7 @@ verifyDigest(
         return false;
 
     secp256k1_pubkey pubkey_imp;
-    if (secp256k1_ec_pubkey_parse(
-            secp256k1Context(),
-            &pubkey_imp,
-            reinterpret_cast<unsigned char const*>(publicKey.data()),
-            publicKey.size()) != 1)
+    if (!ParsedKeyCache::instance().parse(publicKey.slice(), pubkey_imp))
         return false;
 
     secp256k1_ecdsa_signature sig_imp;
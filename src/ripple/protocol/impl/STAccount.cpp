@@ -32,10 +32,12 @@ STAccount::STAccount(SField const& n)
 {
 }
 
-STAccount::STAccount(SField const& n, Buffer&& v) : STAccount(n)
+// Read a serialized account into `value`, returning false if it is empty.
+static bool
+readAccount(Slice v, AccountID& value)
 {
     if (v.empty())
-        return;  // Zero is a valid size for a defaulted STAccount.
+        return false;  // Zero is a valid size for a defaulted STAccount.
 
     // Is it safe to throw from this constructor?  Today (November 2015)
     // the only place that calls this constructor is
@@ -45,13 +47,21 @@ STAccount::STAccount(SField const& n, Buffer&& v) : STAccount(n)
     if (v.size() != uint160::bytes)
         Throw<std::runtime_error>("Invalid STAccount size");
 
-    default_ = false;
-    memcpy(value_.begin(), v.data(), uint160::bytes);
+    memcpy(value.begin(), v.data(), uint160::bytes);
+    return true;
+}
+
+STAccount::STAccount(SField const& n, Buffer&& v) : STAccount(n)
+{
+    if (readAccount(Slice(v.data(), v.size()), value_))
+        default_ = false;
 }
 
-STAccount::STAccount(SerialIter& sit, SField const& name)
-    : STAccount(name, sit.getVLBuffer())
+STAccount::STAccount(SerialIter& sit, SField const& name) : STAccount(name)
 {
+    // The account is copied straight out of the data being read
+    if (readAccount(sit.getVLSlice(), value_))
+        default_ = false;
 }
 
 STAccount::STAccount(SField const& n, AccountID const& v)
@@ -64,7 +74,7 @@ STAccount::getText() const
 {
     if (isDefault())
         return "";
-    return toBase58(value());
+    return toBase58Cached(value());
 }
 
 }  // namespace ripple
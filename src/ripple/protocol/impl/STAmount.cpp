@@ -471,7 +471,7 @@ STAmount::setJson(Json::Value& elem) const
         // json.
         elem[jss::value] = getText();
         elem[jss::currency] = to_string(mIssue.currency);
-        elem[jss::issuer] = to_string(mIssue.account);
+        elem[jss::issuer] = toBase58Cached(mIssue.account);
     }
     else
     {
@@ -1032,6 +1032,14 @@ operator-(STAmount const& value)
 //
 //------------------------------------------------------------------------------
 
+// The products of two mantissas need 128 bits. Use the compiler's own
+// 128-bit integer where there is one; the results are identical.
+#ifdef __SIZEOF_INT128__
+using uint128_t = unsigned __int128;
+#else
+using uint128_t = boost::multiprecision::uint128_t;
+#endif
+
 // Calculate (a * b) / c when all three values are 64-bit
 // without loss of precision:
 static std::uint64_t
@@ -1040,9 +1048,7 @@ muldiv(
     std::uint64_t multiplicand,
     std::uint64_t divisor)
 {
-    boost::multiprecision::uint128_t ret;
-
-    boost::multiprecision::multiply(ret, multiplier, multiplicand);
+    uint128_t ret = static_cast<uint128_t>(multiplier) * multiplicand;
     ret /= divisor;
 
     if (ret > std::numeric_limits<std::uint64_t>::max())
@@ -1062,9 +1068,7 @@ muldiv_round(
     std::uint64_t divisor,
     std::uint64_t rounding)
 {
-    boost::multiprecision::uint128_t ret;
-
-    boost::multiprecision::multiply(ret, multiplier, multiplicand);
+    uint128_t ret = static_cast<uint128_t>(multiplier) * multiplicand;
     ret += rounding;
     ret /= divisor;
 
@@ -19,6 +19,7 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/basics/contract.h>
+#include <ripple/json/Writer.h>
 #include <ripple/protocol/STArray.h>
 #include <ripple/protocol/STBase.h>
 
@@ -142,6 +143,23 @@ STArray::getJson(JsonOptions p) const
     return v;
 }
 
+void
+STArray::writeJson(Json::Writer& w, JsonOptions options) const
+{
+    w.startRoot(Json::Writer::array);
+    for (auto const& object : v_)
+    {
+        if (object.getSType() != STI_NOTPRESENT)
+        {
+            w.startAppend(Json::Writer::object);
+            w.rawSet(object.getFName().getJsonName().c_str());
+            object.writeJson(w, options);
+            w.finish();
+        }
+    }
+    w.finish();
+}
+
 void
 STArray::add(Serializer& s) const
 {
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/json/Writer.h>
 #include <ripple/protocol/STBase.h>
 #include <boost/checked_delete.hpp>
 #include <cassert>
@@ -89,6 +90,12 @@ Json::Value STBase::getJson(JsonOptions /*options*/) const
     return getText();
 }
 
+void
+STBase::writeJson(Json::Writer& w, JsonOptions options) const
+{
+    w.output(getJson(options));
+}
+
 void
 STBase::add(Serializer& s) const
 {
@@ -20,6 +20,7 @@
 #include <ripple/basics/Log.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
+#include <ripple/json/Writer.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/STLedgerEntry.h>
@@ -115,6 +116,12 @@ STLedgerEntry::getJson(JsonOptions options) const
     return ret;
 }
 
+void
+STLedgerEntry::writeJson(Json::Writer& w, JsonOptions options) const
+{
+    writeFieldsJson(w, options, jss::index, to_string(key_));
+}
+
 bool
 STLedgerEntry::isThreadedType() const
 {
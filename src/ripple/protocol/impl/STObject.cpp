@@ -18,16 +18,32 @@
 //==============================================================================
 
 #include <ripple/basics/Log.h>
+#include <ripple/json/Writer.h>
 #include <ripple/protocol/InnerObjectFormats.h>
 #include <ripple/protocol/STAccount.h>
 #include <ripple/protocol/STArray.h>
 #include <ripple/protocol/STBlob.h>
 #include <ripple/protocol/STObject.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 
 namespace ripple {
 
 STObject::STObject(STObject&& other)
-    : STBase(other.getFName()), v_(std::move(other.v_)), mType(other.mType)
+    : STBase(other.getFName())
+    , v_(std::move(other.v_))
+    , leaked_(other.leaked_)
+    , mType(other.mType)
+{
+}
+
+STObject::STObject(STObject const& other)
+    : STBase(other)
+    , CountedObject<STObject>(other)
+    , v_(other.leaked_ && other.v_ ? std::make_shared<list_type>(*other.v_)
+                                   : other.v_)
+    , mType(other.mType)
 {
 }
 
@@ -46,7 +62,7 @@ STObject::STObject(
     SField const& name) noexcept(false)
     : STBase(name)
 {
-    v_.reserve(type.size());
+    reserve(type.size());
     set(sit);
     applyTemplate(type);  // May throw
 }
@@ -66,22 +82,66 @@ STObject::operator=(STObject&& other)
     setFName(other.getFName());
     mType = other.mType;
     v_ = std::move(other.v_);
+    leaked_ = other.leaked_;
+    return *this;
+}
+
+STObject&
+STObject::operator=(STObject const& other)
+{
+    if (this != &other)
+    {
+        STBase::operator=(other);
+        v_ = other.leaked_ && other.v_
+            ? std::make_shared<list_type>(*other.v_)
+            : other.v_;
+        leaked_ = false;
+        mType = other.mType;
+    }
     return *this;
 }
 
+STObject::list_type const&
+STObject::emptyFields()
+{
+    static list_type const empty;
+    return empty;
+}
+
+STObject::list_type&
+STObject::mutableFields()
+{
+    if (!v_)
+    {
+        v_ = std::make_shared<list_type>();
+    }
+    else if (v_.use_count() != 1)
+    {
+        v_ = std::make_shared<list_type>(*v_);
+    }
+    else
+    {
+        // The last other owner may have just let go on another thread.
+        // Make sure its reads happen before our writes.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *v_;
+}
+
 void
 STObject::set(const SOTemplate& type)
 {
-    v_.clear();
-    v_.reserve(type.size());
+    auto& v = mutableFields();
+    v.clear();
+    v.reserve(type.size());
     mType = &type;
 
     for (auto const& elem : type)
     {
         if (elem.style() != soeREQUIRED)
-            v_.emplace_back(detail::nonPresentObject, elem.sField());
+            v.emplace_back(detail::nonPresentObject, elem.sField());
         else
-            v_.emplace_back(detail::defaultObject, elem.sField());
+            v.emplace_back(detail::defaultObject, elem.sField());
     }
 }
 
@@ -97,15 +157,16 @@ STObject::applyTemplate(const SOTemplate& type) noexcept(false)
     };
 
     mType = &type;
-    decltype(v_) v;
+    auto& fields = mutableFields();
+    list_type v;
     v.reserve(type.size());
     for (auto const& e : type)
     {
-        auto const iter =
-            std::find_if(v_.begin(), v_.end(), [&](detail::STVar const& b) {
+        auto const iter = std::find_if(
+            fields.begin(), fields.end(), [&](detail::STVar const& b) {
                 return b.get().getFName() == e.sField();
             });
-        if (iter != v_.end())
+        if (iter != fields.end())
         {
             if ((e.style() == soeDEFAULT) && iter->get().isDefault())
             {
@@ -114,7 +175,7 @@ STObject::applyTemplate(const SOTemplate& type) noexcept(false)
                     "may not be explicitly set to default.");
             }
             v.emplace_back(std::move(*iter));
-            v_.erase(iter);
+            fields.erase(iter);
         }
         else
         {
@@ -125,7 +186,7 @@ STObject::applyTemplate(const SOTemplate& type) noexcept(false)
             v.emplace_back(detail::nonPresentObject, e.sField());
         }
     }
-    for (auto const& e : v_)
+    for (auto const& e : fields)
     {
         // Anything left over in the object must be discardable
         if (!e->getFName().isDiscardable())
@@ -136,7 +197,7 @@ STObject::applyTemplate(const SOTemplate& type) noexcept(false)
     }
     // Swap the template matching data in for the old data,
     // freeing any leftover junk
-    v_.swap(v);
+    fields.swap(v);
 }
 
 void
@@ -154,7 +215,8 @@ STObject::set(SerialIter& sit, int depth) noexcept(false)
 {
     bool reachedEndOfObject = false;
 
-    v_.clear();
+    auto& v = mutableFields();
+    v.clear();
 
     // Consume data in the pipe until we run out or reach the end
     while (!sit.empty())
@@ -190,10 +252,10 @@ STObject::set(SerialIter& sit, int depth) noexcept(false)
         }
 
         // Unflatten the field
-        v_.emplace_back(sit, fn, depth + 1);
+        v.emplace_back(sit, fn, depth + 1);
 
         // If the object type has a known SOTemplate then set it.
-        if (auto const obj = dynamic_cast<STObject*>(&(v_.back().get())))
+        if (auto const obj = dynamic_cast<STObject*>(&(v.back().get())))
             obj->applyTemplateFromSField(fn);  // May throw
     }
 
@@ -237,7 +299,7 @@ STObject::getFullText() const
     else
         ret = "{";
 
-    for (auto const& elem : v_)
+    for (auto const& elem : fields())
     {
         if (elem->getSType() != STI_NOTPRESENT)
         {
@@ -259,7 +321,7 @@ STObject::getText() const
 {
     std::string ret = "{";
     bool first = false;
-    for (auto const& elem : v_)
+    for (auto const& elem : fields())
     {
         if (!first)
         {
@@ -281,6 +343,10 @@ STObject::isEquivalent(const STBase& t) const
     if (!v)
         return false;
 
+    // Copies that still share their fields are equal
+    if (v_ && v_ == v->v_ && mType == v->mType)
+        return true;
+
     if (mType != nullptr && v->mType == mType)
     {
         return std::equal(
@@ -333,7 +399,7 @@ STObject::getFieldIndex(SField const& field) const
         return mType->getIndex(field);
 
     int i = 0;
-    for (auto const& elem : v_)
+    for (auto const& elem : fields())
     {
         if (elem->getFName() == field)
             return i;
@@ -367,7 +433,7 @@ STObject::getField(SField const& field)
 SField const&
 STObject::getFieldSType(int index) const
 {
-    return v_[index]->getFName();
+    return fields()[index]->getFName();
 }
 
 const STBase*
@@ -383,18 +449,25 @@ STObject::peekAtPField(SField const& field) const
 
 STBase*
 STObject::getPField(SField const& field, bool createOkay)
+{
+    leaked_ = true;
+    return writablePField(field, createOkay);
+}
+
+STBase*
+STObject::writablePField(SField const& field, bool createOkay)
 {
     int index = getFieldIndex(field);
 
     if (index == -1)
     {
         if (createOkay && isFree())
-            return getPIndex(emplace_back(detail::defaultObject, field));
-
-        return nullptr;
+            index = emplace_back(detail::defaultObject, field);
+        else
+            return nullptr;
     }
 
-    return getPIndex(index);
+    return &mutableFields()[index].get();
 }
 
 bool
@@ -423,7 +496,7 @@ STObject::peekFieldArray(SField const& field)
 bool
 STObject::setFlag(std::uint32_t f)
 {
-    STUInt32* t = dynamic_cast<STUInt32*>(getPField(sfFlags, true));
+    STUInt32* t = dynamic_cast<STUInt32*>(writablePField(sfFlags, true));
 
     if (!t)
         return false;
@@ -435,7 +508,7 @@ STObject::setFlag(std::uint32_t f)
 bool
 STObject::clearFlag(std::uint32_t f)
 {
-    STUInt32* t = dynamic_cast<STUInt32*>(getPField(sfFlags));
+    STUInt32* t = dynamic_cast<STUInt32*>(writablePField(sfFlags, false));
 
     if (!t)
         return false;
@@ -463,6 +536,13 @@ STObject::getFlags(void) const
 
 STBase*
 STObject::makeFieldPresent(SField const& field)
+{
+    leaked_ = true;
+    return writableFieldPresent(field);
+}
+
+STBase*
+STObject::writableFieldPresent(SField const& field)
 {
     int index = getFieldIndex(field);
 
@@ -471,16 +551,18 @@ STObject::makeFieldPresent(SField const& field)
         if (!isFree())
             throwFieldNotFound(field);
 
-        return getPIndex(emplace_back(detail::nonPresentObject, field));
+        index = emplace_back(detail::nonPresentObject, field);
+        return &mutableFields()[index].get();
     }
 
-    STBase* f = getPIndex(index);
+    auto& v = mutableFields();
+    STBase* f = &v[index].get();
 
     if (f->getSType() != STI_NOTPRESENT)
         return f;
 
-    v_[index] = detail::STVar(detail::defaultObject, f->getFName());
-    return getPIndex(index);
+    v[index] = detail::STVar(detail::defaultObject, f->getFName());
+    return &v[index].get();
 }
 
 void
@@ -495,7 +577,8 @@ STObject::makeFieldAbsent(SField const& field)
 
     if (f.getSType() == STI_NOTPRESENT)
         return;
-    v_[index] = detail::STVar(detail::nonPresentObject, f.getFName());
+    mutableFields()[index] =
+        detail::STVar(detail::nonPresentObject, f.getFName());
 }
 
 bool
@@ -513,7 +596,8 @@ STObject::delField(SField const& field)
 void
 STObject::delField(int index)
 {
-    v_.erase(v_.begin() + index);
+    auto& v = mutableFields();
+    v.erase(v.begin() + index);
 }
 
 unsigned char
@@ -606,13 +690,13 @@ STObject::set(std::unique_ptr<STBase> v)
     auto const i = getFieldIndex(v->getFName());
     if (i != -1)
     {
-        v_[i] = std::move(*v);
+        mutableFields()[i] = std::move(*v);
     }
     else
     {
         if (!isFree())
             Throw<std::runtime_error>("missing field in templated STObject");
-        v_.emplace_back(std::move(*v));
+        mutableFields().emplace_back(std::move(*v));
     }
 }
 
@@ -699,7 +783,7 @@ STObject::getJson(JsonOptions options) const
 {
     Json::Value ret(Json::objectValue);
 
-    for (auto const& elem : v_)
+    for (auto const& elem : fields())
     {
         if (elem->getSType() != STI_NOTPRESENT)
             ret[elem->getFName().getJsonName()] = elem->getJson(options);
@@ -707,19 +791,63 @@ STObject::getJson(JsonOptions options) const
     return ret;
 }
 
+void
+STObject::writeJson(Json::Writer& w, JsonOptions options) const
+{
+    writeFieldsJson(w, options, nullptr, {});
+}
+
+void
+STObject::writeFieldsJson(
+    Json::Writer& w,
+    JsonOptions options,
+    char const* extraKey,
+    std::string const& extraValue) const
+{
+    auto const nameOf = [](STBase const* field) {
+        return field->getFName().getJsonName().c_str();
+    };
+
+    boost::container::small_vector<STBase const*, 32> present;
+    for (auto const& elem : fields())
+    {
+        if (elem->getSType() != STI_NOTPRESENT &&
+            (extraKey == nullptr || std::strcmp(nameOf(&*elem), extraKey) != 0))
+            present.push_back(&*elem);
+    }
+    std::sort(present.begin(), present.end(), [&](auto a, auto b) {
+        return std::strcmp(nameOf(a), nameOf(b)) < 0;
+    });
+
+    w.startRoot(Json::Writer::object);
+    for (auto const field : present)
+    {
+        if (extraKey != nullptr && std::strcmp(extraKey, nameOf(field)) < 0)
+        {
+            w.set(extraKey, extraValue);
+            extraKey = nullptr;
+        }
+        w.rawSet(nameOf(field));
+        field->writeJson(w, options);
+    }
+    if (extraKey != nullptr)
+        w.set(extraKey, extraValue);
+    w.finish();
+}
+
 bool
 STObject::operator==(const STObject& obj) const
 {
     // This is not particularly efficient, and only compares data elements
     // with binary representations
     int matches = 0;
-    for (auto const& t1 : v_)
+    for (auto const& t1 : fields())
     {
         if ((t1->getSType() != STI_NOTPRESENT) && t1->getFName().isBinary())
         {
             // each present field must have a matching field
             bool match = false;
-            for (auto const& t2 : obj.v_)
+            for (auto const& t2 : obj.fields())
             {
                 if (t1->getFName() == t2->getFName())
                 {
@@ -738,7 +866,7 @@ STObject::operator==(const STObject& obj) const
     }
 
     int fields = 0;
-    for (auto const& t2 : obj.v_)
+    for (auto const& t2 : obj.fields())
     {
         if ((t2->getSType() != STI_NOTPRESENT) && t2->getFName().isBinary())
             ++fields;
@@ -782,7 +910,7 @@ STObject::getSortedFields(STObject const& objToSort, WhichFields whichFields)
     sf.reserve(objToSort.getCount());
 
     // Choose the fields that we need to sort.
-    for (detail::STVar const& elem : objToSort.v_)
+    for (detail::STVar const& elem : objToSort.fields())
     {
         STBase const& base = elem.get();
         if ((base.getSType() != STI_NOTPRESENT) &&
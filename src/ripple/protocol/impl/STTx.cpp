@@ -21,6 +21,7 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
+#include <ripple/json/Writer.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/Feature.h>
 #include <ripple/protocol/HashPrefix.h>
@@ -228,6 +229,13 @@ STTx::getJson(JsonOptions options, bool binary) const
     return getJson(options);
 }
 
+void
+STTx::writeJson(Json::Writer& w, JsonOptions) const
+{
+    writeFieldsJson(
+        w, JsonOptions::none, jss::hash, to_string(getTransactionID()));
+}
+
 std::string const&
 STTx::getMetaSQLInsertReplaceHeader()
 {
@@ -21,10 +21,96 @@
 #include <ripple/basics/contract.h>
 #include <ripple/protocol/Serializer.h>
 #include <ripple/protocol/digest.h>
+#include <algorithm>
+#include <array>
 #include <type_traits>
 
 namespace ripple {
 
+namespace detail {
+
+// Buffers larger than this are given back to the allocator, so one large
+// serialization does not pin its memory to the thread.
+static constexpr std::size_t maxPooledCapacity = 4096;
+
+// The data of a Serializer is often moved out and kept. A pooled buffer is
+// only handed out if it is not much larger than what was asked for, so
+// what is kept does not waste much memory.
+static bool
+fitsRequest(std::size_t capacity, std::size_t n)
+{
+    return capacity <= std::max<std::size_t>(4 * n, 1024);
+}
+
+class SerializerPool
+{
+private:
+    std::array<Blob, 8> buffers_;
+    std::size_t count_ = 0;
+
+public:
+    // Set once the pool of the thread is gone, for Serializers destroyed
+    // after it during thread or program exit.
+    static thread_local bool destroyed;
+
+    ~SerializerPool()
+    {
+        destroyed = true;
+    }
+
+    static SerializerPool*
+    get()
+    {
+        if (destroyed)
+            return nullptr;
+        thread_local SerializerPool pool;
+        return &pool;
+    }
+
+    Blob
+    take(std::size_t n)
+    {
+        Blob buffer;
+        if (count_ != 0 && fitsRequest(buffers_[count_ - 1].capacity(), n))
+            buffer = std::move(buffers_[--count_]);
+        buffer.reserve(n);
+        return buffer;
+    }
+
+    void
+    give(Blob& buffer) noexcept
+    {
+        if (count_ == buffers_.size())
+            return;
+        buffer.clear();
+        buffers_[count_++] = std::move(buffer);
+    }
+};
+
+thread_local bool SerializerPool::destroyed = false;
+
+Blob
+borrowSerializerBuffer(std::size_t n)
+{
+    if (auto const pool = SerializerPool::get())
+        return pool->take(n);
+    Blob buffer;
+    buffer.reserve(n);
+    return buffer;
+}
+
+void
+returnSerializerBuffer(Blob& buffer) noexcept
+{
+    auto const capacity = buffer.capacity();
+    if (capacity == 0 || capacity > maxPooledCapacity)
+        return;
+    if (auto const pool = SerializerPool::get())
+        pool->give(buffer);
+}
+
+}  // namespace detail
+
 int
 Serializer::add16(std::uint16_t i)
 {
@@ -104,6 +190,14 @@ Serializer::addRaw(Blob const& vector)
     return ret;
 }
 
+int
+Serializer::addRaw(Slice slice)
+{
+    int ret = mData.size();
+    mData.insert(mData.end(), slice.begin(), slice.end());
+    return ret;
+}
+
 int
 Serializer::addRaw(const Serializer& s)
 {
@@ -20,7 +20,18 @@
 #include <ripple/protocol/digest.h>
 #include <openssl/ripemd.h>
 #include <openssl/sha.h>
+#include <algorithm>
+#include <cstring>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RIPPLE_SHA512_MULTIBUFFER 1
+#include <immintrin.h>
+#else
+#define RIPPLE_SHA512_MULTIBUFFER 0
+#endif
 
 namespace ripple {
 
@@ -103,4 +114,332 @@ openssl_sha256_hasher::operator result_type() noexcept
     return digest;
 }
 
+//------------------------------------------------------------------------------
+
+namespace {
+
+void
+storeBigEndian(std::uint8_t* p, std::uint64_t v)
+{
+    for (int i = 7; i >= 0; --i, v >>= 8)
+        p[i] = static_cast<std::uint8_t>(v);
+}
+
+}  // namespace
+
+namespace detail {
+
+uint256
+sha512HalfBlock(std::uint8_t* block, std::size_t size, bool secure) noexcept
+{
+    // The message is followed by a one bit, zeros and its length in bits
+    // as a 128 bit big endian integer, of which only the last two bytes
+    // are needed here.
+    auto const bits = size * 8;
+    block[size] = 0x80;
+    std::memset(block + size + 1, 0, 128 - size - 3);
+    block[126] = static_cast<std::uint8_t>(bits >> 8);
+    block[127] = static_cast<std::uint8_t>(bits);
+
+    // OpenSSL picks the fastest compression function for this processor
+    // (AVX2, AVX, SHA512 extensions on ARMv8 and so on) at startup.
+    SHA512_CTX ctx;
+    SHA512_Init(&ctx);
+    SHA512_Transform(&ctx, block);
+
+    uint256 digest;
+    for (int i = 0; i < 4; ++i)
+        storeBigEndian(digest.data() + 8 * i, ctx.h[i]);
+    if (secure)
+        secure_erase(&ctx, sizeof(ctx));
+    return digest;
+}
+
+}  // namespace detail
+
+//------------------------------------------------------------------------------
+
+#if RIPPLE_SHA512_MULTIBUFFER
+
+namespace {
+
+// SHA-512 round constants
+constexpr std::uint64_t sha512K[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+    0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+    0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+    0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+    0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+    0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+    0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+    0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+    0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+    0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+    0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+    0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+    0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+    0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+    0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+    0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+    0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL};
+
+// SHA-512 initial hash value
+constexpr std::uint64_t sha512H[8] = {
+    0x6a09e667f3bcc908ULL,
+    0xbb67ae8584caa73bULL,
+    0x3c6ef372fe94f82bULL,
+    0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL,
+    0x9b05688c2b3e6c1fULL,
+    0x1f83d9abfb41bd6bULL,
+    0x5be0cd19137e2179ULL};
+
+// SHA-512 works on 128 byte blocks. A message is followed by a one
+// bit, zeros and its length in bits as a 128 bit big endian integer.
+constexpr std::size_t blockSize = 128;
+
+std::size_t
+paddedBlocks(std::size_t size)
+{
+    return (size + 1 + 16 + blockSize - 1) / blockSize;
+}
+
+// The blocks of a padded message. Whole blocks are read in place and
+// the rest of the message is copied into a tail along with the padding.
+class PaddedMessage
+{
+public:
+    void
+    assign(Slice const& message)
+    {
+        data_ = message.data();
+        full_ = message.size() / blockSize;
+
+        auto const rest = message.size() % blockSize;
+        std::memcpy(tail_, data_ + full_ * blockSize, rest);
+        std::memset(tail_ + rest, 0, sizeof(tail_) - rest);
+        tail_[rest] = 0x80;
+
+        auto const tailSize =
+            (paddedBlocks(message.size()) - full_) * blockSize;
+        auto bits = static_cast<std::uint64_t>(message.size()) * 8;
+        for (std::size_t i = 0; i < 8; ++i, bits >>= 8)
+            tail_[tailSize - 1 - i] = static_cast<std::uint8_t>(bits);
+    }
+
+    std::uint8_t const*
+    block(std::size_t n) const
+    {
+        if (n < full_)
+            return data_ + n * blockSize;
+        return tail_ + (n - full_) * blockSize;
+    }
+
+private:
+    std::uint8_t const* data_ = nullptr;
+    std::size_t full_ = 0;
+    std::uint8_t tail_[2 * blockSize];
+};
+
+#define RIPPLE_TARGET_AVX2 __attribute__((target("avx2")))
+
+// Messages hashed together by the AVX2 kernel
+constexpr std::size_t avx2Lanes = 4;
+
+template <int n>
+RIPPLE_TARGET_AVX2 inline __m256i
+rotr(__m256i x)
+{
+    return _mm256_or_si256(
+        _mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - n));
+}
+
+// Hash four messages with the same number of padded blocks
+RIPPLE_TARGET_AVX2 void
+sha512HalfAVX2(
+    PaddedMessage const* messages,
+    std::size_t blocks,
+    uint256* digests)
+{
+    __m256i state[8];
+    for (int i = 0; i < 8; ++i)
+        state[i] = _mm256_set1_epi64x(static_cast<long long>(sha512H[i]));
+
+    auto const byteSwap = _mm256_set_epi8(
+        8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+        8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256i w[80];
+    for (std::size_t n = 0; n < blocks; ++n)
+    {
+        std::uint8_t const* p[avx2Lanes];
+        for (std::size_t l = 0; l < avx2Lanes; ++l)
+            p[l] = messages[l].block(n);
+
+        // Load four words from each lane, swap them to native order and
+        // transpose them so that each vector holds one word of every lane.
+        for (int t = 0; t < 16; t += 4)
+        {
+            __m256i r[avx2Lanes];
+            for (std::size_t l = 0; l < avx2Lanes; ++l)
+            {
+                r[l] = _mm256_shuffle_epi8(
+                    _mm256_loadu_si256(
+                        reinterpret_cast<__m256i const*>(p[l] + 8 * t)),
+                    byteSwap);
+            }
+
+            auto const lo01 = _mm256_unpacklo_epi64(r[0], r[1]);
+            auto const hi01 = _mm256_unpackhi_epi64(r[0], r[1]);
+            auto const lo23 = _mm256_unpacklo_epi64(r[2], r[3]);
+            auto const hi23 = _mm256_unpackhi_epi64(r[2], r[3]);
+            w[t] = _mm256_permute2x128_si256(lo01, lo23, 0x20);
+            w[t + 1] = _mm256_permute2x128_si256(hi01, hi23, 0x20);
+            w[t + 2] = _mm256_permute2x128_si256(lo01, lo23, 0x31);
+            w[t + 3] = _mm256_permute2x128_si256(hi01, hi23, 0x31);
+        }
+
+        for (int t = 16; t < 80; ++t)
+        {
+            auto const x = w[t - 15];
+            auto const y = w[t - 2];
+            auto const s0 = _mm256_xor_si256(
+                _mm256_xor_si256(rotr<1>(x), rotr<8>(x)),
+                _mm256_srli_epi64(x, 7));
+            auto const s1 = _mm256_xor_si256(
+                _mm256_xor_si256(rotr<19>(y), rotr<61>(y)),
+                _mm256_srli_epi64(y, 6));
+            w[t] = _mm256_add_epi64(
+                _mm256_add_epi64(w[t - 16], s0),
+                _mm256_add_epi64(w[t - 7], s1));
+        }
+
+        auto a = state[0];
+        auto b = state[1];
+        auto c = state[2];
+        auto d = state[3];
+        auto e = state[4];
+        auto f = state[5];
+        auto g = state[6];
+        auto h = state[7];
+
+        for (int t = 0; t < 80; ++t)
+        {
+            auto const S1 = _mm256_xor_si256(
+                _mm256_xor_si256(rotr<14>(e), rotr<18>(e)), rotr<41>(e));
+            auto const ch = _mm256_xor_si256(
+                _mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            auto const t1 = _mm256_add_epi64(
+                _mm256_add_epi64(_mm256_add_epi64(h, S1), ch),
+                _mm256_add_epi64(
+                    _mm256_set1_epi64x(static_cast<long long>(sha512K[t])),
+                    w[t]));
+            auto const S0 = _mm256_xor_si256(
+                _mm256_xor_si256(rotr<28>(a), rotr<34>(a)), rotr<39>(a));
+            auto const maj = _mm256_xor_si256(
+                _mm256_and_si256(a, _mm256_xor_si256(b, c)),
+                _mm256_and_si256(b, c));
+            auto const t2 = _mm256_add_epi64(S0, maj);
+
+            h = g;
+            g = f;
+            f = e;
+            e = _mm256_add_epi64(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm256_add_epi64(t1, t2);
+        }
+
+        state[0] = _mm256_add_epi64(state[0], a);
+        state[1] = _mm256_add_epi64(state[1], b);
+        state[2] = _mm256_add_epi64(state[2], c);
+        state[3] = _mm256_add_epi64(state[3], d);
+        state[4] = _mm256_add_epi64(state[4], e);
+        state[5] = _mm256_add_epi64(state[5], f);
+        state[6] = _mm256_add_epi64(state[6], g);
+        state[7] = _mm256_add_epi64(state[7], h);
+    }
+
+    // The half digest is the first four words of each lane
+    alignas(32) std::uint64_t words[4][avx2Lanes];
+    for (int i = 0; i < 4; ++i)
+        _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), state[i]);
+
+    for (std::size_t l = 0; l < avx2Lanes; ++l)
+    {
+        for (int i = 0; i < 4; ++i)
+            storeBigEndian(digests[l].data() + 8 * i, words[i][l]);
+    }
+}
+
+bool
+hasAVX2()
+{
+    static bool const avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+}  // namespace
+
+#endif
+
+void
+sha512HalfBatch(Slice const* messages, uint256* digests, std::size_t count)
+{
+    auto const scalar = [&](std::size_t i) {
+        sha512_half_hasher h;
+        h(messages[i].data(), messages[i].size());
+        digests[i] = static_cast<sha512_half_hasher::result_type>(h);
+    };
+
+#if RIPPLE_SHA512_MULTIBUFFER
+    if (count >= avx2Lanes && hasAVX2())
+    {
+        // Group the messages by padded length, since the lanes of the
+        // kernel must all run the same number of blocks.
+        std::vector<std::pair<std::size_t, std::size_t>> order;
+        order.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            order.emplace_back(paddedBlocks(messages[i].size()), i);
+        std::sort(order.begin(), order.end());
+
+        PaddedMessage padded[avx2Lanes];
+        std::size_t i = 0;
+        while (i < count)
+        {
+            auto const blocks = order[i].first;
+            if (i + avx2Lanes > count ||
+                order[i + avx2Lanes - 1].first != blocks)
+            {
+                scalar(order[i++].second);
+                continue;
+            }
+
+            uint256 result[avx2Lanes];
+            for (std::size_t l = 0; l < avx2Lanes; ++l)
+                padded[l].assign(messages[order[i + l].second]);
+            sha512HalfAVX2(padded, blocks, result);
+            for (std::size_t l = 0; l < avx2Lanes; ++l)
+                digests[order[i + l].second] = result[l];
+            i += avx2Lanes;
+        }
+        return;
+    }
+#endif
+
+    for (std::size_t i = 0; i < count; ++i)
+        scalar(i);
+}
+
 }  // namespace ripple
@@ -88,19 +88,24 @@ checksum(void* out, void const* message, std::size_t size)
 
 namespace detail {
 
-/* The base58 encoding & decoding routines in this namespace are taken from
- * Bitcoin but have been modified from the original.
+/* The base58 encoding & decoding routines in this namespace were taken
+ * from Bitcoin, then changed to work a word at a time.
  *
  * Copyright (c) 2014 The Bitcoin Core developers
  * Distributed under the MIT software license, see the accompanying
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.
+ *
+ * Rather than one base58 digit per pass over the value, each pass divides
+ * the value, held in 32 bit words, by 58^5 and produces five digits. The
+ * decoder likewise multiplies in five digits at a time.
  */
+
+// The largest power of 58 that fits in 32 bits, and its exponent
+static constexpr std::uint64_t b58Chunk = 58ull * 58 * 58 * 58 * 58;
+static constexpr int b58ChunkDigits = 5;
+
 static std::string
-encodeBase58(
-    void const* message,
-    std::size_t size,
-    void* temp,
-    std::size_t temp_size)
+encodeBase58(void const* message, std::size_t size)
 {
     auto pbegin = reinterpret_cast<unsigned char const*>(message);
     auto const pend = pbegin + size;
@@ -113,36 +118,56 @@ encodeBase58(
         zeroes++;
     }
 
-    auto const b58begin = reinterpret_cast<unsigned char*>(temp);
-    auto const b58end = b58begin + temp_size;
+    // The rest of the message as big endian 32 bit words
+    auto const bytes = static_cast<std::size_t>(pend - pbegin);
+    boost::container::small_vector<std::uint32_t, 64> words(
+        (bytes + 3) / 4);
+    {
+        auto word = words.begin();
+        auto const lead = bytes % 4 ? bytes % 4 : 4;
+        for (std::size_t i = 0; pbegin != pend; ++i)
+        {
+            if (i >= lead && (i - lead) % 4 == 0)
+                ++word;
+            *word = (*word << 8) | *pbegin++;
+        }
+    }
 
-    std::fill(b58begin, b58end, 0);
+    // Digits, least significant first. 138 / 100 digits per byte,
+    // rounded up to whole chunks.
+    boost::container::small_vector<std::uint8_t, 128> digits;
+    digits.reserve(bytes * 138 / 100 + b58ChunkDigits + 1);
 
-    while (pbegin != pend)
+    auto first = words.begin();
+    while (first != words.end())
     {
-        int carry = *pbegin;
-        // Apply "b58 = b58 * 256 + ch".
-        for (auto iter = b58end; iter != b58begin; --iter)
+        std::uint64_t rem = 0;
+        for (auto w = first; w != words.end(); ++w)
         {
-            carry += 256 * (iter[-1]);
-            iter[-1] = carry % 58;
-            carry /= 58;
+            auto const cur = (rem << 32) | *w;
+            *w = static_cast<std::uint32_t>(cur / b58Chunk);
+            rem = cur % b58Chunk;
+        }
+        while (first != words.end() && *first == 0)
+            ++first;
+
+        for (int i = 0; i < b58ChunkDigits; ++i)
+        {
+            digits.push_back(static_cast<std::uint8_t>(rem % 58));
+            rem /= 58;
         }
-        assert(carry == 0);
-        pbegin++;
     }
 
-    // Skip leading zeroes in base58 result.
-    auto iter = b58begin;
-    while (iter != b58end && *iter == 0)
-        ++iter;
+    // The last chunk may have been padded with zero digits
+    while (!digits.empty() && digits.back() == 0)
+        digits.pop_back();
 
     // Translate the result into a string.
     std::string str;
-    str.reserve(zeroes + (b58end - iter));
+    str.reserve(zeroes + digits.size());
     str.assign(zeroes, alphabetForward[0]);
-    while (iter != b58end)
-        str += alphabetForward[*(iter++)];
+    for (auto iter = digits.rbegin(); iter != digits.rend(); ++iter)
+        str += alphabetForward[*iter];
     return str;
 }
 
@@ -163,33 +188,53 @@ decodeBase58(std::string const& s)
     if (remain > 64)
         return {};
 
-    // Allocate enough space in big-endian base256 representation.
-    // log(58) / log(256), rounded up.
-    std::vector<unsigned char> b256(remain * 733 / 1000 + 1);
+    // The value as 32 bit words, least significant first. Enough for
+    // log(58) / log(256) bytes per digit, rounded up.
+    boost::container::small_vector<std::uint32_t, 16> words(
+        (remain * 733 / 1000 + 1 + 3) / 4);
+
     while (remain > 0)
     {
-        auto carry = alphabetReverse[*psz];
-        if (carry == -1)
-            return {};
-        // Apply "b256 = b256 * 58 + carry".
-        for (auto iter = b256.rbegin(); iter != b256.rend(); ++iter)
+        // Up to five digits at a time
+        std::uint64_t mult = 1;
+        std::uint64_t carry = 0;
+        for (int i = 0; i < b58ChunkDigits && remain > 0; ++i)
+        {
+            auto const digit = alphabetReverse[*psz];
+            if (digit == -1)
+                return {};
+            carry = carry * 58 + digit;
+            mult *= 58;
+            ++psz;
+            --remain;
+        }
+
+        // Apply "words = words * mult + carry".
+        for (auto& w : words)
         {
-            carry += 58 * *iter;
-            *iter = carry % 256;
-            carry /= 256;
+            carry += mult * w;
+            w = static_cast<std::uint32_t>(carry);
+            carry >>= 32;
         }
         assert(carry == 0);
-        ++psz;
-        --remain;
     }
-    // Skip leading zeroes in b256.
-    auto iter = std::find_if(
-        b256.begin(), b256.end(), [](unsigned char c) { return c != 0; });
+
+    // Lay the words out big endian, skipping leading zero bytes.
     std::string result;
-    result.reserve(zeroes + (b256.end() - iter));
+    result.reserve(zeroes + words.size() * 4);
     result.assign(zeroes, 0x00);
-    while (iter != b256.end())
-        result.push_back(*(iter++));
+    bool leading = true;
+    for (auto w = words.rbegin(); w != words.rend(); ++w)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            auto const byte = static_cast<char>((*w >> shift) & 0xff);
+            if (leading && byte == 0)
+                continue;
+            leading = false;
+            result.push_back(byte);
+        }
+    }
     return result;
 }
 
@@ -201,12 +246,7 @@ encodeBase58Token(TokenType type, void const* token, std::size_t size)
     // expanded token includes type + 4 byte checksum
     auto const expanded = 1 + size + 4;
 
-    // We need expanded + expanded * (log(256) / log(58)) which is
-    // bounded by expanded + expanded * (138 / 100 + 1) which works
-    // out to expanded * 3:
-    auto const bufsize = expanded * 3;
-
-    boost::container::small_vector<std::uint8_t, 1024> buf(bufsize);
+    boost::container::small_vector<std::uint8_t, 128> buf(expanded);
 
     // Lay the data out as
     //      <type><token><checksum>
@@ -215,8 +255,7 @@ encodeBase58Token(TokenType type, void const* token, std::size_t size)
         std::memcpy(buf.data() + 1, token, size);
     checksum(buf.data() + 1 + size, buf.data(), 1 + size);
 
-    return detail::encodeBase58(
-        buf.data(), expanded, buf.data() + expanded, bufsize - expanded);
+    return detail::encodeBase58(buf.data(), expanded);
 }
 
 std::string
@@ -81,6 +81,9 @@ JSS(PaymentChannelCreate);   // transaction type.
 JSS(PaymentChannelFund);     // transaction type.
 JSS(RippleState);            // ledger type.
 JSS(SLE_hit_rate);           // out: GetCounts.
+JSS(SLE_hits);               // out: GetCounts.
+JSS(SLE_misses);             // out: GetCounts.
+JSS(SLE_size);               // out: GetCounts.
 JSS(SetFee);                 // transaction type.
 JSS(UNLModify);              // transaction type.
 JSS(SettleDelay);            // in: TransactionSign
@@ -134,6 +137,7 @@ JSS(auth_change_queued);     // out: AccountInfo
 JSS(available);              // out: ValidatorList
 JSS(avg_bps_recv);           // out: Peers
 JSS(avg_bps_sent);           // out: Peers
+JSS(avg_msgs_per_write);     // out: Peers
 JSS(balance);                // out: AccountLines
 JSS(balances);               // out: GatewayBalances
 JSS(base);                   // out: LogLevel
@@ -145,18 +149,22 @@ JSS(binary);                 // in: AccountTX, LedgerEntry,
 JSS(blob);                   // out: ValidatorList
 JSS(blobs_v2);               // out: ValidatorList
                              // in: UNL
+JSS(blocks);                 // out: LedgerExport
 JSS(books);                  // in: Subscribe, Unsubscribe
 JSS(both);                   // in: Subscribe, Unsubscribe
 JSS(both_sides);             // in: Subscribe, Unsubscribe
 JSS(broadcast);              // out: SubmitTransaction
 JSS(build_path);             // in: TransactionSign
 JSS(build_version);          // out: NetworkOPs
+JSS(bytes);                  // out: LedgerExport
+JSS(caches);                 // out: GetCounts
 JSS(cancel_after);           // out: AccountChannels
 JSS(can_delete);             // out: CanDelete
 JSS(channel_id);             // out: AccountChannels
 JSS(channels);               // out: AccountChannels
 JSS(check);                  // in: AccountObjects
 JSS(check_nodes);            // in: LedgerCleaner
+JSS(checkpoints);            // out: GetCounts
 JSS(clear);                  // in/out: FetchInfo
 JSS(close_flags);            // out: LedgerToJson
 JSS(close_time);             // in: Application, out: NetworkOPs,
@@ -174,11 +182,15 @@ JSS(command);                // in: RPCHandler
 JSS(complete);               // out: NetworkOPs, InboundLedger
 JSS(complete_ledgers);       // out: NetworkOPs, PeerImp
 JSS(complete_shards);        // out: OverlayImpl, PeerImp
+JSS(compress_ratio_recv);    // out: Peers
+JSS(compress_ratio_sent);    // out: Peers
+JSS(compress_us);            // out: Peers
 JSS(consensus);              // out: NetworkOPs, LedgerConsensus
 JSS(converge_time);          // out: NetworkOPs
 JSS(converge_time_s);        // out: NetworkOPs
 JSS(count);                  // in: AccountTx*, ValidatorList
 JSS(counters);               // in/out: retrieve counters
+JSS(currencies);             // in: Subscribe
 JSS(currency);               // in: paths/PathRequest, STAmount
                              // out: STPathSet, STAmount,
                              //      AccountLines
@@ -192,6 +204,7 @@ JSS(dbKBLedger);              // out: getCounts
 JSS(dbKBTotal);               // out: getCounts
 JSS(dbKBTransaction);         // out: getCounts
 JSS(debug_signing);           // in: TransactionSign
+JSS(decompress_us);           // out: Peers
 JSS(deletion_blockers_only);  // in: AccountObjects
 JSS(delivered_amount);        // out: insertDeliveredAmount
 JSS(deposit_authorized);      // out: deposit_authorized
@@ -215,10 +228,12 @@ JSS(drops);                   // out: TxQ
 JSS(duration_us);             // out: NetworkOPs
 JSS(effective);               // out: ValidatorList
                               // in: UNL
-JSS(enabled);                 // out: AmendmentTable
+JSS(enable);                  // in: GetTrace
+JSS(enabled);                 // out: AmendmentTable, GetTrace
 JSS(engine_result);           // out: NetworkOPs, TransactionSign, Submit
 JSS(engine_result_code);      // out: NetworkOPs, TransactionSign, Submit
 JSS(engine_result_message);   // out: NetworkOPs, TransactionSign, Submit
+JSS(entries);                 // out: LedgerExport
 JSS(ephemeral_key);           // out: ValidatorInfo
                               // in/out: Manifest
 JSS(error);                   // out: error
@@ -233,6 +248,7 @@ JSS(expected_date_UTC);     // out: any (warnings)
 JSS(expected_ledger_size);  // out: TxQ
 JSS(expiration);            // out: AccountOffers, AccountChannels,
                             //      ValidatorList
+JSS(fail_counts);           // out: LedgerCleaner
 JSS(fail_hard);             // in: Sign, Submit
 JSS(failed);                // out: InboundLedger
 JSS(feature);               // in: Feature
@@ -244,6 +260,7 @@ JSS(fee_level);             // out: AccountInfo
 JSS(fee_mult_max);          // in: TransactionSign
 JSS(fee_ref);               // out: NetworkOPs
 JSS(fetch_pack);            // out: NetworkOPs
+JSS(finalizing_shards);     // out: CrawlShards
 JSS(first);                 // out: rpc/Version
 JSS(finished);
 JSS(fix_txns);              // in: LedgerCleaner
@@ -293,6 +310,7 @@ JSS(jq_trans_overflow);           // JobQueue transaction limit overflow.
 JSS(kept);                        // out: SubmitTransaction
 JSS(key);                         // out
 JSS(key_type);                    // in/out: WalletPropose, TransactionSign
+JSS(last_duration_us);            // out: GetCounts
 JSS(latency);                     // out: PeerImp
 JSS(last);                        // out: RPCVersion
 JSS(last_close);                  // out: NetworkOPs
@@ -319,6 +337,10 @@ JSS(ledger_index_min);            // in, out: AccountTx*
 JSS(ledger_max);                  // in, out: AccountTx*
 JSS(ledger_min);                  // in, out: AccountTx*
 JSS(ledger_time);                 // out: NetworkOPs
+JSS(ledgers_checked);             // out: LedgerCleaner
+JSS(ledgers_per_second);          // out: CrawlShards, LedgerCleaner
+JSS(ledgers_total);               // out: CrawlShards
+JSS(ledgers_verified);            // out: CrawlShards
 JSS(levels);                      // LogLevels
 JSS(limit);                       // in/out: AccountTx*, AccountOffers,
                                   //         AccountLines, AccountObjects
@@ -354,12 +376,15 @@ JSS(master_key);                  // out: WalletPropose, NetworkOPs,
 JSS(master_seed);                 // out: WalletPropose
 JSS(master_seed_hex);             // out: WalletPropose
 JSS(master_signature);            // out: pubManifest
+JSS(max_duration_us);             // out: GetCounts
 JSS(max_ledger);                  // in/out: LedgerCleaner
 JSS(max_queue_size);              // out: TxQ
 JSS(max_spend_drops);             // out: AccountInfo
 JSS(max_spend_drops_total);       // out: AccountInfo
 JSS(median_fee);                  // out: TxQ
 JSS(median_level);                // out: TxQ
+JSS(memory_arenas);               // out: GetCounts
+JSS(memory_budget);               // out: GetCounts
 JSS(message);                     // error.
 JSS(meta);                        // out: NetworkOPs, AccountTx*, Tx
 JSS(metaData);
@@ -367,6 +392,7 @@ JSS(metadata);  // out: TransactionEntry
 JSS(method);    // RPC
 JSS(methods);
 JSS(metrics);                    // out: Peers
+JSS(min_amount);                 // in: Subscribe
 JSS(min_count);                  // in: GetCounts
 JSS(min_ledger);                 // in: LedgerCleaner
 JSS(minimum_fee);                // out: TxQ
@@ -382,13 +408,28 @@ JSS(no_ripple);                  // out: AccountLines
 JSS(no_ripple_peer);             // out: AccountLines
 JSS(node);                       // out: LedgerEntry
 JSS(node_binary);                // out: LedgerEntry
+JSS(node_cache_hit_rate);        // out: GetCounts
+JSS(node_cache_size);            // out: GetCounts
+JSS(node_cold_hits);             // out: GetCounts
+JSS(node_cold_reads);            // out: GetCounts
+JSS(node_demoted);               // out: GetCounts
+JSS(node_hot_hits);              // out: GetCounts
+JSS(node_hot_reads);             // out: GetCounts
+JSS(node_read_batch_items);      // out: GetCounts
+JSS(node_read_batches);          // out: GetCounts
 JSS(node_read_bytes);            // out: GetCounts
 JSS(node_read_errors);           // out: GetCounts
+JSS(node_read_queue);            // out: GetCounts
 JSS(node_read_retries);          // out: GetCounts
 JSS(node_reads_hit);             // out: GetCounts
 JSS(node_reads_total);           // out: GetCounts
 JSS(node_reads_duration_us);     // out: GetCounts
 JSS(nodestore);                  // out: GetCounts
+JSS(nodeobject_bytes);           // out: GetCounts
+JSS(nodeobject_cached_bytes);    // out: GetCounts
+JSS(nodeobject_legacy_bytes);    // out: GetCounts
+JSS(nodeobject_reused);          // out: GetCounts
+JSS(numa);                       // out: GetCounts
 JSS(node_writes);                // out: GetCounts
 JSS(node_written_bytes);         // out: GetCounts
 JSS(node_writes_duration_us);    // out: GetCounts
@@ -405,12 +446,15 @@ JSS(open_ledger_fee);            // out: TxQ
 JSS(open_ledger_level);          // out: TxQ
 JSS(owner);                      // in: LedgerEntry, out: NetworkOPs
 JSS(owner_funds);                // in/out: Ledger, NetworkOPs, AcceptedLedgerTx
+JSS(pages);                      // out: GetCounts
+JSS(pages_written);              // out: GetCounts
 JSS(params);                     // RPC
 JSS(parent_close_time);          // out: LedgerToJson
 JSS(parent_hash);                // out: LedgerToJson
 JSS(partition);                  // in: LogLevel
 JSS(passphrase);                 // in: WalletPropose
 JSS(password);                   // in: Subscribe
+JSS(path);                       // in/out: LedgerExport
 JSS(paths);                      // in: RipplePathFind
 JSS(paths_canonical);            // out: RipplePathFind
 JSS(paths_computed);             // out: PathRequest, RipplePathFind
@@ -425,6 +469,7 @@ JSS(peer_disconnects_resources);  // Severed peer connections because of
 JSS(port);                        // in: Connect
 JSS(previous);                    // out: Reservations
 JSS(previous_ledger);             // out: LedgerPropose
+JSS(progress);                    // in: LedgerCleaner
 JSS(proof);                       // in: BookOffers
 JSS(propose_seq);                 // out: LedgerPropose
 JSS(proposers);                   // out: NetworkOPs, LedgerConsensus
@@ -463,6 +508,8 @@ JSS(reserve_base_xrp);      // out: NetworkOPs
 JSS(reserve_inc);           // out: NetworkOPs
 JSS(reserve_inc_xrp);       // out: NetworkOPs
 JSS(response);              // websocket
+JSS(response_time);         // out: PeerImp
+JSS(restarts);              // out: GetCounts
 JSS(result);                // RPC
 JSS(ripple_lines);          // out: NetworkOPs
 JSS(ripple_state);          // in: LedgerEntr
@@ -471,6 +518,9 @@ JSS(role);                  // out: Ping.cpp
 JSS(rpc);
 JSS(rt_accounts);  // in: Subscribe, Unsubscribe
 JSS(running_duration_us);
+JSS(save_batches);              // out: GetCounts
+JSS(save_queue);                // out: GetCounts
+JSS(saved_ledgers);             // out: GetCounts
 JSS(search_depth);              // in: RipplePathFind
 JSS(searched_all);              // out: Tx
 JSS(secret);                    // in: TransactionSign,
@@ -495,6 +545,7 @@ JSS(severity);                  // in: LogLevel
 JSS(shards);                    // in/out: GetCounts, DownloadShard
 JSS(signature);                 // out: NetworkOPs, ChannelAuthorize
 JSS(signature_verified);        // out: ChannelVerify
+JSS(signing);                   // out: GetCounts
 JSS(signing_key);               // out: NetworkOPs
 JSS(signing_keys);              // out: ValidatorList
 JSS(signing_time);              // out: NetworkOPs
@@ -508,11 +559,13 @@ JSS(source_tag);                // out: AccountChannels
 JSS(stand_alone);               // out: NetworkOPs
 JSS(start);                     // in: TxHistory
 JSS(started);
+JSS(startup_ms);          // out: NetworkOPs
 JSS(state);               // out: Logic.h, ServerState, LedgerData
 JSS(state_accounting);    // out: NetworkOPs
 JSS(state_now);           // in: Subscribe
 JSS(status);              // error
 JSS(stop);                // in: LedgerCleaner
+JSS(stream_compression);  // out: Peers
 JSS(streams);             // in: Subscribe, Unsubscribe
 JSS(strict);              // in: AccountCurrencies, AccountInfo
 JSS(sub_index);           // in: LedgerEntry
@@ -526,6 +579,7 @@ JSS(taker_gets);          // in: Subscribe, Unsubscribe, BookOffers
 JSS(taker_gets_funded);   // out: NetworkOPs
 JSS(taker_pays);          // in: Subscribe, Unsubscribe, BookOffers
 JSS(taker_pays_funded);   // out: NetworkOPs
+JSS(threads);             // in: LedgerExport
 JSS(threshold);           // in: Blacklist
 JSS(ticket);              // in: AccountObjects
 JSS(ticket_count);        // out: AccountInfo
@@ -542,7 +596,9 @@ JSS(total_coins);             // out: LedgerToJson
 JSS(transTreeHash);           // out: ledger/Ledger.cpp
 JSS(transaction);             // in: Tx
                               // out: NetworkOPs, AcceptedLedgerTx,
+JSS(transaction_filter);      // in: Subscribe
 JSS(transaction_hash);        // out: RCLCxPeerPos, LedgerToJson
+JSS(transaction_types);       // in: Subscribe
 JSS(transactions);            // out: LedgerToJson,
                               // in: AccountTx*, Unsubscribe
 JSS(transitions);             // out: NetworkOPs
@@ -592,6 +648,7 @@ JSS(value);                   // out: STAmount
 JSS(version);                 // out: RPCVersion
 JSS(vetoed);                  // out: AmendmentTableImpl
 JSS(vote);                    // in: Feature
+JSS(wal);                     // out: GetCounts
 JSS(warning);                 // rpc:
 JSS(warnings);                // out: server_info, server_state
 JSS(workers);
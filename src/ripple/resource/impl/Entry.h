@@ -25,7 +25,9 @@
 #include <ripple/beast/core/List.h>
 #include <ripple/resource/impl/Key.h>
 #include <ripple/resource/impl/Tuning.h>
+#include <atomic>
 #include <cassert>
+#include <mutex>
 
 namespace ripple {
 namespace Resource {
@@ -71,14 +73,24 @@ struct Entry : public beast::List<Entry>::Node
     int
     balance(clock_type::time_point const now)
     {
+        std::lock_guard _(mutex);
         return local_balance.value(now) + remote_balance;
     }
 
+    // Balance excluding remote contributions
+    int
+    localBalance(clock_type::time_point const now)
+    {
+        std::lock_guard _(mutex);
+        return local_balance.value(now);
+    }
+
     // Add a charge and return normalized balance
     // including contributions from imports.
     int
     add(int charge, clock_type::time_point const now)
     {
+        std::lock_guard _(mutex);
         return local_balance.add(charge, now) + remote_balance;
     }
 
@@ -88,11 +100,15 @@ struct Entry : public beast::List<Entry>::Node
     // Number of Consumer references
     int refcount;
 
+    // Guards local_balance and lastWarningTime. Charging an entry takes
+    // only this, not the lock of the whole table.
+    std::mutex mutex;
+
     // Exponentially decaying balance of resource consumption
     DecayingSample<decayWindowSeconds, clock_type> local_balance;
 
     // Normalized balance contribution from imports
-    int remote_balance;
+    std::atomic<int> remote_balance;
 
     // Time of the last warning
     clock_type::time_point lastWarningTime;
@@ -214,37 +214,37 @@ public:
 
         for (auto& inboundEntry : inbound_)
         {
-            int localBalance = inboundEntry.local_balance.value(now);
+            int localBalance = inboundEntry.localBalance(now);
             if ((localBalance + inboundEntry.remote_balance) >= threshold)
             {
                 Json::Value& entry =
                     (ret[inboundEntry.to_string()] = Json::objectValue);
                 entry[jss::local] = localBalance;
-                entry[jss::remote] = inboundEntry.remote_balance;
+                entry[jss::remote] = inboundEntry.remote_balance.load();
                 entry[jss::type] = "inbound";
             }
         }
         for (auto& outboundEntry : outbound_)
         {
-            int localBalance = outboundEntry.local_balance.value(now);
+            int localBalance = outboundEntry.localBalance(now);
             if ((localBalance + outboundEntry.remote_balance) >= threshold)
             {
                 Json::Value& entry =
                     (ret[outboundEntry.to_string()] = Json::objectValue);
                 entry[jss::local] = localBalance;
-                entry[jss::remote] = outboundEntry.remote_balance;
+                entry[jss::remote] = outboundEntry.remote_balance.load();
                 entry[jss::type] = "outbound";
             }
         }
         for (auto& adminEntry : admin_)
         {
-            int localBalance = adminEntry.local_balance.value(now);
+            int localBalance = adminEntry.localBalance(now);
             if ((localBalance + adminEntry.remote_balance) >= threshold)
             {
                 Json::Value& entry =
                     (ret[adminEntry.to_string()] = Json::objectValue);
                 entry[jss::local] = localBalance;
-                entry[jss::remote] = adminEntry.remote_balance;
+                entry[jss::remote] = adminEntry.remote_balance.load();
                 entry[jss::type] = "admin";
             }
         }
@@ -265,7 +265,7 @@ public:
         for (auto& inboundEntry : inbound_)
         {
             Gossip::Item item;
-            item.balance = inboundEntry.local_balance.value(now);
+            item.balance = inboundEntry.localBalance(now);
             if (item.balance >= minimumGossipBalance)
             {
                 item.address = inboundEntry.key->address;
@@ -441,10 +441,11 @@ public:
         }
     }
 
+    // Charging, and the checks that follow it, only lock the entry. The
+    // Consumer charged holds a reference, so the entry can't be erased.
     Disposition
     charge(Entry& entry, Charge const& fee)
     {
-        std::lock_guard _(lock_);
         clock_type::time_point const now(m_clock.now());
         int const balance(entry.add(fee.cost(), now));
         JLOG(m_journal.trace()) << "Charging " << entry << " for " << fee;
@@ -457,22 +458,21 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard _(lock_);
-        bool notify(false);
         auto const elapsed = m_clock.now();
-        if (entry.balance(m_clock.now()) >= warningThreshold &&
-            elapsed != entry.lastWarningTime)
         {
-            charge(entry, feeWarning);
-            notify = true;
+            std::lock_guard _(entry.mutex);
+            if (entry.local_balance.value(elapsed) + entry.remote_balance <
+                    warningThreshold ||
+                elapsed == entry.lastWarningTime)
+                return false;
+            entry.local_balance.add(feeWarning.cost(), elapsed);
             entry.lastWarningTime = elapsed;
         }
-        if (notify)
-        {
-            JLOG(m_journal.info()) << "Load warning: " << entry;
-            ++m_stats.warn;
-        }
-        return notify;
+        JLOG(m_journal.trace())
+            << "Charging " << entry << " for " << feeWarning;
+        JLOG(m_journal.info()) << "Load warning: " << entry;
+        ++m_stats.warn;
+        return true;
     }
 
     bool
@@ -481,30 +481,29 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard _(lock_);
-        bool drop(false);
         clock_type::time_point const now(m_clock.now());
-        int const balance(entry.balance(now));
-        if (balance >= dropThreshold)
+        int balance;
         {
-            JLOG(m_journal.warn())
-                << "Consumer entry " << entry << " dropped with balance "
-                << balance << " at or above drop threshold " << dropThreshold;
+            std::lock_guard _(entry.mutex);
+            balance = entry.local_balance.value(now) + entry.remote_balance;
+            if (balance < dropThreshold)
+                return false;
 
             // Adding feeDrop at this point keeps the dropped connection
             // from re-connecting for at least a little while after it is
             // dropped.
-            charge(entry, feeDrop);
-            ++m_stats.drop;
-            drop = true;
+            entry.local_balance.add(feeDrop.cost(), now);
         }
-        return drop;
+        JLOG(m_journal.warn())
+            << "Consumer entry " << entry << " dropped with balance " << balance
+            << " at or above drop threshold " << dropThreshold;
+        ++m_stats.drop;
+        return true;
     }
 
     int
     balance(Entry& entry)
     {
-        std::lock_guard _(lock_);
         return entry.balance(m_clock.now());
     }
 
@@ -524,7 +523,7 @@ public:
             item["name"] = entry.to_string();
             item["balance"] = entry.balance(now);
             if (entry.remote_balance != 0)
-                item["remote_balance"] = entry.remote_balance;
+                item["remote_balance"] = entry.remote_balance.load();
         }
     }
 
@@ -0,0 +1,131 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_RESPONSECACHE_H_INCLUDED
+#define RIPPLE_RPC_RESPONSECACHE_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/insight/Collector.h>
+#include <ripple/core/Config.h>
+#include <ripple/json/json_value.h>
+#include <ripple/resource/Charge.h>
+#include <ripple/rpc/Role.h>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace ripple {
+namespace RPC {
+
+/** Caches the responses of read-only RPC methods.
+
+    Public servers answer the same requests many times between ledgers.
+    For the methods enabled in the configuration, a successful result is
+    kept and returned to later requests with the same method, parameters,
+    API version and role.
+
+    Every entry belongs to the closed and validated ledgers that were
+    current when it was stored. The cache empties itself as soon as either
+    of them changes, so a response is never served across ledgers. Within
+    a ledger interval, results that depend on the open ledger may be
+    stale; that is the trade operators make by enabling a method.
+*/
+class ResponseCache
+{
+public:
+    struct Setup
+    {
+        explicit Setup() = default;
+
+        // Names of the methods whose responses are cached
+        std::set<std::string> methods;
+
+        // The most responses kept at once
+        std::size_t maxEntries = 10000;
+    };
+
+    ResponseCache(Setup const& setup, beast::insight::Collector::ptr const&);
+
+    /** Returns `true` if responses to this method are cached. */
+    bool
+    enabled(std::string const& method) const
+    {
+        return setup_.methods.count(method) != 0;
+    }
+
+    /** Returns the key a request is cached under. */
+    static std::string
+    makeKey(
+        std::string const& method,
+        Json::Value const& params,
+        unsigned apiVersion,
+        Role role);
+
+    /** Look up a cached response.
+
+        @param closed The hash of the last closed ledger.
+        @param validated The hash of the last validated ledger.
+        @return `true` if the response and its load charge were found.
+    */
+    bool
+    fetch(
+        std::string const& key,
+        uint256 const& closed,
+        uint256 const& validated,
+        Json::Value& result,
+        Resource::Charge& loadType);
+
+    /** Store a response computed against the given ledgers.
+
+        The response is discarded if the ledgers have changed since.
+    */
+    void
+    insert(
+        std::string key,
+        uint256 const& closed,
+        uint256 const& validated,
+        Json::Value const& result,
+        Resource::Charge const& loadType);
+
+private:
+    struct Entry
+    {
+        Json::Value result;
+        Resource::Charge loadType;
+    };
+
+    Setup const setup_;
+
+    std::mutex mutex_;
+    uint256 closed_;
+    uint256 validated_;
+    std::unordered_map<std::string, Entry> entries_;
+
+    beast::insight::Counter hits_;
+    beast::insight::Counter misses_;
+};
+
+ResponseCache::Setup
+setup_ResponseCache(Config const& config);
+
+}  // namespace RPC
+}  // namespace ripple
+
+#endif
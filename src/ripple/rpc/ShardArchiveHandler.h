@@ -124,13 +124,17 @@ private:
     bool
     removeAndProceed(std::lock_guard<std::mutex> const& lock);
 
+    // Create the downloader for the configured archive handling.
+    std::shared_ptr<HTTPDownloader>
+    makeDownloader();
+
     /////////////////////////////////////////////////
     // m_ is used to protect access to downloader_,
     // archives_, process_ and to protect setting and
     // destroying sqliteDB_.
     /////////////////////////////////////////////////
     std::mutex mutable m_;
-    std::shared_ptr<DatabaseDownloader> downloader_;
+    std::shared_ptr<HTTPDownloader> downloader_;
     std::map<std::uint32_t, parsedURL> archives_;
     bool process_;
     std::unique_ptr<DatabaseCon> sqliteDB_;
@@ -139,6 +143,9 @@ private:
     Application& app_;
     beast::Journal const j_;
     boost::filesystem::path const downloadDir_;
+
+    // Extract archives while they download rather than afterwards
+    bool const streamArchives_;
     boost::asio::basic_waitable_timer<std::chrono::steady_clock> timer_;
     JobCounter jobCounter_;
     TimerOpCounter timerCounter_;
@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_SIGNINGQUEUE_H_INCLUDED
+#define RIPPLE_RPC_SIGNINGQUEUE_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/core/Config.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/KeyType.h>
+#include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/Seed.h>
+#include <ripple/rpc/Role.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace RPC {
+
+/** Runs the signing done on behalf of RPC clients on its own threads.
+
+    Deriving a key pair from a secret and signing a transaction take long
+    enough that a burst of sign, sign_for or submit-with-secret requests
+    would otherwise hold the job queue threads serving every other client.
+    Each request is queued here instead, while its coroutine gives up its
+    thread until the signing is done.
+
+    Unlimited (admin and identified) clients and all other clients have
+    separate queues of bounded length, and the threads always serve the
+    unlimited queue first. A request that finds its queue full is refused.
+
+    The key pairs derived for the secrets in use are also kept, so that
+    clients signing many transactions with one account derive its keys
+    once. Entries are found by a salted hash of the seed and the least
+    recently used is dropped when the cache is full; secret keys erase
+    themselves when they are dropped.
+*/
+class SigningQueue
+{
+public:
+    struct Setup
+    {
+        explicit Setup() = default;
+
+        // The threads signing requests
+        std::size_t threads = 2;
+
+        // The most requests waiting in each queue
+        std::size_t maxQueued = 256;
+
+        // The most key pairs kept
+        std::size_t keyCacheSize = 256;
+    };
+
+    SigningQueue(Setup const& setup, beast::Journal journal);
+
+    ~SigningQueue();
+
+    SigningQueue(SigningQueue const&) = delete;
+    SigningQueue&
+    operator=(SigningQueue const&) = delete;
+
+    /** Queue work for a signing thread.
+
+        @return false if the queue for the role is full or the queue is
+                stopping, in which case the work is not run.
+    */
+    bool
+    post(Role role, std::function<void()> work);
+
+    /** Run work on a signing thread and wait for it to finish.
+
+        The coroutine is suspended while the work is queued and running.
+        Without a coroutine the work is run on the calling thread.
+
+        @return false if the work could not be queued and was not run.
+    */
+    bool
+    run(Role role,
+        std::shared_ptr<JobQueue::Coro> const& coro,
+        std::function<void()> work);
+
+    /** Return the key pair for a seed, deriving it only if it isn't cached.
+     */
+    std::pair<PublicKey, SecretKey>
+    keyPair(KeyType type, Seed const& seed);
+
+    Json::Value
+    getJson() const;
+
+private:
+    using KeyPair = std::pair<PublicKey, SecretKey>;
+
+    void
+    loop();
+
+    Setup const setup_;
+    beast::Journal const j_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<std::function<void()>> unlimited_;
+    std::deque<std::function<void()>> limited_;
+    std::size_t rejected_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+
+    // Salts the hashes the key pairs are found by
+    uint256 const salt_;
+
+    mutable std::mutex keyMutex_;
+    std::list<uint256> keyOrder_;
+    hash_map<uint256, std::pair<KeyPair, std::list<uint256>::iterator>>
+        keys_;
+    std::size_t keyHits_ = 0;
+    std::size_t keyMisses_ = 0;
+};
+
+SigningQueue::Setup
+setup_SigningQueue(Config const& config);
+
+}  // namespace RPC
+}  // namespace ripple
+
+#endif
@@ -43,6 +43,7 @@ namespace ripple {
       type: <string> // optional, defaults to all account objects types
       limit: <integer> // optional
       marker: <opaque> // optional, resume previous query
+      binary: <bool> // optional, defaults to false
     }
 */
 
@@ -151,7 +152,8 @@ doAccountObjects(RPC::JsonContext& context)
             dirIndex,
             entryIndex,
             limit,
-            result))
+            result,
+            params.isMember(jss::binary) && params[jss::binary].asBool()))
     {
         result[jss::account_objects] = Json::arrayValue;
     }
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
@@ -181,19 +182,32 @@ doBookOffers(RPC::JsonContext& context)
         return *err;
 
     bool const bProof(context.params.isMember(jss::proof));
+    bool const bBinary(
+        context.params.isMember(jss::binary) &&
+        context.params[jss::binary].asBool());
 
     Json::Value const jvMarker(
         context.params.isMember(jss::marker) ? context.params[jss::marker]
                                              : Json::Value(Json::nullValue));
 
-    context.netOps.getBookPage(
-        lpLedger,
-        {{pay_currency, pay_issuer}, {get_currency, get_issuer}},
-        takerID ? *takerID : beast::zero,
-        bProof,
-        limit,
-        jvMarker,
-        jvResult);
+    Book const book{{pay_currency, pay_issuer}, {get_currency, get_issuer}};
+    AccountID const taker = takerID ? *takerID : beast::zero;
+
+    // Snapshots hold expanded offers
+    if (!jvMarker.isNull() || bBinary ||
+        !context.app.getOrderBookDB().getSnapshotPage(
+            *lpLedger, book, taker, limit, jvResult))
+    {
+        context.netOps.getBookPage(
+            lpLedger,
+            book,
+            taker,
+            bProof,
+            bBinary,
+            limit,
+            jvMarker,
+            jvResult);
+    }
 
     context.loadType = Resource::feeMediumBurdenRPC;
 
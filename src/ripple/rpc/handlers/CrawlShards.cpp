@@ -73,6 +73,11 @@ doCrawlShards(RPC::JsonContext& context)
             jvResult[jss::public_key] = toBase58(
                 TokenType::NodePublic, context.app.nodeIdentity().first);
         jvResult[jss::complete_shards] = shardStore->getCompleteShards();
+        if (auto finalizing = shardStore->getFinalizingShards();
+            finalizing.size() > 0)
+        {
+            jvResult[jss::finalizing_shards] = std::move(finalizing);
+        }
     }
 
     if (hops == 0)
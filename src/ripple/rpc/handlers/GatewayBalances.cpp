@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/IssuerBalances.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/paths/RippleState.h>
 #include <ripple/ledger/ReadView.h>
@@ -140,8 +141,12 @@ doGatewayBalances(RPC::JsonContext& context)
     std::map<AccountID, std::vector<STAmount>> assets;
     std::map<AccountID, std::vector<STAmount>> frozenBalances;
 
-    // Traverse the cold wallet's trust lines
+    // Without hot wallets to set apart, the totals may already be known
+    if (!hotWallets.empty() ||
+        !context.app.getIssuerBalances().getTotals(
+            *ledger, accountID, sums, frozenBalances, assets))
     {
+        // Traverse the cold wallet's trust lines
         forEachItem(
             *ledger, accountID, [&](std::shared_ptr<SLE const> const& sle) {
                 auto rs = RippleState::makeItem(accountID, sle);
@@ -20,10 +20,17 @@
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/PendingSaves.h>
+#include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/main/MemoryBudget.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SignatureCache.h>
+#include <ripple/basics/MemoryArena.h>
+#include <ripple/basics/Numa.h>
 #include <ripple/basics/UptimeClock.h>
 #include <ripple/core/DatabaseCon.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/json/json_value.h>
 #include <ripple/ledger/CachedSLEs.h>
 #include <ripple/net/RPCErr.h>
@@ -32,6 +39,7 @@
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/SigningQueue.h>
 #include <ripple/shamap/ShardFamily.h>
 
 namespace ripple {
@@ -90,6 +98,29 @@ getCountsJson(Application& app, int minObjectCount)
         if (dbKB > 0)
             ret[jss::dbKBTransaction] = dbKB;
 
+        {
+            auto checkpoints = [](DatabaseCon const& db) {
+                Json::Value jv(Json::objectValue);
+                if (auto const stats = db.checkpointStats())
+                {
+                    jv[jss::pages] = stats->walPages;
+                    jv[jss::checkpoints] = std::to_string(stats->checkpoints);
+                    jv[jss::restarts] = std::to_string(stats->restarts);
+                    jv[jss::pages_written] =
+                        std::to_string(stats->pagesWritten);
+                    jv[jss::last_duration_us] =
+                        std::to_string(stats->lastDuration.count());
+                    jv[jss::max_duration_us] =
+                        std::to_string(stats->maxDuration.count());
+                }
+                return jv;
+            };
+
+            Json::Value& wal = (ret[jss::wal] = Json::objectValue);
+            wal[jss::ledger] = checkpoints(app.getLedgerDB());
+            wal[jss::transaction] = checkpoints(app.getTxnDB());
+        }
+
         {
             std::size_t c = app.getOPs().getLocalTxCount();
             if (c > 0)
@@ -98,10 +129,22 @@ getCountsJson(Application& app, int minObjectCount)
     }
 
     ret[jss::write_load] = app.getNodeStore().getWriteLoad();
+    {
+        auto const saves = app.pendingSaves().getStats();
+        ret[jss::save_queue] = static_cast<Json::UInt>(saves.queued);
+        ret[jss::save_batches] = std::to_string(saves.batches);
+        ret[jss::saved_ledgers] = std::to_string(saves.ledgers);
+    }
 
     ret[jss::historical_perminute] =
         static_cast<int>(app.getInboundLedgers().fetchRate());
-    ret[jss::SLE_hit_rate] = app.cachedSLEs().rate();
+    {
+        auto const& cache = app.cachedSLEs();
+        ret[jss::SLE_hit_rate] = cache.rate();
+        ret[jss::SLE_hits] = std::to_string(cache.hits());
+        ret[jss::SLE_misses] = std::to_string(cache.misses());
+        ret[jss::SLE_size] = static_cast<Json::UInt>(cache.size());
+    }
     ret[jss::ledger_hit_rate] = app.getLedgerMaster().getCacheHitRate();
     ret[jss::AL_hit_rate] = app.getAcceptedLedgerCache().getHitRate();
 
@@ -111,6 +154,46 @@ getCountsJson(Application& app, int minObjectCount)
         app.getNodeFamily().getTreeNodeCache(0)->getCacheSize();
     ret[jss::treenode_track_size] =
         app.getNodeFamily().getTreeNodeCache(0)->getTrackSize();
+    ret[jss::memory_budget] = app.getMemoryBudget().getJson();
+    {
+        Json::Value& arenas = (ret[jss::memory_arenas] = Json::objectValue);
+        arenas["allocator"] = allocatorName();
+        for (std::size_t i = 0; i < memoryArenaCount; ++i)
+        {
+            auto const arena = static_cast<MemoryArena>(i);
+            auto const stats = getMemoryArenaStats(arena);
+            Json::Value& jv = (arenas[to_string(arena)] = Json::objectValue);
+            jv["bytes"] = std::to_string(stats.bytes);
+            jv["allocations"] = std::to_string(stats.allocations);
+            jv["total_allocations"] = std::to_string(stats.total);
+            if (stats.resident != 0)
+                jv["resident_bytes"] = std::to_string(stats.resident);
+        }
+    }
+    ret[jss::job_queue] = app.getJobQueue().getJson();
+    if (numa::enabled())
+        ret[jss::numa] = numa::getJson();
+    {
+        auto& family = app.getNodeFamily();
+        Json::Value& caches = (ret[jss::caches] = Json::objectValue);
+        caches["tree_nodes"] = family.getTreeNodeCache(0)->getJson();
+        caches["full_below"] = family.getFullBelowCache(0)->getJson();
+        caches["transactions"] =
+            app.getMasterTransaction().getCache().getJson();
+        caches["accepted_ledgers"] = app.getAcceptedLedgerCache().getJson();
+        caches["temp_nodes"] = app.getTempNodeCache().getJson();
+        caches["signatures"] = app.getSignatureCache().getJson();
+    }
+
+    ret[jss::signing] = app.getSigningQueue().getJson();
+
+    {
+        auto const pool = NodeObject::getPoolStats();
+        ret[jss::nodeobject_bytes] = std::to_string(pool.allocatedBytes);
+        ret[jss::nodeobject_cached_bytes] = std::to_string(pool.cachedBytes);
+        ret[jss::nodeobject_legacy_bytes] = std::to_string(pool.legacyBytes);
+        ret[jss::nodeobject_reused] = std::to_string(pool.reused);
+    }
 
     std::string uptime;
     auto s = UptimeClock::now();
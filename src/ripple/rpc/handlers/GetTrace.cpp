@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/Tracer.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+
+namespace ripple {
+
+// {
+//   enable: <bool>              // start or stop recording
+//   ledger_index_min: <number>  // only spans for this ledger or later
+//   clear: <bool>               // discard the spans once returned
+// }
+//
+// The result loads in chrome://tracing or Perfetto.
+Json::Value
+doGetTrace(RPC::JsonContext& context)
+{
+    auto& tracer = context.app.getTracer();
+    auto const& params = context.params;
+
+    if (params.isMember(jss::enable))
+    {
+        if (!params[jss::enable].isBool())
+            return RPC::invalid_field_error(jss::enable);
+        tracer.setEnabled(params[jss::enable].asBool());
+    }
+
+    std::uint32_t minLedgerSeq = 0;
+    if (params.isMember(jss::ledger_index_min))
+    {
+        auto const& min = params[jss::ledger_index_min];
+        if (!min.isIntegral() || (min.isInt() && min.asInt() < 0))
+            return RPC::invalid_field_error(jss::ledger_index_min);
+        minLedgerSeq = min.asUInt();
+    }
+
+    Json::Value ret = tracer.getJson(minLedgerSeq);
+    ret[jss::enabled] = tracer.enabled();
+
+    if (params.isMember(jss::clear) && params[jss::clear].asBool())
+    {
+        tracer.clear();
+        ret[jss::clear] = true;
+    }
+
+    return ret;
+}
+
+}  // namespace ripple
@@ -67,6 +67,8 @@ doGatewayBalances(RPC::JsonContext&);
 Json::Value
 doGetCounts(RPC::JsonContext&);
 Json::Value
+doGetTrace(RPC::JsonContext&);
+Json::Value
 doLedgerAccept(RPC::JsonContext&);
 Json::Value
 doLedgerCleaner(RPC::JsonContext&);
@@ -79,6 +81,8 @@ doLedgerData(RPC::JsonContext&);
 Json::Value
 doLedgerEntry(RPC::JsonContext&);
 Json::Value
+doLedgerExport(RPC::JsonContext&);
+Json::Value
 doLedgerHeader(RPC::JsonContext&);
 Json::Value
 doLedgerRequest(RPC::JsonContext&);
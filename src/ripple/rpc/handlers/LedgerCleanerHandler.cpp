@@ -28,8 +28,7 @@ namespace ripple {
 Json::Value
 doLedgerCleaner(RPC::JsonContext& context)
 {
-    context.app.getLedgerMaster().doLedgerCleaner(context.params);
-    return RPC::makeObjectValue("Cleaner configured");
+    return context.app.getLedgerMaster().doLedgerCleaner(context.params);
 }
 
 }  // namespace ripple
@@ -1,6 +1,8 @@
 #include <ripple/rpc/GRPCHandlers.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 
+#include <thread>
+
 namespace ripple {
 std::pair<org::xrpl::rpc::v1::GetLedgerDiffResponse, grpc::Status>
 doLedgerDiffGrpc(
@@ -50,8 +52,11 @@ doLedgerDiffGrpc(
 
     int maxDifferences = std::numeric_limits<int>::max();
 
+    // Diffs of whole state maps can be large, so compare the
+    // branches below the roots on several threads
+    int const threads = std::thread::hardware_concurrency();
     bool res = baseLedger->stateMap().compare(
-        desiredLedger->stateMap(), differences, maxDifferences);
+        desiredLedger->stateMap(), differences, maxDifferences, threads);
     if (!res)
     {
         grpc::Status errorStatus{
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/RPCHelpers.h>
+
+namespace ripple {
+
+// {
+//   ledger_hash : <ledger>
+//   ledger_index : <ledger_index>
+//   path : <string>             // the file to write
+//   threads : <number>          // optional, defaults to the core count
+// }
+//
+// Writes the whole state of the ledger to a file, for tools that would
+// otherwise page through ledger_data. The file layout is described in
+// StateExport.cpp.
+Json::Value
+doLedgerExport(RPC::JsonContext& context)
+{
+    auto const& params = context.params;
+
+    if (!params.isMember(jss::path))
+        return RPC::missing_field_error(jss::path);
+    if (!params[jss::path].isString() || params[jss::path].asString().empty())
+        return RPC::invalid_field_error(jss::path);
+    auto const path = params[jss::path].asString();
+
+    std::size_t threads = context.app.getWorkerPool().concurrency();
+    if (params.isMember(jss::threads))
+    {
+        auto const& t = params[jss::threads];
+        if (!t.isIntegral() || (t.isInt() ? t.asInt() < 1 : t.asUInt() < 1))
+            return RPC::invalid_field_error(jss::threads);
+        threads = t.asUInt();
+    }
+
+    std::shared_ptr<ReadView const> view;
+    auto result = RPC::lookupLedger(view, context);
+    if (!view)
+        return result;
+
+    auto const ledger = std::dynamic_pointer_cast<Ledger const>(view);
+    if (!ledger)
+        return RPC::make_error(rpcLGR_NOT_FOUND, "ledgerNotClosed");
+
+    StateExport::Summary summary;
+    try
+    {
+        summary = StateExport::write(
+            ledger->stateMap(),
+            ledger->info(),
+            path,
+            threads,
+            context.app.getWorkerPool(),
+            context.app.journal("StateExport"));
+    }
+    catch (std::exception const& e)
+    {
+        return RPC::make_error(rpcINTERNAL, e.what());
+    }
+
+    result[jss::path] = path;
+    result[jss::entries] = std::to_string(summary.entries);
+    result[jss::blocks] = summary.blocks;
+    result[jss::bytes] = std::to_string(summary.bytes);
+    result[jss::duration_us] = std::to_string(summary.elapsed.count());
+    return result;
+}
+
+}  // namespace ripple
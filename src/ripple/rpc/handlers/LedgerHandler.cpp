@@ -30,6 +30,8 @@
 #include <ripple/rpc/impl/GRPCHelpers.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 
+#include <thread>
+
 namespace ripple {
 namespace RPC {
 
@@ -174,8 +176,11 @@ doLedgerGrpc(RPC::GRPCContext<org::xrpl::rpc::v1::GetLedgerRequest>& context)
 
         int maxDifferences = std::numeric_limits<int>::max();
 
+        // Diffs of whole state maps can be large, so compare the
+        // branches below the roots on several threads
+        int const threads = std::thread::hardware_concurrency();
         bool res = base->stateMap().compare(
-            desired->stateMap(), differences, maxDifferences);
+            desired->stateMap(), differences, maxDifferences, threads);
         if (!res)
         {
             grpc::Status errorStatus{
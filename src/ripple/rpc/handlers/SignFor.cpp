@@ -49,7 +49,8 @@ doSignFor(RPC::JsonContext& context)
         failType,
         context.role,
         context.ledgerMaster.getValidatedLedgerAge(),
-        context.app);
+        context.app,
+        context.coro);
 
     ret[jss::deprecated] =
         "This command has been deprecated and will be "
@@ -48,7 +48,8 @@ doSign(RPC::JsonContext& context)
         failType,
         context.role,
         context.ledgerMaster.getValidatedLedgerAge(),
-        context.app);
+        context.app,
+        context.coro);
 
     ret[jss::deprecated] =
         "This command has been deprecated and will be "
@@ -63,7 +63,8 @@ doSubmit(RPC::JsonContext& context)
             context.role,
             context.ledgerMaster.getValidatedLedgerAge(),
             context.app,
-            RPC::getProcessTxnFn(context.netOps));
+            RPC::getProcessTxnFn(context.netOps),
+            context.coro);
 
         ret[jss::deprecated] =
             "Signing support in the 'submit' command has been "
@@ -105,6 +106,7 @@ doSubmit(RPC::JsonContext& context)
                 Validity::SigGoodOnly);
         auto [validity, reason] = checkValidity(
             context.app.getHashRouter(),
+            context.app.getSignatureCache(),
             *stpTrans,
             context.ledgerMaster.getCurrentLedger()->rules(),
             context.app.config());
@@ -234,6 +236,7 @@ doSubmitGrpc(
                 Validity::SigGoodOnly);
         auto [validity, reason] = checkValidity(
             context.app.getHashRouter(),
+            context.app.getSignatureCache(),
             *stpTrans,
             context.ledgerMaster.getCurrentLedger()->rules(),
             context.app.config());
@@ -18,13 +18,16 @@
 //==============================================================================
 
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/TransactionFilter.h>
 #include <ripple/basics/Log.h>
 #include <ripple/ledger/ReadView.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/net/RPCSub.h>
 #include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/TxFormats.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
@@ -33,6 +36,113 @@
 
 namespace ripple {
 
+// Parse an issue of a book in a transaction filter
+static bool
+parseIssue(Json::Value const& jv, Issue& issue)
+{
+    if (!jv.isObject() || !jv.isMember(jss::currency) ||
+        !jv[jss::currency].isString() ||
+        !to_currency(issue.currency, jv[jss::currency].asString()))
+        return false;
+
+    if (jv.isMember(jss::issuer) &&
+        (!jv[jss::issuer].isString() ||
+         !to_issuer(issue.account, jv[jss::issuer].asString())))
+        return false;
+
+    return !isXRP(issue.currency) == !isXRP(issue.account) &&
+        issue.account != noAccount();
+}
+
+// Parse the filter for the transactions stream. If there is an error,
+// return it as JSON.
+static boost::optional<Json::Value>
+parseTransactionFilter(Json::Value const& jv, TransactionFilter& filter)
+{
+    if (!jv.isObject())
+        return RPC::object_field_error(jss::transaction_filter);
+
+    auto member = [&jv](Json::StaticString name) -> Json::Value const* {
+        if (!jv.isMember(name))
+            return nullptr;
+        return &jv[name];
+    };
+
+    if (auto const types = member(jss::transaction_types))
+    {
+        if (!types->isArray() || types->size() == 0)
+            return RPC::expected_field_error(jss::transaction_types, "array");
+        for (auto const& type : *types)
+        {
+            try
+            {
+                if (!type.isString())
+                    return RPC::invalid_field_error(jss::transaction_types);
+                filter.addType(
+                    TxFormats::getInstance().findTypeByName(type.asString()));
+            }
+            catch (std::exception const&)
+            {
+                return RPC::invalid_field_error(jss::transaction_types);
+            }
+        }
+    }
+
+    if (auto const accounts = member(jss::accounts))
+    {
+        if (!accounts->isArray() || accounts->size() == 0)
+            return RPC::expected_field_error(jss::accounts, "array");
+        for (auto const& account : *accounts)
+        {
+            boost::optional<AccountID> id;
+            if (account.isString())
+                id = parseBase58<AccountID>(account.asString());
+            if (!id)
+                return RPC::invalid_field_error(jss::accounts);
+            filter.addAccount(*id);
+        }
+    }
+
+    if (auto const currencies = member(jss::currencies))
+    {
+        if (!currencies->isArray() || currencies->size() == 0)
+            return RPC::expected_field_error(jss::currencies, "array");
+        for (auto const& currency : *currencies)
+        {
+            Currency c;
+            if (!currency.isString() || !to_currency(c, currency.asString()))
+                return RPC::invalid_field_error(jss::currencies);
+            filter.addCurrency(c);
+        }
+    }
+
+    if (auto const books = member(jss::books))
+    {
+        if (!books->isArray() || books->size() == 0)
+            return RPC::expected_field_error(jss::books, "array");
+        for (auto const& j : *books)
+        {
+            Book book;
+            if (!j.isObject() || !parseIssue(j[jss::taker_pays], book.in) ||
+                !parseIssue(j[jss::taker_gets], book.out) ||
+                book.in == book.out)
+                return RPC::invalid_field_error(jss::books);
+            filter.addBook(book);
+        }
+    }
+
+    if (jv.isMember(jss::min_amount))
+    {
+        STAmount amount;
+        if (!amountFromJsonNoThrow(amount, jv[jss::min_amount]) ||
+            amount.negative())
+            return RPC::invalid_field_error(jss::min_amount);
+        filter.setMinAmount(amount);
+    }
+
+    return boost::none;
+}
+
 Json::Value
 doSubscribe(RPC::JsonContext& context)
 {
@@ -111,6 +221,19 @@ doSubscribe(RPC::JsonContext& context)
         ispSub = context.infoSub;
     }
 
+    // Without a filter transactions subscribers are sent every
+    // validated transaction
+    std::shared_ptr<TransactionFilter const> transactionFilter;
+    if (context.params.isMember(jss::transaction_filter))
+    {
+        auto filter = std::make_shared<TransactionFilter>();
+        if (auto const err = parseTransactionFilter(
+                context.params[jss::transaction_filter], *filter))
+            return *err;
+        if (!filter->empty())
+            transactionFilter = std::move(filter);
+    }
+
     if (context.params.isMember(jss::streams))
     {
         if (!context.params[jss::streams].isArray())
@@ -144,7 +267,10 @@ doSubscribe(RPC::JsonContext& context)
             }
             else if (streamName == "transactions")
             {
-                context.netOps.subTransactions(ispSub);
+                if (transactionFilter)
+                    context.netOps.subTransactions(ispSub, transactionFilter);
+                else
+                    context.netOps.subTransactions(ispSub);
             }
             else if (
                 streamName == "transactions_proposed" ||
@@ -311,14 +437,26 @@ doSubscribe(RPC::JsonContext& context)
                     Json::Value jvOffers(Json::objectValue);
 
                     auto add = [&](Json::StaticString field) {
-                        context.netOps.getBookPage(
-                            lpLedger,
-                            field == jss::asks ? reversed(book) : book,
-                            takerID ? *takerID : noAccount(),
-                            false,
-                            RPC::Tuning::bookOffers.rdefault,
-                            jvMarker,
-                            jvOffers);
+                        auto const& side =
+                            field == jss::asks ? reversed(book) : book;
+                        auto const taker = takerID ? *takerID : noAccount();
+                        if (!context.app.getOrderBookDB().getSnapshotPage(
+                                *lpLedger,
+                                side,
+                                taker,
+                                RPC::Tuning::bookOffers.rdefault,
+                                jvOffers))
+                        {
+                            context.netOps.getBookPage(
+                                lpLedger,
+                                side,
+                                taker,
+                                false,
+                                false,
+                                RPC::Tuning::bookOffers.rdefault,
+                                jvMarker,
+                                jvOffers);
+                        }
 
                         if (jvResult.isMember(field))
                         {
@@ -91,8 +91,7 @@ doTxPostgres(RPC::Context& context, TxArgs const& args)
                 locator.getNodestoreHash(), locator.getLedgerSequence()))
         {
             auto node = SHAMapTreeNode::makeFromPrefix(
-                makeSlice(obj->getData()),
-                SHAMapHash{locator.getNodestoreHash()});
+                obj->getData(), SHAMapHash{locator.getNodestoreHash()});
             if (!node)
             {
                 assert(false);
@@ -394,7 +393,8 @@ populateJsonResponse(
 Json::Value
 doTxJson(RPC::JsonContext& context)
 {
-    if (!context.app.config().useTxTables())
+    if (!context.app.config().useTxTables() &&
+        !context.app.config().txIndex())
         return rpcError(rpcNOT_ENABLED);
 
     // Deserialize and validate JSON arguments
@@ -433,7 +433,8 @@ doTxJson(RPC::JsonContext& context)
 std::pair<org::xrpl::rpc::v1::GetTransactionResponse, grpc::Status>
 doTxGrpc(RPC::GRPCContext<org::xrpl::rpc::v1::GetTransactionRequest>& context)
 {
-    if (!context.app.config().useTxTables())
+    if (!context.app.config().useTxTables() &&
+        !context.app.config().txIndex())
     {
         return {
             {},
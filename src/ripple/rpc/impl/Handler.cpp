@@ -84,6 +84,7 @@ Handler const handlerArray[]{
     {"download_shard", byRef(&doDownloadShard), Role::ADMIN, NO_CONDITION},
     {"gateway_balances", byRef(&doGatewayBalances), Role::USER, NO_CONDITION},
     {"get_counts", byRef(&doGetCounts), Role::ADMIN, NO_CONDITION},
+    {"get_trace", byRef(&doGetTrace), Role::ADMIN, NO_CONDITION},
     {"feature", byRef(&doFeature), Role::ADMIN, NO_CONDITION},
     {"fee", byRef(&doFee), Role::USER, NEEDS_CURRENT_LEDGER},
     {"fetch_info", byRef(&doFetchInfo), Role::ADMIN, NO_CONDITION},
@@ -102,6 +103,7 @@ Handler const handlerArray[]{
      NEEDS_CURRENT_LEDGER},
     {"ledger_data", byRef(&doLedgerData), Role::USER, NO_CONDITION},
     {"ledger_entry", byRef(&doLedgerEntry), Role::USER, NO_CONDITION},
+    {"ledger_export", byRef(&doLedgerExport), Role::ADMIN, NO_CONDITION},
     {"ledger_header", byRef(&doLedgerHeader), Role::USER, NO_CONDITION},
     {"ledger_request", byRef(&doLedgerRequest), Role::ADMIN, NO_CONDITION},
     {"log_level", byRef(&doLogLevel), Role::ADMIN, NO_CONDITION},
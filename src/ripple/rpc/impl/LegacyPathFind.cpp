@@ -38,6 +38,7 @@ LegacyPathFind::LegacyPathFind(bool isAdmin, Application& app) : m_isOk(false)
 
     auto const& jobCount = app.getJobQueue().getJobCountGE(jtCLIENT);
     if (jobCount > Tuning::maxPathfindJobCount ||
+        app.getJobQueue().isBacklogged(jtCLIENT) ||
         app.getFeeTrack().isLoadedLocal())
         return;
 
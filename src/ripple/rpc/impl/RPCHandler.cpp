@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
@@ -30,9 +31,11 @@
 #include <ripple/json/to_string.h>
 #include <ripple/net/InfoSub.h>
 #include <ripple/net/RPCErr.h>
+#include <ripple/nodestore/Scheduler.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/RPCHandler.h>
+#include <ripple/rpc/ResponseCache.h>
 #include <ripple/rpc/Role.h>
 #include <ripple/rpc/impl/Handler.h>
 #include <ripple/rpc/impl/Tuning.h>
@@ -137,6 +140,13 @@ fillHandler(JsonContext& context, Handler const*& result)
             JLOG(context.j.debug()) << "Too busy for command: " << jc;
             return rpcTOO_BUSY;
         }
+
+        // Shed client load while queued commands miss their latency target
+        if (context.app.getJobQueue().isBacklogged(jtCLIENT))
+        {
+            JLOG(context.j.debug()) << "Too busy for command: backlogged";
+            return rpcTOO_BUSY;
+        }
     }
 
     if (!context.params.isMember(jss::command) &&
@@ -185,6 +195,8 @@ callMethod(
     static std::atomic<std::uint64_t> requestId{0};
     auto& perfLog = context.app.getPerfLog();
     std::uint64_t const curId = ++requestId;
+    NodeStore::ScopedFetchCaller const fetchCaller(
+        NodeStore::FetchCaller::rpc);
     try
     {
         perfLog.rpcStart(name, curId);
@@ -219,6 +231,38 @@ callMethod(
     }
 }
 
+// Calls the method, answering from the response cache if it's enabled
+template <class Method>
+Status
+callCachedMethod(
+    JsonContext& context,
+    Method method,
+    std::string const& name,
+    Json::Value& result)
+{
+    auto& cache = context.app.getResponseCache();
+    // Reporting mode has no closed ledger to key the cache on
+    if (!cache.enabled(name) || context.app.config().reporting())
+        return callMethod(context, method, name, result);
+
+    auto const hashOf = [](std::shared_ptr<Ledger const> const& ledger) {
+        return ledger ? ledger->info().hash : uint256{};
+    };
+    auto const closed = hashOf(context.ledgerMaster.getClosedLedger());
+    auto const validated = hashOf(context.ledgerMaster.getValidatedLedger());
+
+    auto key = ResponseCache::makeKey(
+        name, context.params, context.apiVersion, context.role);
+    if (cache.fetch(key, closed, validated, result, context.loadType))
+        return rpcSUCCESS;
+
+    auto const ret = callMethod(context, method, name, result);
+    if (!ret && !result.isMember(jss::error))
+        cache.insert(
+            std::move(key), closed, validated, result, context.loadType);
+    return ret;
+}
+
 }  // namespace
 
 void
@@ -268,7 +312,8 @@ doCommand(RPC::JsonContext& context, Json::Value& result)
                 << ", user: " << context.headers.user
                 << ", forwarded for: " << context.headers.forwardedFor;
 
-            auto ret = callMethod(context, method, handler->name_, result);
+            auto ret =
+                callCachedMethod(context, method, handler->name_, result);
 
             JLOG(context.j.debug())
                 << "finish command: " << handler->name_
@@ -279,7 +324,8 @@ doCommand(RPC::JsonContext& context, Json::Value& result)
         }
         else
         {
-            auto ret = callMethod(context, method, handler->name_, result);
+            auto ret =
+                callCachedMethod(context, method, handler->name_, result);
             injectReportingWarning(context, result);
             return ret;
         }
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/ledger/View.h>
@@ -26,6 +27,7 @@
 #include <ripple/protocol/Feature.h>
 #include <ripple/rpc/Context.h>
 #include <ripple/rpc/DeliveredAmount.h>
+#include <ripple/rpc/SigningQueue.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 #include <boost/algorithm/string/case_conv.hpp>
 
@@ -96,7 +98,8 @@ getAccountObjects(
     uint256 dirIndex,
     uint256 const& entryIndex,
     std::uint32_t const limit,
-    Json::Value& jvResult)
+    Json::Value& jvResult,
+    bool binary)
 {
     auto const root = keylet::ownerDir(account);
     auto found = false;
@@ -127,6 +130,18 @@ getAccountObjects(
             found = true;
         }
 
+        // Read the entries of the page into the state map together, as
+        // reading them one at a time waits on the node store for each
+        if (auto const stateLedger = dynamic_cast<Ledger const*>(&ledger))
+        {
+            auto last = entries.end();
+            if (!typeFilter &&
+                std::distance(iter, last) > std::ptrdiff_t(limit - i))
+                last = iter + (limit - i);
+            stateLedger->stateMap().fetchPaths(
+                std::vector<uint256>(iter, last));
+        }
+
         for (; iter != entries.end(); ++iter)
         {
             auto const sleNode = ledger.read(keylet::child(*iter));
@@ -142,7 +157,16 @@ getAccountObjects(
             if (!typeFilter.has_value() ||
                 typeMatchesFilter(typeFilter.value(), sleNode->getType()))
             {
-                jvObjects.append(sleNode->getJson(JsonOptions::none));
+                if (binary)
+                {
+                    Json::Value& entry = jvObjects.append(Json::objectValue);
+                    entry[jss::data] = serializeHex(*sleNode);
+                    entry[jss::index] = to_string(sleNode->key());
+                }
+                else
+                {
+                    jvObjects.append(sleNode->getJson(JsonOptions::none));
+                }
 
                 if (++i == limit)
                 {
@@ -540,6 +564,12 @@ lookupLedger(
     if (auto status = ledgerFromRequest(ledger, context))
         return status;
 
+    // Requests read the same hot entries of closed ledgers over and over,
+    // so share the deserialized entries between them.
+    if (auto closed = std::dynamic_pointer_cast<Ledger const>(ledger))
+        ledger = std::make_shared<CachedLedger const>(
+            closed, context.app.cachedSLEs());
+
     auto& info = ledger->info();
 
     if (!ledger->open())
@@ -705,7 +735,10 @@ getSeedFromRPC(Json::Value const& params, Json::Value& error)
 }
 
 std::pair<PublicKey, SecretKey>
-keypairForSignature(Json::Value const& params, Json::Value& error)
+keypairForSignature(
+    Json::Value const& params,
+    Json::Value& error,
+    SigningQueue* signing)
 {
     bool const has_key_type = params.isMember(jss::key_type);
 
@@ -828,6 +861,8 @@ keypairForSignature(Json::Value const& params, Json::Value& error)
     if (keyType != KeyType::secp256k1 && keyType != KeyType::ed25519)
         LogicError("keypairForSignature: invalid key type");
 
+    if (signing)
+        return signing->keyPair(*keyType, *seed);
     return generateKeyPair(*keyType, *seed);
 }
 
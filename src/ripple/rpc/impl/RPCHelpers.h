@@ -44,6 +44,7 @@ class Transaction;
 namespace RPC {
 
 struct JsonContext;
+class SigningQueue;
 
 /** Get an AccountID from an account ID or public key. */
 boost::optional<AccountID>
@@ -79,6 +80,7 @@ accountFromStringWithCode(
     @param entryIndex Begin gathering objects from this directory node.
     @param limit Maximum number of objects to find.
     @param jvResult A JSON result that holds the request objects.
+    @param binary Return each object serialized, with its index.
 */
 bool
 getAccountObjects(
@@ -88,7 +90,8 @@ getAccountObjects(
     uint256 dirIndex,
     uint256 const& entryIndex,
     std::uint32_t const limit,
-    Json::Value& jvResult);
+    Json::Value& jvResult,
+    bool binary = false);
 
 /** Get ledger by hash
     If there is no error in the return value, the ledger pointer will have
@@ -186,8 +189,15 @@ getSeedFromRPC(Json::Value const& params, Json::Value& error);
 boost::optional<Seed>
 parseRippleLibSeed(Json::Value const& params);
 
+/** Return the key pair for the secret of a signing request.
+
+    If a signing queue is passed, the key pair is taken from its cache.
+*/
 std::pair<PublicKey, SecretKey>
-keypairForSignature(Json::Value const& params, Json::Value& error);
+keypairForSignature(
+    Json::Value const& params,
+    Json::Value& error,
+    SigningQueue* signing = nullptr);
 
 /**
  * API version numbers used in API version 1
@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/ResponseCache.h>
+#include <boost/algorithm/string.hpp>
+
+namespace ripple {
+namespace RPC {
+
+ResponseCache::ResponseCache(
+    Setup const& setup,
+    beast::insight::Collector::ptr const& collector)
+    : setup_(setup)
+    , hits_(collector->make_counter("rpc_cache", "hits"))
+    , misses_(collector->make_counter("rpc_cache", "misses"))
+{
+}
+
+std::string
+ResponseCache::makeKey(
+    std::string const& method,
+    Json::Value const& params,
+    unsigned apiVersion,
+    Role role)
+{
+    // The members of a Json object are kept sorted, so equal requests
+    // serialize the same way. Drop the fields that only label a request.
+    Json::Value canonical = params;
+    if (canonical.isObject())
+    {
+        canonical.removeMember(jss::id);
+        canonical.removeMember(jss::command);
+        canonical.removeMember(jss::method);
+        canonical.removeMember(jss::jsonrpc);
+        canonical.removeMember(jss::ripplerpc);
+    }
+
+    return method + '\n' + std::to_string(apiVersion) + '\n' +
+        std::to_string(static_cast<int>(role)) + '\n' + to_string(canonical);
+}
+
+bool
+ResponseCache::fetch(
+    std::string const& key,
+    uint256 const& closed,
+    uint256 const& validated,
+    Json::Value& result,
+    Resource::Charge& loadType)
+{
+    std::lock_guard lock(mutex_);
+    if (closed != closed_ || validated != validated_)
+    {
+        entries_.clear();
+        closed_ = closed;
+        validated_ = validated;
+    }
+
+    auto const it = entries_.find(key);
+    if (it == entries_.end())
+    {
+        ++misses_;
+        return false;
+    }
+
+    ++hits_;
+    result = it->second.result;
+    loadType = it->second.loadType;
+    return true;
+}
+
+void
+ResponseCache::insert(
+    std::string key,
+    uint256 const& closed,
+    uint256 const& validated,
+    Json::Value const& result,
+    Resource::Charge const& loadType)
+{
+    std::lock_guard lock(mutex_);
+    if (closed != closed_ || validated != validated_)
+        return;
+
+    if (entries_.size() >= setup_.maxEntries)
+        return;
+
+    entries_.emplace(std::move(key), Entry{result, loadType});
+}
+
+ResponseCache::Setup
+setup_ResponseCache(Config const& config)
+{
+    ResponseCache::Setup setup;
+    auto const& section = config.section("rpc_cache");
+
+    std::string methods;
+    if (set(methods, "methods", section))
+    {
+        std::vector<std::string> names;
+        boost::split(names, methods, boost::is_any_of(", "));
+        for (auto& name : names)
+        {
+            boost::trim(name);
+            if (!name.empty())
+                setup.methods.insert(std::move(name));
+        }
+    }
+
+    std::size_t maxEntries = setup.maxEntries;
+    if (set(maxEntries, "max_entries", section))
+    {
+        if (maxEntries == 0)
+            Throw<std::runtime_error>(
+                "[rpc_cache] max_entries must be greater than zero");
+        setup.maxEntries = maxEntries;
+    }
+
+    return setup;
+}
+
+}  // namespace RPC
+}  // namespace ripple
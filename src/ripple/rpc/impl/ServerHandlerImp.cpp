@@ -17,9 +17,11 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/PerfLog.h>
 #include <ripple/basics/base64.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/make_SSLContext.h>
@@ -49,6 +51,8 @@
 #include <boost/regex.hpp>
 #include <boost/type_traits.hpp>
 #include <algorithm>
+#include <atomic>
+#include <set>
 #include <stdexcept>
 
 namespace ripple {
@@ -61,6 +65,13 @@ isStatusRequest(http_request_type const& request)
         request.method() == boost::beast::http::verb::get;
 }
 
+static bool
+isMetricsRequest(http_request_type const& request)
+{
+    return request.target() == "/metrics" &&
+        request.method() == boost::beast::http::verb::get;
+}
+
 static Handoff
 statusRequestResponse(
     http_request_type const& request,
@@ -121,6 +132,7 @@ ServerHandlerImp::ServerHandlerImp(
     rpc_requests_ = group->make_counter("requests");
     rpc_size_ = group->make_event("size");
     rpc_time_ = group->make_event("time");
+    rpc_latency_ = group->make_histogram("latency");
 }
 
 ServerHandlerImp::~ServerHandlerImp()
@@ -224,6 +236,11 @@ ServerHandlerImp::onHandoff(
     if (is_ws && isStatusRequest(request))
         return statusResponse(request);
 
+    if ((p.count("http") > 0 || p.count("https") > 0) &&
+        isMetricsRequest(request))
+        return metricsResponse(
+            session.port(), request, remote_address.address());
+
     // Otherwise pass to legacy onRequest or websocket
     return {};
 }
@@ -338,11 +355,13 @@ ServerHandlerImp::onWSMessage(
         [this, session, jv = std::move(jv)](
             std::shared_ptr<JobQueue::Coro> const& coro) {
             auto const jr = this->processSession(session, coro, jv);
-            auto const s = to_string(jr);
-            auto const n = s.length();
-            boost::beast::multi_buffer sb(n);
-            sb.commit(boost::asio::buffer_copy(
-                sb.prepare(n), boost::asio::buffer(s.c_str(), n)));
+            // Serialize straight into the message; the socket sends it
+            // as frames of a bounded size
+            boost::beast::multi_buffer sb;
+            Json::stream(jr, [&sb](auto const p, auto const n) {
+                sb.commit(boost::asio::buffer_copy(
+                    sb.prepare(n), boost::asio::buffer(p, n)));
+            });
             session->send(
                 std::make_shared<StreambufWSMsg<decltype(sb)>>(std::move(sb)));
             session->complete();
@@ -521,6 +540,8 @@ ServerHandlerImp::processSession(
         buffers_to_string(session->request().body().data()),
         session->remoteAddress().at_port(0),
         makeOutput(*session),
+        // Chunked transfer encoding was introduced in HTTP/1.1
+        session->request().version() >= 11,
         coro,
         forwardedFor(session->request()),
         [&] {
@@ -547,6 +568,81 @@ make_json_error(Json::Int code, Json::Value&& message)
     return r;
 }
 
+// Methods that only read a ledger, whose batch entries may run in parallel
+static std::set<std::string> const parallelMethods{
+    "account_channels",
+    "account_currencies",
+    "account_info",
+    "account_lines",
+    "account_objects",
+    "account_offers",
+    "book_offers",
+    "deposit_authorized",
+    "gateway_balances",
+    "ledger_entry",
+    "noripple_check",
+    "transaction_entry",
+};
+
+// Point a request for the validated or closed ledger at the given one
+static void
+pinLedger(
+    Json::Value& params,
+    std::shared_ptr<ReadView const> const& validated,
+    std::shared_ptr<ReadView const> const& closed)
+{
+    if (params.isMember(jss::ledger_hash) || params.isMember(jss::ledger) ||
+        !params[jss::ledger_index].isString())
+        return;
+
+    auto const index = params[jss::ledger_index].asString();
+    auto const& ledger = index == "validated"
+        ? validated
+        : (index == "closed" ? closed : nullptr);
+    if (!ledger)
+        return;
+
+    params.removeMember(jss::ledger_index);
+    params[jss::ledger_hash] = to_string(ledger->info().hash);
+}
+
+void
+ServerHandlerImp::runParallel(
+    std::vector<BatchTask>& tasks,
+    Json::Value& reply,
+    std::shared_ptr<JobQueue::Coro> const& coro)
+{
+    if (tasks.size() == 1)
+    {
+        reply[tasks.front().index] = tasks.front().run();
+        return;
+    }
+
+    // The last one to finish, this coroutine or a job, resumes the batch
+    auto remaining = std::make_shared<std::atomic<std::size_t>>(tasks.size());
+    ++*remaining;
+
+    for (auto& task : tasks)
+    {
+        if (!m_jobQueue.addJob(
+                jtCLIENT, "RPC-Batch", [&task, remaining, coro](Job&) {
+                    task.result = task.run();
+                    if (--*remaining == 0 && !coro->post())
+                        coro->resume();
+                }))
+        {
+            task.result = task.run();
+            --*remaining;
+        }
+    }
+
+    if (--*remaining != 0)
+        coro->yield();
+
+    for (auto& task : tasks)
+        reply[task.index] = std::move(task.result);
+}
+
 Json::Int constexpr method_not_found = -32601;
 Json::Int constexpr server_overloaded = -32604;
 Json::Int constexpr forbidden = -32605;
@@ -558,6 +654,7 @@ ServerHandlerImp::processRequest(
     std::string const& request,
     beast::IP::Endpoint const& remoteIPAddress,
     Output&& output,
+    bool chunked,
     std::shared_ptr<JobQueue::Coro> coro,
     boost::string_view forwardedFor,
     boost::string_view user)
@@ -593,6 +690,23 @@ ServerHandlerImp::processRequest(
         size = jsonOrig[jss::params].size();
     }
 
+    // The entries of a batch that ask for the validated or closed ledger all
+    // read the one that was current when the batch arrived
+    std::shared_ptr<ReadView const> validated;
+    std::shared_ptr<ReadView const> closed;
+    if (batch)
+    {
+        auto& ledgerMaster = app_.getLedgerMaster();
+        if (app_.config().standalone() || app_.config().reporting() ||
+            ledgerMaster.getValidatedLedgerAge() <=
+                RPC::Tuning::maxValidatedLedgerAge)
+        {
+            validated = ledgerMaster.getValidatedLedger();
+            closed = ledgerMaster.getClosedLedger();
+        }
+    }
+    std::vector<BatchTask> tasks;
+
     Json::Value reply(batch ? Json::arrayValue : Json::objectValue);
     auto const start(std::chrono::high_resolution_clock::now());
     for (unsigned i = 0; i < size; ++i)
@@ -821,109 +935,137 @@ ServerHandlerImp::processRequest(
         JLOG(m_journal.trace())
             << "doRpcCommand:" << strMethod << ":" << params;
 
-        Resource::Charge loadType = Resource::feeReferenceRPC;
-
-        RPC::JsonContext context{
-            {m_journal,
-             app_,
-             loadType,
-             m_networkOPs,
-             app_.getLedgerMaster(),
-             usage,
-             role,
-             coro,
-             InfoSub::pointer(),
-             apiVersion},
-            params,
-            {user, forwardedFor}};
-        Json::Value result;
-        RPC::doCommand(context, result);
-        usage.charge(loadType);
-        if (usage.warn())
-            result[jss::warning] = jss::load;
-
-        Json::Value r(Json::objectValue);
-        if (ripplerpc >= "2.0")
-        {
-            if (result.isMember(jss::error))
+        auto execute = [this,
+                        params,
+                        usage,
+                        role,
+                        apiVersion,
+                        ripplerpc,
+                        user,
+                        forwardedFor](
+                           Json::Value contextParams,
+                           std::shared_ptr<JobQueue::Coro> coro) mutable {
+            Resource::Charge loadType = Resource::feeReferenceRPC;
+
+            RPC::JsonContext context{
+                {m_journal,
+                 app_,
+                 loadType,
+                 m_networkOPs,
+                 app_.getLedgerMaster(),
+                 usage,
+                 role,
+                 coro,
+                 InfoSub::pointer(),
+                 apiVersion},
+                std::move(contextParams),
+                {user, forwardedFor}};
+            Json::Value result;
+            RPC::doCommand(context, result);
+            usage.charge(loadType);
+            if (usage.warn())
+                result[jss::warning] = jss::load;
+
+            Json::Value r(Json::objectValue);
+            if (ripplerpc >= "2.0")
             {
-                result[jss::status] = jss::error;
-                result["code"] = result[jss::error_code];
-                result["message"] = result[jss::error_message];
-                result.removeMember(jss::error_message);
-                JLOG(m_journal.debug()) << "rpcError: " << result[jss::error]
-                                        << ": " << result[jss::error_message];
-                r[jss::error] = std::move(result);
+                if (result.isMember(jss::error))
+                {
+                    result[jss::status] = jss::error;
+                    result["code"] = result[jss::error_code];
+                    result["message"] = result[jss::error_message];
+                    result.removeMember(jss::error_message);
+                    JLOG(m_journal.debug())
+                        << "rpcError: " << result[jss::error] << ": "
+                        << result[jss::error_message];
+                    r[jss::error] = std::move(result);
+                }
+                else
+                {
+                    result[jss::status] = jss::success;
+                    r[jss::result] = std::move(result);
+                }
             }
             else
             {
-                result[jss::status] = jss::success;
+                // Always report "status".  On an error report the request as
+                // received.
+                if (result.isMember(jss::error))
+                {
+                    auto rq = params;
+
+                    if (rq.isObject())
+                    {  // But mask potentially sensitive information.
+                        if (rq.isMember(jss::passphrase.c_str()))
+                            rq[jss::passphrase.c_str()] = "<masked>";
+                        if (rq.isMember(jss::secret.c_str()))
+                            rq[jss::secret.c_str()] = "<masked>";
+                        if (rq.isMember(jss::seed.c_str()))
+                            rq[jss::seed.c_str()] = "<masked>";
+                        if (rq.isMember(jss::seed_hex.c_str()))
+                            rq[jss::seed_hex.c_str()] = "<masked>";
+                    }
+
+                    result[jss::status] = jss::error;
+                    result[jss::request] = rq;
+
+                    JLOG(m_journal.debug())
+                        << "rpcError: " << result[jss::error] << ": "
+                        << result[jss::error_message];
+                }
+                else
+                {
+                    result[jss::status] = jss::success;
+                }
                 r[jss::result] = std::move(result);
             }
-        }
-        else
-        {
-            // Always report "status".  On an error report the request as
-            // received.
-            if (result.isMember(jss::error))
-            {
-                auto rq = params;
-
-                if (rq.isObject())
-                {  // But mask potentially sensitive information.
-                    if (rq.isMember(jss::passphrase.c_str()))
-                        rq[jss::passphrase.c_str()] = "<masked>";
-                    if (rq.isMember(jss::secret.c_str()))
-                        rq[jss::secret.c_str()] = "<masked>";
-                    if (rq.isMember(jss::seed.c_str()))
-                        rq[jss::seed.c_str()] = "<masked>";
-                    if (rq.isMember(jss::seed_hex.c_str()))
-                        rq[jss::seed_hex.c_str()] = "<masked>";
-                }
 
-                result[jss::status] = jss::error;
-                result[jss::request] = rq;
+            if (params.isMember(jss::jsonrpc))
+                r[jss::jsonrpc] = params[jss::jsonrpc];
+            if (params.isMember(jss::ripplerpc))
+                r[jss::ripplerpc] = params[jss::ripplerpc];
+            if (params.isMember(jss::id))
+                r[jss::id] = params[jss::id];
+            return r;
+        };
 
-                JLOG(m_journal.debug()) << "rpcError: " << result[jss::error]
-                                        << ": " << result[jss::error_message];
-            }
-            else
-            {
-                result[jss::status] = jss::success;
-            }
-            r[jss::result] = std::move(result);
+        if (batch && coro && parallelMethods.count(strMethod))
+        {
+            auto contextParams = params;
+            pinLedger(contextParams, validated, closed);
+            tasks.push_back({reply.size(), [execute, contextParams]() mutable {
+                                 return execute(
+                                     std::move(contextParams), nullptr);
+                             }});
+            reply.append(Json::nullValue);
         }
-
-        if (params.isMember(jss::jsonrpc))
-            r[jss::jsonrpc] = params[jss::jsonrpc];
-        if (params.isMember(jss::ripplerpc))
-            r[jss::ripplerpc] = params[jss::ripplerpc];
-        if (params.isMember(jss::id))
-            r[jss::id] = params[jss::id];
-        if (batch)
-            reply.append(std::move(r));
+        else if (batch)
+            reply.append(execute(params, coro));
         else
-            reply = std::move(r);
+            reply = execute(params, coro);
     }
-    auto response = to_string(reply);
 
-    rpc_time_.notify(std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::high_resolution_clock::now() - start));
+    if (!tasks.empty())
+        runParallel(tasks, reply, coro);
+    auto const elapsed = std::chrono::high_resolution_clock::now() - start;
+    rpc_time_.notify(
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed));
+    rpc_latency_.notify(elapsed);
     ++rpc_requests_;
-    rpc_size_.notify(beast::insight::Event::value_type{response.size()});
-
-    response += '\n';
 
     if (auto stream = m_journal.debug())
     {
         static const int maxSize = 10000;
+        auto const response = to_string(reply);
         if (response.size() <= maxSize)
             stream << "Reply: " << response;
         else
             stream << "Reply: " << response.substr(0, maxSize);
     }
 
-    HTTPReply(200, response, output, rpcJ);
+    // The reply is serialized as it is written, in chunks if it's large
+    auto const replySize = HTTPReply(200, reply, output, chunked, rpcJ);
+    rpc_size_.notify(beast::insight::Event::value_type{replySize});
 }
 
 //------------------------------------------------------------------------------
@@ -962,6 +1104,31 @@ ServerHandlerImp::statusResponse(http_request_type const& request) const
     return handoff;
 }
 
+Handoff
+ServerHandlerImp::metricsResponse(
+    Port const& port,
+    http_request_type const& request,
+    boost::asio::ip::address const& remote_address) const
+{
+    using namespace boost::beast::http;
+    if (!ipAllowed(remote_address, port.admin_ip) ||
+        !authorized(port, build_map(request)))
+        return statusRequestResponse(request, status::forbidden);
+
+    Handoff handoff;
+    response<string_body> msg;
+    msg.result(status::ok);
+    msg.version(request.version());
+    msg.insert("Server", BuildInfo::getFullVersionString());
+    msg.insert("Content-Type", "text/plain; version=0.0.4");
+    msg.body() = app_.getPerfLog().prometheus();
+    msg.keep_alive(beast::rfc2616::is_keep_alive(request));
+    msg.prepare_payload();
+    handoff.keep_alive = msg.keep_alive();
+    handoff.response = std::make_shared<SimpleWriter>(msg);
+    return handoff;
+}
+
 //------------------------------------------------------------------------------
 
 void
@@ -1031,6 +1198,7 @@ to_Port(ParsedPort const& parsed, std::ostream& log)
     p.ssl_ciphers = parsed.ssl_ciphers;
     p.pmd_options = parsed.pmd_options;
     p.ws_queue_limit = parsed.ws_queue_limit;
+    p.pipeline_depth = parsed.pipeline_depth;
     p.limit = parsed.limit;
 
     return p;
@@ -31,6 +31,7 @@
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
 #include <boost/utility/string_view.hpp>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <vector>
@@ -98,6 +99,7 @@ private:
     beast::insight::Counter rpc_requests_;
     beast::insight::Event rpc_size_;
     beast::insight::Event rpc_time_;
+    beast::insight::Histogram rpc_latency_;
     std::mutex countlock_;
     std::map<std::reference_wrapper<Port const>, int> count_;
 
@@ -190,12 +192,36 @@ private:
         std::string const& request,
         beast::IP::Endpoint const& remoteIPAddress,
         Output&&,
+        bool chunked,
         std::shared_ptr<JobQueue::Coro> coro,
         boost::string_view forwardedFor,
         boost::string_view user);
 
+    // A batch entry run on its own job, and where its reply goes
+    struct BatchTask
+    {
+        unsigned index;
+        std::function<Json::Value()> run;
+        Json::Value result{};
+    };
+
+    // Run batch entries side by side, suspending the coroutine until the
+    // last of them has finished, and put their replies in place.
+    void
+    runParallel(
+        std::vector<BatchTask>& tasks,
+        Json::Value& reply,
+        std::shared_ptr<JobQueue::Coro> const& coro);
+
     Handoff
     statusResponse(http_request_type const& request) const;
+
+    // Serve the performance counters to an admin in the Prometheus format
+    Handoff
+    metricsResponse(
+        Port const& port,
+        http_request_type const& request,
+        boost::asio::ip::address const& remote_address) const;
 };
 
 }  // namespace ripple
@@ -21,6 +21,7 @@
 #include <ripple/basics/Archive.h>
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/net/ArchiveDownloader.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/rpc/ShardArchiveHandler.h>
 #include <ripple/rpc/impl/Handler.h>
@@ -74,6 +75,10 @@ ShardArchiveHandler::ShardArchiveHandler(Application& app, Stoppable& parent)
     , app_(app)
     , j_(app.journal("ShardArchiveHandler"))
     , downloadDir_(getDownloadDirectory(app.config()))
+    , streamArchives_(get<bool>(
+          app.config().section(ConfigSection::shardDatabase()),
+          "stream_archives",
+          false))
     , timer_(app_.getIOService())
     , verificationScheduler_(
           std::chrono::seconds(get<std::uint32_t>(
@@ -102,8 +107,7 @@ ShardArchiveHandler::init()
     if (exists(downloadDir_ / stateDBName) &&
         is_regular_file(downloadDir_ / stateDBName))
     {
-        downloader_ =
-            make_DatabaseDownloader(app_.getIOService(), app_.config(), j_);
+        downloader_ = makeDownloader();
 
         return initFromDB(lock);
     }
@@ -290,8 +294,7 @@ ShardArchiveHandler::start()
         if (!downloader_)
         {
             // will throw if can't initialize ssl context
-            downloader_ =
-                make_DatabaseDownloader(app_.getIOService(), app_.config(), j_);
+            downloader_ = makeDownloader();
         }
     }
     catch (std::exception const& e)
@@ -380,8 +383,11 @@ ShardArchiveHandler::next(std::lock_guard<std::mutex> const& l)
     // Download the archive. Process in another thread
     // to prevent holding up the lock if the downloader
     // sleeps.
+    // When streaming, the archive is extracted into the temp
+    // directory as it arrives and is never stored.
     auto const& url{archives_.begin()->second};
-    auto wrapper = jobCounter_.wrap([this, url, dstDir](Job&) {
+    auto const dstPath{streamArchives_ ? dstDir : dstDir / "archive.tar.lz4"};
+    auto wrapper = jobCounter_.wrap([this, url, dstPath](Job&) {
         auto const ssl = (url.scheme == "https");
         auto const defaultPort = ssl ? 443 : 80;
 
@@ -390,7 +396,7 @@ ShardArchiveHandler::next(std::lock_guard<std::mutex> const& l)
                 std::to_string(url.port.get_value_or(defaultPort)),
                 url.path,
                 11,
-                dstDir / "archive.tar.lz4",
+                dstPath,
                 [this](path dstPath) { complete(dstPath); },
                 ssl))
         {
@@ -418,7 +424,11 @@ ShardArchiveHandler::complete(path dstPath)
         std::lock_guard lock(m_);
         try
         {
-            if (!is_regular_file(dstPath))
+            auto const downloaded = streamArchives_
+                ? is_directory(
+                      dstPath / std::to_string(archives_.begin()->first))
+                : is_regular_file(dstPath);
+            if (!downloaded)
             {
                 auto ar{archives_.begin()};
                 JLOG(j_.error())
@@ -498,11 +508,14 @@ ShardArchiveHandler::process(path const& dstPath)
         shardIndex = archives_.begin()->first;
     }
 
-    auto const shardDir{dstPath.parent_path() / std::to_string(shardIndex)};
+    // A streamed archive was extracted into dstPath while downloading
+    auto const extractDir{streamArchives_ ? dstPath : dstPath.parent_path()};
+    auto const shardDir{extractDir / std::to_string(shardIndex)};
     try
     {
         // Extract the downloaded archive
-        extractTarLz4(dstPath, dstPath.parent_path());
+        if (!streamArchives_)
+            extractTarLz4(dstPath, extractDir);
 
         // The extracted root directory name must match the shard index
         if (!is_directory(shardDir))
@@ -584,6 +597,15 @@ ShardArchiveHandler::doRelease(std::lock_guard<std::mutex> const&)
     process_ = false;
 }
 
+std::shared_ptr<HTTPDownloader>
+ShardArchiveHandler::makeDownloader()
+{
+    if (streamArchives_)
+        return make_ArchiveDownloader(app_.getIOService(), app_.config(), j_);
+
+    return make_DatabaseDownloader(app_.getIOService(), app_.config(), j_);
+}
+
 bool
 ShardArchiveHandler::onClosureFailed(
     std::string const& errorMsg,
@@ -0,0 +1,226 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/crypto/csprng.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/rpc/SigningQueue.h>
+#include <exception>
+
+namespace ripple {
+namespace RPC {
+
+static uint256
+makeSalt()
+{
+    uint256 salt;
+    crypto_prng()(salt.data(), salt.size());
+    return salt;
+}
+
+SigningQueue::SigningQueue(Setup const& setup, beast::Journal journal)
+    : setup_(setup), j_(journal), salt_(makeSalt())
+{
+    threads_.reserve(setup_.threads);
+    for (std::size_t i = 0; i < setup_.threads; ++i)
+    {
+        threads_.emplace_back([this, i]() {
+            beast::setCurrentThreadName("signing #" + std::to_string(i));
+            loop();
+        });
+    }
+}
+
+SigningQueue::~SigningQueue()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    cond_.notify_all();
+
+    for (auto& thread : threads_)
+        thread.join();
+}
+
+bool
+SigningQueue::post(Role role, std::function<void()> work)
+{
+    {
+        std::lock_guard lock(mutex_);
+        auto& queue = isUnlimited(role) ? unlimited_ : limited_;
+        if (stopping_ || threads_.empty() || queue.size() >= setup_.maxQueued)
+        {
+            ++rejected_;
+            return false;
+        }
+        queue.push_back(std::move(work));
+    }
+    cond_.notify_one();
+    return true;
+}
+
+bool
+SigningQueue::run(
+    Role role,
+    std::shared_ptr<JobQueue::Coro> const& coro,
+    std::function<void()> work)
+{
+    if (!coro)
+    {
+        work();
+        return true;
+    }
+
+    // The signing thread resumes the coroutine once the work is done.
+    // If that happens before the coroutine yields, the resume waits.
+    std::exception_ptr error;
+    if (!post(role, [&work, &error, coro]() {
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            if (!coro->post())
+                coro->resume();
+        }))
+    {
+        JLOG(j_.debug()) << "Signing queue full";
+        return false;
+    }
+
+    coro->yield();
+    if (error)
+        std::rethrow_exception(error);
+    return true;
+}
+
+std::pair<PublicKey, SecretKey>
+SigningQueue::keyPair(KeyType type, Seed const& seed)
+{
+    auto const key = sha512Half_s(
+        salt_,
+        static_cast<std::uint8_t>(type),
+        Slice(seed.data(), seed.size()));
+
+    {
+        std::lock_guard lock(keyMutex_);
+        if (auto it = keys_.find(key); it != keys_.end())
+        {
+            ++keyHits_;
+            keyOrder_.splice(keyOrder_.begin(), keyOrder_, it->second.second);
+            return it->second.first;
+        }
+        ++keyMisses_;
+    }
+
+    auto ret = generateKeyPair(type, seed);
+    if (setup_.keyCacheSize == 0)
+        return ret;
+
+    std::lock_guard lock(keyMutex_);
+    if (keys_.count(key))
+        return ret;
+
+    while (keys_.size() >= setup_.keyCacheSize)
+    {
+        keys_.erase(keyOrder_.back());
+        keyOrder_.pop_back();
+    }
+
+    keyOrder_.push_front(key);
+    keys_.emplace(key, std::make_pair(ret, keyOrder_.begin()));
+    return ret;
+}
+
+Json::Value
+SigningQueue::getJson() const
+{
+    Json::Value ret(Json::objectValue);
+    {
+        std::lock_guard lock(mutex_);
+        ret["threads"] = static_cast<Json::UInt>(threads_.size());
+        ret["queued_unlimited"] = static_cast<Json::UInt>(unlimited_.size());
+        ret["queued"] = static_cast<Json::UInt>(limited_.size());
+        ret["rejected"] = static_cast<Json::UInt>(rejected_);
+    }
+    {
+        std::lock_guard lock(keyMutex_);
+        ret["key_pairs"] = static_cast<Json::UInt>(keys_.size());
+        ret["key_hits"] = static_cast<Json::UInt>(keyHits_);
+        ret["key_misses"] = static_cast<Json::UInt>(keyMisses_);
+    }
+    return ret;
+}
+
+void
+SigningQueue::loop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this]() {
+                return stopping_ || !unlimited_.empty() || !limited_.empty();
+            });
+
+            // Finish what was queued before stopping: each task resumes a
+            // waiting coroutine.
+            auto& queue = !unlimited_.empty() ? unlimited_ : limited_;
+            if (queue.empty())
+                return;
+
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        try
+        {
+            task();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.error()) << "Signing task failed: " << e.what();
+        }
+    }
+}
+
+SigningQueue::Setup
+setup_SigningQueue(Config const& config)
+{
+    SigningQueue::Setup setup;
+    auto const& section = config.section("signing");
+
+    set(setup.threads, "threads", section);
+    set(setup.maxQueued, "max_queued", section);
+    set(setup.keyCacheSize, "key_cache_size", section);
+
+    if (setup.threads == 0)
+        Throw<std::runtime_error>("[signing] threads must be at least 1");
+
+    return setup;
+}
+
+}  // namespace RPC
+}  // namespace ripple
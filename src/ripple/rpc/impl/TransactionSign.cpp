@@ -36,6 +36,7 @@
 #include <ripple/protocol/Sign.h>
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/rpc/impl/LegacyPathFind.h>
+#include <ripple/rpc/SigningQueue.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 #include <ripple/rpc/impl/TransactionSign.h>
 #include <ripple/rpc/impl/Tuning.h>
@@ -368,7 +369,8 @@ transactionPreProcessImpl(
     auto j = app.journal("RPCHandler");
 
     Json::Value jvResult;
-    auto const [pk, sk] = keypairForSignature(params, jvResult);
+    auto const [pk, sk] =
+        keypairForSignature(params, jvResult, &app.getSigningQueue());
     if (contains_error(jvResult))
         return jvResult;
 
@@ -549,6 +551,27 @@ transactionPreProcessImpl(
     return transactionPreProcessResult{std::move(stpTrans)};
 }
 
+// Derive the keys and sign on the signing queue, so the work doesn't hold
+// a job queue thread serving other clients.
+static transactionPreProcessResult
+transactionPreProcessQueued(
+    Json::Value& params,
+    Role role,
+    SigningForParams& signingArgs,
+    std::chrono::seconds validatedLedgerAge,
+    Application& app,
+    std::shared_ptr<JobQueue::Coro> const& coro)
+{
+    boost::optional<transactionPreProcessResult> result;
+    if (!app.getSigningQueue().run(role, coro, [&]() {
+            result.emplace(transactionPreProcessImpl(
+                params, role, signingArgs, validatedLedgerAge, app));
+        }))
+        return rpcError(rpcTOO_BUSY);
+
+    return std::move(*result);
+}
+
 static std::pair<Json::Value, Transaction::pointer>
 transactionConstructImpl(
     std::shared_ptr<STTx const> const& stpTrans,
@@ -589,7 +612,11 @@ transactionConstructImpl(
                     sttxNew->getTransactionID(),
                     Validity::SigGoodOnly);
             if (checkValidity(
-                    app.getHashRouter(), *sttxNew, rules, app.config())
+                    app.getHashRouter(),
+                    app.getSignatureCache(),
+                    *sttxNew,
+                    rules,
+                    app.config())
                     .first != Validity::Valid)
             {
                 ret.first = RPC::make_error(rpcINTERNAL, "Invalid signature.");
@@ -768,7 +795,8 @@ transactionSign(
     NetworkOPs::FailHard failType,
     Role role,
     std::chrono::seconds validatedLedgerAge,
-    Application& app)
+    Application& app,
+    std::shared_ptr<JobQueue::Coro> const& coro)
 {
     using namespace detail;
 
@@ -777,8 +805,8 @@ transactionSign(
 
     // Add and amend fields based on the transaction type.
     SigningForParams signForParams;
-    transactionPreProcessResult preprocResult = transactionPreProcessImpl(
-        jvRequest, role, signForParams, validatedLedgerAge, app);
+    transactionPreProcessResult preprocResult = transactionPreProcessQueued(
+        jvRequest, role, signForParams, validatedLedgerAge, app, coro);
 
     if (!preprocResult.second)
         return preprocResult.first;
@@ -806,7 +834,8 @@ transactionSubmit(
     Role role,
     std::chrono::seconds validatedLedgerAge,
     Application& app,
-    ProcessTransactionFn const& processTransaction)
+    ProcessTransactionFn const& processTransaction,
+    std::shared_ptr<JobQueue::Coro> const& coro)
 {
     using namespace detail;
 
@@ -816,8 +845,8 @@ transactionSubmit(
 
     // Add and amend fields based on the transaction type.
     SigningForParams signForParams;
-    transactionPreProcessResult preprocResult = transactionPreProcessImpl(
-        jvRequest, role, signForParams, validatedLedgerAge, app);
+    transactionPreProcessResult preprocResult = transactionPreProcessQueued(
+        jvRequest, role, signForParams, validatedLedgerAge, app, coro);
 
     if (!preprocResult.second)
         return preprocResult.first;
@@ -934,7 +963,8 @@ transactionSignFor(
     NetworkOPs::FailHard failType,
     Role role,
     std::chrono::seconds validatedLedgerAge,
-    Application& app)
+    Application& app,
+    std::shared_ptr<JobQueue::Coro> const& coro)
 {
     auto const& ledger = app.openLedger().current();
     auto j = app.journal("RPCHandler");
@@ -985,8 +1015,8 @@ transactionSignFor(
     SigningForParams signForParams(
         *signerAccountID, multiSignPubKey, multiSignature);
 
-    transactionPreProcessResult preprocResult = transactionPreProcessImpl(
-        jvRequest, role, signForParams, validatedLedgerAge, app);
+    transactionPreProcessResult preprocResult = transactionPreProcessQueued(
+        jvRequest, role, signForParams, validatedLedgerAge, app, coro);
 
     if (!preprocResult.second)
         return preprocResult.first;
@@ -21,6 +21,7 @@
 #define RIPPLE_RPC_TRANSACTIONSIGN_H_INCLUDED
 
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/ledger/ApplyView.h>
 #include <ripple/rpc/Role.h>
 
@@ -90,16 +91,22 @@ getProcessTxnFn(NetworkOPs& netOPs)
     };
 }
 
-/** Returns a Json::objectValue. */
+/** Returns a Json::objectValue.
+
+    The keys are derived and the transaction signed on the application's
+    signing queue. The coroutine, if any, is suspended meanwhile; without
+    one the signing is done on the calling thread.
+*/
 Json::Value
 transactionSign(
     Json::Value params,  // Passed by value so it can be modified locally.
     NetworkOPs::FailHard failType,
     Role role,
     std::chrono::seconds validatedLedgerAge,
-    Application& app);
+    Application& app,
+    std::shared_ptr<JobQueue::Coro> const& coro = {});
 
-/** Returns a Json::objectValue. */
+/** Returns a Json::objectValue. Signs as transactionSign does. */
 Json::Value
 transactionSubmit(
     Json::Value params,  // Passed by value so it can be modified locally.
@@ -107,16 +114,18 @@ transactionSubmit(
     Role role,
     std::chrono::seconds validatedLedgerAge,
     Application& app,
-    ProcessTransactionFn const& processTransaction);
+    ProcessTransactionFn const& processTransaction,
+    std::shared_ptr<JobQueue::Coro> const& coro = {});
 
-/** Returns a Json::objectValue. */
+/** Returns a Json::objectValue. Signs as transactionSign does. */
 Json::Value
 transactionSignFor(
     Json::Value params,  // Passed by value so it can be modified locally.
     NetworkOPs::FailHard failType,
     Role role,
     std::chrono::seconds validatedLedgerAge,
-    Application& app);
+    Application& app,
+    std::shared_ptr<JobQueue::Coro> const& coro = {});
 
 /** Returns a Json::objectValue. */
 Json::Value
@@ -80,6 +80,13 @@ public:
         auto m = std::make_shared<StreambufWSMsg<decltype(sb)>>(std::move(sb));
         sp->send(m);
     }
+
+    void
+    publish(PublishedJson const& msg, bool) override
+    {
+        if (auto sp = ws_.lock())
+            sp->send(std::make_shared<SharedWSMsg>(msg.text()));
+    }
 };
 
 }  // namespace ripple
@@ -69,6 +69,10 @@ struct Port
     // Websocket disconnects if send queue exceeds this limit
     std::uint16_t ws_queue_limit;
 
+    // Most HTTP requests from one connection handled at once. Responses
+    // are still sent in the order the requests arrived.
+    std::uint16_t pipeline_depth = 1;
+
     // Returns `true` if any websocket protocols are specified
     bool
     websockets() const;
@@ -104,6 +108,7 @@ struct ParsedPort
     boost::beast::websocket::permessage_deflate pmd_options;
     int limit = 0;
     std::uint16_t ws_queue_limit;
+    std::uint16_t pipeline_depth = 1;
 
     boost::optional<boost::asio::ip::address> ip;
     boost::optional<std::uint16_t> port;
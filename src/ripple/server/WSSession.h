@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -66,6 +67,17 @@ public:
     */
     virtual std::pair<boost::tribool, std::vector<boost::asio::const_buffer>>
     prepare(std::size_t bytes, std::function<void(void)> resume) = 0;
+
+    /** Return the size of the message in bytes, or zero if not known.
+
+        Messages whose size is known before they are written may share a
+        send queue entry with other small messages.
+    */
+    virtual std::size_t
+    size() const
+    {
+        return 0;
+    }
 };
 
 template <class Streambuf>
@@ -79,6 +91,12 @@ public:
     {
     }
 
+    std::size_t
+    size() const override
+    {
+        return sb_.size();
+    }
+
     std::pair<boost::tribool, std::vector<boost::asio::const_buffer>>
     prepare(std::size_t bytes, std::function<void(void)>) override
     {
@@ -104,6 +122,37 @@ public:
     }
 };
 
+/** A message whose bytes are shared with other sessions. */
+class SharedWSMsg : public WSMsg
+{
+    std::shared_ptr<std::string const> text_;
+    std::size_t pos_ = 0;
+    std::size_t n_ = 0;
+
+public:
+    explicit SharedWSMsg(std::shared_ptr<std::string const> text)
+        : text_(std::move(text))
+    {
+    }
+
+    std::size_t
+    size() const override
+    {
+        return text_->size();
+    }
+
+    std::pair<boost::tribool, std::vector<boost::asio::const_buffer>>
+    prepare(std::size_t bytes, std::function<void(void)>) override
+    {
+        pos_ += n_;
+        if (pos_ >= text_->size())
+            return {true, {}};
+        n_ = std::min(bytes, text_->size() - pos_);
+        boost::tribool const done = pos_ + n_ == text_->size();
+        return {done, {boost::asio::const_buffer(text_->data() + pos_, n_)}};
+    }
+};
+
 struct WSSession
 {
     std::shared_ptr<void> appDefined;
@@ -130,6 +179,10 @@ struct WSSession
     virtual void
     send(std::shared_ptr<WSMsg> w) = 0;
 
+    /** Return the number of messages waiting to be sent. */
+    virtual std::size_t
+    queueDepth() const = 0;
+
     virtual void
     close() = 0;
 
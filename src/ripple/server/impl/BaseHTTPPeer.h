@@ -22,6 +22,7 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/beast/net/IPAddressConversion.h>
+#include <ripple/beast/rfc2616.h>
 #include <ripple/server/Session.h>
 #include <ripple/server/impl/io_list.h>
 #include <boost/asio/ip/tcp.hpp>
@@ -33,9 +34,11 @@
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/parser.hpp>
 #include <boost/beast/http/read.hpp>
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -99,6 +102,14 @@ protected:
     std::size_t bytes_in_ = 0;
     std::size_t bytes_out_ = 0;
 
+    // When the port allows more than one request in flight, requests
+    // whose responses have not all been queued, oldest first.
+    class Request;
+    std::deque<std::shared_ptr<Request>> pipeline_;
+    bool reading_ = false;
+    bool read_closed_ = false;
+    bool writer_busy_ = false;
+
     //--------------------------------------------------------------------------
 
 public:
@@ -156,6 +167,36 @@ protected:
     virtual void
     do_request() = 0;
 
+    /** Returns the session to hand the request just read to.
+
+        This is the connection itself unless the port allows pipelining.
+        Then the request gets a session of its own, and the next request
+        is read while it is handled.
+    */
+    Session&
+    request_session();
+
+    bool
+    pipelining() const
+    {
+        return port_.pipeline_depth > 1;
+    }
+
+    bool
+    writing();
+
+    void
+    send(buffer&& b);
+
+    void
+    read_ahead();
+
+    void
+    on_response(std::shared_ptr<Request> const& request, buffer&& b);
+
+    void
+    flush_pipeline();
+
     virtual void
     do_close() = 0;
 
@@ -203,6 +244,122 @@ protected:
 
 //------------------------------------------------------------------------------
 
+/** A request on a connection that pipelines.
+
+    The handler answers it as it would the connection. Its response is held
+    back until the responses to the requests read before it are queued, so
+    responses leave in the order the requests arrived.
+*/
+template <class Handler, class Impl>
+class BaseHTTPPeer<Handler, Impl>::Request
+    : public Session,
+      public std::enable_shared_from_this<
+          typename BaseHTTPPeer<Handler, Impl>::Request>
+{
+public:
+    Request(std::shared_ptr<BaseHTTPPeer> peer, http_request_type&& message)
+        : peer_(std::move(peer))
+        , message_(std::move(message))
+        , keep_alive_(beast::rfc2616::is_keep_alive(message_))
+    {
+    }
+
+    beast::Journal
+    journal() override
+    {
+        return peer_->journal_;
+    }
+
+    Port const&
+    port() override
+    {
+        return peer_->port_;
+    }
+
+    beast::IP::Endpoint
+    remoteAddress() override
+    {
+        return peer_->remoteAddress();
+    }
+
+    http_request_type&
+    request() override
+    {
+        return message_;
+    }
+
+    void
+    write(void const* buffer, std::size_t bytes) override
+    {
+        if (bytes == 0)
+            return;
+        auto b = std::make_shared<typename BaseHTTPPeer::buffer>(buffer, bytes);
+        post(peer_->strand_, [self = this->shared_from_this(), b]() {
+            self->peer_->on_response(self, std::move(*b));
+        });
+    }
+
+    void
+    write(std::shared_ptr<Writer> const& writer, bool keep_alive) override
+    {
+        post(
+            peer_->strand_,
+            [self = this->shared_from_this(), writer, keep_alive]() {
+                self->writer_ = writer;
+                self->keep_alive_ = keep_alive;
+                self->complete_ = true;
+                self->peer_->flush_pipeline();
+            });
+    }
+
+    std::shared_ptr<Session>
+    detach() override
+    {
+        return this->shared_from_this();
+    }
+
+    void
+    complete() override
+    {
+        post(peer_->strand_, [self = this->shared_from_this()]() {
+            self->complete_ = true;
+            self->peer_->flush_pipeline();
+        });
+    }
+
+    void
+    close(bool graceful) override
+    {
+        if (!graceful)
+            return peer_->close();
+        post(peer_->strand_, [self = this->shared_from_this()]() {
+            self->complete_ = true;
+            self->keep_alive_ = false;
+            self->peer_->flush_pipeline();
+        });
+    }
+
+    std::shared_ptr<WSSession>
+    websocketUpgrade() override
+    {
+        // Upgrades are made during the handoff, before requests are queued
+        return nullptr;
+    }
+
+private:
+    friend class BaseHTTPPeer;
+
+    std::shared_ptr<BaseHTTPPeer> peer_;
+    http_request_type message_;
+    // Response data written before this became the oldest request
+    std::vector<buffer> held_;
+    std::shared_ptr<Writer> writer_;
+    bool keep_alive_;
+    bool complete_ = false;
+};
+
+//------------------------------------------------------------------------------
+
 template <class Handler, class Impl>
 template <class ConstBufferSequence>
 BaseHTTPPeer<Handler, Impl>::BaseHTTPPeer(
@@ -299,11 +456,23 @@ void
 BaseHTTPPeer<Handler, Impl>::do_read(yield_context do_yield)
 {
     complete_ = false;
+    reading_ = true;
     error_code ec;
-    start_timer();
+    // Requests in flight may take longer than the idle timeout to answer
+    if (pipeline_.empty())
+        start_timer();
     boost::beast::http::async_read(
         impl().stream_, read_buf_, message_, do_yield[ec]);
-    cancel_timer();
+    reading_ = false;
+    if (!pipelining() || !writing())
+        cancel_timer();
+    if (pipelining() && graceful_)
+        return;
+    if (pipelining() && ec == boost::beast::http::error::end_of_stream)
+    {
+        read_closed_ = true;
+        return flush_pipeline();
+    }
     if (ec == boost::beast::http::error::end_of_stream)
         return do_close();
     if (ec == boost::beast::error::timeout)
@@ -351,6 +520,12 @@ BaseHTTPPeer<Handler, Impl>::on_write(
                     std::placeholders::_1,
                     std::placeholders::_2)));
     }
+    if (pipelining())
+    {
+        if (reading_ && pipeline_.empty())
+            start_timer();
+        return flush_pipeline();
+    }
     if (!complete_)
         return;
     if (graceful_)
@@ -402,6 +577,12 @@ BaseHTTPPeer<Handler, Impl>::do_writer(
             break;
     }
 
+    if (pipelining())
+    {
+        writer_busy_ = false;
+        return flush_pipeline();
+    }
+
     if (!keep_alive)
         return do_close();
 
@@ -422,9 +603,16 @@ BaseHTTPPeer<Handler, Impl>::write(void const* buf, std::size_t bytes)
 {
     if (bytes == 0)
         return;
+    send(buffer(buf, bytes));
+}
+
+template <class Handler, class Impl>
+void
+BaseHTTPPeer<Handler, Impl>::send(buffer&& b)
+{
     if ([&] {
             std::lock_guard lock(mutex_);
-            wq_.emplace_back(buf, bytes);
+            wq_.push_back(std::move(b));
             return wq_.size() == 1 && wq2_.size() == 0;
         }())
     {
@@ -447,6 +635,19 @@ BaseHTTPPeer<Handler, Impl>::write(
     std::shared_ptr<Writer> const& writer,
     bool keep_alive)
 {
+    if (pipelining())
+    {
+        // A response made during the handoff waits its turn like any other
+        auto const request = std::make_shared<Request>(
+            impl().shared_from_this(), std::move(message_));
+        message_ = {};
+        request->writer_ = writer;
+        request->keep_alive_ = keep_alive;
+        request->complete_ = true;
+        pipeline_.push_back(request);
+        return flush_pipeline();
+    }
+
     boost::asio::spawn(bind_executor(
         strand_,
         std::bind(
@@ -527,6 +728,124 @@ BaseHTTPPeer<Handler, Impl>::close(bool graceful)
     boost::beast::get_lowest_layer(impl().stream_).close();
 }
 
+//------------------------------------------------------------------------------
+
+template <class Handler, class Impl>
+Session&
+BaseHTTPPeer<Handler, Impl>::request_session()
+{
+    if (!pipelining())
+        return session();
+
+    auto const request = std::make_shared<Request>(
+        impl().shared_from_this(), std::move(message_));
+    message_ = {};
+    pipeline_.push_back(request);
+    read_ahead();
+    return *request;
+}
+
+template <class Handler, class Impl>
+bool
+BaseHTTPPeer<Handler, Impl>::writing()
+{
+    std::lock_guard lock(mutex_);
+    return writer_busy_ || !wq_.empty() || !wq2_.empty();
+}
+
+// Start reading the next request if another one may be in flight.
+template <class Handler, class Impl>
+void
+BaseHTTPPeer<Handler, Impl>::read_ahead()
+{
+    if (reading_ || read_closed_ || graceful_ ||
+        pipeline_.size() >= port_.pipeline_depth)
+        return;
+    if (!pipeline_.empty() && !pipeline_.back()->keep_alive_)
+        return;
+
+    reading_ = true;
+    boost::asio::spawn(
+        strand_,
+        std::bind(
+            &BaseHTTPPeer<Handler, Impl>::do_read,
+            impl().shared_from_this(),
+            std::placeholders::_1));
+}
+
+template <class Handler, class Impl>
+void
+BaseHTTPPeer<Handler, Impl>::on_response(
+    std::shared_ptr<Request> const& request,
+    buffer&& b)
+{
+    if (!writer_busy_ && !pipeline_.empty() && pipeline_.front() == request)
+        return send(std::move(b));
+
+    // Once the connection is closing, later responses are dropped
+    if (std::find(pipeline_.begin(), pipeline_.end(), request) !=
+        pipeline_.end())
+        request->held_.push_back(std::move(b));
+}
+
+// Send what the oldest requests have ready, in order, and retire the ones
+// that are complete.
+template <class Handler, class Impl>
+void
+BaseHTTPPeer<Handler, Impl>::flush_pipeline()
+{
+    // The writer calls back when it is done
+    if (writer_busy_)
+        return;
+
+    while (!pipeline_.empty())
+    {
+        auto const request = pipeline_.front();
+        for (auto& b : request->held_)
+            send(std::move(b));
+        request->held_.clear();
+
+        if (!request->complete_)
+            break;
+
+        if (request->writer_)
+        {
+            // The writer goes out after everything queued before it
+            if (writing())
+                return;
+            writer_busy_ = true;
+            boost::asio::spawn(
+                strand_,
+                std::bind(
+                    &BaseHTTPPeer<Handler, Impl>::do_writer,
+                    impl().shared_from_this(),
+                    std::move(request->writer_),
+                    request->keep_alive_,
+                    std::placeholders::_1));
+        }
+
+        pipeline_.pop_front();
+        if (!request->keep_alive_)
+        {
+            graceful_ = true;
+            pipeline_.clear();
+        }
+        if (writer_busy_)
+            return;
+    }
+
+    if (pipeline_.empty() && (graceful_ || read_closed_))
+    {
+        if (!writing())
+            do_close();
+        return;
+    }
+
+    if (pipeline_.empty() && reading_)
+        start_timer();
+    read_ahead();
+}
+
 }  // namespace ripple
 
 #endif
@@ -29,8 +29,11 @@
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/websocket.hpp>
+#include <boost/circular_buffer.hpp>
+#include <atomic>
 #include <cassert>
 #include <functional>
+#include <vector>
 
 namespace ripple {
 
@@ -48,10 +51,25 @@ protected:
 private:
     friend class BasePeer<Handler, Impl>;
 
+    // Small messages queued behind each other share an entry in the send
+    // queue, up to this many bytes, so that bursts of small stream
+    // messages don't count against the queue limit one by one.
+    static constexpr std::size_t coalesceBytes = 16384;
+
+    // One or more messages, written in order
+    struct QueueEntry
+    {
+        std::vector<std::shared_ptr<WSMsg>> msgs;
+        std::size_t next = 0;
+        std::size_t bytes = 0;
+    };
+
     http_request_type request_;
     boost::beast::multi_buffer rb_;
     boost::beast::multi_buffer wb_;
-    std::list<std::shared_ptr<WSMsg>> wq_;
+    // The front entry is being written
+    boost::circular_buffer<QueueEntry> wq_;
+    std::atomic<std::size_t> queued_{0};
     bool do_close_ = false;
     boost::beast::websocket::close_reason cr_;
     waitable_timer timer_;
@@ -102,6 +120,12 @@ public:
     void
     send(std::shared_ptr<WSMsg> w) override;
 
+    std::size_t
+    queueDepth() const override
+    {
+        return queued_;
+    }
+
     void
     close() override;
 
@@ -175,6 +199,7 @@ BaseWSPeer<Handler, Impl>::BaseWSPeer(
     beast::Journal journal)
     : BasePeer<Handler, Impl>(port, handler, executor, remote_address, journal)
     , request_(std::move(request))
+    , wq_(std::size_t{port.ws_queue_limit} + 1)
     , timer_(std::move(timer))
     , payload_("12345678")  // ensures size is 8 bytes
 {
@@ -225,17 +250,35 @@ BaseWSPeer<Handler, Impl>::send(std::shared_ptr<WSMsg> w)
                 &BaseWSPeer::send, impl().shared_from_this(), std::move(w)));
     if (do_close_)
         return;
+
+    // Add a small message to the last entry if it isn't being written yet
+    auto const size = w->size();
+    if (size != 0 && size <= coalesceBytes && wq_.size() > 1 &&
+        wq_.back().bytes != 0 && wq_.back().bytes + size <= coalesceBytes)
+    {
+        wq_.back().msgs.push_back(std::move(w));
+        wq_.back().bytes += size;
+        ++queued_;
+        return;
+    }
+
     if (wq_.size() > port().ws_queue_limit)
     {
         cr_.code = safe_cast<decltype(cr_.code)>(
             boost::beast::websocket::close_code::policy_error);
         cr_.reason = "Policy error: client is too slow.";
-        JLOG(this->j_.info()) << cr_.reason;
+        JLOG(this->j_.info()) << cr_.reason << " " << queued_
+                              << " messages queued";
         wq_.erase(std::next(wq_.begin()), wq_.end());
+        queued_ = wq_.front().msgs.size() - wq_.front().next;
         close(cr_);
         return;
     }
-    wq_.emplace_back(std::move(w));
+    QueueEntry e;
+    e.msgs.push_back(std::move(w));
+    e.bytes = size <= coalesceBytes ? size : 0;
+    wq_.push_back(std::move(e));
+    ++queued_;
     if (wq_.size() == 1)
         on_write({});
 }
@@ -312,7 +355,8 @@ BaseWSPeer<Handler, Impl>::on_write(error_code const& ec)
 {
     if (ec)
         return fail(ec, "write");
-    auto& w = *wq_.front();
+    auto& e = wq_.front();
+    auto& w = *e.msgs[e.next];
     auto const result = w.prepare(
         65536, std::bind(&BaseWSPeer::do_write, impl().shared_from_this()));
     if (boost::indeterminate(result.first))
@@ -346,7 +390,9 @@ BaseWSPeer<Handler, Impl>::on_write_fin(error_code const& ec)
 {
     if (ec)
         return fail(ec, "write_fin");
-    wq_.pop_front();
+    --queued_;
+    if (auto& e = wq_.front(); ++e.next == e.msgs.size())
+        wq_.pop_front();
     if (do_close_)
         impl().ws_.async_close(
             cr_,
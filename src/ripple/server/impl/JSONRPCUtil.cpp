@@ -18,12 +18,14 @@
 //==============================================================================
 
 #include <ripple/basics/Log.h>
+#include <ripple/json/json_writer.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/BuildInfo.h>
 #include <ripple/protocol/SystemParameters.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/server/impl/JSONRPCUtil.h>
 #include <boost/algorithm/string.hpp>
+#include <sstream>
 
 namespace ripple {
 
@@ -52,6 +54,35 @@ getHTTPHeaderTimestamp()
     return std::string(buffer);
 }
 
+// Writes the status line and the date header
+static void
+startReply(int nStatus, Json::Output const& output)
+{
+    switch (nStatus)
+    {
+        case 200:
+            output("HTTP/1.1 200 OK\r\n");
+            break;
+        case 400:
+            output("HTTP/1.1 400 Bad Request\r\n");
+            break;
+        case 403:
+            output("HTTP/1.1 403 Forbidden\r\n");
+            break;
+        case 404:
+            output("HTTP/1.1 404 Not Found\r\n");
+            break;
+        case 500:
+            output("HTTP/1.1 500 Internal Server Error\r\n");
+            break;
+        case 503:
+            output("HTTP/1.1 503 Server is overloaded\r\n");
+            break;
+    }
+
+    output(getHTTPHeaderTimestamp());
+}
+
 void
 HTTPReply(
     int nStatus,
@@ -95,29 +126,7 @@ HTTPReply(
         return;
     }
 
-    switch (nStatus)
-    {
-        case 200:
-            output("HTTP/1.1 200 OK\r\n");
-            break;
-        case 400:
-            output("HTTP/1.1 400 Bad Request\r\n");
-            break;
-        case 403:
-            output("HTTP/1.1 403 Forbidden\r\n");
-            break;
-        case 404:
-            output("HTTP/1.1 404 Not Found\r\n");
-            break;
-        case 500:
-            output("HTTP/1.1 500 Internal Server Error\r\n");
-            break;
-        case 503:
-            output("HTTP/1.1 503 Server is overloaded\r\n");
-            break;
-    }
-
-    output(getHTTPHeaderTimestamp());
+    startReply(nStatus, output);
 
     output(
         "Connection: Keep-Alive\r\n"
@@ -141,4 +150,64 @@ HTTPReply(
     output("\r\n");
 }
 
+std::size_t
+HTTPReply(
+    int nStatus,
+    Json::Value const& content,
+    Json::Output const& output,
+    bool chunked,
+    beast::Journal j)
+{
+    // The body is sent in chunks of about this size
+    static constexpr std::size_t chunkSize = 64 * 1024;
+
+    std::string buffer;
+    std::size_t size = 0;
+    bool started = false;
+
+    auto const writeChunk = [&]() {
+        std::ostringstream ss;
+        ss << std::hex << buffer.size() << "\r\n";
+        output(ss.str());
+        output(buffer);
+        output("\r\n");
+        buffer.clear();
+    };
+
+    Json::stream(content, [&](void const* data, std::size_t n) {
+        size += n;
+        buffer.append(static_cast<char const*>(data), n);
+        if (!chunked || buffer.size() < chunkSize)
+            return;
+
+        if (!started)
+        {
+            JLOG(j.trace()) << "HTTP Reply " << nStatus << " chunked";
+            startReply(nStatus, output);
+            output(
+                "Connection: Keep-Alive\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "Content-Type: application/json; charset=UTF-8\r\n");
+            output("Server: " + systemName() + "-json-rpc/");
+            output(BuildInfo::getFullVersionString());
+            output(
+                "\r\n"
+                "\r\n");
+            started = true;
+        }
+        writeChunk();
+    });
+
+    if (!started)
+    {
+        HTTPReply(nStatus, buffer, output, j);
+        return size;
+    }
+
+    buffer += "\r\n";
+    writeChunk();
+    output("0\r\n\r\n");
+    return size;
+}
+
 }  // namespace ripple
@@ -20,8 +20,10 @@
 #ifndef RIPPLE_SERVER_JSONRPCUTIL_H_INCLUDED
 #define RIPPLE_SERVER_JSONRPCUTIL_H_INCLUDED
 
+#include <ripple/beast/utility/Journal.h>
 #include <ripple/json/Output.h>
 #include <ripple/json/json_value.h>
+#include <cstddef>
 
 namespace ripple {
 
@@ -32,6 +34,24 @@ HTTPReply(
     Json::Output const&,
     beast::Journal j);
 
+/** Write a reply whose body is the serialized Json::Value.
+
+    The value is serialized straight to the output rather than to an
+    intermediate string. When chunked is set, a body larger than a single
+    chunk is sent with chunked transfer encoding as it is serialized, so
+    the whole reply is never held in memory at once. Smaller bodies, and
+    every body when chunked is not set, are sent with a Content-Length.
+
+    @return The size of the serialized value in bytes.
+*/
+std::size_t
+HTTPReply(
+    int nStatus,
+    Json::Value const& content,
+    Json::Output const&,
+    bool chunked,
+    beast::Journal j);
+
 }  // namespace ripple
 
 #endif
@@ -160,7 +160,7 @@ PlainHTTPPeer<Handler>::do_request()
     if (ec)
         return this->fail(ec, "request");
     // legacy
-    this->handler_.onRequest(this->session());
+    this->handler_.onRequest(this->request_session());
 }
 
 template <class Handler>
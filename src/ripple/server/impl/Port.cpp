@@ -233,6 +233,27 @@ parse_Port(ParsedPort& port, Section const& section, std::ostream& log)
         }
     }
 
+    {
+        auto const result = section.find("pipeline_depth");
+        if (result.second)
+        {
+            try
+            {
+                port.pipeline_depth =
+                    beast::lexicalCastThrow<std::uint16_t>(result.first);
+
+                if (port.pipeline_depth == 0 || port.pipeline_depth > 64)
+                    Throw<std::exception>();
+            }
+            catch (std::exception const&)
+            {
+                log << "Invalid value '" << result.first << "' for key "
+                    << "'pipeline_depth' in [" << section.name() << "]";
+                Rethrow();
+            }
+        }
+    }
+
     populate(section, "admin", log, port.admin_ip, true, {});
     populate(
         section,
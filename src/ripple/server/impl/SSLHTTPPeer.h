@@ -188,7 +188,7 @@ SSLHTTPPeer<Handler>::do_request()
     if (what.response)
         return this->write(what.response, what.keep_alive);
     // legacy
-    this->handler_.onRequest(this->session());
+    this->handler_.onRequest(this->request_session());
 }
 
 template <class Handler>
@@ -24,11 +24,14 @@
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/nodestore/Database.h>
 #include <ripple/shamap/FullBelowCache.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
 #include <ripple/shamap/TreeNodeCache.h>
 #include <cstdint>
 
 namespace ripple {
 
+class WorkerPool;
+
 class Family
 {
 public:
@@ -53,6 +56,10 @@ public:
     virtual beast::Journal const&
     journal() = 0;
 
+    /** Return the threads that work on a map's branches in parallel. */
+    virtual WorkerPool&
+    workers() = 0;
+
     /** Return a pointer to the Family Full Below Cache
 
         @param ledgerSeq ledger sequence determines a corresponding shard cache
@@ -81,6 +88,27 @@ public:
     virtual void
     missingNode(uint256 const& refHash, std::uint32_t refNum) = 0;
 
+    /** Report a node of a ledger's map that is not stored locally.
+
+        Called for each node a read finds missing, before the map as a
+        whole is reported. A family that can fetch single nodes does so
+        here; by default the whole ledger is left to be acquired.
+    */
+    virtual void
+    missingNode(SHAMapType type, uint256 const& hash, std::uint32_t refNum)
+    {
+    }
+
+    /** Take a node a peer sent in reply to a fetch by hash.
+
+        @return true if the family fetched the node, and has kept it.
+    */
+    virtual bool
+    foundNode(uint256 const& hash, Slice const& data)
+    {
+        return false;
+    }
+
     virtual void
     reset() = 0;
 };
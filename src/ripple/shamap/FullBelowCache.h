@@ -22,8 +22,13 @@
 
 #include <ripple/basics/KeyCache.h>
 #include <ripple/basics/base_uint.h>
+#include <ripple/basics/hardened_hash.h>
 #include <ripple/beast/insight/Collector.h>
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
 
 namespace ripple {
@@ -32,6 +37,10 @@ namespace detail {
 
 /** Remembers which tree keys have all descendants resident.
     This optimizes the process of acquiring a complete tree.
+
+    Keys are spread over several independently locked caches so that
+    threads walking different parts of a tree rarely contend. Each shard
+    is given an equal part of the target size.
 */
 template <class Key>
 class BasicFullBelowCache
@@ -60,15 +69,25 @@ public:
             beast::insight::NullCollector::New(),
         std::size_t target_size = defaultCacheTargetSize,
         std::chrono::seconds expiration = std::chrono::minutes{2})
-        : m_cache(name, clock, collector, target_size, expiration), m_gen(1)
+        : m_stats(
+              name,
+              std::bind(&BasicFullBelowCache::collect_metrics, this),
+              collector)
+        , m_metrics(name, collector)
+        , m_gen(1)
     {
+        size_type const shardSize =
+            (target_size + shardCount - 1) / shardCount;
+        for (auto& shard : m_shards)
+            shard = std::make_unique<CacheType>(
+                name, clock, shardSize, expiration);
     }
 
     /** Return the clock associated with the cache. */
     clock_type&
     clock()
     {
-        return m_cache.clock();
+        return m_shards.front()->clock();
     }
 
     /** Return the number of elements in the cache.
@@ -78,7 +97,10 @@ public:
     size_type
     size() const
     {
-        return m_cache.size();
+        size_type total = 0;
+        for (auto const& shard : m_shards)
+            total += shard->size();
+        return total;
     }
 
     /** Remove expired cache items.
@@ -88,7 +110,43 @@ public:
     void
     sweep()
     {
-        m_cache.sweep();
+        using namespace std::chrono;
+        auto const start = steady_clock::now();
+        std::size_t removed = 0;
+        steady_clock::duration longest{};
+        for (auto& shard : m_shards)
+        {
+            // Each shard holds its own lock for the whole of its sweep
+            auto const shardStart = steady_clock::now();
+            removed += shard->sweep();
+            longest = std::max(longest, steady_clock::now() - shardStart);
+        }
+
+        auto const took =
+            duration_cast<microseconds>(steady_clock::now() - start);
+        m_metrics.evicted(removed);
+        m_metrics.swept(
+            counts(),
+            clock().now(),
+            took,
+            took,
+            duration_cast<microseconds>(longest));
+    }
+
+    /** Sizes and statistics, for get_counts.
+        Thread safety:
+            Safe to call from any thread.
+    */
+    Json::Value
+    getJson()
+    {
+        auto const entries = size();
+        Json::Value ret(Json::objectValue);
+        ret["size"] = static_cast<Json::UInt>(entries);
+        ret["estimated_bytes"] =
+            std::to_string(CacheType::estimateBytes(entries));
+        m_metrics.getJson(ret, counts(), clock().now());
+        return ret;
     }
 
     /** Refresh the last access time of an item, if it exists.
@@ -100,7 +158,13 @@ public:
     bool
     touch_if_exists(key_type const& key)
     {
-        return m_cache.touch_if_exists(key);
+        if (shardFor(key).touch_if_exists(key))
+        {
+            ++m_stats.hits;
+            return true;
+        }
+        ++m_stats.misses;
+        return false;
     }
 
     /** Insert a key into the cache.
@@ -113,7 +177,7 @@ public:
     void
     insert(key_type const& key)
     {
-        m_cache.insert(key);
+        shardFor(key).insert(key);
     }
 
     /** generation determines whether cached entry is valid */
@@ -126,19 +190,77 @@ public:
     void
     clear()
     {
-        m_cache.clear();
+        for (auto& shard : m_shards)
+            shard->clear();
         ++m_gen;
     }
 
     void
     reset()
     {
-        m_cache.clear();
+        for (auto& shard : m_shards)
+            shard->clear();
         m_gen = 1;
     }
 
 private:
-    KeyCache<Key> m_cache;
+    static constexpr std::size_t shardCount = 16;
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats(
+            std::string const& prefix,
+            Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook(collector->make_hook(handler))
+            , size(collector->make_gauge(prefix, "size"))
+            , hit_rate(collector->make_gauge(prefix, "hit_rate"))
+            , hits(0)
+            , misses(0)
+        {
+        }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+
+        std::atomic<std::size_t> hits;
+        std::atomic<std::size_t> misses;
+    };
+
+    CacheType&
+    shardFor(key_type const& key)
+    {
+        return *m_shards[m_hash(key) % shardCount];
+    }
+
+    CacheMetrics::Counts
+    counts() const
+    {
+        return {
+            m_stats.hits.load(),
+            m_stats.misses.load(),
+            m_metrics.evictions()};
+    }
+
+    void
+    collect_metrics()
+    {
+        m_stats.size.set(size());
+
+        beast::insight::Gauge::value_type hit_rate(0);
+        auto const hits = m_stats.hits.load();
+        auto const total = hits + m_stats.misses.load();
+        if (total != 0)
+            hit_rate = (hits * 100) / total;
+        m_stats.hit_rate.set(hit_rate);
+    }
+
+    Stats m_stats;
+    CacheMetrics m_metrics;
+    hardened_hash<> m_hash;
+    std::array<std::unique_ptr<CacheType>, shardCount> m_shards;
     std::atomic<std::uint32_t> m_gen;
 };
 
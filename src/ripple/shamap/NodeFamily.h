@@ -21,7 +21,10 @@
 #define RIPPLE_SHAMAP_NODEFAMILY_H_INCLUDED
 
 #include <ripple/app/main/CollectorManager.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/shamap/Family.h>
+#include <chrono>
+#include <mutex>
 
 namespace ripple {
 
@@ -60,6 +63,9 @@ public:
         return j_;
     }
 
+    WorkerPool&
+    workers() override;
+
     bool
     isShardBacked() const override
     {
@@ -91,7 +97,28 @@ public:
         acquire(hash, seq);
     }
 
+    void
+    missingNode(SHAMapType type, uint256 const& hash, std::uint32_t seq)
+        override;
+
+    bool
+    foundNode(uint256 const& hash, Slice const& data) override;
+
 private:
+    using clock_type = std::chrono::steady_clock;
+
+    // A node of a stored ledger fetched on its own by hash
+    struct Fetch
+    {
+        enum class State : char { pending, sent, idle };
+
+        SHAMapType type;
+        std::uint32_t seq;
+        State state = State::pending;
+        int tries = 0;
+        clock_type::time_point sent;
+    };
+
     Application& app_;
     NodeStore::Database& db_;
     beast::Journal const j_;
@@ -103,8 +130,24 @@ private:
     LedgerIndex maxSeq_{0};
     std::mutex maxSeqMutex_;
 
+    // Missing nodes being fetched by hash, how many are waiting to be
+    // requested and for a reply, and whether a job to request them is queued
+    hash_map<uint256, Fetch> fetches_;
+    std::size_t pending_{0};
+    std::size_t outstanding_{0};
+    bool sendQueued_{false};
+    std::mutex fetchMutex_;
+
     void
     acquire(uint256 const& hash, std::uint32_t seq);
+
+    // Queue a job to send requests for pending nodes, if there are any and
+    // there is room for more requests
+    void
+    queueSend(std::lock_guard<std::mutex> const&);
+
+    void
+    sendFetches();
 };
 
 }  // namespace ripple
@@ -27,13 +27,16 @@
 #include <ripple/shamap/Family.h>
 #include <ripple/shamap/FullBelowCache.h>
 #include <ripple/shamap/SHAMapAddNode.h>
+#include <ripple/shamap/SHAMapDeferredWrites.h>
 #include <ripple/shamap/SHAMapInnerNode.h>
 #include <ripple/shamap/SHAMapItem.h>
 #include <ripple/shamap/SHAMapLeafNode.h>
 #include <ripple/shamap/SHAMapMissingNode.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
 #include <ripple/shamap/TreeNodeCache.h>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <stack>
 #include <vector>
 
@@ -104,11 +107,17 @@ private:
     /** The sequence of the ledger that this map references, if any. */
     std::uint32_t ledgerSeq_ = 0;
 
+    // Where the map builds its nodes, if not in the heap
+    std::shared_ptr<SHAMapNodeArena> arena_;
+
     std::shared_ptr<SHAMapTreeNode> root_;
     mutable SHAMapState state_;
     SHAMapType const type_;
-    bool backed_ = true;         // Map is backed by the database
-    mutable bool full_ = false;  // Map is believed complete in database
+    bool backed_ = true;  // Map is backed by the database
+    // Map is believed complete in database
+    mutable std::atomic<bool> full_ = false;
+    // Where a flush leaves its writes, if they are put off
+    SHAMapDeferredWrites* deferred_ = nullptr;
 
 public:
     /** Number of children each non-leaf node has (the 'radix tree' part of the
@@ -120,8 +129,8 @@ public:
     static inline constexpr unsigned int leafDepth = 64;
 
     using DeltaItem = std::pair<
-        std::shared_ptr<SHAMapItem const>,
-        std::shared_ptr<SHAMapItem const>>;
+        boost::intrusive_ptr<SHAMapItem const>,
+        boost::intrusive_ptr<SHAMapItem const>>;
     using Delta = std::map<uint256, DeltaItem>;
 
     SHAMap(SHAMap const&) = delete;
@@ -131,6 +140,14 @@ public:
     // build new map
     SHAMap(SHAMapType t, Family& f);
 
+    /** Build a new map whose nodes are made in an arena.
+
+        Meant for maps that are built and thrown away quickly, such as
+        transaction maps. Nodes read from the database or from peers are
+        still made in the heap, since they are shared through the caches.
+    */
+    SHAMap(SHAMapType t, Family& f, std::shared_ptr<SHAMapNodeArena> arena);
+
     SHAMap(SHAMapType t, uint256 const& hash, Family& f);
 
     ~SHAMap() = default;
@@ -141,6 +158,12 @@ public:
         return f_;
     }
 
+    std::shared_ptr<SHAMapNodeArena> const&
+    arena() const
+    {
+        return arena_;
+    }
+
     Family&
     family()
     {
@@ -160,6 +183,16 @@ public:
     const_iterator
     end() const;
 
+    /** Return an iterator for a range scan from the first item.
+
+        As the iterator advances, the readAhead subtrees that follow it at
+        each level of its path are read into the tree node cache in the
+        background, so a long scan waits on the disk's bandwidth rather
+        than on one read at a time. Zero reads nothing ahead.
+    */
+    const_iterator
+    begin(int readAhead) const;
+
     //--------------------------------------------------------------------------
 
     // Returns a new map that's a snapshot of this one.
@@ -190,29 +223,50 @@ public:
     delItem(uint256 const& id);
 
     bool
-    addItem(SHAMapNodeType type, SHAMapItem&& i);
+    addItem(SHAMapNodeType type, boost::intrusive_ptr<SHAMapItem const> item);
 
     SHAMapHash
     getHash() const;
 
     // save a copy if you have a temporary anyway
     bool
-    updateGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const>);
+    updateGiveItem(
+        SHAMapNodeType type,
+        boost::intrusive_ptr<SHAMapItem const> item);
 
     bool
-    addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item);
+    addGiveItem(
+        SHAMapNodeType type,
+        boost::intrusive_ptr<SHAMapItem const> item);
 
     // Save a copy if you need to extend the life
     // of the SHAMapItem beyond this SHAMap
-    std::shared_ptr<SHAMapItem const> const&
+    boost::intrusive_ptr<SHAMapItem const> const&
     peekItem(uint256 const& id) const;
-    std::shared_ptr<SHAMapItem const> const&
+    boost::intrusive_ptr<SHAMapItem const> const&
     peekItem(uint256 const& id, SHAMapHash& hash) const;
 
+    /** Read the nodes on the paths to a set of keys into the tree.
+
+        The paths are read one level at a time, each level with a single
+        batch fetch from the node store, so looking the keys up afterwards
+        does not wait on a read for every node. Keys that are not in the
+        map are followed as far as their paths go.
+    */
+    void
+    fetchPaths(std::vector<uint256> const& keys) const;
+
     // traverse functions
     const_iterator
     upper_bound(uint256 const& id) const;
 
+    /** Return an iterator for a range scan from the first item after id.
+
+        @see begin(int)
+    */
+    const_iterator
+    upper_bound(uint256 const& id, int readAhead) const;
+
     /**  Visit every node in this SHAMap
 
          @param function called with every node visited.
@@ -238,8 +292,20 @@ public:
     */
     void
     visitLeaves(
-        std::function<void(std::shared_ptr<SHAMapItem const> const&)> const&)
-        const;
+        std::function<
+            void(boost::intrusive_ptr<SHAMapItem const> const&)> const&) const;
+
+    /**  Visit, breadth first, the nodes of this SHAMap already in memory
+
+         Nothing is fetched, so the nodes visited are the ones that have
+         been used since the map was loaded.
+
+         @param function called with every resident node visited.
+         If function returns false, visitResident exits.
+    */
+    void
+    visitResident(
+        std::function<bool(SHAMapTreeNode const&)> const& function) const;
 
     // comparison/sync functions
 
@@ -301,6 +367,24 @@ public:
         Slice const& rawNode,
         SHAMapSyncFilter* filter);
 
+    /** Attach a node already decoded with SHAMapTreeNode::makeFromWire.
+
+        Lets callers decode and hash nodes without holding whatever lock
+        guards the map. A null node is treated as invalid data.
+    */
+    /** @{ */
+    SHAMapAddNode
+    addRootNode(
+        SHAMapHash const& hash,
+        std::shared_ptr<SHAMapTreeNode> node,
+        SHAMapSyncFilter* filter);
+    SHAMapAddNode
+    addKnownNode(
+        SHAMapNodeID const& nodeID,
+        std::shared_ptr<SHAMapTreeNode> newNode,
+        SHAMapSyncFilter* filter);
+    /** @} */
+
     // status functions
     void
     setImmutable();
@@ -315,8 +399,14 @@ public:
 
     // caution: otherMap must be accessed only by this function
     // return value: true=successfully completed, false=too different
+    // With more than one thread, the branches below the roots are
+    // compared in parallel
     bool
-    compare(SHAMap const& otherMap, Delta& differences, int maxCount) const;
+    compare(
+        SHAMap const& otherMap,
+        Delta& differences,
+        int maxCount,
+        int threads = 1) const;
 
     /** Convert any modified nodes to shared. */
     int
@@ -326,8 +416,26 @@ public:
     int
     flushDirty(NodeObjectType t);
 
+    /** Convert modified nodes to shared, leaving their writes to the
+        nodestore in `deferred` for the caller to store later. */
+    int
+    flushDirty(NodeObjectType t, SHAMapDeferredWrites& deferred);
+
+    /** Look for the nodes of the map that are not stored locally.
+
+        The subtrees below the root are spread over
+        NodeStore::Database::walkThreads() threads.
+
+        @param missingNodes Receives the missing nodes that are found.
+        @param maxMissing Stop after finding this many missing nodes.
+        @param nodesPerSecond If not zero, the most nodes to visit each
+                              second, across all threads.
+    */
     void
-    walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
+    walkMap(
+        std::vector<SHAMapMissingNode>& missingNodes,
+        int maxMissing,
+        std::size_t nodesPerSecond = 0) const;
     bool
     deepCompare(SHAMap& other) const;  // Intended for debug/test only
 
@@ -343,8 +451,8 @@ private:
     using SharedPtrNodeStack =
         std::stack<std::pair<std::shared_ptr<SHAMapTreeNode>, SHAMapNodeID>>;
     using DeltaRef = std::pair<
-        std::shared_ptr<SHAMapItem const> const&,
-        std::shared_ptr<SHAMapItem const> const&>;
+        boost::intrusive_ptr<SHAMapItem const> const&,
+        boost::intrusive_ptr<SHAMapItem const> const&>;
 
     // tree node cache operations
     std::shared_ptr<SHAMapTreeNode>
@@ -400,7 +508,8 @@ private:
     firstBelow(
         std::shared_ptr<SHAMapTreeNode>,
         SharedPtrNodeStack& stack,
-        int branch = 0) const;
+        int branch = 0,
+        int readAhead = 0) const;
 
     // Simple descent
     // Get a child of the specified node
@@ -438,7 +547,7 @@ private:
     descendNoStore(std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
 
     /** If there is only one leaf below this node, get its contents */
-    std::shared_ptr<SHAMapItem const> const&
+    boost::intrusive_ptr<SHAMapItem const> const&
     onlyBelow(SHAMapTreeNode*) const;
 
     bool
@@ -449,17 +558,89 @@ private:
     SHAMapLeafNode const*
     peekFirstItem(SharedPtrNodeStack& stack) const;
     SHAMapLeafNode const*
-    peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const;
+    peekNextItem(
+        uint256 const& id,
+        SharedPtrNodeStack& stack,
+        int readAhead = 0) const;
+
+    // Read ahead of a range scan that has just moved to a branch of an
+    // inner node. Opening reads the count subtrees that follow the branch.
+    // Otherwise the scan moved over from the branch before, and only the
+    // last of those subtrees is new.
+    void
+    prefetchScan(SHAMapInnerNode& node, int branch, int count, bool open)
+        const;
+
+    // Open the read ahead at every level of a scan's path to a key
+    void
+    prefetchScanPath(SharedPtrNodeStack stack, uint256 const& key, int count)
+        const;
     bool
     walkBranch(
         SHAMapTreeNode* node,
-        std::shared_ptr<SHAMapItem const> const& otherMapItem,
+        boost::intrusive_ptr<SHAMapItem const> const& otherMapItem,
         bool isFirstMap,
         Delta& differences,
         int& maxCount) const;
+
+    // Compare the subtrees below two nodes, one from each map
+    bool
+    compareNodes(
+        SHAMapTreeNode* ourRoot,
+        SHAMapTreeNode* otherRoot,
+        SHAMap const& otherMap,
+        Delta& differences,
+        int& maxCount) const;
+
+    // Compare the branches below two inner roots on several threads
+    bool
+    compareBranches(
+        SHAMap const& otherMap,
+        Delta& differences,
+        int maxCount,
+        int threads) const;
+
+    // Walk the subtrees below an inner root on several threads, optionally
+    // limiting the rate at which nodes are visited
+    void
+    walkMapParallel(
+        std::vector<SHAMapMissingNode>& missingNodes,
+        int maxMissing,
+        int threads,
+        std::size_t nodesPerSecond) const;
+
     int
     walkSubTree(bool doWrite, NodeObjectType t);
 
+    // Flush the dirty nodes below an inner node that is ours, returning
+    // the node to link in its place
+    std::shared_ptr<SHAMapInnerNode>
+    flushSubTree(
+        std::shared_ptr<SHAMapInnerNode> node,
+        bool doWrite,
+        NodeObjectType t,
+        int& flushed) const;
+
+    // Hash, share and write the ready children of an inner node from the
+    // given offset on, hook them to the node and drop them from the list,
+    // returning the count flushed
+    int
+    flushReady(
+        SHAMapInnerNode& parent,
+        std::vector<std::pair<int, std::shared_ptr<SHAMapTreeNode>>>& ready,
+        std::size_t start,
+        bool doWrite,
+        NodeObjectType t) const;
+
+    // Flush the dirty inner children of an inner node that is ours on
+    // several threads and link them back in, returning the count flushed
+    int
+    flushBranches(
+        SHAMapInnerNode& node,
+        bool doWrite,
+        NodeObjectType t,
+        int threads) const;
+
     // Structure to track information about call to
     // getMissingNodes while it's in progress
     struct MissingNodes
@@ -510,6 +691,11 @@ private:
         // reads
         std::map<SHAMapInnerNode*, SHAMapNodeID> resumes_;
 
+        // instrumentation: child nodes examined and time spent waiting
+        // for deferred reads
+        std::size_t visited_ = 0;
+        std::chrono::steady_clock::duration waited_{};
+
         MissingNodes(
             int max,
             SHAMapSyncFilter* filter,
@@ -530,7 +716,11 @@ private:
     void
     gmn_ProcessNodes(MissingNodes&, MissingNodes::StackEntry& node);
     void
-    gmn_ProcessDeferredReads(MissingNodes&);
+    gmn_ProcessDeferredReads(MissingNodes&, int outstanding = 0);
+    void
+    gmn_Traverse(MissingNodes&, MissingNodes::StackEntry pos);
+    void
+    gmn_TraverseParallel(MissingNodes&, int threads);
 
     // fetch from DB helper function
     std::shared_ptr<SHAMapTreeNode>
@@ -603,6 +793,7 @@ private:
     SharedPtrNodeStack stack_;
     SHAMap const* map_ = nullptr;
     pointer item_ = nullptr;
+    int readAhead_ = 0;
 
 public:
     const_iterator() = delete;
@@ -624,21 +815,31 @@ public:
     operator++(int);
 
 private:
-    explicit const_iterator(SHAMap const* map);
+    explicit const_iterator(SHAMap const* map, int readAhead = 0);
     const_iterator(SHAMap const* map, std::nullptr_t);
-    const_iterator(SHAMap const* map, pointer item, SharedPtrNodeStack&& stack);
+    const_iterator(
+        SHAMap const* map,
+        pointer item,
+        SharedPtrNodeStack&& stack,
+        int readAhead = 0);
 
     friend bool
     operator==(const_iterator const& x, const_iterator const& y);
     friend class SHAMap;
 };
 
-inline SHAMap::const_iterator::const_iterator(SHAMap const* map) : map_(map)
+inline SHAMap::const_iterator::const_iterator(
+    SHAMap const* map,
+    int readAhead)
+    : map_(map), readAhead_(readAhead)
 {
     assert(map_ != nullptr);
 
     if (auto temp = map_->peekFirstItem(stack_))
         item_ = temp->peekItem().get();
+
+    if (item_ && readAhead_ > 0)
+        map_->prefetchScanPath(stack_, item_->key(), readAhead_);
 }
 
 inline SHAMap::const_iterator::const_iterator(SHAMap const* map, std::nullptr_t)
@@ -649,9 +850,12 @@ inline SHAMap::const_iterator::const_iterator(SHAMap const* map, std::nullptr_t)
 inline SHAMap::const_iterator::const_iterator(
     SHAMap const* map,
     pointer item,
-    SharedPtrNodeStack&& stack)
-    : stack_(std::move(stack)), map_(map), item_(item)
+    SharedPtrNodeStack&& stack,
+    int readAhead)
+    : stack_(std::move(stack)), map_(map), item_(item), readAhead_(readAhead)
 {
+    if (item_ && readAhead_ > 0)
+        map_->prefetchScanPath(stack_, item_->key(), readAhead_);
 }
 
 inline SHAMap::const_iterator::reference
@@ -669,7 +873,7 @@ SHAMap::const_iterator::operator->() const
 inline SHAMap::const_iterator&
 SHAMap::const_iterator::operator++()
 {
-    if (auto temp = map_->peekNextItem(item_->key(), stack_))
+    if (auto temp = map_->peekNextItem(item_->key(), stack_, readAhead_))
         item_ = temp->peekItem().get();
     else
         item_ = nullptr;
@@ -709,6 +913,12 @@ SHAMap::end() const
     return const_iterator(this, nullptr);
 }
 
+inline SHAMap::const_iterator
+SHAMap::begin(int readAhead) const
+{
+    return const_iterator(this, backed_ ? readAhead : 0);
+}
+
 }  // namespace ripple
 
 #endif
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAP_SHAMAPDEFERREDWRITES_H_INCLUDED
+#define RIPPLE_SHAMAP_SHAMAPDEFERREDWRITES_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/nodestore/Database.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Nodes flushed from a SHAMap whose writes to the node store were put off.
+
+    A flush that defers its writes hashes and canonicalizes the nodes as
+    usual, so the map can be used at once, and leaves the serialized nodes
+    here to be stored later.
+*/
+class SHAMapDeferredWrites
+{
+public:
+    SHAMapDeferredWrites() = default;
+    SHAMapDeferredWrites(SHAMapDeferredWrites const&) = delete;
+    SHAMapDeferredWrites&
+    operator=(SHAMapDeferredWrites const&) = delete;
+
+    /** Add a node to write. Safe to call from several threads. */
+    void
+    add(NodeObjectType type,
+        Blob&& data,
+        uint256 const& hash,
+        std::uint32_t ledgerSeq)
+    {
+        std::lock_guard lock(mutex_);
+        nodes_.push_back({type, std::move(data), hash, ledgerSeq});
+    }
+
+    /** Write the nodes to the node store.
+
+        Returns once every node added so far is stored, even when the
+        writes were done by a concurrent call.
+
+        @return The number of nodes this call wrote.
+    */
+    std::size_t
+    store(NodeStore::Database& db)
+    {
+        std::lock_guard lock(mutex_);
+        auto const count = nodes_.size();
+        for (auto& node : nodes_)
+            db.store(node.type, std::move(node.data), node.hash, node.seq);
+        nodes_.clear();
+        nodes_.shrink_to_fit();
+        return count;
+    }
+
+private:
+    struct Node
+    {
+        NodeObjectType type;
+        Blob data;
+        uint256 hash;
+        std::uint32_t seq;
+    };
+
+    std::mutex mutex_;
+    std::vector<Node> nodes_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -21,12 +21,14 @@
 #define RIPPLE_SHAMAP_SHAMAPINNERNODE_H_INCLUDED
 
 #include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/spinlock.h>
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/shamap/SHAMapItem.h>
 #include <ripple/shamap/SHAMapNodeID.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
 #include <ripple/shamap/impl/TaggedPointer.h>
 
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 #include <memory>
@@ -53,7 +55,8 @@ private:
     std::uint32_t fullBelowGen_ = 0;
     std::uint16_t isBranch_ = 0;
 
-    static std::mutex childLock;
+    /** A bitlock for the children of this node, with one bit per child */
+    mutable std::atomic<std::uint16_t> lock_ = 0;
 
     /** Convert arrays stored in `hashesAndChildren_` so they can store the
         requested number of children.
@@ -111,7 +114,9 @@ public:
     ~SHAMapInnerNode();
 
     std::shared_ptr<SHAMapTreeNode>
-    clone(std::uint32_t cowid) const override;
+    clone(
+        std::uint32_t cowid,
+        std::shared_ptr<SHAMapNodeArena> const& arena) const override;
 
     SHAMapNodeType
     getType() const override
@@ -172,6 +177,10 @@ public:
     void
     updateHashDeep();
 
+    /** Copy the current hashes of any children held in memory. */
+    void
+    updateChildHashes();
+
     void
     serializeForWire(Serializer&) const override;
 
@@ -20,74 +20,107 @@
 #ifndef RIPPLE_SHAMAP_SHAMAPITEM_H_INCLUDED
 #define RIPPLE_SHAMAP_SHAMAPITEM_H_INCLUDED
 
-#include <ripple/basics/Blob.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/basics/Slice.h>
 #include <ripple/basics/base_uint.h>
-#include <ripple/beast/utility/Journal.h>
-#include <ripple/protocol/Serializer.h>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
 
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 
 namespace ripple {
 
 // an item stored in a SHAMap
+//
+// The data is stored right after the item, in the same block of memory,
+// and the item carries its own reference count. Items are created with
+// make_shamapitem, which draws the memory from slabs of fixed size, and
+// are owned through boost::intrusive_ptr.
 class SHAMapItem : public CountedObject<SHAMapItem>
 {
+    // These are used to support boost::intrusive_ptr reference counting
+    friend void
+    intrusive_ptr_add_ref(SHAMapItem const* x);
+
+    friend void
+    intrusive_ptr_release(SHAMapItem const* x);
+
+    // This is the only way to construct a SHAMapItem
+    friend boost::intrusive_ptr<SHAMapItem>
+    make_shamapitem(uint256 const& tag, Slice data);
+
 private:
-    uint256 tag_;
-    Blob data_;
+    uint256 const tag_;
 
-public:
-    SHAMapItem(uint256 const& tag, Blob const& data);
-    SHAMapItem(uint256 const& tag, Serializer const& s);
-    SHAMapItem(uint256 const& tag, Serializer&& s);
+    // We use std::uint32_t for the size: items are never this large.
+    std::uint32_t const size_;
 
-    Slice
-    slice() const;
+    // Items are shared between maps and kept alive by the leaves that
+    // hold them.
+    mutable std::atomic<std::uint32_t> refcount_ = 1;
 
-    uint256 const&
-    key() const;
+    // Copies the data into the memory that follows the item, which the
+    // caller must have allocated along with it.
+    SHAMapItem(uint256 const& tag, Slice data);
 
-    Blob const&
-    peekData() const;
+public:
+    SHAMapItem() = delete;
+    SHAMapItem(SHAMapItem const& other) = delete;
+    SHAMapItem&
+    operator=(SHAMapItem const& other) = delete;
+    SHAMapItem(SHAMapItem&& other) = delete;
+    SHAMapItem&
+    operator=(SHAMapItem&&) = delete;
+
+    uint256 const&
+    key() const
+    {
+        return tag_;
+    }
 
     std::size_t
-    size() const;
+    size() const
+    {
+        return size_;
+    }
+
     void const*
-    data() const;
-};
+    data() const
+    {
+        return reinterpret_cast<std::uint8_t const*>(this) + sizeof(*this);
+    }
 
-//------------------------------------------------------------------------------
+    Slice
+    slice() const
+    {
+        return {data(), size()};
+    }
+};
 
-inline Slice
-SHAMapItem::slice() const
+inline void
+intrusive_ptr_add_ref(SHAMapItem const* x)
 {
-    return {data_.data(), data_.size()};
-}
+    // This can only happen if someone releases the last reference to the
+    // item while we were trying to increment the refcount.
+    assert(x->refcount_ != 0);
 
-inline std::size_t
-SHAMapItem::size() const
-{
-    return data_.size();
+    x->refcount_.fetch_add(1, std::memory_order_relaxed);
 }
 
-inline void const*
-SHAMapItem::data() const
-{
-    return data_.data();
-}
+void
+intrusive_ptr_release(SHAMapItem const* x);
 
-inline uint256 const&
-SHAMapItem::key() const
-{
-    return tag_;
-}
+/** Create an item holding a copy of the given data. */
+boost::intrusive_ptr<SHAMapItem>
+make_shamapitem(uint256 const& tag, Slice data);
 
-inline Blob const&
-SHAMapItem::peekData() const
+/** Create a copy of an item. */
+inline boost::intrusive_ptr<SHAMapItem>
+make_shamapitem(SHAMapItem const& other)
 {
-    return data_;
+    return make_shamapitem(other.key(), other.slice());
 }
 
 }  // namespace ripple
@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAP_SHAMAPNODEARENA_H_INCLUDED
+#define RIPPLE_SHAMAP_SHAMAPNODEARENA_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** Memory for the tree nodes of short lived maps.
+
+    Transaction maps, and the transaction sets of consensus, are built,
+    hashed and mostly thrown away every few seconds. Building their nodes
+    one by one in the general heap churns the allocator and fragments it.
+    A map given an arena instead carves its nodes out of large blocks, and
+    the blocks are returned together once the last node drawn from them
+    is destroyed. Freeing a single node returns nothing.
+
+    Every node holds a reference to its arena, so nodes that outlive the
+    map, in the tree node cache or in a snapshot, keep the blocks alive.
+
+    @note Allocation can be called concurrently.
+*/
+class SHAMapNodeArena
+{
+public:
+    // Allocations larger than this get a block of their own
+    static constexpr std::size_t blockBytes = 64 * 1024;
+
+    SHAMapNodeArena() = default;
+    SHAMapNodeArena(SHAMapNodeArena const&) = delete;
+    SHAMapNodeArena&
+    operator=(SHAMapNodeArena const&) = delete;
+
+    ~SHAMapNodeArena();
+
+    void*
+    allocate(std::size_t bytes, std::size_t alignment);
+
+    void
+    deallocate(void* p, std::size_t bytes) noexcept;
+
+    /** The bytes of the blocks obtained so far. */
+    std::size_t
+    reserved() const;
+
+    /** The bytes of the allocations not yet freed. */
+    std::size_t
+    used() const
+    {
+        return used_;
+    }
+
+    /** A standard allocator drawing memory from an arena. */
+    template <class T>
+    struct Allocator
+    {
+        using value_type = T;
+
+        std::shared_ptr<SHAMapNodeArena> arena;
+
+        explicit Allocator(std::shared_ptr<SHAMapNodeArena> a) noexcept
+            : arena(std::move(a))
+        {
+        }
+
+        template <class U>
+        Allocator(Allocator<U> const& other) noexcept : arena(other.arena)
+        {
+        }
+
+        T*
+        allocate(std::size_t n)
+        {
+            return static_cast<T*>(
+                arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void
+        deallocate(T* p, std::size_t n) noexcept
+        {
+            arena->deallocate(p, n * sizeof(T));
+        }
+
+        template <class U>
+        bool
+        operator==(Allocator<U> const& other) const noexcept
+        {
+            return arena == other.arena;
+        }
+
+        template <class U>
+        bool
+        operator!=(Allocator<U> const& other) const noexcept
+        {
+            return arena != other.arena;
+        }
+    };
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::pair<void*, std::size_t>> blocks_;
+    char* next_ = nullptr;
+    char* end_ = nullptr;
+    std::atomic<std::size_t> used_{0};
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAP_SHAMAPSNAPSHOT_H_INCLUDED
+#define RIPPLE_SHAMAP_SHAMAPSNAPSHOT_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/shamap/Family.h>
+#include <ripple/shamap/SHAMap.h>
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** A file of SHAMap nodes used to warm the tree node cache at startup.
+
+    A snapshot holds the nodes of a map that were in memory when it was
+    written, breadth first, so inner nodes come before the leaves below
+    them. Nodes are kept in their prefix format and the loader hashes each
+    one again, so an old or damaged snapshot can cost time but can never
+    put a wrong node in the cache.
+
+    Loaded nodes are held until release() is called, so they outlive the
+    cache's expiration while the ledger that needs them is acquired.
+*/
+class SHAMapSnapshot
+{
+public:
+    SHAMapSnapshot(boost::filesystem::path path, beast::Journal j);
+
+    SHAMapSnapshot(SHAMapSnapshot const&) = delete;
+    SHAMapSnapshot&
+    operator=(SHAMapSnapshot const&) = delete;
+
+    boost::filesystem::path const&
+    path() const
+    {
+        return path_;
+    }
+
+    /** Write the nodes of a map already in memory, replacing any snapshot.
+
+        Nothing is fetched from the database. The file is written beside
+        the snapshot and renamed over it, so a reader never sees part of
+        one.
+
+        @param map The map to write
+        @param ledgerSeq The sequence of the ledger the map belongs to
+        @param maxNodes The most nodes to write
+        @return The number of nodes written, or 0 on error
+    */
+    std::size_t
+    write(SHAMap const& map, std::uint32_t ledgerSeq, std::size_t maxNodes)
+        const;
+
+    /** Add the nodes of the snapshot to a family's tree node cache.
+
+        The file is memory mapped and read once, front to back.
+
+        @return The number of nodes loaded
+    */
+    std::size_t
+    load(Family& family);
+
+    /** Stop holding the nodes loaded from the snapshot. */
+    void
+    release();
+
+private:
+    boost::filesystem::path const path_;
+    beast::Journal const j_;
+
+    // Keeps writes from the periodic job and shutdown apart
+    std::mutex mutable writeMutex_;
+
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<SHAMapTreeNode>> loaded_;
+};
+
+}  // namespace ripple
+
+#endif
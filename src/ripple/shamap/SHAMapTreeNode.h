@@ -21,9 +21,12 @@
 #define RIPPLE_SHAMAP_SHAMAPTREENODE_H_INCLUDED
 
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/MemoryArena.h>
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/Serializer.h>
 #include <ripple/shamap/SHAMapItem.h>
+#include <ripple/shamap/SHAMapNodeArena.h>
 #include <ripple/shamap/SHAMapNodeID.h>
 
 #include <cstdint>
@@ -209,15 +212,29 @@ public:
         cowid_ = 0;
     }
 
-    /** Make a copy of this node, setting the owner. */
+    /** Make a copy of this node, setting the owner.
+
+        @param arena Where to make the copy, or nullptr for the heap
+    */
     virtual std::shared_ptr<SHAMapTreeNode>
-    clone(std::uint32_t cowid) const = 0;
+    clone(
+        std::uint32_t cowid,
+        std::shared_ptr<SHAMapNodeArena> const& arena) const = 0;
     /** @} */
 
     /** Recalculate the hash of this node. */
     virtual void
     updateHash() = 0;
 
+    /** Recalculate the hashes of several nodes at once.
+
+        Inner nodes first pick up the hashes of their children, as with
+        updateHashDeep, so the children must already be hashed. Where the
+        processor allows it, the nodes are hashed together.
+    */
+    static void
+    updateHashes(SHAMapTreeNode* const* nodes, std::size_t count);
+
     /** Return the hash of this node. */
     SHAMapHash const&
     getHash() const
@@ -268,6 +285,27 @@ private:
     makeTransactionWithMeta(Slice data, SHAMapHash const& hash, bool hashValid);
 };
 
+/** Make a tree node, drawing its memory from the shamap arena. */
+template <class Node, class... Args>
+std::shared_ptr<Node>
+makeSHAMapNode(Args&&... args)
+{
+    return std::allocate_shared<Node>(
+        ArenaAllocator<Node, MemoryArena::shamap>{},
+        std::forward<Args>(args)...);
+}
+
+/** Make a tree node in a map's arena, or as above if it has none. */
+template <class Node, class... Args>
+std::shared_ptr<Node>
+makeSHAMapNodeIn(std::shared_ptr<SHAMapNodeArena> const& arena, Args&&... args)
+{
+    if (!arena)
+        return makeSHAMapNode<Node>(std::forward<Args>(args)...);
+    return std::allocate_shared<Node>(
+        SHAMapNodeArena::Allocator<Node>{arena}, std::forward<Args>(args)...);
+}
+
 }  // namespace ripple
 
 #endif
@@ -35,7 +35,7 @@ class SHAMapTxLeafNode final : public SHAMapLeafNode,
 {
 public:
     SHAMapTxLeafNode(
-        std::shared_ptr<SHAMapItem const> item,
+        boost::intrusive_ptr<SHAMapItem const> item,
         std::uint32_t cowid)
         : SHAMapLeafNode(std::move(item), cowid)
     {
@@ -43,7 +43,7 @@ public:
     }
 
     SHAMapTxLeafNode(
-        std::shared_ptr<SHAMapItem const> item,
+        boost::intrusive_ptr<SHAMapItem const> item,
         std::uint32_t cowid,
         SHAMapHash const& hash)
         : SHAMapLeafNode(std::move(item), cowid, hash)
@@ -51,9 +51,11 @@ public:
     }
 
     std::shared_ptr<SHAMapTreeNode>
-    clone(std::uint32_t cowid) const final override
+    clone(
+        std::uint32_t cowid,
+        std::shared_ptr<SHAMapNodeArena> const& arena) const final override
     {
-        return std::make_shared<SHAMapTxLeafNode>(item_, cowid, hash_);
+        return makeSHAMapNodeIn<SHAMapTxLeafNode>(arena, item_, cowid, hash_);
     }
 
     SHAMapNodeType
@@ -66,13 +68,13 @@ public:
     updateHash() final override
     {
         hash_ = SHAMapHash{sha512Half(
-            HashPrefix::transactionID, makeSlice(item_->peekData()))};
+            HashPrefix::transactionID, item_->slice())};
     }
 
     void
     serializeForWire(Serializer& s) const final override
     {
-        s.addRaw(item_->peekData());
+        s.addRaw(item_->slice());
         s.add8(wireTypeTransaction);
     }
 
@@ -80,7 +82,7 @@ public:
     serializeWithPrefix(Serializer& s) const final override
     {
         s.add32(HashPrefix::transactionID);
-        s.addRaw(item_->peekData());
+        s.addRaw(item_->slice());
     }
 };
 
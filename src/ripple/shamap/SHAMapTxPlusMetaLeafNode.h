@@ -36,7 +36,7 @@ class SHAMapTxPlusMetaLeafNode final
 {
 public:
     SHAMapTxPlusMetaLeafNode(
-        std::shared_ptr<SHAMapItem const> item,
+        boost::intrusive_ptr<SHAMapItem const> item,
         std::uint32_t cowid)
         : SHAMapLeafNode(std::move(item), cowid)
     {
@@ -44,7 +44,7 @@ public:
     }
 
     SHAMapTxPlusMetaLeafNode(
-        std::shared_ptr<SHAMapItem const> item,
+        boost::intrusive_ptr<SHAMapItem const> item,
         std::uint32_t cowid,
         SHAMapHash const& hash)
         : SHAMapLeafNode(std::move(item), cowid, hash)
@@ -52,9 +52,12 @@ public:
     }
 
     std::shared_ptr<SHAMapTreeNode>
-    clone(std::uint32_t cowid) const override
+    clone(
+        std::uint32_t cowid,
+        std::shared_ptr<SHAMapNodeArena> const& arena) const override
     {
-        return std::make_shared<SHAMapTxPlusMetaLeafNode>(item_, cowid, hash_);
+        return makeSHAMapNodeIn<SHAMapTxPlusMetaLeafNode>(
+            arena, item_, cowid, hash_);
     }
 
     SHAMapNodeType
@@ -67,13 +70,13 @@ public:
     updateHash() final override
     {
         hash_ = SHAMapHash{sha512Half(
-            HashPrefix::txNode, makeSlice(item_->peekData()), item_->key())};
+            HashPrefix::txNode, item_->slice(), item_->key())};
     }
 
     void
     serializeForWire(Serializer& s) const final override
     {
-        s.addRaw(item_->peekData());
+        s.addRaw(item_->slice());
         s.addBitString(item_->key());
         s.add8(wireTypeTransactionWithMeta);
     }
@@ -82,7 +85,7 @@ public:
     serializeWithPrefix(Serializer& s) const final override
     {
         s.add32(HashPrefix::txNode);
-        s.addRaw(item_->peekData());
+        s.addRaw(item_->slice());
         s.addBitString(item_->key());
     }
 };
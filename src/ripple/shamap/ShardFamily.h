@@ -60,6 +60,9 @@ public:
         return j_;
     }
 
+    WorkerPool&
+    workers() override;
+
     bool
     isShardBacked() const override
     {
@@ -20,11 +20,12 @@
 #ifndef RIPPLE_SHAMAP_TREENODECACHE_H_INCLUDED
 #define RIPPLE_SHAMAP_TREENODECACHE_H_INCLUDED
 
+#include <ripple/basics/ShardedTaggedCache.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
 
 namespace ripple {
 
-using TreeNodeCache = TaggedCache<uint256, SHAMapTreeNode>;
+using TreeNodeCache = ShardedTaggedCache<uint256, SHAMapTreeNode>;
 
 }  // namespace ripple
 
@@ -17,10 +17,20 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/Tuning.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/Overlay.h>
+#include <ripple/overlay/Peer.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/shamap/NodeFamily.h>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 namespace ripple {
 
@@ -44,11 +54,37 @@ NodeFamily::NodeFamily(Application& app, CollectorManager& cm)
 {
 }
 
+WorkerPool&
+NodeFamily::workers()
+{
+    return app_.getWorkerPool();
+}
+
 void
 NodeFamily::sweep()
 {
     fbCache_->sweep();
     tnCache_->sweep();
+
+    std::lock_guard lock(fetchMutex_);
+    auto const now = clock_type::now();
+    for (auto it = fetches_.begin(); it != fetches_.end();)
+    {
+        auto& fetch = it->second;
+        if (fetch.state == Fetch::State::sent &&
+            now - fetch.sent >= missingNodeTimeout)
+        {
+            fetch.state = Fetch::State::idle;
+            --outstanding_;
+        }
+
+        if (fetch.state == Fetch::State::idle &&
+            now - fetch.sent >= missingNodeExpiration)
+            it = fetches_.erase(it);
+        else
+            ++it;
+    }
+    queueSend(lock);
 }
 
 void
@@ -59,6 +95,13 @@ NodeFamily::reset()
         maxSeq_ = 0;
     }
 
+    {
+        std::lock_guard lock(fetchMutex_);
+        fetches_.clear();
+        pending_ = 0;
+        outstanding_ = 0;
+    }
+
     fbCache_->reset();
     tnCache_->reset();
 }
@@ -68,6 +111,15 @@ NodeFamily::missingNode(std::uint32_t seq)
 {
     JLOG(j_.error()) << "Missing node in " << seq;
 
+    {
+        // Leave the ledger be while its missing nodes are fetched by hash
+        std::lock_guard lock(fetchMutex_);
+        if (std::any_of(fetches_.begin(), fetches_.end(), [seq](auto const& f) {
+                return f.second.seq == seq;
+            }))
+            return;
+    }
+
     std::unique_lock<std::mutex> lock(maxSeqMutex_);
     if (maxSeq_ == 0)
     {
@@ -93,6 +145,190 @@ NodeFamily::missingNode(std::uint32_t seq)
     }
 }
 
+void
+NodeFamily::missingNode(SHAMapType type, uint256 const& hash, std::uint32_t seq)
+{
+    if (seq == 0 || type == SHAMapType::FREE)
+        return;
+
+    {
+        std::lock_guard lock(fetchMutex_);
+        auto it = fetches_.find(hash);
+        if (it == fetches_.end())
+        {
+            if (fetches_.size() >= missingNodeLimit)
+                return;
+            it = fetches_.emplace(hash, Fetch{type, seq}).first;
+            ++pending_;
+            queueSend(lock);
+            return;
+        }
+
+        auto& fetch = it->second;
+        if (fetch.state == Fetch::State::sent &&
+            clock_type::now() - fetch.sent >= missingNodeTimeout)
+        {
+            fetch.state = Fetch::State::idle;
+            --outstanding_;
+        }
+
+        // Already waiting to be requested, or for a reply
+        if (fetch.state != Fetch::State::idle)
+            return;
+
+        if (fetch.tries < missingNodeTries)
+        {
+            fetch.state = Fetch::State::pending;
+            ++pending_;
+            queueSend(lock);
+            return;
+        }
+
+        // Peers did not send the node, so acquire the ledger instead
+        fetches_.erase(it);
+    }
+
+    acquire(app_.getLedgerMaster().getHashBySeq(seq), seq);
+}
+
+bool
+NodeFamily::foundNode(uint256 const& hash, Slice const& data)
+{
+    NodeObjectType type;
+    std::uint32_t seq;
+    {
+        std::lock_guard lock(fetchMutex_);
+        auto const it = fetches_.find(hash);
+        if (it == fetches_.end())
+            return false;
+
+        if (sha512Half(data) != hash)
+        {
+            JLOG(j_.warn()) << "Fetched node " << hash << " is corrupt";
+            return true;
+        }
+
+        auto const& fetch = it->second;
+        type = fetch.type == SHAMapType::STATE ? hotACCOUNT_NODE
+                                               : hotTRANSACTION_NODE;
+        seq = fetch.seq;
+        if (fetch.state == Fetch::State::pending)
+            --pending_;
+        else if (fetch.state == Fetch::State::sent)
+            --outstanding_;
+        fetches_.erase(it);
+        queueSend(lock);
+    }
+
+    db_.store(type, Blob(data.begin(), data.end()), hash, seq);
+    return true;
+}
+
+void
+NodeFamily::queueSend(std::lock_guard<std::mutex> const&)
+{
+    if (sendQueued_ || pending_ == 0 || outstanding_ >= missingNodeOutstanding)
+        return;
+
+    // Reports that arrive before the job runs join its requests
+    sendQueued_ = app_.getJobQueue().addJob(
+        jtLEDGER_DATA, "missingNodes", [this](Job&) { sendFetches(); });
+}
+
+void
+NodeFamily::sendFetches()
+{
+    // The pending nodes of each map, up to the room left for requests
+    std::map<std::pair<std::uint32_t, SHAMapType>, std::vector<uint256>>
+        batches;
+    {
+        std::lock_guard lock(fetchMutex_);
+        sendQueued_ = false;
+        auto const now = clock_type::now();
+        for (auto& [hash, fetch] : fetches_)
+        {
+            if (outstanding_ >= missingNodeOutstanding)
+                break;
+            if (fetch.state != Fetch::State::pending)
+                continue;
+            fetch.state = Fetch::State::sent;
+            fetch.sent = now;
+            ++fetch.tries;
+            --pending_;
+            ++outstanding_;
+            batches[{fetch.seq, fetch.type}].push_back(hash);
+        }
+    }
+
+    auto const peers = app_.overlay().getActivePeers();
+    for (auto const& [key, hashes] : batches)
+    {
+        auto const [seq, type] = key;
+        auto const ledgerHash = app_.getLedgerMaster().getHashBySeq(seq);
+
+        // Select target Peer based on highest score, from those that have
+        // the ledger.  The score is randomized but biased in favor of Peers
+        // with low latency.
+        std::shared_ptr<Peer> target;
+        if (ledgerHash.isNonZero())
+        {
+            int maxScore = 0;
+            for (auto const& peer : peers)
+            {
+                if (peer->hasLedger(ledgerHash, seq))
+                {
+                    int const score = peer->getScore(true);
+                    if (!target || (score > maxScore))
+                    {
+                        target = peer;
+                        maxScore = score;
+                    }
+                }
+            }
+        }
+
+        if (!target)
+        {
+            JLOG(j_.debug()) << "No peer for " << hashes.size()
+                             << " missing nodes in " << seq;
+            {
+                std::lock_guard lock(fetchMutex_);
+                for (auto const& hash : hashes)
+                {
+                    if (fetches_.erase(hash) != 0)
+                        --outstanding_;
+                }
+            }
+            acquire(ledgerHash, seq);
+            continue;
+        }
+
+        for (std::size_t i = 0; i < hashes.size(); i += missingNodeBatch)
+        {
+            protocol::TMGetObjectByHash tmBH;
+            tmBH.set_query(true);
+            tmBH.set_type(
+                type == SHAMapType::STATE
+                    ? protocol::TMGetObjectByHash::otSTATE_NODE
+                    : protocol::TMGetObjectByHash::otTRANSACTION_NODE);
+            tmBH.set_ledgerhash(ledgerHash.begin(), ledgerHash.size());
+            tmBH.set_seq(seq);
+            auto const end = std::min(hashes.size(), i + missingNodeBatch);
+            for (auto j = i; j < end; ++j)
+            {
+                protocol::TMIndexedObject* io = tmBH.add_objects();
+                io->set_hash(hashes[j].begin(), hashes[j].size());
+                io->set_ledgerseq(seq);
+            }
+            target->send(
+                std::make_shared<Message>(tmBH, protocol::mtGET_OBJECTS));
+        }
+        JLOG(j_.debug()) << "Requested " << hashes.size()
+                         << " missing nodes in " << seq << " from peer "
+                         << target->id();
+    }
+}
+
 void
 NodeFamily::acquire(uint256 const& hash, std::uint32_t seq)
 {
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/basics/contract.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapAccountStateLeafNode.h>
 #include <ripple/shamap/SHAMapNodeID.h>
@@ -25,24 +26,121 @@
 #include <ripple/shamap/SHAMapTxLeafNode.h>
 #include <ripple/shamap/SHAMapTxPlusMetaLeafNode.h>
 
+#include <array>
+#include <atomic>
+#include <tuple>
+
 namespace ripple {
 
+namespace {
+
+void
+prefetchChildren(
+    NodeStore::Database& db,
+    std::shared_ptr<TreeNodeCache> const& cache,
+    std::uint32_t ledgerSeq,
+    SHAMapInnerNode const& node,
+    int after,
+    int width,
+    int depth);
+
+// Read a node into the tree node cache ahead of a walk that is likely to
+// need it. If it's an inner node, the first width of its children follow
+// as it arrives, until the depth runs out.
+//
+// The callbacks may outlive the map, so they only refer to the cache
+// and the database.
+void
+prefetchNode(
+    NodeStore::Database& db,
+    std::shared_ptr<TreeNodeCache> const& cache,
+    std::uint32_t ledgerSeq,
+    SHAMapHash const& hash,
+    int width,
+    int depth)
+{
+    if (cache->fetch(hash.as_uint256()))
+        return;
+
+    db.asyncFetch(
+        hash.as_uint256(),
+        ledgerSeq,
+        [&db, cache, ledgerSeq, hash, width, depth](
+            std::shared_ptr<NodeObject> const& object) {
+            if (!object)
+                return;
+
+            std::shared_ptr<SHAMapTreeNode> node;
+            try
+            {
+                node = SHAMapTreeNode::makeFromPrefix(object->getData(), hash);
+            }
+            catch (std::exception const&)
+            {
+                // The walk itself will report the invalid node
+                return;
+            }
+            if (!node)
+                return;
+
+            cache->canonicalize_replace_client(hash.as_uint256(), node);
+            if (depth > 1 && node->isInner())
+                prefetchChildren(
+                    db,
+                    cache,
+                    ledgerSeq,
+                    static_cast<SHAMapInnerNode const&>(*node),
+                    -1,
+                    width,
+                    depth - 1);
+        });
+}
+
+// Read up to width of the children of an inner node that follow the
+// given branch
+void
+prefetchChildren(
+    NodeStore::Database& db,
+    std::shared_ptr<TreeNodeCache> const& cache,
+    std::uint32_t ledgerSeq,
+    SHAMapInnerNode const& node,
+    int after,
+    int width,
+    int depth)
+{
+    for (int branch = after + 1;
+         branch < SHAMapInnerNode::branchFactor && width > 0;
+         ++branch)
+    {
+        if (node.isEmptyBranch(branch))
+            continue;
+
+        prefetchNode(
+            db, cache, ledgerSeq, node.getChildHash(branch), width, depth);
+        --width;
+    }
+}
+
+}  // namespace
+
 [[nodiscard]] std::shared_ptr<SHAMapLeafNode>
 makeTypedLeaf(
     SHAMapNodeType type,
-    std::shared_ptr<SHAMapItem const> item,
-    std::uint32_t owner)
+    boost::intrusive_ptr<SHAMapItem const> item,
+    std::uint32_t owner,
+    std::shared_ptr<SHAMapNodeArena> const& arena)
 {
     if (type == SHAMapNodeType::tnTRANSACTION_NM)
-        return std::make_shared<SHAMapTxLeafNode>(std::move(item), owner);
+        return makeSHAMapNodeIn<SHAMapTxLeafNode>(
+            arena, std::move(item), owner);
 
     if (type == SHAMapNodeType::tnTRANSACTION_MD)
-        return std::make_shared<SHAMapTxPlusMetaLeafNode>(
-            std::move(item), owner);
+        return makeSHAMapNodeIn<SHAMapTxPlusMetaLeafNode>(
+            arena, std::move(item), owner);
 
     if (type == SHAMapNodeType::tnACCOUNT_STATE)
-        return std::make_shared<SHAMapAccountStateLeafNode>(
-            std::move(item), owner);
+        return makeSHAMapNodeIn<SHAMapAccountStateLeafNode>(
+            arena, std::move(item), owner);
 
     LogicError(
         "Attempt to create leaf node of unknown type " +
@@ -50,10 +148,21 @@ makeTypedLeaf(
             static_cast<std::underlying_type_t<SHAMapNodeType>>(type)));
 }
 
-SHAMap::SHAMap(SHAMapType t, Family& f)
-    : f_(f), journal_(f.journal()), state_(SHAMapState::Modifying), type_(t)
+SHAMap::SHAMap(SHAMapType t, Family& f) : SHAMap(t, f, nullptr)
 {
-    root_ = std::make_shared<SHAMapInnerNode>(cowid_);
+}
+
+SHAMap::SHAMap(
+    SHAMapType t,
+    Family& f,
+    std::shared_ptr<SHAMapNodeArena> arena)
+    : f_(f)
+    , journal_(f.journal())
+    , arena_(std::move(arena))
+    , state_(SHAMapState::Modifying)
+    , type_(t)
+{
+    root_ = makeSHAMapNodeIn<SHAMapInnerNode>(arena_, cowid_);
 }
 
 // The `hash` parameter is unused. It is part of the interface so it's clear
@@ -63,13 +172,14 @@ SHAMap::SHAMap(SHAMapType t, Family& f)
 SHAMap::SHAMap(SHAMapType t, uint256 const& hash, Family& f)
     : f_(f), journal_(f.journal()), state_(SHAMapState::Synching), type_(t)
 {
-    root_ = std::make_shared<SHAMapInnerNode>(cowid_);
+    root_ = makeSHAMapNode<SHAMapInnerNode>(cowid_);
 }
 
 std::shared_ptr<SHAMap>
 SHAMap::snapShot(bool isMutable) const
 {
-    auto ret = std::make_shared<SHAMap>(type_, f_);
+    // A snapshot lives about as long as its map, so they share an arena
+    auto ret = std::make_shared<SHAMap>(type_, f_, arena_);
     SHAMap& newMap = *ret;
 
     if (!isMutable)
@@ -163,8 +273,62 @@ std::shared_ptr<SHAMapTreeNode>
 SHAMap::fetchNodeFromDB(SHAMapHash const& hash) const
 {
     assert(backed_);
-    auto obj = f_.db().fetchNodeObject(hash.as_uint256(), ledgerSeq_);
-    return finishFetch(hash, obj);
+
+    // Parse the node directly from the payload the database hands us,
+    // rather than from an intermediate NodeObject
+    struct
+    {
+        std::shared_ptr<SHAMapTreeNode> node;
+        bool invalid = false;
+    } result;
+
+    auto const found = f_.db().fetchNodePayload(
+        hash.as_uint256(), ledgerSeq_, [&result, &hash](Slice data) {
+            try
+            {
+                result.node = SHAMapTreeNode::makeFromPrefix(data, hash);
+            }
+            catch (std::exception const&)
+            {
+                result.invalid = true;
+            }
+        });
+
+    if (!found)
+    {
+        // A map being acquired is expected to be missing nodes
+        if (state_ != SHAMapState::Synching)
+            f_.missingNode(type_, hash.as_uint256(), ledgerSeq_);
+        // Only the first thread to find the map incomplete reports it
+        if (full_.exchange(false))
+            f_.missingNode(ledgerSeq_);
+        return {};
+    }
+
+    if (result.invalid)
+    {
+        JLOG(journal_.warn()) << "Invalid DB node " << hash;
+        return {};
+    }
+
+    if (result.node)
+    {
+        canonicalize(hash, result.node);
+
+        // An inner node read from disk is usually followed by reads of
+        // its children, so start those now to overlap them
+        if (auto const depth = f_.db().prefetchDepth();
+            depth > 0 && result.node->isInner())
+            prefetchChildren(
+                f_.db(),
+                f_.getTreeNodeCache(ledgerSeq_),
+                ledgerSeq_,
+                static_cast<SHAMapInnerNode const&>(*result.node),
+                -1,
+                branchFactor,
+                depth);
+    }
+    return result.node;
 }
 
 std::shared_ptr<SHAMapTreeNode>
@@ -175,19 +339,18 @@ SHAMap::finishFetch(
     assert(backed_);
     if (!object)
     {
-        if (full_)
-        {
-            full_ = false;
+        if (state_ != SHAMapState::Synching)
+            f_.missingNode(type_, hash.as_uint256(), ledgerSeq_);
+        // Only the first thread to find the map incomplete reports it
+        if (full_.exchange(false))
             f_.missingNode(ledgerSeq_);
-        }
         return {};
     }
 
     std::shared_ptr<SHAMapTreeNode> node;
     try
     {
-        node =
-            SHAMapTreeNode::makeFromPrefix(makeSlice(object->getData()), hash);
+        node = SHAMapTreeNode::makeFromPrefix(object->getData(), hash);
         if (node)
             canonicalize(hash, node);
         return node;
@@ -429,7 +592,7 @@ SHAMap::unshareNode(std::shared_ptr<Node> node, SHAMapNodeID const& nodeID)
     {
         // have a CoW
         assert(state_ != SHAMapState::Immutable);
-        node = std::static_pointer_cast<Node>(node->clone(cowid_));
+        node = std::static_pointer_cast<Node>(node->clone(cowid_, arena_));
         if (nodeID.isRoot())
             root_ = node;
     }
@@ -440,7 +603,8 @@ SHAMapLeafNode*
 SHAMap::firstBelow(
     std::shared_ptr<SHAMapTreeNode> node,
     SharedPtrNodeStack& stack,
-    int branch) const
+    int branch,
+    int readAhead) const
 {
     // Return the first item at or below this node
     if (node->isLeaf())
@@ -458,6 +622,8 @@ SHAMap::firstBelow(
     {
         if (!inner->isEmptyBranch(i))
         {
+            if (readAhead > 0)
+                prefetchScan(*inner, i, readAhead, true);
             node = descendThrow(inner, i);
             assert(!stack.empty());
             if (node->isLeaf())
@@ -476,9 +642,9 @@ SHAMap::firstBelow(
     return nullptr;
 }
 
-static const std::shared_ptr<SHAMapItem const> no_item;
+static const boost::intrusive_ptr<SHAMapItem const> no_item;
 
-std::shared_ptr<SHAMapItem const> const&
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMap::onlyBelow(SHAMapTreeNode* node) const
 {
     // If there is only one item below this node, return it
@@ -529,7 +695,10 @@ SHAMap::peekFirstItem(SharedPtrNodeStack& stack) const
 }
 
 SHAMapLeafNode const*
-SHAMap::peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const
+SHAMap::peekNextItem(
+    uint256 const& id,
+    SharedPtrNodeStack& stack,
+    int readAhead) const
 {
     assert(!stack.empty());
     assert(stack.top().first->isLeaf());
@@ -543,8 +712,10 @@ SHAMap::peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const
         {
             if (!inner->isEmptyBranch(i))
             {
+                if (readAhead > 0)
+                    prefetchScan(*inner, i, readAhead, false);
                 node = descendThrow(inner, i);
-                auto leaf = firstBelow(node, stack, i);
+                auto leaf = firstBelow(node, stack, i, readAhead);
                 if (!leaf)
                     Throw<SHAMapMissingNode>(type_, id);
                 assert(leaf->isLeaf());
@@ -557,7 +728,146 @@ SHAMap::peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const
     return nullptr;
 }
 
-std::shared_ptr<SHAMapItem const> const&
+void
+SHAMap::prefetchScan(
+    SHAMapInnerNode& node,
+    int branch,
+    int count,
+    bool open) const
+{
+    // Subtrees read ahead bring the start of their own next level, which
+    // is where the scan will go first when it gets to them
+    static constexpr int depth = 2;
+
+    auto const cache = f_.getTreeNodeCache(ledgerSeq_);
+    int const width = count;
+    for (int i = branch + 1; i < branchFactor && count > 0; ++i)
+    {
+        if (node.isEmptyBranch(i))
+            continue;
+
+        if ((open || count == 1) && !node.getChildPointer(i))
+            prefetchNode(
+                f_.db(), cache, ledgerSeq_, node.getChildHash(i), width, depth);
+        --count;
+    }
+}
+
+void
+SHAMap::prefetchScanPath(
+    SharedPtrNodeStack stack,
+    uint256 const& key,
+    int count) const
+{
+    for (; !stack.empty(); stack.pop())
+    {
+        auto const& [node, nodeID] = stack.top();
+        if (node->isInner())
+            prefetchScan(
+                static_cast<SHAMapInnerNode&>(*node),
+                selectBranch(nodeID, key),
+                count,
+                true);
+    }
+}
+
+void
+SHAMap::fetchPaths(std::vector<uint256> const& keys) const
+{
+    if (!backed_ || !root_->isInner())
+        return;
+
+    // Where the path to each key leaves the nodes in memory
+    struct Walk
+    {
+        SHAMapInnerNode* node;
+        SHAMapNodeID nodeID;
+        uint256 const* key;
+    };
+
+    std::vector<Walk> walks;
+    walks.reserve(keys.size());
+    for (auto const& key : keys)
+        walks.push_back(
+            {static_cast<SHAMapInnerNode*>(root_.get()), SHAMapNodeID{}, &key});
+
+    std::vector<uint256> missing;
+    while (!walks.empty())
+    {
+        // Follow each path down through the nodes already in memory
+        std::vector<Walk> waiting;
+        missing.clear();
+        for (auto walk : walks)
+        {
+            for (;;)
+            {
+                auto const branch = selectBranch(walk.nodeID, *walk.key);
+                if (walk.node->isEmptyBranch(branch))
+                    break;
+
+                auto child = walk.node->getChildPointer(branch);
+                if (!child)
+                {
+                    auto const& hash = walk.node->getChildHash(branch);
+                    if (auto cached = cacheLookup(hash))
+                    {
+                        cached = walk.node->canonicalizeChild(
+                            branch, std::move(cached));
+                        child = cached.get();
+                    }
+                    else
+                    {
+                        missing.push_back(hash.as_uint256());
+                        waiting.push_back(walk);
+                        break;
+                    }
+                }
+
+                if (!child->isInner())
+                    break;
+                walk.node = static_cast<SHAMapInnerNode*>(child);
+                walk.nodeID = walk.nodeID.getChildNodeID(branch);
+            }
+        }
+
+        if (missing.empty())
+            break;
+
+        // Paths that share a node need it read once
+        std::sort(missing.begin(), missing.end());
+        missing.erase(
+            std::unique(missing.begin(), missing.end()), missing.end());
+        auto const objects = f_.db().fetchBatch(missing, ledgerSeq_);
+
+        hash_map<uint256, std::shared_ptr<SHAMapTreeNode>> fetched;
+        for (std::size_t i = 0; i < missing.size(); ++i)
+        {
+            if (auto node = finishFetch(SHAMapHash{missing[i]}, objects[i]))
+                fetched.emplace(missing[i], std::move(node));
+        }
+
+        // Hook up what was read and carry on below it
+        walks.clear();
+        for (auto const& walk : waiting)
+        {
+            auto const branch = selectBranch(walk.nodeID, *walk.key);
+            auto const it = fetched.find(
+                walk.node->getChildHash(branch).as_uint256());
+            if (it == fetched.end())
+                continue;
+
+            auto const child =
+                walk.node->canonicalizeChild(branch, it->second);
+            if (child->isInner())
+                walks.push_back(
+                    {static_cast<SHAMapInnerNode*>(child.get()),
+                     walk.nodeID.getChildNodeID(branch),
+                     walk.key});
+        }
+    }
+}
+
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMap::peekItem(uint256 const& id) const
 {
     SHAMapLeafNode* leaf = findKey(id);
@@ -568,7 +878,7 @@ SHAMap::peekItem(uint256 const& id) const
     return leaf->peekItem();
 }
 
-std::shared_ptr<SHAMapItem const> const&
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMap::peekItem(uint256 const& id, SHAMapHash& hash) const
 {
     SHAMapLeafNode* leaf = findKey(id);
@@ -582,9 +892,17 @@ SHAMap::peekItem(uint256 const& id, SHAMapHash& hash) const
 
 SHAMap::const_iterator
 SHAMap::upper_bound(uint256 const& id) const
+{
+    return upper_bound(id, 0);
+}
+
+SHAMap::const_iterator
+SHAMap::upper_bound(uint256 const& id, int readAhead) const
 {
     // Get a const_iterator to the next item in the tree after a given item
     // item need not be in tree
+    if (!backed_)
+        readAhead = 0;
     SharedPtrNodeStack stack;
     walkTowardsKey(id, &stack);
     while (!stack.empty())
@@ -595,7 +913,7 @@ SHAMap::upper_bound(uint256 const& id) const
             auto leaf = static_cast<SHAMapLeafNode*>(node.get());
             if (leaf->peekItem()->key() > id)
                 return const_iterator(
-                    this, leaf->peekItem().get(), std::move(stack));
+                    this, leaf->peekItem().get(), std::move(stack), readAhead);
         }
         else
         {
@@ -611,7 +929,10 @@ SHAMap::upper_bound(uint256 const& id) const
                     if (!leaf)
                         Throw<SHAMapMissingNode>(type_, id);
                     return const_iterator(
-                        this, leaf->peekItem().get(), std::move(stack));
+                        this,
+                        leaf->peekItem().get(),
+                        std::move(stack),
+                        readAhead);
                 }
             }
         }
@@ -686,7 +1007,7 @@ SHAMap::delItem(uint256 const& id)
                         }
                     }
 
-                    prevNode = makeTypedLeaf(type, item, node->cowid());
+                    prevNode = makeTypedLeaf(type, item, node->cowid(), arena_);
                 }
                 else
                 {
@@ -705,7 +1026,9 @@ SHAMap::delItem(uint256 const& id)
 }
 
 bool
-SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
+SHAMap::addGiveItem(
+    SHAMapNodeType type,
+    boost::intrusive_ptr<SHAMapItem const> item)
 {
     assert(state_ != SHAMapState::Immutable);
     assert(type != SHAMapNodeType::tnINNER);
@@ -735,7 +1058,7 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
         auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
         int branch = selectBranch(nodeID, tag);
         assert(inner->isEmptyBranch(branch));
-        auto newNode = makeTypedLeaf(type, std::move(item), cowid_);
+        auto newNode = makeTypedLeaf(type, std::move(item), cowid_, arena_);
         inner->setChild(branch, newNode);
     }
     else
@@ -743,10 +1066,10 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
         // this is a leaf node that has to be made an inner node holding two
         // items
         auto leaf = std::static_pointer_cast<SHAMapLeafNode>(node);
-        std::shared_ptr<SHAMapItem const> otherItem = leaf->peekItem();
+        boost::intrusive_ptr<SHAMapItem const> otherItem = leaf->peekItem();
         assert(otherItem && (tag != otherItem->key()));
 
-        node = std::make_shared<SHAMapInnerNode>(node->cowid());
+        node = makeSHAMapNodeIn<SHAMapInnerNode>(arena_, node->cowid());
 
         unsigned int b1, b2;
 
@@ -758,15 +1081,17 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
             // we need a new inner node, since both go on same branch at this
             // level
             nodeID = nodeID.getChildNodeID(b1);
-            node = std::make_shared<SHAMapInnerNode>(cowid_);
+            node = makeSHAMapNodeIn<SHAMapInnerNode>(arena_, cowid_);
         }
 
         // we can add the two leaf nodes here
         assert(node->isInner());
 
         auto inner = static_cast<SHAMapInnerNode*>(node.get());
-        inner->setChild(b1, makeTypedLeaf(type, std::move(item), cowid_));
-        inner->setChild(b2, makeTypedLeaf(type, std::move(otherItem), cowid_));
+        inner->setChild(
+            b1, makeTypedLeaf(type, std::move(item), cowid_, arena_));
+        inner->setChild(
+            b2, makeTypedLeaf(type, std::move(otherItem), cowid_, arena_));
     }
 
     dirtyUp(stack, tag, node);
@@ -774,9 +1099,11 @@ SHAMap::addGiveItem(SHAMapNodeType type, std::shared_ptr<SHAMapItem const> item)
 }
 
 bool
-SHAMap::addItem(SHAMapNodeType type, SHAMapItem&& i)
+SHAMap::addItem(
+    SHAMapNodeType type,
+    boost::intrusive_ptr<SHAMapItem const> item)
 {
-    return addGiveItem(type, std::make_shared<SHAMapItem const>(std::move(i)));
+    return addGiveItem(type, std::move(item));
 }
 
 SHAMapHash
@@ -794,7 +1121,7 @@ SHAMap::getHash() const
 bool
 SHAMap::updateGiveItem(
     SHAMapNodeType type,
-    std::shared_ptr<SHAMapItem const> item)
+    boost::intrusive_ptr<SHAMapItem const> item)
 {
     // can't change the tag but can change the hash
     uint256 tag = item->key();
@@ -887,8 +1214,11 @@ SHAMap::writeNode(NodeObjectType t, std::shared_ptr<SHAMapTreeNode> node) const
 
     Serializer s;
     node->serializeWithPrefix(s);
-    f_.db().store(
-        t, std::move(s.modData()), node->getHash().as_uint256(), ledgerSeq_);
+    auto const& hash = node->getHash().as_uint256();
+    if (deferred_)
+        deferred_->add(t, std::move(s.modData()), hash, ledgerSeq_);
+    else
+        f_.db().store(t, std::move(s.modData()), hash, ledgerSeq_);
     return node;
 }
 
@@ -907,7 +1237,7 @@ SHAMap::preFlushNode(std::shared_ptr<Node> node) const
     {
         // Node is not uniquely ours, so unshare it before
         // possibly modifying it
-        node = std::static_pointer_cast<Node>(node->clone(cowid_));
+        node = std::static_pointer_cast<Node>(node->clone(cowid_, arena_));
     }
     return node;
 }
@@ -926,6 +1256,23 @@ SHAMap::flushDirty(NodeObjectType t)
     return walkSubTree(backed_, t);
 }
 
+int
+SHAMap::flushDirty(NodeObjectType t, SHAMapDeferredWrites& deferred)
+{
+    deferred_ = &deferred;
+    try
+    {
+        auto const flushed = walkSubTree(backed_, t);
+        deferred_ = nullptr;
+        return flushed;
+    }
+    catch (...)
+    {
+        deferred_ = nullptr;
+        throw;
+    }
+}
+
 int
 SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
 {
@@ -952,19 +1299,44 @@ SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
 
     if (node->isEmpty())
     {  // replace empty root with a new empty root
-        root_ = std::make_shared<SHAMapInnerNode>(0);
+        root_ = makeSHAMapNodeIn<SHAMapInnerNode>(arena_, 0);
         return 1;
     }
 
-    // Stack of {parent,index,child} pointers representing
-    // inner nodes we are in the process of flushing
-    using StackEntry = std::pair<std::shared_ptr<SHAMapInnerNode>, int>;
+    node = preFlushNode(std::move(node));
+
+    // Flushing distinct branches touches distinct nodes, so busy maps
+    // hash and write the subtrees below the root in parallel
+    if (auto const threads = f_.db().flushThreads(); threads > 1)
+        flushed += flushBranches(*node, doWrite, t, threads);
+
+    // Last inner node is the new root_
+    root_ = flushSubTree(std::move(node), doWrite, t, flushed);
+
+    return flushed;
+}
+
+std::shared_ptr<SHAMapInnerNode>
+SHAMap::flushSubTree(
+    std::shared_ptr<SHAMapInnerNode> node,
+    bool doWrite,
+    NodeObjectType t,
+    int& flushed) const
+{
+    // Stack of {parent,index,ready} entries representing inner nodes we
+    // are in the process of flushing. The ready offset marks where the
+    // parent's own ready children begin.
+    using StackEntry =
+        std::tuple<std::shared_ptr<SHAMapInnerNode>, int, std::size_t>;
     std::stack<StackEntry, std::vector<StackEntry>> stack;
 
-    node = preFlushNode(std::move(node));
+    // Dirty children, with their branches, whose own children have all
+    // been flushed. Siblings are hashed together once their parent has
+    // been walked, so that they can share a multi-buffer hash.
+    std::vector<std::pair<int, std::shared_ptr<SHAMapTreeNode>>> ready;
+    std::size_t start = 0;
 
     int pos = 0;
-
     // We can't flush an inner node until we flush its children
     while (1)
     {
@@ -991,7 +1363,8 @@ SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
                     {
                         // save our place and work on this node
 
-                        stack.emplace(std::move(node), branch);
+                        stack.emplace(std::move(node), branch, start);
+                        start = ready.size();
                         // The semantics of this changes when we move to c++-20
                         // Right now no move will occur; With c++-20 child will
                         // be moved from.
@@ -1001,52 +1374,121 @@ SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
                     }
                     else
                     {
-                        // flush this leaf
-                        ++flushed;
-
-                        assert(node->cowid() == cowid_);
-                        child->updateHash();
-                        child->unshare();
-
-                        if (doWrite)
-                            child = writeNode(t, std::move(child));
-
-                        node->shareChild(branch, child);
+                        // this leaf is flushed along with its siblings
+                        ready.emplace_back(branch, std::move(child));
                     }
                 }
             }
         }
 
-        // update the hash of this inner node
-        node->updateHashDeep();
-
-        // This inner node can now be shared
-        node->unshare();
-
-        if (doWrite)
-            node = std::static_pointer_cast<SHAMapInnerNode>(
-                writeNode(t, std::move(node)));
-
-        ++flushed;
+        // update the hashes of this node's ready children, which can
+        // now be shared, and hook them to this node
+        assert(node->cowid() == cowid_);
+        flushed += flushReady(*node, ready, start, doWrite, t);
 
         if (stack.empty())
             break;
 
-        auto parent = std::move(stack.top().first);
-        pos = stack.top().second;
+        auto [parent, branch, parentStart] = std::move(stack.top());
         stack.pop();
 
-        // Hook this inner node to its parent
-        assert(parent->cowid() == cowid_);
-        parent->shareChild(pos, node);
+        // This inner node is ready once its parent has been walked
+        ready.emplace_back(branch, std::move(node));
 
         // Continue with parent's next child, if any
         node = std::move(parent);
-        ++pos;
+        pos = branch + 1;
+        start = parentStart;
     }
 
-    // Last inner node is the new root_
-    root_ = std::move(node);
+    // update the hash of this inner node
+    node->updateHashDeep();
+
+    // This inner node can now be shared
+    node->unshare();
+
+    if (doWrite)
+        node = std::static_pointer_cast<SHAMapInnerNode>(
+            writeNode(t, std::move(node)));
+
+    ++flushed;
+
+    return node;
+}
+
+int
+SHAMap::flushReady(
+    SHAMapInnerNode& parent,
+    std::vector<std::pair<int, std::shared_ptr<SHAMapTreeNode>>>& ready,
+    std::size_t start,
+    bool doWrite,
+    NodeObjectType t) const
+{
+    auto const count = ready.size() - start;
+    if (count == 0)
+        return 0;
+
+    std::array<SHAMapTreeNode*, branchFactor> nodes;
+    for (std::size_t i = 0; i < count; ++i)
+        nodes[i] = ready[start + i].second.get();
+    SHAMapTreeNode::updateHashes(nodes.data(), count);
+
+    for (std::size_t i = start; i < ready.size(); ++i)
+    {
+        auto& [branch, child] = ready[i];
+        child->unshare();
+
+        if (doWrite)
+            child = writeNode(t, std::move(child));
+
+        parent.shareChild(branch, child);
+    }
+
+    ready.resize(start);
+    return count;
+}
+
+int
+SHAMap::flushBranches(
+    SHAMapInnerNode& node,
+    bool doWrite,
+    NodeObjectType t,
+    int threads) const
+{
+    // Below this many dirty branches the threads cost more than they save
+    std::size_t constexpr parallelFlushMin = 4;
+
+    std::vector<std::pair<int, std::shared_ptr<SHAMapInnerNode>>> branches;
+    for (int branch = 0; branch < branchFactor; ++branch)
+    {
+        if (node.isEmptyBranch(branch))
+            continue;
+
+        auto child = node.getChild(branch);
+        if (child && child->cowid() != 0 && child->isInner())
+            branches.emplace_back(
+                branch, std::static_pointer_cast<SHAMapInnerNode>(child));
+    }
+
+    if (branches.size() < parallelFlushMin)
+        return 0;
+
+    // The branches are spread over at most `threads` threads
+    std::atomic<int> flushed{0};
+    f_.workers().run(
+        branches.size(),
+        [&](std::size_t i) {
+            auto& child{branches[i].second};
+            int n = 0;
+            child = flushSubTree(preFlushNode(std::move(child)), doWrite, t, n);
+            flushed += n;
+        },
+        (branches.size() + threads - 1) / threads);
+
+    // The root is hashed once its flushed children are linked in
+    assert(node.cowid() == cowid_);
+    for (auto const& [branch, child] : branches)
+        node.shareChild(branch, child);
 
     return flushed;
 }
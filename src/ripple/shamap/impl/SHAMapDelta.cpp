@@ -18,8 +18,15 @@
 //==============================================================================
 
 #include <ripple/basics/contract.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/shamap/SHAMap.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
 namespace ripple {
 
 // This code is used to compare another node's transaction tree
@@ -33,7 +40,7 @@ namespace ripple {
 bool
 SHAMap::walkBranch(
     SHAMapTreeNode* node,
-    std::shared_ptr<SHAMapItem const> const& otherMapItem,
+    boost::intrusive_ptr<SHAMapItem const> const& otherMapItem,
     bool isFirstMap,
     Delta& differences,
     int& maxCount) const
@@ -69,16 +76,18 @@ SHAMap::walkBranch(
                 if (isFirstMap)
                     differences.insert(std::make_pair(
                         item->key(),
-                        DeltaRef(item, std::shared_ptr<SHAMapItem const>())));
+                        DeltaRef(
+                            item, boost::intrusive_ptr<SHAMapItem const>())));
                 else
                     differences.insert(std::make_pair(
                         item->key(),
-                        DeltaRef(std::shared_ptr<SHAMapItem const>(), item)));
+                        DeltaRef(
+                            boost::intrusive_ptr<SHAMapItem const>(), item)));
 
                 if (--maxCount <= 0)
                     return false;
             }
-            else if (item->peekData() != otherMapItem->peekData())
+            else if (item->slice() != otherMapItem->slice())
             {
                 // non-matching items with same tag
                 if (isFirstMap)
@@ -107,11 +116,13 @@ SHAMap::walkBranch(
         if (isFirstMap)  // this is first map, so other item is from second
             differences.insert(std::make_pair(
                 otherMapItem->key(),
-                DeltaRef(std::shared_ptr<SHAMapItem const>(), otherMapItem)));
+                DeltaRef(
+                    boost::intrusive_ptr<SHAMapItem const>(), otherMapItem)));
         else
             differences.insert(std::make_pair(
                 otherMapItem->key(),
-                DeltaRef(otherMapItem, std::shared_ptr<SHAMapItem const>())));
+                DeltaRef(
+                    otherMapItem, boost::intrusive_ptr<SHAMapItem const>())));
 
         if (--maxCount <= 0)
             return false;
@@ -121,7 +132,11 @@ SHAMap::walkBranch(
 }
 
 bool
-SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
+SHAMap::compare(
+    SHAMap const& otherMap,
+    Delta& differences,
+    int maxCount,
+    int threads) const
 {
     // compare two hash trees, add up to maxCount differences to the difference
     // table return value: true=complete table of differences given, false=too
@@ -133,11 +148,26 @@ SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
     if (getHash() == otherMap.getHash())
         return true;
 
+    if (threads > 1 && root_->isInner() && otherMap.root_->isInner())
+        return compareBranches(otherMap, differences, maxCount, threads);
+
+    return compareNodes(
+        root_.get(), otherMap.root_.get(), otherMap, differences, maxCount);
+}
+
+bool
+SHAMap::compareNodes(
+    SHAMapTreeNode* ourRoot,
+    SHAMapTreeNode* otherRoot,
+    SHAMap const& otherMap,
+    Delta& differences,
+    int& maxCount) const
+{
     using StackEntry = std::pair<SHAMapTreeNode*, SHAMapTreeNode*>;
     std::stack<StackEntry, std::vector<StackEntry>>
         nodeStack;  // track nodes we've pushed
 
-    nodeStack.push({root_.get(), otherMap.root_.get()});
+    nodeStack.push({ourRoot, otherRoot});
     while (!nodeStack.empty())
     {
         auto [ourNode, otherNode] = nodeStack.top();
@@ -156,8 +186,7 @@ SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
             auto other = static_cast<SHAMapLeafNode*>(otherNode);
             if (ours->peekItem()->key() == other->peekItem()->key())
             {
-                if (ours->peekItem()->peekData() !=
-                    other->peekItem()->peekData())
+                if (ours->peekItem()->slice() != other->peekItem()->slice())
                 {
                     differences.insert(std::make_pair(
                         ours->peekItem()->key(),
@@ -172,14 +201,14 @@ SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
                     ours->peekItem()->key(),
                     DeltaRef(
                         ours->peekItem(),
-                        std::shared_ptr<SHAMapItem const>())));
+                        boost::intrusive_ptr<SHAMapItem const>())));
                 if (--maxCount <= 0)
                     return false;
 
                 differences.insert(std::make_pair(
                     other->peekItem()->key(),
                     DeltaRef(
-                        std::shared_ptr<SHAMapItem const>(),
+                        boost::intrusive_ptr<SHAMapItem const>(),
                         other->peekItem())));
                 if (--maxCount <= 0)
                     return false;
@@ -214,7 +243,7 @@ SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
                         SHAMapTreeNode* iNode = descendThrow(ours, i);
                         if (!walkBranch(
                                 iNode,
-                                std::shared_ptr<SHAMapItem const>(),
+                                boost::intrusive_ptr<SHAMapItem const>(),
                                 true,
                                 differences,
                                 maxCount))
@@ -226,7 +255,7 @@ SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
                         SHAMapTreeNode* iNode = otherMap.descendThrow(other, i);
                         if (!otherMap.walkBranch(
                                 iNode,
-                                std::shared_ptr<SHAMapItem const>(),
+                                boost::intrusive_ptr<SHAMapItem const>(),
                                 false,
                                 differences,
                                 maxCount))
@@ -245,13 +274,113 @@ SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
     return true;
 }
 
+bool
+SHAMap::compareBranches(
+    SHAMap const& otherMap,
+    Delta& differences,
+    int maxCount,
+    int threads) const
+{
+    auto ours = static_cast<SHAMapInnerNode*>(root_.get());
+    auto other = static_cast<SHAMapInnerNode*>(otherMap.root_.get());
+
+    // The differences found below one branch of the roots
+    struct Branch
+    {
+        int branch;
+        Delta differences;
+        bool complete = true;
+    };
+
+    std::vector<Branch> branches;
+    for (int i = 0; i < branchFactor; ++i)
+    {
+        if (ours->getChildHash(i) != other->getChildHash(i))
+            branches.push_back({i});
+    }
+
+    // The branches are spread over at most `threads` threads
+    std::atomic<bool> stop{false};
+    f_.workers().run(
+        branches.size(),
+        [&](std::size_t i) {
+            if (stop)
+                return;
+
+            auto& [branch, found, complete] = branches[i];
+
+            // Each branch may find as many differences as the whole map;
+            // the merge below trims the total.
+            int count = maxCount;
+
+            if (other->isEmptyBranch(branch))
+            {
+                complete = walkBranch(
+                    descendThrow(ours, branch),
+                    boost::intrusive_ptr<SHAMapItem const>(),
+                    true,
+                    found,
+                    count);
+            }
+            else if (ours->isEmptyBranch(branch))
+            {
+                complete = otherMap.walkBranch(
+                    otherMap.descendThrow(other, branch),
+                    boost::intrusive_ptr<SHAMapItem const>(),
+                    false,
+                    found,
+                    count);
+            }
+            else
+            {
+                complete = compareNodes(
+                    descendThrow(ours, branch),
+                    otherMap.descendThrow(other, branch),
+                    otherMap,
+                    found,
+                    count);
+            }
+
+            // Too many differences in one branch are too many overall
+            if (!complete)
+                stop = true;
+        },
+        (branches.size() + threads - 1) / threads);
+
+    // Merge the branches in order, stopping at maxCount as the serial
+    // comparison does
+    for (auto& branch : branches)
+    {
+        for (auto& difference : branch.differences)
+        {
+            differences.insert(std::move(difference));
+            if (--maxCount <= 0)
+                return false;
+        }
+
+        if (!branch.complete)
+            return false;
+    }
+
+    return true;
+}
+
 void
-SHAMap::walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing)
-    const
+SHAMap::walkMap(
+    std::vector<SHAMapMissingNode>& missingNodes,
+    int maxMissing,
+    std::size_t nodesPerSecond) const
 {
     if (!root_->isInner())  // root_ is only node, and we have it
         return;
 
+    if (auto const threads = backed_ ? f_.db().walkThreads() : 1;
+        threads > 1 || nodesPerSecond != 0)
+    {
+        walkMapParallel(missingNodes, maxMissing, threads, nodesPerSecond);
+        return;
+    }
+
     using StackEntry = std::shared_ptr<SHAMapInnerNode>;
     std::stack<StackEntry, std::vector<StackEntry>> nodeStack;
 
@@ -287,4 +416,90 @@ SHAMap::walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing)
     }
 }
 
+void
+SHAMap::walkMapParallel(
+    std::vector<SHAMapMissingNode>& missingNodes,
+    int maxMissing,
+    int threads,
+    std::size_t nodesPerSecond) const
+{
+    using namespace std::chrono;
+
+    std::atomic<bool> stop{false};
+
+    // Every thread reports the nodes it can't find here
+    std::mutex missingMutex;
+    auto missing = [&](SHAMapHash const& hash) {
+        std::lock_guard lock(missingMutex);
+        if (maxMissing <= 0)
+            return;
+        missingNodes.emplace_back(type_, hash);
+        if (--maxMissing <= 0)
+            stop = true;
+    };
+
+    // Holds the threads, together, to the requested rate
+    auto const start = steady_clock::now();
+    std::atomic<std::uint64_t> visited{0};
+    auto pace = [&](std::uint64_t count) {
+        if (nodesPerSecond == 0 || count == 0)
+            return;
+        auto const due = start +
+            duration_cast<steady_clock::duration>(duration<double>(
+                static_cast<double>(visited += count) / nodesPerSecond));
+        if (due > steady_clock::now())
+            std::this_thread::sleep_until(due);
+    };
+
+    // Visit the children of an inner node, keeping the inner ones. A
+    // missing child is reported rather than thrown, so that one walk can
+    // find many.
+    using Inner = std::shared_ptr<SHAMapInnerNode>;
+    auto visit = [&](SHAMapInnerNode& node, std::vector<Inner>& inner) {
+        std::uint64_t count = 0;
+        for (int i = 0; i < branchFactor && !stop; ++i)
+        {
+            if (node.isEmptyBranch(i))
+                continue;
+
+            auto child = node.getChild(i);
+            if (!child && backed_)
+                child = fetchNodeNT(node.getChildHash(i));
+            ++count;
+
+            if (!child)
+                missing(node.getChildHash(i));
+            else if (child->isInner())
+                inner.push_back(std::static_pointer_cast<SHAMapInnerNode>(
+                    std::move(child)));
+        }
+        return count;
+    };
+
+    // Share out subtrees from far enough down that every thread has
+    // plenty to do, even when the top of the tree is lopsided
+    std::vector<Inner> work{std::static_pointer_cast<SHAMapInnerNode>(root_)};
+    while (!stop && !work.empty() &&
+           work.size() < static_cast<std::size_t>(threads) * branchFactor)
+    {
+        std::vector<Inner> below;
+        for (auto const& node : work)
+            pace(visit(*node, below));
+        work = std::move(below);
+    }
+
+    f_.workers().run(
+        work.size(),
+        [&](std::size_t i) {
+            std::vector<Inner> stack{work[i]};
+            while (!stack.empty() && !stop)
+            {
+                auto node = std::move(stack.back());
+                stack.pop_back();
+                pace(visit(*node, stack));
+            }
+        },
+        (work.size() + threads - 1) / threads);
+}
+
 }  // namespace ripple
@@ -40,8 +40,6 @@
 
 namespace ripple {
 
-std::mutex SHAMapInnerNode::childLock;
-
 SHAMapInnerNode::SHAMapInnerNode(
     std::uint32_t cowid,
     std::uint8_t numAllocatedChildren)
@@ -79,11 +77,13 @@ SHAMapInnerNode::getChildIndex(int i) const
 }
 
 std::shared_ptr<SHAMapTreeNode>
-SHAMapInnerNode::clone(std::uint32_t cowid) const
+SHAMapInnerNode::clone(
+    std::uint32_t cowid,
+    std::shared_ptr<SHAMapNodeArena> const& arena) const
 {
     auto const branchCount = getBranchCount();
     auto const thisIsSparse = !hashesAndChildren_.isDense();
-    auto p = std::make_shared<SHAMapInnerNode>(cowid, branchCount);
+    auto p = makeSHAMapNodeIn<SHAMapInnerNode>(arena, cowid, branchCount);
     p->hash_ = hash_;
     p->isBranch_ = isBranch_;
     p->fullBelowGen_ = fullBelowGen_;
@@ -108,7 +108,9 @@ SHAMapInnerNode::clone(std::uint32_t cowid) const
             cloneHashes[branchNum] = thisHashes[indexNum];
         });
     }
-    std::lock_guard lock(childLock);
+    spinlock sl(lock_);
+    std::lock_guard lock(sl);
+
     if (thisIsSparse)
     {
         int cloneChildIndex = 0;
@@ -135,7 +137,7 @@ SHAMapInnerNode::makeFullInner(
     if (data.size() != 512)
         Throw<std::runtime_error>("Invalid FI node");
 
-    auto ret = std::make_shared<SHAMapInnerNode>(0, branchFactor);
+    auto ret = makeSHAMapNode<SHAMapInnerNode>(0, branchFactor);
 
     Serializer s(data.data(), data.size());
 
@@ -164,7 +166,7 @@ SHAMapInnerNode::makeCompressedInner(Slice data)
 
     int len = s.getLength();
 
-    auto ret = std::make_shared<SHAMapInnerNode>(0, branchFactor);
+    auto ret = makeSHAMapNode<SHAMapInnerNode>(0, branchFactor);
 
     auto retHashes = ret->hashesAndChildren_.getHashes();
     for (int i = 0; i < (len / 33); ++i)
@@ -207,6 +209,13 @@ SHAMapInnerNode::updateHash()
 
 void
 SHAMapInnerNode::updateHashDeep()
+{
+    updateChildHashes();
+    updateHash();
+}
+
+void
+SHAMapInnerNode::updateChildHashes()
 {
     SHAMapHash* hashes;
     std::shared_ptr<SHAMapTreeNode>* children;
@@ -217,7 +226,6 @@ SHAMapInnerNode::updateHashDeep()
         if (children[indexNum] != nullptr)
             hashes[indexNum] = children[indexNum]->getHash();
     });
-    updateHash();
 }
 
 void
@@ -335,8 +343,11 @@ SHAMapInnerNode::getChildPointer(int branch)
     assert(branch >= 0 && branch < branchFactor);
     assert(!isEmptyBranch(branch));
 
-    std::lock_guard lock(childLock);
-    return hashesAndChildren_.getChildren()[*getChildIndex(branch)].get();
+    auto const index = *getChildIndex(branch);
+
+    packed_spinlock sl(lock_, index);
+    std::lock_guard lock(sl);
+    return hashesAndChildren_.getChildren()[index].get();
 }
 
 std::shared_ptr<SHAMapTreeNode>
@@ -345,8 +356,11 @@ SHAMapInnerNode::getChild(int branch)
     assert(branch >= 0 && branch < branchFactor);
     assert(!isEmptyBranch(branch));
 
-    std::lock_guard lock(childLock);
-    return hashesAndChildren_.getChildren()[*getChildIndex(branch)];
+    auto const index = *getChildIndex(branch);
+
+    packed_spinlock sl(lock_, index);
+    std::lock_guard lock(sl);
+    return hashesAndChildren_.getChildren()[index];
 }
 
 SHAMapHash const&
@@ -371,7 +385,9 @@ SHAMapInnerNode::canonicalizeChild(
     auto [_, hashes, children] = hashesAndChildren_.getHashesAndChildren();
     assert(node->getHash() == hashes[childIndex]);
 
-    std::lock_guard lock(childLock);
+    packed_spinlock sl(lock_, childIndex);
+    std::lock_guard lock(sl);
+
     if (children[childIndex])
     {
         // There is already a node hooked up, return it
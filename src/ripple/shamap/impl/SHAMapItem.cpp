@@ -17,26 +17,86 @@
 */
 //==============================================================================
 
-#include <ripple/protocol/Serializer.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/basics/MemoryArena.h>
+#include <ripple/basics/SlabAllocator.h>
 #include <ripple/shamap/SHAMapItem.h>
 
+#include <cassert>
+#include <cstring>
+#include <new>
+
 namespace ripple {
 
-class SHAMap;
+namespace {
 
-SHAMapItem::SHAMapItem(uint256 const& tag, Blob const& data)
-    : tag_(tag), data_(data)
+// The size classes of the slabs, by the number of bytes that follow the
+// item. They cover the serialized sizes of nearly all ledger entries and
+// transactions; larger items are allocated individually.
+//
+// The set is never destroyed, so that items released while static
+// objects are being destroyed can still be returned to it.
+SlabAllocatorSet<SHAMapItem>&
+slabber()
 {
+    static auto* const slabs = new SlabAllocatorSet<SHAMapItem>({
+        {128, megabytes(std::size_t(60))},
+        {192, megabytes(std::size_t(46))},
+        {272, megabytes(std::size_t(60))},
+        {384, megabytes(std::size_t(56))},
+        {564, megabytes(std::size_t(68))},
+        {772, megabytes(std::size_t(46))},
+        {1052, megabytes(std::size_t(60))},
+    });
+
+    return *slabs;
 }
 
-SHAMapItem::SHAMapItem(uint256 const& tag, const Serializer& data)
-    : tag_(tag), data_(data.peekData())
+}  // namespace
+
+SHAMapItem::SHAMapItem(uint256 const& tag, Slice data)
+    : tag_(tag), size_(static_cast<std::uint32_t>(data.size()))
 {
+    if (!data.empty())
+        std::memcpy(
+            reinterpret_cast<std::uint8_t*>(this) + sizeof(*this),
+            data.data(),
+            data.size());
 }
 
-SHAMapItem::SHAMapItem(uint256 const& tag, Serializer&& data)
-    : tag_(tag), data_(std::move(data.modData()))
+boost::intrusive_ptr<SHAMapItem>
+make_shamapitem(uint256 const& tag, Slice data)
 {
+    assert(data.size() <= megabytes<std::size_t>(16));
+
+    std::uint8_t* raw = slabber().allocate(data.size());
+
+    // If we can't grab memory from the slab allocators, we fall back to
+    // the shamap arena and try to grab a precisely-sized memory block:
+    if (raw == nullptr)
+        raw = static_cast<std::uint8_t*>(arenaAllocate(
+            MemoryArena::shamap, sizeof(SHAMapItem) + data.size()));
+
+    // We do not increment the reference count here on purpose: the
+    // constructor of SHAMapItem explicitly sets it to 1. We use the fact
+    // that the placement new will never throw.
+    return {new (raw) SHAMapItem{tag, data}, false};
+}
+
+void
+intrusive_ptr_release(SHAMapItem const* x)
+{
+    if (x->refcount_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        auto p = reinterpret_cast<std::uint8_t*>(const_cast<SHAMapItem*>(x));
+        auto const bytes = sizeof(SHAMapItem) + x->size();
+
+        x->~SHAMapItem();
+
+        // If the slabs don't claim this pointer, it came from the arena.
+        if (!slabber().deallocate(p))
+            arenaDeallocate(MemoryArena::shamap, p, bytes);
+    }
 }
 
 }  // namespace ripple
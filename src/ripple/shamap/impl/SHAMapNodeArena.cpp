@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/MemoryArena.h>
+#include <ripple/shamap/SHAMapNodeArena.h>
+#include <cassert>
+#include <cstdint>
+
+namespace ripple {
+
+SHAMapNodeArena::~SHAMapNodeArena()
+{
+    // Every node holds the arena, so none can be left
+    assert(used_ == 0);
+    for (auto const& [block, bytes] : blocks_)
+        arenaDeallocate(MemoryArena::shamap, block, bytes);
+}
+
+void*
+SHAMapNodeArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    assert(alignment <= alignof(std::max_align_t));
+
+    std::lock_guard lock(mutex_);
+
+    if (bytes > blockBytes / 4)
+    {
+        auto p = arenaAllocate(MemoryArena::shamap, bytes);
+        blocks_.emplace_back(p, bytes);
+        used_ += bytes;
+        return p;
+    }
+
+    auto align = [alignment](char* p) {
+        auto const a = reinterpret_cast<std::uintptr_t>(p);
+        return p + (alignment - a % alignment) % alignment;
+    };
+
+    char* p = next_ ? align(next_) : nullptr;
+    if (!p || p + bytes > end_)
+    {
+        next_ = static_cast<char*>(
+            arenaAllocate(MemoryArena::shamap, blockBytes));
+        end_ = next_ + blockBytes;
+        blocks_.emplace_back(next_, blockBytes);
+        p = align(next_);
+    }
+
+    next_ = p + bytes;
+    used_ += bytes;
+    return p;
+}
+
+void
+SHAMapNodeArena::deallocate(void*, std::size_t bytes) noexcept
+{
+    // The memory is only returned with the blocks
+    used_ -= bytes;
+}
+
+std::size_t
+SHAMapNodeArena::reserved() const
+{
+    std::lock_guard lock(mutex_);
+    std::size_t bytes = 0;
+    for (auto const& block : blocks_)
+        bytes += block.second;
+    return bytes;
+}
+
+}  // namespace ripple
@@ -0,0 +1,194 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/shamap/SHAMapSnapshot.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fstream>
+#include <iterator>
+
+namespace ripple {
+
+// The file starts with a header:
+//
+//  magic       4 bytes
+//  version     4 bytes
+//  ledgerSeq   4 bytes
+//  rootHash   32 bytes
+//
+// followed by one record per node: its size in 4 bytes, then the node in
+// its prefix format. Integers are big endian, as Serializer writes them.
+static constexpr std::uint32_t snapshotMagic = 0x534E4150;  // "SNAP"
+static constexpr std::uint32_t snapshotVersion = 1;
+static constexpr std::size_t snapshotHeaderSize = 44;
+
+SHAMapSnapshot::SHAMapSnapshot(boost::filesystem::path path, beast::Journal j)
+    : path_(std::move(path)), j_(j)
+{
+}
+
+std::size_t
+SHAMapSnapshot::write(
+    SHAMap const& map,
+    std::uint32_t ledgerSeq,
+    std::size_t maxNodes) const
+{
+    std::lock_guard lock(writeMutex_);
+
+    auto const temp = path_.string() + ".tmp";
+    std::size_t count = 0;
+
+    try
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            Throw<std::runtime_error>("unable to create " + temp);
+
+        Serializer s;
+        s.add32(snapshotMagic);
+        s.add32(snapshotVersion);
+        s.add32(ledgerSeq);
+        s.addBitString(map.getHash().as_uint256());
+        out.write(reinterpret_cast<char const*>(s.data()), s.size());
+
+        Serializer node;
+        map.visitResident([&](SHAMapTreeNode const& n) {
+            node.erase();
+            n.serializeWithPrefix(node);
+
+            s.erase();
+            s.add32(node.size());
+            out.write(reinterpret_cast<char const*>(s.data()), s.size());
+            out.write(reinterpret_cast<char const*>(node.data()), node.size());
+
+            return ++count < maxNodes && out.good();
+        });
+
+        out.close();
+        if (!out)
+            Throw<std::runtime_error>("unable to write " + temp);
+
+        boost::filesystem::rename(temp, path_);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.warn()) << "Unable to write snapshot " << path_.string()
+                        << ": " << e.what();
+
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp, ec);
+        return 0;
+    }
+
+    JLOG(j_.info()) << "Wrote " << count << " nodes of ledger " << ledgerSeq
+                    << " to snapshot " << path_.string();
+    return count;
+}
+
+std::size_t
+SHAMapSnapshot::load(Family& family)
+{
+    namespace bip = boost::interprocess;
+
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(path_, ec))
+    {
+        JLOG(j_.debug()) << "No snapshot at " << path_.string();
+        return 0;
+    }
+
+    std::vector<std::shared_ptr<SHAMapTreeNode>> loaded;
+    std::uint32_t ledgerSeq = 0;
+
+    try
+    {
+        bip::file_mapping file(path_.string().c_str(), bip::read_only);
+        bip::mapped_region region(file, bip::read_only);
+        region.advise(bip::mapped_region::advice_sequential);
+
+        Slice data(region.get_address(), region.get_size());
+        if (data.size() < snapshotHeaderSize)
+            Throw<std::runtime_error>("too short");
+
+        SerialIter sit(data.data(), snapshotHeaderSize);
+        if (sit.get32() != snapshotMagic)
+            Throw<std::runtime_error>("not a snapshot");
+        if (auto const version = sit.get32(); version != snapshotVersion)
+            Throw<std::runtime_error>(
+                "unknown version " + std::to_string(version));
+        ledgerSeq = sit.get32();
+        data += snapshotHeaderSize;
+
+        auto const cache = family.getTreeNodeCache(ledgerSeq);
+
+        while (data.size() >= 4)
+        {
+            std::uint32_t const size = SerialIter(data.data(), 4).get32();
+            data += 4;
+
+            // A snapshot cut short is still good up to the cut
+            if (size > data.size())
+                break;
+
+            Slice const raw(data.data(), size);
+            data += size;
+
+            SHAMapHash const hash{sha512Half(raw)};
+            auto node = SHAMapTreeNode::makeFromPrefix(raw, hash);
+            cache->canonicalize_replace_client(hash.as_uint256(), node);
+            loaded.push_back(std::move(node));
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.warn()) << "Unable to read snapshot " << path_.string()
+                        << ": " << e.what();
+    }
+
+    JLOG(j_.info()) << "Loaded " << loaded.size() << " nodes of ledger "
+                    << ledgerSeq << " from snapshot " << path_.string();
+
+    auto const count = loaded.size();
+    std::lock_guard lock(mutex_);
+    loaded_.insert(
+        loaded_.end(),
+        std::make_move_iterator(loaded.begin()),
+        std::make_move_iterator(loaded.end()));
+    return count;
+}
+
+void
+SHAMapSnapshot::release()
+{
+    std::vector<std::shared_ptr<SHAMapTreeNode>> loaded;
+    {
+        std::lock_guard lock(mutex_);
+        loaded.swap(loaded_);
+    }
+    if (!loaded.empty())
+    {
+        JLOG(j_.debug()) << "Released " << loaded.size()
+                         << " nodes loaded from snapshot";
+    }
+}
+
+}  // namespace ripple
@@ -18,15 +18,21 @@
 //==============================================================================
 
 #include <ripple/basics/random.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapSyncFilter.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <queue>
+
 namespace ripple {
 
 void
 SHAMap::visitLeaves(
-    std::function<void(std::shared_ptr<SHAMapItem const> const& item)> const&
-        leafFunction) const
+    std::function<void(boost::intrusive_ptr<SHAMapItem const> const& item)>
+        const& leafFunction) const
 {
     visitNodes([&leafFunction](SHAMapTreeNode& node) {
         if (!node.isInner())
@@ -97,6 +103,39 @@ SHAMap::visitNodes(std::function<bool(SHAMapTreeNode&)> const& function) const
     }
 }
 
+void
+SHAMap::visitResident(
+    std::function<bool(SHAMapTreeNode const&)> const& function) const
+{
+    if (!root_ || !function(*root_) || !root_->isInner())
+        return;
+
+    std::queue<std::shared_ptr<SHAMapInnerNode>> queue;
+    queue.push(std::static_pointer_cast<SHAMapInnerNode>(root_));
+
+    while (!queue.empty())
+    {
+        auto const node = std::move(queue.front());
+        queue.pop();
+
+        for (int branch = 0; branch < branchFactor; ++branch)
+        {
+            if (node->isEmptyBranch(branch))
+                continue;
+
+            auto child = node->getChild(branch);
+            if (!child)
+                continue;
+
+            if (!function(*child))
+                return;
+
+            if (child->isInner())
+                queue.push(std::static_pointer_cast<SHAMapInnerNode>(child));
+        }
+    }
+}
+
 void
 SHAMap::visitDifferences(
     SHAMap const* have,
@@ -184,6 +223,7 @@ SHAMap::gmn_ProcessNodes(MissingNodes& mn, MissingNodes::StackEntry& se)
         if (node->isEmptyBranch(branch))
             continue;
 
+        ++mn.visited_;
         auto const& childHash = node->getChildHash(branch);
 
         if (mn.missingHashes_.count(childHash) != 0)
@@ -260,14 +300,13 @@ SHAMap::gmn_ProcessNodes(MissingNodes& mn, MissingNodes::StackEntry& se)
     node = nullptr;
 }
 
-// Wait for deferred reads to finish and
-// process their results
+// Wait for deferred reads to finish and process their
+// results, until no more than the given number are outstanding
 void
-SHAMap::gmn_ProcessDeferredReads(MissingNodes& mn)
+SHAMap::gmn_ProcessDeferredReads(MissingNodes& mn, int outstanding)
 {
-    // Process all deferred reads
     int complete = 0;
-    while (complete != mn.deferred_)
+    while (mn.deferred_ - complete > outstanding)
     {
         std::tuple<
             SHAMapInnerNode*,
@@ -278,8 +317,13 @@ SHAMap::gmn_ProcessDeferredReads(MissingNodes& mn)
         {
             std::unique_lock<std::mutex> lock{mn.deferLock_};
 
-            while (mn.finishedReads_.size() <= complete)
-                mn.deferCondVar_.wait(lock);
+            if (mn.finishedReads_.size() <= complete)
+            {
+                auto const start = std::chrono::steady_clock::now();
+                while (mn.finishedReads_.size() <= complete)
+                    mn.deferCondVar_.wait(lock);
+                mn.waited_ += std::chrono::steady_clock::now() - start;
+            }
             deferredNode = std::move(mn.finishedReads_[complete++]);
         }
 
@@ -305,46 +349,18 @@ SHAMap::gmn_ProcessDeferredReads(MissingNodes& mn)
         }
     }
 
-    mn.finishedReads_.clear();
-    mn.deferred_ = 0;
+    // Reads still outstanding complete behind the ones we processed
+    std::lock_guard lock{mn.deferLock_};
+    mn.finishedReads_.erase(
+        mn.finishedReads_.begin(), mn.finishedReads_.begin() + complete);
+    mn.deferred_ -= complete;
 }
 
-/** Get a list of node IDs and hashes for nodes that are part of this SHAMap
-    but not available locally.  The filter can hold alternate sources of
-    nodes that are not permanently stored locally
-*/
-std::vector<std::pair<SHAMapNodeID, uint256>>
-SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
+// Traverse the map from the specified StackEntry, posting
+// deferred reads and processing them as they complete
+void
+SHAMap::gmn_Traverse(MissingNodes& mn, MissingNodes::StackEntry pos)
 {
-    assert(root_->getHash().isNonZero());
-    assert(max > 0);
-
-    MissingNodes mn(
-        max,
-        filter,
-        4096,  // number of async reads per pass
-        f_.getFullBelowCache(ledgerSeq_)->getGeneration());
-
-    if (!root_->isInner() ||
-        std::static_pointer_cast<SHAMapInnerNode>(root_)->isFullBelow(
-            mn.generation_))
-    {
-        clearSynching();
-        return std::move(mn.missingNodes_);
-    }
-
-    // Start at the root.
-    // The firstChild value is selected randomly so if multiple threads
-    // are traversing the map, each thread will start at a different
-    // (randomly selected) inner node.  This increases the likelihood
-    // that the two threads will produce different request sets (which is
-    // more efficient than sending identical requests).
-    MissingNodes::StackEntry pos{
-        static_cast<SHAMapInnerNode*>(root_.get()),
-        SHAMapNodeID(),
-        rand_int(255),
-        0,
-        true};
     auto& node = std::get<0>(pos);
     auto& nextChild = std::get<3>(pos);
     auto& fullBelow = std::get<4>(pos);
@@ -380,13 +396,21 @@ SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
             }
         }
 
-        // We have either emptied the stack or
-        // posted as many deferred reads as we can
+        // We have either emptied the stack or posted as many deferred
+        // reads as we can. While there is more to traverse, only wait
+        // for half of them so that the read queue never runs dry.
         if (mn.deferred_)
-            gmn_ProcessDeferredReads(mn);
+        {
+            bool const more = (node != nullptr) || !mn.stack_.empty();
+            gmn_ProcessDeferredReads(mn, more ? mn.maxDefer_ / 2 : 0);
+        }
 
         if (mn.max_ <= 0)
-            return std::move(mn.missingNodes_);
+        {
+            // Don't leave reads referring to mn behind
+            gmn_ProcessDeferredReads(mn);
+            return;
+        }
 
         if (node == nullptr)
         {  // We weren't in the middle of processing a node
@@ -416,6 +440,214 @@ SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
         // and we have no nodes to resume
 
     } while (node != nullptr);
+}
+
+// Resolve the children of the root on this thread, then
+// traverse the subtrees below them on several threads
+void
+SHAMap::gmn_TraverseParallel(MissingNodes& mn, int threads)
+{
+    auto root = static_cast<SHAMapInnerNode*>(root_.get());
+    SHAMapNodeID const rootID;
+
+    for (int branch = 0; branch < branchFactor; ++branch)
+    {
+        if (root->isEmptyBranch(branch))
+            continue;
+
+        ++mn.visited_;
+        auto const& childHash = root->getChildHash(branch);
+
+        if (backed_ &&
+            f_.getFullBelowCache(ledgerSeq_)
+                ->touch_if_exists(childHash.as_uint256()))
+            continue;
+
+        bool pending = false;
+        auto d = descendAsync(
+            root,
+            branch,
+            mn.filter_,
+            pending,
+            [root, rootID, branch, &mn](
+                std::shared_ptr<SHAMapTreeNode> found, SHAMapHash const&) {
+                // a read completed asynchronously
+                std::unique_lock<std::mutex> lock{mn.deferLock_};
+                mn.finishedReads_.emplace_back(
+                    root, rootID, branch, std::move(found));
+                mn.deferCondVar_.notify_one();
+            });
+
+        if (pending)
+        {
+            ++mn.deferred_;
+        }
+        else if (!d)
+        {
+            mn.missingHashes_.insert(childHash);
+            mn.missingNodes_.emplace_back(
+                rootID.getChildNodeID(branch), childHash.as_uint256());
+
+            if (--mn.max_ <= 0)
+                break;
+        }
+    }
+
+    gmn_ProcessDeferredReads(mn);
+    mn.resumes_.clear();
+    if (mn.max_ <= 0)
+        return;
+
+    // Every child of the root that is not yet known to be full
+    // below is the start of a subtree for a worker to traverse
+    std::vector<MissingNodes::StackEntry> subtrees;
+    for (int branch = 0; branch < branchFactor; ++branch)
+    {
+        if (root->isEmptyBranch(branch))
+            continue;
+
+        auto child = root->getChildPointer(branch);
+        if (child && child->isInner() &&
+            !static_cast<SHAMapInnerNode*>(child)->isFullBelow(
+                mn.generation_))
+        {
+            subtrees.emplace_back(
+                static_cast<SHAMapInnerNode*>(child),
+                rootID.getChildNodeID(branch),
+                rand_int(255),
+                0,
+                true);
+        }
+    }
+
+    auto const count{std::min<std::size_t>(threads, subtrees.size())};
+
+    // The workers post to the same read queue, so split the
+    // deferred reads between them
+    std::vector<std::unique_ptr<MissingNodes>> workers;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        workers.push_back(std::make_unique<MissingNodes>(
+            mn.max_,
+            mn.filter_,
+            std::max<int>(mn.maxDefer_ / count, 1),
+            mn.generation_));
+    }
+
+    // Each worker takes the next subtree left until none remain. The
+    // workers share mn.filter_ and may call it at the same time. That is
+    // safe for the filters of backed maps: they read from the fetch pack
+    // cache, which locks itself, and the pending batch they keep for the
+    // node store is guarded by a mutex.
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> stop{false};
+    f_.workers().run(count, [&](std::size_t w) {
+        auto& wmn = *workers[w];
+        for (auto i = next++; i < subtrees.size() && !stop; i = next++)
+        {
+            gmn_Traverse(wmn, subtrees[i]);
+
+            if (wmn.max_ <= 0)
+                stop = true;
+        }
+    });
+
+    // Merge what the workers found. Time spent waiting is averaged, so
+    // that it stays a fraction of the elapsed time.
+    std::chrono::steady_clock::duration waited{};
+    for (auto const& wmn : workers)
+    {
+        mn.visited_ += wmn->visited_;
+        waited += wmn->waited_;
+
+        for (auto const& missing : wmn->missingNodes_)
+        {
+            if (mn.max_ <= 0)
+                break;
+
+            if (mn.missingHashes_.insert(SHAMapHash{missing.second}).second)
+            {
+                mn.missingNodes_.push_back(missing);
+                --mn.max_;
+            }
+        }
+    }
+    if (count > 0)
+        mn.waited_ += waited / count;
+
+    // Nothing is missing below any branch: so too below the root
+    if (mn.missingNodes_.empty())
+    {
+        root->setFullBelowGen(mn.generation_);
+        if (backed_)
+        {
+            f_.getFullBelowCache(ledgerSeq_)
+                ->insert(root->getHash().as_uint256());
+        }
+    }
+}
+
+/** Get a list of node IDs and hashes for nodes that are part of this SHAMap
+    but not available locally.  The filter can hold alternate sources of
+    nodes that are not permanently stored locally
+*/
+std::vector<std::pair<SHAMapNodeID, uint256>>
+SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
+{
+    assert(root_->getHash().isNonZero());
+    assert(max > 0);
+
+    MissingNodes mn(
+        max,
+        filter,
+        4096,  // number of async reads per pass
+        f_.getFullBelowCache(ledgerSeq_)->getGeneration());
+
+    if (!root_->isInner() ||
+        std::static_pointer_cast<SHAMapInnerNode>(root_)->isFullBelow(
+            mn.generation_))
+    {
+        clearSynching();
+        return std::move(mn.missingNodes_);
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+
+    if (auto const threads = backed_ ? f_.db().syncThreads() : 1;
+        threads > 1)
+    {
+        gmn_TraverseParallel(mn, threads);
+    }
+    else
+    {
+        // Start at the root.
+        // The firstChild value is selected randomly so if multiple threads
+        // are traversing the map, each thread will start at a different
+        // (randomly selected) inner node.  This increases the likelihood
+        // that the two threads will produce different request sets (which
+        // is more efficient than sending identical requests).
+        gmn_Traverse(
+            mn,
+            {static_cast<SHAMapInnerNode*>(root_.get()),
+             SHAMapNodeID(),
+             rand_int(255),
+             0,
+             true});
+    }
+
+    if (auto stream = journal_.debug())
+    {
+        using namespace std::chrono;
+        auto const elapsed = steady_clock::now() - start;
+        auto const us = std::max<std::int64_t>(
+            duration_cast<microseconds>(elapsed).count(), 1);
+        stream << "getMissingNodes: " << mn.visited_ << " nodes in "
+               << us / 1000 << "ms (" << mn.visited_ * 1000000 / us
+               << " nodes/s), "
+               << duration_cast<microseconds>(mn.waited_).count() * 100 / us
+               << "% waiting for reads, " << mn.missingNodes_.size()
+               << " missing";
+    }
 
     if (mn.missingNodes_.empty())
         clearSynching();
@@ -540,8 +772,24 @@ SHAMap::addRootNode(
         return SHAMapAddNode::duplicate();
     }
 
+    return addRootNode(hash, SHAMapTreeNode::makeFromWire(rootNode), filter);
+}
+
+SHAMapAddNode
+SHAMap::addRootNode(
+    SHAMapHash const& hash,
+    std::shared_ptr<SHAMapTreeNode> node,
+    SHAMapSyncFilter* filter)
+{
+    // we already have a root_ node
+    if (root_->getHash().isNonZero())
+    {
+        JLOG(journal_.trace()) << "got root node, already have one";
+        assert(root_->getHash() == hash);
+        return SHAMapAddNode::duplicate();
+    }
+
     assert(cowid_ >= 1);
-    auto node = SHAMapTreeNode::makeFromWire(rootNode);
     if (!node || node->getHash() != hash)
         return SHAMapAddNode::invalid();
 
@@ -582,8 +830,24 @@ SHAMap::addKnownNode(
         return SHAMapAddNode::duplicate();
     }
 
+    return addKnownNode(node, SHAMapTreeNode::makeFromWire(rawNode), filter);
+}
+
+SHAMapAddNode
+SHAMap::addKnownNode(
+    SHAMapNodeID const& node,
+    std::shared_ptr<SHAMapTreeNode> newNode,
+    SHAMapSyncFilter* filter)
+{
+    assert(!node.isRoot());
+
+    if (!isSynching())
+    {
+        JLOG(journal_.trace()) << "AddKnownNode while not synching";
+        return SHAMapAddNode::duplicate();
+    }
+
     auto const generation = f_.getFullBelowCache(ledgerSeq_)->getGeneration();
-    auto newNode = SHAMapTreeNode::makeFromWire(rawNode);
     SHAMapNodeID iNodeID;
     auto iNode = root_.get();
 
@@ -697,7 +961,7 @@ SHAMap::deepCompare(SHAMap& other) const
                 static_cast<SHAMapLeafNode*>(otherNode)->peekItem();
             if (nodePeek->key() != otherNodePeek->key())
                 return false;
-            if (nodePeek->peekData() != otherNodePeek->peekData())
+            if (nodePeek->slice() != otherNodePeek->slice())
                 return false;
         }
         else if (node->isInner())
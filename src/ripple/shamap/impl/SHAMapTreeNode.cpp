@@ -31,6 +31,7 @@
 #include <ripple/shamap/SHAMapTxLeafNode.h>
 #include <ripple/shamap/SHAMapTxPlusMetaLeafNode.h>
 #include <mutex>
+#include <vector>
 
 #include <openssl/sha.h>
 
@@ -42,16 +43,13 @@ SHAMapTreeNode::makeTransaction(
     SHAMapHash const& hash,
     bool hashValid)
 {
-    // FIXME: using a Serializer results in a copy; avoid it?
-    Serializer s(data.begin(), data.size());
-
-    auto item = std::make_shared<SHAMapItem const>(
-        sha512Half(HashPrefix::transactionID, data), s);
+    auto item =
+        make_shamapitem(sha512Half(HashPrefix::transactionID, data), data);
 
     if (hashValid)
-        return std::make_shared<SHAMapTxLeafNode>(std::move(item), 0, hash);
+        return makeSHAMapNode<SHAMapTxLeafNode>(std::move(item), 0, hash);
 
-    return std::make_shared<SHAMapTxLeafNode>(std::move(item), 0);
+    return makeSHAMapNode<SHAMapTxLeafNode>(std::move(item), 0);
 }
 
 std::shared_ptr<SHAMapTreeNode>
@@ -60,27 +58,20 @@ SHAMapTreeNode::makeTransactionWithMeta(
     SHAMapHash const& hash,
     bool hashValid)
 {
-    Serializer s(data.data(), data.size());
-
-    uint256 tag;
-
-    if (s.size() < tag.bytes)
+    if (data.size() < uint256::bytes)
         Throw<std::runtime_error>("Short TXN+MD node");
 
-    // FIXME: improve this interface so that the above check isn't needed
-    if (!s.getBitString(tag, s.size() - tag.bytes))
-        Throw<std::out_of_range>(
-            "Short TXN+MD node (" + std::to_string(s.size()) + ")");
+    // The key follows the data
+    auto const tag = uint256::fromVoid(data.end() - uint256::bytes);
+    data.remove_suffix(uint256::bytes);
 
-    s.chop(tag.bytes);
-
-    auto item = std::make_shared<SHAMapItem const>(tag, s.peekData());
+    auto item = make_shamapitem(tag, data);
 
     if (hashValid)
-        return std::make_shared<SHAMapTxPlusMetaLeafNode>(
+        return makeSHAMapNode<SHAMapTxPlusMetaLeafNode>(
             std::move(item), 0, hash);
 
-    return std::make_shared<SHAMapTxPlusMetaLeafNode>(std::move(item), 0);
+    return makeSHAMapNode<SHAMapTxPlusMetaLeafNode>(std::move(item), 0);
 }
 
 std::shared_ptr<SHAMapTreeNode>
@@ -89,30 +80,23 @@ SHAMapTreeNode::makeAccountState(
     SHAMapHash const& hash,
     bool hashValid)
 {
-    Serializer s(data.data(), data.size());
-
-    uint256 tag;
-
-    if (s.size() < tag.bytes)
+    if (data.size() < uint256::bytes)
         Throw<std::runtime_error>("short AS node");
 
-    // FIXME: improve this interface so that the above check isn't needed
-    if (!s.getBitString(tag, s.size() - tag.bytes))
-        Throw<std::out_of_range>(
-            "Short AS node (" + std::to_string(s.size()) + ")");
-
-    s.chop(tag.bytes);
+    // The key follows the data
+    auto const tag = uint256::fromVoid(data.end() - uint256::bytes);
+    data.remove_suffix(uint256::bytes);
 
     if (tag.isZero())
         Throw<std::runtime_error>("Invalid AS node");
 
-    auto item = std::make_shared<SHAMapItem const>(tag, s.peekData());
+    auto item = make_shamapitem(tag, data);
 
     if (hashValid)
-        return std::make_shared<SHAMapAccountStateLeafNode>(
+        return makeSHAMapNode<SHAMapAccountStateLeafNode>(
             std::move(item), 0, hash);
 
-    return std::make_shared<SHAMapAccountStateLeafNode>(std::move(item), 0);
+    return makeSHAMapNode<SHAMapAccountStateLeafNode>(std::move(item), 0);
 }
 
 std::shared_ptr<SHAMapTreeNode>
@@ -183,6 +167,53 @@ SHAMapTreeNode::makeFromPrefix(Slice rawNode, SHAMapHash const& hash)
         ")");
 }
 
+void
+SHAMapTreeNode::updateHashes(SHAMapTreeNode* const* nodes, std::size_t count)
+{
+    // The hash of a node is the SHA512-Half of its prefixed serialization.
+    // Serialize them all into one buffer and hash the pieces together.
+    Serializer s;
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> hashed;
+    offsets.reserve(count + 1);
+    hashed.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto node = nodes[i];
+        if (node->isInner())
+        {
+            auto inner = static_cast<SHAMapInnerNode*>(node);
+            inner->updateChildHashes();
+
+            // An inner node with no branches hashes to zero
+            if (inner->isEmpty())
+            {
+                node->hash_ = SHAMapHash{};
+                continue;
+            }
+        }
+
+        hashed.push_back(i);
+        offsets.push_back(s.size());
+        node->serializeWithPrefix(s);
+    }
+    offsets.push_back(s.size());
+
+    auto const buffer = s.slice();
+    std::vector<Slice> messages;
+    messages.reserve(hashed.size());
+    for (std::size_t i = 0; i < hashed.size(); ++i)
+        messages.emplace_back(
+            buffer.data() + offsets[i], offsets[i + 1] - offsets[i]);
+
+    std::vector<uint256> digests(hashed.size());
+    sha512HalfBatch(messages.data(), digests.data(), hashed.size());
+
+    for (std::size_t i = 0; i < hashed.size(); ++i)
+        nodes[hashed[i]]->hash_ = SHAMapHash{digests[i]};
+}
+
 std::string
 SHAMapTreeNode::getString(const SHAMapNodeID& id) const
 {
@@ -20,6 +20,7 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/Tuning.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/shamap/ShardFamily.h>
 
@@ -103,6 +104,12 @@ ShardFamily::getTreeNodeCacheSize()
     return {cacheSz, trackSz};
 }
 
+WorkerPool&
+ShardFamily::workers()
+{
+    return app_.getWorkerPool();
+}
+
 void
 ShardFamily::sweep()
 {
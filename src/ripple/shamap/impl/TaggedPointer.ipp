@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/basics/MemoryArena.h>
 #include <ripple/shamap/impl/TaggedPointer.h>
 
 #include <ripple/shamap/SHAMapInnerNode.h>
@@ -99,7 +100,7 @@ std::array<std::function<void*()>, boundaries.size()> initAllocateArrayFuns(
         boost::singleton_pool<
             boost::fast_pool_allocator_tag,
             arrayChunkSizeBytes[I],
-            boost::default_user_allocator_new_delete,
+            ArenaPoolAllocator<MemoryArena::shamap>,
             std::mutex,
             chunksPerBlock[I],
             chunksPerBlock[I]>::malloc...,
@@ -116,7 +117,7 @@ std::array<std::function<void(void*)>, boundaries.size()> initFreeArrayFuns(
         static_cast<void (*)(void*)>(boost::singleton_pool<
                                      boost::fast_pool_allocator_tag,
                                      arrayChunkSizeBytes[I],
-                                     boost::default_user_allocator_new_delete,
+                                     ArenaPoolAllocator<MemoryArena::shamap>,
                                      std::mutex,
                                      chunksPerBlock[I],
                                      chunksPerBlock[I]>::free)...,
@@ -133,7 +134,7 @@ std::array<std::function<bool(void*)>, boundaries.size()> initIsFromArrayFuns(
         boost::singleton_pool<
             boost::fast_pool_allocator_tag,
             arrayChunkSizeBytes[I],
-            boost::default_user_allocator_new_delete,
+            ArenaPoolAllocator<MemoryArena::shamap>,
             std::mutex,
             chunksPerBlock[I],
             chunksPerBlock[I]>::is_from...,
@@ -0,0 +1,270 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/tx/applySteps.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/TxFormats.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Times the three apply stages of each kind of transaction.
+
+    The ledger holds a configurable number of funded accounts, each with a
+    trust line, an order book and the escrows, checks, channels and offers
+    the transactions act on. Every transaction is run through preflight,
+    preclaim and doApply many times, each time against a fresh copy of the
+    same open ledger, and every stage is timed on its own.
+
+    One line of compact JSON is written per transaction, so results can be
+    collected and compared from release to release. Pass the number of
+    accounts as the suite argument, for example "--unittest-arg=10000".
+*/
+class ApplyBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    // Applies of each transaction; the fastest and the mean are reported
+    static constexpr int runs = 200;
+
+    // Depth of the USD/XRP order book
+    static constexpr int bookDepth = 50;
+
+    struct Stage
+    {
+        clock::duration fastest = clock::duration::max();
+        clock::duration total{0};
+
+        void
+        add(clock::duration d)
+        {
+            fastest = std::min(fastest, d);
+            total += d;
+        }
+    };
+
+    // Funded accounts filling out the ledger
+    std::size_t accounts_ = 0;
+
+    std::size_t
+    accounts()
+    {
+        std::string const a = arg();
+        if (!a.empty())
+        {
+            if (auto const n = std::stoul(a); n > 0)
+                return n;
+        }
+        return 1000;
+    }
+
+    void
+    measure(jtx::Env& env, std::string const& name, jtx::JTx const& jt)
+    {
+        using namespace std::chrono;
+
+        auto& app = env.app();
+        auto const j = app.journal("ApplyBench");
+        auto const& tx = *jt.stx;
+
+        Stage preflightStage;
+        Stage preclaimStage;
+        Stage applyStage;
+        TER result = tesSUCCESS;
+
+        for (int run = 0; run != runs; ++run)
+        {
+            OpenView view(*env.current());
+
+            auto const start = clock::now();
+            auto const pf = preflight(app, view.rules(), tx, tapNONE, j);
+            auto const preflighted = clock::now();
+            auto const pc = preclaim(pf, app, view);
+            auto const preclaimed = clock::now();
+            auto const applied = doApply(pc, app, view);
+            auto const done = clock::now();
+
+            preflightStage.add(preflighted - start);
+            preclaimStage.add(preclaimed - preflighted);
+            applyStage.add(done - preclaimed);
+            result = applied.first;
+        }
+
+        if (!BEAST_EXPECTS(
+                isTesSuccess(result), name + ": " + transToken(result)))
+            return;
+
+        auto const format =
+            TxFormats::getInstance().findByType(tx.getTxnType());
+
+        Json::Value jv(Json::objectValue);
+        jv["name"] = name;
+        jv["type"] = format ? format->getName() : "unknown";
+        jv["accounts"] = static_cast<Json::UInt>(accounts_);
+        jv["runs"] = runs;
+        auto const stage = [&jv](char const* label, Stage const& s) {
+            auto& out = jv[label] = Json::objectValue;
+            out["min_ns"] = static_cast<Json::UInt>(
+                duration_cast<nanoseconds>(s.fastest).count());
+            out["mean_ns"] = static_cast<Json::UInt>(
+                duration_cast<nanoseconds>(s.total / runs).count());
+        };
+        stage("preflight", preflightStage);
+        stage("preclaim", preclaimStage);
+        stage("doApply", applyStage);
+        log << Json::Compact(std::move(jv)) << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+        using namespace std::chrono_literals;
+
+        accounts_ = accounts();
+
+        Env env(*this, envconfig(), nullptr, beast::severities::kDisabled);
+        Account const gw("gateway");
+        Account const alice("alice");
+        Account const bob("bob");
+        Account const carol("carol");
+        auto const USD = gw["USD"];
+
+        testcase("Setup");
+        env.fund(XRP(100000000), gw, alice, bob, carol);
+        env.close();
+
+        // Accounts filling out the ledger, each holding USD
+        for (std::size_t i = 0; i != accounts_; ++i)
+        {
+            Account const a("a" + std::to_string(i));
+            env.fund(XRP(10000), a);
+            env.trust(USD(1000000), a);
+            env(pay(gw, a, USD(100)));
+            if (i % 256 == 255)
+                env.close();
+        }
+        env.close();
+
+        env.trust(USD(1000000), alice, bob, carol);
+        env.close();
+        env(pay(gw, alice, USD(100000)));
+        env(pay(gw, carol, USD(100000)));
+        env.close();
+
+        for (int level = 0; level != bookDepth; ++level)
+            env(offer(carol, XRP(100 + level), USD(1)));
+        env.close();
+
+        // The objects later transactions act on
+        auto const offerSeq = env.seq(alice);
+        env(offer(alice, USD(1), XRP(1)));
+
+        auto const escrowCreate = [&](NetClock::duration finishAfter) {
+            Json::Value jv;
+            jv[jss::TransactionType] = jss::EscrowCreate;
+            jv[jss::Flags] = tfUniversal;
+            jv[jss::Account] = alice.human();
+            jv[jss::Destination] = bob.human();
+            jv[jss::Amount] = XRP(100).value().getJson(JsonOptions::none);
+            jv[sfFinishAfter.jsonName] =
+                (env.now() + finishAfter).time_since_epoch().count();
+            return jv;
+        };
+        auto const escrowSeq = env.seq(alice);
+        env(escrowCreate(1s));
+
+        auto const checkID = keylet::check(alice, env.seq(alice)).key;
+        env(check::create(alice, bob, USD(100)));
+
+        auto const chanID = keylet::payChan(alice, bob, env.seq(alice)).key;
+        auto const payChanCreate = [&] {
+            Json::Value jv;
+            jv[jss::TransactionType] = jss::PaymentChannelCreate;
+            jv[jss::Flags] = tfUniversal;
+            jv[jss::Account] = alice.human();
+            jv[jss::Destination] = bob.human();
+            jv[jss::Amount] = XRP(1000).value().getJson(JsonOptions::none);
+            jv["SettleDelay"] = 100;
+            jv["PublicKey"] = strHex(alice.pk().slice());
+            return jv;
+        };
+        env(payChanCreate());
+
+        env.close(env.now() + 10s);
+        env.close();
+        pass();
+
+        testcase("Apply");
+        measure(env, "Payment XRP", env.jt(pay(alice, bob, XRP(10))));
+        measure(env, "Payment IOU", env.jt(pay(alice, bob, USD(10))));
+        measure(
+            env,
+            "Payment cross currency",
+            env.jt(pay(alice, bob, USD(10)), sendmax(XRP(2000))));
+        measure(env, "OfferCreate", env.jt(offer(alice, USD(10), XRP(10))));
+        measure(
+            env,
+            "OfferCreate crossing",
+            env.jt(offer(alice, USD(10), XRP(2000))));
+        measure(env, "OfferCancel", env.jt(offer_cancel(alice, offerSeq)));
+        measure(env, "TrustSet", env.jt(trust(alice, bob["EUR"](1000))));
+        measure(env, "AccountSet", env.jt(fset(alice, asfRequireDest)));
+        measure(env, "SetRegularKey", env.jt(regkey(alice, bob)));
+        measure(env, "DepositPreauth", env.jt(deposit::auth(alice, bob)));
+        measure(env, "TicketCreate", env.jt(ticket::create(alice, 1)));
+        measure(env, "CheckCreate", env.jt(check::create(alice, bob, USD(10))));
+        measure(env, "CheckCash", env.jt(check::cash(bob, checkID, USD(10))));
+        measure(env, "CheckCancel", env.jt(check::cancel(alice, checkID)));
+        measure(env, "EscrowCreate", env.jt(escrowCreate(100s)));
+        {
+            Json::Value jv;
+            jv[jss::TransactionType] = jss::EscrowFinish;
+            jv[jss::Flags] = tfUniversal;
+            jv[jss::Account] = bob.human();
+            jv[sfOwner.jsonName] = alice.human();
+            jv[sfOfferSequence.jsonName] = escrowSeq;
+            measure(env, "EscrowFinish", env.jt(jv));
+        }
+        measure(env, "PaymentChannelCreate", env.jt(payChanCreate()));
+        {
+            Json::Value jv;
+            jv[jss::TransactionType] = jss::PaymentChannelFund;
+            jv[jss::Flags] = tfUniversal;
+            jv[jss::Account] = alice.human();
+            jv["Channel"] = to_string(chanID);
+            jv[jss::Amount] = XRP(100).value().getJson(JsonOptions::none);
+            measure(env, "PaymentChannelFund", env.jt(jv));
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ApplyBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/protocol/Feature.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class BuildLedger_test : public beast::unit_test::suite
+{
+    static std::unique_ptr<Config>
+    applyThreads(std::unique_ptr<Config> cfg, std::size_t threads)
+    {
+        cfg->LEDGER_APPLY_THREADS = threads;
+        return cfg;
+    }
+
+    // Submit the same transactions to each env and close them together,
+    // expecting the closed ledgers to match.
+    void
+    testSameLedgers()
+    {
+        testcase("Same ledgers on one or several threads");
+        using namespace jtx;
+
+        Env serial(*this, envconfig(applyThreads, 1));
+        Env parallel(*this, envconfig(applyThreads, 4));
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 12; ++i)
+            accounts.emplace_back("a" + std::to_string(i));
+        Account const gw{"gateway"};
+        auto const USD = gw["USD"];
+
+        auto const both = [&](auto&& submit) {
+            submit(serial);
+            submit(parallel);
+        };
+
+        auto const closeBoth = [&] {
+            serial.close();
+            parallel.close();
+            auto const& s = serial.closed()->info();
+            auto const& p = parallel.closed()->info();
+            BEAST_EXPECT(s.accountHash == p.accountHash);
+            BEAST_EXPECT(s.txHash == p.txHash);
+            BEAST_EXPECT(s.hash == p.hash);
+        };
+
+        both([&](Env& env) {
+            env.fund(XRP(100000), gw);
+            for (auto const& a : accounts)
+                env.fund(XRP(10000), a);
+        });
+        closeBoth();
+
+        both([&](Env& env) {
+            for (auto const& a : accounts)
+                env(trust(a, USD(10000)));
+        });
+        closeBoth();
+
+        for (int round = 0; round < 4; ++round)
+        {
+            both([&](Env& env) {
+                // Independent payments
+                for (std::size_t i = 0; i < accounts.size(); i += 2)
+                    env(pay(accounts[i], accounts[i + 1], XRP(10 + round)));
+
+                // Payments that depend on each other
+                for (std::size_t i = 0; i + 1 < accounts.size(); ++i)
+                    env(pay(accounts[i], accounts[i + 1], XRP(1)));
+
+                // Issued currency through the gateway, and offers that
+                // may cross
+                for (std::size_t i = 0; i < accounts.size(); ++i)
+                {
+                    env(pay(gw, accounts[i], USD(100)));
+                    if (i % 2 == 0)
+                        env(offer(accounts[i], XRP(100), USD(100)));
+                    else
+                        env(offer(accounts[i], USD(100), XRP(100)));
+                }
+            });
+            closeBoth();
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testSameLedgers();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BuildLedger, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
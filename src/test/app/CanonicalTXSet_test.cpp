@@ -0,0 +1,311 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/basics/contract.h>
+#include <ripple/beast/unit_test.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+namespace ripple {
+namespace test {
+
+class CanonicalTXSet_test : public beast::unit_test::suite
+{
+    using TxPtr = std::shared_ptr<STTx const>;
+
+    static TxPtr
+    makeTx(AccountID const& account, SeqProxy seqProx, std::uint64_t fee = 10)
+    {
+        return std::make_shared<STTx const>(
+            ttACCOUNT_SET, [&](STObject& obj) {
+                obj.setAccountID(sfAccount, account);
+                obj.setFieldAmount(sfFee, STAmount(fee));
+                if (seqProx.isSeq())
+                    obj.setFieldU32(sfSequence, seqProx.value());
+                else
+                {
+                    obj.setFieldU32(sfSequence, 0);
+                    obj.setFieldU32(sfTicketSequence, seqProx.value());
+                }
+            });
+    }
+
+    // The order the transactions were kept in when the set was a map
+    static std::vector<uint256>
+    mapOrder(uint256 const& salt, std::vector<TxPtr> const& txs)
+    {
+        std::map<std::tuple<uint256, SeqProxy, uint256>, uint256> map;
+        for (auto const& tx : txs)
+        {
+            auto const account = tx->getAccountID(sfAccount);
+            uint256 key = beast::zero;
+            std::memcpy(key.begin(), account.begin(), account.size());
+            key ^= salt;
+            map.emplace(
+                std::make_tuple(
+                    key, tx->getSeqProxy(), tx->getTransactionID()),
+                tx->getTransactionID());
+        }
+
+        std::vector<uint256> result;
+        for (auto const& [_, id] : map)
+        {
+            (void)_;
+            result.push_back(id);
+        }
+        return result;
+    }
+
+    static std::vector<uint256>
+    ids(CanonicalTXSet const& set)
+    {
+        std::vector<uint256> result;
+        for (auto const& [_, tx] : set)
+        {
+            (void)_;
+            result.push_back(tx->getTransactionID());
+        }
+        return result;
+    }
+
+    static uint256
+    fromHex(char const* hex)
+    {
+        uint256 result;
+        if (!result.parseHex(hex))
+            Throw<std::invalid_argument>("invalid hex");
+        return result;
+    }
+
+    uint256 const salt_ = fromHex(
+        "1234567890ABCDEF1234567890ABCDEF1234567890ABCDEF1234567890ABCDEF");
+    AccountID const alice_{1};
+    AccountID const bob_{2};
+    AccountID const carol_{0xff00000000000000ULL};
+
+    void
+    testOrder()
+    {
+        testcase("Order");
+
+        std::vector<TxPtr> txs;
+        for (auto const& account : {alice_, bob_, carol_})
+        {
+            for (std::uint32_t seq : {3, 1, 2})
+                txs.push_back(makeTx(account, SeqProxy::sequence(seq)));
+            for (std::uint32_t ticket : {7, 5})
+                txs.push_back(
+                    makeTx(account, SeqProxy{SeqProxy::ticket, ticket}));
+        }
+        // Transactions that only differ by their ID
+        txs.push_back(makeTx(bob_, SeqProxy::sequence(2), 20));
+        txs.push_back(makeTx(bob_, SeqProxy::sequence(2), 30));
+
+        CanonicalTXSet set(salt_);
+        BEAST_EXPECT(set.empty());
+        for (auto const& tx : txs)
+            set.insert(tx);
+        BEAST_EXPECT(set.size() == txs.size());
+        BEAST_EXPECT(!set.empty());
+        BEAST_EXPECT(ids(set) == mapOrder(salt_, txs));
+
+        // Inserting into a sorted set puts the transaction in order
+        txs.push_back(makeTx(alice_, SeqProxy::sequence(4)));
+        set.insert(txs.back());
+        BEAST_EXPECT(ids(set) == mapOrder(salt_, txs));
+
+        // A different salt orders the accounts differently
+        auto const salt = fromHex(
+            "FEDCBA0987654321FEDCBA0987654321FEDCBA0987654321FEDCBA0987654321");
+        set.reset(salt);
+        BEAST_EXPECT(set.empty());
+        BEAST_EXPECT(set.key() == salt);
+        for (auto const& tx : txs)
+            set.insert(tx);
+        BEAST_EXPECT(ids(set) == mapOrder(salt, txs));
+    }
+
+    void
+    testDuplicates()
+    {
+        testcase("Duplicates");
+
+        CanonicalTXSet set(salt_);
+        auto const first = makeTx(alice_, SeqProxy::sequence(1));
+        auto const copy = std::make_shared<STTx const>(*first);
+        auto const other = makeTx(alice_, SeqProxy::sequence(2));
+        set.insert(first);
+        set.insert(other);
+        set.insert(copy);
+        set.insert(first);
+        BEAST_EXPECT(set.size() == 2);
+
+        // The first insert of a transaction is the one kept
+        auto it = set.begin();
+        BEAST_EXPECT(it->second == first);
+        ++it;
+        BEAST_EXPECT(it->second == other);
+        ++it;
+        BEAST_EXPECT(it == set.end());
+
+        // A duplicate of a transaction already sorted is dropped too
+        set.insert(copy);
+        BEAST_EXPECT(set.size() == 2);
+        BEAST_EXPECT(set.begin()->second == first);
+    }
+
+    void
+    testErase()
+    {
+        testcase("Erase");
+
+        std::vector<TxPtr> txs;
+        for (auto const& account : {alice_, bob_, carol_})
+        {
+            for (std::uint32_t seq = 1; seq <= 4; ++seq)
+                txs.push_back(makeTx(account, SeqProxy::sequence(seq)));
+        }
+
+        CanonicalTXSet set(salt_);
+        for (auto const& tx : txs)
+            set.insert(tx);
+        auto const order = mapOrder(salt_, txs);
+
+        // Erase every other transaction while iterating
+        std::vector<uint256> kept;
+        bool erase = true;
+        for (auto it = set.begin(); it != set.end(); erase = !erase)
+        {
+            if (erase)
+                it = set.erase(it);
+            else
+            {
+                kept.push_back(it->second->getTransactionID());
+                ++it;
+            }
+        }
+        BEAST_EXPECT(kept.size() == order.size() / 2);
+        for (std::size_t i = 0; i < kept.size(); ++i)
+            BEAST_EXPECT(kept[i] == order[2 * i + 1]);
+        BEAST_EXPECT(set.size() == kept.size());
+        BEAST_EXPECT(!set.empty());
+        BEAST_EXPECT(ids(set) == kept);
+
+        // Other iterators stay valid across an erase
+        auto first = set.begin();
+        auto second = std::next(first);
+        auto third = std::next(second);
+        BEAST_EXPECT(set.erase(second) == third);
+        BEAST_EXPECT(std::next(first) == third);
+        BEAST_EXPECT(set.size() == kept.size() - 1);
+
+        // Inserting drops the erased slots
+        set.insert(txs.front());
+        auto expected = kept;
+        expected.erase(expected.begin() + 1);
+        expected.push_back(txs.front()->getTransactionID());
+        std::sort(
+            expected.begin(),
+            expected.end(),
+            [&order](uint256 const& a, uint256 const& b) {
+                return std::find(order.begin(), order.end(), a) <
+                    std::find(order.begin(), order.end(), b);
+            });
+        BEAST_EXPECT(ids(set) == expected);
+        BEAST_EXPECT(set.size() == expected.size());
+
+        for (auto it = set.begin(); it != set.end();)
+            it = set.erase(it);
+        BEAST_EXPECT(set.size() == 0);
+        BEAST_EXPECT(set.empty());
+        BEAST_EXPECT(set.begin() == set.end());
+    }
+
+    void
+    testPopAcctTransaction()
+    {
+        testcase("popAcctTransaction");
+
+        auto const a1 = makeTx(alice_, SeqProxy::sequence(1));
+        auto const a2 = makeTx(alice_, SeqProxy::sequence(2));
+        auto const a3 = makeTx(alice_, SeqProxy::sequence(3));
+        auto const a5 = makeTx(alice_, SeqProxy::sequence(5));
+        auto const t7 = makeTx(alice_, SeqProxy{SeqProxy::ticket, 7});
+        auto const t4 = makeTx(alice_, SeqProxy{SeqProxy::ticket, 4});
+        auto const b1 = makeTx(bob_, SeqProxy::sequence(1));
+        auto const b2 = makeTx(bob_, SeqProxy::sequence(2));
+
+        CanonicalTXSet set(salt_);
+        for (auto const& tx : {t7, a3, b1, a1, t4, a5, b2, a2})
+            set.insert(tx);
+
+        // Erase the first two of alice's transactions and bob's first, as
+        // if they had been applied
+        for (auto it = set.begin(); it != set.end();)
+        {
+            if (it->second == a1 || it->second == a2 || it->second == b1)
+                it = set.erase(it);
+            else
+                ++it;
+        }
+        BEAST_EXPECT(set.size() == 5);
+
+        // The next transaction is found past the cleared slots. Sequences
+        // need not be consecutive, and come before tickets.
+        BEAST_EXPECT(set.popAcctTransaction(a1) == a3);
+        BEAST_EXPECT(set.size() == 4);
+        BEAST_EXPECT(set.popAcctTransaction(a3) == a5);
+        BEAST_EXPECT(set.popAcctTransaction(a5) == t4);
+        BEAST_EXPECT(set.popAcctTransaction(t4) == t7);
+        BEAST_EXPECT(set.popAcctTransaction(t7) == nullptr);
+        BEAST_EXPECT(set.size() == 1);
+
+        // Another account's transactions are never returned
+        BEAST_EXPECT(set.popAcctTransaction(a1) == nullptr);
+        BEAST_EXPECT(set.popAcctTransaction(b1) == b2);
+        BEAST_EXPECT(set.popAcctTransaction(b2) == nullptr);
+        BEAST_EXPECT(set.size() == 0);
+        BEAST_EXPECT(set.empty());
+        BEAST_EXPECT(set.begin() == set.end());
+
+        // Popped slots are dropped when the set is next sorted
+        set.insert(a2);
+        BEAST_EXPECT(set.size() == 1);
+        BEAST_EXPECT(set.popAcctTransaction(a1) == a2);
+        BEAST_EXPECT(set.empty());
+    }
+
+public:
+    void
+    run() override
+    {
+        testOrder();
+        testDuplicates();
+        testErase();
+        testPopAcctTransaction();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CanonicalTXSet, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,327 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/paths/Flow.h>
+#include <ripple/app/paths/Pathfinder.h>
+#include <ripple/app/paths/RippleCalc.h>
+#include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/app/paths/impl/FlowDebugInfo.h>
+#include <ripple/app/paths/impl/Steps.h>
+#include <ripple/app/paths/impl/StrandFlow.h>
+#include <ripple/ledger/PaymentSandbox.h>
+#include <test/jtx.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Times the payment engine and the path finder on a busy ledger.
+
+    The ledger has several gateways issuing the same currencies, market
+    makers holding all of them, and a deep order book between every pair
+    of currencies. Each stage is timed on its own so a change can be
+    traced to the part of the engine it affects.
+*/
+class FlowBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    // Runs of each measurement; the fastest and the mean are reported
+    static constexpr int runs = 10;
+
+    struct Timings
+    {
+        std::map<std::string, std::vector<clock::duration>> samples;
+
+        template <class F>
+        auto
+        time(std::string const& stage, F&& f)
+        {
+            auto const start = clock::now();
+            struct Stop
+            {
+                Timings& t;
+                std::string const& stage;
+                clock::time_point start;
+                ~Stop()
+                {
+                    t.samples[stage].push_back(clock::now() - start);
+                }
+            } stop{*this, stage, start};
+            return f();
+        }
+    };
+
+    void
+    report(Timings const& timings)
+    {
+        using namespace std::chrono;
+        for (auto const& [stage, samples] : timings.samples)
+        {
+            auto const fastest =
+                *std::min_element(samples.begin(), samples.end());
+            clock::duration total{0};
+            for (auto const& s : samples)
+                total += s;
+            log << "  " << stage << ": min "
+                << duration_cast<microseconds>(fastest).count() << "us, mean "
+                << duration_cast<microseconds>(total / samples.size()).count()
+                << "us" << std::endl;
+        }
+    }
+
+    // Build the ledger: `depth` offers between every pair of currencies,
+    // each at a slightly worse rate than the one before.
+    void
+    setup(
+        jtx::Env& env,
+        std::vector<jtx::Account> const& gateways,
+        std::vector<jtx::Account> const& makers,
+        std::vector<jtx::Account> const& users,
+        int depth)
+    {
+        using namespace jtx;
+
+        for (auto const& gw : gateways)
+            env.fund(XRP(100000000), gw);
+        for (auto const& maker : makers)
+            env.fund(XRP(100000000), maker);
+        for (auto const& user : users)
+            env.fund(XRP(100000), user);
+        env.close();
+
+        std::vector<IOU> currencies;
+        for (auto const& gw : gateways)
+        {
+            for (auto const& name : {"USD", "EUR", "BTC"})
+                currencies.push_back(gw[name]);
+        }
+
+        for (auto const& iou : currencies)
+        {
+            for (auto const& maker : makers)
+                env.trust(iou(1000000000), maker);
+            for (auto const& user : users)
+                env.trust(iou(1000000000), user);
+        }
+        env.close();
+
+        for (auto const& iou : currencies)
+        {
+            for (auto const& maker : makers)
+                env(pay(iou.account, maker, iou(10000000)));
+        }
+        env.close();
+
+        auto const rate = [](int level) { return 1000 + 5 * level; };
+
+        std::vector<std::function<STAmount(int)>> assets;
+        assets.push_back([](int n) { return STAmount(XRP(n)); });
+        for (auto const& iou : currencies)
+            assets.push_back([iou](int n) { return STAmount(iou(n)); });
+
+        for (int level = 0; level != depth; ++level)
+        {
+            auto const& maker = makers[level % makers.size()];
+            for (std::size_t i = 0; i != assets.size(); ++i)
+            {
+                for (std::size_t k = 0; k != assets.size(); ++k)
+                {
+                    if (i != k)
+                        env(offer(
+                            maker, assets[i](rate(level)), assets[k](1000)));
+                }
+            }
+            env.close();
+        }
+    }
+
+    void
+    testPayment(
+        jtx::Env& env,
+        jtx::Account const& src,
+        jtx::Account const& dst,
+        STAmount const& deliver,
+        STAmount const& sendMax)
+    {
+        log << "Paying " << deliver.getFullText() << " with "
+            << sendMax.getFullText() << std::endl;
+
+        Timings timings;
+        auto& app = env.app();
+        auto const j = app.journal("FlowBench");
+        STPathSet paths;
+        std::size_t passes = 0;
+        std::size_t strandCount = 0;
+
+        for (int run = 0; run != runs; ++run)
+        {
+            auto const cache = std::make_shared<RippleLineCache>(env.current());
+            Pathfinder pf(
+                cache,
+                src,
+                dst,
+                sendMax.getCurrency(),
+                sendMax.getIssuer(),
+                deliver,
+                boost::none,
+                app);
+
+            timings.time("findPaths", [&] {
+                return pf.findPaths(app.config().PATH_SEARCH);
+            });
+            timings.time(
+                "computePathRanks", [&] { pf.computePathRanks(4); });
+            STPath fullLiquidityPath;
+            paths = timings.time("getBestPaths", [&] {
+                return pf.getBestPaths(
+                    4, fullLiquidityPath, {}, sendMax.getIssuer());
+            });
+
+            // Finding paths again from the same cache reuses the search
+            Pathfinder again(
+                cache,
+                src,
+                dst,
+                sendMax.getCurrency(),
+                sendMax.getIssuer(),
+                deliver,
+                boost::none,
+                app);
+            timings.time("findPaths (cached)", [&] {
+                return again.findPaths(app.config().PATH_SEARCH);
+            });
+        }
+
+        for (int run = 0; run != runs; ++run)
+        {
+            PaymentSandbox sb(env.current().get(), tapNONE);
+            path::RippleCalc::Input input;
+            input.partialPaymentAllowed = true;
+            timings.time("rippleCalculate", [&] {
+                return path::RippleCalc::rippleCalculate(
+                    sb, sendMax, deliver, dst, src, paths, app.logs(), &input);
+            });
+        }
+
+        for (int run = 0; run != runs; ++run)
+        {
+            PaymentSandbox sb(env.current().get(), tapNONE);
+            timings.time("flow", [&] {
+                return flow(
+                    sb,
+                    deliver,
+                    src,
+                    dst,
+                    paths,
+                    true,
+                    true,
+                    false,
+                    false,
+                    boost::none,
+                    sendMax,
+                    j);
+            });
+        }
+
+        // The two stages of flow, timed apart
+        for (int run = 0; run != runs; ++run)
+        {
+            PaymentSandbox sb(env.current().get(), tapNONE);
+            auto const [ter, strands] = timings.time("flow: toStrands", [&] {
+                return toStrands(
+                    sb,
+                    src,
+                    dst,
+                    deliver.issue(),
+                    boost::none,
+                    sendMax.issue(),
+                    paths,
+                    true,
+                    false,
+                    false,
+                    j);
+            });
+            if (!BEAST_EXPECT(ter == tesSUCCESS))
+                return;
+            strandCount = strands.size();
+
+            path::detail::FlowDebugInfo info(false, false);
+            timings.time("flow: strands", [&] {
+                return flow<IOUAmount, IOUAmount>(
+                    sb,
+                    strands,
+                    toAmount<IOUAmount>(deliver),
+                    true,
+                    false,
+                    boost::none,
+                    sendMax,
+                    j,
+                    &info);
+            });
+            passes = info.passCount();
+        }
+
+        log << "  " << paths.size() << " paths, " << strandCount
+            << " strands, " << passes << " liquidity passes" << std::endl;
+        report(timings);
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+
+        std::vector<Account> gateways;
+        for (auto const& name : {"gw1", "gw2", "gw3"})
+            gateways.emplace_back(name);
+        std::vector<Account> makers;
+        for (auto const& name : {"m1", "m2", "m3", "m4"})
+            makers.emplace_back(name);
+        Account const alice("alice");
+        Account const bob("bob");
+
+        Env env(*this, envconfig(), nullptr, beast::severities::kDisabled);
+        setup(env, gateways, makers, {alice, bob}, 40);
+
+        auto const USD = gateways[0]["USD"];
+        auto const BTC = gateways[2]["BTC"];
+        env(pay(gateways[0], alice, USD(1000000)));
+        env.close();
+
+        testcase("Deep books");
+        testPayment(env, alice, bob, BTC(20000), STAmount(USD(30000)));
+
+        testcase("Small payment");
+        testPayment(env, alice, bob, BTC(10), STAmount(USD(20)));
+
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(FlowBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -1378,6 +1378,82 @@ struct Flow_test : public beast::unit_test::suite
         env.require(balance(alice, XRP(9000) - drops(20)));
     }
 
+    void
+    testStrandThreads(FeatureBitset features)
+    {
+        testcase("Strand Threads");
+
+        using namespace jtx;
+        Env env(*this, features);
+        auto const alice = Account("alice");
+        auto const bob = Account("bob");
+        auto const carol = Account("carol");
+        auto const gw = Account("gw");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+        auto const BTC = gw["BTC"];
+
+        env.fund(XRP(10000), alice, bob, carol, gw);
+        env.trust(USD(1000), alice, bob, carol);
+        env.trust(EUR(1000), alice, bob, carol);
+        env.trust(BTC(1000), alice, bob, carol);
+
+        env(pay(gw, alice, BTC(100)));
+        env(pay(gw, bob, USD(100)));
+        env(pay(gw, bob, EUR(100)));
+
+        env(offer(bob, BTC(10), USD(10)));
+        env(offer(bob, BTC(12), USD(10)));
+        env(offer(bob, BTC(10), EUR(11)));
+        env(offer(bob, BTC(11), EUR(10)));
+        env(offer(bob, EUR(10), USD(10)));
+        env(offer(bob, EUR(12), USD(10)));
+        env.close();
+
+        auto IPE = [](Issue const& iss) {
+            return STPathElement(
+                STPathElement::typeCurrency | STPathElement::typeIssuer,
+                xrpAccount(),
+                iss.currency,
+                iss.account);
+        };
+        STPathSet paths;
+        paths.push_back(STPath({IPE(USD.issue())}));
+        paths.push_back(STPath({IPE(EUR.issue()), IPE(USD.issue())}));
+
+        // Evaluating the strands on several threads must not change the
+        // outcome of the payment.
+        auto const pay = [&](std::size_t threads) {
+            PaymentSandbox sb(env.current().get(), tapNONE);
+            return flow(
+                sb,
+                USD(45),
+                alice,
+                carol,
+                paths,
+                false,
+                true,
+                true,
+                false,
+                boost::none,
+                STAmount(BTC(60)),
+                env.app().logs().journal("Flow"),
+                nullptr,
+                threads);
+        };
+
+        auto const expected = pay(0);
+        BEAST_EXPECT(expected.result() == tesSUCCESS);
+        for (std::size_t threads : {2, 4})
+        {
+            auto const actual = pay(threads);
+            BEAST_EXPECT(actual.result() == expected.result());
+            BEAST_EXPECT(actual.actualAmountIn == expected.actualAmountIn);
+            BEAST_EXPECT(actual.actualAmountOut == expected.actualAmountOut);
+            BEAST_EXPECT(actual.removableOffers == expected.removableOffers);
+        }
+    }
+
     void
     testWithFeats(FeatureBitset features)
     {
@@ -1399,6 +1475,8 @@ struct Flow_test : public beast::unit_test::suite
         testReexecuteDirectStep(features);
         testSelfPayLowQualityOffer(features);
         testTicketPay(features);
+        testStrandThreads(features);
+        testStrandThreads(features - featureFlowSortStrands);
     }
 
     void
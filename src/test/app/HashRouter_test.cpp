@@ -20,6 +20,9 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -277,6 +280,51 @@ class HashRouter_test : public beast::unit_test::suite
         BEAST_EXPECT(router.shouldProcess(key, peer, flags, 1s));
     }
 
+    void
+    testConcurrency()
+    {
+        using namespace std::chrono_literals;
+        TestStopwatch stopwatch;
+        HashRouter router(stopwatch, 5s, 5);
+
+        // Keys spread over every shard, set and read from several threads
+        auto const makeKey = [](int thread, int i) {
+            uint256 key(static_cast<std::uint64_t>(thread * 10000 + i));
+            *key.data() = static_cast<std::uint8_t>(i);
+            return key;
+        };
+
+        std::atomic<int> mismatches{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < 2000; ++i)
+                {
+                    auto const key = makeKey(t, i);
+                    router.addSuppressionPeer(key, t + 1);
+                    router.setFlags(key, 1 << t);
+                    if (router.getFlags(key) != 1 << t)
+                        ++mismatches;
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        BEAST_EXPECT(mismatches == 0);
+
+        for (int t = 0; t < 4; ++t)
+        {
+            for (int i = 0; i < 2000; ++i)
+            {
+                int flags = 0;
+                BEAST_EXPECT(
+                    !router.addSuppressionPeer(makeKey(t, i), 9, flags));
+                BEAST_EXPECT(flags == 1 << t);
+            }
+        }
+    }
+
 public:
     void
     run() override
@@ -288,6 +336,7 @@ public:
         testRelay();
         testRecover();
         testProcess();
+        testConcurrency();
     }
 };
 
@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/reporting/ETLHelpers.h>
+#include <ripple/beast/unit_test.h>
+
+namespace ripple {
+namespace test {
+
+class LedgerDataPartitions_test : public beast::unit_test::suite
+{
+    // The marker a GetLedgerData page would return to resume at a position
+    static std::string
+    markerAt(std::uint64_t position)
+    {
+        std::string marker(uint256::bytes, '\0');
+        for (std::size_t i = 0; i < 8; ++i)
+            marker[i] = static_cast<char>(position >> (56 - 8 * i));
+        return marker;
+    }
+
+    static constexpr std::uint64_t quarter = std::uint64_t{1} << 62;
+
+    void
+    testInitial()
+    {
+        testcase("initial partitions");
+
+        LedgerDataPartitions partitions{4};
+        BEAST_EXPECT(partitions.size() == 4);
+        BEAST_EXPECT(!partitions.complete());
+
+        for (std::uint64_t i = 0; i < 4; ++i)
+        {
+            auto const a = partitions.acquire();
+            if (!BEAST_EXPECT(a))
+                return;
+            BEAST_EXPECT(a->id == i);
+            BEAST_EXPECT(
+                LedgerDataPartitions::position(a->marker) == i * quarter);
+        }
+
+        // Each partition ends where the next begins
+        auto const progress = partitions.advance(0, markerAt(quarter - 1), 10);
+        BEAST_EXPECT(progress.more);
+        BEAST_EXPECT(progress.end && *progress.end == quarter);
+
+        // The last partition runs to the end of the keyspace
+        BEAST_EXPECT(!partitions.advance(3, markerAt(3 * quarter + 1), 10).end);
+    }
+
+    void
+    testComplete()
+    {
+        testcase("complete");
+
+        LedgerDataPartitions partitions{2};
+        auto const a = partitions.acquire();
+        auto const b = partitions.acquire();
+        if (!BEAST_EXPECT(a && b))
+            return;
+
+        // A marker past the end of a partition finishes it
+        BEAST_EXPECT(!partitions.advance(a->id, markerAt(2 * quarter), 5).more);
+        BEAST_EXPECT(!partitions.complete());
+
+        // No marker means the end of the state map
+        BEAST_EXPECT(!partitions.advance(b->id, "", 5).more);
+        BEAST_EXPECT(partitions.complete());
+
+        BEAST_EXPECT(!partitions.acquire());
+    }
+
+    void
+    testSplitByWidth()
+    {
+        testcase("split before any objects arrive");
+
+        LedgerDataPartitions partitions{2};
+        partitions.acquire();
+        partitions.acquire();
+
+        // Every partition is taken, so the widest is split. [0, 2^63) is
+        // wider by one than the rest of the keyspace
+        auto const c = partitions.acquire();
+        if (!BEAST_EXPECT(c))
+            return;
+        BEAST_EXPECT(c->id == 2);
+        BEAST_EXPECT(partitions.size() == 3);
+        BEAST_EXPECT(LedgerDataPartitions::position(c->marker) == quarter);
+
+        // The partition split loses its upper half
+        auto const progress = partitions.advance(0, markerAt(quarter - 1), 0);
+        BEAST_EXPECT(progress.more);
+        BEAST_EXPECT(progress.end && *progress.end == quarter);
+        BEAST_EXPECT(!partitions.advance(0, markerAt(quarter), 0).more);
+
+        // The new partition ends where the old one did
+        auto const upper = partitions.advance(2, markerAt(quarter + 1), 0);
+        BEAST_EXPECT(upper.more);
+        BEAST_EXPECT(upper.end && *upper.end == 2 * quarter);
+    }
+
+    void
+    testSplitByDensity()
+    {
+        testcase("split by density");
+
+        LedgerDataPartitions partitions{2};
+        partitions.acquire();
+        partitions.acquire();
+
+        // Partition 0 is sparse and has little left. Partition 1 is dense
+        partitions.advance(0, markerAt(2 * quarter - quarter / 8), 10);
+        partitions.advance(1, markerAt(3 * quarter), 100000);
+
+        auto const c = partitions.acquire();
+        if (!BEAST_EXPECT(c))
+            return;
+        auto const mid = 3 * quarter + (~std::uint64_t{0} - 3 * quarter) / 2;
+        BEAST_EXPECT(LedgerDataPartitions::position(c->marker) == mid);
+
+        // The dense partition still has the most left, so it is split again
+        auto const d = partitions.acquire();
+        if (!BEAST_EXPECT(d))
+            return;
+        BEAST_EXPECT(
+            LedgerDataPartitions::position(d->marker) ==
+            3 * quarter + (mid - 3 * quarter) / 2);
+    }
+
+    void
+    testNoSplit()
+    {
+        testcase("no split of small partitions");
+
+        LedgerDataPartitions partitions{2};
+        partitions.acquire();
+        partitions.acquire();
+
+        // Few objects are estimated to be left anywhere
+        partitions.advance(0, markerAt(2 * quarter - 16), 100);
+        partitions.advance(1, markerAt(~std::uint64_t{0} - 16), 100);
+        BEAST_EXPECT(!partitions.acquire());
+        BEAST_EXPECT(partitions.size() == 2);
+    }
+
+    void
+    testRelease()
+    {
+        testcase("release");
+
+        LedgerDataPartitions partitions{2};
+        auto const a = partitions.acquire();
+        partitions.acquire();
+        if (!BEAST_EXPECT(a))
+            return;
+
+        auto const resume = quarter / 2;
+        partitions.advance(a->id, markerAt(resume), 50);
+        partitions.release(a->id);
+
+        // A released partition is resumed where it left off, before any
+        // partition is split
+        auto const again = partitions.acquire();
+        if (!BEAST_EXPECT(again))
+            return;
+        BEAST_EXPECT(again->id == a->id);
+        BEAST_EXPECT(LedgerDataPartitions::position(again->marker) == resume);
+        BEAST_EXPECT(partitions.size() == 2);
+    }
+
+public:
+    void
+    run() override
+    {
+        testInitial();
+        testComplete();
+        testSplitByWidth();
+        testSplitByDensity();
+        testNoSplit();
+        testRelease();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerDataPartitions, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,178 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerHashIndex.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/protocol/digest.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class LedgerHashIndex_test : public beast::unit_test::suite
+{
+    static uint256
+    hashOf(std::uint32_t seq)
+    {
+        return sha512Half(seq);
+    }
+
+    // Sequences spread over several chunks, including the first and last
+    static std::vector<std::uint32_t>
+    sequences()
+    {
+        return {
+            1,
+            2,
+            LedgerHashIndex::chunkLedgers - 1,
+            LedgerHashIndex::chunkLedgers,
+            60000000,
+            60000001,
+            std::numeric_limits<std::uint32_t>::max()};
+    }
+
+    void
+    check(LedgerHashIndex const& index)
+    {
+        for (auto const seq : sequences())
+            BEAST_EXPECT(index.get(seq) == hashOf(seq));
+        BEAST_EXPECT(!index.get(3));
+        BEAST_EXPECT(!index.get(60000002));
+        BEAST_EXPECT(!index.get(1000000));
+    }
+
+    void
+    testMemory(beast::Journal const& journal)
+    {
+        testcase("memory");
+
+        LedgerHashIndex index({}, journal);
+        BEAST_EXPECT(!index.mapped());
+        BEAST_EXPECT(!index.get(1));
+
+        for (auto const seq : sequences())
+            index.set(seq, hashOf(seq));
+        check(index);
+
+        // A corrected entry replaces the old one
+        index.set(2, hashOf(1000));
+        BEAST_EXPECT(index.get(2) == hashOf(1000));
+    }
+
+    void
+    testFile(beast::Journal const& journal)
+    {
+        testcase("file");
+
+        beast::temp_dir dir;
+        auto const path = dir.file("ledger_hashes.dat");
+
+        {
+            LedgerHashIndex index(path, journal);
+            BEAST_EXPECT(index.mapped());
+            for (auto const seq : sequences())
+                index.set(seq, hashOf(seq));
+            check(index);
+        }
+
+        // Only the chunks in use take space in the file
+        auto const size = boost::filesystem::file_size(path);
+        BEAST_EXPECT(
+            size < 8 * LedgerHashIndex::chunkLedgers * uint256::bytes);
+
+        {
+            LedgerHashIndex index(path, journal);
+            BEAST_EXPECT(index.mapped());
+            check(index);
+
+            // A chunk allocated after reopening does not overlap the others
+            index.set(30000000, hashOf(30000000));
+            BEAST_EXPECT(index.get(30000000) == hashOf(30000000));
+            check(index);
+        }
+
+        {
+            LedgerHashIndex index(path, journal);
+            BEAST_EXPECT(index.get(30000000) == hashOf(30000000));
+            check(index);
+        }
+    }
+
+    void
+    testDamaged(beast::Journal const& journal)
+    {
+        testcase("damaged");
+
+        beast::temp_dir dir;
+        auto const path = dir.file("ledger_hashes.dat");
+
+        {
+            LedgerHashIndex index(path, journal);
+            for (auto const seq : sequences())
+                index.set(seq, hashOf(seq));
+        }
+
+        // Losing the end of the file leaves chunks in the directory that
+        // are not in the file, so the index starts over
+        boost::filesystem::resize_file(
+            path,
+            boost::filesystem::file_size(path) -
+                LedgerHashIndex::chunkLedgers * uint256::bytes);
+        {
+            LedgerHashIndex index(path, journal);
+            BEAST_EXPECT(index.mapped());
+            for (auto const seq : sequences())
+                BEAST_EXPECT(!index.get(seq));
+            index.set(5, hashOf(5));
+        }
+
+        // As does a file that is not an index
+        {
+            std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+            out << std::string(300000, 'x');
+        }
+        {
+            LedgerHashIndex index(path, journal);
+            BEAST_EXPECT(index.mapped());
+            BEAST_EXPECT(!index.get(5));
+            index.set(5, hashOf(5));
+            BEAST_EXPECT(index.get(5) == hashOf(5));
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        SuiteJournal journal("LedgerHashIndex_test", *this);
+        testMemory(journal);
+        testFile(journal);
+        testDamaged(journal);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerHashIndex, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerHeaderCache.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/digest.h>
+#include <limits>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class LedgerHeaderCache_test : public beast::unit_test::suite
+{
+    static LedgerInfo
+    headerOf(std::uint32_t seq)
+    {
+        using namespace std::chrono_literals;
+
+        LedgerInfo info;
+        info.seq = seq;
+        info.parentHash = sha512Half(seq - 1);
+        info.txHash = sha512Half(seq, 't');
+        info.accountHash = sha512Half(seq, 'a');
+        info.drops = XRPAmount{100000000000000000 - seq};
+        info.closeTime = NetClock::time_point{seq * 4s};
+        info.parentCloseTime = NetClock::time_point{seq * 4s - 4s};
+        info.closeTimeResolution = 10s;
+        info.closeFlags = seq % 2;
+        info.hash = calculateLedgerHash(info);
+        return info;
+    }
+
+    bool
+    same(boost::optional<LedgerInfo> const& got, LedgerInfo const& want)
+    {
+        return got && got->seq == want.seq && got->hash == want.hash &&
+            got->parentHash == want.parentHash &&
+            got->txHash == want.txHash &&
+            got->accountHash == want.accountHash &&
+            got->drops == want.drops && got->closeTime == want.closeTime &&
+            got->parentCloseTime == want.parentCloseTime &&
+            got->closeTimeResolution == want.closeTimeResolution &&
+            got->closeFlags == want.closeFlags;
+    }
+
+    void
+    testInsert()
+    {
+        testcase("insert");
+
+        auto const chunk = LedgerHeaderCache::chunkLedgers;
+        std::vector<std::uint32_t> const seqs{
+            1,
+            2,
+            chunk - 1,
+            chunk,
+            60000000,
+            std::numeric_limits<std::uint32_t>::max()};
+
+        LedgerHeaderCache cache(16 * chunk);
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(!cache.get(1));
+
+        for (auto const seq : seqs)
+            cache.insert(headerOf(seq));
+        BEAST_EXPECT(cache.size() == seqs.size());
+
+        for (auto const seq : seqs)
+            BEAST_EXPECT(same(cache.get(seq), headerOf(seq)));
+        BEAST_EXPECT(!cache.get(3));
+        BEAST_EXPECT(!cache.get(chunk + 1));
+
+        // Inserting a header again replaces it
+        cache.insert(headerOf(2));
+        BEAST_EXPECT(cache.size() == seqs.size());
+        BEAST_EXPECT(same(cache.get(2), headerOf(2)));
+    }
+
+    void
+    testErase()
+    {
+        testcase("erase");
+
+        auto const chunk = LedgerHeaderCache::chunkLedgers;
+
+        LedgerHeaderCache cache(16 * chunk);
+        for (std::uint32_t seq = 1; seq <= 3 * chunk; seq += 7)
+            cache.insert(headerOf(seq));
+        auto const before = cache.size();
+
+        // Within a chunk, then whole chunks before one
+        cache.erasePrior(chunk + 100);
+        for (std::uint32_t seq = 1; seq <= 3 * chunk; seq += 7)
+            BEAST_EXPECT(
+                static_cast<bool>(cache.get(seq)) == (seq >= chunk + 100));
+        BEAST_EXPECT(cache.size() < before);
+
+        cache.erasePrior(std::numeric_limits<std::uint32_t>::max());
+        BEAST_EXPECT(cache.size() == 0);
+    }
+
+    void
+    testLimit()
+    {
+        testcase("limit");
+
+        auto const chunk = LedgerHeaderCache::chunkLedgers;
+
+        // Room for two chunks: the one least recently used is dropped
+        LedgerHeaderCache cache(2 * chunk);
+        cache.insert(headerOf(1));
+        cache.insert(headerOf(chunk + 1));
+        BEAST_EXPECT(cache.get(1));
+        cache.insert(headerOf(2 * chunk + 1));
+
+        BEAST_EXPECT(cache.get(1));
+        BEAST_EXPECT(!cache.get(chunk + 1));
+        BEAST_EXPECT(cache.get(2 * chunk + 1));
+        BEAST_EXPECT(cache.size() == 2);
+    }
+
+public:
+    void
+    run() override
+    {
+        testInsert();
+        testErase();
+        testLimit();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerHeaderCache, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
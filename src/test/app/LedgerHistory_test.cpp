@@ -193,10 +193,52 @@ public:
         }
     }
 
+    void
+    testOpenFromHeader()
+    {
+        testcase("LedgerHistory open from header");
+        using namespace jtx;
+
+        Env env{*this};
+        Account const alice{"alice"};
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        auto const closed = env.closed();
+        auto const seq = closed->seq();
+        auto const hash = closed->info().hash;
+        BEAST_EXPECT(env.app().getLedgerMaster().haveLedger(seq));
+
+        // Insert the header, then drop the ledger itself
+        LedgerHistory lh{beast::insight::NullCollector::New(), env.app()};
+        lh.insert(env.app().getLedgerMaster().getLedgerByHash(hash), true);
+        lh.clearLedgerCachePrior(seq + 1);
+
+        // A sequence whose header does not match is not opened from it
+        BEAST_EXPECT(!lh.getLedgerByHash(uint256{1}, seq));
+
+        auto const ledger = lh.getLedgerByHash(hash, seq);
+        if (!BEAST_EXPECT(ledger))
+            return;
+        BEAST_EXPECT(ledger->info().hash == hash);
+        BEAST_EXPECT(ledger->info().accountHash == closed->info().accountHash);
+        BEAST_EXPECT(lh.getLedgerBySeq(seq) == ledger);
+
+        // The maps and the fees are read on first use
+        BEAST_EXPECT(ledger->exists(keylet::account(alice.id())));
+        BEAST_EXPECT(ledger->fees().base == closed->fees().base);
+        BEAST_EXPECT(
+            ledger->stateMap().getHash().as_uint256() ==
+            closed->info().accountHash);
+        BEAST_EXPECT(
+            ledger->txMap().getHash().as_uint256() == closed->info().txHash);
+    }
+
     void
     run() override
     {
         testHandleMismatch();
+        testOpenFromHeader();
     }
 };
 
@@ -227,6 +227,11 @@ public:
     {
         return 0;
     }
+    std::optional<std::chrono::milliseconds>
+    responseTime() const override
+    {
+        return {};
+    }
     PublicKey const&
     getNodePublic() const override
     {
@@ -847,6 +852,7 @@ struct NetworkOfTwo
  * -- replay a range of ledgers and fallback to InboundLedgers because
  *    peers do not support ProtocolFeature::LedgerReplay
  * -- replay a range of ledgers and the network drops or repeats messages
+ * -- replay a range of ledgers through a delta window smaller than the range
  * -- call onStop() and the tasks and subtasks are removed
  * -- process a bad skip list
  * -- process a bad ledger delta
@@ -1060,6 +1066,34 @@ struct LedgerReplayer_test : public beast::unit_test::suite
             c.loadFromString(toLoad);
             BEAST_EXPECT(c.LEDGER_REPLAY == false);
         }
+
+        {
+            Config c;
+            BEAST_EXPECT(c.LEDGER_REPLAY_WINDOW == 32);
+            std::string toLoad = (R"rippleConfig(
+[ledger_replay_window]
+4
+)rippleConfig");
+            c.loadFromString(toLoad);
+            BEAST_EXPECT(c.LEDGER_REPLAY_WINDOW == 4);
+        }
+
+        {
+            Config c;
+            std::string toLoad = (R"rippleConfig(
+[ledger_replay_window]
+0
+)rippleConfig");
+            try
+            {
+                c.loadFromString(toLoad);
+                fail();
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+        }
     }
 
     void
@@ -1227,6 +1261,41 @@ struct LedgerReplayer_test : public beast::unit_test::suite
         BEAST_EXPECT(net.client.countsAsExpected(0, 0, 0));
     }
 
+    void
+    testDeltaWindow()
+    {
+        testcase("delta window smaller than the task");
+        int totalReplay = 10;
+        NetworkOfTwo net(
+            *this,
+            {totalReplay + 1},
+            PeerSetBehavior::Drop50,
+            InboundLedgersBehavior::DropAll,
+            PeerFeature::LedgerReplayEnabled);
+        net.client.app.config().LEDGER_REPLAY_WINDOW = 2;
+
+        auto l = net.server.ledgerMaster.getClosedLedger();
+        uint256 finalHash = l->info().hash;
+        for (int i = 0; i < totalReplay - 1; ++i)
+        {
+            l = net.server.ledgerMaster.getLedgerByHash(l->info().parentHash);
+        }
+        net.client.ledgerMaster.storeLedger(l);
+
+        net.client.replayer.replay(
+            InboundLedger::Reason::GENERIC, finalHash, totalReplay);
+
+        std::vector<TaskStatus> deltaStatuses(
+            totalReplay - 1, TaskStatus::Completed);
+        BEAST_EXPECT(net.client.waitAndCheckStatus(
+            finalHash,
+            totalReplay,
+            TaskStatus::Completed,
+            TaskStatus::Completed,
+            deltaStatuses));
+        BEAST_EXPECT(net.client.waitForLedgers(finalHash, totalReplay));
+    }
+
     void
     testOnStop()
     {
@@ -1276,7 +1345,8 @@ struct LedgerReplayer_test : public beast::unit_test::suite
             InboundLedger::Reason::GENERIC, finalHash, totalReplay);
 
         auto skipList = net.client.findSkipListAcquire(finalHash);
-        auto item = std::make_shared<SHAMapItem>(uint256(12345), Blob(55, 55));
+        auto item =
+            make_shamapitem(uint256(12345), makeSlice(Blob(55, 55)));
         skipList->processData(l->seq(), item);
 
         std::vector<TaskStatus> deltaStatuses;
@@ -1436,6 +1506,7 @@ struct LedgerReplayer_test : public beast::unit_test::suite
         testPeerSetBehavior(PeerSetBehavior::Good);
         testPeerSetBehavior(PeerSetBehavior::Drop50);
         testPeerSetBehavior(PeerSetBehavior::Repeat);
+        testDeltaWindow();
         testOnStop();
         testSkipListBadReply();
         testLedgerDeltaBadReply();
@@ -27,6 +27,7 @@
 #include <ripple/protocol/STExchange.h>
 #include <ripple/protocol/SecretKey.h>
 #include <ripple/protocol/Sign.h>
+#include <ripple/protocol/digest.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/utility/in_place_factory.hpp>
@@ -948,6 +949,29 @@ public:
             ".example.com"));
     }
 
+    void
+    testSignatureCheckCache()
+    {
+        testcase("signature check cache");
+
+        SignatureCheckCache checks{2};
+        auto const a = sha512Half(std::uint32_t{1});
+        auto const b = sha512Half(std::uint32_t{2});
+        auto const c = sha512Half(std::uint32_t{3});
+        BEAST_EXPECT(!checks.find(a));
+
+        checks.insert(a, true);
+        checks.insert(b, false);
+        BEAST_EXPECT(checks.find(a) == true);
+        BEAST_EXPECT(checks.find(b) == false);
+
+        // A full cache starts over
+        checks.insert(c, true);
+        BEAST_EXPECT(!checks.find(a));
+        BEAST_EXPECT(!checks.find(b));
+        BEAST_EXPECT(checks.find(c) == true);
+    }
+
     void
     run() override
     {
@@ -1022,7 +1046,18 @@ public:
             BEAST_EXPECT(
                 cache.applyManifest(clone(s_b2)) ==
                 ManifestDisposition::invalid);
+
+            // The outcome of a signature check is remembered
+            BEAST_EXPECT(!cache.checkSignatures(s_b2));
+            BEAST_EXPECT(
+                cache.applyManifest(clone(s_b2)) ==
+                ManifestDisposition::invalid);
+            BEAST_EXPECT(cache.checkSignatures(s_b1));
+            BEAST_EXPECT(
+                cache.applyManifest(clone(s_b1)) ==
+                ManifestDisposition::accepted);
         }
+        testSignatureCheckCache();
         testLoadStore(cache);
         testGetSignature();
         testGetKeys();
@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/MemoryBudget.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/beast/unit_test.h>
+#include <test/unit_test/SuiteJournal.h>
+
+namespace ripple {
+namespace test {
+
+class MemoryBudget_test : public beast::unit_test::suite
+{
+    // Just enough of TaggedCache for the budget to manage
+    struct FakeCache
+    {
+        int target;
+        std::size_t size;
+        float hitRate;
+
+        int
+        getTargetSize() const
+        {
+            return target;
+        }
+
+        void
+        setTargetSize(int s)
+        {
+            target = s;
+        }
+
+        std::size_t
+        getCacheSize() const
+        {
+            return size;
+        }
+
+        float
+        getHitRate() const
+        {
+            return hitRate;
+        }
+    };
+
+    static constexpr std::uint64_t budget = 2000000;
+
+    void
+    testPressure()
+    {
+        testcase("Pressure");
+        SuiteJournal journal("MemoryBudget_test", *this);
+
+        FakeCache cold{1000, 1000, 10};
+        FakeCache hot{1000, 1000, 90};
+        MemoryBudget mb(budget, journal);
+        mb.add("cold", cold, 1000);
+        mb.add("hot", hot, 1000);
+
+        // Within the budget nothing changes
+        mb.rebalance(budget);
+        BEAST_EXPECT(cold.target == 1000 && hot.target == 1000);
+
+        // 500KB over 80% of the budget comes out of the cold cache
+        mb.rebalance(budget + 100000);
+        BEAST_EXPECT(cold.target == 500);
+        BEAST_EXPECT(hot.target == 1000);
+
+        // A cache is never cut below an eighth of its ceiling
+        mb.rebalance(10 * budget);
+        BEAST_EXPECT(cold.target == 125);
+        BEAST_EXPECT(hot.target == 125);
+
+        // Below 80% of the budget targets grow back an eighth at a time,
+        // as far as the room allows
+        mb.rebalance(budget / 2);
+        BEAST_EXPECT(hot.target == 250);
+        BEAST_EXPECT(cold.target == 250);
+        mb.rebalance(budget - budget / 5 - 200000);
+        BEAST_EXPECT(hot.target == 375);
+        BEAST_EXPECT(cold.target == 325);
+
+        for (int i = 0; i < 10; ++i)
+            mb.rebalance(0);
+        BEAST_EXPECT(cold.target == 1000 && hot.target == 1000);
+    }
+
+    void
+    testHeld()
+    {
+        testcase("Held");
+        SuiteJournal journal("MemoryBudget_test", *this);
+
+        // Cuts come from what a cache holds, not its target
+        FakeCache cache{1000, 400, 50};
+        MemoryBudget mb(budget, journal);
+        mb.add("cache", cache, 5000);
+        mb.rebalance(budget + 100000);
+        BEAST_EXPECT(cache.target == 300);
+
+        // Caches without a target are left alone
+        FakeCache unbounded{0, 5000, 0};
+        mb.add("unbounded", unbounded, 1000);
+        mb.rebalance(10 * budget);
+        BEAST_EXPECT(unbounded.target == 0);
+        BEAST_EXPECT(cache.target == 125);
+
+        auto const json = mb.getJson();
+        BEAST_EXPECT(json["caches"].isMember("cache"));
+        BEAST_EXPECT(!json["caches"].isMember("unbounded"));
+    }
+
+    void
+    testDisabled()
+    {
+        testcase("Disabled");
+        SuiteJournal journal("MemoryBudget_test", *this);
+
+        FakeCache cache{1000, 1000, 0};
+        MemoryBudget mb(0, journal);
+        mb.add("cache", cache, 1000);
+        mb.rebalance(10 * budget);
+        BEAST_EXPECT(cache.target == 1000);
+
+        Config config;
+        config.MEMORY_BUDGET = 100;
+        BEAST_EXPECT(setup_MemoryBudget(config) == megabytes(100));
+    }
+
+public:
+    void
+    run() override
+    {
+        testPressure();
+        testHeld();
+        testDisabled();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MemoryBudget, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
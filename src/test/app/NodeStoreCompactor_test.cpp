@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/TxIndex.h>
+#include <ripple/app/misc/NodeStoreCompactor.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/core/WorkerPool.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/shamap/SHAMap.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <set>
+
+namespace ripple {
+namespace test {
+
+class NodeStoreCompactor_test : public beast::unit_test::suite
+{
+    beast::xor_shift_engine eng_;
+
+    boost::intrusive_ptr<SHAMapItem>
+    makeItem(uint256 const& key)
+    {
+        Serializer s;
+        for (int d = 0; d < 4; ++d)
+            s.add32(rand_int<std::uint32_t>(eng_));
+        return make_shamapitem(key, s.slice());
+    }
+
+    static uint256
+    keyOf(int i)
+    {
+        return sha512Half(std::uint32_t(i));
+    }
+
+    // Store a ledger header for a tree, the way Ledger saves one
+    static uint256
+    storeHeader(NodeStore::Database& db, SHAMap const& map, std::uint32_t seq)
+    {
+        LedgerInfo info;
+        info.seq = seq;
+        info.accountHash = map.getHash().as_uint256();
+        info.hash = sha512Half(HashPrefix::ledgerMaster, seq);
+
+        Serializer s;
+        s.add32(HashPrefix::ledgerMaster);
+        addRaw(info, s);
+        db.store(hotLEDGER, std::move(s.modData()), info.hash, seq);
+        return info.hash;
+    }
+
+    static void
+    storeTxIndex(
+        NodeStore::Database& db,
+        int tx,
+        std::uint32_t seq,
+        uint256 const& node)
+    {
+        Serializer s;
+        s.add32(seq);
+        s.add32(0);
+        s.addBitString(node);
+        db.store(
+            hotTX_INDEX, std::move(s.modData()), txIndexKey(keyOf(tx)), seq);
+    }
+
+    static std::set<uint256>
+    nodesOf(SHAMap const& map)
+    {
+        std::set<uint256> nodes;
+        map.visitNodes([&nodes](SHAMapTreeNode& node) {
+            nodes.insert(node.getHash().as_uint256());
+            return true;
+        });
+        return nodes;
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace NodeStore;
+
+        SuiteJournal journal("NodeStoreCompactor_test", *this);
+        tests::TestNodeFamily f(journal);
+        auto& db = f.db();
+
+        // Three ledgers, each changing some of the entries of the last
+        SHAMap first(SHAMapType::STATE, f);
+        for (int i = 0; i < 500; ++i)
+            first.addItem(SHAMapNodeType::tnACCOUNT_STATE, makeItem(keyOf(i)));
+        first.flushDirty(hotACCOUNT_NODE);
+
+        auto second = first.snapShot(true);
+        for (int i = 0; i < 50; ++i)
+            second->updateGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE, makeItem(keyOf(i)));
+        second->flushDirty(hotACCOUNT_NODE);
+
+        auto third = second->snapShot(true);
+        for (int i = 450; i < 550; ++i)
+        {
+            if (i < 500)
+                third->delItem(keyOf(i));
+            else
+                third->addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE, makeItem(keyOf(i)));
+        }
+        third->flushDirty(hotACCOUNT_NODE);
+
+        storeHeader(db, first, 1);
+        auto const secondHash = storeHeader(db, *second, 2);
+        auto const thirdHash = storeHeader(db, *third, 3);
+
+        auto const firstNodes = nodesOf(first);
+        auto keptNodes = nodesOf(*second);
+        for (auto const& hash : nodesOf(*third))
+            keptNodes.insert(hash);
+
+        std::vector<uint256> dropped;
+        for (auto const& hash : firstNodes)
+        {
+            if (keptNodes.count(hash) == 0)
+                dropped.push_back(hash);
+        }
+        BEAST_EXPECT(!dropped.empty());
+
+        // One index entry points into a kept tree, one into a dropped one
+        storeTxIndex(db, 1, 3, *keptNodes.begin());
+        storeTxIndex(db, 2, 1, dropped.front());
+
+        WorkerPool workers(3);
+        NodeStoreCompactor compactor(db, journal);
+        auto const found = compactor.mark(
+            {secondHash, thirdHash, sha512Half(HashPrefix::ledgerMaster, 9u)},
+            workers);
+        BEAST_EXPECT(found == 2);
+        BEAST_EXPECT(compactor.missing() == 0);
+
+        // Every node of the kept trees, and their headers
+        BEAST_EXPECT(compactor.marked().objects == keptNodes.size() + 2);
+
+        // Counting only leaves nothing behind
+        auto const counted = compactor.sweep(nullptr);
+        BEAST_EXPECT(counted.live.objects == compactor.marked().objects + 1);
+        BEAST_EXPECT(
+            counted.total.objects >= counted.live.objects + dropped.size() + 2);
+        BEAST_EXPECT(counted.total.bytes > counted.live.bytes);
+
+        DummyScheduler scheduler;
+        Section section;
+        section.set("type", "memory");
+        section.set("path", "NodeStoreCompactor_test");
+        auto dest = Manager::instance().make_Backend(
+            section, megabytes(4), scheduler, journal);
+        dest->open();
+
+        auto const copied = compactor.sweep(dest.get());
+        BEAST_EXPECT(copied.failed == 0);
+        BEAST_EXPECT(copied.live.objects == counted.live.objects);
+
+        auto has = [&dest](uint256 const& hash) {
+            std::shared_ptr<NodeObject> object;
+            return dest->fetch(hash.data(), &object) == ok && object;
+        };
+        for (auto const& hash : keptNodes)
+            BEAST_EXPECT(has(hash));
+        for (auto const& hash : dropped)
+            BEAST_EXPECT(!has(hash));
+        BEAST_EXPECT(has(secondHash) && has(thirdHash));
+        BEAST_EXPECT(!has(sha512Half(HashPrefix::ledgerMaster, 1u)));
+        BEAST_EXPECT(has(txIndexKey(keyOf(1))));
+        BEAST_EXPECT(!has(txIndexKey(keyOf(2))));
+
+        // A kept tree is whole in the compacted store
+        std::size_t copiedObjects = 0;
+        dest->for_each([&](std::shared_ptr<NodeObject>) { ++copiedObjects; });
+        BEAST_EXPECT(copiedObjects == copied.live.objects);
+        dest->close();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(NodeStoreCompactor, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/misc/SignatureCache.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/protocol/digest.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class SignatureCache_test : public beast::unit_test::suite
+{
+    static uint256
+    makeKey(std::uint32_t i)
+    {
+        return SignatureCache::key(sha512Half(i), Slice{}, Slice{});
+    }
+
+    void
+    testBasics()
+    {
+        testcase("Basics");
+
+        SignatureCache cache(4);
+        auto const a = makeKey(1);
+        BEAST_EXPECT(!cache.contains(a));
+        BEAST_EXPECT(cache.misses() == 1);
+
+        cache.insert(a);
+        BEAST_EXPECT(cache.contains(a));
+        BEAST_EXPECT(cache.hits() == 1);
+        BEAST_EXPECT(cache.size() == 1);
+
+        // A failed check is not remembered, a good one is
+        int checks = 0;
+        auto const b = makeKey(2);
+        auto failing = [&] {
+            ++checks;
+            return false;
+        };
+        auto passing = [&] {
+            ++checks;
+            return true;
+        };
+        BEAST_EXPECT(!cache.verify(b, failing));
+        BEAST_EXPECT(cache.verify(b, passing));
+        BEAST_EXPECT(cache.verify(b, passing));
+        BEAST_EXPECT(checks == 2);
+
+        // The key depends on everything the outcome depends on
+        auto const digest = sha512Half(std::uint32_t(3));
+        Blob const pk(33, 2);
+        Blob const sig(70, 1);
+        auto const k =
+            SignatureCache::key(digest, makeSlice(pk), makeSlice(sig));
+        BEAST_EXPECT(
+            k != SignatureCache::key(digest, makeSlice(pk), makeSlice(sig), 1));
+        BEAST_EXPECT(k != SignatureCache::key(digest, makeSlice(pk), Slice{}));
+    }
+
+    void
+    testEviction()
+    {
+        testcase("Eviction");
+
+        SignatureCache cache(4);
+        for (std::uint32_t i = 0; i < 10; ++i)
+            cache.insert(makeKey(i));
+        BEAST_EXPECT(cache.size() == 4);
+
+        // The oldest entries went first
+        for (std::uint32_t i = 0; i < 6; ++i)
+            BEAST_EXPECT(!cache.contains(makeKey(i)));
+        for (std::uint32_t i = 6; i < 10; ++i)
+            BEAST_EXPECT(cache.contains(makeKey(i)));
+
+        auto const json = cache.getJson();
+        BEAST_EXPECT(json["size"].asUInt() == 4);
+        BEAST_EXPECT(json["evictions"].asString() == "6");
+        BEAST_EXPECT(json["hits"].asString() == "4");
+        BEAST_EXPECT(json["misses"].asString() == "6");
+    }
+
+    void
+    testTransactions()
+    {
+        testcase("Transactions");
+
+        using namespace jtx;
+        Env env(*this);
+        Account const alice("alice");
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        auto const good = env.jt(pay(alice, env.master, XRP(1))).stx;
+        STObject obj(*env.jt(pay(alice, env.master, XRP(2))).stx);
+        auto sig = obj.getFieldVL(sfTxnSignature);
+        sig[sig.size() / 2] ^= 0x01;
+        obj.setFieldVL(sfTxnSignature, sig);
+        auto const bad = std::make_shared<STTx const>(std::move(obj));
+
+        auto const rules = env.current()->rules();
+        SignatureCache cache;
+        auto check = [&](STTx const& tx) {
+            // A router that has never seen the transaction, as after
+            // its entry expires
+            HashRouter router(
+                stopwatch(),
+                HashRouter::getDefaultHoldTime(),
+                HashRouter::getDefaultRecoverLimit());
+            return checkValidity(router, cache, tx, rules, env.app().config())
+                .first;
+        };
+
+        BEAST_EXPECT(check(*good) == Validity::Valid);
+        BEAST_EXPECT(cache.hits() == 0);
+        BEAST_EXPECT(check(*good) == Validity::Valid);
+        BEAST_EXPECT(cache.hits() == 1);
+
+        BEAST_EXPECT(check(*bad) == Validity::SigBad);
+        BEAST_EXPECT(check(*bad) == Validity::SigBad);
+        BEAST_EXPECT(cache.hits() == 1);
+        BEAST_EXPECT(cache.size() == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBasics();
+        testEviction();
+        testTransactions();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SignatureCache, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
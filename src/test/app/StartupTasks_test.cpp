@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/StartupTasks.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/core/WorkerPool.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+namespace ripple {
+namespace test {
+
+class StartupTasks_test : public beast::unit_test::suite
+{
+    WorkerPool workers_{2};
+
+    void
+    testOrder()
+    {
+        testcase("Order");
+        SuiteJournal journal("StartupTasks_test", *this);
+
+        StartupTasks tasks(workers_, journal);
+        std::mutex mutex;
+        std::condition_variable cond;
+        int arrived = 0;
+        std::atomic<bool> together = false;
+        std::atomic<bool> afterBoth = false;
+
+        // Each of the first two waits for the other, which only finishes
+        // in time if they run at the same time
+        auto meet = [&]() {
+            std::unique_lock lock(mutex);
+            ++arrived;
+            cond.notify_all();
+            if (cond.wait_for(lock, std::chrono::seconds(10), [&]() {
+                    return arrived == 2;
+                }))
+                together = true;
+            return true;
+        };
+        tasks.add("a", {}, meet);
+        tasks.add("b", {}, meet);
+        tasks.add("c", {"a", "b"}, [&]() {
+            std::lock_guard lock(mutex);
+            afterBoth = arrived == 2;
+            return true;
+        });
+
+        BEAST_EXPECT(tasks.run());
+        BEAST_EXPECT(together);
+        BEAST_EXPECT(afterBoth);
+
+        auto const durations = tasks.durations();
+        BEAST_EXPECT(durations.size() == 3);
+        if (durations.size() == 3)
+        {
+            BEAST_EXPECT(durations[0].first == "a");
+            BEAST_EXPECT(durations[1].first == "b");
+            BEAST_EXPECT(durations[2].first == "c");
+        }
+    }
+
+    void
+    testFailure()
+    {
+        testcase("Failure");
+        SuiteJournal journal("StartupTasks_test", *this);
+
+        StartupTasks tasks(workers_, journal);
+        std::atomic<int> ran = 0;
+        tasks.add("fails", {}, [&]() {
+            ++ran;
+            return false;
+        });
+        tasks.add("after", {"fails"}, [&]() {
+            ++ran;
+            return true;
+        });
+
+        BEAST_EXPECT(!tasks.run());
+        BEAST_EXPECT(ran == 1);
+        auto const durations = tasks.durations();
+        BEAST_EXPECT(
+            durations.size() == 1 && durations.front().first == "fails");
+    }
+
+    void
+    testException()
+    {
+        testcase("Exception");
+        SuiteJournal journal("StartupTasks_test", *this);
+
+        StartupTasks tasks(workers_, journal);
+        tasks.add("throws", {}, []() -> bool {
+            throw std::runtime_error("startup");
+        });
+
+        try
+        {
+            tasks.run();
+            fail("no exception");
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(std::string(e.what()) == "startup");
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testOrder();
+        testFailure();
+        testException();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(StartupTasks, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
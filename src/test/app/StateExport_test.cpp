@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <boost/filesystem.hpp>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class StateExport_test : public beast::unit_test::suite
+{
+    struct Record
+    {
+        uint256 key;
+        std::uint16_t type;
+        Blob data;
+    };
+
+    // A ledger with enough entries to fill many small blocks
+    std::shared_ptr<Ledger const>
+    makeLedger(jtx::Env& env)
+    {
+        using namespace jtx;
+        Account const gw("gw");
+        env.fund(XRP(100000), gw);
+        env.close();
+        for (int i = 0; i < 40; ++i)
+        {
+            Account const a("a" + std::to_string(i));
+            env.fund(XRP(1000), a);
+            env.close();
+            env(trust(a, gw["USD"](100)));
+            env(pay(gw, a, gw["USD"](10)));
+            env.close();
+        }
+        return std::dynamic_pointer_cast<Ledger const>(env.closed());
+    }
+
+    std::vector<Record>
+    readAll(std::string const& path, StateExport::Summary& summary)
+    {
+        std::vector<Record> records;
+        summary = StateExport::read(path, [&](StateExport::Entry const& e) {
+            records.push_back(
+                {e.key, e.type, Blob(e.data.begin(), e.data.end())});
+        });
+        return records;
+    }
+
+    void
+    testRoundTrip()
+    {
+        testcase("Round trip");
+        using namespace jtx;
+
+        Env env(*this);
+        SuiteJournal journal("StateExport_test", *this);
+        auto const ledger = makeLedger(env);
+        if (!BEAST_EXPECT(ledger))
+            return;
+
+        std::vector<Record> expected;
+        for (auto const& item : ledger->stateMap())
+        {
+            auto const sle = std::make_shared<SLE const>(
+                SerialIter{item.data(), item.size()}, item.key());
+            expected.push_back(
+                {item.key(),
+                 static_cast<std::uint16_t>(sle->getType()),
+                 Blob(item.slice().begin(), item.slice().end())});
+        }
+
+        beast::temp_dir dir;
+        for (std::size_t const threads : {1, 4})
+        {
+            auto const path = dir.file("state.lexp");
+            auto const written = StateExport::write(
+                ledger->stateMap(),
+                ledger->info(),
+                path,
+                threads,
+                env.app().getWorkerPool(),
+                journal,
+                512);
+
+            BEAST_EXPECT(written.entries == expected.size());
+            BEAST_EXPECT(written.blocks > 8);
+            BEAST_EXPECT(written.bytes == boost::filesystem::file_size(path));
+            BEAST_EXPECT(!boost::filesystem::exists(path + ".tmp"));
+
+            StateExport::Summary read;
+            auto const records = readAll(path, read);
+            BEAST_EXPECT(read.ledgerSeq == ledger->info().seq);
+            BEAST_EXPECT(read.ledgerHash == ledger->info().hash);
+            BEAST_EXPECT(read.accountHash == ledger->info().accountHash);
+            BEAST_EXPECT(read.entries == written.entries);
+            BEAST_EXPECT(read.blocks == written.blocks);
+            BEAST_EXPECT(read.rawBytes == written.rawBytes);
+
+            // Entries come back in key order, however the blocks were written
+            if (!BEAST_EXPECT(records.size() == expected.size()))
+                continue;
+            for (std::size_t i = 0; i < records.size(); ++i)
+            {
+                BEAST_EXPECT(records[i].key == expected[i].key);
+                BEAST_EXPECT(records[i].type == expected[i].type);
+                BEAST_EXPECT(records[i].data == expected[i].data);
+            }
+        }
+    }
+
+    void
+    testDamaged()
+    {
+        testcase("Damaged");
+        using namespace jtx;
+
+        Env env(*this);
+        SuiteJournal journal("StateExport_test", *this);
+        auto const ledger = makeLedger(env);
+        if (!BEAST_EXPECT(ledger))
+            return;
+
+        beast::temp_dir dir;
+        auto const path = dir.file("state.lexp");
+        auto const written = StateExport::write(
+            ledger->stateMap(),
+            ledger->info(),
+            path,
+            2,
+            env.app().getWorkerPool(),
+            journal,
+            512);
+
+        // An export missing its end is not read
+        boost::filesystem::resize_file(path, written.bytes - 1);
+        StateExport::Summary read;
+        try
+        {
+            readAll(path, read);
+            fail("truncated export read");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+
+        // Failing to write leaves nothing behind
+        auto const missing = dir.file("missing/state.lexp");
+        try
+        {
+            StateExport::write(
+                ledger->stateMap(),
+                ledger->info(),
+                missing,
+                2,
+                env.app().getWorkerPool(),
+                journal);
+            fail("export to a missing directory");
+        }
+        catch (std::exception const&)
+        {
+            pass();
+        }
+        BEAST_EXPECT(!boost::filesystem::exists(missing));
+    }
+
+    void
+    testRPC()
+    {
+        testcase("RPC");
+        using namespace jtx;
+
+        Env env(*this);
+        auto const ledger = makeLedger(env);
+        if (!BEAST_EXPECT(ledger))
+            return;
+
+        beast::temp_dir dir;
+        auto const path = dir.file("state.lexp");
+
+        Json::Value params;
+        params[jss::ledger_hash] = to_string(ledger->info().hash);
+        auto result = env.rpc(
+            "json", "ledger_export", to_string(params))[jss::result];
+        BEAST_EXPECT(result[jss::error] == "invalidParams");
+
+        params[jss::path] = path;
+        params[jss::threads] = 0;
+        result = env.rpc(
+            "json", "ledger_export", to_string(params))[jss::result];
+        BEAST_EXPECT(result[jss::error] == "invalidParams");
+
+        params[jss::threads] = 3;
+        result = env.rpc(
+            "json", "ledger_export", to_string(params))[jss::result];
+        BEAST_EXPECT(result[jss::status] == "success");
+        BEAST_EXPECT(result[jss::path] == path);
+        BEAST_EXPECT(
+            result[jss::ledger_index].asUInt() == ledger->info().seq);
+        BEAST_EXPECT(result[jss::blocks].asUInt() >= 1);
+
+        StateExport::Summary read;
+        auto const records = readAll(path, read);
+        BEAST_EXPECT(std::to_string(read.entries) == result[jss::entries]);
+        BEAST_EXPECT(std::to_string(read.bytes) == result[jss::bytes]);
+        BEAST_EXPECT(records.size() == read.entries);
+        BEAST_EXPECT(to_string(read.ledgerHash) == result[jss::ledger_hash]);
+    }
+
+public:
+    void
+    run() override
+    {
+        testRoundTrip();
+        testDamaged();
+        testRPC();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(StateExport, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
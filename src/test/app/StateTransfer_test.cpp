@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/StateTransfer.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/overlay/impl/Handshake.h>
+#include <ripple/protocol/digest.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <map>
+
+namespace ripple {
+namespace test {
+
+class StateTransfer_test : public beast::unit_test::suite
+{
+    using Result = StateTransfer::Result;
+
+    beast::xor_shift_engine eng_;
+
+    std::shared_ptr<SHAMap>
+    makeMap(Family& f, std::uint32_t count)
+    {
+        auto map = std::make_shared<SHAMap>(SHAMapType::STATE, f);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            Serializer s;
+            for (int d = 0; d < 16; ++d)
+                s.add32(rand_int<std::uint32_t>(eng_));
+            map->addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(sha512Half(i), s.slice()));
+        }
+        return map;
+    }
+
+    static uint256 const&
+    ledgerHash()
+    {
+        static uint256 const hash = sha512Half(std::string("ledger"));
+        return hash;
+    }
+
+    void
+    testTransfer()
+    {
+        testcase("Transfer");
+
+        SuiteJournal journal("StateTransfer_test", *this);
+        tests::TestNodeFamily f(journal);
+        auto const source = makeMap(f, 5000);
+
+        // Each range takes two replies
+        StateTransfer transfer(ledgerHash(), source->getHash(), f, 2);
+        std::map<std::uint32_t, protocol::TMGetStateRange> asked;
+        for (std::uint32_t peer = 1; peer <= 2; ++peer)
+        {
+            auto const request = transfer.nextRequest(peer);
+            if (BEAST_EXPECT(request))
+                asked.emplace(peer, *request);
+        }
+        BEAST_EXPECT(!transfer.nextRequest(3));
+        BEAST_EXPECT(transfer.waiting());
+
+        std::size_t replies = 0;
+        while (!asked.empty())
+        {
+            auto const [peer, request] = *asked.begin();
+            asked.erase(asked.begin());
+
+            auto const reply = StateTransfer::makeReply(source.get(), request);
+            BEAST_EXPECT(!reply.has_error());
+            BEAST_EXPECT(reply.leaves_size() <= StateTransfer::replyLeaves);
+            BEAST_EXPECT(transfer.take(peer, reply) == Result::useful);
+            BEAST_EXPECT(transfer.take(peer, reply) == Result::stale);
+            ++replies;
+
+            if (auto const next = transfer.nextRequest(peer))
+                asked.emplace(peer, *next);
+        }
+
+        BEAST_EXPECT(replies == 4);
+        BEAST_EXPECT(transfer.complete());
+        BEAST_EXPECT(!transfer.waiting());
+        BEAST_EXPECT(transfer.leaves() == 5000);
+        auto const map = transfer.finish();
+        BEAST_EXPECT(map && map->getHash() == source->getHash());
+    }
+
+    void
+    testBadReplies()
+    {
+        testcase("Bad replies");
+
+        SuiteJournal journal("StateTransfer_test", *this);
+        tests::TestNodeFamily f(journal);
+        auto const source = makeMap(f, 2000);
+        StateTransfer transfer(ledgerHash(), source->getHash(), f);
+
+        auto const request = transfer.nextRequest(1);
+        if (!BEAST_EXPECT(request))
+            return;
+        auto const good = StateTransfer::makeReply(source.get(), *request);
+        BEAST_EXPECT(good.leaves_size() > 1 && !good.has_next());
+
+        // Only the peer asked is listened to
+        BEAST_EXPECT(transfer.take(2, good) == Result::stale);
+
+        auto swapped = good;
+        swapped.mutable_leaves()->SwapElements(0, 1);
+        BEAST_EXPECT(transfer.take(1, swapped) == Result::bad);
+        BEAST_EXPECT(!transfer.usable(1));
+        BEAST_EXPECT(!transfer.nextRequest(1));
+
+        // The range is asked of another peer, which strays out of it
+        auto const again = transfer.nextRequest(2);
+        BEAST_EXPECT(again && again->marker() == request->marker());
+        auto outside = good;
+        uint256 last;
+        last.data()[0] = 0xFF;
+        auto leaf = outside.add_leaves();
+        leaf->set_key(last.begin(), last.size());
+        leaf->set_data("x");
+        BEAST_EXPECT(transfer.take(2, outside) == Result::bad);
+
+        auto const third = transfer.nextRequest(3);
+        BEAST_EXPECT(third && third->marker() == request->marker());
+        BEAST_EXPECT(
+            transfer.take(3, StateTransfer::makeReply(nullptr, *third)) ==
+            Result::refused);
+        BEAST_EXPECT(!transfer.usable(3));
+
+        // A question the server can't parse
+        auto malformed = *request;
+        malformed.set_marker("short");
+        BEAST_EXPECT(
+            StateTransfer::makeReply(source.get(), malformed).error() ==
+            protocol::TMReplyError::reBAD_REQUEST);
+
+        // Unanswered for a whole interval, the range is asked again
+        auto const fourth = transfer.nextRequest(4);
+        BEAST_EXPECT(fourth && fourth->marker() == request->marker());
+        transfer.timeout();
+        auto const fifth = transfer.nextRequest(5);
+        BEAST_EXPECT(fifth && fifth->marker() != request->marker());
+        transfer.timeout();
+        auto const sixth = transfer.nextRequest(6);
+        BEAST_EXPECT(sixth && sixth->marker() == request->marker());
+        BEAST_EXPECT(transfer.take(4, good) == Result::stale);
+        BEAST_EXPECT(transfer.take(6, good) == Result::useful);
+        BEAST_EXPECT(transfer.leaves() == good.leaves_size());
+        BEAST_EXPECT(!transfer.complete());
+    }
+
+    void
+    testMismatch()
+    {
+        testcase("Mismatch");
+
+        SuiteJournal journal("StateTransfer_test", *this);
+        tests::TestNodeFamily f(journal);
+        auto const source = makeMap(f, 100);
+        auto const other = makeMap(f, 100);
+
+        // Leaves that don't hash to the header are not taken
+        StateTransfer transfer(ledgerHash(), other->getHash(), f, 1);
+        auto const request = transfer.nextRequest(1);
+        if (!BEAST_EXPECT(request))
+            return;
+        BEAST_EXPECT(!request->has_end());
+        BEAST_EXPECT(
+            transfer.take(
+                1, StateTransfer::makeReply(source.get(), *request)) ==
+            Result::useful);
+        BEAST_EXPECT(transfer.complete());
+        BEAST_EXPECT(!transfer.finish());
+    }
+
+    void
+    testHandshake()
+    {
+        testcase("Handshake");
+
+        auto negotiate = [this](bool outbound, bool inbound) {
+            http_request_type request;
+            request.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesRequestHeader(
+                    true, true, true, true, true, true, outbound));
+            http_response_type response;
+            response.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesResponseHeader(
+                    request, true, true, true, true, true, true, inbound));
+
+            // The other features are still negotiated alongside
+            BEAST_EXPECT(featureEnabled(response, FEATURE_RELAY_BATCH));
+            return featureEnabled(response, FEATURE_STATE_TRANSFER);
+        };
+        BEAST_EXPECT(negotiate(true, true));
+        BEAST_EXPECT(!negotiate(true, false));
+        BEAST_EXPECT(!negotiate(false, true));
+    }
+
+public:
+    void
+    run() override
+    {
+        testTransfer();
+        testBadReplies();
+        testMismatch();
+        testHandshake();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(StateTransfer, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,225 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/TransactionFilter.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/SField.h>
+#include <ripple/protocol/UintTypes.h>
+#include <algorithm>
+
+namespace ripple {
+namespace test {
+
+class TransactionFilter_test : public beast::unit_test::suite
+{
+    static AccountID
+    account(std::uint8_t n)
+    {
+        AccountID id;
+        id.data()[0] = n;
+        return id;
+    }
+
+    static Currency
+    currency(char const* code)
+    {
+        Currency c;
+        to_currency(c, code);
+        return c;
+    }
+
+    static Issue
+    issue(char const* code, std::uint8_t issuer)
+    {
+        return {currency(code), account(issuer)};
+    }
+
+    static TransactionFilter::Subject
+    payment(
+        std::uint8_t from,
+        std::uint8_t to,
+        STAmount const& amount,
+        std::vector<Book> const& books = {})
+    {
+        STTx const tx(ttPAYMENT, [&](STObject& obj) {
+            obj.setAccountID(sfAccount, account(from));
+            obj.setAccountID(sfDestination, account(to));
+            obj.setFieldAmount(sfAmount, amount);
+            obj.setFieldAmount(sfFee, STAmount(10));
+        });
+        return TransactionFilter::subjectOf(
+            tx, {account(from), account(to)}, books);
+    }
+
+    static std::vector<std::uint64_t>
+    sorted(std::vector<std::uint64_t> v)
+    {
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+
+    void
+    testSubject()
+    {
+        testcase("Subject");
+
+        auto const usd = issue("USD", 9);
+        auto const s = payment(1, 2, STAmount(usd, 5));
+        BEAST_EXPECT(s.type == ttPAYMENT);
+        BEAST_EXPECT(s.accounts.size() == 2);
+        BEAST_EXPECT(s.amount && *s.amount == STAmount(usd, 5));
+
+        // The fee's currency is not among those of the transaction
+        BEAST_EXPECT(s.currencies.size() == 1);
+        BEAST_EXPECT(s.currencies.count(usd.currency) == 1);
+        BEAST_EXPECT(s.currencies.count(xrpCurrency()) == 0);
+    }
+
+    void
+    testMatches()
+    {
+        testcase("Matches");
+
+        auto const usd = issue("USD", 9);
+        auto const eur = issue("EUR", 9);
+        Book const book(usd, eur);
+        auto const a = payment(1, 2, STAmount(usd, 5), {book});
+        auto const b = payment(3, 4, STAmount(100));
+
+        {
+            TransactionFilter f;
+            BEAST_EXPECT(f.empty());
+            BEAST_EXPECT(f.matches(a) && f.matches(b));
+        }
+
+        {
+            // Any member of a set matches
+            TransactionFilter f;
+            f.addAccount(account(2));
+            f.addAccount(account(4));
+            BEAST_EXPECT(f.matches(a) && f.matches(b));
+            f.addType(ttOFFER_CREATE);
+            BEAST_EXPECT(!f.matches(a) && !f.matches(b));
+            f.addType(ttPAYMENT);
+            BEAST_EXPECT(f.matches(a) && f.matches(b));
+        }
+
+        {
+            // Every predicate must match
+            TransactionFilter f;
+            f.addCurrency(xrpCurrency());
+            BEAST_EXPECT(!f.matches(a) && f.matches(b));
+            f.addAccount(account(1));
+            BEAST_EXPECT(!f.matches(a) && !f.matches(b));
+        }
+
+        {
+            TransactionFilter f;
+            f.addBook(book);
+            BEAST_EXPECT(f.matches(a) && !f.matches(b));
+            TransactionFilter reversed;
+            reversed.addBook(Book(eur, usd));
+            BEAST_EXPECT(!reversed.matches(a));
+        }
+
+        {
+            // The minimum is of one issue
+            TransactionFilter f;
+            f.setMinAmount(STAmount(usd, 5));
+            BEAST_EXPECT(f.matches(a) && !f.matches(b));
+            f.setMinAmount(STAmount(usd, 6));
+            BEAST_EXPECT(!f.matches(a));
+            f.setMinAmount(STAmount(issue("USD", 8), 1));
+            BEAST_EXPECT(!f.matches(a));
+            f.setMinAmount(STAmount(50));
+            BEAST_EXPECT(!f.matches(a) && f.matches(b));
+        }
+    }
+
+    void
+    testIndex()
+    {
+        testcase("Index");
+
+        auto const usd = issue("USD", 9);
+        auto const eur = issue("EUR", 9);
+        Book const book(usd, eur);
+        auto const a = payment(1, 2, STAmount(usd, 5), {book});
+        auto const b = payment(3, 4, STAmount(100));
+
+        auto make = [](auto&& setup) {
+            auto f = std::make_shared<TransactionFilter>();
+            setup(*f);
+            return std::shared_ptr<TransactionFilter const>(std::move(f));
+        };
+
+        TransactionFilterIndex index;
+        BEAST_EXPECT(index.empty());
+        BEAST_EXPECT(index.matches(a).empty());
+
+        // Listed by account, though it has a type too
+        index.insert(1, make([](auto& f) {
+            f.addAccount(account(1));
+            f.addAccount(account(3));
+            f.addType(ttPAYMENT);
+        }));
+        index.insert(2, make([&](auto& f) { f.addBook(book); }));
+        index.insert(3, make([](auto& f) { f.addCurrency(xrpCurrency()); }));
+        index.insert(4, make([](auto& f) { f.addType(ttPAYMENT); }));
+        index.insert(
+            5, make([&](auto& f) { f.setMinAmount(STAmount(usd, 1)); }));
+        index.insert(6, make([](auto& f) { f.addType(ttTRUST_SET); }));
+        BEAST_EXPECT(index.size() == 6);
+
+        using list = std::vector<std::uint64_t>;
+        BEAST_EXPECT(sorted(index.matches(a)) == list({1, 2, 4, 5}));
+        BEAST_EXPECT(sorted(index.matches(b)) == list({1, 3, 4}));
+
+        // Replacing a filter lists it anew
+        index.insert(1, make([](auto& f) { f.addAccount(account(2)); }));
+        BEAST_EXPECT(index.size() == 6);
+        BEAST_EXPECT(sorted(index.matches(a)) == list({1, 2, 4, 5}));
+        BEAST_EXPECT(sorted(index.matches(b)) == list({3, 4}));
+
+        BEAST_EXPECT(index.erase(4));
+        BEAST_EXPECT(!index.erase(4));
+        BEAST_EXPECT(index.erase(5));
+        BEAST_EXPECT(sorted(index.matches(a)) == list({1, 2}));
+        BEAST_EXPECT(sorted(index.matches(b)) == list({3}));
+
+        for (std::uint64_t seq : {1, 2, 3, 6})
+            BEAST_EXPECT(index.erase(seq));
+        BEAST_EXPECT(index.empty());
+        BEAST_EXPECT(index.matches(a).empty());
+    }
+
+public:
+    void
+    run() override
+    {
+        testSubject();
+        testMatches();
+        testIndex();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TransactionFilter, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
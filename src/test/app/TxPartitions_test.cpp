@@ -0,0 +1,283 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/DBInit.h>
+#include <ripple/app/misc/TxPartitions.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/core/DatabaseCon.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <memory>
+
+namespace ripple {
+namespace test {
+
+class TxPartitions_test : public beast::unit_test::suite
+{
+    // A transaction database with two read connections, and its
+    // partitions
+    struct TxDB
+    {
+        std::unique_ptr<DatabaseCon> db;
+        std::unique_ptr<TxPartitions> partitions;
+
+        TxDB(beast::temp_dir const& dir, std::uint32_t ledgers)
+        {
+            DatabaseCon::Setup setup;
+            setup.dataDir = dir.path();
+            setup.readConnections = 2;
+            db = std::make_unique<DatabaseCon>(
+                setup, TxDBName, TxDBPragma, TxDBInit);
+            partitions = std::make_unique<TxPartitions>(
+                *db,
+                setup.dataDir,
+                std::vector<std::string>(TxDBPragma.begin(), TxDBPragma.end()),
+                ledgers,
+                beast::Journal{beast::Journal::getNullSink()});
+        }
+    };
+
+    static bool
+    exists(beast::temp_dir const& dir, std::string const& name)
+    {
+        return boost::filesystem::exists(dir.file(name));
+    }
+
+    // Write one transaction of account "A" to a ledger
+    static void
+    insert(TxDB& txdb, LedgerIndex seq)
+    {
+        auto const schema = txdb.partitions->schemaFor(seq);
+        auto const ledger = std::to_string(seq);
+        auto const id = std::string(64 - ledger.size(), '0') + ledger;
+
+        auto db = txdb.db->checkoutDb();
+        *db << "INSERT INTO " + schema +
+                ".Transactions (TransID, LedgerSeq, Status, RawTxn, "
+                "TxnMeta) VALUES ('" +
+                id + "', " + ledger + ", 'V', X'00', X'00');";
+        *db << "INSERT INTO " + schema +
+                ".AccountTransactions (TransID, Account, LedgerSeq, "
+                "TxnSeq) VALUES ('" +
+                id + "', 'A', " + ledger + ", 0);";
+    }
+
+    static int
+    count(soci::session& session, std::string const& from)
+    {
+        int n = 0;
+        session << "SELECT COUNT(*) FROM " + from + ";", soci::into(n);
+        return n;
+    }
+
+    void
+    testRotation()
+    {
+        testcase("Rotation");
+
+        beast::temp_dir dir;
+        {
+            TxDB txdb(dir, 100);
+            BEAST_EXPECT(
+                txdb.partitions->schemas() == std::vector<std::string>{"main"});
+
+            // A partition is created for each range the ledger reaches
+            BEAST_EXPECT(txdb.partitions->schemaFor(1005) == "tx1000");
+            BEAST_EXPECT(txdb.partitions->schemaFor(1099) == "tx1000");
+            BEAST_EXPECT(txdb.partitions->schemaFor(1100) == "tx1100");
+            BEAST_EXPECT(txdb.partitions->schemaFor(1250) == "tx1200");
+            BEAST_EXPECT(txdb.partitions->schemaFor(1150) == "tx1100");
+            BEAST_EXPECT(exists(dir, "transaction.1000.db"));
+            BEAST_EXPECT(exists(dir, "transaction.1100.db"));
+            BEAST_EXPECT(exists(dir, "transaction.1200.db"));
+
+            // Ledgers older than every partition go to the main file
+            BEAST_EXPECT(txdb.partitions->schemaFor(5) == "main");
+            BEAST_EXPECT(!exists(dir, "transaction.0.db"));
+
+            BEAST_EXPECT(
+                txdb.partitions->schemas() ==
+                std::vector<std::string>(
+                    {"main", "tx1000", "tx1100", "tx1200"}));
+
+            insert(txdb, 5);
+            insert(txdb, 1050);
+            insert(txdb, 1250);
+            auto db = txdb.db->checkoutDb();
+            BEAST_EXPECT(count(*db, "main.Transactions") == 1);
+            BEAST_EXPECT(count(*db, "tx1000.Transactions") == 1);
+            BEAST_EXPECT(count(*db, "tx1100.Transactions") == 0);
+            BEAST_EXPECT(count(*db, "Transactions") == 3);
+            BEAST_EXPECT(count(*db, "AccountTransactions") == 3);
+        }
+
+        // The partitions are attached again, and still read, when the
+        // database is reopened without partitioning
+        {
+            TxDB txdb(dir, 0);
+            BEAST_EXPECT(
+                txdb.partitions->schemas() ==
+                std::vector<std::string>(
+                    {"main", "tx1000", "tx1100", "tx1200"}));
+            BEAST_EXPECT(txdb.partitions->schemaFor(1300) == "main");
+            BEAST_EXPECT(!exists(dir, "transaction.1300.db"));
+
+            auto db = txdb.db->checkoutReadDb();
+            BEAST_EXPECT(count(*db, "Transactions") == 3);
+            BEAST_EXPECT(count(*db, "AccountTransactions") == 3);
+        }
+    }
+
+    void
+    testRetire()
+    {
+        testcase("Retire");
+
+        beast::temp_dir dir;
+        TxDB txdb(dir, 100);
+        insert(txdb, 50);
+        insert(txdb, 150);
+        insert(txdb, 250);
+        BEAST_EXPECT(txdb.partitions->schemas().size() == 4);
+
+        // Nothing is removed while any of its ledgers are kept
+        BEAST_EXPECT(txdb.partitions->retire(150) == 1);
+        BEAST_EXPECT(!exists(dir, "transaction.0.db"));
+        BEAST_EXPECT(exists(dir, "transaction.100.db"));
+        BEAST_EXPECT(
+            txdb.partitions->schemas() ==
+            std::vector<std::string>({"main", "tx100", "tx200"}));
+
+        // The newest partition is kept even if all its ledgers are gone
+        BEAST_EXPECT(txdb.partitions->retire(1000) == 1);
+        BEAST_EXPECT(!exists(dir, "transaction.100.db"));
+        BEAST_EXPECT(exists(dir, "transaction.200.db"));
+        BEAST_EXPECT(txdb.partitions->retire(1000) == 0);
+        BEAST_EXPECT(
+            txdb.partitions->schemas() ==
+            std::vector<std::string>({"main", "tx200"}));
+
+        // Every connection has dropped the removed partitions
+        {
+            auto db = txdb.db->checkoutDb();
+            BEAST_EXPECT(count(*db, "Transactions") == 1);
+            BEAST_EXPECT(count(*db, "AccountTxJoined") == 1);
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            auto db = txdb.db->checkoutReadDb();
+            BEAST_EXPECT(count(*db, "Transactions") == 1);
+            BEAST_EXPECT(count(*db, "AccountTxJoined") == 1);
+        }
+    }
+
+    void
+    testAccountTxJoined()
+    {
+        testcase("AccountTxJoined");
+
+        beast::temp_dir dir;
+        TxDB txdb(dir, 100);
+        insert(txdb, 150);
+        insert(txdb, 250);
+
+        // Ledgers before every partition are written to the main file
+        insert(txdb, 50);
+        insert(txdb, 5);
+        BEAST_EXPECT(count(*txdb.db->checkoutDb(), "main.Transactions") == 2);
+
+        auto check = [this](soci::session& session) {
+            std::vector<std::uint64_t> seqs(8);
+            std::vector<std::string> ids(8);
+            session << "SELECT LedgerSeq, TransID FROM AccountTxJoined "
+                       "WHERE Account = 'A' ORDER BY LedgerSeq DESC;",
+                soci::into(seqs), soci::into(ids);
+            BEAST_EXPECT(
+                seqs == std::vector<std::uint64_t>({250, 150, 50, 5}));
+            BEAST_EXPECT(ids.size() == 4 && ids[0].size() == 64);
+
+            // Every row is joined with the transaction in its own file
+            BEAST_EXPECT(
+                count(
+                    session,
+                    "AccountTxJoined WHERE Status = 'V' AND "
+                    "RawTxn IS NOT NULL") == 4);
+        };
+
+        check(*txdb.db->checkoutDb());
+        for (int i = 0; i < 2; ++i)
+            check(*txdb.db->checkoutReadDb());
+    }
+
+    void
+    testLimit()
+    {
+        testcase("Limit");
+
+        beast::temp_dir dir;
+        {
+            TxDB txdb(dir, 10);
+            for (LedgerIndex i = 0; i < TxPartitions::maxPartitions; ++i)
+                BEAST_EXPECT(
+                    txdb.partitions->schemaFor(i * 10) ==
+                    "tx" + std::to_string(i * 10));
+
+            // Past the limit, new ranges go to the main file
+            auto const next = TxPartitions::maxPartitions * 10;
+            BEAST_EXPECT(txdb.partitions->schemaFor(next) == "main");
+            BEAST_EXPECT(txdb.partitions->schemaFor(next + 20) == "main");
+            BEAST_EXPECT(
+                !exists(dir, "transaction." + std::to_string(next) + ".db"));
+            BEAST_EXPECT(
+                txdb.partitions->schemas().size() ==
+                TxPartitions::maxPartitions + 1);
+
+            // Existing partitions are still written
+            BEAST_EXPECT(txdb.partitions->schemaFor(15) == "tx10");
+        }
+
+        // A database with more partitions than can be attached is refused
+        std::ofstream{dir.file("transaction.1000.db")};
+        try
+        {
+            TxDB txdb(dir, 10);
+            fail("too many partitions");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testRotation();
+        testRetire();
+        testAccountTxJoined();
+        testLimit();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxPartitions, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/TxSetSketch.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/Handshake.h>
+#include <ripple/protocol/digest.h>
+#include <algorithm>
+
+namespace ripple {
+namespace test {
+
+class TxSetSketch_test : public beast::unit_test::suite
+{
+    static std::vector<uint256>
+    makeIDs(std::uint32_t first, std::size_t count)
+    {
+        std::vector<uint256> ids;
+        for (std::uint32_t i = 0; i < count; ++i)
+            ids.push_back(sha512Half(first + i));
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    static TxSetSketch
+    sketchOf(
+        std::vector<uint256> const& common,
+        std::vector<uint256> const& extra,
+        std::size_t cells)
+    {
+        TxSetSketch sketch(cells);
+        for (auto const& id : common)
+            sketch.insert(id);
+        for (auto const& id : extra)
+            sketch.insert(id);
+        return sketch;
+    }
+
+    void
+    testDecode()
+    {
+        testcase("Decode");
+
+        auto const common = makeIDs(0, 500);
+
+        for (std::size_t added : {0, 1, 5, 20})
+        {
+            for (std::size_t removed : {0, 3, 12})
+            {
+                auto const cells = TxSetSketch::cellsFor(added + removed);
+                auto const mine = makeIDs(10000, added);
+                auto const theirs = makeIDs(20000, removed);
+
+                auto sketch = sketchOf(common, mine, cells);
+                BEAST_EXPECT(sketch.subtract(sketchOf(common, theirs, cells)));
+
+                auto diff = sketch.decode();
+                if (!BEAST_EXPECT(diff))
+                    continue;
+                std::sort(diff->added.begin(), diff->added.end());
+                std::sort(diff->removed.begin(), diff->removed.end());
+                BEAST_EXPECT(diff->added == mine);
+                BEAST_EXPECT(diff->removed == theirs);
+            }
+        }
+
+        // A difference far larger than the sketch can't be listed
+        {
+            auto const cells = TxSetSketch::cellsFor(10);
+            auto sketch = sketchOf(common, makeIDs(30000, 200), cells);
+            BEAST_EXPECT(sketch.subtract(sketchOf(common, {}, cells)));
+            BEAST_EXPECT(!sketch.decode());
+        }
+
+        // Sketches of different sizes don't subtract
+        {
+            TxSetSketch sketch(30);
+            BEAST_EXPECT(!sketch.subtract(TxSetSketch(60)));
+        }
+    }
+
+    void
+    testSerialize()
+    {
+        testcase("Serialize");
+
+        auto const ids = makeIDs(0, 8);
+        auto const sketch = sketchOf(ids, {}, TxSetSketch::cellsFor(8));
+        auto const data = sketch.serialize();
+
+        auto copy = TxSetSketch::deserialize(makeSlice(data));
+        if (BEAST_EXPECT(copy))
+        {
+            BEAST_EXPECT(copy->cells() == sketch.cells());
+            BEAST_EXPECT(copy->serialize() == data);
+
+            auto const diff = copy->decode();
+            if (BEAST_EXPECT(diff))
+            {
+                BEAST_EXPECT(diff->added.size() == ids.size());
+                BEAST_EXPECT(diff->removed.empty());
+            }
+        }
+
+        BEAST_EXPECT(!TxSetSketch::deserialize(Slice{}));
+        BEAST_EXPECT(!TxSetSketch::deserialize(
+            makeSlice(data.substr(0, data.size() - 1))));
+        BEAST_EXPECT(!TxSetSketch::deserialize(
+            makeSlice(data.substr(0, data.size() / sketch.cells()))));
+    }
+
+    void
+    testHandshake()
+    {
+        testcase("Handshake");
+
+        auto negotiate = [](bool outbound, bool inbound) {
+            http_request_type request;
+            request.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesRequestHeader(true, true, true, true, outbound));
+            http_response_type response;
+            response.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesResponseHeader(
+                    request, true, true, true, true, inbound));
+
+            // The other features are still negotiated alongside
+            return featureEnabled(response, FEATURE_VPRR) &&
+                featureEnabled(response, FEATURE_LEDGER_REPLAY) &&
+                featureEnabled(response, FEATURE_TX_RECONCILE);
+        };
+        BEAST_EXPECT(negotiate(true, true));
+        BEAST_EXPECT(!negotiate(true, false));
+        BEAST_EXPECT(!negotiate(false, true));
+    }
+
+public:
+    void
+    run() override
+    {
+        testDecode();
+        testSerialize();
+        testHandshake();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxSetSketch, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
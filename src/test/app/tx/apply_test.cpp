@@ -19,8 +19,9 @@
 
 #include <ripple/app/tx/apply.h>
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/protocol/Feature.h>
-#include <test/jtx/Env.h>
+#include <test/jtx.h>
 
 namespace ripple {
 
@@ -32,6 +33,12 @@ public:
     {
         testcase("Require Fully Canonicial Signature");
         testFullyCanonicalSigs();
+        testcase("Check Signatures In Parallel");
+        testCheckSignatures();
+        testcase("Vouched Signatures");
+        testVouchedSignatures();
+        testcase("Validators Check Vouched Signatures");
+        testValidatorVouchedSignatures();
     }
 
     void
@@ -58,6 +65,7 @@ public:
 
             Validity valid = checkValidity(
                                  no_fully_canonical.app().getHashRouter(),
+                                 no_fully_canonical.app().getSignatureCache(),
                                  tx,
                                  no_fully_canonical.current()->rules(),
                                  no_fully_canonical.app().config())
@@ -73,6 +81,7 @@ public:
 
             Validity valid = checkValidity(
                                  fully_canonical.app().getHashRouter(),
+                                 fully_canonical.app().getSignatureCache(),
                                  tx,
                                  fully_canonical.current()->rules(),
                                  fully_canonical.app().config())
@@ -83,6 +92,144 @@ public:
 
         pass();
     }
+
+    void
+    testCheckSignatures()
+    {
+        using namespace test::jtx;
+        Env env(*this);
+        Account const alice("alice");
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        // Enough transactions to spread over several threads, with every
+        // third one carrying a damaged signature.
+        std::vector<std::shared_ptr<STTx const>> txs;
+        for (int i = 0; i < 48; ++i)
+        {
+            auto const jt =
+                env.jt(pay(alice, env.master, XRP(1)), seq(i + 1), fee(10));
+            if (i % 3 != 0)
+            {
+                txs.push_back(jt.stx);
+                continue;
+            }
+            STObject obj(*jt.stx);
+            auto sig = obj.getFieldVL(sfTxnSignature);
+            sig[sig.size() / 2] ^= 0x01;
+            obj.setFieldVL(sfTxnSignature, sig);
+            txs.push_back(std::make_shared<STTx const>(std::move(obj)));
+        }
+
+        auto& router = env.app().getHashRouter();
+        auto& signatures = env.app().getSignatureCache();
+        auto const rules = env.current()->rules();
+        WorkerPool workers(3);
+        checkSignatures(router, signatures, txs, rules, workers);
+
+        for (std::size_t i = 0; i < txs.size(); ++i)
+        {
+            auto const validity = checkValidity(
+                                      router,
+                                      signatures,
+                                      *txs[i],
+                                      rules,
+                                      env.app().config())
+                                      .first;
+            if (i % 3 == 0)
+                BEAST_EXPECT(validity == Validity::SigBad);
+            else
+                BEAST_EXPECT(validity == Validity::Valid);
+        }
+    }
+
+    void
+    testVouchedSignatures()
+    {
+        using namespace test::jtx;
+        Env env(*this);
+        Account const alice("alice");
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        auto& router = env.app().getHashRouter();
+        auto& signatures = env.app().getSignatureCache();
+        auto const rules = env.current()->rules();
+
+        auto damaged = [&](std::uint32_t s) {
+            auto const jt =
+                env.jt(pay(alice, env.master, XRP(1)), seq(s), fee(10));
+            STObject obj(*jt.stx);
+            auto sig = obj.getFieldVL(sfTxnSignature);
+            sig[sig.size() / 2] ^= 0x01;
+            obj.setFieldVL(sfTxnSignature, sig);
+            return std::make_shared<STTx const>(std::move(obj));
+        };
+
+        // A signature vouched for by a cluster member is not checked again,
+        // but the local checks still run
+        auto const vouched = damaged(1);
+        auto const vouchedID = vouched->getTransactionID();
+        BEAST_EXPECT(!isSignatureGood(router, vouchedID));
+        BEAST_EXPECT(acceptVouchedSignature(env.app(), vouchedID));
+        BEAST_EXPECT(isSignatureGood(router, vouchedID));
+        BEAST_EXPECT(
+            checkValidity(
+                router, signatures, *vouched, rules, env.app().config())
+                .first == Validity::Valid);
+
+        // A signature already found bad stays bad
+        auto const bad = damaged(2);
+        auto const badID = bad->getTransactionID();
+        BEAST_EXPECT(
+            checkValidity(router, signatures, *bad, rules, env.app().config())
+                .first == Validity::SigBad);
+        forceValidity(router, badID, Validity::SigGoodOnly);
+        BEAST_EXPECT(!isSignatureGood(router, badID));
+        BEAST_EXPECT(
+            checkValidity(router, signatures, *bad, rules, env.app().config())
+                .first == Validity::SigBad);
+
+        // A signature checked here is good
+        auto const good =
+            env.jt(pay(alice, env.master, XRP(1)), seq(3), fee(10)).stx;
+        BEAST_EXPECT(
+            checkValidity(router, signatures, *good, rules, env.app().config())
+                .first == Validity::Valid);
+        BEAST_EXPECT(isSignatureGood(router, good->getTransactionID()));
+    }
+
+    void
+    testValidatorVouchedSignatures()
+    {
+        using namespace test::jtx;
+        Env env(*this, envconfig(validator, ""));
+        Account const alice("alice");
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        auto& router = env.app().getHashRouter();
+        auto const jt =
+            env.jt(pay(alice, env.master, XRP(1)), seq(1), fee(10));
+        STObject obj(*jt.stx);
+        auto sig = obj.getFieldVL(sfTxnSignature);
+        sig[sig.size() / 2] ^= 0x01;
+        obj.setFieldVL(sfTxnSignature, sig);
+        auto const damaged = std::make_shared<STTx const>(std::move(obj));
+        auto const id = damaged->getTransactionID();
+
+        // A validator ignores the vouch and finds the signature bad
+        BEAST_EXPECT(!acceptVouchedSignature(env.app(), id));
+        BEAST_EXPECT(!isSignatureGood(router, id));
+        BEAST_EXPECT(
+            checkValidity(
+                router,
+                env.app().getSignatureCache(),
+                *damaged,
+                env.current()->rules(),
+                env.app().config())
+                .first == Validity::SigBad);
+    }
 };
 
 BEAST_DEFINE_TESTSUITE(Apply, app, ripple);
@@ -0,0 +1,196 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class Log_test : public beast::unit_test::suite
+{
+    static std::vector<std::string>
+    readLines(std::string const& path)
+    {
+        std::vector<std::string> lines;
+        std::ifstream in(path);
+        for (std::string line; std::getline(in, line);)
+            lines.push_back(line);
+        return lines;
+    }
+
+    static std::size_t
+    countMatching(std::vector<std::string> const& lines, std::string const& s)
+    {
+        std::size_t n = 0;
+        for (auto const& line : lines)
+        {
+            if (line.find(s) != std::string::npos)
+                ++n;
+        }
+        return n;
+    }
+
+    void
+    testBlocking()
+    {
+        testcase("blocking");
+        using namespace beast::severities;
+
+        beast::temp_dir dir;
+        auto const path = dir.file("debug.log");
+        Logs logs(kTrace);
+        logs.silent(true);
+        BEAST_EXPECT(logs.open(path));
+        logs.startAsync(16, Logs::Overflow::block);
+
+        constexpr int threads = 4;
+        constexpr int messages = 2000;
+        std::vector<std::thread> writers;
+        for (int t = 0; t != threads; ++t)
+        {
+            writers.emplace_back([&logs, t]() {
+                auto const j = logs.journal("Test" + std::to_string(t));
+                for (int i = 0; i != messages; ++i)
+                    JLOG(j.debug()) << "message " << i << ".";
+            });
+        }
+        for (auto& w : writers)
+            w.join();
+        logs.flush();
+
+        auto const lines = readLines(path);
+        BEAST_EXPECT(lines.size() == threads * messages);
+        BEAST_EXPECT(logs.dropped() == 0);
+
+        // Each thread's messages are written in the order they were logged
+        for (int t = 0; t != threads; ++t)
+        {
+            auto const prefix = "Test" + std::to_string(t) + ":DBG message ";
+            int next = 0;
+            for (auto const& line : lines)
+            {
+                auto const pos = line.find(prefix);
+                if (pos == std::string::npos)
+                    continue;
+                if (line.substr(pos + prefix.size()) !=
+                    std::to_string(next) + ".")
+                    break;
+                ++next;
+            }
+            BEAST_EXPECT(next == messages);
+        }
+    }
+
+    void
+    testDropping()
+    {
+        testcase("dropping");
+        using namespace beast::severities;
+
+        beast::temp_dir dir;
+        auto const path = dir.file("debug.log");
+        Logs logs(kTrace);
+        logs.silent(true);
+        BEAST_EXPECT(logs.open(path));
+        logs.startAsync(2, Logs::Overflow::drop);
+
+        constexpr std::size_t messages = 10000;
+        auto const j = logs.journal("Test");
+        for (std::size_t i = 0; i != messages; ++i)
+            JLOG(j.trace()) << "message " << i;
+        logs.flush();
+
+        auto const lines = readLines(path);
+        auto const written = countMatching(lines, "Test:TRC message ");
+        BEAST_EXPECT(written + logs.dropped() == messages);
+        BEAST_EXPECT(written >= 2);
+        if (logs.dropped() != 0)
+        {
+            BEAST_EXPECT(
+                countMatching(lines, "Logs:WRN ") != 0 &&
+                countMatching(lines, "messages were dropped") != 0);
+        }
+    }
+
+    void
+    testFatal()
+    {
+        testcase("fatal");
+        using namespace beast::severities;
+
+        beast::temp_dir dir;
+        auto const path = dir.file("debug.log");
+        Logs logs(kWarning);
+        logs.silent(true);
+        BEAST_EXPECT(logs.open(path));
+        logs.startAsync(8, Logs::Overflow::drop);
+
+        auto const j = logs.journal("Test");
+        JLOG(j.debug()) << "below the threshold";
+        JLOG(j.warn()) << "queued";
+        JLOG(j.fatal()) << "written at once";
+
+        // No flush: a fatal message is written before write returns
+        auto const lines = readLines(path);
+        BEAST_EXPECT(lines.size() == 2);
+        BEAST_EXPECT(countMatching(lines, "Test:WRN queued") == 1);
+        BEAST_EXPECT(countMatching(lines, "Test:FTL written at once") == 1);
+    }
+
+    void
+    testShutdown()
+    {
+        testcase("shutdown");
+        using namespace beast::severities;
+
+        beast::temp_dir dir;
+        auto const path = dir.file("debug.log");
+        {
+            Logs logs(kInfo);
+            logs.silent(true);
+            BEAST_EXPECT(logs.open(path));
+            logs.startAsync(1024, Logs::Overflow::block);
+            auto const j = logs.journal("Test");
+            for (int i = 0; i != 100; ++i)
+                JLOG(j.info()) << "message " << i;
+        }
+
+        // Messages still queued are written when the logs are destroyed
+        BEAST_EXPECT(readLines(path).size() == 100);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBlocking();
+        testDropping();
+        testFatal();
+        testShutdown();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Log, basics, ripple);
+
+}  // namespace ripple
@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/MemoryArena.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_value.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+class MemoryArena_test : public beast::unit_test::suite
+{
+    struct Counted : ArenaAllocated<MemoryArena::overlay>
+    {
+        char data[100];
+    };
+
+    void
+    testAllocator()
+    {
+        testcase("allocator");
+
+        auto const before = getMemoryArenaStats(MemoryArena::overlay);
+        {
+            std::vector<int, ArenaAllocator<int, MemoryArena::overlay>> v;
+            v.reserve(1000);
+            auto const during = getMemoryArenaStats(MemoryArena::overlay);
+            BEAST_EXPECT(during.bytes == before.bytes + 1000 * sizeof(int));
+            BEAST_EXPECT(during.allocations == before.allocations + 1);
+            BEAST_EXPECT(during.total == before.total + 1);
+        }
+        auto const after = getMemoryArenaStats(MemoryArena::overlay);
+        BEAST_EXPECT(after.bytes == before.bytes);
+        BEAST_EXPECT(after.allocations == before.allocations);
+        BEAST_EXPECT(after.total == before.total + 1);
+    }
+
+    void
+    testAllocated()
+    {
+        testcase("allocated");
+
+        auto const before = getMemoryArenaStats(MemoryArena::overlay);
+        auto p = std::make_unique<Counted>();
+        BEAST_EXPECT(
+            getMemoryArenaStats(MemoryArena::overlay).bytes ==
+            before.bytes + sizeof(Counted));
+        p.reset();
+        BEAST_EXPECT(
+            getMemoryArenaStats(MemoryArena::overlay).bytes == before.bytes);
+
+        // Objects built in place are not counted
+        alignas(Counted) char buffer[sizeof(Counted)];
+        auto q = new (buffer) Counted;
+        BEAST_EXPECT(
+            getMemoryArenaStats(MemoryArena::overlay).bytes == before.bytes);
+        q->~Counted();
+    }
+
+    void
+    testPoolAllocator()
+    {
+        testcase("pool allocator");
+
+        using Pool = ArenaPoolAllocator<MemoryArena::overlay>;
+        auto const before = getMemoryArenaStats(MemoryArena::overlay);
+        auto block = Pool::malloc(1000);
+        std::memset(block, 0, 1000);
+        BEAST_EXPECT(
+            getMemoryArenaStats(MemoryArena::overlay).bytes >=
+            before.bytes + 1000);
+        Pool::free(block);
+        BEAST_EXPECT(
+            getMemoryArenaStats(MemoryArena::overlay).bytes == before.bytes);
+    }
+
+    void
+    testJson()
+    {
+        testcase("json");
+
+        auto const before = getMemoryArenaStats(MemoryArena::json);
+        {
+            Json::Value jv(Json::objectValue);
+            for (int i = 0; i < 100; ++i)
+                jv[std::to_string(i)] = std::string(i, 'x');
+            BEAST_EXPECT(
+                getMemoryArenaStats(MemoryArena::json).allocations >=
+                before.allocations + 200);
+
+            // Strings with embedded nulls are released in full
+            jv["nulls"] = std::string(10, '\0');
+        }
+        BEAST_EXPECT(
+            getMemoryArenaStats(MemoryArena::json).bytes == before.bytes);
+    }
+
+public:
+    void
+    run() override
+    {
+        BEAST_EXPECT(std::string(to_string(MemoryArena::shamap)) == "shamap");
+        BEAST_EXPECT(std::string(allocatorName()).size() != 0);
+
+        testAllocator();
+        testAllocated();
+        testPoolAllocator();
+        testJson();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MemoryArena, basics, ripple);
+
+}  // namespace ripple
@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Numa.h>
+#include <ripple/beast/unit_test.h>
+#include <thread>
+
+namespace ripple {
+
+class Numa_test : public beast::unit_test::suite
+{
+    void
+    testTopology()
+    {
+        testcase("topology");
+
+        BEAST_EXPECT(numa::nodeCount() >= 1);
+        BEAST_EXPECT(numa::nodes().size() == numa::nodeCount());
+
+        // currentNode is either unknown or one of the nodes
+        auto const node = numa::currentNode();
+        BEAST_EXPECT(
+            node == -1 ||
+            (node >= 0 && static_cast<std::size_t>(node) < numa::nodeCount()));
+
+        auto const jv = numa::getJson();
+        BEAST_EXPECT(jv["nodes"].size() == numa::nodeCount());
+    }
+
+    void
+    testEnable()
+    {
+        testcase("enable");
+
+        numa::setEnabled(true);
+        BEAST_EXPECT(numa::enabled() == (numa::nodeCount() > 1));
+
+        // Every node runs the function, on that node when known
+        for (std::size_t n = 0; n < numa::nodeCount(); ++n)
+        {
+            bool ran = false;
+            int where = -2;
+            numa::runOnNode(n, [&] {
+                ran = true;
+                where = numa::currentNode();
+            });
+            BEAST_EXPECT(ran);
+            if (numa::enabled() && !numa::nodes()[n].empty())
+                BEAST_EXPECT(where == -1 || where == static_cast<int>(n));
+        }
+
+        numa::setEnabled(false);
+        BEAST_EXPECT(!numa::enabled());
+
+        // Disabled, the function runs on the calling thread
+        auto const id = std::this_thread::get_id();
+        bool same = false;
+        numa::runOnNode(0, [&] { same = std::this_thread::get_id() == id; });
+        BEAST_EXPECT(same);
+    }
+
+public:
+    void
+    run() override
+    {
+        testTopology();
+        testEnable();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Numa, basics, ripple);
+
+}  // namespace ripple
@@ -29,6 +29,7 @@
 #include <string>
 #include <test/jtx/Env.h>
 #include <thread>
+#include <vector>
 
 //------------------------------------------------------------------------------
 
@@ -1120,6 +1121,90 @@ public:
         }
     }
 
+    void
+    testPrometheus()
+    {
+        using namespace std::chrono;
+
+        PerfLogParent parent{j_};
+        auto perfLog{getPerfLog(parent, WithFile::no)};
+
+        auto contains = [](std::string const& text, std::string const& line) {
+            return text.find(line + "\n") != std::string::npos;
+        };
+
+        // With no activity only the metric family headers are written
+        std::string text = perfLog->prometheus();
+        BEAST_EXPECT(contains(
+            text, "# TYPE rippled_rpc_duration_seconds histogram"));
+        BEAST_EXPECT(
+            contains(text, "# TYPE rippled_job_queued_total counter"));
+        BEAST_EXPECT(text.find('{') == std::string::npos);
+
+        perfLog->rpcStart("ping", 1);
+        perfLog->rpcFinish("ping", 1);
+        perfLog->rpcStart("ping", 2);
+        perfLog->rpcError("ping", 2);
+
+        perfLog->resizeJobs(1);
+        perfLog->jobQueue(jtCLIENT);
+        perfLog->jobStart(jtCLIENT, 3ms, steady_clock::now(), 0);
+        perfLog->jobFinish(jtCLIENT, 30ms, 0);
+
+        // Counters updated from many threads add up
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; ++i)
+        {
+            threads.emplace_back([&perfLog]() {
+                for (int j = 0; j < 1000; ++j)
+                    perfLog->jobQueue(jtPACK);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        text = perfLog->prometheus();
+        BEAST_EXPECT(
+            contains(text, "rippled_rpc_started_total{method=\"ping\"} 2"));
+        BEAST_EXPECT(
+            contains(text, "rippled_rpc_finished_total{method=\"ping\"} 1"));
+        BEAST_EXPECT(
+            contains(text, "rippled_rpc_errored_total{method=\"ping\"} 1"));
+        BEAST_EXPECT(contains(
+            text,
+            "rippled_rpc_duration_seconds_bucket"
+            "{method=\"ping\",le=\"+Inf\"} 2"));
+        BEAST_EXPECT(contains(
+            text, "rippled_rpc_duration_seconds_count{method=\"ping\"} 2"));
+
+        BEAST_EXPECT(contains(
+            text, "rippled_job_queued_total{job=\"clientCommand\"} 1"));
+        BEAST_EXPECT(contains(
+            text, "rippled_job_queued_total{job=\"makeFetchPack\"} 8000"));
+        BEAST_EXPECT(contains(
+            text,
+            "rippled_job_queued_seconds_bucket"
+            "{job=\"clientCommand\",le=\"0.0025\"} 0"));
+        BEAST_EXPECT(contains(
+            text,
+            "rippled_job_queued_seconds_bucket"
+            "{job=\"clientCommand\",le=\"0.01\"} 1"));
+        BEAST_EXPECT(contains(
+            text,
+            "rippled_job_running_seconds_bucket"
+            "{job=\"clientCommand\",le=\"0.025\"} 0"));
+        BEAST_EXPECT(contains(
+            text,
+            "rippled_job_running_seconds_bucket"
+            "{job=\"clientCommand\",le=\"0.1\"} 1"));
+        BEAST_EXPECT(contains(
+            text,
+            "rippled_job_running_seconds_sum{job=\"clientCommand\"} 0.03"));
+        BEAST_EXPECT(contains(
+            text,
+            "rippled_job_running_seconds_count{job=\"clientCommand\"} 1"));
+    }
+
     void
     run() override
     {
@@ -1132,6 +1217,7 @@ public:
         testInvalidID(WithFile::yes);
         testRotate(WithFile::no);
         testRotate(WithFile::yes);
+        testPrometheus();
     }
 };
 
@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/make_SSLContext.h>
+#include <ripple/beast/unit_test.h>
+#include <openssl/bio.h>
+#include <openssl/ssl.h>
+#include <array>
+
+namespace ripple {
+namespace test {
+
+class SSLSessionCache_test : public beast::unit_test::suite
+{
+    // One end of a TLS connection over memory buffers
+    struct End
+    {
+        SSL* ssl;
+        BIO* in;
+        BIO* out;
+
+        End(boost::asio::ssl::context& context, bool client)
+            : ssl(SSL_new(context.native_handle()))
+            , in(BIO_new(BIO_s_mem()))
+            , out(BIO_new(BIO_s_mem()))
+        {
+            SSL_set_bio(ssl, in, out);
+            if (client)
+                SSL_set_connect_state(ssl);
+            else
+                SSL_set_accept_state(ssl);
+        }
+
+        End(End const&) = delete;
+        End&
+        operator=(End const&) = delete;
+
+        ~End()
+        {
+            SSL_free(ssl);
+        }
+    };
+
+    static void
+    transfer(End& from, End& to)
+    {
+        std::array<char, 4096> buf;
+        int n;
+        while ((n = BIO_read(from.out, buf.data(), buf.size())) > 0)
+            BIO_write(to.in, buf.data(), n);
+    }
+
+    // Runs the handshake, then lets the client take in any session
+    // tickets the server sent after it. Returns true if the client
+    // resumed a session.
+    bool
+    connect(
+        boost::asio::ssl::context& context,
+        std::shared_ptr<SSLSessionCache> const& cache,
+        std::string const& key)
+    {
+        End client(context, true);
+        End server(context, false);
+        cache->prepare(client.ssl, key);
+
+        for (int i = 0; i < 10 &&
+             !(SSL_is_init_finished(client.ssl) &&
+               SSL_is_init_finished(server.ssl));
+             ++i)
+        {
+            SSL_do_handshake(client.ssl);
+            transfer(client, server);
+            SSL_do_handshake(server.ssl);
+            transfer(server, client);
+        }
+        BEAST_EXPECT(SSL_is_init_finished(client.ssl));
+        BEAST_EXPECT(SSL_is_init_finished(server.ssl));
+
+        std::array<char, 16> buf;
+        SSL_read(client.ssl, buf.data(), buf.size());
+        return SSL_session_reused(client.ssl) == 1;
+    }
+
+public:
+    void
+    run() override
+    {
+        auto context = make_SSLContext("");
+
+        {
+            testcase("Resume");
+            auto const cache = std::make_shared<SSLSessionCache>(4);
+            BEAST_EXPECT(!connect(*context, cache, "a"));
+            BEAST_EXPECT(cache->size() == 1);
+            BEAST_EXPECT(connect(*context, cache, "a"));
+
+            // Sessions are only offered to the server they came from
+            BEAST_EXPECT(!connect(*context, cache, "b"));
+            BEAST_EXPECT(cache->size() == 2);
+        }
+
+        {
+            testcase("Capacity");
+            auto const cache = std::make_shared<SSLSessionCache>(1);
+            BEAST_EXPECT(!connect(*context, cache, "a"));
+            BEAST_EXPECT(!connect(*context, cache, "b"));
+            BEAST_EXPECT(cache->size() == 1);
+
+            // The oldest session was dropped
+            BEAST_EXPECT(!connect(*context, cache, "a"));
+            BEAST_EXPECT(connect(*context, cache, "a"));
+        }
+
+        {
+            testcase("Cache gone");
+            auto cache = std::make_shared<SSLSessionCache>(4);
+            End client(*context, true);
+            cache->prepare(client.ssl, "a");
+            cache.reset();
+
+            // The connection outlives the cache; new sessions are dropped
+            End server(*context, false);
+            for (int i = 0; i < 10 && !SSL_is_init_finished(client.ssl); ++i)
+            {
+                SSL_do_handshake(client.ssl);
+                transfer(client, server);
+                SSL_do_handshake(server.ssl);
+                transfer(server, client);
+            }
+            std::array<char, 16> buf;
+            SSL_read(client.ssl, buf.data(), buf.size());
+            BEAST_EXPECT(SSL_is_init_finished(client.ssl));
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SSLSessionCache, basics, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,333 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/clock/manual_clock.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class ShardedTaggedCache_test : public beast::unit_test::suite
+{
+    using Key = int;
+    using Value = std::string;
+    using Cache = ShardedTaggedCache<Key, Value>;
+
+    void
+    testAge(beast::Journal const& journal)
+    {
+        testcase("age eviction");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        clock.set(0);
+
+        Cache c("test", 1, 1s, clock, journal);
+
+        // Insert an item, retrieve it, and age it so it gets purged.
+        {
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+            BEAST_EXPECT(!c.insert(1, "one"));
+            BEAST_EXPECT(c.getCacheSize() == 1);
+            BEAST_EXPECT(c.getTrackSize() == 1);
+
+            {
+                std::string s;
+                BEAST_EXPECT(c.retrieve(1, s));
+                BEAST_EXPECT(s == "one");
+            }
+
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+
+        // Insert an item, maintain a strong pointer, age it, and
+        // verify that the entry still exists.
+        {
+            BEAST_EXPECT(!c.insert(2, "two"));
+
+            {
+                auto p = c.fetch(2);
+                BEAST_EXPECT(p != nullptr);
+                ++clock;
+                c.sweep();
+                BEAST_EXPECT(c.getCacheSize() == 0);
+                BEAST_EXPECT(c.getTrackSize() == 1);
+
+                // Canonicalizing a new object brings back the original
+                auto p2 = std::make_shared<Value>("two");
+                BEAST_EXPECT(c.canonicalize_replace_client(2, p2));
+                BEAST_EXPECT(c.getCacheSize() == 1);
+                BEAST_EXPECT(p.get() == p2.get());
+            }
+
+            // Make sure its gone now that our reference is gone
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+
+        // Many keys spread over the shards
+        {
+            for (int i = 0; i < 1000; ++i)
+                BEAST_EXPECT(!c.insert(i, std::to_string(i)));
+            BEAST_EXPECT(c.getCacheSize() == 1000);
+            BEAST_EXPECT(c.getKeys().size() == 1000);
+
+            BEAST_EXPECT(c.del(7, false));
+            BEAST_EXPECT(!c.fetch(7));
+            BEAST_EXPECT(c.getCacheSize() == 999);
+
+            c.clear();
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+    }
+
+    void
+    testClock(beast::Journal const& journal)
+    {
+        testcase("clock eviction");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        clock.set(0);
+
+        // Without a target size, unused items expire on the second sweep
+        {
+            Cache c(
+                "test",
+                0,
+                1s,
+                clock,
+                journal,
+                beast::insight::NullCollector::New(),
+                Cache::Eviction::clock);
+
+            BEAST_EXPECT(!c.insert(1, "one"));
+            BEAST_EXPECT(!c.insert(2, "two"));
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 2);
+
+            // Using an item gives it another chance
+            BEAST_EXPECT(c.fetch(1));
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 1);
+            BEAST_EXPECT(c.refreshIfPresent(1));
+            BEAST_EXPECT(!c.refreshIfPresent(2));
+
+            c.sweep();
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+
+        // With a target size, only the excess is expired
+        {
+            Cache c(
+                "test",
+                2,
+                1s,
+                clock,
+                journal,
+                beast::insight::NullCollector::New(),
+                Cache::Eviction::clock,
+                1);
+
+            for (int i = 0; i < 4; ++i)
+                BEAST_EXPECT(!c.insert(i, std::to_string(i)));
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 4);
+
+            BEAST_EXPECT(c.fetch(0));
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 2);
+            BEAST_EXPECT(c.fetch(0));
+
+            // At the target size, nothing more is expired
+            c.sweep();
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 2);
+        }
+    }
+
+    void
+    testThreads(beast::Journal const& journal)
+    {
+        testcase("concurrent use");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        clock.set(0);
+
+        Cache c("test", 0, 1s, clock, journal);
+
+        // Every thread canonicalizes the same keys and must end up
+        // with the same objects
+        auto constexpr keys = 2000;
+        auto constexpr threads = 4;
+        std::vector<std::vector<std::shared_ptr<Value>>> seen(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < keys; ++i)
+                {
+                    auto p = std::make_shared<Value>(std::to_string(i));
+                    c.canonicalize_replace_client(i, p);
+                    seen[t].push_back(std::move(p));
+                    if (i % 128 == 0)
+                        c.sweep();
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        bool same = true;
+        for (int t = 1; t < threads; ++t)
+        {
+            for (int i = 0; i < keys; ++i)
+                same = same && (seen[t][i] == seen[0][i]);
+        }
+        BEAST_EXPECT(same);
+        BEAST_EXPECT(c.getCacheSize() == keys);
+    }
+
+public:
+    void
+    run() override
+    {
+        test::SuiteJournal journal("ShardedTaggedCache_test", *this);
+
+        testAge(journal);
+        testClock(journal);
+        testThreads(journal);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ShardedTaggedCache, common, ripple);
+
+//------------------------------------------------------------------------------
+
+// Compares lookups in a TaggedCache and a ShardedTaggedCache as the
+// number of threads grows
+class ShardedTaggedCache_timing_test : public beast::unit_test::suite
+{
+    static constexpr int keys = 100000;
+    static constexpr int lookups = 1000000;
+
+    template <class Cache>
+    std::chrono::milliseconds
+    time(Cache& cache, int threads, int sweepEvery)
+    {
+        for (int i = 0; i < keys; ++i)
+            cache.insert(i, i);
+
+        std::atomic<long> found{0};
+        auto const start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                beast::xor_shift_engine rng(t + 1);
+                long n = 0;
+                for (int i = 0; i < lookups / threads; ++i)
+                {
+                    if (cache.fetch(static_cast<int>(rng() % keys)))
+                        ++n;
+                    if (sweepEvery && t == 0 && i % sweepEvery == 0)
+                        cache.sweep();
+                }
+                found += n;
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        // Sweeping may evict entries under clock eviction
+        if (!sweepEvery)
+            BEAST_EXPECT(found == (lookups / threads) * threads);
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+    }
+
+    template <class Make>
+    void
+    report(std::string const& name, Make&& make)
+    {
+        for (int threads : {1, 2, 4, 8})
+        {
+            auto cache = make();
+            auto const fetches = time(*cache, threads, 0);
+            cache = make();
+            auto const sweeps = time(*cache, threads, lookups / 8 / threads);
+            log << name << " " << threads << " threads: " << fetches.count()
+                << "ms fetching, " << sweeps.count()
+                << "ms fetching while sweeping" << std::endl;
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("ShardedTaggedCache_timing_test", *this);
+        TestStopwatch clock;
+
+        testcase("fetch");
+
+        report("TaggedCache", [&]() {
+            return std::make_unique<TaggedCache<int, int>>(
+                "timing", 0, 1h, clock, journal);
+        });
+        report("ShardedTaggedCache", [&]() {
+            return std::make_unique<ShardedTaggedCache<int, int>>(
+                "timing", 0, 1h, clock, journal);
+        });
+        report("ShardedTaggedCache (clock)", [&]() {
+            return std::make_unique<ShardedTaggedCache<int, int>>(
+                "timing",
+                0,
+                1h,
+                clock,
+                journal,
+                beast::insight::NullCollector::New(),
+                ShardedTaggedCache<int, int>::Eviction::clock);
+        });
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ShardedTaggedCache_timing, common, ripple);
+
+}  // namespace ripple
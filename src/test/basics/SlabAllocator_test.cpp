@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/basics/SlabAllocator.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/shamap/SHAMapItem.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class SlabAllocator_test : public beast::unit_test::suite
+{
+    struct Object
+    {
+        std::uint64_t a;
+        std::uint64_t b;
+    };
+
+    void
+    testAllocator()
+    {
+        testcase("allocator");
+
+        // Room for three blocks of 64 bytes in each slab
+        SlabAllocator<Object> slab(48, 200, 8);
+        BEAST_EXPECT(slab.size() == 64);
+
+        std::vector<std::uint8_t*> blocks;
+        for (int i = 0; i < 7; ++i)
+        {
+            auto p = slab.allocate();
+            if (!BEAST_EXPECT(p != nullptr))
+                return;
+            BEAST_EXPECT(reinterpret_cast<std::uintptr_t>(p) % 8 == 0);
+            std::memset(p, i, slab.size());
+            blocks.push_back(p);
+        }
+
+        // Every block is distinct and intact
+        for (int i = 0; i < blocks.size(); ++i)
+        {
+            BEAST_EXPECT(std::all_of(
+                blocks[i], blocks[i] + slab.size(), [i](std::uint8_t c) {
+                    return c == i;
+                }));
+        }
+
+        // A freed block is reused before the untouched part of its slab
+        auto const freed = blocks[6];
+        BEAST_EXPECT(slab.deallocate(freed));
+        BEAST_EXPECT(slab.allocate() == freed);
+
+        // Memory the allocator doesn't own is not released
+        std::uint8_t other[64];
+        BEAST_EXPECT(!slab.deallocate(other));
+
+        for (auto p : blocks)
+            BEAST_EXPECT(slab.deallocate(p));
+    }
+
+    void
+    testAllocatorSet()
+    {
+        testcase("allocator set");
+
+        SlabAllocatorSet<Object> set({
+            {64, kilobytes(std::size_t(4))},
+            {16, kilobytes(std::size_t(4))},
+        });
+
+        auto small = set.allocate(8);
+        auto large = set.allocate(40);
+        BEAST_EXPECT(small != nullptr);
+        BEAST_EXPECT(large != nullptr);
+
+        // Requests larger than any size class are not served
+        BEAST_EXPECT(set.allocate(65) == nullptr);
+
+        BEAST_EXPECT(set.deallocate(small));
+        BEAST_EXPECT(set.deallocate(large));
+
+        // The block comes back from the smallest class that fits
+        BEAST_EXPECT(set.allocate(16) == small);
+    }
+
+    void
+    testThreads()
+    {
+        testcase("threads");
+
+        SlabAllocator<Object> slab(16, kilobytes(std::size_t(4)));
+
+        auto constexpr threads = 4;
+        auto constexpr count = 1000;
+        std::vector<std::vector<std::uint8_t*>> blocks(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < count; ++i)
+                {
+                    auto p = slab.allocate();
+                    std::memset(p, t, slab.size());
+                    blocks[t].push_back(p);
+                    if (i % 3 == 0)
+                    {
+                        slab.deallocate(blocks[t].back());
+                        blocks[t].pop_back();
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        std::vector<std::uint8_t*> all;
+        bool intact = true;
+        for (int t = 0; t < threads; ++t)
+        {
+            for (auto p : blocks[t])
+            {
+                intact = intact && std::all_of(
+                    p, p + slab.size(), [t](std::uint8_t c) { return c == t; });
+                all.push_back(p);
+            }
+        }
+        BEAST_EXPECT(intact);
+
+        std::sort(all.begin(), all.end());
+        BEAST_EXPECT(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+        for (auto p : all)
+            BEAST_EXPECT(slab.deallocate(p));
+    }
+
+    void
+    testItems()
+    {
+        testcase("SHAMapItem");
+
+        // Items of every size, including sizes beyond the slabs
+        for (std::size_t size : {0, 1, 12, 100, 128, 129, 1000, 5000})
+        {
+            Blob data(size);
+            for (std::size_t i = 0; i < size; ++i)
+                data[i] = static_cast<std::uint8_t>(i);
+
+            uint256 const key{size};
+            auto item = make_shamapitem(key, makeSlice(data));
+            BEAST_EXPECT(item->key() == key);
+            BEAST_EXPECT(item->size() == size);
+            BEAST_EXPECT(item->slice() == makeSlice(data));
+
+            // Copies hold their own data
+            auto copy = make_shamapitem(*item);
+            BEAST_EXPECT(copy.get() != item.get());
+            BEAST_EXPECT(copy->key() == key);
+            BEAST_EXPECT(copy->slice() == item->slice());
+
+            // Sharing doesn't copy
+            boost::intrusive_ptr<SHAMapItem const> shared = item;
+            item.reset();
+            BEAST_EXPECT(shared->slice() == makeSlice(data));
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testAllocator();
+        testAllocatorSet();
+        testThreads();
+        testItems();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SlabAllocator, basics, ripple);
+
+}  // namespace ripple
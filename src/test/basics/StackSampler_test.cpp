@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StackSampler.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ripple {
+namespace test {
+
+class StackSampler_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono_literals;
+
+        if (!perf::canSampleStacks())
+        {
+            pass();
+            return;
+        }
+
+        // One thread waits on a condition variable and one spins, and both
+        // must keep doing so while they are sampled
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        std::atomic<bool> stop{false};
+
+        std::thread waiter([&] {
+            beast::setCurrentThreadName("sampleWaiter");
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return done; });
+        });
+        std::thread spinner([&] {
+            beast::setCurrentThreadName("sampleSpinner");
+            while (!stop.load())
+                ;
+        });
+
+        // Give the threads time to name themselves
+        std::this_thread::sleep_for(50ms);
+        auto const report = perf::sampleStacks(3, 10ms);
+
+        {
+            std::lock_guard lock(mutex);
+            done = true;
+        }
+        cv.notify_all();
+        stop = true;
+        waiter.join();
+        spinner.join();
+
+        BEAST_EXPECT(
+            report.find("\"sampleWaiter\", answered 3 of 3") !=
+            std::string::npos);
+        BEAST_EXPECT(
+            report.find("\"sampleSpinner\", answered 3 of 3") !=
+            std::string::npos);
+        BEAST_EXPECT(report.find("#0 ") != std::string::npos);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(StackSampler, basics, ripple);
+
+}  // namespace test
+}  // namespace ripple
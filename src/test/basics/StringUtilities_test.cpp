@@ -21,6 +21,7 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/ToString.h>
 #include <ripple/beast/unit_test.h>
+#include <cctype>
 
 namespace ripple {
 
@@ -61,6 +62,51 @@ public:
         testUnHexFailure("XRP");
     }
 
+    void
+    testHexCodec()
+    {
+        testcase("hex codec");
+
+        // Lengths around every block size the vectorized codecs use
+        std::string bytes;
+        for (int i = 0; i < 300; ++i)
+            bytes.push_back(static_cast<char>(i * 7 + 3));
+
+        for (std::size_t size = 0; size < bytes.size(); ++size)
+        {
+            std::string expected;
+            boost::algorithm::hex(
+                bytes.begin(),
+                bytes.begin() + size,
+                std::back_inserter(expected));
+
+            std::string const hex = strHex(makeSlice(bytes.substr(0, size)));
+            BEAST_EXPECT(hex == expected);
+
+            auto const blob = strUnHex(hex);
+            BEAST_EXPECT(
+                blob && makeSlice(*blob) == makeSlice(bytes.substr(0, size)));
+
+            auto lower = hex;
+            for (auto& c : lower)
+                c = static_cast<char>(std::tolower(c));
+            auto const fromLower = strUnHex(lower);
+            BEAST_EXPECT(fromLower && *fromLower == *blob);
+        }
+
+        // A bad character is found wherever it is
+        std::string const hex = strHex(makeSlice(bytes.substr(0, 100)));
+        for (std::size_t i = 0; i < hex.size(); ++i)
+        {
+            for (char const bad : {'g', 'G', '/', ':', '@', '`', '\0', '\xff'})
+            {
+                auto copy = hex;
+                copy[i] = bad;
+                BEAST_EXPECT(!strUnHex(copy));
+            }
+        }
+    }
+
     void
     testParseUrl()
     {
@@ -311,6 +357,7 @@ public:
     {
         testParseUrl();
         testUnHex();
+        testHexCodec();
         testToString();
     }
 };
@@ -147,6 +147,74 @@ public:
             BEAST_EXPECT(c.getCacheSize() == 0);
             BEAST_EXPECT(c.getTrackSize() == 0);
         }
+
+        // Sweeps record evictions, and rates are reported since the
+        // sweep a window ago
+        {
+            Cache m("metrics", 0, 30s, clock, journal);
+            m.sweep();
+
+            for (Key k = 0; k < 10; ++k)
+                m.insert(k, "value");
+            std::string s;
+            for (Key k = 0; k < 20; ++k)
+                m.retrieve(k, s);
+
+            clock.advance(40s);
+            m.sweep();
+
+            auto const json = m.getJson();
+            BEAST_EXPECT(json["size"] == 0);
+            BEAST_EXPECT(json["hits"] == "10");
+            BEAST_EXPECT(json["misses"] == "10");
+            BEAST_EXPECT(json["evictions"] == "10");
+            BEAST_EXPECT(json["sweeps"] == 2);
+            BEAST_EXPECT(json["estimated_bytes"] == "0");
+            BEAST_EXPECT(json["1m"]["seconds"] == 40);
+            BEAST_EXPECT(json["1m"]["evictions_per_sec"] == 0.25);
+            BEAST_EXPECT(json["1m"]["hit_rate"] == 50.0);
+            BEAST_EXPECT(json["10m"]["seconds"] == 40);
+
+            // Past the short window, the baseline is the second sweep
+            clock.advance(80s);
+            m.sweep();
+            auto const later = m.getJson();
+            BEAST_EXPECT(later["1m"]["seconds"] == 80);
+            BEAST_EXPECT(later["1m"]["hits_per_sec"] == 0.0);
+            BEAST_EXPECT(!later["1m"].isMember("hit_rate"));
+            BEAST_EXPECT(later["10m"]["seconds"] == 120);
+        }
+
+        // A sweep with no time budget still visits every entry, one
+        // slice of buckets at a time
+        {
+            Cache s("sliced", 0, 1s, clock, journal);
+            s.setSweepBudget(0us);
+            BEAST_EXPECT(s.getSweepBudget() == 0us);
+
+            std::vector<std::shared_ptr<std::string>> held;
+            for (Key k = 0; k < 1000; ++k)
+            {
+                auto p = std::make_shared<std::string>("value");
+                s.canonicalize_replace_client(k, p);
+                if (k % 10 == 0)
+                    held.push_back(p);
+            }
+            BEAST_EXPECT(s.getCacheSize() == 1000);
+
+            s.sweep();
+            BEAST_EXPECT(s.getCacheSize() == 1000);
+
+            clock.advance(2s);
+            s.sweep();
+            BEAST_EXPECT(s.getCacheSize() == 0);
+            BEAST_EXPECT(s.getTrackSize() == held.size());
+            BEAST_EXPECT(s.getJson()["evictions"] == "1000");
+
+            held.clear();
+            s.sweep();
+            BEAST_EXPECT(s.getTrackSize() == 0);
+        }
     }
 };
 
@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Tracer.h>
+#include <ripple/beast/unit_test.h>
+#include <string>
+
+namespace ripple {
+namespace test {
+
+class Tracer_test : public beast::unit_test::suite
+{
+    using Tracer = perf::Tracer;
+
+    static Tracer::Setup
+    setup(std::size_t capacity, bool enabled = true)
+    {
+        Tracer::Setup s;
+        s.enabled = enabled;
+        s.capacity = capacity;
+        return s;
+    }
+
+    void
+    testSpans()
+    {
+        testcase("spans");
+
+        Tracer tracer(setup(16));
+        {
+            Tracer::Span span(tracer, "outer", "ledger", 5);
+            Tracer::Span inner(tracer, "inner", "ledger");
+            inner.setLedgerSeq(6);
+        }
+        BEAST_EXPECT(tracer.size() == 2);
+
+        auto const jv = tracer.getJson();
+        BEAST_EXPECT(jv["displayTimeUnit"] == "ms");
+        auto const& events = jv["traceEvents"];
+        BEAST_EXPECT(events.isArray() && events.size() == 2);
+        if (events.size() != 2)
+            return;
+
+        // The inner span ends first, so it is recorded first
+        BEAST_EXPECT(events[0u]["name"] == "inner");
+        BEAST_EXPECT(events[0u]["args"]["ledger_seq"] == 6);
+        BEAST_EXPECT(events[1u]["name"] == "outer");
+        BEAST_EXPECT(events[1u]["cat"] == "ledger");
+        BEAST_EXPECT(events[1u]["ph"] == "X");
+        BEAST_EXPECT(events[1u]["args"]["ledger_seq"] == 5);
+        BEAST_EXPECT(
+            events[1u]["ts"].asDouble() <= events[0u]["ts"].asDouble());
+        BEAST_EXPECT(events[0u]["tid"] == events[1u]["tid"]);
+    }
+
+    void
+    testDisabled()
+    {
+        testcase("disabled");
+
+        Tracer tracer(setup(16, false));
+        {
+            Tracer::Span span(tracer, "off", "ledger");
+            // Enabling part way through does not record the open span
+            tracer.setEnabled(true);
+        }
+        BEAST_EXPECT(tracer.size() == 0);
+
+        {
+            Tracer::Span span(tracer, "on", "ledger");
+            tracer.setEnabled(false);
+        }
+        BEAST_EXPECT(tracer.size() == 1);
+        BEAST_EXPECT(!tracer.tracingJobs());
+    }
+
+    void
+    testRing()
+    {
+        testcase("ring buffer");
+
+        Tracer tracer(setup(4));
+        char const* names[] = {"0", "1", "2", "3", "4", "5"};
+        auto const now = Tracer::clock_type::now();
+        for (std::uint32_t i = 0; i < 6; ++i)
+            tracer.record(names[i], "test", now, now, i + 1);
+        BEAST_EXPECT(tracer.size() == 4);
+
+        // The oldest spans are overwritten, and the rest come back in order
+        auto jv = tracer.getJson();
+        auto const& events = jv["traceEvents"];
+        BEAST_EXPECT(events.size() == 4);
+        for (unsigned i = 0; i < events.size(); ++i)
+            BEAST_EXPECT(events[i]["name"] == std::to_string(i + 2));
+
+        // Spans for earlier ledgers are left out, those for none are kept
+        tracer.record("none", "test", now, now);
+        jv = tracer.getJson(5);
+        BEAST_EXPECT(jv["traceEvents"].size() == 3);
+        BEAST_EXPECT(jv["traceEvents"][0u]["name"] == "4");
+        BEAST_EXPECT(jv["traceEvents"][2u]["name"] == "none");
+        BEAST_EXPECT(!jv["traceEvents"][2u].isMember("args"));
+
+        tracer.clear();
+        BEAST_EXPECT(tracer.size() == 0);
+        BEAST_EXPECT(tracer.getJson()["traceEvents"].size() == 0);
+        tracer.record("again", "test", now, now);
+        BEAST_EXPECT(tracer.size() == 1);
+    }
+
+    void
+    testSetup()
+    {
+        testcase("setup");
+
+        Section section("trace");
+        auto s = perf::setup_Tracer(section);
+        BEAST_EXPECT(!s.enabled);
+        BEAST_EXPECT(!s.jobs);
+        BEAST_EXPECT(s.capacity == 65536);
+
+        section.set("enable", "1");
+        section.set("events", "100");
+        section.set("jobs", "1");
+        s = perf::setup_Tracer(section);
+        BEAST_EXPECT(s.enabled);
+        BEAST_EXPECT(s.jobs);
+        BEAST_EXPECT(s.capacity == 100);
+
+        Tracer tracer(s);
+        BEAST_EXPECT(tracer.tracingJobs());
+    }
+
+public:
+    void
+    run() override
+    {
+        testSpans();
+        testDisabled();
+        testRing();
+        testSetup();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Tracer, basics, ripple);
+
+}  // namespace test
+}  // namespace ripple
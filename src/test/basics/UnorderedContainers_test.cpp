@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ripple {
+
+namespace {
+
+std::vector<uint256>
+randomKeys(std::size_t count, std::uint64_t seed)
+{
+    beast::xor_shift_engine rng(seed);
+    std::vector<uint256> keys(count);
+    for (auto& key : keys)
+    {
+        for (auto& b : key)
+            b = static_cast<std::uint8_t>(rng());
+    }
+    return keys;
+}
+
+}  // namespace
+
+class UnorderedContainers_test : public beast::unit_test::suite
+{
+public:
+    void
+    testUniformKeyHash()
+    {
+        testcase("uniform_key_hash");
+
+        // The hash is the first 64 bits of the key, whatever follows
+        uint256 a;
+        for (std::size_t i = 0; i < a.size(); ++i)
+            a.data()[i] = static_cast<std::uint8_t>(i);
+        uint256 b = a;
+        b.data()[sizeof(std::size_t)] ^= 1;
+        BEAST_EXPECT(uniform_key_hash{}(a) == uniform_key_hash{}(b));
+        b.data()[0] ^= 1;
+        BEAST_EXPECT(uniform_key_hash{}(a) != uniform_key_hash{}(b));
+    }
+
+    void
+    testContainers()
+    {
+        testcase("containers");
+
+        auto const keys = randomKeys(1000, 3);
+        uniform_hash_map<uint256, std::size_t> map;
+        uniform_hash_set<uint256> set;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            map.emplace(keys[i], i);
+            set.insert(keys[i]);
+        }
+        BEAST_EXPECT(map.size() == keys.size());
+        BEAST_EXPECT(set.size() == keys.size());
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            auto const it = map.find(keys[i]);
+            BEAST_EXPECT(it != map.end() && it->second == i);
+            BEAST_EXPECT(set.count(keys[i]) == 1);
+        }
+        BEAST_EXPECT(map.count(uint256{}) == 0);
+        BEAST_EXPECT(set.count(uint256{}) == 0);
+    }
+
+    void
+    run() override
+    {
+        testUniformKeyHash();
+        testContainers();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(UnorderedContainers, basics, ripple);
+
+class UnorderedContainersBench_test : public beast::unit_test::suite
+{
+    // The average time to look up each key, about half of them present
+    template <class Hash>
+    std::chrono::nanoseconds
+    time(std::vector<uint256> const& keys, std::size_t size)
+    {
+        std::unordered_map<uint256, std::size_t, Hash> map;
+        for (std::size_t i = 0; i < size; ++i)
+            map.emplace(keys[2 * i], i);
+
+        using clock_type = std::chrono::steady_clock;
+        std::size_t found = 0;
+        auto const start = clock_type::now();
+        for (int round = 0; round < 20; ++round)
+        {
+            for (std::size_t i = 0; i < 2 * size; ++i)
+                found += map.count(keys[i]);
+        }
+        auto const elapsed = clock_type::now() - start;
+        // Keep the results alive
+        if (found == 1)
+            log << found;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) /
+            (20 * 2 * size);
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("Lookup speed");
+
+        for (std::size_t size : {64, 4096, 262144})
+        {
+            auto const keys = randomKeys(2 * size, size);
+
+            // Alternate the runs, so none gains from going later
+            auto u = time<uniform_key_hash>(keys, size);
+            auto x = time<beast::uhash<>>(keys, size);
+            auto h = time<hardened_hash<>>(keys, size);
+            u = std::min(u, time<uniform_key_hash>(keys, size));
+            x = std::min(x, time<beast::uhash<>>(keys, size));
+            h = std::min(h, time<hardened_hash<>>(keys, size));
+            log << size << " keys: " << u.count() << "ns, uhash "
+                << x.count() << "ns, hardened_hash " << h.count() << "ns"
+                << std::endl;
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(UnorderedContainersBench, basics, ripple);
+
+}  // namespace ripple
@@ -0,0 +1,304 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/clock/manual_clock.h>
+#include <ripple/beast/container/aged_container_utility.h>
+#include <ripple/beast/container/aged_flat_unordered_map.h>
+#include <ripple/beast/container/aged_unordered_map.h>
+#include <ripple/beast/unit_test.h>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace beast {
+
+class aged_flat_unordered_map_test : public unit_test::suite
+{
+    using Clock = manual_clock<std::chrono::steady_clock>;
+    using Map = aged_flat_unordered_map<int, std::string, Clock::clock_type>;
+
+    void
+    testBasics()
+    {
+        testcase("basics");
+
+        Clock clock;
+        Map m(clock);
+        BEAST_EXPECT(m.empty());
+        BEAST_EXPECT(m.find(1) == m.end());
+
+        auto const [it, inserted] = m.emplace(1, "one");
+        BEAST_EXPECT(inserted);
+        BEAST_EXPECT(it->first == 1 && it->second == "one");
+        BEAST_EXPECT(!m.emplace(1, "uno").second);
+        BEAST_EXPECT(m.find(1)->second == "one");
+
+        // Enough elements to grow the table several times
+        for (int i = 2; i <= 1000; ++i)
+            BEAST_EXPECT(m.emplace(i, std::to_string(i)).second);
+        BEAST_EXPECT(m.size() == 1000);
+
+        std::size_t n = 0;
+        for (auto const& v : m)
+        {
+            BEAST_EXPECT(v.first == 1 || v.second == std::to_string(v.first));
+            ++n;
+        }
+        BEAST_EXPECT(n == 1000);
+
+        // Erasing keeps every other element reachable
+        for (int i = 1; i <= 1000; i += 2)
+            BEAST_EXPECT(m.erase(i) == 1);
+        BEAST_EXPECT(m.erase(1) == 0);
+        BEAST_EXPECT(m.size() == 500);
+        for (int i = 1; i <= 1000; ++i)
+            BEAST_EXPECT((m.find(i) != m.end()) == (i % 2 == 0));
+
+        m.erase(m.find(2));
+        BEAST_EXPECT(m.count(2) == 0);
+        BEAST_EXPECT(m.size() == 499);
+
+        m.clear();
+        BEAST_EXPECT(m.empty());
+        BEAST_EXPECT(m.begin() == m.end());
+    }
+
+    void
+    testExpire()
+    {
+        testcase("expire");
+        using namespace std::chrono_literals;
+
+        Clock clock;
+        Map m(clock);
+
+        m.emplace(1, "one");
+        m.emplace(2, "two");
+        ++clock;
+        m.emplace(3, "three");
+        m.touch(m.find(1));
+        BEAST_EXPECT(m.find(1).when() == clock.now());
+
+        // Nothing is older than one second yet
+        BEAST_EXPECT(expire(m, 2s) == 0);
+        ++clock;
+        BEAST_EXPECT(expire(m, 2s) == 1);
+        BEAST_EXPECT(m.count(1) == 1);
+        BEAST_EXPECT(m.count(2) == 0);
+        BEAST_EXPECT(m.count(3) == 1);
+
+        // A key erased and inserted again lives from its insertion
+        m.erase(3);
+        m.emplace(3, "three");
+        ++clock;
+        BEAST_EXPECT(expire(m, 2s) == 1);
+        BEAST_EXPECT(m.count(1) == 0);
+        BEAST_EXPECT(m.count(3) == 1);
+        clock.advance(10s);
+        BEAST_EXPECT(expire(m, 2s) == 1);
+        BEAST_EXPECT(m.empty());
+
+        // With wider buckets elements may outlive the age, never less
+        Map wide(clock, 4s);
+        wide.emplace(1, "one");
+        ++clock;
+        wide.emplace(2, "two");
+        ++clock;
+        BEAST_EXPECT(expire(wide, 2s) == 0);
+        ++clock;
+        BEAST_EXPECT(expire(wide, 2s) == 2);
+    }
+
+    void
+    testRandom()
+    {
+        testcase("random");
+        using namespace std::chrono_literals;
+
+        // Check against the list based container
+        Clock clock;
+        Map flat(clock);
+        aged_unordered_map<int, std::string, Clock::clock_type> list(clock);
+
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<int> key(0, 2000);
+        std::uniform_int_distribution<int> op(0, 9);
+        bool same = true;
+        for (int i = 0; i < 50000; ++i)
+        {
+            auto const k = key(gen);
+            switch (op(gen))
+            {
+                case 0:
+                    flat.erase(k);
+                    if (auto const it = list.find(k); it != list.end())
+                        list.erase(it);
+                    break;
+                case 1:
+                    ++clock;
+                    expire(flat, 5s);
+                    expire(list, 5s);
+                    break;
+                default: {
+                    auto const f = flat.find(k);
+                    auto const l = list.find(k);
+                    same &= (f == flat.end()) == (l == list.end());
+                    if (f != flat.end() && l != list.end())
+                    {
+                        same &= f->second == l->second;
+                        flat.touch(f);
+                        list.touch(l);
+                    }
+                    else
+                    {
+                        flat.emplace(k, std::to_string(i));
+                        list.emplace(k, std::to_string(i));
+                    }
+                }
+            }
+            same &= flat.size() == list.size();
+        }
+        BEAST_EXPECT(same);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBasics();
+        testExpire();
+        testRandom();
+    }
+};
+
+/** Compares the flat and the list based aged maps under a HashRouter load.
+
+    Keys are suppression hashes held for a fixed time. Each simulated
+    second inserts new keys, looks up and touches a mix of recent ones and
+    expires the old ones, the way HashRouter does. Reports the time per
+    operation for each container and table size.
+*/
+class aged_flat_unordered_map_bench_test : public unit_test::suite
+{
+    using Clock = manual_clock<std::chrono::steady_clock>;
+
+    struct Key
+    {
+        std::uint64_t a, b, c, d;
+
+        bool
+        operator==(Key const& other) const
+        {
+            return a == other.a && b == other.b && c == other.c &&
+                d == other.d;
+        }
+    };
+
+    // Not empty, so that the list based container doesn't inherit it
+    // alongside its key_equal
+    struct KeyHash
+    {
+        std::uint64_t multiplier = 0x9E3779B97F4A7C15;
+
+        std::size_t
+        operator()(Key const& k) const
+        {
+            return static_cast<std::size_t>(k.a ^ (k.b * multiplier));
+        }
+    };
+
+    struct Value
+    {
+        std::uint32_t flags = 0;
+        std::uint32_t peers[6] = {};
+    };
+
+    template <class Map>
+    double
+    simulate(std::size_t perSecond, std::size_t seconds, std::uint64_t& sum)
+    {
+        using namespace std::chrono_literals;
+        Clock clock;
+        Map m(clock);
+        std::mt19937_64 gen(1);
+        std::vector<Key> recent;
+        std::size_t ops = 0;
+
+        auto const start = std::clock();
+        for (std::size_t s = 0; s < seconds; ++s)
+        {
+            ++clock;
+            expire(m, 300s);
+            for (std::size_t i = 0; i < perSecond; ++i)
+            {
+                Key const k{gen(), gen(), gen(), gen()};
+                m.emplace(k, Value{}).first->second.flags = 1;
+                recent.push_back(k);
+
+                // Most traffic repeats hashes seen in the last seconds
+                for (int r = 0; r < 5; ++r)
+                {
+                    auto const& rk = recent[gen() % recent.size()];
+                    if (auto it = m.find(rk); it != m.end())
+                    {
+                        m.touch(it);
+                        sum += it->second.flags;
+                    }
+                }
+                ops += 6;
+            }
+            if (recent.size() > 20 * perSecond)
+                recent.erase(
+                    recent.begin(), recent.begin() + recent.size() / 2);
+        }
+        return 1e9 * (std::clock() - start) / CLOCKS_PER_SEC / ops;
+    }
+
+public:
+    void
+    run() override
+    {
+        using Flat = aged_flat_unordered_map<
+            Key,
+            Value,
+            Clock::clock_type,
+            KeyHash>;
+        using List = aged_unordered_map<Key, Value, Clock::clock_type, KeyHash>;
+
+        std::uint64_t sum = 0;
+        for (std::size_t const perSecond : {100, 1000, 5000})
+        {
+            // Run long enough that the table reaches its steady size
+            std::size_t const seconds = 400;
+            auto const list = simulate<List>(perSecond, seconds, sum);
+            auto const flat = simulate<Flat>(perSecond, seconds, sum);
+            log << perSecond * 300 << " entries: list " << list
+                << "ns/op, flat " << flat << "ns/op" << std::endl;
+        }
+        BEAST_EXPECT(sum > 0);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(aged_flat_unordered_map, container, beast);
+BEAST_DEFINE_TESTSUITE_MANUAL(aged_flat_unordered_map_bench, container, beast);
+
+}  // namespace beast
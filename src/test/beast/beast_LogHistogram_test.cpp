@@ -0,0 +1,169 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/insight/Histogram.h>
+#include <ripple/beast/insight/NullCollector.h>
+
+#include <ripple/beast/unit_test.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace beast {
+namespace insight {
+
+class LogHistogram_test : public unit_test::suite
+{
+public:
+    void
+    testBuckets()
+    {
+        testcase("buckets");
+
+        // Small values are counted exactly
+        for (std::uint64_t v = 0; v != LogHistogram::subBuckets; ++v)
+        {
+            BEAST_EXPECT(LogHistogram::index(v) == v);
+            BEAST_EXPECT(LogHistogram::midpoint(LogHistogram::index(v)) == v);
+        }
+
+        // Buckets are contiguous and ordered
+        for (std::size_t i = 1; i != LogHistogram::buckets; ++i)
+        {
+            auto const lower = LogHistogram::lowerBound(i);
+            BEAST_EXPECT(lower > LogHistogram::lowerBound(i - 1));
+            BEAST_EXPECT(LogHistogram::index(lower) == i);
+            BEAST_EXPECT(LogHistogram::index(lower - 1) == i - 1);
+        }
+
+        // Every value reads back within 1/16
+        bool accurate = true;
+        std::uint64_t const limit = std::uint64_t{1}
+            << LogHistogram::maxExponent;
+        for (std::uint64_t v = 1; v < limit; v = v * 3 / 2 + 1)
+        {
+            auto const m = LogHistogram::midpoint(LogHistogram::index(v));
+            auto const error = m > v ? m - v : v - m;
+            if (error * 16 > v)
+                accurate = false;
+        }
+        BEAST_EXPECT(accurate);
+
+        // Values past the range share the last bucket
+        BEAST_EXPECT(
+            LogHistogram::index(limit) == LogHistogram::buckets - 1);
+        BEAST_EXPECT(
+            LogHistogram::index(~std::uint64_t{0}) ==
+            LogHistogram::buckets - 1);
+    }
+
+    void
+    testPercentiles()
+    {
+        testcase("percentiles");
+
+        LogHistogram h;
+        BEAST_EXPECT(h.percentile(50) == 0);
+
+        for (std::uint64_t v = 1; v <= 1000; ++v)
+            h.add(v);
+        BEAST_EXPECT(LogHistogram::count(h.counts()) == 1000);
+
+        auto near = [](std::uint64_t got, std::uint64_t want) {
+            auto const error = got > want ? got - want : want - got;
+            return error * 16 <= want;
+        };
+        BEAST_EXPECT(near(h.percentile(50), 500));
+        BEAST_EXPECT(near(h.percentile(90), 900));
+        BEAST_EXPECT(near(h.percentile(99), 990));
+        BEAST_EXPECT(near(h.percentile(100), 1000));
+        BEAST_EXPECT(h.percentile(0) == 1);
+    }
+
+    void
+    testMerge()
+    {
+        testcase("merge");
+
+        LogHistogram a;
+        LogHistogram b;
+        for (int i = 0; i != 10; ++i)
+            a.add(100);
+        for (int i = 0; i != 30; ++i)
+            b.add(10000);
+
+        auto const before = a.counts();
+        a.merge(b.counts());
+        auto const after = a.counts();
+        BEAST_EXPECT(LogHistogram::count(after) == 40);
+        BEAST_EXPECT(
+            LogHistogram::percentile(after, 20) == LogHistogram::percentile(
+                                                       before, 50));
+        BEAST_EXPECT(
+            LogHistogram::percentile(after, 50) == b.percentile(50));
+
+        auto const interval = LogHistogram::difference(after, before);
+        BEAST_EXPECT(LogHistogram::count(interval) == 30);
+        BEAST_EXPECT(interval == b.counts());
+    }
+
+    void
+    testHistogram()
+    {
+        testcase("histogram");
+        using namespace std::chrono;
+
+        // A null metric records nothing
+        Histogram empty;
+        empty.notify(milliseconds(5));
+        BEAST_EXPECT(empty.count() == 0);
+        BEAST_EXPECT(empty.percentile(50) == microseconds(0));
+
+        // The null collector still keeps the distribution locally
+        auto const collector = NullCollector::New();
+        auto const h = collector->make_histogram("test", "latency");
+        for (int i = 0; i != 99; ++i)
+            h.notify(milliseconds(2));
+        h.notify(seconds(1));
+        BEAST_EXPECT(h.count() == 100);
+
+        auto const p50 = h.percentile(50);
+        BEAST_EXPECT(p50 >= microseconds(1875) && p50 <= microseconds(2125));
+        BEAST_EXPECT(h.percentile(100) >= milliseconds(937));
+
+        // Sub-microsecond timings round up
+        auto const fine = collector->make_histogram("fine");
+        fine.notify(nanoseconds(10));
+        BEAST_EXPECT(fine.percentile(50) == microseconds(1));
+    }
+
+    void
+    run() override
+    {
+        testBuckets();
+        testPercentiles();
+        testMerge();
+        testHistogram();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LogHistogram, insight, beast);
+
+}  // namespace insight
+}  // namespace beast
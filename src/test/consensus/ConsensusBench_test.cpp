@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <test/csf.h>
+#include <test/csf/random.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Sweep network shapes through the consensus simulator and report timings.
+
+    Every combination of UNL size, link latency distribution and
+    transaction load is simulated on a completely trusted network. The
+    results are written to the log as CSV, one table per collector, so that
+    changes to ConsensusParms or Consensus.h can be compared run to run.
+*/
+class ConsensusBench_test : public beast::unit_test::suite
+{
+    using Latency = std::function<csf::SimDuration(std::mt19937_64&)>;
+
+    struct Profile
+    {
+        char const* name;
+        Latency latency;
+    };
+
+    struct Output
+    {
+        std::stringstream rounds;
+        std::stringstream ledgers;
+        std::stringstream txs;
+        bool printHeaders = true;
+    };
+
+    void
+    simulate(
+        std::size_t numPeers,
+        Profile const& profile,
+        std::uint32_t txPerSec,
+        Output& out)
+    {
+        using namespace csf;
+        using namespace std::chrono;
+
+        Sim sim;
+        PeerGroup peers = sim.createGroup(numPeers);
+        peers.trust(peers);
+
+        // Every pair of peers gets its own link delay
+        for (Peer* a : peers)
+            for (Peer* b : peers)
+                if (a != b)
+                    a->connect(*b, profile.latency(sim.rng));
+
+        RoundCollector roundCollector;
+        LedgerCollector ledgerCollector;
+        TxCollector txCollector;
+        auto colls =
+            makeCollectors(roundCollector, ledgerCollector, txCollector);
+        sim.collectors.add(colls);
+
+        // Initial round to set prior state
+        sim.run(1);
+
+        SimDuration const simDuration = 2min;
+        SimDuration const quiet = 10s;
+        Rate const rate{txPerSec, 1000ms};
+
+        HeartbeatTimer heart(sim.scheduler);
+
+        auto peerSelector = makeSelector(
+            peers.begin(),
+            peers.end(),
+            std::vector<double>(numPeers, 1.),
+            sim.rng);
+        auto txSubmitter = makeSubmitter(
+            ConstantDistribution{rate.inv()},
+            sim.scheduler.now() + quiet,
+            sim.scheduler.now() + simDuration - quiet,
+            peerSelector,
+            sim.scheduler,
+            sim.rng);
+
+        heart.start();
+        sim.run(simDuration);
+
+        BEAST_EXPECT(sim.branches() == 1);
+
+        std::string const tag = std::to_string(numPeers) + "_" +
+            profile.name + "_" + std::to_string(txPerSec);
+        roundCollector.csv(simDuration, out.rounds, tag, out.printHeaders);
+        ledgerCollector.csv(simDuration, out.ledgers, tag, out.printHeaders);
+        txCollector.csv(simDuration, out.txs, tag, out.printHeaders);
+        out.printHeaders = false;
+    }
+
+    void
+    run() override
+    {
+        using namespace std::chrono;
+
+        std::vector<Profile> const profiles = {
+            {"fixed200ms",
+             [](std::mt19937_64&) -> csf::SimDuration { return 200ms; }},
+            {"uniform10to400ms",
+             [](std::mt19937_64& rng) -> csf::SimDuration {
+                 return milliseconds(
+                     std::uniform_int_distribution<>{10, 400}(rng));
+             }},
+            {"exponential100ms",
+             [](std::mt19937_64& rng) -> csf::SimDuration {
+                 return milliseconds(
+                     1 +
+                     int(std::exponential_distribution<>{1. / 100}(rng)));
+             }}};
+
+        Output out;
+        for (std::size_t const numPeers : {5, 15, 35})
+            for (auto const& profile : profiles)
+                for (std::uint32_t const txPerSec : {10, 100})
+                    simulate(numPeers, profile, txPerSec, out);
+
+        // tag is <peers>_<latency profile>_<tx per second>
+        log << out.rounds.str() << std::endl;
+        log << out.ledgers.str() << std::endl;
+        log << out.txs.str() << std::endl;
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL_PRIO(ConsensusBench, consensus, ripple, 80);
+
+}  // namespace test
+}  // namespace ripple
@@ -1055,6 +1055,49 @@ public:
         BEAST_EXPECT(sim.synchronized());
     }
 
+    void
+    testDisputedTx()
+    {
+        using namespace csf;
+        testcase("disputed tx");
+
+        ConsensusParms const parms{};
+        auto peers = std::make_shared<DisputePeers<PeerID>>();
+        DisputedTx<Tx, PeerID> dispute{Tx{1}, false, 100, peers, journal_};
+
+        // Enough peers that the votes span more than one word
+        for (std::uint32_t i = 0; i < 100; ++i)
+            dispute.setVote(PeerID{i}, i < 70);
+        BEAST_EXPECT(peers->size() == 100);
+        BEAST_EXPECT(dispute.getJson()["yays"] == 70);
+        BEAST_EXPECT(dispute.getJson()["nays"] == 30);
+
+        dispute.setVote(PeerID{5}, false);
+        dispute.setVote(PeerID{5}, false);
+        BEAST_EXPECT(dispute.getJson()["yays"] == 69);
+        BEAST_EXPECT(dispute.getJson()["nays"] == 31);
+
+        dispute.unVote(PeerID{80});
+        dispute.unVote(PeerID{500});
+        BEAST_EXPECT(dispute.getJson()["nays"] == 30);
+        BEAST_EXPECT(dispute.getJson()["votes"].size() == 99);
+        BEAST_EXPECT(dispute.getJson()["votes"]["5"] == false);
+        BEAST_EXPECT(dispute.getJson()["votes"]["6"] == true);
+
+        BEAST_EXPECT(dispute.updateVote(50, false, parms));
+        BEAST_EXPECT(dispute.getOurVote());
+        BEAST_EXPECT(!dispute.updateVote(50, false, parms));
+
+        // Another dispute of the same round shares the peer indices
+        DisputedTx<Tx, PeerID> other{Tx{2}, true, 100, peers, journal_};
+        other.setVote(PeerID{99}, true);
+        other.setVote(PeerID{100}, false);
+        BEAST_EXPECT(peers->size() == 101);
+        BEAST_EXPECT(other.getJson()["yays"] == 1);
+        BEAST_EXPECT(other.getJson()["nays"] == 1);
+        BEAST_EXPECT(dispute.getJson()["nays"] == 30);
+    }
+
     void
     run() override
     {
@@ -1071,6 +1114,7 @@ public:
         testHubNetwork();
         testPreferredByBranch();
         testPauseForLaggards();
+        testDisputedTx();
     }
 };
 
@@ -0,0 +1,131 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/consensus/LedgerTrie.h>
+#include <test/csf/ledgers.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Times LedgerTrie::getPreferred on a trie the size of a busy network's.
+
+    Many validators support tips spread over the recent end of a long
+    chain with forks. The preferred ledger is looked up repeatedly with
+    the support unchanged, and again after every change of support.
+*/
+class LedgerTrieBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    void
+    run() override
+    {
+        using namespace csf;
+        using namespace std::chrono;
+
+        // Length of the main chain and the number of forks off it
+        std::size_t constexpr chain = 2000;
+        std::size_t constexpr forks = 200;
+        std::size_t constexpr forkLength = 8;
+        // Validators, and how far behind the tip the oldest validates
+        std::size_t constexpr validators = 1000;
+        std::size_t constexpr spread = 64;
+        // Lookups per measurement
+        std::size_t constexpr lookups = 2000;
+
+        std::mt19937 gen{42};
+        LedgerOracle oracle;
+        Tx::ID nextTx{0};
+
+        std::vector<Ledger> ledgers{Ledger{Ledger::MakeGenesis{}}};
+        for (std::size_t i = 0; i < chain; ++i)
+            ledgers.push_back(oracle.accept(ledgers.back(), ++nextTx));
+
+        std::uniform_int_distribution<std::size_t> recent(
+            chain - spread, chain);
+        std::size_t const mainline = ledgers.size();
+        for (std::size_t f = 0; f < forks; ++f)
+        {
+            auto parent = ledgers[recent(gen)];
+            for (std::size_t i = 0; i < forkLength; ++i)
+            {
+                parent = oracle.accept(parent, ++nextTx);
+                ledgers.push_back(parent);
+            }
+        }
+
+        std::uniform_int_distribution<std::size_t> any(
+            mainline - spread, ledgers.size() - 1);
+        std::vector<Ledger> tips;
+        LedgerTrie<Ledger> trie;
+        for (std::size_t v = 0; v < validators; ++v)
+        {
+            tips.push_back(ledgers[any(gen)]);
+            trie.insert(tips.back());
+        }
+
+        log << validators << " validators on " << ledgers.size()
+            << " ledgers" << std::endl;
+
+        auto report = [&](char const* what, clock::duration elapsed) {
+            log << "  " << what << ": "
+                << duration_cast<nanoseconds>(elapsed).count() / lookups
+                << "ns per lookup" << std::endl;
+        };
+
+        // The support does not change between lookups
+        {
+            std::size_t found = 0;
+            auto const start = clock::now();
+            for (std::size_t i = 0; i < lookups; ++i)
+                found += trie.getPreferred(Ledger::Seq{0}) ? 1 : 0;
+            report("unchanged support", clock::now() - start);
+            BEAST_EXPECT(found == lookups);
+        }
+
+        // One validator moves to another ledger before each lookup
+        {
+            std::uniform_int_distribution<std::size_t> validator(
+                0, validators - 1);
+            std::size_t found = 0;
+            auto const start = clock::now();
+            for (std::size_t i = 0; i < lookups; ++i)
+            {
+                auto& tip = tips[validator(gen)];
+                trie.remove(tip);
+                tip = ledgers[any(gen)];
+                trie.insert(tip);
+                found += trie.getPreferred(Ledger::Seq{0}) ? 1 : 0;
+            }
+            report("changed support", clock::now() - start);
+            BEAST_EXPECT(found == lookups);
+        }
+
+        BEAST_EXPECT(trie.checkInvariants());
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(LedgerTrieBench, consensus, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -664,6 +664,40 @@ class LedgerTrie_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testPreferredCache()
+    {
+        using namespace csf;
+        using Seq = Ledger::Seq;
+        // The preferred ledger is remembered only until the support or the
+        // largest issued sequence changes
+        LedgerTrie<Ledger> t;
+        LedgerHistoryHelper h;
+        t.insert(h["abc"]);
+        t.insert(h["abde"], 2);
+        BEAST_EXPECT(t.getPreferred(Seq{1})->id == h["abde"].id());
+        BEAST_EXPECT(t.getPreferred(Seq{1})->id == h["abde"].id());
+
+        // A different largest issued sequence is not served from the cache
+        LedgerTrie<Ledger> fresh;
+        fresh.insert(h["abc"]);
+        fresh.insert(h["abde"], 2);
+        auto const expected = fresh.getPreferred(Seq{5});
+        auto const actual = t.getPreferred(Seq{5});
+        BEAST_EXPECT(
+            expected && actual && expected->id == actual->id &&
+            expected->seq == actual->seq);
+        BEAST_EXPECT(t.getPreferred(Seq{1})->id == h["abde"].id());
+
+        t.insert(h["abc"], 2);
+        BEAST_EXPECT(t.getPreferred(Seq{1})->id == h["abc"].id());
+        t.remove(h["abc"], 2);
+        BEAST_EXPECT(t.getPreferred(Seq{1})->id == h["abde"].id());
+        t.remove(h["abde"], 2);
+        t.remove(h["abc"]);
+        BEAST_EXPECT(t.getPreferred(Seq{1}) == boost::none);
+    }
+
     void
     run() override
     {
@@ -672,6 +706,7 @@ class LedgerTrie_test : public beast::unit_test::suite
         testEmpty();
         testSupport();
         testGetPreferred();
+        testPreferredCache();
         testRootRelated();
         testStress();
     }
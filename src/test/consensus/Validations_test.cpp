@@ -1089,6 +1089,54 @@ class Validations_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testTrustedValidatedCounts()
+    {
+        using namespace std::chrono_literals;
+        testcase("Trusted validated counts");
+
+        LedgerHistoryHelper h;
+        TestHarness harness(h.oracle);
+        Node a = harness.makeNode(), b = harness.makeNode(),
+             c = harness.makeNode(), d = harness.makeNode();
+        d.untrust();
+
+        for (auto const& id : {"a", "ab", "abc", "abcd"})
+        {
+            BEAST_EXPECT(ValStatus::current == harness.add(a.validate(h[id])));
+            BEAST_EXPECT(ValStatus::current == harness.add(c.partial(h[id])));
+            BEAST_EXPECT(ValStatus::current == harness.add(d.validate(h[id])));
+            harness.clock().advance(1s);
+        }
+        // b skips a ledger and ends on another branch
+        for (auto const& id : {"a", "abc", "abce"})
+        {
+            harness.clock().advance(1s);
+            BEAST_EXPECT(ValStatus::current == harness.add(b.validate(h[id])));
+        }
+
+        std::vector<Ledger::ID> const chain = {
+            h["a"].id(), h["ab"].id(), h["abc"].id(), h["abcd"].id()};
+        Ledger::Seq const last = h["abcd"].seq();
+
+        auto counts = harness.vals().getTrustedValidatedCounts(last, chain);
+        BEAST_EXPECT(counts.size() == 2);
+        BEAST_EXPECT(counts[a.nodeID()] == 4);
+        BEAST_EXPECT(counts[b.nodeID()] == 2);
+
+        // Only the end of the chain
+        counts = harness.vals().getTrustedValidatedCounts(
+            last, {h["abc"].id(), h["abcd"].id()});
+        BEAST_EXPECT(counts[a.nodeID()] == 2);
+        BEAST_EXPECT(counts[b.nodeID()] == 1);
+
+        harness.vals().trustChanged({d.nodeID()}, {a.nodeID()});
+        counts = harness.vals().getTrustedValidatedCounts(last, chain);
+        BEAST_EXPECT(counts.size() == 2);
+        BEAST_EXPECT(counts.count(a.nodeID()) == 0);
+        BEAST_EXPECT(counts[d.nodeID()] == 4);
+    }
+
     void
     run() override
     {
@@ -1106,6 +1154,7 @@ class Validations_test : public beast::unit_test::suite
         testNumTrustedForLedger();
         testSeqEnforcer();
         testTrustChanged();
+        testTrustedValidatedCounts();
     }
 };
 
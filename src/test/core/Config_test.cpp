@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/basics/contract.h>
+#include <ripple/beast/utility/temp_dir.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/ConfigSections.h>
 #include <ripple/server/Port.h>
@@ -1139,6 +1140,84 @@ r.ripple.com 51235
         BEAST_EXPECT(!testDiverged("901"));
     }
 
+    void
+    testAutoTune()
+    {
+        using namespace std::chrono_literals;
+
+        testcase("node_size auto");
+
+        constexpr std::uint64_t gigabyte = 1024 * 1024 * 1024;
+        auto tune = [](unsigned cores,
+                       std::uint64_t memory,
+                       boost::optional<std::chrono::microseconds> latency =
+                           boost::none) {
+            HostResources host;
+            host.cores = cores;
+            host.memory = memory;
+            host.readLatency = latency;
+            return autoTune(host);
+        };
+
+        // Memory picks the size, few cores cap it
+        BEAST_EXPECT(tune(8, 4 * gigabyte).nodeSize == 0);
+        BEAST_EXPECT(tune(8, 8 * gigabyte).nodeSize == 1);
+        BEAST_EXPECT(tune(8, 12 * gigabyte).nodeSize == 2);
+        BEAST_EXPECT(tune(8, 16 * gigabyte).nodeSize == 3);
+        BEAST_EXPECT(tune(8, 64 * gigabyte).nodeSize == 4);
+        BEAST_EXPECT(tune(2, 64 * gigabyte).nodeSize == 1);
+        BEAST_EXPECT(tune(1, 64 * gigabyte).nodeSize == 0);
+        BEAST_EXPECT(tune(0, 0).nodeSize == 0);
+
+        // The disk picks the threads
+        auto const unmeasured = tune(8, 64 * gigabyte);
+        BEAST_EXPECT(unmeasured.workers == 6);
+        BEAST_EXPECT(unmeasured.readThreads == 4);
+        auto const fast = tune(8, 64 * gigabyte, 50us);
+        BEAST_EXPECT(fast.workers == 6);
+        BEAST_EXPECT(fast.readThreads == 2);
+        auto const slow = tune(8, 64 * gigabyte, 5000us);
+        BEAST_EXPECT(slow.workers == 10);
+        BEAST_EXPECT(slow.readThreads == 16);
+        BEAST_EXPECT(tune(1, 0, 5000us).readThreads == 4);
+
+        // Small nodes search shorter paths
+        BEAST_EXPECT(tune(1, 0).pathSearch == 4);
+        BEAST_EXPECT(tune(1, 0).pathSearchMax == 6);
+        BEAST_EXPECT(unmeasured.pathSearch == 7);
+        BEAST_EXPECT(unmeasured.pathSearchMax == 10);
+
+        // An empty node store directory is not measured
+        beast::temp_dir dir;
+        {
+            Config c;
+            c.loadFromString(
+                "[node_size]\nauto\n[node_db]\ntype=memory\npath=" +
+                dir.path() + "\n");
+            auto const tuning = autoTune(c.HOST_RESOURCES);
+            BEAST_EXPECT(c.NODE_SIZE_AUTO);
+            BEAST_EXPECT(!c.HOST_RESOURCES.readLatency);
+            BEAST_EXPECT(c.NODE_SIZE == tuning.nodeSize);
+            BEAST_EXPECT(c.WORKERS_AUTO);
+            BEAST_EXPECT(c.WORKERS == static_cast<std::size_t>(tuning.workers));
+            BEAST_EXPECT(c.NODESTORE_READ_THREADS == tuning.readThreads);
+            BEAST_EXPECT(c.PATH_SEARCH == tuning.pathSearch);
+        }
+
+        // Explicit settings are kept
+        {
+            Config c;
+            c.loadFromString(
+                "[node_size]\nauto\n[workers]\n3\n[path_search]\n2\n"
+                "[node_db]\ntype=memory\npath=" +
+                dir.path() + "\n");
+            BEAST_EXPECT(!c.WORKERS_AUTO);
+            BEAST_EXPECT(c.WORKERS == 3);
+            BEAST_EXPECT(c.PATH_SEARCH == 2);
+            BEAST_EXPECT(c.PATH_SEARCH_FAST == 2);
+        }
+    }
+
     void
     run() override
     {
@@ -1154,6 +1233,7 @@ r.ripple.com 51235
         testGetters();
         testAmendment();
         testOverlay();
+        testAutoTune();
     }
 };
 
@@ -0,0 +1,125 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/core/CoroStackPool.h>
+#include <boost/coroutine/all.hpp>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Measures the cost of the coroutines that run client requests.
+
+    Each simulated request runs on its own coroutine with a 1MB stack,
+    touches as much of the stack as a typical RPC handler, suspends once
+    the way a request waiting on the network or the job queue does, and is
+    then resumed to completion. Batches of requests are live at once, as
+    under concurrent load.
+
+    Reports requests per second and CPU time per request, with stacks
+    from malloc, as boost.coroutine's default allocator does, and with
+    stacks from a CoroStackPool.
+*/
+class CoroBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+    using coro_t = boost::coroutines::asymmetric_coroutine<void>;
+
+    static constexpr std::size_t stackSize = megabytes(1);
+    static constexpr std::size_t requests = 20000;
+
+    // Touch some stack, as a handler's call chain does
+    static std::size_t
+    handle(std::size_t depth)
+    {
+        volatile char frame[4096];
+        std::memset(const_cast<char*>(frame), int(depth), sizeof(frame));
+        if (depth == 0)
+            return frame[0];
+        return frame[100] + handle(depth - 1);
+    }
+
+    template <class Make>
+    void
+    measure(char const* label, std::size_t concurrent, Make&& make)
+    {
+        std::vector<coro_t::pull_type> live;
+        live.reserve(concurrent);
+        std::size_t sum = 0;
+
+        auto const start = clock::now();
+        auto const cpuStart = std::clock();
+        for (std::size_t done = 0; done < requests; done += concurrent)
+        {
+            for (std::size_t i = 0; i < concurrent; ++i)
+            {
+                live.push_back(make([&sum](coro_t::push_type& yield) {
+                    yield();
+                    sum += handle(8);
+                }));
+            }
+            for (auto& coro : live)
+                coro();
+            live.clear();
+        }
+        auto const cpu = std::clock() - cpuStart;
+        auto const elapsed = std::chrono::duration_cast<
+            std::chrono::duration<double>>(clock::now() - start);
+
+        log << label << ", " << concurrent << " concurrent: "
+            << static_cast<std::size_t>(requests / elapsed.count())
+            << " requests/s, "
+            << static_cast<std::size_t>(1e9 * cpu / CLOCKS_PER_SEC / requests)
+            << "ns CPU per request" << std::endl;
+        BEAST_EXPECT(sum != 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        for (std::size_t const concurrent : {1, 16, 64, 256})
+        {
+            measure("malloc", concurrent, [](auto&& fn) {
+                return coro_t::pull_type(
+                    std::move(fn),
+                    boost::coroutines::attributes(stackSize),
+                    boost::coroutines::standard_stack_allocator());
+            });
+
+            CoroStackPool pool(stackSize, 64);
+            measure("pooled", concurrent, [&pool](auto&& fn) {
+                return coro_t::pull_type(
+                    std::move(fn),
+                    boost::coroutines::attributes(pool.stackSize()),
+                    CoroStackPool::Allocator(pool));
+            });
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(CoroBench, core, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/core/CoroStackPool.h>
+#include <boost/coroutine/all.hpp>
+
+namespace ripple {
+namespace test {
+
+class CoroStackPool_test : public beast::unit_test::suite
+{
+    using coro_t = boost::coroutines::asymmetric_coroutine<void>;
+
+    void
+    testReuse()
+    {
+        testcase("reuse");
+        CoroStackPool pool(kilobytes(64), 2);
+        CoroStackPool::Allocator alloc(pool);
+
+        boost::coroutines::stack_context a;
+        boost::coroutines::stack_context b;
+        boost::coroutines::stack_context c;
+        alloc.allocate(a, pool.stackSize());
+        alloc.allocate(b, pool.stackSize());
+        alloc.allocate(c, pool.stackSize());
+        BEAST_EXPECT(a.size == pool.stackSize());
+        BEAST_EXPECT(a.sp != b.sp && b.sp != c.sp && a.sp != c.sp);
+        BEAST_EXPECT(pool.idle() == 0);
+
+        // Only two stacks are kept
+        alloc.deallocate(a);
+        alloc.deallocate(b);
+        alloc.deallocate(c);
+        BEAST_EXPECT(pool.idle() == 2);
+
+        // The last stack kept is handed out first
+        boost::coroutines::stack_context d;
+        alloc.allocate(d, pool.stackSize());
+        BEAST_EXPECT(d.sp == b.sp);
+        BEAST_EXPECT(pool.idle() == 1);
+
+        // Other sizes bypass the pool
+        boost::coroutines::stack_context e;
+        alloc.allocate(e, kilobytes(128));
+        BEAST_EXPECT(e.size == kilobytes(128));
+        BEAST_EXPECT(pool.idle() == 1);
+        alloc.deallocate(e);
+        BEAST_EXPECT(pool.idle() == 1);
+        alloc.deallocate(d);
+        BEAST_EXPECT(pool.idle() == 2);
+    }
+
+    void
+    testCoroutines()
+    {
+        testcase("coroutines");
+        CoroStackPool pool(kilobytes(64), 4);
+
+        // Coroutines run on pooled stacks and give them back when done
+        int steps = 0;
+        for (int i = 0; i < 10; ++i)
+        {
+            coro_t::pull_type coro(
+                [&](coro_t::push_type& yield) {
+                    ++steps;
+                    yield();
+                    ++steps;
+                },
+                boost::coroutines::attributes(pool.stackSize()),
+                CoroStackPool::Allocator(pool));
+            BEAST_EXPECT(pool.idle() == 0);
+            coro();
+            BEAST_EXPECT(!coro);
+        }
+        BEAST_EXPECT(steps == 20);
+        BEAST_EXPECT(pool.idle() == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testReuse();
+        testCoroutines();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CoroStackPool, core, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -21,7 +21,10 @@
 #include <ripple/crypto/csprng.h>
 #include <boost/filesystem.hpp>
 #include <fstream>
+#include <set>
 #include <streambuf>
+#include <thread>
+#include <vector>
 #include <test/jtx/Env.h>
 
 namespace ripple {
@@ -49,11 +52,57 @@ class CryptoPRNG_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testThreads()
+    {
+        testcase("Threads");
+
+        // Each thread draws from its own buffer; no value may be handed
+        // out twice, within a thread or across them.
+        std::size_t const threads = 4;
+        std::size_t const count = 5000;
+        std::vector<std::vector<std::uint64_t>> values(threads);
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&values, t, count] {
+                auto& engine = crypto_prng();
+                auto& v = values[t];
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    v.push_back(engine());
+
+                    // Odd sizes and large fills interleaved with integers
+                    std::uint8_t small[3];
+                    engine(small, sizeof(small));
+                    if (i % 100 == 0)
+                    {
+                        std::uint64_t large[16];
+                        engine(large, sizeof(large));
+                        v.insert(v.end(), std::begin(large), std::end(large));
+                    }
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+
+        std::set<std::uint64_t> seen;
+        std::size_t total = 0;
+        for (auto const& v : values)
+        {
+            seen.insert(v.begin(), v.end());
+            total += v.size();
+        }
+        BEAST_EXPECT(seen.size() == total);
+    }
+
 public:
     void
     run() override
     {
         testGetValues();
+        testThreads();
     }
 };
 
@@ -20,6 +20,11 @@
 #include <ripple/beast/unit_test.h>
 #include <ripple/core/JobQueue.h>
 #include <test/jtx/Env.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -154,12 +159,147 @@ class JobQueue_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testPriority()
+    {
+        jtx::Env env{*this};
+
+        // A standalone Env runs a single worker thread, so the jobs
+        // below run one at a time in the order the queue picks them.
+        JobQueue& jQueue = env.app().getJobQueue();
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool release = false;
+        std::vector<std::string> order;
+
+        auto record = [&](std::string const& name) {
+            return [&, name](Job&) {
+                std::lock_guard lock(mutex);
+                order.push_back(name);
+            };
+        };
+
+        // Hold the worker until every other job has been queued
+        BEAST_EXPECT(jQueue.addJob(jtADMIN, "JobBlock", [&](Job&) {
+            std::unique_lock lock(mutex);
+            order.push_back("block");
+            cv.notify_all();
+            cv.wait(lock, [&] { return release; });
+        }));
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return !order.empty(); });
+        }
+
+        BEAST_EXPECT(jQueue.addJob(jtPACK, "JobPack1", record("pack1")));
+        BEAST_EXPECT(jQueue.addJob(jtCLIENT, "JobClient1", record("client1")));
+        BEAST_EXPECT(jQueue.addJob(jtPACK, "JobPack2", record("pack2")));
+        BEAST_EXPECT(jQueue.addJob(jtCLIENT, "JobClient2", record("client2")));
+        BEAST_EXPECT(jQueue.addJob(jtADMIN, "JobAdmin", record("admin")));
+
+        BEAST_EXPECT(jQueue.getJobCount(jtPACK) == 2);
+        BEAST_EXPECT(jQueue.getJobCount(jtCLIENT) >= 2);
+        BEAST_EXPECT(jQueue.getJobCountTotal(jtADMIN) == 2);
+        BEAST_EXPECT(jQueue.getJobCountGE(jtADMIN) == 1);
+
+        {
+            std::lock_guard lock(mutex);
+            release = true;
+        }
+        cv.notify_all();
+        jQueue.rendezvous();
+
+        // Higher job types run first, and each type runs oldest first
+        std::vector<std::string> const expected{
+            "block", "admin", "client1", "client2", "pack1", "pack2"};
+        BEAST_EXPECT(order == expected);
+        BEAST_EXPECT(jQueue.getJobCountTotal(jtPACK) == 0);
+    }
+
+    void
+    testPromotion()
+    {
+        using namespace std::chrono_literals;
+        jtx::Env env{*this};
+
+        JobQueue& jQueue = env.app().getJobQueue();
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool release = false;
+        std::vector<std::string> order;
+
+        auto record = [&](std::string const& name) {
+            return [&, name](Job&) {
+                std::lock_guard lock(mutex);
+                order.push_back(name);
+            };
+        };
+
+        BEAST_EXPECT(jQueue.addJob(jtADMIN, "JobBlock", [&](Job&) {
+            std::unique_lock lock(mutex);
+            order.push_back("block");
+            cv.notify_all();
+            cv.wait(lock, [&] { return release; });
+        }));
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return !order.empty(); });
+        }
+
+        // Local transactions have a 100ms average latency target, client
+        // commands 2000ms and administration none.
+        BEAST_EXPECT(jQueue.addJob(jtCLIENT, "JobClient", record("client")));
+        BEAST_EXPECT(
+            jQueue.addJob(jtTRANSACTION_l, "JobLocal", record("local")));
+        BEAST_EXPECT(jQueue.addJob(jtADMIN, "JobAdmin", record("admin")));
+
+        BEAST_EXPECT(!jQueue.isBacklogged(jtTRANSACTION_l));
+        std::this_thread::sleep_for(150ms);
+        BEAST_EXPECT(jQueue.isBacklogged(jtTRANSACTION_l));
+        BEAST_EXPECT(!jQueue.isBacklogged(jtCLIENT));
+        BEAST_EXPECT(!jQueue.isBacklogged(jtADMIN));
+
+        {
+            std::lock_guard lock(mutex);
+            release = true;
+        }
+        cv.notify_all();
+        jQueue.rendezvous();
+
+        // The overdue local transaction runs ahead of higher priorities
+        std::vector<std::string> const expected{
+            "block", "local", "admin", "client"};
+        BEAST_EXPECT(order == expected);
+        BEAST_EXPECT(!jQueue.isBacklogged(jtTRANSACTION_l));
+
+        // Every job that ran was counted in its type's histograms
+        auto const jv = jQueue.getJson();
+        bool found = false;
+        for (auto const& pri : jv["job_types"])
+        {
+            if (pri["job_type"] != "localTransaction")
+                continue;
+            found = true;
+            // Waited at least 150ms, ran in well under a second
+            BEAST_EXPECT(pri["wait_us"]["p50"].asUInt() >= 140'000);
+            BEAST_EXPECT(
+                pri["wait_us"]["p99"].asUInt() ==
+                pri["wait_us"]["p50"].asUInt());
+            BEAST_EXPECT(pri["run_us"]["p50"].asUInt() < 1'000'000);
+        }
+        BEAST_EXPECT(found);
+    }
+
 public:
     void
     run() override
     {
         testAddJob();
         testPostCoro();
+        testPriority();
+        testPromotion();
     }
 };
 
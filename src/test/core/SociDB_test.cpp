@@ -20,10 +20,13 @@
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/basics/contract.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/core/DatabaseCon.h>
 #include <ripple/core/SociDB.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <test/jtx/TestSuite.h>
+#include <chrono>
+#include <thread>
 
 namespace ripple {
 class SociDB_test final : public TestSuite
@@ -355,12 +358,143 @@ public:
             bfs::remove(dbPath);
     }
     void
+    testReadConnections()
+    {
+        testcase("readConnections");
+        namespace bfs = boost::filesystem;
+        DatabaseCon::Setup setup;
+        setup.dataDir = getDatabasePath();
+        setup.readConnections = 2;
+        bfs::path const dbPath = setup.dataDir / "SociReadTestDB.db";
+        {
+            std::array<char const*, 1> const pragma{
+                {"PRAGMA journal_mode=wal;"}};
+            std::array<char const*, 1> const init{
+                {"CREATE TABLE IF NOT EXISTS ReadTest ("
+                 "  Key INTEGER PRIMARY KEY,"
+                 "  IntData INTEGER"
+                 ");"}};
+            DatabaseCon con(setup, "SociReadTestDB.db", pragma, init);
+
+            {
+                auto db = con.checkoutDb();
+                *db << "INSERT INTO ReadTest (IntData) VALUES (7);";
+            }
+
+            // Two readers can be checked out at once, while the writer
+            // is held, and see what the writer committed
+            auto writer = con.checkoutDb();
+            auto first = con.checkoutReadDb();
+            auto second = con.checkoutReadDb();
+            BEAST_EXPECT(first.get() != second.get());
+            BEAST_EXPECT(first.get() != writer.get());
+            for (auto* s : {first.get(), second.get()})
+            {
+                int value = 0;
+                *s << "SELECT IntData FROM ReadTest;", soci::into(value);
+                BEAST_EXPECT(value == 7);
+            }
+
+            // Readers refuse to write
+            try
+            {
+                *first << "INSERT INTO ReadTest (IntData) VALUES (8);";
+                fail();
+            }
+            catch (std::exception const&)
+            {
+                pass();
+            }
+        }
+        {
+            // Without readers, reads go through the writer
+            setup.readConnections = 0;
+            std::array<char const*, 0> const none{};
+            DatabaseCon con(setup, "SociReadTestDB.db", none, none);
+            soci::session* read;
+            {
+                auto db = con.checkoutReadDb();
+                read = db.get();
+            }
+            BEAST_EXPECT(read == con.checkoutDb().get());
+        }
+        for (auto const& suffix : {"", "-wal", "-shm"})
+        {
+            bfs::path const p(dbPath.string() + suffix);
+            if (bfs::is_regular_file(p))
+                bfs::remove(p);
+        }
+    }
+    void
+    testCheckpoint()
+    {
+        testcase("checkpoint");
+        namespace bfs = boost::filesystem;
+        using namespace std::chrono_literals;
+        DatabaseCon::Setup setup;
+        setup.dataDir = getDatabasePath();
+        bfs::path const dbPath = setup.dataDir / "SociCheckpointTestDB.db";
+        Logs logs{beast::severities::kDisabled};
+        {
+            std::array<char const*, 1> const pragma{
+                {"PRAGMA journal_mode=wal;"}};
+            std::array<char const*, 1> const init{
+                {"CREATE TABLE IF NOT EXISTS CheckpointTest ("
+                 "  Key INTEGER PRIMARY KEY,"
+                 "  Data TEXT"
+                 ");"}};
+            DatabaseCon con(
+                setup,
+                "SociCheckpointTestDB.db",
+                pragma,
+                init,
+                DatabaseCon::CheckpointerSetup{&logs});
+
+            // Grow the log well past the checkpoint threshold
+            std::string const data(2000, 'x');
+            for (int i = 0; i < 4000; ++i)
+            {
+                auto db = con.checkoutDb();
+                *db << "INSERT INTO CheckpointTest (Data) VALUES (:d);",
+                    soci::use(data);
+            }
+
+            auto stats = con.checkpointStats();
+            for (int i = 0; i < 100 && stats && !stats->pagesWritten; ++i)
+            {
+                std::this_thread::sleep_for(50ms);
+                stats = con.checkpointStats();
+            }
+            if (BEAST_EXPECT(stats))
+            {
+                BEAST_EXPECT(stats->checkpoints > 0);
+                BEAST_EXPECT(stats->pagesWritten > 0);
+                BEAST_EXPECT(stats->walPages > 0);
+                BEAST_EXPECT(stats->maxDuration >= stats->lastDuration);
+            }
+        }
+        {
+            // No checkpointer, no stats
+            std::array<char const*, 0> const none{};
+            DatabaseCon con(setup, "SociCheckpointTestDB.db", none, none);
+            BEAST_EXPECT(!con.checkpointStats());
+        }
+        for (auto const& suffix : {"", "-wal", "-shm"})
+        {
+            bfs::path const p(dbPath.string() + suffix);
+            if (bfs::is_regular_file(p))
+                bfs::remove(p);
+        }
+    }
+    void
     testSQLite()
     {
         testSQLiteFileNames();
         testSQLiteSession();
         testSQLiteSelect();
         testSQLiteDeleteWithSubselect();
+        testReadConnections();
+        testCheckpoint();
     }
     void
     run() override
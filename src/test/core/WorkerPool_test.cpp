@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/core/WorkerPool.h>
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class WorkerPool_test : public beast::unit_test::suite
+{
+    void
+    testRun()
+    {
+        testcase("run");
+
+        WorkerPool pool(3);
+        BEAST_EXPECT(pool.concurrency() == 4);
+
+        // Every index is called once
+        std::vector<std::atomic<int>> calls(10000);
+        pool.run(calls.size(), [&](std::size_t i) { ++calls[i]; });
+        bool once = true;
+        for (auto const& c : calls)
+            once = once && c == 1;
+        BEAST_EXPECT(once);
+
+        pool.run(0, [&](std::size_t) { fail("called"); });
+
+        // A loop too short for its grain runs on the caller alone
+        std::set<std::thread::id> ids;
+        std::mutex mutex;
+        pool.run(
+            15,
+            [&](std::size_t) {
+                std::lock_guard lock(mutex);
+                ids.insert(std::this_thread::get_id());
+            },
+            16);
+        BEAST_EXPECT(
+            ids.size() == 1 && *ids.begin() == std::this_thread::get_id());
+
+        // Without pool threads the caller does everything
+        WorkerPool none(0);
+        BEAST_EXPECT(none.concurrency() == 1);
+        std::size_t sum = 0;
+        none.run(100, [&](std::size_t i) { sum += i; });
+        BEAST_EXPECT(sum == 4950);
+    }
+
+    void
+    testException()
+    {
+        testcase("exception");
+
+        WorkerPool pool(2);
+        std::atomic<std::size_t> called{0};
+        try
+        {
+            pool.run(1000, [&](std::size_t i) {
+                ++called;
+                if (i == 500)
+                    throw std::runtime_error("five hundred");
+            });
+            fail("no exception");
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(std::string(e.what()) == "five hundred");
+        }
+        BEAST_EXPECT(called == 1000);
+    }
+
+    void
+    testShared()
+    {
+        testcase("shared");
+
+        // Several callers at once, some running loops within loops, all
+        // finish with the same few pool threads
+        WorkerPool pool(2);
+        std::atomic<std::size_t> total{0};
+        std::vector<std::thread> callers;
+        for (int c = 0; c < 8; ++c)
+        {
+            callers.emplace_back([&] {
+                for (int round = 0; round < 50; ++round)
+                {
+                    pool.run(20, [&](std::size_t) {
+                        pool.run(10, [&](std::size_t) { ++total; });
+                    });
+                }
+            });
+        }
+        for (auto& caller : callers)
+            caller.join();
+        BEAST_EXPECT(total == 8 * 50 * 20 * 10);
+    }
+
+public:
+    void
+    run() override
+    {
+        testRun();
+        testException();
+        testShared();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(WorkerPool, core, ripple);
+
+}  // namespace test
+}  // namespace ripple
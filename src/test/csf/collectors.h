@@ -22,6 +22,7 @@
 #include <ripple/basics/UnorderedContainers.h>
 #include <boost/optional.hpp>
 #include <chrono>
+#include <map>
 #include <ostream>
 #include <test/csf/Histogram.h>
 #include <test/csf/SimTime.h>
@@ -707,6 +708,186 @@ struct StreamCollector
     }
 };
 
+/** Tracks the duration of consensus rounds and how well peers agree.
+
+    Measures, for every peer, the time from starting a round to accepting
+    its result, how closely the close times of ledgers with the same
+    sequence number match across the network, and how many messages peers
+    relayed to each other. Intended for comparing the performance of
+    consensus parameters rather than checking correctness.
+*/
+struct RoundCollector
+{
+    std::size_t rounds{0};
+    std::size_t closeTimeAgreed{0};
+
+    std::size_t proposalsRelayed{0};
+    std::size_t validationsRelayed{0};
+    std::size_t messagesRelayed{0};
+
+    std::map<PeerID, SimTime> roundStart_;
+
+    // Earliest and latest close time of the ledgers accepted for each
+    // sequence number
+    std::map<
+        Ledger::Seq,
+        std::pair<NetClock::time_point, NetClock::time_point>>
+        closeTimes_;
+
+    using Hist = Histogram<SimTime::duration>;
+    Hist roundDuration;
+
+    // Ignore most events by default
+    template <class E>
+    void
+    on(PeerID, SimTime, E const& e)
+    {
+    }
+
+    template <class V>
+    void
+    on(PeerID, SimTime, Relay<V> const& e)
+    {
+        ++messagesRelayed;
+    }
+
+    void
+    on(PeerID, SimTime, Relay<Proposal> const& e)
+    {
+        ++messagesRelayed;
+        ++proposalsRelayed;
+    }
+
+    void
+    on(PeerID, SimTime, Relay<Validation> const& e)
+    {
+        ++messagesRelayed;
+        ++validationsRelayed;
+    }
+
+    void
+    on(PeerID who, SimTime when, StartRound const& e)
+    {
+        roundStart_[who] = when;
+    }
+
+    void
+    on(PeerID who, SimTime when, AcceptLedger const& e)
+    {
+        auto const it = roundStart_.find(who);
+        if (it != roundStart_.end())
+        {
+            ++rounds;
+            roundDuration.insert(when - it->second);
+            roundStart_.erase(it);
+        }
+
+        if (e.ledger.closeAgree())
+            ++closeTimeAgreed;
+
+        auto const closeTime = e.ledger.closeTime();
+        auto const [ct, inserted] = closeTimes_.emplace(
+            e.ledger.seq(), std::make_pair(closeTime, closeTime));
+        if (!inserted)
+        {
+            ct->second.first = std::min(ct->second.first, closeTime);
+            ct->second.second = std::max(ct->second.second, closeTime);
+        }
+    }
+
+    /** The spread of close times across ledgers with the same sequence */
+    Histogram<NetClock::duration>
+    closeTimeSpread() const
+    {
+        Histogram<NetClock::duration> res;
+        for (auto const& [seq, range] : closeTimes_)
+            res.insert(range.second - range.first);
+        return res;
+    }
+
+    template <class T, class Tag>
+    void
+    csv(SimDuration simDuration,
+        T& log,
+        Tag const& tag,
+        bool printHeaders = false)
+    {
+        using namespace std::chrono;
+        auto perSec = [&simDuration](std::size_t count) {
+            return double(count) / duration_cast<seconds>(simDuration).count();
+        };
+
+        auto fmtS = [](SimDuration dur) {
+            return duration_cast<duration<float>>(dur).count();
+        };
+
+        auto const spread = closeTimeSpread();
+
+        if (printHeaders)
+        {
+            log << "tag"
+                << ","
+                << "roundNum"
+                << ","
+                << "roundDuration10Pctl"
+                << ","
+                << "roundDuration50Pctl"
+                << ","
+                << "roundDuration90Pctl"
+                << ","
+                << "closeTimeAgreeFraction"
+                << ","
+                << "closeTimeSpread50Pctl"
+                << ","
+                << "closeTimeSpreadMax"
+                << ","
+                << "msgNumRelayed"
+                << ","
+                << "msgRateRelayed"
+                << ","
+                << "proposalNumRelayed"
+                << ","
+                << "validationNumRelayed" << std::endl;
+        }
+
+        log << tag
+            << ","
+            // roundNum
+            << rounds
+            << ","
+            // roundDuration10Pctl
+            << std::setprecision(2) << fmtS(roundDuration.percentile(0.1f))
+            << ","
+            // roundDuration50Pctl
+            << std::setprecision(2) << fmtS(roundDuration.percentile(0.5f))
+            << ","
+            // roundDuration90Pctl
+            << std::setprecision(2) << fmtS(roundDuration.percentile(0.9f))
+            << ","
+            // closeTimeAgreeFraction
+            << std::setprecision(2)
+            << (rounds ? double(closeTimeAgreed) / rounds : 0.0)
+            << ","
+            // closeTimeSpread50Pctl
+            << duration_cast<seconds>(spread.percentile(0.5f)).count()
+            << ","
+            // closeTimeSpreadMax
+            << duration_cast<seconds>(spread.maxValue()).count()
+            << ","
+            // msgNumRelayed
+            << messagesRelayed
+            << ","
+            // msgRateRelayed
+            << std::setprecision(2) << perSec(messagesRelayed)
+            << ","
+            // proposalNumRelayed
+            << proposalsRelayed
+            << ","
+            // validationNumRelayed
+            << validationsRelayed << std::endl;
+    }
+};
+
 /** Saves information about Jumps for closed and fully validated ledgers. A
     jump occurs when a node closes/fully validates a new ledger that is not the
     immediate child of the prior closed/fully validated ledgers. This includes
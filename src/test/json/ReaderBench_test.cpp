@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/json/json_writer.h>
+#include <chrono>
+#include <random>
+#include <string>
+
+namespace ripple {
+namespace test {
+
+/** Measures Json::Reader throughput on typical server input.
+
+    The documents are shaped like the large inputs the server parses: a
+    submit request carrying a multi-signed tx_blob, a validator list with
+    its base64 blob, and a page of ledger objects with many small fields.
+*/
+class ReaderBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    std::mt19937 gen_{17};
+
+    std::string
+    randomString(std::size_t size, char const* alphabet)
+    {
+        std::string const chars(alphabet);
+        std::uniform_int_distribution<std::size_t> pick(0, chars.size() - 1);
+        std::string s(size, '\0');
+        for (auto& c : s)
+            c = chars[pick(gen_)];
+        return s;
+    }
+
+    std::string
+    submitRequest()
+    {
+        Json::Value jv(Json::objectValue);
+        jv["method"] = "submit";
+        auto& params = jv["params"] = Json::arrayValue;
+        auto& p = params.append(Json::objectValue);
+        p["tx_blob"] = randomString(8000, "0123456789ABCDEF");
+        p["fail_hard"] = false;
+        return Json::FastWriter{}.write(jv);
+    }
+
+    std::string
+    validatorList()
+    {
+        char const* const base64 =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        Json::Value jv(Json::objectValue);
+        jv["public_key"] = randomString(66, "0123456789ABCDEF");
+        jv["manifest"] = randomString(300, base64);
+        jv["blob"] = randomString(200000, base64);
+        jv["signature"] = randomString(128, "0123456789ABCDEF");
+        jv["version"] = 1;
+        return Json::FastWriter{}.write(jv);
+    }
+
+    std::string
+    ledgerPage()
+    {
+        Json::Value jv(Json::objectValue);
+        auto& state = jv["state"] = Json::arrayValue;
+        for (int i = 0; i < 2000; ++i)
+        {
+            auto& o = state.append(Json::objectValue);
+            o["Account"] = randomString(
+                33,
+                "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz");
+            o["Balance"] = std::to_string(gen_());
+            o["Flags"] = 0;
+            o["LedgerEntryType"] = "AccountRoot";
+            o["OwnerCount"] = i % 7;
+            o["PreviousTxnID"] = randomString(64, "0123456789ABCDEF");
+            o["PreviousTxnLgrSeq"] = 60000000 + i;
+            o["Sequence"] = i;
+            o["index"] = randomString(64, "0123456789ABCDEF");
+            o["memo"] = "line one\nline \"two\"";
+        }
+        return Json::FastWriter{}.write(jv);
+    }
+
+    void
+    measure(std::string const& name, std::string const& document)
+    {
+        using namespace std::chrono;
+
+        std::size_t const reps = std::max<std::size_t>(
+            10, (std::size_t{200} << 20) / document.size());
+
+        auto const start = clock::now();
+        bool ok = true;
+        for (std::size_t i = 0; i < reps; ++i)
+        {
+            Json::Reader reader;
+            Json::Value jv;
+            ok = reader.parse(document, jv) && ok;
+        }
+        auto const elapsed =
+            duration_cast<duration<double>>(clock::now() - start).count();
+
+        BEAST_EXPECT(ok);
+        log << name << ": " << document.size() << " bytes, "
+            << static_cast<std::size_t>(
+                   reps * document.size() / elapsed / (1 << 20))
+            << " MB/s" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        measure("submit", submitRequest());
+        measure("validator list", validatorList());
+        measure("ledger page", ledgerPage());
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ReaderBench, json, ripple);
+
+}  // namespace test
+}  // namespace ripple
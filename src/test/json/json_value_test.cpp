@@ -25,6 +25,7 @@
 #include <ripple/json/json_writer.h>
 
 #include <algorithm>
+#include <cstring>
 #include <regex>
 
 namespace ripple {
@@ -604,6 +605,49 @@ struct json_value_test : beast::unit_test::suite
         pass();
     }
 
+    void
+    test_read_strings()
+    {
+        auto parse = [](std::string const& doc, Json::Value& j) {
+            Json::Reader r;
+            return r.parse(doc, j);
+        };
+        Json::Value j;
+
+        BEAST_EXPECT(parse(R"({"a":"plain","b":"x\"y\\z\/\n\tA"})", j));
+        BEAST_EXPECT(j["a"] == "plain");
+        BEAST_EXPECT(j["b"] == "x\"y\\z/\n\tA");
+
+        // An escaped quote at the end of the string
+        BEAST_EXPECT(parse(R"({"a":"\""})", j));
+        BEAST_EXPECT(j["a"] == "\"");
+
+        // A long string with escapes throughout
+        std::string text;
+        std::string doc = R"({"a":")";
+        for (int i = 0; i < 1000; ++i)
+        {
+            text += std::string(i % 40, 'h') + "\\";
+            doc += std::string(i % 40, 'h') + "\\\\";
+        }
+        doc += "\"}";
+        BEAST_EXPECT(parse(doc, j));
+        BEAST_EXPECT(j["a"] == text);
+
+        // Unterminated strings
+        BEAST_EXPECT(!parse(R"({"a":"abc)", j));
+        BEAST_EXPECT(!parse(R"({"a":"abc\)", j));
+        BEAST_EXPECT(!parse(R"({"a":"abc\")", j));
+        BEAST_EXPECT(!parse(R"({"a":"\q"})", j));
+
+        // Duplicate member names are still rejected
+        Json::Reader r;
+        BEAST_EXPECT(!r.parse(R"({"a":1,"b":2,"a":3})", j));
+        BEAST_EXPECT(
+            r.getFormatedErrorMessages().find("Key 'a' appears twice.") !=
+            std::string::npos);
+    }
+
     void
     test_edge_cases()
     {
@@ -762,6 +806,48 @@ struct json_value_test : beast::unit_test::suite
         pass();
     }
 
+    void
+    test_small_strings()
+    {
+        std::string const shortest;
+        std::string const small(15, 's');
+        std::string const large(16, 'l');
+
+        for (auto const& str : {shortest, small, large})
+        {
+            Json::Value v1{str};
+            BEAST_EXPECT(v1.isString());
+            BEAST_EXPECT(v1.asString() == str);
+            BEAST_EXPECT(std::strcmp(v1.asCString(), str.c_str()) == 0);
+
+            Json::Value v2{v1};
+            BEAST_EXPECT(v2 == v1);
+            BEAST_EXPECT(v2.asString() == str);
+
+            Json::Value v3 = std::move(v1);
+            BEAST_EXPECT(!v1);
+            BEAST_EXPECT(v3.asString() == str);
+
+            Json::Value other{"a somewhat longer string"};
+            other.swap(v3);
+            BEAST_EXPECT(other.asString() == str);
+            BEAST_EXPECT(v3.asString() == "a somewhat longer string");
+
+            Json::Value const fromStatic{Json::StaticString("static")};
+            v3 = fromStatic;
+            BEAST_EXPECT(v3.asString() == "static");
+            BEAST_EXPECT(v3 == fromStatic);
+        }
+
+        // Short strings still order against each other and long strings
+        Json::Value const a{"abc"};
+        Json::Value const b{"abd"};
+        Json::Value const c{std::string(20, 'z')};
+        BEAST_EXPECT(a < b);
+        BEAST_EXPECT(b < c);
+        BEAST_EXPECT(!(c < a));
+    }
+
     void
     test_comparisons()
     {
@@ -1380,9 +1466,11 @@ struct json_value_test : beast::unit_test::suite
         test_compare();
         test_bool();
         test_bad_json();
+        test_read_strings();
         test_edge_cases();
         test_copy();
         test_move();
+        test_small_strings();
         test_comparisons();
         test_compact();
         test_conversions();
@@ -25,6 +25,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <test/jtx.h>
 #include <test/jtx/Env.h>
+#include <limits>
 
 namespace ripple {
 
@@ -462,6 +463,53 @@ class Invariants_test : public beast::unit_test::suite
     }
 
 public:
+    void
+    testReplaySample()
+    {
+        using namespace test::jtx;
+        testcase << "replay sample";
+
+        // Check the invariants of the transaction in each of these
+        // configurations, after manufacturing some XRP
+        auto const check = [&](std::size_t sample, ApplyFlags flags) {
+            Env env{*this, envconfig([sample](std::unique_ptr<Config> cfg) {
+                        cfg->REPLAY_INVARIANT_SAMPLE = sample;
+                        return cfg;
+                    })};
+            Account A1{"A1"};
+            env.fund(XRP(1000), A1);
+            env.close();
+
+            OpenView ov{*env.current()};
+            STTx tx{ttACCOUNT_SET, [](STObject&) {}};
+            test::StreamSink sink{beast::severities::kWarning};
+            beast::Journal jlog{sink};
+            ApplyContext ac{
+                env.app(),
+                ov,
+                tx,
+                tesSUCCESS,
+                safe_cast<FeeUnit64>(env.current()->fees().units),
+                flags,
+                jlog};
+
+            auto const sle = ac.view().peek(keylet::account(A1.id()));
+            if (!BEAST_EXPECT(sle))
+                return TER{tesSUCCESS};
+            sle->setFieldAmount(
+                sfBalance, sle->getFieldAmount(sfBalance) + STAmount{500});
+            ac.view().update(sle);
+            return ac.checkInvariants(tesSUCCESS, XRPAmount{});
+        };
+
+        // This transaction's ID is not a multiple of the sample size, so
+        // only a replay on a server that samples skips its checks.
+        auto const sample = std::numeric_limits<std::size_t>::max();
+        BEAST_EXPECT(check(1, tapREPLAY) == tecINVARIANT_FAILED);
+        BEAST_EXPECT(check(sample, tapNONE) == tecINVARIANT_FAILED);
+        BEAST_EXPECT(check(sample, tapREPLAY) == tesSUCCESS);
+    }
+
     void
     run() override
     {
@@ -474,6 +522,7 @@ public:
         testNoBadOffers();
         testNoZeroEscrow();
         testValidNewAccountRoot();
+        testReplaySample();
     }
 };
 
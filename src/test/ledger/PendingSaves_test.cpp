@@ -49,10 +49,49 @@ struct PendingSaves_test : public beast::unit_test::suite
         BEAST_EXPECT(!ps.pending(0));
     }
 
+    void
+    testQueue()
+    {
+        PendingSaves ps;
+        bool dispatch = false;
+
+        // Only the first ledger queued asks for the queue to be drained
+        BEAST_EXPECT(ps.enqueue(nullptr, dispatch));
+        BEAST_EXPECT(dispatch);
+        BEAST_EXPECT(ps.enqueue(nullptr, dispatch));
+        BEAST_EXPECT(!dispatch);
+        BEAST_EXPECT(ps.enqueue(nullptr, dispatch));
+        BEAST_EXPECT(!dispatch);
+        BEAST_EXPECT(ps.getStats().queued == 3);
+
+        BEAST_EXPECT(ps.takeBatch(2).size() == 2);
+        BEAST_EXPECT(ps.enqueue(nullptr, dispatch));
+        BEAST_EXPECT(!dispatch);
+        BEAST_EXPECT(ps.takeBatch(2).size() == 2);
+        BEAST_EXPECT(ps.takeBatch(2).empty());
+
+        auto const stats = ps.getStats();
+        BEAST_EXPECT(stats.queued == 0);
+        BEAST_EXPECT(stats.batches == 2);
+        BEAST_EXPECT(stats.ledgers == 4);
+
+        // Once drained, the next ledger asks again
+        BEAST_EXPECT(ps.enqueue(nullptr, dispatch));
+        BEAST_EXPECT(dispatch);
+        BEAST_EXPECT(ps.takeBatch(16).size() == 1);
+        BEAST_EXPECT(ps.takeBatch(16).empty());
+
+        // The queue is bounded
+        for (std::size_t i = 0; i < PendingSaves::queueLimit; ++i)
+            BEAST_EXPECT(ps.enqueue(nullptr, dispatch));
+        BEAST_EXPECT(!ps.enqueue(nullptr, dispatch));
+    }
+
     void
     run() override
     {
         testSaves();
+        testQueue();
     }
 };
 
@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/net/SubscriberFanout.h>
+#include <mutex>
+#include <test/jtx.h>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class SubscriberFanout_test : public beast::unit_test::suite
+{
+    // Records the messages published to it
+    class TestSub : public InfoSub
+    {
+    public:
+        explicit TestSub(Source& source) : InfoSub(source)
+        {
+        }
+
+        void
+        send(Json::Value const& jv, bool) override
+        {
+            std::lock_guard lock(mutex_);
+            received_.push_back(jv[jss::ledger_index].asInt());
+        }
+
+        std::vector<int>
+        received()
+        {
+            std::lock_guard lock(mutex_);
+            return received_;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::vector<int> received_;
+    };
+
+    void
+    testOrdering()
+    {
+        testcase("Ordering");
+
+        using namespace jtx;
+        Env env(*this);
+        auto& jq = env.app().getJobQueue();
+        SubscriberFanout fanout(jq, env.journal);
+
+        std::vector<std::shared_ptr<TestSub>> subs;
+        for (int i = 0; i < 20; ++i)
+            subs.push_back(std::make_shared<TestSub>(env.app().getOPs()));
+
+        int constexpr events = 200;
+        for (int e = 0; e < events; ++e)
+        {
+            Json::Value jv;
+            jv[jss::ledger_index] = e;
+            // Every other event goes to half of the subscribers
+            std::vector<InfoSub::pointer> to;
+            for (std::size_t i = 0; i < subs.size(); ++i)
+            {
+                if (e % 2 == 0 || i % 2 == 0)
+                    to.push_back(subs[i]);
+            }
+            fanout.publish(std::move(jv), std::move(to));
+        }
+        jq.rendezvous();
+
+        for (std::size_t i = 0; i < subs.size(); ++i)
+        {
+            std::vector<int> expected;
+            for (int e = 0; e < events; ++e)
+            {
+                if (e % 2 == 0 || i % 2 == 0)
+                    expected.push_back(e);
+            }
+            BEAST_EXPECT(subs[i]->received() == expected);
+        }
+        BEAST_EXPECT(fanout.dropped() == 0);
+    }
+
+    void
+    testNoSubscribers()
+    {
+        testcase("No subscribers");
+
+        using namespace jtx;
+        Env env(*this);
+        SubscriberFanout fanout(env.app().getJobQueue(), env.journal);
+        fanout.publish(Json::Value(Json::objectValue), {});
+        env.app().getJobQueue().rendezvous();
+        BEAST_EXPECT(fanout.dropped() == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testOrdering();
+        testNoSubscribers();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SubscriberFanout, net, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -20,6 +20,8 @@
 #include <ripple/beast/utility/temp_dir.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/FilteredBackend.h>
+#include <ripple/nodestore/impl/PackedShard.h>
 #include <ripple/unity/rocksdb.h>
 #include <algorithm>
 #include <test/nodestore/TestBase.h>
@@ -80,6 +82,26 @@ public:
                 fetchCopyOfBatch(*backend, &copy, batch);
                 BEAST_EXPECT(areBatchesEqual(batch, copy));
             }
+
+            {
+                // Read the payloads without constructing objects
+                for (auto const& object : batch)
+                {
+                    bool same = false;
+                    auto const status = backend->fetchPayload(
+                        object->getHash().cbegin(), [&](Slice data) {
+                            same = (data == object->getData());
+                        });
+                    BEAST_EXPECT(status == ok && same);
+                }
+
+                uint256 missing;
+                missing.data()[0] = 1;
+                bool visited = false;
+                auto const status = backend->fetchPayload(
+                    missing.cbegin(), [&](Slice) { visited = true; });
+                BEAST_EXPECT(status == notFound && !visited);
+            }
         }
 
         {
@@ -98,6 +120,247 @@ public:
         }
     }
 
+    void
+    testMappedReads(std::uint64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("NuDB mapped reads");
+
+        Section params;
+        beast::temp_dir tempDir;
+        params.set("type", "nudb");
+        params.set("path", tempDir.path());
+
+        beast::xor_shift_engine rng(seedValue);
+        auto batch = createPredictableBatch(2000, rng());
+        auto extra = createPredictableBatch(100, rng());
+
+        test::SuiteJournal journal("Backend_test", *this);
+
+        {
+            std::unique_ptr<Backend> backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+        }
+
+        params.set("mmap_reads", "1");
+        std::unique_ptr<Backend> backend = Manager::instance().make_Backend(
+            params, megabytes(4), scheduler, journal);
+        backend->open();
+
+        {
+            // Objects written before the files were mapped
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+
+        {
+            // Objects written past the end of the mapping
+            storeBatch(*backend, extra);
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, extra);
+            BEAST_EXPECT(areBatchesEqual(extra, copy));
+        }
+
+        std::shared_ptr<NodeObject> object;
+        uint256 missing;
+        missing.data()[0] = 1;
+        BEAST_EXPECT(backend->fetch(missing.cbegin(), &object) == notFound);
+    }
+
+    void
+    testPacked(std::uint64_t const seedValue)
+    {
+        testcase("Packed shard");
+
+        beast::temp_dir tempDir;
+        boost::filesystem::path const path{
+            boost::filesystem::path(tempDir.path()) / PackedShardFileName};
+
+        beast::xor_shift_engine rng(seedValue);
+        auto batch = createPredictableBatch(2000, rng());
+
+        std::vector<LedgerInfo> infos(3);
+        for (std::uint32_t i = 0; i < infos.size(); ++i)
+        {
+            infos[i].seq = 257 + i;
+            infos[i].hash.data()[0] = i + 1;
+        }
+
+        {
+            PackedShardWriter writer(path, 257, 259);
+            for (auto const& object : batch)
+                writer.add(object);
+
+            // Objects added twice are stored once
+            writer.add(batch.front());
+
+            for (auto const& info : infos)
+                writer.addLedger(info);
+
+            BEAST_EXPECT(!boost::filesystem::exists(path));
+            writer.commit();
+        }
+        BEAST_EXPECT(boost::filesystem::exists(path));
+
+        test::SuiteJournal journal("Backend_test", *this);
+        PackedBackend backend(path, journal);
+        backend.open(false);
+
+        {
+            std::shuffle(batch.begin(), batch.end(), rng);
+            Batch copy;
+            fetchCopyOfBatch(backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+
+        {
+            std::size_t count = 0;
+            backend.for_each([&](std::shared_ptr<NodeObject>) { ++count; });
+            BEAST_EXPECT(count == batch.size());
+        }
+
+        {
+            auto const ledgers = backend.ledgers();
+            BEAST_EXPECT(ledgers.size() == infos.size());
+            for (std::size_t i = 0; i < ledgers.size(); ++i)
+            {
+                BEAST_EXPECT(ledgers[i].seq == infos[i].seq);
+                BEAST_EXPECT(ledgers[i].hash == infos[i].hash);
+            }
+        }
+
+        std::shared_ptr<NodeObject> object;
+        uint256 missing;
+        missing.data()[0] = 1;
+        BEAST_EXPECT(backend.fetch(missing.cbegin(), &object) == notFound);
+
+        // Storing objects the file already holds is accepted
+        backend.store(batch.front());
+        auto extra = createPredictableBatch(1, rng());
+        try
+        {
+            backend.store(extra.front());
+            fail();
+        }
+        catch (std::logic_error const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testKeyFilter(std::uint64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("Key filter");
+
+        Section params;
+        beast::temp_dir tempDir;
+        params.set("type", "nudb");
+        params.set("path", tempDir.path());
+        params.set("key_filter", "1");
+        params.set("key_filter_size", "4000");
+
+        beast::xor_shift_engine rng(seedValue);
+        auto batch = createPredictableBatch(2000, rng());
+
+        test::SuiteJournal journal("Backend_test", *this);
+        auto const filterPath{
+            boost::filesystem::path(tempDir.path()) / KeyFilterFileName};
+
+        auto count = [](Backend const& backend, char const* name) {
+            Json::Value obj(Json::objectValue);
+            backend.getCountsJson(obj);
+            return std::stoull(obj["key_filter"][name].asString());
+        };
+        auto randomKey = [&rng]() {
+            uint256 key;
+            for (auto& byte : key)
+                byte = static_cast<std::uint8_t>(rng());
+            return key;
+        };
+
+        {
+            std::unique_ptr<Backend> backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(count(*backend, "keys") == batch.size());
+
+            // Nearly all missing keys are answered by the filter
+            std::shared_ptr<NodeObject> object;
+            for (int i = 0; i < 1000; ++i)
+            {
+                BEAST_EXPECT(
+                    backend->fetch(randomKey().cbegin(), &object) ==
+                    notFound);
+            }
+            BEAST_EXPECT(count(*backend, "filtered") >= 990);
+
+            // A missing key which passes the filter is remembered
+            boost::optional<uint256> passed;
+            for (int i = 0; !passed && i < 10000000; ++i)
+            {
+                auto const key = randomKey();
+                if (backend->fetch(key.cbegin(), &object) == notFound &&
+                    count(*backend, "false_positives") != 0)
+                    passed = key;
+            }
+            if (!BEAST_EXPECT(passed))
+                return;
+            BEAST_EXPECT(
+                backend->fetch(passed->cbegin(), &object) == notFound);
+            BEAST_EXPECT(count(*backend, "negative_hits") == 1);
+
+            // and found once it is stored
+            backend->store(NodeObject::createObject(
+                hotUNKNOWN, batch.front()->getData(), *passed));
+            BEAST_EXPECT(backend->fetch(passed->cbegin(), &object) == ok);
+            BEAST_EXPECT(object && object->getHash() == *passed);
+            batch.push_back(object);
+        }
+
+        // The filter saved on closing is loaded on opening
+        BEAST_EXPECT(boost::filesystem::exists(filterPath));
+        {
+            std::unique_ptr<Backend> backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            BEAST_EXPECT(!boost::filesystem::exists(filterPath));
+            BEAST_EXPECT(count(*backend, "keys") == batch.size());
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+
+        // Without a saved filter, as after a crash, it is rebuilt
+        boost::filesystem::remove(filterPath);
+        params.set("key_filter_size", "100");
+        {
+            std::unique_ptr<Backend> backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            BEAST_EXPECT(count(*backend, "keys") == batch.size());
+            BEAST_EXPECT(count(*backend, "capacity") >= batch.size());
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            std::sort(batch.begin(), batch.end(), LessThan{});
+            std::sort(copy.begin(), copy.end(), LessThan{});
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+    }
+
     //--------------------------------------------------------------------------
 
     void
@@ -106,6 +369,9 @@ public:
         std::uint64_t const seedValue = 50;
 
         testBackend("nudb", seedValue);
+        testMappedReads(seedValue);
+        testPacked(seedValue);
+        testKeyFilter(seedValue);
 
 #if RIPPLE_ROCKSDB_AVAILABLE
         testBackend("rocksdb", seedValue);
@@ -19,9 +19,13 @@
 
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/BatchWriter.h>
+#include <ripple/nodestore/impl/CodecDictionary.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/codec.h>
 #include <test/nodestore/TestBase.h>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -76,6 +80,156 @@ public:
         }
     }
 
+    // Checks that objects own a copy of their payload and that released
+    // memory is recycled
+    void
+    testPool(std::uint64_t const seedValue)
+    {
+        testcase("pool");
+
+        auto batch = createPredictableBatch(numObjectsToTest, seedValue);
+
+        for (auto const& object : batch)
+        {
+            auto const data = object->getData();
+            Blob blob(data.begin(), data.end());
+            auto const storage = blob.data();
+            auto const moved = NodeObject::createObject(
+                object->getType(), std::move(blob), object->getHash());
+            BEAST_EXPECT(isSame(object, moved));
+            BEAST_EXPECT(moved->getData().data() == storage);
+
+            auto const copy = NodeObject::createObject(
+                object->getType(), data, object->getHash());
+            BEAST_EXPECT(isSame(object, copy));
+            BEAST_EXPECT(copy->getData().data() != data.data());
+        }
+
+        // Blocks a thread still holds when it exits are handed back
+        std::thread([] {
+            NodeObject::createObject(hotUNKNOWN, Slice("payload", 7), {});
+        }).join();
+        BEAST_EXPECT(NodeObject::getPoolStats().cachedBytes > 0);
+
+        auto const before = NodeObject::getPoolStats();
+        BEAST_EXPECT(before.allocatedBytes > 0);
+        BEAST_EXPECT(before.legacyBytes > 0);
+
+        auto const size = batch.size();
+        batch.clear();
+        auto const after = NodeObject::getPoolStats();
+        BEAST_EXPECT(after.allocatedBytes < before.allocatedBytes);
+
+        // Allocations of the same sizes come back out of the free lists
+        batch = createPredictableBatch(size, seedValue);
+        BEAST_EXPECT(NodeObject::getPoolStats().reused > after.reused);
+    }
+
+    // Checks the codec round trip through a trained dictionary
+    void
+    testDictionary(std::uint64_t const seedValue)
+    {
+        testcase("dictionary");
+
+        auto const batch = createPredictableBatch(numObjectsToTest, seedValue);
+
+        // Give the samples something in common for the dictionary to find
+        std::string const common =
+            "Account Balance Flags OwnerCount PreviousTxnID Sequence";
+        std::vector<Blob> samples;
+        for (auto const& object : batch)
+        {
+            auto const data = object->getData();
+            Blob sample(common.begin(), common.end());
+            sample.insert(sample.end(), data.begin(), data.begin() + 16);
+            sample.insert(sample.end(), common.begin(), common.end());
+            samples.push_back(std::move(sample));
+        }
+
+        auto const content = CodecDictionary::train(samples, 1024);
+        BEAST_EXPECT(!content.empty() && content.size() <= 1024);
+        CodecDictionary const dict(content);
+        CodecDictionary const other(
+            Blob(content.begin(), content.begin() + content.size() / 2));
+        BEAST_EXPECT(dict.id() != other.id());
+
+        std::size_t plain = 0;
+        std::size_t trained = 0;
+        for (auto const& sample : samples)
+        {
+            nudb::detail::buffer buf;
+            plain += nodeobject_compress(sample.data(), sample.size(), buf)
+                         .second;
+
+            auto const out =
+                nodeobject_compress(sample.data(), sample.size(), buf, &dict);
+            trained += out.second;
+
+            nudb::detail::buffer buf2;
+            auto const check =
+                nodeobject_decompress(out.first, out.second, buf2, &dict);
+            BEAST_EXPECT(
+                check.second == sample.size() &&
+                std::memcmp(check.first, sample.data(), sample.size()) == 0);
+
+            // Objects can only be read with the dictionary they were
+            // written with
+            try
+            {
+                nodeobject_decompress(out.first, out.second, buf2);
+                fail("missing dictionary");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+            try
+            {
+                nodeobject_decompress(out.first, out.second, buf2, &other);
+                fail("wrong dictionary");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+        }
+        BEAST_EXPECT(trained < plain);
+    }
+
+    // Checks that a scheduler running the writer on the storing thread
+    // does not deadlock it
+    void
+    testBatchWriter(std::uint64_t const seedValue)
+    {
+        testcase("batch writer");
+
+        struct Collect : BatchWriter::Callback
+        {
+            Batch written;
+
+            void
+            writeBatch(Batch const& batch) override
+            {
+                written.insert(written.end(), batch.begin(), batch.end());
+            }
+        };
+
+        auto const batch = createPredictableBatch(numObjectsToTest, seedValue);
+
+        DummyScheduler scheduler;
+        Collect collect;
+        {
+            BatchWriter writer(collect, scheduler);
+            for (auto const& object : batch)
+                writer.store(object);
+            writer.store(batch);
+            BEAST_EXPECT(writer.getWriteLoad() == 0);
+        }
+        BEAST_EXPECT(collect.written.size() == 2 * batch.size());
+        BEAST_EXPECT(std::equal(
+            batch.begin(), batch.end(), collect.written.begin(), isSame));
+    }
+
     void
     run() override
     {
@@ -84,6 +238,12 @@ public:
         testBatches(seedValue);
 
         testBlobs(seedValue);
+
+        testPool(seedValue);
+
+        testDictionary(seedValue);
+
+        testBatchWriter(seedValue);
     }
 };
 
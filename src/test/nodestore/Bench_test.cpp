@@ -0,0 +1,467 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/unity/rocksdb.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <atomic>
+#include <beast/unit_test/thread.hpp>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <test/unit_test/SuiteJournal.h>
+#include <thread>
+
+namespace ripple {
+namespace NodeStore {
+
+/*  Objects shaped like those a server writes.
+
+    Each object is drawn from a table of shapes, which is either built in
+    or sampled from an existing database. Inner nodes carry the number
+    of non-empty branches seen, so the codec compresses them the way it
+    would on a live server.
+*/
+class Workload
+{
+public:
+    struct Shape
+    {
+        NodeObjectType type;
+        std::uint32_t prefix;
+        std::uint32_t size;
+        // Non-empty branches, for inner nodes
+        int branches;
+    };
+
+    // An approximation of the main network: a bit over half of the
+    // objects written are inner nodes, a third state leaves and the
+    // rest transaction leaves.
+    Workload()
+    {
+        beast::xor_shift_engine gen(1);
+        std::uniform_int_distribution<int> branches(2, 16);
+        std::uniform_int_distribution<std::uint32_t> stateSize(120, 400);
+        std::uniform_int_distribution<std::uint32_t> txSize(250, 1200);
+        auto const inner = static_cast<std::uint32_t>(HashPrefix::innerNode);
+        for (int i = 0; i < 100; ++i)
+        {
+            if (i < 55)
+                shapes_.push_back(
+                    {hotACCOUNT_NODE, inner, 516, branches(gen)});
+            else if (i < 90)
+                shapes_.push_back(
+                    {hotACCOUNT_NODE,
+                     static_cast<std::uint32_t>(HashPrefix::leafNode),
+                     stateSize(gen),
+                     0});
+            else
+                shapes_.push_back(
+                    {hotTRANSACTION_NODE,
+                     static_cast<std::uint32_t>(HashPrefix::txNode),
+                     txSize(gen),
+                     0});
+        }
+    }
+
+    // Sample the shapes of the objects in an existing database
+    Workload(Backend& backend, std::size_t samples)
+    {
+        std::mt19937_64 gen;
+        std::uint64_t n = 0;
+        backend.for_each([&](std::shared_ptr<NodeObject> object) {
+            auto const data = object->getData();
+            Shape shape{object->getType(), 0, std::uint32_t(data.size()), 0};
+            if (data.size() >= 4)
+                shape.prefix = (std::uint32_t(data[0]) << 24) |
+                    (std::uint32_t(data[1]) << 16) |
+                    (std::uint32_t(data[2]) << 8) | data[3];
+            if (shape.prefix ==
+                    static_cast<std::uint32_t>(HashPrefix::innerNode) &&
+                data.size() == 516)
+            {
+                for (std::size_t i = 4; i < data.size(); i += 32)
+                {
+                    if (std::any_of(
+                            data.data() + i, data.data() + i + 32, [](auto c) {
+                                return c != 0;
+                            }))
+                        ++shape.branches;
+                }
+            }
+
+            auto const i = n++;
+            if (shapes_.size() < samples)
+                shapes_.push_back(shape);
+            else if (auto const j = std::uniform_int_distribution<
+                         std::uint64_t>{0, i}(gen);
+                     j < samples)
+                shapes_[j] = shape;
+        });
+        if (shapes_.empty())
+            Throw<std::runtime_error>("no objects to sample");
+    }
+
+    // Returns the key of the n-th object
+    uint256
+    key(std::uint64_t n) const
+    {
+        beast::xor_shift_engine gen(n + 1);
+        gen();
+        uint256 key;
+        fill(key.data(), key.size(), gen);
+        return key;
+    }
+
+    // Returns the n-th object, which is the same on every call
+    std::shared_ptr<NodeObject>
+    object(std::uint64_t n) const
+    {
+        beast::xor_shift_engine gen(n + 1);
+        auto const& shape = shapes_[gen() % shapes_.size()];
+
+        uint256 key;
+        fill(key.data(), key.size(), gen);
+
+        Blob data(std::max<std::uint32_t>(shape.size, 4));
+        data[0] = shape.prefix >> 24;
+        data[1] = shape.prefix >> 16;
+        data[2] = shape.prefix >> 8;
+        data[3] = shape.prefix;
+        if (shape.branches > 0 && data.size() == 516)
+        {
+            // The empty branches are spread out like in a real tree
+            for (int i = 0; i < shape.branches; ++i)
+                fill(&data[4 + 32 * ((i * 7 + n) % 16)], 32, gen);
+        }
+        else
+        {
+            // Serialized objects repeat their field codes and common
+            // values, so only part of a leaf is random
+            auto const body = data.size() - 4;
+            for (std::size_t i = 0; i < body / 2; ++i)
+                data[4 + i] = static_cast<std::uint8_t>(i % 23);
+            fill(&data[4 + body / 2], body - body / 2, gen);
+        }
+
+        return NodeObject::createObject(shape.type, std::move(data), key);
+    }
+
+    std::size_t
+    shapes() const
+    {
+        return shapes_.size();
+    }
+
+private:
+    std::vector<Shape> shapes_;
+
+    static void
+    fill(std::uint8_t* p, std::size_t bytes, beast::xor_shift_engine& gen)
+    {
+        while (bytes > 0)
+        {
+            auto const v = gen();
+            auto const n = std::min(bytes, sizeof(v));
+            std::memcpy(p, &v, n);
+            p += n;
+            bytes -= n;
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class NodeStoreBench_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Params
+    {
+        // Objects written before measuring, so reads reach into history
+        std::size_t history;
+        // Ledgers closed while measuring
+        std::size_t ledgers;
+        // Average objects written when a ledger closes
+        std::size_t ledgerObjects;
+        // Time between ledger closes
+        std::chrono::milliseconds closeInterval;
+        // Threads reading like RPC clients
+        std::size_t readers;
+        // Percent of reads for objects which do not exist
+        std::size_t missingPercent;
+        // Percent of reads for objects from the last few ledgers
+        std::size_t recentPercent;
+    };
+
+    static Params
+    params(Section const& config)
+    {
+        Params p;
+        p.history = std::max<std::size_t>(
+            get<std::size_t>(config, "history", 200000), 1);
+        p.ledgers = get<std::size_t>(config, "ledgers", 100);
+        p.ledgerObjects = get<std::size_t>(config, "ledger_objects", 2000);
+        p.closeInterval = std::chrono::milliseconds(
+            get<std::size_t>(config, "close_ms", 250));
+        p.readers = get<std::size_t>(config, "readers", 4);
+        p.missingPercent = get<std::size_t>(config, "missing_percent", 10);
+        p.recentPercent = get<std::size_t>(config, "recent_percent", 50);
+        return p;
+    }
+
+    static std::string
+    to_string(Section const& config)
+    {
+        std::string s;
+        for (auto iter = config.begin(); iter != config.end(); ++iter)
+            s += (iter != config.begin() ? "," : "") + iter->first + "=" +
+                iter->second;
+        return s;
+    }
+
+    static Section
+    parse(std::string s)
+    {
+        Section section;
+        std::vector<std::string> v;
+        boost::split(v, s, boost::algorithm::is_any_of(","));
+        section.append(v);
+        return section;
+    }
+
+    // Formats latencies in microseconds as percentiles
+    static std::string
+    percentiles(std::vector<std::int64_t>& v)
+    {
+        if (v.empty())
+            return "no samples";
+        std::sort(v.begin(), v.end());
+        auto at = [&v](double q) {
+            return v[std::min<std::size_t>(v.size() * q, v.size() - 1)];
+        };
+        std::stringstream ss;
+        ss << "p50=" << at(0.5) << "us p90=" << at(0.9)
+           << "us p99=" << at(0.99) << "us p99.9=" << at(0.999)
+           << "us max=" << v.back() << "us";
+        return ss.str();
+    }
+
+    static double
+    rate(std::size_t n, clock_type::duration d)
+    {
+        auto const s = std::chrono::duration<double>(d).count();
+        return s > 0 ? n / s : 0;
+    }
+
+    void
+    bench(Section const& config, Workload const& workload)
+    {
+        auto const p = params(config);
+        test::SuiteJournal journal("NodeStoreBench", *this);
+        DummyScheduler scheduler;
+        auto backend = Manager::instance().make_Backend(
+            config, megabytes(4), scheduler, journal);
+        backend->open();
+
+        log << to_string(config) << std::endl;
+
+        std::atomic<std::uint64_t> written{0};
+        {
+            auto const start = clock_type::now();
+            for (; written < p.history; ++written)
+                backend->store(workload.object(written));
+            backend->sync();
+            log << "  history: " << p.history << " objects at " << std::fixed
+                << std::setprecision(0)
+                << rate(p.history, clock_type::now() - start) << "/s"
+                << std::endl;
+        }
+
+        // Readers pick recent objects, any object, or a missing one
+        std::uint64_t const missing = std::uint64_t(1) << 63;
+        std::atomic<bool> done{false};
+        std::vector<std::vector<std::int64_t>> latencies(p.readers);
+        std::vector<std::size_t> found(p.readers);
+        std::vector<beast::unit_test::thread> readers;
+        for (std::size_t id = 0; id < p.readers; ++id)
+        {
+            readers.emplace_back(*this, [&, id] {
+                beast::xor_shift_engine gen(id + 1);
+                auto& samples = latencies[id];
+                std::shared_ptr<NodeObject> object;
+                while (!done)
+                {
+                    auto const end = written.load();
+                    auto const recent = std::min<std::uint64_t>(
+                        end, 4 * p.ledgerObjects);
+                    auto const pick = gen() % 100;
+                    std::uint64_t n;
+                    if (pick < p.missingPercent)
+                        n = missing | gen();
+                    else if (pick < p.missingPercent + p.recentPercent)
+                        n = end - 1 - gen() % recent;
+                    else
+                        n = gen() % end;
+                    auto const key = workload.key(n);
+
+                    auto const start = clock_type::now();
+                    if (backend->fetch(key.data(), &object) == ok)
+                        ++found[id];
+                    samples.push_back(
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            clock_type::now() - start)
+                            .count());
+                }
+            });
+        }
+
+        // Ledger closes write a burst of objects, and then wait
+        std::vector<std::int64_t> bursts;
+        std::vector<std::int64_t> writes;
+        std::size_t objects = 0;
+        beast::xor_shift_engine gen(0);
+        auto const start = clock_type::now();
+        for (std::size_t ledger = 0; ledger < p.ledgers; ++ledger)
+        {
+            auto const closed = clock_type::now();
+            auto const n = p.ledgerObjects / 2 + gen() % (p.ledgerObjects + 1);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto object = workload.object(written);
+                auto const before = clock_type::now();
+                backend->store(object);
+                writes.push_back(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        clock_type::now() - before)
+                        .count());
+                ++written;
+            }
+            objects += n;
+            bursts.push_back(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    clock_type::now() - closed)
+                    .count());
+            std::this_thread::sleep_until(closed + p.closeInterval);
+        }
+        backend->sync();
+        auto const elapsed = clock_type::now() - start;
+
+        done = true;
+        for (auto& t : readers)
+            t.join();
+
+        std::vector<std::int64_t> reads;
+        std::size_t hits = 0;
+        for (std::size_t id = 0; id < p.readers; ++id)
+        {
+            reads.insert(
+                reads.end(), latencies[id].begin(), latencies[id].end());
+            hits += found[id];
+        }
+
+        log << "  writes: " << objects << " objects at " << std::fixed
+            << std::setprecision(0) << rate(objects, elapsed) << "/s, "
+            << percentiles(writes) << std::endl;
+        log << "  ledger bursts: " << percentiles(bursts) << std::endl;
+        log << "  reads: " << reads.size() << " at "
+            << rate(reads.size(), elapsed) << "/s, " << hits << " found, "
+            << percentiles(reads) << std::endl;
+
+        backend->close();
+    }
+
+    void
+    run() override
+    {
+        testcase("NodeStoreBench", beast::unit_test::abort_on_fail);
+
+        /*  Parameters, given in each backend configuration:
+
+            history         Objects written before measuring
+            ledgers         Ledgers closed while measuring
+            ledger_objects  Average objects written per ledger
+            close_ms        Milliseconds between ledger closes
+            readers         Threads reading while ledgers close
+            missing_percent Percent of reads for missing objects
+            recent_percent  Percent of reads for recently written objects
+            profile_type    Backend type of a database to sample shapes from
+            profile_path    Path of a database to sample shapes from
+
+            Configurations are separated by semicolons, for example
+            --unittest-arg="type=nudb;type=rocksdb,cache_mb=256"
+        */
+        std::string default_args =
+            "type=nudb"
+#if RIPPLE_ROCKSDB_AVAILABLE
+            ";type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256,"
+            "file_size_mb=8,file_size_mult=2"
+#endif
+            ";type=memory";
+
+        auto args = arg().empty() ? default_args : arg();
+        std::vector<std::string> config_strings;
+        boost::split(config_strings, args, boost::algorithm::is_any_of(";"));
+
+        for (auto const& config_string : config_strings)
+        {
+            if (config_string.empty())
+                continue;
+
+            Section config = parse(config_string);
+
+            Workload workload;
+            if (config.exists("profile_path"))
+            {
+                Section section;
+                section.set("type", get<std::string>(config, "profile_type"));
+                section.set("path", get<std::string>(config, "profile_path"));
+                DummyScheduler scheduler;
+                test::SuiteJournal journal("NodeStoreBench", *this);
+                auto source = Manager::instance().make_Backend(
+                    section, megabytes(4), scheduler, journal);
+                source->open(false);
+                workload = Workload(*source, 100000);
+                source->close();
+                log << "Sampled " << workload.shapes() << " object shapes"
+                    << std::endl;
+            }
+
+            beast::temp_dir tempDir;
+            config.set("path", tempDir.path());
+            bench(config, workload);
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(NodeStoreBench, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/nodestore/impl/ConcurrencyWindow.h>
+
+namespace ripple {
+namespace NodeStore {
+
+class ConcurrencyWindow_test : public beast::unit_test::suite
+{
+    using clock_type = ConcurrencyWindow::clock_type;
+
+    static constexpr std::chrono::microseconds target{50000};
+
+public:
+    void
+    testGrowth()
+    {
+        testcase("growth");
+
+        ConcurrencyWindow window(4, 6, target);
+        BEAST_EXPECT(window.limit() == 4);
+
+        // A full window of fast writes raises the limit by one
+        for (int i = 0; i < 3; ++i)
+            window.onComplete(true, target);
+        BEAST_EXPECT(window.limit() == 4);
+        window.onComplete(true, target);
+        BEAST_EXPECT(window.limit() == 5);
+
+        // The limit never passes the ceiling
+        for (int i = 0; i < 100; ++i)
+            window.onComplete(true, target / 2);
+        BEAST_EXPECT(window.limit() == 6);
+
+        // The starting limit is kept within [1, ceiling]
+        BEAST_EXPECT(ConcurrencyWindow(100, 6, target).limit() == 6);
+        BEAST_EXPECT(ConcurrencyWindow(0, 6, target).limit() == 1);
+    }
+
+    void
+    testDecrease()
+    {
+        testcase("decrease");
+
+        auto const start = clock_type::now();
+        ConcurrencyWindow window(64, 4096, target);
+
+        // A failed write, such as a timeout or an overloaded server,
+        // halves the limit
+        window.onComplete(false, target / 2, start);
+        BEAST_EXPECT(window.limit() == 32);
+
+        // Failures within one target latency of it count once
+        window.onComplete(false, target, start + target / 2);
+        BEAST_EXPECT(window.limit() == 32);
+
+        // A slow write halves the limit too
+        window.onComplete(true, 2 * target, start + target);
+        BEAST_EXPECT(window.limit() == 16);
+
+        // The limit stays at least one
+        for (int i = 2; i < 10; ++i)
+            window.onComplete(false, target, start + i * target);
+        BEAST_EXPECT(window.limit() == 1);
+    }
+
+    void
+    run() override
+    {
+        testGrowth();
+        testDecrease();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ConcurrencyWindow, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
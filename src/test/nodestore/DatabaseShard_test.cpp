@@ -25,6 +25,7 @@
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/Shard.h>
+#include <ripple/protocol/digest.h>
 #include <chrono>
 #include <numeric>
 #include <test/jtx.h>
@@ -1320,6 +1321,39 @@ class DatabaseShard_test : public TestBase
             data.ledgers_[index]->info().hash, ledgerSeq));
     }
 
+    void
+    testFetchByHash(std::uint64_t const seedValue)
+    {
+        testcase("Fetch by hash");
+
+        using namespace test::jtx;
+
+        beast::temp_dir shardDir;
+        Env env{*this, testConfig(shardDir.path())};
+        DatabaseShard* db = env.app().getShardStore();
+        BEAST_EXPECT(db);
+
+        TestData data(seedValue, 4, 2);
+        if (!BEAST_EXPECT(data.makeLedgers(env)))
+            return;
+
+        for (std::uint32_t i = 0; i < 2; ++i)
+            if (!createShard(data, *db, 2))
+                return;
+
+        // Final shards are found through their filters without a ledger
+        // sequence
+        for (std::uint32_t i = 0; i < 2 * ledgersPerShard; ++i)
+        {
+            auto const& info{data.ledgers_[i]->info()};
+            BEAST_EXPECT(db->fetchNodeObject(info.hash, 0));
+            BEAST_EXPECT(db->fetchNodeObject(info.accountHash, 0));
+        }
+
+        for (std::uint32_t i = 0; i < 100; ++i)
+            BEAST_EXPECT(!db->fetchNodeObject(sha512Half(i, seedValue), 0));
+    }
+
 public:
     DatabaseShard_test() : journal_("DatabaseShard_test", *this)
     {
@@ -1342,6 +1376,7 @@ public:
         testImportWithHistoricalPaths(seedValue + 80);
         testPrepareWithHistoricalPaths(seedValue + 90);
         testOpenShardManagement(seedValue + 100);
+        testFetchByHash(seedValue + 110);
     }
 };
 
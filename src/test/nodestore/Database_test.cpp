@@ -21,6 +21,7 @@
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/protocol/jss.h>
 #include <test/jtx.h>
 #include <test/jtx/CheckMessageLogs.h>
 #include <test/jtx/envconfig.h>
@@ -520,6 +521,170 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void
+    testTiered(std::string const& type, std::int64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+        RootStoppable parent("TestRootStoppable");
+
+        testcase("tiered '" + type + "'");
+
+        beast::temp_dir hot_db;
+        beast::temp_dir cold_db;
+        Section nodeParams;
+        nodeParams.set("type", type);
+        nodeParams.set("path", hot_db.path());
+        nodeParams.set("cold_path", cold_db.path());
+
+        auto batch = createPredictableBatch(numObjectsToTest, seedValue);
+
+        auto counts = [](Database& db, Json::StaticString const& key) {
+            Json::Value obj(Json::objectValue);
+            db.getCountsJson(obj);
+            return std::stoull(obj[key].asString());
+        };
+
+        auto open = [&] {
+            return Manager::instance().make_Database(
+                "test",
+                megabytes(4),
+                scheduler,
+                2,
+                parent,
+                nodeParams,
+                journal_);
+        };
+
+        {
+            // New objects are served from the hot tier
+            auto db = open();
+            storeBatch(*db, batch);
+            Batch copy;
+            fetchCopyOfBatch(*db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(counts(*db, jss::node_hot_hits) == batch.size());
+            BEAST_EXPECT(counts(*db, jss::node_cold_reads) == 0);
+        }
+
+        {
+            // The last generation stays readable after a restart
+            auto db = open();
+            Batch copy;
+            fetchCopyOfBatch(*db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(counts(*db, jss::node_hot_hits) == batch.size());
+        }
+
+        {
+            // Once its generation is dropped, objects come from the cold tier
+            auto db = open();
+            Batch copy;
+            fetchCopyOfBatch(*db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(counts(*db, jss::node_hot_hits) == 0);
+            BEAST_EXPECT(counts(*db, jss::node_cold_hits) == batch.size());
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void
+    testCacheWrites(std::int64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+        RootStoppable parent("TestRootStoppable");
+
+        testcase("cache writes");
+
+        auto batch = createPredictableBatch(numObjectsToTest, seedValue);
+
+        auto hitRate = [&](bool cacheWrites) {
+            Section nodeParams;
+            nodeParams.set("type", "memory");
+            nodeParams.set("path", cacheWrites ? "cached" : "uncached");
+            nodeParams.set("cache_size", std::to_string(2 * batch.size()));
+            nodeParams.set("cache_writes", cacheWrites ? "1" : "0");
+
+            auto db = Manager::instance().make_Database(
+                "test",
+                megabytes(4),
+                scheduler,
+                2,
+                parent,
+                nodeParams,
+                journal_);
+            storeBatch(*db, batch);
+            Batch copy;
+            fetchCopyOfBatch(*db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+
+            Json::Value obj(Json::objectValue);
+            db->getCountsJson(obj);
+            return obj[jss::node_cache_hit_rate].asDouble();
+        };
+
+        // Objects just written are read from the cache, not the backend
+        BEAST_EXPECT(hitRate(true) == 100);
+        BEAST_EXPECT(hitRate(false) == 0);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void
+    testFetchCaller(std::int64_t const seedValue)
+    {
+        // Keeps the fetch reports, and runs tasks like DummyScheduler
+        struct RecordingScheduler : DummyScheduler
+        {
+            std::vector<std::pair<FetchType, FetchCaller>> reports;
+
+            void
+            onFetch(FetchReport const& report) override
+            {
+                reports.emplace_back(report.fetchType, report.caller);
+            }
+        };
+
+        RecordingScheduler scheduler;
+        RootStoppable parent("TestRootStoppable");
+
+        testcase("fetch caller");
+
+        Section nodeParams;
+        nodeParams.set("type", "memory");
+        nodeParams.set("path", "fetchcaller");
+        auto db = Manager::instance().make_Database(
+            "test", megabytes(4), scheduler, 2, parent, nodeParams, journal_);
+
+        auto const batch = createPredictableBatch(1, seedValue);
+        storeBatch(*db, batch);
+        auto const& hash = batch.front()->getHash();
+
+        db->fetchNodeObject(hash);
+        {
+            ScopedFetchCaller const rpc(FetchCaller::rpc);
+            db->fetchNodeObject(hash);
+            {
+                ScopedFetchCaller const sync(FetchCaller::ledgerSync);
+                db->fetchNodeObject(hash, 0, FetchType::async);
+            }
+            db->fetchNodePayload(hash, 0, [](Slice) {});
+        }
+        db->fetchNodeObject(hash);
+
+        using R = std::pair<FetchType, FetchCaller>;
+        BEAST_EXPECT(
+            scheduler.reports ==
+            (std::vector<R>{
+                {FetchType::synchronous, FetchCaller::unknown},
+                {FetchType::synchronous, FetchCaller::rpc},
+                {FetchType::async, FetchCaller::ledgerSync},
+                {FetchType::synchronous, FetchCaller::rpc},
+                {FetchType::synchronous, FetchCaller::unknown}}));
+    }
+
+    //--------------------------------------------------------------------------
+
     void
     testNodeStore(
         std::string const& type,
@@ -596,6 +761,27 @@ public:
             BEAST_EXPECT(areBatchesEqual(batch, copy));
         }
 
+        {
+            // Write the whole batch at once into a new database
+            beast::temp_dir batch_db;
+            Section batchParams(nodeParams);
+            batchParams.set("path", batch_db.path());
+            std::unique_ptr<Database> db = Manager::instance().make_Database(
+                "test",
+                megabytes(4),
+                scheduler,
+                2,
+                parent,
+                batchParams,
+                journal_);
+
+            db->storeBatch(batch, db->earliestLedgerSeq());
+
+            Batch copy;
+            fetchCopyOfBatch(*db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+
         if (type == "memory")
         {
             // Earliest ledger sequence tests
@@ -708,6 +894,12 @@ public:
             testImport("sqlite", "sqlite", seedValue);
 #endif
         }
+
+        testTiered("nudb", seedValue);
+
+        testCacheWrites(seedValue);
+
+        testFetchCaller(seedValue);
     }
 };
 
@@ -197,7 +197,7 @@ public:
         {
             std::shared_ptr<NodeObject> const object(batch[i]);
 
-            Blob data(object->getData());
+            Blob data(object->getData().begin(), object->getData().end());
 
             db.store(
                 object->getType(),
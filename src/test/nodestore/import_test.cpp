@@ -22,16 +22,21 @@
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/beast/rfc2616.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/CodecDictionary.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <boost/beast/core/string.hpp>
 #include <boost/regex.hpp>
 #include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <iomanip>
 #include <map>
 #include <nudb/create.hpp>
 #include <nudb/detail/format.hpp>
 #include <nudb/xxhasher.hpp>
+#include <random>
 #include <sstream>
 
 #include <ripple/unity/rocksdb.h>
@@ -554,5 +559,114 @@ BEAST_DEFINE_TESTSUITE_MANUAL(import, NodeStore, ripple);
 
 //------------------------------------------------------------------------------
 
+class train_dictionary_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        testcase(beast::unit_test::abort_on_fail) << arg();
+
+        pass();
+        auto const args = parse_args(arg());
+        bool usage = args.empty();
+
+        for (auto const key : {"type", "path", "out"})
+        {
+            if (!usage && args.find(key) == args.end())
+            {
+                log << "Missing parameter: " << key;
+                usage = true;
+            }
+        }
+
+        if (usage)
+        {
+            log << "Usage:\n"
+                << "--unittest-arg=type=<type>,path=<path>,out=<out>"
+                   "[,samples=<samples>][,size=<size>]\n"
+                << "type:    Backend type of the database, e.g. NuDB\n"
+                << "path:    Database to sample objects from\n"
+                << "out:     File to write the dictionary to\n"
+                << "samples: Objects to sample (default 100000)\n"
+                << "size:    Dictionary size in bytes (default 65536)\n"
+                << "The database must not be in use.";
+            return;
+        }
+
+        std::size_t const nsamples = args.count("samples")
+            ? std::stoull(args.at("samples"))
+            : 100000;
+        std::size_t const size = args.count("size")
+            ? std::stoull(args.at("size"))
+            : CodecDictionary::maxSize;
+
+        Section section;
+        section.set("type", args.at("type"));
+        section.set("path", args.at("path"));
+        DummyScheduler scheduler;
+        auto backend = Manager::instance().make_Backend(
+            section,
+            megabytes(4),
+            scheduler,
+            beast::Journal{beast::Journal::getNullSink()});
+        backend->open(false);
+
+        // Reservoir sample the objects so the whole database is covered
+        auto const start = std::chrono::steady_clock::now();
+        std::vector<Blob> samples;
+        std::mt19937_64 gen;
+        std::uint64_t nitems = 0;
+        backend->for_each([&](std::shared_ptr<NodeObject> object) {
+            auto const data = object->getData();
+            auto const i = nitems++;
+            if (samples.size() < nsamples)
+                samples.emplace_back(data.begin(), data.end());
+            else if (auto const j = std::uniform_int_distribution<
+                         std::uint64_t>{0, i}(gen);
+                     j < nsamples)
+                samples[j].assign(data.begin(), data.end());
+        });
+        backend->close();
+        log << "Sampled " << samples.size() << " of " << nitems
+            << " objects in "
+            << detail::fmtdur(std::chrono::steady_clock::now() - start);
+
+        auto const dict = std::make_shared<CodecDictionary const>(
+            CodecDictionary::train(samples, size));
+        {
+            std::ofstream os(args.at("out"), std::ios::binary);
+            auto const content = dict->content();
+            os.write(
+                reinterpret_cast<char const*>(content.data()),
+                content.size());
+            if (!os)
+                Throw<std::runtime_error>("unable to write " + args.at("out"));
+        }
+
+        // Report the effect on the sampled objects
+        std::uint64_t raw = 0;
+        std::uint64_t plain = 0;
+        std::uint64_t trained = 0;
+        nudb::detail::buffer buf;
+        for (auto const& sample : samples)
+        {
+            raw += sample.size();
+            plain += nodeobject_compress(sample.data(), sample.size(), buf)
+                         .second;
+            trained += nodeobject_compress(
+                           sample.data(), sample.size(), buf, dict.get())
+                           .second;
+        }
+        log << "Dictionary " << dict->id() << ": " << dict->content().size()
+            << " bytes, samples " << raw << " bytes, " << plain
+            << " compressed, " << trained << " with dictionary";
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(train_dictionary, NodeStore, ripple);
+
+//------------------------------------------------------------------------------
+
 }  // namespace NodeStore
 }  // namespace ripple
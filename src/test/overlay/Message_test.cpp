@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/ProtocolMessage.h>
+#include <boost/beast/core/multi_buffer.hpp>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class Message_test : public beast::unit_test::suite
+{
+    static protocol::TMTransaction
+    makeTransaction(std::size_t size)
+    {
+        protocol::TMTransaction tx;
+        tx.set_rawtransaction(std::string(size, 't'));
+        tx.set_status(protocol::tsNEW);
+        return tx;
+    }
+
+    void
+    testPools()
+    {
+        testcase("Pools");
+
+        // A block given back is handed out again for its size class
+        auto const a = detail::allocateMessageBuffer(300);
+        detail::deallocateMessageBuffer(a, 300);
+        auto const b = detail::allocateMessageBuffer(400);
+        BEAST_EXPECT(a == b);
+
+        auto const c = detail::allocateMessageBuffer(400);
+        BEAST_EXPECT(c != b);
+        BEAST_EXPECT(
+            reinterpret_cast<std::uintptr_t>(c) % alignof(std::max_align_t) ==
+            0);
+        detail::deallocateMessageBuffer(b, 400);
+        detail::deallocateMessageBuffer(c, 400);
+
+        // Large buffers are allocated individually
+        auto const big = detail::allocateMessageBuffer(megabytes(1));
+        BEAST_EXPECT(big != nullptr);
+        detail::deallocateMessageBuffer(big, megabytes(1));
+        detail::deallocateMessageBuffer(nullptr, 0);
+    }
+
+    void
+    testSerialize()
+    {
+        testcase("Serialize");
+
+        using namespace compression;
+
+        for (std::size_t size : {1, 100, 250, 3000, 20000, 200000})
+        {
+            auto const tx = makeTransaction(size);
+            Message m(tx, protocol::mtTRANSACTION);
+
+            auto const& buffer = m.getBuffer(Compressed::Off);
+            BEAST_EXPECT(buffer.size() == Message::totalSize(tx));
+            BEAST_EXPECT(m.getType() == protocol::mtTRANSACTION);
+            BEAST_EXPECT(
+                std::string(buffer.begin() + headerBytes, buffer.end()) ==
+                tx.SerializeAsString());
+
+            // The compressed form parses back to the same message
+            auto const& compressed = m.getBuffer(Compressed::On);
+            boost::beast::multi_buffer buffers;
+            buffers.commit(boost::asio::buffer_copy(
+                buffers.prepare(compressed.size()),
+                boost::asio::buffer(compressed)));
+
+            boost::system::error_code ec;
+            auto const header = ripple::detail::parseMessageHeader(
+                ec, buffers.data(), compressed.size());
+            if (!BEAST_EXPECT(header))
+                continue;
+            BEAST_EXPECT(
+                (header->algorithm != Algorithm::None) ==
+                (&compressed != &buffer));
+            auto const parsed = ripple::detail::parsePayload<
+                protocol::TMTransaction>(
+                *header, ripple::detail::copyPayload(*header, buffers.data()));
+            BEAST_EXPECT(
+                parsed &&
+                parsed->SerializeAsString() == tx.SerializeAsString());
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testPools();
+        testSerialize();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Message, overlay, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,192 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/Handshake.h>
+#include <ripple/overlay/impl/RelayBatch.h>
+#include <ripple/overlay/impl/TrafficCount.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class RelayBatch_test : public beast::unit_test::suite
+{
+    static std::shared_ptr<Message>
+    makeProposal(std::uint32_t seq)
+    {
+        protocol::TMProposeSet prop;
+        prop.set_proposeseq(seq);
+        prop.set_currenttxhash(std::string(32, 'a' + seq % 26));
+        prop.set_nodepubkey(std::string(33, 'b'));
+        prop.set_closetime(seq);
+        prop.set_signature(std::string(72, 'c'));
+        prop.set_previousledger(std::string(32, 'd'));
+        return std::make_shared<Message>(prop, protocol::mtPROPOSE_LEDGER);
+    }
+
+    static std::shared_ptr<Message>
+    makeValidation(std::uint32_t seq)
+    {
+        protocol::TMValidation val;
+        val.set_validation(std::string(200, 'a' + seq % 26));
+        return std::make_shared<Message>(val, protocol::mtVALIDATION);
+    }
+
+    // The serialized protocol message the buffer carries
+    static std::string
+    payload(std::shared_ptr<Message> const& m)
+    {
+        auto const& buffer = m->getBuffer(compression::Compressed::Off);
+        return std::string(
+            buffer.begin() + compression::headerBytes, buffer.end());
+    }
+
+    void
+    testHandshake()
+    {
+        testcase("Handshake");
+
+        auto negotiate = [this](bool outbound, bool inbound) {
+            http_request_type request;
+            request.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesRequestHeader(
+                    true, true, true, true, true, outbound));
+            http_response_type response;
+            response.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesResponseHeader(
+                    request, true, true, true, true, true, inbound));
+
+            // The other features are still negotiated alongside
+            BEAST_EXPECT(featureEnabled(response, FEATURE_TX_RECONCILE));
+            return featureEnabled(response, FEATURE_RELAY_BATCH);
+        };
+        BEAST_EXPECT(negotiate(true, true));
+        BEAST_EXPECT(!negotiate(true, false));
+        BEAST_EXPECT(!negotiate(false, true));
+    }
+
+    void
+    testBatch()
+    {
+        testcase("Batch");
+
+        protocol::TMTransaction tx;
+        tx.set_rawtransaction(std::string(100, 't'));
+        tx.set_status(protocol::tsNEW);
+        BEAST_EXPECT(!isRelayBatchable(Message(tx, protocol::mtTRANSACTION)));
+
+        std::vector<std::shared_ptr<Message>> messages;
+        for (std::uint32_t i = 0; i < Tuning::relayBatchMessages; ++i)
+        {
+            messages.push_back(i % 3 ? makeValidation(i) : makeProposal(i));
+            BEAST_EXPECT(isRelayBatchable(*messages.back()));
+        }
+
+        auto const batch = makeRelayBatch(messages);
+        BEAST_EXPECT(batch->getType() == protocol::mtRELAY_BATCH);
+        BEAST_EXPECT(!isRelayBatchable(*batch));
+        BEAST_EXPECT(
+            batch->getCategory() == TrafficCount::category::relay_batch);
+
+        protocol::TMRelayBatch parsed;
+        if (!BEAST_EXPECT(parsed.ParseFromString(payload(batch))))
+            return;
+        BEAST_EXPECT(
+            static_cast<std::size_t>(
+                parsed.proposals_size() + parsed.validations_size()) ==
+            messages.size());
+
+        // Every entry is the original message, in the order queued
+        int proposals = 0;
+        int validations = 0;
+        for (auto const& m : messages)
+        {
+            if (m->getType() == protocol::mtVALIDATION)
+                BEAST_EXPECT(
+                    parsed.validations(validations++) == payload(m));
+            else
+                BEAST_EXPECT(parsed.proposals(proposals++) == payload(m));
+        }
+
+        // Relayed validations repeat much of each other, so the batch
+        // is worth compressing
+        auto const& compressed = batch->getBuffer(compression::Compressed::On);
+        BEAST_EXPECT(compressed.size() < batch->getBufferSize());
+    }
+
+    void
+    testTransactions()
+    {
+        testcase("Transactions");
+
+        BEAST_EXPECT(!isTransactionBatchable(*makeValidation(0)));
+
+        std::vector<protocol::TMTransaction> txs;
+        std::vector<std::shared_ptr<Message>> messages;
+        for (std::uint32_t i = 0; i < Tuning::transactionBatchMessages; ++i)
+        {
+            protocol::TMTransaction tx;
+            tx.set_rawtransaction(std::string(150 + i, 'a' + i % 26));
+            tx.set_status(protocol::tsNEW);
+            tx.set_deferred(i % 2);
+            txs.push_back(tx);
+            messages.push_back(
+                std::make_shared<Message>(tx, protocol::mtTRANSACTION));
+            BEAST_EXPECT(isTransactionBatchable(*messages.back()));
+        }
+
+        auto const batch = makeTransactionBatch(messages);
+        BEAST_EXPECT(batch->getType() == protocol::mtTRANSACTIONS);
+        BEAST_EXPECT(!isTransactionBatchable(*batch));
+        BEAST_EXPECT(
+            batch->getCategory() == TrafficCount::category::transaction);
+
+        protocol::TMTransactions parsed;
+        if (!BEAST_EXPECT(parsed.ParseFromString(payload(batch))) ||
+            !BEAST_EXPECT(
+                static_cast<std::size_t>(parsed.transactions_size()) ==
+                txs.size()))
+            return;
+        for (std::size_t i = 0; i < txs.size(); ++i)
+        {
+            auto const& tx = parsed.transactions(i);
+            BEAST_EXPECT(tx.rawtransaction() == txs[i].rawtransaction());
+            BEAST_EXPECT(tx.deferred() == txs[i].deferred());
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testHandshake();
+        testBatch();
+        testTransactions();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RelayBatch, overlay, ripple);
+
+}  // namespace test
+}  // namespace ripple
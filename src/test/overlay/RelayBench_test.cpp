@@ -0,0 +1,300 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/Peer.h>
+#include <ripple/overlay/ReduceRelayCommon.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/digest.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <ripple.pb.h>
+
+namespace ripple {
+namespace test {
+
+/** Measures how fast a node takes in, deduplicates and relays traffic.
+
+    Simulated peers deliver rounds of transactions, proposals and
+    validations, each message arriving from several of them. Every arrival
+    is checked against the HashRouter the way PeerImp does, and the first
+    copy is serialized once and queued to the peers that have not sent it,
+    the way OverlayImpl::relay does. Peers drain a fixed number of queued
+    messages between batches of arrivals.
+
+    Reports arrivals per second, CPU time per arrival, the HashRouter hit
+    rate and send queue depths for a range of peer counts. Pass the peer
+    counts to try as the suite argument, for example "--unittest-arg=50,500".
+*/
+class RelayBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    // A message to relay, built before timing starts
+    struct Item
+    {
+        uint256 uid;
+        std::unique_ptr<::google::protobuf::Message> message;
+        int type;
+        boost::optional<PublicKey> validator;
+    };
+
+    struct Arrival
+    {
+        std::size_t item;
+        Peer::id_t from;
+    };
+
+    struct SimPeer
+    {
+        explicit SimPeer(Peer::id_t id_) : id(id_)
+        {
+        }
+
+        Peer::id_t id;
+        std::deque<std::shared_ptr<Message>> queue;
+        std::size_t maxDepth = 0;
+    };
+
+    // Size of the simulated network traffic
+    static constexpr std::size_t rounds = 20;
+    static constexpr std::size_t txPerRound = 1000;
+    static constexpr std::size_t validators = 35;
+    static constexpr std::size_t proposalsPerValidator = 2;
+    // Number of peers each message arrives from
+    static constexpr std::size_t copies = 6;
+    // Arrivals between drains, and messages each peer sends per drain
+    static constexpr std::size_t arrivalsPerTick = 1000;
+    static constexpr std::size_t drainPerTick = 200;
+
+    std::mt19937 gen_{42};
+
+    std::string
+    randomBytes(std::size_t size)
+    {
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::string s(size, '\0');
+        for (auto& c : s)
+            c = static_cast<char>(byte(gen_));
+        return s;
+    }
+
+    std::vector<Item>
+    makeRound(std::vector<PublicKey> const& keys, std::uint32_t seq)
+    {
+        std::vector<Item> items;
+        std::uniform_int_distribution<std::size_t> txSize(150, 400);
+
+        for (std::size_t i = 0; i < txPerRound; ++i)
+        {
+            auto tx = std::make_unique<protocol::TMTransaction>();
+            tx->set_rawtransaction(randomBytes(txSize(gen_)));
+            tx->set_status(protocol::tsNEW);
+            auto const uid = sha512Half(makeSlice(tx->rawtransaction()));
+            items.push_back(
+                {uid, std::move(tx), protocol::mtTRANSACTION, boost::none});
+        }
+
+        for (auto const& key : keys)
+        {
+            for (std::uint32_t p = 0; p < proposalsPerValidator; ++p)
+            {
+                auto prop = std::make_unique<protocol::TMProposeSet>();
+                prop->set_proposeseq(p);
+                prop->set_currenttxhash(randomBytes(32));
+                prop->set_nodepubkey(key.data(), key.size());
+                prop->set_closetime(seq);
+                prop->set_signature(randomBytes(72));
+                prop->set_previousledger(randomBytes(32));
+                auto const uid = sha512Half(
+                    makeSlice(prop->currenttxhash()),
+                    makeSlice(prop->signature()));
+                items.push_back(
+                    {uid, std::move(prop), protocol::mtPROPOSE_LEDGER, key});
+            }
+
+            auto val = std::make_unique<protocol::TMValidation>();
+            val->set_validation(randomBytes(250));
+            auto const uid = sha512Half(makeSlice(val->validation()));
+            items.push_back({uid, std::move(val), protocol::mtVALIDATION, key});
+        }
+
+        return items;
+    }
+
+    void
+    simulate(std::size_t peerCount, std::size_t txRelayPercentage)
+    {
+        using namespace std::chrono;
+
+        std::vector<PublicKey> keys;
+        for (std::size_t i = 0; i < validators; ++i)
+            keys.push_back(randomKeyPair(KeyType::secp256k1).first);
+
+        std::vector<SimPeer> peers;
+        for (std::size_t i = 0; i < peerCount; ++i)
+            peers.emplace_back(static_cast<Peer::id_t>(i + 1));
+
+        HashRouter router(
+            stopwatch(),
+            HashRouter::getDefaultHoldTime(),
+            HashRouter::getDefaultRecoverLimit());
+
+        std::size_t messages = 0;
+        std::size_t arrivals = 0;
+        std::size_t duplicates = 0;
+        std::size_t relayed = 0;
+        std::size_t depthSamples = 0;
+        std::size_t depthTotal = 0;
+        clock::duration elapsed{};
+        std::clock_t cpu = 0;
+
+        std::uniform_int_distribution<std::size_t> anyPeer(0, peerCount - 1);
+        std::vector<SimPeer*> targets;
+        targets.reserve(peerCount);
+
+        auto drain = [&]() {
+            for (auto& p : peers)
+            {
+                auto const n = std::min(drainPerTick, p.queue.size());
+                p.queue.erase(p.queue.begin(), p.queue.begin() + n);
+                depthTotal += p.queue.size();
+            }
+            ++depthSamples;
+        };
+
+        for (std::uint32_t seq = 0; seq < rounds; ++seq)
+        {
+            auto const items = makeRound(keys, seq);
+            messages += items.size();
+
+            std::vector<Arrival> stream;
+            for (std::size_t i = 0; i < items.size(); ++i)
+            {
+                for (std::size_t c = 0; c < std::min(copies, peerCount); ++c)
+                    stream.push_back({i, peers[anyPeer(gen_)].id});
+            }
+            std::shuffle(stream.begin(), stream.end(), gen_);
+
+            auto const start = clock::now();
+            auto const cpuStart = std::clock();
+            for (auto const& a : stream)
+            {
+                auto const& item = items[a.item];
+                if (!router.addSuppressionPeer(item.uid, a.from))
+                {
+                    ++duplicates;
+                }
+                else if (auto const toSkip = router.shouldRelay(item.uid))
+                {
+                    auto const sm = std::make_shared<Message>(
+                        *item.message, item.type, item.validator);
+
+                    targets.clear();
+                    for (auto& p : peers)
+                    {
+                        if (toSkip->find(p.id) == toSkip->end())
+                            targets.push_back(&p);
+                    }
+                    if (item.type == protocol::mtTRANSACTION)
+                        reduce_relay::selectTxRelayPeers(
+                            targets, txRelayPercentage, gen_);
+
+                    for (auto p : targets)
+                    {
+                        p->queue.push_back(sm);
+                        p->maxDepth = std::max(p->maxDepth, p->queue.size());
+                    }
+                    relayed += targets.size();
+                }
+
+                if (++arrivals % arrivalsPerTick == 0)
+                    drain();
+            }
+            cpu += std::clock() - cpuStart;
+            elapsed += clock::now() - start;
+        }
+
+        std::size_t maxDepth = 0;
+        for (auto const& p : peers)
+            maxDepth = std::max(maxDepth, p.maxDepth);
+
+        auto const seconds = duration_cast<duration<double>>(elapsed).count();
+        auto const cpuNs = 1e9 * cpu / CLOCKS_PER_SEC / arrivals;
+
+        log << peerCount << " peers, " << txRelayPercentage
+            << "% tx relay: " << messages << " messages, " << arrivals
+            << " arrivals" << std::endl;
+        log << "  " << static_cast<std::size_t>(arrivals / seconds)
+            << " arrivals/s, " << static_cast<std::size_t>(cpuNs)
+            << "ns CPU per arrival" << std::endl;
+        log << "  router hit rate "
+            << (100.0 * duplicates / arrivals) << "%, " << relayed
+            << " copies queued" << std::endl;
+        log << "  queue depth max " << maxDepth << ", mean "
+            << (depthSamples ? depthTotal / (depthSamples * peerCount) : 0)
+            << std::endl;
+
+        // Every message is relayed exactly once
+        BEAST_EXPECT(arrivals - duplicates == messages);
+    }
+
+    std::vector<std::size_t>
+    peerCounts()
+    {
+        std::vector<std::size_t> counts;
+        std::string const a = arg();
+        std::size_t pos = 0;
+        while (pos < a.size())
+        {
+            auto const end = std::min(a.find(',', pos), a.size());
+            if (auto const n = std::stoul(a.substr(pos, end - pos)); n > 0)
+                counts.push_back(n);
+            pos = end + 1;
+        }
+        if (counts.empty())
+            counts = {21, 100, 400};
+        return counts;
+    }
+
+public:
+    void
+    run() override
+    {
+        for (auto const n : peerCounts())
+            simulate(n, 100);
+
+        // Hub nodes with transaction reduce-relay enabled
+        simulate(400, 25);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(RelayBench, overlay, ripple);
+
+}  // namespace test
+}  // namespace ripple
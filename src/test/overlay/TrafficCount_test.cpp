@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/TrafficCount.h>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace test {
+
+class TrafficCount_test : public beast::unit_test::suite
+{
+    using Histogram = TrafficCount::Histogram;
+
+    void
+    testBuckets()
+    {
+        testcase("Histogram buckets");
+
+        Histogram h;
+        h.add(0);
+        h.add(1);
+        h.add(2);
+        h.add(3);
+        h.add(1000);
+        h.add(std::numeric_limits<std::uint64_t>::max());
+
+        auto const counts = h.counts();
+        BEAST_EXPECT(counts[0] == 1);
+        BEAST_EXPECT(counts[1] == 1);
+        BEAST_EXPECT(counts[2] == 2);
+        // 512 <= 1000 < 1024
+        BEAST_EXPECT(counts[10] == 1);
+        BEAST_EXPECT(counts[Histogram::buckets - 1] == 1);
+    }
+
+    void
+    testPercentile()
+    {
+        testcase("Histogram percentile");
+
+        Histogram h;
+        BEAST_EXPECT(Histogram::percentile(h.counts(), 50) == 0);
+
+        for (int i = 0; i < 90; ++i)
+            h.add(100);
+        for (int i = 0; i < 10; ++i)
+            h.add(5000);
+
+        auto const counts = h.counts();
+        BEAST_EXPECT(Histogram::percentile(counts, 0) == 127);
+        BEAST_EXPECT(Histogram::percentile(counts, 50) == 127);
+        BEAST_EXPECT(Histogram::percentile(counts, 89) == 127);
+        BEAST_EXPECT(Histogram::percentile(counts, 90) == 8191);
+        BEAST_EXPECT(Histogram::percentile(counts, 99) == 8191);
+        BEAST_EXPECT(Histogram::percentile(counts, 100) == 8191);
+    }
+
+    void
+    testThreads()
+    {
+        testcase("Histogram threads");
+
+        Histogram h;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+            threads.emplace_back([&h, t] {
+                for (int i = 0; i < 10000; ++i)
+                    h.add(t);
+            });
+        for (auto& t : threads)
+            t.join();
+
+        std::uint64_t total = 0;
+        for (auto const c : h.counts())
+            total += c;
+        BEAST_EXPECT(total == 80000);
+        BEAST_EXPECT(h.counts()[0] == 10000);
+    }
+
+    void
+    testCounts()
+    {
+        testcase("Traffic histograms");
+
+        TrafficCount traffic;
+        traffic.addCount(TrafficCount::category::transaction, true, 300);
+        traffic.addQueueTime(
+            TrafficCount::category::transaction, std::chrono::microseconds{20});
+        traffic.addHandlerTime(
+            TrafficCount::category::proposal, std::chrono::microseconds{70});
+
+        auto const& h = traffic.getHistograms();
+        // 256 <= 300 < 512
+        BEAST_EXPECT(
+            h[TrafficCount::category::transaction].size.counts()[9] == 1);
+        BEAST_EXPECT(
+            h[TrafficCount::category::transaction].queued.counts()[5] == 1);
+        BEAST_EXPECT(
+            h[TrafficCount::category::proposal].handler.counts()[7] == 1);
+        BEAST_EXPECT(traffic.getCounts()[TrafficCount::category::transaction]
+                         .messagesIn == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBuckets();
+        testPercentile();
+        testThreads();
+        testCounts();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TrafficCount, overlay, ripple);
+
+}  // namespace test
+
+}  // namespace ripple
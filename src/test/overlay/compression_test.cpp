@@ -27,6 +27,7 @@
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/impl/Handshake.h>
 #include <ripple/overlay/impl/ProtocolMessage.h>
+#include <ripple/overlay/impl/StreamCompression.h>
 #include <ripple/overlay/impl/ZeroCopyStream.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/PublicKey.h>
@@ -140,6 +141,13 @@ public:
             uncompressed.begin() + ripple::compression::headerBytes,
             uncompressed.end(),
             decompressed.begin()));
+
+        // A payload copied for parsing off the I/O strand parses the same
+        auto const deferred = ripple::detail::parsePayload<T>(
+            *header, ripple::detail::copyPayload(*header, buffers.data()));
+        BEAST_EXPECT(
+            deferred &&
+            deferred->SerializeAsString() == proto1->SerializeAsString());
     }
 
     std::shared_ptr<protocol::TMManifests>
@@ -525,11 +533,83 @@ public:
         handshake(0, 0);
     }
 
+    void
+    testStreamCompression()
+    {
+        testcase("Stream compression");
+
+        auto thresh = beast::severities::Severity::kInfo;
+        auto logs = std::make_unique<Logs>(thresh);
+        auto const tx = buildTransaction(*logs);
+
+        compression::StreamCompressor compressor;
+        compression::StreamDecompressor decompressor;
+        std::vector<std::uint8_t> out;
+        std::size_t streamBytes = 0;
+        std::size_t messageBytes = 0;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            tx->set_receivetimestamp(tx->receivetimestamp() + i);
+            Message m(*tx, protocol::mtTRANSACTION);
+            auto const& buffer = m.getBuffer(Compressed::Off);
+            compressor.compress(makeSlice(buffer), out);
+            streamBytes += out.size();
+            messageBytes += m.getBuffer(Compressed::On).size();
+
+            boost::system::error_code ec;
+            auto const header = ripple::detail::parseMessageHeader(
+                ec, boost::asio::buffer(out), out.size());
+            if (!BEAST_EXPECT(header))
+                return;
+            BEAST_EXPECT(header->algorithm == Algorithm::LZ4Stream);
+            BEAST_EXPECT(header->message_type == protocol::mtTRANSACTION);
+            BEAST_EXPECT(
+                header->uncompressed_size ==
+                buffer.size() - compression::headerBytes);
+
+            auto const payload = decompressor.decompress(
+                out.data() + header->header_size,
+                header->payload_wire_size,
+                header->uncompressed_size);
+            if (!BEAST_EXPECT(payload))
+                return;
+            BEAST_EXPECT(std::equal(
+                buffer.begin() + compression::headerBytes,
+                buffer.end(),
+                payload));
+        }
+
+        // The repeated content compresses across messages
+        BEAST_EXPECT(streamBytes * 2 < messageBytes);
+        BEAST_EXPECT(compressor.bytesIn() == decompressor.bytesOut());
+        BEAST_EXPECT(compressor.bytesOut() == decompressor.bytesIn());
+
+        // Negotiated only if both sides offer it
+        auto negotiate = [](bool outbound, bool inbound) {
+            http_request_type request;
+            request.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesRequestHeader(true, false, false, outbound));
+            http_response_type response;
+            response.insert(
+                "X-Protocol-Ctl",
+                makeFeaturesResponseHeader(
+                    request, true, false, false, inbound));
+            return isFeatureValue(response, FEATURE_COMPR, "lz4") &&
+                isFeatureValue(response, FEATURE_COMPR, "lz4s");
+        };
+        BEAST_EXPECT(negotiate(true, true));
+        BEAST_EXPECT(!negotiate(true, false));
+        BEAST_EXPECT(!negotiate(false, true));
+    }
+
     void
     run() override
     {
         testProtocol();
         testHandshake();
+        testStreamCompression();
     }
 };
 
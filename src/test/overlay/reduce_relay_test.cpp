@@ -29,8 +29,11 @@
 #include <boost/optional.hpp>
 #include <boost/thread.hpp>
 
+#include <deque>
 #include <numeric>
 #include <optional>
+#include <random>
+#include <set>
 
 namespace ripple {
 
@@ -101,6 +104,11 @@ public:
     {
         return 0;
     }
+    std::optional<std::chrono::milliseconds>
+    responseTime() const override
+    {
+        return {};
+    }
     PublicKey const&
     getNodePublic() const override
     {
@@ -1330,6 +1338,38 @@ vp_squelched=1
             c2.loadFromString(toLoad);
             BEAST_EXPECT(c2.VP_REDUCE_RELAY_ENABLE == false);
             BEAST_EXPECT(c2.VP_REDUCE_RELAY_SQUELCH == false);
+            BEAST_EXPECT(c2.TX_REDUCE_RELAY_ENABLE == false);
+            BEAST_EXPECT(c2.TX_RELAY_PERCENTAGE == 25);
+
+            Config c3;
+
+            toLoad = R"rippleConfig(
+[reduce_relay]
+tx_enable=1
+tx_relay_percentage=40
+)rippleConfig";
+
+            c3.loadFromString(toLoad);
+            BEAST_EXPECT(c3.TX_REDUCE_RELAY_ENABLE == true);
+            BEAST_EXPECT(c3.TX_RELAY_PERCENTAGE == 40);
+
+            Config c4;
+
+            toLoad = R"rippleConfig(
+[reduce_relay]
+tx_enable=1
+tx_relay_percentage=5
+)rippleConfig";
+
+            try
+            {
+                c4.loadFromString(toLoad);
+                fail();
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
         });
     }
 
@@ -1473,6 +1513,101 @@ vp_squelched=1
         });
     }
 
+    /** Flood a transaction through a random network, once to every peer
+     * and once to the peers chosen by transaction reduce-relay, and compare
+     * the messages sent and the hops needed to reach every node.
+     */
+    void
+    testTxReduceRelay(bool log)
+    {
+        doTest("Transaction reduce-relay", log, [&](bool log) {
+            std::size_t const numNodes = 200;
+            std::size_t const degree = 30;
+            std::mt19937 g(42);
+
+            // Random graph where every node has at least degree links
+            std::vector<std::set<std::size_t>> links(numNodes);
+            for (std::size_t i = 0; i < numNodes; ++i)
+            {
+                std::uniform_int_distribution<std::size_t> d(0, numNodes - 1);
+                while (links[i].size() < degree)
+                {
+                    auto const j = d(g);
+                    if (j != i)
+                    {
+                        links[i].insert(j);
+                        links[j].insert(i);
+                    }
+                }
+            }
+
+            struct Result
+            {
+                std::size_t messages = 0;
+                std::size_t reached = 0;
+                std::size_t maxHops = 0;
+                double meanHops = 0;
+            };
+
+            auto propagate = [&](bool reduce) {
+                Result res;
+                std::vector<int> hops(numNodes, -1);
+                // Relay: node, the peer it received the transaction from
+                std::deque<std::pair<std::size_t, std::size_t>> queue;
+                hops[0] = 0;
+                queue.emplace_back(0, 0);
+                while (!queue.empty())
+                {
+                    auto const [node, from] = queue.front();
+                    queue.pop_front();
+                    std::vector<std::size_t> peers;
+                    for (auto const p : links[node])
+                        if (p != from || node == 0)
+                            peers.push_back(p);
+                    // The source of a transaction always floods it
+                    if (reduce && node != 0)
+                        reduce_relay::selectTxRelayPeers(peers, 25, g);
+                    for (auto const p : peers)
+                    {
+                        ++res.messages;
+                        if (hops[p] == -1)
+                        {
+                            hops[p] = hops[node] + 1;
+                            queue.emplace_back(p, node);
+                        }
+                    }
+                }
+                for (auto const h : hops)
+                {
+                    if (h < 0)
+                        continue;
+                    ++res.reached;
+                    res.maxHops = std::max<std::size_t>(res.maxHops, h);
+                    res.meanHops += h;
+                }
+                res.meanHops /= res.reached;
+                return res;
+            };
+
+            auto const full = propagate(false);
+            auto const reduced = propagate(true);
+
+            BEAST_EXPECT(full.reached == numNodes);
+            BEAST_EXPECT(reduced.reached == numNodes);
+            BEAST_EXPECT(reduced.messages < full.messages / 2);
+            BEAST_EXPECT(reduced.maxHops <= full.maxHops + 2);
+
+            if (log)
+                std::cout << "flooding: " << full.messages << " messages, "
+                          << full.meanHops << " mean hops, " << full.maxHops
+                          << " max hops" << std::endl
+                          << "reduce-relay: " << reduced.messages
+                          << " messages, " << reduced.meanHops
+                          << " mean hops, " << reduced.maxHops << " max hops"
+                          << std::endl;
+        });
+    }
+
     void
     testHandshake(bool log)
     {
@@ -1559,6 +1694,7 @@ public:
         testSelectedPeerStopsRelaying(log);
         testInternalHashRouter(log);
         testRandomSquelch(log);
+        testTxReduceRelay(log);
         testHandshake(log);
     }
 };
@@ -21,6 +21,7 @@
 #include <ripple/basics/safe_cast.h>
 #include <ripple/beast/clock/manual_clock.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/peerfinder/impl/Handouts.h>
 #include <ripple/peerfinder/impl/Livecache.h>
 #include <boost/algorithm/string.hpp>
 #include <test/beast/IPEndpointCommon.h>
@@ -226,6 +227,60 @@ public:
         BEAST_EXPECT(!all_match);
     }
 
+    void
+    testSample()
+    {
+        testcase("Sample");
+        using namespace std::chrono_literals;
+        Livecache<> c(clock_, journal_);
+        for (auto i = 0; i < 100; ++i)
+            add(beast::IP::randomEP(true),
+                c,
+                ripple::rand_int(0, safe_cast<int>(Tuning::maxHops + 1)));
+
+        EndpointSample sample;
+        BEAST_EXPECT(sample.empty());
+        sample.refresh(c.hops);
+        BEAST_EXPECT(sample.size() == c.size());
+
+        auto cmp_EP = [](Endpoint const& a, Endpoint const& b) {
+            return (
+                b.hops < a.hops || (b.hops == a.hops && b.address < a.address));
+        };
+
+        // each hop holds the same endpoints as the cache
+        auto hop = sample.begin();
+        for (auto i = c.hops.begin(); i != c.hops.end(); ++i, ++hop)
+        {
+            std::vector<Endpoint> expected((*i).begin(), (*i).end());
+            std::vector<Endpoint> actual(hop->begin(), hop->end());
+            std::sort(expected.begin(), expected.end(), cmp_EP);
+            std::sort(actual.begin(), actual.end(), cmp_EP);
+            BEAST_EXPECT(expected == actual);
+        }
+        BEAST_EXPECT(hop == sample.end());
+
+        // handing out an endpoint rotates it to the back of its hop
+        for (auto& h : sample)
+        {
+            if (h.size() < 2)
+                continue;
+            Endpoint const front = *h.begin();
+            h.move_back(h.begin());
+            BEAST_EXPECT(h.begin()->address != front.address);
+            BEAST_EXPECT(std::prev(h.end())->address == front.address);
+        }
+
+        // the sample is a copy, changes to the cache don't show
+        auto const count = sample.size();
+        clock_.advance(Tuning::liveCacheSecondsToLive + 1s);
+        c.expire();
+        BEAST_EXPECT(c.empty());
+        BEAST_EXPECT(sample.size() == count);
+        sample.refresh(c.hops);
+        BEAST_EXPECT(sample.empty());
+    }
+
     void
     run() override
     {
@@ -234,6 +289,7 @@ public:
         testExpire();
         testHistogram();
         testShuffle();
+        testSample();
     }
 };
 
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/impl/ParsedKeyCache.h>
+#include <chrono>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Measures what the parsed key cache saves on secp256k1 verification.
+
+    Times parsing a compressed key with and without the cache, and whole
+    signature verifications, over a small set of keys used repeatedly the
+    way validator and busy account keys are.
+*/
+class ParsedKeyBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t keyCount = 64;
+    static constexpr std::size_t reps = 200000;
+
+    template <class F>
+    double
+    nsPerCall(std::size_t calls, F&& f)
+    {
+        using namespace std::chrono;
+        auto const start = clock::now();
+        f();
+        return duration_cast<duration<double, std::nano>>(
+                   clock::now() - start)
+                   .count() /
+            calls;
+    }
+
+public:
+    void
+    run() override
+    {
+        std::vector<PublicKey> keys;
+        std::vector<SecretKey> secrets;
+        for (std::size_t i = 0; i < keyCount; ++i)
+        {
+            secrets.push_back(randomSecretKey());
+            keys.push_back(derivePublicKey(KeyType::secp256k1, secrets.back()));
+        }
+
+        std::size_t good = 0;
+        auto const direct = nsPerCall(reps, [&] {
+            secp256k1_pubkey parsed;
+            for (std::size_t i = 0; i < reps; ++i)
+            {
+                auto const& key = keys[i % keyCount];
+                good += secp256k1_ec_pubkey_parse(
+                    secp256k1Context(), &parsed, key.data(), key.size());
+            }
+        });
+
+        ParsedKeyCache cache;
+        auto const cached = nsPerCall(reps, [&] {
+            secp256k1_pubkey parsed;
+            for (std::size_t i = 0; i < reps; ++i)
+                good += cache.parse(keys[i % keyCount].slice(), parsed);
+        });
+        BEAST_EXPECT(good == 2 * reps);
+
+        std::vector<uint256> digests;
+        std::vector<Buffer> sigs;
+        for (std::size_t i = 0; i < keyCount; ++i)
+        {
+            digests.push_back(sha512Half(std::uint32_t(i)));
+            sigs.push_back(signDigest(keys[i], secrets[i], digests.back()));
+        }
+
+        std::size_t const verifies = reps / 20;
+        std::size_t verified = 0;
+        auto const verify = nsPerCall(verifies, [&] {
+            for (std::size_t i = 0; i < verifies; ++i)
+            {
+                auto const k = i % keyCount;
+                verified += verifyDigest(keys[k], digests[k], sigs[k], true);
+            }
+        });
+        BEAST_EXPECT(verified == verifies);
+
+        log << keyCount << " keys: parse " << static_cast<std::size_t>(direct)
+            << "ns, cached parse " << static_cast<std::size_t>(cached)
+            << "ns, verify " << static_cast<std::size_t>(verify) << "ns"
+            << std::endl;
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ParsedKeyBench, protocol, ripple);
+
+}  // namespace test
+}  // namespace ripple
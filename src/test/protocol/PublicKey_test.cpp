@@ -20,6 +20,9 @@
 #include <ripple/beast/unit_test.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/impl/ParsedKeyCache.h>
+#include <cstring>
 #include <vector>
 
 namespace ripple {
@@ -453,12 +456,81 @@ public:
         BEAST_EXPECT(pk1 == pk3);
     }
 
+    void
+    testParsedKeyCache()
+    {
+        testcase("Parsed key cache");
+
+        auto const pk = derivePublicKey(
+            KeyType::secp256k1,
+            generateSecretKey(
+                KeyType::secp256k1, generateSeed("masterpassphrase")));
+
+        auto parseDirect = [](Slice const& key, secp256k1_pubkey& out) {
+            return secp256k1_ec_pubkey_parse(
+                       secp256k1Context(), &out, key.data(), key.size()) == 1;
+        };
+        auto same = [](secp256k1_pubkey const& a, secp256k1_pubkey const& b) {
+            return std::memcmp(a.data, b.data, sizeof(a.data)) == 0;
+        };
+
+        ParsedKeyCache cache;
+        secp256k1_pubkey expected;
+        BEAST_EXPECT(parseDirect(pk.slice(), expected));
+
+        for (int i = 0; i < 3; ++i)
+        {
+            secp256k1_pubkey parsed;
+            BEAST_EXPECT(cache.parse(pk.slice(), parsed));
+            BEAST_EXPECT(same(parsed, expected));
+        }
+        BEAST_EXPECT(cache.misses() == 1);
+        BEAST_EXPECT(cache.hits() == 2);
+
+        // A key sharing the slot gives the same answer as parsing it
+        // directly, and leaves the first key correct
+        auto other = Blob(pk.data(), pk.data() + pk.size());
+        other.back() ^= 0x01;
+        for (int i = 0; i < 2; ++i)
+        {
+            secp256k1_pubkey direct;
+            secp256k1_pubkey parsed;
+            auto const valid = parseDirect(makeSlice(other), direct);
+            BEAST_EXPECT(cache.parse(makeSlice(other), parsed) == valid);
+            if (valid)
+                BEAST_EXPECT(same(parsed, direct));
+
+            BEAST_EXPECT(cache.parse(pk.slice(), parsed));
+            BEAST_EXPECT(same(parsed, expected));
+        }
+
+        // Keys that do not parse are rejected every time
+        Blob invalid(33, 0xFF);
+        invalid[0] = 0x02;
+        for (int i = 0; i < 2; ++i)
+        {
+            secp256k1_pubkey parsed;
+            BEAST_EXPECT(!cache.parse(makeSlice(invalid), parsed));
+        }
+
+        // Verification goes through the cache
+        auto const sk = generateSecretKey(
+            KeyType::secp256k1, generateSeed("masterpassphrase"));
+        auto const digest = sha512Half(std::string("cache"));
+        auto const sig = signDigest(pk, sk, digest);
+        BEAST_EXPECT(verifyDigest(pk, digest, sig, true));
+        BEAST_EXPECT(verifyDigest(pk, digest, sig, true));
+        BEAST_EXPECT(!verifyDigest(
+            pk, sha512Half(std::string("other")), sig, true));
+    }
+
     void
     run() override
     {
         testBase58();
         testCanonical();
         testMiscOperations();
+        testParsedKeyCache();
     }
 };
 
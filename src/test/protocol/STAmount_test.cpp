@@ -21,9 +21,289 @@
 #include <ripple/basics/random.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/protocol/STAmount.h>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <chrono>
 
 namespace ripple {
 
+// The arithmetic as it was before the 128-bit fast paths, kept to check
+// the fast paths against.
+namespace reference {
+
+static std::uint64_t const tenTo14 = 100000000000000ull;
+static std::uint64_t const tenTo14m1 = tenTo14 - 1;
+static std::uint64_t const tenTo17 = tenTo14 * 1000;
+
+static std::uint64_t
+muldiv_round(
+    std::uint64_t multiplier,
+    std::uint64_t multiplicand,
+    std::uint64_t divisor,
+    std::uint64_t rounding)
+{
+    boost::multiprecision::uint128_t ret;
+
+    boost::multiprecision::multiply(ret, multiplier, multiplicand);
+    ret += rounding;
+    ret /= divisor;
+
+    if (ret > std::numeric_limits<std::uint64_t>::max())
+        Throw<std::overflow_error>("overflow");
+
+    return static_cast<uint64_t>(ret);
+}
+
+static void
+bringIntoRange(std::uint64_t& value, int& offset)
+{
+    while (value < STAmount::cMinValue)
+    {
+        value *= 10;
+        --offset;
+    }
+}
+
+static std::int64_t
+getSNValue(STAmount const& amount)
+{
+    auto const ret = static_cast<std::int64_t>(amount.mantissa());
+    return amount.negative() ? -ret : ret;
+}
+
+static STAmount
+nativeProduct(STAmount const& v1, STAmount const& v2)
+{
+    std::uint64_t const minV =
+        getSNValue(v1) < getSNValue(v2) ? getSNValue(v1) : getSNValue(v2);
+    std::uint64_t const maxV =
+        getSNValue(v1) < getSNValue(v2) ? getSNValue(v2) : getSNValue(v1);
+
+    if (minV > 3000000000ull)  // sqrt(cMaxNative)
+        Throw<std::runtime_error>("Native value overflow");
+
+    if (((maxV >> 32) * minV) > 2095475792ull)  // cMaxNative / 2^32
+        Throw<std::runtime_error>("Native value overflow");
+
+    return STAmount(v1.getFName(), minV * maxV);
+}
+
+static STAmount
+divide(STAmount const& num, STAmount const& den, Issue const& issue)
+{
+    if (den == beast::zero)
+        Throw<std::runtime_error>("division by zero");
+
+    if (num == beast::zero)
+        return {issue};
+
+    std::uint64_t numVal = num.mantissa();
+    std::uint64_t denVal = den.mantissa();
+    int numOffset = num.exponent();
+    int denOffset = den.exponent();
+
+    if (num.native())
+        bringIntoRange(numVal, numOffset);
+
+    if (den.native())
+        bringIntoRange(denVal, denOffset);
+
+    return STAmount(
+        issue,
+        muldiv_round(numVal, tenTo17, denVal, 0) + 5,
+        numOffset - denOffset - 17,
+        num.negative() != den.negative());
+}
+
+static STAmount
+multiply(STAmount const& v1, STAmount const& v2, Issue const& issue)
+{
+    if (v1 == beast::zero || v2 == beast::zero)
+        return STAmount(issue);
+
+    if (v1.native() && v2.native() && isXRP(issue))
+        return nativeProduct(v1, v2);
+
+    std::uint64_t value1 = v1.mantissa();
+    std::uint64_t value2 = v2.mantissa();
+    int offset1 = v1.exponent();
+    int offset2 = v2.exponent();
+
+    if (v1.native())
+        bringIntoRange(value1, offset1);
+
+    if (v2.native())
+        bringIntoRange(value2, offset2);
+
+    return STAmount(
+        issue,
+        muldiv_round(value1, value2, tenTo14, 0) + 7,
+        offset1 + offset2 + 14,
+        v1.negative() != v2.negative());
+}
+
+static void
+canonicalizeRound(bool native, std::uint64_t& value, int& offset)
+{
+    if (native)
+    {
+        if (offset < 0)
+        {
+            int loops = 0;
+
+            while (offset < -1)
+            {
+                value /= 10;
+                ++offset;
+                ++loops;
+            }
+
+            value += (loops >= 2) ? 9 : 10;  // add before last divide
+            value /= 10;
+            ++offset;
+        }
+    }
+    else if (value > STAmount::cMaxValue)
+    {
+        while (value > (10 * STAmount::cMaxValue))
+        {
+            value /= 10;
+            ++offset;
+        }
+
+        value += 9;  // add before last divide
+        value /= 10;
+        ++offset;
+    }
+}
+
+static STAmount
+smallestAbove(Issue const& issue, bool xrp)
+{
+    if (xrp)
+        return STAmount(issue, std::uint64_t(1), 0, false);
+    return STAmount(issue, STAmount::cMinValue, STAmount::cMinOffset, false);
+}
+
+static STAmount
+mulRound(
+    STAmount const& v1,
+    STAmount const& v2,
+    Issue const& issue,
+    bool roundUp)
+{
+    if (v1 == beast::zero || v2 == beast::zero)
+        return {issue};
+
+    bool const xrp = isXRP(issue);
+
+    if (v1.native() && v2.native() && xrp)
+        return nativeProduct(v1, v2);
+
+    std::uint64_t value1 = v1.mantissa(), value2 = v2.mantissa();
+    int offset1 = v1.exponent(), offset2 = v2.exponent();
+
+    if (v1.native())
+        bringIntoRange(value1, offset1);
+
+    if (v2.native())
+        bringIntoRange(value2, offset2);
+
+    bool const resultNegative = v1.negative() != v2.negative();
+
+    std::uint64_t amount = muldiv_round(
+        value1, value2, tenTo14, (resultNegative != roundUp) ? tenTo14m1 : 0);
+
+    int offset = offset1 + offset2 + 14;
+    if (resultNegative != roundUp)
+        canonicalizeRound(xrp, amount, offset);
+    STAmount result(issue, amount, offset, resultNegative);
+
+    if (roundUp && !resultNegative && !result)
+        return smallestAbove(issue, xrp);
+    return result;
+}
+
+static STAmount
+divRound(
+    STAmount const& num,
+    STAmount const& den,
+    Issue const& issue,
+    bool roundUp)
+{
+    if (den == beast::zero)
+        Throw<std::runtime_error>("division by zero");
+
+    if (num == beast::zero)
+        return {issue};
+
+    std::uint64_t numVal = num.mantissa(), denVal = den.mantissa();
+    int numOffset = num.exponent(), denOffset = den.exponent();
+
+    if (num.native())
+        bringIntoRange(numVal, numOffset);
+
+    if (den.native())
+        bringIntoRange(denVal, denOffset);
+
+    bool const resultNegative = (num.negative() != den.negative());
+
+    std::uint64_t amount = muldiv_round(
+        numVal, tenTo17, denVal, (resultNegative != roundUp) ? denVal - 1 : 0);
+
+    int offset = numOffset - denOffset - 17;
+
+    if (resultNegative != roundUp)
+        canonicalizeRound(isXRP(issue), amount, offset);
+
+    STAmount result(issue, amount, offset, resultNegative);
+    if (roundUp && !resultNegative && !result)
+        return smallestAbove(issue, isXRP(issue));
+    return result;
+}
+
+}  // namespace reference
+
+// Random amounts covering native and issued values of every magnitude
+class RandomAmounts
+{
+    beast::xor_shift_engine engine_;
+    Issue const usd_{Currency(0x5553440000000000), AccountID(0x4985601)};
+    int const maxExponent_;
+
+public:
+    // Issued amounts have exponents no further than `maxExponent` from 0
+    RandomAmounts(std::uint64_t seed, int maxExponent)
+        : engine_(seed), maxExponent_(maxExponent)
+    {
+    }
+
+    Issue
+    issue()
+    {
+        return rand_bool(engine_) ? xrpIssue() : usd_;
+    }
+
+    STAmount
+    operator()()
+    {
+        bool const negative = rand_int(engine_, 3) == 0;
+        if (rand_bool(engine_))
+        {
+            // Drops with between 1 and 17 digits
+            std::uint64_t value = 1;
+            for (int digits = rand_int(engine_, 1, 17); digits > 1; --digits)
+                value *= 10;
+            value += rand_int(engine_, value * 9);
+            return STAmount(value, negative);
+        }
+        return STAmount(
+            usd_,
+            rand_int(engine_, STAmount::cMinValue, STAmount::cMaxValue),
+            rand_int(engine_, -maxExponent_, maxExponent_),
+            negative);
+    }
+};
+
 class STAmount_test : public beast::unit_test::suite
 {
 public:
@@ -671,6 +951,67 @@ public:
         }
     }
 
+    void
+    testDifferential()
+    {
+        testcase("Arithmetic matches the reference implementation");
+
+        // Run an operation both ways, expecting the same amount or that
+        // both throw.
+        auto const same = [this](auto&& fast, auto&& slow) {
+            boost::optional<STAmount> expected;
+            try
+            {
+                expected = slow();
+            }
+            catch (std::exception const&)
+            {
+            }
+
+            try
+            {
+                auto const actual = fast();
+                if (!expected)
+                    return fail("only the reference threw");
+                if (actual != *expected ||
+                    actual.issue() != expected->issue() ||
+                    actual.native() != expected->native())
+                {
+                    log << actual.getFullText() << " not "
+                        << expected->getFullText() << std::endl;
+                    return fail("different result");
+                }
+                pass();
+            }
+            catch (std::exception const&)
+            {
+                BEAST_EXPECT(!expected);
+            }
+        };
+
+        RandomAmounts amount(20211014, 60);
+        for (int i = 0; i < 20000; ++i)
+        {
+            auto const a = amount();
+            auto const b = amount();
+            auto const issue = amount.issue();
+            bool const roundUp = i % 2 == 0;
+
+            same(
+                [&] { return multiply(a, b, issue); },
+                [&] { return reference::multiply(a, b, issue); });
+            same(
+                [&] { return divide(a, b, issue); },
+                [&] { return reference::divide(a, b, issue); });
+            same(
+                [&] { return mulRound(a, b, issue, roundUp); },
+                [&] { return reference::mulRound(a, b, issue, roundUp); });
+            same(
+                [&] { return divRound(a, b, issue, roundUp); },
+                [&] { return reference::divRound(a, b, issue, roundUp); });
+        }
+    }
+
     //--------------------------------------------------------------------------
 
     void
@@ -684,9 +1025,97 @@ public:
         testRounding();
         testConvertXRP();
         testConvertIOU();
+        testDifferential();
     }
 };
 
 BEAST_DEFINE_TESTSUITE(STAmount, ripple_data, ripple);
 
+// Times the arithmetic against the reference implementation
+class STAmountBench_test : public beast::unit_test::suite
+{
+    template <class Op>
+    std::chrono::nanoseconds
+    time(std::vector<std::pair<STAmount, STAmount>> const& inputs, Op&& op)
+    {
+        using clock_type = std::chrono::steady_clock;
+        std::size_t zeros = 0;
+        auto const start = clock_type::now();
+        for (auto const& [a, b] : inputs)
+        {
+            try
+            {
+                if (op(a, b) == beast::zero)
+                    ++zeros;
+            }
+            catch (std::exception const&)
+            {
+            }
+        }
+        auto const elapsed = clock_type::now() - start;
+        // Keep the results alive
+        if (zeros == inputs.size() + 1)
+            log << zeros;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) /
+            inputs.size();
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("Arithmetic throughput");
+
+        // Amounts like those in offers, few of which overflow
+        RandomAmounts amount(1, 10);
+        std::vector<std::pair<STAmount, STAmount>> inputs;
+        inputs.reserve(1000000);
+        while (inputs.size() < inputs.capacity())
+            inputs.emplace_back(amount(), amount());
+        Issue const usd{Currency(0x5553440000000000), AccountID(0x4985601)};
+
+        auto const report = [&](char const* name, auto&& fast, auto&& slow) {
+            // Alternate the runs, so neither gains from going second
+            auto f = time(inputs, fast);
+            auto s = time(inputs, slow);
+            f = std::min(f, time(inputs, fast));
+            s = std::min(s, time(inputs, slow));
+            log << name << ": " << f.count() << "ns, reference "
+                << s.count() << "ns" << std::endl;
+        };
+
+        report(
+            "multiply",
+            [&](auto const& a, auto const& b) { return multiply(a, b, usd); },
+            [&](auto const& a, auto const& b) {
+                return reference::multiply(a, b, usd);
+            });
+        report(
+            "divide",
+            [&](auto const& a, auto const& b) { return divide(a, b, usd); },
+            [&](auto const& a, auto const& b) {
+                return reference::divide(a, b, usd);
+            });
+        report(
+            "mulRound",
+            [&](auto const& a, auto const& b) {
+                return mulRound(a, b, usd, true);
+            },
+            [&](auto const& a, auto const& b) {
+                return reference::mulRound(a, b, usd, true);
+            });
+        report(
+            "divRound",
+            [&](auto const& a, auto const& b) {
+                return divRound(a, b, usd, true);
+            },
+            [&](auto const& a, auto const& b) {
+                return reference::divRound(a, b, usd, true);
+            });
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(STAmountBench, ripple_data, ripple);
+
 }  // namespace ripple
@@ -19,6 +19,8 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/json/Output.h>
+#include <ripple/json/Writer.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/SecretKey.h>
@@ -673,6 +675,58 @@ public:
 }
 }  // namespace ripple
 
+void
+testCopyOnWrite()
+{
+    testcase("copy on write");
+
+    STObject orig(sfGeneric);
+    orig.setFieldU32(sfSequence, 1);
+    orig.setFieldVL(sfMemoData, Blob{1, 2, 3});
+
+    // A copy sees the original's fields and a write to either side
+    // stays on that side.
+    {
+        STObject copy(orig);
+        BEAST_EXPECT(copy == orig);
+        BEAST_EXPECT(copy.getFieldU32(sfSequence) == 1);
+        copy.setFieldU32(sfSequence, 2);
+        BEAST_EXPECT(copy.getFieldU32(sfSequence) == 2);
+        BEAST_EXPECT(orig.getFieldU32(sfSequence) == 1);
+        orig.setFieldU32(sfExpiration, 3);
+        BEAST_EXPECT(!copy.isFieldPresent(sfExpiration));
+        copy.makeFieldAbsent(sfMemoData);
+        BEAST_EXPECT(orig.getFieldVL(sfMemoData).size() == 3);
+        orig.delField(sfExpiration);
+    }
+
+    // A copy made after a reference into the fields was handed out is
+    // not changed by writes through that reference.
+    {
+        auto& field = orig.getField(sfSequence);
+        STObject copy(orig);
+        STObject assigned(sfGeneric);
+        assigned = orig;
+        dynamic_cast<STUInt32&>(field).setValue(4);
+        BEAST_EXPECT(orig.getFieldU32(sfSequence) == 4);
+        BEAST_EXPECT(copy.getFieldU32(sfSequence) == 1);
+        BEAST_EXPECT(assigned.getFieldU32(sfSequence) == 1);
+    }
+
+    // Nested objects are shared and unshared separately.
+    {
+        STObject outer(sfGeneric);
+        outer.setFieldArray(sfMemos, STArray{});
+        outer.peekFieldArray(sfMemos).push_back(orig);
+        STObject copy(outer);
+        outer.peekFieldArray(sfMemos)[0].setFieldU32(sfSequence, 5);
+        BEAST_EXPECT(
+            outer.getFieldArray(sfMemos)[0].getFieldU32(sfSequence) == 5);
+        BEAST_EXPECT(
+            copy.getFieldArray(sfMemos)[0].getFieldU32(sfSequence) == 4);
+    }
+}
+
 void
 testMalformed()
 {
@@ -704,6 +758,59 @@ testMalformed()
     }
 }
 
+void
+testWriteJson()
+{
+    testcase("writeJson");
+
+    auto const check = [this](STBase const& st) {
+        std::string written;
+        {
+            Json::Writer w(Json::stringOutput(written));
+            st.writeJson(w, JsonOptions::none);
+        }
+        BEAST_EXPECT(
+            written == Json::jsonAsString(st.getJson(JsonOptions::none)));
+    };
+
+    STObject memo(sfMemo);
+    memo.setFieldVL(sfMemoType, Blob{1, 2});
+    memo.setFieldVL(sfMemoData, Blob{3, 4, 5});
+    STArray memos(sfMemos);
+    memos.push_back(memo);
+    memos.push_back(memo);
+
+    STAmount const usd{Issue{to_currency("USD"), noAccount()}, 25, -1};
+
+    STObject obj(sfGeneric);
+    obj.setFieldU32(sfSequence, 7);
+    obj.setFieldAmount(sfTakerGets, usd);
+    obj.setFieldAmount(sfTakerPays, STAmount{100});
+    obj.setAccountID(sfAccount, noAccount());
+    obj.setFieldV256(sfIndexes, STVector256{{uint256{1}, uint256{2}}});
+    obj.setFieldArray(sfMemos, memos);
+    check(obj);
+    check(memos);
+    check(STObject(sfGeneric));
+
+    // Derived types add a member of their own
+    STLedgerEntry sle{keylet::offer(noAccount(), 3)};
+    sle.setAccountID(sfAccount, noAccount());
+    sle.setFieldU32(sfSequence, 3);
+    sle.setFieldAmount(sfTakerGets, usd);
+    sle.setFieldAmount(sfTakerPays, STAmount{100});
+    check(sle);
+
+    STTx const tx{ttPAYMENT, [&](auto& obj) {
+                      obj.setAccountID(sfAccount, noAccount());
+                      obj.setAccountID(sfDestination, xrpAccount());
+                      obj.setFieldAmount(sfAmount, usd);
+                      obj.setFieldAmount(sfFee, STAmount{10});
+                      obj.setFieldArray(sfMemos, memos);
+                  }};
+    check(tx);
+}
+
 void
 run() override
 {
@@ -711,11 +818,13 @@ run() override
     test::jtx::Env env(*this);
 
     testFields();
+    testCopyOnWrite();
     testSerialization();
     testParseJSONArray();
     testParseJSONArrayWithInvalidChildrenObjects();
     testParseJSONEdgeCases();
     testMalformed();
+    testWriteJson();
 }
 }
 ;
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/Serializer.h>
+
+namespace ripple {
+
+struct Serializer_test : public beast::unit_test::suite
+{
+    void
+    testBufferReuse()
+    {
+        testcase("buffer reuse");
+
+        void const* first = nullptr;
+        {
+            Serializer s;
+            s.add32(1);
+            first = s.data();
+        }
+        {
+            // The buffer given back is handed out again
+            Serializer s;
+            BEAST_EXPECT(s.size() == 0);
+            s.add32(2);
+            BEAST_EXPECT(s.data() == first);
+            SerialIter sit(s.slice());
+            BEAST_EXPECT(sit.get32() == 2);
+        }
+
+        Blob kept;
+        {
+            // Data moved out is not reused
+            Serializer s;
+            s.add32(3);
+            kept = std::move(s.modData());
+        }
+        {
+            Serializer s;
+            s.add32(4);
+            BEAST_EXPECT(s.data() != kept.data());
+        }
+        BEAST_EXPECT(kept == Blob({0, 0, 0, 3}));
+
+        {
+            // Buffers much larger than asked for are not handed out
+            {
+                Serializer s(4096);
+                s.add32(5);
+            }
+            Serializer s(16);
+            BEAST_EXPECT(s.capacity() < 4096);
+        }
+    }
+
+    void
+    testVLSlice()
+    {
+        testcase("VL slices");
+
+        Serializer s;
+        Blob const data{1, 2, 3, 4, 5};
+        s.addVL(data);
+        s.add8(9);
+
+        SerialIter sit(s.slice());
+        auto const slice = sit.getVLSlice();
+        BEAST_EXPECT(slice.size() == data.size());
+        BEAST_EXPECT(std::equal(slice.begin(), slice.end(), data.begin()));
+        // The slice points into the serialized data
+        BEAST_EXPECT(
+            slice.data() == static_cast<std::uint8_t const*>(s.data()) + 1);
+        BEAST_EXPECT(sit.get8() == 9);
+        BEAST_EXPECT(sit.empty());
+    }
+
+    void
+    run() override
+    {
+        testBufferReuse();
+        testVLSlice();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Serializer, protocol, ripple);
+
+}  // namespace ripple
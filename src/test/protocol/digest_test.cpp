@@ -0,0 +1,224 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Blob.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/protocol/digest.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ripple {
+
+class digest_test : public beast::unit_test::suite
+{
+    // Hash each message with and without batching and compare
+    void
+    check(std::vector<Blob> const& blobs)
+    {
+        std::vector<Slice> messages;
+        for (auto const& blob : blobs)
+            messages.push_back(makeSlice(blob));
+
+        std::vector<uint256> digests(messages.size());
+        sha512HalfBatch(messages.data(), digests.data(), messages.size());
+
+        for (std::size_t i = 0; i < messages.size(); ++i)
+        {
+            sha512_half_hasher h;
+            h(messages[i].data(), messages[i].size());
+            BEAST_EXPECT(
+                digests[i] ==
+                static_cast<sha512_half_hasher::result_type>(h));
+        }
+    }
+
+    void
+    testBoundaries()
+    {
+        testcase("padding boundaries");
+
+        // Lengths either side of the points where the padding spills
+        // into another block, several of each so that they batch up
+        for (std::size_t size :
+             {0, 1, 111, 112, 113, 127, 128, 129, 239, 240, 256, 516})
+        {
+            std::vector<Blob> blobs;
+            for (std::uint8_t i = 0; i < 9; ++i)
+                blobs.emplace_back(size, i);
+            check(blobs);
+        }
+    }
+
+    void
+    testMixed()
+    {
+        testcase("mixed lengths");
+
+        beast::xor_shift_engine rng(42);
+        for (int round = 0; round < 64; ++round)
+        {
+            std::vector<Blob> blobs(rng() % 40);
+            for (auto& blob : blobs)
+            {
+                blob.resize(rng() % 600);
+                for (auto& b : blob)
+                    b = static_cast<std::uint8_t>(rng());
+            }
+            check(blobs);
+        }
+    }
+
+    // The first half of the full SHA-512 digest
+    static uint256
+    reference(Blob const& blob)
+    {
+        openssl_sha512_hasher h;
+        h(blob.data(), blob.size());
+        auto const digest = openssl_sha512_hasher::result_type(h);
+        return uint256::fromVoid(digest.data());
+    }
+
+    template <class Hasher>
+    uint256
+    hashInPieces(Blob const& blob, beast::xor_shift_engine& rng)
+    {
+        Hasher h;
+        std::size_t offset = 0;
+        while (offset < blob.size())
+        {
+            auto const n = std::min<std::size_t>(
+                rng() % 48, blob.size() - offset);
+            h(blob.data() + offset, n);
+            offset += n;
+        }
+        return static_cast<typename Hasher::result_type>(h);
+    }
+
+    void
+    testHalfHasher()
+    {
+        testcase("half hasher");
+
+        // Every length up to a few blocks, written in random pieces so
+        // that some messages move off the single block path part way.
+        beast::xor_shift_engine rng(7);
+        for (std::size_t size = 0; size < 300; ++size)
+        {
+            Blob blob(size);
+            for (auto& b : blob)
+                b = static_cast<std::uint8_t>(rng());
+
+            auto const expected = reference(blob);
+            BEAST_EXPECT(
+                hashInPieces<sha512_half_hasher>(blob, rng) == expected);
+            BEAST_EXPECT(
+                hashInPieces<sha512_half_hasher_s>(blob, rng) == expected);
+        }
+
+        // A known answer: the first half of SHA-512("abc")
+        Blob const abc{'a', 'b', 'c'};
+        BEAST_EXPECT(
+            to_string(sha512Half(makeSlice(abc))) ==
+            "DDAF35A193617ABACC417349AE20413112E6FA4E89A97EA20A9EEEE64B55D39A");
+    }
+
+    void
+    run() override
+    {
+        testBoundaries();
+        testMixed();
+        testHalfHasher();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(digest, protocol, ripple);
+
+class digestBench_test : public beast::unit_test::suite
+{
+    // The average time to hash each message
+    template <class Hash>
+    std::chrono::nanoseconds
+    time(std::vector<Blob> const& messages, Hash&& hash)
+    {
+        using clock_type = std::chrono::steady_clock;
+        std::uint8_t sink = 0;
+        auto const start = clock_type::now();
+        for (int round = 0; round < 50; ++round)
+        {
+            for (auto const& message : messages)
+                sink ^= *hash(message).data();
+        }
+        auto const elapsed = clock_type::now() - start;
+        // Keep the results alive
+        if (sink == 0x100)
+            log << sink;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) /
+            (50 * messages.size());
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("SHA512-Half throughput");
+
+        beast::xor_shift_engine rng(1);
+        for (std::size_t size : {22, 32, 64, 516})
+        {
+            std::vector<Blob> messages(20000);
+            for (auto& message : messages)
+            {
+                message.resize(size);
+                for (auto& b : message)
+                    b = static_cast<std::uint8_t>(rng());
+            }
+
+            // Written as a two byte prefix and the rest, the way keylets
+            // and hash prefixed objects are hashed.
+            auto const fast = [](Blob const& m) {
+                sha512_half_hasher h;
+                h(m.data(), 2);
+                h(m.data() + 2, m.size() - 2);
+                return static_cast<uint256>(h);
+            };
+            auto const slow = [](Blob const& m) {
+                sha512_hasher h;
+                h(m.data(), 2);
+                h(m.data() + 2, m.size() - 2);
+                auto const digest = sha512_hasher::result_type(h);
+                return uint256::fromVoid(digest.data());
+            };
+
+            // Alternate the runs, so neither gains from going second
+            auto f = time(messages, fast);
+            auto s = time(messages, slow);
+            f = std::min(f, time(messages, fast));
+            s = std::min(s, time(messages, slow));
+            log << size << " bytes: " << f.count() << "ns, OpenSSL "
+                << s.count() << "ns" << std::endl;
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(digestBench, protocol, ripple);
+
+}  // namespace ripple
@@ -19,6 +19,8 @@
 
 #include <ripple/beast/unit_test.h>
 #include <ripple/protocol/UintTypes.h>
+#include <ripple/protocol/tokens.h>
+#include <random>
 
 namespace ripple {
 
@@ -30,12 +32,42 @@ struct types_test : public beast::unit_test::suite
         auto const s = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
         if (BEAST_EXPECT(parseBase58<AccountID>(s)))
             BEAST_EXPECT(toBase58(*parseBase58<AccountID>(s)) == s);
+
+        // Leading zero bytes
+        BEAST_EXPECT(toBase58(xrpAccount()) == "rrrrrrrrrrrrrrrrrrrrrhoLvTp");
+        BEAST_EXPECT(toBase58(noAccount()) == "rrrrrrrrrrrrrrrrrrrrBZbvji");
+        BEAST_EXPECT(toBase58Cached(noAccount()) == toBase58(noAccount()));
+        BEAST_EXPECT(toBase58Cached(noAccount()) == toBase58(noAccount()));
+    }
+
+    void
+    testBase58()
+    {
+        std::mt19937 gen(5);
+        for (int i = 0; i < 1000; ++i)
+        {
+            // Tokens of every length up to that of a public key, with
+            // runs of zero bytes
+            std::string token(i % 34, '\0');
+            for (auto& c : token)
+                c = gen() % 3 == 0 ? 0 : static_cast<char>(gen());
+            auto const type = static_cast<TokenType>(gen() % 2 ? 0 : gen());
+
+            auto const s = encodeBase58Token(type, token.data(), token.size());
+            BEAST_EXPECT(decodeBase58Token(s, type) == token);
+
+            // Characters outside the alphabet are rejected
+            auto bad = s;
+            bad[gen() % bad.size()] = '0';
+            BEAST_EXPECT(decodeBase58Token(bad, type).empty());
+        }
     }
 
     void
     run() override
     {
         testAccountID();
+        testBase58();
     }
 };
 
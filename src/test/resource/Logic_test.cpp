@@ -27,6 +27,8 @@
 
 #include <boost/utility/base_from_member.hpp>
 #include <functional>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 namespace Resource {
@@ -275,6 +277,44 @@ public:
         pass();
     }
 
+    void
+    testConcurrentCharges(beast::Journal j)
+    {
+        testcase("Concurrent charges");
+
+        TestLogic logic(j);
+
+        // Consumers share entries by address; the clock doesn't move, so
+        // no charge decays and the balances are exact
+        beast::IP::Endpoint const address(
+            beast::IP::Endpoint::from_string("192.0.2.3"));
+        int constexpr threads = 4;
+        int constexpr charges = 1000;
+        int constexpr cost = 32;
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]() {
+                Consumer c(logic.newInboundEndpoint(address));
+                for (int i = 0; i < charges; ++i)
+                {
+                    c.charge(Charge(cost));
+                    c.warn();
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+
+        Consumer c(logic.newInboundEndpoint(address));
+        // The charges stay below the warning threshold, so no fee was added
+        BEAST_EXPECT(
+            c.balance() == threads * charges * cost / decayWindowSeconds);
+        BEAST_EXPECT(!c.warn());
+        BEAST_EXPECT(!c.disconnect());
+    }
+
     void
     run() override
     {
@@ -286,6 +326,7 @@ public:
         testCharges(journal);
         testImports(journal);
         testImport(journal);
+        testConcurrentCharges(journal);
     }
 };
 
@@ -17,9 +17,11 @@
 */
 //==============================================================================
 
+#include <ripple/basics/StringUtilities.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/json_value.h>
 #include <ripple/json/to_string.h>
+#include <ripple/protocol/STLedgerEntry.h>
 #include <ripple/protocol/jss.h>
 #include <test/jtx.h>
 
@@ -578,12 +580,60 @@ public:
         BEAST_EXPECT(acct_objs_is_size(acct_objs(gw, jss::hashes), 0));
     }
 
+    void
+    testBinary()
+    {
+        testcase("binary");
+
+        using namespace jtx;
+        Env env(*this);
+
+        Account const gw{"gateway"};
+        Account const bob{"bob"};
+        auto const USD = gw["USD"];
+
+        env.fund(XRP(1000), gw, bob);
+        env.trust(USD(1000), bob);
+        env(pay(gw, bob, USD(100)));
+        env(offer(bob, XRP(100), USD(1)), txflags(tfPassive));
+        env.close();
+
+        Json::Value params;
+        params[jss::account] = bob.human();
+        auto const expanded =
+            env.rpc("json", "account_objects", to_string(params))[jss::result];
+        params[jss::binary] = true;
+        auto const binary =
+            env.rpc("json", "account_objects", to_string(params))[jss::result];
+
+        auto const& objs = expanded[jss::account_objects];
+        auto const& blobs = binary[jss::account_objects];
+        if (!BEAST_EXPECT(objs.size() == 2 && blobs.size() == 2))
+            return;
+
+        // Each object decodes to the one returned as JSON
+        for (Json::UInt i = 0; i < blobs.size(); ++i)
+        {
+            BEAST_EXPECT(!blobs[i].isMember(sfLedgerEntryType.jsonName));
+            BEAST_EXPECT(blobs[i][jss::index] == objs[i][jss::index]);
+
+            uint256 key;
+            auto const data = strUnHex(blobs[i][jss::data].asString());
+            if (!BEAST_EXPECT(
+                    data && key.parseHex(blobs[i][jss::index].asString())))
+                continue;
+            STLedgerEntry const sle{SerialIter{makeSlice(*data)}, key};
+            BEAST_EXPECT(sle.getJson(JsonOptions::none) == objs[i]);
+        }
+    }
+
     void
     run() override
     {
         testErrors();
         testUnsteppedThenStepped();
         testObjectTypes();
+        testBinary();
     }
 };
 
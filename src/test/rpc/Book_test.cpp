@@ -15,8 +15,13 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/OrderBookDB.h>
+#include <ripple/basics/StringUtilities.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STLedgerEntry.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/impl/Tuning.h>
 #include <test/jtx.h>
@@ -1709,6 +1714,133 @@ public:
             (asAdmin ? RPC::Tuning::bookOffers.rdefault : 0u));
     }
 
+    void
+    testBookOfferSnapshot()
+    {
+        testcase("BookOffer Snapshot");
+        using namespace jtx;
+        Env env{*this};
+        Account gw{"gw"};
+        Account alice{"alice"};
+        Account bob{"bob"};
+        env.fund(XRP(10000), gw, alice, bob);
+        env.close();
+        auto USD = gw["USD"];
+        env(rate(gw, 1.25));
+        env.trust(USD(1000), alice, bob);
+        env(pay(gw, alice, USD(30)));
+        env(pay(gw, bob, USD(100)));
+        env.close();
+
+        // alice's second offer is only partly funded
+        env(offer(alice, XRP(100), USD(20)));
+        env(offer(alice, XRP(200), USD(20)));
+        env(offer(bob, XRP(300), USD(50)));
+        env.close();
+
+        Json::Value jvParams;
+        jvParams[jss::ledger_index] = "validated";
+        jvParams[jss::taker_pays][jss::currency] = "XRP";
+        jvParams[jss::taker_gets][jss::currency] = "USD";
+        jvParams[jss::taker_gets][jss::issuer] = gw.human();
+        auto const walked = env.rpc(
+            "json", "book_offers", to_string(jvParams))[jss::result];
+        BEAST_EXPECT(walked[jss::offers].size() == 3);
+
+        // Having been asked for, the book is snapshotted at the next ledger
+        env.close();
+        env.app().getJobQueue().rendezvous();
+        auto const ledger = env.app().getLedgerMaster().getValidatedLedger();
+        Book const book{xrpIssue(), USD.issue()};
+        auto& orderBooks = env.app().getOrderBookDB();
+
+        Json::Value result;
+        BEAST_EXPECT(
+            orderBooks.getSnapshotPage(*ledger, book, noAccount(), 10, result));
+        BEAST_EXPECT(result[jss::offers] == walked[jss::offers]);
+
+        auto const served = env.rpc(
+            "json", "book_offers", to_string(jvParams))[jss::result];
+        BEAST_EXPECT(served[jss::offers] == walked[jss::offers]);
+
+        // The whole book is held, so any limit is served
+        result.clear();
+        BEAST_EXPECT(
+            orderBooks.getSnapshotPage(*ledger, book, noAccount(), 1, result));
+        BEAST_EXPECT(result[jss::offers].size() == 1);
+        result.clear();
+        BEAST_EXPECT(orderBooks.getSnapshotPage(
+            *ledger, book, noAccount(), 1000, result));
+        BEAST_EXPECT(result[jss::offers].size() == 3);
+
+        // The issuer pays no transfer fee, so its view is walked afresh
+        BEAST_EXPECT(
+            !orderBooks.getSnapshotPage(*ledger, book, gw.id(), 10, result));
+
+        // Nor is there a snapshot of any other ledger
+        BEAST_EXPECT(!orderBooks.getSnapshotPage(
+            *env.current(), book, noAccount(), 10, result));
+    }
+
+    void
+    testBookOfferBinary()
+    {
+        testcase("BookOffer Binary");
+        using namespace jtx;
+        Env env{*this};
+        Account gw{"gw"};
+        Account alice{"alice"};
+        env.fund(XRP(10000), gw, alice);
+        env.close();
+        auto USD = gw["USD"];
+        env.trust(USD(1000), alice);
+        env(pay(gw, alice, USD(30)));
+        env(offer(alice, XRP(100), USD(20)));
+        env(offer(alice, XRP(200), USD(20)));
+        env.close();
+
+        Json::Value jvParams;
+        jvParams[jss::ledger_index] = "validated";
+        jvParams[jss::taker_pays][jss::currency] = "XRP";
+        jvParams[jss::taker_gets][jss::currency] = "USD";
+        jvParams[jss::taker_gets][jss::issuer] = gw.human();
+        auto const expanded = env.rpc(
+            "json", "book_offers", to_string(jvParams))[jss::result];
+        jvParams[jss::binary] = true;
+        auto const binary = env.rpc(
+            "json", "book_offers", to_string(jvParams))[jss::result];
+
+        auto const& offers = expanded[jss::offers];
+        auto const& blobs = binary[jss::offers];
+        if (!BEAST_EXPECT(offers.size() == 2 && blobs.size() == 2))
+            return;
+
+        for (Json::UInt i = 0; i < blobs.size(); ++i)
+        {
+            auto const& blob = blobs[i];
+            auto const& offer = offers[i];
+            BEAST_EXPECT(!blob.isMember(jss::TakerGets));
+            BEAST_EXPECT(blob[jss::index] == offer[jss::index]);
+
+            // The funding details are still computed for binary offers
+            BEAST_EXPECT(blob[jss::quality] == offer[jss::quality]);
+            BEAST_EXPECT(blob[jss::owner_funds] == offer[jss::owner_funds]);
+            BEAST_EXPECT(
+                blob[jss::taker_gets_funded] == offer[jss::taker_gets_funded]);
+
+            uint256 key;
+            auto const data = strUnHex(blob[jss::data].asString());
+            if (!BEAST_EXPECT(
+                    data && key.parseHex(blob[jss::index].asString())))
+                continue;
+            STLedgerEntry const sle{SerialIter{makeSlice(*data)}, key};
+            auto const json = sle.getJson(JsonOptions::none);
+            BEAST_EXPECT(json[jss::TakerGets] == offer[jss::TakerGets]);
+            BEAST_EXPECT(json[jss::TakerPays] == offer[jss::TakerPays]);
+            BEAST_EXPECT(json[jss::Sequence] == offer[jss::Sequence]);
+        }
+    }
+
     void
     run() override
     {
@@ -1726,6 +1858,8 @@ public:
         testBookOfferErrors();
         testBookOfferLimits(true);
         testBookOfferLimits(false);
+        testBookOfferSnapshot();
+        testBookOfferBinary();
     }
 };
 
@@ -15,7 +15,10 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/IssuerBalances.h>
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Feature.h>
 #include <ripple/protocol/jss.h>
 #include <test/jtx.h>
@@ -148,6 +151,86 @@ public:
         }
     }
 
+    void
+    testKeptTotals()
+    {
+        testcase("Kept totals");
+        using namespace jtx;
+        Env env(*this);
+
+        Account const gw{"gw"};
+        Account const bob{"bob"};
+        Account const carol{"carol"};
+        Account const nobody{"nobody"};
+        env.fund(XRP(10000), gw, bob, carol, nobody);
+        env.close();
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+        env.trust(USD(1000), bob, carol);
+        env.trust(EUR(1000), carol);
+        env(pay(gw, bob, USD(100)));
+        env(pay(gw, carol, USD(25)));
+        env(pay(gw, carol, EUR(40)));
+        env.close();
+
+        auto query = [&](bool scan) {
+            Json::Value params;
+            params[jss::account] = gw.human();
+            params[jss::ledger_index] = "validated";
+            // A hot wallet forces a scan of the trust lines
+            if (scan)
+                params[jss::hotwallet] = nobody.human();
+            return env.rpc(
+                "json", "gateway_balances", to_string(params))[jss::result];
+        };
+
+        auto check = [&]() {
+            env.close();
+            env.app().getJobQueue().rendezvous();
+
+            std::map<Currency, STAmount> obligations;
+            std::map<AccountID, std::vector<STAmount>> frozen;
+            std::map<AccountID, std::vector<STAmount>> assets;
+            auto const ledger =
+                env.app().getLedgerMaster().getValidatedLedger();
+            BEAST_EXPECT(env.app().getIssuerBalances().getTotals(
+                *ledger, gw.id(), obligations, frozen, assets));
+
+            auto const kept = query(false);
+            auto const scanned = query(true);
+            for (auto const& field :
+                 {jss::obligations, jss::frozen_balances, jss::assets})
+                BEAST_EXPECT(kept[field] == scanned[field]);
+            return kept;
+        };
+
+        // Asking about the issuer starts keeping its totals
+        query(false);
+        auto result = check();
+        BEAST_EXPECT(result[jss::obligations]["USD"] == "125");
+        BEAST_EXPECT(result[jss::obligations]["EUR"] == "40");
+
+        // Payments, a frozen line, an asset and a removed line
+        env(pay(gw, carol, USD(5)));
+        env(trust(gw, carol["EUR"](0), carol, tfSetFreeze));
+        env(trust(gw, bob["USD"](50)));
+        env(pay(bob, gw, USD(100)));
+        env(pay(bob, gw, USD(10)));
+        result = check();
+        BEAST_EXPECT(result[jss::obligations].size() == 1);
+        BEAST_EXPECT(result[jss::obligations]["USD"] == "30");
+        BEAST_EXPECT(
+            result[jss::frozen_balances][carol.human()][0u][jss::value] ==
+            "40");
+        BEAST_EXPECT(
+            result[jss::assets][bob.human()][0u][jss::value] == "10");
+
+        env(pay(carol, gw, USD(30)));
+        env.trust(USD(0), carol);
+        result = check();
+        BEAST_EXPECT(!result.isMember(jss::obligations));
+    }
+
     void
     run() override
     {
@@ -155,6 +238,7 @@ public:
         auto const sa = supported_amendments();
         testGWB(sa - featureFlowCross);
         testGWB(sa);
+        testKeptTotals();
     }
 };
 
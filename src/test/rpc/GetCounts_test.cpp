@@ -47,6 +47,9 @@ class GetCounts_test : public beast::unit_test::suite
             BEAST_EXPECT(
                 result.isMember(jss::dbKBTotal) &&
                 result[jss::dbKBTotal].asInt() > 0);
+            BEAST_EXPECT(
+                result[jss::job_queue].isMember("threads") &&
+                result[jss::job_queue]["job_types"].isArray());
         }
 
         // create some transactions
@@ -106,6 +109,19 @@ class GetCounts_test : public beast::unit_test::suite
                 result.isMember(jss::local_txs) &&
                 result[jss::local_txs].asInt() > 0);
         }
+
+        {
+            // reads of a closed ledger share deserialized entries
+            result = env.rpc("get_counts")[jss::result];
+            auto const hits = std::stoull(result[jss::SLE_hits].asString());
+            for (auto i = 0; i < 2; ++i)
+                env.rpc("account_info", alice.human(), "closed");
+            result = env.rpc("get_counts")[jss::result];
+            BEAST_EXPECT(result.isMember(jss::SLE_misses));
+            BEAST_EXPECT(
+                std::stoull(result[jss::SLE_hits].asString()) > hits);
+            BEAST_EXPECT(result[jss::SLE_size].asUInt() > 0);
+        }
     }
 
 public:
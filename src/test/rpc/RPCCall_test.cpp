@@ -3229,6 +3229,88 @@ static RPCCallTestData const rpcCallTestArray[] = {
      RPCCallTestData::bad_cast,
      R"()"},
 
+    // get_trace
+    // ------------------------------------------------------------------------
+    {"get_trace: minimal.",
+     __LINE__,
+     {"get_trace"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "get_trace",
+    "params" : [
+      {
+         "api_version" : %MAX_API_VER%,
+      }
+    ]
+    })"},
+    {"get_trace: clear.",
+     __LINE__,
+     {"get_trace", "clear"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "get_trace",
+    "params" : [
+      {
+         "api_version" : %MAX_API_VER%,
+         "clear" : true
+      }
+    ]
+    })"},
+    {"get_trace: start.",
+     __LINE__,
+     {"get_trace", "start"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "get_trace",
+    "params" : [
+      {
+         "api_version" : %MAX_API_VER%,
+         "enable" : true
+      }
+    ]
+    })"},
+    {"get_trace: stop.",
+     __LINE__,
+     {"get_trace", "stop"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "get_trace",
+    "params" : [
+      {
+         "api_version" : %MAX_API_VER%,
+         "enable" : false
+      }
+    ]
+    })"},
+    {"get_trace: invalid argument.",
+     __LINE__,
+     {"get_trace", "pause"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "get_trace",
+    "params" : [
+      {
+         "error" : "invalidParams",
+         "error_code" : 31,
+         "error_message" : "Invalid parameters."
+      }
+    ]
+    })"},
+    {"get_trace: too many arguments.",
+     __LINE__,
+     {"get_trace", "start", "clear"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "get_trace",
+    "params" : [
+      {
+         "error" : "badSyntax",
+         "error_code" : 1,
+         "error_message" : "Syntax error."
+      }
+    ]
+    })"},
+
     // json
     // ------------------------------------------------------------------------
     {"json: minimal.",
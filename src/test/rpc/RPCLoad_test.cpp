@@ -0,0 +1,355 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/core/Config.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx/JSONRPCClient.h>
+#include <test/jtx/WSClient.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Replays a mix of RPC requests against a running server.
+
+    Requests are sent at a fixed total rate over several connections, each
+    of which waits for one reply before sending its next request, so the
+    rate achieved falls short of the one asked for once the server can not
+    keep up. Meanwhile another connection polls get_counts for the depth
+    of the server's job queue.
+
+    Reports the latency percentiles and error rate of each method, and the
+    number of jobs seen waiting.
+
+    Parameters, separated by commas, for example
+    --unittest-arg="port=5005,rate=500,requests=capture.txt":
+
+        ip          Address of the server, 127.0.0.1 by default
+        port        Port of the server, 5005 by default
+        protocol    http or ws, http by default
+        requests    File of requests to replay; if missing, a mix of
+                    server_info, fee, ledger_closed and ledger_current
+        rate        Requests per second over all connections, 100 by default
+        duration    Seconds to run, 30 by default
+        clients     Connections sending requests, 4 by default
+        poll_ms     Milliseconds between polls of get_counts, 1000 by default
+
+    The file holds one request per line, either the body of a JSON-RPC
+    request such as {"method":"fee","params":[{}]} or a WebSocket command
+    such as {"command":"fee"}. Blank lines and lines starting with '#' are
+    ignored, and the requests are sent in order, over and over.
+*/
+class RPCLoad_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    struct Request
+    {
+        std::string method;
+        Json::Value params;
+    };
+
+    struct Stats
+    {
+        std::vector<clock::duration> latencies;
+        std::size_t errors = 0;
+    };
+
+    static Section
+    parse(std::string const& s)
+    {
+        Section section;
+        std::vector<std::string> v;
+        boost::split(v, s, boost::algorithm::is_any_of(","));
+        section.append(v);
+        return section;
+    }
+
+    std::vector<Request>
+    loadRequests(std::string const& path)
+    {
+        std::vector<Request> requests;
+        std::ifstream in(path);
+        if (!in)
+        {
+            fail("Unable to open " + path);
+            return requests;
+        }
+
+        std::string line;
+        while (std::getline(in, line))
+        {
+            boost::trim(line);
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            Json::Value jv;
+            if (!Json::Reader().parse(line, jv) || !jv.isObject())
+            {
+                log << "Skipping unreadable request: " << line << std::endl;
+                continue;
+            }
+
+            Request r;
+            if (jv.isMember(jss::method))
+            {
+                r.method = jv[jss::method].asString();
+                if (jv[jss::params].isArray() && jv[jss::params].size() > 0)
+                    r.params = jv[jss::params][0u];
+            }
+            else if (jv.isMember(jss::command))
+            {
+                r.method = jv[jss::command].asString();
+                jv.removeMember(jss::command);
+                jv.removeMember(jss::id);
+                r.params = jv;
+            }
+            else
+            {
+                log << "Skipping request with no method: " << line
+                    << std::endl;
+                continue;
+            }
+            requests.push_back(std::move(r));
+        }
+        return requests;
+    }
+
+    static std::vector<Request>
+    defaultRequests()
+    {
+        Json::Value current(Json::objectValue);
+        current[jss::ledger_index] = "current";
+        return {
+            {"server_info", {}},
+            {"fee", {}},
+            {"ledger_closed", {}},
+            {"ledger", current}};
+    }
+
+    static std::unique_ptr<AbstractClient>
+    connect(Section const& args)
+    {
+        auto const protocol = get<std::string>(args, "protocol", "http");
+
+        Config cfg;
+        cfg.section("server").append("port_load");
+        auto& port = cfg.section("port_load");
+        port.set("ip", get<std::string>(args, "ip", "127.0.0.1"));
+        port.set("port", get<std::string>(args, "port", "5005"));
+        port.set("protocol", protocol);
+
+        if (protocol == "ws" || protocol == "wss")
+            return makeWSClient(cfg, false, 1);
+        return makeJSONRPCClient(cfg, 1);
+    }
+
+    static bool
+    failed(Json::Value const& jv)
+    {
+        return jv.isNull() || jv.isMember(jss::error) ||
+            jv[jss::result][jss::status] == jss::error;
+    }
+
+    template <class Duration>
+    static std::int64_t
+    micros(Duration d)
+    {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(d).count();
+    }
+
+    void
+    report(
+        std::map<std::string, Stats>& stats,
+        clock::duration elapsed,
+        std::vector<std::size_t> const& depths,
+        std::map<std::string, std::size_t> const& maxWaiting)
+    {
+        using namespace std::chrono;
+
+        std::size_t total = 0;
+        std::size_t errors = 0;
+        for (auto& [method, s] : stats)
+        {
+            auto& l = s.latencies;
+            if (l.empty())
+                continue;
+            std::sort(l.begin(), l.end());
+            auto const at = [&l](double p) {
+                return micros(l[static_cast<std::size_t>(p * (l.size() - 1))]);
+            };
+            log << "  " << method << ": " << l.size() << " requests, "
+                << (100.0 * s.errors / l.size()) << "% errors, p50 "
+                << at(0.5) << "us, p90 " << at(0.9) << "us, p99 " << at(0.99)
+                << "us, max " << micros(l.back()) << "us" << std::endl;
+            total += l.size();
+            errors += s.errors;
+        }
+
+        auto const seconds = duration_cast<duration<double>>(elapsed).count();
+        log << total << " requests in " << seconds << "s, "
+            << (seconds > 0 ? total / seconds : 0) << " per second, "
+            << errors << " errors" << std::endl;
+
+        if (depths.empty())
+            return;
+        std::size_t sum = 0;
+        for (auto const d : depths)
+            sum += d;
+        log << "Jobs waiting over " << depths.size() << " polls: mean "
+            << (sum / depths.size()) << ", max "
+            << *std::max_element(depths.begin(), depths.end()) << std::endl;
+        for (auto const& [type, n] : maxWaiting)
+            log << "  " << type << ": max " << n << " waiting" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono;
+
+        testcase("RPC load");
+
+        auto const args = parse(arg());
+        auto const requests = args.exists("requests")
+            ? loadRequests(get<std::string>(args, "requests"))
+            : defaultRequests();
+        if (!BEAST_EXPECT(!requests.empty()))
+            return;
+
+        auto const rate = std::max(1.0, get<double>(args, "rate", 100));
+        auto const clients = std::max(1, get<int>(args, "clients", 4));
+        auto const runFor = seconds(get<int>(args, "duration", 30));
+        auto const pollEvery = milliseconds(get<int>(args, "poll_ms", 1000));
+
+        // Each connection sends at its share of the rate, offset from the
+        // others so the requests are spread evenly
+        auto const interval = duration_cast<clock::duration>(
+            duration<double>(clients / rate));
+
+        std::atomic<std::size_t> next{0};
+        std::atomic<bool> done{false};
+        std::vector<std::map<std::string, Stats>> results(clients);
+        std::vector<std::size_t> depths;
+        std::map<std::string, std::size_t> maxWaiting;
+
+        auto const start = clock::now();
+        auto const stop = start + runFor;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < clients; ++i)
+        {
+            threads.emplace_back([&, i]() {
+                auto& stats = results[i];
+                std::unique_ptr<AbstractClient> client;
+                auto when = start + interval * i / clients;
+                for (; when < stop; when += interval)
+                {
+                    std::this_thread::sleep_until(when);
+                    auto const& r = requests[next++ % requests.size()];
+                    auto& s = stats[r.method];
+                    auto const sent = clock::now();
+                    try
+                    {
+                        if (!client)
+                            client = connect(args);
+                        if (failed(client->invoke(r.method, r.params)))
+                            ++s.errors;
+                    }
+                    catch (std::exception const&)
+                    {
+                        // Reconnect for the next request
+                        client.reset();
+                        ++s.errors;
+                    }
+                    s.latencies.push_back(clock::now() - sent);
+                }
+            });
+        }
+
+        std::thread poller([&]() {
+            std::unique_ptr<AbstractClient> client;
+            while (!done)
+            {
+                std::this_thread::sleep_for(pollEvery);
+                try
+                {
+                    if (!client)
+                        client = connect(args);
+                    auto const jv = client->invoke("get_counts");
+                    std::size_t waiting = 0;
+                    for (auto const& job :
+                         jv[jss::result][jss::job_queue]["job_types"])
+                    {
+                        auto const n = job["waiting"].asUInt();
+                        auto& max = maxWaiting[job["job_type"].asString()];
+                        max = std::max<std::size_t>(max, n);
+                        waiting += n;
+                    }
+                    depths.push_back(waiting);
+                }
+                catch (std::exception const&)
+                {
+                    client.reset();
+                }
+            }
+        });
+
+        for (auto& t : threads)
+            t.join();
+        auto const elapsed = clock::now() - start;
+        done = true;
+        poller.join();
+
+        std::map<std::string, Stats> stats;
+        for (auto& r : results)
+        {
+            for (auto& [method, s] : r)
+            {
+                auto& merged = stats[method];
+                merged.latencies.insert(
+                    merged.latencies.end(),
+                    s.latencies.begin(),
+                    s.latencies.end());
+                merged.errors += s.errors;
+            }
+        }
+
+        report(stats, elapsed, depths, maxWaiting);
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(RPCLoad, rpc, ripple);
+
+}  // namespace test
+}  // namespace ripple
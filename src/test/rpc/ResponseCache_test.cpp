@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/insight/NullCollector.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/resource/Fees.h>
+#include <ripple/rpc/ResponseCache.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class ResponseCache_test : public beast::unit_test::suite
+{
+    static RPC::ResponseCache::Setup
+    makeSetup(std::size_t maxEntries)
+    {
+        RPC::ResponseCache::Setup setup;
+        setup.methods = {"account_info"};
+        setup.maxEntries = maxEntries;
+        return setup;
+    }
+
+    void
+    testKey()
+    {
+        testcase("key");
+        using Cache = RPC::ResponseCache;
+
+        Json::Value a(Json::objectValue);
+        a[jss::account] = "alice";
+        a[jss::ledger_index] = "validated";
+        Json::Value b(Json::objectValue);
+        b[jss::ledger_index] = "validated";
+        b[jss::account] = "alice";
+        b[jss::id] = 7;
+        b[jss::command] = "account_info";
+
+        auto const key = Cache::makeKey("account_info", a, 1, Role::GUEST);
+        BEAST_EXPECT(
+            key == Cache::makeKey("account_info", b, 1, Role::GUEST));
+        BEAST_EXPECT(
+            key != Cache::makeKey("account_info", a, 2, Role::GUEST));
+        BEAST_EXPECT(
+            key != Cache::makeKey("account_info", a, 1, Role::ADMIN));
+        BEAST_EXPECT(key != Cache::makeKey("account_lines", a, 1, Role::GUEST));
+
+        b[jss::account] = "bob";
+        BEAST_EXPECT(
+            key != Cache::makeKey("account_info", b, 1, Role::GUEST));
+    }
+
+    void
+    testCache()
+    {
+        testcase("cache");
+
+        RPC::ResponseCache cache(
+            makeSetup(2), beast::insight::NullCollector::New());
+        BEAST_EXPECT(cache.enabled("account_info"));
+        BEAST_EXPECT(!cache.enabled("server_info"));
+
+        uint256 const closed1{1}, closed2{2}, validated{3};
+        Json::Value result;
+        Resource::Charge load = Resource::feeReferenceRPC;
+
+        BEAST_EXPECT(!cache.fetch("a", closed1, validated, result, load));
+        Json::Value stored(Json::objectValue);
+        stored[jss::status] = jss::success;
+        cache.insert(
+            "a", closed1, validated, stored, Resource::feeMediumBurdenRPC);
+
+        BEAST_EXPECT(cache.fetch("a", closed1, validated, result, load));
+        BEAST_EXPECT(result == stored);
+        BEAST_EXPECT(load.cost() == Resource::feeMediumBurdenRPC.cost());
+
+        // The cache holds at most two entries
+        cache.insert("b", closed1, validated, stored, load);
+        cache.insert("c", closed1, validated, stored, load);
+        BEAST_EXPECT(cache.fetch("b", closed1, validated, result, load));
+        BEAST_EXPECT(!cache.fetch("c", closed1, validated, result, load));
+
+        // A new ledger empties the cache
+        BEAST_EXPECT(!cache.fetch("a", closed2, validated, result, load));
+        BEAST_EXPECT(!cache.fetch("b", closed2, validated, result, load));
+
+        // Responses computed against an older ledger aren't stored
+        cache.insert("a", closed1, validated, stored, load);
+        BEAST_EXPECT(!cache.fetch("a", closed2, validated, result, load));
+    }
+
+    void
+    testAccountInfo()
+    {
+        testcase("account_info");
+        using namespace jtx;
+
+        Env env{*this, envconfig([](std::unique_ptr<Config> cfg) {
+                    cfg->section("rpc_cache").set("methods", "account_info");
+                    return cfg;
+                })};
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        auto const balance = [&]() {
+            auto const info = env.rpc(
+                "json",
+                "account_info",
+                "{\"account\": \"" + alice.human() + "\"}");
+            return info[jss::result][jss::account_data][sfBalance.jsonName];
+        };
+
+        auto const before = balance();
+        BEAST_EXPECT(before.isString());
+
+        // Within a ledger interval the cached response is returned
+        env(pay(alice, bob, XRP(100)));
+        BEAST_EXPECT(balance() == before);
+
+        // The next ledger invalidates it
+        env.close();
+        BEAST_EXPECT(balance() != before);
+    }
+
+public:
+    void
+    run() override
+    {
+        testKey();
+        testCache();
+        testAccountInfo();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ResponseCache, rpc, ripple);
+
+}  // namespace test
+}  // namespace ripple
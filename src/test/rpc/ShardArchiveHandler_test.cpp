@@ -159,9 +159,11 @@ public:
     // contents of the filesystem and the handler's
     // archives.
     void
-    testDownloadsAndFileSystem()
+    testDownloadsAndFileSystem(bool streamArchives)
     {
-        testcase("testDownloadsAndFileSystem");
+        testcase(
+            std::string("testDownloadsAndFileSystem") +
+            (streamArchives ? " streamed" : ""));
 
         beast::temp_dir tempDir;
 
@@ -171,6 +173,7 @@ public:
         section.set("max_historical_shards", "20");
         section.set("ledgers_per_shard", "256");
         section.set("earliest_seq", "257");
+        section.set("stream_archives", streamArchives ? "1" : "0");
         auto& sectionNode = c->section(ConfigSection::nodeDatabase());
         sectionNode.set("earliest_seq", "257");
         c->setupControl(true, true, true);
@@ -667,7 +670,8 @@ public:
     {
         testSingleDownloadAndStateDB();
         testDownloadsAndStateDB();
-        testDownloadsAndFileSystem();
+        testDownloadsAndFileSystem(false);
+        testDownloadsAndFileSystem(true);
         testDownloadsAndRestart();
         testShardCountFailure();
         testRedundantShardFailure();
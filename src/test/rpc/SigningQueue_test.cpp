@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/SigningQueue.h>
+#include <test/jtx.h>
+#include <future>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class SigningQueue_test : public beast::unit_test::suite
+{
+    beast::Journal const j_{beast::Journal::getNullSink()};
+
+    static RPC::SigningQueue::Setup
+    makeSetup(std::size_t maxQueued, std::size_t keyCacheSize)
+    {
+        RPC::SigningQueue::Setup setup;
+        setup.threads = 1;
+        setup.maxQueued = maxQueued;
+        setup.keyCacheSize = keyCacheSize;
+        return setup;
+    }
+
+    void
+    testKeyPairs()
+    {
+        testcase("key pairs");
+
+        RPC::SigningQueue queue(makeSetup(8, 2), j_);
+        auto const a = generateSeed("alice");
+        auto const b = generateSeed("bob");
+        auto const c = generateSeed("carol");
+
+        auto const expected = generateKeyPair(KeyType::secp256k1, a);
+        auto const first = queue.keyPair(KeyType::secp256k1, a);
+        BEAST_EXPECT(first.first == expected.first);
+        BEAST_EXPECT(first.second == expected.second);
+
+        auto const second = queue.keyPair(KeyType::secp256k1, a);
+        BEAST_EXPECT(second.first == expected.first);
+        BEAST_EXPECT(second.second == expected.second);
+
+        // The key type is part of what a pair is found by
+        auto const ed = queue.keyPair(KeyType::ed25519, a);
+        BEAST_EXPECT(ed.first == generateKeyPair(KeyType::ed25519, a).first);
+
+        auto json = queue.getJson();
+        BEAST_EXPECT(json["key_hits"].asUInt() == 1);
+        BEAST_EXPECT(json["key_misses"].asUInt() == 2);
+        BEAST_EXPECT(json["key_pairs"].asUInt() == 2);
+
+        // The least recently used pair is dropped
+        queue.keyPair(KeyType::secp256k1, a);
+        queue.keyPair(KeyType::secp256k1, b);
+        queue.keyPair(KeyType::secp256k1, a);
+        queue.keyPair(KeyType::secp256k1, c);
+        queue.keyPair(KeyType::secp256k1, b);
+        json = queue.getJson();
+        BEAST_EXPECT(json["key_hits"].asUInt() == 3);
+        BEAST_EXPECT(json["key_misses"].asUInt() == 5);
+        BEAST_EXPECT(json["key_pairs"].asUInt() == 2);
+    }
+
+    void
+    testQueues()
+    {
+        testcase("queues");
+
+        std::vector<int> order;
+        std::promise<void> started;
+        std::promise<void> release;
+        auto const wait = release.get_future().share();
+        {
+            RPC::SigningQueue queue(makeSetup(1, 0), j_);
+
+            // Block the only thread
+            BEAST_EXPECT(queue.post(Role::USER, [&, wait]() {
+                started.set_value();
+                wait.wait();
+            }));
+            started.get_future().wait();
+
+            // Each role has a queue of its own, of one request
+            BEAST_EXPECT(
+                queue.post(Role::USER, [&]() { order.push_back(1); }));
+            BEAST_EXPECT(
+                !queue.post(Role::GUEST, [&]() { order.push_back(2); }));
+            BEAST_EXPECT(
+                queue.post(Role::ADMIN, [&]() { order.push_back(3); }));
+            BEAST_EXPECT(
+                !queue.post(Role::ADMIN, [&]() { order.push_back(4); }));
+
+            auto const json = queue.getJson();
+            BEAST_EXPECT(json["queued"].asUInt() == 1);
+            BEAST_EXPECT(json["queued_unlimited"].asUInt() == 1);
+            BEAST_EXPECT(json["rejected"].asUInt() == 2);
+
+            // Without a coroutine the work is done on the calling thread
+            bool ran = false;
+            BEAST_EXPECT(queue.run(Role::USER, {}, [&]() { ran = true; }));
+            BEAST_EXPECT(ran);
+
+            release.set_value();
+        }
+
+        // The queue finishes its work before it stops, admin work first
+        BEAST_EXPECT((order == std::vector<int>{3, 1}));
+    }
+
+    void
+    testSign()
+    {
+        testcase("sign");
+        using namespace jtx;
+
+        Env env{*this};
+        env.close();
+
+        Json::Value toSign;
+        toSign[jss::tx_json] = noop(env.master);
+        toSign[jss::secret] = "masterpassphrase";
+
+        for (int i = 0; i < 2; ++i)
+        {
+            auto const result =
+                env.rpc("json", "sign", to_string(toSign))[jss::result];
+            BEAST_EXPECT(!RPC::contains_error(result));
+            BEAST_EXPECT(result.isMember(jss::tx_blob));
+        }
+
+        // The second request found the key pair derived for the first
+        auto const counts = env.rpc("get_counts")[jss::result];
+        BEAST_EXPECT(counts[jss::signing]["key_hits"].asUInt() == 1);
+        BEAST_EXPECT(counts[jss::signing]["key_misses"].asUInt() == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testKeyPairs();
+        testQueues();
+        testSign();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SigningQueue, rpc, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -288,6 +288,103 @@ public:
         BEAST_EXPECT(jv[jss::status] == "success");
     }
 
+    void
+    testTransactionFilter()
+    {
+        testcase("Transaction filter");
+
+        using namespace std::chrono_literals;
+        using namespace jtx;
+        Env env(*this);
+        auto wsc = makeWSClient(env.app().config());
+        Account const alice("alice");
+        Account const gw("gw");
+        env.fund(XRP(10000), alice, gw);
+        env.close();
+
+        Json::Value stream;
+        {
+            // Only trust lines set by alice
+            stream[jss::streams] = Json::arrayValue;
+            stream[jss::streams].append("transactions");
+            auto& filter = stream[jss::transaction_filter];
+            filter[jss::transaction_types].append("TrustSet");
+            filter[jss::accounts].append(alice.human());
+            auto jv = wsc->invoke("subscribe", stream);
+            BEAST_EXPECT(jv[jss::status] == "success");
+        }
+
+        {
+            // Neither a trust line nor alice's
+            env.fund(XRP(10000), "carol");
+            env.close();
+            BEAST_EXPECT(!wsc->getMsg(10ms));
+
+            env.trust(gw["USD"](100), alice);
+            env.close();
+            BEAST_EXPECT(wsc->findMsg(5s, [&](auto const& jv) {
+                return jv[jss::transaction][jss::TransactionType] ==
+                    jss::TrustSet &&
+                    jv[jss::transaction][jss::Account] == alice.human();
+            }));
+
+            env.trust(alice["EUR"](100), gw);
+            env.close();
+            BEAST_EXPECT(wsc->findMsg(5s, [&](auto const& jv) {
+                return jv[jss::transaction][jss::Account] == gw.human();
+            }));
+
+            env(pay(gw, alice, gw["USD"](10)));
+            env.close();
+            BEAST_EXPECT(!wsc->getMsg(10ms));
+        }
+
+        {
+            // Subscribing again replaces the filter
+            stream[jss::transaction_filter] = Json::objectValue;
+            auto& filter = stream[jss::transaction_filter];
+            filter[jss::min_amount] = gw["USD"](5).value().getJson(
+                JsonOptions::none);
+            auto jv = wsc->invoke("subscribe", stream);
+            BEAST_EXPECT(jv[jss::status] == "success");
+
+            env(pay(gw, alice, gw["USD"](1)));
+            env(pay(gw, alice, XRP(50)));
+            env.close();
+            BEAST_EXPECT(!wsc->getMsg(10ms));
+
+            env(pay(gw, alice, gw["USD"](20)));
+            env.close();
+            BEAST_EXPECT(wsc->findMsg(5s, [&](auto const& jv) {
+                return jv[jss::transaction][jss::TransactionType] ==
+                    jss::Payment;
+            }));
+        }
+
+        {
+            // Malformed filters
+            Json::Value bad;
+            bad[jss::streams] = Json::arrayValue;
+            bad[jss::streams].append("transactions");
+            bad[jss::transaction_filter][jss::transaction_types].append(
+                "NotATransaction");
+            auto jv = wsc->invoke("subscribe", bad);
+            BEAST_EXPECT(jv[jss::status] == "error");
+
+            bad[jss::transaction_filter] = Json::objectValue;
+            bad[jss::transaction_filter][jss::accounts].append("alice");
+            jv = wsc->invoke("subscribe", bad);
+            BEAST_EXPECT(jv[jss::status] == "error");
+        }
+
+        auto jv = wsc->invoke("unsubscribe", stream);
+        BEAST_EXPECT(jv[jss::status] == "success");
+
+        env(pay(gw, alice, gw["USD"](20)));
+        env.close();
+        BEAST_EXPECT(!wsc->getMsg(10ms));
+    }
+
     void
     testManifests()
     {
@@ -697,6 +794,7 @@ public:
         testServer();
         testLedger();
         testTransactions();
+        testTransactionFilter();
         testManifests();
         testValidations();
         testSubErrors(true);
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/TxIndex.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
@@ -268,11 +269,73 @@ class Transaction_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testTxIndex()
+    {
+        testcase("Test Transaction Index");
+
+        using namespace test::jtx;
+        using std::to_string;
+
+        const char* NOT_FOUND = RPC::get_error_info(rpcTXN_NOT_FOUND).token;
+
+        Env env(*this, envconfig([](std::unique_ptr<Config> cfg) {
+            cfg->TX_INDEX = true;
+            return cfg;
+        }));
+        auto const alice = Account("alice");
+        env.fund(XRP(1000), alice);
+        env.close();
+
+        std::vector<std::shared_ptr<STTx const>> txns;
+        for (int i = 0; i < 10; ++i)
+        {
+            env(noop(alice));
+            txns.emplace_back(env.tx());
+            if (i % 3 == 0)
+                env.close();
+        }
+        env.close();
+
+        {
+            // The index does not need the Transactions table
+            auto db = env.app().getTxnDB().checkoutDb();
+            *db << "DELETE FROM Transactions;";
+        }
+
+        for (auto const& tx : txns)
+        {
+            auto const id = tx->getTransactionID();
+            auto const location = findTxIndex(env.app(), id);
+            if (!BEAST_EXPECT(location))
+                continue;
+            BEAST_EXPECT(location->ledgerSeq <= env.closed()->info().seq);
+
+            auto const result =
+                env.rpc("tx", to_string(id))[jss::result];
+            BEAST_EXPECT(result[jss::status] == jss::success);
+            BEAST_EXPECT(result[jss::validated].asBool());
+            BEAST_EXPECT(result[jss::ledger_index] == location->ledgerSeq);
+            BEAST_EXPECT(
+                result[jss::meta][sfTransactionIndex.jsonName] ==
+                location->txnSeq);
+        }
+
+        auto const tx = env.jt(noop(alice), seq(env.seq(alice))).stx;
+        auto const result =
+            env.rpc("tx", to_string(tx->getTransactionID()))[jss::result];
+        BEAST_EXPECT(
+            result[jss::status] == jss::error &&
+            result[jss::error] == NOT_FOUND);
+        BEAST_EXPECT(!result.isMember(jss::searched_all));
+    }
+
 public:
     void
     run() override
     {
         testRangeRequest();
+        testTxIndex();
     }
 };
 
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/server/impl/JSONRPCUtil.h>
+#include <boost/beast/http.hpp>
+#include <string>
+
+namespace ripple {
+namespace test {
+
+class JSONRPCUtil_test : public beast::unit_test::suite
+{
+    static Json::Value
+    makeValue(std::size_t count)
+    {
+        Json::Value jv(Json::objectValue);
+        auto& items = jv["items"] = Json::arrayValue;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Json::Value item(Json::objectValue);
+            item["index"] = static_cast<Json::UInt>(i);
+            item["data"] = std::string(50, 'A' + i % 26);
+            items.append(std::move(item));
+        }
+        return jv;
+    }
+
+    // Parses a reply, returning the body and whether it was chunked
+    std::pair<std::string, bool>
+    parse(std::string const& text)
+    {
+        namespace http = boost::beast::http;
+        http::response_parser<http::string_body> parser;
+        parser.eager(true);
+        boost::beast::error_code ec;
+        std::size_t used = 0;
+        while (!ec && !parser.is_done() && used < text.size())
+            used += parser.put(
+                boost::asio::buffer(text.data() + used, text.size() - used),
+                ec);
+        BEAST_EXPECT(!ec);
+        BEAST_EXPECT(used == text.size());
+        BEAST_EXPECT(parser.is_done());
+        BEAST_EXPECT(parser.get().result_int() == 200);
+        return {parser.get().body(), parser.chunked()};
+    }
+
+    void
+    testReply(std::size_t count, bool chunked, bool expectChunked)
+    {
+        auto const jv = makeValue(count);
+        std::string expected;
+        Json::stream(jv, [&](void const* p, std::size_t n) {
+            expected.append(static_cast<char const*>(p), n);
+        });
+
+        std::string text;
+        auto const size =
+            HTTPReply(200, jv, Json::stringOutput(text), chunked, journal_);
+        BEAST_EXPECT(size == expected.size());
+
+        auto const [body, wasChunked] = parse(text);
+        BEAST_EXPECT(wasChunked == expectChunked);
+        BEAST_EXPECT(body == expected + "\r\n");
+    }
+
+    beast::Journal const journal_{beast::Journal::getNullSink()};
+
+public:
+    void
+    run() override
+    {
+        testcase("small reply");
+        testReply(10, true, false);
+        testReply(10, false, false);
+
+        testcase("large reply");
+        testReply(10000, true, true);
+        testReply(10000, false, false);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JSONRPCUtil, server, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -1181,6 +1181,54 @@ class ServerStatus_test : public beast::unit_test::suite,
         }
     }
 
+    void
+    testBatchRequests(boost::asio::yield_context& yield)
+    {
+        testcase("RPC client sends a batch");
+
+        using namespace test::jtx;
+        Env env{*this};
+        Account const alice{"alice"};
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        // Read-only entries run in parallel and others inline, but the
+        // replies keep the order of the entries
+        Json::Value jv;
+        jv[jss::method] = "batch";
+        jv[jss::params] = Json::arrayValue;
+        for (int i = 0; i < 8; ++i)
+        {
+            Json::Value entry;
+            entry[jss::method] = i % 3 == 2 ? "server_info" : "account_info";
+            entry[jss::account] = alice.human();
+            entry[jss::ledger_index] = i % 2 ? "validated" : "current";
+            entry[jss::id] = i;
+            jv[jss::params].append(entry);
+        }
+
+        boost::beast::http::response<boost::beast::http::string_body> resp;
+        boost::system::error_code ec;
+        doHTTPRequest(env, yield, false, resp, ec, to_string(jv));
+        BEAST_EXPECT(resp.result() == boost::beast::http::status::ok);
+
+        Json::Value reply;
+        Json::Reader{}.parse(resp.body(), reply);
+        if (!BEAST_EXPECT(reply.isArray() && reply.size() == 8))
+            return;
+        for (int i = 0; i < 8; ++i)
+        {
+            auto const& r = reply[i];
+            BEAST_EXPECT(r[jss::id] == i);
+            if (i % 3 == 2)
+                BEAST_EXPECT(r[jss::result].isMember(jss::info));
+            else
+                BEAST_EXPECT(
+                    r[jss::result][jss::account_data][jss::Account] ==
+                    alice.human());
+        }
+    }
+
     void
     testStatusNotOkay(boost::asio::yield_context& yield)
     {
@@ -1239,6 +1287,7 @@ public:
             testNoRPC(yield);
             testWSRequests(yield);
             testRPCRequests(yield);
+            testBatchRequests(yield);
             testStatusNotOkay(yield);
         });
     }
@@ -28,7 +28,9 @@
 #include <boost/beast/ssl/ssl_stream.hpp>
 #include <boost/optional.hpp>
 #include <boost/utility/in_place_factory.hpp>
+#include <algorithm>
 #include <chrono>
+#include <mutex>
 #include <stdexcept>
 #include <test/jtx.h>
 #include <test/jtx/CaptureLogs.h>
@@ -304,6 +306,100 @@ public:
         pass();
     }
 
+    // Answers requests in batches, the newest of each batch first
+    struct PipelineHandler : TestHandler
+    {
+        explicit PipelineHandler(std::size_t batch_) : batch(batch_)
+        {
+        }
+
+        void
+        onRequest(Session& session)
+        {
+            std::vector<std::shared_ptr<Session>> answer;
+            {
+                std::lock_guard lock(mutex);
+                pending.push_back(session.detach());
+                most = std::max(most, pending.size());
+                if (pending.size() == batch ||
+                    !beast::rfc2616::is_keep_alive(session.request()))
+                    std::swap(answer, pending);
+            }
+            for (auto it = answer.rbegin(); it != answer.rend(); ++it)
+            {
+                auto& s = **it;
+                s.write("Hello, " + std::string(s.request().target()) + "\n");
+                if (beast::rfc2616::is_keep_alive(s.request()))
+                    s.complete();
+                else
+                    s.close(true);
+            }
+        }
+
+        std::size_t const batch;
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Session>> pending;
+        std::size_t most = 0;
+    };
+
+    void
+    test_pipeline(std::uint16_t depth, std::size_t batch)
+    {
+        TestSink sink{*this};
+        TestThread thread;
+        beast::Journal journal{sink};
+        PipelineHandler handler(batch);
+        auto server = make_Server(handler, thread.get_io_service(), journal);
+        std::vector<Port> serverPort(1);
+        serverPort.back().ip =
+            beast::IP::Address::from_string(getEnvLocalhostAddr());
+        serverPort.back().port = 0;
+        serverPort.back().protocol.insert("http");
+        serverPort.back().pipeline_depth = depth;
+        auto eps = server->ports(serverPort);
+
+        boost::asio::io_service ios;
+        using socket = boost::asio::ip::tcp::socket;
+        socket s(ios);
+        if (!connect(s, eps[0]))
+            return;
+
+        // All of the requests are sent before any response is read
+        if (!write(
+                s,
+                "GET /1 HTTP/1.1\r\n"
+                "Connection: Keep-Alive\r\n"
+                "\r\n"
+                "GET /2 HTTP/1.1\r\n"
+                "Connection: Keep-Alive\r\n"
+                "\r\n"
+                "GET /3 HTTP/1.1\r\n"
+                "Connection: close\r\n"
+                "\r\n"))
+            return;
+
+        std::string got;
+        boost::system::error_code ec;
+        boost::asio::read(s, boost::asio::dynamic_buffer(got), ec);
+        BEAST_EXPECT(ec == boost::asio::error::eof);
+        BEAST_EXPECT(got == "Hello, /1\nHello, /2\nHello, /3\n");
+        BEAST_EXPECT(handler.most == std::min<std::size_t>(depth, batch));
+
+        s.shutdown(socket::shutdown_both, ec);
+        server = nullptr;
+    }
+
+    void
+    pipelineTests()
+    {
+        testcase("Pipelined requests");
+
+        // Responses keep the order of the requests, however they are
+        // answered, and no more than the depth are handled at once
+        test_pipeline(4, 3);
+        test_pipeline(2, 2);
+    }
+
     void
     stressTest()
     {
@@ -505,6 +601,7 @@ public:
     run() override
     {
         basicTests();
+        pipelineTests();
         stressTest();
         testBadConfig();
     }
@@ -0,0 +1,328 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapItem.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define RIPPLE_SHAMAPBENCH_MALLINFO 1
+#endif
+
+namespace ripple {
+namespace tests {
+
+/** Times the SHAMap operations ledgers are built and acquired with.
+
+    A map of a million items, or as many as the suite argument asks for,
+    is built and then put through the work a ledger close does to it:
+    batches of updates, deletes and inserts on a mutable snapshot, hashing
+    and flushing the changed nodes, and comparing the result with the
+    original. It is then iterated in order and copied to an empty map the
+    way a ledger is acquired from a peer.
+
+    Keys are hashes, as every ledger key is, and item sizes follow the mix
+    of account roots, trust lines and offers in the ledger. Each stage
+    reports operations per second and the change in heap use, where the C
+    library can report it.
+*/
+class SHAMapBench_test : public beast::unit_test::suite
+{
+    using clock = std::chrono::steady_clock;
+
+    // Changes of each kind made to the snapshot, about a busy ledger's worth
+    static constexpr std::size_t batch = 20000;
+
+    beast::xor_shift_engine eng_;
+    std::uint64_t next_ = 0;
+
+    boost::intrusive_ptr<SHAMapItem>
+    makeItem(uint256 const& key)
+    {
+        // Account roots, trust lines and offers, roughly in proportion
+        static constexpr std::size_t sizes[] = {120, 120, 120, 230, 230, 260};
+        Serializer s;
+        auto const size = sizes[rand_int(eng_, std::size_t{5})];
+        while (s.size() < size)
+            s.add32(rand_int<std::uint32_t>(eng_));
+        return make_shamapitem(key, s.slice());
+    }
+
+    boost::intrusive_ptr<SHAMapItem>
+    makeItem()
+    {
+        return makeItem(sha512Half(next_++));
+    }
+
+    static std::int64_t
+    heapInUse()
+    {
+#ifdef RIPPLE_SHAMAPBENCH_MALLINFO
+        auto const mi = mallinfo2();
+        return static_cast<std::int64_t>(mi.uordblks + mi.hblkhd);
+#else
+        return 0;
+#endif
+    }
+
+    /** Times a stage and reports its rate and the heap it kept. */
+    template <class F>
+    void
+    stage(std::string const& name, F&& f)
+    {
+        using namespace std::chrono;
+
+        [[maybe_unused]] auto const heap = heapInUse();
+        auto const start = clock::now();
+        std::size_t const ops = f();
+        auto const elapsed = clock::now() - start;
+        auto const seconds = duration_cast<duration<double>>(elapsed).count();
+
+        log << "  " << name << ": " << ops << " ops in "
+            << duration_cast<milliseconds>(elapsed).count() << "ms, "
+            << static_cast<std::uint64_t>(seconds > 0 ? ops / seconds : 0)
+            << " ops/s";
+#ifdef RIPPLE_SHAMAPBENCH_MALLINFO
+        log << ", " << (heapInUse() - heap) << " bytes";
+#endif
+        log << std::endl;
+    }
+
+    std::size_t
+    items()
+    {
+        std::string const a = arg();
+        if (!a.empty())
+        {
+            if (auto const n = std::stoul(a); n > 0)
+                return n;
+        }
+        return 1000000;
+    }
+
+public:
+    void
+    run() override
+    {
+        test::SuiteJournal journal("SHAMapBench_test", *this);
+
+        auto const count = items();
+        log << count << " items" << std::endl;
+
+        TestNodeFamily f(journal);
+        SHAMap map(SHAMapType::FREE, f);
+
+        {
+            testcase("build");
+
+            std::vector<boost::intrusive_ptr<SHAMapItem>> fill;
+            fill.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+                fill.push_back(makeItem());
+
+            stage("insert", [&] {
+                for (auto& item : fill)
+                    map.addGiveItem(
+                        SHAMapNodeType::tnACCOUNT_STATE, std::move(item));
+                return count;
+            });
+
+            stage("flushDirty", [&] {
+                SHAMapDeferredWrites writes;
+                return map.flushDirty(hotACCOUNT_NODE, writes);
+            });
+            map.setImmutable();
+            pass();
+        }
+
+        std::shared_ptr<SHAMap> changed;
+        {
+            testcase("snapshot");
+
+            stage("snapShot", [&] {
+                for (int i = 0; i < 1000; ++i)
+                    changed = map.snapShot(true);
+                return 1000;
+            });
+
+            // Existing keys to change and to remove, fixed before timing
+            std::vector<boost::intrusive_ptr<SHAMapItem>> updates;
+            std::vector<uint256> deletes;
+            auto const n = std::min(batch, count / 2);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto const k = rand_int(eng_, std::uint64_t{count - 1});
+                auto const key = sha512Half(k);
+                if (k % 2 == 0)
+                    updates.push_back(makeItem(key));
+                else
+                    deletes.push_back(key);
+            }
+            std::vector<boost::intrusive_ptr<SHAMapItem>> inserts;
+            for (std::size_t i = 0; i < n; ++i)
+                inserts.push_back(makeItem());
+
+            stage("update", [&] {
+                for (auto& item : updates)
+                    changed->updateGiveItem(
+                        SHAMapNodeType::tnACCOUNT_STATE, std::move(item));
+                return updates.size();
+            });
+
+            stage("delete", [&] {
+                std::size_t ops = 0;
+                for (auto const& key : deletes)
+                    ops += changed->delItem(key) ? 1 : 0;
+                return ops;
+            });
+
+            stage("insert", [&] {
+                for (auto& item : inserts)
+                    changed->addGiveItem(
+                        SHAMapNodeType::tnACCOUNT_STATE, std::move(item));
+                return inserts.size();
+            });
+
+            stage("flushDirty", [&] {
+                SHAMapDeferredWrites writes;
+                return changed->flushDirty(hotACCOUNT_NODE, writes);
+            });
+            changed->setImmutable();
+
+            stage("compare", [&] {
+                SHAMap::Delta differences;
+                BEAST_EXPECT(map.compare(
+                    *changed,
+                    differences,
+                    std::numeric_limits<int>::max()));
+                return differences.size();
+            });
+        }
+
+        {
+            testcase("iterate");
+
+            stage("iterate", [&] {
+                std::size_t ops = 0;
+                for (auto const& item : map)
+                {
+                    (void)item;
+                    ++ops;
+                }
+                BEAST_EXPECT(ops == count);
+                return ops;
+            });
+        }
+
+        {
+            testcase("sync");
+
+            TestNodeFamily f2(journal);
+            SHAMap destination(SHAMapType::FREE, f2);
+            destination.setSynching();
+
+            {
+                std::vector<SHAMapNodeID> ids;
+                std::vector<Blob> nodes;
+                BEAST_EXPECT(
+                    map.getNodeFat(SHAMapNodeID(), ids, nodes, false, 0));
+                BEAST_EXPECT(destination
+                                 .addRootNode(
+                                     map.getHash(),
+                                     makeSlice(nodes.front()),
+                                     nullptr)
+                                 .isGood());
+            }
+
+            // The three steps of each round are timed apart
+            clock::duration missingTime{};
+            clock::duration fatTime{};
+            clock::duration addTime{};
+            std::size_t requested = 0;
+            std::size_t added = 0;
+            [[maybe_unused]] auto const heap = heapInUse();
+
+            while (true)
+            {
+                auto start = clock::now();
+                auto const missing =
+                    destination.getMissingNodes(2048, nullptr);
+                missingTime += clock::now() - start;
+                if (missing.empty())
+                    break;
+                requested += missing.size();
+
+                std::vector<SHAMapNodeID> ids;
+                std::vector<Blob> nodes;
+                start = clock::now();
+                for (auto const& m : missing)
+                {
+                    if (!map.getNodeFat(m.first, ids, nodes, false, 1))
+                        fail("", __FILE__, __LINE__);
+                }
+                fatTime += clock::now() - start;
+
+                start = clock::now();
+                for (std::size_t i = 0; i < ids.size(); ++i)
+                {
+                    if (destination
+                            .addKnownNode(ids[i], makeSlice(nodes[i]), nullptr)
+                            .isUseful())
+                        ++added;
+                }
+                addTime += clock::now() - start;
+            }
+            destination.clearSynching();
+            BEAST_EXPECT(destination.getHash() == map.getHash());
+
+            using namespace std::chrono;
+            auto const rate = [](std::size_t ops, clock::duration d) {
+                auto const s = duration_cast<duration<double>>(d).count();
+                return static_cast<std::uint64_t>(s > 0 ? ops / s : 0);
+            };
+            log << "  getMissingNodes: " << requested << " nodes, "
+                << rate(requested, missingTime) << " nodes/s" << std::endl;
+            log << "  getNodeFat: " << requested << " requests, "
+                << rate(requested, fatTime) << " requests/s" << std::endl;
+            log << "  addKnownNode: " << added << " nodes, "
+                << rate(added, addTime) << " nodes/s";
+#ifdef RIPPLE_SHAMAPBENCH_MALLINFO
+            log << ", " << (heapInUse() - heap) << " bytes";
+#endif
+            log << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapBench, shamap, ripple);
+
+}  // namespace tests
+}  // namespace ripple
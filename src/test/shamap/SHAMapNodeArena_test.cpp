@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapNodeArena.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <cstdint>
+
+namespace ripple {
+namespace tests {
+
+class SHAMapNodeArena_test : public beast::unit_test::suite
+{
+    beast::xor_shift_engine eng_;
+
+    boost::intrusive_ptr<SHAMapItem>
+    makeItem(std::uint32_t i)
+    {
+        Serializer s;
+        for (int d = 0; d < 8; ++d)
+            s.add32(rand_int<std::uint32_t>(eng_));
+        return make_shamapitem(sha512Half(i), s.slice());
+    }
+
+    void
+    testAllocate()
+    {
+        testcase("allocate");
+
+        SHAMapNodeArena arena;
+        BEAST_EXPECT(arena.reserved() == 0);
+
+        auto const a = arena.allocate(24, 8);
+        auto const b = arena.allocate(40, 16);
+        BEAST_EXPECT(reinterpret_cast<std::uintptr_t>(b) % 16 == 0);
+        BEAST_EXPECT(static_cast<char*>(b) >= static_cast<char*>(a) + 24);
+        BEAST_EXPECT(arena.reserved() == SHAMapNodeArena::blockBytes);
+        BEAST_EXPECT(arena.used() == 64);
+
+        // A large allocation gets a block of its own
+        auto const big = SHAMapNodeArena::blockBytes;
+        auto const c = arena.allocate(big, 16);
+        BEAST_EXPECT(arena.reserved() == 2 * SHAMapNodeArena::blockBytes);
+
+        // Small ones fill the first block before another is taken
+        for (int i = 0; i < 100; ++i)
+            arena.deallocate(arena.allocate(64, 8), 64);
+        BEAST_EXPECT(arena.reserved() == 2 * SHAMapNodeArena::blockBytes);
+
+        arena.deallocate(a, 24);
+        arena.deallocate(b, 40);
+        arena.deallocate(c, big);
+        BEAST_EXPECT(arena.used() == 0);
+    }
+
+    void
+    testMap()
+    {
+        testcase("map");
+
+        test::SuiteJournal journal("SHAMapNodeArena_test", *this);
+        TestNodeFamily f(journal);
+
+        auto arena = std::make_shared<SHAMapNodeArena>();
+        SHAMap heap(SHAMapType::TRANSACTION, f);
+        auto map = std::make_shared<SHAMap>(SHAMapType::TRANSACTION, f, arena);
+        BEAST_EXPECT(map->arena() == arena);
+        BEAST_EXPECT(!heap.arena());
+
+        for (std::uint32_t i = 0; i < 2000; ++i)
+        {
+            auto const item = makeItem(i);
+            heap.addItem(SHAMapNodeType::tnTRANSACTION_NM, item);
+            map->addItem(SHAMapNodeType::tnTRANSACTION_NM, item);
+        }
+        BEAST_EXPECT(map->getHash() == heap.getHash());
+        BEAST_EXPECT(arena->used() > 0);
+        BEAST_EXPECT(arena->reserved() >= arena->used());
+
+        // A snapshot unshares its nodes into the same arena
+        auto const before = arena->used();
+        auto copy = map->snapShot(true);
+        BEAST_EXPECT(copy->arena() == arena);
+        for (std::uint32_t i = 0; i < 100; ++i)
+        {
+            BEAST_EXPECT(copy->delItem(sha512Half(i)));
+            BEAST_EXPECT(heap.delItem(sha512Half(i)));
+        }
+        BEAST_EXPECT(arena->used() > before);
+        BEAST_EXPECT(copy->getHash() == heap.getHash());
+        BEAST_EXPECT(map->getHash() != heap.getHash());
+
+        // Nodes kept past the map keep the memory they came from
+        auto root = copy->snapShot(false);
+        map.reset();
+        copy.reset();
+        BEAST_EXPECT(arena->used() > 0);
+        BEAST_EXPECT(root->getHash() == heap.getHash());
+
+        root.reset();
+        BEAST_EXPECT(arena->used() == 0);
+        BEAST_EXPECT(arena.use_count() == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testAllocate();
+        testMap();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SHAMapNodeArena, shamap, ripple);
+
+}  // namespace tests
+}  // namespace ripple
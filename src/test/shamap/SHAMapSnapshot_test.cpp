@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapSnapshot.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace ripple {
+namespace tests {
+
+class SHAMapSnapshot_test : public beast::unit_test::suite
+{
+    beast::xor_shift_engine eng_;
+
+    boost::intrusive_ptr<SHAMapItem>
+    makeRandomAS()
+    {
+        Serializer s;
+
+        for (int d = 0; d < 3; ++d)
+            s.add32(rand_int<std::uint32_t>(eng_));
+
+        return make_shamapitem(s.getSHA512Half(), s.slice());
+    }
+
+    void
+    fill(SHAMap& map, int items)
+    {
+        for (int i = 0; i < items; ++i)
+            map.addItem(SHAMapNodeType::tnACCOUNT_STATE, makeRandomAS());
+        map.setImmutable();
+    }
+
+    static std::size_t
+    resident(SHAMap const& map)
+    {
+        std::size_t count = 0;
+        map.visitResident([&count](SHAMapTreeNode const&) {
+            ++count;
+            return true;
+        });
+        return count;
+    }
+
+    void
+    testRoundTrip(beast::Journal const& journal)
+    {
+        testcase("round trip");
+
+        beast::temp_dir dir;
+        SHAMapSnapshot snapshot(dir.file("state.snapshot"), journal);
+
+        TestNodeFamily f(journal);
+        SHAMap source(SHAMapType::FREE, f);
+        fill(source, 1000);
+
+        auto const count = resident(source);
+        BEAST_EXPECT(snapshot.write(source, 7, 1000000) == count);
+        BEAST_EXPECT(
+            !boost::filesystem::exists(dir.file("state.snapshot.tmp")));
+
+        // The second family's database is empty, so the map can only be
+        // built from the nodes the snapshot put in its cache
+        TestNodeFamily f2(journal);
+        BEAST_EXPECT(snapshot.load(f2) == count);
+
+        SHAMap destination(SHAMapType::FREE, f2);
+        BEAST_EXPECT(destination.fetchRoot(source.getHash(), nullptr));
+
+        std::size_t found = 0;
+        source.visitNodes([&](SHAMapTreeNode& node) {
+            if (f2.getTreeNodeCache(7)->fetch(node.getHash().as_uint256()))
+                ++found;
+            return true;
+        });
+        BEAST_EXPECT(found == count);
+
+        destination.visitLeaves([&](auto const& item) {
+            auto const expected = source.peekItem(item->key());
+            if (!expected || expected->slice() != item->slice())
+                fail("", __FILE__, __LINE__);
+        });
+
+        snapshot.release();
+    }
+
+    void
+    testMaxNodes(beast::Journal const& journal)
+    {
+        testcase("max nodes");
+
+        beast::temp_dir dir;
+        SHAMapSnapshot snapshot(dir.file("state.snapshot"), journal);
+
+        TestNodeFamily f(journal);
+        SHAMap source(SHAMapType::FREE, f);
+        fill(source, 1000);
+
+        BEAST_EXPECT(snapshot.write(source, 7, 17) == 17);
+
+        // Written breadth first, so the root and all its children come first
+        TestNodeFamily f2(journal);
+        BEAST_EXPECT(snapshot.load(f2) == 17);
+        SHAMap destination(SHAMapType::FREE, f2);
+        BEAST_EXPECT(destination.fetchRoot(source.getHash(), nullptr));
+    }
+
+    void
+    testDamaged(beast::Journal const& journal)
+    {
+        testcase("damaged");
+
+        beast::temp_dir dir;
+        auto const path = dir.file("state.snapshot");
+        SHAMapSnapshot snapshot(path, journal);
+
+        {
+            TestNodeFamily f(journal);
+            BEAST_EXPECT(snapshot.load(f) == 0);
+        }
+
+        TestNodeFamily f(journal);
+        SHAMap source(SHAMapType::FREE, f);
+        fill(source, 1000);
+
+        auto const count = snapshot.write(source, 7, 1000000);
+        BEAST_EXPECT(count > 100);
+
+        // A snapshot cut short loads up to the cut
+        boost::filesystem::resize_file(
+            path, boost::filesystem::file_size(path) / 2);
+        {
+            TestNodeFamily f2(journal);
+            auto const loaded = snapshot.load(f2);
+            BEAST_EXPECT(loaded > 0 && loaded < count);
+        }
+
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << "this is not a snapshot of anything at all, however long";
+        }
+        {
+            TestNodeFamily f2(journal);
+            BEAST_EXPECT(snapshot.load(f2) == 0);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        test::SuiteJournal journal("SHAMapSnapshot_test", *this);
+
+        testRoundTrip(journal);
+        testMaxNodes(journal);
+        testDamaged(journal);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SHAMapSnapshot, shamap, ripple);
+
+}  // namespace tests
+}  // namespace ripple
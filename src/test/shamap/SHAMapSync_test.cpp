@@ -34,7 +34,7 @@ class SHAMapSync_test : public beast::unit_test::suite
 public:
     beast::xor_shift_engine eng_;
 
-    std::shared_ptr<SHAMapItem>
+    boost::intrusive_ptr<SHAMapItem>
     makeRandomAS()
     {
         Serializer s;
@@ -42,7 +42,7 @@ public:
         for (int d = 0; d < 3; ++d)
             s.add32(rand_int<std::uint32_t>(eng_));
 
-        return std::make_shared<SHAMapItem>(s.getSHA512Half(), s.peekData());
+        return make_shamapitem(s.getSHA512Half(), s.slice());
     }
 
     bool
@@ -56,10 +56,10 @@ public:
 
         for (int i = 0; i < count; ++i)
         {
-            std::shared_ptr<SHAMapItem> item = makeRandomAS();
+            boost::intrusive_ptr<SHAMapItem> item = makeRandomAS();
             items.push_back(item->key());
 
-            if (!map.addItem(SHAMapNodeType::tnACCOUNT_STATE, std::move(*item)))
+            if (!map.addItem(SHAMapNodeType::tnACCOUNT_STATE, std::move(item)))
             {
                 log << "Unable to add item to map\n";
                 return false;
@@ -91,15 +91,25 @@ public:
         using namespace beast::severities;
         test::SuiteJournal journal("SHAMapSync_test", *this);
 
-        TestNodeFamily f(journal), f2(journal);
+        testSync(journal, 1);
+        testSync(journal, 4);
+    }
+
+    void
+    testSync(beast::Journal const& journal, int syncThreads)
+    {
+        testcase(
+            "sync with " + std::to_string(syncThreads) + " search threads");
+
+        TestNodeFamily f(journal, 1, 1, syncThreads),
+            f2(journal, 1, syncThreads, syncThreads);
         SHAMap source(SHAMapType::FREE, f);
         SHAMap destination(SHAMapType::FREE, f2);
 
         int items = 10000;
         for (int i = 0; i < items; ++i)
         {
-            source.addItem(
-                SHAMapNodeType::tnACCOUNT_STATE, std::move(*makeRandomAS()));
+            source.addItem(SHAMapNodeType::tnACCOUNT_STATE, makeRandomAS());
             if (i % 100 == 0)
                 source.invariants();
         }
@@ -118,6 +128,10 @@ public:
         source.walkMap(missingNodes, 2048);
         BEAST_EXPECT(missingNodes.empty());
 
+        // A walk held to a rate still visits everything
+        source.walkMap(missingNodes, 2048, 1000000);
+        BEAST_EXPECT(missingNodes.empty());
+
         std::vector<SHAMapNodeID> nodeIDs, gotNodeIDs;
         std::vector<Blob> gotNodes;
         std::vector<uint256> hashes;
@@ -145,6 +159,18 @@ public:
                              .isGood());
         }
 
+        if (syncThreads > 1)
+        {
+            // Only the root is present, so a parallel walk reports each of
+            // its branches rather than throwing at the first
+            std::vector<SHAMapMissingNode> missing;
+            destination.walkMap(missing, 2048);
+            BEAST_EXPECT(missing.size() > 3);
+            missing.clear();
+            destination.walkMap(missing, 3);
+            BEAST_EXPECT(missing.size() == 3);
+        }
+
         do
         {
             f.clock().advance(std::chrono::seconds(1));
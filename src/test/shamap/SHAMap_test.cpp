@@ -21,9 +21,12 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/shamap/SHAMap.h>
 #include <test/shamap/common.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <chrono>
+#include <thread>
 
 namespace ripple {
 namespace tests {
@@ -44,10 +47,10 @@ static_assert(std::is_move_assignable<SHAMap::const_iterator>{}, "");
 
 static_assert(std::is_nothrow_destructible<SHAMapItem>{}, "");
 static_assert(!std::is_default_constructible<SHAMapItem>{}, "");
-static_assert(std::is_copy_constructible<SHAMapItem>{}, "");
-static_assert(std::is_copy_assignable<SHAMapItem>{}, "");
-static_assert(std::is_move_constructible<SHAMapItem>{}, "");
-static_assert(std::is_move_assignable<SHAMapItem>{}, "");
+static_assert(!std::is_copy_constructible<SHAMapItem>{}, "");
+static_assert(!std::is_copy_assignable<SHAMapItem>{}, "");
+static_assert(!std::is_move_constructible<SHAMapItem>{}, "");
+static_assert(!std::is_move_assignable<SHAMapItem>{}, "");
 
 static_assert(std::is_nothrow_destructible<SHAMapNodeID>{}, "");
 static_assert(std::is_default_constructible<SHAMapNodeID>{}, "");
@@ -128,6 +131,255 @@ public:
 
         run(true, journal);
         run(false, journal);
+        testParallelFlush(journal);
+        testDeferredWrites(journal);
+        testParallelCompare(journal);
+        testScanReadAhead(journal);
+        testFetchPaths(journal);
+    }
+
+    void
+    testParallelFlush(beast::Journal const& journal)
+    {
+        testcase("parallel flush");
+
+        tests::TestNodeFamily serialFamily{journal};
+        tests::TestNodeFamily parallelFamily{journal, 4};
+        SHAMap serial{SHAMapType::FREE, serialFamily};
+        SHAMap parallel{SHAMapType::FREE, parallelFamily};
+
+        auto add = [&](int count, std::uint8_t value) {
+            for (int i = 0; i < count; ++i)
+            {
+                auto const key{sha512Half(i)};
+                Blob const data(32, value);
+                serial.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    make_shamapitem(key, makeSlice(data)));
+                parallel.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    make_shamapitem(key, makeSlice(data)));
+            }
+        };
+
+        add(2000, 1);
+        auto const flushed = serial.flushDirty(hotACCOUNT_NODE);
+        BEAST_EXPECT(parallel.flushDirty(hotACCOUNT_NODE) == flushed);
+        BEAST_EXPECT(serial.getHash() == parallel.getHash());
+        parallel.invariants();
+
+        // Modify the flushed maps and flush again
+        auto serialNext = serial.snapShot(true);
+        auto parallelNext = parallel.snapShot(true);
+        for (int i = 0; i < 2000; i += 3)
+        {
+            auto const key{sha512Half(i)};
+            Blob const data(32, 2);
+            serialNext->updateGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(key, makeSlice(data)));
+            parallelNext->updateGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(key, makeSlice(data)));
+        }
+        BEAST_EXPECT(
+            serialNext->flushDirty(hotACCOUNT_NODE) ==
+            parallelNext->flushDirty(hotACCOUNT_NODE));
+        BEAST_EXPECT(serialNext->getHash() == parallelNext->getHash());
+        BEAST_EXPECT(serialNext->getHash() != serial.getHash());
+        parallelNext->invariants();
+    }
+
+    void
+    testDeferredWrites(beast::Journal const& journal)
+    {
+        testcase("deferred writes");
+
+        tests::TestNodeFamily f{journal};
+        SHAMap unwritten{SHAMapType::FREE, f};
+        SHAMap held{SHAMapType::FREE, f};
+        for (int i = 0; i < 500; ++i)
+        {
+            auto const key{sha512Half(i)};
+            Blob const data(32, 7);
+            unwritten.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(key, makeSlice(data)));
+            held.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(key, makeSlice(data)));
+        }
+
+        SHAMapDeferredWrites writes;
+        auto const flushed = unwritten.unshare();
+        BEAST_EXPECT(held.flushDirty(hotACCOUNT_NODE, writes) == flushed);
+        BEAST_EXPECT(held.getHash() == unwritten.getHash());
+        held.invariants();
+
+        // Nothing reaches the node store until the writes are stored
+        auto const root = held.getHash().as_uint256();
+        BEAST_EXPECT(!f.db().fetchNodeObject(root));
+        BEAST_EXPECT(writes.store(f.db()) == flushed);
+        BEAST_EXPECT(f.db().fetchNodeObject(root));
+        BEAST_EXPECT(writes.store(f.db()) == 0);
+    }
+
+    void
+    testParallelCompare(beast::Journal const& journal)
+    {
+        testcase("parallel compare");
+
+        tests::TestNodeFamily f{journal};
+        SHAMap base{SHAMapType::FREE, f};
+        for (int i = 0; i < 2000; ++i)
+        {
+            base.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(sha512Half(i), makeSlice(Blob(32, 1))));
+        }
+        base.unshare();
+        base.setImmutable();
+
+        // Change, delete and add items all over the key space
+        auto changed = base.snapShot(true);
+        for (int i = 0; i < 2000; i += 7)
+        {
+            changed->updateGiveItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(sha512Half(i), makeSlice(Blob(32, 2))));
+        }
+        for (int i = 3; i < 2000; i += 11)
+            changed->delItem(sha512Half(i));
+        for (int i = 2000; i < 2100; ++i)
+        {
+            changed->addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(sha512Half(i), makeSlice(Blob(32, 3))));
+        }
+        changed->unshare();
+        changed->setImmutable();
+
+        SHAMap::Delta serial;
+        BEAST_EXPECT(base.compare(*changed, serial, 100000));
+        BEAST_EXPECT(!serial.empty());
+
+        SHAMap::Delta parallel;
+        BEAST_EXPECT(base.compare(*changed, parallel, 100000, 4));
+        BEAST_EXPECT(parallel.size() == serial.size());
+        for (auto const& [key, items] : serial)
+        {
+            auto const it = parallel.find(key);
+            if (!BEAST_EXPECT(it != parallel.end()))
+                continue;
+            BEAST_EXPECT(bool(items.first) == bool(it->second.first));
+            BEAST_EXPECT(bool(items.second) == bool(it->second.second));
+        }
+
+        // Both stop once they reach the limit
+        SHAMap::Delta limited;
+        BEAST_EXPECT(!base.compare(*changed, limited, 50, 4));
+        BEAST_EXPECT(limited.size() == 50);
+    }
+
+    void
+    testScanReadAhead(beast::Journal const& journal)
+    {
+        testcase("scan read ahead");
+
+        using namespace std::chrono_literals;
+
+        tests::TestNodeFamily f{journal, 1, 1, 1, 4};
+        SHAMapHash hash;
+        std::vector<uint256> keys;
+        {
+            SHAMap map{SHAMapType::FREE, f};
+            for (int i = 0; i < 2000; ++i)
+            {
+                map.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    make_shamapitem(sha512Half(i), makeSlice(Blob(32, 1))));
+            }
+            map.flushDirty(hotACCOUNT_NODE);
+            hash = map.getHash();
+            for (auto const& item : map)
+                keys.push_back(item.key());
+        }
+
+        // Start from the database alone, so only reading ahead fills the
+        // cache before the scan needs a node
+        f.reset();
+        SHAMap map{SHAMapType::FREE, f};
+        BEAST_EXPECT(map.fetchRoot(hash, nullptr));
+
+        auto it = map.begin(4);
+        auto const cache = f.getTreeNodeCache(0);
+        for (int i = 0; i < 500 && cache->getCacheSize() < 20; ++i)
+            std::this_thread::sleep_for(10ms);
+        BEAST_EXPECT(cache->getCacheSize() >= 20);
+
+        std::vector<uint256> scanned;
+        for (; it != map.end(); ++it)
+            scanned.push_back(it->key());
+        BEAST_EXPECT(scanned == keys);
+
+        auto const middle = keys.size() / 2;
+        scanned.clear();
+        for (auto i = map.upper_bound(keys[middle], 4); i != map.end(); ++i)
+            scanned.push_back(i->key());
+        BEAST_EXPECT(
+            std::equal(
+                scanned.begin(),
+                scanned.end(),
+                keys.begin() + middle + 1,
+                keys.end()) &&
+            scanned.size() == keys.size() - middle - 1);
+    }
+
+    void
+    testFetchPaths(beast::Journal const& journal)
+    {
+        testcase("fetch paths");
+
+        tests::TestNodeFamily f{journal};
+        SHAMapHash hash;
+        {
+            SHAMap map{SHAMapType::FREE, f};
+            for (int i = 0; i < 2000; ++i)
+            {
+                map.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    make_shamapitem(sha512Half(i), makeSlice(Blob(32, 1))));
+            }
+            map.flushDirty(hotACCOUNT_NODE);
+            hash = map.getHash();
+        }
+
+        f.reset();
+        SHAMap map{SHAMapType::FREE, f};
+        BEAST_EXPECT(map.fetchRoot(hash, nullptr));
+
+        // Some keys that are in the map, one twice, and one that is not
+        std::vector<uint256> keys;
+        for (int i = 0; i < 2000; i += 20)
+            keys.push_back(sha512Half(i));
+        keys.push_back(keys.front());
+        keys.push_back(sha512Half(5000));
+
+        auto& db = f.db();
+        auto const before = db.getFetchTotalCount();
+        map.fetchPaths(keys);
+        auto const fetched = db.getFetchTotalCount() - before;
+        BEAST_EXPECT(fetched > keys.size());
+
+        // Every node the lookups need is in memory now
+        for (std::size_t i = 0; i + 1 < keys.size(); ++i)
+            BEAST_EXPECT(map.hasItem(keys[i]));
+        BEAST_EXPECT(!map.hasItem(keys.back()));
+        BEAST_EXPECT(db.getFetchTotalCount() == before + fetched);
+
+        // Nothing is read twice
+        map.fetchPaths(keys);
+        BEAST_EXPECT(db.getFetchTotalCount() == before + fetched);
     }
 
     void
@@ -158,37 +410,42 @@ public:
         if (!backed)
             sMap.setUnbacked();
 
-        SHAMapItem i1(h1, IntToVUC(1)), i2(h2, IntToVUC(2)),
-            i3(h3, IntToVUC(3)), i4(h4, IntToVUC(4)), i5(h5, IntToVUC(5));
+        auto const i1 = make_shamapitem(h1, makeSlice(IntToVUC(1)));
+        auto const i2 = make_shamapitem(h2, makeSlice(IntToVUC(2)));
+        auto const i3 = make_shamapitem(h3, makeSlice(IntToVUC(3)));
+        auto const i4 = make_shamapitem(h4, makeSlice(IntToVUC(4)));
+        auto const i5 = make_shamapitem(h5, makeSlice(IntToVUC(5)));
         unexpected(
-            !sMap.addItem(SHAMapNodeType::tnTRANSACTION_NM, SHAMapItem{i2}),
+            !sMap.addItem(
+                SHAMapNodeType::tnTRANSACTION_NM, make_shamapitem(*i2)),
             "no add");
         sMap.invariants();
         unexpected(
-            !sMap.addItem(SHAMapNodeType::tnTRANSACTION_NM, SHAMapItem{i1}),
+            !sMap.addItem(
+                SHAMapNodeType::tnTRANSACTION_NM, make_shamapitem(*i1)),
             "no add");
         sMap.invariants();
 
         auto i = sMap.begin();
         auto e = sMap.end();
-        unexpected(i == e || (*i != i1), "bad traverse");
+        unexpected(i == e || (*i != *i1), "bad traverse");
         ++i;
-        unexpected(i == e || (*i != i2), "bad traverse");
+        unexpected(i == e || (*i != *i2), "bad traverse");
         ++i;
         unexpected(i != e, "bad traverse");
-        sMap.addItem(SHAMapNodeType::tnTRANSACTION_NM, SHAMapItem{i4});
+        sMap.addItem(SHAMapNodeType::tnTRANSACTION_NM, make_shamapitem(*i4));
         sMap.invariants();
-        sMap.delItem(i2.key());
+        sMap.delItem(i2->key());
         sMap.invariants();
-        sMap.addItem(SHAMapNodeType::tnTRANSACTION_NM, SHAMapItem{i3});
+        sMap.addItem(SHAMapNodeType::tnTRANSACTION_NM, make_shamapitem(*i3));
         sMap.invariants();
         i = sMap.begin();
         e = sMap.end();
-        unexpected(i == e || (*i != i1), "bad traverse");
+        unexpected(i == e || (*i != *i1), "bad traverse");
         ++i;
-        unexpected(i == e || (*i != i3), "bad traverse");
+        unexpected(i == e || (*i != *i3), "bad traverse");
         ++i;
-        unexpected(i == e || (*i != i4), "bad traverse");
+        unexpected(i == e || (*i != *i4), "bad traverse");
         ++i;
         unexpected(i != e, "bad traverse");
 
@@ -284,7 +541,7 @@ public:
             BEAST_EXPECT(map.getHash() == beast::zero);
             for (int k = 0; k < keys.size(); ++k)
             {
-                SHAMapItem item(keys[k], IntToVUC(k));
+                auto item = make_shamapitem(keys[k], makeSlice(IntToVUC(k)));
                 BEAST_EXPECT(map.addItem(
                     SHAMapNodeType::tnTRANSACTION_NM, std::move(item)));
                 BEAST_EXPECT(map.getHash().as_uint256() == hashes[k]);
@@ -339,7 +596,7 @@ public:
             {
                 map.addItem(
                     SHAMapNodeType::tnTRANSACTION_NM,
-                    SHAMapItem{k, IntToVUC(0)});
+                    make_shamapitem(k, makeSlice(IntToVUC(0))));
                 map.invariants();
             }
 
@@ -372,7 +629,9 @@ class SHAMapPathProof_test : public beast::unit_test::suite
         {
             uint256 k(c);
             Blob b(32, c);
-            map.addItem(SHAMapNodeType::tnACCOUNT_STATE, SHAMapItem{k, b});
+            map.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(k, makeSlice(b)));
             map.invariants();
 
             auto root = map.getHash().as_uint256();
@@ -21,10 +21,12 @@
 #define RIPPLE_SHAMAP_TESTS_COMMON_H_INCLUDED
 
 #include <ripple/basics/chrono.h>
+#include <ripple/core/WorkerPool.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/shamap/Family.h>
+#include <algorithm>
 
 namespace ripple {
 namespace tests {
@@ -43,8 +45,15 @@ private:
 
     beast::Journal const j_;
 
+    WorkerPool workers_;
+
 public:
-    TestNodeFamily(beast::Journal j)
+    TestNodeFamily(
+        beast::Journal j,
+        int flushThreads = 1,
+        int syncThreads = 1,
+        int walkThreads = 1,
+        int scanReadAhead = 0)
         : fbCache_(std::make_shared<FullBelowCache>(
               "App family full below cache",
               clock_))
@@ -56,10 +65,15 @@ public:
               j))
         , parent_("TestRootStoppable")
         , j_(j)
+        , workers_(std::max({flushThreads, syncThreads, walkThreads}) - 1)
     {
         Section testSection;
         testSection.set("type", "memory");
         testSection.set("Path", "SHAMap_test");
+        testSection.set("flush_threads", std::to_string(flushThreads));
+        testSection.set("sync_threads", std::to_string(syncThreads));
+        testSection.set("walk_threads", std::to_string(walkThreads));
+        testSection.set("scan_read_ahead", std::to_string(scanReadAhead));
         db_ = NodeStore::Manager::instance().make_Database(
             "test", megabytes(4), scheduler_, 1, parent_, testSection, j);
     }
@@ -82,6 +96,12 @@ public:
         return j_;
     }
 
+    WorkerPool&
+    workers() override
+    {
+        return workers_;
+    }
+
     std::shared_ptr<FullBelowCache> getFullBelowCache(std::uint32_t) override
     {
         return fbCache_;